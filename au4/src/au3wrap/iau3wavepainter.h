@@ -3,6 +3,9 @@
 #include <QColor>
 #include <QRect>
 
+#include <cstdint>
+#include <vector>
+
 #include "modularity/imoduleinterface.h"
 #include "processing/processingtypes.h"
 
@@ -36,6 +39,40 @@ public:
         Style style;
     };
 
+    //! One column of pixels, in fractions of the channel height from its top
+    struct Column {
+        float maxY = 0.0f;
+        float minY = 0.0f;
+        float rmsTopY = 0.0f;
+        float rmsBottomY = 0.0f;
+        bool clipped = false;
+
+        bool operator==(const Column& other) const
+        {
+            return maxY == other.maxY && minY == other.minY
+                   && rmsTopY == other.rmsTopY && rmsBottomY == other.rmsBottomY
+                   && clipped == other.clipped;
+        }
+    };
+
+    //! The columns of one element of the wave data cache of a channel
+    struct ColumnsBlock {
+        size_t channel = 0;
+        //! Position of the first column at the zoom level, which identifies
+        //! the block while scrolling
+        int64_t firstColumn = 0;
+        //! Geometry of the block in the view; it may start left of the view
+        double left = 0.0;
+        double top = 0.0;
+        double height = 0.0;
+        //! Whether the columns are final or still being read
+        bool complete = false;
+        std::vector<Column> columns;
+    };
+
     virtual void paint(QPainter& painter, const processing::ClipKey& clipKey, const Params& params) = 0;
+
+    //! Columns to paint elsewhere, as on the GPU, for the same parameters as paint()
+    virtual std::vector<ColumnsBlock> columns(const processing::ClipKey& clipKey, const Params& params) = 0;
 };
 }
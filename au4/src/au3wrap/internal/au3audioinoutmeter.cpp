@@ -4,6 +4,8 @@
 
 #include "au3audioinoutmeter.h"
 
+#include <algorithm>
+
 #include "libraries/lib-utility/MemoryX.h"
 
 #include "log.h"
@@ -11,15 +13,31 @@
 using namespace muse;
 using namespace muse::async;
 
+//! NOTE As the refresh rate of the meters of Audacity 3
+constexpr int DISPLAY_RATE_HZ = 30;
+
+//! NOTE The toolbar meters show two channels
+constexpr unsigned DISPLAYED_CHANNELS = 2;
+
+au::au3::InOutMeter::InOutMeter()
+    : m_displayTimer(std::chrono::milliseconds(1000 / DISPLAY_RATE_HZ))
+{
+    m_displayTimer.onTimeout(this, [this]() {
+        sendSignalChanges();
+    });
+    m_displayTimer.start();
+}
+
 void au::au3::InOutMeter::Clear()
 {
 }
 
 void au::au3::InOutMeter::Reset(double sampleRate, bool resetClipping)
 {
-    UNUSED(sampleRate);
     UNUSED(resetClipping);
 
+    m_levels.Reset(sampleRate);
+
     au::audio::volume_dbfs_t zero = static_cast<au::audio::volume_dbfs_t>(LINEAR_TO_DB(0));
 
     m_audioSignalChanges.send(0, au::audio::AudioSignalVal { 0, zero });
@@ -28,47 +46,22 @@ void au::au3::InOutMeter::Reset(double sampleRate, bool resetClipping)
 
 void au::au3::InOutMeter::UpdateDisplay(unsigned int numChannels, unsigned long numFrames, const float* sampleData)
 {
-    auto sptr = sampleData;
-    unsigned int num = 2;
-
-    int numPeakSamplesToClip = 3;
-
-    std::vector<float> peak(num);
-    std::vector<float> rms(num);
-    std::vector<bool> clipping(num);
-    std::vector<unsigned long> headPeakCount(num);
-    std::vector<int> tailPeakCount(num);
-
-    for (unsigned long i = 0; i < numFrames; i++) {
-        for (unsigned int j = 0; j < num; j++) {
-            peak[j] = std::max(peak[j], fabs(sptr[j]));
-            rms[j] += sptr[j] * sptr[j];
-
-            // In addition to looking for mNumPeakSamplesToClip peaked
-            // samples in a row, also send the number of peaked samples
-            // at the head and tail, in case there's a run of peaked samples
-            // that crosses block boundaries
-            if (fabs(sptr[j]) >= MAX_AUDIO) {
-                if (headPeakCount[j] == i) {
-                    headPeakCount[j]++;
-                }
-                tailPeakCount[j]++;
-                if (tailPeakCount[j] > numPeakSamplesToClip) {
-                    clipping[j] = true;
-                }
-            } else {
-                tailPeakCount[j] = 0;
-            }
-        }
-        sptr += numChannels;
-    }
-    for (unsigned int j = 0; j < num; j++) {
-        rms[j] = sqrt(rms[j] / numFrames);
+    //! NOTE Called in the audio callback; only measures, never notifies
+    m_levels.Accumulate(numChannels, numFrames, sampleData);
+}
+
+void au::au3::InOutMeter::sendSignalChanges()
+{
+    MeterLevelsQueue::Levels levels;
+    if (!m_levels.Drain(levels) || levels.nChannels == 0) {
+        return;
     }
 
-    m_audioSignalChanges.send(0, au::audio::AudioSignalVal { 0, static_cast<au::audio::volume_dbfs_t>(LINEAR_TO_DB(peak[0])) });
-    m_audioSignalChanges.send(1, au::audio::AudioSignalVal { 0, static_cast<au::audio::volume_dbfs_t>(LINEAR_TO_DB(peak[1])) });
-    // LOGD() << "=============== change " << LINEAR_TO_DB(peak[0]) << " - " << LINEAR_TO_DB(peak[1]);
+    for (unsigned ch = 0; ch < DISPLAYED_CHANNELS; ++ch) {
+        //! NOTE A mono signal is shown in both channels
+        const float peak = levels.peaks[std::min(ch, levels.nChannels - 1)];
+        m_audioSignalChanges.send(ch, au::audio::AudioSignalVal { 0, static_cast<au::audio::volume_dbfs_t>(LINEAR_TO_DB(peak)) });
+    }
 }
 
 bool au::au3::InOutMeter::IsMeterDisabled() const
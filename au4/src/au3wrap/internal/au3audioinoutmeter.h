@@ -8,15 +8,19 @@
 #include "global/async/asyncable.h"
 #include "global/async/promise.h"
 #include "global/async/channel.h"
+#include "global/timer.h"
 
 #include "playback/audiotypes.h"
 
 #include "libraries/lib-audio-devices/Meter.h"
+#include "libraries/lib-audio-io/MeterLevelsQueue.h"
 
 namespace au::au3 {
 class InOutMeter : public Meter, public muse::async::Asyncable
 {
 public:
+    InOutMeter();
+
     void Clear() override;
     void Reset(double sampleRate, bool resetClipping) override;
     void UpdateDisplay(unsigned numChannels, unsigned long numFrames, const float* sampleData) override;
@@ -28,6 +32,13 @@ public:
     muse::async::Promise<muse::async::Channel<au::audio::audioch_t, au::audio::AudioSignalVal> > signalChanges() const;
 
 private:
+    void sendSignalChanges();
+
+    //! NOTE Filled in the audio callback, and drained in the main thread
+    //! at the rate of the display, so that there is no event for each callback
+    MeterLevelsQueue m_levels;
+    muse::Timer m_displayTimer;
+
     muse::async::Channel<au::audio::audioch_t, au::audio::AudioSignalVal> m_audioSignalChanges;
 };
 }
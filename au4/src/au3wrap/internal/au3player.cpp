@@ -21,7 +21,7 @@
 using namespace au::au3;
 
 Au3Player::Au3Player()
-    : m_positionUpdateTimer(std::chrono::microseconds(1000))
+    : m_positionUpdateTimer(std::chrono::milliseconds(50))
 {
     m_positionUpdateTimer.onTimeout(this, [this]() {
         updatePlaybackPosition();
@@ -29,6 +29,7 @@ Au3Player::Au3Player()
 
     m_playbackStatus.ch.onReceive(this, [this](audio::PlaybackStatus st) {
         if (st == audio::PlaybackStatus::Running) {
+            m_positionInterpolator.Reset();
             m_positionUpdateTimer.start();
         } else {
             m_positionUpdateTimer.stop();
@@ -314,12 +315,20 @@ void Au3Player::resetLoop()
 
 void Au3Player::updatePlaybackPosition()
 {
-    m_playbackPosition.set(std::max(0.0, AudioIO::Get()->GetStreamTime()));
+    m_playbackPosition.set(playbackPosition());
 }
 
 au::audio::secs_t Au3Player::playbackPosition() const
 {
-    return m_playbackPosition.val;
+    //! NOTE While playing, the position is estimated for the present moment from
+    //! the last one published by the audio callback, without waiting for it
+    auto gAudioIO = AudioIO::Get();
+    if (m_playbackStatus.val != audio::PlaybackStatus::Running || !gAudioIO->IsStreamActive()) {
+        return m_playbackPosition.val;
+    }
+
+    const double time = m_positionInterpolator.Get(gAudioIO->GetPlaybackClock(), PlaybackClock::Clock::now());
+    return std::max(0.0, time);
 }
 
 muse::async::Channel<au::audio::secs_t> Au3Player::playbackPositionChanged() const
@@ -13,6 +13,8 @@
 
 #include "playback/iplayer.h"
 
+#include "libraries/lib-audio-io/PlaybackClock.h"
+
 class AudacityProject;
 class TrackList;
 struct TransportSequences;
@@ -51,8 +53,11 @@ private:
 
     muse::ValCh<audio::PlaybackStatus> m_playbackStatus;
 
+    //! NOTE Only notifies the listeners of the channel; the play cursor reads
+    //! the position itself, at each frame of its window
     muse::Timer m_positionUpdateTimer;
     muse::ValCh<audio::secs_t> m_playbackPosition;
+    mutable PlaybackClock::Interpolator m_positionInterpolator;
 };
 }
 
@@ -1,5 +1,9 @@
 #include "au3wavepainter.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+
 #include <QColor>
 #include <QPainter>
 #include <QPen>
@@ -177,6 +181,81 @@ public:
         }
     }
 
+    //! Columns of the data cache, in the vertical bounds, with the envelope,
+    //! as fractions of the channel height
+    void Columns(size_t channelIndex,
+                 const WaveMetrics& metrics,
+                 float zoomMin, float zoomMax,
+                 bool dB, float dBRange,
+                 std::vector<au::au3::IAu3WavePainter::ColumnsBlock>& blocks)
+    {
+        assert(channelIndex < mChannelCaches.size());
+        if (channelIndex >= mChannelCaches.size() || zoomMax <= zoomMin) {
+            return;
+        }
+
+        auto& dataCache = *mChannelCaches[channelIndex].DataCache;
+        dataCache.UpdateViewportWidth(metrics.width);
+
+        const ZoomInfo zoomInfo(0.0, metrics.zoom);
+        auto range = dataCache.PerformLookup(zoomInfo, metrics.fromTime, metrics.toTime);
+        if (range.begin() == range.end()) {
+            return;
+        }
+
+        const auto leftPosition = zoomInfo.TimeToPosition(metrics.fromTime);
+        int64_t firstColumn = leftPosition - range.begin().GetLeftOffset();
+
+        const auto& envelope = mWaveClip->GetEnvelope();
+        const bool hasEnvelope = envelope.GetNumberOfPoints() > 0 || envelope.GetDefaultValue() != 1.0;
+        std::array<double, WaveDataCache::CacheElementWidth> envelopeValues;
+
+        const auto remap = [dB, dBRange](float value) {
+            if (!dB || value == 0.0f) {
+                return value;
+            }
+            const float sign = value >= 0 ? 1 : -1;
+            return sign * std::max(0.0f, (LINEAR_TO_DB(std::fabs(value)) + dBRange) / dBRange);
+        };
+        const auto toY = [zoomMin, zoomMax](float value) {
+            return std::clamp((zoomMax - value) / (zoomMax - zoomMin), 0.0f, 1.0f);
+        };
+
+        for (auto it = range.begin(); it != range.end(); ++it, firstColumn += WaveDataCache::CacheElementWidth) {
+            const auto& element = *it;
+
+            au::au3::IAu3WavePainter::ColumnsBlock block;
+            block.channel = channelIndex;
+            block.firstColumn = firstColumn;
+            block.left = metrics.left + (firstColumn - leftPosition);
+            block.top = metrics.top;
+            block.height = metrics.height;
+            block.complete = element.IsComplete;
+
+            if (hasEnvelope) {
+                envelope.GetValues(envelopeValues.data(), static_cast<int>(envelopeValues.size()),
+                                   firstColumn / metrics.zoom, 1.0 / metrics.zoom);
+            }
+
+            block.columns.resize(element.AvailableColumns);
+            for (size_t column = 0; column < element.AvailableColumns; ++column) {
+                const float gain = hasEnvelope ? envelopeValues[column] : 1.0f;
+                const float min = remap(element.Data[column].min) * gain;
+                const float max = remap(element.Data[column].max) * gain;
+                const float rms = remap(element.Data[column].rms) * gain;
+
+                auto& out = block.columns[column];
+                out.maxY = toY(max);
+                out.minY = toY(min);
+                out.rmsTopY = toY(std::min(rms, max));
+                out.rmsBottomY = toY(std::max(-rms, min));
+                out.clipped = min <= -MAX_AUDIO || max >= MAX_AUDIO;
+            }
+
+            blocks.push_back(std::move(block));
+        }
+    }
+
     void MarkChanged() noexcept override { }
 
     void Invalidate() override
@@ -599,31 +678,83 @@ AudacityProject& Au3WavePainter::projectRef() const
     return *project;
 }
 
-void Au3WavePainter::paint(QPainter& painter, const processing::ClipKey& clipKey, const Params& params)
+std::shared_ptr<WaveClip> Au3WavePainter::findClip(const processing::ClipKey& clipKey, WaveTrack*& waveTrack) const
 {
-    //! NOTE Please don't remove, need for debug
-    // if (!(clipKey.trackId == 2 && clipKey.index == 0)) {
-    //     return;
-    // }
-    // LOGD() << "trackId: " << clipKey.trackId << ", clip: " << clipKey.index;
-
     //! Pending tracks are same as project tracks, but with new tracks when recording, so we need draw them
     Track* track = &PendingTracks::Get(projectRef())
                    .SubstitutePendingChangedTrack(*DomAccessor::findWaveTrack(projectRef(), TrackId(clipKey.trackId)));
 
-    WaveTrack* waveTrack = dynamic_cast<WaveTrack*>(track);
+    waveTrack = dynamic_cast<WaveTrack*>(track);
     IF_ASSERT_FAILED(waveTrack) {
-        return;
+        return nullptr;
     }
 
     std::shared_ptr<WaveClip> clip = DomAccessor::findWaveClip(waveTrack, clipKey.index);
     IF_ASSERT_FAILED(clip) {
+        return nullptr;
+    }
+
+    return clip;
+}
+
+void Au3WavePainter::paint(QPainter& painter, const processing::ClipKey& clipKey, const Params& params)
+{
+    //! NOTE Please don't remove, need for debug
+    // if (!(clipKey.trackId == 2 && clipKey.index == 0)) {
+    //     return;
+    // }
+    // LOGD() << "trackId: " << clipKey.trackId << ", clip: " << clipKey.index;
+
+    WaveTrack* waveTrack = nullptr;
+    std::shared_ptr<WaveClip> clip = findClip(clipKey, waveTrack);
+    if (!clip) {
         return;
     }
 
     doPaint(painter, waveTrack, clip.get(), params);
 }
 
+std::vector<IAu3WavePainter::ColumnsBlock> Au3WavePainter::columns(const processing::ClipKey& clipKey, const Params& params)
+{
+    std::vector<ColumnsBlock> blocks;
+
+    WaveTrack* track = nullptr;
+    std::shared_ptr<WaveClip> clip = findClip(clipKey, track);
+    if (!clip) {
+        return blocks;
+    }
+
+    const Geometry& g = params.geometry;
+
+    //! NOTE Individual samples are not drawn yet, as in doPaint
+    if (g.width < CLIPVIEW_WIDTH_MIN || showIndividualSamples(*clip, params.zoom)) {
+        return blocks;
+    }
+
+    auto& settings = WaveformSettings::Get(*track);
+    const bool dB = !settings.isLinear();
+
+    float zoomMin, zoomMax;
+    WaveformScale::Get(*track).GetDisplayBounds(zoomMin, zoomMax);
+
+    WaveMetrics wm;
+    wm.zoom = params.zoom;
+    wm.fromTime = params.fromTime;
+    wm.toTime = params.toTime;
+    wm.height = g.height / static_cast<int>(clip->NChannels());
+    wm.width = g.width;
+    wm.left = g.left;
+    wm.top = 0.0;
+
+    auto& waveformPainter = WaveformPainter::Get(*clip);
+    for (unsigned i = 0; i < clip->NChannels(); ++i) {
+        waveformPainter.Columns(i, wm, zoomMin, zoomMax, dB, settings.dBRange, blocks);
+        wm.top += wm.height;
+    }
+
+    return blocks;
+}
+
 void Au3WavePainter::doPaint(QPainter& painter, const WaveTrack* _track, const WaveClip* clip, const Params& params)
 {
     auto sw = FrameStatistics::CreateStopwatch(FrameStatistics::SectionID::WaveformView);
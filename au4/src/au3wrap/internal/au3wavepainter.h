@@ -2,6 +2,8 @@
 
 #include "../iau3wavepainter.h"
 
+#include <memory>
+
 #include "modularity/ioc.h"
 #include "context/iglobalcontext.h"
 
@@ -17,9 +19,11 @@ public:
     Au3WavePainter() = default;
 
     void paint(QPainter& painter, const processing::ClipKey& clipKey, const Params& params) override;
+    std::vector<ColumnsBlock> columns(const processing::ClipKey& clipKey, const Params& params) override;
 
 private:
     AudacityProject& projectRef() const;
+    std::shared_ptr<WaveClip> findClip(const processing::ClipKey& clipKey, WaveTrack*& track) const;
     void doPaint(QPainter& painter, const WaveTrack* track, const WaveClip* clip, const Params& params);
 };
 }
@@ -23,6 +23,7 @@
 #include "view/clipsview/clipslistmodel.h"
 #include "view/clipsview/cliplistitem.h"
 #include "view/clipsview/waveview.h"
+#include "view/clipsview/gpuwaveview.h"
 #include "view/clipsview/clipcontextmenumodel.h"
 #include "view/clipsview/selectionviewcontroller.h"
 
@@ -103,6 +104,7 @@ void ProjectSceneModule::registerUiTypes()
     qmlRegisterType<ClipsListModel>("Audacity.ProjectScene", 1, 0, "ClipsListModel");
     qmlRegisterUncreatableType<ClipListItem>("Audacity.ProjectScene", 1, 0, "ClipListItem", "Not creatable from QML");
     qmlRegisterType<WaveView>("Audacity.ProjectScene", 1, 0, "WaveView");
+    qmlRegisterType<GpuWaveView>("Audacity.ProjectScene", 1, 0, "GpuWaveView");
     qmlRegisterType<ClipContextMenuModel>("Audacity.ProjectScene", 1, 0, "ClipContextMenuModel");
     qmlRegisterType<SelectionViewController>("Audacity.ProjectScene", 1, 0, "SelectionViewController");
 
@@ -217,7 +217,7 @@ Rectangle {
             }
         }
 
-        WaveView {
+        GpuWaveView {
             id: waveView
             anchors.top: (!root.collapsed && header.visible) ? header.bottom : parent.top
             anchors.left: parent.left
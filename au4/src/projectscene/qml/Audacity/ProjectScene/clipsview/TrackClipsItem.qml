@@ -25,7 +25,10 @@ Item {
         id: clipsModel
 
         onRequestClipTitleEdit: function(index){
-            repeator.itemAt(index).editTitle()
+            var loader = repeator.itemAt(index)
+            if (loader && loader.item) {
+                loader.item.editTitle()
+            }
         }
     }
 
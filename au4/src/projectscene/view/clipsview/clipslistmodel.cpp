@@ -3,6 +3,9 @@
 */
 #include "clipslistmodel.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "global/async/async.h"
 
 #include "types/projectscenetypes.h"
@@ -53,53 +56,103 @@ void ClipsListModel::reload()
         return c1.startTime < c2.startTime;
     });
 
+    //! NOTE Each change is applied to the rows it concerns, rather than by a reset
+    //! of the model, which would lay out all the clips of the track again
     m_allClipList.onItemChanged(this, [this](const Clip& clip) {
-        for (size_t i = 0; i < m_allClipList.size(); ++i) {
-            if (m_allClipList.at(i).key != clip.key) {
-                continue;
-            }
-            m_allClipList[i] = clip;
-            break;
+        onClipChanged(clip);
+    });
+
+    m_allClipList.onItemAdded(this, [this](const Clip& clip) {
+        onClipAdded(clip);
+    });
+
+    m_allClipList.onItemRemoved(this, [this](const Clip& clip) {
+        onClipRemoved(clip);
+    });
+
+    update();
+}
+
+int ClipsListModel::indexByKey(const processing::ClipKey& k) const
+{
+    for (size_t i = 0; i < m_allClipList.size(); ++i) {
+        if (m_allClipList.at(i).key == k) {
+            return static_cast<int>(i);
         }
+    }
+    return -1;
+}
 
-        // LOGDA() << "clip: " << clip.key << ", startTime: " << clip.startTime;
-        ClipListItem* item = itemByKey(clip.key);
-        if (item) {
-            item->setClip(clip);
+int ClipsListModel::rowByKey(const processing::ClipKey& k) const
+{
+    for (int row = 0; row < m_clipList.size(); ++row) {
+        if (m_clipList.at(row)->clip().key == k) {
+            return row;
         }
+    }
+    return -1;
+}
 
-        updateItemsMetrics();
-    });
+void ClipsListModel::onClipChanged(const Clip& clip)
+{
+    const int from = indexByKey(clip.key);
+    if (from < 0) {
+        return;
+    }
 
-    m_allClipList.onItemAdded(this, [this](const Clip& clip) {
-        ProcessingProjectPtr prj = globalContext()->currentProcessingProject();
-        muse::async::NotifyList<au::processing::Clip> newList = prj->clipList(m_trackId);
-        for (size_t i = 0; i < newList.size(); ++i) {
-            if (newList.at(i).key != clip.key) {
-                continue;
-            }
+    m_allClipList[from] = clip;
 
-            m_allClipList.insert(m_allClipList.begin() + i, clip);
+    //! NOTE A moved clip may have to change places, to keep the order by start time
+    const int size = static_cast<int>(m_allClipList.size());
+    int to = from;
+    while (to > 0 && m_allClipList.at(to - 1).startTime > clip.startTime) {
+        --to;
+    }
+    while (to + 1 < size && m_allClipList.at(to + 1).startTime < clip.startTime) {
+        ++to;
+    }
+    auto first = m_allClipList.begin();
+    if (to > from) {
+        std::rotate(first + from, first + from + 1, first + to + 1);
+    } else if (to < from) {
+        std::rotate(first + to, first + from, first + from + 1);
+    }
+    updateTimeIndex();
 
-            positionViewAtClip(clip);
+    if (ClipListItem* item = itemByKey(clip.key)) {
+        item->setClip(clip);
+        updateItemMetrics(item);
+    }
 
-            update();
+    //! NOTE The clip may come into the frame or leave it, or its row may move
+    updateVisibleItems();
+}
 
-            break;
-        }
+void ClipsListModel::onClipAdded(const Clip& clip)
+{
+    const auto it = std::upper_bound(m_allClipList.begin(), m_allClipList.end(), clip.startTime,
+                                     [](double startTime, const Clip& c) {
+        return startTime < c.startTime;
     });
+    m_allClipList.insert(it, clip);
+    updateTimeIndex();
 
-    m_allClipList.onItemRemoved(this, [this](const Clip& clip) {
-        for (auto it = m_allClipList.begin(); it != m_allClipList.end(); ++it) {
-            if (it->key == clip.key) {
-                m_allClipList.erase(it);
-                update();
-                break;
-            }
-        }
-    });
+    updateVisibleItems();
 
-    update();
+    positionViewAtClip(clip);
+}
+
+void ClipsListModel::onClipRemoved(const Clip& clip)
+{
+    const int index = indexByKey(clip.key);
+    if (index < 0) {
+        return;
+    }
+
+    m_allClipList.erase(m_allClipList.begin() + index);
+    updateTimeIndex();
+
+    updateVisibleItems();
 }
 
 ClipListItem* ClipsListModel::itemByKey(const processing::ClipKey& k) const
@@ -122,10 +175,12 @@ void ClipsListModel::update()
     beginResetModel();
 
     m_clipList.clear();
+    m_selectedItem = nullptr;
 
-    for (const au::processing::Clip& c : m_allClipList) {
+    updateTimeIndex();
+    for (size_t index : visibleClipIndexes()) {
         ClipListItem* item = new ClipListItem(this);
-        item->setClip(c);
+        item->setClip(m_allClipList.at(index));
         m_clipList.append(item);
     }
 
@@ -140,58 +195,155 @@ void ClipsListModel::update()
     });
 }
 
-void ClipsListModel::updateItemsMetrics()
+void ClipsListModel::updateTimeIndex()
 {
-    //! NOTE The first step is to calculate the position and width
+    m_maxEndTimes.resize(m_allClipList.size());
+    double maxEndTime = std::numeric_limits<double>::lowest();
+    for (size_t i = 0; i < m_allClipList.size(); ++i) {
+        maxEndTime = std::max(maxEndTime, m_allClipList.at(i).endTime);
+        m_maxEndTimes[i] = maxEndTime;
+    }
+}
+
+std::vector<size_t> ClipsListModel::visibleClipIndexes() const
+{
+    std::vector<size_t> indexes;
+    if (!m_context || m_allClipList.empty()) {
+        return indexes;
+    }
+
     const double cacheTime = CACHE_BUFFER_PX / m_context->zoom();
+    const double fromTime = m_context->frameStartTime() - cacheTime;
+    const double toTime = m_context->frameEndTime() + cacheTime;
+
+    //! NOTE No clip before the first whose greatest end time reaches the range ends in it,
+    //! and no clip after the last starting before the end of the range starts in it
+    const size_t first = std::lower_bound(m_maxEndTimes.begin(), m_maxEndTimes.end(), fromTime) - m_maxEndTimes.begin();
+    const size_t last = std::upper_bound(m_allClipList.begin(), m_allClipList.end(), toTime,
+                                         [](double time, const Clip& c) {
+        return time < c.startTime;
+    }) - m_allClipList.begin();
+
+    for (size_t i = first; i < last; ++i) {
+        //! NOTE A short clip may end before the range, under a longer one that reaches it
+        if (m_allClipList.at(i).endTime >= fromTime) {
+            indexes.push_back(i);
+        }
+    }
 
-    for (int i = 0; i < m_clipList.size(); ++i) {
-        ClipListItem* item = m_clipList[i];
-        const processing::Clip& clip = item->clip();
+    return indexes;
+}
 
-        ClipTime time;
-        time.clipStartTime = clip.startTime;
-        time.clipEndTime = clip.endTime;
-        time.itemStartTime = std::max(clip.startTime, (m_context->frameStartTime() - cacheTime));
-        time.itemEndTime = std::min(clip.endTime, (m_context->frameEndTime() + cacheTime));
+void ClipsListModel::updateVisibleItems()
+{
+    const std::vector<size_t> indexes = visibleClipIndexes();
+
+    auto isVisible = [this, &indexes](const processing::ClipKey& k) {
+        return std::any_of(indexes.begin(), indexes.end(), [this, &k](size_t index) {
+            return m_allClipList.at(index).key == k;
+        });
+    };
+
+    //! NOTE First the rows of the clips that left the frame are removed, a run of rows at a time
+    QList<ClipListItem*> removedList;
+    for (int row = static_cast<int>(m_clipList.size()) - 1; row >= 0; --row) {
+        if (isVisible(m_clipList.at(row)->clip().key)) {
+            continue;
+        }
+
+        int firstRow = row;
+        while (firstRow > 0 && !isVisible(m_clipList.at(firstRow - 1)->clip().key)) {
+            --firstRow;
+        }
 
-        item->setTime(time);
-        item->setX(m_context->timeToPosition(time.itemStartTime));
-        item->setWidth((time.itemEndTime - time.itemStartTime) * m_context->zoom());
+        beginRemoveRows(QModelIndex(), firstRow, row);
+        for (int i = firstRow; i <= row; ++i) {
+            ClipListItem* item = m_clipList.takeAt(firstRow);
+            if (m_selectedItem == item) {
+                m_selectedItem = nullptr;
+            }
+            removedList.append(item);
+        }
+        endRemoveRows();
 
-        // LOGDA() << "clip: " << clip.key
-        //         << ", clipStartTime: " << time.clipStartTime
-        //         << ", itemStartTime: " << time.itemStartTime
-        //         << ", item->x: " << item->x();
+        row = firstRow;
     }
 
-    //! NOTE The second step is to calculate the minimum and maximum movement.
-    for (int i = 0; i < m_clipList.size(); ++i) {
-        ClipListItem* item = m_clipList[i];
-
-        // MoveMaximumX
-        {
-            item->setMoveMaximumX(MOVE_MAX);
-
-            // int nextIdx = i + 1;
-            // if (nextIdx == m_clipList.size()) {
-            //     item->setMoveMaximumX(MOVE_MAX);
-            // } else {
-            //     const ClipListItem* next = m_clipList.at(nextIdx);
-            //     item->setMoveMaximumX(next->x() - item->width());
-            // }
+    //! NOTE Then the remaining rows are put in order, with rows for the clips that came into it
+    for (int row = 0; row < static_cast<int>(indexes.size()); ++row) {
+        const Clip& clip = m_allClipList.at(indexes.at(row));
+        if (row < m_clipList.size() && m_clipList.at(row)->clip().key == clip.key) {
+            continue;
         }
 
-        // MoveMinimumX
-        {
-            item->setMoveMaximumX(MOVE_MIN);
-            // if (i == 0) {
-            //     item->setMoveMaximumX(MOVE_MIN);
-            // } else {
-            //     const ClipListItem* prev = m_clipList.at(i - 1);
-            //     item->setMoveMinimumX(prev->x() + prev->width());
-            // }
+        const int from = rowByKey(clip.key);
+        if (from > row) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_clipList.move(from, row);
+            endMoveRows();
+            continue;
         }
+
+        beginInsertRows(QModelIndex(), row, row);
+        ClipListItem* item = new ClipListItem(this);
+        item->setClip(clip);
+        updateItemMetrics(item);
+        m_clipList.insert(row, item);
+        endInsertRows();
+    }
+
+    onSelectedClip(selectionController()->selectedClip());
+
+    if (removedList.isEmpty()) {
+        return;
+    }
+
+    //! NOTE Deleted later, otherwise there will be errors in Qml
+    muse::async::Async::call(this, [removedList]() {
+        qDeleteAll(removedList);
+    });
+}
+
+void ClipsListModel::updateItemsMetrics()
+{
+    for (ClipListItem* item : std::as_const(m_clipList)) {
+        updateItemMetrics(item);
+    }
+}
+
+void ClipsListModel::updateItemMetrics(ClipListItem* item)
+{
+    //! NOTE The first step is to calculate the position and width
+    const double cacheTime = CACHE_BUFFER_PX / m_context->zoom();
+
+    const processing::Clip& clip = item->clip();
+
+    ClipTime time;
+    time.clipStartTime = clip.startTime;
+    time.clipEndTime = clip.endTime;
+    time.itemStartTime = std::max(clip.startTime, (m_context->frameStartTime() - cacheTime));
+    time.itemEndTime = std::min(clip.endTime, (m_context->frameEndTime() + cacheTime));
+
+    item->setTime(time);
+    item->setX(m_context->timeToPosition(time.itemStartTime));
+    item->setWidth((time.itemEndTime - time.itemStartTime) * m_context->zoom());
+
+    // LOGDA() << "clip: " << clip.key
+    //         << ", clipStartTime: " << time.clipStartTime
+    //         << ", itemStartTime: " << time.itemStartTime
+    //         << ", item->x: " << item->x();
+
+    //! NOTE The second step is to calculate the minimum and maximum movement.
+    //! They don't depend on the neighbours yet, so each item can be updated alone
+
+    // MoveMaximumX
+    {
+        item->setMoveMaximumX(MOVE_MAX);
+    }
+
+    // MoveMinimumX
+    {
+        item->setMoveMaximumX(MOVE_MIN);
     }
 }
 
@@ -236,11 +388,13 @@ QVariant ClipsListModel::data(const QModelIndex& index, int role) const
 
 void ClipsListModel::onTimelineZoomChanged()
 {
+    updateVisibleItems();
     updateItemsMetrics();
 }
 
 void ClipsListModel::onTimelineFrameTimeChanged()
 {
+    updateVisibleItems();
     updateItemsMetrics();
 }
 
@@ -256,11 +410,22 @@ void ClipsListModel::onClipRenameAction(const muse::actions::ActionData& args)
         return;
     }
 
-    IF_ASSERT_FAILED(key.index < m_clipList.size()) {
+    //! NOTE The clip has a row only near the frame, so it may first have to be brought there
+    int row = rowByKey(key);
+    if (row < 0) {
+        const int index = indexByKey(key);
+        IF_ASSERT_FAILED(index >= 0) {
+            return;
+        }
+        positionViewAtClip(m_allClipList.at(index));
+        row = rowByKey(key);
+    }
+
+    IF_ASSERT_FAILED(row >= 0) {
         return;
     }
 
-    emit requestClipTitleEdit(key.index);
+    emit requestClipTitleEdit(row);
 }
 
 bool ClipsListModel::changeClipTitle(const ClipKey& key, const QString& newTitle)
@@ -5,6 +5,8 @@
 
 #include <QAbstractListModel>
 
+#include <vector>
+
 #include "modularity/ioc.h"
 #include "context/iglobalcontext.h"
 #include "processing/iprocessinginteraction.h"
@@ -77,15 +79,29 @@ private:
     };
 
     void update();
+    void updateTimeIndex();
+    std::vector<size_t> visibleClipIndexes() const;
+    void updateVisibleItems();
     void updateItemsMetrics();
+    void updateItemMetrics(ClipListItem* item);
+    void onClipChanged(const processing::Clip& clip);
+    void onClipAdded(const processing::Clip& clip);
+    void onClipRemoved(const processing::Clip& clip);
     void positionViewAtClip(const processing::Clip& clip);
     void onSelectedClip(const processing::ClipKey& k);
     void onClipRenameAction(const muse::actions::ActionData& args);
     ClipListItem* itemByKey(const processing::ClipKey& k) const;
+    int indexByKey(const processing::ClipKey& k) const;
+    int rowByKey(const processing::ClipKey& k) const;
 
     TimelineContext* m_context = nullptr;
     processing::TrackId m_trackId = -1;
+    //! NOTE All the clips of the track, in order of start time
     muse::async::NotifyList<au::processing::Clip> m_allClipList;
+    //! NOTE The greatest end time of the clips up to each one in m_allClipList,
+    //! so that the clips in a time range are found by binary searches
+    std::vector<double> m_maxEndTimes;
+    //! NOTE Items, which are the rows of the model, only for the clips near the frame
     QList<ClipListItem*> m_clipList;
     ClipListItem* m_selectedItem = nullptr;
 };
@@ -0,0 +1,368 @@
+/*
+* Audacity: A Digital Audio Editor
+*/
+#include "gpuwaveview.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGSimpleRectNode>
+#include <QSGTransformNode>
+
+#include "draw/types/color.h"
+
+#include "../timeline/timelinecontext.h"
+
+using namespace au::projectscene;
+
+using ColumnsBlock = au::au3::IAu3WavePainter::ColumnsBlock;
+using Column = au::au3::IAu3WavePainter::Column;
+
+static const QColor BACKGRAUND_COLOR = QColor(255, 255, 255);
+static const QColor SAMPLES_BASE_COLOR = QColor(0, 0, 0);
+static const QColor RMS_BASE_COLOR = QColor(255, 255, 255);
+static const QColor CLIPPED_COLOR = QColor(255, 0, 0);
+
+namespace {
+struct WaveColors {
+    QColor blank;
+    QColor sample;
+    QColor rms;
+};
+
+//! Same colors as WaveView
+WaveColors waveColors(const QColor& clipColor, bool selected)
+{
+    WaveColors colors;
+    if (selected) {
+        colors.blank = muse::draw::blendQColors(BACKGRAUND_COLOR, clipColor, 0.9);
+        colors.sample = muse::draw::blendQColors(colors.blank, SAMPLES_BASE_COLOR, 0.6);
+    } else {
+        colors.blank = muse::draw::blendQColors(BACKGRAUND_COLOR, clipColor, 0.8);
+        colors.sample = muse::draw::blendQColors(colors.blank, SAMPLES_BASE_COLOR, 0.8);
+    }
+    colors.rms = muse::draw::blendQColors(colors.sample, RMS_BASE_COLOR, 0.1);
+    return colors;
+}
+
+QSGGeometryNode* makeBandNode(const QColor& color)
+{
+    auto node = new QSGGeometryNode();
+
+    auto geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+    geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+    node->setGeometry(geometry);
+    node->setFlag(QSGNode::OwnsGeometry);
+
+    auto material = new QSGFlatColorMaterial();
+    material->setColor(color);
+    node->setMaterial(material);
+    node->setFlag(QSGNode::OwnsMaterial);
+
+    return node;
+}
+
+void setBandColor(QSGGeometryNode* node, const QColor& color)
+{
+    auto material = static_cast<QSGFlatColorMaterial*>(node->material());
+    if (material->color() != color) {
+        material->setColor(color);
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+}
+
+//! Two triangles per column, from top to bottom, at least one pixel high
+template<typename Band>
+void setBandGeometry(QSGGeometryNode* node, const std::vector<Column>& columns, double top, double height, Band band)
+{
+    int count = 0;
+    for (const Column& column : columns) {
+        if (band(column).first >= 0) {
+            ++count;
+        }
+    }
+
+    QSGGeometry* geometry = node->geometry();
+    geometry->allocate(count * 6);
+
+    QSGGeometry::Point2D* vertices = geometry->vertexDataAsPoint2D();
+    for (size_t x = 0; x < columns.size(); ++x) {
+        const auto [from, to] = band(columns[x]);
+        if (from < 0) {
+            continue;
+        }
+
+        const float left = static_cast<float>(x);
+        const float right = left + 1.0f;
+        const float y0 = static_cast<float>(top + from * height);
+        const float y1 = std::max(y0 + 1.0f, static_cast<float>(top + to * height));
+
+        vertices[0].set(left, y0);
+        vertices[1].set(right, y0);
+        vertices[2].set(left, y1);
+        vertices[3].set(right, y0);
+        vertices[4].set(right, y1);
+        vertices[5].set(left, y1);
+        vertices += 6;
+    }
+
+    node->markDirty(QSGNode::DirtyGeometry);
+}
+
+//! The columns of one block of the wave data cache
+class BlockNode : public QSGTransformNode
+{
+public:
+    BlockNode(const WaveColors& colors)
+    {
+        m_sampleNode = makeBandNode(colors.sample);
+        m_rmsNode = makeBandNode(colors.rms);
+        m_clippedNode = makeBandNode(CLIPPED_COLOR);
+
+        appendChildNode(m_sampleNode);
+        appendChildNode(m_rmsNode);
+        appendChildNode(m_clippedNode);
+    }
+
+    void update(const ColumnsBlock& block)
+    {
+        QMatrix4x4 matrix;
+        matrix.translate(block.left, 0.0);
+        if (matrix != this->matrix()) {
+            setMatrix(matrix);
+        }
+
+        if (block.columns == m_columns && block.top == m_top && block.height == m_height) {
+            return;
+        }
+
+        m_columns = block.columns;
+        m_top = block.top;
+        m_height = block.height;
+
+        setBandGeometry(m_sampleNode, m_columns, m_top, m_height, [](const Column& c) {
+            return std::make_pair(c.maxY, c.minY);
+        });
+        setBandGeometry(m_rmsNode, m_columns, m_top, m_height, [](const Column& c) {
+            return std::make_pair(c.rmsTopY, c.rmsBottomY);
+        });
+        setBandGeometry(m_clippedNode, m_columns, m_top, m_height, [](const Column& c) {
+            return c.clipped ? std::make_pair(0.0f, 1.0f) : std::make_pair(-1.0f, -1.0f);
+        });
+    }
+
+    void setColors(const WaveColors& colors)
+    {
+        setBandColor(m_sampleNode, colors.sample);
+        setBandColor(m_rmsNode, colors.rms);
+    }
+
+private:
+    QSGGeometryNode* m_sampleNode = nullptr;
+    QSGGeometryNode* m_rmsNode = nullptr;
+    QSGGeometryNode* m_clippedNode = nullptr;
+
+    std::vector<Column> m_columns;
+    double m_top = 0.0;
+    double m_height = 0.0;
+};
+
+class WaveRootNode : public QSGNode
+{
+public:
+    WaveRootNode()
+    {
+        m_background = new QSGSimpleRectNode();
+        appendChildNode(m_background);
+    }
+
+    void update(const QRectF& rect, const WaveColors& colors, const std::vector<ColumnsBlock>& blocks)
+    {
+        m_background->setRect(rect);
+        m_background->setColor(colors.blank);
+
+        std::map<std::pair<size_t, int64_t>, BlockNode*> nodes;
+        for (const ColumnsBlock& block : blocks) {
+            const auto key = std::make_pair(block.channel, block.firstColumn);
+
+            BlockNode* node = nullptr;
+            auto it = m_nodes.find(key);
+            if (it != m_nodes.end()) {
+                node = it->second;
+                m_nodes.erase(it);
+                node->setColors(colors);
+            } else {
+                node = new BlockNode(colors);
+                appendChildNode(node);
+            }
+
+            node->update(block);
+            nodes.emplace(key, node);
+        }
+
+        //! NOTE Blocks scrolled out of the view
+        for (auto& [key, node] : m_nodes) {
+            removeChildNode(node);
+            delete node;
+        }
+
+        m_nodes = std::move(nodes);
+    }
+
+private:
+    QSGSimpleRectNode* m_background = nullptr;
+    std::map<std::pair<size_t, int64_t>, BlockNode*> m_nodes;
+};
+}
+
+GpuWaveView::GpuWaveView(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+    setClip(true);
+}
+
+GpuWaveView::~GpuWaveView()
+{
+}
+
+void GpuWaveView::requestColumns()
+{
+    polish();
+    update();
+}
+
+void GpuWaveView::updatePolish()
+{
+    m_blocks.clear();
+
+    if (!m_context || width() <= 0 || height() <= 0) {
+        return;
+    }
+
+    au3::IAu3WavePainter::Params params;
+    params.geometry.height = height();
+    params.geometry.width = width();
+    params.geometry.left = 0.0;
+
+    params.zoom = m_context->zoom();
+    params.fromTime = (m_clipTime.itemStartTime - m_clipTime.clipStartTime);
+    params.toTime = params.fromTime + (m_clipTime.itemEndTime - m_clipTime.itemStartTime);
+
+    m_blocks = wavePainter()->columns(m_clipKey.key, params);
+}
+
+QSGNode* GpuWaveView::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+    auto root = static_cast<WaveRootNode*>(oldNode);
+    if (!root) {
+        root = new WaveRootNode();
+    }
+
+    root->update(boundingRect(), waveColors(m_clipColor, m_clipSelected), m_blocks);
+
+    return root;
+}
+
+void GpuWaveView::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size()) {
+        requestColumns();
+    }
+}
+
+ClipKey GpuWaveView::clipKey() const
+{
+    return m_clipKey;
+}
+
+void GpuWaveView::setClipKey(const ClipKey& newClipKey)
+{
+    m_clipKey = newClipKey;
+    emit clipKeyChanged();
+
+    requestColumns();
+}
+
+TimelineContext* GpuWaveView::timelineContext() const
+{
+    return m_context;
+}
+
+void GpuWaveView::setTimelineContext(TimelineContext* newContext)
+{
+    if (m_context == newContext) {
+        return;
+    }
+
+    if (m_context) {
+        disconnect(m_context, nullptr, this, nullptr);
+    }
+
+    m_context = newContext;
+
+    if (m_context) {
+        connect(m_context, &TimelineContext::frameTimeChanged, this, &GpuWaveView::onFrameTimeChanged);
+    }
+
+    emit timelineContextChanged();
+}
+
+void GpuWaveView::onFrameTimeChanged()
+{
+    requestColumns();
+}
+
+QColor GpuWaveView::clipColor() const
+{
+    return m_clipColor;
+}
+
+void GpuWaveView::setClipColor(const QColor& newClipColor)
+{
+    if (m_clipColor == newClipColor) {
+        return;
+    }
+    m_clipColor = newClipColor;
+    emit clipColorChanged();
+
+    update();
+}
+
+bool GpuWaveView::clipSelected() const
+{
+    return m_clipSelected;
+}
+
+void GpuWaveView::setClipSelected(bool newClipSelected)
+{
+    if (m_clipSelected == newClipSelected) {
+        return;
+    }
+    m_clipSelected = newClipSelected;
+    emit clipSelectedChanged();
+
+    //! NOTE Only the colors change
+    update();
+}
+
+ClipTime GpuWaveView::clipTime() const
+{
+    return m_clipTime;
+}
+
+void GpuWaveView::setClipTime(const ClipTime& newClipTime)
+{
+    if (m_clipTime == newClipTime) {
+        return;
+    }
+    m_clipTime = newClipTime;
+    emit clipTimeChanged();
+
+    requestColumns();
+}
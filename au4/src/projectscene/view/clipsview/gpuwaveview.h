@@ -0,0 +1,78 @@
+/*
+* Audacity: A Digital Audio Editor
+*/
+#pragma once
+
+#include <QQuickItem>
+
+#include <vector>
+
+#include "modularity/ioc.h"
+#include "au3wrap/iau3wavepainter.h"
+
+#include "types/projectscenetypes.h"
+#include "../timeline/timelinecontext.h"
+
+namespace au::projectscene {
+//! Draws the waveform of a clip in the scene graph, from the columns of the
+//! wave painter, instead of painting it on the CPU like WaveView
+/*!
+ Each block of columns of the wave data cache is a node, whose geometry is
+ uploaded again only when its columns change; scrolling moves the nodes, and
+ selecting the clip changes only the colors.
+ Requires a hardware scene graph backend.
+ */
+class GpuWaveView : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(TimelineContext * context READ timelineContext WRITE setTimelineContext NOTIFY timelineContextChanged FINAL)
+    Q_PROPERTY(ClipKey clipKey READ clipKey WRITE setClipKey NOTIFY clipKeyChanged FINAL)
+    Q_PROPERTY(QColor clipColor READ clipColor WRITE setClipColor NOTIFY clipColorChanged FINAL)
+    Q_PROPERTY(bool clipSelected READ clipSelected WRITE setClipSelected NOTIFY clipSelectedChanged FINAL)
+
+    Q_PROPERTY(ClipTime clipTime READ clipTime WRITE setClipTime NOTIFY clipTimeChanged FINAL)
+
+    muse::Inject<au3::IAu3WavePainter> wavePainter;
+
+public:
+    GpuWaveView(QQuickItem* parent = nullptr);
+    ~GpuWaveView() override;
+
+    TimelineContext* timelineContext() const;
+    void setTimelineContext(TimelineContext* newContext);
+    ClipKey clipKey() const;
+    void setClipKey(const ClipKey& newClipKey);
+    QColor clipColor() const;
+    void setClipColor(const QColor& newClipColor);
+    bool clipSelected() const;
+    void setClipSelected(bool newClipSelected);
+    ClipTime clipTime() const;
+    void setClipTime(const ClipTime& newClipTime);
+
+signals:
+    void timelineContextChanged();
+    void clipKeyChanged();
+    void clipColorChanged();
+    void clipTimeChanged();
+    void clipSelectedChanged();
+
+protected:
+    void updatePolish() override;
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+
+private:
+
+    void onFrameTimeChanged();
+    void requestColumns();
+
+    TimelineContext* m_context = nullptr;
+    ClipKey m_clipKey;
+    QColor m_clipColor;
+    bool m_clipSelected = false;
+    ClipTime m_clipTime;
+
+    //! Collected in the GUI thread by updatePolish, for updatePaintNode
+    std::vector<au3::IAu3WavePainter::ColumnsBlock> m_blocks;
+};
+}
@@ -1,5 +1,8 @@
 #include "playcursorcontroller.h"
 
+#include <QQuickItem>
+#include <QQuickWindow>
+
 using namespace au::projectscene;
 using namespace muse::actions;
 
@@ -22,6 +25,49 @@ void PlayCursorController::init()
     playbackState()->playbackPositionChanged().onReceive(this, [this](audio::secs_t secs) {
         updatePositionX(secs);
     });
+
+    //! NOTE While playing, the position is taken once for each frame that the window
+    //! renders, so that the cursor moves in step with the display
+    playbackState()->playbackStatusChanged().onReceive(this, [this](audio::PlaybackStatus) {
+        if (m_window && isPlaying()) {
+            m_window->update();
+        }
+    });
+
+    if (QQuickItem* item = qobject_cast<QQuickItem*>(parent())) {
+        connect(item, &QQuickItem::windowChanged, this, &PlayCursorController::onWindowChanged);
+        onWindowChanged(item->window());
+    }
+}
+
+bool PlayCursorController::isPlaying() const
+{
+    return playbackState()->playbackStatus() == audio::PlaybackStatus::Running;
+}
+
+void PlayCursorController::onWindowChanged(QQuickWindow* window)
+{
+    if (m_window) {
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+
+    m_window = window;
+
+    if (m_window) {
+        connect(m_window, &QQuickWindow::afterAnimating, this, &PlayCursorController::onWindowFrame);
+    }
+}
+
+void PlayCursorController::onWindowFrame()
+{
+    if (!isPlaying()) {
+        return;
+    }
+
+    updatePositionX(playbackState()->playbackPosition());
+
+    //! NOTE Asks for the next frame, which the render loop paces to the display
+    m_window->update();
 }
 
 void PlayCursorController::seekToX(double x)
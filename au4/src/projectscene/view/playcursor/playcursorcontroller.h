@@ -1,6 +1,9 @@
 #pragma once
 
 #include <QObject>
+#include <QPointer>
+
+class QQuickWindow;
 
 #include "global/async/asyncable.h"
 
@@ -38,6 +41,8 @@ signals:
 
 private slots:
     void onFrameTimeChanged();
+    void onWindowChanged(QQuickWindow* window);
+    void onWindowFrame();
 
 private:
 
@@ -46,7 +51,10 @@ private:
     void updatePositionX(audio::secs_t secs);
     void insureVisible(audio::secs_t secs);
 
+    bool isPlaying() const;
+
     TimelineContext* m_context = nullptr;
+    QPointer<QQuickWindow> m_window;
     double m_positionX = 0.0;
 };
 }
@@ -3461,6 +3461,30 @@ void Alg_iterator::begin_seq(Alg_seq_ptr s, void *cookie, double offset)
 }
 
 
+void Alg_iterator::begin_seq(Alg_seq_ptr s, void *cookie, double offset,
+                             double start_time)
+{
+    int i;
+    for (i = 0; i < s->track_list.length(); i++) {
+        Alg_events &events = s->track_list[i];
+        // events are in time order: find the first at or after start_time
+        int low = 0;
+        int high = events.length();
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (events[mid]->time + offset < start_time) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low < events.length()) {
+            insert(&events, low, true, cookie, offset);
+        }
+    }
+}
+
+
 Alg_event_ptr Alg_iterator::next(bool *note_on, void **cookie_ptr, 
                                  double *offset_ptr, double end_time)
     // return the next event in time from any track
@@ -1007,6 +1007,11 @@ public:
     // sequence to be included in the iteration unless you call begin()
     // (see below).
     void begin_seq(Alg_seq_ptr s, void *cookie = NULL, double offset = 0.0);
+    // Like begin_seq(), but skip the events of s that start before
+    // start_time (which includes the offset), finding the first one of
+    // each track by binary search rather than by iterating
+    void begin_seq(Alg_seq_ptr s, void *cookie, double offset,
+                   double start_time);
     ~Alg_iterator();
     // Prepare to enumerate events in order. If note_off_flag is true, then
     // iteration_next will merge note-off events into the sequence. If you
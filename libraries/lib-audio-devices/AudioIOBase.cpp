@@ -17,6 +17,7 @@ Paul Licameli split from AudioIO.cpp
 #include <wx/sstream.h>
 #include <wx/txtstrm.h>
 
+#include "DeviceManager.h"
 #include "IteratorX.h"
 #include "Meter.h"
 #include "Prefs.h"
@@ -118,6 +119,8 @@ void AudioIOBase::HandleDeviceChange()
    if (IsStreamActive())
       return;
 
+   DeviceManager::Instance()->WaitForScan();
+
    // get the selected record and playback devices
    const int playDeviceNum = getPlayDevIndex();
    const int recDeviceNum = getRecordDevIndex();
@@ -377,6 +380,8 @@ std::vector<long> AudioIOBase::GetSupportedPlaybackRates(int devIndex, double ra
       devIndex = getPlayDevIndex();
    }
 
+   DeviceManager::Instance()->WaitForScan();
+
    // Check if we can use the cached rates
    if (mCachedPlaybackIndex != -1 && devIndex == mCachedPlaybackIndex
          && (rate == 0.0 || make_iterator_range(mCachedPlaybackRates).contains(rate)))
@@ -442,6 +447,8 @@ std::vector<long> AudioIOBase::GetSupportedCaptureRates(int devIndex, double rat
       devIndex = getRecordDevIndex();
    }
 
+   DeviceManager::Instance()->WaitForScan();
+
    // Check if we can use the cached rates
    if (mCachedCaptureIndex != -1 && devIndex == mCachedCaptureIndex
          && (rate == 0.0 || make_iterator_range(mCachedCaptureRates).contains(rate)))
@@ -705,6 +712,7 @@ wxString AudioIOBase::GetDeviceInfo() const
          .Translation();
    }
 
+   DeviceManager::Instance()->WaitForScan();
 
    // FIXME: TRAP_ERR PaErrorCode not handled.  3 instances in GetDeviceInfo().
    int recDeviceNum = Pa_GetDefaultInputDevice();
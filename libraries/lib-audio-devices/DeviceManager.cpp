@@ -37,12 +37,14 @@ DeviceManager* DeviceManager::Instance()
 
 const std::vector<DeviceSourceMap> &DeviceManager::GetInputDeviceMaps()
 {
+   WaitForScan();
    if (!m_inited)
       Init();
    return mInputDeviceSourceMaps;
 }
 const std::vector<DeviceSourceMap> &DeviceManager::GetOutputDeviceMaps()
 {
+   WaitForScan();
    if (!m_inited)
       Init();
    return mOutputDeviceSourceMaps;
@@ -61,6 +63,7 @@ wxString MakeDeviceSourceString(const DeviceSourceMap *map)
 
 DeviceSourceMap* DeviceManager::GetDefaultDevice(int hostIndex, int isInput)
 {
+   WaitForScan();
    if (hostIndex < 0 || hostIndex >= Pa_GetHostApiCount()) {
       return NULL;
    }
@@ -233,10 +236,34 @@ static void AddSources(int deviceIndex, int rate, std::vector<DeviceSourceMap> *
    }
 }
 
+static void ScanDevices(
+   std::vector<DeviceSourceMap> &inputMaps,
+   std::vector<DeviceSourceMap> &outputMaps)
+{
+   // FIXME: TRAP_ERR PaErrorCode not handled in ReScan()
+   int nDevices = Pa_GetDeviceCount();
+
+   //The hierarchy for devices is Host/device/source.
+   //Some newer systems aggregate this.
+   //So we need to call port mixer for every device to get the sources
+   for (int i = 0; i < nDevices; i++) {
+      const PaDeviceInfo *info = Pa_GetDeviceInfo(i);
+      if (info->maxOutputChannels > 0) {
+         AddSources(i, info->defaultSampleRate, &outputMaps, 0);
+      }
+
+      if (info->maxInputChannels > 0) {
+         AddSources(i, info->defaultSampleRate, &inputMaps, 1);
+      }
+   }
+}
+
 /// Gets a NEW list of devices by terminating and restarting portaudio
 /// Assumes that DeviceManager is only used on the main thread.
 void DeviceManager::Rescan()
 {
+   WaitForScan();
+
    // get rid of the previous scan info
    this->mInputDeviceSourceMaps.clear();
    this->mOutputDeviceSourceMaps.clear();
@@ -262,22 +289,7 @@ void DeviceManager::Rescan()
       Pa_Initialize();
    }
 
-   // FIXME: TRAP_ERR PaErrorCode not handled in ReScan()
-   int nDevices = Pa_GetDeviceCount();
-
-   //The hierarchy for devices is Host/device/source.
-   //Some newer systems aggregate this.
-   //So we need to call port mixer for every device to get the sources
-   for (int i = 0; i < nDevices; i++) {
-      const PaDeviceInfo *info = Pa_GetDeviceInfo(i);
-      if (info->maxOutputChannels > 0) {
-         AddSources(i, info->defaultSampleRate, &mOutputDeviceSourceMaps, 0);
-      }
-
-      if (info->maxInputChannels > 0) {
-         AddSources(i, info->defaultSampleRate, &mInputDeviceSourceMaps, 1);
-      }
-   }
+   ScanDevices(mInputDeviceSourceMaps, mOutputDeviceSourceMaps);
 
    // If this was not an initial scan update each device toolbar.
    if ( m_inited )
@@ -287,6 +299,26 @@ void DeviceManager::Rescan()
    mRescanTime = std::chrono::steady_clock::now();
 }
 
+void DeviceManager::StartScan()
+{
+   if (m_inited || mScanThread.joinable())
+      return;
+   // Nothing else reads the maps until WaitForScan()
+   mScanThread = std::thread{ [this]{
+      ScanDevices(mInputDeviceSourceMaps, mOutputDeviceSourceMaps);
+   } };
+}
+
+void DeviceManager::WaitForScan()
+{
+   if (!mScanThread.joinable())
+      return;
+   mScanThread.join();
+   m_inited = true;
+   mRescanTime = std::chrono::steady_clock::now();
+   FinishInit();
+}
+
 
 std::chrono::duration<float> DeviceManager::GetTimeSinceRescan() {
    auto now = std::chrono::steady_clock::now();
@@ -309,13 +341,18 @@ DeviceManager::DeviceManager()
 
 DeviceManager::~DeviceManager()
 {
-
+   if (mScanThread.joinable())
+      mScanThread.join();
 }
 
 void DeviceManager::Init()
 {
     Rescan();
+    FinishInit();
+}
 
+void DeviceManager::FinishInit()
+{
 #if defined(EXPERIMENTAL_DEVICE_CHANGE_HANDLER)
 #if defined(HAVE_DEVICE_CHANGE)
    DeviceChangeHandler::Enable(true);
@@ -19,6 +19,7 @@
 #define __AUDACITY_DEVICEMANAGER__
 
 #include <chrono>
+#include <thread>
 #include <vector>
 
 #include <wx/string.h> // member variables
@@ -54,6 +55,15 @@ class AUDIO_DEVICES_API DeviceManager final
    /// Assumes that DeviceManager is only used on the main thread.
    void Rescan();
 
+   /// Begins the initial scan on a worker thread, so that the startup need
+   /// not wait for slow drivers.  Call after AudioIO is initialized.
+   void StartScan();
+
+   /// Blocks until the scan that StartScan began is done.
+   /// PortAudio is not reentrant:  call this before using it otherwise on the
+   /// main thread, except to query device information.
+   void WaitForScan();
+
    // Time since devices scanned in seconds.
    std::chrono::duration<float> GetTimeSinceRescan();
 
@@ -80,6 +90,7 @@ private:
    /// Does an initial scan.
    /// Called by GetInputDeviceMaps and GetOutputDeviceMaps when needed.
    void Init();
+   void FinishInit();
 
    DeviceSourceMap* GetDefaultDevice(int hostIndex, int isInput);
 
@@ -88,6 +99,8 @@ private:
    std::vector<DeviceSourceMap> mInputDeviceSourceMaps;
    std::vector<DeviceSourceMap> mOutputDeviceSourceMaps;
 
+   std::thread mScanThread;
+
    static DeviceManager dm;
 };
 
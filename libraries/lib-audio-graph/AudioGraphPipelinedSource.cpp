@@ -0,0 +1,196 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioGraphPipelinedSource.cpp
+
+**********************************************************************/
+
+#include "AudioGraphPipelinedSource.h"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+AudioGraph::PipelinedSource::PipelinedSource(Source &upstream,
+   unsigned nChannels, size_t blockSize, size_t nBuffered, size_t nBlocks,
+   Poller pollConsumer
+)  : mUpstream{ upstream }
+   , mBuffers{ nChannels, blockSize, nBuffered }
+   , mNBlocks{ nBlocks }
+   , mPollConsumer{ move(pollConsumer) }
+   , mTerminates{ upstream.Terminates() }
+{
+   assert(nBlocks > 0);
+   assert(upstream.AcceptsBuffers(mBuffers));
+   assert(upstream.AcceptsBlockSize(blockSize));
+}
+
+AudioGraph::PipelinedSource::~PipelinedSource()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStopping = true;
+   }
+   mFreeCondition.notify_one();
+   if (mThread.joinable())
+      mThread.join();
+}
+
+bool AudioGraph::PipelinedSource::AcceptsBuffers(const Buffers &buffers) const
+{
+   return buffers.Channels() >= mBuffers.Channels();
+}
+
+bool AudioGraph::PipelinedSource::AcceptsBlockSize(size_t) const
+{
+   return true;
+}
+
+std::optional<size_t>
+AudioGraph::PipelinedSource::Acquire(Buffers &data, size_t bound)
+{
+   assert(AcceptsBuffers(data));
+   assert(bound <= data.BlockSize());
+   assert(data.BlockSize() <= data.Remaining());
+
+   std::unique_lock<std::mutex> lock{ mMutex };
+   if (!mStarted) {
+      // Start the worker only now, so that upstream may be reinitialized
+      // after construction
+      mStarted = true;
+      mUpstreamRemaining = mUpstream.Remaining();
+      for (size_t ii = 0; ii < mNBlocks; ++ii) {
+         auto &block = mBlocks.emplace_back();
+         block.channels.resize(mBuffers.Channels(),
+            std::vector<float>(mBuffers.BlockSize()));
+         mFree.push_back(&block);
+      }
+      mThread = std::thread{ [this]{ Loop(); } };
+   }
+
+   // Gather up to the bound from as many blocks as needed
+   size_t result = 0;
+   while (result < bound) {
+      mFilledCondition.wait(lock,
+         [this]{ return !mFilled.empty() || mFinished; });
+      if (mFailed) {
+         if (auto pException = std::exchange(mpException, nullptr))
+            std::rethrow_exception(pException);
+         return {};
+      }
+      if (mFilled.empty())
+         // Upstream is exhausted
+         break;
+
+      // The worker only appends to mFilled, so this block stays put
+      auto &block = *mFilled.front();
+      const auto count = std::min(bound - result, block.end - block.start);
+      lock.unlock();
+      for (size_t iChannel = 0; iChannel < block.channels.size(); ++iChannel)
+         std::copy_n(block.channels[iChannel].data() + block.start, count,
+            &data.GetWritePosition(iChannel) + result);
+      lock.lock();
+
+      block.start += count;
+      result += count;
+      mQueued -= count;
+      if (block.start == block.end) {
+         mFilled.pop_front();
+         mFree.push_back(&block);
+         mFreeCondition.notify_one();
+      }
+   }
+   mLastProduced += result;
+   return { result };
+}
+
+sampleCount AudioGraph::PipelinedSource::Remaining() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (!mStarted)
+      return mUpstream.Remaining();
+   return mLastProduced + mQueued + mUpstreamRemaining;
+}
+
+bool AudioGraph::PipelinedSource::Release()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mLastProduced = 0;
+   }
+   return !mPollConsumer || mPollConsumer();
+}
+
+bool AudioGraph::PipelinedSource::Terminates() const
+{
+   return mTerminates;
+}
+
+auto AudioGraph::PipelinedSource::WaitForFree() -> Block *
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   mFreeCondition.wait(lock, [this]{ return mStopping || !mFree.empty(); });
+   if (mStopping)
+      return nullptr;
+   const auto pBlock = mFree.front();
+   mFree.pop_front();
+   return pBlock;
+}
+
+void AudioGraph::PipelinedSource::Loop()
+{
+   // Like Task::RunLoop(), with a sink that copies into the queue
+   bool ok = false;
+   try {
+      mBuffers.Rewind();
+      const auto blockSize = mBuffers.BlockSize();
+      while (true) {
+         const auto oResult = mUpstream.Acquire(mBuffers, blockSize);
+         if (!oResult)
+            break;
+         const auto count = *oResult;
+         if (count == 0) {
+            ok = true;
+            break;
+         }
+
+         const auto pBlock = WaitForFree();
+         if (!pBlock)
+            return;
+         for (size_t iChannel = 0; iChannel < pBlock->channels.size();
+            ++iChannel
+         ) {
+            // Production is at the positions, not yet advanced
+            const auto pSamples = mBuffers.Positions()[iChannel];
+            std::copy_n(pSamples, count, pBlock->channels[iChannel].data());
+         }
+         pBlock->start = 0;
+         pBlock->end = count;
+
+         mBuffers.Advance(count);
+         // Release upstream before publishing the block, so that the
+         // consumer sees a consistent Remaining()
+         const bool released = mUpstream.Release();
+         const auto remaining = mUpstream.Remaining();
+         if (mBuffers.Remaining() < blockSize)
+            // Keep any further production, and the minimum availability
+            mBuffers.Rotate();
+
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mFilled.push_back(pBlock);
+         mQueued += count;
+         mUpstreamRemaining = remaining;
+         mFilledCondition.notify_one();
+         if (!released)
+            break;
+      }
+   }
+   catch (...) {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mpException = std::current_exception();
+   }
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mFinished = true;
+   mFailed = !ok;
+   mFilledCondition.notify_one();
+}
@@ -0,0 +1,108 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioGraphPipelinedSource.h
+  @brief Source that runs another Source in a worker thread, ahead of need
+
+**********************************************************************/
+#ifndef __AUDACITY_AUDIO_GRAPH_PIPELINED_SOURCE__
+#define __AUDACITY_AUDIO_GRAPH_PIPELINED_SOURCE__
+
+#include "AudioGraphBuffers.h"
+#include "AudioGraphSource.h" // to inherit
+#include "SampleCount.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace AudioGraph {
+
+//! Decouples a Source from its consumer with a bounded queue of blocks, so
+//! that the two run concurrently in a pipeline
+/*!
+ The upstream is acquired (and released) in a worker thread started by the
+ first Acquire(), into Buffers of this object.  Chaining several of these
+ overlaps reading, each stage of processing, and the final Sink.
+
+ Exceptions in the worker are rethrown by Acquire() on the consumer's thread.
+ Acquire() fills its bound unless the upstream is exhausted, as a Source
+ consumed directly would.
+ */
+class AUDIO_GRAPH_API PipelinedSource final : public Source {
+public:
+   //! Type of function called in the consumer's thread by Release(), and
+   //! returning false to fail
+   using Poller = std::function<bool()>;
+
+   /*!
+    @param nChannels how many channels of upstream production to pass on;
+       other channels of Buffers given to Acquire() are left unchanged
+    @param nBlocks how many blocks of production may be queued
+    @pre `nChannels > 0`
+    @pre `blockSize > 0`
+    @pre `nBuffered > 0`
+    @pre `nBlocks > 0`
+    @pre `upstream.AcceptsBuffers(Buffers{ nChannels, blockSize, nBuffered })`
+    @pre `upstream.AcceptsBlockSize(blockSize)`
+    */
+   PipelinedSource(Source &upstream, unsigned nChannels, size_t blockSize,
+      size_t nBuffered, size_t nBlocks = 4, Poller pollConsumer = {});
+   //! Stops the worker, which finishes at most one more block
+   ~PipelinedSource() override;
+
+   //! Accepts buffers with at least as many channels as passed on
+   bool AcceptsBuffers(const Buffers &buffers) const override;
+   //! Always true
+   bool AcceptsBlockSize(size_t blockSize) const override;
+   std::optional<size_t> Acquire(Buffers &data, size_t bound) override;
+   sampleCount Remaining() const override;
+   //! Calls the poller, if any
+   bool Release() override;
+   //! Same as for upstream
+   bool Terminates() const override;
+
+private:
+   struct Block {
+      std::vector<std::vector<float>> channels;
+      size_t start{};
+      size_t end{};
+   };
+
+   void Loop();
+   //! Take a free block for the worker
+   //! @return null if stopping
+   Block *WaitForFree();
+
+   Source &mUpstream;
+   Buffers mBuffers;
+   const size_t mNBlocks;
+   const Poller mPollConsumer;
+   const bool mTerminates;
+
+   mutable std::mutex mMutex;
+   std::condition_variable mFilledCondition, mFreeCondition;
+   std::thread mThread;
+   //! All blocks, in stable storage
+   std::deque<Block> mBlocks;
+   std::deque<Block*> mFilled, mFree;
+   //! Samples in mFilled not yet acquired
+   sampleCount mQueued{ 0 };
+   //! Last value of Remaining() of upstream, from the worker
+   sampleCount mUpstreamRemaining{ 0 };
+   //! Total of Acquire() results since the last Release()
+   size_t mLastProduced{ 0 };
+   std::exception_ptr mpException;
+   bool mStarted{ false };
+   //! Whether the worker has finished
+   bool mFinished{ false };
+   //! Whether the worker finished because of failure
+   bool mFailed{ false };
+   bool mStopping{ false };
+};
+
+}
+#endif
@@ -107,7 +107,9 @@ time warp info and AudioIOListener and whether the playback is looped.
 #include "Decibels.h"
 #include "Prefs.h"
 #include "Project.h"
+#include "TempDirectory.h"
 #include "TransactionScope.h"
+#include "Tracing.h"
 
 #include "RealtimeEffectManager.h"
 #include "QualitySettings.h"
@@ -115,6 +117,8 @@ time warp info and AudioIOListener and whether the playback is looped.
 
 #include "Gain.h"
 
+#include "concurrency/ThreadPriority.h"
+
 #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
    #define LOWER_BOUND 0.0
    #define UPPER_BOUND 1.0
@@ -148,6 +152,8 @@ struct AudioIoCallback::TransportState {
                assert(false);
                continue;
             }
+            if (vt->IncludesRealtimeEffects())
+               continue;
             mpRealtimeInitialization
                ->AddGroup(*pGroup, numPlaybackChannels, sampleRate);
          }
@@ -308,7 +314,36 @@ AudioIO::AudioIO()
 
 void AudioIO::StartThread()
 {
-   mAudioThread = std::thread(AudioThread, ref(mFinishAudioThread));
+   // Read preferences in this thread, and apply them in the new one
+   const auto realtime = AudioIORealtimeAudioThread.Read();
+   const auto cores = AudioIOAudioThreadCores.Read().ToStdString();
+   mAudioThread = std::thread([this, realtime, cores]{
+      ConfigureAudioThread(realtime, cores);
+      AudioThread(mFinishAudioThread);
+   });
+}
+
+void AudioIO::ConfigureAudioThread(bool realtime, const std::string &cores)
+{
+   using namespace audacity::concurrency;
+   if (realtime) {
+      RealtimeThreadOptions options;
+      // Match the default SleepInterval of PlaybackPolicy
+      options.period = std::chrono::milliseconds{ 10 };
+      if (const auto result = SetCurrentThreadRealtime(options))
+         wxLogMessage("Audio thread scheduling: %s", result.message);
+      else
+         wxLogWarning(
+            "Audio thread could not get real-time scheduling: %s",
+            result.message);
+   }
+   if (const auto coreList = ParseCoreList(cores); !coreList.empty()) {
+      if (const auto result = SetCurrentThreadAffinity(coreList))
+         wxLogMessage("Audio thread pinned to processors %s", cores);
+      else
+         wxLogWarning("Audio thread could not be pinned to processors %s: %s",
+            cores, result.message);
+   }
 }
 
 AudioIO::~AudioIO()
@@ -318,6 +353,8 @@ AudioIO::~AudioIO()
       // be prepared anyway
       ResetOwningProject();
 
+   DeviceManager::Instance()->WaitForScan();
+
 #if defined(USE_PORTMIXER)
    if (mPortMixer) {
       #if __WXMAC__
@@ -473,6 +510,8 @@ static PaSampleFormat AudacityToPortAudioSampleFormat(sampleFormat format)
 bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
    unsigned int numPlaybackChannels, unsigned int numCaptureChannels)
 {
+   DeviceManager::Instance()->WaitForScan();
+
    auto sampleRate = options.rate;
    mNumPauseFrames = 0;
    SetOwningProject( options.pProject );
@@ -708,6 +747,7 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
          if (mUsingAlsa)
             mHardwarePlaybackLatencyFrames *= 3;
 #endif
+         mMonitoringPath.Prepare(mRate, mNumCaptureChannels);
          break;
       }
       wxLogDebug("Attempt %u to open capture stream failed with: %d", 1 + tries, mLastPaError);
@@ -872,6 +912,9 @@ int AudioIO::StartStream(const TransportSequences &sequences,
 
    gPrefs->Read(wxT("/AudioIO/SWPlaythrough"), &mSoftwarePlaythrough, false);
    mPauseRec = SoundActivatedRecord.Read();
+   mEventDrivenAudioThread = AudioIOEventDrivenThread.Read();
+   mTelemetry.SetEnabled(AudioIOTelemetryEnabled.Read());
+   mTelemetry.Reset();
    gPrefs->Read(wxT("/AudioIO/Microfades"), &mbMicroFades, false);
    int silenceLevelDB;
    gPrefs->Read(wxT("/AudioIO/SilenceLevel"), &silenceLevelDB, -50);
@@ -1008,6 +1051,8 @@ int AudioIO::StartStream(const TransportSequences &sequences,
          return 0;
    }
 
+   StartCaptureSpill();
+
    mpTransportState = std::make_unique<TransportState>(mOwningProject,
       mPlaybackSequences, mNumPlaybackChannels, mRate);
 
@@ -1031,6 +1076,7 @@ int AudioIO::StartStream(const TransportSequences &sequences,
 
    // Now that we are done with AllocateBuffers() and SetSequenceTime():
    mPlaybackSchedule.mTimeQueue.Prime(mPlaybackSchedule.GetSequenceTime());
+   mPlaybackClock.Reset(mPlaybackSchedule.GetSequenceTime());
    // else recording only without overdub
 
    // We signal the audio thread to call SequenceBufferExchange, to prime the RingBuffers
@@ -1163,6 +1209,22 @@ void AudioIO::CallAfterRecording(PostRecordingAction action)
    BasicUI::CallAfter(move(action));
 }
 
+namespace {
+//! Whether the master, or any of the sequences, has realtime effects
+bool HasRealtimeEffects(const AudacityProject *pProject,
+   const ConstPlayableSequences &sequences)
+{
+   if (pProject && RealtimeEffectList::Get(*pProject).GetStatesCount() > 0)
+      return true;
+   return std::any_of(sequences.begin(), sequences.end(),
+      [](const auto &pSequence){
+         const auto pGroup = pSequence && !pSequence->IncludesRealtimeEffects()
+            ? pSequence->FindChannelGroup() : nullptr;
+         return pGroup && RealtimeEffectList::Get(*pGroup).GetStatesCount() > 0;
+      });
+}
+}
+
 bool AudioIO::AllocateBuffers(
    const AudioIOStartStreamOptions &options,
    const TransportSequences &sequences, double t0, double t1, double sampleRate)
@@ -1175,6 +1237,22 @@ bool AudioIO::AllocateBuffers(
    auto &policy = mPlaybackSchedule.GetPolicy();
    auto times = policy.SuggestedBufferTimes(mPlaybackSchedule);
 
+   // Nothing plays live through realtime effects, so their output may be
+   // rendered further ahead, leaving more time for heavy chains
+   if (const auto lookAhead = AudioIORealtimeEffectsLookAhead.Read();
+      lookAhead > 0 && policy.AllowLookAhead(mPlaybackSchedule) &&
+      HasRealtimeEffects(mOwningProject.lock().get(),
+         sequences.playbackSequences)
+   ) {
+      const PlaybackPolicy::Duration duration{ lookAhead };
+      if (times.latency < duration) {
+         times.latency = duration;
+         // Leave room for a batch on top of the queue minimum
+         times.ringBufferDelay = std::max(times.ringBufferDelay,
+            2 * times.latency + times.batchSize);
+      }
+   }
+
    //
    // The (audio) stream has been opened successfully (assuming we tried
    // to open it). We now proceed to
@@ -1325,10 +1403,59 @@ bool AudioIO::AllocateBuffers(
                   ));
             }
 
+            // Parallel prefetch is worth it only for more than one sequence.
+            // A time warp envelope is shared by all mixers, and its lookups
+            // are not safe for concurrent use, so then don't.
+            // Keep the previous pool if the number of workers is unchanged.
+            const auto nWorkers =
+               (mPlaybackMixers.size() < 2 || warpOptions.envelope) ? 0 :
+               std::min<size_t>(
+                  std::max(0, AudioIOPlaybackPrefetchWorkers.Read()),
+                  std::max(1u, std::thread::hardware_concurrency()));
+            if (nWorkers == 0)
+               mPlaybackPrefetch.reset();
+            else if (mPlaybackPrefetch &&
+               mPlaybackPrefetch->NumWorkers() == nWorkers)
+               mPlaybackPrefetch->ResetStats();
+            else {
+               mPlaybackPrefetch.reset();
+               // The workers also run realtime effects, so schedule them
+               // like the Audio thread
+               std::function<void()> configure;
+               if (AudioIORealtimeAudioThread.Read())
+                  configure = []{
+                     using namespace audacity::concurrency;
+                     if (const auto result = SetCurrentThreadRealtime();
+                        !result)
+                        wxLogWarning(
+                           "Playback worker could not get real-time scheduling: %s",
+                           result.message);
+                  };
+               mPlaybackPrefetch = std::make_unique<PlaybackPrefetchPool>(
+                  nWorkers, move(configure));
+            }
+            mSerialRealtimeEffectsCountdown = 0;
+
+            // The same pool runs the realtime effects of the sequences in
+            // parallel, each with its own set of scratch buffers
+            if (mPlaybackPrefetch && mNumPlaybackChannels > 0) {
+               const auto setSize = mScratchBuffers.size();
+               mScratchBuffers.resize(setSize * mPlaybackSequences.size());
+               for (auto ii = setSize; ii < mScratchBuffers.size(); ++ii) {
+                  auto &buffer = mScratchBuffers[ii];
+                  buffer.Allocate(playbackBufferSize, floatSample);
+                  mScratchPointers.push_back(
+                     reinterpret_cast<float*>(buffer.ptr()));
+               }
+            }
+
             const auto timeQueueSize = 1 +
                (playbackBufferSize + TimeQueueGrainSize - 1)
                   / TimeQueueGrainSize;
             mPlaybackSchedule.mTimeQueue.Init( timeQueueSize );
+
+            // Wake the Audio thread when less than the desired queue remains
+            mPlaybackLowWater = mPlaybackQueueMinimum;
          }
 
          if( mNumCaptureChannels > 0 )
@@ -1352,6 +1479,10 @@ bool AudioIO::AllocateBuffers(
             mResample.resize(mNumCaptureChannels);
             mFactor = sampleRate / mRate;
 
+            // Wake the Audio thread when there is enough for a batch
+            mCaptureHighWater =
+               std::max<size_t>(1, lrint(mRate * mMinCaptureSecsToCopy));
+
             for (unsigned int i = 0; i < mNumCaptureChannels; ++i) {
                mCaptureBuffers[i] = std::make_unique<RingBuffer>(
                   mCaptureFormat, captureBufferSize);
@@ -1397,6 +1528,7 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
    mScratchPointers.clear();
    mPlaybackMixers.clear();
    mCaptureBuffers.clear();
+   mCaptureSpill.reset();
    mResample.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
@@ -1500,6 +1632,11 @@ void AudioIO::StopStream()
 
    StopAudioThread();
 
+   if (mTelemetry.IsEnabled()) {
+      if (const auto path = AudioIOTelemetryCsvPath.Read(); !path.empty())
+         mTelemetry.WriteCsv(path);
+   }
+
    // Turn off HW playthrough if PortMixer is being used
 
   #if defined(USE_PORTMIXER)
@@ -1547,6 +1684,12 @@ void AudioIO::StopStream()
       ProcessOnceAndWait();
    }
 
+   // Append what remains in the spill file, before the sequences are flushed
+   if (mCaptureSpill) {
+      mCaptureSpill->Finish();
+      mCaptureSpill.reset();
+   }
+
    // No longer need effects processing. This must be done after the stream is stopped
    // to prevent the callback from being invoked after the effects are finalized.
    mpTransportState.reset();
@@ -1784,6 +1927,13 @@ finished:
    return retval;
 }
 
+std::vector<PlaybackPrefetchStats> AudioIO::GetPlaybackPrefetchStats() const
+{
+   if (!mPlaybackPrefetch)
+      return {};
+   return mPlaybackPrefetch->GetStats();
+}
+
 double AudioIO::GetStreamTime()
 {
    // Sequence time readout for the main thread
@@ -1806,6 +1956,7 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
 {
    enum class State { eUndefined, eOnce, eLoopRunning, eDoNothing, eMonitoring } lastState = State::eUndefined;
    AudioIO *const gAudioIO = AudioIO::Get();
+   Tracing::SetThreadName("Audio thread");
    while (!finish.load(std::memory_order_acquire)) {
       using Clock = std::chrono::steady_clock;
       auto loopPassStart = Clock::now();
@@ -1819,8 +1970,13 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
          .load(std::memory_order_acquire) )
       {
          gAudioIO->SequenceBufferExchange();
-         gAudioIO->mAudioThreadShouldCallSequenceBufferExchangeOnce
-            .store(false, std::memory_order_release);
+         {
+            std::lock_guard<std::mutex> lock{
+               gAudioIO->mAudioThreadSignalMutex };
+            gAudioIO->mAudioThreadShouldCallSequenceBufferExchangeOnce
+               .store(false, std::memory_order_release);
+         }
+         gAudioIO->mAudioThreadOnceDone.notify_all();
 
          lastState = State::eOnce;
       }
@@ -1864,7 +2020,7 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
       gAudioIO->mAudioThreadSequenceBufferExchangeLoopActive
          .store(false, std::memory_order_relaxed);
 
-      std::this_thread::sleep_until( loopPassStart + interval );
+      gAudioIO->WaitForAudioThreadSignal( loopPassStart + interval );
    }
 }
 
@@ -1905,8 +2061,22 @@ size_t AudioIO::GetCommonlyAvailCapture()
 // (which communicates with the audio device).
 void AudioIO::SequenceBufferExchange()
 {
+   AUDACITY_TRACE_SCOPE("AudioIO::SequenceBufferExchange");
+   if (!mTelemetry.IsEnabled()) {
+      FillPlayBuffers();
+      DrainRecordBuffers();
+      return;
+   }
+
+   using Clock = AudioIOTelemetry::Clock;
+   mRealtimeEffectsTime = {};
+   const auto start = Clock::now();
    FillPlayBuffers();
    DrainRecordBuffers();
+   mTelemetry.RecordExchange({ start,
+      std::chrono::duration_cast<AudioIOTelemetry::Duration>(
+         Clock::now() - start),
+      mRealtimeEffectsTime });
 }
 
 void AudioIO::FillPlayBuffers()
@@ -1989,6 +2159,25 @@ void AudioIO::FillPlayBuffers()
 
 #define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
 
+namespace {
+//! How many passes of ProcessPlaybackSlices run realtime effects serially,
+//! after a parallel pass that was slower than serial
+constexpr size_t SerialRealtimeEffectsPasses = 100;
+}
+
+template<typename F> auto AudioIO::TimeRealtimeEffects(const F &f)
+{
+   if (!mTelemetry.IsEnabled())
+      return f();
+   using Clock = AudioIOTelemetry::Clock;
+   const auto start = Clock::now();
+   auto result = f();
+   mRealtimeEffectsTime +=
+      std::chrono::duration_cast<AudioIOTelemetry::Duration>(
+         Clock::now() - start);
+   return result;
+}
+
 bool AudioIO::ProcessPlaybackSlices(
    std::optional<RealtimeEffects::ProcessingScope> &pScope, size_t available)
 {
@@ -2009,6 +2198,15 @@ bool AudioIO::ProcessPlaybackSlices(
    for(unsigned n = 0; n < mProcessingBuffers.size(); ++n)
       processingBufferOffsets[n] = mProcessingBuffers[n].size();
 
+   // index of the first processing buffer of each sequence
+   const auto processingBufferIndices =
+      stackAllocate(size_t, mPlaybackSequences.size());
+   for (size_t iSequence = 0, iBuffer = 0;
+      iSequence < mPlaybackSequences.size(); ++iSequence) {
+      processingBufferIndices[iSequence] = iBuffer;
+      iBuffer += mPlaybackSequences[iSequence]->NChannels();
+   }
+
    do {
       const auto slice =
          policy.GetPlaybackSlice(mPlaybackSchedule, available);
@@ -2023,48 +2221,53 @@ bool AudioIO::ProcessPlaybackSlices(
       mPlaybackSchedule.mTimeQueue.Producer(mPlaybackSchedule, slice);
 
       // mPlaybackMixers correspond one-to-one with mPlaybackSequences
-      size_t iSequence = 0;
-      // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
-      size_t iBuffer = 0;
-      for (auto &mixer : mPlaybackMixers) {
+      // Each task touches only the processing buffers of its own sequence,
+      // so the tasks may run in parallel
+      const auto processMixer = [&, frames = frames, toProduce = toProduce]
+      (size_t iSequence) {
          // The mixer here isn't actually mixing: it's just doing
          // resampling, format conversion, and possibly time track
          // warping
-         if (frames > 0) {
-            size_t produced = 0;
+         auto &mixer = mPlaybackMixers[iSequence];
+         size_t produced = 0;
 
-            if (toProduce)
-               produced = mixer->Process(toProduce);
+         if (toProduce)
+            produced = mixer->Process(toProduce);
 
-            //wxASSERT(produced <= toProduce);
-            // Copy (non-interleaved) mixer outputs to one or more ring buffers
-            const auto nChannels = mPlaybackSequences[iSequence]->NChannels();
+         //wxASSERT(produced <= toProduce);
+         // Copy (non-interleaved) mixer outputs to one or more ring buffers
+         const auto nChannels = mPlaybackSequences[iSequence]->NChannels();
 
-            const auto appendPos = mProcessingBuffers[iBuffer].size();
-            for (size_t j = 0; j < nChannels; ++j)
-            {
-               // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
-               auto& buffer = mProcessingBuffers[iBuffer + j];
-               //Sufficient size should have been reserved in AllocateBuffers
-               //But for some latency values (> aprox. 100ms) pre-allocated
-               //buffer could be not large enough.
-               //Preserve what was written to the buffer during previous pass, don't discard
-               buffer.resize(buffer.size() + frames, 0);
-
-               const auto warpedSamples = mixer->GetBuffer(j);
-               std::copy_n(
-                  reinterpret_cast<const float*>(warpedSamples),
-                  produced,
-                  buffer.data() + appendPos);
-               std::fill_n(
-                  buffer.data() + appendPos + produced,
-                  frames - produced,
-                  .0f);
-            }
-
-            iBuffer += nChannels;
-            ++iSequence;
+         // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
+         const auto iBuffer = processingBufferIndices[iSequence];
+         const auto appendPos = mProcessingBuffers[iBuffer].size();
+         for (size_t j = 0; j < nChannels; ++j)
+         {
+            auto& buffer = mProcessingBuffers[iBuffer + j];
+            //Sufficient size should have been reserved in AllocateBuffers
+            //But for some latency values (> aprox. 100ms) pre-allocated
+            //buffer could be not large enough.
+            //Preserve what was written to the buffer during previous pass, don't discard
+            buffer.resize(buffer.size() + frames, 0);
+
+            const auto warpedSamples = mixer->GetBuffer(j);
+            std::copy_n(
+               reinterpret_cast<const float*>(warpedSamples),
+               produced,
+               buffer.data() + appendPos);
+            std::fill_n(
+               buffer.data() + appendPos + produced,
+               frames - produced,
+               .0f);
          }
+      };
+      if (frames > 0) {
+         if (mPlaybackPrefetch)
+            mPlaybackPrefetch->Run(mPlaybackMixers.size(), processMixer);
+         else
+            for (size_t iSequence = 0; iSequence < mPlaybackMixers.size();
+               ++iSequence)
+               processMixer(iSequence);
       }
 
       available -= frames;
@@ -2085,24 +2288,31 @@ bool AudioIO::ProcessPlaybackSlices(
    // after all the little slices have been written.
    if (pScope)
    {
-      const auto pointers = stackAllocate(float*, mNumPlaybackChannels);
-
-      int bufferIndex = 0;
-      for(const auto& seq : mPlaybackSequences)
-      {
+      // The effect chains of the sequences are independent, so with a pool,
+      // each task may process one sequence, with its own scratch buffers
+      const auto parallel = mPlaybackPrefetch &&
+         mScratchPointers.size() > 2 * mNumPlaybackChannels + 1 &&
+         mSerialRealtimeEffectsCountdown == 0;
+      const auto processEffects = [&](size_t iSequence) {
+         const auto &seq = mPlaybackSequences[iSequence];
          if(!seq)
-            continue;//no similar check in convert-to-float part
+            return;//no similar check in convert-to-float part
          const auto channelGroup = seq->FindChannelGroup();
          if(!channelGroup)
-            continue;
+            return;
+
+         const auto scratchPointers = mScratchPointers.data() +
+            (parallel ? iSequence * (2 * mNumPlaybackChannels + 1) : 0);
+         const auto pointers = stackAllocate(float*, mNumPlaybackChannels);
 
          // Are there more output device channels than channels of vt?
          // Such as when a mono sequence is processed for stereo play?
          // Then supply some non-null fake input buffers, because the
          // various ProcessBlock overrides of effects may crash without it.
          // But it would be good to find the fixes to make this unnecessary.
-         auto scratch = &mScratchPointers[mNumPlaybackChannels + 1];
+         auto scratch = &scratchPointers[mNumPlaybackChannels + 1];
 
+         const auto bufferIndex = processingBufferIndices[iSequence];
          //skip samples that are already processed
          const auto offset = processingBufferOffsets[bufferIndex];
          //number of newly written samples
@@ -2120,11 +2330,13 @@ bool AudioIO::ProcessPlaybackSlices(
                std::fill_n(pointers[i], len, .0f);
             }
 
-            const auto discardable = pScope->Process(channelGroup, &pointers[0],
-               mScratchPointers.data(),
-               // The single dummy output buffer:
-               mScratchPointers[mNumPlaybackChannels],
-               mNumPlaybackChannels, len);
+            // A sequence may come with its effects already applied
+            const auto discardable = seq->IncludesRealtimeEffects() ? 0 :
+               pScope->Process(channelGroup, &pointers[0],
+                  scratchPointers,
+                  // The single dummy output buffer:
+                  scratchPointers[mNumPlaybackChannels],
+                  mNumPlaybackChannels, len);
             // Check for asynchronous user changes in mute, solo status
             const auto silenced = SequenceShouldBeSilent(*seq);
             for(int i = 0; i < seq->NChannels(); ++i)
@@ -2138,9 +2350,35 @@ bool AudioIO::ProcessPlaybackSlices(
                }
             }
          }
+      };
+
+      const auto nSequences = mPlaybackSequences.size();
+      TimeRealtimeEffects([&]{
+         if (!parallel) {
+            if (mSerialRealtimeEffectsCountdown > 0)
+               --mSerialRealtimeEffectsCountdown;
+            for (size_t iSequence = 0; iSequence < nSequences; ++iSequence)
+               processEffects(iSequence);
+            return 0;
+         }
 
-         bufferIndex += seq->NChannels();
-      }
+         // Time the tasks, and the whole, to learn whether the pool helps
+         using Clock = std::chrono::steady_clock;
+         std::atomic<Clock::rep> busy{ 0 };
+         const auto start = Clock::now();
+         mPlaybackPrefetch->Run(nSequences, [&](size_t iSequence){
+            const auto taskStart = Clock::now();
+            processEffects(iSequence);
+            busy.fetch_add((Clock::now() - taskStart).count(),
+               std::memory_order_relaxed);
+         });
+         // When the workers did not get the processors in time, the
+         // batch took longer than doing it all in this thread would have;
+         // then stay serial for a while before trying again
+         if ((Clock::now() - start).count() > busy.load())
+            mSerialRealtimeEffectsCountdown = SerialRealtimeEffectsPasses;
+         return 0;
+      });
    }
 
    //samples at the beginning could have been discarded
@@ -2213,13 +2451,15 @@ bool AudioIO::ProcessPlaybackSlices(
       for(unsigned i = 0; i < mNumPlaybackChannels; ++i)
          pointers[i] = mMasterBuffers[i].data();
 
-      masterBufferOffset = pScope->Process(
-         RealtimeEffectManager::MasterGroup,
-         &pointers[0],
-         mScratchPointers.data(),
-         // The single dummy output buffer:
-         mScratchPointers[mNumPlaybackChannels],
-         mNumPlaybackChannels, samplesAvailable);
+      masterBufferOffset = TimeRealtimeEffects([&]{
+         return pScope->Process(
+            RealtimeEffectManager::MasterGroup,
+            &pointers[0],
+            mScratchPointers.data(),
+            // The single dummy output buffer:
+            mScratchPointers[mNumPlaybackChannels],
+            mNumPlaybackChannels, samplesAvailable);
+      });
 
       // wxASSERT(samplesAvailable >= masterBufferOffset); // don't assert on this thread
       samplesAvailable -= masterBufferOffset;
@@ -2247,30 +2487,108 @@ bool AudioIO::ProcessPlaybackSlices(
    return progress;
 }
 
+void AudioIO::StopRecordingAfterException(AudacityException *pException)
+{
+   // In the main thread, stop recording
+   // This is one place where the application handles disk
+   // exhaustion exceptions from RecordableSequence operations, without
+   // rolling back to the last pushed undo state.  Instead, partial recording
+   // results are pushed as a NEW undo state.  For this reason, as
+   // commented elsewhere, we want an exception safety guarantee for
+   // the output RecordableSequences, after the failed append operation, that
+   // the sequences remain as they were after the previous successful
+   // (block-level) appends.
+
+   // Note that the Flush in StopStream() may throw another exception,
+   // but StopStream() contains that exception, and the logic in
+   // AudacityException::DelayedHandlerAction prevents redundant message
+   // boxes.
+   StopStream();
+   DefaultDelayedHandlerAction( pException );
+   for (auto &pSequence: mCaptureSequences)
+      pSequence->RepairChannels();
+}
+
+void AudioIO::StartCaptureSpill()
+{
+   mCaptureSpill.reset();
+   if (mCaptureSequences.empty() || !AudioIOCaptureSpill.Read())
+      return;
+
+   // Map capture channel numbers to sequences and their channels
+   std::vector<std::pair<RecordableSequence*, size_t>> channels;
+   for (auto &pSequence : mCaptureSequences)
+      for (size_t iChannel = 0, width = pSequence->NChannels();
+         iChannel < width; ++iChannel)
+         channels.emplace_back(pSequence.get(), iChannel);
+
+   // Hold several times the contents of the capture buffers, and the initial
+   // silence of latency correction, so that each pass of
+   // DrainRecordBuffers() fits
+   const auto factor = std::max(1.0, mFactor);
+   const size_t silence = floor(
+      std::max(0.0, mRecordingSchedule.TotalCorrection()) * mRate * factor);
+   const size_t length = lrint(mRate * mCaptureRingBufferSecs * factor) + 1;
+   const size_t minimum = 4 * mNumCaptureChannels * (
+      RecordingSpill::ChunkBytes(silence, floatSample) +
+      2 * RecordingSpill::ChunkBytes(length, floatSample));
+   const size_t bytes = std::max(minimum,
+      size_t(std::max(0, AudioIOCaptureSpillMegabytes.Read())) << 20);
+
+   const auto directory = TempDirectory::TempDir();
+   mCaptureSpill = RecordingSpill::Create(directory, bytes,
+   [this, channels = std::move(channels)](
+      const RecordingSpill::Chunk *begin, const RecordingSpill::Chunk *end
+   ){
+      // Runs in the spill's own thread, which takes over the appending,
+      // and the handling of its exceptions, from DrainRecordBuffers()
+      bool success = true;
+      bool newBlocks = false;
+      GuardedCall( [&] {
+         for (auto pChunk = begin; pChunk != end; ++pChunk) {
+            const auto &[pSequence, iChannel] = channels[pChunk->channel];
+            // see comment in second handler about guarantee
+            newBlocks = pSequence->Append(iChannel,
+               pChunk->data, pChunk->format, pChunk->length, 1,
+               // Do not dither recordings
+               narrowestSampleFormat
+            ) || newBlocks;
+         }
+      },
+      [&] ( AudacityException *pException ) {
+         success = false;
+         if ( pException ) {
+            SetRecordingException();
+            return ;
+         }
+         else
+            throw;
+      },
+      [this] ( AudacityException *pException ) {
+         StopRecordingAfterException(pException);
+      } );
+
+      auto pListener = GetListener();
+      if (pListener && newBlocks)
+         pListener->OnAudioIONewBlocks();
+      return success;
+   });
+
+   if (mCaptureSpill)
+      wxLogMessage("Recording through a spill file of %llu bytes",
+         static_cast<unsigned long long>(bytes));
+   else
+      wxLogWarning("Could not create a recording spill file in %s",
+         directory);
+}
+
 void AudioIO::DrainRecordBuffers()
 {
    if (mRecordingException || mCaptureSequences.empty())
       return;
 
    auto delayedHandler = [this] ( AudacityException * pException ) {
-      // In the main thread, stop recording
-      // This is one place where the application handles disk
-      // exhaustion exceptions from RecordableSequence operations, without
-      // rolling back to the last pushed undo state.  Instead, partial recording
-      // results are pushed as a NEW undo state.  For this reason, as
-      // commented elsewhere, we want an exception safety guarantee for
-      // the output RecordableSequences, after the failed append operation, that
-      // the sequences remain as they were after the previous successful
-      // (block-level) appends.
-
-      // Note that the Flush in StopStream() may throw another exception,
-      // but StopStream() contains that exception, and the logic in
-      // AudacityException::DelayedHandlerAction prevents redundant message
-      // boxes.
-      StopStream();
-      DefaultDelayedHandlerAction( pException );
-      for (auto &pSequence: mCaptureSequences)
-         pSequence->RepairChannels();
+      StopRecordingAfterException(pException);
    };
 
    GuardedCall( [&] {
@@ -2284,10 +2602,26 @@ void AudioIO::DrainRecordBuffers()
 
       double deltat = avail / mRate;
 
-      if (mAudioThreadShouldCallSequenceBufferExchangeOnce
-          .load(std::memory_order_relaxed) ||
-          deltat >= mMinCaptureSecsToCopy)
+      const bool once = mAudioThreadShouldCallSequenceBufferExchangeOnce
+         .load(std::memory_order_relaxed);
+      if (once || deltat >= mMinCaptureSecsToCopy)
       {
+         if (mCaptureSpill) {
+            const size_t silence = mRecordingSchedule.mLatencyCorrected ? 0
+               : floor(std::max(0.0, mRecordingSchedule.TotalCorrection())
+                  * mRate * mFactor);
+            const size_t length = ceil(avail * std::max(1.0, mFactor)) + 1;
+            // Silence, and up to two pieces of samples, for each channel
+            const auto bytes = mNumCaptureChannels * (
+               RecordingSpill::ChunkBytes(silence, mCaptureFormat) +
+               2 * RecordingSpill::ChunkBytes(length, floatSample));
+            if (!mCaptureSpill->HasSpace(bytes) &&
+               // Leave the samples in the ring buffers until the spill
+               // thread catches up, but don't leave any at the last pass
+               !(once && mCaptureSpill->WaitForSpace(bytes)))
+               return;
+         }
+
          bool newBlocks = false;
 
          // Append captured samples to the end of the RecordableSequences.
@@ -2295,7 +2629,23 @@ void AudioIO::DrainRecordBuffers()
          auto iter = mCaptureSequences.begin();
          auto width = (*iter)->NChannels();
          size_t iChannel = 0;
-         for (size_t i = 0; i < mNumCaptureChannels; ++i) {
+         size_t i = 0;
+         const auto append = [&](
+            constSamplePtr buffer, sampleFormat format, size_t len
+         ){
+            if (mCaptureSpill) {
+               if (len > 0)
+                  mCaptureSpill->Write(i, buffer, format, len);
+            }
+            else
+               // see comment in second handler about guarantee
+               newBlocks = (*iter)->Append(iChannel,
+                  buffer, format, len, 1,
+                  // Do not dither recordings
+                  narrowestSampleFormat
+               ) || newBlocks;
+         };
+         for (; i < mNumCaptureChannels; ++i) {
             Finally Do {[&]{
                if (++iChannel == width) {
                   ++iter;
@@ -2315,9 +2665,7 @@ void AudioIO::DrainRecordBuffers()
                   size_t size = floor( correction * mRate * mFactor);
                   SampleBuffer temp(size, mCaptureFormat);
                   ClearSamples(temp.ptr(), mCaptureFormat, 0, size);
-                  (*iter)->Append(iChannel, temp.ptr(), mCaptureFormat, size, 1,
-                     // Do not dither recordings
-                     narrowestSampleFormat);
+                  append(temp.ptr(), mCaptureFormat, size);
                }
                else {
                   // Leftward shift
@@ -2355,6 +2703,28 @@ void AudioIO::DrainRecordBuffers()
 
             wxASSERT(discarded <= avail);
             size_t toGet = avail - discarded;
+            if (mFactor == 1.0 && !pCrossfadeSrc) {
+               // Append straight from the memory of the ring buffer,
+               // which has mCaptureFormat, without an intermediate copy
+               auto &captureBuffer = *mCaptureBuffers[i];
+               size_t toAppend = (double(toGet) > remainingSamples)
+                  ? floor(remainingSamples) : toGet;
+               for (const auto &[pSrc, count] :
+                  captureBuffer.PeekForGet(toGet)) {
+                  const auto len = std::min(count, toAppend);
+                  if (len == 0)
+                     break;
+                  toAppend -= len;
+                  append(pSrc, mCaptureFormat, len);
+               }
+               // Release all of toGet, as Get() would have consumed it
+               const auto got = captureBuffer.CommitGet(toGet);
+               // wxASSERT(got == toGet);
+               // but we can't assert in this thread
+               wxUnusedVar(got);
+               continue;
+            }
+
             SampleBuffer temp;
             size_t size;
             sampleFormat format;
@@ -2419,14 +2789,12 @@ void AudioIO::DrainRecordBuffers()
             }
 
             // Now append
-            // see comment in second handler about guarantee
-            newBlocks = (*iter)->Append(iChannel,
-               temp.ptr(), format, size, 1,
-               // Do not dither recordings
-               narrowestSampleFormat
-            ) || newBlocks;
+            append(temp.ptr(), format, size);
          } // end loop over capture channels
 
+         if (mCaptureSpill)
+            mCaptureSpill->Publish();
+
          // Now update the recording schedule position
          mRecordingSchedule.mPosition += avail / mRate;
          mRecordingSchedule.mLatencyCorrected = latencyCorrected;
@@ -2632,25 +3000,6 @@ void AudioIO::AILAProcess(double maxPeak) {
 }
 #endif
 
-static void DoSoftwarePlaythrough(constSamplePtr inputBuffer,
-                                  sampleFormat inputFormat,
-                                  unsigned inputChannels,
-                                  float *outputBuffer,
-                                  unsigned long len)
-{
-   for (unsigned int i=0; i < inputChannels; i++) {
-      auto inputPtr = inputBuffer + (i * SAMPLE_SIZE(inputFormat));
-
-      SamplesToFloats(inputPtr, inputFormat,
-         outputBuffer + i, len, inputChannels, 2);
-   }
-
-   // One mono input channel goes to both output channels...
-   if (inputChannels == 1)
-      for (int i=0; i < len; i++)
-         outputBuffer[2*i + 1] = outputBuffer[2*i];
-}
-
 int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                           unsigned long framesPerBuffer,
                           const PaStreamCallbackTimeInfo *timeInfo,
@@ -2864,8 +3213,10 @@ void AudioIoCallback::UpdateTimePosition(unsigned long framesPerBuffer)
       return;
 
    // Update the position seen by drawing code
-   mPlaybackSchedule.SetSequenceTime(
-      mPlaybackSchedule.mTimeQueue.Consumer( mMaxFramesOutput, mRate ) );
+   const auto time =
+      mPlaybackSchedule.mTimeQueue.Consumer( mMaxFramesOutput, mRate );
+   mPlaybackSchedule.SetSequenceTime( time );
+   mPlaybackClock.Publish( time, mMaxFramesOutput / mRate );
 }
 
 // return true, IFF we have fully handled the callback.
@@ -2875,8 +3226,7 @@ void AudioIoCallback::UpdateTimePosition(unsigned long framesPerBuffer)
 void AudioIoCallback::DrainInputBuffers(
    constSamplePtr inputBuffer,
    unsigned long framesPerBuffer,
-   const PaStreamCallbackFlags statusFlags,
-   float * tempFloats
+   const PaStreamCallbackFlags statusFlags
 )
 {
    const auto numPlaybackChannels = mNumPlaybackChannels;
@@ -2947,52 +3297,52 @@ void AudioIoCallback::DrainInputBuffers(
    if (len <= 0)
       return;
 
-   // We have an ASSERT in the AudioIO constructor to alert us to
-   // possible issues with the (short*) cast.  We'd have a problem if
-   // sizeof(short) > sizeof(float) since our buffers are sized for floats.
    for(unsigned t = 0; t < numCaptureChannels; t++) {
+      auto &captureBuffer = *mCaptureBuffers[t];
+
+      // Un-interleave straight into the free space of the ring buffer,
+      // which has mCaptureFormat, in at most two pieces.  len is not more
+      // than AvailForPut(), so all of it is reserved.
+      size_t frame = 0;
+      for (const auto &[pDst, count] : captureBuffer.ReserveForPut(len)) {
+         // dmazzoni:
+         // Un-interleave.  Ugly special-case code required because the
+         // capture channels could be in three different sample formats;
+         // it'd be nice to be able to call CopySamples, but it can't
+         // handle multiplying by the gain and then clipping.  Bummer.
+
+         switch(mCaptureFormat) {
+            case floatSample: {
+               auto inputFloats = (const float *)inputBuffer;
+               auto dstFloats = (float *)pDst;
+               for(size_t i = 0; i < count; i++)
+                  dstFloats[i] =
+                     inputFloats[numCaptureChannels*(frame + i)+t];
+            } break;
+            case int24Sample:
+               // We should never get here. Audacity's int24Sample format
+               // is different from PortAudio's sample format and so we
+               // make PortAudio return float samples when recording in
+               // 24-bit samples.
+               wxASSERT(false);
+               break;
+            case int16Sample: {
+               auto inputShorts = (const short *)inputBuffer;
+               auto dstShorts = (short *)pDst;
+               for(size_t i = 0; i < count; i++)
+                  dstShorts[i] =
+                     inputShorts[numCaptureChannels*(frame + i)+t];
+            } break;
+         } // switch
+
+         frame += count;
+      }
 
-      // dmazzoni:
-      // Un-interleave.  Ugly special-case code required because the
-      // capture channels could be in three different sample formats;
-      // it'd be nice to be able to call CopySamples, but it can't
-      // handle multiplying by the gain and then clipping.  Bummer.
-
-      switch(mCaptureFormat) {
-         case floatSample: {
-            auto inputFloats = (const float *)inputBuffer;
-            for(unsigned i = 0; i < len; i++)
-               tempFloats[i] =
-                  inputFloats[numCaptureChannels*i+t];
-         } break;
-         case int24Sample:
-            // We should never get here. Audacity's int24Sample format
-            // is different from PortAudio's sample format and so we
-            // make PortAudio return float samples when recording in
-            // 24-bit samples.
-            wxASSERT(false);
-            break;
-         case int16Sample: {
-            auto inputShorts = (const short *)inputBuffer;
-            short *tempShorts = (short *)tempFloats;
-            for( unsigned i = 0; i < len; i++) {
-               float tmp = inputShorts[numCaptureChannels*i+t];
-               tmp = std::clamp(tmp, -32768.0f, 32767.0f);
-               tempShorts[i] = (short)(tmp);
-            }
-         } break;
-      } // switch
-
-      // JKC: mCaptureFormat must be for samples with sizeof(float) or
-      // fewer bytes (because tempFloats is sized for floats).  All
-      // formats are 2 or 4 bytes, so we are OK.
-      const auto put =
-         mCaptureBuffers[t]->Put(
-            (samplePtr)tempFloats, mCaptureFormat, len);
+      const auto put = captureBuffer.CommitPut(frame);
       // wxASSERT(put == len);
       // but we can't assert in this thread
       wxUnusedVar(put);
-      mCaptureBuffers[t]->Flush();
+      captureBuffer.Flush();
    }
 }
 
@@ -3050,11 +3400,9 @@ void AudioIoCallback::DoPlaythrough(
    for(unsigned i = 0; i < framesPerBuffer*numPlaybackChannels; i++)
       outputFloats[i] = 0.0;
 
-   if (inputBuffer && mSoftwarePlaythrough) {
-      DoSoftwarePlaythrough(inputBuffer, mCaptureFormat,
-                              numCaptureChannels,
-                              outputBuffer, framesPerBuffer);
-   }
+   if (inputBuffer && mSoftwarePlaythrough)
+      mMonitoringPath.Process(inputBuffer, mCaptureFormat, numCaptureChannels,
+         outputBuffer, numPlaybackChannels, framesPerBuffer);
 
    // Copy the results to outputMeterFloats if necessary
    if (outputMeterFloats != outputFloats) {
@@ -3161,6 +3509,30 @@ int AudioIoCallback::AudioCallback(
    const PaStreamCallbackTimeInfo *timeInfo,
    const PaStreamCallbackFlags statusFlags, void * WXUNUSED(userData) )
 {
+   // At every exit, maybe get the Audio thread to service the buffers soon
+   auto signal = finally([this]{ SignalAudioThreadIfNeeded(); });
+
+   std::optional<AudioIOTelemetry::CallbackRecord> telemetry;
+   auto recordTelemetry = finally([&]{
+      if (telemetry) {
+         telemetry->duration =
+            std::chrono::duration_cast<AudioIOTelemetry::Duration>(
+               AudioIOTelemetry::Clock::now() - telemetry->start);
+         mTelemetry.RecordCallback(*telemetry);
+      }
+   });
+   if (mTelemetry.IsEnabled()) {
+      telemetry.emplace();
+      telemetry->start = AudioIOTelemetry::Clock::now();
+      telemetry->frames = framesPerBuffer;
+      telemetry->period = mRate > 0 ? framesPerBuffer / mRate : 0;
+      if (!mPlaybackBuffers.empty())
+         telemetry->playbackReady = GetCommonlyReadyPlayback();
+      if (!mCaptureBuffers.empty())
+         telemetry->captureFree =
+            MinValue(mCaptureBuffers, &RingBuffer::AvailForPut);
+   }
+
    // Poll sequences for change of state.
    // (User might click mute and solo buttons.)
    mbHasSoloSequences = CountSoloingSequences() > 0 ;
@@ -3232,11 +3604,19 @@ int AudioIoCallback::AudioCallback(
    // Even when paused, we do playthrough.
    // Initialise output buffer to zero or to playthrough data.
    // Initialise output meter values.
-   DoPlaythrough(
-      inputBuffer,
-      outputBuffer,
-      framesPerBuffer,
-      outputMeterFloats);
+   {
+      const auto playthroughStart = telemetry
+         ? AudioIOTelemetry::Clock::now() : AudioIOTelemetry::Clock::time_point{};
+      DoPlaythrough(
+         inputBuffer,
+         outputBuffer,
+         framesPerBuffer,
+         outputMeterFloats);
+      if (telemetry)
+         telemetry->playthrough =
+            std::chrono::duration_cast<AudioIOTelemetry::Duration>(
+               AudioIOTelemetry::Clock::now() - playthroughStart);
+   }
 
    // Test for no sequence audio to play (because we are paused and have faded
    // out)
@@ -3258,8 +3638,7 @@ int AudioIoCallback::AudioCallback(
    DrainInputBuffers(
       inputBuffer,
       framesPerBuffer,
-      statusFlags,
-      tempFloats);
+      statusFlags);
 
    SendVuOutputMeterData( outputMeterFloats, framesPerBuffer);
 
@@ -3315,6 +3694,7 @@ int AudioIoCallback::CallbackDoSeek()
    }
 
    mPlaybackSchedule.mTimeQueue.Prime(time);
+   mPlaybackClock.Reset(time);
 
    // Reload the ring buffers
    ProcessOnceAndWait();
@@ -3385,12 +3765,49 @@ void AudioIoCallback::ProcessOnceAndWait(std::chrono::milliseconds sleepTime)
    mAudioThreadShouldCallSequenceBufferExchangeOnce
       .store(true, std::memory_order_release);
 
+   // Don't wait for the Audio thread to finish its sleep
+   mAudioThreadSignalled.store(true, std::memory_order_release);
+   mAudioThreadSignal.notify_one();
+
+   // The Audio thread notifies when done, but still wake up periodically
+   std::unique_lock<std::mutex> lock{ mAudioThreadSignalMutex };
    while (mAudioThreadShouldCallSequenceBufferExchangeOnce
       .load(std::memory_order_acquire))
-   {
-      using namespace std::chrono;
-      std::this_thread::sleep_for(sleepTime);
-   }
+      mAudioThreadOnceDone.wait_for(lock, sleepTime);
+}
+
+void AudioIoCallback::SignalAudioThreadIfNeeded()
+{
+   if (!mEventDrivenAudioThread || mStreamToken <= 0)
+      return;
+   if (mAudioThreadSignalled.load(std::memory_order_relaxed))
+      // Already signalled and not yet serviced
+      return;
+
+   const bool needed =
+      (!mPlaybackBuffers.empty() &&
+         GetCommonlyReadyPlayback() < mPlaybackLowWater) ||
+      (!mCaptureBuffers.empty() &&
+         MinValue(mCaptureBuffers, &RingBuffer::WrittenForGet)
+            >= mCaptureHighWater);
+   if (!needed)
+      return;
+
+   // Don't lock the mutex in this thread, to avoid priority inversion.
+   // That means a notification might be missed if it happens just before
+   // the Audio thread begins waiting; but then it still wakes at its usual
+   // deadline.
+   if (!mAudioThreadSignalled.exchange(true, std::memory_order_release))
+      mAudioThreadSignal.notify_one();
+}
+
+void AudioIoCallback::WaitForAudioThreadSignal(
+   std::chrono::steady_clock::time_point deadline)
+{
+   std::unique_lock<std::mutex> lock{ mAudioThreadSignalMutex };
+   mAudioThreadSignal.wait_until(lock, deadline, [this]{
+      return mAudioThreadSignalled.load(std::memory_order_acquire); });
+   mAudioThreadSignalled.store(false, std::memory_order_relaxed);
 }
 
 
@@ -3405,3 +3822,17 @@ bool AudioIO::IsCapturing() const
 }
 
 BoolSetting SoundActivatedRecord{ "/AudioIO/SoundActivatedRecord", false };
+IntSetting AudioIOPlaybackPrefetchWorkers{
+   "/AudioIO/PlaybackPrefetchWorkers", 0 };
+BoolSetting AudioIOEventDrivenThread{
+   "/AudioIO/EventDrivenAudioThread", false };
+BoolSetting AudioIOTelemetryEnabled{ "/AudioIO/Telemetry", false };
+StringSetting AudioIOTelemetryCsvPath{ "/AudioIO/TelemetryCsvPath", "" };
+BoolSetting AudioIOCaptureSpill{ "/AudioIO/CaptureSpill", false };
+IntSetting AudioIOCaptureSpillMegabytes{
+   "/AudioIO/CaptureSpillMegabytes", 256 };
+BoolSetting AudioIORealtimeAudioThread{
+   "/AudioIO/RealtimeAudioThread", false };
+StringSetting AudioIOAudioThreadCores{ "/AudioIO/AudioThreadCores", "" };
+DoubleSetting AudioIORealtimeEffectsLookAhead{
+   "/AudioIO/RealtimeEffectsLookAhead", 0.0 };
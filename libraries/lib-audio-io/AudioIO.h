@@ -15,8 +15,14 @@
 
 #include "AudioIOBase.h" // to inherit
 #include "AudioIOSequences.h"
+#include "AudioIOTelemetry.h" // member variable
+#include "MonitoringPath.h" // member variable
+#include "PlaybackClock.h" // member variable
+#include "PlaybackPrefetch.h" // member variable
 #include "PlaybackSchedule.h" // member variable
+#include "RecordingSpill.h" // member variable
 
+#include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -38,6 +44,7 @@ class OtherPlayableSequence;
 class RealtimeEffectState;
 class Resample;
 
+class AudacityException;
 class AudacityProject;
 
 struct PaStreamCallbackTimeInfo;
@@ -167,6 +174,12 @@ public:
    }
    //! @}
 
+   //! Timings of the callback and of the Audio thread, when enabled
+   AudioIOTelemetry &GetTelemetry() { return mTelemetry; }
+
+   //! Routes and processing of the input, when software playthrough is on
+   MonitoringPath &GetMonitoringPath() { return mMonitoringPath; }
+
    std::shared_ptr< AudioIOListener > GetListener() const
       { return mListener.lock(); }
    void SetListener( const std::shared_ptr< AudioIOListener > &listener);
@@ -198,8 +211,7 @@ public:
    void DrainInputBuffers(
       constSamplePtr inputBuffer,
       unsigned long framesPerBuffer,
-      const PaStreamCallbackFlags statusFlags,
-      float * tempFloats
+      const PaStreamCallbackFlags statusFlags
    );
    void UpdateTimePosition(
       unsigned long framesPerBuffer
@@ -256,6 +268,9 @@ public:
    using RingBuffers = std::vector<std::unique_ptr<RingBuffer>>;
    RingBuffers mCaptureBuffers;
    RecordableSequences mCaptureSequences;
+   /*! If not null, the Audio thread writes captured samples here, and
+    another thread appends them to mCaptureSequences */
+   std::unique_ptr<RecordingSpill> mCaptureSpill;
    //!Buffers that hold outcome of transformations applied to each individual sample source.
    //!Number of buffers equals to the sum of number all source channels.
    std::vector<std::vector<float>> mProcessingBuffers;
@@ -270,9 +285,18 @@ public:
    float mOldPlaybackGain;
    // Temporary buffers, each as large as the playback buffers
    std::vector<SampleBuffer> mScratchBuffers;
-   std::vector<float *> mScratchPointers; //!< pointing into mScratchBuffers
+   /*! pointing into mScratchBuffers; one set of 2 * mNumPlaybackChannels + 1
+    for each playback sequence if realtime effects of the sequences may run in
+    parallel, else one set for all */
+   std::vector<float *> mScratchPointers;
 
    std::vector<std::unique_ptr<Mixer>> mPlaybackMixers;
+   /*! If not null, helps the Audio thread to run mPlaybackMixers in parallel;
+    unchanging during playback */
+   std::unique_ptr<PlaybackPrefetchPool> mPlaybackPrefetch;
+   //! How many more calls of ProcessPlaybackSlices run realtime effects of
+   //! sequences serially, because parallel processing was no faster
+   size_t mSerialRealtimeEffectsCountdown{ 0 };
 
    std::atomic<float>  mMixerOutputVol{ 1.0 };
    static int          mNextStreamToken;
@@ -295,6 +319,7 @@ public:
    double              mMinCaptureSecsToCopy;
    /*! Read by a worker thread but unchanging during playback */
    bool                mSoftwarePlaythrough;
+   MonitoringPath      mMonitoringPath;
    /// True if Sound Activated Recording is enabled
    /*! Read by a worker thread but unchanging during playback */
    bool                mPauseRec;
@@ -322,6 +347,26 @@ public:
 
    void ProcessOnceAndWait( std::chrono::milliseconds sleepTime = std::chrono::milliseconds(50) );
 
+   //! Called by the PortAudio callback, in event-driven mode, to wake the
+   //! Audio thread early when playback runs low or capture accumulates
+   void SignalAudioThreadIfNeeded();
+   //! Called by the Audio thread between passes
+   /*! Returns at the deadline, or sooner if signalled in event-driven mode */
+   void WaitForAudioThreadSignal(std::chrono::steady_clock::time_point deadline);
+
+   /*! Read by the PortAudio callback but unchanging during a stream */
+   bool mEventDrivenAudioThread{ false };
+   //! Playback ring buffer occupancy below which the callback signals
+   /*! Read by the PortAudio callback but unchanging during a stream */
+   size_t mPlaybackLowWater{ 0 };
+   //! Capture ring buffer occupancy above which the callback signals
+   /*! Read by the PortAudio callback but unchanging during a stream */
+   size_t mCaptureHighWater{ 0 };
+   std::atomic<bool> mAudioThreadSignalled{ false };
+   std::mutex mAudioThreadSignalMutex;
+   std::condition_variable mAudioThreadSignal;
+   //! Notified by the Audio thread after a one-time exchange
+   std::condition_variable mAudioThreadOnceDone;
 
 
    std::atomic<bool>   mForceFadeOut{ false };
@@ -393,6 +438,13 @@ public:
 protected:
    RecordingSchedule mRecordingSchedule{};
    PlaybackSchedule mPlaybackSchedule;
+   //! Written where the TimeQueue is primed or drained
+   PlaybackClock mPlaybackClock;
+
+   AudioIOTelemetry mTelemetry;
+   //! Accumulates realtime effect time during one SequenceBufferExchange;
+   //! used only by the Audio thread
+   AudioIOTelemetry::Duration mRealtimeEffectsTime{};
 
    struct TransportState;
    //! Holds some state for duration of playback or recording
@@ -546,6 +598,14 @@ public:
 
    bool IsAvailable(AudacityProject &project) const;
 
+   //! Timings of the threads that fetched samples for playback
+   /*!
+    One entry per prefetch worker, then one for the Audio thread itself; empty
+    if parallel prefetch is not enabled.  Totals accumulate from the start of
+    the most recent stream.
+    */
+   std::vector<PlaybackPrefetchStats> GetPlaybackPrefetchStats() const;
+
    /** \brief Return a valid sample rate that is supported by the current I/O
    * device(s).
    *
@@ -566,8 +626,18 @@ public:
     */
    double GetStreamTime();
 
+   //! The same time as GetStreamTime(), for interpolation between the
+   //! callbacks; may be read in any thread without locking
+   const PlaybackClock &GetPlaybackClock() const { return mPlaybackClock; }
+
    static void AudioThread(std::atomic<bool> &finish);
 
+private:
+   //! Apply preferences for priority and affinity to the calling thread
+   static void ConfigureAudioThread(bool realtime, const std::string &cores);
+
+public:
+
    static void Init();
    static void Deinit();
 
@@ -614,8 +684,15 @@ private:
       std::optional<RealtimeEffects::ProcessingScope> &pScope,
       size_t available);
 
+   //! Call f, adding its time to mRealtimeEffectsTime if telemetry is enabled
+   template<typename F> auto TimeRealtimeEffects(const F &f);
+
    //! Second part of SequenceBufferExchange
    void DrainRecordBuffers();
+   //! In the main thread, after an exception appending captured samples
+   void StopRecordingAfterException(AudacityException *pException);
+   //! Create mCaptureSpill if preferences ask for it
+   void StartCaptureSpill();
 
    /** \brief Get the number of audio samples free in all of the playback
    * buffers.
@@ -654,5 +731,33 @@ private:
 };
 
 AUDIO_IO_API extern BoolSetting SoundActivatedRecord;
+//! How many threads, besides the Audio thread, fetch samples of playback
+//! sequences, and run their realtime effects, in parallel; 0 (the default)
+//! disables parallel prefetch
+AUDIO_IO_API extern IntSetting AudioIOPlaybackPrefetchWorkers;
+//! Whether the PortAudio callback wakes the Audio thread when its buffers
+//! need service, instead of the Audio thread polling only
+AUDIO_IO_API extern BoolSetting AudioIOEventDrivenThread;
+//! Seconds of playback to render ahead, through realtime effects, when any
+//! playback sequence or the master has them; 0 (the default) keeps the
+//! latency that the playback policy suggests
+/*!
+ Heavier effects then fit at low device latency, but changes of effect
+ settings, and of mute and solo, are heard that much later
+ */
+AUDIO_IO_API extern DoubleSetting AudioIORealtimeEffectsLookAhead;
+//! Whether to ask for real-time scheduling of the Audio thread
+AUDIO_IO_API extern BoolSetting AudioIORealtimeAudioThread;
+//! Processor numbers (as "0,2-3") to which to pin the Audio thread; empty
+//! for no restriction
+AUDIO_IO_API extern StringSetting AudioIOAudioThreadCores;
+//! Whether to collect AudioIOTelemetry during each stream
+AUDIO_IO_API extern BoolSetting AudioIOTelemetryEnabled;
+//! If not empty, where to write telemetry as CSV after each stream stops
+AUDIO_IO_API extern StringSetting AudioIOTelemetryCsvPath;
+//! Whether recording goes through a RecordingSpill file before sample blocks
+AUDIO_IO_API extern BoolSetting AudioIOCaptureSpill;
+//! Size in megabytes of the RecordingSpill file
+AUDIO_IO_API extern IntSetting AudioIOCaptureSpillMegabytes;
 
 #endif
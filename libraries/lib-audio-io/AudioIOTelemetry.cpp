@@ -0,0 +1,197 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file AudioIOTelemetry.cpp
+
+ **********************************************************************/
+
+#include "AudioIOTelemetry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <wx/ffile.h>
+#include <wx/string.h>
+
+template<typename Record>
+bool AudioIOTelemetry::Queue<Record>::Push(const Record &record)
+{
+   const auto write = mWrite.load(std::memory_order_relaxed);
+   const auto next = (write + 1) % mRecords.size();
+   if (next == mRead.load(std::memory_order_acquire))
+      // Full; the consumer has not kept up
+      return false;
+   mRecords[write] = record;
+   mWrite.store(next, std::memory_order_release);
+   return true;
+}
+
+template<typename Record> template<typename F>
+void AudioIOTelemetry::Queue<Record>::PopAll(const F &f)
+{
+   auto read = mRead.load(std::memory_order_relaxed);
+   const auto write = mWrite.load(std::memory_order_acquire);
+   while (read != write) {
+      f(mRecords[read]);
+      read = (read + 1) % mRecords.size();
+   }
+   mRead.store(read, std::memory_order_release);
+}
+
+AudioIOTelemetry::AudioIOTelemetry(size_t capacity, size_t historyLength)
+   : mCallbacks{ capacity }
+   , mExchanges{ capacity }
+   , mHistoryLength{ std::max<size_t>(1, historyLength) }
+{
+}
+
+AudioIOTelemetry::~AudioIOTelemetry() = default;
+
+void AudioIOTelemetry::RecordCallback(const CallbackRecord &record)
+{
+   if (!mCallbacks.Push(record))
+      mDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioIOTelemetry::RecordExchange(const ExchangeRecord &record)
+{
+   if (!mExchanges.Push(record))
+      mDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioIOTelemetry::Collect()
+{
+   mCallbacks.PopAll([this](const CallbackRecord &record){
+      if (mCallbackHistory.size() == mHistoryLength)
+         mCallbackHistory.pop_front();
+      mCallbackHistory.push_back(record);
+   });
+   mExchanges.PopAll([this](const ExchangeRecord &record){
+      if (mExchangeHistory.size() == mHistoryLength)
+         mExchangeHistory.pop_front();
+      mExchangeHistory.push_back(record);
+   });
+}
+
+namespace {
+template<typename Records, typename Member>
+AudioIOTelemetry::Summary Summarize(const Records &records, Member member)
+{
+   AudioIOTelemetry::Summary result;
+   result.count = records.size();
+   if (records.empty())
+      return result;
+
+   std::vector<AudioIOTelemetry::Duration> durations;
+   durations.reserve(records.size());
+   for (const auto &record : records)
+      durations.push_back(record.*member);
+
+   AudioIOTelemetry::Duration total{};
+   for (auto duration : durations)
+      total += duration;
+   result.mean = total / durations.size();
+   result.max = *std::max_element(durations.begin(), durations.end());
+   const auto nth = durations.begin() + (durations.size() - 1) * 99 / 100;
+   std::nth_element(durations.begin(), nth, durations.end());
+   result.p99 = *nth;
+   return result;
+}
+}
+
+auto AudioIOTelemetry::GetStats() -> Stats
+{
+   Collect();
+
+   Stats stats;
+   stats.callback =
+      Summarize(mCallbackHistory, &CallbackRecord::duration);
+   stats.playthrough =
+      Summarize(mCallbackHistory, &CallbackRecord::playthrough);
+   stats.exchange =
+      Summarize(mExchangeHistory, &ExchangeRecord::duration);
+   stats.realtimeEffects =
+      Summarize(mExchangeHistory, &ExchangeRecord::realtimeEffects);
+   stats.dropped = mDropped.load(std::memory_order_relaxed);
+
+   if (mCallbackHistory.empty())
+      return stats;
+
+   stats.minPlaybackReady = std::numeric_limits<size_t>::max();
+   stats.minCaptureFree = std::numeric_limits<size_t>::max();
+   for (const auto &record : mCallbackHistory) {
+      stats.minPlaybackReady =
+         std::min(stats.minPlaybackReady, record.playbackReady);
+      stats.minCaptureFree = std::min(stats.minCaptureFree, record.captureFree);
+      if (record.period > 0)
+         stats.maxLoad = std::max(stats.maxLoad,
+            std::chrono::duration<double>(record.duration).count()
+               / record.period);
+   }
+
+   // Jitter is the deviation of the intervals between successive callbacks
+   if (mCallbackHistory.size() > 2) {
+      double sum = 0, sumSquares = 0;
+      const auto count = mCallbackHistory.size() - 1;
+      for (size_t ii = 1; ii <= count; ++ii) {
+         const double interval = std::chrono::duration<double>(
+            mCallbackHistory[ii].start - mCallbackHistory[ii - 1].start
+         ).count();
+         sum += interval;
+         sumSquares += interval * interval;
+      }
+      const auto mean = sum / count;
+      const auto variance = std::max(0.0, sumSquares / count - mean * mean);
+      stats.callbackJitter = std::chrono::duration_cast<Duration>(
+         std::chrono::duration<double>(std::sqrt(variance)));
+   }
+
+   return stats;
+}
+
+void AudioIOTelemetry::Reset()
+{
+   mCallbacks.PopAll([](const CallbackRecord &){});
+   mExchanges.PopAll([](const ExchangeRecord &){});
+   mCallbackHistory.clear();
+   mExchangeHistory.clear();
+   mDropped.store(0, std::memory_order_relaxed);
+}
+
+bool AudioIOTelemetry::WriteCsv(const wxString &path)
+{
+   Collect();
+
+   wxFFile file{ path, wxT("w") };
+   if (!file.IsOpened())
+      return false;
+
+   // Times are in microseconds, relative to the earliest record
+   auto origin = Clock::time_point::max();
+   if (!mCallbackHistory.empty())
+      origin = std::min(origin, mCallbackHistory.front().start);
+   if (!mExchangeHistory.empty())
+      origin = std::min(origin, mExchangeHistory.front().start);
+   const auto us = [](auto duration) {
+      return std::chrono::duration<double, std::micro>(duration).count();
+   };
+
+   bool ok = file.Write(wxT(
+      "kind,start_us,duration_us,playthrough_us,realtime_effects_us,"
+      "frames,period_us,playback_ready,capture_free\n"));
+   for (const auto &record : mCallbackHistory)
+      ok = ok && file.Write(wxString::Format(
+         wxT("callback,%.1f,%.1f,%.1f,,%lu,%.1f,%zu,%zu\n"),
+         us(record.start - origin), us(record.duration),
+         us(record.playthrough), record.frames,
+         record.period * 1e6, record.playbackReady, record.captureFree));
+   for (const auto &record : mExchangeHistory)
+      ok = ok && file.Write(wxString::Format(
+         wxT("exchange,%.1f,%.1f,,%.1f,,,,\n"),
+         us(record.start - origin), us(record.duration),
+         us(record.realtimeEffects)));
+
+   return file.Close() && ok;
+}
@@ -0,0 +1,129 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file AudioIOTelemetry.h
+ @brief Lock-free collection of timings of the audio callback and the Audio
+ thread, for sizing of latencies
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_AUDIO_IO_TELEMETRY__
+#define __AUDACITY_AUDIO_IO_TELEMETRY__
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "MemoryX.h" // NonInterfering
+
+class wxString;
+
+//! Collects timings from the PortAudio callback and the Audio thread
+/*!
+ Each of the two Record functions may be called from one producer thread only,
+ and does not block or allocate.  The other functions are for one consumer
+ thread, typically the main thread, which moves records out of the lock-free
+ queues into a bounded history, summarizes it, or writes it out.
+ */
+class AUDIO_IO_API AudioIOTelemetry final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+   using Duration = std::chrono::nanoseconds;
+
+   //! Measurements of one invocation of AudioIoCallback::AudioCallback
+   struct CallbackRecord {
+      Clock::time_point start;
+      Duration duration{};
+      Duration playthrough{};
+      unsigned long frames{};
+      //! Seconds of real time that the buffer represents; the deadline
+      double period{};
+      //! Frames ready in all the playback ring buffers, at entry
+      size_t playbackReady{};
+      //! Frames free in all the capture ring buffers, at entry
+      size_t captureFree{};
+   };
+
+   //! Measurements of one pass of SequenceBufferExchange in the Audio thread
+   struct ExchangeRecord {
+      Clock::time_point start;
+      Duration duration{};
+      //! Part of duration spent in realtime effect processing
+      Duration realtimeEffects{};
+   };
+
+   struct Summary {
+      size_t count{};
+      Duration mean{};
+      Duration p99{};
+      Duration max{};
+   };
+
+   struct Stats {
+      Summary callback;
+      Summary playthrough;
+      Summary exchange;
+      Summary realtimeEffects;
+      //! Standard deviation of the intervals between callback starts
+      Duration callbackJitter{};
+      //! Greatest ratio of callback duration to its period
+      double maxLoad{};
+      size_t minPlaybackReady{};
+      size_t minCaptureFree{};
+      //! How many records were lost because a queue was full
+      size_t dropped{};
+   };
+
+   //! @param capacity of each of the lock-free queues
+   //! @param historyLength how many records of each kind to retain
+   explicit AudioIOTelemetry(
+      size_t capacity = 4096, size_t historyLength = 65536);
+   ~AudioIOTelemetry();
+
+   void SetEnabled(bool enabled)
+   { mEnabled.store(enabled, std::memory_order_relaxed); }
+   bool IsEnabled() const
+   { return mEnabled.load(std::memory_order_relaxed); }
+
+   //! Called only from the PortAudio callback thread
+   void RecordCallback(const CallbackRecord &record);
+   //! Called only from the Audio thread
+   void RecordExchange(const ExchangeRecord &record);
+
+   //! Summarize the history, after moving pending records into it
+   Stats GetStats();
+   //! Forget the history and pending records
+   void Reset();
+   //! Write the history as comma separated values, one line per record
+   /*! @return success */
+   bool WriteCsv(const wxString &path);
+
+private:
+   //! Bounded single-producer, single-consumer queue
+   template<typename Record> class Queue {
+   public:
+      explicit Queue(size_t capacity) : mRecords(capacity + 1) {}
+      bool Push(const Record &record);
+      template<typename F> void PopAll(const F &f);
+   private:
+      std::vector<Record> mRecords;
+      NonInterfering<std::atomic<size_t>> mRead{ 0 }, mWrite{ 0 };
+   };
+
+   //! Consumer side
+   void Collect();
+
+   std::atomic<bool> mEnabled{ false };
+   NonInterfering<std::atomic<size_t>> mDropped{ 0 };
+   Queue<CallbackRecord> mCallbacks;
+   Queue<ExchangeRecord> mExchanges;
+
+   const size_t mHistoryLength;
+   std::deque<CallbackRecord> mCallbackHistory;
+   std::deque<ExchangeRecord> mExchangeHistory;
+};
+
+#endif
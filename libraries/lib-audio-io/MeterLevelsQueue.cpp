@@ -0,0 +1,96 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file MeterLevelsQueue.cpp
+
+ **********************************************************************/
+
+#include "MeterLevelsQueue.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "VectorOps.h"
+
+float MeterLevelsQueue::Levels::Rms(size_t channel) const
+{
+   return std::sqrt(squares[channel] / nFrames);
+}
+
+void MeterLevelsQueue::Levels::Merge(const Levels &other)
+{
+   nChannels = std::max(nChannels, other.nChannels);
+   nFrames += other.nFrames;
+   for (size_t c = 0; c < other.nChannels; ++c) {
+      peaks[c] = std::max(peaks[c], other.peaks[c]);
+      squares[c] += other.squares[c];
+   }
+}
+
+MeterLevelsQueue::MeterLevelsQueue(size_t capacity)
+   : mQueue{ std::max<size_t>(1, capacity) }
+{
+}
+
+void MeterLevelsQueue::Reset(double sampleRate)
+{
+   mBlockFrames.store(
+      std::max<size_t>(1, static_cast<size_t>(sampleRate / 100)),
+      std::memory_order_relaxed);
+   mResetPending.store(true, std::memory_order_release);
+}
+
+void MeterLevelsQueue::Accumulate(
+   unsigned nChannels, size_t nFrames, const float *interleaved)
+{
+   if (mResetPending.exchange(false, std::memory_order_acquire))
+      mPending = {};
+
+   const auto nMeasured =
+      std::min<unsigned>(nChannels, static_cast<unsigned>(MaxChannels));
+   if (nMeasured != mPending.nChannels) {
+      if (mPending.nFrames > 0)
+         Push();
+      mPending = {};
+      mPending.nChannels = nMeasured;
+   }
+   if (nMeasured == 0)
+      return;
+
+   const auto blockFrames = mBlockFrames.load(std::memory_order_relaxed);
+   while (nFrames > 0) {
+      // While the queue is full, blocks grow by whole multiples
+      const auto count = std::min(nFrames,
+         blockFrames - mPending.nFrames % blockFrames);
+      if (nMeasured == nChannels)
+         VectorOps::AccumulateLevels(interleaved, nChannels, count,
+            mPending.peaks.data(), mPending.squares.data());
+      else
+         for (size_t frame = 0; frame < count; ++frame)
+            VectorOps::AccumulateLevels(interleaved + frame * nChannels,
+               nMeasured, 1, mPending.peaks.data(), mPending.squares.data());
+      mPending.nFrames += count;
+      interleaved += count * nChannels;
+      nFrames -= count;
+      if (mPending.nFrames % blockFrames == 0)
+         Push();
+   }
+}
+
+void MeterLevelsQueue::Push()
+{
+   if (!mQueue.TryPush(mPending))
+      // Keep accumulating, to merge with the next block
+      return;
+   const auto nChannels = mPending.nChannels;
+   mPending = {};
+   mPending.nChannels = nChannels;
+}
+
+bool MeterLevelsQueue::Drain(Levels &levels)
+{
+   levels = {};
+   mQueue.ConsumeAll([&](Levels &&block){ levels.Merge(block); });
+   return levels.nFrames > 0;
+}
@@ -0,0 +1,71 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file MeterLevelsQueue.h
+ @brief Peak and RMS levels of each channel, measured in the audio callback
+ and read at the rate of the display
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_METER_LEVELS_QUEUE__
+#define __AUDACITY_METER_LEVELS_QUEUE__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "SPSCQueue.h"
+
+//! Decimates samples given to a Meter into one record of levels for each
+//! block of frames, for one consumer thread
+/*!
+ The producer, usually Meter::UpdateDisplay() in the PortAudio callback, never
+ waits nor allocates; the cost per frame is one vector reduction over the
+ channels.  When the consumer falls behind and the queue is full, blocks
+ merge, so the levels are coarser but nothing is lost.
+
+ Channels beyond MaxChannels are not measured.
+ */
+class AUDIO_IO_API MeterLevelsQueue final {
+public:
+   static constexpr size_t MaxChannels = 64;
+
+   struct Levels {
+      unsigned nChannels{ 0 };
+      size_t nFrames{ 0 };
+      std::array<float, MaxChannels> peaks{};
+      //! Sums of the squares of the samples, so that levels may be merged
+      std::array<float, MaxChannels> squares{};
+
+      //! May be called only when nFrames > 0
+      float Rms(size_t channel) const;
+      void Merge(const Levels &other);
+   };
+
+   explicit MeterLevelsQueue(size_t capacity = 32);
+
+   //! Measure blocks of about 10 ms at the rate; the producer discards
+   //! what it measured so far at its next Accumulate(); any thread
+   void Reset(double sampleRate);
+
+   //! For the producer only
+   void Accumulate(
+      unsigned nChannels, size_t nFrames, const float *interleaved);
+
+   //! For the consumer only; merges all blocks measured since the last call
+   /*! @return false, and empty levels, if there were none */
+   bool Drain(Levels &levels);
+
+private:
+   void Push();
+
+   SPSCQueue<Levels> mQueue;
+   std::atomic<size_t> mBlockFrames{ 441 };
+   std::atomic<bool> mResetPending{ false };
+
+   //! Of the producer only
+   Levels mPending;
+};
+
+#endif
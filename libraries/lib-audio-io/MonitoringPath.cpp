@@ -0,0 +1,114 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file MonitoringPath.cpp
+
+ **********************************************************************/
+
+#include "MonitoringPath.h"
+
+#include <algorithm>
+#include <thread>
+
+MonitoringPath::Processor::~Processor() = default;
+
+MonitoringPath::MonitoringPath()
+{
+   ResetRoutes();
+}
+
+MonitoringPath::~MonitoringPath()
+{
+   SetProcessor(nullptr);
+}
+
+void MonitoringPath::Prepare(double sampleRate, size_t nInputs)
+{
+   mSampleRate = sampleRate;
+   mNInputs = std::min(nInputs, MaxChannels);
+   if (mpOwnedProcessor)
+      mpOwnedProcessor->Prepare(mSampleRate, mNInputs);
+}
+
+void MonitoringPath::SetProcessor(std::shared_ptr<Processor> pProcessor)
+{
+   if (pProcessor && mNInputs > 0)
+      pProcessor->Prepare(mSampleRate, mNInputs);
+   mpProcessor.store(pProcessor.get());
+   // A Process() that began before the store may still use the old one
+   while (mProcessing.load())
+      std::this_thread::yield();
+   mpOwnedProcessor = std::move(pProcessor);
+}
+
+void MonitoringPath::SetRoute(size_t input, size_t output, float gain)
+{
+   if (input >= MaxChannels || output >= MaxChannels)
+      return;
+   if (!mExplicitRoutes.load(std::memory_order_relaxed)) {
+      for (auto &row : mGains)
+         for (auto &g : row)
+            g.store(0.0f, std::memory_order_relaxed);
+      mExplicitRoutes.store(true, std::memory_order_relaxed);
+   }
+   mGains[input][output].store(gain, std::memory_order_relaxed);
+}
+
+void MonitoringPath::ResetRoutes()
+{
+   mExplicitRoutes.store(false, std::memory_order_relaxed);
+   for (size_t ii = 0; ii < MaxChannels; ++ii)
+      for (size_t oo = 0; oo < MaxChannels; ++oo)
+         mGains[ii][oo].store(ii == oo ? 1.0f : 0.0f,
+            std::memory_order_relaxed);
+}
+
+void MonitoringPath::Process(constSamplePtr input, sampleFormat format,
+   size_t nInputs, float *output, size_t nOutputs, size_t nFrames) noexcept
+{
+   const auto nMonitored = std::min(nInputs, MaxChannels);
+   if (!input || nMonitored == 0 || nOutputs == 0)
+      return;
+
+   mProcessing.store(true);
+   const auto pProcessor = mpProcessor.load();
+   float *channels[MaxChannels];
+   for (size_t c = 0; c < nMonitored; ++c)
+      channels[c] = mBlock[c].data();
+
+   const auto frameSize = nInputs * SAMPLE_SIZE(format);
+   for (size_t done = 0; done < nFrames;) {
+      const auto len = std::min(MaxBlockFrames, nFrames - done);
+      const auto src = input + done * frameSize;
+      for (size_t c = 0; c < nMonitored; ++c)
+         SamplesToFloats(src + c * SAMPLE_SIZE(format), format,
+            channels[c], len, nInputs, 1);
+      if (pProcessor)
+         pProcessor->Process(channels, nMonitored, len);
+      Mix(nMonitored, nOutputs, len, output + done * nOutputs);
+      done += len;
+   }
+   mProcessing.store(false);
+}
+
+void MonitoringPath::Mix(size_t nInputs, size_t nOutputs, size_t nFrames,
+   float *output) noexcept
+{
+   const auto nRouted = std::min(nOutputs, MaxChannels);
+   // One input channel goes to all output channels by default
+   const bool spread =
+      nInputs == 1 && !mExplicitRoutes.load(std::memory_order_relaxed);
+   for (size_t ii = 0; ii < nInputs; ++ii) {
+      const auto &block = mBlock[ii];
+      for (size_t oo = 0; oo < nRouted; ++oo) {
+         const auto gain = spread
+            ? 1.0f : mGains[ii][oo].load(std::memory_order_relaxed);
+         if (gain == 0.0f)
+            continue;
+         auto pOut = output + oo;
+         for (size_t ff = 0; ff < nFrames; ++ff, pOut += nOutputs)
+            *pOut += gain * block[ff];
+      }
+   }
+}
@@ -0,0 +1,99 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file MonitoringPath.h
+ @brief Software playthrough of the input, routed and optionally processed,
+ in the audio callback
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_MONITORING_PATH__
+#define __AUDACITY_MONITORING_PATH__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "SampleFormat.h"
+
+//! Adds the captured input to the output of the same PortAudio callback, so
+//! that monitoring has the latency of the device buffers and not that of the
+//! ring buffers
+/*!
+ Each input channel goes to the output channels with its own gains.  Unless
+ routes are set, input channel c goes to output channel c, and a single input
+ channel to all outputs.
+
+ A Processor may transform the input before it is routed, as a chain of
+ realtime effects would.
+
+ Process() never waits nor allocates.  Channels beyond MaxChannels are not
+ monitored.
+ */
+class AUDIO_IO_API MonitoringPath final {
+public:
+   static constexpr size_t MaxChannels = 32;
+   //! Frames given to the Processor at once, at most
+   static constexpr size_t MaxBlockFrames = 256;
+
+   //! Transforms monitored input in the audio callback
+   class AUDIO_IO_API Processor {
+   public:
+      virtual ~Processor();
+
+      //! Called in the main thread before any Process() in a new format
+      virtual void Prepare(double sampleRate, size_t nChannels) = 0;
+
+      //! Transform buffers in place; called in the audio callback, so it must
+      //! not wait nor allocate
+      /*! @pre `nFrames <= MaxBlockFrames` */
+      virtual void Process(
+         float *const *channels, size_t nChannels, size_t nFrames) noexcept
+         = 0;
+   };
+
+   MonitoringPath();
+   ~MonitoringPath();
+
+   //! Main thread only, before the stream starts
+   void Prepare(double sampleRate, size_t nInputs);
+
+   //! Replace the processor, or remove it if null; main thread only
+   /*! Waits for a pending Process() to finish with the previous processor,
+    which is then destroyed */
+   void SetProcessor(std::shared_ptr<Processor> pProcessor);
+
+   //! Set the gain from an input channel to an output channel, and make all
+   //! routes explicit, initially silent; any thread
+   void SetRoute(size_t input, size_t output, float gain);
+   //! Return to the default routes; any thread
+   void ResetRoutes();
+
+   //! For the audio callback only; adds to the interleaved output
+   /*! @param input interleaved */
+   void Process(constSamplePtr input, sampleFormat format, size_t nInputs,
+      float *output, size_t nOutputs, size_t nFrames) noexcept;
+
+private:
+   void Mix(size_t nInputs, size_t nOutputs, size_t nFrames,
+      float *output) noexcept;
+
+   using Row = std::array<std::atomic<float>, MaxChannels>;
+   std::array<Row, MaxChannels> mGains;
+   std::atomic<bool> mExplicitRoutes{ false };
+
+   //! Of the main thread only, owning what mpProcessor points to
+   std::shared_ptr<Processor> mpOwnedProcessor;
+   std::atomic<Processor*> mpProcessor{ nullptr };
+   //! True while Process() may use the processor it loaded
+   std::atomic<bool> mProcessing{ false };
+   double mSampleRate{ 44100.0 };
+   size_t mNInputs{ 0 };
+
+   //! Of the audio callback only; deinterleaved input of one block
+   std::array<std::array<float, MaxBlockFrames>, MaxChannels> mBlock;
+};
+
+#endif
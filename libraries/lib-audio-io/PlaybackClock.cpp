@@ -0,0 +1,103 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file PlaybackClock.cpp
+
+ **********************************************************************/
+
+#include "PlaybackClock.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+//! A greater change of time than this many times the real time drained is no
+//! play at any speed, but a seek or the wrap of a loop
+constexpr double MaxSpeed = 64.0;
+}
+
+void PlaybackClock::Reset(double time, Clock::time_point now)
+{
+   mLastTime = time;
+   mLastSpeed = 0;
+   mPending = 0;
+   Store(time, 0, 0, now, ++mLastEpoch);
+}
+
+void PlaybackClock::Publish(double time, double consumed,
+   Clock::time_point now)
+{
+   mPending += consumed;
+   if (time == mLastTime)
+      // The TimeQueue gave no new record yet; readers keep extrapolating
+      return;
+
+   const auto delta = time - mLastTime;
+   auto speed = mPending > 0 ? delta / mPending : 0;
+   if (std::abs(speed) > MaxSpeed || speed * mLastSpeed < 0) {
+      // Discontinuity; estimate the speed again at the next change
+      ++mLastEpoch;
+      speed = std::abs(speed) > MaxSpeed ? 0 : speed;
+   }
+   Store(time, speed, mPending, now, mLastEpoch);
+   mLastTime = time;
+   mLastSpeed = speed;
+   mPending = 0;
+}
+
+void PlaybackClock::Store(double time, double speed, double horizon,
+   Clock::time_point stamp, unsigned epoch)
+{
+   const auto sequence = mSequence.load(std::memory_order_relaxed);
+   mSequence.store(sequence + 1, std::memory_order_relaxed);
+   // Readers that see any of the stores below see the odd sequence too
+   std::atomic_thread_fence(std::memory_order_release);
+   mTime.store(time, std::memory_order_relaxed);
+   mSpeed.store(speed, std::memory_order_relaxed);
+   mHorizon.store(horizon, std::memory_order_relaxed);
+   mStamp.store(stamp.time_since_epoch().count(), std::memory_order_relaxed);
+   mEpoch.store(epoch, std::memory_order_relaxed);
+   mSequence.store(sequence + 2, std::memory_order_release);
+}
+
+auto PlaybackClock::Read() const -> Reading
+{
+   Reading reading;
+   unsigned sequence;
+   do {
+      sequence = mSequence.load(std::memory_order_acquire);
+      reading.time = mTime.load(std::memory_order_relaxed);
+      reading.speed = mSpeed.load(std::memory_order_relaxed);
+      reading.horizon = mHorizon.load(std::memory_order_relaxed);
+      reading.stamp = Clock::time_point{
+         Clock::duration{ mStamp.load(std::memory_order_relaxed) } };
+      reading.epoch = mEpoch.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+   } while ((sequence & 1) ||
+      sequence != mSequence.load(std::memory_order_relaxed));
+   return reading;
+}
+
+double PlaybackClock::Interpolator::Get(
+   const PlaybackClock &clock, Clock::time_point at)
+{
+   const auto reading = clock.Read();
+   const auto elapsed = std::clamp(
+      std::chrono::duration<double>(at - reading.stamp).count(),
+      0.0, reading.horizon);
+   auto time = reading.time + reading.speed * elapsed;
+   if (mValid && mEpoch == reading.epoch)
+      time = reading.speed < 0
+         ? std::min(time, mLast)
+         : std::max(time, mLast);
+   mLast = time;
+   mEpoch = reading.epoch;
+   mValid = true;
+   return time;
+}
+
+void PlaybackClock::Interpolator::Reset()
+{
+   mValid = false;
+}
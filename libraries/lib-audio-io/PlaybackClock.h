@@ -0,0 +1,95 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file PlaybackClock.h
+ @brief Publishes the play position from the PortAudio callback, for smooth
+ display by other threads
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_PLAYBACK_CLOCK__
+#define __AUDACITY_PLAYBACK_CLOCK__
+
+#include <atomic>
+#include <chrono>
+
+//! The sequence time last drained from the TimeQueue, with the moment it was
+//! drained and the speed at which it advances
+/*!
+ There is one writer, the PortAudio callback, or the main thread while the
+ stream is not running.  Readers in any thread never block it: Publish() is
+ wait-free and Read() retries only when it overlaps a Publish().
+
+ The TimeQueue gives a new time only once per TimeQueueGrainSize frames, so a
+ reader that polls the time sees it jump.  An Interpolator instead estimates
+ the time at the moment of each display frame.
+ */
+class AUDIO_IO_API PlaybackClock final {
+public:
+   using Clock = std::chrono::steady_clock;
+
+   struct Reading {
+      //! Sequence time at stamp
+      double time{ 0 };
+      //! Sequence seconds per real second, negative when playing backwards
+      double speed{ 0 };
+      //! Real seconds after stamp, beyond which the time is not extrapolated
+      double horizon{ 0 };
+      Clock::time_point stamp{};
+      //! Changes at each discontinuity, such as a seek or the wrap of a loop
+      unsigned epoch{ 0 };
+   };
+
+   //! Estimates of the time between readings, for one reader
+   /*!
+    Each estimate is monotonic in the direction of play within an epoch: when
+    a new reading falls behind what was estimated already, the estimate holds
+    until the reading catches up, so that a play head never steps back.
+    */
+   class AUDIO_IO_API Interpolator final {
+   public:
+      double Get(const PlaybackClock &clock, Clock::time_point at);
+      //! The next estimate follows the reading, without the monotonic clamp
+      void Reset();
+
+   private:
+      double mLast{ 0 };
+      unsigned mEpoch{ 0 };
+      bool mValid{ false };
+   };
+
+   //! Starts a new epoch at the time, standing still until published again
+   void Reset(double time, Clock::time_point now = Clock::now());
+
+   //! Called in the PortAudio callback after draining the TimeQueue
+   /*!
+    @param time the sequence time now heard
+    @param consumed real seconds of frames drained in this callback
+    */
+   void Publish(double time, double consumed,
+      Clock::time_point now = Clock::now());
+
+   Reading Read() const;
+
+private:
+   void Store(double time, double speed, double horizon,
+      Clock::time_point stamp, unsigned epoch);
+
+   //! Odd while Store() is writing
+   std::atomic<unsigned> mSequence{ 0 };
+   std::atomic<double> mTime{ 0 };
+   std::atomic<double> mSpeed{ 0 };
+   std::atomic<double> mHorizon{ 0 };
+   std::atomic<Clock::rep> mStamp{ 0 };
+   std::atomic<unsigned> mEpoch{ 0 };
+
+   //! @section State of the writer only
+   double mLastTime{ 0 };
+   double mLastSpeed{ 0 };
+   //! Real seconds drained since the time last changed
+   double mPending{ 0 };
+   unsigned mLastEpoch{ 0 };
+};
+
+#endif
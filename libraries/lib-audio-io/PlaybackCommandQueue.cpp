@@ -0,0 +1,69 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file PlaybackCommandQueue.cpp
+
+ **********************************************************************/
+
+#include "PlaybackCommandQueue.h"
+
+#include <algorithm>
+
+PlaybackCommandQueue::PlaybackCommandQueue(size_t capacity)
+   : mQueue{ std::max<size_t>(1, capacity) }
+{
+   // At most one deferred command of each kind
+   mDeferred.reserve(std::variant_size_v<Command>);
+}
+
+PlaybackCommandQueue::~PlaybackCommandQueue() = default;
+
+void PlaybackCommandQueue::Coalesce(
+   std::vector<Command> &commands, const Command &command)
+{
+   const auto iter = std::find_if(commands.begin(), commands.end(),
+      [&](const Command &other){ return other.index() == command.index(); });
+   if (iter == commands.end())
+      commands.push_back(command);
+   else if (auto pSeek = std::get_if<Seek>(&*iter))
+      // Seeks are relative, so they accumulate
+      pSeek->offset += std::get<Seek>(command).offset;
+   else
+      // Other commands are states, so the latest wins
+      *iter = command;
+}
+
+void PlaybackCommandQueue::Post(const Command &command)
+{
+   // Preserve order: don't let the new command overtake deferred ones
+   if (!Retry() || !mQueue.TryPush(command))
+      Coalesce(mDeferred, command);
+}
+
+bool PlaybackCommandQueue::Retry()
+{
+   auto iter = mDeferred.begin();
+   for (const auto end = mDeferred.end();
+      iter != end && mQueue.TryPush(*iter); ++iter)
+      ;
+   mDeferred.erase(mDeferred.begin(), iter);
+   return mDeferred.empty();
+}
+
+auto PlaybackCommandQueue::Consume() -> Batch
+{
+   Batch batch;
+   mQueue.ConsumeAll([&](Command &&command){
+      std::visit([&](const auto &arg){
+         using T = std::decay_t<decltype(arg)>;
+         if constexpr (std::is_same_v<T, Seek>)
+            batch.seek = batch.seek.value_or(0) + arg.offset;
+         else if constexpr (std::is_same_v<T, LoopRegion>)
+            batch.loopRegion = arg;
+         else
+            batch.speed = arg.speed;
+      }, command);
+   });
+   return batch;
+}
@@ -0,0 +1,78 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file PlaybackCommandQueue.h
+ @brief Carries changes of seek position, loop region and speed from the main
+ thread to the Audio thread
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_PLAYBACK_COMMAND_QUEUE__
+#define __AUDACITY_PLAYBACK_COMMAND_QUEUE__
+
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include "SPSCQueue.h"
+
+//! Commands for a PlaybackPolicy, posted by one thread and consumed in batches
+//! by the thread that calls AudioIO::SequenceBufferExchange
+/*!
+ Neither Post() nor Consume() ever waits.  If the queue is full because the
+ consumer is stalled, commands are coalesced on the producer side and sent
+ with the next Post() or Retry(), so the latest state is never lost.
+ */
+class AUDIO_IO_API PlaybackCommandQueue final {
+public:
+   //! Move the play head by a relative amount of sequence time
+   struct Seek {
+      double offset{};
+   };
+   //! Change the looping bounds, or turn looping on or off
+   struct LoopRegion {
+      double t0{};
+      double t1{};
+      bool enabled{};
+   };
+   //! Change the playback speed
+   struct Speed {
+      double speed{ 1.0 };
+   };
+   using Command = std::variant<Seek, LoopRegion, Speed>;
+
+   //! Net effect of all commands consumed at once
+   struct Batch {
+      //! Sum of all seek offsets, if there were any seeks
+      std::optional<double> seek;
+      //! The latest loop region, if there was any
+      std::optional<LoopRegion> loopRegion;
+      //! The latest speed, if there was any
+      std::optional<double> speed;
+
+      bool empty() const { return !seek && !loopRegion && !speed; }
+   };
+
+   explicit PlaybackCommandQueue(size_t capacity = 64);
+   ~PlaybackCommandQueue();
+
+   //! For the producer only
+   void Post(const Command &command);
+   //! For the producer only; send commands deferred because the queue was full
+   /*! @return whether none remain deferred */
+   bool Retry();
+
+   //! For the consumer only; remove all available commands and combine them
+   Batch Consume();
+
+private:
+   //! Merge a command into a list holding at most one of each kind
+   static void Coalesce(std::vector<Command> &commands, const Command &command);
+
+   SPSCQueue<Command> mQueue;
+   //! Producer side only
+   std::vector<Command> mDeferred;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file PlaybackPrefetch.cpp
+
+ **********************************************************************/
+
+#include "PlaybackPrefetch.h"
+
+PlaybackPrefetchPool::PlaybackPrefetchPool(
+   size_t nWorkers, std::function<void()> configure)
+   : mCounters{ std::make_unique<Counters[]>(nWorkers + 1) }
+{
+   mWorkers.reserve(nWorkers);
+   for (size_t iWorker = 0; iWorker < nWorkers; ++iWorker)
+      mWorkers.emplace_back([this, iWorker, configure]{
+         WorkerLoop(iWorker, configure);
+      });
+}
+
+PlaybackPrefetchPool::~PlaybackPrefetchPool()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStopping = true;
+   }
+   mStartCondition.notify_all();
+   for (auto &worker : mWorkers)
+      worker.join();
+}
+
+void PlaybackPrefetchPool::Run(
+   size_t nTasks, TaskFunction function, void *context)
+{
+   if (nTasks == 0)
+      return;
+
+   auto &callerCounters = mCounters[mWorkers.size()];
+   if (mWorkers.empty() || nTasks == 1) {
+      // No need to wake anyone
+      mFunction = function;
+      mContext = context;
+      mNTasks = nTasks;
+      mNextTask.store(0, std::memory_order_relaxed);
+      Participate(callerCounters);
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mFunction = function;
+      mContext = context;
+      mNTasks = nTasks;
+      mNextTask.store(0, std::memory_order_relaxed);
+      // Every worker acknowledges every batch, even if it finds no task left
+      mBusyWorkers = mWorkers.size();
+      ++mGeneration;
+   }
+   mStartCondition.notify_all();
+
+   Participate(callerCounters);
+
+   // Wait for the stragglers; the mutex then also makes their writes visible
+   std::unique_lock<std::mutex> lock{ mMutex };
+   mDoneCondition.wait(lock, [this]{ return mBusyWorkers == 0; });
+}
+
+void PlaybackPrefetchPool::Participate(Counters &counters)
+{
+   using Clock = std::chrono::steady_clock;
+   while (true) {
+      const auto iTask = mNextTask.fetch_add(1, std::memory_order_relaxed);
+      if (iTask >= mNTasks)
+         break;
+      const auto start = Clock::now();
+      mFunction(mContext, iTask);
+      const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+         Clock::now() - start).count();
+      counters.tasks.fetch_add(1, std::memory_order_relaxed);
+      counters.busy.fetch_add(elapsed, std::memory_order_relaxed);
+      if (elapsed > counters.longest.load(std::memory_order_relaxed))
+         counters.longest.store(elapsed, std::memory_order_relaxed);
+   }
+}
+
+void PlaybackPrefetchPool::WorkerLoop(
+   size_t iWorker, const std::function<void()> &configure)
+{
+   if (configure)
+      configure();
+   uint64_t generation = 0;
+   auto &counters = mCounters[iWorker];
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mStartCondition.wait(lock, [&]{
+            return mStopping || mGeneration != generation; });
+         if (mStopping)
+            return;
+         generation = mGeneration;
+      }
+
+      Participate(counters);
+
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (--mBusyWorkers == 0)
+            mDoneCondition.notify_one();
+      }
+   }
+}
+
+std::vector<PlaybackPrefetchStats> PlaybackPrefetchPool::GetStats() const
+{
+   std::vector<PlaybackPrefetchStats> result(mWorkers.size() + 1);
+   for (size_t ii = 0; ii < result.size(); ++ii) {
+      auto &counters = mCounters[ii];
+      result[ii] = {
+         counters.tasks.load(std::memory_order_relaxed),
+         std::chrono::nanoseconds{
+            counters.busy.load(std::memory_order_relaxed) },
+         std::chrono::nanoseconds{
+            counters.longest.load(std::memory_order_relaxed) },
+      };
+   }
+   return result;
+}
+
+void PlaybackPrefetchPool::ResetStats()
+{
+   for (size_t ii = 0; ii <= mWorkers.size(); ++ii) {
+      auto &counters = mCounters[ii];
+      counters.tasks.store(0, std::memory_order_relaxed);
+      counters.busy.store(0, std::memory_order_relaxed);
+      counters.longest.store(0, std::memory_order_relaxed);
+   }
+}
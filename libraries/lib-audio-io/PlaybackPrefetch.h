@@ -0,0 +1,106 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file PlaybackPrefetch.h
+ @brief A small pool of threads helping the Audio thread to fetch samples of
+ many playback sequences at once
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_PLAYBACK_PREFETCH__
+#define __AUDACITY_PLAYBACK_PREFETCH__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MemoryX.h" // NonInterferingBase
+
+//! Timing totals for one participant in PlaybackPrefetchPool::Run
+struct AUDIO_IO_API PlaybackPrefetchStats {
+   //! How many tasks the participant completed
+   uint64_t tasks{};
+   //! Total time spent in tasks
+   std::chrono::nanoseconds busy{};
+   //! Longest single task
+   std::chrono::nanoseconds longest{};
+};
+
+//! Runs a batch of independent tasks on some worker threads and the caller
+/*!
+ The calling thread (the Audio thread) participates in each batch, so that a
+ pool of zero workers degenerates to a simple loop.
+
+ Run() does not allocate memory and is only to be called from one thread at
+ a time.  Statistics may be read from any thread.
+ */
+class AUDIO_IO_API PlaybackPrefetchPool final
+{
+public:
+   //! Function called for each task index in [0, nTasks)
+   using TaskFunction = void (*)(void *context, size_t iTask);
+
+   /*!
+    @param configure if not empty, is called first in each worker thread, as
+    to change its scheduling
+    */
+   explicit PlaybackPrefetchPool(
+      size_t nWorkers, std::function<void()> configure = {});
+   ~PlaybackPrefetchPool();
+
+   PlaybackPrefetchPool(const PlaybackPrefetchPool&) = delete;
+   PlaybackPrefetchPool &operator =(const PlaybackPrefetchPool&) = delete;
+
+   size_t NumWorkers() const { return mWorkers.size(); }
+
+   //! Perform all tasks, returning only after all are done
+   void Run(size_t nTasks, TaskFunction function, void *context);
+
+   //! Convenience overload accepting a callable taking a task index
+   template<typename F> void Run(size_t nTasks, F &&f)
+   {
+      Run(nTasks, [](void *context, size_t iTask){
+         (*static_cast<std::remove_reference_t<F>*>(context))(iTask);
+      }, &f);
+   }
+
+   //! One entry per worker, then a last entry for the calling thread
+   std::vector<PlaybackPrefetchStats> GetStats() const;
+   void ResetStats();
+
+private:
+   struct Counters : NonInterferingBase {
+      std::atomic<uint64_t> tasks{ 0 };
+      std::atomic<int64_t> busy{ 0 };
+      std::atomic<int64_t> longest{ 0 };
+   };
+
+   void WorkerLoop(size_t iWorker, const std::function<void()> &configure);
+   //! Consume tasks of the current batch until there are none left
+   void Participate(Counters &counters);
+
+   std::vector<std::thread> mWorkers;
+   //! One more than mWorkers, for the caller of Run()
+   std::unique_ptr<Counters[]> mCounters;
+
+   std::mutex mMutex;
+   std::condition_variable mStartCondition;
+   std::condition_variable mDoneCondition;
+   uint64_t mGeneration{ 0 };
+   size_t mBusyWorkers{ 0 };
+   bool mStopping{ false };
+
+   TaskFunction mFunction{};
+   void *mContext{};
+   size_t mNTasks{ 0 };
+   NonInterfering<std::atomic<size_t>> mNextTask{ 0 };
+};
+
+#endif
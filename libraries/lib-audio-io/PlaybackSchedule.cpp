@@ -55,6 +55,11 @@ we can afford even smaller times.
 #endif
 }
 
+bool PlaybackPolicy::AllowLookAhead(PlaybackSchedule &)
+{
+   return true;
+}
+
 bool PlaybackPolicy::AllowSeek(PlaybackSchedule &)
 {
    return true;
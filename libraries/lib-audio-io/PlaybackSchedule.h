@@ -94,6 +94,10 @@ public:
    //! Provide hints for construction of playback RingBuffer objects
    virtual BufferTimes SuggestedBufferTimes(PlaybackSchedule &schedule);
 
+   //! Whether the latency of SuggestedBufferTimes may be lengthened, to
+   //! render realtime effects further ahead
+   virtual bool AllowLookAhead(PlaybackSchedule &schedule);
+
    //! @section Called by the PortAudio callback thread
 
    //! Whether repositioning commands are allowed during playback
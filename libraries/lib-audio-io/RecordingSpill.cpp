@@ -0,0 +1,275 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file RecordingSpill.cpp
+
+ **********************************************************************/
+
+#include "RecordingSpill.h"
+
+#include <cstring>
+#include <wx/filename.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+//! Precedes the samples of each chunk in the file
+struct Header {
+   uint32_t channel;
+   uint32_t format;
+   uint64_t length;
+};
+static_assert(sizeof(Header) == 16);
+
+//! Headers and sample data are kept at multiples of this
+constexpr size_t Alignment = sizeof(Header);
+
+//! Value of Header::channel meaning the rest of the file is unused and the
+//! next chunk is at the start
+constexpr uint32_t WrapMarker = ~uint32_t{};
+
+size_t RoundUp(size_t bytes)
+{
+   return (bytes + Alignment - 1) / Alignment * Alignment;
+}
+}
+
+struct RecordingSpill::Mapping {
+   static std::unique_ptr<Mapping> Create(
+      const wxString &directory, size_t bytes);
+   ~Mapping();
+
+   char *data{};
+   size_t size{};
+#ifdef _WIN32
+   HANDLE file{ INVALID_HANDLE_VALUE };
+   HANDLE mapping{};
+#else
+   int fd{ -1 };
+#endif
+};
+
+auto RecordingSpill::Mapping::Create(const wxString &directory, size_t bytes)
+   -> std::unique_ptr<Mapping>
+{
+   const auto path = wxFileName::CreateTempFileName(
+      directory + wxFILE_SEP_PATH + "capture");
+   if (path.empty())
+      return {};
+
+   auto result = std::make_unique<Mapping>();
+   result->size = bytes;
+
+#ifdef _WIN32
+   // The file is deleted when the last handle closes, even after a crash
+   result->file = CreateFileW(path.wc_str(), GENERIC_READ | GENERIC_WRITE,
+      0, nullptr, OPEN_EXISTING,
+      FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+   if (result->file == INVALID_HANDLE_VALUE) {
+      wxRemoveFile(path);
+      return {};
+   }
+   LARGE_INTEGER size;
+   size.QuadPart = bytes;
+   if (!SetFilePointerEx(result->file, size, nullptr, FILE_BEGIN) ||
+       !SetEndOfFile(result->file))
+      return {};
+   result->mapping = CreateFileMappingW(result->file, nullptr,
+      PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+   if (!result->mapping)
+      return {};
+   result->data = static_cast<char*>(
+      MapViewOfFile(result->mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes));
+   if (!result->data)
+      return {};
+#else
+   result->fd = open(path.fn_str(), O_RDWR);
+   // The open descriptor keeps the storage; nothing is left after a crash
+   unlink(path.fn_str());
+   if (result->fd < 0)
+      return {};
+#ifdef __linux__
+   // Reserve the blocks now, not when the Audio thread first writes them
+   if (posix_fallocate(result->fd, 0, bytes) != 0)
+      return {};
+#else
+   if (ftruncate(result->fd, bytes) != 0)
+      return {};
+#endif
+   const auto data = mmap(nullptr, bytes,
+      PROT_READ | PROT_WRITE, MAP_SHARED, result->fd, 0);
+   if (data == MAP_FAILED)
+      return {};
+   result->data = static_cast<char*>(data);
+#endif
+
+   // Fault in every page, so that the writer doesn't wait for it
+   for (size_t offset = 0; offset < bytes; offset += 4096)
+      result->data[offset] = 0;
+
+   return result;
+}
+
+RecordingSpill::Mapping::~Mapping()
+{
+#ifdef _WIN32
+   if (data)
+      UnmapViewOfFile(data);
+   if (mapping)
+      CloseHandle(mapping);
+   if (file != INVALID_HANDLE_VALUE)
+      CloseHandle(file);
+#else
+   if (data)
+      munmap(data, size);
+   if (fd >= 0)
+      close(fd);
+#endif
+}
+
+std::unique_ptr<RecordingSpill>
+RecordingSpill::Create(const wxString &directory, size_t bytes, Sink sink)
+{
+   // Round down, so that a header always fits before the end of the file
+   bytes = bytes / Alignment * Alignment;
+   if (bytes == 0)
+      return {};
+   auto pMapping = Mapping::Create(directory, bytes);
+   if (!pMapping)
+      return {};
+   return std::unique_ptr<RecordingSpill>{
+      new RecordingSpill{ std::move(pMapping), std::move(sink) } };
+}
+
+RecordingSpill::RecordingSpill(std::unique_ptr<Mapping> pMapping, Sink sink)
+   : mpMapping{ std::move(pMapping) }
+   , mData{ mpMapping->data }
+   , mSize{ mpMapping->size }
+   , mSink{ std::move(sink) }
+{
+   mThread = std::thread{ [this]{ ConversionLoop(); } };
+}
+
+RecordingSpill::~RecordingSpill()
+{
+   Finish();
+}
+
+size_t RecordingSpill::ChunkBytes(size_t length, sampleFormat format)
+{
+   return sizeof(Header) + RoundUp(length * SAMPLE_SIZE(format));
+}
+
+bool RecordingSpill::HasSpace(size_t bytes) const
+{
+   const auto used = mPendingWrite - mRead.load(std::memory_order_acquire);
+   // Allow for the end of the file wasted when a chunk doesn't fit before
+   // the end; that is never more than the size of the chunk
+   return 2 * bytes <= mSize - used;
+}
+
+bool RecordingSpill::WaitForSpace(size_t bytes)
+{
+   if (2 * bytes > mSize)
+      return false;
+   std::unique_lock<std::mutex> lock{ mMutex };
+   mConsumed.wait(lock, [&]{
+      return mStopped.load(std::memory_order_relaxed) || HasSpace(bytes); });
+   return !mStopped.load(std::memory_order_relaxed);
+}
+
+void RecordingSpill::Write(size_t channel,
+   constSamplePtr data, sampleFormat format, size_t length)
+{
+   const auto bytes = ChunkBytes(length, format);
+   auto offset = Offset(mPendingWrite);
+   if (mSize - offset < bytes) {
+      const Header marker{ WrapMarker, 0, 0 };
+      memcpy(mData + offset, &marker, sizeof(marker));
+      mPendingWrite += mSize - offset;
+      offset = 0;
+   }
+   const Header header{ static_cast<uint32_t>(channel),
+      static_cast<uint32_t>(format), length };
+   memcpy(mData + offset, &header, sizeof(header));
+   memcpy(mData + offset + sizeof(header), data, length * SAMPLE_SIZE(format));
+   mPendingWrite += bytes;
+}
+
+void RecordingSpill::Publish()
+{
+   if (mWrite.load(std::memory_order_relaxed) == mPendingWrite)
+      return;
+   // Release, so that the writing of chunks happens-before their reading
+   mWrite.store(mPendingWrite, std::memory_order_release);
+   // Lock, so that the wake-up isn't lost between test and wait
+   { std::lock_guard<std::mutex> lock{ mMutex }; }
+   mPublished.notify_one();
+}
+
+void RecordingSpill::Finish()
+{
+   if (!mThread.joinable())
+      return;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mFinishing = true;
+   }
+   mPublished.notify_one();
+   mThread.join();
+}
+
+void RecordingSpill::ConversionLoop()
+{
+   auto read = mRead.load(std::memory_order_relaxed);
+   while (true) {
+      bool finishing;
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mPublished.wait(lock, [&]{ return mFinishing ||
+            mWrite.load(std::memory_order_relaxed) != read; });
+         finishing = mFinishing;
+      }
+
+      const auto write = mWrite.load(std::memory_order_acquire);
+      mChunks.clear();
+      for (auto position = read; position != write;) {
+         const auto offset = Offset(position);
+         Header header;
+         memcpy(&header, mData + offset, sizeof(header));
+         if (header.channel == WrapMarker) {
+            position += mSize - offset;
+            continue;
+         }
+         const auto format = static_cast<sampleFormat>(header.format);
+         const auto length = static_cast<size_t>(header.length);
+         mChunks.push_back({ header.channel,
+            mData + offset + sizeof(header), format, length });
+         position += ChunkBytes(length, format);
+      }
+
+      const bool stop = !mChunks.empty() &&
+         !mSink(mChunks.data(), mChunks.data() + mChunks.size());
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (stop)
+            mStopped.store(true, std::memory_order_relaxed);
+         else
+            // Release, so that reading of the chunks happens-before
+            // their overwriting
+            mRead.store(read = write, std::memory_order_release);
+      }
+      mConsumed.notify_one();
+
+      if (stop ||
+          (finishing && read == mWrite.load(std::memory_order_acquire)))
+         return;
+   }
+}
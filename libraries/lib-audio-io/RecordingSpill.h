@@ -0,0 +1,113 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file RecordingSpill.h
+ @brief Memory-mapped file that buffers captured samples on their way from
+ the Audio thread to the recording sequences
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_RECORDING_SPILL__
+#define __AUDACITY_RECORDING_SPILL__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SampleFormat.h"
+
+class wxString;
+
+//! A circular, preallocated, memory-mapped file, written by the Audio thread
+//! and converted into appends to RecordableSequences by a thread of its own
+/*!
+ Writing is only a copy into mapped memory, so the latency of database
+ commits of sample blocks stays out of the thread that drains capture
+ buffers.  When the file is full the writer is expected to leave samples in
+ its own buffers and try again later.
+
+ There is one writer thread and the conversion thread is the only reader.
+ */
+class AUDIO_IO_API RecordingSpill final {
+public:
+   //! Samples of one capture channel, pointing into the mapped file
+   struct Chunk {
+      size_t channel;
+      constSamplePtr data;
+      sampleFormat format;
+      size_t length;
+   };
+
+   //! Called in the conversion thread with the chunks available, in order
+   /*!
+    The chunks are valid only during the call.  Return false to end
+    conversion, for instance after an exception.
+    */
+   using Sink = std::function<bool(const Chunk *begin, const Chunk *end)>;
+
+   //! @return null if the file can't be created or mapped
+   static std::unique_ptr<RecordingSpill>
+   Create(const wxString &directory, size_t bytes, Sink sink);
+
+   //! Calls Finish()
+   ~RecordingSpill();
+
+   //! Bytes that a chunk of the given length and format occupies
+   static size_t ChunkBytes(size_t length, sampleFormat format);
+
+   //! For the writer; whether chunks totalling `bytes` can be written now
+   bool HasSpace(size_t bytes) const;
+   //! For the writer; wait until HasSpace(bytes)
+   /*! @return false if conversion has ended, so that space can't come */
+   bool WaitForSpace(size_t bytes);
+
+   //! For the writer
+   /*! @pre HasSpace() was true for at least ChunkBytes(length, format) */
+   void Write(size_t channel,
+      constSamplePtr data, sampleFormat format, size_t length);
+   //! For the writer; make all chunks written so far visible to the
+   //! conversion thread
+   void Publish();
+
+   //! Convert all that was published, then stop the conversion thread
+   void Finish();
+
+private:
+   struct Mapping;
+
+   RecordingSpill(std::unique_ptr<Mapping> pMapping, Sink sink);
+
+   void ConversionLoop();
+   //! Offset in the file of a position
+   size_t Offset(uint64_t position) const { return position % mSize; }
+
+   const std::unique_ptr<Mapping> mpMapping;
+   char *const mData;
+   const size_t mSize;
+   const Sink mSink;
+
+   //! Writer side only; includes unpublished chunks
+   uint64_t mPendingWrite{ 0 };
+   std::atomic<uint64_t> mWrite{ 0 };
+   std::atomic<uint64_t> mRead{ 0 };
+
+   std::mutex mMutex;
+   //! Wakes the conversion thread
+   std::condition_variable mPublished;
+   //! Wakes a writer waiting for space
+   std::condition_variable mConsumed;
+   bool mFinishing{ false };
+   std::atomic<bool> mStopped{ false };
+
+   //! Conversion thread only
+   std::vector<Chunk> mChunks;
+   std::thread mThread;
+};
+
+#endif
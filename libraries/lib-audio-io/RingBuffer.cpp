@@ -33,6 +33,8 @@ RingBuffer::RingBuffer(sampleFormat format, size_t size)
    : mBufferSize{ std::max<size_t>(size, 64) }
    , mFormat{ format }
    , mBuffer{ mBufferSize, mFormat }
+   , mCharge{ MemoryAccounting::Tag::RingBuffers,
+      mBufferSize * SAMPLE_SIZE(mFormat) }
 {
 }
 
@@ -207,6 +209,34 @@ std::pair<samplePtr, size_t> RingBuffer::GetUnflushed(unsigned iBlock)
          size1 };
 }
 
+auto RingBuffer::ReserveForPut(size_t samples) -> Spans<samplePtr>
+{
+   // Acquire, so that reading done in Get() happens-before the writing in
+   // place that the caller will do, just as in Put()
+   auto start = mStart.load( std::memory_order_acquire );
+   const auto end = mWritten;
+   samples = std::min( samples, Free( start, end ) );
+
+   // How many in the first part:
+   const size_t size0 = std::min(samples, mBufferSize - end);
+   // How many wrap around the ring buffer:
+   const size_t size1 = samples - size0;
+
+   return {{
+      { size0 ? mBuffer.ptr() + end * SAMPLE_SIZE(mFormat) : nullptr, size0 },
+      { size1 ? mBuffer.ptr() : nullptr, size1 },
+   }};
+}
+
+size_t RingBuffer::CommitPut(size_t samples)
+{
+   auto start = mStart.load( std::memory_order_relaxed );
+   samples = std::min( samples, Free( start, mWritten ) );
+   mLastPadding = 0;
+   mWritten = (mWritten + samples) % mBufferSize;
+   return samples;
+}
+
 void RingBuffer::Flush()
 {
    // Atomically update the end pointer with release, so the nonatomic writes
@@ -276,3 +306,33 @@ size_t RingBuffer::Discard(size_t samplesToDiscard)
 
    return samplesToDiscard;
 }
+
+auto RingBuffer::PeekForGet(size_t samples) -> Spans<constSamplePtr>
+{
+   // Must match the writer's release with acquire for well defined reads of
+   // the buffer, just as in Get()
+   auto end = mEnd.load( std::memory_order_acquire );
+   auto start = mStart.load( std::memory_order_relaxed );
+   samples = std::min( samples, Filled( start, end ) );
+
+   const size_t size0 = std::min(samples, mBufferSize - start);
+   const size_t size1 = samples - size0;
+
+   return {{
+      { size0 ? mBuffer.ptr() + start * SAMPLE_SIZE(mFormat) : nullptr, size0 },
+      { size1 ? mBuffer.ptr() : nullptr, size1 },
+   }};
+}
+
+size_t RingBuffer::CommitGet(size_t samples)
+{
+   auto end = mEnd.load( std::memory_order_relaxed );
+   auto start = mStart.load( std::memory_order_relaxed );
+   samples = std::min( samples, Filled( start, end ) );
+
+   // Unlike Discard(), use release, because the caller did read the data
+   // in place, and those reads must happen-before any reuse of the space
+   mStart.store((start + samples) % mBufferSize, std::memory_order_release);
+
+   return samples;
+}
@@ -11,7 +11,9 @@
 #ifndef __AUDACITY_RING_BUFFER__
 #define __AUDACITY_RING_BUFFER__
 
+#include "MemoryAccounting.h"
 #include "SampleFormat.h"
+#include <array>
 #include <atomic>
 
 class RingBuffer final : public NonInterferingBase {
@@ -39,6 +41,21 @@ class RingBuffer final : public NonInterferingBase {
    //! Get access to written but unflushed data, which is in at most two blocks
    //! Excludes the padding of the most recent Put()
    std::pair<samplePtr, size_t> GetUnflushed(unsigned iBlock);
+   //! Pointers and lengths of at most two contiguous blocks
+   template<typename Ptr> using Spans = std::array<std::pair<Ptr, size_t>, 2>;
+
+   //! Get access to free space, for writing in place, in at most two blocks
+   /*!
+    The blocks total no more than `samples` and no more than AvailForPut().
+    Sample data in them must be written in the buffer's own format.
+    Follow with CommitPut(), then Flush().
+    */
+   Spans<samplePtr> ReserveForPut(size_t samples);
+   //! Account for samples written in place after ReserveForPut(), like Put()
+   /*!
+    @return how many were committed, which is at most the space reserved
+    */
+   size_t CommitPut(size_t samples);
    //! Flush after a sequence of Put (and/or Clear) calls to let consumer see
    void Flush();
 
@@ -50,6 +67,20 @@ class RingBuffer final : public NonInterferingBase {
    //! Does not apply dithering
    size_t Get(samplePtr buffer, sampleFormat format, size_t samples);
    size_t Discard(size_t samples);
+   //! Get access to flushed data, for reading in place, in at most two blocks
+   /*!
+    The blocks total no more than `samples` and no more than AvailForGet().
+    Sample data are in the buffer's own format, GetFormat().
+    Follow with CommitGet() to release the space to the writer.
+    */
+   Spans<constSamplePtr> PeekForGet(size_t samples);
+   //! Release samples read in place after PeekForGet(), like Get()
+   /*!
+    @return how many were released
+    */
+   size_t CommitGet(size_t samples);
+
+   sampleFormat GetFormat() const { return mFormat; }
 
  private:
    size_t Filled(size_t start, size_t end) const;
@@ -65,6 +96,7 @@ class RingBuffer final : public NonInterferingBase {
 
    const sampleFormat  mFormat;
    const SampleBuffer  mBuffer;
+   const MemoryAccounting::Charge mCharge;
 };
 
 #endif /*  __AUDACITY_RING_BUFFER__ */
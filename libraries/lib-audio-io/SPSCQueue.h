@@ -0,0 +1,90 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file SPSCQueue.h
+ @brief Bounded wait-free queue from one producer thread to one consumer
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_SPSC_QUEUE__
+#define __AUDACITY_SPSC_QUEUE__
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "MemoryX.h" // NonInterfering
+
+//! Bounded queue of values from one producer thread to one consumer thread
+/*!
+ Unlike MessageBuffer, every value pushed is delivered, in order, and neither
+ side ever spins or waits for the other.  When the queue is full, TryPush()
+ fails and the producer decides what to do.
+
+ Data must be default-constructible and reassignable.  The queue allocates
+ only at construction.
+ */
+template<typename Data>
+class SPSCQueue {
+public:
+   explicit SPSCQueue(size_t capacity)
+      // One slot is always empty, to distinguish full from empty
+      : mSlots(capacity + 1)
+   {}
+
+   SPSCQueue(const SPSCQueue&) = delete;
+   SPSCQueue &operator =(const SPSCQueue&) = delete;
+
+   size_t Capacity() const { return mSlots.size() - 1; }
+
+   //! For the producer only
+   /*! @return false, leaving the queue unchanged, if it is full */
+   template<typename Arg = Data&&> bool TryPush(Arg &&arg)
+   {
+      const auto write = mWrite.load(std::memory_order_relaxed);
+      const auto next = Next(write);
+      // Acquire, so that the consumer's reading of the slot happens-before
+      // its reuse
+      if (next == mRead.load(std::memory_order_acquire))
+         return false;
+      mSlots[write] = std::forward<Arg>(arg);
+      // Release, so that the writing of the slot happens-before its reading
+      mWrite.store(next, std::memory_order_release);
+      return true;
+   }
+
+   //! For the consumer only; visit and remove all values now in the queue
+   /*!
+    @param f is called with Data&& for each value, oldest first
+    @return how many values were consumed
+    */
+   template<typename F> size_t ConsumeAll(F &&f)
+   {
+      auto read = mRead.load(std::memory_order_relaxed);
+      const auto write = mWrite.load(std::memory_order_acquire);
+      size_t count = 0;
+      for (; read != write; read = Next(read), ++count)
+         f(std::move(mSlots[read]));
+      mRead.store(read, std::memory_order_release);
+      return count;
+   }
+
+   //! For the consumer only
+   bool Empty() const
+   {
+      return mRead.load(std::memory_order_relaxed) ==
+         mWrite.load(std::memory_order_acquire);
+   }
+
+private:
+   size_t Next(size_t index) const
+   {
+      return ++index == mSlots.size() ? 0 : index;
+   }
+
+   std::vector<Data> mSlots;
+   NonInterfering<std::atomic<size_t>> mRead{ 0 }, mWrite{ 0 };
+};
+
+#endif
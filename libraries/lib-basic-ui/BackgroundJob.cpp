@@ -0,0 +1,90 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BackgroundJob.cpp
+
+**********************************************************************/
+#include "BackgroundJob.h"
+
+#include "concurrency/TaskScheduler.h"
+
+namespace BasicUI {
+
+BackgroundJob::BackgroundJob(Tag, ProgressCallback onProgress)
+   : mOnProgress{ std::move(onProgress) }
+   , mpCancellation{ audacity::concurrency::CancellationContext::Create() }
+{
+}
+
+BackgroundJob::~BackgroundJob() = default;
+
+void BackgroundJob::ReportProgress(double fraction)
+{
+   mProgress.store(fraction, std::memory_order_relaxed);
+   if (!mOnProgress || mProgressQueued.exchange(true))
+      return;
+   CallAfter([wThis = weak_from_this()]{
+      if (auto pThis = wThis.lock()) {
+         pThis->mProgressQueued.store(false);
+         if (!pThis->mFinished && !pThis->IsCancelled())
+            pThis->mOnProgress(
+               pThis->mProgress.load(std::memory_order_relaxed));
+      }
+   });
+}
+
+void BackgroundJob::Cancel()
+{
+   if (!mCancelled.exchange(true))
+      mpCancellation->Cancel();
+}
+
+bool BackgroundJob::IsCancelled() const noexcept
+{
+   return mCancelled.load(std::memory_order_relaxed);
+}
+
+const audacity::concurrency::CancellationContextPtr &
+BackgroundJob::GetCancellationContext() const noexcept
+{
+   return mpCancellation;
+}
+
+bool BackgroundJob::IsFinished() const noexcept
+{
+   return mFinished;
+}
+
+std::shared_ptr<BackgroundJob> detail::StartJob(JobWork work,
+   std::function<void(double)> onProgress, FailureCallback onFailure)
+{
+   auto pJob = std::make_shared<BackgroundJob>(
+      BackgroundJob::Tag{}, std::move(onProgress));
+   audacity::concurrency::TaskScheduler::Get().Submit(
+   [pJob, work = std::move(work), onFailure = std::move(onFailure)]{
+      Action done;
+      try {
+         if (!pJob->IsCancelled())
+            done = work(*pJob);
+      }
+      catch (...) {
+         done = [onFailure, pException = std::current_exception()]{
+            if (onFailure)
+               onFailure(pException);
+            else
+               std::rethrow_exception(pException);
+         };
+      }
+      // The job lives at least until this is dispatched
+      CallAfter([pJob, done = std::move(done)]{
+         pJob->mFinished = true;
+         if (done && !pJob->IsCancelled())
+            done();
+      });
+   });
+   return pJob;
+}
+
+}
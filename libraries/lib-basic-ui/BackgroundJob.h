@@ -0,0 +1,117 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BackgroundJob.h
+  @brief Long operations in worker threads, reporting to the main thread
+
+**********************************************************************/
+#ifndef __AUDACITY_BACKGROUND_JOB__
+#define __AUDACITY_BACKGROUND_JOB__
+
+#include "BasicUI.h"
+#include "concurrency/CancellationContext.h"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+namespace BasicUI {
+
+class BackgroundJob;
+
+namespace detail {
+using JobWork = std::function<Action(BackgroundJob &job)>;
+using FailureCallback = std::function<void(std::exception_ptr)>;
+BASIC_UI_API std::shared_ptr<BackgroundJob> StartJob(JobWork work,
+   std::function<void(double)> onProgress, FailureCallback onFailure);
+}
+
+//! State of an operation that runs in a thread of the shared TaskScheduler,
+//! holding no thread of its own, while the main thread stays responsive
+/*!
+ Several jobs may run at once.  The work must not touch what the main thread
+ may change meanwhile, such as the tracks of an open project, unless it
+ copied them before.
+
+ @see RunInBackground
+ */
+class BASIC_UI_API BackgroundJob final
+   : public std::enable_shared_from_this<BackgroundJob>
+{
+   struct Tag {};
+
+public:
+   using ProgressCallback = std::function<void(double fraction)>;
+
+   BackgroundJob(Tag, ProgressCallback onProgress);
+   ~BackgroundJob();
+
+   BackgroundJob(const BackgroundJob&) = delete;
+   BackgroundJob &operator=(const BackgroundJob&) = delete;
+
+   //! Called by the work, in its thread; the progress callback gets the
+   //! latest fraction in the main thread, once for all the reports made
+   //! between two dispatches of the event loop
+   void ReportProgress(double fraction);
+
+   //! Callbacks not yet called will not be; the work may still run, unless
+   //! it polls IsCancelled(); may be called in any thread
+   void Cancel();
+   bool IsCancelled() const noexcept;
+   //! For the TaskGroups that the work runs, to cancel them with the job
+   const audacity::concurrency::CancellationContextPtr &
+   GetCancellationContext() const noexcept;
+
+   //! Whether the work ended and its callback was due; main thread only
+   bool IsFinished() const noexcept;
+
+private:
+   friend std::shared_ptr<BackgroundJob> detail::StartJob(detail::JobWork,
+      ProgressCallback, detail::FailureCallback);
+
+   const ProgressCallback mOnProgress;
+   const audacity::concurrency::CancellationContextPtr mpCancellation;
+   std::atomic<double> mProgress{ 0 };
+   std::atomic<bool> mProgressQueued{ false };
+   std::atomic<bool> mCancelled{ false };
+   bool mFinished{ false };
+};
+
+//! Run work(job) in a worker thread, then onDone in the main thread, passing
+//! it what the work returned, if anything
+/*!
+ @param onFailure called in the main thread with the exception of the work;
+ if empty, the exception is rethrown there, to the handler of the event loop
+ @return the job, which may be dropped; it lives until done
+ */
+template<typename Work, typename OnDone>
+std::shared_ptr<BackgroundJob> RunInBackground(Work work, OnDone onDone,
+   BackgroundJob::ProgressCallback onProgress = {},
+   detail::FailureCallback onFailure = {})
+{
+   using Result = std::invoke_result_t<Work&, BackgroundJob&>;
+   return detail::StartJob(
+      [work = std::move(work), onDone = std::move(onDone)]
+      (BackgroundJob &job) mutable -> Action {
+         if constexpr (std::is_void_v<Result>) {
+            work(job);
+            return [onDone = std::move(onDone)]() mutable { onDone(); };
+         }
+         else {
+            // Shared, so that a result that can only move fits in an Action
+            auto pResult = std::make_shared<Result>(work(job));
+            return [onDone = std::move(onDone), pResult]() mutable {
+               onDone(std::move(*pResult));
+            };
+         }
+      },
+      std::move(onProgress), std::move(onFailure));
+}
+
+}
+
+#endif
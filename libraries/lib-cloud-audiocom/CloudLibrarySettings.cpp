@@ -28,4 +28,8 @@ StringSetting CloudProjectsSavePath {
 IntSetting DaysToKeepFiles {
    "/cloud/audiocom/DaysToKeepFiles", 30
 };
+
+IntSetting UploadSpeedLimitWhileAudioIOActive {
+   "/cloud/audiocom/UploadSpeedLimitWhileAudioIOActive", 256
+};
 } // namespace audacity::cloud::audiocom
@@ -16,4 +16,6 @@ namespace audacity::cloud::audiocom
 {
 CLOUD_AUDIOCOM_API extern StringSetting CloudProjectsSavePath;
 CLOUD_AUDIOCOM_API extern IntSetting DaysToKeepFiles;
+//! In KB per second, 0 for no limit
+CLOUD_AUDIOCOM_API extern IntSetting UploadSpeedLimitWhileAudioIOActive;
 } // namespace audacity::cloud::audiocom
@@ -10,7 +10,6 @@
 **********************************************************************/
 #include "BlockHasher.h"
 
-#include <algorithm>
 #include <atomic>
 #include <future>
 #include <utility>
@@ -18,6 +17,8 @@
 #include "MemoryX.h"
 #include "SampleBlock.h"
 
+#include "concurrency/TaskScheduler.h"
+
 #include "crypto/SHA256.h"
 
 namespace audacity::cloud::audiocom::sync
@@ -28,65 +29,36 @@ public:
    using SampleData = std::vector<std::remove_pointer_t<samplePtr>>;
 
    explicit Workers(
-      BlockHashCache& cache, const std::vector<LockedBlock> blocks,
+      BlockHashCache& cache, std::vector<LockedBlock> blocks,
       std::function<void()> onComplete)
-       : mThreadsCount { std::max(1u, std::thread::hardware_concurrency() / 2) }
-       , mCache { cache }
+       : mCache { cache }
+       , mBlocks { std::move(blocks) }
+       , mResults(mBlocks.size())
+       , mRemaining { mBlocks.size() }
        , mOnComplete { std::move(onComplete) }
    {
-      mResults.reserve(mThreadsCount);
-
-      const auto blocksCount = blocks.size();
-      // Try to add no more that 1 extra block per thread
-      const size_t blockPerThread = blocks.size() / mThreadsCount + 1;
-
-      for (size_t i = 0; i < mThreadsCount; ++i)
-      {
-         const size_t startIndex = i;
-
-         if (startIndex >= blocks.size())
-            break;
-
-         std::vector<LockedBlock> threadBlocks;
-         threadBlocks.reserve(blockPerThread);
-
-         for (size_t j = startIndex; j < blocksCount; j += mThreadsCount)
-            threadBlocks.emplace_back(blocks[j]);
-
-         mResults.emplace_back(std::async(
-            std::launch::async,
-            [this, threadBlocks = std::move(threadBlocks)]()
-            {
-               Result result;
-               SampleData sampleData;
-
-               for (const auto& block : threadBlocks)
-                  result.emplace(block.Id, ComputeHash(sampleData, block));
-
-               return result;
-            }));
-      }
-
-      mWaiter = std::async(
-         std::launch::async,
-         [this]
+      mGroup.RunRange(
+         0, mBlocks.size(), 1,
+         [this](long long first, long long last)
          {
-            for (auto& fut : mResults)
-               fut.wait();
-
-            NotifyReady();
+            auto done = finally(
+               [&]
+               {
+                  const size_t count = last - first;
+                  if (mRemaining.fetch_sub(count) == count)
+                     NotifyReady();
+               });
+
+            SampleData sampleData;
+
+            for (auto i = first; i < last; ++i)
+               mResults[i] = ComputeHash(sampleData, mBlocks[i]);
          });
    }
 
    bool IsReady() const
    {
-      return std::all_of(
-         mResults.begin(), mResults.end(),
-         [](const auto& result)
-         {
-            return result.wait_for(std::chrono::seconds(0)) ==
-                   std::future_status::ready;
-         });
+      return mRemaining == 0;
    }
 
    std::pair<std::string, bool>
@@ -116,42 +88,54 @@ public:
 
    void NotifyReady()
    {
+      mReady.set_value();
+
       if (mOnComplete)
          mOnComplete();
    }
 
    std::vector<std::pair<int64_t, std::string>> TakeResult()
    {
+      // Not the group's Wait(), as onComplete calls this in the last task
+      mReadyFuture.wait();
+
       std::vector<std::pair<int64_t, std::string>> result;
+      result.reserve(mResults.size());
 
-      for (auto& fut : mResults)
+      for (size_t i = 0; i < mResults.size(); ++i)
       {
-         const auto& threadResult = fut.get();
+         const auto id    = mBlocks[i].Id;
+         const auto& hash = mResults[i];
 
-         for (const auto& [id, hash] : threadResult)
-         {
-            result.emplace_back(std::make_pair(id, hash.first));
+         result.emplace_back(std::make_pair(id, hash.first));
 
-            if (hash.second)
-               mCache.UpdateHash(id, hash.first);
-         }
+         if (hash.second)
+            mCache.UpdateHash(id, hash.first);
       }
 
+      mBlocks.clear();
       mResults.clear();
 
       return result;
    }
 
 private:
-   const size_t mThreadsCount;
-
    BlockHashCache& mCache;
 
-   using Result = std::unordered_map<int64_t, std::pair<std::string, bool>>;
-   std::vector<std::future<Result>> mResults;
-   std::future<void> mWaiter;
+   std::vector<LockedBlock> mBlocks;
+   //! Hash of each block, and whether it was computed rather than cached
+   std::vector<std::pair<std::string, bool>> mResults;
+   std::atomic<size_t> mRemaining;
+   std::promise<void> mReady;
+   const std::shared_future<void> mReadyFuture { mReady.get_future() };
 
    std::function<void()> mOnComplete;
+
+   //! Shares the threads of the process; nobody waits for the hashes, so
+   //! that other work comes first. Waits for its tasks on destruction, so it
+   //! goes first
+   concurrency::TaskGroup mGroup { concurrency::TaskScheduler::Get(),
+                                   concurrency::TaskPriority::Background };
 };
 
 BlockHasher::BlockHasher()  = default;
@@ -283,6 +283,38 @@ std::optional<std::string> CloudProjectsDatabase::GetBlockHash(
    return {};
 }
 
+std::unordered_map<int64_t, std::string>
+CloudProjectsDatabase::GetBlockHashes(std::string_view projectId) const
+{
+   auto connection = GetConnection();
+
+   if (!connection)
+      return {};
+
+   auto statement = connection->CreateStatement(
+      "SELECT block_id, hash FROM block_hashes WHERE project_id = ?");
+
+   if (!statement)
+      return {};
+
+   auto result = statement->Prepare(projectId).Run();
+
+   std::unordered_map<int64_t, std::string> hashes;
+
+   for (auto row : result)
+   {
+      int64_t blockId;
+      std::string hash;
+
+      if (!row.Get(0, blockId) || !row.Get(1, hash))
+         continue;
+
+      hashes.emplace(blockId, std::move(hash));
+   }
+
+   return hashes;
+}
+
 void CloudProjectsDatabase::UpdateBlockHashes(
    std::string_view projectId,
    const std::vector<std::pair<int64_t, std::string>>& hashes)
@@ -13,6 +13,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "sqlite/SafeConnection.h"
@@ -104,6 +105,10 @@ public:
    std::optional<std::string>
    GetBlockHash(std::string_view projectId, int64_t blockId) const;
 
+   //! All the cached hashes of a project, in one query
+   std::unordered_map<int64_t, std::string>
+   GetBlockHashes(std::string_view projectId) const;
+
    void UpdateBlockHashes(
       std::string_view projectId,
       const std::vector<std::pair<int64_t, std::string>>& hashes);
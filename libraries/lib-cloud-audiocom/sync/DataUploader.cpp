@@ -11,6 +11,7 @@
 
 #include "DataUploader.h"
 
+#include <algorithm>
 #include <variant>
 
 #include <wx/file.h>
@@ -25,6 +26,8 @@
 
 #include "BasicUI.h"
 
+#include "SyncThrottling.h"
+
 using namespace audacity::network_manager;
 
 namespace audacity::cloud::audiocom::sync
@@ -69,6 +72,12 @@ struct DataUploader::UploadOperation final :
       Request request { Target.UploadUrl };
       request.setHeader(common_headers::ContentType, MimeType);
 
+      // The uploads in flight share the limit
+      const auto uploadsInFlight = ++Uploader.mUploadsInFlight;
+      if (const auto speedLimit = GetUploadSpeedLimit(); speedLimit > 0)
+         request.setMaxUploadSpeed(
+            std::max<int64_t>(1, speedLimit / uploadsInFlight));
+
       ResponsePtr networkResponse;
 
       if (std::holds_alternative<std::vector<uint8_t>>(Data))
@@ -91,6 +100,8 @@ struct DataUploader::UploadOperation final :
       networkResponse->setRequestFinishedCallback(
          [this, retriesLeft, networkResponse, operation = weak_from_this()](auto)
          {
+            --Uploader.mUploadsInFlight;
+
             auto strongThis = operation.lock();
             if (!strongThis)
                return;
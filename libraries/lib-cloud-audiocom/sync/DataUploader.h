@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -65,6 +66,8 @@ private:
 
    using ResponsesList = std::vector<std::shared_ptr<UploadOperation>>;
    ResponsesList mResponses;
+
+   std::atomic<int64_t> mUploadsInFlight { 0 };
 };
 
 } // namespace audacity::cloud::audiocom::sync
@@ -60,6 +60,9 @@ struct LocalProjectSnapshot::ProjectBlocksLock final : private BlockHashCache
 
    std::unique_ptr<BlockHasher> Hasher;
 
+   //! Read before hashing starts, and only then
+   std::unordered_map<int64_t, std::string> CachedHashes;
+
    std::future<void> UpdateCacheFuture;
    std::vector<std::pair<int64_t, std::string>> NewHashes;
 
@@ -75,8 +78,12 @@ struct LocalProjectSnapshot::ProjectBlocksLock final : private BlockHashCache
 
       if (Extension.IsCloudProject())
       {
-         CloudProjectsDatabase::Get().UpdateProjectBlockList(
-            Extension.GetCloudProjectId(), BlockIds);
+         auto& database = CloudProjectsDatabase::Get();
+         const auto projectId = Extension.GetCloudProjectId();
+         database.UpdateProjectBlockList(projectId, BlockIds);
+         // One query, rather than one per block from the hashing threads,
+         // which the connection lock would serialize
+         CachedHashes = database.GetBlockHashes(projectId);
       }
 
       Hasher = std::make_unique<BlockHasher>();
@@ -149,16 +156,12 @@ struct LocalProjectSnapshot::ProjectBlocksLock final : private BlockHashCache
 
    bool GetHash(int64_t blockId, std::string& hash) const override
    {
-      if (!Extension.IsCloudProject())
-         return false;
-
-      auto cachedResult = CloudProjectsDatabase::Get().GetBlockHash(
-         Extension.GetCloudProjectId(), blockId);
+      auto it = CachedHashes.find(blockId);
 
-      if (!cachedResult)
+      if (it == CachedHashes.end())
          return false;
 
-      hash = std::move(*cachedResult);
+      hash = it->second;
 
       return true;
    }
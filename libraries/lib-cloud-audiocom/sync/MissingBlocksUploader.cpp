@@ -11,12 +11,25 @@
 
 #include "MissingBlocksUploader.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "DataUploader.h"
 
+#include "SyncThrottling.h"
 #include "WavPackCompressor.h"
 
 namespace audacity::cloud::audiocom::sync
 {
+namespace
+{
+// Changes of throughput smaller than that are taken for noise
+constexpr auto ThroughputTolerance = 0.05;
+// Uploads per allowed concurrent upload in a measurement window
+constexpr size_t UploadsPerWindow = 2;
+// How often the idle producers check whether audio I/O has stopped
+constexpr auto ThrottledProducerPollPeriod = std::chrono::milliseconds(100);
+} // namespace
 
 MissingBlocksUploader::MissingBlocksUploader(
    Tag, const ServiceConfig& serviceConfig)
@@ -62,8 +75,16 @@ void MissingBlocksUploader::Start(
 
    mProgressData.TotalBlocks = mUploadTasks.size();
 
-   for (auto& thread : mProducerThread)
-      thread = std::thread([this] { ProducerThread(); });
+   // Compression is CPU bound; leave some cores to the rest of the application,
+   // as BlockHasher does
+   const auto numProducers = std::min<size_t>(
+      std::max(1u, std::thread::hardware_concurrency() / 2),
+      std::max<size_t>(1, mUploadTasks.size()));
+
+   mWindowStart = Clock::now();
+
+   for (size_t i = 0; i < numProducers; ++i)
+      mProducerThreads.emplace_back([this, i] { ProducerThread(i); });
 
    mConsumerThread = std::thread([this] { ConsumerThread(); });
 }
@@ -77,7 +98,7 @@ void MissingBlocksUploader::Cancel()
    mRingBufferNotFull.notify_all();
    mUploadsNotFull.notify_all();
 
-   for (auto& thread : mProducerThread)
+   for (auto& thread : mProducerThreads)
       thread.join();
 
    mConsumerThread.join();
@@ -101,7 +122,7 @@ void MissingBlocksUploader::ConsumeBlock(ProducedItem item)
          lock,
          [this]
          {
-            return mConcurrentUploads < NUM_UPLOADERS ||
+            return mConcurrentUploads < GetConcurrentUploadsLimit() ||
                    !mIsRunning.load(std::memory_order_consume);
          });
 
@@ -111,10 +132,12 @@ void MissingBlocksUploader::ConsumeBlock(ProducedItem item)
       ++mConcurrentUploads;
    }
 
+   const auto uploadedBytes = item.CompressedData.size();
+
    DataUploader::Get().Upload(
       mCancellationContext, mServiceConfig, item.Task.BlockUrls,
       std::move(item.CompressedData),
-      [this, task = item.Task,
+      [this, task = item.Task, uploadedBytes,
        weakThis = weak_from_this()](ResponseResult result)
       {
          auto lock = weakThis.lock();
@@ -125,7 +148,7 @@ void MissingBlocksUploader::ConsumeBlock(ProducedItem item)
          if (result.Code != SyncResultCode::Success)
             HandleFailedBlock(result, task);
          else
-            ConfirmBlock(task);
+            ConfirmBlock(task, uploadedBytes);
       });
 }
 
@@ -172,7 +195,8 @@ MissingBlocksUploader::ProducedItem MissingBlocksUploader::PopBlockFromQueue()
    return std::move(item);
 }
 
-void MissingBlocksUploader::ConfirmBlock(BlockUploadTask item)
+void MissingBlocksUploader::ConfirmBlock(
+   BlockUploadTask item, size_t uploadedBytes)
 {
    MissingBlocksUploadProgress progressData;
    {
@@ -186,10 +210,63 @@ void MissingBlocksUploader::ConfirmBlock(BlockUploadTask item)
    {
       std::lock_guard<std::mutex> lock(mUploadsMutex);
       --mConcurrentUploads;
+      AdaptConcurrentUploads(uploadedBytes);
       mUploadsNotFull.notify_one();
    }
 }
 
+void MissingBlocksUploader::AdaptConcurrentUploads(size_t uploadedBytes)
+{
+   if (IsAudioIOActive())
+   {
+      // The throttled throughput says nothing about the link
+      mWindowStart   = Clock::now();
+      mWindowUploads = 0;
+      mWindowBytes   = 0;
+      return;
+   }
+
+   mWindowBytes += uploadedBytes;
+
+   if (++mWindowUploads < UploadsPerWindow * mMaxConcurrentUploads)
+      return;
+
+   const auto now = Clock::now();
+   const auto seconds =
+      std::chrono::duration<double>(now - mWindowStart).count();
+
+   if (seconds <= 0)
+      return;
+
+   // Hill climbing: keep adding (or removing) concurrent uploads while this
+   // improves the throughput, turn back when it worsens it. When the link is
+   // saturated, more uploads in flight only lengthen the round trips.
+   const auto throughput = mWindowBytes / seconds;
+
+   if (throughput < mLastWindowThroughput * (1 - ThroughputTolerance))
+      mConcurrencyStep = -mConcurrencyStep;
+
+   if (
+      mLastWindowThroughput == 0.0 ||
+      std::abs(throughput - mLastWindowThroughput) >
+         mLastWindowThroughput * ThroughputTolerance)
+   {
+      mMaxConcurrentUploads = std::clamp<int>(
+         static_cast<int>(mMaxConcurrentUploads) + mConcurrencyStep,
+         MIN_UPLOADERS, MAX_UPLOADERS);
+   }
+
+   mLastWindowThroughput = throughput;
+   mWindowStart          = now;
+   mWindowUploads        = 0;
+   mWindowBytes          = 0;
+}
+
+size_t MissingBlocksUploader::GetConcurrentUploadsLimit() const
+{
+   return IsAudioIOActive() ? MIN_UPLOADERS : mMaxConcurrentUploads;
+}
+
 void MissingBlocksUploader::HandleFailedBlock(
    const ResponseResult& result, BlockUploadTask task)
 {
@@ -213,10 +290,19 @@ void MissingBlocksUploader::HandleFailedBlock(
    mCancellationContext->Cancel();
 }
 
-void MissingBlocksUploader::ProducerThread()
+void MissingBlocksUploader::ProducerThread(size_t producerIndex)
 {
+   BlockCompressor compressor;
+
    while (mIsRunning.load(std::memory_order_consume))
    {
+      // Only one block at a time is compressed while audio I/O is active
+      if (producerIndex > 0 && IsAudioIOActive())
+      {
+         std::this_thread::sleep_for(ThrottledProducerPollPeriod);
+         continue;
+      }
+
       BlockUploadTask task;
 
       {
@@ -229,7 +315,7 @@ void MissingBlocksUploader::ProducerThread()
          task = std::move(mUploadTasks[index]);
       }
 
-      auto compressedData = CompressBlock(task.Block);
+      auto compressedData = compressor.Compress(task.Block);
 
       if (compressedData.empty())
       {
@@ -12,10 +12,12 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include <functional>
 
@@ -69,8 +71,11 @@ class MissingBlocksUploader final :
    };
 
 public:
-   static constexpr auto NUM_PRODUCERS    = 3;
-   static constexpr auto NUM_UPLOADERS    = 6;
+   //! The number of concurrent uploads starts at NUM_UPLOADERS and is then
+   //! adapted to the measured throughput, within [MIN_UPLOADERS, MAX_UPLOADERS]
+   static constexpr size_t MIN_UPLOADERS  = 2;
+   static constexpr size_t NUM_UPLOADERS  = 6;
+   static constexpr size_t MAX_UPLOADERS  = 16;
    static constexpr auto RING_BUFFER_SIZE = 16;
 
    MissingBlocksUploader(Tag, const ServiceConfig& serviceConfig);
@@ -102,10 +107,15 @@ private:
    void PushBlockToQueue(ProducedItem item);
    ProducedItem PopBlockFromQueue();
 
-   void ConfirmBlock(BlockUploadTask task);
+   void ConfirmBlock(BlockUploadTask task, size_t uploadedBytes);
    void HandleFailedBlock(const ResponseResult& result, BlockUploadTask task);
 
-   void ProducerThread();
+   //! Called with mUploadsMutex locked
+   void AdaptConcurrentUploads(size_t uploadedBytes);
+   //! Called with mUploadsMutex locked
+   size_t GetConcurrentUploadsLimit() const;
+
+   void ProducerThread(size_t producerIndex);
    void ConsumerThread();
 
    const ServiceConfig& mServiceConfig;
@@ -115,7 +125,7 @@ private:
 
    std::atomic_bool mIsRunning { true };
 
-   std::thread mProducerThread[NUM_PRODUCERS];
+   std::vector<std::thread> mProducerThreads;
    std::thread mConsumerThread;
 
    std::mutex mBlocksMutex;
@@ -124,6 +134,16 @@ private:
    std::mutex mUploadsMutex;
    std::condition_variable mUploadsNotFull;
    size_t mConcurrentUploads { 0 };
+   size_t mMaxConcurrentUploads { NUM_UPLOADERS };
+
+   // Throughput measurement, over windows of a few uploads per allowed
+   // concurrent upload
+   using Clock = std::chrono::steady_clock;
+   Clock::time_point mWindowStart;
+   size_t mWindowUploads { 0 };
+   size_t mWindowBytes { 0 };
+   double mLastWindowThroughput { 0.0 };
+   int mConcurrencyStep { 1 };
 
    std::mutex mRingBufferMutex;
 
@@ -256,12 +256,19 @@ std::shared_ptr<MixdownUploader> MixdownUploader::Upload(
 
 void MixdownUploader::SetUrls(const UploadUrls& urls)
 {
-   auto lock = std::lock_guard { mUploadUrlsMutex };
+   {
+      auto lock = std::lock_guard { mUploadUrlsMutex };
+
+      assert(!mUploadUrls);
+      mUploadUrls = urls;
 
-   assert(!mUploadUrls);
-   mUploadUrls = urls;
+      if (!mExportSucceeded || mUploadStarted)
+         return;
 
-   mUploadUrlsSet.notify_one();
+      mUploadStarted = true;
+   }
+
+   StartUpload();
 }
 
 void MixdownUploader::Cancel()
@@ -274,8 +281,18 @@ void MixdownUploader::Cancel()
 
    // To be on a safe side, we cancel both operations
    mDataExporter->Cancel();
+
    // And ensure that WaitingForUrls is interrupted too
-   mUploadUrlsSet.notify_all();
+   {
+      auto lock = std::lock_guard { mUploadUrlsMutex };
+
+      if (!mExportSucceeded || mUploadStarted)
+         return;
+
+      mUploadStarted = true;
+   }
+
+   ReportProgress(MixdownState::Cancelled, 0.0, {});
 }
 
 std::future<MixdownResult> MixdownUploader::GetResultFuture()
@@ -400,14 +417,28 @@ void MixdownUploader::ExportProject()
 
 void MixdownUploader::UploadMixdown()
 {
-   ReportProgress(MixdownState::WaitingForUrls, 0.0, {});
-
+   bool startUpload;
    {
-      auto lock = std::unique_lock { mUploadUrlsMutex };
-      mUploadUrlsSet.wait(
-         lock, [this] { return mUploadCancelled.load() || !!mUploadUrls; });
+      auto lock = std::lock_guard { mUploadUrlsMutex };
+
+      mExportSucceeded = true;
+
+      if (mUploadStarted)
+         return;
+
+      startUpload = mUploadStarted =
+         mUploadUrls || mUploadCancelled.load(std::memory_order_acquire);
    }
 
+   // Otherwise SetUrls will start the upload
+   if (startUpload)
+      StartUpload();
+   else
+      ReportProgress(MixdownState::WaitingForUrls, 0.0, {});
+}
+
+void MixdownUploader::StartUpload()
+{
    if (mUploadCancelled.load(std::memory_order_acquire))
    {
       ReportProgress(MixdownState::Cancelled, 0.0, {});
@@ -430,6 +461,11 @@ void MixdownUploader::UploadMixdown()
                return MixdownState::Failed;
          }();
 
+         // The upload is not retried past this point, so the file is no
+         // longer needed
+         if (wxFileExists(mExportedFilePath))
+            wxRemoveFile(mExportedFilePath);
+
          ReportProgress(state, 1.0, result);
       },
       [this, strongThis = shared_from_this()](double progress)
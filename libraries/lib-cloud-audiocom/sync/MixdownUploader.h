@@ -12,7 +12,6 @@
 
 #include <atomic>
 #include <cstdint>
-#include <condition_variable>
 #include <functional>
 #include <future>
 #include <memory>
@@ -88,13 +87,18 @@ private:
       MixdownState state, double progress, ResponseResult uploadResult);
    void ExportProject();
    void UploadMixdown();
+   void StartUpload();
 
    const ServiceConfig& mServiceConfig;
    const AudacityProject& mProject;
 
+   //! Guards the members below, the upload starts when both the export has
+   //! succeeded and the URLs are set, whichever comes last
    std::mutex mUploadUrlsMutex;
-   std::condition_variable mUploadUrlsSet;
    std::optional<UploadUrls> mUploadUrls;
+   bool mExportSucceeded { false };
+   //! Set once the upload is started or the uploader is cancelled
+   bool mUploadStarted { false };
 
    MixdownProgressCallback mProgressCallback;
 
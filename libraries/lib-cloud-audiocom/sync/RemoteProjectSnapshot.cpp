@@ -156,6 +156,11 @@ RemoteProjectSnapshot::~RemoteProjectSnapshot()
       mResponsesEmptyCV.wait(lock, [this] { return mResponses.empty(); });
    }
 
+   {
+      auto lock = std::unique_lock { mDownloadedBlocksMutex };
+      mBlocksWrittenCV.wait(lock, [this] { return !mWritingBlocks; });
+   }
+
    auto db = CloudProjectsDatabase::Get().GetConnection();
 
    for (const auto& dbName : ListAttachedDatabases())
@@ -538,7 +543,7 @@ void RemoteProjectSnapshot::OnBlockDownloaded(
 {
    const auto compressedData = ReadResponseData(*response);
 
-   const auto blockData =
+   auto blockData =
       DecompressBlock(compressedData.data(), compressedData.size());
 
    if (!blockData)
@@ -550,24 +555,78 @@ void RemoteProjectSnapshot::OnBlockDownloaded(
       return;
    }
 
+   {
+      auto lock = std::lock_guard { mDownloadedBlocksMutex };
+
+      mDownloadedBlocksQueue.push_back(
+         { std::move(blockHash), std::move(*blockData) });
+
+      // The thread already writing will write this block too
+      if (mWritingBlocks)
+         return;
+
+      mWritingBlocks = true;
+   }
+
+   WriteDownloadedBlocks();
+}
+
+void RemoteProjectSnapshot::WriteDownloadedBlocks()
+{
+   std::vector<DownloadedBlock> blocks;
+
+   while (true)
+   {
+      blocks.clear();
+
+      {
+         auto lock = std::lock_guard { mDownloadedBlocksMutex };
+
+         if (mDownloadedBlocksQueue.empty() || !InProgress())
+         {
+            mDownloadedBlocksQueue.clear();
+            mWritingBlocks = false;
+            mBlocksWrittenCV.notify_all();
+            return;
+         }
+
+         std::swap(blocks, mDownloadedBlocksQueue);
+      }
+
+      if (!WriteBlocks(blocks))
+      {
+         auto lock = std::lock_guard { mDownloadedBlocksMutex };
+         mDownloadedBlocksQueue.clear();
+         mWritingBlocks = false;
+         mBlocksWrittenCV.notify_all();
+         return;
+      }
+
+      mDownloadedBlocks.fetch_add(blocks.size(), std::memory_order_acq_rel);
+
+      ReportProgress();
+   }
+}
+
+bool RemoteProjectSnapshot::WriteBlocks(
+   const std::vector<DownloadedBlock>& blocks)
+{
    auto db          = CloudProjectsDatabase::Get().GetConnection();
-   auto transaction = db->BeginTransaction("b_" + blockHash);
+   // A transaction per batch and not per block, as each commit syncs the
+   // database to the disk
+   auto transaction = db->BeginTransaction("b_" + mProjectInfo.Id);
 
    auto hashesStatement = db->CreateStatement(
       "INSERT INTO block_hashes (project_id, block_id, hash) VALUES (?1, ?2, ?3) "
       "ON CONFLICT(project_id, block_id) DO UPDATE SET hash = ?3");
 
-   auto result =
-      hashesStatement->Prepare(mProjectInfo.Id, blockData->BlockId, blockHash)
-         .Run();
-
-   if (!result.IsOk())
+   if (!hashesStatement)
    {
       OnFailure(
          { SyncResultCode::InternalClientError,
            audacity::ToUTF8(
-              result.GetErrors().front().GetErrorString().Translation()) });
-      return;
+              hashesStatement.GetError().GetErrorString().Translation()) });
+      return false;
    }
 
    auto blockStatement = db->CreateStatement(
@@ -581,46 +640,60 @@ void RemoteProjectSnapshot::OnBlockDownloaded(
          { SyncResultCode::InternalClientError,
            audacity::ToUTF8(
               blockStatement.GetError().GetErrorString().Translation()) });
-      return;
+      return false;
    }
 
-   auto& preparedStatement = blockStatement->Prepare();
-
-   preparedStatement.Bind(1, blockData->BlockId);
-   preparedStatement.Bind(2, static_cast<int64_t>(blockData->Format));
-   preparedStatement.Bind(3, blockData->BlockMinMaxRMS.Min);
-   preparedStatement.Bind(4, blockData->BlockMinMaxRMS.Max);
-   preparedStatement.Bind(5, blockData->BlockMinMaxRMS.RMS);
-   preparedStatement.Bind(
-      6, blockData->Summary256.data(),
-      blockData->Summary256.size() * sizeof(MinMaxRMS), false);
-   preparedStatement.Bind(
-      7, blockData->Summary64k.data(),
-      blockData->Summary64k.size() * sizeof(MinMaxRMS), false);
-   preparedStatement.Bind(
-      8, blockData->Data.data(), blockData->Data.size(), false);
+   for (const auto& [blockHash, blockData] : blocks)
+   {
+      auto result =
+         hashesStatement->Prepare(mProjectInfo.Id, blockData.BlockId, blockHash)
+            .Run();
 
-   result = preparedStatement.Run();
+      if (!result.IsOk())
+      {
+         OnFailure(
+            { SyncResultCode::InternalClientError,
+              audacity::ToUTF8(
+                 result.GetErrors().front().GetErrorString().Translation()) });
+         return false;
+      }
 
-   if (!result.IsOk())
-   {
-      OnFailure(
-         { SyncResultCode::InternalClientError,
-           audacity::ToUTF8(
-              result.GetErrors().front().GetErrorString().Translation()) });
-      return;
+      auto& preparedStatement = blockStatement->Prepare();
+
+      preparedStatement.Bind(1, blockData.BlockId);
+      preparedStatement.Bind(2, static_cast<int64_t>(blockData.Format));
+      preparedStatement.Bind(3, blockData.BlockMinMaxRMS.Min);
+      preparedStatement.Bind(4, blockData.BlockMinMaxRMS.Max);
+      preparedStatement.Bind(5, blockData.BlockMinMaxRMS.RMS);
+      preparedStatement.Bind(
+         6, blockData.Summary256.data(),
+         blockData.Summary256.size() * sizeof(MinMaxRMS), false);
+      preparedStatement.Bind(
+         7, blockData.Summary64k.data(),
+         blockData.Summary64k.size() * sizeof(MinMaxRMS), false);
+      preparedStatement.Bind(
+         8, blockData.Data.data(), blockData.Data.size(), false);
+
+      result = preparedStatement.Run();
+
+      if (!result.IsOk())
+      {
+         OnFailure(
+            { SyncResultCode::InternalClientError,
+              audacity::ToUTF8(
+                 result.GetErrors().front().GetErrorString().Translation()) });
+         return false;
+      }
    }
 
    if (auto error = transaction.Commit(); error.IsError())
    {
       OnFailure({ SyncResultCode::InternalClientError,
                   audacity::ToUTF8(error.GetErrorString().Translation()) });
-      return;
+      return false;
    }
 
-   mDownloadedBlocks.fetch_add(1, std::memory_order_acq_rel);
-
-   ReportProgress();
+   return true;
 }
 
 void RemoteProjectSnapshot::OnFailure(ResponseResult result)
@@ -23,6 +23,7 @@
 
 #include "CloudSyncDTO.h"
 #include "NetworkUtils.h"
+#include "WavPackCompressor.h"
 
 namespace audacity::network_manager
 {
@@ -106,6 +107,17 @@ private:
    void OnBlockDownloaded(
       std::string blockHash, audacity::network_manager::ResponsePtr response);
 
+   struct DownloadedBlock final
+   {
+      std::string Hash;
+      DecompressedBlock Data;
+   };
+
+   //! Writes the downloaded blocks, including those that arrive meanwhile,
+   //! in one transaction per batch
+   void WriteDownloadedBlocks();
+   bool WriteBlocks(const std::vector<DownloadedBlock>& blocks);
+
    void OnFailure(ResponseResult result);
    void RemoveResponse(audacity::network_manager::IResponse* response);
 
@@ -150,6 +162,12 @@ private:
       mResponses;
    std::condition_variable mResponsesEmptyCV;
 
+   std::mutex mDownloadedBlocksMutex;
+   std::vector<DownloadedBlock> mDownloadedBlocksQueue;
+   //! Whether a thread is in WriteDownloadedBlocks
+   bool mWritingBlocks { false };
+   std::condition_variable mBlocksWrittenCV;
+
    std::atomic<int64_t> mDownloadedBlocks { 0 };
    std::atomic<int64_t> mCopiedBlocks { 0 };
    std::atomic<int64_t> mDownloadedBytes { 0 };
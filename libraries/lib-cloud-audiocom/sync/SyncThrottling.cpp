@@ -0,0 +1,46 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SyncThrottling.cpp
+
+**********************************************************************/
+#include "SyncThrottling.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "CloudLibrarySettings.h"
+
+namespace audacity::cloud::audiocom::sync
+{
+namespace
+{
+std::atomic<bool> AudioIOActive { false };
+// Settings can't be read from the sync threads, so the limit is read when the
+// audio starts
+std::atomic<int64_t> UploadSpeedLimit { 0 };
+} // namespace
+
+void SetAudioIOActive(bool active)
+{
+   if (active)
+      UploadSpeedLimit.store(
+         std::max(0, UploadSpeedLimitWhileAudioIOActive.Read()) * int64_t(1024),
+         std::memory_order_relaxed);
+
+   AudioIOActive.store(active, std::memory_order_release);
+}
+
+bool IsAudioIOActive() noexcept
+{
+   return AudioIOActive.load(std::memory_order_acquire);
+}
+
+int64_t GetUploadSpeedLimit() noexcept
+{
+   return IsAudioIOActive() ? UploadSpeedLimit.load(std::memory_order_relaxed) :
+                              0;
+}
+} // namespace audacity::cloud::audiocom::sync
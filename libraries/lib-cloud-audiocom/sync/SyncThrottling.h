@@ -0,0 +1,26 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SyncThrottling.h
+
+**********************************************************************/
+#pragma once
+
+#include <cstdint>
+
+namespace audacity::cloud::audiocom::sync
+{
+//! Tells the sync whether audio is played or recorded. The sync then
+//! compresses and uploads fewer blocks at a time, and caps the uploads to
+//! `UploadSpeedLimitWhileAudioIOActive`, so that the audio doesn't drop out.
+//! To be called from the main thread.
+CLOUD_AUDIOCOM_API void SetAudioIOActive(bool active);
+
+bool IsAudioIOActive() noexcept;
+
+//! @return the number of bytes per second all the uploads may share now, or 0
+//! if there is no limit
+int64_t GetUploadSpeedLimit() noexcept;
+} // namespace audacity::cloud::audiocom::sync
@@ -11,6 +11,7 @@
 
 #include "WavPackCompressor.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -31,11 +32,11 @@ namespace
 struct Exporter final
 {
    WavpackContext* Context { nullptr };
-   LockedBlock Block;
+   const LockedBlock& Block;
    std::vector<uint8_t> CompressedData;
 
-   Exporter(LockedBlock block)
-       : Block { std::move(block) }
+   Exporter(const LockedBlock& block, CompressionMode mode)
+       : Block { block }
    {
       WavpackConfig config = {};
 
@@ -48,7 +49,8 @@ struct Exporter final
       config.bits_per_sample = config.bytes_per_sample * 8;
       config.float_norm_exp = Block.Format == floatSample ? 127 : 0;
 
-      config.flags = CONFIG_FAST_FLAG;
+      config.flags =
+         mode == CompressionMode::High ? CONFIG_HIGH_FLAG : CONFIG_FAST_FLAG;
 
       Context = WavpackOpenFileOutput(WriteBlock, this, nullptr);
 
@@ -68,53 +70,44 @@ struct Exporter final
          WavpackCloseFile(Context);
    }
 
-   std::vector<uint8_t> Compress()
+   std::vector<uint8_t> Compress(
+      std::vector<int16_t>& int16Buffer, std::vector<int32_t>& int32Buffer)
    {
       const auto sampleFormat = Block.Format;
       const auto sampleCount = Block.Block->GetSampleCount();
-      const auto dataSize = sampleCount * SAMPLE_SIZE(sampleFormat);
 
-      std::vector<std::remove_pointer_t<samplePtr>> sampleData;
-      sampleData.resize(dataSize);
+      // WavPack takes 32 bit samples: 24 bit integers and floats are read
+      // into them as they are, 16 bit integers are widened in one pass
+      int32Buffer.resize(sampleCount);
 
-      const size_t samplesRead = Block.Block->GetSamples(
-         sampleData.data(), Block.Format, 0, sampleCount, false);
-
-      // Reserve 1.5 times the size of the original data
-      // The compressed data will be smaller than the original data,
-      // but we overallocate just in case
-      CompressedData.reserve(sampleData.size() * 3 / 2);
+      size_t samplesRead;
 
       if (sampleFormat == int16Sample)
       {
-         constexpr size_t conversionSamplesCount = 4096;
-
-         const int16_t* int16Data = reinterpret_cast<const int16_t*>(sampleData.data());
-         std::vector<int32_t> buffer;
-         buffer.resize(conversionSamplesCount);
+         int16Buffer.resize(sampleCount);
 
-         for (size_t firstSample = 0; firstSample < samplesRead;
-              firstSample += conversionSamplesCount)
-         {
-            const auto samplesThisRun =
-               std::min(conversionSamplesCount, samplesRead - firstSample);
-
-            for (size_t i = 0; i < samplesThisRun; ++i)
-               buffer[i] =
-                  (static_cast<int32_t>(int16Data[firstSample + i]) * 65536) >>
-                  16;
+         samplesRead = Block.Block->GetSamples(
+            reinterpret_cast<samplePtr>(int16Buffer.data()), sampleFormat, 0,
+            sampleCount, false);
 
-            WavpackPackSamples(Context, buffer.data(), samplesThisRun);
-         }
+         std::copy(
+            int16Buffer.begin(), int16Buffer.begin() + samplesRead,
+            int32Buffer.begin());
       }
       else
       {
-         const void* data = sampleData.data();
-         WavpackPackSamples(
-            Context, static_cast<int32_t*>(const_cast<void*>(data)),
-            samplesRead);
+         samplesRead = Block.Block->GetSamples(
+            reinterpret_cast<samplePtr>(int32Buffer.data()), sampleFormat, 0,
+            sampleCount, false);
       }
 
+      // Reserve 1.5 times the size of the original data
+      // The compressed data will be smaller than the original data,
+      // but we overallocate just in case
+      CompressedData.reserve(sampleCount * SAMPLE_SIZE(sampleFormat) * 3 / 2);
+
+      Feed(int32Buffer.data(), samplesRead);
+
       Flush();
 
       return std::move(CompressedData);
@@ -485,10 +478,21 @@ void UpdateRMS (DecompressedBlock& block, const std::vector<T>& data)
  }
 } // namespace
 
-std::vector<uint8_t> CompressBlock(const LockedBlock& block)
+BlockCompressor::BlockCompressor(CompressionMode mode)
+    : mMode { mode }
+{
+}
+
+std::vector<uint8_t> BlockCompressor::Compress(const LockedBlock& block)
+{
+   Exporter exporter { block, mMode };
+   return exporter.Compress(mInt16Buffer, mInt32Buffer);
+}
+
+std::vector<uint8_t>
+CompressBlock(const LockedBlock& block, CompressionMode mode)
 {
-   Exporter exporter { block };
-   return exporter.Compress();
+   return BlockCompressor { mode }.Compress(block);
 }
 
 std::optional<DecompressedBlock>
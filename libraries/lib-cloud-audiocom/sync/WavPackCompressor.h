@@ -21,7 +21,32 @@ class AudacityProject;
 
 namespace audacity::cloud::audiocom::sync
 {
-std::vector<uint8_t> CompressBlock(const LockedBlock& block);
+enum class CompressionMode
+{
+   //! For the blocks uploaded while syncing, where time matters most
+   Fast,
+   //! For the blocks that are kept, where size matters most
+   High,
+};
+
+//! Compresses blocks one after another, reusing the sample buffers between
+//! them; one per thread
+class BlockCompressor final
+{
+public:
+   explicit BlockCompressor(CompressionMode mode = CompressionMode::Fast);
+
+   std::vector<uint8_t> Compress(const LockedBlock& block);
+
+private:
+   const CompressionMode mMode;
+
+   std::vector<int16_t> mInt16Buffer;
+   std::vector<int32_t> mInt32Buffer;
+}; // class BlockCompressor
+
+std::vector<uint8_t> CompressBlock(
+   const LockedBlock& block, CompressionMode mode = CompressionMode::Fast);
 
 struct MinMaxRMS final
 {
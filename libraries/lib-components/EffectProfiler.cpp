@@ -0,0 +1,103 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file EffectProfiler.cpp
+
+**********************************************************************/
+#include "EffectProfiler.h"
+
+#include <algorithm>
+
+#include "MemoryX.h"
+
+EffectProfiler::Entry::Entry(wxString name, bool realtime)
+   : mName{ std::move(name) }, mRealtime{ realtime }
+{
+}
+
+void EffectProfiler::Entry::Add(
+   Clock::duration elapsed, size_t samples, double sampleRate)
+{
+   using namespace std::chrono;
+   const auto nanoseconds = static_cast<std::uint64_t>(
+      std::max<nanoseconds::rep>(0, duration_cast<std::chrono::nanoseconds>(
+         elapsed).count()));
+   // Single writer, so relaxed loads and stores suffice
+   mBlocks.store(mBlocks.load(std::memory_order_relaxed) + 1,
+      std::memory_order_relaxed);
+   mSamples.store(mSamples.load(std::memory_order_relaxed) + samples,
+      std::memory_order_relaxed);
+   mTotalTime.store(mTotalTime.load(std::memory_order_relaxed) + nanoseconds,
+      std::memory_order_relaxed);
+   if (nanoseconds > mPeakTime.load(std::memory_order_relaxed))
+      mPeakTime.store(nanoseconds, std::memory_order_relaxed);
+   if (sampleRate > 0 && samples > 0 &&
+      nanoseconds > samples * 1e9 / sampleRate)
+      mDeadlineMisses.store(
+         mDeadlineMisses.load(std::memory_order_relaxed) + 1,
+         std::memory_order_relaxed);
+}
+
+EffectProfiler &EffectProfiler::Get()
+{
+   static EffectProfiler instance;
+   return instance;
+}
+
+auto EffectProfiler::Register(wxString name, bool realtime)
+   -> std::shared_ptr<Entry>
+{
+   std::shared_ptr<Entry> pEntry{
+      safenew Entry{ std::move(name), realtime },
+      [this](Entry *p){ Release(p); }
+   };
+   std::lock_guard lock{ mMutex };
+   mEntries.push_back(pEntry.get());
+   return pEntry;
+}
+
+void EffectProfiler::Release(Entry *pEntry)
+{
+   {
+      std::lock_guard lock{ mMutex };
+      mEntries.erase(
+         std::remove(mEntries.begin(), mEntries.end(), pEntry),
+         mEntries.end());
+      // Skip entries that never processed anything
+      if (pEntry->mBlocks.load(std::memory_order_relaxed) > 0) {
+         if (mReleased.size() == MaxReleased)
+            mReleased.erase(mReleased.begin());
+         mReleased.push_back(Copy(*pEntry));
+      }
+   }
+   delete pEntry;
+}
+
+auto EffectProfiler::GetStatistics() const -> std::vector<Statistics>
+{
+   std::lock_guard lock{ mMutex };
+   auto result = mReleased;
+   for (const auto pEntry : mEntries)
+      result.push_back(Copy(*pEntry));
+   return result;
+}
+
+void EffectProfiler::Reset()
+{
+   std::lock_guard lock{ mMutex };
+   mReleased.clear();
+}
+
+auto EffectProfiler::Copy(const Entry &entry) -> Statistics
+{
+   return {
+      entry.mName,
+      entry.mRealtime,
+      entry.mBlocks.load(std::memory_order_relaxed),
+      entry.mSamples.load(std::memory_order_relaxed),
+      entry.mTotalTime.load(std::memory_order_relaxed) * 1e-9,
+      entry.mPeakTime.load(std::memory_order_relaxed) * 1e-9,
+      entry.mDeadlineMisses.load(std::memory_order_relaxed),
+   };
+}
@@ -0,0 +1,118 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file EffectProfiler.h
+  @brief Accounting of the processor time that effect instances take
+
+**********************************************************************/
+#ifndef __AUDACITY_EFFECT_PROFILER__
+#define __AUDACITY_EFFECT_PROFILER__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <wx/string.h>
+
+//! Collects the time spent in each effect instance, block by block
+/*!
+ Owners of instances (realtime effect states, effect stages) register one
+ entry each and time every call that processes a block.  The counters are
+ written by the one processing thread of the entry and may be read at any
+ time by any other, so that the main thread can report them
+ */
+class COMPONENTS_API EffectProfiler final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+
+   //! Counters for one instance
+   class COMPONENTS_API Entry final
+   {
+   public:
+      Entry(wxString name, bool realtime);
+
+      //! Called by the processing thread after each block
+      /*!
+       @param sampleRate if positive, a block that took longer than its
+       duration counts as a deadline miss
+       */
+      void Add(Clock::duration elapsed, size_t samples, double sampleRate);
+
+      const wxString mName;
+      const bool mRealtime;
+
+      std::atomic<std::uint64_t> mBlocks{ 0 };
+      std::atomic<std::uint64_t> mSamples{ 0 };
+      //! In nanoseconds
+      std::atomic<std::uint64_t> mTotalTime{ 0 };
+      //! In nanoseconds
+      std::atomic<std::uint64_t> mPeakTime{ 0 };
+      std::atomic<std::uint64_t> mDeadlineMisses{ 0 };
+   };
+
+   //! Times one block, from construction to destruction
+   class Scope final
+   {
+   public:
+      Scope(Entry *pEntry, size_t samples, double sampleRate)
+         : mpEntry{ pEntry }, mSamples{ samples }, mSampleRate{ sampleRate }
+         , mStart{ pEntry ? Clock::now() : Clock::time_point{} }
+      {}
+      Scope(const Scope&) = delete;
+      Scope &operator=(const Scope&) = delete;
+      ~Scope()
+      {
+         if (mpEntry)
+            mpEntry->Add(Clock::now() - mStart, mSamples, mSampleRate);
+      }
+      //! Samples may not be known until the block is done
+      void SetSamples(size_t samples) { mSamples = samples; }
+   private:
+      Entry *const mpEntry;
+      size_t mSamples;
+      const double mSampleRate;
+      const Clock::time_point mStart;
+   };
+
+   //! A copy of the counters of one entry
+   struct Statistics {
+      wxString name;
+      bool realtime{};
+      std::uint64_t blocks{};
+      std::uint64_t samples{};
+      double totalSeconds{};
+      double peakSeconds{};
+      std::uint64_t deadlineMisses{};
+   };
+
+   static EffectProfiler &Get();
+
+   //! The profiler reports the entry for as long as the caller holds it
+   std::shared_ptr<Entry> Register(wxString name, bool realtime);
+
+   //! Statistics of entries released since the last Reset(), then of
+   //! entries still held, each in order of registration
+   std::vector<Statistics> GetStatistics() const;
+
+   //! Forget the entries that are no longer held
+   void Reset();
+
+   //! At most so many statistics of released entries are kept
+   static constexpr size_t MaxReleased = 1000;
+
+private:
+   static Statistics Copy(const Entry &entry);
+   void Release(Entry *pEntry);
+
+   mutable std::mutex mMutex;
+   std::vector<Entry*> mEntries;
+   //! Statistics of released entries are kept here until reset
+   std::vector<Statistics> mReleased;
+};
+
+#endif
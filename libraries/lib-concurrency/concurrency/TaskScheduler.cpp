@@ -0,0 +1,290 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: TaskScheduler.cpp
+ */
+
+#include "TaskScheduler.h"
+#include "ICancellable.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+namespace audacity::concurrency
+{
+namespace
+{
+//! The pool and index of the worker running in this thread, if any
+thread_local const TaskScheduler* tScheduler = nullptr;
+thread_local size_t tIndex = 0;
+
+//! How long Wait() sleeps before looking again for tasks to run
+constexpr auto WaitInterval = std::chrono::milliseconds { 1 };
+
+//! Subranges for each thread in RunRange(), for balance when they take
+//! unequal times
+constexpr long long RangesPerThread = 4;
+} // namespace
+
+TaskScheduler& TaskScheduler::Get()
+{
+   static TaskScheduler instance {
+      std::max(2u, std::thread::hardware_concurrency()) - 1
+   };
+   return instance;
+}
+
+TaskScheduler::TaskScheduler(size_t nThreads)
+{
+   assert(nThreads > 0);
+   for (size_t ii = 0; ii < nThreads; ++ii)
+      mWorkers.push_back(std::make_unique<Worker>());
+   // Start threads only when all the queues exist, for stealing
+   for (size_t ii = 0; ii < nThreads; ++ii)
+      mWorkers[ii]->thread = std::thread { [this, ii] { Loop(ii); } };
+}
+
+TaskScheduler::~TaskScheduler()
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mStopping = true;
+   }
+   mCondition.notify_all();
+   for (auto& pWorker : mWorkers)
+      pWorker->thread.join();
+}
+
+size_t TaskScheduler::ThreadCount() const noexcept
+{
+   return mWorkers.size();
+}
+
+void TaskScheduler::Submit(Task task, TaskPriority priority)
+{
+   const auto iPriority = static_cast<size_t>(priority);
+   assert(iPriority < nPriorities);
+   const auto index = tScheduler == this ?
+                         tIndex :
+                         mNext.fetch_add(1) % mWorkers.size();
+   // Count first, so that the count is never less than the tasks
+   ++mQueued;
+   ++mQueuedByPriority[iPriority];
+   {
+      auto& worker = *mWorkers[index];
+      std::lock_guard<std::mutex> lock { worker.mutex };
+      worker.tasks[iPriority].push_back(std::move(task));
+   }
+   // Lock, so that a worker can't miss the count before it sleeps
+   std::lock_guard<std::mutex> lock { mMutex };
+   mCondition.notify_one();
+}
+
+bool TaskScheduler::RunOne()
+{
+   Task task;
+   if (!Take(tScheduler == this ? &tIndex : nullptr, task))
+      return false;
+   task();
+   return true;
+}
+
+bool TaskScheduler::Take(const size_t* index, Task& task)
+{
+   if (mQueued == 0)
+      return false;
+   for (size_t priority = 0; priority < nPriorities; ++priority)
+      if (mQueuedByPriority[priority] > 0 && Take(index, priority, task))
+         return true;
+   return false;
+}
+
+bool TaskScheduler::Take(const size_t* index, size_t priority, Task& task)
+{
+   const auto taken = [&] {
+      --mQueuedByPriority[priority];
+      --mQueued;
+      return true;
+   };
+   if (index) {
+      auto& worker = *mWorkers[*index];
+      std::lock_guard<std::mutex> lock { worker.mutex };
+      auto& tasks = worker.tasks[priority];
+      if (!tasks.empty()) {
+         task = std::move(tasks.back());
+         tasks.pop_back();
+         return taken();
+      }
+   }
+   // Steal the oldest task of another, starting after this one
+   const auto nWorkers = mWorkers.size();
+   const auto first = index ? *index + 1 : mNext.load();
+   for (size_t ii = 0; ii < nWorkers; ++ii) {
+      auto& worker = *mWorkers[(first + ii) % nWorkers];
+      std::lock_guard<std::mutex> lock { worker.mutex };
+      auto& tasks = worker.tasks[priority];
+      if (!tasks.empty()) {
+         task = std::move(tasks.front());
+         tasks.pop_front();
+         return taken();
+      }
+   }
+   return false;
+}
+
+void TaskScheduler::Loop(size_t index)
+{
+   tScheduler = this;
+   tIndex = index;
+   while (true) {
+      Task task;
+      if (Take(&index, task)) {
+         task();
+         continue;
+      }
+      std::unique_lock<std::mutex> lock { mMutex };
+      mCondition.wait(lock, [this] { return mStopping || mQueued > 0; });
+      if (mStopping && mQueued == 0)
+         return;
+   }
+}
+
+class TaskGroup::Cancellation final : public ICancellable
+{
+public:
+   void Cancel() override
+   {
+      mCancelled.store(true, std::memory_order_relaxed);
+   }
+   bool IsCancelled() const noexcept
+   {
+      return mCancelled.load(std::memory_order_relaxed);
+   }
+
+private:
+   std::atomic<bool> mCancelled { false };
+};
+
+TaskGroup::TaskGroup(
+   TaskScheduler& scheduler, TaskPriority priority,
+   const CancellationContextPtr& pContext)
+    : mScheduler { scheduler }
+    , mPriority { priority }
+    , mpCancellation { std::make_shared<Cancellation>() }
+{
+   if (pContext)
+      pContext->OnCancelled(mpCancellation);
+}
+
+TaskGroup::~TaskGroup()
+{
+   try {
+      Wait();
+   }
+   catch (...) {
+   }
+}
+
+void TaskGroup::Run(std::function<void()> task)
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      ++mPending;
+   }
+   mScheduler.Submit([this, task = std::move(task)] {
+      std::exception_ptr pException;
+      try {
+         if (!IsCancelled())
+            task();
+      }
+      catch (...) {
+         pException = std::current_exception();
+      }
+      // Notify while locked, because Wait() may return, and this be
+      // destroyed, as soon as the lock is released
+      std::lock_guard<std::mutex> lock { mMutex };
+      if (pException && !mpException)
+         mpException = pException;
+      if (--mPending == 0)
+         mCondition.notify_all();
+   }, mPriority);
+}
+
+void TaskGroup::RunRange(
+   long long begin, long long end, long long grain, RangeBody body)
+{
+   if (end <= begin)
+      return;
+   const auto length = end - begin;
+   grain = std::max(grain, 1LL);
+   const auto maxRanges =
+      RangesPerThread * static_cast<long long>(mScheduler.ThreadCount() + 1);
+   const auto nRanges = std::clamp(length / grain, 1LL, maxRanges);
+   const auto rangeLength = (length + nRanges - 1) / nRanges;
+   const auto pBody = std::make_shared<const RangeBody>(std::move(body));
+   for (auto first = begin; first < end; first += rangeLength)
+      Run([pBody, first, last = std::min(end, first + rangeLength)] {
+         (*pBody)(first, last);
+      });
+}
+
+void TaskGroup::Cancel()
+{
+   mpCancellation->Cancel();
+}
+
+bool TaskGroup::IsCancelled() const noexcept
+{
+   return mpCancellation->IsCancelled();
+}
+
+void TaskGroup::Wait()
+{
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock { mMutex };
+         if (mPending == 0)
+            break;
+      }
+      // Help, with tasks of this group or any other
+      if (mScheduler.RunOne())
+         continue;
+      std::unique_lock<std::mutex> lock { mMutex };
+      mCondition.wait_for(lock, WaitInterval, [this] { return mPending == 0; });
+   }
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (auto pException = std::exchange(mpException, nullptr))
+      std::rethrow_exception(pException);
+}
+
+void TaskGroup::WaitPolling(
+   const std::function<void()>& poll, std::chrono::milliseconds interval)
+{
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock { mMutex };
+         if (mCondition.wait_for(
+                lock, interval, [this] { return mPending == 0; }))
+            break;
+      }
+      poll();
+   }
+   Wait();
+}
+
+void ParallelFor(
+   long long begin, long long end, long long grain, const RangeBody& body,
+   TaskPriority priority, TaskScheduler& scheduler)
+{
+   // Not worth a task
+   if (end - begin <= std::max(grain, 1LL)) {
+      if (begin < end)
+         body(begin, end);
+      return;
+   }
+   TaskGroup group { scheduler, priority };
+   group.RunRange(begin, end, grain, body);
+   group.Wait();
+}
+} // namespace audacity::concurrency
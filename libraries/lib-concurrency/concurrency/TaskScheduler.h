@@ -0,0 +1,185 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: TaskScheduler.h
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CancellationContext.h"
+
+namespace audacity::concurrency
+{
+//! Order in which queued tasks start; a running task is never preempted
+enum class TaskPriority : unsigned
+{
+   //! Work that playback or recording will soon need, such as prefetching
+   NearRealtime,
+   //! Work that the user waits for, such as effects, imports and drawing
+   Interactive,
+   //! Work that nobody waits for, such as hashing for synchronization
+   Background,
+   nPriorities
+};
+
+//! A pool of worker threads, each with its own queue of tasks, which takes
+//! tasks from the other queues when its own is empty
+/*!
+ Offline computations that share Get() share its threads, instead of each
+ starting as many threads as there are cores.
+
+ Methods may be called in any thread
+ */
+class CONCURRENCY_API TaskScheduler final
+{
+public:
+   //! Must not throw
+   using Task = std::function<void()>;
+
+   //! The pool for the whole process, with one thread fewer than there are
+   //! cores, leaving one for the thread that waits for the tasks
+   static TaskScheduler& Get();
+
+   //! @param nThreads at least 1
+   explicit TaskScheduler(size_t nThreads);
+   //! Finishes all queued tasks
+   ~TaskScheduler();
+
+   TaskScheduler(const TaskScheduler&)            = delete;
+   TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+   size_t ThreadCount() const noexcept;
+
+   //! Queue a task
+   /*!
+    From a worker thread of this pool, the task goes to its own queue, else
+    to each queue in turn.  Tasks of higher priority, in any queue, start
+    before those of lower priority
+    */
+   void Submit(Task task, TaskPriority priority = TaskPriority::Interactive);
+
+   //! Run one queued task in the calling thread, if there is any
+   //! @return whether a task was run
+   bool RunOne();
+
+private:
+   static constexpr auto nPriorities =
+      static_cast<size_t>(TaskPriority::nPriorities);
+
+   struct Worker final
+   {
+      std::mutex mutex;
+      //! One queue for each priority; the worker takes from the back,
+      //! others from the front
+      std::array<std::deque<Task>, nPriorities> tasks;
+      std::thread thread;
+   };
+
+   //! Take a task from the queue of `index` if not null, else from any
+   bool Take(const size_t* index, Task& task);
+   bool Take(const size_t* index, size_t priority, Task& task);
+   void Loop(size_t index);
+
+   std::vector<std::unique_ptr<Worker>> mWorkers;
+
+   //! Guards sleeping and waking of workers
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   bool mStopping { false };
+
+   std::atomic<size_t> mQueued { 0 };
+   std::array<std::atomic<size_t>, nPriorities> mQueuedByPriority {};
+   std::atomic<size_t> mNext { 0 };
+};
+
+//! Type of the function that processes the subrange [first, last)
+using RangeBody = std::function<void(long long first, long long last)>;
+
+//! Tasks queued in a TaskScheduler, which can be waited for together
+class CONCURRENCY_API TaskGroup final
+{
+public:
+   /*!
+    @param pContext if not null, cancelling it cancels the group
+    */
+   explicit TaskGroup(
+      TaskScheduler& scheduler = TaskScheduler::Get(),
+      TaskPriority priority = TaskPriority::Interactive,
+      const CancellationContextPtr& pContext = {});
+   //! Waits, ignoring exceptions
+   ~TaskGroup();
+
+   TaskGroup(const TaskGroup&)            = delete;
+   TaskGroup& operator=(const TaskGroup&) = delete;
+
+   //! Queue a task, which may throw, and may itself Run() more tasks
+   void Run(std::function<void()> task);
+
+   //! Queue tasks calling body for consecutive subranges of [begin, end)
+   /*!
+    The subranges have at least `grain` elements, except perhaps the last,
+    and are no more than a few for each thread
+    */
+   void RunRange(long long begin, long long end, long long grain,
+      RangeBody body);
+
+   //! Tasks not yet started when cancelled won't start
+   void Cancel();
+   //! Long tasks may poll this to stop early
+   bool IsCancelled() const noexcept;
+
+   //! Wait for all tasks run so far, meanwhile running queued tasks in the
+   //! calling thread
+   /*!
+    @throws the first exception from any of the tasks
+    */
+   void Wait();
+
+   //! Wait for all tasks run so far, running none in the calling thread, but
+   //! calling poll() there at each interval until they finish
+   /*!
+    For a thread that must stay responsive, as to report progress or to
+    consume results of the tasks as they come
+
+    @throws the first exception from any of the tasks, or from poll()
+    */
+   void WaitPolling(
+      const std::function<void()>& poll,
+      std::chrono::milliseconds interval = std::chrono::milliseconds { 100 });
+
+private:
+   class Cancellation;
+
+   TaskScheduler& mScheduler;
+   const TaskPriority mPriority;
+   const std::shared_ptr<Cancellation> mpCancellation;
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   size_t mPending { 0 };
+   std::exception_ptr mpException;
+};
+
+//! Calls body for consecutive subranges of [begin, end) in the threads of the
+//! scheduler, and in the calling thread, returning when all are done
+/*!
+ @param grain least number of elements worth a task
+ @throws the first exception from body
+ */
+CONCURRENCY_API void ParallelFor(
+   long long begin, long long end, long long grain, const RangeBody& body,
+   TaskPriority priority = TaskPriority::Interactive,
+   TaskScheduler& scheduler = TaskScheduler::Get());
+} // namespace audacity::concurrency
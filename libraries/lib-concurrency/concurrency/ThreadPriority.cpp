@@ -0,0 +1,244 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ThreadPriority.cpp
+ */
+
+#include "ThreadPriority.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#elif defined(__APPLE__)
+#  include <mach/mach.h>
+#  include <mach/mach_time.h>
+#  include <mach/thread_policy.h>
+#  include <pthread.h>
+#else
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+namespace audacity::concurrency
+{
+namespace
+{
+ThreadSchedulingResult Success(std::string message)
+{
+   return { true, std::move(message) };
+}
+
+ThreadSchedulingResult Failure(std::string message)
+{
+   return { false, std::move(message) };
+}
+} // namespace
+
+#if defined(_WIN32)
+
+ThreadSchedulingResult
+SetCurrentThreadRealtime(const RealtimeThreadOptions& options)
+{
+   // Load avrt.dll at run time, so that there is no link dependency
+   using AvSetMmThreadCharacteristicsPtr = HANDLE(WINAPI*)(LPCWSTR, LPDWORD);
+   using AvSetMmThreadPriorityPtr = BOOL(WINAPI*)(HANDLE, int);
+
+   static const auto avrt = LoadLibraryW(L"avrt.dll");
+   if (avrt != nullptr)
+   {
+      const auto setCharacteristics =
+         reinterpret_cast<AvSetMmThreadCharacteristicsPtr>(
+            GetProcAddress(avrt, "AvSetMmThreadCharacteristicsW"));
+      const auto setPriority = reinterpret_cast<AvSetMmThreadPriorityPtr>(
+         GetProcAddress(avrt, "AvSetMmThreadPriority"));
+
+      DWORD taskIndex = 0;
+      if (setCharacteristics != nullptr)
+      {
+         if (const auto handle = setCharacteristics(L"Pro Audio", &taskIndex))
+         {
+            // AVRT_PRIORITY_HIGH
+            if (setPriority != nullptr && options.priority >= 50)
+               setPriority(handle, 1);
+            return Success("MMCSS \"Pro Audio\" task registered");
+         }
+      }
+   }
+
+   // Fall back to the highest ordinary priority
+   if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+      return Success(
+         "MMCSS unavailable, using THREAD_PRIORITY_TIME_CRITICAL");
+
+   std::ostringstream message;
+   message << "Failed to raise thread priority, error " << GetLastError();
+   return Failure(message.str());
+}
+
+ThreadSchedulingResult
+SetCurrentThreadAffinity(const std::vector<unsigned>& cores)
+{
+   DWORD_PTR mask = 0;
+   if (cores.empty())
+   {
+      DWORD_PTR systemMask = 0;
+      GetProcessAffinityMask(GetCurrentProcess(), &mask, &systemMask);
+   }
+   else
+   {
+      for (auto core : cores)
+         if (core < sizeof(DWORD_PTR) * 8)
+            mask |= DWORD_PTR(1) << core;
+   }
+
+   if (mask == 0)
+      return Failure("No usable processor numbers given");
+
+   if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+   {
+      std::ostringstream message;
+      message << "Failed to set thread affinity, error " << GetLastError();
+      return Failure(message.str());
+   }
+
+   return Success("Thread affinity set");
+}
+
+#elif defined(__APPLE__)
+
+ThreadSchedulingResult
+SetCurrentThreadRealtime(const RealtimeThreadOptions& options)
+{
+   mach_timebase_info_data_t timebase;
+   mach_timebase_info(&timebase);
+
+   const auto toAbsolute = [&](std::chrono::nanoseconds duration)
+   {
+      return static_cast<uint32_t>(
+         duration.count() * timebase.denom / timebase.numer);
+   };
+
+   thread_time_constraint_policy_data_t policy;
+   policy.period = toAbsolute(options.period);
+   policy.computation = toAbsolute(options.computation);
+   policy.constraint = toAbsolute(options.period);
+   policy.preemptible = true;
+
+   const auto result = thread_policy_set(
+      pthread_mach_thread_np(pthread_self()), THREAD_TIME_CONSTRAINT_POLICY,
+      reinterpret_cast<thread_policy_t>(&policy),
+      THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+
+   if (result != KERN_SUCCESS)
+   {
+      std::ostringstream message;
+      message << "THREAD_TIME_CONSTRAINT_POLICY failed, error " << result;
+      return Failure(message.str());
+   }
+
+   return Success("THREAD_TIME_CONSTRAINT_POLICY set");
+}
+
+ThreadSchedulingResult SetCurrentThreadAffinity(const std::vector<unsigned>&)
+{
+   // macOS only has affinity "tags" grouping threads, not pinning to cores
+   return Failure("Thread affinity is not supported on macOS");
+}
+
+#else
+
+ThreadSchedulingResult
+SetCurrentThreadRealtime(const RealtimeThreadOptions& options)
+{
+   sched_param param {};
+   param.sched_priority = std::clamp(
+      options.priority, sched_get_priority_min(SCHED_FIFO),
+      sched_get_priority_max(SCHED_FIFO));
+
+   if (const auto error =
+          pthread_setschedparam(pthread_self(), SCHED_FIFO, &param))
+   {
+      std::ostringstream message;
+      message << "SCHED_FIFO priority " << param.sched_priority
+              << " refused: " << std::strerror(error);
+      if (error == EPERM)
+         message << " (see RLIMIT_RTPRIO or the audio group of the system)";
+      return Failure(message.str());
+   }
+
+   std::ostringstream message;
+   message << "SCHED_FIFO priority " << param.sched_priority << " set";
+   return Success(message.str());
+}
+
+ThreadSchedulingResult
+SetCurrentThreadAffinity(const std::vector<unsigned>& cores)
+{
+   cpu_set_t set;
+   CPU_ZERO(&set);
+
+   if (cores.empty())
+   {
+      if (sched_getaffinity(0, sizeof(set), &set) != 0)
+         return Failure("Failed to query process affinity");
+   }
+   else
+   {
+      for (auto core : cores)
+         if (core < CPU_SETSIZE)
+            CPU_SET(core, &set);
+   }
+
+   if (CPU_COUNT(&set) == 0)
+      return Failure("No usable processor numbers given");
+
+   if (const auto error =
+          pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+   {
+      std::ostringstream message;
+      message << "Failed to set thread affinity: " << std::strerror(error);
+      return Failure(message.str());
+   }
+
+   return Success("Thread affinity set");
+}
+
+#endif
+
+std::vector<unsigned> ParseCoreList(const std::string& list)
+{
+   std::vector<unsigned> result;
+   std::istringstream stream { list };
+   std::string item;
+
+   while (std::getline(stream, item, ','))
+   {
+      unsigned first = 0, last = 0;
+      char dash = 0;
+      std::istringstream itemStream { item };
+
+      if (!(itemStream >> first))
+         continue;
+
+      if (itemStream >> dash)
+      {
+         if (dash != '-' || !(itemStream >> last) || last < first)
+            continue;
+      }
+      else
+         last = first;
+
+      for (auto core = first; core <= last; ++core)
+         result.push_back(core);
+   }
+
+   std::sort(result.begin(), result.end());
+   result.erase(std::unique(result.begin(), result.end()), result.end());
+
+   return result;
+}
+
+} // namespace audacity::concurrency
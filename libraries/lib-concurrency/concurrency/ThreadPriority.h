@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ThreadPriority.h
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace audacity::concurrency
+{
+//! Outcome of an attempt to change scheduling of a thread
+struct CONCURRENCY_API ThreadSchedulingResult final
+{
+   bool success { false };
+   //! Explanation of failure, or of what was done, suitable for a log
+   std::string message;
+
+   explicit operator bool() const noexcept
+   {
+      return success;
+   }
+};
+
+//! Hints for real-time scheduling of a periodic thread
+struct CONCURRENCY_API RealtimeThreadOptions final
+{
+   //! Typical interval between wake-ups
+   std::chrono::nanoseconds period { std::chrono::milliseconds { 10 } };
+   //! Typical work in each period; used where the platform asks for it
+   std::chrono::nanoseconds computation { std::chrono::milliseconds { 2 } };
+   //! Priority within the real-time class, 1 (lowest) to 99, where the
+   //! platform has such a notion
+   int priority { 70 };
+};
+
+//! Ask for real-time scheduling of the calling thread
+/*!
+ Uses SCHED_FIFO on Linux, MMCSS "Pro Audio" on Windows, and
+ THREAD_TIME_CONSTRAINT_POLICY on macOS.  Failure, for instance for lack of
+ privileges, leaves scheduling as it was.
+ */
+CONCURRENCY_API ThreadSchedulingResult
+SetCurrentThreadRealtime(const RealtimeThreadOptions& options = {});
+
+//! Restrict the calling thread to the given zero-based processor numbers
+/*!
+ An empty list restores the default of all processors.  Not supported on
+ macOS, where the result reports failure.
+ */
+CONCURRENCY_API ThreadSchedulingResult
+SetCurrentThreadAffinity(const std::vector<unsigned>& cores);
+
+//! Parse a comma separated list of processor numbers and ranges ("0,2-3")
+/*!
+ Ignores malformed entries
+ */
+CONCURRENCY_API std::vector<unsigned> ParseCoreList(const std::string& list);
+
+} // namespace audacity::concurrency
@@ -0,0 +1,167 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: TaskSchedulerTests.cpp
+ */
+
+#include "concurrency/TaskScheduler.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace audacity::concurrency;
+
+TEST_CASE("TaskScheduler")
+{
+   const size_t nThreads = GENERATE(1, 4);
+   TaskScheduler scheduler { nThreads };
+   REQUIRE(scheduler.ThreadCount() == nThreads);
+
+   SECTION("a group waits for all its tasks")
+   {
+      std::atomic<int> sum { 0 };
+      TaskGroup group { scheduler };
+      for (int ii = 1; ii <= 1000; ++ii)
+         group.Run([&sum, ii] { sum += ii; });
+      group.Wait();
+      REQUIRE(sum == 500500);
+   }
+
+   SECTION("tasks may wait for nested groups")
+   {
+      // With one thread, this deadlocks unless waiting runs tasks
+      std::atomic<int> count { 0 };
+      TaskGroup outer { scheduler };
+      for (int ii = 0; ii < 8; ++ii)
+         outer.Run([&] {
+            TaskGroup inner { scheduler };
+            for (int jj = 0; jj < 8; ++jj)
+               inner.Run([&] { ++count; });
+            inner.Wait();
+         });
+      outer.Wait();
+      REQUIRE(count == 64);
+   }
+
+   SECTION("a group may be waited for while polling")
+   {
+      std::atomic<bool> released { false };
+      std::atomic<int> count { 0 };
+      TaskGroup group { scheduler };
+      for (int ii = 0; ii < 4; ++ii)
+         group.Run([&] {
+            while (!released)
+               std::this_thread::yield();
+            ++count;
+         });
+      // The tasks finish only after some polls, which could not happen if
+      // waiting ran a task in this thread
+      int polls = 0;
+      group.WaitPolling(
+         [&] {
+            if (++polls == 3)
+               released = true;
+         },
+         std::chrono::milliseconds { 1 });
+      REQUIRE(polls >= 3);
+      REQUIRE(count == 4);
+   }
+
+   SECTION("exceptions pass to the waiting thread")
+   {
+      std::atomic<int> count { 0 };
+      TaskGroup group { scheduler };
+      for (int ii = 0; ii < 10; ++ii)
+         group.Run([&count, ii] {
+            ++count;
+            if (ii == 3)
+               throw std::runtime_error { "failed" };
+         });
+      REQUIRE_THROWS_AS(group.Wait(), std::runtime_error);
+      // Other tasks still ran
+      REQUIRE(count == 10);
+      // The exception is reported once
+      REQUIRE_NOTHROW(group.Wait());
+   }
+
+   SECTION("a cancelled group starts no more tasks")
+   {
+      std::atomic<bool> released { false };
+      std::atomic<int> count { 0 };
+      const auto pContext = CancellationContext::Create();
+      TaskGroup group { scheduler, TaskPriority::Interactive, pContext };
+      // Occupy all the threads, so that the other tasks stay queued
+      for (size_t ii = 0; ii < nThreads; ++ii)
+         group.Run([&] {
+            while (!released)
+               std::this_thread::yield();
+            ++count;
+         });
+      for (int ii = 0; ii < 10; ++ii)
+         group.Run([&] { ++count; });
+      pContext->Cancel();
+      REQUIRE(group.IsCancelled());
+      released = true;
+      group.Wait();
+      REQUIRE(count <= static_cast<int>(nThreads));
+   }
+
+   SECTION("ranges cover all elements once")
+   {
+      std::vector<std::atomic<int>> counts(1001);
+      ParallelFor(
+         0, counts.size(), 16,
+         [&](long long first, long long last) {
+            REQUIRE(first < last);
+            for (auto ii = first; ii < last; ++ii)
+               ++counts[ii];
+         },
+         TaskPriority::Interactive, scheduler);
+      REQUIRE(std::all_of(counts.begin(), counts.end(), [](auto& count) {
+         return count == 1;
+      }));
+   }
+}
+
+TEST_CASE("TaskScheduler priorities")
+{
+   TaskScheduler scheduler { 1 };
+   std::atomic<bool> started { false };
+   std::atomic<bool> released { false };
+   std::mutex mutex;
+   std::vector<TaskPriority> order;
+   TaskGroup blocker { scheduler };
+   blocker.Run([&] {
+      started = true;
+      while (!released)
+         std::this_thread::yield();
+   });
+   while (!started)
+      std::this_thread::yield();
+
+   const auto record = [&](TaskPriority priority) {
+      return [&, priority] {
+         std::lock_guard<std::mutex> lock { mutex };
+         order.push_back(priority);
+      };
+   };
+   TaskGroup background { scheduler, TaskPriority::Background };
+   TaskGroup interactive { scheduler, TaskPriority::Interactive };
+   TaskGroup nearRealtime { scheduler, TaskPriority::NearRealtime };
+   background.Run(record(TaskPriority::Background));
+   interactive.Run(record(TaskPriority::Interactive));
+   nearRealtime.Run(record(TaskPriority::NearRealtime));
+   released = true;
+   // Wait without running tasks in this thread
+   background.WaitPolling([] {}, std::chrono::milliseconds { 1 });
+   interactive.WaitPolling([] {}, std::chrono::milliseconds { 1 });
+   nearRealtime.WaitPolling([] {}, std::chrono::milliseconds { 1 });
+   REQUIRE(
+      order == std::vector { TaskPriority::NearRealtime,
+                             TaskPriority::Interactive,
+                             TaskPriority::Background });
+}
@@ -15,6 +15,7 @@
 #include "SimpleCompressor/LookAheadGainReduction.h"
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 
 float CompressorProcessor::GetMakeupGainDb(
    const DynamicRangeProcessorSettings& settings)
@@ -159,8 +160,7 @@ void CompressorProcessor::UpdateEnvelope(const float* const* in, int blockLen)
       mEnvelope[i] = max;
    }
 
-   // TODO: uses std::log10 ; use log2 optimization instead.
-   mGainReductionComputer->computeGainInDecibelsFromSidechainSignal(
+   mGainReductionComputer->computeGainInDecibelsFromSidechainBlock(
       mEnvelope.data(), mEnvelope.data(), blockLen);
 
    if (mSettings.lookaheadMs <= 0)
@@ -184,6 +184,12 @@ void CompressorProcessor::ApplyEnvelope(
 {
    const auto makeupGainDb = mGainReductionComputer->getMakeUpGain();
    const auto d = mLookAheadGainReduction->getDelayInSamples();
+
+   // Once for all channels, and with exp2, cheaper than pow(10, ...)
+   constexpr auto dbToLog2 = 1 / log2ToDb;
+   for (auto j = 0; j < blockLen; ++j)
+      mGains[j] = std::exp2((mEnvelope[j] + makeupGainDb) * dbToLog2);
+
    std::array<float, 2> chanAbsMax { 0.f, 0.f };
    std::array<int, 2> chanAbsMaxIndex { 0, 0 };
    for (auto i = 0; i < mNumChannels; ++i)
@@ -196,9 +202,9 @@ void CompressorProcessor::ApplyEnvelope(
             chanAbsMax[i] = std::abs(in[j]);
             chanAbsMaxIndex[i] = j;
          }
-         out[i][j] =
-            in[j] * std::pow(10.f, 0.05f * (mEnvelope[j] + makeupGainDb));
       }
+      for (auto j = 0; j < blockLen; ++j)
+         out[i][j] = in[j] * mGains[j];
       std::move(in + blockLen, in + blockLen + d, in);
    }
    const auto i = chanAbsMax[0] > chanAbsMax[1] ? 0 : 1;
@@ -227,6 +233,7 @@ void CompressorProcessor::Reinit()
       std::fill(v.begin(), v.end(), 0.f);
    });
    std::fill(mEnvelope.begin(), mEnvelope.end(), 0.f);
+   std::fill(mGains.begin(), mGains.end(), 1.f);
 }
 
 bool CompressorProcessor::Initialized() const
@@ -74,6 +74,8 @@ private:
    int mNumChannels = 0;
    int mBlockSize = 0;
    std::array<float, maxBlockSize> mEnvelope;
+   //! Linear gains of the envelope and the make-up gain
+   std::array<float, maxBlockSize> mGains;
    std::vector<std::vector<float>>
       mDelayedInput; // Can't conveniently use an array here, because neither
                      // delay time nor sample rate are known at compile time.
@@ -0,0 +1,74 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DownsamplingQueueWriter.h
+
+**********************************************************************/
+#pragma once
+
+#include "DynamicRangeProcessorTypes.h"
+#include <algorithm>
+#include <optional>
+
+//! Merges a newer item into an older one, keeping what a display must not
+//! miss: the most compression, the highest levels.
+inline DynamicRangeProcessorOutputPacket Merge(
+   const DynamicRangeProcessorOutputPacket& older,
+   const DynamicRangeProcessorOutputPacket& newer)
+{
+   DynamicRangeProcessorOutputPacket merged;
+   merged.indexOfFirstSample = older.indexOfFirstSample;
+   merged.numSamples = older.numSamples + newer.numSamples;
+   merged.targetCompressionDb =
+      std::min(older.targetCompressionDb, newer.targetCompressionDb);
+   merged.actualCompressionDb =
+      std::min(older.actualCompressionDb, newer.actualCompressionDb);
+   merged.inputDb = std::max(older.inputDb, newer.inputDb);
+   merged.outputDb = std::max(older.outputDb, newer.outputDb);
+   return merged;
+}
+
+inline MeterValues Merge(const MeterValues& older, const MeterValues& newer)
+{
+   return { std::min(older.compressionGainDb, newer.compressionGainDb),
+            std::max(older.outputDb, newer.outputDb) };
+}
+
+/*!
+ * \brief Writes to a `LockFreeQueue` from the audio thread, merging the items
+ * that span fewer than a given number of samples, and those that don't fit in
+ * the queue, rather than dropping them. Allocates nothing.
+ */
+template <typename T> class DownsamplingQueueWriter final
+{
+public:
+   explicit DownsamplingQueueWriter(long long minSamplesPerItem = 0)
+       : mMinSamplesPerItem { minSamplesPerItem }
+   {
+   }
+
+   //! @return whether `item`, possibly merged with previous ones, was put
+   bool Write(LockFreeQueue<T>& queue, const T& item, long long numSamples)
+   {
+      mPending = mPending ? Merge(*mPending, item) : item;
+      mNumPendingSamples += numSamples;
+      if (mNumPendingSamples < mMinSamplesPerItem || !queue.Put(*mPending))
+         return false;
+      Reset();
+      return true;
+   }
+
+   //! Forgets the items not yet put
+   void Reset()
+   {
+      mPending.reset();
+      mNumPendingSamples = 0;
+   }
+
+private:
+   long long mMinSamplesPerItem;
+   std::optional<T> mPending;
+   long long mNumPendingSamples = 0;
+};
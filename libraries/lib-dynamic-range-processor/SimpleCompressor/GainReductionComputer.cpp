@@ -18,6 +18,7 @@
 
 #include "GainReductionComputer.h"
 #include "MathApprox.h"
+#include <algorithm>
 
 namespace DanielRudrich {
 namespace
@@ -149,6 +150,44 @@ void GainReductionComputer::computeGainInDecibelsFromSidechainSignal (const floa
     }
 }
 
+void GainReductionComputer::computeGainInDecibelsFromSidechainBlock (const float* sideChainSignal, float* destination, const int numSamples)
+{
+    // The quadratic part of the knee is x * x / (2 * knee), where x is the
+    // overshoot above the start of the knee, clamped to the knee width. The
+    // linear part starts at the end of the knee. With no knee, only the linear
+    // part remains.
+    const float halfInverseKnee = knee > 0.0f ? 0.5f / knee : 0.0f;
+    float maxLevel = -std::numeric_limits<float>::infinity();
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float levelInDecibels =
+           log2ToDb * FastLog2(std::abs(sideChainSignal[i]));
+        maxLevel = std::max(maxLevel, levelInDecibels);
+        const float overShoot = levelInDecibels - threshold;
+        const float inKnee =
+           std::min(std::max(overShoot + kneeHalf, 0.0f), knee);
+        destination[i] =
+           slope * (inKnee * inKnee * halfInverseKnee +
+                    std::max(overShoot - kneeHalf, 0.0f));
+    }
+
+    // The ballistics depend on the previous sample, and can't be vectorized.
+    float s = state;
+    float minState = 0.0f;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float diff = destination[i] - s;
+        s += (diff < 0.0f ? alphaAttack : alphaRelease) * diff;
+        destination[i] = s;
+        minState = std::min(minState, s);
+    }
+    state = s;
+
+    // Once per block, as the atomics are costly
+    maxInputLevel = maxLevel;
+    maxGainReduction = minState;
+}
+
 void GainReductionComputer::computeLinearGainFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
 {
     computeGainInDecibelsFromSidechainSignal (sideChainSignal, destination, numSamples);
@@ -27,7 +27,7 @@ namespace DanielRudrich {
 /**
  This class acts as the side-chain path of a dynamic range compressor. It processes a given side-chain signal and computes the gain reduction samples depending on the parameters threshold, knee, attack-time, release-time, ratio, and make-up gain.
  */
-class GainReductionComputer
+class DYNAMIC_RANGE_PROCESSOR_API GainReductionComputer
 {
 public:
     GainReductionComputer();
@@ -99,6 +99,11 @@ public:
      */
     void computeGainInDecibelsFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples);
 
+    /**
+     Same as computeGainInDecibelsFromSidechainSignal, but in two passes over the block: the levels and the characteristic, with a branchless knee, in a loop the compiler can vectorize, then the ballistics. Gives the same values, up to rounding. `destination` may be `sideChainSignal`.
+     */
+    void computeGainInDecibelsFromSidechainBlock (const float* sideChainSignal, float* destination, const int numSamples);
+
     /**
      Computes the linear gain including make-up gain for a given side-chain signal. The gain written to the destination can be directly applied to the signals which should be compressed.
      */
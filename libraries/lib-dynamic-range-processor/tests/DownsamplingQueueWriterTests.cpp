@@ -0,0 +1,56 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DownsamplingQueueWriterTests.cpp
+
+**********************************************************************/
+#include "DownsamplingQueueWriter.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("DownsamplingQueueWriter")
+{
+   constexpr auto blockSize = 64;
+
+   SECTION("merges items until they span enough samples")
+   {
+      LockFreeQueue<MeterValues> queue { 16 };
+      DownsamplingQueueWriter<MeterValues> sut { 3 * blockSize };
+      REQUIRE(!sut.Write(queue, { -1.f, -10.f }, blockSize));
+      REQUIRE(!sut.Write(queue, { -6.f, -20.f }, blockSize));
+      REQUIRE(sut.Write(queue, { -3.f, -5.f }, blockSize));
+      MeterValues values;
+      REQUIRE(queue.Get(values));
+      REQUIRE(values.compressionGainDb == -6.f);
+      REQUIRE(values.outputDb == -5.f);
+      REQUIRE(!queue.Get(values));
+   }
+
+   SECTION("merges rather than drops what doesn't fit")
+   {
+      // One slot less than the queue size is usable
+      LockFreeQueue<DynamicRangeProcessorOutputPacket> queue { 2 };
+      DownsamplingQueueWriter<DynamicRangeProcessorOutputPacket> sut;
+      const auto packet = [](long long index, float db) {
+         DynamicRangeProcessorOutputPacket packet;
+         packet.indexOfFirstSample = index;
+         packet.numSamples = blockSize;
+         packet.actualCompressionDb = db;
+         return packet;
+      };
+      REQUIRE(sut.Write(queue, packet(0, -1.f), blockSize));
+      REQUIRE(!sut.Write(queue, packet(blockSize, -2.f), blockSize));
+      REQUIRE(!sut.Write(queue, packet(2 * blockSize, -1.f), blockSize));
+
+      DynamicRangeProcessorOutputPacket received;
+      REQUIRE(queue.Get(received));
+      REQUIRE(received.indexOfFirstSample == 0);
+      REQUIRE(sut.Write(queue, packet(3 * blockSize, -.5f), blockSize));
+      REQUIRE(queue.Get(received));
+      // Contiguous with the first, and with the most compression
+      REQUIRE(received.indexOfFirstSample == blockSize);
+      REQUIRE(received.numSamples == 3 * blockSize);
+      REQUIRE(received.actualCompressionDb == -2.f);
+   }
+}
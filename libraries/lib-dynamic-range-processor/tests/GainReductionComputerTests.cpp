@@ -0,0 +1,83 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  GainReductionComputerTests.cpp
+
+**********************************************************************/
+#include "SimpleCompressor/GainReductionComputer.h"
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using DanielRudrich::GainReductionComputer;
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+constexpr auto blockSize = 512;
+constexpr auto numBlocks = 16;
+
+void Prepare(GainReductionComputer& computer, float knee, float ratio)
+{
+   computer.prepare(sampleRate);
+   computer.setThreshold(-20.f);
+   computer.setKnee(knee);
+   computer.setRatio(ratio);
+   computer.setAttackTime(.001f);
+   computer.setReleaseTime(.05f);
+}
+
+// Noise with an envelope going from silence to above 0 dB and back
+std::vector<float> MakeSidechainSignal()
+{
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> dis(-1.f, 1.f);
+   std::vector<float> signal(blockSize * numBlocks);
+   for (size_t i = 0; i < signal.size(); ++i)
+      signal[i] = dis(gen) * 2 * std::sin(3.14159265f * i / signal.size());
+   // Exact zeros too
+   for (size_t i = 0; i < signal.size(); i += 97)
+      signal[i] = 0.f;
+   return signal;
+}
+} // namespace
+
+TEST_CASE("GainReductionComputer")
+{
+   const auto signal = MakeSidechainSignal();
+   for (const auto knee : { 0.f, 10.f })
+      for (const auto ratio :
+           { 2.f, 10.f, std::numeric_limits<float>::infinity() })
+      {
+         GainReductionComputer perSample;
+         GainReductionComputer perBlock;
+         Prepare(perSample, knee, ratio);
+         Prepare(perBlock, knee, ratio);
+         std::array<float, blockSize> expected;
+         std::array<float, blockSize> actual;
+         for (auto b = 0; b < numBlocks; ++b)
+         {
+            const auto in = signal.data() + b * blockSize;
+            perSample.computeGainInDecibelsFromSidechainSignal(
+               in, expected.data(), blockSize);
+            // In place, as CompressorProcessor does
+            std::copy(in, in + blockSize, actual.begin());
+            perBlock.computeGainInDecibelsFromSidechainBlock(
+               actual.data(), actual.data(), blockSize);
+            for (auto i = 0; i < blockSize; ++i)
+               REQUIRE(actual[i] == Approx(expected[i]).margin(1e-4));
+            REQUIRE(
+               perBlock.getMaxInputLevelInDecibels() ==
+               perSample.getMaxInputLevelInDecibels());
+            REQUIRE(
+               perBlock.getMaxGainReductionInDecibels() ==
+               Approx(perSample.getMaxGainReductionInDecibels()).margin(1e-4));
+         }
+      }
+}
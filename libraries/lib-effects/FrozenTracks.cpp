@@ -0,0 +1,181 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+FrozenTracks.cpp
+
+**********************************************************************/
+
+#include "FrozenTracks.h"
+
+#include "BasicUI.h"
+#include "Mix.h"
+#include "MixAndRender.h"
+#include "Project.h"
+#include "RealtimeEffectList.h"
+#include "StretchingSequence.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+#include "XMLWriter.h"
+
+namespace {
+//! Plays the samples of a rendering, but is otherwise the original track
+class FrozenSequence final : public PlayableSequence
+{
+public:
+   FrozenSequence(std::shared_ptr<const WaveTrack> pTrack,
+      std::shared_ptr<const WaveTrack> pRender)
+      : mpTrack{ move(pTrack) }, mpRender{ move(pRender) }
+   {}
+
+   // WideSampleSequence
+   size_t NChannels() const override { return mpRender->NChannels(); }
+   float GetChannelGain(int channel) const override
+   { return mpTrack->GetChannelGain(channel); }
+   double GetStartTime() const override { return mpRender->GetStartTime(); }
+   double GetEndTime() const override { return mpRender->GetEndTime(); }
+   double GetRate() const override { return mpRender->GetRate(); }
+   sampleFormat WidestEffectiveFormat() const override
+   { return mpRender->WidestEffectiveFormat(); }
+   bool HasTrivialEnvelope() const override
+   { return mpRender->HasTrivialEnvelope(); }
+   void GetEnvelopeValues(double* buffer, size_t bufferLen, double t0,
+      bool backwards) const override
+   { mpRender->GetEnvelopeValues(buffer, bufferLen, t0, backwards); }
+   bool DoGet(size_t iChannel, size_t nBuffers, const samplePtr buffers[],
+      sampleFormat format, sampleCount start, size_t len, bool backwards,
+      fillFormat fill, bool mayThrow,
+      sampleCount* pNumWithinClips) const override
+   {
+      return mpRender->DoGet(iChannel, nBuffers, buffers, format, start, len,
+         backwards, fill, mayThrow, pNumWithinClips);
+   }
+   void Prefetch(const void *client,
+      sampleCount start, size_t len, bool backward) const override
+   { mpRender->Prefetch(client, start, len, backward); }
+
+   // PlayableSequence
+   const ChannelGroup *FindChannelGroup() const override
+   { return mpTrack.get(); }
+   bool GetSolo() const override { return mpTrack->GetSolo(); }
+   bool GetMute() const override { return mpTrack->GetMute(); }
+   bool IncludesRealtimeEffects() const override { return true; }
+
+   // AudioGraph::Channel
+   AudioGraph::ChannelType GetChannelType() const override
+   { return mpTrack->GetChannelType(); }
+
+private:
+   const std::shared_ptr<const WaveTrack> mpTrack;
+   const std::shared_ptr<const WaveTrack> mpRender;
+};
+
+const AttachedProjectObjects::RegisteredFactory key{
+   [](AudacityProject &project){
+      return std::make_shared<FrozenTracks>(project);
+   }
+};
+}
+
+FrozenTracks &FrozenTracks::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<FrozenTracks>(key);
+}
+
+const FrozenTracks &FrozenTracks::Get(const AudacityProject &project)
+{
+   return Get(const_cast<AudacityProject &>(project));
+}
+
+FrozenTracks::FrozenTracks(AudacityProject &project)
+   : mProject{ project }
+{
+}
+
+FrozenTracks::~FrozenTracks() = default;
+
+bool FrozenTracks::Freeze(const WaveTrack &track)
+{
+   auto stages = GetEffectStages(track);
+   const auto startTime = track.GetStartTime();
+   const auto endTime = track.GetEndTime();
+   if (stages.empty() || endTime <= startTime)
+      return false;
+
+   const auto nChannels = track.NChannels();
+   const auto rate = track.GetRate();
+   auto render =
+      WaveTrackFactory::Get(mProject).Create(nChannels, floatSample, rate);
+   render->MoveTo(startTime);
+
+   // As for playback:  envelopes and stretching applied by the sequence
+   // before the effects, gains not at all; but no time warp
+   Mixer::Inputs inputs;
+   inputs.emplace_back(
+      StretchingSequence::Create(track, track.GetClipInterfaces()),
+      move(stages));
+   Mixer mixer(move(inputs), std::nullopt,
+      // Throw to abort the freeze if read fails:
+      true, Mixer::WarpOptions{ static_cast<const BoundedEnvelope*>(nullptr) },
+      startTime, endTime, nChannels, render->GetIdealBlockSize(), false,
+      rate, floatSample, true, nullptr, Mixer::ApplyGain::Discard);
+
+   using namespace BasicUI;
+   auto updateResult = ProgressResult::Success;
+   {
+      const auto effectiveFormat = mixer.EffectiveFormat();
+      auto pProgress = MakeProgress(XO("Freeze Effects"),
+         XO("Rendering realtime effects of %s").Format(track.GetName()));
+      while (updateResult == ProgressResult::Success) {
+         const auto blockLen = mixer.Process();
+         if (blockLen == 0)
+            break;
+         for (auto channel : render->Channels())
+            channel->AppendBuffer(mixer.GetBuffer(channel->GetChannelIndex()),
+               floatSample, blockLen, 1, effectiveFormat);
+         updateResult = pProgress->Poll(
+            mixer.MixGetCurrentTime() - startTime, endTime - startTime);
+      }
+   }
+   render->Flush();
+   if (updateResult == ProgressResult::Cancelled ||
+       updateResult == ProgressResult::Failed)
+      return false;
+
+   mEntries[track.GetId()] = { MakeKey(track), move(render) };
+   return true;
+}
+
+void FrozenTracks::Thaw(const WaveTrack &track)
+{
+   mEntries.erase(track.GetId());
+}
+
+bool FrozenTracks::IsFrozen(const WaveTrack &track) const
+{
+   return mEntries.count(track.GetId()) > 0;
+}
+
+std::shared_ptr<const PlayableSequence>
+FrozenTracks::Find(const WaveTrack &track) const
+{
+   const auto iter = mEntries.find(track.GetId());
+   if (iter == mEntries.end() || iter->second.key != MakeKey(track))
+      return {};
+   return std::make_shared<FrozenSequence>(
+      track.SharedPointer<const WaveTrack>(), iter->second.pRender);
+}
+
+std::string FrozenTracks::MakeKey(const WaveTrack &track)
+{
+   // Sample blocks are immutable, so their ids, with the offsets, trims,
+   // envelopes, and stretching of the clips, identify the content; the
+   // effect stack is identified by its settings
+   XMLStringWriter writer;
+   writer.WriteAttr(wxT("rate"), track.GetRate());
+   for (const auto &pClip : track.Intervals())
+      for (size_t ii = 0, nChannels = pClip->NChannels(); ii < nChannels; ++ii)
+         pClip->WriteXML(ii, writer);
+   RealtimeEffectList::Get(track).WriteXML(writer);
+   return writer.ToUTF8().data();
+}
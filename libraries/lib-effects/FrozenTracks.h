@@ -0,0 +1,83 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+FrozenTracks.h
+@brief Cache of the output of the realtime effects of tracks, for playback
+
+**********************************************************************/
+
+#ifndef __AUDACITY_FROZEN_TRACKS__
+#define __AUDACITY_FROZEN_TRACKS__
+
+#include "ClientData.h"
+#include "Track.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+class AudacityProject;
+struct PlayableSequence;
+class WaveTrack;
+
+//! Per-project cache of renderings of tracks through their realtime effects
+/*!
+ A frozen track plays from its rendering, without running its effects, for
+ as long as neither its clips nor its effect stack change.  The rendering is
+ held in sample blocks of tracks that belong to no track list, so that it is
+ neither shown nor saved.
+
+ Use only in the main thread, while there is no playback
+ */
+class EFFECTS_API FrozenTracks final : public ClientData::Base
+{
+public:
+   static FrozenTracks &Get(AudacityProject &project);
+   static const FrozenTracks &Get(const AudacityProject &project);
+
+   explicit FrozenTracks(AudacityProject &project);
+   FrozenTracks(const FrozenTracks&) = delete;
+   FrozenTracks &operator=(const FrozenTracks&) = delete;
+   ~FrozenTracks() override;
+
+   //! Render the track through its enabled realtime effects, replacing any
+   //! previous rendering of it
+   /*!
+    Envelopes and stretching are rendered too, but not gain, pan, or any
+    time track, which playback still applies
+
+    @return false if there were no effects to render, or the user cancelled
+    */
+   bool Freeze(const WaveTrack &track);
+
+   //! Forget the rendering of the track, if any
+   void Thaw(const WaveTrack &track);
+
+   //! Whether there is a rendering of the track, whether or not it is
+   //! up to date
+   bool IsFrozen(const WaveTrack &track) const;
+
+   //! A sequence to play instead of the track, if the track has an up to
+   //! date rendering
+   /*!
+    The sequence reports the solo, mute, gain, and channel group of the track,
+    and that its samples include the effects
+    */
+   std::shared_ptr<const PlayableSequence> Find(const WaveTrack &track) const;
+
+private:
+   //! Identifies the clips and effect stack of a track, as they would be
+   //! saved
+   static std::string MakeKey(const WaveTrack &track);
+
+   struct Entry {
+      std::string key;
+      std::shared_ptr<const WaveTrack> pRender;
+   };
+
+   AudacityProject &mProject;
+   std::map<TrackId, Entry> mEntries;
+};
+
+#endif
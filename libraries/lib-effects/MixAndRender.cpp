@@ -15,9 +15,153 @@ Paul Licameli split from Mix.cpp
 #include "RealtimeEffectList.h"
 #include "StretchingSequence.h"
 #include "WaveTrack.h"
+#include "concurrency/TaskScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 using WaveTrackConstArray = std::vector < std::shared_ptr < const WaveTrack > >;
 
+namespace {
+//! Duration of the pieces of the timeline that workers mix separately
+constexpr double ChunkDuration = 10.0;
+//! Mixed before each piece but discarded, so that resamplers and stretchers
+//! have settled when the piece begins
+constexpr double PrerollDuration = 0.5;
+
+Mixer::Inputs MakeInputs(const TrackIterRange<const WaveTrack> &trackRange)
+{
+   Mixer::Inputs inputs;
+   for (auto wt : trackRange)
+      inputs.emplace_back(
+         StretchingSequence::Create(*wt, wt->GetClipInterfaces()),
+         GetEffectStages(*wt));
+   return inputs;
+}
+
+//! Realtime effect stages have state that depends on all samples before,
+//! and a time track warps the times of samples, so pieces mixed separately
+//! would not join seamlessly
+bool MayMixInParallel(const Mixer::Inputs &inputs,
+   const Mixer::WarpOptions &warpOptions,
+   double rate, double startTime, double endTime)
+{
+   return !warpOptions.envelope &&
+      warpOptions.minSpeed == 1.0 && warpOptions.maxSpeed == 1.0 &&
+      (endTime - startTime) > 2 * ChunkDuration &&
+      std::thread::hardware_concurrency() > 1 &&
+      std::all_of(inputs.begin(), inputs.end(), [](const Mixer::Input &input){
+         return input.stages.empty();
+      });
+}
+
+struct MixedChunk {
+   std::vector<SampleBuffer> buffers;
+   size_t length{ 0 };
+   sampleFormat effectiveFormat{ narrowestSampleFormat };
+   std::atomic<bool> done{ false };
+};
+
+//! Mix pieces of the timeline in worker threads, each with its own Mixer
+//! starting a little before the piece, and append them to mix in order
+BasicUI::ProgressResult MixInParallel(
+   const TrackIterRange<const WaveTrack> &trackRange,
+   const Mixer::WarpOptions &warpOptions, WaveTrack &mix,
+   double rate, sampleFormat format, double startTime, double endTime,
+   size_t maxBlockLen, BasicUI::ProgressDialog &progress)
+{
+   using namespace BasicUI;
+   const auto nChannels = mix.NChannels();
+   const auto chunkLen = static_cast<size_t>(ChunkDuration * rate);
+   const auto prerollLen = static_cast<size_t>(PrerollDuration * rate);
+   const auto totalLen =
+      static_cast<unsigned long long>((endTime - startTime) * rate);
+   const auto nChunks = static_cast<size_t>((totalLen + chunkLen - 1) / chunkLen);
+   // Bound the memory of pieces mixed but not yet appended
+   const size_t batchSize = 2 * std::thread::hardware_concurrency();
+
+   auto result = ProgressResult::Success;
+   size_t next = 0;
+   for (size_t first = 0;
+      first < nChunks && result == ProgressResult::Success;
+      first += batchSize)
+   {
+      const auto last = std::min(nChunks, first + batchSize);
+      std::vector<MixedChunk> chunks(last - first);
+      audacity::concurrency::TaskGroup group;
+      for (auto ii = first; ii < last; ++ii) {
+         // Sequences have state of their own, so each Mixer needs new ones
+         group.Run([&, ii, inputs = MakeInputs(trackRange)]() mutable {
+            auto &chunk = chunks[ii - first];
+            const auto isLast = (ii + 1 == nChunks);
+            const auto discard = std::min(ii * chunkLen, prerollLen);
+            const auto chunkStart = startTime + ii * chunkLen / rate;
+            // Mix a few samples more than the piece, lest rounding of times
+            // in the Mixer leave a gap
+            const auto chunkEnd = isLast ? endTime
+               : std::min(endTime, startTime + ((ii + 1) * chunkLen + 2) / rate);
+            Mixer mixer(std::move(inputs), std::nullopt,
+               true, warpOptions, chunkStart - discard / rate, chunkEnd,
+               nChannels, maxBlockLen, false, rate, format);
+            chunk.effectiveFormat = mixer.EffectiveFormat();
+
+            // The last piece takes whatever remains
+            const auto wanted = isLast ? chunkLen + maxBlockLen : chunkLen;
+            for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+               chunk.buffers.emplace_back(wanted, format);
+            auto toDiscard = discard;
+            while (chunk.length < wanted && !group.IsCancelled()) {
+               const auto blockLen = mixer.Process();
+               if (blockLen == 0)
+                  break;
+               const auto skip = std::min(toDiscard, blockLen);
+               toDiscard -= skip;
+               const auto count =
+                  std::min(blockLen - skip, wanted - chunk.length);
+               for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+                  CopySamples(
+                     mixer.GetBuffer(iChannel) + skip * SAMPLE_SIZE(format),
+                     format,
+                     chunk.buffers[iChannel].ptr()
+                        + chunk.length * SAMPLE_SIZE(format),
+                     format, count, DitherType::none);
+               chunk.length += count;
+            }
+            chunk.done.store(true, std::memory_order_release);
+         });
+      }
+
+      // Append finished pieces in order, while later ones are mixed
+      const auto append = [&]{
+         while (next < last &&
+            chunks[next - first].done.load(std::memory_order_acquire))
+         {
+            auto &chunk = chunks[next - first];
+            for (auto channel : mix.Channels())
+               channel->AppendBuffer(
+                  chunk.buffers[channel->GetChannelIndex()].ptr(),
+                  format, chunk.length, 1, chunk.effectiveFormat);
+            chunk.buffers.clear();
+            ++next;
+         }
+      };
+      group.WaitPolling([&]{
+         if (result != ProgressResult::Success)
+            return;
+         append();
+         result = progress.Poll(
+            std::min<unsigned long long>(next * chunkLen, totalLen), totalLen);
+         if (result != ProgressResult::Success)
+            group.Cancel();
+      });
+      if (result == ProgressResult::Success)
+         append();
+   }
+   return result;
+}
+}
+
 //TODO-MB: wouldn't it make more sense to DELETE the time track after 'mix and render'?
 Track::Holder MixAndRender(const TrackIterRange<const WaveTrack> &trackRange,
    const Mixer::WarpOptions &warpOptions,
@@ -112,33 +256,39 @@ Track::Holder MixAndRender(const TrackIterRange<const WaveTrack> &trackRange,
       endTime = mixEndTime;
    }
 
-   Mixer mixer(
-      std::move(waveArray), std::nullopt,
-      // Throw to abort mix-and-render if read fails:
-      true, warpOptions, startTime, endTime, mono ? 1 : 2, maxBlockLen, false,
-      rate, format);
-
    using namespace BasicUI;
    auto updateResult = ProgressResult::Success;
    {
-      auto effectiveFormat = mixer.EffectiveFormat();
       auto pProgress = MakeProgress(XO("Mix and Render"),
          XO("Mixing and rendering tracks"));
 
-      while (updateResult == ProgressResult::Success) {
-         auto blockLen = mixer.Process();
-
-         if (blockLen == 0)
-            break;
-
-         for(auto channel : mix->Channels())
-         {
-            auto buffer = mixer.GetBuffer(channel->GetChannelIndex());
-            channel->AppendBuffer(buffer, format, blockLen, 1, effectiveFormat);
+      if (MayMixInParallel(waveArray, warpOptions, rate, startTime, endTime))
+         updateResult = MixInParallel(trackRange, warpOptions, *mix,
+            rate, format, startTime, endTime, maxBlockLen, *pProgress);
+      else {
+         Mixer mixer(
+            std::move(waveArray), std::nullopt,
+            // Throw to abort mix-and-render if read fails:
+            true, warpOptions, startTime, endTime, mono ? 1 : 2, maxBlockLen,
+            false, rate, format);
+         auto effectiveFormat = mixer.EffectiveFormat();
+
+         while (updateResult == ProgressResult::Success) {
+            auto blockLen = mixer.Process();
+
+            if (blockLen == 0)
+               break;
+
+            for(auto channel : mix->Channels())
+            {
+               auto buffer = mixer.GetBuffer(channel->GetChannelIndex());
+               channel->AppendBuffer(
+                  buffer, format, blockLen, 1, effectiveFormat);
+            }
+
+            updateResult = pProgress->Poll(
+               mixer.MixGetCurrentTime() - startTime, endTime - startTime);
          }
-
-         updateResult = pProgress->Poll(
-            mixer.MixGetCurrentTime() - startTime, endTime - startTime);
       }
    }
    mix->Flush();
@@ -20,16 +20,41 @@
 
 #include "PerTrackEffect.h"
 #include "EffectOutputTracks.h"
+#include "EffectProfiler.h"
 
 #include "AudioGraphBuffers.h"
+#include "AudioGraphPipelinedSource.h"
 #include "AudioGraphTask.h"
 #include "EffectStage.h"
+#include "Prefs.h"
+#include "RemoteEffectInstance.h"
 #include "SyncLock.h"
 #include "TimeWarper.h"
+#include "Tracing.h"
 #include "ViewInfo.h"
 #include "WaveTrack.h"
 #include "WaveTrackSink.h"
 #include "WideSampleSource.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+//! Account for the time of the effect on one track
+std::shared_ptr<EffectProfiler::Entry> RegisterProfile(
+   const PerTrackEffect &effect, const Track &track)
+{
+   return EffectProfiler::Get().Register(
+      wxString::Format(wxT("%s: %s"),
+         effect.GetName().Translation(), track.GetName()),
+      false);
+}
+}
+
+BoolSetting PerTrackEffect::PipelineSetting{
+   L"/Effects/PipelineStages", false };
+
+BoolSetting PerTrackEffect::ConcurrentTracksSetting{
+   L"/Effects/ConcurrentTracks", true };
 
 PerTrackEffect::Instance::~Instance() = default;
 
@@ -61,6 +86,11 @@ bool PerTrackEffect::DoPass2() const
    return false;
 }
 
+bool PerTrackEffect::InstancesAreIndependent() const
+{
+   return false;
+}
+
 bool PerTrackEffect::Process(
    EffectInstance &instance, EffectSettings &settings) const
 {
@@ -78,10 +108,15 @@ bool PerTrackEffect::Process(
    // mPass = 1;
    if (DoPass1()) {
       auto &myInstance = dynamic_cast<Instance&>(instance);
-      bGoodResult = pThis->ProcessPass(pOutputs->Get(), myInstance, settings);
+      // Plug-ins of foreign code may instead process in other processes
+      const auto pRemote = RemoteEffectInstance::Create(*this);
+      auto &processing = pRemote
+         ? static_cast<EffectInstance&>(*pRemote)
+         : static_cast<EffectInstance&>(myInstance);
+      bGoodResult = pThis->ProcessPass(pOutputs->Get(), processing, settings);
       // mPass = 2;
       if (bGoodResult && DoPass2())
-         bGoodResult = pThis->ProcessPass(pOutputs->Get(), myInstance, settings);
+         bGoodResult = pThis->ProcessPass(pOutputs->Get(), processing, settings);
    }
    if (bGoodResult)
       pOutputs->Commit();
@@ -90,7 +125,7 @@ bool PerTrackEffect::Process(
 }
 
 bool PerTrackEffect::ProcessPass(TrackList &outputs,
-   Instance &instance, EffectSettings &settings)
+   EffectInstance &instance, EffectSettings &settings)
 {
    const auto duration = settings.extra.GetDuration();
    bool bGoodResult = true;
@@ -110,12 +145,19 @@ bool PerTrackEffect::ProcessPass(TrackList &outputs,
    if (numAudioOut < 1)
       return false;
 
+   if (isProcessor && numAudioIn > 0 &&
+      InstancesAreIndependent() && ConcurrentTracksSetting.Read())
+      return ProcessPassConcurrently(outputs, instance, settings);
+
    // Instances that can be reused in each loop pass
    std::vector<std::shared_ptr<EffectInstance>> recycledInstances{
       // First one is the given one; any others pushed onto here are
       // discarded when we exit
-      std::dynamic_pointer_cast<EffectInstanceEx>(instance.shared_from_this())
+      instance.shared_from_this()
    };
+   // Any others are made like the given one
+   const bool remote =
+      dynamic_cast<RemoteEffectInstance*>(&instance) != nullptr;
 
    const bool multichannel = numAudioIn > 1;
    int iChannel = 0;
@@ -260,8 +302,25 @@ bool PerTrackEffect::ProcessPass(TrackList &outputs,
          WideSampleSequence *pSeq = &chan;
          if (pRight)
             pSeq = &wt;
-         WideSampleSource source{
-            *pSeq, size_t(pRight ? 2 : 1), start, len, pollUser };
+         // When pipelined, the source is released in another thread, where it
+         // only records the position for polling of the user in this thread
+         const bool pipelined = !genLength && PipelineSetting.Read();
+         std::atomic<long long> polledPos{ start.as_long_long() };
+         std::atomic<bool> cancelled{ false };
+         const auto recordPosition = [&](sampleCount inPos) {
+            polledPos = inPos.as_long_long();
+            return !cancelled;
+         };
+         const auto pollPipeline = [&]{
+            if (pollUser(sampleCount{ polledPos.load() }))
+               return true;
+            cancelled = true;
+            return false;
+         };
+         WideSampleSource source{ *pSeq, size_t(pRight ? 2 : 1), start, len,
+            pipelined
+               ? WideSampleSource::Poller{ recordPosition }
+               : WideSampleSource::Poller{ pollUser } };
          // Assert source is safe to Acquire inBuffers
          assert(source.AcceptsBuffers(inBuffers));
          assert(source.AcceptsBlockSize(inBuffers.BlockSize()));
@@ -277,22 +336,30 @@ bool PerTrackEffect::ProcessPass(TrackList &outputs,
             ? wideTrack
             : narrowTrack;
 
+         // A generated track is read by nothing else until done, so it can
+         // be written in another thread; a processor's source reads the
+         // channels that the sink writes
          WaveTrackSink sink{ chan, pRight, pGenerated.get(), start, isProcessor,
-            instance.NeedsDither() ? widestSampleFormat : narrowestSampleFormat
+            instance.NeedsDither() ? widestSampleFormat : narrowestSampleFormat,
+            pGenerated != nullptr
          };
          assert(sink.AcceptsBuffers(outBuffers));
 
          // Go process the track(s)
          const auto factory =
-         [this, &recycledInstances, counter = 0]() mutable {
+         [this, &recycledInstances, remote, counter = 0]() mutable {
             auto index = counter++;
             if (index < recycledInstances.size())
                return recycledInstances[index];
             else
-               return recycledInstances.emplace_back(MakeInstance());
+               return recycledInstances.emplace_back(remote
+                  ? std::shared_ptr<EffectInstance>{
+                     RemoteEffectInstance::Create(*this) }
+                  : MakeInstance());
          };
          bGoodResult = ProcessTrack(channel, factory, settings, source, sink,
-            genLength, sampleRate, wt, inBuffers, outBuffers);
+            genLength, sampleRate, wt, inBuffers, outBuffers,
+            pipelined ? std::function<bool()>{ pollPipeline } : nullptr);
          if (bGoodResult) {
             sink.Flush(outBuffers);
             bGoodResult = sink.IsOk();
@@ -355,13 +422,209 @@ bool PerTrackEffect::ProcessPass(TrackList &outputs,
    return bGoodResult;
 }
 
+bool PerTrackEffect::ProcessPassConcurrently(TrackList &outputs,
+   EffectInstance &instance, EffectSettings &settings)
+{
+   assert(InstancesAreIndependent());
+   const auto duration = settings.extra.GetDuration();
+   const auto numAudioIn = instance.GetAudioInCount();
+   const auto numAudioOut = instance.GetAudioOutCount();
+   const bool multichannel = numAudioIn > 1;
+
+   // One job for each track, or each channel, as ProcessPass() would visit
+   struct Job {
+      WaveTrack &wt;
+      WaveChannel &left;
+      WaveChannel *pRight;
+      int channel;
+      sampleCount start, len;
+   };
+   std::vector<Job> jobs;
+   double total = 0;
+   for (auto pTrack : outputs.Any()) {
+      const auto pWaveTrack = dynamic_cast<WaveTrack*>(pTrack);
+      if (!(pWaveTrack && pWaveTrack->GetSelected())) {
+         if (SyncLock::IsSyncLockSelected(*pTrack))
+            pTrack->SyncLockAdjust(mT1, mT0 + duration);
+         continue;
+      }
+      auto &wt = *pWaveTrack;
+      const auto channels = wt.Channels();
+      sampleCount start = 0, len = 0;
+      GetBounds(wt, &start, &len);
+      if (len == 0)
+         continue;
+      if (multichannel)
+         // TODO: more-than-two-channels
+         jobs.push_back({ wt, **channels.begin(),
+            wt.NChannels() == 2 ? (*channels.rbegin()).get() : nullptr,
+            -1, start, len });
+      else {
+         int iChannel = 0;
+         for (const auto pChannel : channels)
+            jobs.push_back({ wt, *pChannel, nullptr, iChannel++, start, len });
+      }
+      total += len.as_double();
+   }
+   if (jobs.empty())
+      return true;
+
+   // A pool of instances, and a copy of the settings, for each job in progress
+   struct Slot {
+      EffectSettings settings;
+      std::vector<std::shared_ptr<EffectInstance>> instances;
+      size_t blockSize{};
+   };
+   const auto nSlots = std::min<size_t>(jobs.size(),
+      std::max(1u, std::thread::hardware_concurrency()));
+   std::vector<std::unique_ptr<Slot>> slots;
+   std::vector<Slot*> freeSlots;
+   for (size_t ii = 0; ii < nSlots; ++ii) {
+      auto &slot = *slots.emplace_back(std::make_unique<Slot>());
+      slot.settings = settings;
+      if (ii == 0)
+         slot.instances.push_back(instance.shared_from_this());
+      else
+         slot.instances.push_back(MakeInstance());
+      if (!slot.instances[0])
+         return false;
+      freeSlots.push_back(&slot);
+   }
+
+   // The graph for one job, applying the effect in a worker thread
+   struct Running {
+      Running(const Job &job, Slot &slot, unsigned numAudioIn,
+         unsigned numAudioOut, sampleFormat effectiveFormat)
+         : job{ job }, slot{ slot }
+         , polledPos{ job.start.as_long_long() }
+         , source{ job.pRight
+               ? static_cast<const WideSampleSequence&>(job.wt)
+               : static_cast<const WideSampleSequence&>(job.left),
+            size_t(job.pRight ? 2 : 1), job.start, job.len,
+            [this](sampleCount inPos) {
+               polledPos = inPos.as_long_long();
+               return !cancelled;
+            } }
+         , sink{ job.left, job.pRight, nullptr, job.start, true,
+            effectiveFormat }
+      {
+         const auto blockSize = slot.blockSize;
+         const auto max = job.wt.GetMaxBlockSize() * 2;
+         const auto bufferSize =
+            ((max + (blockSize - 1)) / blockSize) * blockSize;
+         inBuffers.Reinit(numAudioIn, blockSize,
+            std::max<size_t>(1, bufferSize / blockSize));
+         // Clear unused input buffers
+         for (size_t i = job.pRight ? 2 : 1; i < numAudioIn; ++i)
+            inBuffers.ClearBuffer(i, bufferSize);
+         inBuffers.Rewind();
+         outBuffers.Reinit(numAudioOut, blockSize,
+            (bufferSize / blockSize) + 1);
+      }
+
+      bool Start(const PerTrackEffect &effect, double sampleRate)
+      {
+         const auto factory = [this, &effect, counter = 0]() mutable {
+            auto index = counter++;
+            if (index < slot.instances.size())
+               return slot.instances[index];
+            else
+               return slot.instances.emplace_back(effect.MakeInstance());
+         };
+         pStage = EffectStage::Create(job.channel,
+            static_cast<const WideSampleSequence&>(job.wt).NChannels(),
+            source, inBuffers, factory, slot.settings, sampleRate, {},
+            RegisterProfile(effect, job.wt));
+         if (!pStage)
+            return false;
+         const auto blockSize = inBuffers.BlockSize();
+         processor.emplace(*pStage, outBuffers.Channels(), blockSize,
+            outBuffers.BufferSize() / blockSize);
+         task.emplace(*processor, outBuffers, sink);
+         // Satisfy the invariant of Task::RunOnce()
+         outBuffers.Rewind();
+         return true;
+      }
+
+      const Job &job;
+      Slot &slot;
+      std::atomic<long long> polledPos;
+      std::atomic<bool> cancelled{ false };
+      Buffers inBuffers, outBuffers;
+      WideSampleSource source;
+      WaveTrackSink sink;
+      std::unique_ptr<EffectStage> pStage;
+      std::optional<AudioGraph::PipelinedSource> processor;
+      std::optional<AudioGraph::Task> task;
+   };
+
+   const auto effectiveFormat =
+      instance.NeedsDither() ? widestSampleFormat : narrowestSampleFormat;
+   std::vector<std::unique_ptr<Running>> running;
+   size_t iNextJob = 0;
+   double finished = 0;
+   bool bGoodResult = true;
+   while (bGoodResult && (iNextJob < jobs.size() || !running.empty())) {
+      // Start jobs while there are free slots
+      while (bGoodResult && iNextJob < jobs.size() && !freeSlots.empty()) {
+         auto &job = jobs[iNextJob++];
+         auto &slot = *freeSlots.back();
+         freeSlots.pop_back();
+         if (slot.blockSize == 0)
+            slot.blockSize =
+               slot.instances[0]->SetBlockSize(job.wt.GetMaxBlockSize() * 2);
+         if (slot.blockSize == 0) {
+            bGoodResult = false;
+            break;
+         }
+         auto &pRunning = running.emplace_back(std::make_unique<Running>(
+            job, slot, std::max(1u, numAudioIn), numAudioOut,
+            effectiveFormat));
+         bGoodResult = pRunning->Start(*this, job.wt.GetRate());
+      }
+      if (!bGoodResult)
+         break;
+
+      // Write one block of each job in turn, while the workers continue
+      for (auto iter = running.begin(); bGoodResult && iter != running.end();) {
+         auto &job = **iter;
+         const auto status = job.task->RunOnce();
+         if (status == AudioGraph::Task::Status::Fail)
+            bGoodResult = false;
+         else if (status == AudioGraph::Task::Status::Done) {
+            job.sink.Flush(job.outBuffers);
+            bGoodResult = job.sink.IsOk();
+            finished += job.job.len.as_double();
+            freeSlots.push_back(&job.slot);
+            // Finalizes the instances
+            iter = running.erase(iter);
+         }
+         else
+            ++iter;
+      }
+
+      // Sum the progress of all jobs
+      auto done = finished;
+      for (auto &pRunning : running)
+         done += (sampleCount{ pRunning->polledPos.load() } -
+            pRunning->job.start).as_double();
+      if (bGoodResult && TotalProgress(done / total))
+         bGoodResult = false;
+   }
+   for (auto &pRunning : running)
+      pRunning->cancelled = true;
+   return bGoodResult;
+}
+
 bool PerTrackEffect::ProcessTrack(int channel, const Factory &factory,
    EffectSettings &settings,
    AudioGraph::Source &upstream, AudioGraph::Sink &sink,
    std::optional<sampleCount> genLength,
    const double sampleRate, const SampleTrack &wt,
-   Buffers &inBuffers, Buffers &outBuffers)
+   Buffers &inBuffers, Buffers &outBuffers,
+   const std::function<bool()> &pollUser)
 {
+   AUDACITY_TRACE_SCOPE("PerTrackEffect::ProcessTrack");
    assert(upstream.AcceptsBuffers(inBuffers));
    assert(sink.AcceptsBuffers(outBuffers));
 
@@ -369,15 +632,30 @@ bool PerTrackEffect::ProcessTrack(int channel, const Factory &factory,
    assert(upstream.AcceptsBlockSize(blockSize));
    assert(blockSize == outBuffers.BlockSize());
 
+   // Read in another thread
+   std::optional<AudioGraph::PipelinedSource> reader;
+   if (pollUser)
+      reader.emplace(upstream, inBuffers.Channels(), blockSize,
+         inBuffers.BufferSize() / blockSize);
+
    auto pSource = EffectStage::Create(
-      channel, static_cast<const WideSampleSequence&>(wt).NChannels(), upstream,
-      inBuffers, factory, settings, sampleRate, genLength);
+      channel, static_cast<const WideSampleSequence&>(wt).NChannels(),
+      reader ? *reader : upstream,
+      inBuffers, factory, settings, sampleRate, genLength,
+      RegisterProfile(*this, wt));
    if (!pSource)
       return false;
    assert(pSource->AcceptsBlockSize(blockSize)); // post of ctor
    assert(pSource->AcceptsBuffers(outBuffers));
 
-   AudioGraph::Task task{ *pSource, outBuffers, sink };
+   // Apply the effect in another thread, and write in this one
+   std::optional<AudioGraph::PipelinedSource> processor;
+   if (pollUser)
+      processor.emplace(*pSource, outBuffers.Channels(), blockSize,
+         outBuffers.BufferSize() / blockSize, 4, pollUser);
+
+   AudioGraph::Task task{
+      processor ? *processor : *pSource, outBuffers, sink };
    return task.RunLoop();
 }
 
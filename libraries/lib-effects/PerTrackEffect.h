@@ -22,6 +22,7 @@
 #include <functional>
 #include <memory>
 
+class BoolSetting;
 class EffectOutputTracks;
 class SampleTrack;
 
@@ -40,6 +41,14 @@ class EFFECTS_API PerTrackEffect
 public:
    ~PerTrackEffect() override;
 
+   //! Whether processing reads, applies the effect, and writes in three
+   //! threads concurrently
+   static BoolSetting PipelineSetting;
+
+   //! Whether several tracks may be processed at once, each by its own
+   //! instances, when the effect allows it
+   static BoolSetting ConcurrentTracksSetting;
+
    class EFFECTS_API Instance : public virtual EffectInstanceEx {
    public:
       explicit Instance(const PerTrackEffect &processor)
@@ -63,6 +72,13 @@ protected:
    /* virtual */ bool DoPass1() const;
    /* virtual */ bool DoPass2() const;
 
+   //! Whether instances made by MakeInstance() share no state with each other
+   //! or with the effect, so that they may process in several threads at once
+   /*!
+    Default implementation returns false
+    */
+   virtual bool InstancesAreIndependent() const;
+
    // non-virtual
    bool Process(EffectInstance &instance, EffectSettings &settings) const;
 
@@ -77,8 +93,21 @@ protected:
 private:
    using Buffers = AudioGraph::Buffers;
 
+   /*!
+    @param instance is either an Instance or a RemoteEffectInstance
+    */
    bool ProcessPass(TrackList &outputs,
-      Instance &instance, EffectSettings &settings);
+      EffectInstance &instance, EffectSettings &settings);
+   //! Alternative to ProcessPass() for a processor effect, applying it to
+   //! each selected track (or channel) in a worker thread of its own
+   /*!
+    Up to as many tracks as there are cores are in progress together, each
+    with its own pool of instances, reused by later tracks; samples are
+    still written only in the calling thread
+    @pre `InstancesAreIndependent()`
+    */
+   bool ProcessPassConcurrently(TrackList &outputs,
+      EffectInstance &instance, EffectSettings &settings);
    using Factory = std::function<std::shared_ptr<EffectInstance>()>;
    /*!
     Previous contents of inBuffers and outBuffers are ignored
@@ -89,6 +118,10 @@ private:
     @pre `sink.AcceptsBuffers(outBuffers)`
     @pre `inBuffers.BlockSize() == outBuffers.BlockSize()`
 
+    @param pollUser if not null, then source is acquired, and the effect is
+       applied, in other threads, and this is called in the calling thread
+       instead, returning false to cancel
+
     @pre `channel < track.NChannels()`
     */
    static bool ProcessTrack(int channel,
@@ -96,7 +129,8 @@ private:
       AudioGraph::Source &source, AudioGraph::Sink &sink,
       std::optional<sampleCount> genLength,
       double sampleRate, const SampleTrack &wt,
-      Buffers &inBuffers, Buffers &outBuffers);
+      Buffers &inBuffers, Buffers &outBuffers,
+      const std::function<bool()> &pollUser = {});
 
    // TODO: put this in struct EffectContext? (Which doesn't exist yet)
    mutable std::shared_ptr<EffectOutputTracks> mpOutputTracks;
@@ -0,0 +1,189 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ConstantQ.cpp
+
+**********************************************************************/
+#include "ConstantQ.h"
+
+#include "RealFFTf.h"
+#include "WindowTable.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+namespace {
+//! Kernels below this fraction of the greatest magnitude are dropped
+constexpr float SparsityThreshold = 1e-3f;
+//! How many sets of kernels Get() keeps
+constexpr size_t MaxCached = 8;
+}
+
+std::shared_ptr<const ConstantQKernels> ConstantQKernels::Get(
+   size_t fftLen, size_t windowSize, int windowType, double rate)
+{
+   using Key = std::tuple<size_t, size_t, int, double>;
+   static std::mutex mutex;
+   // Most recently used first
+   static std::list<std::pair<Key, std::shared_ptr<const ConstantQKernels>>>
+      cache;
+
+   const Key key{ fftLen, windowSize, windowType, rate };
+   std::lock_guard<std::mutex> lock{ mutex };
+   const auto iter = std::find_if(cache.begin(), cache.end(),
+      [&](const auto &pair){ return pair.first == key; });
+   if (iter != cache.end()) {
+      cache.splice(cache.begin(), cache, iter);
+      return cache.front().second;
+   }
+   cache.emplace_front(key, std::make_shared<const ConstantQKernels>(
+      fftLen, windowSize, windowType, rate));
+   if (cache.size() > MaxCached)
+      cache.pop_back();
+   return cache.front().second;
+}
+
+ConstantQKernels::ConstantQKernels(
+   size_t fftLen, size_t windowSize, int windowType, double rate)
+   : mFftLen{ fftLen }
+   , mRate{ rate }
+{
+   assert(windowSize > 0);
+   assert(windowSize <= fftLen);
+
+   // Semitones, but wider bins if the window can't hold kernels of at least
+   // eight cycles of the lowest frequency
+   const double q = std::min(
+      1 / (std::exp2(1.0 / 12) - 1), std::max(1.0, windowSize / 8.0));
+   mBinsPerOctave = 1 / std::log2(1 + 1 / q);
+   // The longest kernel fills the window
+   mMinFrequency = q * rate / windowSize;
+
+   const auto half = mFftLen / 2;
+   const auto hFFT = GetFFT(mFftLen);
+   std::vector<float> re(mFftLen), im(mFftLen), magnitudes(half + 1);
+   std::vector<std::pair<float, float>> spectrum(half + 1);
+   for (size_t bin = 0; GetFrequency(bin) < rate / 2; ++bin) {
+      const auto frequency = GetFrequency(bin);
+      const auto length = std::min(windowSize,
+         static_cast<size_t>(std::ceil(q * rate / frequency)));
+
+      // Windowed complex exponential, centered like the window of samples,
+      // and scaled so that a sinusoid of amplitude 1 gives magnitude 1
+      const auto pWindow = GetWindowTable(windowType, length, false);
+      const auto &window = *pWindow;
+      const auto sum = std::accumulate(window.begin(), window.end(), 0.0);
+      const auto scale = sum > 0 ? 2.0 / sum : 0.0;
+      std::fill(re.begin(), re.end(), 0.0f);
+      std::fill(im.begin(), im.end(), 0.0f);
+      const auto offset = half - length / 2;
+      for (size_t ii = 0; ii < length; ++ii) {
+         const auto phase = 2 * M_PI * frequency *
+            (static_cast<double>(ii) - static_cast<double>(length / 2)) / rate;
+         re[offset + ii] = scale * window[ii] * std::cos(phase);
+         im[offset + ii] = scale * window[ii] * std::sin(phase);
+      }
+
+      // The transform of re + i im, from the transforms of each
+      RealFFTf(re.data(), hFFT.get());
+      RealFFTf(im.data(), hFFT.get());
+      for (size_t jj = 0; jj <= half; ++jj) {
+         float aRe, aIm = 0, bRe, bIm = 0;
+         if (jj == 0)
+            aRe = re[0], bRe = im[0];
+         else if (jj == half)
+            aRe = re[1], bRe = im[1];
+         else {
+            const auto index = hFFT->BitReversed[jj];
+            aRe = re[index], aIm = re[index + 1];
+            bRe = im[index], bIm = im[index + 1];
+         }
+         spectrum[jj] = { aRe - bIm, aIm + bRe };
+         magnitudes[jj] = std::hypot(spectrum[jj].first, spectrum[jj].second);
+      }
+
+      // Keep the range above the threshold, with the 1 / N of Parseval's
+      // theorem
+      const auto threshold = SparsityThreshold *
+         *std::max_element(magnitudes.begin(), magnitudes.end());
+      size_t first = 0, last = half;
+      while (first < last && magnitudes[first] <= threshold)
+         ++first;
+      while (last > first && magnitudes[last] <= threshold)
+         --last;
+      auto &kernel = mKernels.emplace_back();
+      kernel.first = first;
+      kernel.values.reserve(2 * (last - first + 1));
+      for (auto jj = first; jj <= last; ++jj) {
+         kernel.values.push_back(spectrum[jj].first / mFftLen);
+         kernel.values.push_back(-spectrum[jj].second / mFftLen);
+      }
+   }
+
+   // Interpolate in the logarithm of frequency
+   const auto nBins = mKernels.size();
+   mLower.resize(half);
+   mFraction.resize(half);
+   for (size_t jj = 0; jj < half; ++jj) {
+      const auto frequency = jj * rate / mFftLen;
+      const auto position = frequency <= mMinFrequency ? 0.0 :
+         mBinsPerOctave * std::log2(frequency / mMinFrequency);
+      const auto lower =
+         std::min(static_cast<size_t>(position), nBins - 1);
+      mLower[jj] = lower;
+      mFraction[jj] = lower + 1 < nBins ? position - lower : 0.0f;
+   }
+}
+
+double ConstantQKernels::GetFrequency(size_t bin) const
+{
+   return mMinFrequency * std::exp2(bin / mBinsPerOctave);
+}
+
+void ConstantQKernels::GetPowers(
+   const FFTParam &fft, const float *spectrum, float *powers) const
+{
+   assert(fft.Points * 2 == mFftLen);
+   const auto half = mFftLen / 2;
+
+   // Spectrum in the natural order, interleaved, and powers of the bins,
+   // for one column at a time in each thread
+   thread_local std::vector<float> natural, binPowers;
+   natural.resize(2 * (half + 1));
+   binPowers.resize(mKernels.size());
+   natural[0] = spectrum[0];
+   natural[1] = 0;
+   for (size_t jj = 1; jj < half; ++jj) {
+      const auto index = fft.BitReversed[jj];
+      natural[2 * jj] = spectrum[index];
+      natural[2 * jj + 1] = spectrum[index + 1];
+   }
+   natural[2 * half] = spectrum[1];
+   natural[2 * half + 1] = 0;
+
+   for (size_t bin = 0; bin < mKernels.size(); ++bin) {
+      const auto &kernel = mKernels[bin];
+      const float *const x = natural.data() + 2 * kernel.first;
+      const float *const k = kernel.values.data();
+      float re = 0, im = 0;
+      for (size_t ii = 0, nn = kernel.values.size(); ii < nn; ii += 2) {
+         re += x[ii] * k[ii] - x[ii + 1] * k[ii + 1];
+         im += x[ii] * k[ii + 1] + x[ii + 1] * k[ii];
+      }
+      binPowers[bin] = re * re + im * im;
+   }
+
+   for (size_t jj = 0; jj < half; ++jj) {
+      const auto lower = mLower[jj];
+      const auto fraction = mFraction[jj];
+      powers[jj] = fraction == 0 ? binPowers[lower] :
+         binPowers[lower] + fraction * (binPowers[lower + 1] - binPowers[lower]);
+   }
+}
@@ -0,0 +1,86 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ConstantQ.h
+  @brief Constant-Q spectra from the results of RealFFTf
+
+**********************************************************************/
+#ifndef __AUDACITY_CONSTANT_Q__
+#define __AUDACITY_CONSTANT_Q__
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+struct FFTParam;
+
+//! Spectral kernels of a constant-Q transform, as in Brown and Puckette,
+//! "An efficient algorithm for the calculation of a constant Q transform",
+//! JASA 92 (1992)
+/*!
+ Each bin of the transform is the inner product of the samples with a
+ windowed complex exponential, whose length is inversely proportional to the
+ frequency, so higher bins have better time resolution.  The products are
+ computed in the frequency domain, from the one FFT of the samples, with the
+ FFTs of the exponentials, which are precomputed and sparse.
+
+ Bins are a twelfth of an octave apart, unless the window is too short, and
+ the lowest bin has the longest kernel that fits in the window.
+ */
+class FFT_API ConstantQKernels final {
+public:
+   //! Kernels computed once for each combination of the arguments, and
+   //! shared, in any thread
+   static std::shared_ptr<const ConstantQKernels> Get(
+      size_t fftLen, size_t windowSize, int windowType, double rate);
+
+   /*!
+    @param fftLen length of transforms given to GetPowers()
+    @param windowSize samples of the transforms that contain signal, which
+       are centered, with zero padding on either side
+    @param windowType one of eWindowFunctions, for the kernels
+    @pre `fftLen` is a power of two
+    @pre `windowSize <= fftLen`
+    */
+   ConstantQKernels(
+      size_t fftLen, size_t windowSize, int windowType, double rate);
+
+   size_t FFTLength() const { return mFftLen; }
+   //! Number of constant-Q bins
+   size_t NBins() const { return mKernels.size(); }
+   double GetFrequency(size_t bin) const;
+
+   //! Compute powers of the constant-Q transform, interpolated at the
+   //! frequencies of the bins of the FFT
+   /*!
+    A sinusoid of amplitude 1 at the frequency of a bin gives power near 1
+
+    @param fft for `FFTLength()`
+    @param spectrum as computed by `RealFFTf(spectrum, &fft)` from samples
+       not multiplied by any window
+    @param powers receives `FFTLength() / 2` values, omitting Nyquist
+    */
+   void GetPowers(
+      const FFTParam &fft, const float *spectrum, float *powers) const;
+
+private:
+   struct Kernel {
+      //! Index of the first FFT bin of the sparse kernel
+      size_t first;
+      //! Conjugated, interleaved real and imaginary parts
+      std::vector<float> values;
+   };
+
+   const size_t mFftLen;
+   const double mRate;
+   double mMinFrequency;
+   double mBinsPerOctave;
+   std::vector<Kernel> mKernels;
+   //! For each FFT bin, constant-Q bin below and fraction toward the next
+   std::vector<size_t> mLower;
+   std::vector<float> mFraction;
+};
+
+#endif
@@ -47,11 +47,14 @@
 #include <wx/wxcrtvararg.h>
 #include <stdlib.h>
 #include <math.h>
+#include <mutex>
 
 #include "RealFFTf.h"
 
 using Floats = ArrayOf<float>;
 static ArraysOf<int> gFFTBitTable;
+// FFT() may be called in several threads at once
+static std::mutex gFFTBitTableMutex;
 static const size_t MaxFastBits = 16;
 
 /* Declare Static functions */
@@ -111,6 +114,7 @@ void InitFFT()
 
 void DeinitFFT()
 {
+   std::lock_guard<std::mutex> lock{ gFFTBitTableMutex };
    gFFTBitTable.reset();
 }
 
@@ -139,8 +143,11 @@ void FFT(size_t NumSamples,
       exit(1);
    }
 
-   if (!gFFTBitTable)
-      InitFFT();
+   {
+      std::lock_guard<std::mutex> lock{ gFFTBitTableMutex };
+      if (!gFFTBitTable)
+         InitFFT();
+   }
 
    if (!InverseTransform)
       angle_numerator = -angle_numerator;
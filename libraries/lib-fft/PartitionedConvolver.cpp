@@ -0,0 +1,98 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PartitionedConvolver.cpp
+
+**********************************************************************/
+#include "PartitionedConvolver.h"
+
+#include <algorithm>
+#include <cassert>
+
+PartitionedConvolver::PartitionedConvolver(
+   const float *impulse, size_t impulseLength, size_t blockSize)
+   : mBlockSize{ blockSize }
+   , mImpulseLength{ impulseLength }
+   , mFftSize{ 2 * blockSize }
+   , mhFFT{ GetFFT(mFftSize) }
+   , mNPartitions{ (impulseLength + blockSize - 1) / blockSize }
+   , mPartitions(mNPartitions * mFftSize)
+   , mHistory(mNPartitions * mFftSize)
+   , mInput(mFftSize)
+   , mBuffer(mFftSize)
+{
+   assert(impulseLength > 0);
+   assert(blockSize >= 2 && (blockSize & (blockSize - 1)) == 0);
+
+   // Each partition is zero padded to twice the block size, so that the
+   // second half of each circular convolution is the linear one
+   for (size_t ii = 0; ii < mNPartitions; ++ii) {
+      const auto begin = impulse + ii * mBlockSize;
+      const auto count = std::min(mBlockSize, impulseLength - ii * mBlockSize);
+      std::fill(mInput.begin(), mInput.end(), 0.0f);
+      std::copy(begin, begin + count, mInput.begin());
+      Transform(mInput.data(), mPartitions.data() + ii * mFftSize);
+   }
+   Reset();
+}
+
+void PartitionedConvolver::Reset()
+{
+   std::fill(mHistory.begin(), mHistory.end(), 0.0f);
+   std::fill(mInput.begin(), mInput.end(), 0.0f);
+   mNewest = 0;
+}
+
+void PartitionedConvolver::Transform(const float *samples, float *spectrum)
+{
+   const auto hFFT = mhFFT.get();
+   std::copy(samples, samples + mFftSize, spectrum);
+   RealFFTf(spectrum, hFFT);
+   if (hFFT->pSetup)
+      // Already in the natural order
+      return;
+   const auto buffer = mBuffer.data();
+   std::copy(spectrum, spectrum + mFftSize, buffer);
+   for (size_t ii = 1, half = mFftSize / 2; ii < half; ++ii) {
+      const auto index = hFFT->BitReversed[ii];
+      spectrum[2 * ii] = buffer[index];
+      spectrum[2 * ii + 1] = buffer[index + 1];
+   }
+}
+
+void PartitionedConvolver::Process(const float *input, float *output)
+{
+   // Slide the window of input, before output may overwrite it
+   const auto pInput = mInput.data();
+   std::copy(pInput + mBlockSize, pInput + mFftSize, pInput);
+   std::copy(input, input + mBlockSize, pInput + mBlockSize);
+   mNewest = (mNewest + 1) % mNPartitions;
+   Transform(pInput, mHistory.data() + mNewest * mFftSize);
+
+   // Multiply each partition with the spectrum of the input delayed by as
+   // many blocks, and accumulate
+   const auto sum = mBuffer.data();
+   std::fill(sum, sum + mFftSize, 0.0f);
+   for (size_t ii = 0; ii < mNPartitions; ++ii) {
+      const auto iBlock = (mNewest + mNPartitions - ii) % mNPartitions;
+      const float *const x = mHistory.data() + iBlock * mFftSize;
+      const float *const h = mPartitions.data() + ii * mFftSize;
+      sum[0] += x[0] * h[0];
+      sum[1] += x[1] * h[1];
+      for (size_t jj = 2; jj < mFftSize; jj += 2) {
+         sum[jj] += x[jj] * h[jj] - x[jj + 1] * h[jj + 1];
+         sum[jj + 1] += x[jj] * h[jj + 1] + x[jj + 1] * h[jj];
+      }
+   }
+
+   // The second half of the inverse transform, in the time order
+   const auto hFFT = mhFFT.get();
+   InverseRealFFTf(sum, hFFT);
+   for (size_t ii = 0; ii < mBlockSize; ii += 2) {
+      const auto index = hFFT->BitReversed[(mBlockSize + ii) / 2];
+      output[ii] = sum[index];
+      output[ii + 1] = sum[index + 1];
+   }
+}
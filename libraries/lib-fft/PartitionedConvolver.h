@@ -0,0 +1,78 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PartitionedConvolver.h
+  @brief Fast convolution with long impulse responses, in short blocks
+
+**********************************************************************/
+#ifndef __AUDACITY_PARTITIONED_CONVOLVER__
+#define __AUDACITY_PARTITIONED_CONVOLVER__
+
+#include <cstddef>
+#include "PowerSpectrumGetter.h" // PffftFloatVector
+#include "RealFFTf.h"
+
+//! Convolution of a stream with a finite impulse response, by uniformly
+//! partitioned overlap-save
+/*!
+ The impulse response is divided into partitions of the block size, whose
+ spectra are computed once.  Each block of input is transformed once, and its
+ spectrum stays in a delay line, to be multiplied with each partition in turn,
+ so that the cost of a block grows with the length of the impulse response in
+ multiplications only, and the only latency is that of the block.
+
+ Not thread-safe; use one object for each stream
+ */
+class FFT_API PartitionedConvolver final {
+public:
+   /*!
+    @param impulse the impulse response, copied
+    @param impulseLength at least 1
+    @param blockSize samples given to each Process(), a power of two, at
+    least 2
+    */
+   PartitionedConvolver(
+      const float *impulse, size_t impulseLength, size_t blockSize);
+
+   size_t BlockSize() const { return mBlockSize; }
+   size_t ImpulseLength() const { return mImpulseLength; }
+
+   //! Forget the input, as if the next block follows silence
+   void Reset();
+
+   //! Convolve the next `BlockSize()` samples
+   /*!
+    `output[i]` is the convolution at the time of `input[i]`, including that
+    sample times the first value of the impulse response.  After the end of
+    the input, Process() blocks of zeroes to get the last
+    `ImpulseLength() - 1` samples.
+
+    @param input may be the same as output
+    */
+   void Process(const float *input, float *output);
+
+private:
+   //! Transform mFftSize samples, giving complex values in the natural
+   //! order, after the real values at DC and Nyquist
+   void Transform(const float *samples, float *spectrum);
+
+   const size_t mBlockSize;
+   const size_t mImpulseLength;
+   const size_t mFftSize;
+   const HFFT mhFFT;
+   const size_t mNPartitions;
+   //! Spectra of the partitions of the impulse response, each of mFftSize
+   PffftFloatVector mPartitions;
+   //! Spectra of the latest mNPartitions blocks of input, a ring
+   PffftFloatVector mHistory;
+   //! Index in mHistory of the latest block
+   size_t mNewest{ 0 };
+   //! The previous and the latest blocks of input
+   PffftFloatVector mInput;
+   //! Work space for one spectrum
+   PffftFloatVector mBuffer;
+};
+
+#endif
@@ -10,14 +10,11 @@
 **********************************************************************/
 #include "PowerSpectrumGetter.h"
 
+#include <algorithm>
 #include <cassert>
+#include <thread>
 #include <pffft.h>
 
-void PffftSetupDeleter::Pffft_destroy_setup(PFFFT_Setup *p)
-{
-   pffft_destroy_setup(p);
-}
-
 void *PffftAllocatorBase::Pffft_aligned_malloc(size_t nb_bytes)
 {
    return pffft_aligned_malloc(nb_bytes);
@@ -40,8 +37,7 @@ PffftConstFloats PffftFloatVector::aligned(PffftAlignedCount c) const
 
 PowerSpectrumGetter::PowerSpectrumGetter(int fftSize)
     : mFftSize { fftSize }
-    , mSetup { pffft_new_setup(fftSize, PFFFT_REAL) }
-    , mWork(fftSize)
+    , mpFFT { GetFFT(fftSize) }
 {
 }
 
@@ -49,16 +45,79 @@ PowerSpectrumGetter::~PowerSpectrumGetter()
 {
 }
 
+namespace {
+void GetPowers(const FFTParam &fft, size_t fftSize,
+   const float *__restrict buffer, float *__restrict output)
+{
+   output[0] = buffer[0] * buffer[0];
+   if (fft.pSetup) {
+      // The layout is in the natural order; without the indirection through
+      // BitReversed, the compiler vectorizes this loop
+      for (size_t i = 1; i < fftSize / 2; ++i)
+         output[i] = buffer[2 * i] * buffer[2 * i]
+            + buffer[2 * i + 1] * buffer[2 * i + 1];
+   }
+   else {
+      for (size_t i = 1; i < fftSize / 2; ++i) {
+         const auto k = fft.BitReversed[i];
+         output[i] = buffer[k] * buffer[k] + buffer[k + 1] * buffer[k + 1];
+      }
+   }
+   output[fftSize / 2] = buffer[1] * buffer[1];
+}
+
+//! Don't start a thread for fewer frames than this
+constexpr size_t MinFramesPerThread = 8;
+}
+
 void PowerSpectrumGetter::operator()(
    PffftFloats alignedBuffer, PffftFloats alignedOutput)
 {
    const auto buffer = alignedBuffer.get();
-   const auto output = alignedOutput.get();
-   pffft_transform_ordered(mSetup.get(),
-      buffer, buffer, mWork.data(), PFFFT_FORWARD);
-   output[0] = buffer[0] * buffer[0];
-   for (auto i = 1; i < mFftSize / 2; ++i)
-      output[i] =
-         buffer[i * 2] * buffer[i * 2] + buffer[i * 2 + 1] * buffer[i * 2 + 1];
-   output[mFftSize / 2] = buffer[1] * buffer[1];
+   RealFFTf(buffer, mpFFT.get());
+   GetPowers(*mpFFT, mFftSize, buffer, alignedOutput.get());
+}
+
+void PowerSpectrumGetter::operator()(PffftFloats alignedFrames,
+   size_t nFrames, PffftFloats alignedOutput, unsigned nThreads)
+{
+   // The transforms share mpFFT, and RealFFTf may be called in several
+   // threads at once
+   const size_t nWorkers = std::min<size_t>(
+      std::max(1u, nThreads), std::max<size_t>(1, nFrames / MinFramesPerThread));
+   std::vector<std::thread> threads;
+   threads.reserve(nWorkers - 1);
+   size_t first = 0;
+   for (size_t ii = 0; ii + 1 < nWorkers; ++ii) {
+      const auto last = first + nFrames / nWorkers;
+      threads.emplace_back([=]{
+         ComputeFrames(alignedFrames, alignedOutput, first, last); });
+      first = last;
+   }
+   ComputeFrames(alignedFrames, alignedOutput, first, nFrames);
+   for (auto &thread : threads)
+      thread.join();
+}
+
+PffftAlignedCount PowerSpectrumGetter::GetFrameStride() const
+{
+   return PffftAlignedCount(mFftSize);
+}
+
+PffftAlignedCount PowerSpectrumGetter::GetSpectrumStride() const
+{
+   return PffftAlignedCount(mFftSize / 2 + 1);
+}
+
+void PowerSpectrumGetter::ComputeFrames(PffftFloats alignedFrames,
+   PffftFloats alignedOutput, size_t first, size_t last) const
+{
+   const auto frameStride = GetFrameStride();
+   const auto spectrumStride = GetSpectrumStride();
+   for (auto ii = first; ii < last; ++ii) {
+      const auto buffer = (alignedFrames + frameStride * ii).get();
+      RealFFTf(buffer, mpFFT.get());
+      GetPowers(*mpFFT, mFftSize,
+         buffer, (alignedOutput + spectrumStride * ii).get());
+   }
 }
@@ -10,19 +10,11 @@
 **********************************************************************/
 #pragma once
 
-struct PFFFT_Setup;
-
 #include <memory>
 #include <type_traits>
 #include <vector>
 #include "pffft.h"
-
-struct FFT_API PffftSetupDeleter {
-   void operator ()(PFFFT_Setup *p){ if (p) Pffft_destroy_setup(p); }
-private:
-  void Pffft_destroy_setup(PFFFT_Setup *);
-};
-using PffftSetupHolder = std::unique_ptr<PFFFT_Setup, PffftSetupDeleter>;
+#include "RealFFTf.h"
 
 struct FFT_API PffftAllocatorBase {
    static void *Pffft_aligned_malloc(size_t nb_bytes);
@@ -220,8 +212,30 @@ public:
     */
    void operator()(PffftFloats alignedBuffer, PffftFloats alignedOutput);
 
+   /*!
+    * @brief Computes the power spectra of many frames in one call, which is
+    * faster than one call per frame
+    * @param alignedFrames `nFrames` rows of `GetFrameStride()` floats, each
+    * beginning with `fftSize` input samples. Overwritten, as for the
+    * single-frame overload.
+    * @param alignedOutput `nFrames` rows of `GetSpectrumStride()` floats, each
+    * beginning with `fftSize / 2 + 1` samples.
+    * @param nThreads at most how many threads compute, counting the calling
+    * one, which waits for the others to finish
+    */
+   void operator()(PffftFloats alignedFrames, size_t nFrames,
+      PffftFloats alignedOutput, unsigned nThreads = 1);
+
+   //! Distance between the starts of rows of input to the batched overload
+   PffftAlignedCount GetFrameStride() const;
+   //! Distance between the starts of rows of output of the batched overload
+   PffftAlignedCount GetSpectrumStride() const;
+
 private:
+   //! Spectra of frames `[first, last)` of the batched overload
+   void ComputeFrames(PffftFloats alignedFrames, PffftFloats alignedOutput,
+      size_t first, size_t last) const;
+
    const int mFftSize;
-   PffftSetupHolder mSetup;
-   PffftFloatVector mWork;
+   const HFFT mpFFT;
 };
@@ -37,10 +37,14 @@
 */
 
 #include "RealFFTf.h"
+#include "PowerSpectrumGetter.h"
 
+#include <algorithm>
 #include <vector>
+#include <stdint.h>
 #include <stdlib.h>
 #include <math.h>
+#include <pffft.h>
 
 #include <wx/thread.h>
 
@@ -48,6 +52,25 @@
 #define	M_PI		3.14159265358979323846  /* pi */
 #endif
 
+void PffftSetupDeleter::Pffft_destroy_setup(PFFFT_Setup *p)
+{
+   pffft_destroy_setup(p);
+}
+
+namespace {
+//! Whether to use pffft for real sequences of a length
+bool UsesPffft(size_t fftlen)
+{
+#ifdef EXPERIMENTAL_EQ_SSE_THREADED
+   // RealFFTf48x.cpp needs the tables
+   return false;
+#else
+   // pffft requires a multiple of 32 for real sequences
+   return fftlen % 32 == 0 && fftlen <= INT32_MAX;
+#endif
+}
+}
+
 /*
 *  Initialize the Sine table and Twiddle pointers (bit-reversed pointers)
 *  for the FFT routine.
@@ -64,6 +87,15 @@ HFFT InitializeFFT(size_t fftlen)
    */
    h->Points = fftlen / 2;
 
+   if (UsesPffft(fftlen)) {
+      h->pSetup.reset(pffft_new_setup(static_cast<int>(fftlen), PFFFT_REAL));
+      // pffft's ordered output is already in the natural order
+      h->BitReversed.reinit(h->Points);
+      for (size_t i = 0; i < h->Points; i++)
+         h->BitReversed[i] = 2 * i;
+      return h;
+   }
+
    h->SinTable.reinit(2*h->Points);
 
    h->BitReversed.reinit(h->Points);
@@ -93,7 +125,8 @@ HFFT InitializeFFT(size_t fftlen)
    return h;
 }
 
-enum : size_t { MAX_HFFT = 10 };
+// Enough for all powers of two up to 65536
+enum : size_t { MAX_HFFT = 16 };
 
 // Maintain a pool:
 static std::vector< std::unique_ptr<FFTParam> > hFFTArray(MAX_HFFT);
@@ -140,6 +173,35 @@ void FFTDeleter::operator() (FFTParam *hFFT) const
       delete hFFT;
 }
 
+namespace {
+//! pffft requires this alignment of buffers
+constexpr size_t SimdAlignment = 16;
+
+//! Transform in place with pffft
+/*!
+ @pre `h->pSetup`
+ */
+void PffftTransform(fft_type *buffer, const FFTParam *h,
+   pffft_direction_t direction)
+{
+   const auto fftlen = 2 * h->Points;
+   // Work space for pffft, and room to copy a misaligned buffer, reused by
+   // each thread
+   static thread_local PffftFloatVector scratch;
+   if (scratch.size() < 2 * fftlen)
+      scratch.resize(2 * fftlen);
+   const auto work = scratch.data();
+   const auto aligned =
+      reinterpret_cast<uintptr_t>(buffer) % SimdAlignment == 0;
+   const auto data = aligned ? buffer : work + fftlen;
+   if (!aligned)
+      std::copy(buffer, buffer + fftlen, data);
+   pffft_transform_ordered(h->pSetup.get(), data, data, work, direction);
+   if (!aligned)
+      std::copy(data, data + fftlen, buffer);
+}
+}
+
 /*
 *  Forward FFT routine.  Must call GetFFT(fftlen) first!
 *
@@ -160,6 +222,11 @@ void FFTDeleter::operator() (FFTParam *hFFT) const
 */
 void RealFFTf(fft_type *buffer, const FFTParam *h)
 {
+   if (h->pSetup) {
+      PffftTransform(buffer, h, PFFFT_FORWARD);
+      return;
+   }
+
    fft_type *A,*B;
    const fft_type *sptr;
    const fft_type *endptr1,*endptr2;
@@ -262,6 +329,16 @@ void RealFFTf(fft_type *buffer, const FFTParam *h)
 */
 void InverseRealFFTf(fft_type *buffer, const FFTParam *h)
 {
+   if (h->pSetup) {
+      PffftTransform(buffer, h, PFFFT_BACKWARD);
+      // pffft does not scale, but this routine inverts RealFFTf() exactly
+      const auto fftlen = 2 * h->Points;
+      const auto scale = 1.0f / fftlen;
+      for (size_t i = 0; i < fftlen; ++i)
+         buffer[i] *= scale;
+      return;
+   }
+
    fft_type *A,*B;
    const fft_type *sptr;
    const fft_type *endptr1,*endptr2;
@@ -3,11 +3,30 @@
 
 #include "MemoryX.h"
 
+struct PFFFT_Setup;
+
+struct FFT_API PffftSetupDeleter {
+   void operator ()(PFFFT_Setup *p){ if (p) Pffft_destroy_setup(p); }
+private:
+  void Pffft_destroy_setup(PFFFT_Setup *);
+};
+using PffftSetupHolder = std::unique_ptr<PFFFT_Setup, PffftSetupDeleter>;
+
 using fft_type = float;
+
+//! Tables for transforms of one size, shared by all users of that size
+/*!
+ When pffft supports the size, transforms use its vectorized routines, and
+ BitReversed is the identity on the layout of complex values (each
+ `BitReversed[i] == 2 * i`); then SinTable is empty.  Use BitReversed, as
+ documented for RealFFTf() and InverseRealFFTf(), to be correct either way.
+ */
 struct FFTParam {
    ArrayOf<int> BitReversed;
    ArrayOf<fft_type> SinTable;
    size_t Points;
+   //! Not null if transforms use pffft
+   PffftSetupHolder pSetup;
 #ifdef EXPERIMENTAL_EQ_SSE_THREADED
    int pow2Bits;
 #endif
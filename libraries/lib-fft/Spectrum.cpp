@@ -17,6 +17,7 @@
 
 #include <math.h>
 #include "MemoryX.h"
+#include "WindowTable.h"
 using Floats = ArrayOf<float>;
 
 bool ComputeSpectrum(
@@ -39,13 +40,14 @@ bool ComputeSpectrum(
    Floats out{ windowSize };
    Floats out2{ windowSize };
 
+   const auto pWindow = GetWindowFuncTable(windowFunc, windowSize);
+   const float *const window = pWindow->data();
+
    size_t start = 0;
    unsigned windows = 0;
    while (start + windowSize <= width) {
       for (size_t i = 0; i < windowSize; i++)
-         in[i] = data[start + i];
-
-      WindowFunc(windowFunc, windowSize, in.get());
+         in[i] = data[start + i] * window[i];
 
       if (autocorrelation) {
          // Take FFT
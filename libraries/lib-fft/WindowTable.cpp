@@ -0,0 +1,83 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WindowTable.cpp
+
+**********************************************************************/
+#include "WindowTable.h"
+#include "FFT.h"
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <tuple>
+
+namespace {
+enum class Kind { Old, New, Derivative };
+
+//! Bytes of tables kept for reuse, beyond those still in use elsewhere
+constexpr size_t MaxCachedBytes = 8 * 1024 * 1024;
+
+WindowTable Get(Kind kind, int whichFunction, size_t NumSamples,
+   bool extraSample)
+{
+   using Key = std::tuple<Kind, int, size_t, bool>;
+   static std::mutex mutex;
+   // Most recently used first
+   static std::list<std::pair<Key, WindowTable>> cache;
+   static size_t cachedBytes = 0;
+
+   const Key key{ kind, whichFunction, NumSamples, extraSample };
+   {
+      std::lock_guard<std::mutex> lock{ mutex };
+      const auto iter = std::find_if(cache.begin(), cache.end(),
+         [&](const auto &pair){ return pair.first == key; });
+      if (iter != cache.end()) {
+         cache.splice(cache.begin(), cache, iter);
+         return cache.front().second;
+      }
+   }
+
+   // Compute outside the lock; another thread might duplicate the work
+   auto pTable = std::make_shared<PffftFloatVector>(NumSamples, 1.0f);
+   switch (kind) {
+   case Kind::Old:
+      WindowFunc(whichFunction, NumSamples, pTable->data());
+      break;
+   case Kind::New:
+      NewWindowFunc(whichFunction, NumSamples, extraSample, pTable->data());
+      break;
+   case Kind::Derivative:
+      DerivativeOfWindowFunc(
+         whichFunction, NumSamples, extraSample, pTable->data());
+      break;
+   }
+
+   std::lock_guard<std::mutex> lock{ mutex };
+   const auto iter = std::find_if(cache.begin(), cache.end(),
+      [&](const auto &pair){ return pair.first == key; });
+   if (iter != cache.end())
+      return iter->second;
+   cache.emplace_front(key, pTable);
+   cachedBytes += NumSamples * sizeof(float);
+   while (cachedBytes > MaxCachedBytes && cache.size() > 1) {
+      cachedBytes -= cache.back().second->size() * sizeof(float);
+      cache.pop_back();
+   }
+   return pTable;
+}
+}
+
+WindowTable GetWindowTable(int whichFunction, size_t NumSamples,
+   bool extraSample, bool derivative)
+{
+   return Get(derivative ? Kind::Derivative : Kind::New,
+      whichFunction, NumSamples, extraSample);
+}
+
+WindowTable GetWindowFuncTable(int whichFunction, size_t NumSamples)
+{
+   return Get(Kind::Old, whichFunction, NumSamples, false);
+}
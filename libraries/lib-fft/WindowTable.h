@@ -0,0 +1,32 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WindowTable.h
+  @brief Shared tables of the window functions of FFT.h
+
+**********************************************************************/
+#ifndef __AUDACITY_WINDOW_TABLE__
+#define __AUDACITY_WINDOW_TABLE__
+
+#include <memory>
+#include "PowerSpectrumGetter.h" // PffftFloatVector
+
+//! Immutable values of a window function, well aligned for pffft
+using WindowTable = std::shared_ptr<const PffftFloatVector>;
+
+//! What NewWindowFunc(), or DerivativeOfWindowFunc() if `derivative`, would
+//! multiply into NumSamples values
+/*!
+ Tables are computed once for each combination of arguments, and shared, in
+ any thread.  Those of the most recently used sizes are kept.
+ */
+FFT_API WindowTable GetWindowTable(int whichFunction, size_t NumSamples,
+   bool extraSample, bool derivative = false);
+
+//! What WindowFunc() would multiply into NumSamples values
+//! @copydetails GetWindowTable()
+FFT_API WindowTable GetWindowFuncTable(int whichFunction, size_t NumSamples);
+
+#endif
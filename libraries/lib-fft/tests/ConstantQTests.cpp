@@ -0,0 +1,61 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ConstantQTests.cpp
+
+**********************************************************************/
+#include "ConstantQ.h"
+#include "FFT.h"
+#include "RealFFTf.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+TEST_CASE("ConstantQKernels")
+{
+   constexpr double rate = 44100;
+   const size_t windowSize = GENERATE(256, 4096);
+   const size_t zeroPaddingFactor = GENERATE(1, 2);
+   const size_t fftLen = windowSize * zeroPaddingFactor;
+   const auto pKernels =
+      ConstantQKernels::Get(fftLen, windowSize, eWinFuncHann, rate);
+   REQUIRE(pKernels->NBins() > 0);
+   REQUIRE(ConstantQKernels::Get(fftLen, windowSize, eWinFuncHann, rate) ==
+      pKernels);
+   const auto hFFT = GetFFT(fftLen);
+
+   SECTION("bins are constant-Q")
+   {
+      for (size_t bin = 1; bin < pKernels->NBins(); ++bin)
+         REQUIRE(pKernels->GetFrequency(bin) / pKernels->GetFrequency(bin - 1)
+            == Approx(pKernels->GetFrequency(1) / pKernels->GetFrequency(0)));
+      REQUIRE(pKernels->GetFrequency(pKernels->NBins() - 1) < rate / 2);
+   }
+
+   SECTION("a sinusoid at the frequency of a bin has power near 1 there")
+   {
+      const size_t bin = pKernels->NBins() / 2;
+      const auto frequency = pKernels->GetFrequency(bin);
+      std::vector<float> buffer(fftLen, 0.0f);
+      const auto padding = (fftLen - windowSize) / 2;
+      for (size_t ii = 0; ii < windowSize; ++ii)
+         buffer[padding + ii] =
+            std::cos(2 * M_PI * frequency * (padding + ii) / rate);
+      RealFFTf(buffer.data(), hFFT.get());
+      std::vector<float> powers(fftLen / 2);
+      pKernels->GetPowers(*hFFT, buffer.data(), powers.data());
+
+      const auto nearest = static_cast<size_t>(frequency * fftLen / rate + 0.5);
+      // Not exactly 1, because of interpolation between bins
+      REQUIRE(powers[nearest] == Approx(1).epsilon(0.15));
+      REQUIRE(std::max_element(powers.begin(), powers.end()) - powers.begin()
+         == Approx(nearest).margin(1));
+      // Far below, little leaks
+      REQUIRE(powers[nearest / 4] < 1e-3);
+   }
+}
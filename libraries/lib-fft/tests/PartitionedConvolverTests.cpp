@@ -0,0 +1,151 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PartitionedConvolverTests.cpp
+
+**********************************************************************/
+#include "PartitionedConvolver.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<float> RandomSamples(size_t size)
+{
+   std::mt19937 engine { 42 };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   std::vector<float> result(size);
+   for (auto &sample : result)
+      sample = distribution(engine);
+   return result;
+}
+
+std::vector<float> DirectConvolution(
+   const std::vector<float> &input, const std::vector<float> &impulse)
+{
+   std::vector<float> result(input.size() + impulse.size() - 1);
+   for (size_t ii = 0; ii < input.size(); ++ii)
+      for (size_t jj = 0; jj < impulse.size(); ++jj)
+         result[ii + jj] += input[ii] * impulse[jj];
+   return result;
+}
+
+//! Convolve all of input and the tail, in place in blocks
+std::vector<float> Convolve(
+   PartitionedConvolver &convolver, const std::vector<float> &input)
+{
+   const auto blockSize = convolver.BlockSize();
+   const auto length = input.size() + convolver.ImpulseLength() - 1;
+   std::vector<float> result(
+      (length + blockSize - 1) / blockSize * blockSize);
+   std::copy(input.begin(), input.end(), result.begin());
+   for (size_t ii = 0; ii < result.size(); ii += blockSize)
+      convolver.Process(result.data() + ii, result.data() + ii);
+   result.resize(length);
+   return result;
+}
+}
+
+TEST_CASE("PartitionedConvolver")
+{
+   // Block sizes done with and without pffft; impulse responses shorter
+   // than a block, of a whole number of blocks, and not
+   const size_t blockSize = GENERATE(2, 8, 64, 256);
+   const size_t impulseLength = GENERATE(1, 5, 64, 300, 1024);
+   const auto impulse = RandomSamples(impulseLength);
+   auto input = RandomSamples(2000);
+   std::reverse(input.begin(), input.end());
+   const auto expected = DirectConvolution(input, impulse);
+
+   PartitionedConvolver convolver{
+      impulse.data(), impulseLength, blockSize };
+   REQUIRE(convolver.BlockSize() == blockSize);
+   REQUIRE(convolver.ImpulseLength() == impulseLength);
+
+   SECTION("agrees with direct convolution")
+   {
+      const auto result = Convolve(convolver, input);
+      REQUIRE(result.size() == expected.size());
+      for (size_t ii = 0; ii < result.size(); ++ii)
+         REQUIRE(result[ii] == Approx(expected[ii]).margin(1e-3));
+   }
+
+   SECTION("reset forgets the input")
+   {
+      Convolve(convolver, RandomSamples(777));
+      convolver.Reset();
+      const auto result = Convolve(convolver, input);
+      for (size_t ii = 0; ii < result.size(); ++ii)
+         REQUIRE(result[ii] == Approx(expected[ii]).margin(1e-3));
+   }
+}
+
+// Not run by default; select it with the tag
+TEST_CASE("PartitionedConvolver benchmark", "[.benchmark]")
+{
+   using namespace std::chrono;
+   // As for the longest filter of the Equalization effect
+   constexpr size_t impulseLength = 8191;
+   constexpr size_t length = 1 << 22;
+   const auto impulse = RandomSamples(impulseLength);
+   const auto input = RandomSamples(length);
+   std::vector<float> output(length);
+
+   const auto report = [](const char *what, steady_clock::duration elapsed){
+      const auto nanoseconds =
+         duration_cast<duration<double, std::nano>>(elapsed).count() / length;
+      WARN(what << ": nanoseconds per sample " << nanoseconds);
+   };
+
+   {
+      // Overlap-add with one FFT of fixed size, as by
+      // EqualizationFilter::Filter()
+      constexpr size_t windowSize = 16384;
+      constexpr auto L = windowSize - (impulseLength - 1);
+      const auto hFFT = GetFFT(windowSize);
+      std::vector<float> filter(windowSize), buffer(windowSize),
+         last(windowSize), spectrum(windowSize);
+      std::copy(impulse.begin(), impulse.end(), filter.begin());
+      RealFFTf(filter.data(), hFFT.get());
+      const auto start = steady_clock::now();
+      for (size_t ii = 0; ii < length; ii += L) {
+         const auto count = std::min(L, length - ii);
+         std::fill(buffer.begin(), buffer.end(), 0.0f);
+         std::copy_n(input.data() + ii, count, buffer.begin());
+         RealFFTf(buffer.data(), hFFT.get());
+         spectrum[0] = buffer[0] * filter[0];
+         spectrum[1] = buffer[1] * filter[1];
+         for (size_t jj = 1; jj < windowSize / 2; ++jj) {
+            const auto index = hFFT->BitReversed[jj];
+            const auto re = buffer[index], im = buffer[index + 1];
+            const auto fRe = filter[index], fIm = filter[index + 1];
+            spectrum[2 * jj] = re * fRe - im * fIm;
+            spectrum[2 * jj + 1] = re * fIm + im * fRe;
+         }
+         InverseRealFFTf(spectrum.data(), hFFT.get());
+         ReorderToTime(hFFT.get(), spectrum.data(), buffer.data());
+         for (size_t jj = 0; jj < count; ++jj)
+            output[ii + jj] =
+               buffer[jj] + (jj < impulseLength - 1 ? last[L + jj] : 0);
+         std::swap(buffer, last);
+      }
+      report("Overlap-add of 16384", steady_clock::now() - start);
+   }
+
+   for (size_t blockSize = 64; blockSize <= 8192; blockSize *= 4) {
+      PartitionedConvolver convolver{
+         impulse.data(), impulseLength, blockSize };
+      const auto start = steady_clock::now();
+      for (size_t ii = 0; ii < length; ii += blockSize)
+         convolver.Process(input.data() + ii, output.data() + ii);
+      report(("Partitioned, block size " + std::to_string(blockSize)).c_str(),
+         steady_clock::now() - start);
+   }
+}
@@ -0,0 +1,50 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PowerSpectrumGetterTests.cpp
+
+**********************************************************************/
+#include "PowerSpectrumGetter.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+
+TEST_CASE("PowerSpectrumGetter")
+{
+   SECTION("batches agree with single frames")
+   {
+      // Include sizes done with and without pffft, and thread counts that
+      // don't divide the frames evenly
+      const int fftSize = GENERATE(16, 256, 2048);
+      const unsigned nThreads = GENERATE(1u, 3u, 16u);
+      constexpr size_t nFrames = 37;
+
+      PowerSpectrumGetter getPowerSpectrum { fftSize };
+      const auto frameStride = getPowerSpectrum.GetFrameStride();
+      const auto spectrumStride = getPowerSpectrum.GetSpectrumStride();
+      PffftFloatVector frames(frameStride * nFrames);
+      std::mt19937 engine { 42 };
+      std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+      for (auto &value : frames)
+         value = distribution(engine);
+
+      PffftFloatVector expected(spectrumStride * nFrames);
+      PffftFloatVector buffer(fftSize);
+      for (size_t ii = 0; ii < nFrames; ++ii) {
+         const auto frame = frames.begin() + frameStride * ii;
+         std::copy(frame, frame + fftSize, buffer.begin());
+         getPowerSpectrum(buffer.aligned(), expected.aligned(spectrumStride, ii));
+      }
+
+      PffftFloatVector actual(spectrumStride * nFrames);
+      getPowerSpectrum(frames.aligned(), nFrames, actual.aligned(), nThreads);
+      for (size_t ii = 0; ii < nFrames; ++ii)
+         for (size_t jj = 0; jj <= fftSize / 2; ++jj) {
+            const auto index = spectrumStride * ii + jj;
+            REQUIRE(actual[index] == expected[index]);
+         }
+   }
+}
@@ -0,0 +1,128 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealFFTfTests.cpp
+
+**********************************************************************/
+#include "RealFFTf.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<float> RandomSamples(size_t count)
+{
+   std::mt19937 engine { 42 };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   std::vector<float> result(count);
+   for (auto& value : result)
+      value = distribution(engine);
+   return result;
+}
+} // namespace
+
+TEST_CASE("RealFFTf")
+{
+   // Include sizes done with and without pffft
+   const size_t size = GENERATE(4, 16, 32, 256, 4096);
+   const auto hFFT = GetFFT(size);
+   REQUIRE(hFFT->Points == size / 2);
+   const auto input = RandomSamples(size);
+
+   SECTION("agrees with the definition of the DFT")
+   {
+      auto buffer = input;
+      RealFFTf(buffer.data(), hFFT.get());
+      for (size_t k = 0; k <= size / 2; ++k)
+      {
+         double re = 0, im = 0;
+         for (size_t n = 0; n < size; ++n)
+         {
+            const auto angle = -2 * M_PI * k * n / size;
+            re += input[n] * cos(angle);
+            im += input[n] * sin(angle);
+         }
+         // DC and Fs/2 bins are real, and share the first complex value
+         float actualRe, actualIm = 0;
+         if (k == 0)
+            actualRe = buffer[0];
+         else if (k == size / 2)
+            actualRe = buffer[1];
+         else
+         {
+            const auto index = hFFT->BitReversed[k];
+            actualRe = buffer[index];
+            actualIm = buffer[index + 1];
+         }
+         REQUIRE(actualRe == Approx(re).margin(1e-3));
+         REQUIRE(actualIm == Approx(im).margin(1e-3));
+      }
+   }
+
+   SECTION("is inverted by InverseRealFFTf")
+   {
+      auto buffer = input;
+      RealFFTf(buffer.data(), hFFT.get());
+      // Inverse takes the spectrum in natural order
+      std::vector<float> spectrum(size);
+      for (size_t k = 1; k < size / 2; ++k)
+      {
+         spectrum[2 * k] = buffer[hFFT->BitReversed[k]];
+         spectrum[2 * k + 1] = buffer[hFFT->BitReversed[k] + 1];
+      }
+      spectrum[0] = buffer[0];
+      spectrum[1] = buffer[1];
+      InverseRealFFTf(spectrum.data(), hFFT.get());
+      std::vector<float> output(size);
+      ReorderToTime(hFFT.get(), spectrum.data(), output.data());
+      for (size_t n = 0; n < size; ++n)
+         REQUIRE(output[n] == Approx(input[n]).margin(1e-5));
+   }
+
+   SECTION("accepts misaligned buffers")
+   {
+      std::vector<float> storage(size + 1);
+      const auto buffer = storage.data() + 1;
+      std::copy(input.begin(), input.end(), buffer);
+      RealFFTf(buffer, hFFT.get());
+      auto expected = input;
+      RealFFTf(expected.data(), hFFT.get());
+      REQUIRE(std::equal(expected.begin(), expected.end(), buffer));
+   }
+}
+
+// Not run by default; select it with the tag
+TEST_CASE("RealFFTf benchmark", "[.benchmark]")
+{
+   using namespace std::chrono;
+   for (size_t size = 256; size <= 65536; size *= 2)
+   {
+      const auto hFFT = GetFFT(size);
+      const auto input = RandomSamples(size);
+      auto buffer = input;
+      // About the same total work for each size
+      const auto repetitions = std::max<size_t>(10, (1 << 24) / size);
+      // Alternate the directions, so that values stay bounded
+      const auto start = steady_clock::now();
+      for (size_t i = 0; i < repetitions; ++i)
+      {
+         RealFFTf(buffer.data(), hFFT.get());
+         InverseRealFFTf(buffer.data(), hFFT.get());
+      }
+      const auto elapsed = steady_clock::now() - start;
+      const auto microseconds =
+         duration_cast<duration<double, std::micro>>(elapsed).count() /
+         repetitions;
+      WARN(
+         "Microseconds per forward and inverse transform of " << size
+            << " points: " << microseconds);
+   }
+}
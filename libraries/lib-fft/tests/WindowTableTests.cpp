@@ -0,0 +1,52 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WindowTableTests.cpp
+
+**********************************************************************/
+#include "WindowTable.h"
+#include "FFT.h"
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+TEST_CASE("WindowTable")
+{
+   const int whichFunction = GENERATE(eWinFuncRectangular, eWinFuncHann,
+      eWinFuncBlackmanHarris, eWinFuncGaussian25);
+   const size_t size = GENERATE(16, 1025);
+
+   SECTION("tables agree with the window functions")
+   {
+      const bool extra = GENERATE(false, true);
+      std::vector<float> expected(size, 1.0f);
+      NewWindowFunc(whichFunction, size, extra, expected.data());
+      const auto pTable = GetWindowTable(whichFunction, size, extra);
+      REQUIRE(pTable->size() == size);
+      for (size_t ii = 0; ii < size; ++ii)
+         REQUIRE((*pTable)[ii] == expected[ii]);
+
+      std::fill(expected.begin(), expected.end(), 1.0f);
+      DerivativeOfWindowFunc(whichFunction, size, extra, expected.data());
+      const auto pDerivative = GetWindowTable(whichFunction, size, extra, true);
+      for (size_t ii = 0; ii < size; ++ii)
+         REQUIRE((*pDerivative)[ii] == expected[ii]);
+
+      std::fill(expected.begin(), expected.end(), 1.0f);
+      WindowFunc(whichFunction, size, expected.data());
+      const auto pOld = GetWindowFuncTable(whichFunction, size);
+      for (size_t ii = 0; ii < size; ++ii)
+         REQUIRE((*pOld)[ii] == expected[ii]);
+   }
+
+   SECTION("tables are shared")
+   {
+      const auto pTable = GetWindowTable(whichFunction, size, false);
+      REQUIRE(GetWindowTable(whichFunction, size, false) == pTable);
+      REQUIRE(GetWindowTable(whichFunction, size, true) != pTable);
+      REQUIRE(GetWindowFuncTable(whichFunction, size) != pTable);
+   }
+}
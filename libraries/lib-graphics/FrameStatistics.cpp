@@ -13,6 +13,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <ostream>
 
 namespace
 {
@@ -21,16 +22,122 @@ FrameStatistics& GetInstance() noexcept
    static FrameStatistics frameStatistics;
    return frameStatistics;
 }
+
+//! Small numbers for the threads in the trace, the first for the thread
+//! that traces first, usually the main one
+size_t GetThreadIndex() noexcept
+{
+   static std::atomic<size_t> threadsCount { 0 };
+   thread_local const size_t index = threadsCount++;
+   return index;
+}
+
+const char* GetSectionName(FrameStatistics::SectionID section) noexcept
+{
+   using SectionID = FrameStatistics::SectionID;
+
+   switch (section)
+   {
+   case SectionID::TrackPanel:
+      return "TrackPanel";
+   case SectionID::WaveformView:
+      return "WaveformView";
+   case SectionID::WaveDataCache:
+      return "WaveDataCache";
+   case SectionID::WaveBitmapCachePreprocess:
+      return "WaveBitmapCachePreprocess";
+   case SectionID::WaveBitmapCache:
+      return "WaveBitmapCache";
+   case SectionID::CellularPanelPass:
+      return "CellularPanelPass";
+   case SectionID::CellularPanelNode:
+      return "CellularPanelNode";
+   case SectionID::SpectrumView:
+      return "SpectrumView";
+   case SectionID::GraphicsDataCacheLookup:
+      return "GraphicsDataCacheLookup";
+   default:
+      return "Unknown";
+   }
+}
+
+const char* GetCounterName(FrameStatistics::CounterID counter) noexcept
+{
+   using CounterID = FrameStatistics::CounterID;
+
+   switch (counter)
+   {
+   case CounterID::CacheHits:
+      return "CacheHits";
+   case CounterID::CacheMisses:
+      return "CacheMisses";
+   case CounterID::SamplesRead:
+      return "SamplesRead";
+   default:
+      return "Unknown";
+   }
+}
+
+void WriteJSONString(std::ostream& out, const std::string& value)
+{
+   out << '"';
+
+   for (const char c : value)
+   {
+      switch (c)
+      {
+      case '"':
+         out << "\\\"";
+         break;
+      case '\\':
+         out << "\\\\";
+         break;
+      case '\n':
+         out << "\\n";
+         break;
+      default:
+         if (static_cast<unsigned char>(c) < 0x20)
+            out << ' ';
+         else
+            out << c;
+      }
+   }
+
+   out << '"';
+}
 }
 
 FrameStatistics::Stopwatch::~Stopwatch() noexcept
 {
-   GetInstance().AddEvent(mSection, FrameStatistics::Clock::now() - mStart);
+   const auto end = FrameStatistics::Clock::now();
+   auto& instance = GetInstance();
+
+   instance.AddEvent(mSection, end - mStart);
+
+   if (!instance.mTracing)
+      return;
+
+   TraceEvent event { mSection, std::move(mLabel), mStart, end - mStart,
+                      GetThreadIndex() };
+   instance.AddTraceEvent(std::move(event));
+
+   // The counters of the frame just painted
+   if (mSection == SectionID::TrackPanel)
+   {
+      TraceEvent counters { SectionID::Count, {}, end, {}, GetThreadIndex() };
+
+      for (size_t i = 0; i < size_t(CounterID::Count); ++i)
+         counters.Counts[i] = instance.mCounts[i];
+
+      instance.AddTraceEvent(std::move(counters));
+   }
 }
 
-FrameStatistics::Stopwatch::Stopwatch(SectionID section) noexcept
+FrameStatistics::Stopwatch::Stopwatch(
+   SectionID section, std::string label) noexcept
     : mSection(section)
     , mStart(FrameStatistics::Clock::now())
+    , mLabel(std::move(label))
 {
 }
 
@@ -88,18 +195,40 @@ void FrameStatistics::Section::AddEvent(Duration duration) noexcept
 FrameStatistics::Stopwatch
 FrameStatistics::CreateStopwatch(SectionID section) noexcept
 {
+   return CreateStopwatch(section, LabelFunction {});
+}
+
+FrameStatistics::Stopwatch FrameStatistics::CreateStopwatch(
+   SectionID section, const LabelFunction& label) noexcept
+{
+   auto& instance = GetInstance();
+
    // New frame has started
    if (section == SectionID::TrackPanel)
    {
-      auto& instance = GetInstance();
+      for (size_t i = 0; i < size_t(SectionID::Count); ++i)
+         if (SectionID(i) != SectionID::TrackPanel)
+            instance.mSections[i] = {};
+
+      for (auto& count : instance.mCounts)
+         count = 0;
+   }
+
+   std::string text;
 
-      instance.mSections[size_t(SectionID::WaveformView)] = {};
-      instance.mSections[size_t(SectionID::WaveDataCache)] = {};
-      instance.mSections[size_t(SectionID::WaveBitmapCachePreprocess)] = {};
-      instance.mSections[size_t(SectionID::WaveBitmapCache)] = {};
+   if (instance.mTracing && label)
+   {
+      try
+      {
+         text = label();
+      }
+      catch (...)
+      {
+         // The event is only unlabelled
+      }
    }
 
-   return Stopwatch(section);
+   return Stopwatch(section, std::move(text));
 }
 
 const FrameStatistics::Section&
@@ -127,6 +256,107 @@ void FrameStatistics::AddEvent(SectionID section, Duration duration)
    }
 }
 
+void FrameStatistics::AddCount(CounterID counter, size_t count) noexcept
+{
+   if (counter < CounterID::Count)
+      GetInstance().mCounts[size_t(counter)].fetch_add(
+         count, std::memory_order_relaxed);
+}
+
+size_t FrameStatistics::GetCount(CounterID counter) noexcept
+{
+   return counter < CounterID::Count ?
+             GetInstance().mCounts[size_t(counter)].load(
+                std::memory_order_relaxed) :
+             0;
+}
+
+void FrameStatistics::SetTracing(bool tracing)
+{
+   auto& instance = GetInstance();
+
+   std::lock_guard<std::mutex> lock { instance.mTraceMutex };
+
+   if (tracing && !instance.mTracing)
+   {
+      instance.mTraceEvents.clear();
+      instance.mTraceStart = Clock::now();
+   }
+
+   instance.mTracing = tracing;
+}
+
+bool FrameStatistics::IsTracing() noexcept
+{
+   return GetInstance().mTracing;
+}
+
+void FrameStatistics::WriteTrace(std::ostream& out)
+{
+   auto& instance = GetInstance();
+
+   std::lock_guard<std::mutex> lock { instance.mTraceMutex };
+
+   using Microseconds = std::chrono::duration<double, std::micro>;
+
+   const auto microseconds = [&](Timepoint time)
+   { return Microseconds(time - instance.mTraceStart).count(); };
+
+   out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+   bool first = true;
+
+   for (const auto& event : instance.mTraceEvents)
+   {
+      if (!first)
+         out << ',';
+      first = false;
+
+      out << "\n{\"pid\":1,\"tid\":" << event.ThreadIndex
+          << ",\"ts\":" << microseconds(event.Start);
+
+      if (event.Section == SectionID::Count)
+      {
+         out << ",\"ph\":\"C\",\"name\":\"Frame counters\",\"args\":{";
+
+         for (size_t i = 0; i < size_t(CounterID::Count); ++i)
+            out << (i > 0 ? "," : "") << '"' << GetCounterName(CounterID(i))
+                << "\":" << event.Counts[i];
+
+         out << "}}";
+         continue;
+      }
+
+      const auto sectionName = GetSectionName(event.Section);
+
+      out << ",\"ph\":\"X\",\"dur\":"
+          << Microseconds(event.Length).count() << ",\"cat\":\"" << sectionName
+          << "\",\"name\":";
+
+      WriteJSONString(out, event.Label.empty() ? sectionName : event.Label);
+
+      out << '}';
+   }
+
+   out << "\n]}\n";
+}
+
+void FrameStatistics::AddTraceEvent(TraceEvent event)
+{
+   std::lock_guard<std::mutex> lock { mTraceMutex };
+
+   if (!mTracing)
+      return;
+
+   if (mTraceEvents.size() >= MaxTraceEvents)
+   {
+      mTracing = false;
+      return;
+   }
+
+   mTraceEvents.push_back(std::move(event));
+}
+
 void FrameStatistics::UpdatePublisher::Invoke(FrameStatistics::SectionID id)
 {
    Publish(id);
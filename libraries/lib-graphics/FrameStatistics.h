@@ -11,9 +11,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "Observer.h"
 
@@ -21,6 +26,10 @@
 /*!
  * Object of this class is a global singleton. If there are multiple
  * opened projects, the statistics will be merged.
+ *
+ * While tracing, every stopwatch is also recorded as an event, and the
+ * counters once a frame, so that nested sections of each frame can be
+ * exported in the Chrome trace event format.
  */
 class GRAPHICS_API FrameStatistics final
 {
@@ -42,10 +51,34 @@ public:
       WaveBitmapCachePreprocess,
       //! Time required to access the wave bitmaps cache
       WaveBitmapCache,
+      //! Time required for one pass of drawing over the cells of a panel
+      CellularPanelPass,
+      //! Time required to draw one node of a panel in one pass
+      CellularPanelNode,
+      //! Time required to draw the spectrogram of a single clip
+      SpectrumView,
+      //! Time required to look up a range of any GraphicsDataCache
+      GraphicsDataCacheLookup,
       //! Number of the sections
       Count
    };
 
+   //! ID of what is counted in each frame
+   enum class CounterID
+   {
+      //! Elements of graphics data caches that were found
+      CacheHits,
+      //! Elements of graphics data caches that were made anew
+      CacheMisses,
+      //! Samples read from sample blocks for the waveform
+      SamplesRead,
+      //! Number of the counters
+      Count
+   };
+
+   //! Computes the label of an event, only while tracing
+   using LabelFunction = std::function<std::string()>;
+
    //! A helper that notifies the view that a specific section has changed
    struct GRAPHICS_API UpdatePublisher : Observer::Publisher<SectionID>
    {
@@ -58,10 +91,11 @@ public:
    public:
       ~Stopwatch() noexcept;
    private:
-      explicit Stopwatch(SectionID section) noexcept;
+      Stopwatch(SectionID section, std::string label) noexcept;
 
       SectionID mSection;
       Timepoint mStart;
+      std::string mLabel;
 
       friend class FrameStatistics;
    };
@@ -102,14 +136,55 @@ public:
 
    //! Create a Stopwatch for the section specified
    static Stopwatch CreateStopwatch(SectionID section) noexcept;
+   //! Create a Stopwatch whose trace event is labelled, as with the name of a
+   //! track or a clip
+   static Stopwatch
+   CreateStopwatch(SectionID section, const LabelFunction& label) noexcept;
    //! Get the section data
    static const Section& GetSection(SectionID section) noexcept;
    //! Subscribe to sections update
    static Observer::Subscription Subscribe(UpdatePublisher::Callback callback);
+
+   //! Add to a counter of the current frame; may be called in any thread
+   static void AddCount(CounterID counter, size_t count = 1) noexcept;
+   //! Count of the current frame, or of the last one after it is painted
+   static size_t GetCount(CounterID counter) noexcept;
+
+   //! Start or stop recording trace events; starting discards those recorded
+   static void SetTracing(bool tracing);
+   static bool IsTracing() noexcept;
+   //! Write the recorded events as a JSON object in the Chrome trace event
+   //! format, as chrome://tracing and Perfetto read
+   static void WriteTrace(std::ostream& out);
+
 private:
+   //! A stopwatch, or the counters at the end of a frame if Section is
+   //! SectionID::Count
+   struct TraceEvent final
+   {
+      SectionID Section;
+      std::string Label;
+      Timepoint Start;
+      Duration Length;
+      size_t ThreadIndex;
+      size_t Counts[size_t(CounterID::Count)];
+   };
+
+   //! Recording stops at so many events, so that a trace left running
+   //! does not exhaust memory
+   static constexpr size_t MaxTraceEvents = 1024 * 1024;
+
    void AddEvent(SectionID section, Duration duration);
+   void AddTraceEvent(TraceEvent event);
 
    Section mSections[size_t(SectionID::Count)];
 
    UpdatePublisher mUpdatePublisher;
+
+   std::atomic<size_t> mCounts[size_t(CounterID::Count)] {};
+
+   std::atomic<bool> mTracing { false };
+   std::mutex mTraceMutex;
+   std::vector<TraceEvent> mTraceEvents;
+   Timepoint mTraceStart;
 };
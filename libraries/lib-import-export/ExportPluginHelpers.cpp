@@ -18,6 +18,8 @@
 #include "ExportUtils.h"
 #include "ExportPlugin.h"
 #include "StretchingSequence.h"
+#include "PipelinedMixer.h"
+#include "ExportSource.h"
 
 //Create a mixer by computing the time warp factor
 std::unique_ptr<Mixer> ExportPluginHelpers::CreateMixer(
@@ -42,24 +44,76 @@ std::unique_ptr<Mixer> ExportPluginHelpers::CreateMixer(
       mixerSpec ? Mixer::ApplyGain::MapChannels : Mixer::ApplyGain::Mixdown);
 }
 
+std::unique_ptr<PipelinedMixer> ExportPluginHelpers::CreatePipelinedMixer(
+   const AudacityProject& project, bool selectionOnly, double startTime,
+   double stopTime, unsigned numOutChannels, size_t outBufferSize,
+   bool outInterleaved, double outRate, sampleFormat outFormat,
+   MixerOptions::Downmix* mixerSpec)
+{
+   return std::make_unique<PipelinedMixer>(
+      CreateMixer(project, selectionOnly, startTime, stopTime, numOutChannels,
+         outBufferSize, outInterleaved, outRate, outFormat, mixerSpec),
+      numOutChannels, outInterleaved, outFormat);
+}
+
+std::unique_ptr<ExportSource> ExportPluginHelpers::CreateSource(
+   const AudacityProject& project, bool selectionOnly, double startTime,
+   double stopTime, unsigned numOutChannels, size_t outBufferSize,
+   bool outInterleaved, double outRate, sampleFormat outFormat,
+   MixerOptions::Downmix* mixerSpec)
+{
+   const auto tracks = ExportUtils::FindExportWaveTracks(
+      TrackList::Get(project), selectionOnly);
+   if (tracks.size() == 1)
+   {
+      const auto pTrack = *tracks.begin();
+      if (TrackExportSource::CanReplaceMixer(
+             project, *pTrack, startTime, stopTime, numOutChannels, outRate,
+             mixerSpec))
+         return std::make_unique<TrackExportSource>(
+            pTrack->SharedPointer<const WaveTrack>(), startTime, stopTime,
+            outBufferSize, outInterleaved, outFormat);
+   }
+   return std::make_unique<MixerExportSource>(
+      CreateMixer(project, selectionOnly, startTime, stopTime, numOutChannels,
+         outBufferSize, outInterleaved, outRate, outFormat, mixerSpec));
+}
+
 namespace
 {
-   double EvalExportProgress(Mixer &mixer, double t0, double t1)
+   double EvalExportProgress(double currentTime, double t0, double t1)
    {
       const auto duration = t1 - t0;
       if(duration > 0)
-         return std::clamp(mixer.MixGetCurrentTime() - t0, .0, duration) / duration;
+         return std::clamp(currentTime - t0, .0, duration) / duration;
       return .0;
    }
+
+   ExportResult ReportProgress(ExportProcessorDelegate& delegate, double progress)
+   {
+      delegate.OnProgress(progress);
+      if(delegate.IsStopped())
+         return ExportResult::Stopped;
+      if(delegate.IsCancelled())
+         return ExportResult::Cancelled;
+      return ExportResult::Success;
+   }
 }
 
 ExportResult ExportPluginHelpers::UpdateProgress(ExportProcessorDelegate& delegate, Mixer &mixer, double t0, double t1)
 {
-   delegate.OnProgress(EvalExportProgress(mixer, t0, t1));
-   if(delegate.IsStopped())
-      return ExportResult::Stopped;
-   if(delegate.IsCancelled())
-      return ExportResult::Cancelled;
-   return ExportResult::Success;
+   return ReportProgress(
+      delegate, EvalExportProgress(mixer.MixGetCurrentTime(), t0, t1));
+}
+
+ExportResult ExportPluginHelpers::UpdateProgress(ExportProcessorDelegate& delegate, const PipelinedMixer &mixer, double t0, double t1)
+{
+   return ReportProgress(
+      delegate, EvalExportProgress(mixer.MixGetCurrentTime(), t0, t1));
 }
 
+ExportResult ExportPluginHelpers::UpdateProgress(ExportProcessorDelegate& delegate, const ExportSource &source, double t0, double t1)
+{
+   return ReportProgress(
+      delegate, EvalExportProgress(source.MixGetCurrentTime(), t0, t1));
+}
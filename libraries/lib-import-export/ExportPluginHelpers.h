@@ -20,7 +20,9 @@
 
 class TrackList;
 class WaveTrack;
+class ExportSource;
 class Mixer;
+class PipelinedMixer;
 
 namespace MixerOptions
 {
@@ -37,9 +39,26 @@ public:
       bool outInterleaved, double outRate, sampleFormat outFormat,
       MixerOptions::Downmix* mixerSpec);
 
+   //! CreateMixer(), mixing in a thread of its own, ahead of the export loop
+   static std::unique_ptr<PipelinedMixer> CreatePipelinedMixer(
+      const AudacityProject& project, bool selectionOnly, double startTime,
+      double stopTime, unsigned numOutChannels, size_t outBufferSize,
+      bool outInterleaved, double outRate, sampleFormat outFormat,
+      MixerOptions::Downmix* mixerSpec);
+
+   //! Reads the track straight from its blocks when there is one to export,
+   //! with nothing to mix or resample; else as CreateMixer()
+   static std::unique_ptr<ExportSource> CreateSource(
+      const AudacityProject& project, bool selectionOnly, double startTime,
+      double stopTime, unsigned numOutChannels, size_t outBufferSize,
+      bool outInterleaved, double outRate, sampleFormat outFormat,
+      MixerOptions::Downmix* mixerSpec);
+
    ///\brief Sends progress update to delegate and retrieves state update from it.
    ///Typically used inside each export iteration.
    static ExportResult UpdateProgress(ExportProcessorDelegate& delegate, Mixer& mixer, double t0, double t1);
+   static ExportResult UpdateProgress(ExportProcessorDelegate& delegate, const PipelinedMixer& mixer, double t0, double t1);
+   static ExportResult UpdateProgress(ExportProcessorDelegate& delegate, const ExportSource& source, double t0, double t1);
 
    template<typename T>
    static T GetParameterValue(const ExportProcessor::Parameters& parameters, int id, T defaultValue = T())
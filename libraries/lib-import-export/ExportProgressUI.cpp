@@ -16,6 +16,11 @@
 #include "BasicUI.h"
 #include "FileException.h"
 
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
 namespace
 {
    class DialogExportProgressDelegate : public ExportProcessorDelegate
@@ -75,6 +80,53 @@ namespace
       
    };
 
+   //! Delegate of one of several concurrent tasks, which share one dialog
+   class ConcurrentExportProgressDelegate : public ExportProcessorDelegate
+   {
+      const std::atomic<bool>& mCancelled;
+      const std::atomic<bool>& mStopped;
+      std::atomic<double> mProgress {};
+
+   public:
+      ConcurrentExportProgressDelegate(
+         const std::atomic<bool>& cancelled, const std::atomic<bool>& stopped)
+         : mCancelled { cancelled }, mStopped { stopped }
+      {
+      }
+
+      bool IsCancelled() const override
+      {
+         return mCancelled;
+      }
+
+      bool IsStopped() const override
+      {
+         return mStopped;
+      }
+
+      // The shared dialog counts files instead
+      void SetStatusString(const TranslatableString&) override
+      {
+      }
+
+      void OnProgress(double progress) override
+      {
+         mProgress = progress;
+      }
+
+      double GetProgress() const
+      {
+         return mProgress;
+      }
+   };
+
+   void ShowExportError()
+   {
+      BasicUI::ShowErrorDialog(
+         {}, XO("Export error"),
+         XO("Export completed with error."), {},
+         BasicUI::ErrorDialogOptions { BasicUI::ErrorDialogType::ModalError });
+   }
 }
 
 ExportResult ExportProgressUI::Show(ExportTask exportTask)
@@ -91,12 +143,125 @@ ExportResult ExportProgressUI::Show(ExportTask exportTask)
    ExceptionWrappedCall([&] { result = f.get(); });
 
    if(result == ExportResult::Error)
+      ShowExportError();
+
+   return result;
+}
+
+ExportResult ExportProgressUI::Show(
+   size_t count, size_t maxConcurrent,
+   const std::function<ExportTask(size_t)>& makeTask,
+   const std::function<void(size_t, ExportResult)>& onDone)
+{
+   assert(maxConcurrent > 0);
+
+   struct Running
    {
-      BasicUI::ShowErrorDialog(
-         {}, XO("Export error"),
-         XO("Export completed with error."), {},
-         BasicUI::ErrorDialogOptions { BasicUI::ErrorDialogType::ModalError });
+      size_t index;
+      std::unique_ptr<ConcurrentExportProgressDelegate> delegate;
+      std::future<ExportResult> future;
+   };
+
+   std::atomic<bool> cancelled { false };
+   std::atomic<bool> stopped { false };
+   bool anyError = false;
+   bool anyCancelled = false;
+   bool anyStopped = false;
+
+   const auto finish = [&](size_t index, ExportResult result) {
+      anyError = anyError || result == ExportResult::Error;
+      anyCancelled = anyCancelled || result == ExportResult::Cancelled;
+      anyStopped = anyStopped || result == ExportResult::Stopped;
+      onDone(index, result);
+   };
+
+   const auto message = [&](size_t done) {
+      return XO("Exported %lld of %lld files")
+         .Format(static_cast<long long>(done), static_cast<long long>(count));
+   };
+
+   std::vector<Running> running;
+   size_t next = 0;
+   size_t done = 0;
+   auto progressDialog = BasicUI::MakeProgress(XO("Export"), message(done));
+
+   while (true)
+   {
+      while (running.size() < maxConcurrent && next < count && !anyError &&
+             !anyCancelled && !cancelled && !stopped)
+      {
+         const auto index = next++;
+         auto result = ExportResult::Error;
+         ExceptionWrappedCall([&] {
+            auto task = makeTask(index);
+            assert(task.valid());
+            running.push_back({ index,
+               std::make_unique<ConcurrentExportProgressDelegate>(
+                  cancelled, stopped),
+               task.get_future() });
+            // Any failure from here on is found through the future
+            result = ExportResult::Success;
+            // The delegate outlives the thread, because the future is waited
+            // for before it is destroyed
+            std::thread(std::move(task), std::ref(*running.back().delegate))
+               .detach();
+         });
+         if (result == ExportResult::Error)
+         {
+            ++done;
+            finish(index, result);
+         }
+      }
+
+      if (running.empty())
+         break;
+
+      running.front().future.wait_for(std::chrono::milliseconds(50));
+
+      for (auto iter = running.begin(); iter != running.end();)
+      {
+         if (iter->future.wait_for(std::chrono::seconds(0)) !=
+             std::future_status::ready)
+         {
+            ++iter;
+            continue;
+         }
+         auto result = ExportResult::Error;
+         ExceptionWrappedCall([&] { result = iter->future.get(); });
+         ++done;
+         finish(iter->index, result);
+         iter = running.erase(iter);
+      }
+
+      constexpr long long ProgressSteps = 1000ul;
+      double progress = done;
+      for (const auto& task : running)
+         progress += task.delegate->GetProgress();
+
+      progressDialog->SetMessage(message(done));
+      const auto pollResult = progressDialog->Poll(
+         progress / count * ProgressSteps, ProgressSteps);
+      if (pollResult == BasicUI::ProgressResult::Cancelled)
+      {
+         if (!stopped)
+            cancelled = true;
+      }
+      else if (pollResult == BasicUI::ProgressResult::Stopped)
+      {
+         if (!cancelled)
+            stopped = true;
+      }
    }
+   progressDialog.reset();
 
-   return result;
+   if (anyError)
+   {
+      ShowExportError();
+      return ExportResult::Error;
+   }
+   if (anyCancelled || cancelled)
+      return ExportResult::Cancelled;
+   if (anyStopped || stopped)
+      return ExportResult::Stopped;
+   return ExportResult::Success;
 }
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <functional>
 #include <future>
 
 #include "Export.h"
@@ -25,6 +26,23 @@ namespace ExportProgressUI
 {
 IMPORT_EXPORT_API ExportResult Show(ExportTask exportTask);
 
+//! Run `count` export tasks, at most `maxConcurrent` at once, each in a thread
+//! of its own, with one progress dialog for all of them
+/*!
+ No more tasks start after one fails or is cancelled, or after the user
+ stops or cancels them all.
+
+ @param makeTask called in this thread just before task `i` starts; errors it
+ throws are shown, and count as an Error result of the task
+ @param onDone called in this thread with the result of each task made
+ @return Error if any task failed, else Cancelled if any was, else Stopped
+ if any was, else Success
+ */
+IMPORT_EXPORT_API ExportResult Show(
+   size_t count, size_t maxConcurrent,
+   const std::function<ExportTask(size_t i)>& makeTask,
+   const std::function<void(size_t i, ExportResult result)>& onDone);
+
 template <typename Callable>
 void ExceptionWrappedCall(Callable callable)
 {
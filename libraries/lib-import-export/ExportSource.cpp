@@ -0,0 +1,167 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportSource.cpp
+
+**********************************************************************/
+#include "ExportSource.h"
+
+#include <algorithm>
+
+#include "Dither.h"
+#include "Mix.h"
+#include "MixAndRender.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+
+ExportSource::~ExportSource() = default;
+
+MixerExportSource::MixerExportSource(std::unique_ptr<Mixer> pMixer)
+    : mpMixer { std::move(pMixer) }
+{
+}
+
+MixerExportSource::~MixerExportSource() = default;
+
+size_t MixerExportSource::Process()
+{
+   return mpMixer->Process();
+}
+
+constSamplePtr MixerExportSource::GetBuffer() const
+{
+   return mpMixer->GetBuffer();
+}
+
+constSamplePtr MixerExportSource::GetBuffer(int channel) const
+{
+   return mpMixer->GetBuffer(channel);
+}
+
+double MixerExportSource::MixGetCurrentTime() const
+{
+   return mpMixer->MixGetCurrentTime();
+}
+
+TrackExportSource::TrackExportSource(
+   std::shared_ptr<const WaveTrack> pTrack, double t0, double t1,
+   size_t bufferSize, bool interleaved, sampleFormat format)
+    : mpTrack { std::move(pTrack) }
+    , mNumChannels { mpTrack->NChannels() }
+    , mBufferSize { bufferSize }
+    , mInterleaved { interleaved }
+    , mFormat { format }
+    , mReadsFormat { mpTrack->GetSampleFormat() == format }
+    // As the Mixer would, dither only when precision is really lost
+    , mDitherType { mpTrack->WidestEffectiveFormat() > format
+                       ? gHighQualityDither
+                       : DitherType::none }
+    , mPosition { mpTrack->TimeToLongSamples(t0) }
+    , mEnd { mpTrack->TimeToLongSamples(t1) }
+{
+   if (mInterleaved)
+      mBuffers.emplace_back(mBufferSize * mNumChannels, mFormat);
+   else
+      for (size_t c = 0; c < mNumChannels; ++c)
+         mBuffers.emplace_back(mBufferSize, mFormat);
+
+   // Else samples are read straight into mBuffers
+   if (!mReadsFormat || (mInterleaved && mNumChannels > 1))
+      for (size_t c = 0; c < mNumChannels; ++c)
+         mReadBuffers.emplace_back(
+            mBufferSize, mReadsFormat ? mFormat : floatSample);
+}
+
+TrackExportSource::~TrackExportSource() = default;
+
+size_t TrackExportSource::Process()
+{
+   const auto length = limitSampleBufferSize(mBufferSize, mEnd - mPosition);
+   if (length == 0)
+      return 0;
+
+   const auto &buffers = mReadBuffers.empty() ? mBuffers : mReadBuffers;
+   std::vector<samplePtr> pointers;
+   for (const auto &buffer : buffers)
+      pointers.push_back(buffer.ptr());
+
+   // Throw, to stop exporting, if read fails, as the Mixer would
+   const auto readFormat = mReadsFormat ? mFormat : floatSample;
+   mpTrack->DoGet(
+      0, mNumChannels, pointers.data(), readFormat, mPosition, length, false);
+
+   if (!mReadBuffers.empty())
+      for (size_t c = 0; c < mNumChannels; ++c)
+         CopySamples(
+            mReadBuffers[c].ptr(), readFormat,
+            mInterleaved ? mBuffers[0].ptr() + c * SAMPLE_SIZE(mFormat)
+                         : mBuffers[c].ptr(),
+            mFormat, length, mReadsFormat ? DitherType::none : mDitherType, 1,
+            mInterleaved ? mNumChannels : 1);
+
+   mPosition += length;
+
+   // Load the blocks of the next buffers while these are encoded
+   mpTrack->Prefetch(
+      this, mPosition, limitSampleBufferSize(mBufferSize, mEnd - mPosition),
+      false);
+
+   return length;
+}
+
+constSamplePtr TrackExportSource::GetBuffer() const
+{
+   return mBuffers[0].ptr();
+}
+
+constSamplePtr TrackExportSource::GetBuffer(int channel) const
+{
+   return mBuffers[channel].ptr();
+}
+
+double TrackExportSource::MixGetCurrentTime() const
+{
+   return mpTrack->LongSamplesToTime(mPosition);
+}
+
+bool TrackExportSource::CanReplaceMixer(
+   const AudacityProject& project, const WaveTrack& track, double t0,
+   double t1, unsigned numOutChannels, double outRate,
+   const MixerOptions::Downmix* mixerSpec)
+{
+   const auto nChannels = track.NChannels();
+   if (nChannels != numOutChannels || track.GetRate() != outRate)
+      return false;
+
+   if (mixerSpec)
+   {
+      if (
+         mixerSpec->GetNumTracks() != nChannels ||
+         mixerSpec->GetNumChannels() != nChannels)
+         return false;
+      for (size_t i = 0; i < nChannels; ++i)
+         for (size_t j = 0; j < nChannels; ++j)
+            if (mixerSpec->mMap[i][j] != (i == j))
+               return false;
+   }
+
+   for (size_t c = 0; c < nChannels; ++c)
+      if (track.GetChannelGain(c) != 1.0f)
+         return false;
+
+   if (
+      !track.HasTrivialEnvelope() || MixerOptions::Warp { &project }.envelope ||
+      !GetEffectStages(track).empty() || !GetMasterEffectStages(project).empty())
+      return false;
+
+   const auto clips = track.Intervals();
+   return std::none_of(
+      clips.begin(), clips.end(),
+      [&](const auto& pClip)
+      {
+         return pClip->GetPlayStartTime() < t1 &&
+                pClip->GetPlayEndTime() > t0 && pClip->HasPitchOrSpeed();
+      });
+}
@@ -0,0 +1,113 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportSource.h
+
+**********************************************************************/
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "SampleCount.h"
+#include "SampleFormat.h"
+
+class AudacityProject;
+class Mixer;
+class WaveTrack;
+
+namespace MixerOptions
+{
+class Downmix;
+}
+
+//! The samples that an export loop encodes, in buffers like those of Mixer
+/*!
+ See ExportPluginHelpers::CreateSource(), which reads the samples of a track
+ with no Mixer when nothing is to be mixed
+ */
+class IMPORT_EXPORT_API ExportSource /* not final */
+{
+public:
+   virtual ~ExportSource();
+
+   //! Fill the next buffers, invalidating the previous ones
+   //! @return as Mixer::Process()
+   virtual size_t Process() = 0;
+
+   //! As Mixer::GetBuffer(), for the buffers given by the last Process()
+   virtual constSamplePtr GetBuffer() const = 0;
+   //! As Mixer::GetBuffer(int), for the buffers given by the last Process()
+   virtual constSamplePtr GetBuffer(int channel) const = 0;
+
+   //! As Mixer::MixGetCurrentTime(), after the last Process()
+   virtual double MixGetCurrentTime() const = 0;
+};
+
+//! Buffers of a Mixer
+class IMPORT_EXPORT_API MixerExportSource final : public ExportSource
+{
+public:
+   //! @pre `pMixer` is not null
+   explicit MixerExportSource(std::unique_ptr<Mixer> pMixer);
+   ~MixerExportSource() override;
+
+   size_t Process() override;
+   constSamplePtr GetBuffer() const override;
+   constSamplePtr GetBuffer(int channel) const override;
+   double MixGetCurrentTime() const override;
+
+private:
+   const std::unique_ptr<Mixer> mpMixer;
+};
+
+//! Samples of a track, read with no gain and no change of rate or channels,
+//! converted only to the format to export
+/*!
+ A track stored in that format is copied from its blocks with no conversion
+ at all
+ */
+class IMPORT_EXPORT_API TrackExportSource final : public ExportSource
+{
+public:
+   /*!
+    @pre the clips of `pTrack` in [t0, t1) have no pitch or speed change
+    */
+   TrackExportSource(
+      std::shared_ptr<const WaveTrack> pTrack, double t0, double t1,
+      size_t bufferSize, bool interleaved, sampleFormat format);
+   ~TrackExportSource() override;
+
+   size_t Process() override;
+   constSamplePtr GetBuffer() const override;
+   constSamplePtr GetBuffer(int channel) const override;
+   double MixGetCurrentTime() const override;
+
+   //! Whether exporting `track` from `t0` to `t1` through a Mixer with these
+   //! options would only read its samples, so that this may replace it
+   static bool CanReplaceMixer(
+      const AudacityProject& project, const WaveTrack& track, double t0,
+      double t1, unsigned numOutChannels, double outRate,
+      const MixerOptions::Downmix* mixerSpec);
+
+private:
+   const std::shared_ptr<const WaveTrack> mpTrack;
+   const size_t mNumChannels;
+   const size_t mBufferSize;
+   const bool mInterleaved;
+   const sampleFormat mFormat;
+   //! Whether samples are read in mFormat, else as floats, then converted
+   const bool mReadsFormat;
+   //! Dither converting floats to mFormat
+   const DitherType mDitherType;
+
+   sampleCount mPosition;
+   const sampleCount mEnd;
+
+   //! One interleaved buffer, or one for each channel
+   std::vector<SampleBuffer> mBuffers;
+   //! Samples read for each channel, before they are interleaved or converted
+   std::vector<SampleBuffer> mReadBuffers;
+};
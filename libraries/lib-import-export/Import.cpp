@@ -37,11 +37,13 @@ ImportFileHandle
 #include "ImportPlugin.h"
 
 #include <algorithm>
+#include <optional>
 #include <unordered_set>
 
 #include <wx/log.h>
 #include "FileNames.h"
 #include "Project.h"
+#include "SampleBlock.h"
 #include "WaveTrack.h"
 
 #include "Prefs.h"
@@ -659,8 +661,14 @@ bool Importer::Import(
          if(!importResultProxy.OnImportFileOpened(*inFile))
             return false;
 
-         inFile->Import(
-            importResultProxy, trackFactory, tracks, tags, outAcidTags);
+         {
+            // Group the storage of new sample blocks into fewer transactions
+            std::optional<SampleBlockWriteBatch> batch;
+            if (trackFactory && trackFactory->GetSampleBlockFactory())
+               batch.emplace(*trackFactory->GetSampleBlockFactory());
+            inFile->Import(
+               importResultProxy, trackFactory, tracks, tags, outAcidTags);
+         }
          const auto importResult = importResultProxy.GetResult();
          if (importResult == ImportProgressListener::ImportResult::Success ||
              importResult == ImportProgressListener::ImportResult::Stopped)
@@ -857,4 +865,65 @@ bool Importer::Import(
    return false;
 }
 
+bool Importer::ImportStream(
+   AudacityProject& project, std::shared_ptr<ImportByteStream> stream,
+   const FileExtension& extension,
+   ImportProgressListener* importProgressListener,
+   WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
+   std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
+   TranslatableString& errorMessage)
+{
+   auto cleanup = valueRestorer( project.mbBusyImporting, true );
+
+   const auto name = stream->GetName();
+
+   const auto &plugins = sImportPluginList();
+   const auto pPlugin = std::find_if(plugins.begin(), plugins.end(),
+      [&](ImportPlugin *plugin){
+         return plugin->SupportsStreams() &&
+            plugin->SupportsExtension(extension);
+      });
+   if (pPlugin == plugins.end()) {
+      errorMessage = XO(
+/* i18n-hint: %s will be a file extension, like wav */
+"Audacity cannot import a stream of \"%s\" files.\nSave it to a file and import that instead.")
+         .Format( extension );
+      return false;
+   }
+   const auto plugin = *pPlugin;
+
+   wxLogMessage(wxT("Opening stream %s with %s"),
+      name, plugin->GetPluginStringID());
+   ImportProgressResultProxy importResultProxy(importProgressListener);
+   auto inFile = plugin->OpenStream(std::move(stream), &project);
+   if ( (inFile != NULL) && (inFile->GetStreamCount() > 0) )
+   {
+      if(!importResultProxy.OnImportFileOpened(*inFile))
+         return false;
+
+      {
+         // Group the storage of new sample blocks into fewer transactions
+         std::optional<SampleBlockWriteBatch> batch;
+         if (trackFactory && trackFactory->GetSampleBlockFactory())
+            batch.emplace(*trackFactory->GetSampleBlockFactory());
+         inFile->Import(
+            importResultProxy, trackFactory, tracks, tags, outAcidTags);
+      }
+      const auto importResult = importResultProxy.GetResult();
+      if ((importResult == ImportProgressListener::ImportResult::Success ||
+           importResult == ImportProgressListener::ImportResult::Stopped) &&
+          tracks.size() > 0)
+         return true;
+
+      if (importResult == ImportProgressListener::ImportResult::Cancelled)
+         return false;
+   }
+
+   errorMessage = XO(
+/* i18n-hint: the first %s will be the name of a stream, the second the description of a format */
+"Audacity could not import '%s' as %s.")
+      .Format( name, plugin->GetPluginFormatDescription() );
+   return false;
+}
+
 BoolSetting NewImportingSession{ L"/NewImportingSession", false };
@@ -26,6 +26,7 @@ class Tags;
 class WaveTrackFactory;
 class Track;
 class TrackList;
+class ImportByteStream;
 class ImportPlugin;
 class ImportProgressListener;
 class UnusableImportPlugin;
@@ -182,6 +183,20 @@ public:
        std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
        TranslatableString& errorMessage);
 
+   //! Like Import(), for a stream that can only be read forward
+   /*!
+    The stream can be read only once, so it is given only to the first
+    plug-in for `extension` that ImportPlugin::SupportsStreams(); the
+    extension names the format rather than helping to guess it
+    */
+    bool ImportStream(
+       AudacityProject& project, std::shared_ptr<ImportByteStream> stream,
+       const FileExtension& extension,
+       ImportProgressListener* importProgressListener,
+       WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
+       std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
+       TranslatableString& errorMessage);
+
  private:
     struct Traits : Registry::DefaultTraits
     {
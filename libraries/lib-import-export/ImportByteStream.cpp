@@ -0,0 +1,88 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportByteStream.cpp
+
+**********************************************************************/
+#include "ImportByteStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+ImportByteStream::~ImportByteStream() = default;
+
+FileImportByteStream::FileImportByteStream(FILE* file, FilePath name)
+    : mFile { file }
+    , mName { std::move(name) }
+{
+}
+
+FileImportByteStream::~FileImportByteStream() = default;
+
+FilePath FileImportByteStream::GetName() const
+{
+   return mName;
+}
+
+size_t FileImportByteStream::Read(void* buffer, size_t size)
+{
+   if (mFile == nullptr)
+      return 0;
+   // A pipe may give fewer bytes than asked before its end
+   return fread(buffer, 1, size, mFile);
+}
+
+QueuedImportByteStream::QueuedImportByteStream(FilePath name)
+    : mName { std::move(name) }
+{
+}
+
+QueuedImportByteStream::~QueuedImportByteStream() = default;
+
+void QueuedImportByteStream::Append(const void* data, size_t size)
+{
+   if (size == 0)
+      return;
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      // Drop what was read, at most once for each time the stored bytes
+      // double, so that each byte is moved a bounded number of times
+      if (mReadPosition > mBytes.size() / 2)
+      {
+         mBytes.erase(mBytes.begin(), mBytes.begin() + mReadPosition);
+         mReadPosition = 0;
+      }
+      const auto bytes = static_cast<const char*>(data);
+      mBytes.insert(mBytes.end(), bytes, bytes + size);
+   }
+   mAvailable.notify_all();
+}
+
+void QueuedImportByteStream::Finish()
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mFinished = true;
+   }
+   mAvailable.notify_all();
+}
+
+FilePath QueuedImportByteStream::GetName() const
+{
+   return mName;
+}
+
+size_t QueuedImportByteStream::Read(void* buffer, size_t size)
+{
+   std::unique_lock<std::mutex> lock { mMutex };
+   mAvailable.wait(
+      lock, [this] { return mFinished || mReadPosition < mBytes.size(); });
+
+   const auto count = std::min(size, mBytes.size() - mReadPosition);
+   if (count > 0)
+      memcpy(buffer, mBytes.data() + mReadPosition, count);
+   mReadPosition += count;
+   return count;
+}
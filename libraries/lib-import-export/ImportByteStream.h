@@ -0,0 +1,89 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportByteStream.h
+
+**********************************************************************/
+#pragma once
+
+#include "Identifier.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+//! The bytes of a file to import, which arrive in order and can be read only
+//! once, such as from a pipe or a network download
+/*!
+ Plug-ins that support it decode such a stream as its bytes arrive, see
+ ImportPlugin::OpenStream()
+ */
+class IMPORT_EXPORT_API ImportByteStream /* not final */
+{
+public:
+   virtual ~ImportByteStream();
+
+   //! Names the stream in messages, and the tracks imported from it
+   virtual FilePath GetName() const = 0;
+
+   //! Wait until some bytes are available, and read at most `size` of them
+   /*!
+    @return how many were read, zero only at the end of the stream or after
+    an error
+    */
+   virtual size_t Read(void* buffer, size_t size) = 0;
+};
+
+//! Reads a C stream, such as stdin or the output of `popen()`
+class IMPORT_EXPORT_API FileImportByteStream final : public ImportByteStream
+{
+public:
+   //! @param file is not closed by this
+   FileImportByteStream(FILE* file, FilePath name);
+   ~FileImportByteStream() override;
+
+   FilePath GetName() const override;
+   size_t Read(void* buffer, size_t size) override;
+
+private:
+   FILE* const mFile;
+   const FilePath mName;
+};
+
+//! Bytes given by a producer in another thread, such as the data callback of
+//! a network response
+/*!
+ For a download with lib-network-manager, the callback given to
+ `IResponse::setOnDataReceivedCallback()` can `readData()` into a buffer and
+ Append() it, and the one given to `setRequestFinishedCallback()` can
+ Finish().
+ */
+class IMPORT_EXPORT_API QueuedImportByteStream final : public ImportByteStream
+{
+public:
+   explicit QueuedImportByteStream(FilePath name);
+   ~QueuedImportByteStream() override;
+
+   //! Make bytes available to Read(); does not block
+   void Append(const void* data, size_t size);
+
+   //! Read() returns zero when the bytes appended before this are consumed
+   void Finish();
+
+   FilePath GetName() const override;
+   size_t Read(void* buffer, size_t size) override;
+
+private:
+   const FilePath mName;
+
+   std::mutex mMutex;
+   std::condition_variable mAvailable;
+   std::vector<char> mBytes;
+   //! Bytes before this in mBytes were read
+   size_t mReadPosition { 0 };
+   bool mFinished { false };
+};
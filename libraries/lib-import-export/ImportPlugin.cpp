@@ -35,6 +35,17 @@ TranslatableString ImportPlugin::FailureHint() const
    return {};
 }
 
+bool ImportPlugin::SupportsStreams() const
+{
+   return false;
+}
+
+std::unique_ptr<ImportFileHandle> ImportPlugin::OpenStream(
+   std::shared_ptr<ImportByteStream>, AudacityProject*)
+{
+   return nullptr;
+}
+
 
 ImportFileHandle::~ImportFileHandle() = default;
 
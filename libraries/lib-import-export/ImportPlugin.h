@@ -59,6 +59,7 @@ class TrackList;
 class TranslatableString;
 class Tags;
 
+class ImportByteStream;
 class ImportFileHandle;
 
 class ImportProgressListener;
@@ -94,6 +95,17 @@ public:
    virtual std::unique_ptr<ImportFileHandle> Open(
       const FilePath &Filename, AudacityProject*) = 0;
 
+   //! Whether OpenStream() is implemented; default false
+   virtual bool SupportsStreams() const;
+
+   //! Like Open(), for a stream that can only be read forward, which the
+   //! handle decodes as its bytes arrive; default returns null
+   /*!
+    The stream may have been partly read even if this fails
+    */
+   virtual std::unique_ptr<ImportFileHandle> OpenStream(
+      std::shared_ptr<ImportByteStream> stream, AudacityProject*);
+
    virtual ~ImportPlugin();
 
 protected:
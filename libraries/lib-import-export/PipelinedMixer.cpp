@@ -0,0 +1,137 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PipelinedMixer.cpp
+
+**********************************************************************/
+#include "PipelinedMixer.h"
+
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "Mix.h"
+
+PipelinedMixer::PipelinedMixer(
+   std::unique_ptr<Mixer> pMixer, unsigned numChannels, bool interleaved,
+   sampleFormat format, size_t depth)
+    : mpMixer { std::move(pMixer) }
+    , mNumChannels { numChannels }
+    , mInterleaved { interleaved }
+    , mFormat { format }
+    , mSlots(depth)
+    , mStartTime { mpMixer->MixGetCurrentTime() }
+{
+   assert(depth >= 2);
+
+   const auto nBuffers = mpMixer->NumBuses() * (interleaved ? 1 : numChannels);
+   const auto size = mpMixer->BufferSize() * (interleaved ? numChannels : 1);
+   for (auto& slot : mSlots)
+   {
+      slot.buffers.resize(nBuffers);
+      for (auto& buffer : slot.buffers)
+         buffer.Allocate(size, format);
+   }
+}
+
+PipelinedMixer::~PipelinedMixer()
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mStopping = true;
+   }
+   mCondition.notify_all();
+   if (mThread.joinable())
+      mThread.join();
+}
+
+size_t PipelinedMixer::Process()
+{
+   if (!mThread.joinable() && !mFinished)
+      mThread = std::thread { [this] { Loop(); } };
+
+   std::unique_lock<std::mutex> lock { mMutex };
+   if (mHolding)
+   {
+      // Give back the slot of the previous buffers
+      mHolding = false;
+      mRead = (mRead + 1) % mSlots.size();
+      --mFilled;
+      mCondition.notify_all();
+   }
+
+   mCondition.wait(lock, [this] { return mFilled > 0 || mFinished; });
+   if (mFilled == 0)
+   {
+      if (mpException)
+         std::rethrow_exception(std::exchange(mpException, {}));
+      return 0;
+   }
+
+   mHolding = true;
+   return mSlots[mRead].length;
+}
+
+constSamplePtr PipelinedMixer::GetBuffer() const
+{
+   return GetBuffer(0);
+}
+
+constSamplePtr PipelinedMixer::GetBuffer(int channel) const
+{
+   assert(mHolding);
+   return mSlots[mRead].buffers[channel].ptr();
+}
+
+double PipelinedMixer::MixGetCurrentTime() const
+{
+   return mHolding ? mSlots[mRead].time : mStartTime;
+}
+
+void PipelinedMixer::Loop()
+{
+   auto write = mRead;
+   while (true)
+   {
+      {
+         std::unique_lock<std::mutex> lock { mMutex };
+         mCondition.wait(
+            lock, [this] { return mStopping || mFilled < mSlots.size(); });
+         if (mStopping)
+            return;
+      }
+
+      // The consumer does not touch slots past the filled ones
+      auto& slot = mSlots[write];
+      size_t length = 0;
+      try
+      {
+         length = mpMixer->Process();
+         const auto bytes = length * (mInterleaved ? mNumChannels : 1) *
+                            SAMPLE_SIZE(mFormat);
+         for (size_t ii = 0; ii < slot.buffers.size(); ++ii)
+            memcpy(slot.buffers[ii].ptr(), mpMixer->GetBuffer(static_cast<int>(ii)), bytes);
+         slot.length = length;
+         slot.time = mpMixer->MixGetCurrentTime();
+      }
+      catch (...)
+      {
+         std::lock_guard<std::mutex> lock { mMutex };
+         mpException = std::current_exception();
+         mFinished = true;
+         mCondition.notify_all();
+         return;
+      }
+
+      std::lock_guard<std::mutex> lock { mMutex };
+      ++mFilled;
+      write = (write + 1) % mSlots.size();
+      if (length == 0)
+         mFinished = true;
+      mCondition.notify_all();
+      if (mFinished)
+         return;
+   }
+}
@@ -0,0 +1,94 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PipelinedMixer.h
+
+**********************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SampleFormat.h"
+
+class Mixer;
+
+//! Runs a Mixer in a thread of its own, ahead of the export loop that
+//! consumes its buffers
+/*!
+ The loop calls Process() and GetBuffer() as it would on the Mixer, while the
+ next buffers are mixed, so that mixing overlaps encoding and writing.  At
+ most `depth` buffers are mixed ahead.
+
+ Methods must be called in one thread, other than the mixing one
+ */
+class IMPORT_EXPORT_API PipelinedMixer final
+{
+public:
+   /*!
+    @pre `pMixer` is not null
+    @pre `depth >= 2`
+    @param numChannels as given to the Mixer
+    @param interleaved as given to the Mixer
+    */
+   PipelinedMixer(
+      std::unique_ptr<Mixer> pMixer, unsigned numChannels, bool interleaved,
+      sampleFormat format, size_t depth = 4);
+   //! Stops mixing
+   ~PipelinedMixer();
+
+   PipelinedMixer(const PipelinedMixer&) = delete;
+   PipelinedMixer& operator=(const PipelinedMixer&) = delete;
+
+   //! Next buffers from the Mixer, invalidating the previous ones
+   /*!
+    Mixing starts at the first call
+    @return as Mixer::Process()
+    @throws whatever Mixer::Process() threw, after the buffers mixed before
+    */
+   size_t Process();
+
+   //! As Mixer::GetBuffer(), for the buffers given by the last Process()
+   constSamplePtr GetBuffer() const;
+   //! As Mixer::GetBuffer(int), for the buffers given by the last Process()
+   constSamplePtr GetBuffer(int channel) const;
+
+   //! As Mixer::MixGetCurrentTime() after the last Process()
+   double MixGetCurrentTime() const;
+
+private:
+   struct Slot final
+   {
+      std::vector<SampleBuffer> buffers;
+      size_t length { 0 };
+      double time { 0 };
+   };
+
+   void Loop();
+
+   const std::unique_ptr<Mixer> mpMixer;
+   const unsigned mNumChannels;
+   const bool mInterleaved;
+   const sampleFormat mFormat;
+
+   //! A queue of the slots from mRead, of which mFilled are mixed, and the
+   //! first is held by the consumer after Process()
+   std::vector<Slot> mSlots;
+   size_t mRead { 0 };
+   size_t mFilled { 0 };
+   bool mHolding { false };
+   double mStartTime;
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   bool mStopping { false };
+   bool mFinished { false };
+   std::exception_ptr mpException;
+   std::thread mThread;
+};
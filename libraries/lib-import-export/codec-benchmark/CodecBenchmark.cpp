@@ -0,0 +1,854 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CodecBenchmark.cpp
+
+  A command-line application to measure the speed of encoding and decoding
+  with the libraries that the import and export modules use, for the purpose
+  of catching regressions.
+
+**********************************************************************/
+
+#include "sndfile.h"
+
+#include <lame/lame.h>
+
+#ifdef USE_LIBFLAC
+#   include "FLAC/stream_decoder.h"
+#   include "FLAC/stream_encoder.h"
+#endif
+
+#ifdef USE_LIBMPG123
+#   include <mpg123.h>
+#endif
+
+#if defined(USE_LIBOGG) && defined(USE_LIBVORBIS)
+#   define BENCHMARK_VORBIS
+#   include <vorbis/vorbisenc.h>
+#   include <vorbis/vorbisfile.h>
+#endif
+
+#if defined(USE_LIBOPUS) && defined(USE_OPUSFILE) && defined(USE_LIBOGG)
+#   define BENCHMARK_OPUS
+#   include <ogg/ogg.h>
+#   include <opus/opus.h>
+#   include <opus/opusfile.h>
+#endif
+
+#ifdef USE_WAVPACK
+#   include <wavpack/wavpack.h>
+#endif
+
+#ifdef _WIN32
+#   include <windows.h>
+#   include <psapi.h>
+#else
+#   include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+//! Interleaved samples of a file of the corpus, to be encoded
+struct Audio
+{
+   std::string name;
+   int rate;
+   int channels;
+   std::vector<float> samples;
+
+   size_t Frames() const
+   {
+      return samples.size() / channels;
+   }
+};
+
+//! Frames given to, or asked of, the libraries at once, as the modules do
+constexpr size_t blockFrames = 65536;
+
+//! Encoders write 16 bit samples, when the format has a bit depth
+std::vector<int32_t> ToInt16(const float* samples, size_t count)
+{
+   std::vector<int32_t> result(count);
+   std::transform(samples, samples + count, result.begin(), [](float sample) {
+      return static_cast<int32_t>(
+         std::lround(std::clamp(sample, -1.0f, 1.0f) * 32767.0f));
+   });
+   return result;
+}
+
+//! The decoders convert integer samples to floats, as importing does
+void ToFloat(const int32_t* samples, size_t count, std::vector<float>& into)
+{
+   into.resize(count);
+   std::transform(samples, samples + count, into.begin(), [](int32_t sample) {
+      return sample / 32768.0f;
+   });
+}
+
+struct FileCloser
+{
+   void operator()(FILE* file) const
+   {
+      fclose(file);
+   }
+};
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+
+FilePtr OpenOrThrow(const std::string& path, const char* mode)
+{
+   FilePtr file { fopen(path.c_str(), mode) };
+   if (!file)
+      throw std::runtime_error("Cannot open " + path);
+   return file;
+}
+
+void WriteOrThrow(FILE* file, const void* data, size_t size)
+{
+   if (size != 0 && fwrite(data, 1, size, file) != size)
+      throw std::runtime_error("Cannot write");
+}
+
+// PCM, as mod-pcm, with libsndfile
+
+Audio ReadAudio(const std::string& path)
+{
+   SF_INFO info {};
+   const auto file = sf_open(path.c_str(), SFM_READ, &info);
+   if (!file)
+      throw std::runtime_error("Cannot read " + path);
+   Audio audio { path, info.samplerate, info.channels, {} };
+   audio.samples.resize(info.frames * info.channels);
+   audio.samples.resize(
+      sf_readf_float(file, audio.samples.data(), info.frames) * info.channels);
+   sf_close(file);
+   return audio;
+}
+
+void EncodePCM(const Audio& audio, const std::string& path)
+{
+   SF_INFO info {};
+   info.samplerate = audio.rate;
+   info.channels = audio.channels;
+   info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+   const auto file = sf_open(path.c_str(), SFM_WRITE, &info);
+   if (!file)
+      throw std::runtime_error("Cannot write " + path);
+   for (size_t start = 0; start < audio.Frames(); start += blockFrames)
+      sf_writef_float(
+         file, audio.samples.data() + start * audio.channels,
+         std::min(blockFrames, audio.Frames() - start));
+   sf_close(file);
+}
+
+size_t DecodePCM(const std::string& path)
+{
+   SF_INFO info {};
+   const auto file = sf_open(path.c_str(), SFM_READ, &info);
+   if (!file)
+      throw std::runtime_error("Cannot read " + path);
+   std::vector<float> buffer(blockFrames * info.channels);
+   size_t frames = 0;
+   while (const auto count = sf_readf_float(file, buffer.data(), blockFrames))
+      frames += count;
+   sf_close(file);
+   return frames;
+}
+
+// MP3, as mod-mp3, with LAME
+
+bool LameSupports(const Audio& audio)
+{
+   return audio.channels <= 2;
+}
+
+void EncodeMP3(const Audio& audio, const std::string& path)
+{
+   const auto lame = lame_init();
+   lame_set_in_samplerate(lame, audio.rate);
+   lame_set_out_samplerate(lame, audio.rate);
+   lame_set_num_channels(lame, audio.channels);
+   lame_set_VBR(lame, vbr_off);
+   lame_set_brate(lame, 192);
+   if (lame_init_params(lame) < 0)
+   {
+      lame_close(lame);
+      throw std::runtime_error("Cannot initialize LAME");
+   }
+
+   const auto file = OpenOrThrow(path, "wb");
+   // See lame.h/lame_encode_buffer() for this size
+   std::vector<unsigned char> buffer(blockFrames * 5 / 4 + 7200);
+   for (size_t start = 0; start < audio.Frames(); start += blockFrames)
+   {
+      const auto frames = std::min(blockFrames, audio.Frames() - start);
+      const auto samples = audio.samples.data() + start * audio.channels;
+      const auto size =
+         audio.channels == 1 ?
+            lame_encode_buffer_ieee_float(
+               lame, samples, samples, frames, buffer.data(), buffer.size()) :
+            lame_encode_buffer_interleaved_ieee_float(
+               lame, samples, frames, buffer.data(), buffer.size());
+      if (size < 0)
+      {
+         lame_close(lame);
+         throw std::runtime_error("Cannot encode with LAME");
+      }
+      WriteOrThrow(file.get(), buffer.data(), size);
+   }
+   const auto size = lame_encode_flush(lame, buffer.data(), buffer.size());
+   lame_close(lame);
+   if (size < 0)
+      throw std::runtime_error("Cannot encode with LAME");
+   WriteOrThrow(file.get(), buffer.data(), size);
+}
+
+// MP3, as mod-mpg123
+
+#ifdef USE_LIBMPG123
+size_t DecodeMPG123(const std::string& path)
+{
+#   if MPG123_API_VERSION < 46
+   mpg123_init();
+#   endif
+   const auto handle = mpg123_new(nullptr, nullptr);
+   if (!handle)
+      throw std::runtime_error("Cannot initialize mpg123");
+   mpg123_param(handle, MPG123_ADD_FLAGS, MPG123_FORCE_FLOAT, 0.0);
+   if (mpg123_open(handle, path.c_str()) != MPG123_OK)
+   {
+      mpg123_delete(handle);
+      throw std::runtime_error("Cannot read " + path);
+   }
+
+   std::vector<float> buffer(blockFrames * 2);
+   size_t bytes = 0;
+   int result;
+   do
+   {
+      size_t done = 0;
+      result = mpg123_read(
+         handle, reinterpret_cast<unsigned char*>(buffer.data()),
+         buffer.size() * sizeof(float), &done);
+      bytes += done;
+   } while (result == MPG123_OK || result == MPG123_NEW_FORMAT);
+
+   long rate = 0;
+   int channels = 1;
+   int encoding = 0;
+   mpg123_getformat(handle, &rate, &channels, &encoding);
+   mpg123_close(handle);
+   mpg123_delete(handle);
+   if (result != MPG123_DONE)
+      throw std::runtime_error("Cannot decode " + path);
+   return bytes / sizeof(float) / channels;
+}
+#endif
+
+// FLAC, as mod-flac
+
+#ifdef USE_LIBFLAC
+void EncodeFLAC(const Audio& audio, const std::string& path)
+{
+   const auto encoder = FLAC__stream_encoder_new();
+   if (!encoder)
+      throw std::runtime_error("Cannot initialize FLAC");
+   FLAC__stream_encoder_set_channels(encoder, audio.channels);
+   FLAC__stream_encoder_set_bits_per_sample(encoder, 16);
+   FLAC__stream_encoder_set_sample_rate(encoder, audio.rate);
+   FLAC__stream_encoder_set_compression_level(encoder, 5);
+   FLAC__stream_encoder_set_total_samples_estimate(encoder, audio.Frames());
+   if (
+      FLAC__stream_encoder_init_file(encoder, path.c_str(), nullptr, nullptr) !=
+      FLAC__STREAM_ENCODER_INIT_STATUS_OK)
+   {
+      FLAC__stream_encoder_delete(encoder);
+      throw std::runtime_error("Cannot write " + path);
+   }
+
+   auto ok = true;
+   for (size_t start = 0; ok && start < audio.Frames(); start += blockFrames)
+   {
+      const auto frames = std::min(blockFrames, audio.Frames() - start);
+      const auto samples = ToInt16(
+         audio.samples.data() + start * audio.channels,
+         frames * audio.channels);
+      ok = FLAC__stream_encoder_process_interleaved(
+         encoder, samples.data(), frames);
+   }
+   ok = FLAC__stream_encoder_finish(encoder) && ok;
+   FLAC__stream_encoder_delete(encoder);
+   if (!ok)
+      throw std::runtime_error("Cannot encode with FLAC");
+}
+
+size_t DecodeFLAC(const std::string& path)
+{
+   struct State
+   {
+      size_t frames = 0;
+      std::vector<float> samples;
+      bool failed = false;
+   } state;
+
+   const auto write = [](
+                         const FLAC__StreamDecoder*, const FLAC__Frame* frame,
+                         const FLAC__int32* const buffer[], void* data) {
+      auto& state = *static_cast<State*>(data);
+      const auto blockSize = frame->header.blocksize;
+      // One channel after the other, as ImportFLAC copies them into tracks
+      for (unsigned c = 0; c < frame->header.channels; ++c)
+         ToFloat(buffer[c], blockSize, state.samples);
+      state.frames += blockSize;
+      return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+   };
+   const auto error = [](
+                         const FLAC__StreamDecoder*,
+                         FLAC__StreamDecoderErrorStatus, void* data) {
+      static_cast<State*>(data)->failed = true;
+   };
+
+   const auto decoder = FLAC__stream_decoder_new();
+   if (!decoder)
+      throw std::runtime_error("Cannot initialize FLAC");
+   if (
+      FLAC__stream_decoder_init_file(
+         decoder, path.c_str(), write, nullptr, error, &state) !=
+      FLAC__STREAM_DECODER_INIT_STATUS_OK)
+   {
+      FLAC__stream_decoder_delete(decoder);
+      throw std::runtime_error("Cannot read " + path);
+   }
+   const auto ok = FLAC__stream_decoder_process_until_end_of_stream(decoder);
+   FLAC__stream_decoder_finish(decoder);
+   FLAC__stream_decoder_delete(decoder);
+   if (!ok || state.failed)
+      throw std::runtime_error("Cannot decode " + path);
+   return state.frames;
+}
+#endif
+
+// Ogg Vorbis, as mod-ogg
+
+#ifdef BENCHMARK_VORBIS
+void EncodeVorbis(const Audio& audio, const std::string& path)
+{
+   vorbis_info info;
+   vorbis_info_init(&info);
+   if (vorbis_encode_init_vbr(&info, audio.channels, audio.rate, 0.5f))
+   {
+      vorbis_info_clear(&info);
+      throw std::runtime_error("Cannot initialize Vorbis");
+   }
+   vorbis_comment comment;
+   vorbis_comment_init(&comment);
+   vorbis_dsp_state dsp;
+   vorbis_analysis_init(&dsp, &info);
+   vorbis_block block;
+   vorbis_block_init(&dsp, &block);
+   ogg_stream_state stream;
+   ogg_stream_init(&stream, 1);
+
+   const auto file = OpenOrThrow(path, "wb");
+   ogg_page page;
+   const auto writePage = [&] {
+      WriteOrThrow(file.get(), page.header, page.header_len);
+      WriteOrThrow(file.get(), page.body, page.body_len);
+   };
+
+   ogg_packet header, commentHeader, codeHeader;
+   vorbis_analysis_headerout(
+      &dsp, &comment, &header, &commentHeader, &codeHeader);
+   ogg_stream_packetin(&stream, &header);
+   ogg_stream_packetin(&stream, &commentHeader);
+   ogg_stream_packetin(&stream, &codeHeader);
+   while (ogg_stream_flush(&stream, &page))
+      writePage();
+
+   const auto drain = [&] {
+      ogg_packet packet;
+      while (vorbis_analysis_blockout(&dsp, &block) == 1)
+      {
+         vorbis_analysis(&block, nullptr);
+         vorbis_bitrate_addblock(&block);
+         while (vorbis_bitrate_flushpacket(&dsp, &packet))
+         {
+            ogg_stream_packetin(&stream, &packet);
+            while (ogg_stream_pageout(&stream, &page))
+               writePage();
+         }
+      }
+   };
+
+   for (size_t start = 0; start < audio.Frames(); start += blockFrames)
+   {
+      const auto frames = std::min(blockFrames, audio.Frames() - start);
+      const auto samples = audio.samples.data() + start * audio.channels;
+      const auto buffers = vorbis_analysis_buffer(&dsp, frames);
+      for (size_t i = 0; i < frames; ++i)
+         for (int c = 0; c < audio.channels; ++c)
+            buffers[c][i] = samples[i * audio.channels + c];
+      vorbis_analysis_wrote(&dsp, frames);
+      drain();
+   }
+   vorbis_analysis_wrote(&dsp, 0);
+   drain();
+   while (ogg_stream_flush(&stream, &page))
+      writePage();
+
+   ogg_stream_clear(&stream);
+   vorbis_block_clear(&block);
+   vorbis_dsp_clear(&dsp);
+   vorbis_comment_clear(&comment);
+   vorbis_info_clear(&info);
+}
+
+size_t DecodeVorbis(const std::string& path)
+{
+   OggVorbis_File file;
+   if (ov_fopen(path.c_str(), &file) != 0)
+      throw std::runtime_error("Cannot read " + path);
+   size_t frames = 0;
+   int bitstream = 0;
+   float** pcm = nullptr;
+   long count;
+   while ((count = ov_read_float(
+              &file, &pcm, static_cast<int>(blockFrames), &bitstream)) > 0)
+      frames += count;
+   ov_clear(&file);
+   if (count < 0)
+      throw std::runtime_error("Cannot decode " + path);
+   return frames;
+}
+#endif
+
+// Ogg Opus, as mod-opus
+
+#ifdef BENCHMARK_OPUS
+bool OpusSupports(const Audio& audio)
+{
+   // The benchmark does not multiplex streams, nor resample as exporting
+   // does, so the samples of other rates are encoded as if they were at 48 kHz
+   return audio.channels <= 2;
+}
+
+void EncodeOpus(const Audio& audio, const std::string& path)
+{
+   constexpr opus_int32 rate = 48000;
+   constexpr int frameSize = rate / 50;
+
+   int error = OPUS_OK;
+   const auto encoder =
+      opus_encoder_create(rate, audio.channels, OPUS_APPLICATION_AUDIO, &error);
+   if (error != OPUS_OK)
+      throw std::runtime_error("Cannot initialize Opus");
+   opus_encoder_ctl(encoder, OPUS_SET_BITRATE(128000));
+   opus_int32 preSkip = 0;
+   opus_encoder_ctl(encoder, OPUS_GET_LOOKAHEAD(&preSkip));
+
+   ogg_stream_state stream;
+   ogg_stream_init(&stream, 1);
+   const auto file = OpenOrThrow(path, "wb");
+   ogg_page page;
+   const auto writePage = [&] {
+      WriteOrThrow(file.get(), page.header, page.header_len);
+      WriteOrThrow(file.get(), page.body, page.body_len);
+   };
+
+   ogg_int64_t packetNo = 0;
+   const auto packetIn = [&](
+                            unsigned char* data, long size, ogg_int64_t granule,
+                            bool last) {
+      ogg_packet packet {};
+      packet.packet = data;
+      packet.bytes = size;
+      packet.b_o_s = packetNo == 0;
+      packet.e_o_s = last;
+      packet.granulepos = granule;
+      packet.packetno = packetNo++;
+      ogg_stream_packetin(&stream, &packet);
+   };
+
+   // See RFC 7845 for both header packets
+   unsigned char head[19] = { 'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1,
+                              static_cast<unsigned char>(audio.channels),
+                              static_cast<unsigned char>(preSkip & 0xFF),
+                              static_cast<unsigned char>(preSkip >> 8),
+                              rate & 0xFF, (rate >> 8) & 0xFF,
+                              (rate >> 16) & 0xFF, rate >> 24 };
+   packetIn(head, sizeof(head), 0, false);
+   while (ogg_stream_flush(&stream, &page))
+      writePage();
+   unsigned char tags[16] = { 'O', 'p', 'u', 's', 'T', 'a', 'g', 's' };
+   packetIn(tags, sizeof(tags), 0, false);
+   while (ogg_stream_flush(&stream, &page))
+      writePage();
+
+   std::vector<float> frame(frameSize * audio.channels);
+   std::vector<unsigned char> packet(4000);
+   for (size_t start = 0; start < audio.Frames(); start += frameSize)
+   {
+      const auto frames = std::min<size_t>(frameSize, audio.Frames() - start);
+      const auto samples = audio.samples.data() + start * audio.channels;
+      // The last frame is padded with silence
+      std::fill(frame.begin(), frame.end(), 0.0f);
+      std::copy(samples, samples + frames * audio.channels, frame.begin());
+      const auto size = opus_encode_float(
+         encoder, frame.data(), frameSize, packet.data(), packet.size());
+      if (size < 0)
+      {
+         ogg_stream_clear(&stream);
+         opus_encoder_destroy(encoder);
+         throw std::runtime_error("Cannot encode with Opus");
+      }
+      const bool last = start + frameSize >= audio.Frames();
+      packetIn(packet.data(), size, preSkip + start + frames, last);
+      while (ogg_stream_pageout(&stream, &page))
+         writePage();
+   }
+   while (ogg_stream_flush(&stream, &page))
+      writePage();
+
+   ogg_stream_clear(&stream);
+   opus_encoder_destroy(encoder);
+}
+
+size_t DecodeOpus(const std::string& path)
+{
+   int error = 0;
+   const auto file = op_open_file(path.c_str(), &error);
+   if (!file)
+      throw std::runtime_error("Cannot read " + path);
+   std::vector<float> buffer(blockFrames * op_channel_count(file, -1));
+   size_t frames = 0;
+   int count;
+   while ((count = op_read_float(
+              file, buffer.data(), static_cast<int>(buffer.size()), nullptr)) >
+          0)
+      frames += count;
+   op_free(file);
+   if (count < 0)
+      throw std::runtime_error("Cannot decode " + path);
+   return frames;
+}
+#endif
+
+// WavPack, as mod-wavpack
+
+#ifdef USE_WAVPACK
+void EncodeWavPack(const Audio& audio, const std::string& path)
+{
+   const auto file = OpenOrThrow(path, "wb");
+   const auto writeBlock = [](void* id, void* data, int32_t size) -> int {
+      return fwrite(data, 1, size, static_cast<FILE*>(id)) ==
+             static_cast<size_t>(size);
+   };
+   const auto context = WavpackOpenFileOutput(writeBlock, file.get(), nullptr);
+   if (!context)
+      throw std::runtime_error("Cannot initialize WavPack");
+
+   WavpackConfig config {};
+   config.num_channels = audio.channels;
+   config.sample_rate = audio.rate;
+   config.bits_per_sample = 16;
+   config.bytes_per_sample = 2;
+   config.channel_mask = audio.channels <= 2 ? 0x5 - audio.channels :
+                                               (1U << audio.channels) - 1;
+   auto ok =
+      WavpackSetConfiguration64(context, &config, audio.Frames(), nullptr) &&
+      WavpackPackInit(context);
+   for (size_t start = 0; ok && start < audio.Frames(); start += blockFrames)
+   {
+      const auto frames = std::min(blockFrames, audio.Frames() - start);
+      auto samples = ToInt16(
+         audio.samples.data() + start * audio.channels,
+         frames * audio.channels);
+      ok = WavpackPackSamples(context, samples.data(), frames);
+   }
+   ok = ok && WavpackFlushSamples(context);
+   WavpackCloseFile(context);
+   if (!ok)
+      throw std::runtime_error("Cannot encode with WavPack");
+}
+
+size_t DecodeWavPack(const std::string& path)
+{
+   char error[80] {};
+   const auto context =
+      WavpackOpenFileInput(path.c_str(), error, OPEN_WVC | OPEN_FILE_UTF8, 0);
+   if (!context)
+      throw std::runtime_error("Cannot read " + path + ": " + error);
+   const auto channels = WavpackGetNumChannels(context);
+   std::vector<int32_t> buffer(blockFrames * channels);
+   std::vector<float> samples;
+   size_t frames = 0;
+   while (const auto count =
+             WavpackUnpackSamples(context, buffer.data(), blockFrames))
+   {
+      ToFloat(buffer.data(), count * channels, samples);
+      frames += count;
+   }
+   WavpackCloseFile(context);
+   return frames;
+}
+#endif
+
+struct Codec
+{
+   const char* name;
+   const char* extension;
+   std::function<void(const Audio&, const std::string&)> encode;
+   std::function<size_t(const std::string&)> decode;
+   std::function<bool(const Audio&)> supports;
+};
+
+std::vector<Codec> GetCodecs()
+{
+   const auto any = [](const Audio&) { return true; };
+   std::vector<Codec> codecs { { "pcm", "wav", EncodePCM, DecodePCM, any } };
+#ifdef USE_LIBMPG123
+   // mod-mp3 encodes, mod-mpg123 decodes
+   codecs.push_back({ "mp3", "mp3", EncodeMP3, DecodeMPG123, LameSupports });
+#else
+   codecs.push_back({ "mp3", "mp3", EncodeMP3, nullptr, LameSupports });
+#endif
+#ifdef USE_LIBFLAC
+   codecs.push_back({ "flac", "flac", EncodeFLAC, DecodeFLAC, any });
+#endif
+#ifdef BENCHMARK_VORBIS
+   codecs.push_back({ "ogg", "ogg", EncodeVorbis, DecodeVorbis, any });
+#endif
+#ifdef BENCHMARK_OPUS
+   codecs.push_back({ "opus", "opus", EncodeOpus, DecodeOpus, OpusSupports });
+#endif
+#ifdef USE_WAVPACK
+   codecs.push_back({ "wavpack", "wv", EncodeWavPack, DecodeWavPack, any });
+#endif
+   return codecs;
+}
+
+//! Peak resident set size of the process so far, in kibibytes
+long PeakRSS()
+{
+#ifdef _WIN32
+   PROCESS_MEMORY_COUNTERS counters {};
+   if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+      return 0;
+   return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#else
+   rusage usage {};
+   getrusage(RUSAGE_SELF, &usage);
+#   ifdef __APPLE__
+   // In bytes, not kibibytes as on Linux
+   return usage.ru_maxrss / 1024;
+#   else
+   return usage.ru_maxrss;
+#   endif
+#endif
+}
+
+long FileSize(const std::string& path)
+{
+   const auto file = OpenOrThrow(path, "rb");
+   fseek(file.get(), 0, SEEK_END);
+   return ftell(file.get());
+}
+
+//! The shortest of `repeat` runs, in seconds, which is the least disturbed
+//! by the rest of the system
+double Time(int repeat, const std::function<void()>& run)
+{
+   auto best = std::numeric_limits<double>::max();
+   for (int i = 0; i < repeat; ++i)
+   {
+      const auto start = std::chrono::steady_clock::now();
+      run();
+      const std::chrono::duration<double> elapsed =
+         std::chrono::steady_clock::now() - start;
+      best = std::min(best, elapsed.count());
+   }
+   return best;
+}
+
+void PrintRow(
+   const char* codec, const char* operation, const Audio& audio, size_t frames,
+   long bytes, double seconds)
+{
+   std::cout << codec << ',' << operation << ',' << audio.name << ','
+             << audio.channels << ',' << audio.rate << ',' << frames << ','
+             << bytes << ',' << seconds << ','
+             << frames * audio.channels / seconds << ','
+             << bytes / seconds / 1e6 << ',' << PeakRSS() << std::endl;
+}
+
+//! One minute of a stereo chirp with some noise, for when no corpus is given
+Audio MakeSignal()
+{
+   constexpr auto rate = 44100;
+   constexpr auto channels = 2;
+   constexpr auto pi = 3.14159265358979323846;
+   Audio audio { "synthetic", rate, channels, {} };
+   audio.samples.resize(60 * rate * channels);
+   uint32_t noise = 1;
+   for (size_t i = 0; i < audio.Frames(); ++i)
+   {
+      const auto t = static_cast<double>(i) / rate;
+      const auto chirp = 0.5 * std::sin(2 * pi * (100 + 50 * t) * t);
+      for (int c = 0; c < channels; ++c)
+      {
+         noise = noise * 1664525u + 1013904223u;
+         audio.samples[i * channels + c] = static_cast<float>(
+            chirp + 0.05 * (static_cast<double>(noise) / UINT32_MAX - 0.5));
+      }
+   }
+   return audio;
+}
+
+void PrintHelp(const char* const* argv)
+{
+   std::cout
+      << std::endl
+      << "Measures the speed of the codecs that Audacity imports and exports with."
+      << std::endl
+      << std::endl
+      << "Usage: " << argv[0]
+      << " [--codec <name>] [--repeat <count>] [--work-dir <dir>] [<file> ...]"
+      << std::endl
+      << std::endl
+      << "Each file, of any format that libsndfile reads, is encoded with each"
+      << std::endl
+      << "codec then decoded again. With no file, a synthetic signal is used."
+      << std::endl
+      << "Use a standard corpus, such as the EBU SQAM recordings, to compare"
+      << std::endl
+      << "results between builds." << std::endl
+      << std::endl
+      << "Writes comma-separated values to standard output, one row for each"
+      << std::endl
+      << "encoding or decoding; samples_per_second counts the samples of all"
+      << std::endl
+      << "channels, and megabytes_per_second the bytes of the encoded file."
+      << std::endl
+      << "peak_rss_kib is that of the whole process so far: run one --codec at"
+      << std::endl
+      << "a time to compare it between codecs." << std::endl
+      << std::endl
+      << "Codecs:";
+   for (const auto& codec : GetCodecs())
+      std::cout << ' ' << codec.name;
+   std::cout << std::endl << std::endl;
+}
+} // namespace
+
+int main(int argc, char* const* argv)
+{
+   std::string onlyCodec;
+   std::string workDir = ".";
+   int repeat = 3;
+   std::vector<std::string> files;
+   for (int i = 1; i < argc; ++i)
+   {
+      const std::string arg = argv[i];
+      if (arg == "--help" || arg == "-h")
+      {
+         PrintHelp(argv);
+         return 0;
+      }
+      else if (arg == "--codec" && i + 1 < argc)
+         onlyCodec = argv[++i];
+      else if (arg == "--repeat" && i + 1 < argc)
+         repeat = std::max(1, std::atoi(argv[++i]));
+      else if (arg == "--work-dir" && i + 1 < argc)
+         workDir = argv[++i];
+      else if (arg.rfind("--", 0) == 0)
+      {
+         PrintHelp(argv);
+         return 1;
+      }
+      else
+         files.push_back(arg);
+   }
+
+   auto codecs = GetCodecs();
+   if (!onlyCodec.empty())
+   {
+      codecs.erase(
+         std::remove_if(
+            codecs.begin(), codecs.end(),
+            [&](const Codec& codec) { return codec.name != onlyCodec; }),
+         codecs.end());
+      if (codecs.empty())
+      {
+         std::cerr << "Unknown codec " << onlyCodec << std::endl;
+         return 1;
+      }
+   }
+
+   auto failed = false;
+   std::cout << "codec,operation,input,channels,rate,frames,bytes,seconds,"
+                "samples_per_second,megabytes_per_second,peak_rss_kib"
+             << std::endl;
+   const auto benchmark = [&](const Audio& audio) {
+      for (const auto& codec : codecs)
+      {
+         if (!codec.supports(audio))
+            continue;
+         const auto path = workDir + "/codec-benchmark." + codec.extension;
+         try
+         {
+            const auto encodeSeconds =
+               Time(repeat, [&] { codec.encode(audio, path); });
+            const auto bytes = FileSize(path);
+            PrintRow(
+               codec.name, "encode", audio, audio.Frames(), bytes,
+               encodeSeconds);
+            if (codec.decode)
+            {
+               size_t frames = 0;
+               const auto decodeSeconds =
+                  Time(repeat, [&] { frames = codec.decode(path); });
+               PrintRow(
+                  codec.name, "decode", audio, frames, bytes, decodeSeconds);
+            }
+         }
+         catch (const std::exception& e)
+         {
+            std::cerr << codec.name << ", " << audio.name << ": " << e.what()
+                      << std::endl;
+            failed = true;
+         }
+         std::remove(path.c_str());
+      }
+   };
+
+   if (files.empty())
+      benchmark(MakeSignal());
+   for (const auto& file : files)
+   {
+      try
+      {
+         benchmark(ReadAudio(file));
+      }
+      catch (const std::exception& e)
+      {
+         std::cerr << e.what() << std::endl;
+         failed = true;
+      }
+   }
+   return failed ? 1 : 0;
+}
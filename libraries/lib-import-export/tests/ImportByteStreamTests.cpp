@@ -0,0 +1,74 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportByteStreamTests.cpp
+
+**********************************************************************/
+#include "ImportByteStream.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("QueuedImportByteStream", "")
+{
+   SECTION("Reads what was appended, then ends when finished")
+   {
+      QueuedImportByteStream stream { "stream" };
+      stream.Append("abc", 3);
+      stream.Append("de", 2);
+      stream.Finish();
+
+      char buffer[4] {};
+      REQUIRE(stream.Read(buffer, 4) == 4);
+      REQUIRE(std::string(buffer, 4) == "abcd");
+      REQUIRE(stream.Read(buffer, 4) == 1);
+      REQUIRE(buffer[0] == 'e');
+      REQUIRE(stream.Read(buffer, 4) == 0);
+      REQUIRE(stream.GetName() == "stream");
+   }
+
+   SECTION("Reads bytes appended by another thread, in order")
+   {
+      QueuedImportByteStream stream { "stream" };
+      std::vector<unsigned char> bytes(100000);
+      std::iota(bytes.begin(), bytes.end(), 0);
+
+      std::thread producer { [&] {
+         for (size_t start = 0; start < bytes.size(); start += 777)
+            stream.Append(
+               bytes.data() + start, std::min<size_t>(777, bytes.size() - start));
+         stream.Finish();
+      } };
+
+      std::vector<unsigned char> read;
+      unsigned char buffer[1000];
+      while (const auto count = stream.Read(buffer, sizeof(buffer)))
+         read.insert(read.end(), buffer, buffer + count);
+      producer.join();
+
+      REQUIRE(read == bytes);
+   }
+}
+
+TEST_CASE("FileImportByteStream", "")
+{
+   const auto file = tmpfile();
+   REQUIRE(file != nullptr);
+   fputs("bytes", file);
+   rewind(file);
+
+   FileImportByteStream stream { file, "file" };
+   char buffer[8] {};
+   REQUIRE(stream.Read(buffer, sizeof(buffer)) == 5);
+   REQUIRE(std::string(buffer) == "bytes");
+   REQUIRE(stream.Read(buffer, sizeof(buffer)) == 0);
+
+   fclose(file);
+}
@@ -14,6 +14,19 @@
 
 #include <cstddef>
 
+/**
+ * \brief How an IPCChannel moves data. The server chooses, and tells the
+ * client when it connects.
+ */
+enum class IPCTransport
+{
+   ///Data is sent through a loopback socket
+   Socket,
+   ///Data is written into rings in memory shared by both processes;
+   ///the socket only wakes the other side up
+   SharedMemory,
+};
+
 /**
  * \brief Interface for sending data from client to server or vice versa,
  * complemented by IPCChannelStatusCallback
@@ -20,10 +20,12 @@
 #include "internal/ipc-types.h"
 #include "internal/socket_guard.h"
 #include "internal/BufferedIPCChannel.h"
+#include "internal/SharedMemoryIPCChannel.h"
+#include "internal/ipc-handshake.h"
 
 class IPCClient::Impl final
 {
-   std::unique_ptr<BufferedIPCChannel> mChannel;
+   std::unique_ptr<IPCChannel> mChannel;
 public:
 
    Impl(int port, IPCChannelStatusCallback& callback)
@@ -49,8 +51,31 @@ public:
          return;
       }
 
-      mChannel = std::make_unique<BufferedIPCChannel>();
-      mChannel->StartConversation(fd.release(), callback);
+      //Server tells which transport to use
+      const auto handshake = ReceiveHandshake(*fd);
+      if(!handshake)
+      {
+         callback.OnConnectionError();
+         return;
+      }
+      if(handshake->transport == IPCTransport::SharedMemory)
+      {
+         auto channel = SharedMemoryIPCChannel::Open(
+            handshake->path, static_cast<size_t>(handshake->capacity));
+         if(!channel)
+         {
+            callback.OnConnectionError();
+            return;
+         }
+         channel->StartConversation(fd.release(), callback);
+         mChannel = std::move(channel);
+      }
+      else
+      {
+         auto channel = std::make_unique<BufferedIPCChannel>();
+         channel->StartConversation(fd.release(), callback);
+         mChannel = std::move(channel);
+      }
    }
 };
 
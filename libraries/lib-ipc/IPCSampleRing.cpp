@@ -0,0 +1,100 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file IPCSampleRing.cpp
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#include "IPCSampleRing.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+size_t IPCSampleRing::GetRequiredSize(unsigned channels, size_t capacity)
+   noexcept
+{
+   return sizeof(Header) + sizeof(float) * channels * capacity;
+}
+
+IPCSampleRing::IPCSampleRing(void* memory, unsigned channels, size_t capacity,
+   bool initialize) noexcept
+   : mHeader(static_cast<Header*>(memory))
+   , mSamples(reinterpret_cast<float*>(static_cast<Header*>(memory) + 1))
+   , mChannels(channels)
+   , mCapacity(capacity)
+{
+   assert(capacity > 0);
+   if(initialize)
+   {
+      mHeader = new (memory) Header;
+      mHeader->written.store(0, std::memory_order_relaxed);
+      mHeader->read.store(0, std::memory_order_relaxed);
+      mHeader->channels = channels;
+      mHeader->capacity = static_cast<uint32_t>(capacity);
+      std::atomic_thread_fence(std::memory_order_release);
+   }
+   else
+   {
+      // Both sides must agree on the layout
+      assert(mHeader->channels == channels);
+      assert(mHeader->capacity == capacity);
+   }
+}
+
+size_t IPCSampleRing::GetWritable() const noexcept
+{
+   const auto written = mHeader->written.load(std::memory_order_relaxed);
+   const auto read = mHeader->read.load(std::memory_order_acquire);
+   return mCapacity - static_cast<size_t>(written - read);
+}
+
+size_t IPCSampleRing::GetContiguousWritable() const noexcept
+{
+   const auto written = mHeader->written.load(std::memory_order_relaxed);
+   return std::min(GetWritable(),
+      mCapacity - static_cast<size_t>(written % mCapacity));
+}
+
+float* IPCSampleRing::GetWritePointer(unsigned channel) const noexcept
+{
+   assert(channel < mChannels);
+   const auto written = mHeader->written.load(std::memory_order_relaxed);
+   return mSamples + channel * mCapacity + written % mCapacity;
+}
+
+void IPCSampleRing::CommitWrite(size_t count) noexcept
+{
+   assert(count <= GetWritable());
+   mHeader->written.fetch_add(count, std::memory_order_release);
+}
+
+size_t IPCSampleRing::GetReadable() const noexcept
+{
+   const auto written = mHeader->written.load(std::memory_order_acquire);
+   const auto read = mHeader->read.load(std::memory_order_relaxed);
+   return static_cast<size_t>(written - read);
+}
+
+size_t IPCSampleRing::GetContiguousReadable() const noexcept
+{
+   const auto read = mHeader->read.load(std::memory_order_relaxed);
+   return std::min(GetReadable(),
+      mCapacity - static_cast<size_t>(read % mCapacity));
+}
+
+const float* IPCSampleRing::GetReadPointer(unsigned channel) const noexcept
+{
+   assert(channel < mChannels);
+   const auto read = mHeader->read.load(std::memory_order_relaxed);
+   return mSamples + channel * mCapacity + read % mCapacity;
+}
+
+void IPCSampleRing::CommitRead(size_t count) noexcept
+{
+   assert(count <= GetReadable());
+   mHeader->read.fetch_add(count, std::memory_order_release);
+}
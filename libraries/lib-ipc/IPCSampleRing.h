@@ -0,0 +1,80 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file IPCSampleRing.h
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief Lock-free ring of multi-channel float samples, laid out in memory
+ * given by the user (such as IPCSharedMemory), for one writer and one reader
+ * that may be in different processes.
+ *
+ * Both sides work in place: the writer fills the memory returned by
+ * GetWritePointer() and the reader uses the memory returned by
+ * GetReadPointer(), so that samples are never copied by the ring itself.
+ * A span returned for one channel is contiguous; where it ends before the
+ * number of samples available, the rest continues at the start of the ring.
+ */
+class IPC_API IPCSampleRing final
+{
+   struct Header
+   {
+      std::atomic<uint64_t> written;
+      std::atomic<uint64_t> read;
+      uint32_t channels;
+      uint32_t capacity;
+   };
+   static_assert(std::atomic<uint64_t>::is_always_lock_free,
+      "the ring must work across processes");
+
+   Header* mHeader;
+   float* mSamples;
+   const unsigned mChannels;
+   const size_t mCapacity;
+
+public:
+   ///Returns the size of the memory to pass to the constructor
+   static size_t GetRequiredSize(unsigned channels, size_t capacity) noexcept;
+
+   /**
+    * \param memory at least GetRequiredSize(channels, capacity) bytes, suitably
+    * aligned for uint64_t, and living as long as this object
+    * \param initialize true for exactly one of the objects using the memory,
+    * before the others are constructed
+    */
+   IPCSampleRing(void* memory, unsigned channels, size_t capacity,
+      bool initialize) noexcept;
+
+   unsigned GetChannels() const noexcept { return mChannels; }
+   size_t GetCapacity() const noexcept { return mCapacity; }
+
+   ///Writer side: number of samples per channel that can be written
+   size_t GetWritable() const noexcept;
+   ///Writer side: number of samples that can be written contiguously
+   size_t GetContiguousWritable() const noexcept;
+   ///Writer side: where to write the next sample of a channel
+   float* GetWritePointer(unsigned channel) const noexcept;
+   ///Writer side: make samples visible to the reader
+   ///\pre count <= GetWritable()
+   void CommitWrite(size_t count) noexcept;
+
+   ///Reader side: number of samples per channel that can be read
+   size_t GetReadable() const noexcept;
+   ///Reader side: number of samples that can be read contiguously
+   size_t GetContiguousReadable() const noexcept;
+   ///Reader side: where to read the next sample of a channel
+   const float* GetReadPointer(unsigned channel) const noexcept;
+   ///Reader side: give space back to the writer
+   ///\pre count <= GetReadable()
+   void CommitRead(size_t count) noexcept;
+};
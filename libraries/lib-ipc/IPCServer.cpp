@@ -20,19 +20,23 @@
 #include "internal/ipc-types.h"
 #include "internal/socket_guard.h"
 #include "internal/BufferedIPCChannel.h"
+#include "internal/SharedMemoryIPCChannel.h"
+#include "internal/ipc-handshake.h"
 
 class IPCServer::Impl
 {
    bool mTryConnect{true};
    std::mutex mSync;
-   std::unique_ptr<BufferedIPCChannel> mChannel;
+   const IPCTransport mTransport;
+   std::unique_ptr<IPCChannel> mChannel;
    std::unique_ptr<std::thread> mConnectionRoutine;
    int mConnectPort{0};
 
    socket_guard mListenSocket;
 public:
 
-   Impl(IPCChannelStatusCallback& callback)
+   Impl(IPCChannelStatusCallback& callback, IPCTransport transport)
+      : mTransport(transport)
    {
       mListenSocket = socket_guard { socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) };
       if(!mListenSocket)
@@ -60,7 +64,6 @@ public:
 
       mConnectPort = ntohs(addr.sin_port);
 
-      mChannel = std::make_unique<BufferedIPCChannel>();
       mConnectionRoutine = std::make_unique<std::thread>([this, &callback]
       {
          socket_guard connfd;
@@ -79,7 +82,7 @@ public:
                   mListenSocket.reset();//do not need that any more
                   try
                   {
-                     mChannel->StartConversation(connfd.release(), callback);
+                     StartConversation(std::move(connfd), callback);
                   }
                   catch(...)
                   {
@@ -118,6 +121,34 @@ public:
 
    int GetConnectPort() const noexcept { return mConnectPort; }
 
+   ///Tells the client the transport, then starts the channel
+   void StartConversation(socket_guard&& connfd, IPCChannelStatusCallback& callback)
+   {
+      if(mTransport == IPCTransport::SharedMemory)
+      {
+         auto channel = SharedMemoryIPCChannel::Create();
+         if(!channel ||
+            !SendHandshake(*connfd, { mTransport, channel->GetPath(), channel->GetCapacity() }))
+         {
+            callback.OnConnectionError();
+            return;
+         }
+         channel->StartConversation(connfd.release(), callback);
+         mChannel = std::move(channel);
+      }
+      else
+      {
+         if(!SendHandshake(*connfd, { mTransport }))
+         {
+            callback.OnConnectionError();
+            return;
+         }
+         auto channel = std::make_unique<BufferedIPCChannel>();
+         channel->StartConversation(connfd.release(), callback);
+         mChannel = std::move(channel);
+      }
+   }
+
    ~Impl()
    {
       {
@@ -133,7 +164,7 @@ public:
 
 };
 
-IPCServer::IPCServer(IPCChannelStatusCallback& callback)
+IPCServer::IPCServer(IPCChannelStatusCallback& callback, IPCTransport transport)
 {
 #ifdef _WIN32
    WSADATA wsaData;
@@ -141,7 +172,7 @@ IPCServer::IPCServer(IPCChannelStatusCallback& callback)
    if (result != NO_ERROR)
       throw std::runtime_error("WSAStartup failed");
 #endif
-   mImpl = std::make_unique<Impl>(callback);
+   mImpl = std::make_unique<Impl>(callback, transport);
 }
 
 IPCServer::~IPCServer() = default;
@@ -14,7 +14,8 @@
 
 #include <memory>
 
-class IPCChannel;
+#include "IPCChannel.h"
+
 class IPCChannelStatusCallback;
 
 /**
@@ -33,8 +34,10 @@ public:
     * until either IPCChannelStatusCallback::OnDisconnect
     * or IPCChannelStatusCallback::OnConnectionError is called.
     * \param callback Channel status callback. May be accessed from working threads.
+    * \param transport How the channel moves data; the client follows
     */
-   IPCServer(IPCChannelStatusCallback& callback);
+   IPCServer(IPCChannelStatusCallback& callback,
+      IPCTransport transport = IPCTransport::Socket);
    /**
     * \brief Closes connection if any.
     */
@@ -0,0 +1,148 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file IPCSharedMemory.cpp
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#include "IPCSharedMemory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+class IPCSharedMemory::Impl
+{
+public:
+   std::string mPath;
+   bool mOwner{false};
+   void* mData{nullptr};
+   size_t mSize{0};
+#ifdef _WIN32
+   HANDLE mFile{INVALID_HANDLE_VALUE};
+   HANDLE mMapping{nullptr};
+#else
+   int mFd{-1};
+#endif
+
+   bool Map(const std::string& path, size_t size, bool create)
+   {
+      mPath = path;
+      mSize = size;
+#ifdef _WIN32
+      const auto length = MultiByteToWideChar(CP_UTF8, 0,
+         path.c_str(), -1, nullptr, 0);
+      std::wstring widePath(length, L'\0');
+      MultiByteToWideChar(CP_UTF8, 0,
+         path.c_str(), -1, widePath.data(), length);
+      mFile = CreateFileW(widePath.c_str(), GENERIC_READ | GENERIC_WRITE,
+         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+         create ? CREATE_ALWAYS : OPEN_EXISTING,
+         FILE_ATTRIBUTE_TEMPORARY, nullptr);
+      if(mFile == INVALID_HANDLE_VALUE)
+         return false;
+      mOwner = create;
+      LARGE_INTEGER fileSize;
+      fileSize.QuadPart = size;
+      if(create && (!SetFilePointerEx(mFile, fileSize, nullptr, FILE_BEGIN) ||
+         !SetEndOfFile(mFile)))
+         return false;
+      mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READWRITE,
+         fileSize.HighPart, fileSize.LowPart, nullptr);
+      if(mMapping == nullptr)
+         return false;
+      mData = MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+      return mData != nullptr;
+#else
+      mFd = open(path.c_str(), create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR,
+         0600);
+      if(mFd < 0)
+         return false;
+      mOwner = create;
+      if(create && ftruncate(mFd, size) != 0)
+         return false;
+      const auto data = mmap(nullptr, size,
+         PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+      if(data == MAP_FAILED)
+         return false;
+      mData = data;
+      return true;
+#endif
+   }
+
+   ~Impl()
+   {
+#ifdef _WIN32
+      if(mData != nullptr)
+         UnmapViewOfFile(mData);
+      if(mMapping != nullptr)
+         CloseHandle(mMapping);
+      if(mFile != INVALID_HANDLE_VALUE)
+      {
+         CloseHandle(mFile);
+         if(mOwner)
+         {
+            const auto length = MultiByteToWideChar(CP_UTF8, 0,
+               mPath.c_str(), -1, nullptr, 0);
+            std::wstring widePath(length, L'\0');
+            MultiByteToWideChar(CP_UTF8, 0,
+               mPath.c_str(), -1, widePath.data(), length);
+            DeleteFileW(widePath.c_str());
+         }
+      }
+#else
+      if(mData != nullptr)
+         munmap(mData, mSize);
+      if(mFd >= 0)
+      {
+         close(mFd);
+         if(mOwner)
+            unlink(mPath.c_str());
+      }
+#endif
+   }
+};
+
+IPCSharedMemory::IPCSharedMemory(std::unique_ptr<Impl> impl)
+   : mImpl(std::move(impl))
+{
+}
+
+std::unique_ptr<IPCSharedMemory>
+IPCSharedMemory::Create(const std::string& path, size_t size)
+{
+   auto impl = std::make_unique<Impl>();
+   if(size == 0 || !impl->Map(path, size, true))
+      return {};
+   return std::unique_ptr<IPCSharedMemory>(
+      new IPCSharedMemory(std::move(impl)));
+}
+
+std::unique_ptr<IPCSharedMemory>
+IPCSharedMemory::Open(const std::string& path, size_t size)
+{
+   auto impl = std::make_unique<Impl>();
+   if(size == 0 || !impl->Map(path, size, false))
+      return {};
+   return std::unique_ptr<IPCSharedMemory>(
+      new IPCSharedMemory(std::move(impl)));
+}
+
+IPCSharedMemory::~IPCSharedMemory() = default;
+
+void* IPCSharedMemory::GetData() const noexcept
+{
+   return mImpl->mData;
+}
+
+size_t IPCSharedMemory::GetSize() const noexcept
+{
+   return mImpl->mSize;
+}
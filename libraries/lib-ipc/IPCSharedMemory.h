@@ -0,0 +1,48 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file IPCSharedMemory.h
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * \brief Region of memory mapped from a file, so that processes that map
+ * the same file share the contents. The process that creates the region
+ * removes the file when the region is destroyed.
+ */
+class IPC_API IPCSharedMemory final
+{
+   class Impl;
+   std::unique_ptr<Impl> mImpl;
+
+   explicit IPCSharedMemory(std::unique_ptr<Impl> impl);
+public:
+   /**
+    * \brief Creates (or truncates) the file, sized and filled with zeroes
+    * \param path UTF-8 encoded path of the file
+    * \return null if the file can't be created or mapped
+    */
+   static std::unique_ptr<IPCSharedMemory>
+   Create(const std::string& path, size_t size);
+   /**
+    * \brief Maps a file made by Create() in another process
+    * \param size must not exceed the size passed to Create()
+    * \return null if the file can't be opened or mapped
+    */
+   static std::unique_ptr<IPCSharedMemory>
+   Open(const std::string& path, size_t size);
+
+   ~IPCSharedMemory();
+
+   void* GetData() const noexcept;
+   size_t GetSize() const noexcept;
+};
@@ -0,0 +1,280 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SharedMemoryIPCChannel.cpp
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#include "SharedMemoryIPCChannel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "IPCSharedMemory.h"
+#include "MemoryX.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace
+{
+   std::string GetTemporaryDirectory()
+   {
+#ifdef _WIN32
+      wchar_t path[MAX_PATH + 1];
+      const auto length = GetTempPathW(MAX_PATH + 1, path);
+      if(length == 0)
+         return {};
+      const auto size = WideCharToMultiByte(CP_UTF8, 0,
+         path, length, nullptr, 0, nullptr, nullptr);
+      std::string result(size, '\0');
+      WideCharToMultiByte(CP_UTF8, 0,
+         path, length, result.data(), size, nullptr, nullptr);
+      return result;
+#else
+      const auto directory = std::getenv("TMPDIR");
+      std::string result { directory != nullptr ? directory : "/tmp" };
+      if(result.empty() || result.back() != '/')
+         result += '/';
+      return result;
+#endif
+   }
+
+   unsigned long GetProcessId()
+   {
+#ifdef _WIN32
+      return GetCurrentProcessId();
+#else
+      return static_cast<unsigned long>(getpid());
+#endif
+   }
+}
+
+size_t SharedMemoryIPCChannel::GetRingSize(size_t capacity) noexcept
+{
+   return sizeof(RingHeader) + capacity;
+}
+
+std::unique_ptr<SharedMemoryIPCChannel>
+SharedMemoryIPCChannel::Create(size_t capacity)
+{
+   static std::atomic<unsigned> counter { 0 };
+   auto path = GetTemporaryDirectory() + "audacity-ipc-" +
+      std::to_string(GetProcessId()) + "-" + std::to_string(counter++);
+   auto memory = IPCSharedMemory::Create(path, 2 * GetRingSize(capacity));
+   if(!memory)
+      return {};
+   return std::unique_ptr<SharedMemoryIPCChannel>(new SharedMemoryIPCChannel(
+      std::move(memory), std::move(path), capacity, true));
+}
+
+std::unique_ptr<SharedMemoryIPCChannel>
+SharedMemoryIPCChannel::Open(const std::string& path, size_t capacity)
+{
+   if(capacity == 0)
+      return {};
+   auto memory = IPCSharedMemory::Open(path, 2 * GetRingSize(capacity));
+   if(!memory)
+      return {};
+   return std::unique_ptr<SharedMemoryIPCChannel>(new SharedMemoryIPCChannel(
+      std::move(memory), path, capacity, false));
+}
+
+SharedMemoryIPCChannel::SharedMemoryIPCChannel(
+   std::unique_ptr<IPCSharedMemory> memory, std::string path, size_t capacity,
+   bool server)
+   : mMemory(std::move(memory))
+   , mPath(std::move(path))
+   , mCapacity(capacity)
+{
+   //Server writes into the first ring, client into the second
+   const auto data = static_cast<char*>(mMemory->GetData());
+   Ring rings[2];
+   for(int i = 0; i < 2; ++i)
+   {
+      const auto begin = data + i * GetRingSize(capacity);
+      rings[i].header = server
+         ? new (begin) RingHeader{}
+         : reinterpret_cast<RingHeader*>(begin);
+      rings[i].data = begin + sizeof(RingHeader);
+   }
+   mOutbound = rings[server ? 0 : 1];
+   mInbound = rings[server ? 1 : 0];
+}
+
+SharedMemoryIPCChannel::~SharedMemoryIPCChannel()
+{
+   {
+      std::lock_guard lck(mSync);
+      mAlive = false;
+   }
+   mSendCondition.notify_one();
+   if(mSocket != INVALID_SOCKET)
+   {
+      //Shut down connection and wake up select
+#ifdef _WIN32
+      shutdown(mSocket, SD_BOTH);
+#else
+      shutdown(mSocket, SHUT_RDWR);
+#endif
+      if(mSendRoutine)
+         mSendRoutine->join();
+      if(mRecvRoutine)
+         mRecvRoutine->join();
+
+      CLOSE_SOCKET(mSocket);
+   }
+}
+
+void SharedMemoryIPCChannel::Send(const void* bytes, size_t length)
+{
+   assert(length > 0);
+   if(length == 0)
+      return;
+
+   {
+      std::lock_guard lck(mSync);
+
+      auto offset = mOutputBuffer.size();
+      mOutputBuffer.resize(offset + length);
+      std::memcpy(mOutputBuffer.data() + offset, bytes, length);
+   }
+   mSendCondition.notify_one();
+}
+
+void SharedMemoryIPCChannel::Wake(std::atomic<uint32_t>& waiting) noexcept
+{
+   if(waiting.exchange(0) != 0)
+   {
+      const char byte { 0 };
+      send(mSocket, &byte, 1, 0);
+   }
+}
+
+size_t SharedMemoryIPCChannel::WriteOutput() noexcept
+{
+   auto& header = *mOutbound.header;
+   const auto written = header.written.load();
+   const auto writable = mCapacity - static_cast<size_t>(written - header.read.load());
+   const auto count = std::min(writable, mOutputBuffer.size());
+   //Copy in at most two pieces, around the end of the ring
+   const auto offset = static_cast<size_t>(written % mCapacity);
+   const auto first = std::min(count, mCapacity - offset);
+   std::memcpy(mOutbound.data + offset, mOutputBuffer.data(), first);
+   std::memcpy(mOutbound.data, mOutputBuffer.data() + first, count - first);
+   header.written.store(written + count);
+   mOutputBuffer.erase(mOutputBuffer.begin(), mOutputBuffer.begin() + count);
+   return count;
+}
+
+void SharedMemoryIPCChannel::StartConversation(SOCKET socket, IPCChannelStatusCallback& callback)
+{
+   assert(socket != INVALID_SOCKET);
+   assert(mSocket == INVALID_SOCKET && !mSendRoutine && !mRecvRoutine);
+   mSocket = socket;
+
+   mSendRoutine = std::make_unique<std::thread>([this]
+   {
+      auto& header = *mOutbound.header;
+      while(true)
+      {
+         std::unique_lock lck(mSync);
+         mSendCondition.wait(lck, [&]
+         {
+            if(!mAlive)
+               return true;
+            if(mOutputBuffer.empty())
+               return false;
+            if(header.written.load() - header.read.load() < mCapacity)
+               return true;
+            //Ring is full; ask the reader for a wake up, then check again
+            header.writerWaiting.store(1);
+            return header.written.load() - header.read.load() < mCapacity;
+         });
+
+         if(!mAlive)
+            return;
+
+         WriteOutput();
+         lck.unlock();
+
+         Wake(header.readerWaiting);
+      }
+   });
+
+   mRecvRoutine = std::make_unique<std::thread>([this, &callback]{
+      //such order guarantees that IPCStatusCallback::OnConnect will be called
+      //only if both routines have started successfully
+      callback.OnConnect(*this);
+
+      auto terminate = finally([this, &callback]
+      {
+         {
+            //Let "sending" thread know that we're done
+            std::lock_guard lck(mSync);
+            mAlive = false;
+         }
+         mSendCondition.notify_one();
+         callback.OnDisconnect();
+      });
+
+      auto& header = *mInbound.header;
+      char wakeBytes[64];
+      while(true)
+      {
+         //Deliver whatever the other side wrote, in place
+         while(true)
+         {
+            const auto read = header.read.load();
+            const auto readable = static_cast<size_t>(header.written.load() - read);
+            if(readable == 0)
+               break;
+            const auto offset = static_cast<size_t>(read % mCapacity);
+            const auto count = std::min(readable, mCapacity - offset);
+            callback.OnDataAvailable(mInbound.data + offset, count);
+            header.read.store(read + count);
+            Wake(header.writerWaiting);
+         }
+
+         //Any wake up may also be for our own "sending" thread
+         mSendCondition.notify_one();
+
+         //Ask the writer for a wake up, then check again before sleeping
+         header.readerWaiting.store(1);
+         if(header.written.load() != header.read.load())
+            continue;
+
+         fd_set readfds, exceptfds;
+         FD_ZERO(&readfds);
+         FD_ZERO(&exceptfds);
+         FD_SET(mSocket, &readfds);
+         FD_SET(mSocket, &exceptfds);
+
+         auto ret = select(NFDS(mSocket), &readfds, nullptr, &exceptfds, nullptr);
+         if(ret != 1)
+            break;//SOCKET_ERROR
+         ret = recv(mSocket, wakeBytes, static_cast<int>(sizeof(wakeBytes)), 0);
+         if(ret == 0)
+            break;//closed by remote
+         if(ret == SOCKET_ERROR)
+         {
+#ifdef _WIN32
+            auto err = WSAGetLastError();
+            if(err != WSAEWOULDBLOCK && err != EAGAIN)
+               break;
+#else
+            if(errno != EWOULDBLOCK && errno != EAGAIN)
+               break;
+#endif
+         }
+      }
+   });
+}
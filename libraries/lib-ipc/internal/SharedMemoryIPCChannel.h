@@ -0,0 +1,113 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SharedMemoryIPCChannel.h
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ipc-types.h"
+#include "IPCChannel.h"
+
+class IPCChannelStatusCallback;
+class IPCSharedMemory;
+
+/**
+ * \brief Implementation of IPCChannel that moves data through two byte
+ * rings, one for each direction, in memory shared by client and server.
+ * The socket carries only single bytes that wake the other side when it
+ * waits for data or for space. Received data is passed to the callback
+ * directly from the shared memory.
+ */
+class SharedMemoryIPCChannel final : public IPCChannel
+{
+public:
+   static constexpr size_t DefaultCapacity { 1 << 20 };
+
+   ///Server side: makes and initializes the shared memory
+   ///\return null on failure
+   static std::unique_ptr<SharedMemoryIPCChannel> Create(
+      size_t capacity = DefaultCapacity);
+   ///Client side: maps the memory that the server made
+   ///\return null on failure
+   static std::unique_ptr<SharedMemoryIPCChannel> Open(
+      const std::string& path, size_t capacity);
+
+   ///Destroys channel and stops any data exchange
+   ~SharedMemoryIPCChannel() override;
+
+   const std::string& GetPath() const noexcept { return mPath; }
+   size_t GetCapacity() const noexcept { return mCapacity; }
+
+   /**
+    * \brief Thread-safe, doesn't block
+    */
+   void Send(const void* bytes, size_t length) override;
+
+   /**
+    * \brief Same contract as BufferedIPCChannel::StartConversation
+    */
+   void StartConversation(SOCKET socket, IPCChannelStatusCallback& callback);
+
+private:
+   //! Precedes the bytes of each ring
+   struct alignas(64) RingHeader
+   {
+      std::atomic<uint64_t> written;
+      std::atomic<uint64_t> read;
+      //! Set by the reader before it sleeps; the writer wakes it
+      std::atomic<uint32_t> readerWaiting;
+      //! Set by the writer before it sleeps; the reader wakes it
+      std::atomic<uint32_t> writerWaiting;
+   };
+   static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+      std::atomic<uint32_t>::is_always_lock_free,
+      "the rings must work across processes");
+
+   struct Ring
+   {
+      RingHeader* header {nullptr};
+      char* data {nullptr};
+   };
+
+   SharedMemoryIPCChannel(std::unique_ptr<IPCSharedMemory> memory,
+      std::string path, size_t capacity, bool server);
+
+   static size_t GetRingSize(size_t capacity) noexcept;
+   ///Send a byte to the other side if it waits on the flag
+   void Wake(std::atomic<uint32_t>& waiting) noexcept;
+   ///Copies as much of the output buffer as fits into the outbound ring
+   ///\return number of bytes copied
+   size_t WriteOutput() noexcept;
+
+   const std::unique_ptr<IPCSharedMemory> mMemory;
+   const std::string mPath;
+   const size_t mCapacity;
+   Ring mOutbound;
+   Ring mInbound;
+
+   bool mAlive {true};
+   std::mutex mSync;
+   std::condition_variable mSendCondition;
+
+   std::unique_ptr<std::thread> mRecvRoutine;
+   std::unique_ptr<std::thread> mSendRoutine;
+
+   SOCKET mSocket {INVALID_SOCKET};
+
+   //! Bytes given to Send() but not yet in the ring
+   std::vector<char> mOutputBuffer;
+};
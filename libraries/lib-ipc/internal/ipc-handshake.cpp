@@ -0,0 +1,83 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ipc-handshake.cpp
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#include "ipc-handshake.h"
+
+
+namespace
+{
+   //Paths longer than this are not expected
+   constexpr uint32_t MaxPathLength { 4096 };
+
+   bool SendAll(SOCKET socket, const void* bytes, size_t length)
+   {
+      auto data = static_cast<const char*>(bytes);
+      while(length > 0)
+      {
+         const auto ret = send(socket, data, static_cast<int>(length), 0);
+         if(ret <= 0)
+            return false;
+         data += ret;
+         length -= ret;
+      }
+      return true;
+   }
+
+   bool ReceiveAll(SOCKET socket, void* bytes, size_t length)
+   {
+      auto data = static_cast<char*>(bytes);
+      while(length > 0)
+      {
+         const auto ret = recv(socket, data, static_cast<int>(length), 0);
+         if(ret <= 0)
+            return false;
+         data += ret;
+         length -= ret;
+      }
+      return true;
+   }
+}
+
+bool SendHandshake(SOCKET socket, const IPCHandshake& handshake)
+{
+   const auto transport = static_cast<uint8_t>(handshake.transport);
+   if(!SendAll(socket, &transport, sizeof(transport)))
+      return false;
+   if(handshake.transport == IPCTransport::Socket)
+      return true;
+
+   const auto pathLength = static_cast<uint32_t>(handshake.path.size());
+   return SendAll(socket, &pathLength, sizeof(pathLength)) &&
+      SendAll(socket, handshake.path.data(), pathLength) &&
+      SendAll(socket, &handshake.capacity, sizeof(handshake.capacity));
+}
+
+std::optional<IPCHandshake> ReceiveHandshake(SOCKET socket)
+{
+   IPCHandshake handshake;
+   uint8_t transport;
+   if(!ReceiveAll(socket, &transport, sizeof(transport)))
+      return {};
+   handshake.transport = static_cast<IPCTransport>(transport);
+   if(handshake.transport == IPCTransport::Socket)
+      return handshake;
+   if(handshake.transport != IPCTransport::SharedMemory)
+      return {};
+
+   uint32_t pathLength;
+   if(!ReceiveAll(socket, &pathLength, sizeof(pathLength)) ||
+      pathLength > MaxPathLength)
+      return {};
+   handshake.path.resize(pathLength);
+   if(!ReceiveAll(socket, handshake.path.data(), pathLength) ||
+      !ReceiveAll(socket, &handshake.capacity, sizeof(handshake.capacity)))
+      return {};
+   return handshake;
+}
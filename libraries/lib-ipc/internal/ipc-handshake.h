@@ -0,0 +1,37 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ipc-handshake.h
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "ipc-types.h"
+#include "IPCChannel.h"
+
+/**
+ * \brief First message from server to client on a new connection,
+ * describing the transport of the channel
+ */
+struct IPCHandshake
+{
+   IPCTransport transport { IPCTransport::Socket };
+   ///For the shared memory transport: UTF-8 path of the mapped file
+   std::string path;
+   ///For the shared memory transport: bytes in each direction
+   uint64_t capacity { 0 };
+};
+
+///Blocks until the whole handshake is sent
+bool SendHandshake(SOCKET socket, const IPCHandshake& handshake);
+
+///Blocks until the whole handshake is received
+std::optional<IPCHandshake> ReceiveHandshake(SOCKET socket);
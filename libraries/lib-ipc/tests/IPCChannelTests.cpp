@@ -0,0 +1,125 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: IPCChannelTests.cpp
+ */
+
+#include "IPCChannel.h"
+#include "IPCClient.h"
+#include "IPCServer.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace
+{
+//! Collects received bytes, and remembers the channel
+class Endpoint final : public IPCChannelStatusCallback
+{
+public:
+   void OnConnectionError() noexcept override
+   {
+      {
+         std::lock_guard lck(mSync);
+         mFailed = true;
+      }
+      mCondition.notify_all();
+   }
+
+   void OnConnect(IPCChannel& channel) noexcept override
+   {
+      {
+         std::lock_guard lck(mSync);
+         mChannel = &channel;
+      }
+      mCondition.notify_all();
+   }
+
+   void OnDisconnect() noexcept override
+   {
+      {
+         std::lock_guard lck(mSync);
+         mChannel = nullptr;
+      }
+      mCondition.notify_all();
+   }
+
+   void OnDataAvailable(const void* data, size_t size) noexcept override
+   {
+      {
+         std::lock_guard lck(mSync);
+         mReceived.append(static_cast<const char*>(data), size);
+      }
+      mCondition.notify_all();
+   }
+
+   IPCChannel* WaitForChannel()
+   {
+      std::unique_lock lck(mSync);
+      mCondition.wait_for(lck, std::chrono::seconds { 10 },
+         [this] { return mChannel != nullptr || mFailed; });
+      return mChannel;
+   }
+
+   std::string WaitForBytes(size_t size)
+   {
+      std::unique_lock lck(mSync);
+      mCondition.wait_for(lck, std::chrono::seconds { 10 },
+         [&] { return mReceived.size() >= size; });
+      return mReceived;
+   }
+
+private:
+   std::mutex mSync;
+   std::condition_variable mCondition;
+   IPCChannel* mChannel { nullptr };
+   std::string mReceived;
+   bool mFailed { false };
+};
+
+std::string MakePayload(size_t size)
+{
+   std::string payload(size, '\0');
+   for (size_t ii = 0; ii < size; ++ii)
+      payload[ii] = static_cast<char>(ii * 7);
+   return payload;
+}
+}
+
+TEST_CASE("IPCChannel")
+{
+   const auto transport =
+      GENERATE(IPCTransport::Socket, IPCTransport::SharedMemory);
+
+   Endpoint serverSide, clientSide;
+   IPCServer server { serverSide, transport };
+   auto client =
+      std::make_unique<IPCClient>(server.GetConnectPort(), clientSide);
+
+   auto serverChannel = serverSide.WaitForChannel();
+   auto clientChannel = clientSide.WaitForChannel();
+   REQUIRE(serverChannel != nullptr);
+   REQUIRE(clientChannel != nullptr);
+
+   SECTION("bytes arrive in both directions")
+   {
+      serverChannel->Send("ping", 4);
+      REQUIRE(clientSide.WaitForBytes(4) == "ping");
+      clientChannel->Send("pong", 4);
+      REQUIRE(serverSide.WaitForBytes(4) == "pong");
+   }
+
+   SECTION("payloads larger than the buffers arrive whole and in order")
+   {
+      // Larger than the shared memory rings, too
+      const auto payload = MakePayload(3 << 20);
+      clientChannel->Send(payload.data(), payload.size() / 2);
+      clientChannel->Send(
+         payload.data() + payload.size() / 2, payload.size() - payload.size() / 2);
+      REQUIRE(serverSide.WaitForBytes(payload.size()) == payload);
+   }
+}
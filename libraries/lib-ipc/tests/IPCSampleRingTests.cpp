@@ -0,0 +1,96 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: IPCSampleRingTests.cpp
+ */
+
+#include "IPCSampleRing.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("IPCSampleRing")
+{
+   constexpr unsigned nChannels = 2;
+   constexpr size_t capacity = 8;
+   std::vector<uint64_t> memory(
+      (IPCSampleRing::GetRequiredSize(nChannels, capacity) + 7) / 8);
+   IPCSampleRing writer { memory.data(), nChannels, capacity, true };
+   IPCSampleRing reader { memory.data(), nChannels, capacity, false };
+
+   SECTION("starts empty")
+   {
+      REQUIRE(writer.GetWritable() == capacity);
+      REQUIRE(writer.GetContiguousWritable() == capacity);
+      REQUIRE(reader.GetReadable() == 0);
+   }
+
+   SECTION("spans wrap around the end")
+   {
+      writer.CommitWrite(6);
+      reader.CommitRead(6);
+      REQUIRE(writer.GetWritable() == capacity);
+      REQUIRE(writer.GetContiguousWritable() == 2);
+
+      for (unsigned channel = 0; channel < nChannels; ++channel)
+         for (size_t ii = 0; ii < 2; ++ii)
+            writer.GetWritePointer(channel)[ii] = float(channel * 10 + ii);
+      writer.CommitWrite(2);
+      REQUIRE(writer.GetContiguousWritable() == capacity - 2);
+      REQUIRE(writer.GetWritePointer(1) == reader.GetReadPointer(1) - 6);
+
+      REQUIRE(reader.GetReadable() == 2);
+      REQUIRE(reader.GetContiguousReadable() == 2);
+      REQUIRE(reader.GetReadPointer(0)[1] == 1.0f);
+      REQUIRE(reader.GetReadPointer(1)[0] == 10.0f);
+      reader.CommitRead(2);
+      REQUIRE(reader.GetReadable() == 0);
+   }
+
+   SECTION("a full ring has no space")
+   {
+      writer.CommitWrite(capacity);
+      REQUIRE(writer.GetWritable() == 0);
+      REQUIRE(writer.GetContiguousWritable() == 0);
+      REQUIRE(reader.GetReadable() == capacity);
+   }
+
+   SECTION("samples pass between threads in order")
+   {
+      constexpr size_t total = 10000;
+      std::thread producer { [&] {
+         size_t next = 0;
+         while (next < total)
+         {
+            const auto count =
+               std::min(writer.GetContiguousWritable(), total - next);
+            for (size_t ii = 0; ii < count; ++ii)
+               for (unsigned channel = 0; channel < nChannels; ++channel)
+                  writer.GetWritePointer(channel)[ii] = float(next + ii);
+            writer.CommitWrite(count);
+            next += count;
+            if (count == 0)
+               std::this_thread::yield();
+         }
+      } };
+
+      size_t next = 0;
+      bool inOrder = true;
+      while (next < total)
+      {
+         const auto count = reader.GetContiguousReadable();
+         for (size_t ii = 0; ii < count; ++ii)
+            for (unsigned channel = 0; channel < nChannels; ++channel)
+               inOrder = inOrder &&
+                  reader.GetReadPointer(channel)[ii] == float(next + ii);
+         reader.CommitRead(count);
+         next += count;
+         if (count == 0)
+            std::this_thread::yield();
+      }
+      producer.join();
+      REQUIRE(inOrder);
+   }
+}
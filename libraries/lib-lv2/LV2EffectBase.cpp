@@ -285,10 +285,18 @@ RegistryPaths LV2EffectBase::GetFactoryPresets() const
 
          mFactoryPresetUris.push_back(LilvString(preset));
 
-         lilv_world_load_resource(gWorld, preset);
-
-         if (LilvNodesPtr labels{ lilv_world_find_nodes(gWorld, preset,
-            node_Label, nullptr) }) {
+         // Labels are usually in the manifests, already loaded; parse the
+         // whole data of a preset only when it has none, or when it is loaded
+         const auto findLabels = [&]{
+            return LilvNodesPtr{
+               lilv_world_find_nodes(gWorld, preset, node_Label, nullptr) };
+         };
+         auto labels = findLabels();
+         if (!labels) {
+            lilv_world_load_resource(gWorld, preset);
+            labels = findLabels();
+         }
+         if (labels) {
             const auto label = lilv_nodes_get_first(labels.get());
             mFactoryPresetNames.push_back(LilvString(label));
          }
@@ -313,6 +321,8 @@ LV2EffectBase::LoadFactoryPreset(int id, EffectSettings &settings) const
    LilvNodePtr preset{ lilv_new_uri(gWorld, mFactoryPresetUris[id].ToUTF8()) };
    if (!preset)
       return {};
+   // Does nothing if already loaded when listing the presets
+   lilv_world_load_resource(gWorld, preset.get());
 
    using LilvStatePtr = Lilv_ptr<LilvState, lilv_state_free>;
    LilvStatePtr state{
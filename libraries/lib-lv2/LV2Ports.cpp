@@ -17,6 +17,7 @@
 
 #include <wx/log.h>
 #include <cmath>
+#include <cstring>
 
 void LV2AtomPortState::SendToInstance(
    LV2_Atom_Forge &forge, const int64_t frameTime, const float speed
@@ -61,6 +62,23 @@ void LV2AtomPortState::SendToInstance(
             wxLogError(wxT("LV2 sequence buffer overflow"));
          }
       }
+      // Then the scheduled events, at their own times, all in one pass
+      const auto scheduled = mScheduled.get();
+      for (uint32_t pos = 0; pos < mScheduledSize;) {
+         uint32_t frameOffset;
+         memcpy(&frameOffset, scheduled + pos, sizeof(frameOffset));
+         pos += sizeof(frameOffset);
+         const auto pAtom = reinterpret_cast<const LV2_Atom *>(scheduled + pos);
+         const auto size = lv2_atom_total_size(pAtom);
+         pos += lv2_atom_pad_size(size);
+         if (forge.offset + sizeof(LV2_Atom_Event) + size < forge.size) {
+            lv2_atom_forge_frame_time(&forge, frameTime + frameOffset);
+            lv2_atom_forge_write(&forge, pAtom, size);
+         }
+         else
+            wxLogError(wxT("LV2 sequence buffer overflow"));
+      }
+      mScheduledSize = 0;
       lv2_atom_forge_pop(&forge, &seqFrame);
 #if 0
       LV2_ATOM_SEQUENCE_FOREACH(seq, ev) {
@@ -75,6 +93,21 @@ void LV2AtomPortState::SendToInstance(
       ResetForInstanceOutput();
 }
 
+bool LV2AtomPortState::ScheduleEvent(
+   const uint32_t frameOffset, const LV2_Atom &atom)
+{
+   assert(mpPort->mIsInput);
+   const auto size = lv2_atom_total_size(&atom);
+   const auto needed = sizeof(frameOffset) + lv2_atom_pad_size(size);
+   if (mScheduledSize + needed > mpPort->mMinimumSize)
+      return false;
+   const auto scheduled = mScheduled.get() + mScheduledSize;
+   memcpy(scheduled, &frameOffset, sizeof(frameOffset));
+   memcpy(scheduled + sizeof(frameOffset), &atom, size);
+   mScheduledSize += needed;
+   return true;
+}
+
 void LV2AtomPortState::ResetForInstanceOutput() {
    using namespace LV2Symbols;
    auto &port = mpPort;
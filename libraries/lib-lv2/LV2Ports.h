@@ -82,6 +82,7 @@ struct LV2_API LV2AtomPortState final {
       : mpPort{ move(pPort) }
       , mRing{ zix_ring_new(mpPort->mMinimumSize) }
       , mBuffer{ safenew uint8_t[mpPort->mMinimumSize] }
+      , mScheduled{ safenew uint8_t[mpPort->mMinimumSize] }
    {
       assert(mpPort);
       /*
@@ -102,9 +103,24 @@ struct LV2_API LV2AtomPortState final {
     These will be made available to each slave in the chain.
     In addition, reset the output Atom ports.
    */
+   /*!
+    Then append the events scheduled since the last call, in one sequence
+    */
    void SendToInstance(LV2_Atom_Forge &forge, int64_t frameTime, float speed);
    void ResetForInstanceOutput();
 
+   //! Add an event for the next call to SendToInstance, such as a patch:Set
+   //! for sample-accurate automation of a parameter
+   /*!
+    Call from the processing thread.  Copies the atom into storage allocated
+    once with the port, so that batches of events cost no allocations.
+
+    @pre offsets are given in non-decreasing order between sends
+    @param frameOffset position of the event within the next block
+    @return false if the event did not fit, and was dropped
+    */
+   bool ScheduleEvent(uint32_t frameOffset, const LV2_Atom &atom);
+
    //! Take responses from the instance and send cross-thread for the dialog
    void ReceiveFromInstance();
 
@@ -121,6 +137,9 @@ struct LV2_API LV2AtomPortState final {
    const LV2AtomPortPtr mpPort;
    const Lilv_ptr<ZixRing, zix_ring_free> mRing;
    const std::unique_ptr<uint8_t[]> mBuffer;
+   //! Scheduled events, each stored as an offset, then the atom
+   const std::unique_ptr<uint8_t[]> mScheduled;
+   uint32_t mScheduledSize{ 0 };
 };
 using LV2AtomPortStatePtr = std::shared_ptr<LV2AtomPortState>;
 using LV2AtomPortStateArray = std::vector<LV2AtomPortStatePtr>;
@@ -24,6 +24,7 @@
 #include "LV2Wrapper.h"
 #include "LV2FeaturesList.h"
 #include "LV2Ports.h"
+#include "concurrency/TaskScheduler.h"
 
 #if defined(__WXMSW__)
 #include <wx/msw/wrapwin.h>
@@ -110,12 +111,11 @@ void LV2Wrapper::ConnectPorts(const LV2Ports &ports, LV2PortStates &portStates,
 LV2Wrapper::~LV2Wrapper()
 {
    if (mInstance) {
-      if (mThread.joinable()) {
-         // Even if we have been freewheeling, this unblocks the unused thread
-         // so it can be joined
+      {
+         // Skip requests not yet started, and wait for one that is running
+         std::unique_lock lock{ mWorkMutex };
          mStopWorker = true;
-         mRequests.Post({ 0, NULL });  // Must do after writing mStopWorker
-         mThread.join();
+         mWorkDone.wait(lock, [this]{ return !mWorkScheduled; });
       }
       Deactivate();
    }
@@ -152,10 +152,6 @@ LV2Wrapper::LV2Wrapper(CreateToken&&, LV2InstanceFeaturesList &baseFeatures,
    lilv_instance_get_extension_data(mInstance.get(), LV2_WORKER__interface))
 }
 {
-   if (mWorkerInterface)
-      mThread = std::thread{
-         std::mem_fn( &LV2Wrapper::ThreadFunction ), std::ref(*this)
-      };
 }
 
 void LV2Wrapper::Activate()
@@ -208,26 +204,39 @@ void LV2Wrapper::SendBlockSize()
    }
 }
 
-// Thread body
-void LV2Wrapper::ThreadFunction()
+// Task body
+void LV2Wrapper::DoRequests()
 {
-   for (LV2Work work{};
-      // Must test mStopWorker only after reading mRequests
-      mRequests.Receive(work) == wxMSGQUEUE_NO_ERROR && !mStopWorker;
-   )
+   while (true) {
+      LV2Work work;
+      {
+         std::lock_guard lock{ mWorkMutex };
+         if (mStopWorker || mRequests.empty()) {
+            mWorkScheduled = false;
+            mWorkDone.notify_all();
+            return;
+         }
+         work = std::move(mRequests.front());
+         mRequests.pop_front();
+      }
       // Call foreign instance code in this thread, which is neither the
       // main nor the audio thread
-      mWorkerInterface->work(mHandle, respond, this, work.size, work.data);
+      mWorkerInterface->work(mHandle, respond, this, work.size(), work.data());
+   }
 }
 
 void LV2Wrapper::ConsumeResponses()
 {
    if (mWorkerInterface) {
-      LV2Work work{};
-      while (mResponses.ReceiveTimeout(0, work) == wxMSGQUEUE_NO_ERROR)
+      {
+         std::lock_guard lock{ mWorkMutex };
+         mResponsesToDo.swap(mResponses);
+      }
+      for (const auto &work : mResponsesToDo)
          // Invoke foreign instance code in main (destructive) or
          // audio thread (real-time) processing
-         mWorkerInterface->work_response(mHandle, work.size, work.data);
+         mWorkerInterface->work_response(mHandle, work.size(), work.data());
+      mResponsesToDo.clear();
       if (mWorkerInterface->end_run)
          // More foreign code
          mWorkerInterface->end_run(mHandle);
@@ -247,11 +256,22 @@ LV2_Worker_Status LV2Wrapper::ScheduleWork(uint32_t size, const void *data)
       // Not using another thread
       return mWorkerInterface->work(mHandle, respond, this, size, data);
    else {
-      // Put in the queue for the worker thread
-      // which will then do mWorkerInterface->work
-      const auto err = mRequests.Post({ size, data });
-      return (err == wxMSGQUEUE_NO_ERROR)
-         ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_UNKNOWN;
+      // Put in the queue for a task in the pool shared by all instances,
+      // which will then do mWorkerInterface->work; start the task unless one
+      // is already queued or running for this instance
+      {
+         std::lock_guard lock{ mWorkMutex };
+         if (mStopWorker)
+            return LV2_WORKER_ERR_UNKNOWN;
+         mRequests.emplace_back(size, data);
+         if (mWorkScheduled)
+            return LV2_WORKER_SUCCESS;
+         mWorkScheduled = true;
+      }
+      audacity::concurrency::TaskScheduler::Get().Submit([this]{
+         DoRequests();
+      }, audacity::concurrency::TaskPriority::NearRealtime);
+      return LV2_WORKER_SUCCESS;
    }
 }
 
@@ -267,9 +287,9 @@ LV2_Worker_Status LV2Wrapper::Respond(uint32_t size, const void *data)
 {
    // Put in the queue, for another thread -- when not "freewheeling."
    // Otherwise it is just roundabout communication within a thread
-   const auto err = mResponses.Post({ size, data });
-   return (err == wxMSGQUEUE_NO_ERROR)
-      ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_UNKNOWN;
+   std::lock_guard lock{ mWorkMutex };
+   mResponses.emplace_back(size, data);
+   return LV2_WORKER_SUCCESS;
 }
 
 #endif
@@ -4,7 +4,8 @@
 
   @file LV2Wrapper.h
   @brief manager for a handle to an lv2 plug-in instance and request and
-  response queues for inter-thread work scheduling
+  response queues for inter-thread work scheduling, in a pool of threads
+  shared by all instances
 
   Paul Licameli split from LV2Effect.h
 
@@ -27,8 +28,10 @@
 #include "lv2/state/state.h"
 #include "lv2/worker/worker.h"
 
-#include <thread>
-#include <wx/msgqueue.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
 
 struct EffectOutputs;
 struct LV2EffectSettings;
@@ -46,9 +49,17 @@ class LV2_API LV2Wrapper final
    //! To compel use of the factory
    struct CreateToken{};
 public:
+   //! A message of the worker extension, copied, as the extension requires
    struct LV2Work {
-      uint32_t size{};
-      const void *data{};
+      LV2Work() = default;
+      LV2Work(uint32_t size, const void *data)
+         : bytes(static_cast<const char*>(data),
+            static_cast<const char*>(data) + (data ? size : 0))
+      {}
+      uint32_t size() const { return static_cast<uint32_t>(bytes.size()); }
+      const void *data() const { return bytes.empty() ? nullptr : bytes.data(); }
+
+      std::vector<char> bytes;
    };
 
 public:
@@ -59,12 +70,11 @@ public:
       const LV2EffectSettings &settings, float sampleRate,
       EffectOutputs *pOutputs);
 
-   //! Constructor may spawn a thread
    LV2Wrapper(CreateToken&&,
       LV2InstanceFeaturesList &baseFeatures,
       const LilvPlugin &plugin, float sampleRate);
 
-   //! If a thread was started, joins it
+   //! Waits for a request that the worker pool is doing, if any
    ~LV2Wrapper();
 
    void ConnectControlPorts(const LV2Ports &ports,
@@ -93,7 +103,8 @@ public:
    const LV2WrapperFeaturesList &GetFeatures() const { return mFeaturesList; }
 
 private:
-   void ThreadFunction();
+   //! Body of the task in the shared pool, doing the queued requests in order
+   void DoRequests();
 
    // Another object with an explicit virtual function table
    LV2_Worker_Schedule mWorkerSchedule{ this, LV2Wrapper::schedule_work };
@@ -113,17 +124,24 @@ private:
    // Worker extension
    const LV2_Worker_Interface *const mWorkerInterface;
 
-   std::thread mThread;
-   wxMessageQueue<LV2Work> mRequests;
-   wxMessageQueue<LV2Work> mResponses;
+   //! Guards the queues and the flags about the worker task
+   std::mutex mWorkMutex;
+   //! Signals the end of the worker task
+   std::condition_variable mWorkDone;
+   std::deque<LV2Work> mRequests;
+   std::deque<LV2Work> mResponses;
+   //! Whether a task for mRequests is queued or running in the pool; the
+   //! extension requires that work for one instance is not concurrent
+   bool mWorkScheduled{ false };
+   bool mStopWorker{ false };
+   //! Reused by ConsumeResponses(), so that it seldom allocates
+   std::deque<LV2Work> mResponsesToDo;
+
    float mLatency{ 0.0 };
 
-   //! If true, do not spawn extra worker threads
+   //! If true, do requests in the thread that schedules them
    bool mFreeWheeling{ false };
 
-   //! Written by main thread, read by worker, but atomic isn't needed because
-   //! mRequests provides synchronization
-   bool mStopWorker{ false };
    bool mActivated{ false };
 };
 
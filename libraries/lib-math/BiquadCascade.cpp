@@ -0,0 +1,139 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BiquadCascade.cpp
+
+**********************************************************************/
+
+#include "BiquadCascade.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BIQUAD_CASCADE_SSE2
+#include <emmintrin.h>
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#define BIQUAD_CASCADE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Two doubles, one for each channel of a pair
+#if defined(BIQUAD_CASCADE_SSE2)
+using Pair = __m128d;
+inline Pair Load(const double *p) { return _mm_loadu_pd(p); }
+inline void Store(double *p, Pair v) { _mm_storeu_pd(p, v); }
+inline Pair Make(double lane0, double lane1)
+   { return _mm_set_pd(lane1, lane0); }
+inline Pair Plus(Pair a, Pair b) { return _mm_add_pd(a, b); }
+inline Pair Minus(Pair a, Pair b) { return _mm_sub_pd(a, b); }
+inline Pair Times(Pair a, Pair b) { return _mm_mul_pd(a, b); }
+#elif defined(BIQUAD_CASCADE_NEON)
+using Pair = float64x2_t;
+inline Pair Load(const double *p) { return vld1q_f64(p); }
+inline void Store(double *p, Pair v) { vst1q_f64(p, v); }
+inline Pair Make(double lane0, double lane1)
+   { return vsetq_lane_f64(lane1, vdupq_n_f64(lane0), 1); }
+inline Pair Plus(Pair a, Pair b) { return vaddq_f64(a, b); }
+inline Pair Minus(Pair a, Pair b) { return vsubq_f64(a, b); }
+inline Pair Times(Pair a, Pair b) { return vmulq_f64(a, b); }
+#else
+struct Pair { double lanes[2]; };
+inline Pair Load(const double *p) { return { { p[0], p[1] } }; }
+inline void Store(double *p, Pair v) { p[0] = v.lanes[0]; p[1] = v.lanes[1]; }
+inline Pair Make(double lane0, double lane1) { return { { lane0, lane1 } }; }
+inline Pair Plus(Pair a, Pair b)
+   { return { { a.lanes[0] + b.lanes[0], a.lanes[1] + b.lanes[1] } }; }
+inline Pair Minus(Pair a, Pair b)
+   { return { { a.lanes[0] - b.lanes[0], a.lanes[1] - b.lanes[1] } }; }
+inline Pair Times(Pair a, Pair b)
+   { return { { a.lanes[0] * b.lanes[0], a.lanes[1] * b.lanes[1] } }; }
+#endif
+
+//! Doubles of state per section and pair of channels
+constexpr size_t StateSize = 4;
+//! Doubles of coefficients per section, each repeated for both lanes
+constexpr size_t PairCoefficientsSize = 10;
+
+void ProcessPair(const double *coefficients, size_t nSections,
+   double *state, const float *in0, const float *in1,
+   float *out0, float *out1, size_t n)
+{
+   for (size_t i = 0; i < n; ++i) {
+      auto x = Make(in0[i], in1[i]);
+      auto pState = state;
+      auto pCoefficients = coefficients;
+      for (size_t k = 0; k < nSections;
+         ++k, pState += StateSize, pCoefficients += PairCoefficientsSize
+      ) {
+         const auto s1 = Load(pState), s2 = Load(pState + 2);
+         const auto b0 = Load(pCoefficients), b1 = Load(pCoefficients + 2),
+            b2 = Load(pCoefficients + 4), a1 = Load(pCoefficients + 6),
+            a2 = Load(pCoefficients + 8);
+         const auto y = Plus(Times(b0, x), s1);
+         Store(pState, Plus(Minus(Times(b1, x), Times(a1, y)), s2));
+         Store(pState + 2, Minus(Times(b2, x), Times(a2, y)));
+         x = y;
+      }
+      double y[2];
+      Store(y, x);
+      out0[i] = y[0];
+      out1[i] = y[1];
+   }
+}
+
+//! For an odd last channel, using the first lane of the state
+void ProcessOne(const std::vector<BiquadCascade::Section> &sections,
+   double *state, const float *in, float *out, size_t n)
+{
+   const auto nSections = sections.size();
+   for (size_t i = 0; i < n; ++i) {
+      double x = in[i];
+      auto pState = state;
+      for (size_t k = 0; k < nSections; ++k, pState += StateSize) {
+         const auto &section = sections[k];
+         const auto y = section.b0 * x + pState[0];
+         pState[0] = section.b1 * x - section.a1 * y + pState[2];
+         pState[2] = section.b2 * x - section.a2 * y;
+         x = y;
+      }
+      out[i] = x;
+   }
+}
+}
+
+BiquadCascade::BiquadCascade(std::vector<Section> sections, size_t nChannels)
+   : mSections{ std::move(sections) }
+   , mNChannels{ nChannels }
+   , mState((nChannels + 1) / 2 * mSections.size() * StateSize, 0.0)
+{
+   mPairCoefficients.reserve(mSections.size() * PairCoefficientsSize);
+   for (const auto &section : mSections)
+      for (auto coefficient :
+         { section.b0, section.b1, section.b2, section.a1, section.a2 }
+      ) {
+         mPairCoefficients.push_back(coefficient);
+         mPairCoefficients.push_back(coefficient);
+      }
+}
+
+void BiquadCascade::Reset()
+{
+   std::fill(mState.begin(), mState.end(), 0.0);
+}
+
+void BiquadCascade::Process(
+   const float *const *in, float *const *out, size_t n)
+{
+   const auto pairStateSize = mSections.size() * StateSize;
+   auto state = mState.data();
+   size_t c = 0;
+   for (; c + 2 <= mNChannels; c += 2, state += pairStateSize)
+      ProcessPair(mPairCoefficients.data(), mSections.size(), state,
+         in[c], in[c + 1], out[c], out[c + 1], n);
+   if (c < mNChannels)
+      ProcessOne(mSections, state, in[c], out[c], n);
+}
@@ -0,0 +1,56 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BiquadCascade.h
+  @brief Second order IIR sections in series, for several channels at once
+
+**********************************************************************/
+
+#ifndef __AUDACITY_BIQUAD_CASCADE__
+#define __AUDACITY_BIQUAD_CASCADE__
+
+#include <cstddef>
+#include <vector>
+
+//! Applies the same second order sections, one after another, to each of
+//! some channels, two channels at a time in SSE2 or NEON lanes where available
+/*!
+ Computes in double, in transposed direct form II, and rounds to float only
+ the output of the last section, so that high order cascades lose less
+ precision than a series of separate filters, each writing floats.
+ */
+class MATH_API BiquadCascade final
+{
+public:
+   //! Coefficients of one section, normalized so that a0 is 1
+   struct Section {
+      double b0{ 1 }, b1{ 0 }, b2{ 0 };
+      double a1{ 0 }, a2{ 0 };
+   };
+
+   BiquadCascade() = default;
+   BiquadCascade(std::vector<Section> sections, size_t nChannels);
+
+   size_t NSections() const { return mSections.size(); }
+   size_t NChannels() const { return mNChannels; }
+
+   //! Make all channels silent
+   void Reset();
+
+   //! Filter n samples of each channel, continuing from the previous call
+   /*! @pre `in[c]` and `out[c]` exist for each channel c, and each pair is
+    either the same array or does not overlap */
+   void Process(const float *const *in, float *const *out, size_t n);
+
+private:
+   std::vector<Section> mSections;
+   //! The coefficients of the sections in order, each repeated for two lanes
+   std::vector<double> mPairCoefficients;
+   size_t mNChannels{ 0 };
+   //! For each pair of channels, then each section: the two state variables,
+   //! each for two lanes; an odd last channel uses only one lane
+   std::vector<double> mState;
+};
+
+#endif
@@ -38,6 +38,7 @@ and get deterministic behaviour.
 #include "Dither.h"
 
 #include "Internat.h"
+#include "SampleConversion.h"
 #include "Prefs.h"
 
 // Erik de Castro Lopo's header file that
@@ -45,6 +46,7 @@ and get deterministic behaviour.
 // (Note: this file should be included first)
 #include "float_cast.h"
 
+#include <algorithm>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
@@ -63,19 +65,68 @@ constexpr int BUF_MASK = 7;
 // Lipshitz's minimally audible FIR
 const float SHAPED_BS[] = { 2.033f, -2.165f, 1.959f, -1.590f, 0.6149f };
 
-// Dither state
-struct State {
-    int mPhase;
-    float mTriangleState;
-    float mBuffer[8 /* = BUF_SIZE */];
-} mState;
-
-using Ditherer = float (*)(State &, float);
-
-// This is supposed to produce white noise and no dc
-static inline float DITHER_NOISE()
+using State = Dither::State;
+
+//! Samples dithered with each filling of the noise buffer
+constexpr size_t ChunkSize = 256;
+
+// Noise comes from independent xorshift generators, one in each lane of a
+// vector where available, so that it is the same with or without vector
+// instructions
+constexpr size_t NoiseLanes = 4;
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DITHER_SSE2
+#include <emmintrin.h>
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#define DITHER_NEON
+#include <arm_neon.h>
+#endif
+
+// Fill `noise` with white noise uniform in -0.5...0.5, with no dc, from the
+// high 23 bits of each number, as mantissa of a float in 1.0...2.0
+// @pre `count` is a multiple of NoiseLanes
+static void FillNoise(State &state, float *noise, size_t count)
 {
-    return rand() / (float)RAND_MAX - 0.5f;
+    size_t i = 0;
+#if defined(DITHER_SSE2)
+    auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state.mSeeds));
+    const auto one = _mm_set1_epi32(0x3F800000);
+    const auto half = _mm_set1_ps(1.5f);
+    for (; i < count; i += NoiseLanes) {
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+        const auto mantissa = _mm_or_si128(_mm_srli_epi32(x, 9), one);
+        _mm_storeu_ps(noise + i, _mm_sub_ps(_mm_castsi128_ps(mantissa), half));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state.mSeeds), x);
+#elif defined(DITHER_NEON)
+    auto x = vld1q_u32(state.mSeeds);
+    const auto one = vdupq_n_u32(0x3F800000);
+    const auto half = vdupq_n_f32(1.5f);
+    for (; i < count; i += NoiseLanes) {
+        x = veorq_u32(x, vshlq_n_u32(x, 13));
+        x = veorq_u32(x, vshrq_n_u32(x, 17));
+        x = veorq_u32(x, vshlq_n_u32(x, 5));
+        const auto mantissa = vorrq_u32(vshrq_n_u32(x, 9), one);
+        vst1q_f32(noise + i, vsubq_f32(vreinterpretq_f32_u32(mantissa), half));
+    }
+    vst1q_u32(state.mSeeds, x);
+#else
+    for (; i < count; i += NoiseLanes)
+        for (size_t lane = 0; lane < NoiseLanes; ++lane) {
+            auto &x = state.mSeeds[lane];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            const uint32_t mantissa = (x >> 9) | 0x3F800000;
+            float value;
+            memcpy(&value, &mantissa, sizeof(value));
+            noise[i + lane] = value - 1.5f;
+        }
+#endif
 }
 
 // Defines for sample conversion
@@ -119,73 +170,132 @@ static inline void IMPLEMENT_STORE(
         *ptr = static_cast<dst_type>(x);
 }
 
-// Dither single float 'sample' and store it in pointer 'dst', using 'dither' as algorithm
-static inline void DITHER_TO_INT16(Ditherer dither, State &state,
-   short *dst, float sample)
+// Store a dithered sample, already scaled
+static inline void STORE_INT16(short *dst, float sample)
 {
-    IMPLEMENT_STORE<short>(dst,
-        dither(state, sample * CONVERT_DIV16),
-        short(-32768), short(32767));
+    IMPLEMENT_STORE<short>(dst, sample, short(-32768), short(32767));
 }
 
-// Dither single float 'sample' and store it in pointer 'dst', using 'dither' as algorithm
-static inline void DITHER_TO_INT24(Ditherer dither, State &state,
-   int *dst, float sample)
+static inline void STORE_INT24(int *dst, float sample)
 {
-    IMPLEMENT_STORE<int>(dst,
-        dither(state, sample * CONVERT_DIV24), -8388608, 8388607);
+    IMPLEMENT_STORE<int>(dst, sample, -8388608, 8388607);
 }
 
-// Implement one single dither step
+// Dither implementations, each taking its NoisePerSample values of noise
 
-// Implement a dithering loop
-template<typename srcType, typename dstType>
-static inline void DITHER_LOOP( Ditherer dither, State &state,
-    void (*store)(Ditherer, State &, dstType *, float),
-    float (*load)(const srcType *),
-    samplePtr dst, sampleFormat dstFormat, size_t dstStride,
-    constSamplePtr src, sampleFormat srcFormat, size_t srcStride, size_t len)
+// No dither, just return sample
+struct NoDither {
+    static constexpr size_t NoisePerSample = 0;
+    static inline float Apply(State &, float sample, const float *)
+    {
+        return sample;
+    }
+};
+
+// Rectangle dithering, apply one-step noise
+struct RectangleDither {
+    static constexpr size_t NoisePerSample = 1;
+    static inline float Apply(State &, float sample, const float *noise)
+    {
+        return sample - noise[0];
+    }
+};
+
+// Triangle dither - high pass filtered
+struct TriangleDither {
+    static constexpr size_t NoisePerSample = 1;
+    static inline float Apply(State &state, float sample, const float *noise)
+    {
+        float r = noise[0];
+        float result = sample + r - state.mTriangleState;
+        state.mTriangleState = r;
+
+        return result;
+    }
+};
+
+// Shaped dither
+struct ShapedDither {
+    static constexpr size_t NoisePerSample = 2;
+    static inline float Apply(State &state, float sample, const float *noise)
+    {
+        // Generate triangular dither, +-1 LSB, flat psd
+        float r = noise[0] + noise[1];
+        if(sample != sample)  // test for NaN
+           sample = 0; // and do the best we can with it
+
+        // Run FIR
+        float xe = sample + state.mBuffer[state.mPhase] * SHAPED_BS[0]
+            + state.mBuffer[(state.mPhase - 1) & BUF_MASK] * SHAPED_BS[1]
+            + state.mBuffer[(state.mPhase - 2) & BUF_MASK] * SHAPED_BS[2]
+            + state.mBuffer[(state.mPhase - 3) & BUF_MASK] * SHAPED_BS[3]
+            + state.mBuffer[(state.mPhase - 4) & BUF_MASK] * SHAPED_BS[4];
+
+        // Accumulate FIR and triangular noise
+        float result = xe + r;
+
+        // Roll buffer and store last error
+        state.mPhase = (state.mPhase + 1) & BUF_MASK;
+        state.mBuffer[state.mPhase] = xe - lrintf(result);
+
+        return result;
+    }
+};
+
+// Implement a dithering loop, for one kind of dither and pair of formats,
+// so that all of the steps for each sample are inlined; fill the noise for
+// a chunk of samples at a time
+template<typename Ditherer, typename srcType, typename dstType,
+    float (*load)(const srcType *), void (*store)(dstType *, float)>
+static void DITHER_LOOP(State &state, float scale,
+    samplePtr dst, size_t dstStride,
+    constSamplePtr src, size_t srcStride, size_t len)
 {
-    char *d;
-    const char *s;
-    unsigned int ii;
-    for (d = (char*)dst, s = (char*)src, ii = 0;
-        ii < len;
-        ii++, d += SAMPLE_SIZE(dstFormat) * dstStride,
-        s += SAMPLE_SIZE(srcFormat) * srcStride) {
-            store(dither, state, reinterpret_cast<dstType *>(d), load(reinterpret_cast<const srcType *>(s)));
+    auto d = reinterpret_cast<dstType *>(dst);
+    auto s = reinterpret_cast<const srcType *>(src);
+    float noise[ChunkSize * Ditherer::NoisePerSample + NoiseLanes];
+    for (size_t start = 0; start < len; start += ChunkSize) {
+        const auto count = std::min(ChunkSize, len - start);
+        if constexpr (Ditherer::NoisePerSample > 0) {
+            const auto noises = count * Ditherer::NoisePerSample;
+            FillNoise(state, noise,
+                (noises + NoiseLanes - 1) / NoiseLanes * NoiseLanes);
         }
+        const float *n = noise;
+        for (size_t ii = 0; ii < count;
+            ++ii, d += dstStride, s += srcStride,
+            n += Ditherer::NoisePerSample)
+            store(d, Ditherer::Apply(state, load(s) * scale, n));
+    }
 }
 
 // Implement a dither. There are only 3 cases where we must dither,
 // in all other cases, no dithering is necessary.
-static inline void DITHER( Ditherer dither, State &state,
+template<typename Ditherer>
+static inline void DITHER( State &state,
    samplePtr dst, sampleFormat dstFormat, size_t dstStride,
    constSamplePtr src, sampleFormat srcFormat, size_t srcStride, size_t len)
 {
     if (srcFormat == int24Sample && dstFormat == int16Sample)
-        DITHER_LOOP<int, short>(dither, state,
-            DITHER_TO_INT16, FROM_INT24, dst,
-            int16Sample, dstStride, src, int24Sample, srcStride, len);
+        DITHER_LOOP<Ditherer, int, short, FROM_INT24, STORE_INT16>(
+            state, CONVERT_DIV16, dst, dstStride, src, srcStride, len);
     else if (srcFormat == floatSample && dstFormat == int16Sample)
-        DITHER_LOOP<float, short>(dither, state,
-            DITHER_TO_INT16, FROM_FLOAT, dst,
-            int16Sample, dstStride, src, floatSample, srcStride, len);
+        DITHER_LOOP<Ditherer, float, short, FROM_FLOAT, STORE_INT16>(
+            state, CONVERT_DIV16, dst, dstStride, src, srcStride, len);
     else if (srcFormat == floatSample && dstFormat == int24Sample)
-        DITHER_LOOP<float, int>(dither, state,
-            DITHER_TO_INT24, FROM_FLOAT, dst,
-            int24Sample, dstStride, src, floatSample, srcStride, len);
+        DITHER_LOOP<Ditherer, float, int, FROM_FLOAT, STORE_INT24>(
+            state, CONVERT_DIV24, dst, dstStride, src, srcStride, len);
     else { wxASSERT(false); }
 }
 
 
-static inline float NoDither(State &, float sample);
-static inline float RectangleDither(State &, float sample);
-static inline float TriangleDither(State &state, float sample);
-static inline float ShapedDither(State &state, float sample);
-
 Dither::Dither()
+    : mState{}
 {
+    // Distinct nonzero seeds for the lanes of the noise generator
+    for (size_t lane = 0; lane < NoiseLanes; ++lane)
+        mState.mSeeds[lane] = 0x9E3779B9u * (lane + 1);
+
     // On startup, initialize dither by resetting values
     Reset();
 }
@@ -272,6 +382,16 @@ void Dither::Apply(enum DitherType ditherType,
             }
         }
     } else
+    if (destStride == 1 && sourceStride == 1 &&
+        (destFormat == floatSample ||
+         (destFormat == int24Sample && sourceFormat == int16Sample) ||
+         ditherType == DitherType::none) &&
+        CanConvertSamples(sourceFormat, destFormat))
+    {
+        // Contiguous samples with no dither, converted with vector
+        // instructions where available
+        ConvertSamples(source, sourceFormat, dest, destFormat, len);
+    } else
     if (destFormat == floatSample)
     {
         // No need to dither, just convert samples to float.
@@ -306,18 +426,18 @@ void Dither::Apply(enum DitherType ditherType,
         switch (ditherType)
         {
         case DitherType::none:
-            DITHER(NoDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            DITHER<NoDither>(mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::rectangle:
-            DITHER(RectangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            DITHER<RectangleDither>(mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::triangle:
             Reset(); // reset dither filter for this NEW conversion
-            DITHER(TriangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            DITHER<TriangleDither>(mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::shaped:
             Reset(); // reset dither filter for this NEW conversion
-            DITHER(ShapedDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            DITHER<ShapedDither>(mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         default:
             wxASSERT(false); // unknown dither algorithm
@@ -325,55 +445,6 @@ void Dither::Apply(enum DitherType ditherType,
     }
 }
 
-// Dither implementations
-
-// No dither, just return sample
-inline float NoDither(State &, float sample)
-{
-    return sample;
-}
-
-// Rectangle dithering, apply one-step noise
-inline float RectangleDither(State &, float sample)
-{
-    return sample - DITHER_NOISE();
-}
-
-// Triangle dither - high pass filtered
-inline float TriangleDither(State &state, float sample)
-{
-    float r = DITHER_NOISE();
-    float result = sample + r - state.mTriangleState;
-    state.mTriangleState = r;
-
-    return result;
-}
-
-// Shaped dither
-inline float ShapedDither(State &state, float sample)
-{
-    // Generate triangular dither, +-1 LSB, flat psd
-    float r = DITHER_NOISE() + DITHER_NOISE();
-    if(sample != sample)  // test for NaN
-       sample = 0; // and do the best we can with it
-
-    // Run FIR
-    float xe = sample + state.mBuffer[state.mPhase] * SHAPED_BS[0]
-        + state.mBuffer[(state.mPhase - 1) & BUF_MASK] * SHAPED_BS[1]
-        + state.mBuffer[(state.mPhase - 2) & BUF_MASK] * SHAPED_BS[2]
-        + state.mBuffer[(state.mPhase - 3) & BUF_MASK] * SHAPED_BS[3]
-        + state.mBuffer[(state.mPhase - 4) & BUF_MASK] * SHAPED_BS[4];
-
-    // Accumulate FIR and triangular noise
-    float result = xe + r;
-
-    // Roll buffer and store last error
-    state.mPhase = (state.mPhase + 1) & BUF_MASK;
-    state.mBuffer[state.mPhase] = xe - lrintf(result);
-
-    return result;
-}
-
 static const std::initializer_list<EnumValueSymbol> choicesDither{
    { XO("None") },
    { XO("Rectangle") },
@@ -12,6 +12,8 @@
 
 #include "SampleFormat.h"
 
+#include <cstdint>
+
 template< typename Enum > class EnumSetting;
 
 
@@ -44,6 +46,18 @@ public:
                unsigned int len,
                unsigned int sourceStride = 1,
                unsigned int destStride = 1);
+
+    //! What the dithers carry from sample to sample
+    struct State {
+        int mPhase;
+        float mTriangleState;
+        float mBuffer[8];
+        //! Lanes of the noise generator, which Reset() doesn't change
+        uint32_t mSeeds[4];
+    };
+
+private:
+    State mState;
 };
 
 #endif /* __AUDACITY_DITHER_H__ */
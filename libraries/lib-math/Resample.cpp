@@ -29,21 +29,131 @@
 
 #include <soxr.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+
+namespace {
+//! Identifies interchangeable soxr handles for constant rate resampling
+struct HandleKey {
+   int method;
+   double factor;
+
+   bool operator == (const HandleKey &other) const
+   {
+      return method == other.method && factor == other.factor;
+   }
+};
+
+soxrHandle MakeHandle(const HandleKey &key)
+{
+   const auto q_spec = soxr_quality_spec("\0\1\4\6"[key.method], 0);
+   return soxrHandle{ soxr_create(1, key.factor, 1, 0, 0, &q_spec, 0) };
+}
+
+//! Most handles kept in reserve, of all keys together
+constexpr size_t MaxSpares = 16;
+
+//! Makes soxr handles for constant rate resampling ahead of need, in
+//! another thread
+/*!
+ Designing the filters is the costly part of constructing such a Resample,
+ and a used handle can't be reset without repeating it, so handles are not
+ recycled; instead each one taken is replaced in the background, for the
+ next Resample with the same parameters, as when repositioning or for the
+ other channel of a track.  Variable rate handles are cheap and not pooled.
+ */
+class HandlePool {
+public:
+   static HandlePool &Get()
+   {
+      static HandlePool instance;
+      return instance;
+   }
+
+   ~HandlePool()
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mStopping = true;
+      }
+      mCondition.notify_one();
+      if (mThread.joinable())
+         mThread.join();
+   }
+
+   //! Return a spare handle, if there is one, or else make one now; either
+   //! way, make another spare later
+   soxrHandle Take(const HandleKey &key)
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (mRequests.size() < MaxSpares)
+            mRequests.push_back(key);
+         if (!mThread.joinable())
+            mThread = std::thread{ [this]{ Loop(); } };
+         const auto iter = std::find_if(mSpares.begin(), mSpares.end(),
+            [&](const auto &pair){ return pair.first == key; });
+         if (iter != mSpares.end()) {
+            auto result = move(iter->second);
+            mSpares.erase(iter);
+            mCondition.notify_one();
+            return result;
+         }
+      }
+      mCondition.notify_one();
+      return MakeHandle(key);
+   }
+
+private:
+   void Loop()
+   {
+      while (true) {
+         HandleKey key;
+         {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            mCondition.wait(lock,
+               [this]{ return mStopping || !mRequests.empty(); });
+            if (mStopping)
+               return;
+            key = mRequests.front();
+            mRequests.pop_front();
+         }
+         auto handle = MakeHandle(key);
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mSpares.emplace_front(key, move(handle));
+         if (mSpares.size() > MaxSpares)
+            mSpares.pop_back();
+      }
+   }
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::thread mThread;
+   //! Most recently made first
+   std::list<std::pair<HandleKey, soxrHandle>> mSpares;
+   std::deque<HandleKey> mRequests;
+   bool mStopping{ false };
+};
+}
+
 Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor)
 {
    this->SetMethod(useBestMethod);
-   soxr_quality_spec_t q_spec;
    if (dMinFactor == dMaxFactor)
    {
       mbWantConstRateResampling = true; // constant rate resampling
-      q_spec = soxr_quality_spec("\0\1\4\6"[mMethod], 0);
+      mHandle = HandlePool::Get().Take({ mMethod, dMinFactor });
    }
    else
    {
       mbWantConstRateResampling = false; // variable rate resampling
-      q_spec = soxr_quality_spec(SOXR_HQ, SOXR_VR);
+      const auto q_spec = soxr_quality_spec(SOXR_HQ, SOXR_VR);
+      mHandle.reset(soxr_create(1, dMinFactor, 1, 0, 0, &q_spec, 0));
    }
-   mHandle.reset(soxr_create(1, dMinFactor, 1, 0, 0, &q_spec, 0));
 }
 
 Resample::~Resample()
@@ -0,0 +1,371 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleCompression.cpp
+
+**********************************************************************/
+
+#include "SampleCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr uint8_t Magic[4] = { 'A', 'S', 'C', '1' };
+//! Header is the magic, the count of samples, and the Mode
+constexpr size_t HeaderBytes = CompressedSampleHeaderBytes + 1;
+
+//! Samples sharing one choice of predictor, shift, and Rice parameter
+constexpr size_t FrameLength = 4096;
+constexpr unsigned MaxOrder = 3;
+constexpr unsigned MaxRiceParameter = 32;
+//! A unary quotient this long is followed by the whole 64 bit value instead
+//! of a remainder
+constexpr unsigned EscapeQuotient = 48;
+
+//! Float samples that are integers after multiplication by this use
+//! Mode::ScaledFloat
+constexpr double FloatScale = 16777216.0;
+constexpr int64_t Int32Limit = int64_t{ 1 } << 31;
+
+//! How samples map to the integers that are coded
+enum class Mode : uint8_t {
+   //! int16Sample or int24Sample, as themselves
+   Integer,
+   //! floatSample, as their bits, so reordered that the mapping is monotonic
+   FloatBits,
+   //! floatSample, multiplied by FloatScale
+   ScaledFloat,
+};
+
+int64_t FloatKey(float value)
+{
+   int32_t bits;
+   memcpy(&bits, &value, sizeof(bits));
+   // Leave positive values, reverse the order of negative ones
+   return bits ^ ((bits >> 31) & 0x7FFFFFFF);
+}
+
+float KeyFloat(int64_t key)
+{
+   // The transformation is its own inverse
+   auto bits = static_cast<int32_t>(key);
+   bits ^= (bits >> 31) & 0x7FFFFFFF;
+   float value;
+   memcpy(&value, &bits, sizeof(value));
+   return value;
+}
+
+bool ScaleFloat(float value, int64_t &result)
+{
+   const double scaled = value * FloatScale;
+   // Fails also for NaN; and don't lose the sign of negative zero
+   if (!(std::fabs(scaled) < Int32Limit) || scaled != std::floor(scaled) ||
+       (value == 0 && std::signbit(value)))
+      return false;
+   result = static_cast<int64_t>(scaled);
+   return true;
+}
+
+Mode ChooseMode(
+   constSamplePtr src, sampleFormat format, size_t count,
+   std::vector<int64_t> &values)
+{
+   values.resize(count);
+   if (format == int16Sample) {
+      std::copy_n(reinterpret_cast<const int16_t*>(src), count, values.data());
+      return Mode::Integer;
+   }
+   if (format != floatSample) {
+      std::copy_n(reinterpret_cast<const int32_t*>(src), count, values.data());
+      return Mode::Integer;
+   }
+   const auto samples = reinterpret_cast<const float*>(src);
+   size_t ii = 0;
+   for (; ii < count && ScaleFloat(samples[ii], values[ii]); ++ii)
+      ;
+   if (ii == count)
+      return Mode::ScaledFloat;
+   std::transform(samples, samples + count, values.begin(), FloatKey);
+   return Mode::FloatBits;
+}
+
+uint64_t Magnitude(int64_t value)
+{
+   return value < 0 ? 0 - static_cast<uint64_t>(value) : value;
+}
+
+uint64_t ZigZag(int64_t value)
+{
+   return (static_cast<uint64_t>(value) << 1) ^
+      static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value)
+{
+   return static_cast<int64_t>((value >> 1) ^ (0 - (value & 1)));
+}
+
+//! Prediction of y[ii] by the polynomial of the given order, or less for the
+//! first samples of a frame; computed with wrap-around, so that damaged data
+//! can't cause overflow
+uint64_t Prediction(const int64_t *y, size_t ii, unsigned order)
+{
+   const auto at = [&](size_t back){ return static_cast<uint64_t>(y[ii - back]); };
+   switch (std::min<size_t>(order, ii)) {
+   case 0:
+      return 0;
+   case 1:
+      return at(1);
+   case 2:
+      return 2 * at(1) - at(2);
+   default:
+      return 3 * at(1) - 3 * at(2) + at(3);
+   }
+}
+
+class BitWriter {
+public:
+   explicit BitWriter(std::vector<uint8_t> &bytes) : mBytes{ bytes } {}
+
+   //! @pre `bits <= 32`
+   void Put(uint64_t value, unsigned bits)
+   {
+      mAccumulator = (mAccumulator << bits) |
+         (value & ((uint64_t{ 1 } << bits) - 1));
+      mCount += bits;
+      while (mCount >= 8) {
+         mCount -= 8;
+         mBytes.push_back(static_cast<uint8_t>(mAccumulator >> mCount));
+      }
+   }
+
+   void PutOnes(unsigned count)
+   {
+      for (; count > 32; count -= 32)
+         Put(~uint64_t{}, 32);
+      Put(~uint64_t{}, count);
+   }
+
+   void PutRice(uint64_t value, unsigned k)
+   {
+      const auto quotient = value >> k;
+      if (quotient >= EscapeQuotient) {
+         PutOnes(EscapeQuotient);
+         Put(value >> 32, 32);
+         Put(value, 32);
+      }
+      else {
+         PutOnes(quotient);
+         Put(0, 1);
+         Put(value, k);
+      }
+   }
+
+   void Flush()
+   {
+      if (mCount > 0)
+         Put(0, 8 - mCount);
+   }
+
+private:
+   std::vector<uint8_t> &mBytes;
+   uint64_t mAccumulator{};
+   unsigned mCount{};
+};
+
+class BitReader {
+public:
+   BitReader(const uint8_t *begin, const uint8_t *end)
+      : mPosition{ begin }, mEnd{ end }
+   {}
+
+   //! @pre `bits <= 32`
+   bool Get(unsigned bits, uint64_t &value)
+   {
+      while (mCount < bits) {
+         if (mPosition == mEnd)
+            return false;
+         mAccumulator = (mAccumulator << 8) | *mPosition++;
+         mCount += 8;
+      }
+      mCount -= bits;
+      value = (mAccumulator >> mCount) & ((uint64_t{ 1 } << bits) - 1);
+      return true;
+   }
+
+   bool GetRice(unsigned k, uint64_t &value)
+   {
+      uint64_t quotient = 0;
+      for (uint64_t bit; quotient < EscapeQuotient; ++quotient) {
+         if (!Get(1, bit))
+            return false;
+         if (!bit)
+            break;
+      }
+      uint64_t high, low;
+      if (quotient == EscapeQuotient) {
+         if (!(Get(32, high) && Get(32, low)))
+            return false;
+         value = (high << 32) | low;
+      }
+      else {
+         if (!Get(k, low))
+            return false;
+         value = (quotient << k) | low;
+      }
+      return true;
+   }
+
+private:
+   const uint8_t *mPosition;
+   const uint8_t *const mEnd;
+   uint64_t mAccumulator{};
+   unsigned mCount{};
+};
+
+void EncodeFrame(BitWriter &writer, const int64_t *x, size_t length,
+   std::vector<int64_t> &y, std::vector<uint64_t> &residuals)
+{
+   // Remove low bits that are zero in all samples
+   uint64_t bits = 0;
+   for (size_t ii = 0; ii < length; ++ii)
+      bits |= static_cast<uint64_t>(x[ii]);
+   unsigned shift = 0;
+   if (bits != 0)
+      while (!((bits >> shift) & 1))
+         ++shift;
+   for (size_t ii = 0; ii < length; ++ii)
+      y[ii] = x[ii] >> shift;
+
+   // Choose the predictor with least total error
+   uint64_t errors[MaxOrder + 1]{};
+   for (size_t ii = 0; ii < length; ++ii)
+      for (unsigned order = 0; order <= MaxOrder; ++order)
+         errors[order] += Magnitude(
+            y[ii] - static_cast<int64_t>(Prediction(y.data(), ii, order)));
+   const unsigned order = std::min_element(errors, errors + MaxOrder + 1)
+      - errors;
+
+   uint64_t total = 0;
+   for (size_t ii = 0; ii < length; ++ii)
+      total += residuals[ii] = ZigZag(
+         y[ii] - static_cast<int64_t>(Prediction(y.data(), ii, order)));
+
+   // A Rice parameter near the log of the mean is near optimal
+   unsigned k = 0;
+   while (k < MaxRiceParameter && (uint64_t{ length } << (k + 1)) <= total)
+      ++k;
+
+   writer.Put(order, 8);
+   writer.Put(shift, 8);
+   writer.Put(k, 8);
+   for (size_t ii = 0; ii < length; ++ii)
+      writer.PutRice(residuals[ii], k);
+}
+
+bool Store(Mode mode, sampleFormat format, samplePtr dest, size_t ii,
+   int64_t value)
+{
+   if (format == int16Sample) {
+      if (value < INT16_MIN || value > INT16_MAX)
+         return false;
+      reinterpret_cast<int16_t*>(dest)[ii] = static_cast<int16_t>(value);
+      return true;
+   }
+   if (value < -Int32Limit || value >= Int32Limit)
+      return false;
+   if (format != floatSample)
+      reinterpret_cast<int32_t*>(dest)[ii] = static_cast<int32_t>(value);
+   else if (mode == Mode::ScaledFloat)
+      reinterpret_cast<float*>(dest)[ii] =
+         static_cast<float>(value / FloatScale);
+   else
+      reinterpret_cast<float*>(dest)[ii] = KeyFloat(value);
+   return true;
+}
+}
+
+std::vector<uint8_t> CompressSamples(
+   constSamplePtr src, sampleFormat format, size_t count)
+{
+   const auto rawBytes = count * SAMPLE_SIZE(format);
+   if (count == 0 || count > UINT32_MAX)
+      return {};
+
+   std::vector<int64_t> values;
+   const auto mode = ChooseMode(src, format, count, values);
+
+   std::vector<uint8_t> result;
+   result.reserve(rawBytes);
+   result.insert(result.end(), std::begin(Magic), std::end(Magic));
+   for (unsigned byte = 0; byte < 4; ++byte)
+      result.push_back(static_cast<uint8_t>(count >> (8 * byte)));
+   result.push_back(static_cast<uint8_t>(mode));
+
+   BitWriter writer{ result };
+   std::vector<int64_t> y(FrameLength);
+   std::vector<uint64_t> residuals(FrameLength);
+   for (size_t start = 0; start < count; start += FrameLength) {
+      EncodeFrame(writer, values.data() + start,
+         std::min(FrameLength, count - start), y, residuals);
+      if (result.size() >= rawBytes)
+         return {};
+   }
+   writer.Flush();
+   if (result.size() >= rawBytes)
+      return {};
+   return result;
+}
+
+size_t CompressedSampleCount(const void *data, size_t size)
+{
+   const auto bytes = static_cast<const uint8_t*>(data);
+   if (size < CompressedSampleHeaderBytes ||
+       !std::equal(std::begin(Magic), std::end(Magic), bytes))
+      return 0;
+   size_t count = 0;
+   for (unsigned byte = 0; byte < 4; ++byte)
+      count |= size_t{ bytes[4 + byte] } << (8 * byte);
+   return count;
+}
+
+bool DecompressSamples(const void *data, size_t size,
+   sampleFormat format, samplePtr dest, size_t count)
+{
+   const auto bytes = static_cast<const uint8_t*>(data);
+   if (size < HeaderBytes || CompressedSampleCount(data, size) != count ||
+       count == 0)
+      return false;
+   const auto mode = static_cast<Mode>(bytes[CompressedSampleHeaderBytes]);
+   if ((format == floatSample) == (mode == Mode::Integer) ||
+       mode > Mode::ScaledFloat)
+      return false;
+
+   BitReader reader{ bytes + HeaderBytes, bytes + size };
+   std::vector<int64_t> y(FrameLength);
+   for (size_t start = 0; start < count; start += FrameLength) {
+      const auto length = std::min(FrameLength, count - start);
+      uint64_t order, shift, k;
+      if (!(reader.Get(8, order) && reader.Get(8, shift) &&
+            reader.Get(8, k)) ||
+          order > MaxOrder || shift > 63 || k > MaxRiceParameter)
+         return false;
+      for (size_t ii = 0; ii < length; ++ii) {
+         uint64_t residual;
+         if (!reader.GetRice(k, residual))
+            return false;
+         y[ii] = static_cast<int64_t>(
+            Prediction(y.data(), ii, order) +
+            static_cast<uint64_t>(UnZigZag(residual)));
+         const auto value =
+            static_cast<int64_t>(static_cast<uint64_t>(y[ii]) << shift);
+         if ((value >> shift) != y[ii] ||
+             !Store(mode, format, dest, start + ii, value))
+            return false;
+      }
+   }
+   return true;
+}
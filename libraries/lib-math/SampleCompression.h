@@ -0,0 +1,49 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleCompression.h
+  @brief Lossless compression of blocks of samples
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_COMPRESSION__
+#define __AUDACITY_SAMPLE_COMPRESSION__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SampleFormat.h"
+
+//! Bytes at the start of compressed data, from which
+//! CompressedSampleCount() can find the number of samples
+constexpr size_t CompressedSampleHeaderBytes = 8;
+
+//! Losslessly compress samples
+/*!
+ Frames of samples are coded with the best of four fixed polynomial
+ predictors and Rice codes of the residuals.  Float samples that are exactly
+ integers scaled to 24 bits, as after import of integer files, compress like
+ integers; other floats compress less.
+
+ @return the compressed bytes, or empty if they would not be fewer than
+ `count * SAMPLE_SIZE(format)`
+ */
+MATH_API std::vector<uint8_t> CompressSamples(
+   constSamplePtr src, sampleFormat format, size_t count);
+
+//! @return the number of samples in data made by CompressSamples(), or 0 if
+//! `size` is less than CompressedSampleHeaderBytes or the data are not that
+MATH_API size_t CompressedSampleCount(const void *data, size_t size);
+
+//! Reverse CompressSamples()
+/*!
+ @param format must be that given to CompressSamples()
+ @param dest receives `count` samples
+ @return false if the data are damaged or hold other than `count` samples
+ */
+MATH_API bool DecompressSamples(const void *data, size_t size,
+   sampleFormat format, samplePtr dest, size_t count);
+
+#endif
@@ -0,0 +1,453 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleConversion.cpp
+
+**********************************************************************/
+
+#include "SampleConversion.h"
+
+#include "float_cast.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLE_CONVERSION_SSE2
+#include <emmintrin.h>
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#define SAMPLE_CONVERSION_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+constexpr auto Scale16 = float(1 << 15);
+constexpr auto Scale24 = float(1 << 23);
+constexpr int Min24 = -(1 << 23);
+constexpr int Max24 = (1 << 23) - 1;
+
+// Scalar kernels, which also finish what the vector kernels leave
+
+void Int16ToFloat(const short *src, float *dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = src[i] / Scale16;
+}
+
+void Int24ToFloat(const int *src, float *dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = src[i] / Scale24;
+}
+
+void Int16ToInt24(const short *src, int *dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = static_cast<int>(src[i]) << 8;
+}
+
+template<typename Integer>
+Integer Narrow(float sample, float scale, int min, int max)
+{
+   // Float samples may exceed 1.0 internally; clip before scaling
+   sample = sample > 1.0f ? 1.0f : sample < -1.0f ? -1.0f : sample;
+   const int x = lrintf(sample * scale);
+   return static_cast<Integer>(std::clamp(x, min, max));
+}
+
+void FloatToInt16(const float *src, short *dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = Narrow<short>(src[i], Scale16, -32768, 32767);
+}
+
+void FloatToInt24(const float *src, int *dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = Narrow<int>(src[i], Scale24, Min24, Max24);
+}
+
+void Int24ToInt16(const int *src, short *dst, size_t len)
+{
+   // As Dither::Apply() does, through float
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = Narrow<short>(src[i] / Scale24, Scale16, -32768, 32767);
+}
+
+int Unpack24(const unsigned char *src)
+{
+   const uint32_t bits = src[0] | (src[1] << 8) | (uint32_t { src[2] } << 16);
+   // Sign extend from the third byte
+   return static_cast<int32_t>(bits << 8) >> 8;
+}
+
+void UnpackToInt24(const unsigned char *src, int *dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = Unpack24(src + PackedInt24Bytes * i);
+}
+
+void UnpackToFloat(const unsigned char *src, float *dst, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      dst[i] = Unpack24(src + PackedInt24Bytes * i) / Scale24;
+}
+
+// Vector kernels convert a prefix of a multiple of 8 samples and return its
+// length
+
+#if defined(SAMPLE_CONVERSION_SSE2)
+
+size_t Int16ToFloatVector(const short *src, float *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(1.0f / Scale16);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      // Sign extend by shifting the samples into the high halves and back
+      const auto zero = _mm_setzero_si128();
+      const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(zero, x), 16);
+      const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(zero, x), 16);
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+   }
+   return i;
+}
+
+size_t Int24ToFloatVector(const int *src, float *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(1.0f / Scale24);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      const auto hi =
+         _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4));
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+   }
+   return i;
+}
+
+size_t Int16ToInt24Vector(const short *src, int *dst, size_t len)
+{
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      // The samples in the high halves, shifted back only by 8
+      const auto zero = _mm_setzero_si128();
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+         _mm_srai_epi32(_mm_unpacklo_epi16(zero, x), 8));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4),
+         _mm_srai_epi32(_mm_unpackhi_epi16(zero, x), 8));
+   }
+   return i;
+}
+
+//! Clip to -1.0...1.0, scale and round to nearest, as lrintf does in the
+//! default rounding mode
+inline __m128i Scale(__m128 x, __m128 scale)
+{
+   x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+   return _mm_cvtps_epi32(_mm_mul_ps(x, scale));
+}
+
+size_t FloatToInt16Vector(const float *src, short *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(Scale16);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      const auto lo = Scale(_mm_loadu_ps(src + i), scale);
+      const auto hi = Scale(_mm_loadu_ps(src + i + 4), scale);
+      // Saturation clips 32768 to 32767
+      _mm_storeu_si128(
+         reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(lo, hi));
+   }
+   return i;
+}
+
+size_t FloatToInt24Vector(const float *src, int *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(Scale24);
+   // Without SSE4.1 there is no minimum of 32 bit integers; compare instead
+   const auto max = _mm_set1_epi32(Max24);
+   const auto clip = [&](__m128i x) {
+      const auto over = _mm_cmpgt_epi32(x, max);
+      return _mm_or_si128(_mm_andnot_si128(over, x), _mm_and_si128(over, max));
+   };
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+         clip(Scale(_mm_loadu_ps(src + i), scale)));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4),
+         clip(Scale(_mm_loadu_ps(src + i + 4), scale)));
+   }
+   return i;
+}
+
+//! Four packed samples from 16 bytes, of which the last four are ignored
+inline __m128i Unpack4(const unsigned char *src)
+{
+   const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+   // Bring the samples to the low lanes of shifted copies, then gather those
+   const auto ab = _mm_unpacklo_epi32(x, _mm_srli_si128(x, 3));
+   const auto cd =
+      _mm_unpacklo_epi32(_mm_srli_si128(x, 6), _mm_srli_si128(x, 9));
+   // Sign extend by shifting the third bytes to the top and back
+   return _mm_srai_epi32(_mm_slli_epi32(_mm_unpacklo_epi64(ab, cd), 8), 8);
+}
+
+//! The last pair of loads may not read past the packed samples
+inline bool CanUnpack8(size_t i, size_t len)
+{
+   return PackedInt24Bytes * i + 12 + 16 <= PackedInt24Bytes * len;
+}
+
+size_t UnpackToInt24Vector(const unsigned char *src, int *dst, size_t len)
+{
+   size_t i = 0;
+   for (; CanUnpack8(i, len); i += 8) {
+      const auto p = src + PackedInt24Bytes * i;
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), Unpack4(p));
+      _mm_storeu_si128(
+         reinterpret_cast<__m128i *>(dst + i + 4), Unpack4(p + 12));
+   }
+   return i;
+}
+
+size_t UnpackToFloatVector(const unsigned char *src, float *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(1.0f / Scale24);
+   size_t i = 0;
+   for (; CanUnpack8(i, len); i += 8) {
+      const auto p = src + PackedInt24Bytes * i;
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(Unpack4(p)), scale));
+      _mm_storeu_ps(dst + i + 4,
+         _mm_mul_ps(_mm_cvtepi32_ps(Unpack4(p + 12)), scale));
+   }
+   return i;
+}
+
+#elif defined(SAMPLE_CONVERSION_NEON)
+
+size_t Int16ToFloatVector(const short *src, float *dst, size_t len)
+{
+   const auto scale = 1.0f / Scale16;
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      const auto x = vld1q_s16(src + i);
+      vst1q_f32(dst + i,
+         vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+      vst1q_f32(dst + i + 4,
+         vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+   }
+   return i;
+}
+
+size_t Int24ToFloatVector(const int *src, float *dst, size_t len)
+{
+   const auto scale = 1.0f / Scale24;
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      vst1q_f32(dst + i,
+         vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i)), scale));
+      vst1q_f32(dst + i + 4,
+         vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i + 4)), scale));
+   }
+   return i;
+}
+
+size_t Int16ToInt24Vector(const short *src, int *dst, size_t len)
+{
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      const auto x = vld1q_s16(src + i);
+      vst1q_s32(dst + i, vshll_n_s16(vget_low_s16(x), 8));
+      vst1q_s32(dst + i + 4, vshll_n_s16(vget_high_s16(x), 8));
+   }
+   return i;
+}
+
+//! Clip to -1.0...1.0, scale and round to nearest
+inline int32x4_t Scale(float32x4_t x, float scale)
+{
+   x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+   return vcvtnq_s32_f32(vmulq_n_f32(x, scale));
+}
+
+size_t FloatToInt16Vector(const float *src, short *dst, size_t len)
+{
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      // Saturation clips 32768 to 32767
+      vst1q_s16(dst + i, vcombine_s16(
+         vqmovn_s32(Scale(vld1q_f32(src + i), Scale16)),
+         vqmovn_s32(Scale(vld1q_f32(src + i + 4), Scale16))));
+   }
+   return i;
+}
+
+size_t FloatToInt24Vector(const float *src, int *dst, size_t len)
+{
+   const auto max = vdupq_n_s32(Max24);
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      vst1q_s32(dst + i, vminq_s32(Scale(vld1q_f32(src + i), Scale24), max));
+      vst1q_s32(dst + i + 4,
+         vminq_s32(Scale(vld1q_f32(src + i + 4), Scale24), max));
+   }
+   return i;
+}
+
+//! Eight packed samples, deinterleaved into their low, middle and high bytes
+inline int32x4x2_t Unpack8(const unsigned char *src)
+{
+   const auto bytes = vld3_u8(src);
+   const auto low =
+      vorrq_u16(vmovl_u8(bytes.val[0]), vshll_n_u8(bytes.val[1], 8));
+   // The high bytes carry the sign
+   const auto high = vmovl_s8(vreinterpret_s8_u8(bytes.val[2]));
+   return { {
+      vorrq_s32(vshll_n_s16(vget_low_s16(high), 16),
+         vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low)))),
+      vorrq_s32(vshll_n_s16(vget_high_s16(high), 16),
+         vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low)))) } };
+}
+
+size_t UnpackToInt24Vector(const unsigned char *src, int *dst, size_t len)
+{
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      const auto x = Unpack8(src + PackedInt24Bytes * i);
+      vst1q_s32(dst + i, x.val[0]);
+      vst1q_s32(dst + i + 4, x.val[1]);
+   }
+   return i;
+}
+
+size_t UnpackToFloatVector(const unsigned char *src, float *dst, size_t len)
+{
+   const auto scale = 1.0f / Scale24;
+   size_t i = 0;
+   for (; i + 8 <= len; i += 8) {
+      const auto x = Unpack8(src + PackedInt24Bytes * i);
+      vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(x.val[0]), scale));
+      vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(x.val[1]), scale));
+   }
+   return i;
+}
+
+#else
+
+// No vector instructions; the scalar kernels do all
+size_t Int16ToFloatVector(const short *, float *, size_t) { return 0; }
+size_t Int24ToFloatVector(const int *, float *, size_t) { return 0; }
+size_t Int16ToInt24Vector(const short *, int *, size_t) { return 0; }
+size_t FloatToInt16Vector(const float *, short *, size_t) { return 0; }
+size_t FloatToInt24Vector(const float *, int *, size_t) { return 0; }
+size_t UnpackToInt24Vector(const unsigned char *, int *, size_t) { return 0; }
+size_t UnpackToFloatVector(const unsigned char *, float *, size_t)
+{
+   return 0;
+}
+
+#endif
+
+template<bool vector>
+void Convert(constSamplePtr src, sampleFormat srcFormat,
+   samplePtr dst, sampleFormat dstFormat, size_t len)
+{
+   // Apply a vector kernel if there is one, then finish with the scalar one
+   const auto convert = [&](auto vectorKernel, auto scalarKernel,
+      auto *s, auto *d) {
+      size_t done = 0;
+      if constexpr (vector)
+         done = vectorKernel(s, d, len);
+      scalarKernel(s + done, d + done, len - done);
+   };
+   const auto s16 = reinterpret_cast<const short *>(src);
+   const auto s24 = reinterpret_cast<const int *>(src);
+   const auto sf = reinterpret_cast<const float *>(src);
+   const auto d16 = reinterpret_cast<short *>(dst);
+   const auto d24 = reinterpret_cast<int *>(dst);
+   const auto df = reinterpret_cast<float *>(dst);
+   if (srcFormat == int16Sample && dstFormat == floatSample)
+      convert(Int16ToFloatVector, Int16ToFloat, s16, df);
+   else if (srcFormat == int24Sample && dstFormat == floatSample)
+      convert(Int24ToFloatVector, Int24ToFloat, s24, df);
+   else if (srcFormat == int16Sample && dstFormat == int24Sample)
+      convert(Int16ToInt24Vector, Int16ToInt24, s16, d24);
+   else if (srcFormat == floatSample && dstFormat == int16Sample)
+      convert(FloatToInt16Vector, FloatToInt16, sf, d16);
+   else if (srcFormat == floatSample && dstFormat == int24Sample)
+      convert(FloatToInt24Vector, FloatToInt24, sf, d24);
+   else if (srcFormat == int24Sample && dstFormat == int16Sample)
+      Int24ToInt16(s24, d16, len);
+}
+
+template<bool vector>
+void Unpack(constSamplePtr src, samplePtr dst, sampleFormat dstFormat,
+   size_t len)
+{
+   const auto s = reinterpret_cast<const unsigned char *>(src);
+   size_t done = 0;
+   if (dstFormat == int24Sample) {
+      const auto d = reinterpret_cast<int *>(dst);
+      if constexpr (vector)
+         done = UnpackToInt24Vector(s, d, len);
+      UnpackToInt24(s + PackedInt24Bytes * done, d + done, len - done);
+   }
+   else if (dstFormat == floatSample) {
+      const auto d = reinterpret_cast<float *>(dst);
+      if constexpr (vector)
+         done = UnpackToFloatVector(s, d, len);
+      UnpackToFloat(s + PackedInt24Bytes * done, d + done, len - done);
+   }
+}
+}
+
+bool CanConvertSamples(sampleFormat srcFormat, sampleFormat dstFormat)
+{
+   const auto known = [](sampleFormat format) {
+      return format == int16Sample || format == int24Sample ||
+         format == floatSample;
+   };
+   return known(srcFormat) && known(dstFormat) && srcFormat != dstFormat;
+}
+
+void ConvertSamples(constSamplePtr src, sampleFormat srcFormat,
+   samplePtr dst, sampleFormat dstFormat, size_t len)
+{
+   Convert<true>(src, srcFormat, dst, dstFormat, len);
+}
+
+void ConvertSamplesScalar(constSamplePtr src, sampleFormat srcFormat,
+   samplePtr dst, sampleFormat dstFormat, size_t len)
+{
+   Convert<false>(src, srcFormat, dst, dstFormat, len);
+}
+
+void PackInt24Samples(constSamplePtr src, samplePtr dst, size_t len)
+{
+   const auto s = reinterpret_cast<const int *>(src);
+   const auto d = reinterpret_cast<unsigned char *>(dst);
+   for (size_t i = 0; i < len; ++i) {
+      const auto bits = static_cast<uint32_t>(s[i]);
+      d[PackedInt24Bytes * i] = bits & 0xFF;
+      d[PackedInt24Bytes * i + 1] = (bits >> 8) & 0xFF;
+      d[PackedInt24Bytes * i + 2] = (bits >> 16) & 0xFF;
+   }
+}
+
+void UnpackInt24Samples(constSamplePtr src,
+   samplePtr dst, sampleFormat dstFormat, size_t len)
+{
+   Unpack<true>(src, dst, dstFormat, len);
+}
+
+void UnpackInt24SamplesScalar(constSamplePtr src,
+   samplePtr dst, sampleFormat dstFormat, size_t len)
+{
+   Unpack<false>(src, dst, dstFormat, len);
+}
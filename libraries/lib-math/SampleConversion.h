@@ -0,0 +1,54 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleConversion.h
+  @brief Conversion of contiguous samples between formats, without dither
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_CONVERSION__
+#define __AUDACITY_SAMPLE_CONVERSION__
+
+#include "SampleFormat.h"
+
+//! Whether ConvertSamples() can convert from `srcFormat` to `dstFormat`
+/*! True for all pairs of known, distinct formats */
+MATH_API bool CanConvertSamples(sampleFormat srcFormat, sampleFormat dstFormat);
+
+//! Convert `len` contiguous samples, as Dither::Apply() does without dither
+/*!
+ Integers widen exactly.  Floats narrow with clipping to -1.0...1.0 and
+ rounding to nearest.
+ Uses SSE2 or NEON instructions where available.
+
+ @pre `CanConvertSamples(srcFormat, dstFormat)`
+ */
+MATH_API void ConvertSamples(constSamplePtr src, sampleFormat srcFormat,
+   samplePtr dst, sampleFormat dstFormat, size_t len);
+
+//! Same results as ConvertSamples() with no vector instructions
+MATH_API void ConvertSamplesScalar(constSamplePtr src, sampleFormat srcFormat,
+   samplePtr dst, sampleFormat dstFormat, size_t len);
+
+//! Bytes of each sample packed by PackInt24Samples(), as SAMPLE_SIZE_DISK()
+constexpr size_t PackedInt24Bytes = 3;
+
+//! Store `len` int24Sample values in PackedInt24Bytes little endian bytes each
+MATH_API void PackInt24Samples(constSamplePtr src, samplePtr dst, size_t len);
+
+//! Reverse PackInt24Samples(), with sign extension
+/*!
+ Makes float samples as ConvertSamples() does from int24Sample.
+ Uses SSE2 or NEON instructions where available.
+
+ @pre `dstFormat == int24Sample || dstFormat == floatSample`
+ */
+MATH_API void UnpackInt24Samples(constSamplePtr src,
+   samplePtr dst, sampleFormat dstFormat, size_t len);
+
+//! Same results as UnpackInt24Samples() with no vector instructions
+MATH_API void UnpackInt24SamplesScalar(constSamplePtr src,
+   samplePtr dst, sampleFormat dstFormat, size_t len);
+
+#endif
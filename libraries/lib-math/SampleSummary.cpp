@@ -0,0 +1,146 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleSummary.cpp
+
+**********************************************************************/
+
+#include "SampleSummary.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLE_SUMMARY_SSE2
+#include <emmintrin.h>
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#define SAMPLE_SUMMARY_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+struct Accumulation {
+   float min;
+   float max;
+   float sumsq;
+   float sum;
+};
+
+//! @pre `length > 0`
+Accumulation AccumulateScalar(const float *samples, size_t length)
+{
+   Accumulation result{
+      samples[0], samples[0], samples[0] * samples[0], samples[0] };
+   for (size_t i = 1; i < length; ++i) {
+      const auto sample = samples[i];
+      result.sumsq += sample * sample;
+      result.sum += sample;
+      if (sample < result.min)
+         result.min = sample;
+      else if (sample > result.max)
+         result.max = sample;
+   }
+   return result;
+}
+
+//! @pre `length > 0`
+Accumulation Accumulate(const float *samples, size_t length)
+{
+#if defined(SAMPLE_SUMMARY_SSE2) || defined(SAMPLE_SUMMARY_NEON)
+   constexpr size_t width = 4;
+   if (length < 2 * width)
+      return AccumulateScalar(samples, length);
+
+   // Four partial results in each vector
+   float mins[width], maxes[width], squares[width], sums[width];
+   size_t i = width;
+#if defined(SAMPLE_SUMMARY_SSE2)
+   auto value = _mm_loadu_ps(samples);
+   auto min = value, max = value;
+   auto sumsq = _mm_mul_ps(value, value);
+   auto sum = value;
+   for (; i + width <= length; i += width) {
+      value = _mm_loadu_ps(samples + i);
+      min = _mm_min_ps(min, value);
+      max = _mm_max_ps(max, value);
+      sumsq = _mm_add_ps(sumsq, _mm_mul_ps(value, value));
+      sum = _mm_add_ps(sum, value);
+   }
+   _mm_storeu_ps(mins, min);
+   _mm_storeu_ps(maxes, max);
+   _mm_storeu_ps(squares, sumsq);
+   _mm_storeu_ps(sums, sum);
+#else
+   auto value = vld1q_f32(samples);
+   auto min = value, max = value;
+   auto sumsq = vmulq_f32(value, value);
+   auto sum = value;
+   for (; i + width <= length; i += width) {
+      value = vld1q_f32(samples + i);
+      min = vminq_f32(min, value);
+      max = vmaxq_f32(max, value);
+      sumsq = vmlaq_f32(sumsq, value, value);
+      sum = vaddq_f32(sum, value);
+   }
+   vst1q_f32(mins, min);
+   vst1q_f32(maxes, max);
+   vst1q_f32(squares, sumsq);
+   vst1q_f32(sums, sum);
+#endif
+
+   Accumulation result{ mins[0], maxes[0], squares[0], sums[0] };
+   for (size_t lane = 1; lane < width; ++lane) {
+      result.min = std::min(result.min, mins[lane]);
+      result.max = std::max(result.max, maxes[lane]);
+      result.sumsq += squares[lane];
+      result.sum += sums[lane];
+   }
+   // Leftover samples
+   for (; i < length; ++i) {
+      const auto sample = samples[i];
+      result.sumsq += sample * sample;
+      result.sum += sample;
+      result.min = std::min(result.min, sample);
+      result.max = std::max(result.max, sample);
+   }
+   return result;
+#else
+   return AccumulateScalar(samples, length);
+#endif
+}
+
+template<Accumulation (*accumulate)(const float *, size_t)>
+double Summarize(const float *samples, size_t count, size_t frameLength,
+   float *dest, double *pSum)
+{
+   double totalSquares = 0.0;
+   double total = 0.0;
+   for (size_t start = 0; start < count; start += frameLength, dest += 3) {
+      const auto length = std::min(frameLength, count - start);
+      const auto [min, max, sumsq, sum] = accumulate(samples + start, length);
+      totalSquares += sumsq;
+      total += sum;
+      dest[0] = min;
+      dest[1] = max;
+      dest[2] = static_cast<float>(std::sqrt(sumsq / length));
+   }
+   if (pSum)
+      *pSum = total;
+   return totalSquares;
+}
+}
+
+double SummarizeSamples(const float *samples, size_t count,
+   size_t frameLength, float *dest, double *pSum)
+{
+   return Summarize<Accumulate>(samples, count, frameLength, dest, pSum);
+}
+
+double SummarizeSamplesScalar(const float *samples, size_t count,
+   size_t frameLength, float *dest, double *pSum)
+{
+   return Summarize<AccumulateScalar>(
+      samples, count, frameLength, dest, pSum);
+}
@@ -0,0 +1,34 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleSummary.h
+  @brief Minimum, maximum and RMS of consecutive frames of samples
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_SUMMARY__
+#define __AUDACITY_SAMPLE_SUMMARY__
+
+#include <cstddef>
+
+//! Write min, max and rms for each frame of `frameLength` samples
+/*!
+ The last frame may be shorter, and its rms is for its own length.
+ Uses SSE2 or NEON instructions where available.
+
+ @pre `frameLength > 0`
+ @param dest receives three floats for each of the
+ `(count + frameLength - 1) / frameLength` frames
+ @param pSum if not null, receives the sum of all samples
+ @return the sum of the squares of all samples
+ */
+MATH_API double SummarizeSamples(const float *samples, size_t count,
+   size_t frameLength, float *dest, double *pSum = nullptr);
+
+//! Same results as SummarizeSamples() (except for rounding of sums) with
+//! no vector instructions
+MATH_API double SummarizeSamplesScalar(const float *samples, size_t count,
+   size_t frameLength, float *dest, double *pSum = nullptr);
+
+#endif
@@ -0,0 +1,196 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file VectorOps.cpp
+
+**********************************************************************/
+
+#include "VectorOps.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECTOR_OPS_SSE2
+#include <emmintrin.h>
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#define VECTOR_OPS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+#if defined(VECTOR_OPS_SSE2)
+using Vector = __m128;
+inline Vector Load(const float *p) { return _mm_loadu_ps(p); }
+inline void Store(float *p, Vector v) { _mm_storeu_ps(p, v); }
+inline Vector Splat(float x) { return _mm_set1_ps(x); }
+inline Vector Plus(Vector a, Vector b) { return _mm_add_ps(a, b); }
+inline Vector Times(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+inline Vector Max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+inline Vector Abs(Vector a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+#elif defined(VECTOR_OPS_NEON)
+using Vector = float32x4_t;
+inline Vector Load(const float *p) { return vld1q_f32(p); }
+inline void Store(float *p, Vector v) { vst1q_f32(p, v); }
+inline Vector Splat(float x) { return vdupq_n_f32(x); }
+inline Vector Plus(Vector a, Vector b) { return vaddq_f32(a, b); }
+inline Vector Times(Vector a, Vector b) { return vmulq_f32(a, b); }
+inline Vector Max(Vector a, Vector b) { return vmaxq_f32(a, b); }
+inline Vector Abs(Vector a) { return vabsq_f32(a); }
+#else
+using Vector = float;
+inline Vector Load(const float *p) { return *p; }
+inline void Store(float *p, Vector v) { *p = v; }
+inline Vector Splat(float x) { return x; }
+inline Vector Plus(Vector a, Vector b) { return a + b; }
+inline Vector Times(Vector a, Vector b) { return a * b; }
+inline Vector Max(Vector a, Vector b) { return std::max(a, b); }
+inline Vector Abs(Vector a) { return std::abs(a); }
+#endif
+
+constexpr size_t Width = sizeof(Vector) / sizeof(float);
+
+//! Apply `vector` to each group of Width elements, then `scalar` to the
+//! leftovers
+template<typename VectorOp, typename ScalarOp>
+inline void Loop(size_t n, const VectorOp &vector, const ScalarOp &scalar)
+{
+   size_t i = 0;
+   for (; i + Width <= n; i += Width)
+      vector(i);
+   for (; i < n; ++i)
+      scalar(i);
+}
+}
+
+void VectorOps::Add(const float *src, float *dst, size_t n)
+{
+   Loop(n,
+      [&](size_t i){ Store(dst + i, Plus(Load(dst + i), Load(src + i))); },
+      [&](size_t i){ dst[i] += src[i]; });
+}
+
+void VectorOps::Multiply(const float *src, float *dst, size_t n)
+{
+   Loop(n,
+      [&](size_t i){ Store(dst + i, Times(Load(dst + i), Load(src + i))); },
+      [&](size_t i){ dst[i] *= src[i]; });
+}
+
+void VectorOps::MultiplyShifted(
+   const float *factors, float shift, float *dst, size_t n)
+{
+   const auto shifts = Splat(shift);
+   Loop(n,
+      [&](size_t i){ Store(dst + i,
+         Times(Load(dst + i), Plus(Load(factors + i), shifts))); },
+      [&](size_t i){ dst[i] *= factors[i] + shift; });
+}
+
+void VectorOps::MaxOfScaled(
+   const float *src, float scale, float floor, float *dst, size_t n)
+{
+   const auto scales = Splat(scale);
+   const auto floors = Splat(floor);
+   Loop(n,
+      [&](size_t i){ Store(dst + i, Max(Load(dst + i),
+         Max(floors, Times(Load(src + i), scales)))); },
+      [&](size_t i){
+         dst[i] = std::max(dst[i], std::max(floor, src[i] * scale)); });
+}
+
+void VectorOps::PowerSpectrum(
+   const float *re, const float *im, float *dst, size_t n)
+{
+   Loop(n,
+      [&](size_t i){
+         const auto r = Load(re + i), m = Load(im + i);
+         Store(dst + i, Plus(Times(r, r), Times(m, m)));
+      },
+      [&](size_t i){ dst[i] = re[i] * re[i] + im[i] * im[i]; });
+}
+
+void VectorOps::AccumulateLevels(const float *interleaved,
+   size_t nChannels, size_t nFrames, float *peaks, float *squares)
+{
+   if (nChannels == 0)
+      return;
+   if (Width % nChannels == 0) {
+      // Few channels:  each vector holds whole frames, so accumulate across
+      // the frames, then fold the lanes into the channels
+      const auto n = nChannels * nFrames;
+      auto peak = Splat(0), sum = Splat(0);
+      size_t i = 0;
+      for (; i + Width <= n; i += Width) {
+         const auto x = Load(interleaved + i);
+         peak = Max(peak, Abs(x));
+         sum = Plus(sum, Times(x, x));
+      }
+      float lanePeaks[Width], laneSums[Width];
+      Store(lanePeaks, peak);
+      Store(laneSums, sum);
+      for (size_t lane = 0; lane < Width; ++lane) {
+         const auto channel = lane % nChannels;
+         peaks[channel] = std::max(peaks[channel], lanePeaks[lane]);
+         squares[channel] += laneSums[lane];
+      }
+      for (; i < n; ++i) {
+         const auto channel = i % nChannels;
+         const auto x = interleaved[i];
+         peaks[channel] = std::max(peaks[channel], std::abs(x));
+         squares[channel] += x * x;
+      }
+      return;
+   }
+   // Many channels:  each vector holds some channels of one frame
+   for (size_t frame = 0; frame < nFrames; ++frame) {
+      const auto row = interleaved + frame * nChannels;
+      Loop(nChannels,
+         [&](size_t c){
+            const auto x = Load(row + c);
+            Store(peaks + c, Max(Load(peaks + c), Abs(x)));
+            Store(squares + c, Plus(Load(squares + c), Times(x, x)));
+         },
+         [&](size_t c){
+            peaks[c] = std::max(peaks[c], std::abs(row[c]));
+            squares[c] += row[c] * row[c];
+         });
+   }
+}
+
+void VectorOps::SinCycles(const double *cycles, float *dst, size_t n)
+{
+   // Reduce each phase to [-1/4, 1/4] cycles, where sine is odd and monotone,
+   // using sin(2 pi x) = sin(2 pi (+-1/2 - x))
+   for (size_t i = 0; i < n; ++i) {
+      auto x = cycles[i] - std::floor(cycles[i] + 0.5);
+      if (x > 0.25)
+         x = 0.5 - x;
+      else if (x < -0.25)
+         x = -0.5 - x;
+      dst[i] = x;
+   }
+
+   // Taylor series to the 11th power, truncated within 6e-8 on [-pi/2, pi/2]
+   constexpr float c1 = 2 * M_PI, c3 = -1.0f / 6, c5 = 1.0f / 120,
+      c7 = -1.0f / 5040, c9 = 1.0f / 362880, c11 = -1.0f / 39916800;
+   Loop(n,
+      [&](size_t i){
+         const auto t = Times(Load(dst + i), Splat(c1));
+         const auto t2 = Times(t, t);
+         auto p = Plus(Times(t2, Splat(c11)), Splat(c9));
+         p = Plus(Times(t2, p), Splat(c7));
+         p = Plus(Times(t2, p), Splat(c5));
+         p = Plus(Times(t2, p), Splat(c3));
+         p = Plus(Times(t2, p), Splat(1.0f));
+         Store(dst + i, Times(t, p));
+      },
+      [&](size_t i){
+         const auto t = dst[i] * c1;
+         const auto t2 = t * t;
+         dst[i] = t * (1.0f + t2 * (c3 + t2 * (c5 + t2 * (c7 + t2 *
+            (c9 + t2 * c11)))));
+      });
+}
@@ -0,0 +1,60 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file VectorOps.h
+  @brief Element-wise operations on arrays of floats, as on spectra
+
+**********************************************************************/
+
+#ifndef __AUDACITY_VECTOR_OPS__
+#define __AUDACITY_VECTOR_OPS__
+
+#include <cstddef>
+
+//! Loops over bins of spectra, using SSE2 or NEON instructions where
+//! available
+/*!
+ Results are the same as of the obvious scalar loops, except where noted.
+ Arrays need no alignment, and may be of any length.
+ */
+namespace VectorOps {
+
+//! `dst[i] += src[i]`
+MATH_API void Add(const float *src, float *dst, size_t n);
+
+//! `dst[i] *= src[i]`
+MATH_API void Multiply(const float *src, float *dst, size_t n);
+
+//! `dst[i] *= factors[i] + shift`
+MATH_API void MultiplyShifted(
+   const float *factors, float shift, float *dst, size_t n);
+
+//! `dst[i] = max(dst[i], max(floor, src[i] * scale))`
+/*! @pre src and dst do not overlap, or are the same */
+MATH_API void MaxOfScaled(
+   const float *src, float scale, float floor, float *dst, size_t n);
+
+//! `dst[i] = re[i] * re[i] + im[i] * im[i]`
+/*! Rounded in float, after each operation */
+MATH_API void PowerSpectrum(
+   const float *re, const float *im, float *dst, size_t n);
+
+//! For each channel c of interleaved frames, `peaks[c]` becomes the maximum
+//! of itself and the absolute values, and the squares are added to
+//! `squares[c]`
+/*! Sums are in float, in an order that may differ from the scalar loop, so
+ they are close to but not always the same as its results
+ */
+MATH_API void AccumulateLevels(const float *interleaved,
+   size_t nChannels, size_t nFrames, float *peaks, float *squares);
+
+//! `dst[i] = sin(2 * pi * cycles[i])`
+/*! By a polynomial, after reduction of the phases in double, so within
+ 1e-6 of the scalar result, however many cycles
+ */
+MATH_API void SinCycles(const double *cycles, float *dst, size_t n);
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WhiteNoise.cpp
+
+**********************************************************************/
+
+#include "WhiteNoise.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WHITE_NOISE_SSE2
+#include <emmintrin.h>
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#define WHITE_NOISE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+//! From the 24 high bits of a random word
+constexpr float Scale = 1.0f / (1 << 23);
+
+uint64_t SplitMix64(uint64_t &state)
+{
+   auto z = (state += 0x9E3779B97F4A7C15ull);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+   return z ^ (z >> 31);
+}
+}
+
+WhiteNoise::WhiteNoise(uint64_t seed)
+{
+   for (size_t lane = 0; lane < Lanes; ++lane) {
+      bool zero = true;
+      while (zero) {
+         for (size_t word = 0; word < 4; word += 2) {
+            const auto r = SplitMix64(seed);
+            mState[word][lane] = static_cast<uint32_t>(r);
+            mState[word + 1][lane] = static_cast<uint32_t>(r >> 32);
+         }
+         // The state of all zeroes is a fixed point
+         zero = !(mState[0][lane] | mState[1][lane] |
+            mState[2][lane] | mState[3][lane]);
+      }
+   }
+}
+
+void WhiteNoise::Generate(float *dst)
+{
+#if defined(WHITE_NOISE_SSE2)
+   const auto pState = reinterpret_cast<__m128i*>(mState);
+   const auto x = _mm_load_si128(pState), w = _mm_load_si128(pState + 3);
+   const auto t = _mm_xor_si128(x, _mm_slli_epi32(x, 11));
+   const auto next = _mm_xor_si128(_mm_xor_si128(w, _mm_srli_epi32(w, 19)),
+      _mm_xor_si128(t, _mm_srli_epi32(t, 8)));
+   _mm_store_si128(pState, _mm_load_si128(pState + 1));
+   _mm_store_si128(pState + 1, _mm_load_si128(pState + 2));
+   _mm_store_si128(pState + 2, w);
+   _mm_store_si128(pState + 3, next);
+   const auto values = _mm_cvtepi32_ps(_mm_srli_epi32(next, 8));
+   _mm_storeu_ps(dst,
+      _mm_sub_ps(_mm_mul_ps(values, _mm_set1_ps(Scale)), _mm_set1_ps(1.0f)));
+#elif defined(WHITE_NOISE_NEON)
+   const auto x = vld1q_u32(mState[0]), w = vld1q_u32(mState[3]);
+   const auto t = veorq_u32(x, vshlq_n_u32(x, 11));
+   const auto next = veorq_u32(veorq_u32(w, vshrq_n_u32(w, 19)),
+      veorq_u32(t, vshrq_n_u32(t, 8)));
+   vst1q_u32(mState[0], vld1q_u32(mState[1]));
+   vst1q_u32(mState[1], vld1q_u32(mState[2]));
+   vst1q_u32(mState[2], w);
+   vst1q_u32(mState[3], next);
+   const auto values = vcvtq_f32_u32(vshrq_n_u32(next, 8));
+   vst1q_f32(dst,
+      vsubq_f32(vmulq_n_f32(values, Scale), vdupq_n_f32(1.0f)));
+#else
+   for (size_t lane = 0; lane < Lanes; ++lane) {
+      const auto x = mState[0][lane], w = mState[3][lane];
+      const auto t = x ^ (x << 11);
+      const auto next = (w ^ (w >> 19)) ^ (t ^ (t >> 8));
+      mState[0][lane] = mState[1][lane];
+      mState[1][lane] = mState[2][lane];
+      mState[2][lane] = w;
+      mState[3][lane] = next;
+      dst[lane] = (next >> 8) * Scale - 1.0f;
+   }
+#endif
+}
+
+void WhiteNoise::Fill(float *dst, size_t n, float amplitude)
+{
+   size_t i = 0;
+   // Give out what was left over from the previous call
+   for (; i < n && mNSpare > 0; ++i)
+      dst[i] = amplitude * mSpare[Lanes - mNSpare--];
+   for (; i + Lanes <= n; i += Lanes) {
+      Generate(dst + i);
+      for (size_t lane = 0; lane < Lanes; ++lane)
+         dst[i + lane] *= amplitude;
+   }
+   if (i < n) {
+      Generate(mSpare);
+      mNSpare = Lanes;
+      for (; i < n; ++i)
+         dst[i] = amplitude * mSpare[Lanes - mNSpare--];
+   }
+}
@@ -0,0 +1,44 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WhiteNoise.h
+  @brief Uniform pseudo-random samples, several at once
+
+**********************************************************************/
+
+#ifndef __AUDACITY_WHITE_NOISE__
+#define __AUDACITY_WHITE_NOISE__
+
+#include <cstddef>
+#include <cstdint>
+
+//! Four xorshift128 generators in the lanes of SSE2 or NEON registers where
+//! available, interleaved into one stream of samples
+/*!
+ Not for cryptography.  Each lane has a period of 2^128 - 1, and the lanes
+ start from unrelated states, which the seed determines.  Unlike rand(), it
+ has no global state, so generators in different threads don't interfere.
+ */
+class MATH_API WhiteNoise final
+{
+public:
+   static constexpr size_t Lanes = 4;
+
+   explicit WhiteNoise(uint64_t seed = 0);
+
+   //! `dst[i]` uniform in [-amplitude, amplitude), continuing the stream
+   void Fill(float *dst, size_t n, float amplitude = 1.0f);
+
+private:
+   //! Next Lanes values in [-1, 1)
+   void Generate(float *dst);
+
+   //! The state words x, y, z, w of xorshift128, each for all lanes
+   alignas(16) uint32_t mState[4][Lanes];
+   //! Generated but not yet given out
+   float mSpare[Lanes]{};
+   size_t mNSpare{ 0 };
+};
+
+#endif
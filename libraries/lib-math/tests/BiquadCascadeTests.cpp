@@ -0,0 +1,215 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadCascadeTests.cpp
+
+**********************************************************************/
+#include "BiquadCascade.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<float> RandomSamples(size_t count, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   std::vector<float> samples(count);
+   for (auto& sample : samples)
+      sample = distribution(engine);
+   return samples;
+}
+
+//! Low pass sections of the Audio EQ Cookbook, at several frequencies
+std::vector<BiquadCascade::Section> LowPassSections(size_t count)
+{
+   std::vector<BiquadCascade::Section> sections;
+   for (size_t i = 0; i < count; ++i)
+   {
+      const double w0 = 2 * M_PI * (0.02 + 0.05 * i);
+      const double alpha = std::sin(w0) / (2 * (0.6 + 0.1 * i));
+      const double a0 = 1 + alpha;
+      const double cosw0 = std::cos(w0);
+      sections.push_back({ (1 - cosw0) / 2 / a0, (1 - cosw0) / a0,
+                           (1 - cosw0) / 2 / a0, -2 * cosw0 / a0,
+                           (1 - alpha) / a0 });
+   }
+   return sections;
+}
+
+//! Direct form I, in double, as in Biquad of the effects, but keeping double
+//! samples between the sections
+std::vector<float> Reference(
+   const std::vector<BiquadCascade::Section>& sections,
+   const std::vector<float>& input)
+{
+   std::vector<double> samples(input.begin(), input.end());
+   for (const auto& section : sections)
+   {
+      double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+      for (auto& sample : samples)
+      {
+         const double x = sample;
+         const double y = x * section.b0 + x1 * section.b1 +
+                          x2 * section.b2 - y1 * section.a1 - y2 * section.a2;
+         x2 = x1;
+         x1 = x;
+         y2 = y1;
+         y1 = y;
+         sample = y;
+      }
+   }
+   return { samples.begin(), samples.end() };
+}
+
+//! As a series of Biquad::Process calls filters one channel in place
+void SeparateBiquads(
+   const std::vector<BiquadCascade::Section>& sections, float* buffer,
+   size_t count)
+{
+   for (const auto& section : sections)
+   {
+      double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+      for (size_t i = 0; i < count; ++i)
+      {
+         const double x = buffer[i];
+         const double y = x * section.b0 + x1 * section.b1 +
+                          x2 * section.b2 - y1 * section.a1 - y2 * section.a2;
+         x2 = x1;
+         x1 = x;
+         y2 = y1;
+         y1 = y;
+         buffer[i] = y;
+      }
+   }
+}
+} // namespace
+
+TEST_CASE("BiquadCascade", "[BiquadCascade]")
+{
+   constexpr size_t count = 10000;
+
+   SECTION("Identity sections pass samples unchanged")
+   {
+      BiquadCascade cascade { std::vector<BiquadCascade::Section>(3), 1 };
+      const auto input = RandomSamples(count, 1);
+      std::vector<float> output(count);
+      const float* in[] { input.data() };
+      float* out[] { output.data() };
+      cascade.Process(in, out, count);
+      REQUIRE(output == input);
+   }
+
+   SECTION("Matches separate biquads for any count of channels")
+   {
+      const auto sections = LowPassSections(5);
+      for (size_t nChannels = 1; nChannels <= 5; ++nChannels)
+      {
+         BiquadCascade cascade { sections, nChannels };
+         std::vector<std::vector<float>> inputs, outputs;
+         for (size_t c = 0; c < nChannels; ++c)
+         {
+            inputs.push_back(RandomSamples(count, 10 + c));
+            outputs.emplace_back(count);
+         }
+
+         // In pieces of various lengths, continuing the state
+         size_t done = 0;
+         for (size_t len = 1; done < count; len = len * 3 + 1)
+         {
+            len = std::min(len, count - done);
+            std::vector<const float*> in;
+            std::vector<float*> out;
+            for (size_t c = 0; c < nChannels; ++c)
+            {
+               in.push_back(inputs[c].data() + done);
+               out.push_back(outputs[c].data() + done);
+            }
+            cascade.Process(in.data(), out.data(), len);
+            done += len;
+         }
+
+         for (size_t c = 0; c < nChannels; ++c)
+         {
+            const auto expected = Reference(sections, inputs[c]);
+            for (size_t i = 0; i < count; ++i)
+               REQUIRE(outputs[c][i] == Approx(expected[i]).margin(1e-6));
+         }
+      }
+   }
+
+   SECTION("Filters in place, and Reset forgets the state")
+   {
+      const auto sections = LowPassSections(2);
+      BiquadCascade cascade { sections, 2 };
+      auto left = RandomSamples(count, 3), right = RandomSamples(count, 4);
+      const auto expectedLeft = Reference(sections, left);
+      const auto expectedRight = Reference(sections, right);
+      float* channels[] { left.data(), right.data() };
+      const auto original = left;
+
+      cascade.Process(channels, channels, count);
+      for (size_t i = 0; i < count; ++i)
+      {
+         REQUIRE(left[i] == Approx(expectedLeft[i]).margin(1e-6));
+         REQUIRE(right[i] == Approx(expectedRight[i]).margin(1e-6));
+      }
+
+      cascade.Reset();
+      left = original;
+      cascade.Process(channels, channels, count);
+      REQUIRE(left[count - 1] == Approx(expectedLeft[count - 1]).margin(1e-6));
+   }
+}
+
+// Not run by default; select it with the tag
+TEST_CASE("BiquadCascade benchmark", "[.benchmark]")
+{
+   // About the size of one sample block
+   constexpr size_t count = 262144;
+   constexpr int repetitions = 20;
+
+   using namespace std::chrono;
+   for (size_t nSections : { 2, 5 })
+      for (size_t nChannels : { 1, 2, 8 })
+      {
+         const auto sections = LowPassSections(nSections);
+         std::vector<std::vector<float>> buffers;
+         for (size_t c = 0; c < nChannels; ++c)
+            buffers.push_back(RandomSamples(count, c));
+         std::vector<float*> pointers;
+         for (auto& buffer : buffers)
+            pointers.push_back(buffer.data());
+
+         const auto time = [&](auto process) {
+            const auto start = steady_clock::now();
+            for (int i = 0; i < repetitions; ++i)
+               process();
+            const auto elapsed = steady_clock::now() - start;
+            return duration_cast<duration<double, std::micro>>(elapsed)
+                      .count() /
+                   repetitions;
+         };
+
+         const auto separate = time([&] {
+            for (auto& buffer : buffers)
+               SeparateBiquads(sections, buffer.data(), count);
+         });
+         BiquadCascade cascade { sections, nChannels };
+         const auto cascaded = time([&] {
+            cascade.Process(pointers.data(), pointers.data(), count);
+         });
+         WARN(
+            "Microseconds per block, " << nSections << " sections, "
+               << nChannels << " channels: separate biquads " << separate
+               << ", cascade " << cascaded << ", speedup "
+               << separate / cascaded);
+      }
+}
@@ -0,0 +1,78 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DitherTests.cpp
+
+**********************************************************************/
+#include "Dither.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+std::vector<float> Tone(size_t count)
+{
+   std::vector<float> samples(count);
+   for (size_t ii = 0; ii < count; ++ii)
+      samples[ii] = 0.3f * std::sin(ii * 0.01f);
+   return samples;
+}
+
+//! Mean and rms of the error of quantization, in steps of 16 bits
+std::pair<double, double> Error(DitherType type, unsigned stride)
+{
+   const auto samples = Tone(100000);
+   std::vector<short> dest(samples.size() * stride);
+   Dither dither;
+   dither.Apply(type, reinterpret_cast<constSamplePtr>(samples.data()),
+      floatSample, reinterpret_cast<samplePtr>(dest.data()), int16Sample,
+      samples.size(), 1, stride);
+   double sum = 0, sumsq = 0;
+   for (size_t ii = 0; ii < samples.size(); ++ii)
+   {
+      const double error = dest[ii * stride] - samples[ii] * 32768.0;
+      sum += error;
+      sumsq += error * error;
+   }
+   return { sum / samples.size(), std::sqrt(sumsq / samples.size()) };
+}
+} // namespace
+
+TEST_CASE("Dither::Apply")
+{
+   SECTION("adds noise of the expected power and no dc")
+   {
+      // Rounding alone contributes sqrt(1/12); the uniform noise of
+      // rectangle dither as much again; triangle dither twice that
+      const std::pair<DitherType, double> expected[] {
+         { DitherType::none, std::sqrt(1.0 / 12) },
+         { DitherType::rectangle, std::sqrt(2.0 / 12) },
+         { DitherType::triangle, std::sqrt(3.0 / 12) },
+      };
+      for (const auto [type, rms] : expected)
+         for (const unsigned stride : { 1, 2 })
+         {
+            const auto [mean, actualRms] = Error(type, stride);
+            REQUIRE(std::abs(mean) < 0.01);
+            REQUIRE(actualRms == Approx(rms).epsilon(0.02));
+         }
+
+      // Shaped dither moves more noise to where it's less audible
+      const auto [mean, rms] = Error(DitherType::shaped, 1);
+      REQUIRE(std::abs(mean) < 0.01);
+      REQUIRE(rms > 1.0);
+      REQUIRE(rms < 3.0);
+   }
+
+   SECTION("is the same for interleaved and contiguous destinations")
+   {
+      for (auto type : { DitherType::none, DitherType::rectangle,
+              DitherType::triangle, DitherType::shaped })
+         REQUIRE(Error(type, 1) == Error(type, 2));
+   }
+}
@@ -0,0 +1,134 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleCompressionTests.cpp
+
+**********************************************************************/
+#include "SampleCompression.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+//! A noisy tone, like recorded audio
+std::vector<float> Tone(size_t count)
+{
+   std::mt19937 engine { 7 };
+   std::normal_distribution<float> noise { 0.0f, 0.001f };
+   std::vector<float> samples(count);
+   for (size_t ii = 0; ii < count; ++ii)
+      samples[ii] = 0.5f * std::sin(ii * 0.01f) + noise(engine);
+   return samples;
+}
+
+template<typename Sample>
+void RequireRoundTrip(const std::vector<Sample>& samples, sampleFormat format)
+{
+   const auto src = reinterpret_cast<constSamplePtr>(samples.data());
+   const auto compressed = CompressSamples(src, format, samples.size());
+   REQUIRE(!compressed.empty());
+   REQUIRE(compressed.size() < samples.size() * sizeof(Sample));
+   REQUIRE(CompressedSampleCount(compressed.data(), compressed.size()) ==
+           samples.size());
+
+   std::vector<Sample> decompressed(samples.size());
+   REQUIRE(DecompressSamples(compressed.data(), compressed.size(), format,
+      reinterpret_cast<samplePtr>(decompressed.data()), samples.size()));
+   // Compare bits, so that signs of zeros and NaNs count
+   REQUIRE(memcmp(decompressed.data(), samples.data(),
+      samples.size() * sizeof(Sample)) == 0);
+}
+} // namespace
+
+TEST_CASE("SampleCompression")
+{
+   // Include a partial last frame
+   constexpr size_t count = 10000;
+   const auto tone = Tone(count);
+
+   SECTION("int16 round trip")
+   {
+      std::vector<int16_t> samples(count);
+      for (size_t ii = 0; ii < count; ++ii)
+         samples[ii] = static_cast<int16_t>(tone[ii] * 32767);
+      samples[0] = std::numeric_limits<int16_t>::min();
+      samples[1] = std::numeric_limits<int16_t>::max();
+      RequireRoundTrip(samples, int16Sample);
+   }
+
+   SECTION("int24 round trip")
+   {
+      std::vector<int32_t> samples(count);
+      for (size_t ii = 0; ii < count; ++ii)
+         samples[ii] = static_cast<int32_t>(tone[ii] * 8388607);
+      samples[0] = -8388608;
+      samples[1] = 8388607;
+      RequireRoundTrip(samples, int24Sample);
+   }
+
+   SECTION("float round trip")
+   {
+      auto samples = tone;
+      samples[1] = -0.0f;
+      samples[2] = std::numeric_limits<float>::quiet_NaN();
+      samples[3] = -std::numeric_limits<float>::infinity();
+      samples[4] = std::numeric_limits<float>::denorm_min();
+      RequireRoundTrip(samples, floatSample);
+   }
+
+   SECTION("floats from integers compress like integers")
+   {
+      std::vector<float> samples(count);
+      for (size_t ii = 0; ii < count; ++ii)
+         samples[ii] = std::lround(tone[ii] * 32767) / 32768.0f;
+      RequireRoundTrip(samples, floatSample);
+      const auto compressed = CompressSamples(
+         reinterpret_cast<constSamplePtr>(samples.data()), floatSample, count);
+      REQUIRE(compressed.size() < count * sizeof(float) / 2);
+   }
+
+   SECTION("silence compresses to almost nothing")
+   {
+      const std::vector<float> samples(count, 0.0f);
+      RequireRoundTrip(samples, floatSample);
+   }
+
+   SECTION("incompressible samples are not compressed")
+   {
+      std::mt19937 engine { 3 };
+      std::vector<int16_t> samples(count);
+      for (auto& sample : samples)
+         sample = static_cast<int16_t>(engine());
+      REQUIRE(CompressSamples(reinterpret_cast<constSamplePtr>(samples.data()),
+         int16Sample, count).empty());
+   }
+
+   SECTION("damaged data are rejected")
+   {
+      const auto compressed = CompressSamples(
+         reinterpret_cast<constSamplePtr>(tone.data()), floatSample, count);
+      REQUIRE(!compressed.empty());
+      std::vector<float> dest(count);
+      const auto destPtr = reinterpret_cast<samplePtr>(dest.data());
+
+      // Truncated
+      REQUIRE(!DecompressSamples(compressed.data(), compressed.size() / 2,
+         floatSample, destPtr, count));
+      // Wrong count
+      REQUIRE(!DecompressSamples(compressed.data(), compressed.size(),
+         floatSample, destPtr, count - 1));
+      // Wrong format
+      REQUIRE(!DecompressSamples(compressed.data(), compressed.size(),
+         int16Sample, destPtr, count));
+      // Not compressed at all
+      REQUIRE(CompressedSampleCount(tone.data(), 4) == 0);
+   }
+}
@@ -0,0 +1,194 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleConversionTests.cpp
+
+**********************************************************************/
+#include "SampleConversion.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+const sampleFormat Formats[] { int16Sample, int24Sample, floatSample };
+
+const char* Name(sampleFormat format)
+{
+   return format == int16Sample ? "int16" :
+          format == int24Sample ? "int24" : "float";
+}
+
+//! Valid samples of the format, and for float, some beyond -1.0...1.0
+std::vector<char> RandomSamples(sampleFormat format, size_t count)
+{
+   std::mt19937 engine { 42 };
+   std::vector<char> result(count * SAMPLE_SIZE(format));
+   for (size_t i = 0; i < count; ++i)
+   {
+      const auto dest = result.data() + i * SAMPLE_SIZE(format);
+      if (format == int16Sample)
+      {
+         const short value = std::uniform_int_distribution<int> {
+            -32768, 32767 }(engine);
+         memcpy(dest, &value, sizeof(value));
+      }
+      else if (format == int24Sample)
+      {
+         const int value = std::uniform_int_distribution<int> {
+            -(1 << 23), (1 << 23) - 1 }(engine);
+         memcpy(dest, &value, sizeof(value));
+      }
+      else
+      {
+         const float value =
+            std::uniform_real_distribution<float> { -1.25f, 1.25f }(engine);
+         memcpy(dest, &value, sizeof(value));
+      }
+   }
+   return result;
+}
+} // namespace
+
+TEST_CASE("ConvertSamples")
+{
+   SECTION("agrees with the scalar loop")
+   {
+      // Include lengths shorter than a vector and partial last vectors
+      for (const size_t count : { 1, 7, 8, 9, 255, 1000 })
+         for (auto srcFormat : Formats)
+            for (auto dstFormat : Formats)
+            {
+               if (!CanConvertSamples(srcFormat, dstFormat))
+                  continue;
+               const auto source = RandomSamples(srcFormat, count);
+               std::vector<char> expected(count * SAMPLE_SIZE(dstFormat)),
+                  actual(expected.size());
+               ConvertSamplesScalar(source.data(), srcFormat,
+                  expected.data(), dstFormat, count);
+               ConvertSamples(source.data(), srcFormat,
+                  actual.data(), dstFormat, count);
+               REQUIRE(actual == expected);
+            }
+   }
+
+   SECTION("known values")
+   {
+      const std::vector<float> floats {
+         0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 1.0f / 65536 };
+      std::vector<short> shorts(floats.size());
+      ConvertSamples(reinterpret_cast<constSamplePtr>(floats.data()),
+         floatSample, reinterpret_cast<samplePtr>(shorts.data()),
+         int16Sample, floats.size());
+      REQUIRE(shorts ==
+         std::vector<short> { 0, 16384, -16384, 32767, -32768, 32767, -32768,
+            0 });
+
+      std::vector<int> ints(floats.size());
+      ConvertSamples(reinterpret_cast<constSamplePtr>(floats.data()),
+         floatSample, reinterpret_cast<samplePtr>(ints.data()),
+         int24Sample, floats.size());
+      REQUIRE(ints ==
+         std::vector<int> { 0, 1 << 22, -(1 << 22), (1 << 23) - 1, -(1 << 23),
+            (1 << 23) - 1, -(1 << 23), 1 << 7 });
+
+      ConvertSamples(reinterpret_cast<constSamplePtr>(shorts.data()),
+         int16Sample, reinterpret_cast<samplePtr>(ints.data()),
+         int24Sample, shorts.size());
+      REQUIRE(ints[1] == 16384 << 8);
+      REQUIRE(ints[4] == -32768 << 8);
+
+      std::vector<float> back(shorts.size());
+      ConvertSamples(reinterpret_cast<constSamplePtr>(shorts.data()),
+         int16Sample, reinterpret_cast<samplePtr>(back.data()),
+         floatSample, shorts.size());
+      REQUIRE(back[1] == 0.5f);
+      REQUIRE(back[4] == -1.0f);
+   }
+}
+
+TEST_CASE("PackInt24Samples")
+{
+   SECTION("unpacking reverses packing, and agrees with the scalar loop")
+   {
+      for (const size_t count : { 1, 7, 8, 9, 10, 11, 255, 1000 })
+      {
+         const auto source = RandomSamples(int24Sample, count);
+         std::vector<char> packed(count * PackedInt24Bytes);
+         PackInt24Samples(source.data(), packed.data(), count);
+         for (auto dstFormat : { int24Sample, floatSample })
+         {
+            std::vector<char> expected(count * SAMPLE_SIZE(dstFormat)),
+               scalar(expected.size()), actual(expected.size());
+            if (dstFormat == int24Sample)
+               expected = source;
+            else
+               ConvertSamples(source.data(), int24Sample,
+                  expected.data(), dstFormat, count);
+            UnpackInt24SamplesScalar(
+               packed.data(), scalar.data(), dstFormat, count);
+            UnpackInt24Samples(packed.data(), actual.data(), dstFormat, count);
+            REQUIRE(scalar == expected);
+            REQUIRE(actual == expected);
+         }
+      }
+   }
+
+   SECTION("known values")
+   {
+      const std::vector<int> ints {
+         0, 1, -1, (1 << 23) - 1, -(1 << 23), 0x123456, -0x123456, 256 };
+      std::vector<unsigned char> packed(ints.size() * PackedInt24Bytes);
+      PackInt24Samples(reinterpret_cast<constSamplePtr>(ints.data()),
+         reinterpret_cast<samplePtr>(packed.data()), ints.size());
+      REQUIRE(std::vector<unsigned char>(packed.begin(), packed.begin() + 9) ==
+         std::vector<unsigned char> { 0, 0, 0, 1, 0, 0, 0xFF, 0xFF, 0xFF });
+      REQUIRE(packed[15] == 0x56);
+      REQUIRE(packed[17] == 0x12);
+
+      std::vector<int> back(ints.size());
+      UnpackInt24Samples(reinterpret_cast<constSamplePtr>(packed.data()),
+         reinterpret_cast<samplePtr>(back.data()), int24Sample, ints.size());
+      REQUIRE(back == ints);
+   }
+}
+
+// Not run by default; select it with the tag
+TEST_CASE("ConvertSamples benchmark", "[.benchmark]")
+{
+   // About the size of one sample block
+   constexpr size_t count = 262144;
+   constexpr int repetitions = 200;
+
+   using namespace std::chrono;
+   for (auto srcFormat : Formats)
+      for (auto dstFormat : Formats)
+      {
+         if (!CanConvertSamples(srcFormat, dstFormat))
+            continue;
+         const auto source = RandomSamples(srcFormat, count);
+         std::vector<char> dest(count * SAMPLE_SIZE(dstFormat));
+         const auto time = [&](auto convert) {
+            const auto start = steady_clock::now();
+            for (int i = 0; i < repetitions; ++i)
+               convert(source.data(), srcFormat, dest.data(), dstFormat, count);
+            const auto elapsed = steady_clock::now() - start;
+            return duration_cast<duration<double, std::micro>>(elapsed)
+                      .count() /
+                   repetitions;
+         };
+
+         const auto scalar = time(ConvertSamplesScalar);
+         const auto simd = time(ConvertSamples);
+         WARN(
+            "Microseconds per block from " << Name(srcFormat) << " to "
+               << Name(dstFormat) << ": scalar " << scalar
+               << ", vector " << simd << ", speedup " << scalar / simd);
+      }
+}
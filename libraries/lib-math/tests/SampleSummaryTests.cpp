@@ -0,0 +1,102 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleSummaryTests.cpp
+
+**********************************************************************/
+#include "SampleSummary.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<float> RandomSamples(size_t count)
+{
+   std::mt19937 engine { 42 };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   std::vector<float> samples(count);
+   for (auto& sample : samples)
+      sample = distribution(engine);
+   return samples;
+}
+} // namespace
+
+TEST_CASE("SummarizeSamples")
+{
+   SECTION("agrees with the scalar loop")
+   {
+      // Include lengths shorter than a vector and partial last frames
+      for (const size_t count : { 1, 3, 7, 8, 255, 256, 257, 1000, 65536 })
+      {
+         const auto samples = RandomSamples(count);
+         const auto frames = (count + 255) / 256;
+         std::vector<float> expected(3 * frames), actual(3 * frames);
+         double expectedSum, actualSum;
+         const auto expectedTotal = SummarizeSamplesScalar(
+            samples.data(), count, 256, expected.data(), &expectedSum);
+         const auto actualTotal = SummarizeSamples(
+            samples.data(), count, 256, actual.data(), &actualSum);
+
+         REQUIRE(actualTotal == Approx(expectedTotal));
+         REQUIRE(actualSum == Approx(expectedSum).margin(1e-4));
+         for (size_t i = 0; i < frames; ++i)
+         {
+            REQUIRE(actual[3 * i] == expected[3 * i]);
+            REQUIRE(actual[3 * i + 1] == expected[3 * i + 1]);
+            REQUIRE(actual[3 * i + 2] == Approx(expected[3 * i + 2]));
+         }
+      }
+   }
+
+   SECTION("known values")
+   {
+      const std::vector<float> samples { 0.5f, -1.0f, 0.25f, 1.0f, 0.0f };
+      std::vector<float> summary(6);
+      double sum;
+      const auto total = SummarizeSamples(
+         samples.data(), samples.size(), 4, summary.data(), &sum);
+      REQUIRE(total == Approx(2.3125));
+      REQUIRE(sum == Approx(0.75));
+      REQUIRE(summary[0] == -1.0f);
+      REQUIRE(summary[1] == 1.0f);
+      REQUIRE(summary[2] == Approx(std::sqrt(2.3125 / 4)));
+      REQUIRE(summary[3] == 0.0f);
+      REQUIRE(summary[4] == 0.0f);
+      REQUIRE(summary[5] == 0.0f);
+   }
+}
+
+// Not run by default; select it with the tag
+TEST_CASE("SummarizeSamples benchmark", "[.benchmark]")
+{
+   // About the size of one sample block
+   constexpr size_t count = 262144;
+   constexpr int repetitions = 200;
+   const auto samples = RandomSamples(count);
+   std::vector<float> summary(3 * count / 256);
+
+   using namespace std::chrono;
+   const auto time = [&](auto summarize) {
+      double total = 0;
+      const auto start = steady_clock::now();
+      for (int i = 0; i < repetitions; ++i)
+         total += summarize(samples.data(), count, 256, summary.data(), nullptr);
+      const auto elapsed = steady_clock::now() - start;
+      REQUIRE(total > 0);
+      return duration_cast<duration<double, std::micro>>(elapsed).count() /
+             repetitions;
+   };
+
+   const auto scalar = time(SummarizeSamplesScalar);
+   const auto simd = time(SummarizeSamples);
+   WARN(
+      "Microseconds per block: scalar " << scalar << ", vector " << simd
+                                       << ", speedup " << scalar / simd);
+}
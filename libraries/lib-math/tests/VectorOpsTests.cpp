@@ -0,0 +1,142 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  VectorOpsTests.cpp
+
+**********************************************************************/
+#include "VectorOps.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<float> RandomSamples(size_t count, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   std::vector<float> samples(count);
+   for (auto& sample : samples)
+      sample = distribution(engine);
+   return samples;
+}
+} // namespace
+
+TEST_CASE("VectorOps")
+{
+   // Include lengths shorter than a vector and with leftovers
+   const size_t n = GENERATE(0, 1, 3, 4, 5, 8, 257, 1025);
+   const auto a = RandomSamples(n, 1);
+   const auto b = RandomSamples(n, 2);
+   auto actual = b, expected = b;
+
+   SECTION("Add")
+   {
+      VectorOps::Add(a.data(), actual.data(), n);
+      for (size_t i = 0; i < n; ++i)
+         expected[i] += a[i];
+      REQUIRE(actual == expected);
+   }
+
+   SECTION("Multiply")
+   {
+      VectorOps::Multiply(a.data(), actual.data(), n);
+      for (size_t i = 0; i < n; ++i)
+         expected[i] *= a[i];
+      REQUIRE(actual == expected);
+   }
+
+   SECTION("MultiplyShifted")
+   {
+      VectorOps::MultiplyShifted(a.data(), -1.0f, actual.data(), n);
+      for (size_t i = 0; i < n; ++i)
+         expected[i] *= a[i] - 1.0f;
+      REQUIRE(actual == expected);
+   }
+
+   SECTION("MaxOfScaled")
+   {
+      VectorOps::MaxOfScaled(a.data(), 0.9f, 0.1f, actual.data(), n);
+      for (size_t i = 0; i < n; ++i)
+         expected[i] = std::max(expected[i], std::max(0.1f, a[i] * 0.9f));
+      REQUIRE(actual == expected);
+   }
+
+   SECTION("MaxOfScaled in place")
+   {
+      VectorOps::MaxOfScaled(actual.data(), 0.5f, 0.0f, actual.data(), n);
+      for (size_t i = 0; i < n; ++i)
+         expected[i] = std::max(expected[i], std::max(0.0f, b[i] * 0.5f));
+      REQUIRE(actual == expected);
+   }
+
+   SECTION("PowerSpectrum agrees with double precision")
+   {
+      VectorOps::PowerSpectrum(a.data(), b.data(), actual.data(), n);
+      for (size_t i = 0; i < n; ++i) {
+         const double re = a[i], im = b[i];
+         REQUIRE(actual[i] == Approx(re * re + im * im).epsilon(1e-6));
+      }
+   }
+}
+
+TEST_CASE("VectorOps::AccumulateLevels")
+{
+   // Channels that fill vectors exactly, and that do not
+   const size_t nChannels = GENERATE(1, 2, 3, 4, 6, 64);
+   const size_t nFrames = GENERATE(0, 1, 3, 257);
+   const auto samples = RandomSamples(nChannels * nFrames, 3);
+   std::vector<float> peaks(nChannels, 0.5f), squares(nChannels, 1.0f);
+   auto expectedPeaks = peaks;
+   std::vector<double> expectedSquares(nChannels, 1.0);
+
+   VectorOps::AccumulateLevels(
+      samples.data(), nChannels, nFrames, peaks.data(), squares.data());
+   for (size_t frame = 0; frame < nFrames; ++frame)
+      for (size_t c = 0; c < nChannels; ++c) {
+         const double x = samples[frame * nChannels + c];
+         expectedPeaks[c] = std::max(expectedPeaks[c], std::abs(float(x)));
+         expectedSquares[c] += x * x;
+      }
+
+   REQUIRE(peaks == expectedPeaks);
+   for (size_t c = 0; c < nChannels; ++c)
+      REQUIRE(squares[c] == Approx(expectedSquares[c]).epsilon(1e-5));
+}
+
+TEST_CASE("VectorOps::SinCycles")
+{
+   const size_t n = GENERATE(0, 1, 3, 4, 5, 1025);
+   for (const double offset : { 0.0, -3.0, 1e6 + 0.125 })
+   {
+      std::vector<double> cycles(n);
+      for (size_t i = 0; i < n; ++i)
+         cycles[i] = offset + i * 0.0123457;
+      std::vector<float> actual(n);
+
+      VectorOps::SinCycles(cycles.data(), actual.data(), n);
+      for (size_t i = 0; i < n; ++i)
+         REQUIRE(actual[i] ==
+            Approx(std::sin(2 * M_PI * cycles[i])).margin(1e-6));
+   }
+
+   SECTION("Extremes and zeros are exact")
+   {
+      const double cycles[] { 0.0, 0.25, 0.5, 0.75, -0.25 };
+      float actual[5];
+      VectorOps::SinCycles(cycles, actual, 5);
+      REQUIRE(actual[0] == 0.0f);
+      REQUIRE(actual[1] == Approx(1.0f).margin(1e-7));
+      REQUIRE(actual[2] == 0.0f);
+      REQUIRE(actual[3] == Approx(-1.0f).margin(1e-7));
+      REQUIRE(actual[4] == Approx(-1.0f).margin(1e-7));
+      for (auto value : actual)
+         REQUIRE(std::abs(value) <= 1.0f);
+   }
+}
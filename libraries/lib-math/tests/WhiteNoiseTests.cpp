@@ -0,0 +1,80 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WhiteNoiseTests.cpp
+
+**********************************************************************/
+#include "WhiteNoise.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+TEST_CASE("WhiteNoise")
+{
+   constexpr size_t count = 1 << 16;
+
+   SECTION("Samples are uniform within the amplitude")
+   {
+      WhiteNoise noise { 1 };
+      std::vector<float> samples(count);
+      noise.Fill(samples.data(), count, 0.5f);
+
+      double sum = 0, squares = 0;
+      size_t below = 0;
+      for (auto sample : samples)
+      {
+         REQUIRE(sample >= -0.5f);
+         REQUIRE(sample < 0.5f);
+         sum += sample;
+         squares += sample * sample;
+         below += sample < 0;
+      }
+      // Mean 0 and variance 1/12 of the width squared
+      REQUIRE(sum / count == Approx(0).margin(0.01));
+      REQUIRE(squares / count == Approx(1.0 / 12).epsilon(0.02));
+      REQUIRE(below == Approx(count / 2).epsilon(0.02));
+   }
+
+   SECTION("Neighbouring samples are uncorrelated")
+   {
+      WhiteNoise noise { 2 };
+      std::vector<float> samples(count);
+      noise.Fill(samples.data(), count);
+      for (size_t lag = 1; lag <= 8; ++lag)
+      {
+         double product = 0;
+         for (size_t i = lag; i < count; ++i)
+            product += samples[i] * samples[i - lag];
+         REQUIRE(product / count == Approx(0).margin(0.01));
+      }
+   }
+
+   SECTION("The stream does not depend on the lengths of the calls")
+   {
+      WhiteNoise whole { 3 }, pieces { 3 };
+      std::vector<float> expected(1000), actual(1000);
+      whole.Fill(expected.data(), expected.size());
+      size_t done = 0;
+      for (size_t len = 1; done < actual.size(); len = len * 2 + 1)
+      {
+         len = std::min(len, actual.size() - done);
+         pieces.Fill(actual.data() + done, len);
+         done += len;
+      }
+      REQUIRE(actual == expected);
+   }
+
+   SECTION("Seeds give different streams")
+   {
+      WhiteNoise a { 4 }, b { 5 };
+      std::vector<float> x(64), y(64);
+      a.Fill(x.data(), x.size());
+      b.Fill(y.data(), y.size());
+      REQUIRE(x != y);
+   }
+}
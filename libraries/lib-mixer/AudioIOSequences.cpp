@@ -11,6 +11,11 @@
 
 PlayableSequence::~PlayableSequence() = default;
 
+bool PlayableSequence::IncludesRealtimeEffects() const
+{
+   return false;
+}
+
 RecordableSequence::~RecordableSequence() = default;
 
 OtherPlayableSequence::~OtherPlayableSequence() = default;
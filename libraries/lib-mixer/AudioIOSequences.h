@@ -30,6 +30,11 @@ struct MIXER_API PlayableSequence : WideSampleSequence {
 
    //! May vary asynchronously
    virtual bool GetMute() const = 0;
+
+   //! Whether the samples already include the realtime effects of
+   //! FindChannelGroup(), so that playback must not apply them again
+   /*! Default implementation returns false */
+   virtual bool IncludesRealtimeEffects() const;
 };
 
 using ConstPlayableSequences =
@@ -59,7 +59,8 @@ std::vector<std::shared_ptr<EffectInstance>> MakeInstances(
 EffectStage::EffectStage(
    CreateToken, int channel, int nInputChannels, Source& upstream,
    Buffers& inBuffers, const Factory& factory, EffectSettings& settings,
-   double sampleRate, std::optional<sampleCount> genLength)
+   double sampleRate, std::optional<sampleCount> genLength,
+   std::shared_ptr<EffectProfiler::Entry> pProfile)
     : mUpstream { upstream }
     , mInBuffers { inBuffers }
     , mInstances { MakeInstances(
@@ -67,6 +68,7 @@ EffectStage::EffectStage(
     , mSettings { settings }
     , mSampleRate { sampleRate }
     , mIsProcessor { !genLength.has_value() }
+    , mpProfile { move(pProfile) }
     , mDelayRemaining { genLength ? *genLength : sampleCount::max() }
 {
    assert(upstream.AcceptsBlockSize(inBuffers.BlockSize()));
@@ -79,12 +81,14 @@ EffectStage::EffectStage(
 auto EffectStage::Create(
    int channel, int nInputChannels, Source& upstream, Buffers& inBuffers,
    const Factory& factory, EffectSettings& settings, double sampleRate,
-   std::optional<sampleCount> genLength) -> std::unique_ptr<EffectStage>
+   std::optional<sampleCount> genLength,
+   std::shared_ptr<EffectProfiler::Entry> pProfile)
+   -> std::unique_ptr<EffectStage>
 {
    try {
       return std::make_unique<EffectStage>(
          CreateToken {}, channel, nInputChannels, upstream, inBuffers, factory,
-         settings, sampleRate, genLength);
+         settings, sampleRate, genLength, move(pProfile));
    }
    catch (const std::exception &) {
       return nullptr;
@@ -303,16 +307,18 @@ bool EffectStage::Process(EffectInstance &instance,
       // channel may be nonzero in the case of a plug-in that only reads
       // one channel at a time, so multiple instances are made to mix stereo
       assert(channel <= nPositions);
-      std::vector<float *> inPositions(
+      // Reuse the storage of the members, which is allocated at most once
+      auto &inPositions = mInPositions;
+      inPositions.assign(
          positions + channel, positions + nPositions - channel);
       // When the plug-in expects many input channels, replicate the last
       // buffer (assumed to be zero-filled) as dummy input
       inPositions.resize(
          instance.GetAudioInCount() - channel, inPositions.back());
 
-      std::vector<float *> advancedOutPositions;
+      auto &advancedOutPositions = mOutPositions;
+      advancedOutPositions.clear();
       const auto size = instance.GetAudioOutCount() - channel;
-      advancedOutPositions.reserve(size);
 
       auto outPositions = data.Positions();
       // It is assumed that data has at least one dummy buffer last
@@ -325,6 +331,8 @@ bool EffectStage::Process(EffectInstance &instance,
       // as dummy output
       advancedOutPositions.resize(size, advancedOutPositions.back());
 
+      // Offline processing has no deadline
+      EffectProfiler::Scope profileScope{ mpProfile.get(), curBlockSize, 0 };
       processed = instance.ProcessBlock(mSettings,
          inPositions.data(), advancedOutPositions.data(), curBlockSize);
    }
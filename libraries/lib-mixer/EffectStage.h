@@ -17,8 +17,10 @@
 
 #include "AudioGraphSource.h" // to inherit
 #include "EffectInterface.h"
+#include "EffectProfiler.h"
 #include "SampleCount.h"
 #include <functional>
+#include <vector>
 
 class WideSampleSequence;
 
@@ -40,17 +42,20 @@ public:
     @param map not required after construction
 
     @pre `channel < sequence.NChannels()`
+    @param pProfile if not null, times each block given to the instances
     */
    EffectStage(
       CreateToken, int channel, int nInputChannels, Source& upstream,
       Buffers& inBuffers, const Factory& factory, EffectSettings& settings,
-      double sampleRate, std::optional<sampleCount> genLength);
+      double sampleRate, std::optional<sampleCount> genLength,
+      std::shared_ptr<EffectProfiler::Entry> pProfile = nullptr);
 
    //! Satisfies postcondition of constructor or returns null
    static std::unique_ptr<EffectStage> Create(
       int channel, int nInputChannels, Source& upstream, Buffers& inBuffers,
       const Factory& factory, EffectSettings& settings, double sampleRate,
-      std::optional<sampleCount> genLength);
+      std::optional<sampleCount> genLength,
+      std::shared_ptr<EffectProfiler::Entry> pProfile = nullptr);
 
    EffectStage(const EffectStage&) = delete;
    EffectStage &operator =(const EffectStage &) = delete;
@@ -93,6 +98,13 @@ private:
    const double mSampleRate;
    const bool mIsProcessor;
 
+   //! Scratch space for Process(), so that it does not allocate for each
+   //! block
+   mutable std::vector<float *> mInPositions, mOutPositions;
+
+   //! Times the calls to the instances
+   const std::shared_ptr<EffectProfiler::Entry> mpProfile;
+
    sampleCount mDelayRemaining;
    size_t mLastProduced{};
    size_t mLastZeroes{};
@@ -39,6 +39,15 @@ a draggable point type.
 #include <wx/log.h>
 #include <wx/utils.h>
 
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENVELOPE_SSE2
+#include <emmintrin.h>
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#define ENVELOPE_NEON
+#include <arm_neon.h>
+#endif
+
 static const double VALUE_TOLERANCE = 0.001;
 
 Envelope::Envelope(bool exponential, double minValue, double maxValue, double defaultValue)
@@ -340,6 +349,7 @@ bool Envelope::HandleXMLTag(const std::string_view& tag, const AttributesList& a
 
    mEnv.clear();
    mEnv.reserve(numPoints);
+   ++mVersion;
    return true;
 }
 
@@ -349,6 +359,7 @@ XMLTagHandler *Envelope::HandleXMLChild(const std::string_view& tag)
       return NULL;
 
    mEnv.push_back( EnvPoint{} );
+   ++mVersion;
    return &mEnv.back();
 }
 
@@ -663,6 +674,7 @@ std::pair< int, int > Envelope::ExpandRegion
    }
 
    mTrackLen += tlen;
+   ++mVersion;
 
    // Preserve the right-side limit.
    if ( index < range.second )
@@ -787,10 +799,12 @@ int Envelope::InsertOrReplaceRelative(double when, double value) noexcept
    auto range = EqualRange( when, 0 );
    int index = range.first;
 
-   if ( index < range.second )
+   if ( index < range.second ) {
       // modify existing
       // In case of a discontinuity, ALWAYS CHANGING LEFT LIMIT ONLY!
       mEnv[ index ].SetVal( this, value );
+      ++mVersion;
+   }
    else
      // Add NEW
       Insert( index, EnvPoint { when, value } );
@@ -843,9 +857,12 @@ void Envelope::SetTrackLen( double trackLen, double sampleDur )
    // Shrink the array.
    // If more than one point already at the end, keep only the first of them.
    int newLen = std::min( 1 + range.first, range.second );
-   mEnv.resize( newLen );
 
-   ++mVersion;
+   // Only lengthening, as while recording, leaves the values as they were
+   if ( needPoint || newLen != int( mEnv.size() ) )
+      ++mVersion;
+
+   mEnv.resize( newLen );
 
    if ( needPoint )
       AddPointAtEnd( mTrackLen, value );
@@ -874,6 +891,7 @@ void Envelope::RescaleTimesBy(double ratio)
       point.SetT(point.GetT() * ratio);
    if (mTrackLen != DBL_MAX)
       mTrackLen *= ratio;
+   ++mVersion;
 }
 
 // Accessors
@@ -947,6 +965,17 @@ void Envelope::BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept
 void Envelope::BinarySearchForTime_LeftLimit(int &Lo, int &Hi, double t)
    const noexcept
 {
+   // The same optimizations as in BinarySearchForTime
+   for (auto guess : { mSearchGuess, mSearchGuess + 1 }) {
+      if (guess >= 0 && guess < (int)mEnv.size() &&
+          t > mEnv[guess].GetT() &&
+          (1 + guess == (int)mEnv.size() || t <= mEnv[1 + guess].GetT())) {
+         Lo = mSearchGuess = guess;
+         Hi = 1 + guess;
+         return;
+      }
+   }
+
    Lo = -1;
    Hi = mEnv.size();
 
@@ -986,6 +1015,70 @@ void Envelope::GetValues( double *buffer, int bufferLen,
    GetValuesRelative( buffer, bufferLen, t0, tstep);
 }
 
+namespace {
+//! buffer[k] = v0 + k * step, for k < n
+void FillLinear(double *buffer, size_t n, double v0, double step)
+{
+   size_t k = 0;
+#if defined(ENVELOPE_SSE2)
+   const auto vv0 = _mm_set1_pd(v0), vstep = _mm_set1_pd(step),
+      two = _mm_set1_pd(2.0);
+   auto vk = _mm_set_pd(1.0, 0.0);
+   for (; k + 2 <= n; k += 2) {
+      _mm_storeu_pd(buffer + k, _mm_add_pd(vv0, _mm_mul_pd(vk, vstep)));
+      vk = _mm_add_pd(vk, two);
+   }
+#elif defined(ENVELOPE_NEON)
+   const auto vv0 = vdupq_n_f64(v0), vstep = vdupq_n_f64(step),
+      two = vdupq_n_f64(2.0);
+   float64x2_t vk = { 0.0, 1.0 };
+   for (; k + 2 <= n; k += 2) {
+      vst1q_f64(buffer + k, vaddq_f64(vv0, vmulq_f64(vk, vstep)));
+      vk = vaddq_f64(vk, two);
+   }
+#endif
+   for (; k < n; ++k)
+      buffer[k] = v0 + k * step;
+}
+
+//! Samples between exact evaluations of pow() in FillExponential(), which
+//! limits the accumulation of roundoff in repeated multiplications
+constexpr size_t ExponentialBlock = 64;
+
+//! buffer[k] = 10^(logV0 + k * logStep), for k < n
+void FillExponential(double *buffer, size_t n, double logV0, double logStep)
+{
+   const auto ratio = pow(10.0, logStep);
+   for (size_t k0 = 0; k0 < n; k0 += ExponentialBlock) {
+      const auto end = std::min(n, k0 + ExponentialBlock);
+      const auto v0 = pow(10.0, logV0 + k0 * logStep);
+      size_t k = k0;
+#if defined(ENVELOPE_SSE2)
+      const auto ratio2 = _mm_set1_pd(ratio * ratio);
+      auto v = _mm_set_pd(v0 * ratio, v0);
+      for (; k + 2 <= end; k += 2) {
+         _mm_storeu_pd(buffer + k, v);
+         v = _mm_mul_pd(v, ratio2);
+      }
+      if (k < end)
+         buffer[k] = _mm_cvtsd_f64(v);
+#elif defined(ENVELOPE_NEON)
+      const auto ratio2 = vdupq_n_f64(ratio * ratio);
+      float64x2_t v = { v0, v0 * ratio };
+      for (; k + 2 <= end; k += 2) {
+         vst1q_f64(buffer + k, v);
+         v = vmulq_f64(v, ratio2);
+      }
+      if (k < end)
+         buffer[k] = vgetq_lane_f64(v, 0);
+#else
+      for (auto v = v0; k < end; ++k, v *= ratio)
+         buffer[k] = v;
+#endif
+   }
+}
+}
+
 void Envelope::GetValuesRelative
    (double *buffer, int bufferLen, double t0, double tstep, bool leftLimit)
    const noexcept
@@ -993,112 +1086,114 @@ void Envelope::GetValuesRelative
    // JC: If bufferLen ==0 we have probably just allocated a zero sized buffer.
    // wxASSERT( bufferLen > 0 );
 
-   const auto epsilon = tstep / 2;
-   int len = mEnv.size();
+   const int len = mEnv.size();
+   // IF empty envelope THEN default value
+   if (len <= 0) {
+      std::fill(buffer, buffer + std::max(0, bufferLen), mDefaultValue);
+      return;
+   }
 
-   double t = t0;
+   const auto epsilon = tstep / 2;
    double increment = 0;
-   if ( len > 1 && t <= mEnv[0].GetT() && mEnv[0].GetT() == mEnv[1].GetT() )
+   if ( len > 1 && t0 <= mEnv[0].GetT() && mEnv[0].GetT() == mEnv[1].GetT() )
       increment = leftLimit ? -epsilon : epsilon;
 
-   double tprev, vprev, tnext = 0, vnext, vstep = 0;
-
-   for (int b = 0; b < bufferLen; b++) {
-
-      // Get easiest cases out the way first...
-      // IF empty envelope THEN default value
-      if (len <= 0) {
-         buffer[b] = mDefaultValue;
-         t += tstep;
-         continue;
-      }
+   const auto tFirst = mEnv[0].GetT();
+   const auto tLast = mEnv[len - 1].GetT();
+   const auto before = [&](double tplus) {
+      return leftLimit ? tplus <= tFirst : tplus < tFirst; };
+   const auto after = [&](double tplus) {
+      return leftLimit ? tplus > tLast : tplus >= tLast; };
 
-      auto tplus = t + increment;
+   // Fill one run of samples at a time, either outside the envelope, or
+   // within one point-to-point interval
+   for (int b = 0; b < bufferLen;) {
+      const auto t = t0 + b * tstep;
+      const auto tplus = t + increment;
 
       // IF before envelope THEN first value
-      if ( leftLimit ? tplus <= mEnv[0].GetT() : tplus < mEnv[0].GetT() ) {
-         buffer[b] = mEnv[0].GetVal();
-         t += tstep;
+      if (before(tplus)) {
+         buffer[b++] = mEnv[0].GetVal();
          continue;
       }
       // IF after envelope THEN last value
-      if ( leftLimit
-            ? tplus > mEnv[len - 1].GetT() : tplus >= mEnv[len - 1].GetT() ) {
-         buffer[b] = mEnv[len - 1].GetVal();
-         t += tstep;
+      if (after(tplus)) {
+         buffer[b++] = mEnv[len - 1].GetVal();
          continue;
       }
 
-      // be careful to get the correct limit even in case epsilon == 0
-      if ( b == 0 ||
-           ( leftLimit ? tplus > tnext : tplus >= tnext ) ) {
-
-         // We're beyond our tnext, so find the next one.
-         // Don't just increment lo or hi because we might
-         // be zoomed far out and that could be a large number of
-         // points to move over.  That's why we binary search.
-
-         int lo,hi;
-         if ( leftLimit )
-            BinarySearchForTime_LeftLimit( lo, hi, tplus );
-         else
-            BinarySearchForTime( lo, hi, tplus );
-
-         // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
-         // mEnv[len - 1] is after tplus, therefore hi <= len - 1
-         wxASSERT( lo >= 0 && hi <= len - 1 );
-
-         tprev = mEnv[lo].GetT();
-         tnext = mEnv[hi].GetT();
-
-         if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
-            // There is a discontinuity after this point-to-point interval.
-            // Usually will stop evaluating in this interval when time is slightly
-            // before tNext, then use the right limit.
-            // This is the right intent
-            // in case small roundoff errors cause a sample time to be a little
-            // before the envelope point time.
-            // Less commonly we want a left limit, so we continue evaluating in
-            // this interval until shortly after the discontinuity.
-            increment = leftLimit ? -epsilon : epsilon;
-         else
-            increment = 0;
-
-         vprev = GetInterpolationStartValueAtPoint( lo );
-         vnext = GetInterpolationStartValueAtPoint( hi );
+      // Don't just increment lo or hi because we might
+      // be zoomed far out and that could be a large number of
+      // points to move over.  That's why we binary search, starting with a
+      // guess that is right for the usual consecutive calls.
+      int lo,hi;
+      if ( leftLimit )
+         BinarySearchForTime_LeftLimit( lo, hi, tplus );
+      else
+         BinarySearchForTime( lo, hi, tplus );
+
+      // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
+      // mEnv[len - 1] is after tplus, therefore hi <= len - 1
+      wxASSERT( lo >= 0 && hi <= len - 1 );
+
+      const auto tprev = mEnv[lo].GetT();
+      const auto tnext = mEnv[hi].GetT();
+
+      if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
+         // There is a discontinuity after this point-to-point interval.
+         // Usually will stop evaluating in this interval when time is slightly
+         // before tNext, then use the right limit.
+         // This is the right intent
+         // in case small roundoff errors cause a sample time to be a little
+         // before the envelope point time.
+         // Less commonly we want a left limit, so we continue evaluating in
+         // this interval until shortly after the discontinuity.
+         increment = leftLimit ? -epsilon : epsilon;
+      else
+         increment = 0;
 
-         // Interpolate, either linear or log depending on mDB.
-         double dt = (tnext - tprev);
-         double to = t - tprev;
-         double v;
-         if (dt > 0.0)
-         {
-            v = (vprev * (dt - to) + vnext * to) / dt;
-            vstep = (vnext - vprev) * tstep / dt;
-         }
-         else
-         {
-            v = vnext;
-            vstep = 0.0;
-         }
+      // Find the end of the run in this interval
+      // be careful to get the correct limit even in case epsilon == 0
+      const auto inInterval = [&](int k) {
+         const auto tplus = t0 + k * tstep + increment;
+         return !before(tplus) && !after(tplus) &&
+            (leftLimit ? tplus <= tnext : tplus < tnext);
+      };
+      int end = b + 1;
+      if (tstep > 0) {
+         // Estimate, then correct for roundoff
+         end = static_cast<int>(std::clamp(
+            std::ceil((tnext - increment - t0) / tstep),
+            static_cast<double>(end), static_cast<double>(bufferLen)));
+         while (end > b + 1 && !inInterval(end - 1))
+            --end;
+      }
+      while (end < bufferLen && inInterval(end))
+         ++end;
 
-         // An adjustment if logarithmic scale.
-         if( mDB )
-         {
-            v = pow(10.0, v);
-            vstep = pow( 10.0, vstep );
-         }
+      const auto vprev = GetInterpolationStartValueAtPoint( lo );
+      const auto vnext = GetInterpolationStartValueAtPoint( hi );
 
-         buffer[b] = v;
-      } else {
-         if (mDB){
-            buffer[b] = buffer[b - 1] * vstep;
-         }else{
-            buffer[b] = buffer[b - 1] + vstep;
-         }
+      // Interpolate, either linear or log depending on mDB.
+      double dt = (tnext - tprev);
+      double to = t - tprev;
+      double v, vstep;
+      if (dt > 0.0)
+      {
+         v = (vprev * (dt - to) + vnext * to) / dt;
+         vstep = (vnext - vprev) * tstep / dt;
+      }
+      else
+      {
+         v = vnext;
+         vstep = 0.0;
       }
 
-      t += tstep;
+      if (mDB)
+         FillExponential(buffer + b, end - b, v, vstep);
+      else
+         FillLinear(buffer + b, end - b, v, vstep);
+      b = end;
    }
 }
 
@@ -1325,6 +1420,21 @@ double Envelope::IntegralOfInverse( double t0, double t1 ) const
       i = hi; // the point immediately after t0.
    }
 
+   // Skip the whole segments before t1, adding their precomputed integrals
+   if (i < count && mEnv[i].GetT() < t1)
+   {
+      const auto integrals = GetInverseIntegrals();
+      const auto &values = integrals->values;
+      const auto end = std::lower_bound(mEnv.begin() + i, mEnv.end(), t1,
+         [](const EnvPoint &point, double t) { return point.GetT() < t; });
+      const unsigned int last = (end - mEnv.begin()) - 1;
+      total += IntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
+      total += values[last] - values[i];
+      lastT = mEnv[last].GetT();
+      lastVal = mEnv[last].GetVal();
+      i = last + 1;
+   }
+
    // loop through the rest of the envelope points until we get to t1
    while (1)
    {
@@ -1406,6 +1516,25 @@ double Envelope::SolveIntegralOfInverse( double t0, double area ) const
       }
 
       if (area < 0) {
+         // Skip the whole segments after the solution, subtracting their
+         // precomputed integrals
+         if (i >= 0) {
+            double added =
+               -IntegrateInverseInterpolated(mEnv[i].GetVal(), lastVal, lastT - mEnv[i].GetT(), mDB);
+            if (added > area) {
+               area -= added;
+               const auto integrals = GetInverseIntegrals();
+               const auto &values = integrals->values;
+               // The last point before which the remaining area fits
+               const int j = std::upper_bound(values.begin(),
+                  values.begin() + i, values[i] + area) - values.begin() - 1;
+               area += values[i] - values[j + 1];
+               lastT = mEnv[j + 1].GetT();
+               lastVal = mEnv[j + 1].GetVal();
+               i = j;
+            }
+         }
+
          // loop BACKWARDS through the rest of the envelope points until we get to t1
          // (which is less than t0)
          while (i >= 0)
@@ -1422,6 +1551,24 @@ double Envelope::SolveIntegralOfInverse( double t0, double area ) const
          return lastT + area * lastVal;
       }
       else {
+         // Skip the whole segments before the solution, adding their
+         // precomputed integrals
+         if (i < (int)count) {
+            double added = IntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
+            if (added < area) {
+               area -= added;
+               const auto integrals = GetInverseIntegrals();
+               const auto &values = integrals->values;
+               // The first point after which the remaining area fits
+               const int j = std::lower_bound(values.begin() + i + 1,
+                  values.end(), values[i] + area) - values.begin();
+               area -= values[j - 1] - values[i];
+               lastT = mEnv[j - 1].GetT();
+               lastVal = mEnv[j - 1].GetVal();
+               i = j;
+            }
+         }
+
          // loop through the rest of the envelope points until we get to t1
          while (i < (int)count)
          {
@@ -1438,6 +1585,27 @@ double Envelope::SolveIntegralOfInverse( double t0, double area ) const
    }();
 }
 
+auto Envelope::GetInverseIntegrals() const
+   -> std::shared_ptr<const InverseIntegrals>
+{
+   auto integrals = std::atomic_load(&mInverseIntegrals);
+   if (integrals && integrals->version == mVersion)
+      return integrals;
+
+   auto newIntegrals = std::make_shared<InverseIntegrals>();
+   newIntegrals->version = mVersion;
+   auto &values = newIntegrals->values;
+   values.resize(mEnv.size());
+   double total = 0.0;
+   for (size_t i = 1; i < mEnv.size(); ++i) {
+      total += IntegrateInverseInterpolated(mEnv[i - 1].GetVal(), mEnv[i].GetVal(), mEnv[i].GetT() - mEnv[i - 1].GetT(), mDB);
+      values[i] = total;
+   }
+   integrals = std::move(newIntegrals);
+   std::atomic_store(&mInverseIntegrals, integrals);
+   return integrals;
+}
+
 static void checkResult( int n, double a, double b )
 {
    if( (a-b > 0 ? a-b : b-a) > 0.0000001 )
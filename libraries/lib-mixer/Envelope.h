@@ -13,6 +13,7 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <memory>
 #include <vector>
 
 #include "XMLTagHandler.h"
@@ -91,7 +92,7 @@ public:
    double GetTrackLen() const { return mTrackLen; }
 
    bool GetExponential() const { return mDB; }
-   void SetExponential(bool db) { mDB = db; }
+   void SetExponential(bool db) { mDB = db; ++mVersion; }
 
    void Flatten(double value);
 
@@ -163,7 +164,7 @@ public:
    double IntegralOfInverse( double t0, double t1 ) const;
    double SolveIntegralOfInverse( double t0, double area) const;
 
-   void Clear() { mEnv.clear(); }
+   void Clear() { mEnv.clear(); ++mVersion; }
 
    /** \brief Add a point at a particular absolute time coordinate */
    int InsertOrReplace(double when, double value)
@@ -232,6 +233,16 @@ private:
       const noexcept;
    double GetInterpolationStartValueAtPoint(int iPoint) const noexcept;
 
+   //! Integrals of the inverse from the first point to each point
+   struct InverseIntegrals
+   {
+      size_t version;
+      std::vector<double> values;
+   };
+   //! Computes them again if the envelope changed since they last were.
+   //! Safe to call from several threads, as while playing and drawing.
+   std::shared_ptr<const InverseIntegrals> GetInverseIntegrals() const;
+
    // The list of envelope control points.
    EnvArray mEnv;
 
@@ -256,6 +267,10 @@ private:
    size_t mVersion { 0 };
 
    mutable int mSearchGuess { -2 };
+
+   //! Lets IntegralOfInverse and SolveIntegralOfInverse skip the points
+   //! between their bounds, as the time track needs every callback
+   mutable std::shared_ptr<const InverseIntegrals> mInverseIntegrals;
 };
 
 inline void EnvPoint::SetVal( Envelope *pEnvelope, double val )
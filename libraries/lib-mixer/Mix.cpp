@@ -23,7 +23,15 @@
 #include "Resample.h"
 #include "WideSampleSequence.h"
 #include "float_cast.h"
+#include "Prefs.h"
+#include "Tracing.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
 #include <numeric>
+#include <thread>
 
 namespace {
 template<typename T, typename F> std::vector<T>
@@ -80,6 +88,116 @@ size_t FindBufferSize(
 }
 } // namespace
 
+IntSetting MixerThreads{ L"/Mixer/Threads", 1 };
+
+//! A fixed set of threads, each waiting for a batch of tasks from
+//! ForEach()
+class Mixer::Workers final {
+public:
+   explicit Workers(size_t nThreads);
+   ~Workers();
+
+   //! Call `task(i)` for each i < count, in these threads and the calling
+   //! one, returning when all are done
+   /*!
+    The first exception from any task is rethrown in the calling thread,
+    after the others finish
+    */
+   void ForEach(size_t count, const std::function<void(size_t)> &task);
+
+private:
+   void Loop();
+   void Work();
+
+   std::mutex mMutex;
+   std::condition_variable mStart, mDone;
+   std::vector<std::thread> mThreads;
+   //! Non-null while ForEach() is in progress
+   const std::function<void(size_t)> *mpTask{};
+   size_t mCount{};
+   std::atomic<size_t> mNext{ 0 };
+   //! How many of mThreads have not yet finished the batch
+   size_t mBusy{};
+   //! Incremented with each batch
+   unsigned mGeneration{};
+   bool mStopping{ false };
+   std::exception_ptr mpException;
+};
+
+Mixer::Workers::Workers(size_t nThreads)
+{
+   mThreads.reserve(nThreads);
+   for (size_t ii = 0; ii < nThreads; ++ii)
+      mThreads.emplace_back([this]{ Loop(); });
+}
+
+Mixer::Workers::~Workers()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStopping = true;
+   }
+   mStart.notify_all();
+   for (auto &thread : mThreads)
+      thread.join();
+}
+
+void Mixer::Workers::ForEach(
+   size_t count, const std::function<void(size_t)> &task)
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mpTask = &task;
+      mCount = count;
+      mNext = 0;
+      mBusy = mThreads.size();
+      ++mGeneration;
+   }
+   mStart.notify_all();
+   Work();
+
+   std::unique_lock<std::mutex> lock{ mMutex };
+   mDone.wait(lock, [this]{ return mBusy == 0; });
+   mpTask = nullptr;
+   if (auto pException = std::exchange(mpException, nullptr))
+      std::rethrow_exception(pException);
+}
+
+void Mixer::Workers::Loop()
+{
+   unsigned generation = 0;
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mStart.wait(lock, [&]{
+            return mStopping || mGeneration != generation; });
+         if (mStopping)
+            return;
+         generation = mGeneration;
+      }
+      Work();
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (--mBusy == 0)
+            mDone.notify_one();
+      }
+   }
+}
+
+void Mixer::Workers::Work()
+{
+   for (size_t ii; (ii = mNext++) < mCount;) {
+      try {
+         (*mpTask)(ii);
+      }
+      catch (...) {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (!mpException)
+            mpException = std::current_exception();
+      }
+   }
+}
+
 Mixer::Mixer(
    Inputs inputs, std::optional<Stages> masterEffects, const bool mayThrow,
    const WarpOptions& warpOptions, const double startTime,
@@ -90,6 +208,9 @@ Mixer::Mixer(
     : mNumChannels { numOutChannels }
     , mInputs { move(inputs) }
     , mMasterEffects { move(masterEffects) }
+    , mNumBuses { 1 + std::accumulate(mInputs.begin(), mInputs.end(), 0u,
+         [](unsigned result, const Input &input){
+            return std::max(result, input.bus); }) }
     , mBufferSize { FindBufferSize(mInputs, mMasterEffects, outBufferSize) }
     , mApplyGain { applyGain }
     , mHighQuality { highQuality }
@@ -107,15 +228,17 @@ Mixer::Mixer(
     , mFloatBuffers { 3, mBufferSize, 1, 1 }
 
     // non-interleaved
-    , mTemp { mNumChannels, mBufferSize, 1, 1 }
+    , mTemp { mNumBuses * mNumChannels, mBufferSize, 1, 1 }
     , mBuffer { initVector<SampleBuffer>(
-         mInterleaved ? 1 : mNumChannels,
+         mNumBuses * (mInterleaved ? 1 : mNumChannels),
          [format = mFormat,
           size = mBufferSize * (mInterleaved ? mNumChannels : 1)](
             auto& buffer) { buffer.Allocate(size, format); }) }
     , mEffectiveFormat { floatSample }
 {
    assert(BufferSize() <= outBufferSize);
+   // Master effects would process only the first bus
+   assert(!mMasterEffects || mNumBuses == 1);
    const auto nChannelsIn =
    std::accumulate(mInputs.begin(), mInputs.end(), size_t{},
       [](auto sum, const auto &input){
@@ -176,7 +299,32 @@ Mixer::Mixer(
          {
             pDownstream = pNewDownstream.get();
          }
-      mDecoratedSources.emplace_back(Source{ source, *pDownstream });
+      mDecoratedSources.emplace_back(
+         Source{ source, *pDownstream, input.bus });
+   }
+
+   // Sources with effect stages stay serial, because plug-ins might not
+   // tolerate concurrent processing by instances
+   auto nThreads = static_cast<size_t>(std::max(0, MixerThreads.Read()));
+   if (nThreads == 0)
+      nThreads = std::max(1u, std::thread::hardware_concurrency());
+   if (nThreads > 1) {
+      for (size_t ii = 0; ii < mDecoratedSources.size(); ++ii) {
+         const auto &[upstream, downstream, _] = mDecoratedSources[ii];
+         if (&downstream == &upstream)
+            mParallelSources.push_back(ii);
+      }
+      if (const auto nParallel = mParallelSources.size(); nParallel > 1) {
+         mParallelBuffers.reserve(nParallel);
+         for (size_t ii = 0; ii < nParallel; ++ii)
+            // Like mFloatBuffers
+            mParallelBuffers.emplace_back(3, mBufferSize, 1, 1);
+         mParallelResults.resize(nParallel);
+         mpWorkers =
+            std::make_unique<Workers>(std::min(nThreads, nParallel) - 1);
+      }
+      else
+         mParallelSources.clear();
    }
 
    if (mMasterEffects)
@@ -267,13 +415,14 @@ void Mixer::Clear()
 
 static void MixBuffers(unsigned numChannels,
    const unsigned char *channelFlags, const float *gains,
-   const float &src, AudioGraph::Buffers &dests, int len)
+   const float &src, AudioGraph::Buffers &dests, unsigned firstChannel,
+   int len)
 {
    const auto pSrc = &src;
    for (unsigned int c = 0; c < numChannels; c++) {
       if (!channelFlags[c])
          continue;
-      auto dest = &dests.GetWritePosition(c);
+      auto dest = &dests.GetWritePosition(firstChannel + c);
       for (int j = 0; j < len; ++j)
          dest[j] += pSrc[j] * gains[c];   // the actual mixing process
    }
@@ -283,6 +432,7 @@ static void MixBuffers(unsigned numChannels,
 
 size_t Mixer::Process(const size_t maxToProcess)
 {
+   AUDACITY_TRACE_SCOPE("Mixer::Process");
    assert(maxToProcess <= BufferSize());
 
    // MB: this is wrong! mT represented warped time, and mTime is too inaccurate to use
@@ -318,14 +468,17 @@ size_t Mixer::Process(const size_t maxToProcess)
    auto ditherType = mNeedsDither
       ? (mHighQuality ? gHighQualityDither : gLowQualityDither)
       : DitherType::none;
-   for (size_t c = 0; c < mNumChannels; ++c)
-      CopySamples(mTemp.GetReadPosition(c), floatSample,
-         (mInterleaved
-            ? mBuffer[0].ptr() + (c * SAMPLE_SIZE(mFormat))
-            : mBuffer[c].ptr()
-         ),
-         mFormat, *maxOut, ditherType,
-         1, dstStride);
+   for (size_t bus = 0; bus < mNumBuses; ++bus)
+      for (size_t c = 0; c < mNumChannels; ++c) {
+         const auto channel = bus * mNumChannels + c;
+         CopySamples(mTemp.GetReadPosition(channel), floatSample,
+            (mInterleaved
+               ? mBuffer[bus].ptr() + (c * SAMPLE_SIZE(mFormat))
+               : mBuffer[channel].ptr()
+            ),
+            mFormat, *maxOut, ditherType,
+            1, dstStride);
+      }
 
    // MB: this doesn't take warping into account, replaced with code based on mSamplePos
    //mT += (maxOut / mRate);
@@ -344,6 +497,13 @@ constSamplePtr Mixer::GetBuffer(int channel)
    return mBuffer[channel].ptr();
 }
 
+constSamplePtr Mixer::GetBusBuffer(unsigned bus)
+{
+   assert(mInterleaved);
+   assert(bus < mNumBuses);
+   return mBuffer[bus].ptr();
+}
+
 sampleFormat Mixer::EffectiveFormat() const
 {
    return mEffectiveFormat;
@@ -404,9 +564,15 @@ void Mixer::SetSpeedForKeyboardScrubbing(double speed, double startTime)
    mSpeed = fabs(speed);
 }
 
+void Mixer::Prefetch(double t0, double t1) const
+{
+   for (auto &source : mSources)
+      source.Prefetch(t0, t1);
+}
+
 bool Mixer::AcceptsBuffers(const Buffers& buffers) const
 {
-   return buffers.Channels() == mNumChannels &&
+   return buffers.Channels() == mNumBuses * mNumChannels &&
           AcceptsBlockSize(buffers.BlockSize());
 }
 
@@ -463,9 +629,24 @@ std::optional<size_t> Mixer::Acquire(Buffers& data, size_t maxToProcess)
    for (auto c = 0;c < data.Channels(); ++c)
       data.ClearBuffer(c, maxToProcess);
 
-   for (auto& [upstream, downstream] : mDecoratedSources)
+   if (!mParallelSources.empty() && !AcquireInParallel(maxToProcess))
+      return 0;
+
+   // Accumulate in the same order as when acquiring serially, so that the
+   // sums are the same
+   auto pParallel = mParallelSources.begin();
+   for (size_t ii = 0; ii < mDecoratedSources.size(); ++ii)
    {
-      auto oResult = downstream.Acquire(mFloatBuffers, maxToProcess);
+      auto& [upstream, downstream, bus] = mDecoratedSources[ii];
+      const bool parallel =
+         pParallel != mParallelSources.end() && *pParallel == ii;
+      const auto iParallel = pParallel - mParallelSources.begin();
+      if (parallel)
+         ++pParallel;
+      auto& buffers = parallel ? mParallelBuffers[iParallel] : mFloatBuffers;
+      auto oResult = parallel
+         ? mParallelResults[iParallel]
+         : downstream.Acquire(buffers, maxToProcess);
       // One of MixVariableRates or MixSameRate assigns into mTemp[*][*]
       // which are the sources for the CopySamples calls, and they copy into
       // mBuffer[*][*]
@@ -479,7 +660,7 @@ std::optional<size_t> Mixer::Acquire(Buffers& data, size_t maxToProcess)
       const auto limit = std::min<size_t>(upstream.Channels(), maxChannels);
       for (size_t j = 0; j < limit; ++j)
       {
-         const auto pFloat = (const float*)mFloatBuffers.GetReadPosition(j);
+         const auto pFloat = (const float*)buffers.GetReadPosition(j);
          auto& sequence = upstream.GetSequence();
          if (mApplyGain != ApplyGain::Discard)
          {
@@ -498,12 +679,13 @@ std::optional<size_t> Mixer::Acquire(Buffers& data, size_t maxToProcess)
 
          const auto flags =
             findChannelFlags(upstream.MixerSpec(j), sequence, j);
-         MixBuffers(mNumChannels, flags, gains, *pFloat, data, result);
+         MixBuffers(mNumChannels, flags, gains, *pFloat, data,
+            bus * mNumChannels, result);
       }
 
       downstream.Release();
-      mFloatBuffers.Advance(result);
-      mFloatBuffers.Rotate();
+      buffers.Advance(result);
+      buffers.Rotate();
    }
 
    // MB: this doesn't take warping into account, replaced with code based on mSamplePos
@@ -513,6 +695,17 @@ std::optional<size_t> Mixer::Acquire(Buffers& data, size_t maxToProcess)
    return maxOut;
 }
 
+bool Mixer::AcquireInParallel(size_t maxToProcess)
+{
+   mpWorkers->ForEach(mParallelSources.size(), [&](size_t ii) {
+      auto &downstream = mDecoratedSources[mParallelSources[ii]].downstream;
+      mParallelResults[ii] =
+         downstream.Acquire(mParallelBuffers[ii], maxToProcess);
+   });
+   return std::all_of(mParallelResults.begin(), mParallelResults.end(),
+      [](const std::optional<size_t> &oResult){ return oResult.has_value(); });
+}
+
 std::unique_ptr<EffectStage>& Mixer::RegisterEffectStage(
    AudioGraph::Source& upstream, const MixerOptions::StageSpecification& stage,
    double outRate)
@@ -18,6 +18,7 @@
 #include "SampleFormat.h"
 #include <optional>
 
+class IntSetting;
 class sampleCount;
 class BoundedEnvelope;
 class EffectStage;
@@ -37,12 +38,14 @@ public:
    struct Input {
       Input(
          std::shared_ptr<const WideSampleSequence> pSequence = {},
-         Stages stages = {}
-      )  : pSequence{ move(pSequence) }, stages{ move(stages) }
+         Stages stages = {}, unsigned bus = 0
+      )  : pSequence{ move(pSequence) }, stages{ move(stages) }, bus{ bus }
       {}
 
       std::shared_ptr<const WideSampleSequence> pSequence;
       Stages stages;
+      //! Which of the output buses receives this input
+      unsigned bus;
    };
    using Inputs = std::vector<Input>;
 
@@ -61,7 +64,11 @@ public:
     @pre all sequences in `inputs` are non-null
     @pre any left channels in inputs are immediately followed by their
        partners
+    @pre `!masterEffects || NumBuses() == 1`
     @post `BufferSize() <= outBufferSize` (equality when no inputs have stages)
+
+    @param numOutChannels the number of channels of each bus
+    @param mixerSpec its columns are relative to the bus of each input
     */
    Mixer(
       Inputs inputs, std::optional<Stages> masterEffects, bool mayThrow,
@@ -79,6 +86,13 @@ public:
 
    size_t BufferSize() const { return mBufferSize; }
 
+   //! One more than the greatest bus of the inputs
+   /*!
+    Each Process() mixes all the buses from one pass over the inputs, as if
+    by separate Mixers given the inputs of each bus
+    */
+   unsigned NumBuses() const { return mNumBuses; }
+
    //
    // Processing
    //
@@ -105,17 +119,30 @@ public:
    void SetTimesAndSpeed(
       double t0, double t1, double speed, bool bSkipping = false);
    void SetSpeedForKeyboardScrubbing(double speed, double startTime);
+   //! Hint that processing may soon jump anywhere in [t0, t1)
+   void Prefetch(double t0, double t1) const;
 
    //! Current time in seconds (unwarped, i.e. always between startTime and stopTime)
    /*! This value is not accurate, it's useful for progress bars and indicators, but nothing else. */
    double MixGetCurrentTime();
 
-   //! Retrieve the main buffer or the interleaved buffer
+   //! Retrieve the main buffer or the interleaved buffer of the first bus
    constSamplePtr GetBuffer();
 
    //! Retrieve one of the non-interleaved buffers
+   /*!
+    @param channel counts the channels of all buses, so that
+       `bus * numOutChannels + c` is channel `c` of `bus`
+    */
    constSamplePtr GetBuffer(int channel);
 
+   //! Retrieve the interleaved buffer of one bus
+   /*!
+    @pre output is interleaved
+    @pre `bus < NumBuses()`
+    */
+   constSamplePtr GetBusBuffer(unsigned bus);
+
    //! Deduce the effective width of the output, which may be narrower than the stored format
    sampleFormat EffectiveFormat() const;
 
@@ -136,10 +163,19 @@ private:
       AudioGraph::Source& upstream,
       const MixerOptions::StageSpecification& stage, double outRate);
 
+   //! Acquire from the sources without effect stages into their own buffers,
+   //! concurrently
+   /*!
+    @return whether all sources produced a result
+    */
+   bool AcquireInParallel(size_t maxToProcess);
+
    // Input
+   //! Of each bus
    const unsigned   mNumChannels;
    Inputs           mInputs;
    const std::optional<Stages> mMasterEffects;
+   const unsigned   mNumBuses;
 
    // Transformations
    const size_t     mBufferSize;
@@ -169,10 +205,12 @@ private:
 
    // Each channel's data is transformed, including application of
    // gains and pans, and then (maybe many-to-one) mixer specifications
-   // determine where in mTemp it is accumulated
+   // determine where in mTemp it is accumulated; channels of each bus are
+   // adjacent
    AudioGraph::Buffers mTemp;
 
-   // Final result applies dithering and interleaving
+   // Final result applies dithering and interleaving; if interleaved, one
+   // buffer per bus
    const std::vector<SampleBuffer> mBuffer;
 
    std::vector<MixerSource> mSources;
@@ -181,7 +219,25 @@ private:
    std::vector<std::unique_ptr<EffectStage>> mStages;
    std::vector<AudioGraph::Source*> mMasterStages;
 
-   struct Source { MixerSource &upstream; AudioGraph::Source &downstream; };
+   struct Source {
+      MixerSource &upstream; AudioGraph::Source &downstream; unsigned bus;
+   };
    std::vector<Source> mDecoratedSources;
+
+   //! Threads that help the calling thread in AcquireInParallel()
+   class Workers;
+   std::unique_ptr<Workers> mpWorkers;
+   //! Indices into mDecoratedSources of the sources acquired in parallel;
+   //! empty when acquiring all serially
+   std::vector<size_t> mParallelSources;
+   //! Buffers, and results of the last AcquireInParallel(), corresponding to
+   //! mParallelSources
+   std::vector<AudioGraph::Buffers> mParallelBuffers;
+   std::vector<std::optional<size_t>> mParallelResults;
 };
+
+//! How many threads may acquire the inputs of one Mixer; 0 for as many as
+//! there are cores, 1 to acquire them serially
+/*! The mixed result is the same, whatever the number */
+extern MIXER_API IntSetting MixerThreads;
 #endif
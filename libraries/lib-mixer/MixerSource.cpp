@@ -18,6 +18,8 @@
 #include "Resample.h"
 #include "WideSampleSequence.h"
 #include "float_cast.h"
+#include <atomic>
+#include <mutex>
 
 namespace {
 template<typename T, typename F> std::vector<T>
@@ -37,8 +39,32 @@ initVector(size_t dim1, size_t dim2)
 }
 }
 
+namespace {
+std::atomic<unsigned long long> sResampledSamples{ 0 };
+std::atomic<unsigned long long> sDirectSamples{ 0 };
+std::atomic<unsigned long long> sUnitGainSamples{ 0 };
+}
+
+auto MixerSource::GetStatistics() -> Statistics
+{
+   return {
+      sResampledSamples.load(std::memory_order_relaxed),
+      sDirectSamples.load(std::memory_order_relaxed),
+      sUnitGainSamples.load(std::memory_order_relaxed)
+   };
+}
+
+bool MixerSource::Resamples() const
+{
+   return mResampleParameters.mVariableRates ||
+      GetSequence().GetRate() != mRate;
+}
+
 void MixerSource::MakeResamplers()
 {
+   assert(Resamples());
+   if (mSampleQueue.empty())
+      mSampleQueue = initVector<float>(mnChannels, sQueueMaxLen);
    for (size_t j = 0; j < mnChannels; ++j)
       mResample[j] = std::make_unique<Resample>(
          mResampleParameters.mHighQuality,
@@ -65,6 +91,8 @@ double ComputeWarpFactor(const Envelope &env, double t0, double t1)
 
 }
 
+#define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
+
 size_t MixerSource::MixVariableRates(
    unsigned nChannels, const size_t maxOut, float *floatBuffers[])
 {
@@ -124,12 +152,13 @@ size_t MixerSource::MixVariableRates(
 
          // Nothing to do if past end of play interval
          if (getLen > 0) {
-            std::vector<float*> dst;
-            for (auto& queue : mSampleQueue)
-               dst.push_back(queue.data() + queueLen);
+            // Not a std::vector, which would allocate on each refill
+            const auto dst = stackAllocate(float *, nChannels);
+            for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+               dst[iChannel] = mSampleQueue[iChannel].data() + queueLen;
             constexpr auto iChannel = 0u;
             if (!mpSeq->GetFloats(
-                   iChannel, nChannels, dst.data(), pos, getLen, backwards,
+                   iChannel, nChannels, dst, pos, getLen, backwards,
                    FillFormat::fillZero, mMayThrow)) {
                // Now redundant in case of failure
                // for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
@@ -209,6 +238,7 @@ size_t MixerSource::MixVariableRates(
    }
 
    assert(out <= maxOut);
+   sResampledSamples.fetch_add(out, std::memory_order_relaxed);
 
    mSamplePos = pos;
    mQueueStart = queueStart;
@@ -260,12 +290,18 @@ size_t MixerSource::MixSameRate(unsigned nChannels, const size_t maxOut,
       
    }
 
-   mpSeq->GetEnvelopeValues(mEnvValues.data(), slen, t, backwards);
+   sDirectSamples.fetch_add(slen, std::memory_order_relaxed);
+   // Skip the fetch and multiplication when the result is known
+   if (mpSeq->HasTrivialEnvelope())
+      sUnitGainSamples.fetch_add(slen, std::memory_order_relaxed);
+   else {
+      mpSeq->GetEnvelopeValues(mEnvValues.data(), slen, t, backwards);
 
-   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
-      const auto pFloat = floatBuffers[iChannel];
-      for (size_t i = 0; i < slen; i++)
-         pFloat[i] *= mEnvValues[i]; // Track gain control will go here?
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+         const auto pFloat = floatBuffers[iChannel];
+         for (size_t i = 0; i < slen; i++)
+            pFloat[i] *= mEnvValues[i]; // Track gain control will go here?
+      }
    }
 
    if (backwards)
@@ -297,7 +333,6 @@ MixerSource::MixerSource(
    , mEnvelope{ options.envelope }
    , mMayThrow{ mayThrow }
    , mTimesAndSpeed{ move(pTimesAndSpeed) }
-   , mSampleQueue{ initVector<float>(mnChannels, sQueueMaxLen) }
    , mQueueStart{ 0 }
    , mQueueLen{ 0 }
    , mResampleParameters{ highQuality, mpSeq->GetRate(), rate, options }
@@ -308,7 +343,10 @@ MixerSource::MixerSource(
    assert(mTimesAndSpeed);
    auto t0 = mTimesAndSpeed->mT0;
    mSamplePos = GetSequence().TimeToLongSamples(t0);
-   MakeResamplers();
+   // When rates match without warping, samples are fetched directly and
+   // no resamplers are needed
+   if (Resamples())
+      MakeResamplers();
 }
 
 MixerSource::~MixerSource() = default;
@@ -333,7 +371,11 @@ bool MixerSource::AcceptsBlockSize(size_t blockSize) const
    return blockSize <= mEnvValues.size();
 }
 
-#define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
+namespace {
+//! Serializes updates of the time shared by the sources of a Mixer, which
+//! may be acquired in several threads
+std::mutex sTimeMutex;
+}
 
 std::optional<size_t> MixerSource::Acquire(Buffers &data, size_t bound)
 {
@@ -353,15 +395,21 @@ std::optional<size_t> MixerSource::Acquire(Buffers &data, size_t bound)
    for (size_t j = 0; j < limit; ++j)
       pFloats[j] = &data.GetWritePosition(j);
    const auto rate = GetSequence().GetRate();
-   auto result = (mResampleParameters.mVariableRates || rate != mRate)
+   // Let storage read ahead so that its latency overlaps with processing
+   GetSequence().Prefetch(this, mSamplePos,
+      static_cast<size_t>(sReadAheadSeconds * rate), backwards);
+   auto result = Resamples()
       ? MixVariableRates(limit, bound, pFloats)
       : MixSameRate(limit, bound, pFloats);
    maxTrack = std::max(maxTrack, result);
    auto newT = mSamplePos.as_double() / rate;
-   if (backwards)
-      mTime = std::min(mTime, newT);
-   else
-      mTime = std::max(mTime, newT);
+   {
+      std::lock_guard<std::mutex> lock{ sTimeMutex };
+      if (backwards)
+         mTime = std::min(mTime, newT);
+      else
+         mTime = std::max(mTime, newT);
+   }
    for (size_t j = 0; j < limit; ++j) {
       mixed[j] = result;
    }
@@ -415,6 +463,15 @@ void MixerSource::Reposition(double time, bool skipping)
    // constant rate resampling if you try to reuse the resampler after it has
    // flushed.  Should that be considered a bug in sox?  This works around it.
    // (See also bug 1887, and the same work around in Mixer::Restart().)
-   if (skipping)
+   if (skipping && Resamples())
       MakeResamplers();
 }
+
+void MixerSource::Prefetch(double t0, double t1) const
+{
+   const auto &sequence = GetSequence();
+   const auto start = sequence.TimeToLongSamples(t0);
+   const auto end = sequence.TimeToLongSamples(t1);
+   if (end > start)
+      sequence.Prefetch(&mRangeClient, start, (end - start).as_size_t(), false);
+}
@@ -61,10 +61,27 @@ public:
    //! @return false
    bool Terminates() const override;
    void Reposition(double time, bool skipping);
+   //! Hint that reads may soon jump anywhere in [t0, t1), as in scrubbing
+   /*! Independent of the read-ahead that Acquire() asks for */
+   void Prefetch(double t0, double t1) const;
 
    bool VariableRates() const { return mResampleParameters.mVariableRates; }
 
+   //! Counts of samples produced by all sources, by how they were produced
+   struct Statistics {
+      //! Through resamplers
+      unsigned long long resampled{};
+      //! Fetched directly, because rates matched without warping
+      unsigned long long direct{};
+      //! Of the direct samples, those that also skipped a unit gain envelope
+      unsigned long long unitGain{};
+   };
+   static Statistics GetStatistics();
+
 private:
+   //! Whether samples go through mResample, or else directly to the output
+   bool Resamples() const;
+   //! Make mResample, and mSampleQueue if not yet done; only if Resamples()
    void MakeResamplers();
 
    //! Cut the queue into blocks of this finer size
@@ -79,6 +96,9 @@ private:
     */
    static constexpr size_t sQueueMaxLen = 65536;
 
+   //! Duration ahead of the read position to ask the sequence to prefetch
+   static constexpr double sReadAheadSeconds = 5.0;
+
    /*!
     Assume floatBuffers has extent nChannels
     @post result: `result <= maxOut`
@@ -115,7 +135,7 @@ private:
     */
    sampleCount mSamplePos;
 
-   //! First intermediate buffer when resampling is needed
+   //! First intermediate buffer when resampling is needed; empty otherwise
    std::vector<std::vector<float>> mSampleQueue;
 
    //! Position of the start of the next block to resample
@@ -125,6 +145,7 @@ private:
    int mQueueLen;
 
    const ResampleParameters mResampleParameters;
+   //! Null when not Resamples()
    std::vector<std::unique_ptr<Resample>> mResample;
 
    //! Gain envelopes are applied to input before other transformations
@@ -137,5 +158,8 @@ private:
    //! Remember how many channels were passed to Acquire()
    unsigned mMaxChannels{};
    size_t mLastProduced{};
+
+   //! Its address identifies the hints of Prefetch() to the sequence
+   const char mRangeClient{};
 };
 #endif
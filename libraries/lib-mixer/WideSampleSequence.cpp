@@ -12,6 +12,10 @@ Paul Licameli split from SampleFrame.cpp
 
 WideSampleSequence::~WideSampleSequence() = default;
 
+void WideSampleSequence::Prefetch(const void *, sampleCount, size_t, bool) const
+{
+}
+
 sampleCount WideSampleSequence::TimeToLongSamples(double t0) const
 {
    return sampleCount(floor(t0 * GetRate() + 0.5));
@@ -77,6 +77,16 @@ public:
       // contiguous range.
       sampleCount* pNumWithinClips = nullptr) const = 0;
 
+   //! Hint that samples will soon be read, so that they may be loaded early
+   /*!
+    @param client identifies the reader; each hint replaces the previous one
+       of the same client, and hints lapse if not renewed
+    @param backward as for DoGet()
+    Default implementation does nothing
+    */
+   virtual void Prefetch(const void *client,
+      sampleCount start, size_t len, bool backward) const;
+
    virtual double GetStartTime() const = 0;
    virtual double GetEndTime() const = 0;
    virtual double GetRate() const = 0;
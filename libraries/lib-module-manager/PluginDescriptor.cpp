@@ -40,6 +40,9 @@ namespace
    constexpr auto AttrEffectRealtime = "effect_realtime";
    constexpr auto AttrEffectAutomatable = "effect_automatable";
    constexpr auto AttrEffectInteractive = "effect_interactive";
+
+   constexpr auto AttrImporterIdentifier = "importer_identifier";
+   constexpr auto AttrImporterExtensions = "importer_extensions";
 }
 
 PluginType PluginDescriptor::GetPluginType() const
@@ -282,6 +285,14 @@ void PluginDescriptor::WriteXML(XMLWriter& writer) const
       writer.WriteAttr(AttrEffectAutomatable, IsEffectAutomatable());
       writer.WriteAttr(AttrEffectInteractive, IsEffectInteractive());
    }
+   else if(GetPluginType() == PluginTypeImporter)
+   {
+      writer.WriteAttr(AttrImporterIdentifier, GetImporterIdentifier());
+      wxString extensions;
+      for(auto& extension : GetImporterExtensions())
+         extensions += extension + wxT(":");
+      writer.WriteAttr(AttrImporterExtensions, extensions);
+   }
    writer.EndTag(XMLNodeName);
 }
 
@@ -323,6 +334,16 @@ bool PluginDescriptor::HandleXMLTag(const std::string_view& tag, const Attribute
             SetEffectFamily(attr.ToWString());
          else if(key == AttrProviderID)
             SetProviderID(attr.ToWString());
+         else if(key == AttrImporterIdentifier)
+            SetImporterIdentifier(attr.ToWString());
+         else if(key == AttrImporterExtensions)
+         {
+            FileExtensions extensions;
+            for(auto& extension : wxSplit(attr.ToWString(), ':', '\0'))
+               if(!extension.empty())
+                  extensions.push_back(extension);
+            SetImporterExtensions(std::move(extensions));
+         }
       }
       return true;
    }
@@ -47,6 +47,16 @@ wxString detail::MakeRequestString(const wxString& providerId, const wxString& p
    return wxJoin(wxArrayStringEx {providerId, pluginPath}, ';');
 }
 
+wxString detail::MakeCommandString(const wxArrayString& fields)
+{
+   return wxJoin(fields, '\n', '\\');
+}
+
+wxArrayString detail::ParseCommandString(const wxString& command)
+{
+   return wxSplit(command, '\n', '\\');
+}
+
 void detail::PutMessage(IPCChannel& channel, const wxString& value)
 {
    auto utf8 = value.ToUTF8();
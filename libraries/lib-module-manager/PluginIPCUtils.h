@@ -32,6 +32,36 @@ namespace detail
    ///return Item string that can be passed as argument to wxConnection::Request
    wxString MakeRequestString(const wxString& providerId, const wxString& pluginPath);
 
+   ///Commands sent by RemoteEffectInstance to PluginProcessHost. Each reply
+   ///begins with ReplyOk or ReplyError, then any results
+   namespace ProcessCommand
+   {
+      ///provider id, plugin path; replies audio in count, audio out count
+      constexpr auto Open = "open";
+      ///maximum block size; replies block size
+      constexpr auto BlockSize = "blocksize";
+      ///shared memory path, audio in count, audio out count, ring capacity
+      constexpr auto Map = "map";
+      ///sample rate, channel names separated by ',', settings parameters;
+      ///replies audio in count, audio out count, latency
+      constexpr auto Initialize = "initialize";
+      ///number of samples; replies number of samples produced,
+      ///microseconds spent processing
+      constexpr auto Process = "process";
+      constexpr auto Finalize = "finalize";
+
+      constexpr auto ReplyOk = "ok";
+      ///followed by a message
+      constexpr auto ReplyError = "error";
+   }
+
+   ///Joins a command and its arguments, which may contain any characters,
+   ///into one message
+   wxString MakeCommandString(const wxArrayString& fields);
+
+   ///Splits a message made by MakeCommandString
+   wxArrayString ParseCommandString(const wxString& command);
+
    ///Writes the length of the string and string bytes into the channel.
    ///Message can be then extracted with InputMessageReader
    void PutMessage(IPCChannel& channel, const wxString& value);
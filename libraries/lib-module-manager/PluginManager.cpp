@@ -24,6 +24,7 @@ for shared and private configs - which need to move out.
 
 
 #include <algorithm>
+#include <set>
 
 #include <wx/log.h>
 #include <wx/tokenzr.h>
@@ -36,6 +37,8 @@ for shared and private configs - which need to move out.
 #include "MemoryX.h"
 #include "ModuleManager.h"
 #include "PlatformCompatibility.h"
+#include "PluginRegistryCache.h"
+#include "PluginScanCache.h"
 #include "Base64.h"
 #include "Variant.h"
 
@@ -540,6 +543,23 @@ bool PluginManager::DropFile(const wxString &fileName)
 
 void PluginManager::Load()
 {
+   // The snapshot saved with an unchanged registry spares parsing it
+   {
+      PluginRegistryVersion regver;
+      std::vector<PluginDescriptor> plugins;
+      if (PluginRegistryCache::Read(
+             FileNames::PluginRegistry(), regver, plugins) &&
+          regver == REGVERCUR)
+      {
+         mRegver = regver;
+         for (auto &plug : plugins) {
+            auto id = plug.GetID();
+            mRegisteredPlugins.emplace(std::move(id), std::move(plug));
+         }
+         return;
+      }
+   }
+
    // Create/Open the registry
    auto pRegistry = sFactory(FileNames::PluginRegistry());
    auto &registry = *pRegistry;
@@ -894,8 +914,25 @@ void PluginManager::Save()
 
    // Just to be safe
    registry.Flush();
+   pRegistry.reset();
 
    mRegver = REGVERCUR;
+
+   std::vector<const PluginDescriptor*> plugins;
+   plugins.reserve(mRegisteredPlugins.size());
+   for (auto &[id, plug] : mRegisteredPlugins)
+      // Only what LoadGroup reads back
+      switch (plug.GetPluginType()) {
+      case PluginTypeModule:
+      case PluginTypeEffect:
+      case PluginTypeImporter:
+      case PluginTypeStub:
+         plugins.push_back(&plug);
+         break;
+      default:
+         break;
+      }
+   PluginRegistryCache::Write(FileNames::PluginRegistry(), mRegver, plugins);
 }
 
 void PluginManager::NotifyPluginsChanged()
@@ -1200,13 +1237,29 @@ void PluginManager::ClearEffectPlugins()
 
 std::map<wxString, std::vector<wxString>> PluginManager::CheckPluginUpdates()
 {
-   wxArrayString pathIndex;
+   PluginScanCache scanCache { *GetSettings() };
+
+   std::set<wxString> pathIndex;
+   std::set<wxString> changedPaths;
    for (auto &pair : mRegisteredPlugins) {
       auto &plug = pair.second;
 
       // Bypass 2.1.0 placeholders...remove this after a few releases past 2.1.0
-      if (plug.GetPluginType() != PluginTypeNone)
-         pathIndex.push_back(plug.GetPath().BeforeFirst(wxT(';')));
+      if (plug.GetPluginType() == PluginTypeNone)
+         continue;
+
+      const auto modulePath = plug.GetPath().BeforeFirst(wxT(';'));
+      if (!pathIndex.insert(modulePath).second)
+         continue;
+
+      // Only modules of providers are files that can change
+      if (plug.GetPluginType() == PluginTypeModule)
+         continue;
+      if (!scanCache.Contains(modulePath))
+         // Registered before the cache existed, assume it is up to date
+         scanCache.Update(modulePath);
+      else if (!scanCache.IsUnchanged(modulePath))
+         changedPaths.insert(modulePath);
    }
 
    // Scan for NEW ones.
@@ -1218,6 +1271,10 @@ std::map<wxString, std::vector<wxString>> PluginManager::CheckPluginUpdates()
    // When the user enables the plugin, each provider that reported it will be asked
    // to register the plugin.
 
+   std::set<wxString> clearedPaths;
+   for (const auto& plug : mEffectPluginsCleared)
+      clearedPaths.insert(plug.GetPath().BeforeFirst(wxT(';')));
+
    auto& moduleManager = ModuleManager::Get();
    std::map<wxString, std::vector<wxString>> newPaths;
    for(auto& [id, provider] : moduleManager.Providers())
@@ -1226,20 +1283,25 @@ std::map<wxString, std::vector<wxString>> PluginManager::CheckPluginUpdates()
       for(const auto& path : paths)
       {
          const auto modulePath = path.BeforeFirst(';');
-         if (!make_iterator_range(pathIndex).contains(modulePath) ||
-            make_iterator_range(mEffectPluginsCleared).any_of([&modulePath](const PluginDescriptor& plug) {
-               return plug.GetPath().BeforeFirst(wxT(';')) == modulePath;
-            })
-         )
+         if (pathIndex.count(modulePath) == 0 ||
+            changedPaths.count(modulePath) != 0 ||
+            clearedPaths.count(modulePath) != 0)
          {
             newPaths[modulePath].push_back(id);
          }
       }
    }
 
+   mSettings->Flush();
+
    return newPaths;
 }
 
+void PluginManager::SetModuleScanned(const wxString& modulePath)
+{
+   PluginScanCache { *GetSettings() }.Update(modulePath);
+}
+
 PluginID PluginManager::GetID(const PluginProvider *provider)
 {
    return ModuleManager::GetID(provider);
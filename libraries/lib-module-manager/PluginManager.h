@@ -171,10 +171,16 @@ public:
    /**
     * \brief Ensures that all currently registered plugins still exist
     * and scans for new ones.
+    * Registered modules that have changed since they were last scanned,
+    * according to the scan cache, are reported as new ones.
     * \return Map, where each module path(key) is associated with at least one provider id
     */
    std::map<wxString, std::vector<wxString>> CheckPluginUpdates();
 
+   //! Remember the present state of the module, so that it is not reported
+   //! by CheckPluginUpdates until it changes
+   void SetModuleScanned(const wxString& modulePath);
+
    //! Used only by Nyquist Workbench module
    const PluginID & RegisterPlugin(
       std::unique_ptr<EffectDefinitionInterface> effect, PluginType type );
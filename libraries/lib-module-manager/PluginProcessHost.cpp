@@ -0,0 +1,332 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginProcessHost.cpp
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#include "PluginProcessHost.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <wx/log.h>
+#include <wx/module.h>
+#include <wx/process.h>
+#include <wx/utils.h>
+
+#include "CommandLineArgs.h"
+#include "EffectAutomationParameters.h"
+#include "FileNames.h"
+#include "IPCClient.h"
+#include "IPCSharedMemory.h"
+#include "ModuleManager.h"
+#include "PlatformCompatibility.h"
+#include "Prefs.h"
+
+using namespace detail;
+
+namespace
+{
+   wxArrayString MakeError(const wxString& message)
+   {
+      wxArrayString reply;
+      reply.push_back(ProcessCommand::ReplyError);
+      reply.push_back(message);
+      return reply;
+   }
+
+   bool LoadSettings(const EffectSettingsManager& manager,
+      const wxString& parameters, EffectSettings& settings)
+   {
+      CommandParameters parms;
+      return parms.SetParameters(parameters) &&
+         manager.LoadSettings(parms, settings);
+   }
+}
+
+PluginProcessHost::PluginProcessHost(int connectPort)
+{
+   FileNames::InitializePathList();
+   InitPreferences(audacity::ApplicationSettings::Call());
+
+   auto& moduleManager = ModuleManager::Get();
+   moduleManager.Initialize();
+   moduleManager.DiscoverProviders();
+
+   mClient = std::make_unique<IPCClient>(connectPort, *this);
+}
+
+PluginProcessHost::~PluginProcessHost() = default;
+
+void PluginProcessHost::OnConnect(IPCChannel& channel) noexcept
+{
+   std::lock_guard lck(mSync);
+   mChannel = &channel;
+}
+
+void PluginProcessHost::OnDisconnect() noexcept
+{
+   Stop();
+}
+
+void PluginProcessHost::OnConnectionError() noexcept
+{
+   Stop();
+}
+
+void PluginProcessHost::OnDataAvailable(const void* data, size_t size) noexcept
+{
+   try
+   {
+      mInputMessageReader.ConsumeBytes(data, size);
+      if(mInputMessageReader.CanPop())
+      {
+         {
+            std::lock_guard lck(mSync);
+            assert(!mRequest);
+            mRequest = mInputMessageReader.Pop();
+         }
+         mRequestCondition.notify_one();
+      }
+   }
+   catch(...)
+   {
+      Stop();
+   }
+}
+
+bool PluginProcessHost::Serve()
+{
+   std::unique_lock lck(mSync);
+   mRequestCondition.wait(lck, [this]{ return !mRunning || mRequest.has_value(); });
+
+   if(!mRunning)
+      return false;
+
+   std::optional<wxString> request;
+   mRequest.swap(request);
+   lck.unlock();
+
+   wxArrayString reply;
+   try
+   {
+      reply = Handle(ParseCommandString(*request));
+   }
+   catch(...)
+   {
+      reply = MakeError("exception in plugin");
+   }
+
+   lck.lock();
+   if(mChannel)
+      PutMessage(*mChannel, MakeCommandString(reply));
+   return true;
+}
+
+wxArrayString PluginProcessHost::Handle(const wxArrayString& request)
+{
+   if(request.empty())
+      return MakeError("empty request");
+
+   const auto& command = request[0];
+   wxArrayString reply;
+   reply.push_back(ProcessCommand::ReplyOk);
+
+   if(command == ProcessCommand::Open && request.size() == 3)
+   {
+      mPlugin = ModuleManager::Get().LoadPlugin(request[1], request[2]);
+      mFactory = dynamic_cast<const EffectInstanceFactory*>(mPlugin.get());
+      if(mFactory == nullptr)
+         return MakeError("not an effect");
+      mSettings = mFactory->MakeSettings();
+      mInstance = mFactory->MakeInstance();
+      if(!mInstance)
+         return MakeError("no instance");
+      reply.push_back(wxString::Format("%u", mInstance->GetAudioInCount()));
+      reply.push_back(wxString::Format("%u", mInstance->GetAudioOutCount()));
+      return reply;
+   }
+   if(!mInstance)
+      return MakeError("no plugin is open");
+
+   if(command == ProcessCommand::BlockSize && request.size() == 2)
+   {
+      unsigned long maxBlockSize;
+      if(!request[1].ToULong(&maxBlockSize))
+         return MakeError("malformed block size");
+      reply.push_back(
+         wxString::Format("%zu", mInstance->SetBlockSize(maxBlockSize)));
+      return reply;
+   }
+   if(command == ProcessCommand::Map && request.size() == 5)
+   {
+      unsigned long audioIn, audioOut, capacity;
+      if(!request[2].ToULong(&audioIn) || !request[3].ToULong(&audioOut) ||
+         !request[4].ToULong(&capacity) || capacity == 0)
+         return MakeError("malformed mapping");
+      mInput.reset();
+      mOutput.reset();
+      const auto outputOffset = GetOutputRingOffset(audioIn, capacity);
+      mMemory = IPCSharedMemory::Open(std::string { request[1].ToUTF8() },
+         outputOffset + IPCSampleRing::GetRequiredSize(audioOut, capacity));
+      if(!mMemory)
+         return MakeError("cannot map shared memory");
+      const auto data = static_cast<char*>(mMemory->GetData());
+      mInput.emplace(data, audioIn, capacity, false);
+      mOutput.emplace(data + outputOffset, audioOut, capacity, false);
+      mInputPointers.resize(audioIn);
+      mOutputPointers.resize(audioOut);
+      return reply;
+   }
+   if(command == ProcessCommand::Initialize && request.size() == 4)
+   {
+      if(!request[1].ToCDouble(&mSampleRate))
+         return MakeError("malformed sample rate");
+      std::vector<ChannelName> channelNames;
+      for(const auto& name : wxSplit(request[2], ','))
+      {
+         long value;
+         if(!name.ToLong(&value))
+            return MakeError("malformed channel names");
+         channelNames.push_back(static_cast<ChannelName>(value));
+      }
+      channelNames.push_back(ChannelNameEOL);
+      if(!LoadSettings(*mFactory, request[3], mSettings))
+         return MakeError("cannot load settings");
+      if(!mInstance->ProcessInitialize(
+         mSettings, mSampleRate, channelNames.data()))
+         return MakeError("initialization failed");
+      reply.push_back(wxString::Format("%u", mInstance->GetAudioInCount()));
+      reply.push_back(wxString::Format("%u", mInstance->GetAudioOutCount()));
+      reply.push_back(wxString::Format("%llu", static_cast<unsigned long long>(
+         mInstance->GetLatency(mSettings, mSampleRate))));
+      return reply;
+   }
+   if(command == ProcessCommand::Process && request.size() == 2)
+   {
+      unsigned long count;
+      if(!request[1].ToULong(&count))
+         return MakeError("malformed sample count");
+      if(!mInput || !mOutput)
+         return MakeError("no shared memory");
+
+      const auto start = std::chrono::steady_clock::now();
+      size_t remaining = count;
+      size_t produced = 0;
+      while(remaining > 0)
+      {
+         // Process in place, taking spans that don't wrap around
+         const auto length = std::min({ remaining,
+            mInput->GetContiguousReadable(),
+            mOutput->GetContiguousWritable() });
+         if(length == 0)
+            break;
+         for(unsigned channel = 0; channel < mInputPointers.size(); ++channel)
+            mInputPointers[channel] = mInput->GetReadPointer(channel);
+         for(unsigned channel = 0; channel < mOutputPointers.size(); ++channel)
+            mOutputPointers[channel] = mOutput->GetWritePointer(channel);
+         const auto processed = mInstance->ProcessBlock(mSettings,
+            mInputPointers.data(), mOutputPointers.data(), length);
+         mInput->CommitRead(length);
+         mOutput->CommitWrite(std::min(processed, length));
+         produced += std::min(processed, length);
+         remaining -= length;
+      }
+      const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+         std::chrono::steady_clock::now() - start);
+
+      reply.push_back(wxString::Format("%zu", produced));
+      reply.push_back(wxString::Format("%lld",
+         static_cast<long long>(elapsed.count())));
+      return reply;
+   }
+   if(command == ProcessCommand::Finalize && request.size() == 1)
+   {
+      if(!mInstance->ProcessFinalize())
+         return MakeError("finalization failed");
+      return reply;
+   }
+   return MakeError("unknown command");
+}
+
+void PluginProcessHost::Stop() noexcept
+{
+   try
+   {
+      std::lock_guard lck(mSync);
+      mRunning = false;
+      mChannel = nullptr;
+   }
+   catch(...)
+   {
+   }
+   mRequestCondition.notify_one();
+}
+
+size_t PluginProcessHost::GetOutputRingOffset(unsigned audioIn, size_t capacity)
+   noexcept
+{
+   // Keep the second header on its own cache line
+   constexpr size_t alignment = 64;
+   const auto size = IPCSampleRing::GetRequiredSize(audioIn, capacity);
+   return (size + alignment - 1) / alignment * alignment;
+}
+
+long PluginProcessHost::Start(int connectPort)
+{
+   const auto cmd = wxString::Format("\"%s\" %s %d",
+      PlatformCompatibility::GetExecutablePath(),
+      PluginProcessHost::HostArgument,
+      connectPort);
+
+   auto process = std::make_unique<wxProcess>();
+   process->Detach();
+   const auto pid = wxExecute(cmd, wxEXEC_ASYNC, process.get());
+   if(pid != 0)
+      //process will delete itself upon termination
+      process.release();
+   return pid;
+}
+
+bool PluginProcessHost::IsHostProcess()
+{
+   return CommandLineArgs::argc >= 3 &&
+      wxStrcmp(CommandLineArgs::argv[1], HostArgument) == 0;
+}
+
+class PluginProcessHostModule final :
+   public wxModule
+{
+public:
+   DECLARE_DYNAMIC_CLASS(PluginProcessHostModule)
+
+   bool OnInit() override
+   {
+      if(PluginProcessHost::IsHostProcess())
+      {
+         long connectPort;
+         if(!wxString{ CommandLineArgs::argv[2] }.ToLong(&connectPort))
+            return false;
+
+         wxLog::EnableLogging(false);
+
+         //Handle requests...
+         PluginProcessHost host(connectPort);
+         while(host.Serve()) { }
+         //...and terminate app
+         return false;
+      }
+      //do nothing if current process isn't a processing host
+      return true;
+   }
+
+   void OnExit() override
+   {
+
+   }
+};
+IMPLEMENT_DYNAMIC_CLASS(PluginProcessHostModule, wxModule);
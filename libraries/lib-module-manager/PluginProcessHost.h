@@ -0,0 +1,92 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginProcessHost.h
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <wx/string.h>
+
+#include "EffectInterface.h"
+#include "IPCChannel.h"
+#include "IPCSampleRing.h"
+#include "PluginIPCUtils.h"
+
+class ComponentInterface;
+class IPCClient;
+class IPCSharedMemory;
+
+/**
+ * \brief Internal class, applies one plugin effect in a process of its
+ * own on behalf of a RemoteEffectInstance in the main app.
+ * Commands (see detail::ProcessCommand) arrive over lib-ipc, one at a
+ * time, and each is answered before the next is sent. Samples don't travel
+ * through the channel: the plugin processes them in place, in rings mapped
+ * from a file that both processes share.
+ */
+class MODULE_MANAGER_API PluginProcessHost final
+   : public IPCChannelStatusCallback
+{
+   static constexpr auto HostArgument = "--process-host";
+
+   std::unique_ptr<IPCClient> mClient;
+   IPCChannel* mChannel{nullptr};
+   detail::InputMessageReader mInputMessageReader;
+   std::mutex mSync;
+   std::condition_variable mRequestCondition;
+   std::optional<wxString> mRequest;
+
+   bool mRunning{true};
+
+   std::unique_ptr<ComponentInterface> mPlugin;
+   const EffectInstanceFactory* mFactory{nullptr};
+   std::shared_ptr<EffectInstance> mInstance;
+   EffectSettings mSettings;
+   double mSampleRate{0};
+
+   std::unique_ptr<IPCSharedMemory> mMemory;
+   std::optional<IPCSampleRing> mInput;
+   std::optional<IPCSampleRing> mOutput;
+   std::vector<const float*> mInputPointers;
+   std::vector<float*> mOutputPointers;
+
+   void Stop() noexcept;
+
+   ///Returns the reply to a request
+   wxArrayString Handle(const wxArrayString& request);
+
+public:
+   /**
+    * \brief Attempts to start a host application (should be called from
+    * the main application)
+    * \return process id of the host, or 0 if it didn't start
+    */
+   static long Start(int connectPort);
+
+   ///Returns true if current process is considered to be a processing host
+   static bool IsHostProcess();
+
+   ///Shared memory holds the input ring at offset 0, and the output ring at
+   ///the offset returned by this function
+   static size_t GetOutputRingOffset(unsigned audioIn, size_t capacity) noexcept;
+
+   explicit PluginProcessHost(int connectPort);
+   ~PluginProcessHost() override;
+
+   void OnConnect(IPCChannel& channel) noexcept override;
+   void OnDisconnect() noexcept override;
+   void OnConnectionError() noexcept override;
+   void OnDataAvailable(const void* data, size_t size) noexcept override;
+
+   bool Serve();
+};
@@ -0,0 +1,135 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginRegistryCache.cpp
+
+  Part of lib-module-manager library.
+
+**********************************************************************/
+
+#include "PluginRegistryCache.h"
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include "PluginScanCache.h"
+#include "XMLFileReader.h"
+#include "XMLWriter.h"
+
+namespace
+{
+   constexpr auto NodeRegistry = "PluginRegistryCache";
+   constexpr auto AttrRegistryVersion = "registry_version";
+   constexpr auto AttrRegistrySize = "registry_size";
+   constexpr auto AttrRegistryHash = "registry_hash";
+
+   FilePath GetCachePath(const FilePath& registryPath)
+   {
+      wxFileName fileName { registryPath };
+      fileName.SetExt(wxT("xml"));
+      return fileName.GetFullPath();
+   }
+
+   //! Size and contents of the registry file, as a string for an attribute
+   wxString GetRegistryStamp(const FilePath& registryPath, wxString& size)
+   {
+      PluginScanCache::Fingerprint fingerprint;
+      if(!PluginScanCache::GetFingerprint(registryPath, fingerprint, true))
+         return {};
+      size = wxString::Format(wxT("%lld"), fingerprint.size);
+      return wxString::Format(wxT("%llx"),
+         static_cast<unsigned long long>(fingerprint.hash));
+   }
+
+   class CacheHandler final : public XMLTagHandler
+   {
+   public:
+      wxString regver;
+      wxString size;
+      wxString hash;
+      std::vector<PluginDescriptor> plugins;
+
+      bool HandleXMLTag(
+         const std::string_view& tag, const AttributesList& attrs) override
+      {
+         if(tag != NodeRegistry)
+            return false;
+         for(auto& p : attrs)
+         {
+            auto key = wxString(p.first.data(), p.first.length());
+            auto& attr = p.second;
+            if(key == AttrRegistryVersion)
+               regver = attr.ToWString();
+            else if(key == AttrRegistrySize)
+               size = attr.ToWString();
+            else if(key == AttrRegistryHash)
+               hash = attr.ToWString();
+         }
+         return true;
+      }
+
+      XMLTagHandler* HandleXMLChild(const std::string_view& tag) override
+      {
+         if(tag == PluginDescriptor::XMLNodeName)
+         {
+            plugins.resize(plugins.size() + 1);
+            return &plugins.back();
+         }
+         return nullptr;
+      }
+   };
+}
+
+bool PluginRegistryCache::Read(const FilePath& registryPath,
+   PluginRegistryVersion& regver, std::vector<PluginDescriptor>& plugins)
+{
+   const auto cachePath = GetCachePath(registryPath);
+   if(!wxFileExists(cachePath))
+      return false;
+
+   CacheHandler handler;
+   XMLFileReader reader;
+   if(!reader.Parse(&handler, cachePath))
+      return false;
+
+   wxString size;
+   const auto hash = GetRegistryStamp(registryPath, size);
+   if(hash.empty() || hash != handler.hash || size != handler.size)
+      return false;
+
+   regver = handler.regver;
+   plugins = std::move(handler.plugins);
+   return true;
+}
+
+void PluginRegistryCache::Write(const FilePath& registryPath,
+   const PluginRegistryVersion& regver,
+   const std::vector<const PluginDescriptor*>& plugins)
+{
+   const auto cachePath = GetCachePath(registryPath);
+   wxString size;
+   const auto hash = GetRegistryStamp(registryPath, size);
+   if(hash.empty())
+   {
+      wxRemoveFile(cachePath);
+      return;
+   }
+
+   XMLStringWriter writer;
+   writer.StartTag(NodeRegistry);
+   writer.WriteAttr(AttrRegistryVersion, regver);
+   writer.WriteAttr(AttrRegistrySize, size);
+   writer.WriteAttr(AttrRegistryHash, hash);
+   for(auto pPlugin : plugins)
+      pPlugin->WriteXML(writer);
+   writer.EndTag(NodeRegistry);
+
+   // A snapshot that can't be written is of no use:  remove any stale one
+   wxFFile file { cachePath, wxT("wb") };
+   if(!file.IsOpened() || !file.Write(writer, wxConvUTF8) || !file.Close())
+   {
+      file.Close();
+      wxRemoveFile(cachePath);
+   }
+}
@@ -0,0 +1,37 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginRegistryCache.h
+
+  @brief A snapshot of the plugin registry that loads faster than the
+  registry itself
+
+  Part of lib-module-manager library.
+
+**********************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "PluginDescriptor.h"
+
+namespace PluginRegistryCache
+{
+   /**
+    * \brief Reads the descriptors saved with the registry, if the registry
+    * is exactly as when they were saved.
+    *
+    * The registry itself stays the storage that other versions of Audacity
+    * read and write; the snapshot is XML parsed in one pass, without the
+    * lookups of the configuration file.
+    * @return false if there is no snapshot, or the registry changed since
+    */
+   bool Read(const FilePath& registryPath, PluginRegistryVersion& regver,
+      std::vector<PluginDescriptor>& plugins);
+
+   //! Saves the descriptors that were just written to the registry
+   void Write(const FilePath& registryPath, const PluginRegistryVersion& regver,
+      const std::vector<const PluginDescriptor*>& plugins);
+}
@@ -0,0 +1,175 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginScanCache.cpp
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#include "PluginScanCache.h"
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include "BasicSettings.h"
+
+#define SCANCACHEROOT wxString(wxT("/pluginscancache/"))
+
+#define KEY_PATH     wxT("Path")
+#define KEY_SIZE     wxT("Size")
+#define KEY_MODIFIED wxT("Modified")
+#define KEY_HASH     wxT("Hash")
+
+namespace
+{
+   constexpr std::uint64_t FNVOffsetBasis = 14695981039346656037ull;
+   constexpr std::uint64_t FNVPrime = 1099511628211ull;
+
+   std::uint64_t FNV1a(std::uint64_t hash, const unsigned char* data, size_t size)
+   {
+      for(size_t i = 0; i < size; ++i)
+      {
+         hash ^= data[i];
+         hash *= FNVPrime;
+      }
+      return hash;
+   }
+}
+
+PluginScanCache::PluginScanCache(audacity::BasicSettings& settings)
+   : mSettings(settings)
+{
+}
+
+bool PluginScanCache::IsUnchanged(const wxString& modulePath)
+{
+   Fingerprint remembered;
+   if(!Read(modulePath, remembered))
+      return false;
+
+   Fingerprint current;
+   if(!GetFingerprint(modulePath, current, false))
+      return false;
+
+   if(current.size == remembered.size && current.modified == remembered.modified)
+      return true;
+
+   //Files that differ in size have changed, contents of directories are
+   //not hashed
+   if(current.size != remembered.size || remembered.hash == 0)
+      return false;
+
+   current.hash = HashFile(modulePath);
+   if(current.hash != remembered.hash)
+      return false;
+
+   Write(modulePath, current);
+   return true;
+}
+
+bool PluginScanCache::Contains(const wxString& modulePath) const
+{
+   return mSettings.HasGroup(GetGroup(modulePath));
+}
+
+void PluginScanCache::Update(const wxString& modulePath)
+{
+   Fingerprint fingerprint;
+   if(GetFingerprint(modulePath, fingerprint, true))
+      Write(modulePath, fingerprint);
+   else
+      Remove(modulePath);
+}
+
+void PluginScanCache::Remove(const wxString& modulePath)
+{
+   const auto group = GetGroup(modulePath);
+   if(mSettings.HasGroup(group))
+      mSettings.DeleteGroup(group);
+}
+
+bool PluginScanCache::GetFingerprint(const wxString& modulePath, Fingerprint& fingerprint, bool computeHash)
+{
+   if(wxFileName::DirExists(modulePath))
+   {
+      const auto modified = wxFileName::DirName(modulePath).GetModificationTime();
+      if(!modified.IsValid())
+         return false;
+      fingerprint = { 0, modified.GetValue().GetValue(), 0 };
+      return true;
+   }
+
+   const wxFileName fileName { modulePath };
+   if(!fileName.FileExists())
+      return false;
+   const auto modified = fileName.GetModificationTime();
+   const auto size = fileName.GetSize();
+   if(!modified.IsValid() || size == wxInvalidSize)
+      return false;
+   fingerprint = {
+      static_cast<long long>(size.GetValue()),
+      modified.GetValue().GetValue(),
+      computeHash ? HashFile(modulePath) : 0
+   };
+   return true;
+}
+
+std::uint64_t PluginScanCache::HashFile(const wxString& path)
+{
+   wxFFile file { path, wxT("rb") };
+   if(!file.IsOpened())
+      return 0;
+
+   auto hash = FNVOffsetBasis;
+   unsigned char buffer[64 * 1024];
+   size_t read;
+   while((read = file.Read(buffer, sizeof(buffer))) > 0)
+      hash = FNV1a(hash, buffer, read);
+   return hash;
+}
+
+wxString PluginScanCache::GetGroup(const wxString& modulePath)
+{
+   //Paths may contain characters not allowed in group names, use a
+   //hash of the path instead; the path itself is stored to detect
+   //collisions
+   const auto utf8 = modulePath.utf8_str();
+   const auto hash = FNV1a(FNVOffsetBasis,
+      reinterpret_cast<const unsigned char*>(utf8.data()), utf8.length());
+   return SCANCACHEROOT + wxString::Format(wxT("%016llx"), static_cast<unsigned long long>(hash));
+}
+
+bool PluginScanCache::Read(const wxString& modulePath, Fingerprint& fingerprint) const
+{
+   const auto group = GetGroup(modulePath);
+   if(!mSettings.HasGroup(group))
+      return false;
+
+   auto scope = mSettings.BeginGroup(group);
+   if(mSettings.Read(KEY_PATH, wxString{}) != modulePath)
+      return false;
+
+   wxString hash;
+   if(!mSettings.Read(KEY_SIZE, &fingerprint.size) ||
+      !mSettings.Read(KEY_MODIFIED, &fingerprint.modified) ||
+      !mSettings.Read(KEY_HASH, &hash))
+      return false;
+
+   unsigned long long value{};
+   if(!hash.ToULongLong(&value, 16))
+      return false;
+   fingerprint.hash = value;
+   return true;
+}
+
+void PluginScanCache::Write(const wxString& modulePath, const Fingerprint& fingerprint)
+{
+   auto scope = mSettings.BeginGroup(GetGroup(modulePath));
+   mSettings.Write(KEY_PATH, modulePath);
+   mSettings.Write(KEY_SIZE, fingerprint.size);
+   mSettings.Write(KEY_MODIFIED, fingerprint.modified);
+   mSettings.Write(KEY_HASH,
+      wxString::Format(wxT("%llx"), static_cast<unsigned long long>(fingerprint.hash)));
+}
@@ -0,0 +1,68 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginScanCache.h
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include <wx/string.h>
+
+namespace audacity
+{
+   class BasicSettings;
+}
+
+/**
+ * \brief Remembers what plugin modules looked like when they were last
+ * scanned, so that only the changed ones are scanned again.
+ *
+ * A module is identified by its path, and its state by the modification
+ * time and size of the file; the contents are hashed only when those
+ * differ from the remembered ones, so that a module that was merely
+ * touched or reinstalled is not scanned again either. Bundles (directories)
+ * are identified by modification time only.
+ */
+class MODULE_MANAGER_API PluginScanCache final
+{
+   audacity::BasicSettings& mSettings;
+public:
+   struct Fingerprint
+   {
+      long long size{};
+      long long modified{};
+      //! FNV-1a of the contents, zero for directories or if not computed
+      std::uint64_t hash{};
+   };
+
+   explicit PluginScanCache(audacity::BasicSettings& settings);
+
+   /**
+    * \brief Whether the module was scanned before and has not changed since.
+    * Updates the remembered modification time if only that changed.
+    */
+   bool IsUnchanged(const wxString& modulePath);
+
+   //! Whether anything is remembered about the module
+   bool Contains(const wxString& modulePath) const;
+
+   //! Remember the present state of the module as scanned
+   void Update(const wxString& modulePath);
+
+   void Remove(const wxString& modulePath);
+
+   //! @return false if the module does not exist
+   static bool GetFingerprint(const wxString& modulePath, Fingerprint& fingerprint, bool computeHash);
+   static std::uint64_t HashFile(const wxString& path);
+
+private:
+   static wxString GetGroup(const wxString& modulePath);
+   bool Read(const wxString& modulePath, Fingerprint& fingerprint) const;
+   void Write(const wxString& modulePath, const Fingerprint& fingerprint);
+};
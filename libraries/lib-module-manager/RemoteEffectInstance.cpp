@@ -0,0 +1,407 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RemoteEffectInstance.cpp
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#include "RemoteEffectInstance.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/process.h>
+
+#include "EffectAutomationParameters.h"
+#include "IPCServer.h"
+#include "IPCSharedMemory.h"
+#include "PluginManager.h"
+#include "PluginProcessHost.h"
+#include "Prefs.h"
+#include "wxArrayStringEx.h"
+
+using namespace detail;
+
+BoolSetting RemoteEffectInstance::Enabled{
+   L"/Effects/OutOfProcessPlugins", false };
+
+namespace
+{
+   //! Loading a plugin may be slow
+   constexpr std::chrono::milliseconds OpenTimeout{ 30000 };
+   //! Any other command, including processing of one block
+   constexpr std::chrono::milliseconds CommandTimeout{ 5000 };
+
+   //! For instances that are initialized without being given a block size
+   constexpr size_t DefaultBlockSize = 4096;
+
+   wxArrayStringEx MakeCommand(
+      const char* name, std::initializer_list<wxString> arguments = {})
+   {
+      wxArrayStringEx command { wxString { name } };
+      command.insert(command.end(), arguments);
+      return command;
+   }
+
+   //! Families of plugins that run foreign code
+   bool IsExternalFamily(const wxString& family)
+   {
+      for(auto name : { "VST", "VST3", "LV2", "LADSPA", "AudioUnit" })
+         if(family == name)
+            return true;
+      return false;
+   }
+}
+
+double RemoteEffectInstance::Statistics::MeanOverheadMicroseconds() const
+   noexcept
+{
+   if(blocks == 0)
+      return 0;
+   return static_cast<double>((roundTrip - processing).count()) / blocks;
+}
+
+std::shared_ptr<RemoteEffectInstance>
+RemoteEffectInstance::Create(const EffectInstanceFactory& effect)
+{
+   if(!Enabled.Read())
+      return {};
+   const auto pDescriptor =
+      PluginManager::Get().GetPlugin(PluginManager::GetID(&effect));
+   if(pDescriptor == nullptr ||
+      !IsExternalFamily(pDescriptor->GetEffectFamily()))
+      return {};
+
+   auto result = std::make_shared<RemoteEffectInstance>(CreateToken{}, effect);
+   try
+   {
+      if(!result->Start(pDescriptor->GetProviderID(), pDescriptor->GetPath()))
+         return {};
+   }
+   catch(...)
+   {
+      return {};
+   }
+   return result;
+}
+
+RemoteEffectInstance::RemoteEffectInstance(
+   CreateToken, const EffectInstanceFactory& effect)
+   : mManager{ effect }
+   , mName{ effect.GetSymbol().Internal() }
+{
+}
+
+RemoteEffectInstance::~RemoteEffectInstance()
+{
+   {
+      std::lock_guard lck(mSync);
+      // Disconnection now is not a failure
+      mStopping = true;
+   }
+   // The host exits when disconnected, unless hung, and then it was killed
+   mServer.reset();
+}
+
+bool RemoteEffectInstance::Start(
+   const wxString& providerId, const wxString& pluginPath)
+{
+   mServer = std::make_unique<IPCServer>(*this);
+   mPid = PluginProcessHost::Start(mServer->GetConnectPort());
+   if(mPid == 0)
+      return false;
+   {
+      std::unique_lock lck(mSync);
+      if(!mCondition.wait_for(lck, OpenTimeout,
+         [this]{ return mChannel != nullptr || mFailed; }) || mFailed)
+      {
+         Abandon();
+         return false;
+      }
+   }
+   const auto results =
+      Call(
+      MakeCommand(ProcessCommand::Open, { providerId, pluginPath }), OpenTimeout);
+   unsigned long audioIn, audioOut;
+   if(!results || results->size() != 2 ||
+      !(*results)[0].ToULong(&audioIn) || !(*results)[1].ToULong(&audioOut))
+      return false;
+   mAudioIn = audioIn;
+   mAudioOut = audioOut;
+   return true;
+}
+
+std::optional<wxArrayString> RemoteEffectInstance::Call(
+   const wxArrayString& command, std::chrono::milliseconds timeout)
+{
+   std::unique_lock lck(mSync);
+   if(mFailed || mChannel == nullptr)
+      return {};
+   mReply.reset();
+   try
+   {
+      PutMessage(*mChannel, MakeCommandString(command));
+   }
+   catch(...)
+   {
+      Abandon();
+      return {};
+   }
+   if(!mCondition.wait_for(lck, timeout,
+      [this]{ return mReply.has_value() || mFailed; }) || mFailed)
+   {
+      wxLogDebug("Plugin processing host of %s stopped responding", mName);
+      Abandon();
+      return {};
+   }
+
+   auto reply = ParseCommandString(*mReply);
+   mReply.reset();
+   if(reply.empty() || reply[0] != ProcessCommand::ReplyOk)
+   {
+      wxLogDebug("Plugin processing host of %s failed: %s", mName,
+         reply.size() > 1 ? reply[1] : wxString{});
+      return {};
+   }
+   reply.erase(reply.begin());
+   return reply;
+}
+
+void RemoteEffectInstance::Abandon() noexcept
+{
+   mFailed = true;
+   mChannel = nullptr;
+   if(mPid != 0)
+   {
+      wxProcess::Kill(mPid, wxSIGKILL);
+      mPid = 0;
+   }
+}
+
+void RemoteEffectInstance::OnConnect(IPCChannel& channel) noexcept
+{
+   {
+      std::lock_guard lck(mSync);
+      mChannel = &channel;
+   }
+   mCondition.notify_all();
+}
+
+void RemoteEffectInstance::OnDisconnect() noexcept
+{
+   {
+      std::lock_guard lck(mSync);
+      mChannel = nullptr;
+      if(!mStopping)
+         mFailed = true;
+   }
+   mCondition.notify_all();
+}
+
+void RemoteEffectInstance::OnConnectionError() noexcept
+{
+   OnDisconnect();
+}
+
+void RemoteEffectInstance::OnDataAvailable(const void* data, size_t size)
+   noexcept
+{
+   try
+   {
+      {
+         std::lock_guard lck(mSync);
+         mInputMessageReader.ConsumeBytes(data, size);
+         if(mInputMessageReader.CanPop())
+            mReply = mInputMessageReader.Pop();
+      }
+      mCondition.notify_all();
+   }
+   catch(...)
+   {
+      OnDisconnect();
+   }
+}
+
+size_t RemoteEffectInstance::GetBlockSize() const
+{
+   return mBlockSize;
+}
+
+size_t RemoteEffectInstance::SetBlockSize(size_t maxBlockSize)
+{
+   const auto results = Call(MakeCommand(ProcessCommand::BlockSize,
+      { wxString::Format("%zu", maxBlockSize) }), CommandTimeout);
+   unsigned long blockSize;
+   if(!results || results->size() != 1 || !(*results)[0].ToULong(&blockSize))
+      return 0;
+   return mBlockSize = blockSize;
+}
+
+unsigned RemoteEffectInstance::GetAudioInCount() const
+{
+   return mAudioIn;
+}
+
+unsigned RemoteEffectInstance::GetAudioOutCount() const
+{
+   return mAudioOut;
+}
+
+auto RemoteEffectInstance::GetLatency(
+   const EffectSettings&, double) const -> SampleCount
+{
+   return mLatency;
+}
+
+bool RemoteEffectInstance::ProcessInitialize(EffectSettings& settings,
+   double sampleRate, ChannelNames chanMap)
+{
+   // Only the first instance of an effect stage is given a block size
+   if(mBlockSize == 0 && SetBlockSize(DefaultBlockSize) == 0)
+      return false;
+
+   CommandParameters parms;
+   wxString parameters;
+   if(!mManager.SaveSettings(settings, parms) ||
+      !parms.GetParameters(parameters))
+      return false;
+
+   wxArrayString channelNames;
+   for(auto name = chanMap; name && *name != ChannelNameEOL; ++name)
+      channelNames.push_back(wxString::Format("%d", static_cast<int>(*name)));
+
+   const auto results = Call(MakeCommand(ProcessCommand::Initialize, {
+      wxString::FromCDouble(sampleRate),
+      wxJoin(channelNames, ','), parameters }), CommandTimeout);
+   unsigned long audioIn, audioOut;
+   unsigned long long latency;
+   if(!results || results->size() != 3 ||
+      !(*results)[0].ToULong(&audioIn) || !(*results)[1].ToULong(&audioOut) ||
+      !(*results)[2].ToULongLong(&latency))
+      return false;
+   mAudioIn = audioIn;
+   mAudioOut = audioOut;
+   mLatency = latency;
+   return EnsureRings();
+}
+
+bool RemoteEffectInstance::EnsureRings()
+{
+   if(mBlockSize == 0)
+      return false;
+   if(mInput && mOutput && mInput->GetChannels() == mAudioIn &&
+      mOutput->GetChannels() == mAudioOut &&
+      mInput->GetCapacity() == mBlockSize)
+      return true;
+
+   mInput.reset();
+   mOutput.reset();
+   mMemory.reset();
+   const auto path = wxFileName::CreateTempFileName(
+      wxFileName::GetTempDir() + wxFILE_SEP_PATH + "audacity-plugin");
+   if(path.empty())
+      return false;
+   const auto outputOffset =
+      PluginProcessHost::GetOutputRingOffset(mAudioIn, mBlockSize);
+   mMemory = IPCSharedMemory::Create(std::string { path.ToUTF8() },
+      outputOffset + IPCSampleRing::GetRequiredSize(mAudioOut, mBlockSize));
+   if(!mMemory)
+      return false;
+   const auto data = static_cast<char*>(mMemory->GetData());
+   mInput.emplace(data, mAudioIn, mBlockSize, true);
+   mOutput.emplace(data + outputOffset, mAudioOut, mBlockSize, true);
+
+   return Call(MakeCommand(ProcessCommand::Map, { path,
+      wxString::Format("%u", mAudioIn), wxString::Format("%u", mAudioOut),
+      wxString::Format("%zu", mBlockSize) }), CommandTimeout).has_value();
+}
+
+size_t RemoteEffectInstance::ProcessBlock(EffectSettings&,
+   const float* const* inBlock, float* const* outBlock, size_t blockLen)
+{
+   if(!mInput || !mOutput)
+      return 0;
+
+   size_t produced = 0;
+   for(size_t done = 0; done < blockLen;)
+   {
+      // Fill what the ring holds; the host sees it when the command arrives
+      const auto count = std::min(blockLen - done, mInput->GetWritable());
+      for(size_t written = 0; written < count;)
+      {
+         const auto length =
+            std::min(count - written, mInput->GetContiguousWritable());
+         for(unsigned channel = 0; channel < mAudioIn; ++channel)
+            std::memcpy(mInput->GetWritePointer(channel),
+               inBlock[channel] + done + written, length * sizeof(float));
+         mInput->CommitWrite(length);
+         written += length;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      const auto results = Call(MakeCommand(ProcessCommand::Process,
+         { wxString::Format("%zu", count) }), CommandTimeout);
+      const auto roundTrip =
+         std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+      unsigned long result;
+      long long processing;
+      if(!results || results->size() != 2 ||
+         !(*results)[0].ToULong(&result) ||
+         !(*results)[1].ToLongLong(&processing) ||
+         result > mOutput->GetReadable() || produced + result > blockLen)
+         return 0;
+
+      for(size_t read = 0; read < result;)
+      {
+         const auto length =
+            std::min<size_t>(result - read, mOutput->GetContiguousReadable());
+         for(unsigned channel = 0; channel < mAudioOut; ++channel)
+            std::memcpy(outBlock[channel] + produced + read,
+               mOutput->GetReadPointer(channel), length * sizeof(float));
+         mOutput->CommitRead(length);
+         read += length;
+      }
+      produced += result;
+      done += count;
+
+      std::lock_guard lck(mSync);
+      ++mStatistics.blocks;
+      mStatistics.roundTrip += roundTrip;
+      mStatistics.processing += std::chrono::microseconds{ processing };
+   }
+   return produced;
+}
+
+bool RemoteEffectInstance::ProcessFinalize() noexcept
+{
+   try
+   {
+      const auto result =
+         Call(MakeCommand(ProcessCommand::Finalize), CommandTimeout).has_value();
+      const auto statistics = GetStatistics();
+      if(statistics.blocks > 0)
+         wxLogInfo("%s processed out of process: %llu blocks, "
+            "mean round trip %.1f us, of which IPC overhead %.1f us",
+            mName, static_cast<unsigned long long>(statistics.blocks),
+            static_cast<double>(statistics.roundTrip.count()) /
+               statistics.blocks,
+            statistics.MeanOverheadMicroseconds());
+      return result;
+   }
+   catch(...)
+   {
+      return false;
+   }
+}
+
+auto RemoteEffectInstance::GetStatistics() const -> Statistics
+{
+   std::lock_guard lck(mSync);
+   return mStatistics;
+}
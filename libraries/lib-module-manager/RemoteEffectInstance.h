@@ -0,0 +1,139 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RemoteEffectInstance.h
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+#include "EffectInterface.h"
+#include "IPCChannel.h"
+#include "IPCSampleRing.h"
+#include "PluginIPCUtils.h"
+
+class BoolSetting;
+class IPCServer;
+class IPCSharedMemory;
+
+/**
+ * \brief EffectInstance that applies a plugin effect in a
+ * PluginProcessHost process of its own, so that a plugin that crashes or
+ * hangs fails the processing instead of the application, and plugins in
+ * separate instances run on separate cores.
+ *
+ * Samples are copied into and out of rings in memory shared with the host,
+ * where the plugin processes them in place; one command per block, over
+ * lib-ipc, tells the host how many samples are ready. The time spent by
+ * those round trips, beyond the processing itself, is measured, and
+ * reported for each instance when processing finishes.
+ *
+ * Only destructive processing is forwarded. The instance is not one the
+ * plugin's own editor could use.
+ */
+class MODULE_MANAGER_API RemoteEffectInstance final
+   : public EffectInstance
+   , public IPCChannelStatusCallback
+{
+   struct CreateToken {};
+public:
+   //! Whether processing of plugins of external code runs in other processes
+   static BoolSetting Enabled;
+
+   struct Statistics
+   {
+      uint64_t blocks{0};
+      //! From sending each block to having its results
+      std::chrono::microseconds roundTrip{0};
+      //! Spent by the plugin, as measured in the host
+      std::chrono::microseconds processing{0};
+
+      //! Mean of round trip time beyond processing time, per block
+      double MeanOverheadMicroseconds() const noexcept;
+   };
+
+   /**
+    * \return null if Enabled is false, if the effect is not a registered
+    * plugin of a family that loads external code, or if the host could not
+    * start and load it
+    */
+   static std::shared_ptr<RemoteEffectInstance>
+   Create(const EffectInstanceFactory& effect);
+
+   RemoteEffectInstance(CreateToken, const EffectInstanceFactory& effect);
+   ~RemoteEffectInstance() override;
+
+   size_t GetBlockSize() const override;
+   size_t SetBlockSize(size_t maxBlockSize) override;
+   unsigned GetAudioInCount() const override;
+   unsigned GetAudioOutCount() const override;
+   SampleCount GetLatency(
+      const EffectSettings& settings, double sampleRate) const override;
+
+   bool ProcessInitialize(EffectSettings& settings,
+      double sampleRate, ChannelNames chanMap) override;
+   bool ProcessFinalize() noexcept override;
+   size_t ProcessBlock(EffectSettings& settings,
+      const float* const* inBlock, float* const* outBlock, size_t blockLen)
+      override;
+
+   Statistics GetStatistics() const;
+
+   void OnConnect(IPCChannel& channel) noexcept override;
+   void OnDisconnect() noexcept override;
+   void OnConnectionError() noexcept override;
+   void OnDataAvailable(const void* data, size_t size) noexcept override;
+
+private:
+   bool Start(const wxString& providerId, const wxString& pluginPath);
+   //! Sends a command and waits for its reply
+   /*!
+    Abandons the host, for this and all later calls, if the reply doesn't
+    come in time
+    @return the results that follow detail::ProcessCommand::ReplyOk, or
+    nullopt if the command failed
+    */
+   std::optional<wxArrayString> Call(
+      const wxArrayString& command, std::chrono::milliseconds timeout);
+   //! Kills the host; call with mSync locked
+   void Abandon() noexcept;
+   //! (Re)makes the rings if channel counts or block size changed
+   bool EnsureRings();
+
+   const EffectSettingsManager& mManager;
+   const wxString mName;
+
+   std::unique_ptr<IPCServer> mServer;
+   long mPid{0};
+
+   mutable std::mutex mSync;
+   std::condition_variable mCondition;
+   IPCChannel* mChannel{nullptr};
+   detail::InputMessageReader mInputMessageReader;
+   std::optional<wxString> mReply;
+   bool mFailed{false};
+   bool mStopping{false};
+
+   unsigned mAudioIn{0};
+   unsigned mAudioOut{0};
+   size_t mBlockSize{0};
+   SampleCount mLatency{0};
+
+   std::unique_ptr<IPCSharedMemory> mMemory;
+   std::optional<IPCSampleRing> mInput;
+   std::optional<IPCSampleRing> mOutput;
+
+   Statistics mStatistics;
+};
@@ -15,11 +15,12 @@
 #include "MirTypes.h"
 #include "MirUtils.h"
 #include "PowerSpectrumGetter.h"
+#include "RealFFTf.h"
 #include "StftFrameProvider.h"
 #include <cassert>
 #include <cmath>
 #include <numeric>
-#include <pffft.h>
+#include <thread>
 
 namespace MIR
 {
@@ -76,24 +77,25 @@ GetNormalizedCircularAutocorr(const std::vector<float>& ux /* unaligned x*/)
       return ux;
    const auto N = ux.size();
    assert(IsPowOfTwo(N));
-   PffftSetupHolder setup { pffft_new_setup(N, PFFFT_REAL) };
+   // The shared plan of this size
+   const auto hFFT = GetFFT(N);
    PffftFloatVector x { ux.begin(), ux.end() };
-   PffftFloatVector work(N);
-   pffft_transform_ordered(
-      setup.get(), x.data(), x.data(), work.data(), PFFFT_FORWARD);
-
-   // Transform to a power spectrum, but preserving the layout expected by PFFFT
-   // in preparation for the inverse transform.
-   x[0] *= x[0];
-   x[1] *= x[1];
-   for (auto n = 2; n < N; n += 2)
+   RealFFTf(x.data(), hFFT.get());
+
+   // Transform to a power spectrum, in the natural order expected by the
+   // inverse transform.
+   PffftFloatVector y(N);
+   y[0] = x[0] * x[0];
+   y[1] = x[1] * x[1];
+   for (auto i = 1; i < N / 2; ++i)
    {
-      x[n] = x[n] * x[n] + x[n + 1] * x[n + 1];
-      x[n + 1] = 0.f;
+      const auto k = hFFT->BitReversed[i];
+      y[2 * i] = x[k] * x[k] + x[k + 1] * x[k + 1];
+      y[2 * i + 1] = 0.f;
    }
 
-   pffft_transform_ordered(
-      setup.get(), x.data(), x.data(), work.data(), PFFFT_BACKWARD);
+   InverseRealFFTf(y.data(), hFFT.get());
+   ReorderToTime(hFFT.get(), y.data(), x.data());
 
    // The second half of the circular autocorrelation is the mirror of the first
    // half. We are economic and only keep the first half.
@@ -115,7 +117,14 @@ std::vector<float> GetOnsetDetectionFunction(
    const auto sampleRate = frameProvider.GetSampleRate();
    const auto numFrames = frameProvider.GetNumFrames();
    const auto frameSize = frameProvider.GetFftSize();
-   PffftFloatVector buffer(frameSize);
+   PowerSpectrumGetter getPowerSpectrum { frameSize };
+   const auto frameStride = getPowerSpectrum.GetFrameStride();
+   const auto spectrumStride = getPowerSpectrum.GetSpectrumStride();
+   // Frames are transformed in batches, in parallel
+   constexpr size_t framesPerBatch = 128;
+   const auto nThreads = std::thread::hardware_concurrency();
+   PffftFloatVector frames(frameStride * framesPerBatch);
+   PffftFloatVector powSpecs(spectrumStride * framesPerBatch);
    std::vector<float> odf;
    odf.reserve(numFrames);
    const auto powSpecSize = frameSize / 2 + 1;
@@ -124,33 +133,43 @@ std::vector<float> GetOnsetDetectionFunction(
    PffftFloatVector firstPowSpec;
    std::fill(prevPowSpec.begin(), prevPowSpec.end(), 0.f);
 
-   PowerSpectrumGetter getPowerSpectrum { frameSize };
-
    auto frameCounter = 0;
-   while (frameProvider.GetNextFrame(buffer))
+   while (true)
    {
-      getPowerSpectrum(buffer.aligned(), powSpec.aligned());
-
-      // Compress the frame as per section (6.5) in Müller, Meinard.
-      // Fundamentals of music processing: Audio, analysis, algorithms,
-      // applications. Vol. 5. Cham: Springer, 2015.
-      constexpr auto gamma = 100.f;
-      std::transform(
-         powSpec.begin(), powSpec.end(), powSpec.begin(),
-         [gamma](float x) { return FastLog2(1 + gamma * std::sqrt(x)); });
-
-      if (firstPowSpec.empty())
-         firstPowSpec = powSpec;
-      else
-         odf.push_back(GetNoveltyMeasure(prevPowSpec, powSpec));
-
-      if (debugOutput)
-         debugOutput->postProcessedStft.push_back(powSpec);
-
-      std::swap(prevPowSpec, powSpec);
-
-      if (progressCallback)
-         progressCallback(1. * ++frameCounter / numFrames);
+      size_t nFrames = 0;
+      while (nFrames < framesPerBatch &&
+             frameProvider.GetNextFrame(frames.data() + frameStride * nFrames))
+         ++nFrames;
+      if (nFrames == 0)
+         break;
+      getPowerSpectrum(frames.aligned(), nFrames, powSpecs.aligned(), nThreads);
+
+      for (size_t i = 0; i < nFrames; ++i)
+      {
+         const auto spectrum = powSpecs.begin() + spectrumStride * i;
+         std::copy(spectrum, spectrum + powSpecSize, powSpec.begin());
+
+         // Compress the frame as per section (6.5) in Müller, Meinard.
+         // Fundamentals of music processing: Audio, analysis, algorithms,
+         // applications. Vol. 5. Cham: Springer, 2015.
+         constexpr auto gamma = 100.f;
+         std::transform(
+            powSpec.begin(), powSpec.end(), powSpec.begin(),
+            [gamma](float x) { return FastLog2(1 + gamma * std::sqrt(x)); });
+
+         if (firstPowSpec.empty())
+            firstPowSpec = powSpec;
+         else
+            odf.push_back(GetNoveltyMeasure(prevPowSpec, powSpec));
+
+         if (debugOutput)
+            debugOutput->postProcessedStft.push_back(powSpec);
+
+         std::swap(prevPowSpec, powSpec);
+
+         if (progressCallback)
+            progressCallback(1. * ++frameCounter / numFrames);
+      }
    }
 
    // Close the loop.
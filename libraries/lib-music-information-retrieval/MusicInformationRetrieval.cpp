@@ -21,6 +21,10 @@
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <numeric>
 #include <regex>
 
@@ -43,6 +47,72 @@ auto RemovePathPrefix(const std::string& filename)
 // has 1.5 quarter notes per beat.
 constexpr std::array<double, numTimeSignatures> quarternotesPerBeat { 2., 1.,
                                                                       1., 1.5 };
+
+// Meters found in the signal of audio analyzed before, so that importing the
+// same audio again in this session needs no analysis. The analysis of a
+// minute can take seconds, while reading it again to hash it takes
+// milliseconds.
+struct MeterCacheKey
+{
+   uint64_t hash;
+   long long numSamples;
+   double sampleRate;
+   FalsePositiveTolerance tolerance;
+
+   bool operator==(const MeterCacheKey& other) const
+   {
+      return hash == other.hash && numSamples == other.numSamples &&
+             sampleRate == other.sampleRate && tolerance == other.tolerance;
+   }
+};
+
+constexpr size_t meterCacheSize = 64;
+std::mutex meterCacheMutex;
+std::deque<std::pair<MeterCacheKey, std::optional<MusicalMeter>>> meterCache;
+
+// FNV-1a, over the bits of the samples
+uint64_t HashSamples(const MirAudioReader& audio)
+{
+   constexpr size_t blockSize = 4096;
+   std::vector<float> buffer(blockSize);
+   uint64_t hash = 14695981039346656037u;
+   const auto numSamples = audio.GetNumSamples();
+   for (long long start = 0; start < numSamples; start += blockSize)
+   {
+      const auto numFrames =
+         static_cast<size_t>(std::min<long long>(blockSize, numSamples - start));
+      audio.ReadFloats(buffer.data(), start, numFrames);
+      for (size_t i = 0; i < numFrames; ++i)
+      {
+         uint32_t bits;
+         std::memcpy(&bits, &buffer[i], sizeof bits);
+         hash = (hash ^ bits) * 1099511628211u;
+      }
+   }
+   return hash;
+}
+
+// The outer optional is empty if the key was not found
+std::optional<std::optional<MusicalMeter>>
+FindMeter(const MeterCacheKey& key)
+{
+   std::lock_guard<std::mutex> lock { meterCacheMutex };
+   const auto it = std::find_if(
+      meterCache.begin(), meterCache.end(),
+      [&](const auto& entry) { return entry.first == key; });
+   if (it == meterCache.end())
+      return std::nullopt;
+   return std::make_optional(it->second);
+}
+
+void StoreMeter(
+   const MeterCacheKey& key, const std::optional<MusicalMeter>& meter)
+{
+   std::lock_guard<std::mutex> lock { meterCacheMutex };
+   if (meterCache.size() == meterCacheSize)
+      meterCache.pop_front();
+   meterCache.emplace_back(key, meter);
+}
 } // namespace
 
 std::optional<ProjectSyncInfo>
@@ -141,9 +211,24 @@ std::optional<MusicalMeter> GetMusicalMeterFromSignal(
       // A file longer than 1 minute is most likely not a loop, and processing
       // it would be costly.
       return {};
+   // Debug output is only obtained by analyzing
+   const auto useCache = debugOutput == nullptr;
+   const MeterCacheKey key { useCache ? HashSamples(audio) : 0,
+                             audio.GetNumSamples(), audio.GetSampleRate(),
+                             tolerance };
+   if (useCache)
+      if (auto cached = FindMeter(key))
+      {
+         if (progressCallback)
+            progressCallback(1.);
+         return std::move(*cached);
+      }
    DecimatingMirAudioReader decimatedAudio { audio };
-   return GetMeterUsingTatumQuantizationFit(
+   auto meter = GetMeterUsingTatumQuantizationFit(
       decimatedAudio, tolerance, progressCallback, debugOutput);
+   if (useCache)
+      StoreMeter(key, meter);
+   return meter;
 }
 
 void SynchronizeProject(
@@ -69,6 +69,11 @@ GetProjectSyncInfo(const ProjectSyncInfoInput& input);
 MUSIC_INFORMATION_RETRIEVAL_API std::optional<double>
 GetBpmFromFilename(const std::string& filename);
 
+/*!
+ * The result for the same samples, rate and tolerance is remembered for the
+ * session, unless `debugOutput` is given, so that analyzing them again only
+ * costs reading them.
+ */
 MUSIC_INFORMATION_RETRIEVAL_API std::optional<MusicalMeter>
 GetMusicalMeterFromSignal(
    const MirAudioReader& source, FalsePositiveTolerance tolerance,
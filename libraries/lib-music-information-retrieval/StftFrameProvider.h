@@ -30,6 +30,8 @@ class MUSIC_INFORMATION_RETRIEVAL_API StftFrameProvider
 public:
    StftFrameProvider(const MirAudioReader& source);
    bool GetNextFrame(PffftFloatVector& frame);
+   //! Like the other overload, but writes `GetFftSize()` floats at `frame`
+   bool GetNextFrame(float* frame);
    int GetNumFrames() const;
    int GetSampleRate() const;
    double GetFrameRate() const;
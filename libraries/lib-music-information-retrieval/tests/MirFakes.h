@@ -52,6 +52,45 @@ class SquareWaveMirAudioReader : public MirAudioReader
    }
 };
 
+//! Clicks at a steady tempo, counting the samples read
+class ClickTrackMirAudioReader : public MirAudioReader
+{
+public:
+   ClickTrackMirAudioReader(double bpm, double offset = 0.)
+       : period { static_cast<long long>(GetSampleRate() * 60 / bpm) }
+       , offset { static_cast<long long>(GetSampleRate() * offset) }
+   {
+   }
+
+   double GetSampleRate() const override
+   {
+      return 44100;
+   }
+   long long GetNumSamples() const override
+   {
+      return 8 * 44100;
+   }
+   void
+   ReadFloats(float* buffer, long long where, size_t numFrames) const override
+   {
+      for (size_t i = 0; i < numFrames; ++i)
+      {
+         const auto phase = (where + i + offset) % period;
+         // A decaying burst of a few milliseconds
+         buffer[i] = phase < 200 ? (phase % 2 ? 1.f : -1.f) *
+                                      (1.f - phase / 200.f) :
+                                   0.f;
+      }
+      numSamplesRead += numFrames;
+   }
+
+   mutable long long numSamplesRead = 0;
+
+private:
+   const long long period;
+   const long long offset;
+};
+
 class FakeProjectInterface final : public ProjectInterface
 {
 public:
@@ -173,6 +173,34 @@ TEST_CASE("GetProjectSyncInfo")
    }
 }
 
+TEST_CASE("GetMusicalMeterFromSignal")
+{
+   SECTION("does not analyze the same samples twice")
+   {
+      const ClickTrackMirAudioReader first { 120 };
+      const ClickTrackMirAudioReader again { 120 };
+      const auto meter = GetMusicalMeterFromSignal(
+         first, FalsePositiveTolerance::Lenient, nullptr);
+      const auto cached = GetMusicalMeterFromSignal(
+         again, FalsePositiveTolerance::Lenient, nullptr);
+      // The second time, the samples are only read to be hashed.
+      REQUIRE(first.numSamplesRead > first.GetNumSamples());
+      REQUIRE(again.numSamplesRead == again.GetNumSamples());
+      REQUIRE(meter.has_value() == cached.has_value());
+      if (meter.has_value())
+      {
+         REQUIRE(meter->bpm == cached->bpm);
+         REQUIRE(meter->timeSignature == cached->timeSignature);
+      }
+
+      // Different samples are analyzed.
+      const ClickTrackMirAudioReader shifted { 120, .1 };
+      GetMusicalMeterFromSignal(
+         shifted, FalsePositiveTolerance::Lenient, nullptr);
+      REQUIRE(shifted.numSamplesRead > shifted.GetNumSamples());
+   }
+}
+
 TEST_CASE("SynchronizeProject")
 {
    constexpr auto initialProjectTempo = 100.;
@@ -100,6 +100,17 @@ Request::Timeout Request::getTimeout () const noexcept
     return mTimeout;
 }
 
+Request& Request::setMaxUploadSpeed (int64_t bytesPerSecond) noexcept
+{
+    mMaxUploadSpeed = bytesPerSecond;
+    return *this;
+}
+
+int64_t Request::getMaxUploadSpeed () const noexcept
+{
+    return mMaxUploadSpeed;
+}
+
 Request& Request::appendCookies (const CookiesList& list)
 {
     for (const Cookie& cookie : list)
@@ -12,6 +12,7 @@
 
 #include <string>
 #include <chrono>
+#include <cstdint>
 #include <numeric>
 
 #include "NetworkManagerApi.h"
@@ -60,6 +61,10 @@ public:
 
     Request& setTimeout(Timeout timeout) noexcept;
     Timeout getTimeout() const noexcept;
+
+    //! Limits the upload to a number of bytes per second, 0 for no limit
+    Request& setMaxUploadSpeed(int64_t bytesPerSecond) noexcept;
+    int64_t getMaxUploadSpeed() const noexcept;
 private:
     std::string mUrl;
 
@@ -69,6 +74,8 @@ private:
     size_t mMaxRedirects { INFINITE_REDIRECTS };
 
     Timeout mTimeout { std::chrono::seconds (5) };
+
+    int64_t mMaxUploadSpeed { 0 };
 };
 
 }
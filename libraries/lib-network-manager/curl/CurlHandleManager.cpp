@@ -280,14 +280,38 @@ CurlHandleManager::CurlHandleManager ()
     mUserAgent = ss.str ();
 
     mProxy = gCurlConfig.Proxy;
+
+    mShare = curl_share_init ();
+
+    if (mShare != nullptr)
+    {
+        curl_share_setopt (mShare, CURLSHOPT_LOCKFUNC, LockSharedData);
+        curl_share_setopt (mShare, CURLSHOPT_UNLOCKFUNC, UnlockSharedData);
+        curl_share_setopt (mShare, CURLSHOPT_USERDATA, this);
+
+        curl_share_setopt (mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt (mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+        // Connections can be shared since curl 7.57.0
+        curl_share_setopt (mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+    }
 }
 
 CurlHandleManager::~CurlHandleManager ()
 {
-    std::lock_guard<std::mutex> lock (mHandleCacheLock);
+    {
+        std::lock_guard<std::mutex> lock (mHandleCacheLock);
 
-    for (auto& cachedHandle : mHandleCache)
-        curl_easy_cleanup (cachedHandle.Handle);
+        for (auto& cachedHandle : mHandleCache)
+            curl_easy_cleanup (cachedHandle.Handle);
+
+        mHandleCache.clear ();
+    }
+
+    // The handles using the share must be cleaned up first
+    if (mShare != nullptr)
+        curl_share_cleanup (mShare);
 }
 
 void CurlHandleManager::setProxy (std::string proxy)
@@ -299,6 +323,9 @@ CurlHandleManager::Handle CurlHandleManager::getHandle (RequestVerb verb, const
 {
     Handle handle (this, getCurlHandleFromCache (verb, url), verb, url);
 
+    if (mShare != nullptr)
+        handle.setOption (CURLOPT_SHARE, mShare);
+
     if (!mProxy.empty ())
     {
         handle.setOption (CURLOPT_PROXY, mProxy);
@@ -372,6 +399,16 @@ void CurlHandleManager::cleanupHandlesCache ()
     }), mHandleCache.end ());
 }
 
+void CurlHandleManager::LockSharedData (CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+{
+    static_cast<CurlHandleManager*> (userptr)->mSharedDataLocks[data].lock ();
+}
+
+void CurlHandleManager::UnlockSharedData (CURL*, curl_lock_data data, void* userptr)
+{
+    static_cast<CurlHandleManager*> (userptr)->mSharedDataLocks[data].unlock ();
+}
+
 std::string CurlHandleManager::GetSchemeAndDomain (const std::string& url)
 {
     const size_t schemeEndPosition = url.find ("://");
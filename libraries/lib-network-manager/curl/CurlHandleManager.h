@@ -121,11 +121,19 @@ private:
 
     static std::string GetSchemeAndDomain (const std::string& url);
 
+    static void LockSharedData (CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void UnlockSharedData (CURL* handle, curl_lock_data data, void* userptr);
+
     std::string mProxy;
     std::string mUserAgent;
 
     std::mutex mHandleCacheLock;
     std::vector<CachedHandle> mHandleCache;
+
+    // Lets all the handles use the same connections, DNS entries and
+    // TLS sessions, whatever the verb of the request
+    CURLSH* mShare { nullptr };
+    std::mutex mSharedDataLocks[CURL_LOCK_DATA_LAST];
 };
 
 }
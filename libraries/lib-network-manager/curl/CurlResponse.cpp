@@ -262,6 +262,9 @@ void CurlResponse::perform ()
         std::chrono::duration_cast<std::chrono::milliseconds> (mRequest.getTimeout()).count ()
     );
 
+    // Also resets the limit of a handle taken from the cache
+    handle.setOption (CURLOPT_MAX_SEND_SPEED_LARGE, static_cast<curl_off_t> (mRequest.getMaxUploadSpeed ()));
+
     handle.appendCookies (mRequest.getCookies ());
 
     curl_mime* mimeList = nullptr;
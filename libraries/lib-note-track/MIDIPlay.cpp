@@ -361,7 +361,9 @@ Time (in seconds, = total_sample_count / sample_rate)
 #include "portaudio.h"
 #include <portmidi.h>
 #include <porttime.h>
+#include <map>
 #include <thread>
+#include <tuple>
 
 #define ROUND(x) (int) ((x)+0.5)
 
@@ -480,6 +482,16 @@ enum {
    MIDI_MINIMAL_LATENCY_MS = 1
 };
 
+namespace {
+//! Messages are given to PortMidi in batches of at most this many
+constexpr size_t MidiEventBatchSize = 256;
+
+struct MidiEventBatch {
+   MidiEventBatch() { events.reserve(MidiEventBatchSize); }
+   std::vector<PmEvent> events;
+};
+}
+
 // return the system time as a double
 static double streamStartTime = 0; // bias system time to small number
 
@@ -515,6 +527,7 @@ AudioIOExt::RegisteredFactory sMIDIPlayFactory{
 
 MIDIPlay::MIDIPlay(const PlaybackSchedule &schedule)
    : mPlaybackSchedule{ schedule }
+   , mpEventBatch{ std::make_unique<MidiEventBatch>() }
 {
 #ifdef AUDIO_IO_GB_MIDI_WORKAROUND
    // Pre-allocate with a likely sufficient size, exceeding probable number of
@@ -637,11 +650,13 @@ Iterator::Iterator(
       // to the data until playback finishes. This is just a sanity check.
       seq->set_in_use(true);
       const void *cookie = t.get();
+      // Skip to the start by binary search in each track of the sequence
       it.begin_seq(seq,
          // casting away const, but allegro just uses the pointer opaquely
-         const_cast<void*>(cookie), t->GetStartTime() + offset);
+         const_cast<void*>(cookie), t->GetStartTime() + offset,
+         startTime + offset);
    }
-   Prime(send, startTime + offset);
+   Prime(send, startTime + offset, midiPlaybackTracks, offset);
 }
 
 Iterator::~Iterator()
@@ -649,23 +664,65 @@ Iterator::~Iterator()
    it.end();
 }
 
-void Iterator::Prime(bool send, double startTime)
+void Iterator::Prime(bool send, double startTime,
+   const NoteTrackConstArray &midiPlaybackTracks, double offset)
 {
-   GetNextEvent(); // prime the pump for FillOtherBuffers
-
-   // Start MIDI from current cursor position
-   while (mNextEvent &&
-          GetNextEventTime() < startTime) {
-      if (send)
-         /*
-          hasSolo argument doesn't matter because midiStateOnly is true.
-          "Fast-forward" all update events from the start of track to the given
-          play start time so the notes sound with correct timbre whenever
-          turned on.
-          */
+   if (send) {
+      /*
+       "Fast-forward" the update events from the start of track to the given
+       play start time so the notes sound with correct timbre whenever
+       turned on.  Only the last update of each parameter matters, so only
+       that one is sent.
+       */
+      struct State {
+         double time;
+         Alg_update_ptr update;
+         NoteTrack *track;
+      };
+      std::vector<State> states;
+      using Key = std::tuple<const NoteTrack*, long, const char*, long>;
+      std::map<Key, size_t> stateIndices;
+      for (auto &t : midiPlaybackTracks) {
+         Alg_seq &seq = t->GetSeq();
+         const auto seqOffset = t->GetStartTime() + offset;
+         for (int i = 0; i < seq.track_list.length(); ++i) {
+            Alg_events &events = seq.track_list[i];
+            for (int j = 0;
+               j < events.length() && events[j]->time + seqOffset < startTime;
+               ++j
+            ) {
+               if (!events[j]->is_update())
+                  continue;
+               const auto update = static_cast<Alg_update_ptr>(events[j]);
+               // Attribute names are interned, so pointers compare
+               const Key key{ t.get(), update->chan,
+                  update->get_attribute(), update->get_identifier() };
+               const State state{ update->time + seqOffset, update,
+                  const_cast<NoteTrack*>(t.get()) };
+               const auto [iter, inserted] =
+                  stateIndices.try_emplace(key, states.size());
+               if (inserted)
+                  states.push_back(state);
+               else
+                  states[iter->second] = state;
+            }
+         }
+      }
+      std::stable_sort(states.begin(), states.end(),
+         [](const State &a, const State &b){ return a.time < b.time; });
+      for (const auto &state : states) {
+         mNextEvent = state.update;
+         mNextEventTrack = state.track;
+         mNextIsNoteOn = true;
+         mNextEventTime = state.time;
+         mNextEventRealTime.reset();
+         // hasSolo argument doesn't matter because midiStateOnly is true.
          OutputEvent(0, true, false);
-      GetNextEvent();
+      }
    }
+
+   // The iterator already starts at the start time
+   GetNextEvent(); // prime the pump for FillOtherBuffers
 }
 
 double Iterator::GetNextEventTime() const
@@ -729,6 +786,7 @@ bool MIDIPlay::StartPortMidiStream(double rate)
       mMidiOutputComplete = false;
       mMaxMidiTimestamp = 0;
       PrepareMidiIterator(true, mPlaybackSchedule.mT0, 0);
+      FlushEvents();
 
       // It is ok to call this now, but do not send timestamped midi
       // until after the first audio callback, which provides necessary
@@ -779,17 +837,18 @@ void MIDIPlay::StopOtherStream()
 
 double Iterator::UncorrectedMidiEventTime(double pauseTime)
 {
-   double time;
-   if (mPlaybackSchedule.mEnvelope)
-      time =
-         mPlaybackSchedule.RealDuration(
-            GetNextEventTime() - mMIDIPlay.MidiLoopOffset())
-         + mPlaybackSchedule.mT0 +
-           (mMIDIPlay.mMidiLoopPasses * mPlaybackSchedule.mWarpedLength);
-   else
-      time = GetNextEventTime();
-
-   return time + pauseTime;
+   if (!mNextEventRealTime) {
+      if (mPlaybackSchedule.mEnvelope)
+         mNextEventRealTime =
+            mPlaybackSchedule.RealDuration(
+               GetNextEventTime() - mMIDIPlay.MidiLoopOffset())
+            + mPlaybackSchedule.mT0 +
+              (mMIDIPlay.mMidiLoopPasses * mPlaybackSchedule.mWarpedLength);
+      else
+         mNextEventRealTime = GetNextEventTime();
+   }
+
+   return *mNextEventRealTime + pauseTime;
 }
 
 bool Iterator::Unmuted(bool hasSolo) const
@@ -953,7 +1012,7 @@ bool Iterator::OutputEvent(double pauseTime, bool midiStateOnly, bool hasSolo)
          if (timestamp > mMIDIPlay.mMaxMidiTimestamp) {
             mMIDIPlay.mMaxMidiTimestamp = timestamp;
          }
-         Pm_WriteShort(mMIDIPlay.mMidiStream, timestamp,
+         mMIDIPlay.QueueEvent(timestamp,
                     Pm_Message((int) (command + channel),
                                   (long) data1, (long) data2));
          /* wxPrintf("Pm_WriteShort %lx (%p) @ %d, advance %d\n",
@@ -968,6 +1027,7 @@ bool Iterator::OutputEvent(double pauseTime, bool midiStateOnly, bool hasSolo)
 void Iterator::GetNextEvent()
 {
    mNextEventTrack = nullptr; // clear it just to be safe
+   mNextEventRealTime.reset();
    // now get the next event and the track from which it came
    double nextOffset;
    auto midiLoopOffset = mMIDIPlay.MidiLoopOffset();
@@ -1009,10 +1069,15 @@ void MIDIPlay::FillOtherBuffers(
    if (actual_latency > mAudioOutLatency) {
        time += actual_latency - mAudioOutLatency;
    }
+   // Look ahead by one more buffer:  the events due while it plays are
+   // scheduled now, with their timestamps, so that PortMidi delivers them
+   // at their times however late the next callback comes
+   time += mAudioFramesPerBuffer / rate;
+   const auto pauseTime = PauseTime(rate, pauseFrames);
    while (mIterator &&
           mIterator->mNextEvent &&
-          mIterator->UncorrectedMidiEventTime(PauseTime(rate, pauseFrames)) < time) {
-      if (mIterator->OutputEvent(PauseTime(rate, pauseFrames), false, hasSolo)) {
+          mIterator->UncorrectedMidiEventTime(pauseTime) < time) {
+      if (mIterator->OutputEvent(pauseTime, false, hasSolo)) {
          if (mPlaybackSchedule.GetPolicy().Looping(mPlaybackSchedule)) {
             // jump back to beginning of loop
             ++mMidiLoopPasses;
@@ -1024,6 +1089,7 @@ void MIDIPlay::FillOtherBuffers(
       else if (mIterator)
          mIterator->GetNextEvent();
    }
+   FlushEvents();
 }
 
 double MIDIPlay::PauseTime(double rate, unsigned long pauseFrames)
@@ -1069,6 +1135,9 @@ void MIDIPlay::AllNotesOff(bool looping)
    static_cast<void>(looping);// compiler food.
 #endif
 
+   // Messages already queued go out first
+   FlushEvents();
+
    // to keep track of when MIDI should all be delivered,
    // update mMaxMidiTimestamp to now:
    PmTimestamp now = MidiTime();
@@ -1094,8 +1163,7 @@ void MIDIPlay::AllNotesOff(bool looping)
 
    mMaxMidiTimestamp += 1;
    for (const auto &pair : mPendingNotesOff) {
-      Pm_WriteShort(mMidiStream,
-                    (doDelay ? mMaxMidiTimestamp : 0),
+      QueueEvent((doDelay ? mMaxMidiTimestamp : 0),
                     Pm_Message(
          0x90 + pair.first, pair.second, 0));
       mMaxMidiTimestamp++; // allow 1ms per note-off
@@ -1106,11 +1174,27 @@ void MIDIPlay::AllNotesOff(bool looping)
 #endif
 
    for (int chan = 0; chan < 16; chan++) {
-      Pm_WriteShort(mMidiStream,
-                    (doDelay ? mMaxMidiTimestamp : 0),
+      QueueEvent((doDelay ? mMaxMidiTimestamp : 0),
                     Pm_Message(0xB0 + chan, 0x7B, 0));
       mMaxMidiTimestamp++; // allow 1ms per all-notes-off
    }
+   FlushEvents();
+}
+
+void MIDIPlay::QueueEvent(PmTimestamp timestamp, int32_t message)
+{
+   auto &events = mpEventBatch->events;
+   if (events.size() == MidiEventBatchSize)
+      FlushEvents();
+   events.push_back({ message, timestamp });
+}
+
+void MIDIPlay::FlushEvents()
+{
+   auto &events = mpEventBatch->events;
+   if (!events.empty() && mMidiStream)
+      Pm_Write(mMidiStream, events.data(), static_cast<int32_t>(events.size()));
+   events.clear();
 }
 
 void MIDIPlay::ComputeOtherTimings(double rate, bool paused,
@@ -13,6 +13,7 @@ Paul Licameli split from AudIOBase.h
 #define __AUDACITY_MIDI_PLAY__
 
 #include "AudioIOExt.h"
+#include <memory>
 #include <optional>
 #include "WrapAllegro.h"
 
@@ -33,6 +34,7 @@ using NoteTrackConstArray = std::vector < std::shared_ptr< const NoteTrack > >;
 namespace {
 
 struct MIDIPlay;
+struct MidiEventBatch;
 
 Alg_update gAllNotesOff; // special event for loop ending
 // the fields of this event are never used, only the address is important
@@ -44,7 +46,10 @@ struct Iterator {
       double startTime, double offset, bool send );
    ~Iterator();
 
-   void Prime(bool send, double startTime);
+   //! Send the state that the updates before startTime set, if send is
+   //! true, and find the first event after it
+   void Prime(bool send, double startTime,
+      const NoteTrackConstArray &midiPlaybackTracks, double offset);
 
    double GetNextEventTime() const;
 
@@ -78,6 +83,9 @@ private:
    /// Real time at which the next event should be output, measured in seconds.
    /// Note that this could be a note's time+duration for note offs.
    double           mNextEventTime = 0;
+   /// UncorrectedMidiEventTime() without the pause time, computed once for
+   /// each event, because warping by the envelope is costly
+   std::optional<double> mNextEventRealTime;
 };
 
 struct MIDIPlay : AudioIOExt
@@ -122,6 +130,10 @@ struct MIDIPlay : AudioIOExt
    /// stream closing until last message has been delivered
    PmTimestamp mMaxMidiTimestamp = 0;
 
+   /// Timestamped messages not yet given to PortMidi, which are written
+   /// together by FlushEvents()
+   std::unique_ptr<MidiEventBatch> mpEventBatch;
+
    /// Offset from ideal sample computation time to system time,
    /// where "ideal" means when we would get the callback if there
    /// were no scheduling delays or computation time
@@ -152,6 +164,11 @@ struct MIDIPlay : AudioIOExt
    double PauseTime(double rate, unsigned long pauseFrames);
    void AllNotesOff(bool looping = false);
 
+   //! Add a message to the batch, flushing it first if it is full
+   void QueueEvent(PmTimestamp timestamp, int32_t message);
+   //! Write the batch to the stream in one call
+   void FlushEvents();
+
    /** \brief Compute the current PortMidi timestamp time.
     *
     * This is used by PortMidi to synchronize midi time to audio samples
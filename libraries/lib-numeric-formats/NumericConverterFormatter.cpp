@@ -62,6 +62,24 @@ void NumericConverterFormatter::UpdateFormatForValue(double, bool)
 {
 }
 
+const wxString&
+NumericConverterFormatter::FormatField(size_t fieldIndex, int value) const
+{
+   if (mFieldStrings.size() <= fieldIndex)
+      mFieldStrings.resize(fieldIndex + 1);
+   auto& cached = mFieldStrings[fieldIndex];
+   const auto& formatStr = mFields[fieldIndex].formatStr;
+   if (
+      cached.text.empty() || cached.value != value ||
+      cached.formatStr != formatStr)
+   {
+      cached.value = value;
+      cached.formatStr = formatStr;
+      cached.text = wxString::Format(formatStr, value);
+   }
+   return cached.text;
+}
+
 const wxString& NumericConverterFormatter::GetPrefix() const
 {
    return mPrefix;
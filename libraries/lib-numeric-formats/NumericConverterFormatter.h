@@ -84,8 +84,24 @@ struct NUMERIC_FORMATS_API NumericConverterFormatter /* not final */ :
    const DigitInfos& GetDigitInfos() const;
 
 protected:
+   //! Format the value of a field with its formatStr
+   /*!
+    Rulers and time controls format one value after another that differ only
+    in the last fields, so the text of the previous call for the same field is
+    reused when the value and the format are unchanged
+    */
+   const wxString& FormatField(size_t fieldIndex, int value) const;
+
    wxString mPrefix;
 
    NumericFields mFields;
    DigitInfos mDigits;
+
+private:
+   struct FieldString final {
+      int value{};
+      wxString formatStr;
+      wxString text;
+   };
+   mutable std::vector<FieldString> mFieldStrings;
 };
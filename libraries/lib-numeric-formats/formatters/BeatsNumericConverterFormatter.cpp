@@ -255,8 +255,8 @@ public:
          const auto fieldValue = std::max(
             0, static_cast<int>(std::floor(value * eps / fieldLength)));
 
-         result.fieldValueStrings[fieldIndex] = wxString::Format(
-            mFields[fieldIndex].formatStr, fieldValue + mFieldValueOffset);
+         result.fieldValueStrings[fieldIndex] =
+            FormatField(fieldIndex, fieldValue + mFieldValueOffset);
 
          value = value - fieldValue * fieldLength;
       }
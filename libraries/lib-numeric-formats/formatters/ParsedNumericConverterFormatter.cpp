@@ -387,6 +387,7 @@ public:
       double rawValue, bool nearest) const override
    {
       ConversionResult result;
+      result.fieldValueStrings.reserve(mFields.size());
 
       if (IsTimeRelatedFormat() && mContext.HasSampleRate())
          rawValue = floor(rawValue * mSampleRate + (nearest ? 0.5f : 0.0f)) /
@@ -497,7 +498,7 @@ public:
                field += wxT("-");
          }
          else
-            field = wxString::Format(mFields[i].formatStr, (int)value);
+            field = FormatField(i, (int)value);
 
          result.fieldValueStrings.push_back(field);
 
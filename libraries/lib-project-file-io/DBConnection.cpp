@@ -13,9 +13,15 @@ Paul Licameli -- split from ProjectFileIO.cpp
 
 #include "sqlite3.h"
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <set>
+#include <utility>
 #include <wx/string.h>
 
 #include "AudacityLogger.h"
+#include "Prefs.h"
 #include "BasicUI.h"
 #include "FileNames.h"
 #include "Internat.h"
@@ -23,6 +29,9 @@ Paul Licameli -- split from ProjectFileIO.cpp
 #include "FileException.h"
 #include "wxFileNameWrapper.h"
 #include "SentryHelper.h"
+#include "Tracing.h"
+
+#include "concurrency/ThreadPriority.h"
 
 #define AUDACITY_PROJECT_PAGE_SIZE 65536
 
@@ -33,6 +42,14 @@ static const char* PageSizeConfig =
    "PRAGMA <schema>.page_size = " xstr(AUDACITY_PROJECT_PAGE_SIZE) ";"
    "VACUUM;";
 
+namespace {
+std::atomic_bool sCheckpointsDeferred{ false };
+
+//! Connections with checkpoint threads, to wake when deferral ends
+std::mutex sConnectionsMutex;
+std::set<DBConnection*> sConnections;
+}
+
 // Configuration to provide "safe" connections
 static const char* SafeConfig =
    "PRAGMA <schema>.busy_timeout = 5000;"
@@ -41,6 +58,16 @@ static const char* SafeConfig =
    "PRAGMA <schema>.journal_mode = WAL;"
    "PRAGMA <schema>.wal_autocheckpoint = 0;";
 
+// Ask SQLite to read pages of the main file through a memory mapping of up to
+// the given size, saving a copy into its page cache; WAL pages are still read
+static int MemoryMap(sqlite3 *db)
+{
+   const auto megabytes = std::max(0, MemoryMapMegabytes.Read());
+   const auto sql = wxString::Format("PRAGMA main.mmap_size = %lld;",
+      static_cast<long long>(megabytes) << 20);
+   return sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
+}
+
 // Configuration to provide "Fast" connections
 static const char *FastConfig =
    "PRAGMA <schema>.busy_timeout = 5000;"
@@ -144,10 +171,21 @@ int DBConnection::Open(const FilePath fileName)
    wxASSERT(mDB == nullptr);
    int rc;
 
+   mOwnerThread = std::this_thread::get_id();
+
    // Initialize checkpoint controls
    mCheckpointStop = false;
    mCheckpointPending = false;
    mCheckpointActive = false;
+   mCheckpointTruncate = false;
+   mCheckpointUrgent = false;
+   mWalPages = 0;
+   mCheckpointStatistics = {};
+   const auto deferredPages =
+      (static_cast<long long>(std::max(0, DeferredCheckpointMegabytes.Read()))
+         << 20) / AUDACITY_PROJECT_PAGE_SIZE;
+   mDeferredCheckpointPages = static_cast<int>(std::min<long long>(
+      deferredPages, std::numeric_limits<int>::max()));
    rc = OpenStepByStep( fileName );
    if ( rc != SQLITE_OK)
    {
@@ -202,6 +240,10 @@ int DBConnection::OpenStepByStep(const FilePath fileName)
       return rc;
    }
 
+   // Not fatal; reading merely takes the usual path
+   if (MemoryMap(mDB) != SQLITE_OK)
+      wxLogMessage("Failed to map %s into memory", fileName);
+
    rc = sqlite3_open(name, &mCheckpointDB);
    if (rc != SQLITE_OK)
    {
@@ -222,11 +264,31 @@ int DBConnection::OpenStepByStep(const FilePath fileName)
    }
 
    auto db = mCheckpointDB;
+   // Read preferences in this thread, and apply them in the new one
+   const auto cores = CheckpointThreadCores.Read().ToStdString();
    mCheckpointThread = std::thread(
-      [this, db, fileName]{ CheckpointThread(db, fileName); });
+      [this, db, fileName, cores]{
+         using namespace audacity::concurrency;
+         Tracing::SetThreadName("Checkpoint thread");
+         // Keep checkpoints off the processors reserved for audio
+         if (const auto coreList = ParseCoreList(cores); !coreList.empty()) {
+            if (const auto result = SetCurrentThreadAffinity(coreList))
+               wxLogMessage("Checkpoint thread pinned to processors %s",
+                  cores);
+            else
+               wxLogWarning(
+                  "Checkpoint thread could not be pinned to processors %s: %s",
+                  cores, result.message);
+         }
+         CheckpointThread(db, fileName);
+      });
 
    // Install our checkpoint hook
    sqlite3_wal_hook(mDB, CheckpointHook, this);
+   {
+      std::lock_guard<std::mutex> guard{ sConnectionsMutex };
+      sConnections.insert(this);
+   }
    return rc;
 }
 
@@ -244,6 +306,17 @@ bool DBConnection::Close()
    // Uninstall our checkpoint hook so that no additional checkpoints
    // are sent our way.  (Though this shouldn't really happen.)
    sqlite3_wal_hook(mDB, nullptr, nullptr);
+   {
+      std::lock_guard<std::mutex> guard{ sConnectionsMutex };
+      sConnections.erase(this);
+   }
+
+   // Don't let deferral of checkpoints delay the close
+   {
+      std::lock_guard<std::mutex> guard(mCheckpointMutex);
+      mCheckpointUrgent = true;
+      mCheckpointCondition.notify_one();
+   }
 
    // Display a progress dialog if there's active or pending checkpoints
    if (mCheckpointPending || mCheckpointActive)
@@ -285,6 +358,14 @@ bool DBConnection::Close()
       mCheckpointThread.join();
    }
 
+   if (const auto statistics = GetCheckpointStatistics(); statistics.count)
+      wxLogMessage("Checkpoints of %s: %d, %d forced while deferred, "
+                   "longest %.3f s, total %.3f s",
+                   sqlite3_db_filename(mDB, nullptr),
+                   static_cast<int>(statistics.count),
+                   static_cast<int>(statistics.forced),
+                   statistics.maxSeconds, statistics.totalSeconds);
+
    // We're done with the prepared statements
    {
       std::lock_guard<std::mutex> guard(mStatementMutex);
@@ -303,6 +384,14 @@ bool DBConnection::Close()
          }
       }
       mStatements.clear();
+
+      for (auto stmt : mReadStatements)
+         sqlite3_finalize(stmt.second);
+      mReadStatements.clear();
+      for (auto db : mReadDBs)
+         if (db.second)
+            sqlite3_close(db.second);
+      mReadDBs.clear();
    }
 
    // Not much we can do if the closes fail, so just report the error
@@ -490,10 +579,74 @@ sqlite3_stmt *DBConnection::Prepare(enum StatementID id, const char *sql)
    return stmt;
 }
 
+namespace {
+//! Limits the number of read-only connections
+constexpr size_t MaxReadConnections = 16;
+//! Wait no longer for a read-only connection than this, in milliseconds,
+//! before falling back to the primary connection
+constexpr int ReadBusyTimeout = 50;
+}
+
+sqlite3_stmt *DBConnection::PrepareRead(enum StatementID id, const char *sql)
+{
+   const auto thread = std::this_thread::get_id();
+   if (thread != mOwnerThread)
+   {
+      std::lock_guard<std::mutex> guard(mStatementMutex);
+      StatementIndex ndx(id, thread);
+      auto iter = mReadStatements.find(ndx);
+      if (iter != mReadStatements.end())
+         return iter->second;
+
+      if (auto db = GetReadDB(thread))
+      {
+         sqlite3_stmt *stmt = nullptr;
+         if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT,
+               &stmt, 0) == SQLITE_OK)
+         {
+            mReadStatements.insert({ndx, stmt});
+            return stmt;
+         }
+         sqlite3_finalize(stmt);
+      }
+   }
+
+   // Share the primary connection
+   return Prepare(id, sql);
+}
+
+sqlite3 *DBConnection::GetReadDB(std::thread::id thread)
+{
+   auto iter = mReadDBs.find(thread);
+   if (iter != mReadDBs.end())
+      return iter->second;
+   if (mReadDBs.size() >= MaxReadConnections)
+      return nullptr;
+
+   sqlite3 *db = nullptr;
+   const char *name = sqlite3_db_filename(mDB, "main");
+   if (name && *name &&
+       sqlite3_open_v2(name, &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK)
+   {
+      sqlite3_busy_timeout(db, ReadBusyTimeout);
+      MemoryMap(db);
+   }
+   else
+   {
+      wxLogMessage("Failed to open read connection to %s", name ? name : "");
+      // Closing is correct even if open failed
+      sqlite3_close(db);
+      db = nullptr;
+   }
+   mReadDBs.insert({thread, db});
+   return db;
+}
+
 void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
 {
    int rc = SQLITE_OK;
    bool giveUp = false;
+   bool forced = false, truncate = false;
 
    while (true)
    {
@@ -503,7 +656,9 @@ void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
          mCheckpointCondition.wait(lock,
                                    [&]
                                    {
-                                      return mCheckpointPending || mCheckpointStop;
+                                      return mCheckpointStop ||
+                                         (mCheckpointPending &&
+                                          !CheckpointDeferred());
                                    });
 
          // Requested to stop, so bail
@@ -515,22 +670,50 @@ void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
          // Capture the number of pages that need checkpointing and reset
          mCheckpointActive = true;
          mCheckpointPending = false;
+         forced = sCheckpointsDeferred && !mCheckpointUrgent;
+         truncate = std::exchange(mCheckpointTruncate, false);
       }
 
       // And kick off the checkpoint. This may not checkpoint ALL frames
       // in the WAL.  They'll be gotten the next time around.
       using namespace std::chrono;
-      do {
-         rc = giveUp ? SQLITE_OK :
-            sqlite3_wal_checkpoint_v2(
-               db, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+      const auto start = steady_clock::now();
+      {
+         AUDACITY_TRACE_SCOPE("DBConnection checkpoint");
+         do {
+            rc = giveUp ? SQLITE_OK :
+               sqlite3_wal_checkpoint_v2(
+                  db, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+         }
+         // Contentions for an exclusive lock on the database are possible,
+         // even while the main thread is merely drawing the tracks, which
+         // may perform reads
+         while (rc == SQLITE_BUSY && (std::this_thread::sleep_for(1ms), true));
+
+         // After a deferral, shrink the log that grew meanwhile.  The passive
+         // checkpoint left little to copy, so writers are not blocked for long;
+         // if readers still use the log, leave that to a later checkpoint
+         if (truncate && !giveUp && rc == SQLITE_OK) {
+            const auto rcTruncate = sqlite3_wal_checkpoint_v2(
+               db, nullptr, SQLITE_CHECKPOINT_TRUNCATE, nullptr, nullptr);
+            if (rcTruncate != SQLITE_BUSY)
+               rc = rcTruncate;
+         }
       }
-      // Contentions for an exclusive lock on the database are possible,
-      // even while the main thread is merely drawing the tracks, which
-      // may perform reads
-      while (rc == SQLITE_BUSY && (std::this_thread::sleep_for(1ms), true));
+      const auto seconds =
+         duration_cast<duration<double>>(steady_clock::now() - start).count();
 
       // Reset
+      {
+         std::lock_guard<std::mutex> guard(mCheckpointMutex);
+         auto &statistics = mCheckpointStatistics;
+         ++statistics.count;
+         if (forced)
+            ++statistics.forced;
+         statistics.lastSeconds = seconds;
+         statistics.maxSeconds = std::max(statistics.maxSeconds, seconds);
+         statistics.totalSeconds += seconds;
+      }
       mCheckpointActive = false;
 
       if (rc != SQLITE_OK)
@@ -591,12 +774,58 @@ int DBConnection::CheckpointHook(void *data, sqlite3 *db, const char *schema, in
 
    // Queue the database pointer for our checkpoint thread to process
    std::lock_guard<std::mutex> guard(that->mCheckpointMutex);
+   that->mWalPages = pages;
    that->mCheckpointPending = true;
    that->mCheckpointCondition.notify_one();
 
    return SQLITE_OK;
 }
 
+bool DBConnection::CheckpointDeferred() const
+{
+   return sCheckpointsDeferred && !mCheckpointUrgent &&
+      mWalPages < mDeferredCheckpointPages;
+}
+
+void DBConnection::DeferCheckpoints(bool defer)
+{
+   if (sCheckpointsDeferred.exchange(defer) == defer || defer)
+      return;
+
+   // Deferral ended; checkpoint fully what accumulated meanwhile
+   std::lock_guard<std::mutex> guard{ sConnectionsMutex };
+   for (const auto pConnection : sConnections) {
+      std::lock_guard<std::mutex> lock{ pConnection->mCheckpointMutex };
+      pConnection->mCheckpointTruncate = true;
+      pConnection->mCheckpointPending = true;
+      pConnection->mCheckpointCondition.notify_one();
+   }
+}
+
+auto DBConnection::GetCheckpointStatistics() const -> CheckpointStatistics
+{
+   std::lock_guard<std::mutex> guard(mCheckpointMutex);
+   auto result = mCheckpointStatistics;
+   result.walBytes = static_cast<size_t>(mWalPages) * AUDACITY_PROJECT_PAGE_SIZE;
+   return result;
+}
+
+auto DBConnection::GetIOStatistics() -> IOStatistics
+{
+   IOStatistics result;
+   if (!mDB)
+      return result;
+   const auto get = [this](int op, long long &value) {
+      int current = 0, highwater = 0;
+      if (sqlite3_db_status(mDB, op, &current, &highwater, 0) == SQLITE_OK)
+         value = current;
+   };
+   get(SQLITE_DBSTATUS_CACHE_HIT, result.cacheHits);
+   get(SQLITE_DBSTATUS_CACHE_MISS, result.cacheMisses);
+   get(SQLITE_DBSTATUS_CACHE_WRITE, result.pagesWritten);
+   return result;
+}
+
 // Install an implementation of TransactionScope
 #include "TransactionScope.h"
 
@@ -733,3 +962,9 @@ const ConnectionPtr &ConnectionPtr::Get( const AudacityProject &project )
    return Get( const_cast< AudacityProject & >( project ) );
 }
 
+StringSetting CheckpointThreadCores{ L"/FileFormats/CheckpointThreadCores", L"" };
+IntSetting DeferredCheckpointMegabytes{
+   L"/FileFormats/DeferredCheckpointMegabytes", 256 };
+IntSetting MemoryMapMegabytes{ L"/FileFormats/MemoryMapMegabytes",
+   // Address space of 32 bit processes is too scarce
+   sizeof(void*) >= 8 ? 4096 : 0 };
@@ -80,13 +80,50 @@ public:
       InsertSampleBlock,
       DeleteSampleBlock,
       GetSampleBlockSize,
-      GetAllSampleBlocksSize
+      GetAllSampleBlocksSize,
+      InsertSampleBlocks,
+      LoadAllSampleBlocks
    };
    sqlite3_stmt *Prepare(enum StatementID id, const char *sql);
+   //! Like Prepare(), for statements that only read
+   /*!
+    In threads other than the one that opened the database, the statement
+    may belong to a read-only connection of that thread, so that readers
+    don't contend for the primary connection.  Such a connection sees only
+    committed data:  if a row is not found, retry with Prepare().
+    Use sqlite3_db_handle() to distinguish the connections.
+    */
+   sqlite3_stmt *PrepareRead(enum StatementID id, const char *sql);
 
    void SetBypass( bool bypass );
    bool ShouldBypass();
 
+   //! While deferred, checkpoints of all connections wait, so that they do not
+   //! compete for the disk with recording, unless the write-ahead log of a
+   //! project grows to DeferredCheckpointMegabytes
+   /*! When deferral ends, each connection checkpoints all of its log, then
+    truncates it.  May be called in any thread. */
+   static void DeferCheckpoints(bool defer);
+
+   struct CheckpointStatistics {
+      //! Size of the write-ahead log after the last commit
+      size_t walBytes{ 0 };
+      //! Checkpoints done, and those of them forced by the size of the log
+      //! while deferred
+      size_t count{ 0 }, forced{ 0 };
+      double lastSeconds{ 0 }, maxSeconds{ 0 }, totalSeconds{ 0 };
+   };
+   //! May be called in any thread
+   CheckpointStatistics GetCheckpointStatistics() const;
+
+   //! Counts of the page cache of the primary connection since it opened;
+   //! the read-only connections of other threads are not included
+   struct IOStatistics {
+      long long cacheHits{ 0 }, cacheMisses{ 0 }, pagesWritten{ 0 };
+   };
+   //! Main thread only
+   IOStatistics GetIOStatistics();
+
    //! Just set stored errors
    void SetError(
       const TranslatableString &msg,
@@ -102,9 +139,14 @@ public:
 private:
    int OpenStepByStep(const FilePath fileName);
    int ModeConfig(sqlite3 *db, const char *schema, const char *config);
+   //! @pre mStatementMutex is locked
+   //! @return null if there is none for the thread and no more may be opened
+   sqlite3 *GetReadDB(std::thread::id thread);
 
    void CheckpointThread(sqlite3 *db, const FilePath &fileName);
    static int CheckpointHook(void *data, sqlite3 *db, const char *schema, int pages);
+   //! @pre mCheckpointMutex is locked
+   bool CheckpointDeferred() const;
 
 private:
    std::weak_ptr<AudacityProject> mpProject;
@@ -113,15 +155,30 @@ private:
 
    std::thread mCheckpointThread;
    std::condition_variable mCheckpointCondition;
-   std::mutex mCheckpointMutex;
+   mutable std::mutex mCheckpointMutex;
    std::atomic_bool mCheckpointStop{ false };
    std::atomic_bool mCheckpointPending{ false };
    std::atomic_bool mCheckpointActive{ false };
+   //! Set when deferral ends, for a checkpoint that also truncates the log
+   bool mCheckpointTruncate{ false };
+   //! Set when closing, so that deferral does not delay it
+   bool mCheckpointUrgent{ false };
+   //! Pages in the write-ahead log, reported by the hook
+   int mWalPages{ 0 };
+   //! Pages of the log that force a deferred checkpoint; 0 for no deferral
+   int mDeferredCheckpointPages{ 0 };
+   CheckpointStatistics mCheckpointStatistics;
 
    std::mutex mStatementMutex;
    using StatementIndex = std::pair<enum StatementID, std::thread::id>;
    std::map<StatementIndex, sqlite3_stmt *> mStatements;
 
+   //! The thread that opened the database, which uses only mDB
+   std::thread::id mOwnerThread;
+   //! Read-only connections of other threads; null after failure to open
+   std::map<std::thread::id, sqlite3 *> mReadDBs;
+   std::map<StatementIndex, sqlite3_stmt *> mReadStatements;
+
    std::shared_ptr<DBConnectionErrors> mpErrors;
    CheckpointFailureCallback mCallback;
 
@@ -148,4 +205,19 @@ public:
    Connection mpConnection;
 };
 
+class StringSetting;
+//! Processor numbers (as "0,2-3") to which to pin checkpoint threads; empty
+//! for no restriction
+extern PROJECT_FILE_IO_API StringSetting CheckpointThreadCores;
+
+class IntSetting;
+//! Size in megabytes of the write-ahead log of a project, at which it is
+//! checkpointed even while checkpoints are deferred; zero for no deferral.
+//! Applies when a file is opened.
+extern PROJECT_FILE_IO_API IntSetting DeferredCheckpointMegabytes;
+
+//! Largest part of a project file to read through a memory mapping, in
+//! megabytes; zero reads without mapping.  Applies when a file is opened.
+extern PROJECT_FILE_IO_API IntSetting MemoryMapMegabytes;
+
 #endif
@@ -10,6 +10,7 @@ Paul Licameli split from AudacityProject.cpp
 
 #include "ProjectFileIO.h"
 
+#include <algorithm>
 #include <atomic>
 #include <sqlite3.h>
 #include <optional>
@@ -94,11 +95,23 @@ static const int ProjectFileID = PACK('A', 'U', 'D', 'Y');
 // A search for "SQL sampleblocks" will find all SQL related 
 // to sampleblocks.
 
+// Value of PRAGMA auto_vacuum when pages may be freed by incremental_vacuum
+static const int AutoVacuumIncremental = 2;
+
+// Work done by each step of ProjectFileIO::CompactIncrementally(), small
+// enough that the deadline of a slice is not much overrun
+static const int CompactionRowsPerStep = 256;
+static const int CompactionPagesPerStep = 64;
+
 static const char *ProjectFileSchema =
    // These are persistent and not connection based
    //
    // See the CMakeList.txt for the SQLite lib for more
    // settings.
+   //
+   // auto_vacuum must precede the creation of tables; it lets
+   // CompactIncrementally() return free pages without copying the file.
+   "PRAGMA <schema>.auto_vacuum = INCREMENTAL;"
    "PRAGMA <schema>.application_id = %d;"
    "PRAGMA <schema>.user_version = %u;"
    ""
@@ -372,6 +385,110 @@ protected:
 
 constexpr std::array<const char*, 2> BufferedProjectBlobStream::Columns;
 
+//! Reads a document rebuilt in memory, as BufferedProjectBlobStream reads one
+//! stored in the database
+class BufferedStringStream final : public BufferedStreamReader
+{
+public:
+   explicit BufferedStringStream(const std::string &contents)
+      : mContents{ contents }
+   {
+   }
+
+protected:
+   bool HasMoreData() const override
+   {
+      return mOffset < mContents.size();
+   }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      maxBytes = std::min(maxBytes, mContents.size() - mOffset);
+      memcpy(buffer, mContents.data() + mOffset, maxBytes);
+      mOffset += maxBytes;
+      return maxBytes;
+   }
+
+private:
+   const std::string &mContents;
+   size_t mOffset{ 0 };
+};
+
+namespace {
+// The autosave delta is a sequence of records, each a kind byte and
+// little-endian 64 bit numbers, after the size of the whole document that
+// it changes:
+//    DeltaBase, offset, length: bytes copied from the whole document
+//    DeltaLiteral, length, bytes: bytes given in the record
+enum : unsigned char { DeltaBase, DeltaLiteral };
+
+//! Changes are written whole instead after this many
+constexpr int MaxAutoSaveDeltas = 32;
+
+// The autosave journal is the sizes of the autosave document and delta
+// written with it, the greatest block id, the count of runs of unreferenced
+// ids, then the first id and count of each run, all as for the delta
+
+//! Runs of ids in each statement that deletes the orphans they name
+constexpr size_t JournalRunsPerStatement = 256;
+
+void AppendNumber(MemoryStream &stream, uint64_t value)
+{
+   unsigned char bytes[sizeof(value)];
+   for (auto &byte : bytes) {
+      byte = value & 0xFF;
+      value >>= 8;
+   }
+   stream.AppendData(bytes, sizeof(bytes));
+}
+
+bool ReadNumber(const std::string &contents, size_t &offset, uint64_t &value)
+{
+   if (contents.size() - offset < sizeof(value))
+      return false;
+   value = 0;
+   for (size_t ii = sizeof(value); ii-- > 0;)
+      value = (value << 8) |
+         static_cast<unsigned char>(contents[offset + ii]);
+   offset += sizeof(value);
+   return true;
+}
+
+bool HasTable(sqlite3 *db, const char *table)
+{
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{
+      if (stmt)
+         sqlite3_finalize(stmt);
+   });
+   return sqlite3_prepare_v2(db,
+         "SELECT 1 FROM main.sqlite_master WHERE type = 'table' AND name = ?1;",
+         -1, &stmt, nullptr) == SQLITE_OK &&
+      sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC) == SQLITE_OK &&
+      sqlite3_step(stmt) == SQLITE_ROW;
+}
+
+//! Append the columns of the row with id 1 of a table to `contents`
+bool ReadColumns(sqlite3 *db, const char *sql, std::string &contents)
+{
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{
+      if (stmt)
+         sqlite3_finalize(stmt);
+   });
+   if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK ||
+       sqlite3_step(stmt) != SQLITE_ROW)
+      return false;
+   for (int column = 0, count = sqlite3_column_count(stmt);
+        column < count; ++column) {
+      const auto data =
+         static_cast<const char *>(sqlite3_column_blob(stmt, column));
+      contents.append(data ? data : "", sqlite3_column_bytes(stmt, column));
+   }
+   return true;
+}
+}
+
 bool ProjectFileIO::InitializeSQL()
 {
    if (audacity::sqlite::Initialize().IsError())
@@ -475,6 +592,69 @@ wxString ProjectFileIO::GenerateDoc()
    return doc;
 }
 
+namespace {
+//! Same columns as the project and autosave documents
+constexpr auto CreateUndoTracksSQL =
+   "CREATE TABLE IF NOT EXISTS %s.undotracks"
+   "("
+   "  id                   INTEGER PRIMARY KEY,"
+   "  dict                 BLOB,"
+   "  doc                  BLOB"
+   ");";
+}
+
+std::optional<int64_t>
+ProjectFileIO::WriteUndoTracks(const ProjectSerializer &doc)
+{
+   auto db = DB();
+
+   // Made on demand, as for autosave deltas
+   char sql[256];
+   sqlite3_snprintf(sizeof(sql), sql, CreateUndoTracksSQL, "main");
+   if (!Query(sql, [](auto...) { return 0; }))
+      return {};
+
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{
+      if (stmt)
+         sqlite3_finalize(stmt);
+   });
+
+   const auto &dict = doc.GetDict();
+   const auto &data = doc.GetData();
+   if (sqlite3_prepare_v2(db,
+          "INSERT INTO main.undotracks(dict, doc) VALUES(?1, ?2);",
+          -1, &stmt, nullptr) != SQLITE_OK ||
+       sqlite3_bind_blob64(
+          stmt, 1, dict.GetData(), dict.GetSize(), SQLITE_STATIC) ||
+       sqlite3_bind_blob64(
+          stmt, 2, data.GetData(), data.GetSize(), SQLITE_STATIC) ||
+       sqlite3_step(stmt) != SQLITE_DONE)
+   {
+      SetDBError(
+         XO("Failed to write undo history to the project file.")
+      );
+      return {};
+   }
+
+   return sqlite3_last_insert_rowid(db);
+}
+
+bool ProjectFileIO::ReadUndoTracks(int64_t id, XMLTagHandler &handler)
+{
+   BufferedProjectBlobStream stream(DB(), "main", "undotracks", id);
+   return ProjectSerializer::Decode(stream, &handler);
+}
+
+void ProjectFileIO::DeleteUndoTracks(int64_t id)
+{
+   char sql[256];
+   sqlite3_snprintf(sizeof(sql), sql,
+      "DELETE FROM main.undotracks WHERE id = %lld;",
+      static_cast<long long>(id));
+   Query(sql, [](auto...) { return 0; }, true);
+}
+
 sqlite3 *ProjectFileIO::DB()
 {
    return GetConnection().DB();
@@ -837,6 +1017,12 @@ void ProjectFileIO::InSet(sqlite3_context *context, int argc, sqlite3_value **ar
 }
 
 bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement)
+{
+   return DeleteBlocks(blockids, complement, {});
+}
+
+bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement,
+   const wxString &condition)
 {
    auto db = DB();
    int rc;
@@ -865,8 +1051,9 @@ bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement)
    // This is the first command that writes to the database, and so we
    // do more informative error reporting than usual, if it fails.
    auto sql = wxString::Format(
-      "DELETE FROM sampleblocks WHERE %sinset(blockid);",
-      complement ? "NOT " : "" );
+      "DELETE FROM sampleblocks WHERE %sinset(blockid)%s;",
+      complement ? "NOT " : "",
+      condition.empty() ? wxString{} : " AND " + condition );
    rc = sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
    if (rc != SQLITE_OK)
    {
@@ -1141,6 +1328,19 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
          }
       }
 
+      // Undo history written to the file uses blocks that are all copied,
+      // unless pruning
+      if (!prune && HasTable(db, "undotracks")) {
+         char createSQL[256];
+         sqlite3_snprintf(
+            sizeof(createSQL), createSQL, CreateUndoTracksSQL, "outbound");
+         if (!Query(createSQL, [](auto...) { return 0; }) ||
+             !Query("INSERT INTO outbound.undotracks"
+                    "  SELECT * FROM main.undotracks;",
+                [](auto...) { return 0; }))
+            return false;
+      }
+
       // Write the doc.
       //
       // If we're compacting a temporary project (user initiated from the File
@@ -1209,6 +1409,20 @@ bool ProjectFileIO::ShouldCompact(const std::vector<const TrackList *> &tracks)
    // Remember if we had unused blocks in the project file
    mHadUnused = (blockcount > active.size());
 
+   // Files made before auto_vacuum was enabled can't return free pages
+   // incrementally; copying them is the only way
+   int64_t autoVacuum = 0, freePages = 0, pageCount = 0;
+   if (GetValue("PRAGMA auto_vacuum;", autoVacuum, true) &&
+       autoVacuum != AutoVacuumIncremental &&
+       GetValue("PRAGMA freelist_count;", freePages, true) &&
+       GetValue("PRAGMA page_count;", pageCount, true) &&
+       pageCount > 0 && freePages * 100 / pageCount > 20)
+   {
+      wxLogDebug(wxT("compacting %lld free pages"),
+         static_cast<long long>(freePages));
+      return true;
+   }
+
    // Let's make a percentage...should be plenty of head room
    current *= 100;
 
@@ -1538,6 +1752,101 @@ void ProjectFileIO::Compact(
    return;
 }
 
+auto ProjectFileIO::CompactIncrementally(std::chrono::milliseconds slice)
+   -> CompactionProgress
+{
+   using Clock = std::chrono::steady_clock;
+   const auto deadline = Clock::now() + slice;
+   auto &pass = mCompactionPass;
+
+   const auto finish = [&pass]{
+      pass = {};
+      return CompactionProgress{ 1.0, true };
+   };
+
+   // Temporary projects are deleted at close and need no compaction
+   if (!HasConnection() || IsTemporary())
+      return finish();
+
+   const auto db = DB();
+   if (pass.db != db) {
+      // Begin a pass; blocks made later are in use, and need no examination
+      pass = {};
+      pass.db = db;
+      int64_t autoVacuum = 0;
+      if (!GetValue("SELECT coalesce(max(blockid), 0) FROM sampleblocks;",
+            pass.lastID, true) ||
+          !GetValue("PRAGMA auto_vacuum;", autoVacuum, true))
+         return finish();
+      pass.vacuum = (autoVacuum == AutoVacuumIncremental);
+   }
+
+   const auto progress = [&pass](int64_t freePages) {
+      const auto rows = pass.lastID > 0
+         ? std::min(1.0, double(pass.cursor) / pass.lastID)
+         : 1.0;
+      if (!pass.vacuum)
+         return rows;
+      const auto pages = pass.freePages > 0
+         ? 1.0 - double(freePages) / pass.freePages
+         : 0.0;
+      return (rows + pages) / 2;
+   };
+
+   // Don't write into an open transaction, whose rollback would undo the
+   // work; resume later
+   if (!sqlite3_get_autocommit(db))
+      return { progress(pass.freePages), false };
+
+   // Delete rows of blocks that no sample block object uses, a few at a time
+   if (pass.cursor < pass.lastID) {
+      const auto &pFactory =
+         WaveTrackFactory::Get( mProject ).GetSampleBlockFactory();
+      while (pass.cursor < pass.lastID) {
+         if (Clock::now() >= deadline)
+            return { progress(pass.freePages), false };
+         auto upTo = pass.lastID;
+         int64_t id = 0;
+         if (GetValue(wxString::Format(
+               "SELECT blockid FROM sampleblocks WHERE blockid > %lld"
+               " ORDER BY blockid LIMIT 1 OFFSET %d;",
+               static_cast<long long>(pass.cursor),
+               CompactionRowsPerStep - 1), id, true))
+            upTo = std::min(upTo, id);
+         // Only the live blocks of this range, not of all the project, need
+         // be found for each step
+         const auto blockids = pFactory->GetActiveBlockIDs(pass.cursor, upTo);
+         if (!DeleteBlocks(blockids, true, wxString::Format(
+               "blockid > %lld AND blockid <= %lld",
+               static_cast<long long>(pass.cursor),
+               static_cast<long long>(upTo))))
+            return finish();
+         pass.cursor = upTo;
+      }
+   }
+
+   // Return free pages to the file system, a few at a time
+   if (pass.vacuum) {
+      int64_t freePages = 0;
+      while (GetValue("PRAGMA freelist_count;", freePages, true) &&
+             freePages > 0) {
+         if (pass.freePages < 0)
+            pass.freePages = freePages;
+         if (Clock::now() >= deadline)
+            return { progress(freePages), false };
+         const auto sql = wxString::Format(
+            "PRAGMA incremental_vacuum(%d);", CompactionPagesPerStep);
+         if (sqlite3_exec(db, sql, nullptr, nullptr, nullptr) != SQLITE_OK) {
+            wxLogWarning(wxT("Incremental compaction failed: %s"),
+               sqlite3_errmsg(db));
+            break;
+         }
+      }
+   }
+
+   return finish();
+}
+
 bool ProjectFileIO::WasCompacted()
 {
    return mWasCompacted;
@@ -1787,11 +2096,13 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
 
 bool ProjectFileIO::AutoSave(bool recording)
 {
+   auto journal = MakeAutoSaveJournal(recording);
+
    ProjectSerializer autosave;
    WriteXMLHeader(autosave);
    WriteXML(autosave, recording);
 
-   if (WriteDoc("autosave", autosave))
+   if (WriteAutoSave(autosave, std::move(journal)))
    {
       mModified = true;
       return true;
@@ -1800,6 +2111,333 @@ bool ProjectFileIO::AutoSave(bool recording)
    return false;
 }
 
+bool ProjectFileIO::WriteAutoSave(const ProjectSerializer &autosave,
+   std::optional<AutoSaveJournal> journal)
+{
+   auto db = DB();
+   auto &base = mAutoSaveBase;
+
+   // Divide the document at the boundaries of top-level elements; the
+   // change of one track leaves the others identical
+   std::string document;
+   document.reserve(autosave.GetData().GetSize());
+   for (auto chunk : autosave.GetData())
+      document.append(static_cast<const char *>(chunk.first), chunk.second);
+   std::vector<std::string_view> segments;
+   size_t start = 0;
+   for (auto boundary : autosave.GetBoundaries()) {
+      if (boundary > start)
+         segments.emplace_back(document.data() + start, boundary - start);
+      start = boundary;
+   }
+   if (document.size() > start)
+      segments.emplace_back(document.data() + start, document.size() - start);
+
+   if (base.db == db && base.deltas < MaxAutoSaveDeltas) {
+      MemoryStream delta;
+      AppendNumber(delta, base.size);
+      size_t literalBytes = 0;
+      // Merge references to adjacent parts of the whole document
+      uint64_t copyOffset = 0, copyLength = 0;
+      const auto flush = [&]{
+         if (copyLength > 0) {
+            delta.AppendByte(DeltaBase);
+            AppendNumber(delta, copyOffset);
+            AppendNumber(delta, copyLength);
+         }
+         copyLength = 0;
+      };
+      for (auto segment : segments) {
+         if (const auto iter = base.index.find(segment);
+             iter != base.index.end()) {
+            const auto offset = base.offsets[iter->second];
+            if (copyLength == 0 || copyOffset + copyLength != offset) {
+               flush();
+               copyOffset = offset;
+            }
+            copyLength += segment.size();
+         }
+         else {
+            flush();
+            delta.AppendByte(DeltaLiteral);
+            AppendNumber(delta, segment.size());
+            delta.AppendData(segment.data(), segment.size());
+            literalBytes += segment.size();
+         }
+      }
+      flush();
+
+      // Consolidate instead when most of the document changed
+      if (literalBytes * 2 <= document.size()) {
+         if (!HasTable(db, "autosavedelta")) {
+            // Made on demand, so that files not changed since opening in
+            // a version before this one are not changed by merely opening
+            if (!Query(
+               "CREATE TABLE IF NOT EXISTS main.autosavedelta"
+               "("
+               "  id                   INTEGER PRIMARY KEY,"
+               "  dict                 BLOB,"
+               "  doc                  BLOB"
+               ");", [](auto...) { return 0; }))
+               return false;
+         }
+         if (journal) {
+            journal->docSize = base.size;
+            journal->deltaSize = delta.GetSize();
+         }
+         TransactionScope transaction(mProject, "AutoSave");
+         if (!WriteDoc("autosavedelta", autosave.GetDict(), delta) ||
+             !WriteAutoSaveJournal(journal) ||
+             !transaction.Commit())
+            return false;
+         ++base.deltas;
+         return true;
+      }
+   }
+
+   // Write the whole document, and forget the changes to the previous one,
+   // together
+   base = {};
+   if (journal) {
+      journal->docSize = document.size();
+      journal->deltaSize = 0;
+   }
+   {
+      TransactionScope transaction(mProject, "AutoSave");
+      if (!WriteDoc("autosave", autosave))
+         return false;
+      if (HasTable(db, "autosavedelta") &&
+          !Query("DELETE FROM main.autosavedelta;", [](auto...) { return 0; }))
+         return false;
+      if (!WriteAutoSaveJournal(journal))
+         return false;
+      if (!transaction.Commit())
+         return false;
+   }
+
+   base.db = db;
+   base.size = document.size();
+   base.segments.reserve(segments.size());
+   base.offsets.reserve(segments.size());
+   for (auto segment : segments) {
+      base.offsets.push_back(segment.data() - document.data());
+      base.segments.emplace_back(segment);
+   }
+   // Index after filling, so that the views stay valid
+   for (size_t ii = 0; ii < base.segments.size(); ++ii)
+      base.index.emplace(base.segments[ii], ii);
+
+   return true;
+}
+
+std::optional<std::string> ProjectFileIO::ReadAutoSaveDelta()
+{
+   auto db = DB();
+   std::string delta, document;
+   if (!HasTable(db, "autosavedelta") ||
+       !ReadColumns(db,
+         "SELECT dict, doc FROM main.autosavedelta WHERE id = 1;", delta) ||
+       !ReadColumns(db,
+         "SELECT doc FROM main.autosave WHERE id = 1;", document))
+      return {};
+
+   // The dictionary is the whole dict column, and the delta follows the
+   // size of the document it changes
+   int64_t dictSize = 0;
+   if (!GetValue(
+      "SELECT length(dict) FROM main.autosavedelta WHERE id = 1;",
+      dictSize, true) || dictSize < 0 ||
+       static_cast<uint64_t>(dictSize) > delta.size())
+      return {};
+
+   const auto fail = [&]{
+      wxLogWarning(
+         "Ignoring autosave changes that don't apply; recovering from the "
+         "last whole autosave");
+      return std::nullopt;
+   };
+
+   std::string result = delta.substr(0, dictSize);
+   size_t offset = dictSize;
+   uint64_t size;
+   if (!ReadNumber(delta, offset, size) || size != document.size())
+      return fail();
+   while (offset < delta.size()) {
+      const auto kind = static_cast<unsigned char>(delta[offset++]);
+      uint64_t first, second;
+      if (kind == DeltaBase) {
+         if (!ReadNumber(delta, offset, first) ||
+             !ReadNumber(delta, offset, second) ||
+             first > document.size() || second > document.size() - first)
+            return fail();
+         result.append(document, first, second);
+      }
+      else if (kind == DeltaLiteral) {
+         if (!ReadNumber(delta, offset, first) ||
+             first > delta.size() - offset)
+            return fail();
+         result.append(delta, offset, first);
+         offset += first;
+      }
+      else
+         return fail();
+   }
+   return result;
+}
+
+auto ProjectFileIO::MakeAutoSaveJournal(bool recording)
+   -> std::optional<AutoSaveJournal>
+{
+   AutoSaveJournal journal;
+   int64_t lastID = 0;
+   if (!GetValue("SELECT coalesce(max(blockid), 0) FROM sampleblocks;",
+         lastID, true))
+      return {};
+   journal.lastID = lastID;
+
+   // The blocks of the tracks that WriteXML() writes
+   WaveTrackUtilities::SampleBlockIDSet referenced;
+   const auto &pendingTracks = PendingTracks::Get(mProject);
+   for (const auto pTrack : TrackList::Get(mProject).Any()) {
+      const Track *useTrack = pTrack;
+      if (recording)
+         useTrack = &pendingTracks.SubstitutePendingChangedTrack(*pTrack);
+      else if (useTrack->GetId() == TrackId{})
+         continue;
+      if (const auto pWaveTrack = dynamic_cast<const WaveTrack *>(useTrack))
+         WaveTrackUtilities::InspectBlocks(*pWaveTrack, {}, &referenced);
+   }
+
+   // Blocks that only the undo history or the clipboard use would be orphans
+   // if the autosave were recovered
+   std::vector<SampleBlockID> unreferenced;
+   for (auto id : WaveTrackFactory::Get(mProject).GetSampleBlockFactory()
+           ->GetActiveBlockIDs())
+      if (id > 0 && id <= journal.lastID && !referenced.count(id))
+         unreferenced.push_back(id);
+   std::sort(unreferenced.begin(), unreferenced.end());
+   for (auto id : unreferenced) {
+      auto &runs = journal.unreferenced;
+      if (!runs.empty() &&
+          runs.back().first + static_cast<SampleBlockID>(runs.back().second)
+             == id)
+         ++runs.back().second;
+      else
+         runs.emplace_back(id, 1);
+   }
+   return journal;
+}
+
+bool ProjectFileIO::WriteAutoSaveJournal(
+   const std::optional<AutoSaveJournal> &journal)
+{
+   auto db = DB();
+   if (!journal)
+      // Recovery will examine every row instead
+      return !HasTable(db, "autosavejournal") ||
+         Query("DELETE FROM main.autosavejournal;", [](auto...) { return 0; });
+
+   // Made on demand, as for autosave deltas
+   if (!HasTable(db, "autosavejournal") && !Query(
+      "CREATE TABLE IF NOT EXISTS main.autosavejournal"
+      "("
+      "  id                   INTEGER PRIMARY KEY,"
+      "  dict                 BLOB,"
+      "  doc                  BLOB"
+      ");", [](auto...) { return 0; }))
+      return false;
+
+   MemoryStream stream;
+   AppendNumber(stream, journal->docSize);
+   AppendNumber(stream, journal->deltaSize);
+   AppendNumber(stream, journal->lastID);
+   AppendNumber(stream, journal->unreferenced.size());
+   for (const auto &[first, count] : journal->unreferenced) {
+      AppendNumber(stream, first);
+      AppendNumber(stream, count);
+   }
+   return WriteDoc("autosavejournal", MemoryStream{}, stream);
+}
+
+auto ProjectFileIO::ReadAutoSaveJournal() -> std::optional<AutoSaveJournal>
+{
+   auto db = DB();
+   std::string contents;
+   if (!HasTable(db, "autosavejournal") ||
+       !ReadColumns(db,
+         "SELECT dict, doc FROM main.autosavejournal WHERE id = 1;", contents))
+      return {};
+
+   AutoSaveJournal journal;
+   size_t offset = 0;
+   uint64_t lastID, nRuns;
+   if (!ReadNumber(contents, offset, journal.docSize) ||
+       !ReadNumber(contents, offset, journal.deltaSize) ||
+       !ReadNumber(contents, offset, lastID) ||
+       !ReadNumber(contents, offset, nRuns) ||
+       nRuns > (contents.size() - offset) / 16)
+      return {};
+   journal.lastID = lastID;
+   journal.unreferenced.reserve(nRuns);
+   while (nRuns--) {
+      uint64_t first, count;
+      if (!ReadNumber(contents, offset, first) ||
+          !ReadNumber(contents, offset, count))
+         return {};
+      journal.unreferenced.emplace_back(first, count);
+   }
+
+   // A version that doesn't know the journal may have written the autosave
+   // since
+   int64_t docSize = -1, deltaSize = 0;
+   if (!GetValue(
+         "SELECT coalesce(max(length(doc)), -1) FROM main.autosave;",
+         docSize, true) ||
+       (HasTable(db, "autosavedelta") && !GetValue(
+         "SELECT coalesce(max(length(doc)), 0) FROM main.autosavedelta;",
+         deltaSize, true)))
+      return {};
+   if (static_cast<uint64_t>(docSize) != journal.docSize ||
+       static_cast<uint64_t>(deltaSize) != journal.deltaSize) {
+      wxLogMessage(
+         "The autosave journal does not match the autosave; examining all "
+         "sample blocks");
+      return {};
+   }
+   return journal;
+}
+
+bool ProjectFileIO::DeleteBlocks(
+   const BlockIDs &blockids, const AutoSaveJournal &journal)
+{
+   TransactionScope transaction(mProject, "DeleteOrphans");
+
+   // Rows made since the journal was written
+   if (!DeleteBlocks(blockids, true, wxString::Format("blockid > %lld",
+         static_cast<long long>(journal.lastID))))
+      return false;
+
+   // Rows that the document did not use when the journal was written, as
+   // ranges of the primary key, so that the other rows are not visited
+   const auto &runs = journal.unreferenced;
+   for (size_t first = 0; first < runs.size();
+        first += JournalRunsPerStatement) {
+      wxString condition;
+      const auto last = std::min(runs.size(), first + JournalRunsPerStatement);
+      for (size_t ii = first; ii < last; ++ii) {
+         if (!condition.empty())
+            condition += " OR ";
+         condition += wxString::Format("blockid BETWEEN %lld AND %lld",
+            static_cast<long long>(runs[ii].first),
+            static_cast<long long>(runs[ii].first + runs[ii].second - 1));
+      }
+      if (!DeleteBlocks(blockids, true, "(" + condition + ")"))
+         return false;
+   }
+
+   return transaction.Commit();
+}
+
 bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
 {
    int rc;
@@ -1809,7 +2447,14 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
       db = DB();
    }
 
-   rc = sqlite3_exec(db, "DELETE FROM autosave;", nullptr, nullptr, nullptr);
+   // Changes to the autosave document, and its journal, go with it
+   mAutoSaveBase = {};
+   std::string sql = "DELETE FROM autosave;";
+   if (HasTable(db, "autosavedelta"))
+      sql += " DELETE FROM autosavedelta;";
+   if (HasTable(db, "autosavejournal"))
+      sql += " DELETE FROM autosavejournal;";
+   rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
    if (rc != SQLITE_OK)
    {
       ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
@@ -1829,6 +2474,14 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
 bool ProjectFileIO::WriteDoc(const char *table,
                              const ProjectSerializer &autosave,
                              const char *schema /* = "main" */)
+{
+   return WriteDoc(table, autosave.GetDict(), autosave.GetData(), schema);
+}
+
+bool ProjectFileIO::WriteDoc(const char *table,
+                             const MemoryStream &dict,
+                             const MemoryStream &data,
+                             const char *schema /* = "main" */)
 {
    auto db = DB();
 
@@ -1867,9 +2520,6 @@ bool ProjectFileIO::WriteDoc(const char *table,
       return false;
    }
 
-   const MemoryStream& dict = autosave.GetDict();
-   const MemoryStream& data = autosave.GetData();
-
    // Bind statement parameters
    // Might return SQL_MISUSE which means it's our mistake that we violated
    // preconditions; should return SQL_OK which is 0
@@ -2037,6 +2687,11 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
    if (!OpenConnection(fileName))
       return {};
 
+   // Undo history written to the file lasts only for the session
+   if (HasTable(DB(), "undotracks") &&
+       !Query("DELETE FROM main.undotracks;", [](auto...) { return 0; }))
+      return {};
+
    int64_t rowId = -1;
 
    bool useAutosave =
@@ -2062,11 +2717,29 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
       return {};
    else
    {
-      // Load 'er up
-      BufferedProjectBlobStream stream(
-         DB(), "main", useAutosave ? "autosave" : "project", rowId);
+      const auto decode = [this](BufferedStreamReader &stream) {
+         // Fetch the details of all blocks at once, not one by one as the
+         // document names them
+         SampleBlockLoading loading{ *WaveTrackFactory::Get( mProject )
+            .GetSampleBlockFactory() };
+         return ProjectSerializer::Decode(stream, this);
+      };
 
-      success = ProjectSerializer::Decode(stream, this);
+      // Load 'er up, with any changes autosaved since the whole document
+      bool deltaApplied = false;
+      if (const auto recovered =
+             useAutosave ? ReadAutoSaveDelta() : std::optional<std::string>{})
+      {
+         deltaApplied = true;
+         BufferedStringStream stream{ *recovered };
+         success = decode(stream);
+      }
+      else
+      {
+         BufferedProjectBlobStream stream(
+            DB(), "main", useAutosave ? "autosave" : "project", rowId);
+         success = decode(stream);
+      }
 
       if (!success)
       {
@@ -2083,7 +2756,14 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
             ->GetActiveBlockIDs();
       if (blockids.size() > 0)
       {
-         success = DeleteBlocks(blockids, true);
+         // Recovery needs to examine only the rows that the journal names,
+         // if it was written with the document just read
+         const auto journal = useAutosave
+            ? ReadAutoSaveJournal() : std::optional<AutoSaveJournal>{};
+         if (journal && (journal->deltaSize > 0) == deltaApplied)
+            success = DeleteBlocks(blockids, *journal);
+         else
+            success = DeleteBlocks(blockids, true);
          if (!success)
             return {};
       }
@@ -2679,3 +3359,12 @@ static ProjectHistory::AutoSave::Scope scope {
          "Error:_Disk_full_or_not_writable"
       };
 } };
+
+BoolSetting CompressSampleBlocks{ L"/FileFormats/CompressSampleBlocks", false };
+BoolSetting PackInt24SampleBlocks{
+   L"/FileFormats/PackInt24SampleBlocks", false };
+IntSetting SampleCacheMegabytes{ L"/FileFormats/SampleCacheMegabytes", 256 };
+BoolSetting LazySampleBlockMetadata{
+   L"/FileFormats/LazySampleBlockMetadata", false };
+BoolSetting DeduplicateSampleBlocks{
+   L"/FileFormats/DeduplicateSampleBlocks", false };
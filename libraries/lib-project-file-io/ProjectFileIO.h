@@ -11,9 +11,13 @@ Paul Licameli split from AudacityProject.h
 #ifndef __AUDACITY_PROJECT_FILE_IO__
 #define __AUDACITY_PROJECT_FILE_IO__
 
+#include <chrono>
 #include <memory>
 #include <optional>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <wx/event.h>
 
@@ -29,6 +33,7 @@ struct sqlite3_value;
 
 class AudacityProject;
 class DBConnection;
+class MemoryStream;
 struct DBConnectionErrors;
 class ProjectSerializer;
 class SqliteSampleBlock;
@@ -205,6 +210,28 @@ public:
    void Compact(
       const std::vector<const TrackList *> &tracks, bool force = false);
 
+   //! Progress of a pass of CompactIncrementally()
+   struct CompactionProgress {
+      //! Fraction of the pass done, from 0 to 1
+      double fraction{ 0.0 };
+      //! Whether the pass is finished; the next call begins another
+      bool done{ false };
+   };
+
+   //! Do a bounded slice of the work of compaction in place, resuming the
+   //! pass that earlier calls left unfinished
+   /*!
+    Deletes the rows of sample blocks that no sample block object uses, then,
+    if the file permits, returns free pages to the file system.  Unlike
+    Compact(), it neither copies the file nor keeps blocks only of given
+    tracks, so it may run at any time while the project is open.  It does
+    nothing while a transaction is open.
+
+    Free pages are recorded in the file, so an unfinished pass loses little
+    when the project closes.
+    */
+   CompactionProgress CompactIncrementally(std::chrono::milliseconds slice);
+
    // The last compact check did actually compact the project file if true
    bool WasCompacted();
 
@@ -228,6 +255,17 @@ public:
    //! Return a strings representation of the active project XML doc
    wxString GenerateDoc();
 
+   //! Write a document of tracks of a state of undo history
+   /*!
+    The documents last only while the project stays open
+    @return the id for reading it back, or nullopt on failure
+    */
+   std::optional<int64_t> WriteUndoTracks(const ProjectSerializer &doc);
+   //! Give a document written by WriteUndoTracks() to a handler
+   bool ReadUndoTracks(int64_t id, XMLTagHandler &handler);
+   //! Forget a document written by WriteUndoTracks()
+   void DeleteUndoTracks(int64_t id);
+
 private:
    void OnCheckpointFailure();
 
@@ -274,6 +312,47 @@ private:
 
    // Write project or autosave XML (binary) documents
    bool WriteDoc(const char *table, const ProjectSerializer &autosave, const char *schema = "main");
+   bool WriteDoc(const char *table, const MemoryStream &dict,
+      const MemoryStream &data, const char *schema = "main");
+
+   //! What recovery from the autosave needs to find orphaned sample blocks,
+   //! without examining every row
+   struct AutoSaveJournal {
+      //! Sizes of the autosave document and of its changes, if any, written
+      //! with the journal
+      uint64_t docSize{}, deltaSize{};
+      //! Greatest block id stored; rows made later may be orphans
+      SampleBlockID lastID{};
+      //! Blocks in use, but not by the document, as runs of consecutive ids,
+      //! each the first id and the count
+      std::vector<std::pair<SampleBlockID, uint64_t>> unreferenced;
+   };
+
+   //! Write the autosave document whole, or else only its top-level elements
+   //! that differ from the last one written whole, and the journal with it
+   bool WriteAutoSave(const ProjectSerializer &autosave,
+      std::optional<AutoSaveJournal> journal);
+   //! Rebuild the dictionary and document of the autosave, from its last
+   //! whole document and the changes written since
+   /*! @return nullopt if there are no changes, or they don't apply */
+   std::optional<std::string> ReadAutoSaveDelta();
+
+   //! Make the journal before writing the document, so that blocks made
+   //! meanwhile come after its last id
+   std::optional<AutoSaveJournal> MakeAutoSaveJournal(bool recording);
+   //! Replace the journal, or delete it if null
+   bool WriteAutoSaveJournal(const std::optional<AutoSaveJournal> &journal);
+   //! @return nullopt if there is none, or it was not written with the
+   //! autosave document now stored
+   std::optional<AutoSaveJournal> ReadAutoSaveJournal();
+   //! Delete only the rows that the journal says may be orphans, and are
+   //! not among `blockids`
+   bool DeleteBlocks(const BlockIDs &blockids, const AutoSaveJournal &journal);
+
+   // As the public overload, but only among rows satisfying an SQL condition,
+   // if not empty
+   bool DeleteBlocks(const BlockIDs &blockids, bool complement,
+      const wxString &condition);
 
    // Application defined function to verify blockid exists is in set of blockids
    static void InSet(sqlite3_context *context, int argc, sqlite3_value **argv);
@@ -329,6 +408,35 @@ private:
    // Project had unused blocks during last Compact()
    bool mHadUnused;
 
+   //! State of the unfinished pass of CompactIncrementally()
+   struct CompactionPass {
+      //! Connection of the pass; another one begins a new pass
+      sqlite3 *db{};
+      //! Greatest block id when the pass began
+      int64_t lastID{};
+      //! Rows with ids up to this one were examined
+      int64_t cursor{};
+      //! Free pages when the vacuuming began, or negative before
+      int64_t freePages{ -1 };
+      //! Whether the file permits returning free pages
+      bool vacuum{ false };
+   } mCompactionPass;
+
+   //! The autosave document last written whole, divided into its top-level
+   //! elements and the parts between them
+   struct AutoSaveBase {
+      //! Connection written to; another one needs a whole document again
+      sqlite3 *db{};
+      std::vector<std::string> segments;
+      //! Offsets of segments in the document
+      std::vector<uint64_t> offsets;
+      uint64_t size{};
+      //! Index of segments by contents
+      std::unordered_map<std::string_view, size_t> index;
+      //! Count of changes written since
+      int deltas{ 0 };
+   } mAutoSaveBase;
+
    Connection mPrevConn;
    FilePath mPrevFileName;
    bool mPrevTemporary;
@@ -348,4 +456,34 @@ private:
    std::shared_ptr<AudacityProject> mpProject;
 };
 
+//! Whether sample blocks are stored losslessly compressed
+/*!
+ Read when a project is opened, and applies to blocks that it then makes.
+ Projects with compressed blocks can't be opened by versions before the
+ introduction of this setting.
+ */
+extern PROJECT_FILE_IO_API BoolSetting CompressSampleBlocks;
+
+//! Whether 24 bit sample blocks that are not compressed are stored in three
+//! bytes for each sample, not four
+/*!
+ Read when a project is opened, and applies to blocks that it then makes.
+ Projects with packed blocks can't be opened by versions before the
+ introduction of this setting.
+ */
+extern PROJECT_FILE_IO_API BoolSetting PackInt24SampleBlocks;
+
+//! Memory budget of the cache of samples of each project, in megabytes
+extern PROJECT_FILE_IO_API IntSetting SampleCacheMegabytes;
+
+//! Whether opening a project defers fetching the details of its sample blocks
+//! until they are used, or loaded in idle time afterward
+/*! Read when a project is opened */
+extern PROJECT_FILE_IO_API BoolSetting LazySampleBlockMetadata;
+
+//! Whether a new sample block with the same contents as another one of the
+//! project shares its row, instead of storing the samples again
+/*! Read when a project is opened */
+extern PROJECT_FILE_IO_API BoolSetting DeduplicateSampleBlocks;
+
 #endif
@@ -369,6 +369,8 @@ ProjectSerializer::~ProjectSerializer()
 
 void ProjectSerializer::StartTag(const wxString & name)
 {
+   if (mNesting++ == 1)
+      mBoundaries.push_back(mBuffer.GetSize());
    mBuffer.AppendByte(FT_StartTag);
    WriteName(name);
 }
@@ -377,6 +379,8 @@ void ProjectSerializer::EndTag(const wxString & name)
 {
    mBuffer.AppendByte(FT_EndTag);
    WriteName(name);
+   if (--mNesting == 1)
+      mBoundaries.push_back(mBuffer.GetSize());
 }
 
 void ProjectSerializer::WriteAttr(const wxString & name, const wxChar *value)
@@ -509,6 +513,11 @@ const MemoryStream& ProjectSerializer::GetData() const
    return mBuffer;
 }
 
+const std::vector<size_t>& ProjectSerializer::GetBoundaries() const
+{
+   return mBoundaries;
+}
+
 bool ProjectSerializer::IsEmpty() const
 {
    return mBuffer.GetSize() == 0;
@@ -528,22 +537,23 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
    XMLTagHandlerAdapter adapter(handler);
 
    std::vector<char> bytes;
+   // Each distinct name is stored once; its views stay valid while decoding,
+   // so that the tables of ids are only views, cheap to index, push and pop
+   std::unordered_set<std::string> mInterned;
    IdMap mIds;
    std::vector<IdMap> mIdStack;
    char mCharSize = 0;
 
-   mIds.clear();
-
    struct Error{}; // exception type for short-range try/catch
    auto Lookup = [&mIds]( UShort id ) -> std::string_view
    {
-      auto iter = mIds.find( id );
-      if (iter == mIds.end())
+      // Ids are dense, but a damaged document may use one not defined
+      if (id >= mIds.size() || mIds[id].data() == nullptr)
       {
          throw Error{};
       }
 
-      return iter->second;
+      return mIds[id];
    };
 
    int64_t stringsCount = 0;
@@ -551,9 +561,14 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
 
    auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](int len) -> std::string
    {
-      bytes.reserve( len );
+      // A damaged document may give a bad length or end early
+      if (len < 0)
+         throw Error{};
+      // The buffer keeps its capacity from string to string
+      bytes.resize( len );
       auto data = bytes.data();
-      in.Read( data, len );
+      if (in.Read( data, len ) != static_cast<size_t>(len))
+         throw Error{};
 
       stringsCount++;
       stringsLength += len;
@@ -587,14 +602,16 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
          {
             case FT_Push:
             {
-               mIdStack.push_back(mIds);
+               mIdStack.push_back(std::move(mIds));
                mIds.clear();
             }
             break;
 
             case FT_Pop:
             {
-               mIds = mIdStack.back();
+               if (mIdStack.empty())
+                  throw Error{};
+               mIds = std::move(mIdStack.back());
                mIdStack.pop_back();
             }
             break;
@@ -603,7 +620,9 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             {
                id = ReadUShort( in );
                auto len = ReadUShort( in );
-               mIds[id] = ReadString(len);
+               if (id >= mIds.size())
+                  mIds.resize(id + 1);
+               mIds[id] = *mInterned.insert(ReadString(len)).first;
             }
             break;
 
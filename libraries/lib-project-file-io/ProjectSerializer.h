@@ -16,8 +16,10 @@
 #include "MemoryStream.h" // member variables
 #include <wx/mstream.h>
 
+#include <string_view>
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 
 #include "Identifier.h"
 
@@ -30,7 +32,9 @@ class BufferedStreamReader;
 ///
 
 using NameMap = std::unordered_map<wxString, unsigned short>;
-using IdMap = std::unordered_map<unsigned short, std::string>;
+//! Names of a document by their ids, which are dense, viewing strings that
+//! the decoder keeps
+using IdMap = std::vector<std::string_view>;
 
 // This class's overrides do NOT throw AudacityException.
 class PROJECT_FILE_IO_API ProjectSerializer final : public XMLWriter
@@ -61,6 +65,9 @@ public:
 
    const MemoryStream& GetDict() const;
    const MemoryStream& GetData() const;
+   //! Offsets in GetData() where the children of the outermost element begin
+   //! and end, in increasing order
+   const std::vector<size_t>& GetBoundaries() const;
 
    bool IsEmpty() const;
    bool DictChanged() const;
@@ -74,6 +81,9 @@ private:
 private:
    MemoryStream mBuffer;
    bool mDictChanged;
+   std::vector<size_t> mBoundaries;
+   //! Count of tags started and not yet ended
+   int mNesting{ 0 };
 
    static NameMap mNames;
    static MemoryStream mDict;
@@ -13,21 +13,38 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 
 #include "BasicUI.h"
 #include "DBConnection.h"
+#include "MemoryAccounting.h"
 #include "ProjectFileIO.h"
+#include "SampleCompression.h"
+#include "SampleConversion.h"
 #include "SampleFormat.h"
+#include "SampleSummary.h"
+#include "Tracing.h"
 #include "AudioSegmentSampleView.h"
 #include "XMLTagHandler.h"
 
 #include "SampleBlock.h" // to inherit
+#include "SampleBlockCache.h"
 #include "UndoManager.h"
-#include "UndoTracks.h"
+#include "UndoTracksStorage.h"
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
 
+#include "crypto/SHA256.h"
+
 #include "SentryHelper.h"
 #include <wx/log.h>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <future>
 #include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
 
 class SqliteSampleBlockFactory;
 
@@ -38,9 +55,15 @@ public:
    BlockSampleView GetFloatSampleView(bool mayThrow) override;
 
 private:
+   //! Still valid after eviction from the factory's cache while views remain
    std::weak_ptr<std::vector<float>> mCache;
+   //! Serializes loading of the view, so that it is loaded only once
    std::mutex mCacheMutex;
 
+   //! Samples of a compressed row, kept alive by sRecentlyDecoded
+   std::weak_ptr<const std::vector<char>> mDecoded;
+   std::mutex mDecodedMutex;
+
 public:
    explicit SqliteSampleBlock(
       const std::shared_ptr<SqliteSampleBlockFactory> &pFactory);
@@ -48,12 +71,19 @@ public:
 
    void CloseLock() noexcept override;
 
-   void SetSamples(
-      constSamplePtr src, size_t numsamples, sampleFormat srcformat);
-
    //! Numbers of bytes needed for 256 and for 64k summaries
    using Sizes = std::pair< size_t, size_t >;
+   //! First part of storing samples, which does not use the database, and so
+   //! may be done in any thread
+   Sizes PrepareSamples(
+      constSamplePtr src, size_t numsamples, sampleFormat srcformat);
+   //! Second part of storing samples
    void Commit(Sizes sizes);
+   //! Bind the seven values of one row for insertion, starting at parameter
+   //! number `first`
+   void Bind(sqlite3_stmt *stmt, int first, Sizes sizes);
+   //! After insertion of the row bound by Bind()
+   void Committed(SampleBlockID id);
 
    void Delete();
 
@@ -65,6 +95,7 @@ public:
                        size_t numsamples) override;
    sampleFormat GetSampleFormat() const override;
    size_t GetSampleCount() const override;
+   bool SuggestSampleCount(size_t count) override;
 
    bool GetSummary256(float *dest, size_t frameoffset, size_t numframes) override;
    bool GetSummary64k(float *dest, size_t frameoffset, size_t numframes) override;
@@ -78,23 +109,62 @@ public:
    /// Gets extreme values for the entire block
    MinMaxRMS DoGetMinMaxRMS() const override;
 
+   //! Computed with the summaries, else once when first wanted
+   double DoGetSum() override;
+
    size_t GetSpaceUsage() const override;
    void SaveXML(XMLWriter &xmlFile) override;
 
 private:
    bool IsSilent() const { return mBlockID <= 0; }
+
+   //! How the samples column of a row holds the samples
+   enum class Encoding {
+      Plain,
+      Compressed,
+      //! int24Sample in PackedInt24Bytes each
+      Packed,
+   };
+
+   //! Stored details of a block other than its samples and summaries
+   struct Metadata {
+      //! Value of the sampleformat column, which may flag an Encoding
+      int format;
+      double sumMin;
+      double sumMax;
+      double sumRms;
+      size_t sampleCount;
+   };
+   //! Columns to select, in order, for ReadMetadata()
+   static const char *const MetadataColumns;
+   //! Read the columns of MetadataColumns from a row, beginning at `column`
+   static Metadata ReadMetadata(sqlite3_stmt *stmt, int column);
+   void SetMetadata(SampleBlockID sbid, const Metadata &metadata);
+
    void Load(SampleBlockID sbid);
+   //! Load the stored details of a block made lazily, once, in any thread
+   void EnsureLoaded() const;
+   //! DoGetSamples() without the cache
+   size_t ReadSamples(samplePtr dest,
+                      sampleFormat destformat,
+                      size_t sampleoffset,
+                      size_t numsamples);
    bool GetSummary(float *dest,
                    size_t frameoffset,
                    size_t numframes,
                    DBConnection::StatementID id,
                    const char *sql);
+   //! Query with a statement selecting one blob for the block id
    size_t GetBlob(void *dest,
                   sampleFormat destformat,
-                  sqlite3_stmt *stmt,
+                  DBConnection::StatementID id,
+                  const char *sql,
                   sampleFormat srcformat,
                   size_t srcoffset,
-                  size_t srcbytes);
+                  size_t srcbytes,
+                  Encoding encoding = Encoding::Plain);
+   //! All samples of a compressed row
+   std::shared_ptr<const std::vector<char>> GetDecoded();
 
    enum {
       fields = 3, /* min, max, rms */
@@ -115,21 +185,44 @@ private:
    friend SqliteSampleBlockFactory;
 
    const std::shared_ptr<SqliteSampleBlockFactory> mpFactory;
-   bool mValid{ false };
+   std::atomic<bool> mValid{ false };
+   //! Serializes EnsureLoaded()
+   mutable std::mutex mLoadMutex;
+   //! Whether mSampleCount came from SuggestSampleCount(), before loading
+   bool mCountSuggested{ false };
    bool mLocked = false;
 
    SampleBlockID mBlockID{ 0 };
 
    ArrayOf<char> mSamples;
+   //! Made by PrepareSamples() if the factory compresses, and it saves space
+   std::vector<uint8_t> mCompressed;
+   //! Made by PrepareSamples() from int24Sample if the factory packs them,
+   //! and they were not compressed
+   std::vector<char> mPacked;
+   //! How the row in the database holds the samples
+   Encoding mRowEncoding{ Encoding::Plain };
+   //! Digest of the format and samples, made by PrepareSamples() if the
+   //! factory deduplicates
+   std::string mContentHash;
+   //! Bytes of the uncompressed samples
    size_t mSampleBytes;
    size_t mSampleCount;
    sampleFormat mSampleFormat;
 
    ArrayOf<char> mSummary256;
    ArrayOf<char> mSummary64k;
+   //! Bytes of the samples, summaries and compressed samples held until
+   //! Committed()
+   MemoryAccounting::Charge mPendingCharge{
+      MemoryAccounting::Tag::SampleBlocks };
    double mSumMin;
    double mSumMax;
    double mSumRms;
+   //! Sum of the samples, not stored in the database, whose schema would
+   //! change; valid when mHasSum
+   std::atomic<double> mSum{ 0.0 };
+   std::atomic<bool> mHasSum{ false };
 
 #if defined(WORDS_BIGENDIAN)
 #error All sample block data is little endian...big endian not yet supported
@@ -142,6 +235,37 @@ private:
 static std::map< SampleBlockID, std::shared_ptr<SqliteSampleBlock> >
    sSilentBlocks;
 
+namespace {
+//! Added to the sampleformat column of rows with compressed samples
+constexpr int CompressedFormatFlag = 0x8000;
+//! Added to the sampleformat column of rows with packed int24Sample
+constexpr int PackedFormatFlag = 0x4000;
+
+//! Keeps the most recently decompressed samples of blocks alive, so that
+//! reading of a block in several pieces decompresses it only once
+class RecentlyDecoded {
+public:
+   using Samples = std::shared_ptr<const std::vector<char>>;
+   void Use(const Samples &samples)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      const auto iter = std::find(mSamples.begin(), mSamples.end(), samples);
+      if (iter == mSamples.begin() && iter != mSamples.end())
+         return;
+      if (iter != mSamples.end())
+         mSamples.erase(iter);
+      else if (mSamples.size() == Capacity)
+         mSamples.pop_back();
+      mSamples.push_front(samples);
+   }
+
+private:
+   static constexpr size_t Capacity = 16;
+   std::mutex mMutex;
+   std::deque<Samples> mSamples;
+} sRecentlyDecoded;
+}
+
 ///\brief Implementation of @ref SampleBlockFactory using Sqlite database
 class SqliteSampleBlockFactory final
    : public SampleBlockFactory
@@ -153,11 +277,17 @@ public:
    ~SqliteSampleBlockFactory() override;
 
    SampleBlockIDs GetActiveBlockIDs() override;
+   SampleBlockIDs GetActiveBlockIDs(
+      SampleBlockID after, SampleBlockID upTo) override;
 
    SampleBlockPtr DoCreate(constSamplePtr src,
       size_t numsamples,
       sampleFormat srcformat) override;
 
+   std::vector<SampleBlockPtr> DoCreateMany(
+      const std::vector<BlockSource> &sources,
+      sampleFormat srcformat) override;
+
    SampleBlockPtr DoCreateSilent(
       size_t numsamples,
       sampleFormat srcformat) override;
@@ -174,10 +304,40 @@ public:
       return mSampleBlockDeletionCallback;
    }
 
+   void BeginWriteBatch() override;
+   void EndWriteBatch() override;
+   void FlushWriteBatch() override;
+
+   SampleBlockCache *GetCache() override;
+
+   void BeginLoading() override;
+   void EndLoading() override;
+
 private:
    void OnBeginPurge(size_t begin, size_t end);
    void OnEndPurge();
 
+   //! Insert rows for blocks prepared by SqliteSampleBlock::PrepareSamples,
+   //! several to each statement
+   void CommitMany(
+      const std::vector<std::shared_ptr<SqliteSampleBlock>> &blocks,
+      const std::vector<SqliteSampleBlock::Sizes> &sizes);
+   //! Count insertions, flushing an open write batch when it is big enough
+   void OnInserted(size_t count);
+   //! Execute a statement about the write batch savepoint
+   bool ExecBatch(const char *sql);
+   //! Fetch the details of all stored blocks into mPreloaded, with one scan
+   //! of the table
+   void Preload();
+   //! Load some of mUnloaded on the main thread, then schedule another call
+   //! if any remain
+   void WarmSome();
+   //! A live block with the same contents as `block`, which is prepared and
+   //! not committed, or else null, after remembering `block` for later
+   //! comparisons
+   std::shared_ptr<SqliteSampleBlock>
+   FindDuplicate(const std::shared_ptr<SqliteSampleBlock> &pBlock);
+
    friend SqliteSampleBlock;
 
    AudacityProject &mProject;
@@ -192,11 +352,62 @@ private:
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
    AllBlocksMap mAllBlocks;
+
+   //! Nesting depth of BeginWriteBatch()
+   size_t mBatchDepth{ 0 };
+   //! Whether the outermost BeginWriteBatch() found no transaction and so
+   //! opened a savepoint
+   bool mBatchOpen{ false };
+   //! Rows inserted since the savepoint was opened
+   size_t mBatchInserts{ 0 };
+
+   //! Nesting depth of BeginLoading()
+   size_t mLoadingDepth{ 0 };
+   //! Details of stored blocks not yet made, while loading, after the first
+   //! is made from an id
+   std::optional<std::unordered_map<SampleBlockID, SqliteSampleBlock::Metadata>>
+      mPreloaded;
+
+   //! Whether to compress the samples of new blocks; fixed when the project
+   //! is opened
+   const bool mCompress;
+   //! Whether to store int24Sample in three bytes each when not compressing
+   //! them; fixed when the project is opened
+   const bool mPackInt24;
+   //! Whether blocks made while loading defer fetching their details; fixed
+   //! when the project is opened
+   const bool mLazy;
+   //! Blocks made lazily and perhaps not yet loaded, for WarmSome()
+   std::deque<std::weak_ptr<SqliteSampleBlock>> mUnloaded;
+   //! Whether a call of WarmSome() is pending
+   bool mWarming{ false };
+
+   //! Whether new blocks share the rows of others with the same contents;
+   //! fixed when the project is opened
+   const bool mDeduplicate;
+   //! Blocks made in this session, by the digests of their contents
+   std::unordered_map<std::string, std::weak_ptr<SqliteSampleBlock>>
+      mBlocksByContents;
+
+   SampleBlockCache mSampleCache;
 };
 
+namespace {
+//! Rows in each multiple-row insertion
+constexpr size_t RowsPerInsert = 8;
+//! Rows inserted in a write batch before it is flushed
+constexpr size_t InsertsPerBatch = 256;
+}
+
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
    : mProject{ project }
    , mppConnection{ ConnectionPtr::Get(project).shared_from_this() }
+   , mCompress{ CompressSampleBlocks.Read() }
+   , mPackInt24{ PackInt24SampleBlocks.Read() }
+   , mLazy{ LazySampleBlockMetadata.Read() }
+   , mDeduplicate{ DeduplicateSampleBlocks.Read() }
+   , mSampleCache{
+      std::max(0, SampleCacheMegabytes.Read()) * size_t{ 1024 * 1024 } }
 {
    mUndoSubscription = UndoManager::Get(project)
       .Subscribe([this](UndoRedoMessage message){
@@ -217,12 +428,214 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
    constSamplePtr src, size_t numsamples, sampleFormat srcformat )
 {
    auto sb = std::make_shared<SqliteSampleBlock>(shared_from_this());
-   sb->SetSamples(src, numsamples, srcformat);
+   const auto sizes = sb->PrepareSamples(src, numsamples, srcformat);
+   if (auto pDuplicate = FindDuplicate(sb))
+      return pDuplicate;
+   sb->Commit(sizes);
    // block id has now been assigned
    mAllBlocks[ sb->GetBlockID() ] = sb;
    return sb;
 }
 
+std::vector<SampleBlockPtr> SqliteSampleBlockFactory::DoCreateMany(
+   const std::vector<BlockSource> &sources, sampleFormat srcformat)
+{
+   const auto nBlocks = sources.size();
+   if (nBlocks == 0)
+      return {};
+   std::vector<std::shared_ptr<SqliteSampleBlock>> blocks(nBlocks);
+   std::vector<SqliteSampleBlock::Sizes> sizes(nBlocks);
+   for (auto &pBlock : blocks)
+      pBlock = std::make_shared<SqliteSampleBlock>(shared_from_this());
+
+   // Copying of samples and computation of summaries don't touch the
+   // database, so divide them among threads
+   const auto prepare = [&](size_t first, size_t last) {
+      for (auto i = first; i < last; ++i)
+         sizes[i] = blocks[i]->PrepareSamples(
+            sources[i].src, sources[i].numsamples, srcformat);
+   };
+   const size_t nThreads = std::min<size_t>(nBlocks,
+      std::max(1u, std::thread::hardware_concurrency()));
+   const auto perThread = (nBlocks + nThreads - 1) / nThreads;
+   {
+      std::vector<std::future<void>> futures;
+      for (auto first = perThread; first < nBlocks; first += perThread)
+         futures.push_back(std::async(std::launch::async,
+            prepare, first, std::min(nBlocks, first + perThread)));
+      prepare(0, std::min(nBlocks, perThread));
+      // Rethrow any exception from the other threads
+      for (auto &future : futures)
+         future.get();
+   }
+
+   // Blocks of repeated contents, as from a Repeat effect, share one row
+   std::vector<std::shared_ptr<SqliteSampleBlock>> unique;
+   std::vector<SqliteSampleBlock::Sizes> uniqueSizes;
+   unique.reserve(nBlocks);
+   uniqueSizes.reserve(nBlocks);
+   for (size_t i = 0; i < nBlocks; ++i) {
+      if (auto pDuplicate = FindDuplicate(blocks[i]))
+         blocks[i] = std::move(pDuplicate);
+      else {
+         unique.push_back(blocks[i]);
+         uniqueSizes.push_back(sizes[i]);
+      }
+   }
+
+   // Insertions into the database remain in this thread, in order, and in
+   // one transaction
+   {
+      SampleBlockWriteBatch batch{ *this };
+      CommitMany(unique, uniqueSizes);
+   }
+
+   std::vector<SampleBlockPtr> result;
+   result.reserve(nBlocks);
+   for (auto &pBlock : blocks) {
+      // block id has now been assigned
+      mAllBlocks[ pBlock->GetBlockID() ] = pBlock;
+      result.push_back(pBlock);
+   }
+   return result;
+}
+
+void SqliteSampleBlockFactory::CommitMany(
+   const std::vector<std::shared_ptr<SqliteSampleBlock>> &blocks,
+   const std::vector<SqliteSampleBlock::Sizes> &sizes)
+{
+   AUDACITY_TRACE_SCOPE("SqliteSampleBlockFactory::CommitMany");
+   const auto nBlocks = blocks.size();
+   size_t first = 0;
+   if (nBlocks >= RowsPerInsert) {
+      auto &conn = *blocks[0]->Conn();
+      const auto db = conn.DB();
+
+      static const auto sql = []{
+         std::string result =
+            "INSERT INTO sampleblocks (sampleformat, summin, summax, sumrms,"
+            " summary256, summary64k, samples) VALUES";
+         for (size_t row = 0; row < RowsPerInsert; ++row)
+            result += row ? ",(?,?,?,?,?,?,?)" : "(?,?,?,?,?,?,?)";
+         return result + ";";
+      }();
+      // Prepare and cache statement...automatically finalized at DB close
+      sqlite3_stmt *stmt =
+         conn.Prepare(DBConnection::InsertSampleBlocks, sql.c_str());
+
+      for (; first + RowsPerInsert <= nBlocks; first += RowsPerInsert) {
+         for (size_t row = 0; row < RowsPerInsert; ++row)
+            blocks[first + row]->Bind(stmt, 1 + 7 * row, sizes[first + row]);
+
+         // Execute the statement
+         const auto rc = sqlite3_step(stmt);
+         if (rc != SQLITE_DONE || sqlite3_changes(db) != RowsPerInsert)
+         {
+            ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+            ADD_EXCEPTION_CONTEXT("sqlite3.context",
+               "SqliteSampleBlockFactory::CommitMany::step");
+
+            wxLogDebug(wxT("SqliteSampleBlockFactory::CommitMany - SQLITE error %s"),
+               sqlite3_errmsg(db));
+
+            // Clear statement bindings and rewind statement
+            sqlite3_clear_bindings(stmt);
+            sqlite3_reset(stmt);
+
+            // Just showing the user a simple message, not the library error
+            // too which isn't internationalized
+            conn.ThrowException( true );
+         }
+
+         // AUTOINCREMENT assigns consecutive ids to the rows of one
+         // statement, and this connection is the only writer
+         const auto last = sqlite3_last_insert_rowid(db);
+         for (size_t row = 0; row < RowsPerInsert; ++row)
+            blocks[first + row]->Committed(
+               last - (RowsPerInsert - 1) + row);
+
+         // Clear statement bindings and rewind statement
+         sqlite3_clear_bindings(stmt);
+         sqlite3_reset(stmt);
+
+         OnInserted(RowsPerInsert);
+      }
+   }
+
+   // Remaining blocks one at a time
+   for (; first < nBlocks; ++first)
+      blocks[first]->Commit(sizes[first]);
+}
+
+void SqliteSampleBlockFactory::BeginWriteBatch()
+{
+   if (mBatchDepth++ > 0)
+      return;
+   auto &pConnection = mppConnection->mpConnection;
+   // Within an enclosing transaction, rely on it instead
+   if (!pConnection || !sqlite3_get_autocommit(pConnection->DB()))
+      return;
+   mBatchOpen = ExecBatch("SAVEPOINT SampleBlockBatch;");
+   mBatchInserts = 0;
+}
+
+void SqliteSampleBlockFactory::EndWriteBatch()
+{
+   wxASSERT(mBatchDepth > 0);
+   if (--mBatchDepth > 0 || !mBatchOpen)
+      return;
+   mBatchOpen = false;
+   // Failure is only logged; SQLite leaves the savepoint open, and then
+   // commits it with the next transaction
+   ExecBatch("RELEASE SampleBlockBatch;");
+}
+
+void SqliteSampleBlockFactory::FlushWriteBatch()
+{
+   if (!mBatchOpen)
+      return;
+   mBatchInserts = 0;
+   if (!ExecBatch("RELEASE SampleBlockBatch;")) {
+      mBatchOpen = false;
+      mppConnection->mpConnection->ThrowException( true );
+   }
+   mBatchOpen = ExecBatch("SAVEPOINT SampleBlockBatch;");
+}
+
+SampleBlockCache *SqliteSampleBlockFactory::GetCache()
+{
+   return &mSampleCache;
+}
+
+void SqliteSampleBlockFactory::OnInserted(size_t count)
+{
+   if (mBatchOpen && (mBatchInserts += count) >= InsertsPerBatch)
+      FlushWriteBatch();
+}
+
+bool SqliteSampleBlockFactory::ExecBatch(const char *sql)
+{
+   auto &pConnection = mppConnection->mpConnection;
+   if (!pConnection)
+      return false;
+
+   char *errmsg = nullptr;
+   const auto rc =
+      sqlite3_exec(pConnection->DB(), sql, nullptr, nullptr, &errmsg);
+   if (errmsg)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context",
+         "SqliteSampleBlockFactory::ExecBatch");
+
+      pConnection->SetDBError(
+         XO("Failed to update savepoint:\n\n%s").Format(sql)
+      );
+      sqlite3_free(errmsg);
+   }
+   return rc == SQLITE_OK;
+}
+
 auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
 {
    SampleBlockIDs result;
@@ -238,6 +651,23 @@ auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
    return result;
 }
 
+auto SqliteSampleBlockFactory::GetActiveBlockIDs(
+   SampleBlockID after, SampleBlockID upTo) -> SampleBlockIDs
+{
+   // The map is ordered, so visit only the range
+   SampleBlockIDs result;
+   const auto end = mAllBlocks.upper_bound(upTo);
+   for (auto it = mAllBlocks.upper_bound(after); it != end;) {
+      if (it->second.expired())
+         it = mAllBlocks.erase(it);
+      else {
+         result.insert( it->first );
+         ++it;
+      }
+   }
+   return result;
+}
+
 SampleBlockPtr SqliteSampleBlockFactory::DoCreateSilent(
    size_t numsamples, sampleFormat )
 {
@@ -290,6 +720,24 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromId(
    auto ssb           = std::make_shared<SqliteSampleBlock>(shared_from_this());
    wb                 = ssb;
    ssb->mSampleFormat = srcformat;
+
+   if (mLoadingDepth > 0 && mLazy) {
+      // A placeholder, until first used, or warmed after loading
+      ssb->mBlockID = id;
+      mUnloaded.push_back(ssb);
+      return ssb;
+   }
+
+   if (mLoadingDepth > 0 && !mPreloaded)
+      Preload();
+   if (mPreloaded) {
+      if (const auto iter = mPreloaded->find(id); iter != mPreloaded->end()) {
+         ssb->SetMetadata(id, iter->second);
+         mPreloaded->erase(iter);
+         return ssb;
+      }
+   }
+
    // This may throw database errors
    // It initializes the rest of the fields
    ssb->Load(static_cast<SampleBlockID>(id));
@@ -297,25 +745,123 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromId(
    return ssb;
 }
 
+void SqliteSampleBlockFactory::BeginLoading()
+{
+   ++mLoadingDepth;
+}
+
+void SqliteSampleBlockFactory::EndLoading()
+{
+   if (mLoadingDepth > 0 && --mLoadingDepth == 0) {
+      mPreloaded.reset();
+      if (!mUnloaded.empty() && !mWarming) {
+         mWarming = true;
+         BasicUI::CallAfter([wThis = weak_from_this()]{
+            if (auto pThis = wThis.lock())
+               pThis->WarmSome();
+         });
+      }
+   }
+}
+
+namespace {
+//! Blocks loaded by each call of SqliteSampleBlockFactory::WarmSome()
+constexpr size_t BlocksPerWarming = 256;
+}
+
+void SqliteSampleBlockFactory::WarmSome()
+{
+   mWarming = false;
+   for (size_t ii = 0; ii < BlocksPerWarming && !mUnloaded.empty(); ++ii) {
+      if (const auto pBlock = mUnloaded.front().lock()) {
+         try {
+            pBlock->EnsureLoaded();
+         }
+         catch (...) {
+            // Ignored here; the reader will meet the error again
+         }
+      }
+      mUnloaded.pop_front();
+   }
+   if (!mUnloaded.empty()) {
+      // Yield to other events between batches
+      mWarming = true;
+      BasicUI::CallAfter([wThis = weak_from_this()]{
+         if (auto pThis = wThis.lock())
+            pThis->WarmSome();
+      });
+   }
+}
+
+std::shared_ptr<SqliteSampleBlock> SqliteSampleBlockFactory::FindDuplicate(
+   const std::shared_ptr<SqliteSampleBlock> &pBlock)
+{
+   if (!mDeduplicate || pBlock->mContentHash.empty())
+      return {};
+   auto &wBlock = mBlocksByContents[pBlock->mContentHash];
+   if (auto pDuplicate = wBlock.lock())
+      return pDuplicate;
+   // The first, or the only remaining, block with these contents
+   wBlock = pBlock;
+   return {};
+}
+
+void SqliteSampleBlockFactory::Preload()
+{
+   mPreloaded.emplace();
+   auto &preloaded = *mPreloaded;
+
+   auto &pConnection = mppConnection->mpConnection;
+   if (!pConnection)
+      return;
+
+   // Prepare and cache statement...automatically finalized at DB close
+   static const auto sql = std::string{ "SELECT blockid, " } +
+      SqliteSampleBlock::MetadataColumns + " FROM sampleblocks;";
+   sqlite3_stmt *stmt = pConnection->Prepare(
+      DBConnection::LoadAllSampleBlocks, sql.c_str());
+   if (!stmt)
+      return;
+
+   int rc;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+      preloaded.emplace(sqlite3_column_int64(stmt, 0),
+         SqliteSampleBlock::ReadMetadata(stmt, 1));
+   if (rc != SQLITE_DONE)
+   {
+      // Not fatal; each block will be loaded alone
+      wxLogDebug(wxT("SqliteSampleBlockFactory::Preload - SQLITE error %s"),
+         sqlite3_errmsg(pConnection->DB()));
+      preloaded.clear();
+   }
+
+   // Rewind statement
+   sqlite3_reset(stmt);
+}
+
 BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
 {
    assert(mSampleCount > 0);
 
-   // Double-checked locking.
-   // `weak_ptr::lock()` guarantees atomicity, which is important to make this
-   // work without races.
-   auto cache = mCache.lock();
-   if (cache)
-      return cache;
+   // Silent blocks are cheap to make, and their ids are shared
+   auto *const pSampleCache = IsSilent() ? nullptr : &mpFactory->mSampleCache;
+
    std::lock_guard<std::mutex> lock(mCacheMutex);
-   cache = mCache.lock();
-   if (cache)
+   if (pSampleCache)
+      if (auto cache = pSampleCache->Find(mBlockID))
+         return cache;
+   // The view may outlive its eviction from the cache
+   if (auto cache = mCache.lock()) {
+      if (pSampleCache)
+         pSampleCache->Insert(mBlockID, cache);
       return cache;
+   }
 
-   const auto newCache =
-      std::make_shared<std::vector<float>>(mSampleCount);
+   const auto newCache = MemoryAccounting::MakeChargedVector<float>(
+      MemoryAccounting::Tag::SampleBlocks, mSampleCount);
+   bool failed = false;
    try {
-      const auto cachedSize = DoGetSamples(
+      const auto cachedSize = ReadSamples(
          reinterpret_cast<samplePtr>(newCache->data()), floatSample, 0,
          mSampleCount);
       assert(cachedSize == mSampleCount);
@@ -325,8 +871,12 @@ BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
       if (mayThrow)
          std::rethrow_exception(std::current_exception());
       std::fill(newCache->begin(), newCache->end(), 0.f);
+      failed = true;
    }
    mCache = newCache;
+   // Don't keep zeroes for long after failure
+   if (pSampleCache && !failed)
+      pSampleCache->Insert(mBlockID, newCache);
    return newCache;
 }
 
@@ -352,6 +902,16 @@ SqliteSampleBlock::~SqliteSampleBlock()
       cb(*this);
    }
 
+   if (!IsSilent() && mpFactory)
+      mpFactory->mSampleCache.Erase(mBlockID);
+
+   if (!mContentHash.empty() && mpFactory) {
+      auto &byContents = mpFactory->mBlocksByContents;
+      if (const auto iter = byContents.find(mContentHash);
+          iter != byContents.end() && iter->second.expired())
+         byContents.erase(iter);
+   }
+
    if (IsSilent()) {
       // The block object was constructed but failed to Load() or Commit().
       // Or it's a silent block with no row in the database.
@@ -406,18 +966,62 @@ SampleBlockID SqliteSampleBlock::GetBlockID() const
 
 sampleFormat SqliteSampleBlock::GetSampleFormat() const
 {
+   EnsureLoaded();
    return mSampleFormat;
 }
 
 size_t SqliteSampleBlock::GetSampleCount() const
 {
+   if (!mCountSuggested)
+      EnsureLoaded();
    return mSampleCount;
 }
 
+bool SqliteSampleBlock::SuggestSampleCount(size_t count)
+{
+   if (mValid || IsSilent())
+      return false;
+   mSampleCount = count;
+   mSampleBytes = mSampleCount * SAMPLE_SIZE(mSampleFormat);
+   mCountSuggested = true;
+   return true;
+}
+
+void SqliteSampleBlock::EnsureLoaded() const
+{
+   if (mValid || IsSilent())
+      return;
+   std::lock_guard<std::mutex> lock{ mLoadMutex };
+   if (!mValid)
+      // Only the stored details change, which no const member reports
+      // before they are loaded
+      const_cast<SqliteSampleBlock*>(this)->Load(mBlockID);
+}
+
 size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
                                      sampleFormat destformat,
                                      size_t sampleoffset,
                                      size_t numsamples)
+{
+   // Float samples, as for playback, drawing and most effects, come through
+   // the cache, so that reading of a block in pieces or repeatedly queries
+   // the database once
+   if (destformat == floatSample && !IsSilent()) {
+      const auto view = GetFloatSampleView(true);
+      const auto samples = reinterpret_cast<float*>(dest);
+      sampleoffset = std::min(sampleoffset, view->size());
+      const auto copied = std::min(numsamples, view->size() - sampleoffset);
+      std::copy_n(view->data() + sampleoffset, copied, samples);
+      std::fill(samples + copied, samples + numsamples, 0.f);
+      return numsamples;
+   }
+   return ReadSamples(dest, destformat, sampleoffset, numsamples);
+}
+
+size_t SqliteSampleBlock::ReadSamples(samplePtr dest,
+                                      sampleFormat destformat,
+                                      size_t sampleoffset,
+                                      size_t numsamples)
 {
    if (IsSilent()) {
       auto size = SAMPLE_SIZE(destformat);
@@ -425,29 +1029,84 @@ size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
       return numsamples;
    }
 
-   // Prepare and cache statement...automatically finalized at DB close
-   sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::GetSamples,
-      "SELECT samples FROM sampleblocks WHERE blockid = ?1;");
+   EnsureLoaded();
+
+   if (mRowEncoding == Encoding::Compressed) {
+      const auto decoded = GetDecoded();
+      sampleoffset = std::min(sampleoffset, mSampleCount);
+      const auto copied = std::min(numsamples, mSampleCount - sampleoffset);
+      CopySamples(decoded->data() + sampleoffset * SAMPLE_SIZE(mSampleFormat),
+         mSampleFormat, dest, destformat, copied);
+      memset(dest + copied * SAMPLE_SIZE(destformat), 0,
+         (numsamples - copied) * SAMPLE_SIZE(destformat));
+      return numsamples;
+   }
+
+   if (mRowEncoding == Encoding::Packed)
+      return GetBlob(dest,
+                     destformat,
+                     DBConnection::GetSamples,
+                     "SELECT samples FROM sampleblocks WHERE blockid = ?1;",
+                     mSampleFormat,
+                     sampleoffset * PackedInt24Bytes,
+                     numsamples * PackedInt24Bytes,
+                     Encoding::Packed) / PackedInt24Bytes;
 
    return GetBlob(dest,
                   destformat,
-                  stmt,
+                  DBConnection::GetSamples,
+                  "SELECT samples FROM sampleblocks WHERE blockid = ?1;",
                   mSampleFormat,
                   sampleoffset * SAMPLE_SIZE(mSampleFormat),
                   numsamples * SAMPLE_SIZE(mSampleFormat)) / SAMPLE_SIZE(mSampleFormat);
 }
 
-void SqliteSampleBlock::SetSamples(constSamplePtr src,
-                                   size_t numsamples,
-                                   sampleFormat srcformat)
+auto SqliteSampleBlock::GetDecoded() -> std::shared_ptr<const std::vector<char>>
+{
+   std::lock_guard<std::mutex> lock(mDecodedMutex);
+   auto decoded = mDecoded.lock();
+   if (!decoded) {
+      auto newDecoded = MemoryAccounting::MakeChargedVector<char>(
+         MemoryAccounting::Tag::SampleBlocks, mSampleBytes);
+      GetBlob(newDecoded->data(), mSampleFormat, DBConnection::GetSamples,
+         "SELECT samples FROM sampleblocks WHERE blockid = ?1;",
+         mSampleFormat, 0, mSampleBytes, Encoding::Compressed);
+      mDecoded = decoded = std::move(newDecoded);
+   }
+   sRecentlyDecoded.Use(decoded);
+   return decoded;
+}
+
+auto SqliteSampleBlock::PrepareSamples(constSamplePtr src,
+   size_t numsamples, sampleFormat srcformat) -> Sizes
 {
    auto sizes = SetSizes(numsamples, srcformat);
    mSamples.reinit(mSampleBytes);
    memcpy(mSamples.get(), src, mSampleBytes);
 
+   if (mpFactory->mDeduplicate) {
+      crypto::SHA256 hasher;
+      const int format = mSampleFormat;
+      hasher.Update(&format, sizeof(format));
+      hasher.Update(mSamples.get(), mSampleBytes);
+      mContentHash = hasher.Finalize();
+   }
+
    CalcSummary( sizes );
 
-   Commit( sizes );
+   // Compression is the costliest part, and this may run in a worker thread
+   if (mpFactory->mCompress)
+      mCompressed = CompressSamples(mSamples.get(), mSampleFormat, mSampleCount);
+
+   if (mCompressed.empty() && mpFactory->mPackInt24 &&
+       mSampleFormat == int24Sample) {
+      mPacked.resize(mSampleCount * PackedInt24Bytes);
+      PackInt24Samples(mSamples.get(), mPacked.data(), mSampleCount);
+   }
+
+   mPendingCharge.Set(mSampleBytes + sizes.first + sizes.second +
+      mCompressed.size() + mPacked.size());
+   return sizes;
 }
 
 bool SqliteSampleBlock::GetSummary256(float *dest,
@@ -477,13 +1136,12 @@ bool SqliteSampleBlock::GetSummary(float *dest,
    if (!silent) {
       // Not a silent block
       try {
-         // Prepare and cache statement...automatically finalized at DB close
-         auto stmt = Conn()->Prepare(id, sql);
          // Note GetBlob returns a size_t, not a bool
          // REVIEW: An error in GetBlob() will throw an exception.
          GetBlob(dest,
                      floatSample,
-                     stmt,
+                     id,
+                     sql,
                      floatSample,
                      frameoffset * fields * SAMPLE_SIZE(floatSample),
                      numframes * fields * SAMPLE_SIZE(floatSample));
@@ -499,16 +1157,19 @@ bool SqliteSampleBlock::GetSummary(float *dest,
 
 double SqliteSampleBlock::GetSumMin() const
 {
+   EnsureLoaded();
    return mSumMin;
 }
 
 double SqliteSampleBlock::GetSumMax() const
 {
+   EnsureLoaded();
    return mSumMax;
 }
 
 double SqliteSampleBlock::GetSumRms() const
 {
+   EnsureLoaded();
    return mSumRms;
 }
 
@@ -526,10 +1187,7 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
    float max = -FLT_MAX;
    float sumsq = 0;
 
-   if (!mValid)
-   {
-      Load(mBlockID);
-   }
+   EnsureLoaded();
 
    if (start < mSampleCount)
    {
@@ -566,9 +1224,24 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
 /// these values are already computed.
 MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS() const
 {
+   EnsureLoaded();
    return { (float) mSumMin, (float) mSumMax, (float) mSumRms };
 }
 
+double SqliteSampleBlock::DoGetSum()
+{
+   if (IsSilent())
+      return 0.0;
+   if (mHasSum)
+      return mSum;
+   // Samples are immutable, so concurrent computations agree
+   const auto view = GetFloatSampleView(true);
+   const auto sum = std::accumulate(view->begin(), view->end(), 0.0);
+   mSum = sum;
+   mHasSum = true;
+   return sum;
+}
+
 size_t SqliteSampleBlock::GetSpaceUsage() const
 {
    if (IsSilent())
@@ -579,37 +1252,54 @@ size_t SqliteSampleBlock::GetSpaceUsage() const
 
 size_t SqliteSampleBlock::GetBlob(void *dest,
                                   sampleFormat destformat,
-                                  sqlite3_stmt *stmt,
+                                  DBConnection::StatementID id,
+                                  const char *sql,
                                   sampleFormat srcformat,
                                   size_t srcoffset,
-                                  size_t srcbytes)
+                                  size_t srcbytes,
+                                  Encoding encoding)
 {
+   AUDACITY_TRACE_SCOPE("SqliteSampleBlock::GetBlob");
    auto db = DB();
 
    wxASSERT(!IsSilent());
 
-   if (!mValid)
-   {
-      Load(mBlockID);
-   }
+   EnsureLoaded();
 
    int rc;
    size_t minbytes = 0;
 
-   // Bind statement parameters
-   // Might return SQLITE_MISUSE which means it's our mistake that we violated
-   // preconditions; should return SQL_OK which is 0
-   if (sqlite3_bind_int64(stmt, 1, mBlockID))
-   {
-      ADD_EXCEPTION_CONTEXT(
-         "sqlite3.rc", std::to_string(sqlite3_errcode(Conn()->DB())));
-      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::GetBlob::bind");
+   const auto bind = [this](sqlite3_stmt *stmt) {
+      // Bind statement parameters
+      // Might return SQLITE_MISUSE which means it's our mistake that we violated
+      // preconditions; should return SQL_OK which is 0
+      if (sqlite3_bind_int64(stmt, 1, mBlockID))
+      {
+         ADD_EXCEPTION_CONTEXT(
+            "sqlite3.rc", std::to_string(sqlite3_errcode(Conn()->DB())));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::GetBlob::bind");
 
-      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
-   }
+         wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+      }
+   };
+
+   // Prepare and cache statement...automatically finalized at DB close
+   // Prefer the read connection of this thread
+   auto stmt = Conn()->PrepareRead(id, sql);
+   bind(stmt);
 
    // Execute the statement
    rc = sqlite3_step(stmt);
+   if (rc != SQLITE_ROW && sqlite3_db_handle(stmt) != db)
+   {
+      // The row may not yet be committed, or the read connection may be
+      // busy; the primary connection has the final answer
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+      stmt = Conn()->Prepare(id, sql);
+      bind(stmt);
+      rc = sqlite3_step(stmt);
+   }
    if (rc != SQLITE_ROW)
    {
       ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
@@ -637,9 +1327,49 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
    samplePtr src = (samplePtr) sqlite3_column_blob(stmt, 0);
    size_t blobbytes = (size_t) sqlite3_column_bytes(stmt, 0);
 
+   if (encoding == Encoding::Compressed)
+   {
+      // Only GetDecoded() asks for this, and for all of the samples
+      wxASSERT(srcoffset == 0 && srcbytes == mSampleBytes &&
+         destformat == srcformat);
+      const bool decompressed = DecompressSamples(
+         src, blobbytes, srcformat, (samplePtr) dest, mSampleCount);
+
+      // Clear statement bindings and rewind statement
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+
+      if (!decompressed)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.context",
+            "SqliteSampleBlock::GetBlob::decompress");
+         Conn()->ThrowException( false );
+      }
+      return srcbytes;
+   }
+
    srcoffset = std::min(srcoffset, blobbytes);
    minbytes = std::min(srcbytes, blobbytes - srcoffset);
 
+   if (encoding == Encoding::Packed)
+   {
+      // Offsets and sizes count packed bytes; unpack directly to dest
+      wxASSERT(
+         srcformat == int24Sample &&
+         (destformat == floatSample || destformat == int24Sample));
+      const auto copied = minbytes / PackedInt24Bytes;
+      const auto wanted = srcbytes / PackedInt24Bytes;
+      UnpackInt24Samples(src + srcoffset, (samplePtr) dest, destformat, copied);
+      memset((samplePtr) dest + copied * SAMPLE_SIZE(destformat), 0,
+         (wanted - copied) * SAMPLE_SIZE(destformat));
+
+      // Clear statement bindings and rewind statement
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+
+      return srcbytes;
+   }
+
    if (srcoffset != 0)
    {
       srcoffset += 0;
@@ -708,18 +1438,11 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
 
    wxASSERT(sbid > 0);
 
-   mValid = false;
-   mSampleCount = 0;
-   mSampleBytes = 0;
-   mSumMin = FLT_MAX;
-   mSumMax = -FLT_MAX;
-   mSumMin = 0.0;
-
    // Prepare and cache statement...automatically finalized at DB close
+   static const auto sql = std::string{ "SELECT " } +
+      MetadataColumns + " FROM sampleblocks WHERE blockid = ?1;";
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::LoadSampleBlock,
-      "SELECT sampleformat, summin, summax, sumrms,"
-      "       length(samples)"
-      "  FROM sampleblocks WHERE blockid = ?1;");
+      sql.c_str());
 
    // Bind statement parameters
    // Might return SQLITE_MISUSE which means it's our mistake that we violated
@@ -754,26 +1477,72 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
    }
 
    // Retrieve returned data
-   mBlockID = sbid;
-   mSampleFormat = (sampleFormat) sqlite3_column_int(stmt, 0);
-   mSumMin = sqlite3_column_double(stmt, 1);
-   mSumMax = sqlite3_column_double(stmt, 2);
-   mSumRms = sqlite3_column_double(stmt, 3);
-   mSampleBytes = sqlite3_column_int(stmt, 4);
-   mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   SetMetadata(sbid, ReadMetadata(stmt, 0));
 
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
    sqlite3_reset(stmt);
+}
+
+// The CASE spares reading the whole blob of uncompressed samples
+// 32768 is CompressedFormatFlag
+const char *const SqliteSampleBlock::MetadataColumns =
+   "sampleformat, summin, summax, sumrms, length(samples),"
+   " CASE WHEN sampleformat & 32768 THEN substr(samples, 1, 8) END";
+
+auto SqliteSampleBlock::ReadMetadata(sqlite3_stmt *stmt, int column)
+   -> Metadata
+{
+   Metadata result;
+   result.format = sqlite3_column_int(stmt, column);
+   result.sumMin = sqlite3_column_double(stmt, column + 1);
+   result.sumMax = sqlite3_column_double(stmt, column + 2);
+   result.sumRms = sqlite3_column_double(stmt, column + 3);
+   if (result.format & CompressedFormatFlag)
+      // The length of the blob isn't that of the samples
+      result.sampleCount = CompressedSampleCount(
+         sqlite3_column_blob(stmt, column + 5),
+         sqlite3_column_bytes(stmt, column + 5));
+   else if (result.format & PackedFormatFlag)
+      result.sampleCount =
+         sqlite3_column_int(stmt, column + 4) / PackedInt24Bytes;
+   else
+      result.sampleCount = sqlite3_column_int(stmt, column + 4) /
+         SAMPLE_SIZE((sampleFormat) result.format);
+   return result;
+}
 
+void SqliteSampleBlock::SetMetadata(
+   SampleBlockID sbid, const Metadata &metadata)
+{
+   mBlockID = sbid;
+   mRowEncoding = (metadata.format & CompressedFormatFlag)
+      ? Encoding::Compressed
+      : (metadata.format & PackedFormatFlag)
+         ? Encoding::Packed
+         : Encoding::Plain;
+   mSampleFormat = (sampleFormat)
+      (metadata.format & ~(CompressedFormatFlag | PackedFormatFlag));
+   mSumMin = metadata.sumMin;
+   mSumMax = metadata.sumMax;
+   mSumRms = metadata.sumRms;
+   if (!mCountSuggested)
+      mSampleCount = metadata.sampleCount;
+   else if (metadata.sampleCount != mSampleCount)
+      // Keep the count that the sequence was built on; reading pads or
+      // truncates, as for a damaged block
+      wxLogWarning(
+         wxT("Block %lld has %lld samples, but the project expects %lld"),
+         static_cast<long long>(sbid),
+         static_cast<long long>(metadata.sampleCount),
+         static_cast<long long>(mSampleCount));
+   mSampleBytes = mSampleCount * SAMPLE_SIZE(mSampleFormat);
    mValid = true;
 }
 
 void SqliteSampleBlock::Commit(Sizes sizes)
 {
-   const auto mSummary256Bytes = sizes.first;
-   const auto mSummary64kBytes = sizes.second;
-
+   AUDACITY_TRACE_SCOPE("SqliteSampleBlock::Commit");
    auto db = DB();
    int rc;
 
@@ -783,25 +1552,7 @@ void SqliteSampleBlock::Commit(Sizes sizes)
       "                          summary256, summary64k, samples)"
       "                         VALUES(?1,?2,?3,?4,?5,?6,?7);");
 
-   // Bind statement parameters
-   // Might return SQLITE_MISUSE which means it's our mistake that we violated
-   // preconditions; should return SQL_OK which is 0
-   if (sqlite3_bind_int(stmt, 1, static_cast<int>(mSampleFormat)) ||
-       sqlite3_bind_double(stmt, 2, mSumMin) ||
-       sqlite3_bind_double(stmt, 3, mSumMax) ||
-       sqlite3_bind_double(stmt, 4, mSumRms) ||
-       sqlite3_bind_blob(stmt, 5, mSummary256.get(), mSummary256Bytes, SQLITE_STATIC) ||
-       sqlite3_bind_blob(stmt, 6, mSummary64k.get(), mSummary64kBytes, SQLITE_STATIC) ||
-       sqlite3_bind_blob(stmt, 7, mSamples.get(), mSampleBytes, SQLITE_STATIC))
-   {
-
-      ADD_EXCEPTION_CONTEXT(
-         "sqlite3.rc", std::to_string(sqlite3_errcode(Conn()->DB())));
-      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Commit::bind");
-
-
-      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
-   }
+   Bind(stmt, 1, sizes);
 
    // Execute the statement
    rc = sqlite3_step(stmt);
@@ -822,21 +1573,71 @@ void SqliteSampleBlock::Commit(Sizes sizes)
    }
 
    // Retrieve returned data
-   mBlockID = sqlite3_last_insert_rowid(db);
+   Committed(sqlite3_last_insert_rowid(db));
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+
+   mpFactory->OnInserted(1);
+}
+
+void SqliteSampleBlock::Bind(sqlite3_stmt *stmt, int first, Sizes sizes)
+{
+   const auto mSummary256Bytes = sizes.first;
+   const auto mSummary64kBytes = sizes.second;
+   const bool compressed = !mCompressed.empty();
+   const bool packed = !mPacked.empty();
+   const auto format = static_cast<int>(mSampleFormat) |
+      (compressed ? CompressedFormatFlag : 0) |
+      (packed ? PackedFormatFlag : 0);
+   const void *const samples = compressed ? (const void*) mCompressed.data()
+      : packed ? (const void*) mPacked.data()
+      : mSamples.get();
+   const size_t sampleBytes = compressed ? mCompressed.size()
+      : packed ? mPacked.size()
+      : mSampleBytes;
+
+   // Bind statement parameters
+   // Might return SQLITE_MISUSE which means it's our mistake that we violated
+   // preconditions; should return SQL_OK which is 0
+   if (sqlite3_bind_int(stmt, first, format) ||
+       sqlite3_bind_double(stmt, first + 1, mSumMin) ||
+       sqlite3_bind_double(stmt, first + 2, mSumMax) ||
+       sqlite3_bind_double(stmt, first + 3, mSumRms) ||
+       sqlite3_bind_blob(stmt, first + 4, mSummary256.get(), mSummary256Bytes, SQLITE_STATIC) ||
+       sqlite3_bind_blob(stmt, first + 5, mSummary64k.get(), mSummary64kBytes, SQLITE_STATIC) ||
+       sqlite3_bind_blob(stmt, first + 6, samples, sampleBytes, SQLITE_STATIC))
+   {
+
+      ADD_EXCEPTION_CONTEXT(
+         "sqlite3.rc", std::to_string(sqlite3_errcode(Conn()->DB())));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Commit::bind");
+
+
+      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+   }
+}
+
+void SqliteSampleBlock::Committed(SampleBlockID id)
+{
+   mBlockID = id;
+   mRowEncoding = !mCompressed.empty() ? Encoding::Compressed
+      : !mPacked.empty() ? Encoding::Packed
+      : Encoding::Plain;
 
    // Reset local arrays
    mSamples.reset();
+   mCompressed = {};
+   mPacked = {};
    mSummary256.reset();
    mSummary64k.reset();
+   mPendingCharge.Release();
    {
       std::lock_guard<std::mutex> lock(mCacheMutex);
       mCache.reset();
    }
 
-   // Clear statement bindings and rewind statement
-   sqlite3_clear_bindings(stmt);
-   sqlite3_reset(stmt);
-
    mValid = true;
 }
 
@@ -906,7 +1707,7 @@ auto SqliteSampleBlock::SetSizes(
 /// Calculates summary block data describing this sample data.
 ///
 /// This method also has the side effect of setting the mSumMin,
-/// mSumMax, and mSumRms members of this class.
+/// mSumMax, mSumRms, and mSum members of this class.
 ///
 void SqliteSampleBlock::CalcSummary(Sizes sizes)
 {
@@ -937,48 +1738,21 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
    float min;
    float max;
    float sumsq;
-   double totalSquares = 0.0;
    double fraction = 0.0;
 
    // Recalc 256 summaries
    int sumLen = (mSampleCount + 255) / 256;
    int summaries = 256;
 
-   for (int i = 0; i < sumLen; ++i)
-   {
-      min = samples[i * 256];
-      max = samples[i * 256];
-      sumsq = min * min;
-
-      int jcount = 256;
-      if (jcount > mSampleCount - i * 256)
-      {
-         jcount = mSampleCount - i * 256;
-         fraction = 1.0 - (jcount / 256.0);
-      }
-
-      for (int j = 1; j < jcount; ++j)
-      {
-         float f1 = samples[i * 256 + j];
-         sumsq += f1 * f1;
-
-         if (f1 < min)
-         {
-            min = f1;
-         }
-         else if (f1 > max)
-         {
-            max = f1;
-         }
-      }
-
-      totalSquares += sumsq;
-
-      summary256[i * fields] = min;
-      summary256[i * fields + 1] = max;
-      // The rms is correct, but this may be for less than 256 samples in last loop.
-      summary256[i * fields + 2] = (float) sqrt(sumsq / jcount);
-   }
+   // The rms is correct, but this may be for less than 256 samples in the
+   // last frame.
+   double sum;
+   const double totalSquares =
+      SummarizeSamples(samples, mSampleCount, 256, summary256, &sum);
+   mSum = sum;
+   mHasSum = true;
+   if (const auto remainder = mSampleCount % 256)
+      fraction = 1.0 - (remainder / 256.0);
 
    for (int i = sumLen, frames256 = mSummary256Bytes / bytesPerFrame;
         i < frames256; ++i)
@@ -1073,8 +1847,7 @@ static size_t EstimateRemovedBlocks(
    using namespace WaveTrackUtilities;
    SampleBlockIDSet wontDelete;
    auto f = [&](const UndoStackElem &elem) {
-      if (auto pTracks = UndoTracks::Find(elem))
-         InspectBlocks(*pTracks, {}, &wontDelete);
+      UndoTracksStorage::InspectBlocks(elem, {}, &wontDelete);
    };
    manager.VisitStates(f, 0, begin);
    manager.VisitStates(f, end, manager.GetNumStates());
@@ -1085,16 +1858,14 @@ static size_t EstimateRemovedBlocks(
    // Collect ids that won't survive (and are not negative pseudo ids)
    SampleBlockIDSet seen, mayDelete;
    manager.VisitStates([&](const UndoStackElem &elem) {
-      if (auto pTracks = UndoTracks::Find(elem)) {
-         InspectBlocks(*pTracks,
-            [&](SampleBlockConstPtr pBlock){
-               auto id = pBlock->GetBlockID();
-               if (id > 0 && !wontDelete.count(id))
-                  mayDelete.insert(id);
-            },
-            &seen
-         );
-      }
+      UndoTracksStorage::InspectBlocks(elem,
+         [&](SampleBlockConstPtr pBlock){
+            auto id = pBlock->GetBlockID();
+            if (id > 0 && !wontDelete.count(id))
+               mayDelete.insert(id);
+         },
+         &seen
+      );
    }, begin, end);
    return mayDelete.size();
 }
@@ -0,0 +1,143 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoTracksStorage.cpp
+
+**********************************************************************/
+#include "UndoTracksStorage.h"
+
+#include "AudacityException.h"
+#include "DBConnection.h"
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "ProjectSerializer.h"
+#include "SampleBlock.h"
+#include "Track.h"
+#include "UndoTracks.h"
+#include "XMLTagHandler.h"
+
+namespace {
+constexpr auto UndoTracksTag = "undotracks";
+
+//! Adds the tracks of the document to the project, as when opening it
+class UndoTracksReader final : public XMLTagHandler
+{
+public:
+   explicit UndoTracksReader(AudacityProject &project)
+      : mProject{ project }
+   {}
+
+   bool HandleXMLTag(
+      const std::string_view &tag, const AttributesList &) override
+   {
+      return tag == UndoTracksTag;
+   }
+
+   XMLTagHandler *HandleXMLChild(const std::string_view &tag) override
+   {
+      return ProjectFileIORegistry::Get().CallObjectAccessor(tag, mProject);
+   }
+
+private:
+   AudacityProject &mProject;
+};
+
+class SpilledTracks final : public UndoTracks::Storage
+{
+public:
+   SpilledTracks(ProjectFileIO &projectFileIO, int64_t id,
+      std::vector<SampleBlockConstPtr> blocks
+   )  : mwProjectFileIO{ projectFileIO.weak_from_this() }
+      , mID{ id }
+      , mBlocks{ move(blocks) }
+   {}
+
+   ~SpilledTracks() override
+   {
+      // Don't bother when the file is about to be deleted anyway
+      auto pProjectFileIO = mwProjectFileIO.lock();
+      try {
+         if (pProjectFileIO && pProjectFileIO->HasConnection() &&
+             !pProjectFileIO->GetConnection().ShouldBypass())
+            pProjectFileIO->DeleteUndoTracks(mID);
+      }
+      catch (...) {
+         // A leftover row is deleted when the project is next opened
+      }
+   }
+
+   void Restore(AudacityProject &project) const override
+   {
+      UndoTracksReader reader{ project };
+      if (!ProjectFileIO::Get(project).ReadUndoTracks(mID, reader))
+         throw SimpleMessageBoxException{
+            ExceptionType::Internal,
+            XO("Failed to read undo history from the project file."),
+            XO("Warning"),
+            "Error:_Disk_full_or_not_writable"
+         };
+   }
+
+   const std::vector<SampleBlockConstPtr> &GetBlocks() const
+   {
+      return mBlocks;
+   }
+
+private:
+   const std::weak_ptr<ProjectFileIO> mwProjectFileIO;
+   const int64_t mID;
+   //! Keep the rows of the blocks that the document names
+   const std::vector<SampleBlockConstPtr> mBlocks;
+};
+
+static UndoTracks::Spill::Scope scope {
+[](AudacityProject &project, const TrackList &tracks)
+   -> std::unique_ptr<UndoTracks::Storage>
+{
+   auto &projectFileIO = ProjectFileIO::Get(project);
+   if (!projectFileIO.HasConnection())
+      return nullptr;
+
+   try {
+      ProjectSerializer doc;
+      doc.StartTag(UndoTracksTag);
+      for (auto pTrack : tracks)
+         pTrack->WriteXML(doc);
+      doc.EndTag(UndoTracksTag);
+
+      const auto id = projectFileIO.WriteUndoTracks(doc);
+      if (!id)
+         return nullptr;
+
+      std::vector<SampleBlockConstPtr> blocks;
+      WaveTrackUtilities::SampleBlockIDSet seen;
+      WaveTrackUtilities::InspectBlocks(tracks,
+         [&](SampleBlockConstPtr pBlock){ blocks.push_back(move(pBlock)); },
+         &seen);
+
+      return std::make_unique<SpilledTracks>(projectFileIO, *id, move(blocks));
+   }
+   catch (...) {
+      // Keep the tracks in memory
+      return nullptr;
+   }
+} };
+}
+
+void UndoTracksStorage::InspectBlocks(const UndoStackElem &state,
+   WaveTrackUtilities::BlockInspector inspector,
+   WaveTrackUtilities::SampleBlockIDSet *pIDs)
+{
+   if (auto pTracks = UndoTracks::Find(state))
+      WaveTrackUtilities::InspectBlocks(*pTracks, move(inspector), pIDs);
+   else if (auto pStorage = dynamic_cast<const SpilledTracks *>(
+         UndoTracks::FindStorage(state)))
+      for (auto &pBlock : pStorage->GetBlocks()) {
+         if (pIDs && !pIDs->insert(pBlock->GetBlockID()).second)
+            continue;
+         if (inspector)
+            inspector(pBlock);
+      }
+}
@@ -0,0 +1,28 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoTracksStorage.h
+
+**********************************************************************/
+#pragma once
+
+#include "WaveTrackUtilities.h"
+
+struct UndoStackElem;
+
+//! Spills the tracks of states of undo history into the project file
+/*!
+ States beyond the budget of UndoHistoryMegabytes are written as documents,
+ like the project document, and read back when undone or redone to.  They keep
+ their sample blocks, so that the rows of the blocks remain.
+ */
+namespace UndoTracksStorage {
+//! Visit the sample blocks of the tracks of a state, as
+//! WaveTrackUtilities::InspectBlocks() does, whether they are in memory or
+//! spilled
+PROJECT_FILE_IO_API void InspectBlocks(const UndoStackElem &state,
+   WaveTrackUtilities::BlockInspector inspector,
+   WaveTrackUtilities::SampleBlockIDSet *pIDs = nullptr);
+}
@@ -72,7 +72,14 @@ void ProjectHistory::PushState(const TranslatableString &desc,
                                 UndoPush flags )
 {
    auto &project = mProject;
-   if((flags & UndoPush::NOAUTOSAVE) == UndoPush::NONE)
+   if (mBatchDepth > 0 && mBatchPushed) {
+      // Coalesce into the state pushed first in the batch
+      ModifyState(false);
+      mDirty = true;
+      return;
+   }
+
+   if (mBatchDepth == 0 && (flags & UndoPush::NOAUTOSAVE) == UndoPush::NONE)
       AutoSave::Call(project);
 
    // remaining no-fail operations "commit" the changes of undo manager state
@@ -80,6 +87,8 @@ void ProjectHistory::PushState(const TranslatableString &desc,
    undoManager.PushState(desc, shortDesc, flags);
 
    mDirty = true;
+   if (mBatchDepth > 0)
+      mBatchPushed = true;
 }
 
 void ProjectHistory::RollbackState()
@@ -92,7 +101,7 @@ void ProjectHistory::RollbackState()
 void ProjectHistory::ModifyState(bool bWantsAutoSave)
 {
    auto &project = mProject;
-   if (bWantsAutoSave)
+   if (bWantsAutoSave && mBatchDepth == 0)
       AutoSave::Call(project);
 
    // remaining no-fail operations "commit" the changes of undo manager state
@@ -126,3 +135,15 @@ void ProjectHistory::SetStateTo(unsigned int n, bool doAutosave)
       [this, doAutosave]( const UndoStackElem &elem ){
          PopState(elem.state, doAutosave); } );
 }
+
+ProjectHistory::BatchScope::BatchScope(AudacityProject &project)
+   : mHistory{ ProjectHistory::Get(project) }
+{
+   if (mHistory.mBatchDepth++ == 0)
+      mHistory.mBatchPushed = false;
+}
+
+ProjectHistory::BatchScope::~BatchScope()
+{
+   --mHistory.mBatchDepth;
+}
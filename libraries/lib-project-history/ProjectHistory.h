@@ -62,10 +62,33 @@ public:
    bool GetDirty() const { return mDirty; }
    void SetDirty( bool value ) { mDirty = value; }
 
+   //! Coalesces the states pushed during its lifetime into one, for batches
+   //! of many edits
+   /*!
+    While any scope is alive, the first PushState() adds a state and later
+    ones only modify it, and neither pushes nor modifications autosave.
+    Ending the scope does not autosave; follow it with ModifyState(true).
+    Scopes may nest.
+    */
+   class PROJECT_HISTORY_API BatchScope {
+   public:
+      explicit BatchScope(AudacityProject &project);
+      BatchScope(const BatchScope&) = delete;
+      BatchScope &operator=(const BatchScope&) = delete;
+      ~BatchScope();
+   private:
+      ProjectHistory &mHistory;
+   };
+
 private:
    AudacityProject &mProject;
 
    bool mDirty{ false };
+
+   //! Nesting depth of BatchScope
+   size_t mBatchDepth{ 0 };
+   //! Whether a state was pushed since the outermost BatchScope began
+   bool mBatchPushed{ false };
 };
 
 #endif
@@ -23,6 +23,7 @@ UndoManager
 
 #include "UndoManager.h"
 
+#include <algorithm>
 #include <wx/hashset.h>
 
 #include "BasicUI.h"
@@ -38,6 +39,18 @@ bool UndoStateExtension::CanUndoOrRedo(const AudacityProject &)
    return true;
 }
 
+size_t UndoStateExtension::GetMemoryUsage() const
+{
+   return 0;
+}
+
+bool UndoStateExtension::Spill(AudacityProject &)
+{
+   return false;
+}
+
+IntSetting UndoHistoryMegabytes{ L"/History/UndoHistoryMegabytes", 0 };
+
 namespace {
    using Savers = std::vector<UndoRedoExtensionRegistry::Saver>;
    static Savers &GetSavers()
@@ -121,6 +134,8 @@ void UndoManager::RemoveStateAt(int n)
 
 void UndoManager::EnqueueMessage(UndoRedoMessage message)
 {
+   // Every change of the stack is announced here
+   UpdateCharge();
    BasicUI::CallAfter([wThis = weak_from_this(), message]{
       if (auto pThis = wThis.lock())
          pThis->Publish(message);
@@ -249,9 +264,48 @@ void UndoManager::PushState(const TranslatableString &longDescription,
 
    lastAction = longDescription;
 
+   LimitMemoryUsage();
+
    EnqueueMessage({ UndoRedoMessage::Pushed });
 }
 
+void UndoManager::LimitMemoryUsage()
+{
+   const auto budget =
+      std::max(0, UndoHistoryMegabytes.Read()) * size_t{ 1024 * 1024 };
+   if (budget == 0)
+      return;
+
+   // Newer states are likelier to be undone to, so they stay in memory
+   size_t total = 0;
+   for (auto ii = static_cast<int>(stack.size()); ii-- > 0;)
+      for (auto &pExtension : stack[ii]->state.extensions) {
+         if (!pExtension)
+            continue;
+         const auto usage = pExtension->GetMemoryUsage();
+         if (total + usage > budget && ii != current && ii != saved &&
+             pExtension->Spill(mProject))
+            continue;
+         total += usage;
+      }
+}
+
+void UndoManager::UpdateCharge()
+{
+   // The first estimate of a state's usage visits its tracks; don't pay that
+   // unless asked to
+   if (!MemoryAccounting::IsEnabled()) {
+      mCharge.Release();
+      return;
+   }
+   size_t total = 0;
+   for (auto &pElem : stack)
+      for (auto &pExtension : pElem->state.extensions)
+         if (pExtension)
+            total += pExtension->GetMemoryUsage();
+   mCharge.Set(total);
+}
+
 void UndoManager::AbandonRedo()
 {
    if (saved > current) {
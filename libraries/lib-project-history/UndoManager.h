@@ -48,7 +48,9 @@
 #include <memory>
 #include <vector>
 #include "ClientData.h"
+#include "MemoryAccounting.h"
 #include "Observer.h"
+#include "Prefs.h"
 
 //! Type of message published by UndoManager
 /*! all are published only during idle time, except BeginPurge and EndPurge */
@@ -89,6 +91,15 @@ public:
 
    //! Whether undo or redo is now permitted; default returns true
    virtual bool CanUndoOrRedo(const AudacityProject &project);
+
+   //! Estimate of the bytes of memory that Spill() could release; default
+   //! returns 0
+   virtual size_t GetMemoryUsage() const;
+
+   //! Move the contents out of memory, until RestoreUndoRedoState() needs
+   //! them again; default does nothing and returns false
+   /*! Does not throw; returns false on failure */
+   virtual bool Spill(AudacityProject &project);
 };
 
 class PROJECT_HISTORY_API UndoRedoExtensionRegistry {
@@ -215,6 +226,10 @@ class PROJECT_HISTORY_API UndoManager final
 
    void EnqueueMessage(UndoRedoMessage message);
    void RemoveStateAt(int n);
+   //! Spill the oldest states that don't fit in UndoHistoryMegabytes
+   void LimitMemoryUsage();
+   //! Charge the memory of the states that are not spilled, if accounting
+   void UpdateCharge();
 
    AudacityProject &mProject;
  
@@ -225,6 +240,16 @@ class PROJECT_HISTORY_API UndoManager final
 
    TranslatableString lastAction;
    bool mayConsolidate { false };
+
+   MemoryAccounting::Charge mCharge{ MemoryAccounting::Tag::UndoStates };
 };
 
+//! Memory budget of the states of undo history of each project, in megabytes,
+//! or 0 for no limit
+/*!
+ Older states beyond the budget are written into the project file, except for
+ the current and the saved states, and read back when undone or redone to
+ */
+extern PROJECT_HISTORY_API IntSetting UndoHistoryMegabytes;
+
 #endif
@@ -0,0 +1,52 @@
+/**********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file CompensatingDelay.cpp
+
+ *********************************************************************/
+
+#include "CompensatingDelay.h"
+
+#include <algorithm>
+#include <cstring>
+
+CompensatingDelay::CompensatingDelay(unsigned nChannels, size_t capacity)
+   : mBuffers(nChannels, std::vector<float>(capacity, 0.0f))
+   , mCapacity{ capacity }
+{
+}
+
+void CompensatingDelay::Process(const float *const *input,
+   float *const *output, unsigned nChannels, size_t len, size_t delay)
+{
+   const auto nDelayed = std::min<size_t>(nChannels, mBuffers.size());
+   if (output)
+      for (auto iChannel = nDelayed; iChannel < nChannels; ++iChannel)
+         memcpy(output[iChannel], input[iChannel], len * sizeof(float));
+   if (mCapacity == 0) {
+      if (output)
+         for (size_t iChannel = 0; iChannel < nDelayed; ++iChannel)
+            memcpy(output[iChannel], input[iChannel], len * sizeof(float));
+      return;
+   }
+
+   delay = std::min(delay, MaxDelay());
+   for (size_t iChannel = 0; iChannel < nDelayed; ++iChannel) {
+      const auto buffer = mBuffers[iChannel].data();
+      const auto in = input[iChannel];
+      const auto out = output ? output[iChannel] : nullptr;
+      auto write = mWritePosition;
+      auto read = (write + mCapacity - delay) % mCapacity;
+      for (size_t ii = 0; ii < len; ++ii) {
+         buffer[write] = in[ii];
+         if (out)
+            out[ii] = buffer[read];
+         if (++write == mCapacity)
+            write = 0;
+         if (++read == mCapacity)
+            read = 0;
+      }
+   }
+   mWritePosition = (mWritePosition + len) % mCapacity;
+}
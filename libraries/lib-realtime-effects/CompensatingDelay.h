@@ -0,0 +1,58 @@
+/**********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file CompensatingDelay.h
+ @brief Delay line that keeps a bypassed effect's latency in the chain
+
+ *********************************************************************/
+
+#ifndef __AUDACITY_COMPENSATING_DELAY__
+#define __AUDACITY_COMPENSATING_DELAY__
+
+#include <cstddef>
+#include <vector>
+
+//! Multichannel delay line, by variable amounts up to a fixed capacity
+/*!
+ Realtime effect latency is compensated by discarding the leading samples
+ of the output of the effect.  When the effect is later bypassed, the dry
+ signal must be delayed as much, so that the track stays aligned with the
+ others.  The line records the input even while the effect is not bypassed,
+ so that switching is seamless.
+
+ Storage is allocated only by the constructor, so that the worker thread
+ does not allocate
+ */
+class REALTIME_EFFECTS_API CompensatingDelay final
+{
+public:
+   CompensatingDelay() = default;
+   //! @param capacity greatest delay plus one
+   CompensatingDelay(unsigned nChannels, size_t capacity);
+
+   //! Greatest delay that Process can apply
+   size_t MaxDelay() const
+   { return mCapacity > 0 ? mCapacity - 1 : 0; }
+
+   //! Bytes of the delay lines
+   size_t GetMemoryUsage() const
+   { return mBuffers.size() * mCapacity * sizeof(float); }
+
+   //! Record the input; if output is not null, also write the input delayed
+   /*!
+    @param nChannels at most the number given to the constructor; more are
+    passed through undelayed, or ignored if output is null
+    @param delay is limited to MaxDelay()
+    @pre `output` buffers do not overlap `input` buffers
+    */
+   void Process(const float *const *input, float *const *output,
+      unsigned nChannels, size_t len, size_t delay);
+
+private:
+   std::vector<std::vector<float>> mBuffers;
+   size_t mCapacity{ 0 };
+   size_t mWritePosition{ 0 };
+};
+
+#endif
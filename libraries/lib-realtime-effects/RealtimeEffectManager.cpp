@@ -13,6 +13,7 @@
 
 #include <memory>
 #include "Project.h"
+#include "Tracing.h"
 
 #include <atomic>
 #include <wx/time.h>
@@ -119,11 +120,22 @@ void RealtimeEffectManager::ProcessStart(bool suspended)
 
 // This will be called in a thread other than the main GUI thread.
 //
+EffectInstance::SampleCount
+RealtimeEffectManager::GetCompensatedLatency(const ChannelGroup *group)
+{
+   EffectInstance::SampleCount result = 0;
+   VisitGroup(group, [&](RealtimeEffectState &state, bool) {
+      result += state.GetCompensatedLatency();
+   });
+   return result;
+}
+
 size_t RealtimeEffectManager::Process(bool suspended,
    const ChannelGroup *group,
    float *const *buffers, float *const *scratch, float *const dummy,
    unsigned nBuffers, size_t numSamples)
 {
+   AUDACITY_TRACE_SCOPE("RealtimeEffectManager::Process");
    // Can be suspended because of the audio stream being paused or because
    // effects have been suspended, so allow the samples to pass as-is.
    if (suspended)
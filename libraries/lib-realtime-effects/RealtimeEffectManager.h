@@ -68,6 +68,15 @@ public:
    bool IsActive() const noexcept;
 //   Latency GetLatency() const;
 
+   //! Total latency of the effects of the group (or the master when null)
+   //! that playback has compensated so far
+   /*!
+    Each group is aligned by discarding the leading samples that its own
+    chain delays; bypassed effects then delay the dry signal as much
+    */
+   EffectInstance::SampleCount GetCompensatedLatency(
+      const ChannelGroup *group);
+
    //! Main thread appends a global or per-group effect
    /*!
     @param pScope if realtime is active but scope is absent, there is no effect
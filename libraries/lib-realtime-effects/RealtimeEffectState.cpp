@@ -16,6 +16,7 @@
 #include "PluginManager.h"
 #include "SampleCount.h"
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <condition_variable>
@@ -317,6 +318,7 @@ RealtimeEffectState::RealtimeEffectState(const PluginID& id)
 {
    SetID(id);
    BuildAll();
+   UpdateCharge();
 }
 
 RealtimeEffectState::~RealtimeEffectState()
@@ -422,11 +424,31 @@ RealtimeEffectState::Initialize(double sampleRate)
 
    mCurrentProcessor = 0;
    mGroups.clear();
+   mDelays.clear();
+   mpProfile = EffectProfiler::Get().Register(
+      mPlugin->GetName().Translation(), true);
    mLatency = {};
+   mCompensatedLatency.store(0, std::memory_order_relaxed);
+   UpdateCharge();
    return EnsureInstance(sampleRate);
 }
 
+void RealtimeEffectState::UpdateCharge()
+{
+   auto bytes = sizeof(*this);
+   for (auto &[_, delay] : mDelays)
+      bytes += delay.GetMemoryUsage();
+   mCharge.Set(bytes);
+}
+
 namespace {
+//! Least capacity of the delay lines of bypassed effects, for effects that
+//! report their latency only after processing
+constexpr size_t MinCompensatingDelay = 8192;
+//! Bound on the memory for the delay lines, for effects that report
+//! outlandish latencies
+constexpr size_t MaxCompensatingDelay = 1 << 20;
+
 // The caller passes the number of channels to process and specifies
 // the number of input and output buffers.  There will always be the
 // same number of output buffers as there are input buffers.
@@ -482,6 +504,14 @@ RealtimeEffectState::AddGroup(
       // Remember the sampleRate of the group, so latency can be computed
       // later
       mGroups[group] = { first, sampleRate };
+      // Allocate here, not in the worker thread, with room for the latency
+      // that the instance reports so far
+      const auto latency = pInstance->GetLatency(
+         mWorkerSettings.settings, sampleRate);
+      mDelays[group] = CompensatingDelay{ chans, 1 + std::max(
+         MinCompensatingDelay,
+         limitSampleBufferSize(MaxCompensatingDelay, latency)) };
+      UpdateCharge();
       return pInstance;
    }
    return {};
@@ -559,11 +589,21 @@ size_t RealtimeEffectState::Process(
          }
       };
 
+   const auto pDelay = [&]() -> CompensatingDelay * {
+      const auto iter = mDelays.find(group);
+      return iter == mDelays.end() ? nullptr : &iter->second;
+   }();
+
    if (!mPlugin || !pInstance || !mLastActive)
    {
-      // Process trivially
-      for (size_t ii = 0; ii < chans; ++ii)
-         memcpy(outbuf[ii], inbuf[ii], numSamples * sizeof(float));
+      // Process trivially, but keep any latency that was compensated, so
+      // that the group stays aligned with the others
+      if (pDelay)
+         pDelay->Process(inbuf, outbuf, chans, numSamples,
+            limitSampleBufferSize(pDelay->MaxDelay(), GetCompensatedLatency()));
+      else
+         for (size_t ii = 0; ii < chans; ++ii)
+            memcpy(outbuf[ii], inbuf[ii], numSamples * sizeof(float));
       if (pInstance)
       {
          auto processor = pair.first;
@@ -591,6 +631,13 @@ size_t RealtimeEffectState::Process(
       }
       return 0;
    }
+   // Record the dry signal, in case of bypass later
+   if (pDelay)
+      pDelay->Process(inbuf, nullptr, chans, numSamples, 0);
+
+   // A block that takes longer than it plays misses the deadline
+   EffectProfiler::Scope profileScope{ mpProfile.get(), numSamples, pair.second };
+
    const auto numAudioIn = pInstance->GetAudioInCount();
    const auto numAudioOut = pInstance->GetAudioOutCount();
    const auto clientOut = stackAllocate(float *, numAudioOut);
@@ -635,6 +682,8 @@ size_t RealtimeEffectState::Process(
                auto discard = limitSampleBufferSize(len, *mLatency);
                len -= discard;
                *mLatency -= discard;
+               mCompensatedLatency.fetch_add(
+                  discard, std::memory_order_relaxed);
             }
          }
          ++processor;
@@ -692,6 +741,9 @@ void RealtimeEffectState::SetActive(bool active)
 bool RealtimeEffectState::Finalize() noexcept
 {
    mGroups.clear();
+   mDelays.clear();
+   mpProfile.reset();
+   UpdateCharge();
    mCurrentProcessor = 0;
 
    auto pInstance = mwInstance.lock();
@@ -705,6 +757,7 @@ bool RealtimeEffectState::Finalize() noexcept
 
    auto result = pInstance->RealtimeFinalize(mMainSettings.settings);
    mLatency = {};
+   mCompensatedLatency.store(0, std::memory_order_relaxed);
    mInitialized = false;
    return result;
 }
@@ -17,8 +17,11 @@
 #include <unordered_map>
 #include <vector>
 #include "ClientData.h"
+#include "CompensatingDelay.h"
 #include "EffectInterface.h"
+#include "EffectProfiler.h"
 #include "GlobalVariable.h"
+#include "MemoryAccounting.h"
 #include "MemoryX.h"
 #include "Observer.h"
 #include "PluginProvider.h" // for PluginID
@@ -88,6 +91,12 @@ public:
    //! Worker thread finishes a batch of samples
    bool ProcessEnd();
 
+   //! How much latency of the effect was compensated so far, by discarding;
+   //! the dry signal is delayed as much while the effect is bypassed
+   /*! May be called in any thread */
+   EffectInstance::SampleCount GetCompensatedLatency() const noexcept
+   { return mCompensatedLatency.load(std::memory_order_relaxed); }
+
    const EffectSettings &GetSettings() const { return mMainSettings.settings; }
 
    //! Test only in the main thread
@@ -120,6 +129,7 @@ private:
 
    std::shared_ptr<EffectInstance> MakeInstance();
    std::shared_ptr<EffectInstance> EnsureInstance(double rate);
+   void UpdateCharge();
 
    struct Access;
    struct AccessState;
@@ -176,6 +186,8 @@ private:
 
    //! How many samples must be discarded
    std::optional<EffectInstance::SampleCount> mLatency;
+   //! How many samples were discarded, since initialization
+   std::atomic<EffectInstance::SampleCount> mCompensatedLatency{ 0 };
    //! Assigned in the worker thread at the start of each processing scope
    bool mLastActive{};
 
@@ -187,6 +199,12 @@ private:
     
    std::unordered_map<const ChannelGroup *, std::pair<size_t, double>>
       mGroups;
+   //! Delays the dry signal of each group while bypassed
+   std::unordered_map<const ChannelGroup *, CompensatingDelay> mDelays;
+   //! Times the processing, from initialization to finalization
+   std::shared_ptr<EffectProfiler::Entry> mpProfile;
+   //! The state and its delay lines; the instance is not seen
+   MemoryAccounting::Charge mCharge{ MemoryAccounting::Tag::RealtimeEffects };
 
    // This must not be reset to nullptr while a worker thread is running.
    // In fact it is never yet reset to nullptr, before destruction.
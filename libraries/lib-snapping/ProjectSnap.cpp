@@ -61,6 +61,7 @@ void ProjectSnap::SetSnapTo(Identifier snap)
    if (mSnapTo != snap)
    {
       mSnapTo = snap;
+      mSnapFunctionFound = false;
 
       SnapToSetting.Write(mSnapTo.GET());
       gPrefs->Flush();
@@ -74,12 +75,26 @@ Identifier ProjectSnap::GetSnapTo() const
    return mSnapTo;
 }
 
+const SnapRegistryItem* ProjectSnap::GetSnapFunction() const
+{
+   if (!mSnapFunctionFound)
+   {
+      mSnapFunction = SnapFunctionsRegistry::Find(mSnapTo);
+      mSnapFunctionFound = true;
+   }
+   return mSnapFunction;
+}
+
 SnapResult ProjectSnap::SnapTime(double time) const
 {
    if (mSnapMode == SnapMode::SNAP_OFF)
       return { time, false };
 
-   return SnapFunctionsRegistry::Snap(mSnapTo, mProject, time, mSnapMode == SnapMode::SNAP_NEAREST);
+   const auto function = GetSnapFunction();
+   if (function == nullptr)
+      return { time, false };
+
+   return function->Snap(mProject, time, mSnapMode == SnapMode::SNAP_NEAREST);
 }
 
 SnapResult ProjectSnap::SingleStep(double time, bool upwards) const
@@ -87,7 +102,11 @@ SnapResult ProjectSnap::SingleStep(double time, bool upwards) const
    if (mSnapMode == SnapMode::SNAP_OFF)
       return { time, false };
 
-   return SnapFunctionsRegistry::SingleStep(mSnapTo, mProject, time, upwards);
+   const auto function = GetSnapFunction();
+   if (function == nullptr)
+      return { time, false };
+
+   return function->SingleStep(mProject, time, upwards);
 }
 
 static ProjectFileIORegistry::AttributeWriterEntry entry {
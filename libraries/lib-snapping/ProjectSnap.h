@@ -45,8 +45,14 @@ public:
    SnapResult SingleStep(double time, bool upwards) const;
 
 private:
+   //! The function for mSnapTo, looked up once, not at each snap
+   const SnapRegistryItem* GetSnapFunction() const;
+
    const AudacityProject& mProject;
    
    SnapMode mSnapMode { ReadSnapMode() };
    Identifier mSnapTo { ReadSnapTo() };
+
+   mutable const SnapRegistryItem* mSnapFunction {};
+   mutable bool mSnapFunctionFound { false };
 };
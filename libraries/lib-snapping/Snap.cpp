@@ -18,6 +18,7 @@
 #include "ProjectNumericFormats.h"
 #include "ProjectRate.h"
 #include "ProjectSnap.h"
+#include "ProjectTimeSignature.h"
 #include "Track.h"
 #include "ZoomInfo.h"
 
@@ -84,16 +85,28 @@ void SnapManager::Reinit()
    auto rate = ProjectRate::Get(*mProject).GetRate();
    auto format = formats.GetSelectionFormat();
 
+   // Beat grids depend on these
+   const auto &timeSignature = ProjectTimeSignature::Get(*mProject);
+   const auto tempo = timeSignature.GetTempo();
+   const auto upper = timeSignature.GetUpperTimeSignature();
+   const auto lower = timeSignature.GetLowerTimeSignature();
+
    // No need to reinit if these are still the same
-   if (snapTo == mSnapTo && rate == mRate && format == mFormat)
+   if (snapTo == mSnapTo && snapMode == mSnapMode && rate == mRate &&
+       format == mFormat && tempo == mTempo &&
+       upper == mUpperTimeSignature && lower == mLowerTimeSignature)
    {
       return;
    }
 
    // Save NEW settings
    mSnapTo = snapTo;
+   mSnapMode = snapMode;
    mRate = rate;
    mFormat = format;
+   mTempo = tempo;
+   mUpperTimeSignature = upper;
+   mLowerTimeSignature = lower;
 
    mSnapPoints.clear();
 
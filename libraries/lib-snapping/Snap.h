@@ -18,6 +18,7 @@
 #include <vector>
 #include <wx/defs.h>
 #include "ComponentInterfaceSymbol.h"
+#include "SnapUtils.h"
 
 class AudacityProject;
 class Track;
@@ -106,9 +107,15 @@ private:
    // Info for snap-to-time
    bool mSnapToTime{ false };
 
+   //! What the snap points were filtered for; Reinit() does nothing while
+   //! these are unchanged
    Identifier mSnapTo {};
+   SnapMode mSnapMode { SnapMode::SNAP_OFF };
    double mRate{ 0.0 };
    NumericFormatID mFormat{};
+   double mTempo{ 0.0 };
+   int mUpperTimeSignature{ 0 };
+   int mLowerTimeSignature{ 0 };
 };
 
 #endif
@@ -1,3 +1,7 @@
 #include "AudioSegment.h"
 
 AudioSegment::~AudioSegment() = default;
+
+void AudioSegment::Prime()
+{
+}
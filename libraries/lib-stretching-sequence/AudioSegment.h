@@ -43,4 +43,10 @@ public:
     * @brief Whether the segment has no more samples to provide.
     */
    virtual bool Empty() const = 0;
+
+   /**
+    * @brief Do ahead the work that the first `GetFloats` would otherwise do
+    * before giving samples, such as priming a stretcher. Default does nothing.
+    */
+   virtual void Prime();
 };
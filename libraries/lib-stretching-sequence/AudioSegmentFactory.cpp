@@ -13,6 +13,7 @@
 #include "ClipInterface.h"
 #include "ClipSegment.h"
 #include "SilenceSegment.h"
+#include "StretchedClipCache.h"
 #include "TimeAndPitchInterface.h"
 
 #include <algorithm>
@@ -59,8 +60,10 @@ AudioSegmentFactory::CreateAudioSegmentSequenceForward(double t0)
       }
       else if (clip->GetPlayEndTime() <= t0)
          continue;
+      // Until the cache has the clip rendered, it is stretched as it plays
       segments.push_back(std::make_shared<ClipSegment>(
-         *clip, t0 - clip->GetPlayStartTime(), PlaybackDirection::forward));
+         *clip, t0 - clip->GetPlayStartTime(), PlaybackDirection::forward,
+         StretchedClipCache::Get().Find(clip)));
       t0 = clip->GetPlayEndTime();
    }
    return segments;
@@ -1,5 +1,18 @@
 #include "ClipInterface.h"
 
+bool ClipContentKey::Matches(const ClipContentKey& other) const
+{
+   if (ids.empty() || ids != other.ids || owner.expired())
+      return false;
+   // Compare the owners themselves, not addresses that may be reused
+   return !owner.owner_before(other.owner) && !other.owner.owner_before(owner);
+}
+
 ClipTimes::~ClipTimes() = default;
 
 ClipInterface::~ClipInterface() = default;
+
+ClipContentKey ClipInterface::GetContentKey() const
+{
+   return {};
+}
@@ -15,6 +15,9 @@
 #include "SampleCount.h"
 #include "SampleFormat.h"
 
+#include <memory>
+#include <vector>
+
 class STRETCHING_SEQUENCE_API ClipTimes
 {
 public:
@@ -42,6 +45,20 @@ enum class PitchAndSpeedPreset
    OptimizeForVoice,
 };
 
+//! Identifies the samples of a clip, so that what is computed from them can be
+//! reused while they are unchanged
+struct STRETCHING_SEQUENCE_API ClipContentKey
+{
+   //! The ids have meaning only while this lives, e.g., a project's storage
+   std::weak_ptr<const void> owner;
+   //! Empty when the samples cannot be identified
+   std::vector<long long> ids;
+
+   //! Whether both identify the same samples; false if either is empty or
+   //! its owner is gone
+   bool Matches(const ClipContentKey& other) const;
+};
+
 class STRETCHING_SEQUENCE_API ClipInterface : public ClipTimes
 {
 public:
@@ -63,6 +80,13 @@ public:
    [[nodiscard]] virtual Observer::Subscription
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const = 0;
+
+   //! Identifies what GetSampleView() gives for all channels and the visible
+   //! samples, not the rate or the stretching parameters
+   /*!
+    Default implementation gives an empty key, matching none
+    */
+   virtual ClipContentKey GetContentKey() const;
 };
 
 using ClipConstHolders = std::vector<std::shared_ptr<const ClipInterface>>;
@@ -12,6 +12,8 @@
 #include "ClipInterface.h"
 #include "SampleFormat.h"
 #include "StaffPadTimeAndPitch.h"
+#include "StretchedClipCache.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <functional>
@@ -40,16 +42,17 @@ GetTotalNumSamplesToProduce(const ClipInterface& clip, double durationToDiscard)
 
 ClipSegment::ClipSegment(
    const ClipInterface& clip, double durationToDiscard,
-   PlaybackDirection direction)
-    : mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
+   PlaybackDirection direction,
+   std::shared_ptr<const StretchedClipRender> pRender)
+    : mClip { clip }
+    , mDurationToDiscard { durationToDiscard }
+    , mDirection { direction }
+    , mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
          clip, durationToDiscard) }
-    , mSource { clip, durationToDiscard, direction }
+    , mpRender { std::move(pRender) }
     , mPreserveFormants { clip.GetPitchAndSpeedPreset() ==
                           PitchAndSpeedPreset::OptimizeForVoice }
     , mCentShift { clip.GetCentShift() }
-    , mStretcher { std::make_unique<StaffPadTimeAndPitch>(
-         clip.GetRate(), clip.NChannels(), mSource,
-         GetStretchingParameters(clip)) }
     , mOnSemitoneShiftChangeSubscription { clip.SubscribeToCentShiftChange(
          [this](int cents) {
             mCentShift = cents;
@@ -64,6 +67,23 @@ ClipSegment::ClipSegment(
           })
     }
 {
+   if (mpRender)
+      // The render starts where the clip does
+      mRenderOffset = std::max<long long>(
+         0, (GetTotalNumSamplesToProduce(clip, 0.) - mTotalNumSamplesToProduce)
+               .as_long_long());
+   // Else the stretcher is primed only when needed, not for every clip after
+   // the play head each time the cursor is reset
+}
+
+void ClipSegment::StartStretching(double durationToDiscard)
+{
+   mStretcher.reset();
+   mSource = std::make_unique<ClipTimeAndPitchSource>(
+      mClip, durationToDiscard, mDirection);
+   mStretcher = std::make_unique<StaffPadTimeAndPitch>(
+      mClip.GetRate(), mClip.NChannels(), *mSource,
+      GetStretchingParameters(mClip));
 }
 
 ClipSegment::~ClipSegment()
@@ -81,13 +101,50 @@ size_t ClipSegment::GetFloats(float* const* buffers, size_t numSamples)
    // cannot trust that the observer subscriptions do not get called after
    // destruction of this object, so better not do anything too sophisticated
    // there.
-   if (mUpdateFormantPreservation.exchange(false))
-      mStretcher->OnFormantPreservationChange(mPreserveFormants);
-   if (mUpdateCentShift.exchange(false))
-      mStretcher->OnCentShiftChange(mCentShift);
+   const auto updateFormantPreservation =
+      mUpdateFormantPreservation.exchange(false);
+   const auto updateCentShift = mUpdateCentShift.exchange(false);
+   if (mpRender && (updateFormantPreservation || updateCentShift))
+   {
+      // The render is of the former parameters: stretch the rest
+      mpRender.reset();
+      StartStretching(
+         mDurationToDiscard +
+         mTotalNumSamplesProduced.as_double() / mClip.GetRate());
+   }
+   else if (mStretcher)
+   {
+      if (updateFormantPreservation)
+         mStretcher->OnFormantPreservationChange(mPreserveFormants);
+      if (updateCentShift)
+         mStretcher->OnCentShiftChange(mCentShift);
+   }
+   else if (!mpRender)
+      // With the present parameters of the clip
+      StartStretching(mDurationToDiscard);
    const auto numSamplesToProduce = limitSampleBufferSize(
       numSamples, mTotalNumSamplesToProduce - mTotalNumSamplesProduced);
-   mStretcher->GetSamples(buffers, numSamplesToProduce);
+   if (mpRender)
+   {
+      const auto start =
+         mRenderOffset + mTotalNumSamplesProduced.as_size_t();
+      for (size_t iChannel = 0; iChannel < NChannels(); ++iChannel)
+      {
+         const auto& channel = mpRender->channels[iChannel];
+         const auto available = start < channel.size() ?
+                                   std::min(
+                                      numSamplesToProduce,
+                                      channel.size() - start) :
+                                   0;
+         if (available > 0)
+            std::copy_n(channel.data() + start, available, buffers[iChannel]);
+         std::fill(
+            buffers[iChannel] + available,
+            buffers[iChannel] + numSamplesToProduce, 0.f);
+      }
+   }
+   else
+      mStretcher->GetSamples(buffers, numSamplesToProduce);
    mTotalNumSamplesProduced += numSamplesToProduce;
    return numSamplesToProduce;
 }
@@ -99,5 +156,11 @@ bool ClipSegment::Empty() const
 
 size_t ClipSegment::NChannels() const
 {
-   return mSource.NChannels();
+   return mClip.NChannels();
+}
+
+void ClipSegment::Prime()
+{
+   if (!mpRender && !mStretcher)
+      StartStretching(mDurationToDiscard);
 }
@@ -19,6 +19,7 @@
 
 class ClipInterface;
 class TimeAndPitchInterface;
+struct StretchedClipRender;
 
 using PitchRatioChangeCbSubscriber =
    std::function<void(std::function<void(double)>)>;
@@ -30,26 +31,42 @@ using PitchRatioChangeCbSubscriber =
 class STRETCHING_SEQUENCE_API ClipSegment final : public AudioSegment
 {
 public:
+   /*!
+    * @param pRender if not null, the samples are copied from it rather than
+    * stretched, see StretchedClipCache; it must have been rendered with the
+    * present parameters of the clip
+    */
    ClipSegment(const ClipInterface&,
-      double durationToDiscard, PlaybackDirection);
+      double durationToDiscard, PlaybackDirection,
+      std::shared_ptr<const StretchedClipRender> pRender = nullptr);
    ~ClipSegment() override;
 
    // AudioSegment
    size_t GetFloats(float* const* buffers, size_t numSamples) override;
    bool Empty() const override;
    size_t NChannels() const override;
+   void Prime() override;
 
 private:
+   //! Stretch from `durationToDiscard` on, instead of copying the render
+   void StartStretching(double durationToDiscard);
+
+   const ClipInterface& mClip;
+   const double mDurationToDiscard;
+   const PlaybackDirection mDirection;
    const sampleCount mTotalNumSamplesToProduce;
    sampleCount mTotalNumSamplesProduced = 0;
-   ClipTimeAndPitchSource mSource;
+   std::shared_ptr<const StretchedClipRender> mpRender;
+   //! Where the samples of this segment start in `mpRender`
+   size_t mRenderOffset = 0;
    bool mPreserveFormants;
    int mCentShift;
    std::atomic<bool> mUpdateFormantPreservation = false;
    std::atomic<bool> mUpdateCentShift = false;
-   // Careful that this guy is constructed after `mSource`, which it refers to
-   // in its ctor.
-   // todo(mhodgkinson) make this safe.
+   //! Null while copying from the render, and until the first request for
+   //! samples or Prime()
+   std::unique_ptr<ClipTimeAndPitchSource> mSource;
+   //! Refers to `mSource`, so is destroyed before it
    std::unique_ptr<TimeAndPitchInterface> mStretcher;
    Observer::Subscription mOnSemitoneShiftChangeSubscription;
    Observer::Subscription mOnFormantPreservationChangeSubscription;
@@ -0,0 +1,208 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCache.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+#include "BasicUI.h"
+#include "ClipTimeAndPitchSource.h"
+#include "StaffPadTimeAndPitch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+//! Enough for a few dozen stereo loops of some seconds each
+constexpr size_t defaultMaxBytes = 256 * 1024 * 1024;
+
+//! Samples per channel computed at once
+constexpr size_t renderBufferSize = 4096;
+
+size_t GetRenderLength(const ClipInterface& clip, double stretchRatio)
+{
+   return sampleCount {
+      clip.GetVisibleSampleCount().as_double() * stretchRatio + .5
+   }.as_size_t();
+}
+} // namespace
+
+StretchedClipCache& StretchedClipCache::Get()
+{
+   static StretchedClipCache instance {
+      defaultMaxBytes, audacity::concurrency::TaskScheduler::Get()
+   };
+   return instance;
+}
+
+StretchedClipCache::StretchedClipCache(
+   size_t maxBytes, audacity::concurrency::TaskScheduler& scheduler)
+    : mMaxBytes { maxBytes }
+    , mRenders { scheduler }
+{
+}
+
+StretchedClipCache::~StretchedClipCache()
+{
+   mStopping = true;
+}
+
+bool StretchedClipCache::Key::Matches(const Key& other) const
+{
+   return rate == other.rate && stretchRatio == other.stretchRatio &&
+          centShift == other.centShift &&
+          preserveFormants == other.preserveFormants &&
+          content.Matches(other.content);
+}
+
+std::shared_ptr<const StretchedClipRender>
+StretchedClipCache::Find(const std::shared_ptr<const ClipInterface>& pClip)
+{
+   const auto stretchRatio = pClip->GetStretchRatio();
+   const auto centShift = pClip->GetCentShift();
+   if (
+      TimeAndPitchInterface::IsPassThroughMode(stretchRatio) && centShift == 0)
+      return nullptr;
+   // Long clips would push out all else
+   if (
+      GetRenderLength(*pClip, stretchRatio) * pClip->NChannels() *
+         sizeof(float) >
+      mMaxBytes / 4)
+      return nullptr;
+
+   Key key { pClip->GetContentKey(), pClip->GetRate(), stretchRatio,
+             centShift,
+             pClip->GetPitchAndSpeedPreset() ==
+                PitchAndSpeedPreset::OptimizeForVoice };
+   if (key.content.ids.empty())
+      return nullptr;
+
+   std::lock_guard<std::mutex> lock { mMutex };
+   const auto end = mEntries.end();
+   const auto it = std::find_if(mEntries.begin(), end, [&](const Entry& entry) {
+      return entry.key.Matches(key);
+   });
+   if (it != end)
+   {
+      it->lastUse = ++mUseCount;
+      return it->pRender;
+   }
+
+   mEntries.push_back({ key });
+   mRenders.Run([this, pClip, key = std::move(key)]() mutable {
+      std::shared_ptr<const StretchedClipRender> pRender;
+      // Whether to forget the key, so that it may be rendered again
+      auto forget = false;
+      try
+      {
+         pRender = Render(
+            *pClip, key.stretchRatio, key.centShift, key.preserveFormants,
+            mStopping);
+         // Keep the render only for the samples it was made of
+         if (!pRender || !pClip->GetContentKey().Matches(key.content))
+         {
+            pRender.reset();
+            forget = true;
+         }
+      }
+      catch (...)
+      {
+         // Segments of this clip go on stretching as they play
+      }
+      {
+         std::lock_guard<std::mutex> lock { mMutex };
+         const auto it = std::find_if(
+            mEntries.begin(), mEntries.end(),
+            [&](const Entry& entry) { return entry.key.Matches(key); });
+         if (it != mEntries.end() && forget)
+            mEntries.erase(it);
+         else if (it != mEntries.end())
+         {
+            it->pending = false;
+            it->pRender = pRender;
+            if (pRender)
+               for (const auto& channel : pRender->channels)
+                  it->bytes += channel.size() * sizeof(float);
+            mBytes += it->bytes;
+            Evict();
+         }
+      }
+      // Release the clip, and maybe its blocks, in the main thread
+      BasicUI::CallAfter([pClip = std::move(pClip)] {});
+   });
+   return nullptr;
+}
+
+void StretchedClipCache::Clear()
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   mEntries.erase(
+      std::remove_if(
+         mEntries.begin(), mEntries.end(),
+         [](const Entry& entry) { return !entry.pending; }),
+      mEntries.end());
+   mBytes = 0;
+}
+
+void StretchedClipCache::Evict()
+{
+   // Renders of closed projects can never be found again
+   mEntries.erase(
+      std::remove_if(
+         mEntries.begin(), mEntries.end(),
+         [this](const Entry& entry) {
+            if (entry.pending || !entry.key.content.owner.expired())
+               return false;
+            mBytes -= entry.bytes;
+            return true;
+         }),
+      mEntries.end());
+
+   while (mBytes > mMaxBytes)
+   {
+      const auto it = std::min_element(
+         mEntries.begin(), mEntries.end(),
+         [](const Entry& a, const Entry& b) {
+            // Pending entries last, as they hold nothing yet
+            return std::make_pair(a.pending, a.lastUse) <
+                   std::make_pair(b.pending, b.lastUse);
+         });
+      if (it == mEntries.end() || it->pending)
+         break;
+      mBytes -= it->bytes;
+      mEntries.erase(it);
+   }
+}
+
+std::shared_ptr<const StretchedClipRender> StretchedClipCache::Render(
+   const ClipInterface& clip, double stretchRatio, int centShift,
+   bool preserveFormants, const std::atomic<bool>& stop)
+{
+   TimeAndPitchInterface::Parameters params;
+   params.timeRatio = stretchRatio;
+   params.pitchRatio = std::pow(2., centShift / 1200.);
+   params.preserveFormants = preserveFormants;
+
+   const auto nChannels = clip.NChannels();
+   const auto length = GetRenderLength(clip, stretchRatio);
+   ClipTimeAndPitchSource source { clip, 0., PlaybackDirection::forward };
+   StaffPadTimeAndPitch stretcher { clip.GetRate(), nChannels, source,
+                                    params };
+
+   auto pRender = std::make_shared<StretchedClipRender>();
+   pRender->channels.assign(nChannels, std::vector<float>(length));
+   std::vector<float*> buffers(nChannels);
+   for (size_t start = 0; start < length; start += renderBufferSize)
+   {
+      if (stop)
+         return nullptr;
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+         buffers[iChannel] = pRender->channels[iChannel].data() + start;
+      stretcher.GetSamples(
+         buffers.data(), std::min(renderBufferSize, length - start));
+   }
+   return pRender;
+}
@@ -0,0 +1,111 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCache.h
+
+**********************************************************************/
+#pragma once
+
+#include "ClipInterface.h"
+#include "concurrency/TaskScheduler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//! The whole visible part of a clip, stretched and pitch-shifted from its
+//! start, one vector of samples for each channel
+struct StretchedClipRender
+{
+   std::vector<std::vector<float>> channels;
+};
+
+//! Renders of the clips that have pitch or speed changes, computed in the
+//! background, so that playing or exporting them again need not run the
+//! stretcher
+/*!
+ A render is found by the content of the clip, see ClipInterface::GetContentKey,
+ and by the rate and the stretching parameters. Renders are kept in memory up
+ to a total size, the least recently used being dropped first.
+
+ Methods may be called in any thread.
+ */
+class STRETCHING_SEQUENCE_API StretchedClipCache final
+{
+public:
+   static StretchedClipCache& Get();
+
+   //! @param maxBytes bounds the total size of the renders kept
+   StretchedClipCache(
+      size_t maxBytes, audacity::concurrency::TaskScheduler& scheduler);
+   //! Stops renders in progress and waits for them
+   ~StretchedClipCache();
+
+   StretchedClipCache(const StretchedClipCache&) = delete;
+   StretchedClipCache& operator=(const StretchedClipCache&) = delete;
+
+   //! The render of `pClip` with its present parameters, if it is complete
+   /*!
+    Else, queues the render (once for the same key) and gives null, as it
+    does for clips with no pitch or speed change, with an empty content key,
+    or too long to be kept.
+
+    @pre `pClip` is not null
+    */
+   std::shared_ptr<const StretchedClipRender>
+   Find(const std::shared_ptr<const ClipInterface>& pClip);
+
+   //! Drop all complete renders
+   void Clear();
+
+   //! Render all of `clip` with these parameters, as ClipSegment would
+   //! stretch it from its start
+   /*!
+    @param stop is polled between buffers, and if true, rendering stops
+    @return null if stopped
+    */
+   static std::shared_ptr<const StretchedClipRender> Render(
+      const ClipInterface& clip, double stretchRatio, int centShift,
+      bool preserveFormants, const std::atomic<bool>& stop);
+
+private:
+   struct Key
+   {
+      ClipContentKey content;
+      int rate;
+      double stretchRatio;
+      int centShift;
+      bool preserveFormants;
+
+      bool Matches(const Key& other) const;
+   };
+
+   struct Entry
+   {
+      Key key;
+      //! Null until rendered, or if rendering failed
+      std::shared_ptr<const StretchedClipRender> pRender;
+      bool pending { true };
+      size_t bytes { 0 };
+      uint64_t lastUse { 0 };
+   };
+
+   //! @pre mMutex is locked
+   void Evict();
+
+   const size_t mMaxBytes;
+
+   std::mutex mMutex;
+   std::vector<Entry> mEntries;
+   size_t mBytes { 0 };
+   uint64_t mUseCount { 0 };
+
+   std::atomic<bool> mStopping { false };
+   //! Declared last, so that it waits for the renders before the rest is
+   //! destroyed
+   audacity::concurrency::TaskGroup mRenders;
+};
@@ -13,10 +13,16 @@
 #include "AudioSegmentFactory.h"
 #include "StaffPadTimeAndPitch.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace
 {
+//! How many recent seek targets are remembered
+constexpr size_t maxSeekTargets = 4;
+//! How many spare segment sequences are kept, each with a primed stretcher
+constexpr size_t maxSpares = 2;
+
 void GetOffsetBuffer(
    float** offsetBuffer, float* const* buffer, size_t numChannels,
    size_t offset)
@@ -36,11 +42,50 @@ StretchingSequence::StretchingSequence(
 
 void StretchingSequence::ResetCursor(double t, PlaybackDirection direction)
 {
-   mAudioSegments =
-      mAudioSegmentFactory->CreateAudioSegmentSequence(t, direction);
+   const SeekTarget target { TimeToLongSamples(t), direction };
+   const auto spare = std::find_if(
+      mSpares.begin(), mSpares.end(),
+      [&](const Spare& spare) { return spare.target == target; });
+   if (spare != mSpares.end())
+   {
+      mAudioSegments = std::move(spare->segments);
+      mSpares.erase(spare);
+      // For the next time
+      mSpareTarget = target;
+   }
+   else
+   {
+      mAudioSegments =
+         mAudioSegmentFactory->CreateAudioSegmentSequence(t, direction);
+      const auto end = mSeekTargets.end();
+      if (std::find(mSeekTargets.begin(), end, target) != end)
+         mSpareTarget = target;
+      else
+      {
+         mSeekTargets.push_back(target);
+         if (mSeekTargets.size() > maxSeekTargets)
+            mSeekTargets.pop_front();
+      }
+   }
    mActiveAudioSegmentIt = mAudioSegments.begin();
    mPlaybackDirection = direction;
-   mExpectedStart = TimeToLongSamples(t);
+   mExpectedStart = target.first;
+}
+
+void StretchingSequence::PrepareSpare()
+{
+   if (!mSpareTarget.has_value())
+      return;
+   const auto [start, direction] = *mSpareTarget;
+   mSpareTarget.reset();
+   auto segments = mAudioSegmentFactory->CreateAudioSegmentSequence(
+      start.as_double() / mSequence.GetRate(), direction);
+   // What is read first after the seek: a clip, or the silence before one
+   for (size_t i = 0; i < std::min<size_t>(2, segments.size()); ++i)
+      segments[i]->Prime();
+   mSpares.push_back({ { start, direction }, std::move(segments) });
+   if (mSpares.size() > maxSpares)
+      mSpares.erase(mSpares.begin());
 }
 
 bool StretchingSequence::GetNext(
@@ -103,6 +148,13 @@ bool StretchingSequence::DoGet(
       iChannel, nBuffers, buffers, format, start, len, backwards);
 }
 
+void StretchingSequence::Prefetch(const void *client,
+   sampleCount start, size_t len, bool backward) const
+{
+   // Exact only without stretching, but good enough for a hint
+   mSequence.Prefetch(client, start, len, backward);
+}
+
 const ChannelGroup* StretchingSequence::FindChannelGroup() const
 {
    return mSequence.FindChannelGroup();
@@ -157,14 +209,12 @@ AudioGraph::ChannelType StretchingSequence::GetChannelType() const
 bool StretchingSequence::GetFloats(
    float* buffers[], sampleCount start, size_t len, bool backwards) const
 {
-   std::vector<samplePtr> charBuffers;
-   const auto nChannels = NChannels();
-   charBuffers.reserve(nChannels);
-   for (auto i = 0u; i < nChannels; ++i)
-      charBuffers.push_back(reinterpret_cast<samplePtr>(buffers[i]));
+   // Cast the pointers as WideSampleSequence::GetFloats() does, rather than
+   // copy them into a temporary vector
+   const auto charBuffers = reinterpret_cast<const samplePtr*>(buffers);
    constexpr auto iChannel = 0u;
    return DoGet(
-      iChannel, nChannels, charBuffers.data(), sampleFormat::floatSample, start,
+      iChannel, NChannels(), charBuffers, sampleFormat::floatSample, start,
       len, backwards);
 }
 
@@ -174,16 +224,22 @@ bool StretchingSequence::MutableGet(
 {
    // StretchingSequence is not expected to be used for any other case.
    assert(iChannel == 0u);
-   if (
+   const auto seek =
       !mExpectedStart.has_value() || *mExpectedStart != start ||
-      (mPlaybackDirection == PlaybackDirection::backward != backwards))
+      (mPlaybackDirection == PlaybackDirection::backward != backwards);
+   if (seek)
    {
       const auto t = start.as_double() / mSequence.GetRate();
       ResetCursor(
          t,
          backwards ? PlaybackDirection::backward : PlaybackDirection::forward);
    }
-   return GetNext(reinterpret_cast<float* const*>(buffers), nBuffers, len);
+   const auto result =
+      GetNext(reinterpret_cast<float* const*>(buffers), nBuffers, len);
+   // Spread the priming away from the seek, which already had its own
+   if (!seek)
+      PrepareSpare();
+   return result;
 }
 
 std::shared_ptr<StretchingSequence> StretchingSequence::Create(
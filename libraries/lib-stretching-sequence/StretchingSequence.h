@@ -13,8 +13,10 @@
 #include "AudioIOSequences.h"
 #include "PlaybackDirection.h"
 
+#include <deque>
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 class AudioSegment;
@@ -50,6 +52,8 @@ public:
       sampleFormat format, sampleCount start, size_t len, bool backwards,
       fillFormat fill = FillFormat::fillZero, bool mayThrow = true,
       sampleCount* pNumWithinClips = nullptr) const override;
+   void Prefetch(const void *client,
+      sampleCount start, size_t len, bool backward) const override;
 
    // PlayableSequence
    const ChannelGroup *FindChannelGroup() const override;
@@ -66,7 +70,18 @@ public:
 private:
    using AudioSegments = std::vector<std::shared_ptr<AudioSegment>>;
 
+   using SeekTarget = std::pair<sampleCount, PlaybackDirection>;
+
+   //! Segments made ahead for a seek target, their first ones primed
+   struct Spare
+   {
+      SeekTarget target;
+      AudioSegments segments;
+   };
+
    void ResetCursor(double t, PlaybackDirection);
+   //! Make the spare segments wanted for mSpareTarget, if any
+   void PrepareSpare();
    bool GetNext(float *const buffers[], size_t numChannels, size_t numSamples);
    bool MutableGet(
       size_t iChannel, size_t nBuffers, const samplePtr buffers[],
@@ -78,4 +93,12 @@ private:
    AudioSegments::const_iterator mActiveAudioSegmentIt = mAudioSegments.end();
    std::optional<sampleCount> mExpectedStart;
    PlaybackDirection mPlaybackDirection = PlaybackDirection::forward;
+
+   //! Where the cursor was last reset, most recent last
+   std::deque<SeekTarget> mSeekTargets;
+   //! Segments ready for seek targets that recur, as when a loop restarts
+   std::vector<Spare> mSpares;
+   //! A seek target to make spare segments for, after the next samples are
+   //! given, and not while the seek to it is served
+   std::optional<SeekTarget> mSpareTarget;
 };
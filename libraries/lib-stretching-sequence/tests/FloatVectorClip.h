@@ -71,9 +71,15 @@ public:
       return {};
    }
 
+   ClipContentKey GetContentKey() const override
+   {
+      return contentKey;
+   }
+
 public:
    double stretchRatio = 1.;
    double playStartTime = 0.;
+   ClipContentKey contentKey;
 
 private:
    double GetPlayDuration() const;
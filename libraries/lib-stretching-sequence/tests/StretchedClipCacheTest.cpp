@@ -0,0 +1,137 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCacheTest.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+#include "AudioContainer.h"
+#include "ClipSegment.h"
+#include "FloatVectorClip.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+constexpr auto sampleRate = 8000;
+constexpr auto numSamples = 4000;
+
+std::vector<float> MakeSine()
+{
+   std::vector<float> sine(numSamples);
+   for (auto i = 0u; i < sine.size(); ++i)
+      sine[i] = std::sin(2 * 3.14159265 * 440 * i / sampleRate);
+   return sine;
+}
+
+std::shared_ptr<const StretchedClipRender> WaitForRender(
+   StretchedClipCache& cache, const std::shared_ptr<const ClipInterface>& clip)
+{
+   for (auto i = 0; i < 1000; ++i)
+   {
+      if (auto pRender = cache.Find(clip))
+         return pRender;
+      std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+   }
+   return nullptr;
+}
+} // namespace
+
+TEST_CASE("ClipContentKey")
+{
+   const auto owner = std::make_shared<int>();
+   const ClipContentKey key { owner, { 1, 2, 3 } };
+
+   REQUIRE(key.Matches(ClipContentKey { owner, { 1, 2, 3 } }));
+   REQUIRE(!key.Matches(ClipContentKey { owner, { 1, 2 } }));
+   REQUIRE(
+      !key.Matches(ClipContentKey { std::make_shared<int>(), { 1, 2, 3 } }));
+   REQUIRE(!ClipContentKey { owner, {} }.Matches(ClipContentKey { owner, {} }));
+
+   ClipContentKey expired { std::make_shared<int>(), { 1 } };
+   REQUIRE(!expired.Matches(expired));
+}
+
+TEST_CASE("StretchedClipCache")
+{
+   audacity::concurrency::TaskScheduler scheduler { 1 };
+   StretchedClipCache cache { 1 << 20, scheduler };
+   const auto owner = std::make_shared<int>();
+   const auto clip =
+      std::make_shared<FloatVectorClip>(sampleRate, MakeSine(), 2u);
+   clip->contentKey = { owner, { 42 } };
+
+   SECTION("does not render clips with no speed or pitch change")
+   {
+      REQUIRE(cache.Find(clip) == nullptr);
+      std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+      REQUIRE(cache.Find(clip) == nullptr);
+   }
+
+   SECTION("does not render clips that cannot be identified")
+   {
+      clip->stretchRatio = 2.;
+      clip->contentKey = {};
+      REQUIRE(cache.Find(clip) == nullptr);
+      std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+      REQUIRE(cache.Find(clip) == nullptr);
+   }
+
+   SECTION("renders in the background what ClipSegment would stretch")
+   {
+      clip->stretchRatio = 2.;
+      REQUIRE(cache.Find(clip) == nullptr);
+      const auto pRender = WaitForRender(cache, clip);
+      REQUIRE(pRender != nullptr);
+      REQUIRE(pRender->channels.size() == 2u);
+      REQUIRE(pRender->channels[0].size() == 2u * numSamples);
+
+      SECTION("and segments copy it from where they start")
+      {
+         constexpr auto offset = 1000;
+         ClipSegment sut { *clip, static_cast<double>(offset) / sampleRate,
+                           PlaybackDirection::forward, pRender };
+         AudioContainer output(2u * numSamples, 2u);
+         REQUIRE(
+            sut.GetFloats(output.channelPointers.data(), 2u * numSamples) ==
+            2u * numSamples - offset);
+         REQUIRE(sut.Empty());
+         for (auto i = 0u; i < 2u; ++i)
+            REQUIRE(std::equal(
+               pRender->channels[i].begin() + offset,
+               pRender->channels[i].end(), output.channelVectors[i].begin()));
+      }
+   }
+
+   SECTION("finds no render once the samples change")
+   {
+      clip->stretchRatio = 2.;
+      REQUIRE(WaitForRender(cache, clip) != nullptr);
+      clip->contentKey = { owner, { 43 } };
+      REQUIRE(cache.Find(clip) == nullptr);
+   }
+
+   SECTION("keeps no more than its maximum size")
+   {
+      // Room for four stereo renders of 8000 samples
+      StretchedClipCache smallCache { 256000, scheduler };
+      clip->stretchRatio = 2.;
+      REQUIRE(WaitForRender(smallCache, clip) != nullptr);
+      for (auto id = 44; id < 48; ++id)
+      {
+         const auto other =
+            std::make_shared<FloatVectorClip>(sampleRate, MakeSine(), 2u);
+         other->stretchRatio = 2.;
+         other->contentKey = { owner, { id } };
+         REQUIRE(WaitForRender(smallCache, other) != nullptr);
+      }
+      // The least recently used was dropped
+      REQUIRE(smallCache.Find(clip) == nullptr);
+   }
+}
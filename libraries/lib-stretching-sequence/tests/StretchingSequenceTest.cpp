@@ -110,6 +110,39 @@ TEST_CASE("StretchingSequence unit tests")
             numSamples, backwards));
          REQUIRE(factory->callCount == refCount + 2);
       }
+
+      SECTION("keeps segments ready for seek targets that recur")
+      {
+         auto factory = new MockAudioSegmentFactory;
+         const auto mockSequence =
+            std::make_shared<MockPlayableSequence>(sampleRate, numChannels);
+         StretchingSequence sut(
+            *mockSequence, sampleRate, numChannels,
+            std::unique_ptr<AudioSegmentFactoryInterface> { factory });
+         constexpr auto numSamples = 3;
+         constexpr auto loopStart = 10;
+         AudioContainer buffer(numSamples, 1);
+         const auto get = [&](int start) {
+            REQUIRE(sut.GetFloats(
+               AudioContainerHelper::GetData(buffer).data(), start,
+               numSamples, !backwards));
+         };
+         get(loopStart);
+         get(loopStart + numSamples);
+         const auto refCount = factory->callCount;
+         // First restart of the loop: segments are made as for any seek ...
+         get(loopStart);
+         REQUIRE(factory->callCount == refCount + 1);
+         // ... and spare ones with the next samples, not with the seek.
+         get(loopStart + numSamples);
+         REQUIRE(factory->callCount == refCount + 2);
+         // Next restart: the spare segments are used.
+         get(loopStart);
+         REQUIRE(factory->callCount == refCount + 2);
+         // And replaced.
+         get(loopStart + numSamples);
+         REQUIRE(factory->callCount == refCount + 3);
+      }
    }
 }
 
@@ -221,6 +221,13 @@ void ThemeBase::SwitchTheme( teThemeType Theme )
    auto &resources = *mpSet;
    EnsureInitialised();
 
+   // Built-in themes don't change: reuse what was unpacked before, as when
+   // preferences are committed without a change of theme
+   if (!Theme.empty() && Theme != "custom" && resources.bLoadedFromBuiltin) {
+      mPreferredSystemAppearance = resources.preferredSystemAppearance;
+      return;
+   }
+
    const bool cbOkIfNotFound = true;
 
    if( !ReadImageCache( Theme, cbOkIfNotFound ) )
@@ -855,6 +862,7 @@ bool ThemeBase::ReadImageCache( teThemeType type, bool bOkIfNotFound)
 
    if( type.empty() || type == "custom" )
    {
+      resources.bLoadedFromBuiltin = false;
       mPreferredSystemAppearance = PreferredSystemAppearance::Light;
 
       // Take the image cache file for the theme chosen in preferences
@@ -899,6 +907,8 @@ bool ThemeBase::ReadImageCache( teThemeType type, bool bOkIfNotFound)
          return true;
 
       pImage = iter->second.data.data();
+      resources.bLoadedFromBuiltin = true;
+      resources.preferredSystemAppearance = mPreferredSystemAppearance;
       //wxLogDebug("Reading ImageCache %p size %i", pImage, ImageSize );
       wxMemoryInputStream InternalStream( pImage, ImageSize );
 
@@ -908,6 +918,7 @@ bool ThemeBase::ReadImageCache( teThemeType type, bool bOkIfNotFound)
          // was not a valid png image.
          // Most likely someone edited it by mistake,
          // Or some experiment is being tried with NEW formats for it.
+         resources.bLoadedFromBuiltin = false;
          ShowMessageBox(
             XO(
 "Audacity could not read its default theme.\nPlease report the problem."));
@@ -984,6 +995,8 @@ void ThemeBase::LoadOneThemeComponents( teThemeType id, bool bOkIfNotFound )
    const auto dir = ThemeComponentsDir(GetFilePath(), id);
    if( !wxDirExists( dir ))
       return;
+   // The components replace images of the built-in theme
+   resources.bLoadedFromBuiltin = false;
 
    using namespace BasicUI;
 
@@ -105,6 +105,12 @@ struct ThemeSet
    std::vector<wxColour> mColours;
 
    bool bInitialised = false;
+
+   //! Whether the images and colours are those of a built-in theme, unpacked
+   //! already, so that switching to it again need not unpack them
+   bool bLoadedFromBuiltin = false;
+   PreferredSystemAppearance preferredSystemAppearance {
+      PreferredSystemAppearance::Light };
 };
 
 struct ThemeChangeMessage {
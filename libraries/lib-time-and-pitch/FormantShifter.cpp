@@ -18,22 +18,45 @@
 
 namespace
 {
-// `x` has length `fftSize/2+1`.
+// How many more points than the liftered cepstrum has the low-resolution
+// envelope is computed at. Interpolating linearly between them then is
+// within a few hundredths of a dB of the full-resolution envelope.
+constexpr auto envelopeOversampling = 4;
+
+// Smallest size that pffft transforms
+constexpr auto minEnvelopeFftSize = 32;
+
+// Size of the FFT that computes the envelope at low resolution, and
+// `fftSize` if the envelope is better computed at full resolution.
+int GetEnvelopeFftSize(int binCutoff, int fftSize)
+{
+   if (binCutoff >= fftSize / 2)
+      return fftSize;
+   auto size = minEnvelopeFftSize;
+   while (size < envelopeOversampling * 2 * (binCutoff + 1))
+      size *= 2;
+   return std::min(size, fftSize);
+}
+
+// `x` has length `fftSize/2+1`, and `tmp`, at least that.
 // Returns the last bin that wasn't zeroed.
-size_t ResampleFreqDomain(float* x, size_t fftSize, double factor)
+size_t
+ResampleFreqDomain(float* x, size_t fftSize, double factor, float* tmp)
 {
    const auto size = fftSize / 2 + 1;
    const auto end = std::min(size, size_t(size * factor));
-   std::vector<float> tmp(end);
+   // Multiplying is much cheaper than dividing, in this loop over all bins
+   const auto step = 1. / factor;
    for (size_t i = 0; i < end; ++i)
    {
-      const int int_pos = i / factor;
-      const float frac_pos = 1.f * i / factor - int_pos;
+      const auto pos = i * step;
+      const int int_pos = pos;
+      const float frac_pos = pos - int_pos;
       const auto k = MapToPositiveHalfIndex(int_pos, fftSize);
       const auto l = MapToPositiveHalfIndex(int_pos + 1, fftSize);
       tmp[i] = (1 - frac_pos) * x[k] + frac_pos * x[l];
    }
-   std::copy(tmp.begin(), tmp.begin() + end, x);
+   std::copy(tmp, tmp + end, x);
    if (end < size)
       std::fill(x + end, x + size, 0.f);
    return end;
@@ -42,13 +65,16 @@ size_t ResampleFreqDomain(float* x, size_t fftSize, double factor)
 
 FormantShifter::FormantShifter(
    int sampleRate, double cutoffQuefrency,
-   FormantShifterLoggerInterface& logger)
+   FormantShifterLoggerInterface& logger, bool fullResolutionEnvelope)
     : cutoffQuefrency { cutoffQuefrency }
     , mSampleRate { sampleRate }
+    , mFullResolutionEnvelope { fullResolutionEnvelope }
     , mLogger { logger }
 {
 }
 
+FormantShifter::~FormantShifter() = default;
+
 void FormantShifter::Reset(size_t fftSize)
 {
    mFft = std::make_unique<staffpad::audio::FourierTransform>(
@@ -58,6 +84,7 @@ void FormantShifter::Reset(size_t fftSize)
    mCepstrum.setSize(1, fftSize);
    mEnvelopeReal.resize(numBins);
    mWeights.resize(numBins);
+   mResampled.resize(numBins);
 }
 
 void FormantShifter::Reset()
@@ -97,12 +124,19 @@ void FormantShifter::Process(
    mLogger.Log(pCepst, fftSize, "cepstrumLiftered");
 
    // Get the envelope back.
-   mFft->forwardReal(mCepstrum, mEnvelope);
-   std::transform(
-      pEnv, pEnv + numBins, mEnvelopeReal.begin(),
-      [fftSize = fftSize](const std::complex<float>& env) {
-         return std::exp2(env.real() / fftSize);
-      });
+   const auto envelopeFftSize =
+      mFullResolutionEnvelope ? fftSize : GetEnvelopeFftSize(binCutoff, fftSize);
+   if (envelopeFftSize < fftSize)
+      ComputeEnvelopeAtLowResolution(binCutoff, envelopeFftSize);
+   else
+   {
+      mFft->forwardReal(mCepstrum, mEnvelope);
+      std::transform(
+         pEnv, pEnv + numBins, mEnvelopeReal.begin(),
+         [fftSize = fftSize](const std::complex<float>& env) {
+            return std::exp2(env.real() / fftSize);
+         });
+   }
    mLogger.Log(mEnvelopeReal.data(), numBins, "envelope");
 
    // Get the weights, which are the ratio of the desired envelope to the
@@ -112,7 +146,8 @@ void FormantShifter::Process(
       [](float env) { return std::isnormal(env) ? 1.f / env : 0.f; });
 
    const auto lastNonZeroedBin =
-      ResampleFreqDomain(mEnvelopeReal.data(), fftSize, factor);
+      ResampleFreqDomain(
+         mEnvelopeReal.data(), fftSize, factor, mResampled.data());
 
    mLogger.Log(mEnvelopeReal.data(), numBins, "envelopeResampled");
    std::transform(
@@ -145,7 +180,7 @@ void FormantShifter::Process(
    // Now apply the weights.
    std::transform(
       spec, spec + numBins, mWeights.begin(), spec,
-      std::multiplies<std::complex<float>>());
+      [](const std::complex<float>& x, float weight) { return x * weight; });
 
    mLogger.Log(
       spec, numBins, "weightedMagnitude",
@@ -155,3 +190,50 @@ void FormantShifter::Process(
 
    mLogger.ProcessFinished(spec, fftSize);
 }
+
+void FormantShifter::ComputeEnvelopeAtLowResolution(
+   int binCutoff, int envelopeFftSize)
+{
+   const auto fftSize = mFft->getSize();
+   const auto numBins = fftSize / 2 + 1;
+   if (!mEnvelopeFft || mEnvelopeFft->getSize() != envelopeFftSize)
+   {
+      mEnvelopeFft =
+         std::make_unique<staffpad::audio::FourierTransform>(envelopeFftSize);
+      mLowResCepstrum.setSize(1, envelopeFftSize);
+      mLowResEnvelope.setSize(1, envelopeFftSize / 2 + 1);
+   }
+
+   // The few coefficients that liftering kept, at both ends, are all there is
+   // to transform. At bin `j`, the smaller transform then gives exactly what
+   // the full one gives at bin `j * fftSize / envelopeFftSize`.
+   const auto pCepst = mCepstrum.getPtr(0);
+   const auto pLowResCepst = mLowResCepstrum.getPtr(0);
+   std::copy(pCepst, pCepst + binCutoff + 1, pLowResCepst);
+   std::fill(
+      pLowResCepst + binCutoff + 1,
+      pLowResCepst + envelopeFftSize - binCutoff, 0.f);
+   std::copy(
+      pCepst + fftSize - binCutoff, pCepst + fftSize,
+      pLowResCepst + envelopeFftSize - binCutoff);
+   mEnvelopeFft->forwardReal(mLowResCepstrum, mLowResEnvelope);
+
+   // Interpolate the log envelope, which is smoother than the envelope.
+   // Linear steps in the log are constant ratios, so that exp2 need only be
+   // taken at the points of the smaller transform.
+   const auto pLowResEnv = mLowResEnvelope.getPtr(0);
+   const auto step = fftSize / envelopeFftSize;
+   const auto scale = 1.f / fftSize;
+   auto env = std::exp2(pLowResEnv[0].real() * scale);
+   for (auto j = 0; j < envelopeFftSize / 2; ++j)
+   {
+      const auto next = std::exp2(pLowResEnv[j + 1].real() * scale);
+      const auto ratio = std::exp2(
+         (pLowResEnv[j + 1].real() - pLowResEnv[j].real()) * scale / step);
+      auto value = env;
+      for (auto k = 0; k < step; ++k, value *= ratio)
+         mEnvelopeReal[j * step + k] = value;
+      env = next;
+   }
+   mEnvelopeReal[numBins - 1] = env;
+}
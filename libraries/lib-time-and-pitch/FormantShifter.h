@@ -16,6 +16,7 @@
 #include "StaffPad/SamplesFloat.h"
 #include <complex>
 #include <memory>
+#include <vector>
 
 namespace staffpad::audio
 {
@@ -24,14 +25,21 @@ class FourierTransform;
 
 class FormantShifterLoggerInterface;
 
-class FormantShifter
+class TIME_AND_PITCH_API FormantShifter
 {
 public:
    const double cutoffQuefrency;
 
+   /*!
+    * \param fullResolutionEnvelope if false, the envelope is computed with an
+    * FFT only as large as the liftered cepstrum requires, and interpolated
+    * to the bins of the spectrum.
+    */
    FormantShifter(
       int sampleRate, double cutoffQuefrency,
-      FormantShifterLoggerInterface& logger);
+      FormantShifterLoggerInterface& logger,
+      bool fullResolutionEnvelope = false);
+   ~FormantShifter();
 
    void Reset(size_t fftSize);
    void Reset();
@@ -57,11 +65,21 @@ public:
       const float* powerSpectrum, std::complex<float>* spectrum, double factor);
 
 private:
+   //! Fills mEnvelopeReal from the liftered cepstrum with a smaller FFT
+   void ComputeEnvelopeAtLowResolution(int binCutoff, int envelopeFftSize);
+
    const int mSampleRate;
+   const bool mFullResolutionEnvelope;
    FormantShifterLoggerInterface& mLogger;
    std::unique_ptr<staffpad::audio::FourierTransform> mFft;
    staffpad::SamplesComplex mEnvelope;
    staffpad::SamplesReal mCepstrum;
    std::vector<float> mEnvelopeReal;
    std::vector<float> mWeights;
+   std::vector<float> mResampled;
+
+   //! Of the size last needed for the envelope at low resolution
+   std::unique_ptr<staffpad::audio::FourierTransform> mEnvelopeFft;
+   staffpad::SamplesComplex mLowResEnvelope;
+   staffpad::SamplesReal mLowResCepstrum;
 };
@@ -10,6 +10,7 @@
 
 #include <array>
 #include <complex>
+#include <cstring>
 #include <type_traits>
 #include <memory>
 #include <utility>
@@ -385,8 +385,9 @@ void TimeAndPitch::_process_hop(int hop_a, int hop_s)
     d->fft.forwardReal(d->fft_timeseries, d->spectrum);
     // norms of the mid channel only (or sole channel) are needed in
     // _time_stretch
-    vo::calcNorms(d->spectrum.getPtr(0), d->norm.getPtr(0), d->spectrum.getNumSamples());
-    for (int ch = 0; ch < _numChannels; ++ch)
+    vo::calcNormsAndPhases(d->spectrum.getPtr(0), d->norm.getPtr(0), d->phase.getPtr(0),
+                           d->spectrum.getNumSamples());
+    for (int ch = 1; ch < _numChannels; ++ch)
       vo::calcPhases(d->spectrum.getPtr(ch), d->phase.getPtr(ch), d->spectrum.getNumSamples());
 
     if (_shiftTimbreCb)
@@ -14,12 +14,20 @@
 #include <cstdint>
 #include <cstring>
 
-#if defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_X64) || \
-                          (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#if (defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_X64) || \
+                           (defined(_M_IX86_FP) && _M_IX86_FP >= 2))) || \
+   defined(__SSE2__)
 #define USE_SSE2_COMPLEX 1
 #endif
 
-#if USE_SSE2_COMPLEX
+// AVX2 is chosen at run time, where the CPU has it
+#if USE_SSE2_COMPLEX && !defined(_M_ARM64EC)
+#define USE_AVX2_COMPLEX 1
+#endif
+
+#if USE_AVX2_COMPLEX
+#   include "SimdComplexConversions_avx2.h"
+#elif USE_SSE2_COMPLEX
 #   include "SimdComplexConversions_sse2.h"
 #endif
 
@@ -103,6 +111,11 @@ inline void findMaxElement(const T* src, int32_t n, int32_t& maxIndex, T& maxVal
 
 inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 {
+#if USE_AVX2_COMPLEX
+  if (simd_complex_conversions::avx2::isSupported())
+    return simd_complex_conversions::avx2::calc_norms_and_phases(
+       src, nullptr, dst, n);
+#endif
   simd_complex_conversions::perform_parallel_simd_aligned(
      src, dst, n,
      [](const __m128 rp, const __m128 ip, __m128& out)
@@ -111,16 +124,37 @@ inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 
 inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
 {
+#if USE_AVX2_COMPLEX
+  if (simd_complex_conversions::avx2::isSupported())
+    return simd_complex_conversions::avx2::calc_norms(src, dst, n);
+#endif
   simd_complex_conversions::perform_parallel_simd_aligned(
      src, dst, n,
      [](const __m128 rp, const __m128 ip, __m128& out)
      { out = simd_complex_conversions::norm(rp, ip); });
 }
 
+inline void calcNormsAndPhases(
+   const std::complex<float>* src, float* norms, float* phases, int32_t n)
+{
+#if USE_AVX2_COMPLEX
+  if (simd_complex_conversions::avx2::isSupported())
+    return simd_complex_conversions::avx2::calc_norms_and_phases(
+       src, norms, phases, n);
+#endif
+  calcNorms(src, norms, n);
+  calcPhases(src, phases, n);
+}
+
 inline void rotate(
    const float* oldPhase, const float* newPhase, std::complex<float>* dst,
    int32_t n)
 {
+#if USE_AVX2_COMPLEX
+  if (simd_complex_conversions::avx2::isSupported())
+    return simd_complex_conversions::avx2::rotate_parallel_simd_aligned(
+       oldPhase, newPhase, dst, n);
+#endif
   simd_complex_conversions::rotate_parallel_simd_aligned(
      oldPhase, newPhase, dst, n);
 }
@@ -137,6 +171,13 @@ inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
     dst[i] = std::norm(src[i]);
 }
 
+inline void calcNormsAndPhases(
+   const std::complex<float>* src, float* norms, float* phases, int32_t n)
+{
+  calcNorms(src, norms, n);
+  calcPhases(src, phases, n);
+}
+
 inline void rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
 {
   for (int32_t i = 0; i < n; i++) {
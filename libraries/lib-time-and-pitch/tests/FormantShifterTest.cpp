@@ -0,0 +1,158 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  FormantShifterTest.cpp
+
+**********************************************************************/
+#include "FormantShifter.h"
+#include "FormantShifterLoggerInterface.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+constexpr auto cutoffQuefrency = 0.002;
+// As StaffPadTimeAndPitch uses with formant preservation
+constexpr auto fftSize = 2048;
+constexpr auto numBins = fftSize / 2 + 1;
+
+class NullLogger final : public FormantShifterLoggerInterface
+{
+public:
+   void NewSamplesComing(int) override
+   {
+   }
+   void Log(int, const char*) const override
+   {
+   }
+   void Log(const float*, size_t, const char*) const override
+   {
+   }
+   void Log(
+      const std::complex<float>*, size_t, const char*,
+      const std::function<float(const std::complex<float>&)>&) const override
+   {
+   }
+   void ProcessFinished(std::complex<float>*, size_t) override
+   {
+   }
+};
+
+// A voiced spectrum: harmonics of `f0` under three formants, with some noise
+std::vector<std::complex<float>> MakeVoiceSpectrum(double f0, unsigned seed)
+{
+   std::mt19937 gen { seed };
+   std::uniform_real_distribution<float> phase(-3.14159265f, 3.14159265f);
+   std::uniform_real_distribution<float> noise(0.f, .01f);
+   const auto formant = [](double f, double center, double width) {
+      return std::exp(-(f - center) * (f - center) / (2 * width * width));
+   };
+   std::vector<std::complex<float>> spectrum(numBins);
+   for (auto i = 0; i < numBins; ++i)
+   {
+      const auto f = 1. * i * sampleRate / fftSize;
+      const auto envelope = .05 + formant(f, 700, 150) +
+                            .5 * formant(f, 1200, 200) +
+                            .25 * formant(f, 2600, 300);
+      // Distance to the nearest harmonic, in bins
+      const auto distance =
+         (f - std::round(f / f0) * f0) * fftSize / sampleRate;
+      const auto comb = std::exp(-distance * distance);
+      const auto magnitude = fftSize * (envelope * comb + noise(gen)) / 2;
+      spectrum[i] = std::polar(static_cast<float>(magnitude), phase(gen));
+   }
+   return spectrum;
+}
+
+std::vector<float>
+GetPowerSpectrum(const std::vector<std::complex<float>>& spectrum)
+{
+   std::vector<float> power(spectrum.size());
+   std::transform(
+      spectrum.begin(), spectrum.end(), power.begin(),
+      [](const std::complex<float>& x) { return std::norm(x); });
+   return power;
+}
+} // namespace
+
+TEST_CASE("FormantShifter")
+{
+   NullLogger logger;
+   FormantShifter fullResolution { sampleRate, cutoffQuefrency, logger,
+                                   true };
+   FormantShifter lowResolution { sampleRate, cutoffQuefrency, logger };
+   fullResolution.Reset(fftSize);
+   lowResolution.Reset(fftSize);
+
+   SECTION("low-resolution envelope gives the same weights within 0.2 dB")
+   {
+      for (const auto factor : { .5, .8, 1. / 1.05, 1.25, 2. })
+      {
+         const auto input = MakeVoiceSpectrum(150 / factor, 0);
+         const auto power = GetPowerSpectrum(input);
+         auto expected = input;
+         auto actual = input;
+         fullResolution.Process(power.data(), expected.data(), factor);
+         lowResolution.Process(power.data(), actual.data(), factor);
+         for (auto i = 0; i < numBins; ++i)
+         {
+            const auto dB =
+               20 * std::log10(std::abs(actual[i]) / std::abs(expected[i]));
+            REQUIRE(std::abs(dB) < .2);
+         }
+      }
+   }
+}
+
+// Not run by default; prints the time per frame with either resolution
+TEST_CASE("FormantShifter benchmark", "[.benchmark]")
+{
+   using namespace std::chrono;
+   NullLogger logger;
+   constexpr auto numFrames = 2000;
+   constexpr auto numRounds = 10;
+   const auto input = MakeVoiceSpectrum(200, 0);
+   const auto power = GetPowerSpectrum(input);
+   auto spectrum = input;
+   for (const auto factor : { .8, 1.25 })
+   {
+      const auto time = [&](bool fullResolutionEnvelope) {
+         FormantShifter shifter { sampleRate, cutoffQuefrency, logger,
+                                  fullResolutionEnvelope };
+         shifter.Reset(fftSize);
+         // The best of a few rounds, the others having been interrupted
+         auto best = std::numeric_limits<double>::max();
+         for (auto round = 0; round < numRounds; ++round)
+         {
+            const auto start = steady_clock::now();
+            for (auto i = 0; i < numFrames; ++i)
+            {
+               std::copy(input.begin(), input.end(), spectrum.begin());
+               shifter.Process(power.data(), spectrum.data(), factor);
+            }
+            best = std::min(
+               best, duration<double, std::micro>(steady_clock::now() - start)
+                           .count() /
+                        numFrames);
+         }
+         return best;
+      };
+      const auto full = time(true);
+      const auto low = time(false);
+      std::cout << "Formant shift by " << factor << ": " << full
+                << " us per frame at full resolution, " << low
+                << " us at low resolution\n";
+   }
+}
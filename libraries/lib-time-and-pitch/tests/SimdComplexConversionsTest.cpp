@@ -0,0 +1,139 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SimdComplexConversionsTest.cpp
+
+**********************************************************************/
+#include "StaffPad/SamplesFloat.h"
+#include "StaffPad/VectorOps.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace staffpad;
+
+namespace
+{
+// Odd, to cover the partial packets
+constexpr auto numBins = 2049;
+
+// SamplesFloat is filled in place, as its copies would share buffers
+void FillRandomSpectrum(SamplesComplex& spectrum)
+{
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> dis(-1.f, 1.f);
+   spectrum.setSize(1, numBins);
+   auto p = spectrum.getPtr(0);
+   for (auto i = 0; i < numBins; ++i)
+      p[i] = { dis(gen), dis(gen) };
+   // Special cases of atan2
+   p[0] = { 0.f, 0.f };
+   p[1] = { 0.f, 1.f };
+   p[2] = { 0.f, -1.f };
+   p[3] = { -1.f, 0.f };
+   p[4] = { 1.f, 0.f };
+}
+
+void FillRandomPhases(SamplesReal& phases)
+{
+   std::mt19937 gen { 1 };
+   std::uniform_real_distribution<float> dis(-3.14159265f, 3.14159265f);
+   phases.setSize(1, numBins);
+   auto p = phases.getPtr(0);
+   for (auto i = 0; i < numBins; ++i)
+      p[i] = dis(gen);
+}
+} // namespace
+
+TEST_CASE("VectorOps complex conversions")
+{
+   SamplesComplex spectrum;
+   FillRandomSpectrum(spectrum);
+   const auto src = spectrum.getPtr(0);
+
+   SECTION("calcNormsAndPhases agrees with the standard library")
+   {
+      SamplesReal norms, phases;
+      norms.setSize(1, numBins);
+      phases.setSize(1, numBins);
+      vo::calcNormsAndPhases(src, norms.getPtr(0), phases.getPtr(0), numBins);
+      for (auto i = 0; i < numBins; ++i)
+      {
+         REQUIRE(norms.getPtr(0)[i] == Approx(std::norm(src[i])));
+         REQUIRE(
+            phases.getPtr(0)[i] ==
+            Approx(std::arg(src[i])).margin(1e-6));
+      }
+   }
+
+   SECTION("rotate agrees with the standard library")
+   {
+      SamplesReal oldPhases, newPhases;
+      FillRandomPhases(oldPhases);
+      FillRandomPhases(newPhases);
+      std::reverse(newPhases.getPtr(0), newPhases.getPtr(0) + numBins);
+      SamplesComplex rotated;
+      FillRandomSpectrum(rotated);
+      vo::rotate(
+         oldPhases.getPtr(0), newPhases.getPtr(0), rotated.getPtr(0), numBins);
+      for (auto i = 0; i < numBins; ++i)
+      {
+         const auto theta = newPhases.getPtr(0)[i] - oldPhases.getPtr(0)[i];
+         const auto expected =
+            src[i] * std::complex<float>(std::cos(theta), std::sin(theta));
+         REQUIRE(
+            rotated.getPtr(0)[i].real() ==
+            Approx(expected.real()).margin(1e-6));
+         REQUIRE(
+            rotated.getPtr(0)[i].imag() ==
+            Approx(expected.imag()).margin(1e-6));
+      }
+   }
+
+#if USE_AVX2_COMPLEX
+   SECTION("AVX2 gives the same results as SSE2")
+   {
+      if (!simd_complex_conversions::avx2::isSupported())
+         return;
+
+      SamplesReal avxNorms, avxPhases, sseNorms, ssePhases;
+      for (auto p : { &avxNorms, &avxPhases, &sseNorms, &ssePhases })
+         p->setSize(1, numBins);
+      simd_complex_conversions::avx2::calc_norms_and_phases(
+         src, avxNorms.getPtr(0), avxPhases.getPtr(0), numBins);
+      simd_complex_conversions::perform_parallel_simd_aligned(
+         src, sseNorms.getPtr(0), numBins,
+         [](const __m128 rp, const __m128 ip, __m128& out)
+         { out = simd_complex_conversions::norm(rp, ip); });
+      simd_complex_conversions::perform_parallel_simd_aligned(
+         src, ssePhases.getPtr(0), numBins,
+         [](const __m128 rp, const __m128 ip, __m128& out)
+         { out = simd_complex_conversions::atan2_ps(ip, rp); });
+
+      SamplesReal oldPhases;
+      FillRandomPhases(oldPhases);
+      SamplesComplex avxRotated, sseRotated;
+      FillRandomSpectrum(avxRotated);
+      FillRandomSpectrum(sseRotated);
+      simd_complex_conversions::avx2::rotate_parallel_simd_aligned(
+         oldPhases.getPtr(0), avxPhases.getPtr(0), avxRotated.getPtr(0),
+         numBins);
+      simd_complex_conversions::rotate_parallel_simd_aligned(
+         oldPhases.getPtr(0), ssePhases.getPtr(0), sseRotated.getPtr(0),
+         numBins);
+
+      for (auto i = 0; i < numBins; ++i)
+      {
+         REQUIRE(avxNorms.getPtr(0)[i] == sseNorms.getPtr(0)[i]);
+         REQUIRE(avxPhases.getPtr(0)[i] == ssePhases.getPtr(0)[i]);
+         REQUIRE(avxRotated.getPtr(0)[i] == sseRotated.getPtr(0)[i]);
+      }
+   }
+#endif
+}
@@ -11,9 +11,20 @@
 #include "PendingTracks.h"
 #include "Track.h"
 #include "UndoManager.h"
+#include "XMLWriter.h"
+
+#include <optional>
+
+UndoTracks::Storage::~Storage() = default;
 
 // Undo/redo handling of selection changes
 namespace {
+//! Counts the characters of a document without making it
+struct DocumentSizer final : XMLWriter {
+   void Write(const wxString &data) override { size += data.length(); }
+   size_t size{ 0 };
+};
+
 struct TrackListRestorer final : UndoStateExtension {
    TrackListRestorer(AudacityProject &project)
       : mpTracks{ TrackList::Create(nullptr) }
@@ -28,13 +39,49 @@ struct TrackListRestorer final : UndoStateExtension {
    void RestoreUndoRedoState(AudacityProject &project) override {
       auto &dstTracks = TrackList::Get(project);
       dstTracks.Clear();
+      if (mpStorage) {
+         // The state is likely to be visited again, so bring it back into
+         // memory
+         mpStorage->Restore(project);
+         mpTracks = TrackList::Create(nullptr);
+         for (auto pTrack : dstTracks)
+            mpTracks->Add(pTrack->Duplicate());
+         mpStorage.reset();
+         return;
+      }
       for (auto pTrack : *mpTracks)
          dstTracks.Add(pTrack->Duplicate());
    }
    bool CanUndoOrRedo(const AudacityProject &project) override {
       return !PendingTracks::Get(project).HasPendingTracks();
    }
-   const std::shared_ptr<TrackList> mpTracks;
+   //! Estimated by the size of the document of the tracks, which grows with
+   //! the numbers of clips, sample blocks, envelope points, and labels
+   size_t GetMemoryUsage() const override {
+      if (!mpTracks)
+         return 0;
+      if (!mMemoryUsage) {
+         DocumentSizer sizer;
+         for (auto pTrack : *mpTracks)
+            pTrack->WriteXML(sizer);
+         mMemoryUsage = sizer.size;
+      }
+      return *mMemoryUsage;
+   }
+   bool Spill(AudacityProject &project) override {
+      if (!mpTracks)
+         return false;
+      mpStorage = UndoTracks::Spill::Call(project, *mpTracks);
+      if (!mpStorage)
+         return false;
+      mpTracks.reset();
+      return true;
+   }
+   //! Null while spilled
+   std::shared_ptr<TrackList> mpTracks;
+   //! Non-null while spilled
+   std::unique_ptr<UndoTracks::Storage> mpStorage;
+   mutable std::optional<size_t> mMemoryUsage;
 };
 
 UndoRedoExtensionRegistry::Entry sEntry {
@@ -42,9 +89,8 @@ UndoRedoExtensionRegistry::Entry sEntry {
       return std::make_shared<TrackListRestorer>(project);
    }
 };
-}
 
-TrackList *UndoTracks::Find(const UndoStackElem &state)
+const TrackListRestorer *FindRestorer(const UndoStackElem &state)
 {
    auto &exts = state.state.extensions;
    auto end = exts.end(),
@@ -52,6 +98,21 @@ TrackList *UndoTracks::Find(const UndoStackElem &state)
          return dynamic_cast<TrackListRestorer*>(pExt.get());
       });
    if (iter != end)
-      return static_cast<TrackListRestorer*>(iter->get())->mpTracks.get();
+      return static_cast<TrackListRestorer*>(iter->get());
+   return nullptr;
+}
+}
+
+TrackList *UndoTracks::Find(const UndoStackElem &state)
+{
+   if (auto pRestorer = FindRestorer(state))
+      return pRestorer->mpTracks.get();
+   return nullptr;
+}
+
+auto UndoTracks::FindStorage(const UndoStackElem &state) -> const Storage *
+{
+   if (auto pRestorer = FindRestorer(state))
+      return pRestorer->mpStorage.get();
    return nullptr;
 }
@@ -10,11 +10,36 @@
 #ifndef __AUDACITY_UNDO_TRACKS__
 #define __AUDACITY_UNDO_TRACKS__
 
+#include <memory>
+#include "GlobalVariable.h"
+
+class AudacityProject;
 class TrackList;
 struct UndoStackElem;
 
 namespace UndoTracks {
+//! Tracks of a state of undo history, or null if they were spilled
 TRACK_API TrackList *Find(const UndoStackElem &state);
+
+//! Holds the tracks of a state of undo history, moved out of memory
+class TRACK_API Storage {
+public:
+   virtual ~Storage();
+
+   //! Add the stored tracks to the tracks of the project, which are empty
+   /*! @throw an exception on failure */
+   virtual void Restore(AudacityProject &project) const = 0;
+};
+
+//! Where the tracks of a state of undo history were spilled, or null if they
+//! are in memory
+TRACK_API const Storage *FindStorage(const UndoStackElem &state);
+
+//! Type of function that moves copies of tracks out of memory, or returns
+//! null if it can't; it does not throw
+struct TRACK_API Spill : GlobalHook<Spill,
+   std::unique_ptr<Storage>(AudacityProject &, const TrackList &)
+> {};
 }
 
 #endif
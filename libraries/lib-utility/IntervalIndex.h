@@ -0,0 +1,106 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  IntervalIndex.h
+
+**********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+//! Finds which of many intervals, sorted by their starts, meet a range
+/*!
+ The intervals are the leaves of a balanced tree, each node of which keeps the
+ latest end of the intervals below it, so that a query visits only the
+ subtrees that can contain a result: O(log n + k log n) for k results.
+
+ Intervals are closed, so that points and abutting intervals are found.
+ The index does not observe the intervals; Reset() it when they change.
+ */
+class IntervalIndex final
+{
+public:
+   //! Index the intervals from `first` to `last`
+   /*!
+    @pre the starts are not decreasing
+    @param getStart gives the start of an element
+    @param getEnd gives the end of an element, not less than its start
+    */
+   template<typename Iterator, typename GetStart, typename GetEnd>
+   void
+   Reset(Iterator first, Iterator last, GetStart getStart, GetEnd getEnd)
+   {
+      mStarts.clear();
+      std::vector<double> ends;
+
+      for (; first != last; ++first)
+      {
+         mStarts.push_back(getStart(*first));
+         ends.push_back(getEnd(*first));
+      }
+
+      mLeaves = 1;
+      while (mLeaves < mStarts.size())
+         mLeaves *= 2;
+
+      mMaxEnds.assign(2 * mLeaves, -std::numeric_limits<double>::infinity());
+      std::copy(ends.begin(), ends.end(), mMaxEnds.begin() + mLeaves);
+
+      for (auto node = mLeaves; node-- > 1;)
+         mMaxEnds[node] = std::max(mMaxEnds[2 * node], mMaxEnds[2 * node + 1]);
+   }
+
+   //! Number of intervals indexed
+   size_t size() const noexcept
+   {
+      return mStarts.size();
+   }
+
+   //! Call `visitor` with the position of each interval that meets
+   //! [from, to], in increasing order
+   template<typename Visitor>
+   void Visit(double from, double to, Visitor&& visitor) const
+   {
+      if (mStarts.empty() || !(from <= to))
+         return;
+
+      // Intervals starting after `to` are all at the end
+      const size_t count =
+         std::upper_bound(mStarts.begin(), mStarts.end(), to) -
+         mStarts.begin();
+
+      if (count > 0)
+         Visit(1, 0, mLeaves, count, from, visitor);
+   }
+
+private:
+   template<typename Visitor>
+   void Visit(
+      size_t node, size_t first, size_t last, size_t count, double from,
+      Visitor& visitor) const
+   {
+      if (first >= count || mMaxEnds[node] < from)
+         return;
+
+      if (last - first == 1)
+      {
+         visitor(first);
+         return;
+      }
+
+      const auto middle = (first + last) / 2;
+      Visit(2 * node, first, middle, count, from, visitor);
+      Visit(2 * node + 1, middle, last, count, from, visitor);
+   }
+
+   std::vector<double> mStarts;
+   //! Latest ends in the implicit tree; the node `i` has children `2i` and
+   //! `2i+1`, and the leaves start at `mLeaves`
+   std::vector<double> mMaxEnds;
+   size_t mLeaves { 0 };
+};
@@ -0,0 +1,161 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MemoryAccounting.cpp
+
+**********************************************************************/
+#include "MemoryAccounting.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+
+#ifdef _WIN32
+#   include <windows.h>
+#   include <psapi.h>
+#else
+#   include <sys/resource.h>
+#endif
+
+namespace MemoryAccounting {
+namespace {
+struct Counters {
+   std::atomic<size_t> bytes{ 0 };
+   std::atomic<size_t> peakBytes{ 0 };
+   std::atomic<size_t> objects{ 0 };
+};
+
+std::array<Counters, static_cast<size_t>(Tag::nTags)> sCounters;
+
+std::atomic<bool> sEnabled{
+   std::getenv("AUDACITY_MEMORY_ACCOUNTING") != nullptr };
+
+Counters &GetCounters(Tag tag)
+{
+   return sCounters[static_cast<size_t>(tag)];
+}
+
+void RaisePeak(Counters &counters, size_t bytes)
+{
+   auto peak = counters.peakBytes.load(std::memory_order_relaxed);
+   while (peak < bytes && !counters.peakBytes.compare_exchange_weak(
+      peak, bytes, std::memory_order_relaxed))
+      ;
+}
+}
+
+const char *GetName(Tag tag)
+{
+   switch (tag) {
+   case Tag::SampleBlocks:
+      return "SampleBlocks";
+   case Tag::GraphicsDataCaches:
+      return "GraphicsDataCaches";
+   case Tag::UndoStates:
+      return "UndoStates";
+   case Tag::RingBuffers:
+      return "RingBuffers";
+   case Tag::RealtimeEffects:
+      return "RealtimeEffects";
+   default:
+      return "";
+   }
+}
+
+bool IsEnabled()
+{
+   return sEnabled.load(std::memory_order_relaxed);
+}
+
+void SetEnabled(bool enabled)
+{
+   if (enabled && !IsEnabled())
+      ResetPeaks();
+   sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+Totals GetTotals(Tag tag)
+{
+   auto &counters = GetCounters(tag);
+   return {
+      counters.bytes.load(std::memory_order_relaxed),
+      counters.peakBytes.load(std::memory_order_relaxed),
+      counters.objects.load(std::memory_order_relaxed)
+   };
+}
+
+void ResetPeaks()
+{
+   for (auto &counters : sCounters)
+      counters.peakBytes.store(
+         counters.bytes.load(std::memory_order_relaxed),
+         std::memory_order_relaxed);
+}
+
+size_t GetPeakProcessBytes()
+{
+#ifdef _WIN32
+   PROCESS_MEMORY_COUNTERS counters{};
+   if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+      return 0;
+   return counters.PeakWorkingSetSize;
+#else
+   rusage usage{};
+   if (getrusage(RUSAGE_SELF, &usage) != 0)
+      return 0;
+#   ifdef __APPLE__
+   // In bytes, not kibibytes as on Linux
+   return static_cast<size_t>(usage.ru_maxrss);
+#   else
+   return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#   endif
+#endif
+}
+
+Charge &Charge::operator=(const Charge &other)
+{
+   if (this != &other) {
+      Release();
+      mTag = other.mTag;
+      Set(other.mBytes);
+   }
+   return *this;
+}
+
+void Charge::Set(size_t bytes)
+{
+   if (!IsEnabled()) {
+      Release();
+      mBytes = bytes;
+      return;
+   }
+   auto &counters = GetCounters(mTag);
+   if (!mCounted) {
+      mCounted = true;
+      mBytes = 0;
+      counters.objects.fetch_add(1, std::memory_order_relaxed);
+   }
+   size_t total;
+   if (bytes >= mBytes)
+      total = counters.bytes.fetch_add(
+         bytes - mBytes, std::memory_order_relaxed) + (bytes - mBytes);
+   else
+      total = counters.bytes.fetch_sub(
+         mBytes - bytes, std::memory_order_relaxed) - (mBytes - bytes);
+   mBytes = bytes;
+   RaisePeak(counters, total);
+}
+
+void Charge::Release()
+{
+   if (mCounted) {
+      auto &counters = GetCounters(mTag);
+      counters.bytes.fetch_sub(mBytes, std::memory_order_relaxed);
+      counters.objects.fetch_sub(1, std::memory_order_relaxed);
+      mCounted = false;
+   }
+   mBytes = 0;
+}
+
+}
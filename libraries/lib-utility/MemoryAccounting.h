@@ -0,0 +1,96 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MemoryAccounting.h
+  @brief Opt-in counters of the memory held by each subsystem
+
+**********************************************************************/
+#ifndef __AUDACITY_MEMORY_ACCOUNTING__
+#define __AUDACITY_MEMORY_ACCOUNTING__
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//! Counts the bytes and the objects that each subsystem holds
+/*!
+ Owners of memory hold a Charge, setting it to the bytes they hold when
+ these change.  Nothing is counted unless accounting is enabled, by the
+ AUDACITY_MEMORY_ACCOUNTING environment variable or SetEnabled(); then each
+ change costs a few relaxed atomic operations, which any thread may do
+ */
+namespace MemoryAccounting {
+
+enum class Tag : unsigned {
+   SampleBlocks,
+   GraphicsDataCaches,
+   UndoStates,
+   RingBuffers,
+   RealtimeEffects,
+   nTags
+};
+
+//! Stable and untranslated, for scripting and diagnostics
+UTILITY_API const char *GetName(Tag tag);
+
+UTILITY_API bool IsEnabled();
+//! Charges made while disabled stay uncounted until set again
+UTILITY_API void SetEnabled(bool enabled);
+
+struct Totals final {
+   size_t bytes{ 0 };
+   //! Greatest value of bytes since enabled or ResetPeaks()
+   size_t peakBytes{ 0 };
+   //! Charges now counted
+   size_t objects{ 0 };
+};
+
+UTILITY_API Totals GetTotals(Tag tag);
+//! Lowers the peaks to the present totals
+UTILITY_API void ResetPeaks();
+
+//! Greatest resident memory of the whole process so far, as the operating
+//! system reports it, whether or not accounting is enabled
+/*! @return 0 if unknown */
+UTILITY_API size_t GetPeakProcessBytes();
+
+//! Bytes held by one object, counted against a tag while accounting is enabled
+class UTILITY_API Charge final {
+public:
+   explicit Charge(Tag tag, size_t bytes = 0) : mTag{ tag } { Set(bytes); }
+   //! Charges the same bytes again, as a copy holds as much
+   Charge(const Charge &other) : Charge{ other.mTag, other.mBytes } {}
+   Charge &operator=(const Charge &other);
+   ~Charge() { Release(); }
+
+   //! Counts the bytes, or releases them if accounting is disabled
+   void Set(size_t bytes);
+   //! Stops counting, until set again
+   void Release();
+
+   size_t GetBytes() const { return mBytes; }
+
+private:
+   Tag mTag;
+   size_t mBytes{ 0 };
+   bool mCounted{ false };
+};
+
+//! Makes a vector whose elements are charged to the tag while it lives
+template<typename T>
+std::shared_ptr<std::vector<T>> MakeChargedVector(Tag tag, size_t size)
+{
+   struct Holder {
+      Holder(Tag tag, size_t size)
+         : vector(size), charge{ tag, size * sizeof(T) } {}
+      std::vector<T> vector;
+      Charge charge;
+   };
+   auto pHolder = std::make_shared<Holder>(tag, size);
+   return { pHolder, &pHolder->vector };
+}
+
+}
+
+#endif
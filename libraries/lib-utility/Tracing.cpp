@@ -0,0 +1,217 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Tracing.cpp
+
+**********************************************************************/
+#include "Tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Tracing {
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point sOrigin = Clock::now();
+
+//! Nanoseconds since the origin, never 0, which means no span
+uint64_t Now()
+{
+   return 1 + std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now() - sOrigin).count();
+}
+
+struct Event {
+   const char *name;
+   uint64_t begin;
+   uint64_t duration;
+};
+
+//! Events per thread in one trace
+constexpr size_t Capacity = 1 << 16;
+
+//! Written only by its thread; read by GetTraceJSON()
+struct ThreadBuffer {
+   explicit ThreadBuffer(unsigned id) : id{ id } {}
+   const unsigned id;
+   std::atomic<const char*> name{ nullptr };
+   //! Trace to which the recorded events belong
+   std::atomic<unsigned> generation{ 0 };
+   //! Events recorded; each is complete before this count includes it
+   std::atomic<size_t> count{ 0 };
+   const std::unique_ptr<Event[]> events{ new Event[Capacity] };
+};
+
+std::atomic<bool> sEnabled{ std::getenv("AUDACITY_TRACING") != nullptr };
+std::atomic<unsigned> sGeneration{ 1 };
+std::atomic<uint64_t> sStart{ 0 };
+std::atomic<size_t> sDropped{ 0 };
+
+//! Guards the list of buffers, which a thread joins at its first span
+std::mutex sMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> sBuffers;
+unsigned sNextId = 1;
+
+thread_local std::shared_ptr<ThreadBuffer> tBuffer;
+thread_local const char *tName = nullptr;
+
+ThreadBuffer &GetBuffer()
+{
+   if (!tBuffer) {
+      std::lock_guard<std::mutex> lock{ sMutex };
+      tBuffer = std::make_shared<ThreadBuffer>(sNextId++);
+      tBuffer->name.store(tName, std::memory_order_relaxed);
+      sBuffers.push_back(tBuffer);
+   }
+   return *tBuffer;
+}
+
+void Record(const char *name, uint64_t begin, uint64_t end)
+{
+   auto &buffer = GetBuffer();
+   const auto generation = sGeneration.load(std::memory_order_acquire);
+   if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+      // First span of this thread in a new trace
+      buffer.count.store(0, std::memory_order_relaxed);
+      buffer.generation.store(generation, std::memory_order_release);
+   }
+   const auto count = buffer.count.load(std::memory_order_relaxed);
+   if (count == Capacity) {
+      sDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   buffer.events[count] = { name, begin, end - begin };
+   buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void AppendEscaped(std::string &json, const char *str)
+{
+   for (; *str; ++str) {
+      const auto c = *str;
+      if (c == '"' || c == '\\') {
+         json += '\\';
+         json += c;
+      }
+      else if (static_cast<unsigned char>(c) < 0x20)
+         json += ' ';
+      else
+         json += c;
+   }
+}
+
+void AppendMicroseconds(std::string &json, uint64_t nanoseconds)
+{
+   char buffer[32];
+   std::snprintf(buffer, sizeof buffer, "%llu.%03llu",
+      static_cast<unsigned long long>(nanoseconds / 1000),
+      static_cast<unsigned long long>(nanoseconds % 1000));
+   json += buffer;
+}
+}
+
+bool IsEnabled()
+{
+   return sEnabled.load(std::memory_order_relaxed);
+}
+
+void Start()
+{
+   {
+      std::lock_guard<std::mutex> lock{ sMutex };
+      // Forget the buffers of threads that ended
+      sBuffers.erase(std::remove_if(sBuffers.begin(), sBuffers.end(),
+         [](const auto &pBuffer){ return pBuffer.use_count() == 1; }),
+         sBuffers.end());
+   }
+   sDropped.store(0, std::memory_order_relaxed);
+   sStart.store(Now(), std::memory_order_relaxed);
+   sGeneration.fetch_add(1, std::memory_order_acq_rel);
+   sEnabled.store(true, std::memory_order_relaxed);
+}
+
+void Stop()
+{
+   sEnabled.store(false, std::memory_order_relaxed);
+}
+
+void SetThreadName(const char *name)
+{
+   tName = name;
+   if (tBuffer)
+      tBuffer->name.store(name, std::memory_order_relaxed);
+}
+
+std::string GetTraceJSON()
+{
+   const auto generation = sGeneration.load(std::memory_order_acquire);
+   const auto start = sStart.load(std::memory_order_relaxed);
+   std::string json{ "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" };
+   bool first = true;
+   const auto separate = [&]{
+      if (!first)
+         json += ",\n";
+      first = false;
+   };
+
+   std::lock_guard<std::mutex> lock{ sMutex };
+   for (const auto &pBuffer : sBuffers) {
+      auto &buffer = *pBuffer;
+      if (buffer.generation.load(std::memory_order_acquire) != generation)
+         continue;
+      const auto tid = std::to_string(buffer.id);
+      if (const auto name = buffer.name.load(std::memory_order_relaxed)) {
+         separate();
+         json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+         json += tid;
+         json += ",\"args\":{\"name\":\"";
+         AppendEscaped(json, name);
+         json += "\"}}";
+      }
+      const auto count = buffer.count.load(std::memory_order_acquire);
+      for (size_t ii = 0; ii < count; ++ii) {
+         const auto &event = buffer.events[ii];
+         // Skip spans that began before the trace
+         if (event.begin < start)
+            continue;
+         separate();
+         json += "{\"name\":\"";
+         AppendEscaped(json, event.name);
+         json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+         json += tid;
+         json += ",\"ts\":";
+         AppendMicroseconds(json, event.begin - start);
+         json += ",\"dur\":";
+         AppendMicroseconds(json, event.duration);
+         json += '}';
+      }
+   }
+   json += "]}\n";
+   return json;
+}
+
+size_t GetDroppedCount()
+{
+   return sDropped.load(std::memory_order_relaxed);
+}
+
+Span::Span(const char *name)
+   : mName{ name }
+   , mBegin{ IsEnabled() ? Now() : 0 }
+{
+}
+
+Span::~Span()
+{
+   if (mBegin && IsEnabled())
+      Record(mName, mBegin, Now());
+}
+
+}
@@ -0,0 +1,73 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Tracing.h
+  @brief Opt-in timeline of scoped spans in all threads
+
+**********************************************************************/
+#ifndef __AUDACITY_TRACING__
+#define __AUDACITY_TRACING__
+
+#include <cstdint>
+#include <string>
+
+//! Records when named scopes begin and end in each thread, for viewing as one
+//! timeline in Perfetto or chrome://tracing
+/*!
+ Spans are recorded only while tracing is started, by the AUDACITY_TRACING
+ environment variable or Start(); then each costs two reads of a clock and a
+ store into a buffer of its thread, which no other thread writes, so that no
+ lock is taken, even in the audio thread.  Spans that overflow the buffer of
+ their thread are dropped.
+
+ Builds configured without tracing define AUDACITY_TRACE_SCOPE as nothing.
+ */
+namespace Tracing {
+
+UTILITY_API bool IsEnabled();
+//! Discards the spans recorded before, and begins recording
+UTILITY_API void Start();
+//! Ends recording, keeping the spans until the next Start()
+UTILITY_API void Stop();
+
+//! Names the calling thread in the trace
+//! @pre `name` is a string literal or otherwise outlives all traces
+UTILITY_API void SetThreadName(const char *name);
+
+//! Spans recorded since Start(), in the Chrome trace event format
+/*! Call after Stop(), lest spans of running threads be missed */
+UTILITY_API std::string GetTraceJSON();
+
+//! Number of spans not recorded because the buffer of their thread was full
+UTILITY_API size_t GetDroppedCount();
+
+//! Records its lifetime in the calling thread, if tracing is started then
+class UTILITY_API Span final {
+public:
+   //! @pre `name` is a string literal or otherwise outlives all traces
+   explicit Span(const char *name);
+   ~Span();
+
+   Span(const Span&) = delete;
+   Span &operator=(const Span&) = delete;
+
+private:
+   const char *const mName;
+   //! Nanoseconds since the start of tracing, or 0 if not recording
+   const uint64_t mBegin;
+};
+
+}
+
+#ifdef HAS_TRACING
+#define AUDACITY_TRACE_CONCAT_(a, b) a ## b
+#define AUDACITY_TRACE_CONCAT(a, b) AUDACITY_TRACE_CONCAT_(a, b)
+//! Records a span named by a string literal, until the end of the scope
+#define AUDACITY_TRACE_SCOPE(name) \
+   const Tracing::Span AUDACITY_TRACE_CONCAT(traceSpan, __LINE__){ name }
+#else
+#define AUDACITY_TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif
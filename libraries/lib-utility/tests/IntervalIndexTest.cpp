@@ -0,0 +1,95 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  IntervalIndexTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "IntervalIndex.h"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+
+namespace
+{
+using Interval = std::pair<double, double>;
+
+std::vector<size_t> Query(const IntervalIndex& index, double from, double to)
+{
+   std::vector<size_t> result;
+   index.Visit(from, to, [&](size_t i) { result.push_back(i); });
+   return result;
+}
+
+IntervalIndex MakeIndex(const std::vector<Interval>& intervals)
+{
+   IntervalIndex index;
+   index.Reset(
+      intervals.begin(), intervals.end(),
+      [](const Interval& i) { return i.first; },
+      [](const Interval& i) { return i.second; });
+   return index;
+}
+} // namespace
+
+TEST_CASE("IntervalIndex", "")
+{
+   SECTION("An empty index finds nothing")
+   {
+      const auto index = MakeIndex({});
+
+      REQUIRE(index.size() == 0);
+      REQUIRE(Query(index, -1e9, 1e9).empty());
+   }
+
+   SECTION("Long intervals are found after their start")
+   {
+      const auto index =
+         MakeIndex({ { 0, 100 }, { 1, 2 }, { 3, 3 }, { 5, 6 }, { 50, 60 } });
+
+      REQUIRE(Query(index, 10, 20) == std::vector<size_t> { 0 });
+      REQUIRE(Query(index, 2, 3) == std::vector<size_t> { 0, 1, 2 });
+      REQUIRE(Query(index, 6, 50) == std::vector<size_t> { 0, 3, 4 });
+      REQUIRE(Query(index, 101, 200).empty());
+      REQUIRE(Query(index, -5, -1).empty());
+      REQUIRE(Query(index, 20, 10).empty());
+   }
+
+   SECTION("Results match a linear search")
+   {
+      std::mt19937 generator { 42 };
+      std::uniform_real_distribution<double> starts { 0.0, 1000.0 };
+      std::exponential_distribution<double> lengths { 0.1 };
+
+      for (const size_t count : { 1, 2, 3, 7, 64, 1000 })
+      {
+         std::vector<Interval> intervals;
+         for (size_t i = 0; i < count; ++i)
+         {
+            const auto start = starts(generator);
+            intervals.emplace_back(start, start + lengths(generator));
+         }
+         std::sort(intervals.begin(), intervals.end());
+
+         const auto index = MakeIndex(intervals);
+         REQUIRE(index.size() == count);
+
+         for (int query = 0; query < 100; ++query)
+         {
+            const auto from = starts(generator);
+            const auto to = from + lengths(generator);
+
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < count; ++i)
+               if (intervals[i].first <= to && intervals[i].second >= from)
+                  expected.push_back(i);
+
+            REQUIRE(Query(index, from, to) == expected);
+         }
+      }
+   }
+}
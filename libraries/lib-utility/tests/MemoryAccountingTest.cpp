@@ -0,0 +1,75 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemoryAccountingTest.cpp
+
+**********************************************************************/
+
+#include "MemoryAccounting.h"
+#include <catch2/catch.hpp>
+
+using namespace MemoryAccounting;
+
+TEST_CASE("MemoryAccounting")
+{
+   constexpr auto tag = Tag::RingBuffers;
+   SetEnabled(true);
+   const auto before = GetTotals(tag);
+
+   SECTION("counts the bytes and objects of live charges")
+   {
+      {
+         Charge a{ tag, 100 };
+         Charge b{ tag, 50 };
+         REQUIRE(GetTotals(tag).bytes == before.bytes + 150);
+         REQUIRE(GetTotals(tag).objects == before.objects + 2);
+         a.Set(10);
+         REQUIRE(GetTotals(tag).bytes == before.bytes + 60);
+         REQUIRE(GetTotals(tag).peakBytes >= before.bytes + 150);
+         Charge c{ b };
+         REQUIRE(GetTotals(tag).bytes == before.bytes + 110);
+         REQUIRE(GetTotals(tag).objects == before.objects + 3);
+      }
+      REQUIRE(GetTotals(tag).bytes == before.bytes);
+      REQUIRE(GetTotals(tag).objects == before.objects);
+   }
+
+   SECTION("counts nothing while disabled")
+   {
+      SetEnabled(false);
+      Charge a{ tag, 100 };
+      REQUIRE(GetTotals(tag).bytes == before.bytes);
+      SetEnabled(true);
+      a.Set(200);
+      REQUIRE(GetTotals(tag).bytes == before.bytes + 200);
+      SetEnabled(false);
+      a.Set(300);
+      REQUIRE(GetTotals(tag).bytes == before.bytes);
+      REQUIRE(GetTotals(tag).objects == before.objects);
+      SetEnabled(true);
+   }
+
+   SECTION("charged vectors release their bytes when destroyed")
+   {
+      auto pVector = MakeChargedVector<float>(tag, 64);
+      REQUIRE(pVector->size() == 64);
+      REQUIRE(GetTotals(tag).bytes == before.bytes + 64 * sizeof(float));
+      std::weak_ptr<std::vector<float>> wVector = pVector;
+      pVector.reset();
+      REQUIRE(wVector.expired());
+      REQUIRE(GetTotals(tag).bytes == before.bytes);
+   }
+
+   SetEnabled(false);
+}
+
+TEST_CASE("MemoryAccounting::GetPeakProcessBytes")
+{
+   // Filled, so that the pages are resident
+   constexpr size_t size = 64 * 1024 * 1024;
+   std::vector<char> memory(size, 1);
+   REQUIRE(memory.back() == 1);
+   REQUIRE(GetPeakProcessBytes() >= size);
+}
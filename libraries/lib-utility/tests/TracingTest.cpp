@@ -0,0 +1,68 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  TracingTest.cpp
+
+**********************************************************************/
+
+#include "Tracing.h"
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+namespace {
+size_t CountOf(const std::string &json, const std::string &part)
+{
+   size_t count = 0;
+   for (auto pos = json.find(part); pos != std::string::npos;
+      pos = json.find(part, pos + part.size()))
+      ++count;
+   return count;
+}
+}
+
+TEST_CASE("Tracing")
+{
+   SECTION("records spans of all threads only while started")
+   {
+      Tracing::Stop();
+      { Tracing::Span span{ "before" }; }
+      Tracing::Start();
+      REQUIRE(Tracing::IsEnabled());
+      {
+         Tracing::Span outer{ "outer" };
+         Tracing::Span inner{ "inner" };
+      }
+      std::thread{ []{
+         Tracing::SetThreadName("worker");
+         Tracing::Span span{ "in \"worker\"" };
+      } }.join();
+      Tracing::Stop();
+      { Tracing::Span span{ "after" }; }
+
+      const auto json = Tracing::GetTraceJSON();
+      REQUIRE(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+      REQUIRE(CountOf(json, "\"ph\":\"X\"") == 3);
+      REQUIRE(CountOf(json, "\"name\":\"outer\"") == 1);
+      REQUIRE(CountOf(json, "\"name\":\"inner\"") == 1);
+      REQUIRE(CountOf(json, "\"name\":\"in \\\"worker\\\"\"") == 1);
+      REQUIRE(CountOf(json, "\"args\":{\"name\":\"worker\"}") == 1);
+      REQUIRE(CountOf(json, "before") == 0);
+      REQUIRE(CountOf(json, "after") == 0);
+      REQUIRE(Tracing::GetDroppedCount() == 0);
+   }
+
+   SECTION("starting again discards the spans of the previous trace")
+   {
+      Tracing::Start();
+      { Tracing::Span span{ "first" }; }
+      Tracing::Start();
+      { Tracing::Span span{ "second" }; }
+      Tracing::Stop();
+      const auto json = Tracing::GetTraceJSON();
+      REQUIRE(CountOf(json, "first") == 0);
+      REQUIRE(CountOf(json, "second") == 1);
+   }
+}
@@ -431,6 +431,8 @@ void Viewport::DoScroll()
    const auto pos = mpCallbacks ? mpCallbacks->GetVerticalThumbPosition() : 0;
    viewInfo.vpos = pos * scrollStep;
 
+   UpdateScrollVelocity(viewInfo.hpos, zoom);
+
    //mchinen: do not always set this project to be the active one.
    //a project may autoscroll while playing in the background
    //I think this is okay since OnMouseEvent has one of these.
@@ -440,6 +442,37 @@ void Viewport::DoScroll()
       Publish({ true, false, false });
 }
 
+//! Scrolling stopped if the view did not move for so many seconds
+static constexpr double ScrollVelocityTimeout = 0.5;
+
+void Viewport::UpdateScrollVelocity(double hpos, double zoom)
+{
+   if (hpos == mLastHpos && zoom == mLastZoom)
+      // Only vertical scrolling
+      return;
+
+   const auto now = std::chrono::steady_clock::now();
+   const auto elapsed =
+      std::chrono::duration<double>(now - mLastScrollTime).count();
+
+   if (zoom != mLastZoom || elapsed > ScrollVelocityTimeout)
+      mScrollVelocity = 0.0;
+   else if (elapsed > 0)
+      // Average with the previous velocity, for the jitter of events
+      mScrollVelocity = (mScrollVelocity + (hpos - mLastHpos) / elapsed) / 2;
+
+   mLastHpos = hpos;
+   mLastZoom = zoom;
+   mLastScrollTime = now;
+}
+
+double Viewport::GetScrollVelocity() const
+{
+   const auto elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - mLastScrollTime).count();
+   return elapsed > ScrollVelocityTimeout ? 0.0 : mScrollVelocity;
+}
+
 void Viewport::ZoomFitHorizontallyAndShowTrack(Track *pTrack)
 {
    auto &project = mProject;
@@ -14,6 +14,8 @@ Paul Licameli split from ProjectWindow.h
 #include "ClientData.h"
 #include "Observer.h"
 
+#include <chrono>
+
 class AudacityProject;
 class Track;
 class TrackList;
@@ -75,6 +77,13 @@ public:
    //! Cause refresh of viewport contents after setting scrolling or zooming
    void DoScroll();
 
+   //! Seconds of the timeline per second that the view scrolled horizontally
+   //! lately, positive to the right, or zero if it has not lately
+   /*!
+    Painting may use it to fill caches for what will come into view next
+    */
+   double GetScrollVelocity() const;
+
    /*!
     This method 'rewinds' the track, by setting the cursor to 0 and
     scrolling the window to fit 0 on the left side of it
@@ -183,6 +192,8 @@ private:
 
    void FinishAutoScroll();
 
+   void UpdateScrollVelocity(double hpos, double zoom);
+
    void OnUndoPushedModified();
    void OnUndoRedo();
    void OnUndoReset();
@@ -213,6 +224,12 @@ private:
 
    bool mAutoScrolling{ false };
    bool mbInitializingScrollbar{ false };
+
+   // Horizontal scrolling, as of the last DoScroll() that moved the view
+   double mLastHpos{ 0.0 };
+   double mLastZoom{ 0.0 };
+   std::chrono::steady_clock::time_point mLastScrollTime{};
+   double mScrollVelocity{ 0.0 };
 };
 
 #endif
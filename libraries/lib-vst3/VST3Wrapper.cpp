@@ -199,20 +199,17 @@ bool SetupProcessing(Steinberg::Vst::IComponent& component, Steinberg::Vst::Proc
    return false;
 }
 
+//! View of the queues that have points for one processing block
 class InputParameterChanges final : public Steinberg::Vst::IParameterChanges
 {
-   const Steinberg::int32 mParameterCount;
-   SingleInputParameterValue* const mParameterQueues;
+   InputParameterValueQueue* const mParameterQueues;
+   const std::vector<Steinberg::int32>& mActiveQueues;
 public:
 
-   InputParameterChanges(const std::vector<std::pair<Steinberg::Vst::ParamID, Steinberg::Vst::ParamValue>>& values, SingleInputParameterValue* queues)
-      : mParameterQueues(queues), mParameterCount(values.size())
+   InputParameterChanges(InputParameterValueQueue* queues, const std::vector<Steinberg::int32>& activeQueues)
+      : mParameterQueues(queues), mActiveQueues(activeQueues)
    {
       FUNKNOWN_CTOR
-
-      int queueIndex{0};
-      for(auto& p : values)
-         queues[queueIndex++].Set(p.first, p.second);
    }
 
    ~InputParameterChanges()
@@ -228,11 +225,13 @@ public:
 
    Steinberg::int32 PLUGIN_API getParameterCount() override
    {
-      return mParameterCount;
+      return static_cast<Steinberg::int32>(mActiveQueues.size());
    }
    Steinberg::Vst::IParamValueQueue* PLUGIN_API getParameterData(Steinberg::int32 index) override
    {
-      return &mParameterQueues[index];
+      if(index < 0 || index >= getParameterCount())
+         return nullptr;
+      return &mParameterQueues[mActiveQueues[index]];
    }
 
    DECLARE_FUNKNOWN_METHODS;
@@ -372,37 +371,61 @@ IMPLEMENT_FUNKNOWN_METHODS(ComponentHandler, Steinberg::Vst::IComponentHandler,
 }
 
 
-void SingleInputParameterValue::Set(Steinberg::Vst::ParamID id, const Steinberg::Vst::ParamValue value)
+InputParameterValueQueue::InputParameterValueQueue()
+{
+   FUNKNOWN_CTOR
+   mPoints.reserve(MaxPoints);
+}
+
+void InputParameterValueQueue::Reset(Steinberg::Vst::ParamID id)
 {
    mParameterId = id;
-   mValue = value;
+   mPoints.clear();
 }
 
-Steinberg::tresult SingleInputParameterValue::addPoint(Steinberg::int32 sampleOffset, Steinberg::Vst::ParamValue value,
+void InputParameterValueQueue::Add(Steinberg::int32 sampleOffset, Steinberg::Vst::ParamValue value)
+{
+   if(!mPoints.empty())
+   {
+      auto& last = mPoints.back();
+      if(sampleOffset < last.first)
+         return;
+      if(sampleOffset == last.first || mPoints.size() == MaxPoints)
+      {
+         last = { sampleOffset, value };
+         return;
+      }
+   }
+   mPoints.emplace_back(sampleOffset, value);
+}
+
+Steinberg::tresult InputParameterValueQueue::addPoint(Steinberg::int32 sampleOffset, Steinberg::Vst::ParamValue value,
    Steinberg::int32& index)
 {
    return Steinberg::kResultFalse;
 }
 
-Steinberg::Vst::ParamID SingleInputParameterValue::getParameterId()
+Steinberg::Vst::ParamID InputParameterValueQueue::getParameterId()
 {
    return mParameterId;
 }
 
-Steinberg::tresult SingleInputParameterValue::getPoint(Steinberg::int32 index, Steinberg::int32& sampleOffset,
+Steinberg::tresult InputParameterValueQueue::getPoint(Steinberg::int32 index, Steinberg::int32& sampleOffset,
    Steinberg::Vst::ParamValue& value)
 {
-   sampleOffset = 0;
-   value = mValue;
+   if(index < 0 || index >= getPointCount())
+      return Steinberg::kResultFalse;
+   sampleOffset = mPoints[index].first;
+   value = mPoints[index].second;
    return Steinberg::kResultOk;
 }
 
-Steinberg::int32 SingleInputParameterValue::getPointCount()
+Steinberg::int32 InputParameterValueQueue::getPointCount()
 {
-   return 1;
+   return static_cast<Steinberg::int32>(mPoints.size());
 }
 
-IMPLEMENT_FUNKNOWN_METHODS(SingleInputParameterValue, Steinberg::Vst::IParamValueQueue, Steinberg::Vst::IParamValueQueue::iid);
+IMPLEMENT_FUNKNOWN_METHODS(InputParameterValueQueue, Steinberg::Vst::IParamValueQueue, Steinberg::Vst::IParamValueQueue::iid);
 
 VST3Wrapper::VST3Wrapper(VST3::Hosting::Module& module, const VST3::Hosting::ClassInfo& effectClassInfo)
    : mModule{ module }
@@ -556,8 +579,18 @@ void VST3Wrapper::InitializeComponents()
    if(!SetupProcessing(*mEffectComponent, mSetup))
       throw std::runtime_error("bus configuration not supported");
 
-   mParameterQueues = std::make_unique<SingleInputParameterValue[]>(mEditController->getParameterCount());
-   mParameters.reserve(mEditController->getParameterCount());
+   const auto parameterCount = mEditController->getParameterCount();
+   mParameterQueues = std::make_unique<InputParameterValueQueue[]>(parameterCount);
+   mActiveQueues.reserve(parameterCount);
+   for(int32 i = 0; i < parameterCount; ++i)
+   {
+      Vst::ParameterInfo parameterInfo { };
+      if(mEditController->getParameterInfo(i, parameterInfo) == kResultOk)
+      {
+         mQueueIndices[parameterInfo.id] = i;
+         mParameterQueues[i].Reset(parameterInfo.id);
+      }
+   }
 
    Steinberg::MemoryStream stateStream;
    if(mEffectComponent->getState(&stateStream) == kResultOk)
@@ -804,13 +837,19 @@ void VST3Wrapper::ConsumeChanges(const EffectSettings& settings)
 {
    const auto& vst3settings = GetSettings(settings);
    for(auto& p : vst3settings.parameterChanges)
-   {
-      auto it = std::find_if(mParameters.begin(), mParameters.end(), [&p](const auto& v) { return v.first == p.first; });
-      if(it != mParameters.end())
-         it->second = p.second;
-      else
-         mParameters.push_back(p);
-   }
+      AddParameterChange(p.first, p.second);
+}
+
+void VST3Wrapper::AddParameterChange(Steinberg::Vst::ParamID id,
+   Steinberg::Vst::ParamValue value, Steinberg::int32 sampleOffset)
+{
+   const auto it = mQueueIndices.find(id);
+   if(it == mQueueIndices.end())
+      return;
+   auto& queue = mParameterQueues[it->second];
+   if(queue.getPointCount() == 0)
+      mActiveQueues.push_back(it->second);
+   queue.Add(sampleOffset, value);
 }
 
 //Used as a workaround for issue #2555: some plugins do not accept changes
@@ -861,8 +900,13 @@ size_t VST3Wrapper::Process(const float* const* inBlock, float* const* outBlock,
 {
    using namespace Steinberg;
    
-   InputParameterChanges inputParameterChanges(mParameters, mParameterQueues.get());
-   mParameters.clear();
+   InputParameterChanges inputParameterChanges(mParameterQueues.get(), mActiveQueues);
+   //All scheduled changes are delivered by this call, even if it fails
+   auto clearQueues = finally([this]{
+      for(auto index : mActiveQueues)
+         mParameterQueues[index].Reset(mParameterQueues[index].getParameterId());
+      mActiveQueues.clear();
+   });
 
    Vst::ProcessData data;
    data.processMode = mSetup.processMode;
@@ -6,6 +6,9 @@
 #include <pluginterfaces/vst/ivstprocesscontext.h>
 #include <public.sdk/source/vst/hosting/module.h>
 
+#include <unordered_map>
+#include <vector>
+
 #include "EffectInterface.h"
 
 class VST3Wrapper;
@@ -27,16 +30,32 @@ namespace Steinberg
    }
 }
 
-class SingleInputParameterValue final : public Steinberg::Vst::IParamValueQueue
+//! Points of change of one parameter, within one processing block
+/*!
+ Storage for the points is reserved once, so that adding them during
+ processing does not allocate
+ */
+class InputParameterValueQueue final : public Steinberg::Vst::IParamValueQueue
 {
    Steinberg::Vst::ParamID mParameterId{};
-   Steinberg::Vst::ParamValue mValue;
+   std::vector<std::pair<Steinberg::int32, Steinberg::Vst::ParamValue>> mPoints;
 public:
+   //! Most points kept for one parameter in one block; further points
+   //! replace the last one
+   static constexpr size_t MaxPoints = 64;
+
+   InputParameterValueQueue();
+   ~InputParameterValueQueue() { FUNKNOWN_DTOR }
 
-   SingleInputParameterValue() { FUNKNOWN_CTOR }
-   ~SingleInputParameterValue() { FUNKNOWN_DTOR }
+   //! Discard all points and reassign the parameter
+   void Reset(Steinberg::Vst::ParamID id);
 
-   void Set(Steinberg::Vst::ParamID id, const Steinberg::Vst::ParamValue value);
+   //! Add a point, keeping them in order of offset
+   /*!
+    A point at the same offset as the last replaces it; a point before the
+    last is ignored, as the plug-in expects increasing offsets
+    */
+   void Add(Steinberg::int32 sampleOffset, Steinberg::Vst::ParamValue value);
 
    Steinberg::tresult PLUGIN_API addPoint(Steinberg::int32 sampleOffset, Steinberg::Vst::ParamValue value,
       Steinberg::int32& index) override;
@@ -115,6 +134,19 @@ public:
    //! changed the DSP model state
    void FlushParameters(EffectSettings& settings, bool* hasChanges = nullptr);
 
+   //! Schedules a change of a parameter for the next call to Process
+   /*!
+    All changes scheduled between two calls to Process are delivered to the
+    plug-in in one batch, sample-accurately, which makes automation from
+    envelope data cheap: nothing is allocated per change.
+    Call from the same thread as Process.
+    Ignores parameters unknown to the edit controller.
+
+    \param sampleOffset position of the change within the next block
+    */
+   void AddParameterChange(Steinberg::Vst::ParamID id,
+      Steinberg::Vst::ParamValue value, Steinberg::int32 sampleOffset = 0);
+
    //Intialize first, before calling to Process. It's safe to it use from another thread
    size_t Process(const float* const* inBlock, float* const* outBlock, size_t blockLen);
    
@@ -152,12 +184,13 @@ private:
 
    bool mActive {false};
 
-   std::vector<std::pair<Steinberg::Vst::ParamID, Steinberg::Vst::ParamValue>> mParameters;
-   //A preallocated array of Steinberg::Vst::IParameterValueQueue
-   //used as a view to an actual parameter changes that reside
-   //in VST3EffectSettings structure, dynamically assigned during
-   //processing
-   std::unique_ptr<SingleInputParameterValue[]> mParameterQueues;
+   //A preallocated array of Steinberg::Vst::IParamValueQueue,
+   //one for each parameter of the edit controller; those with
+   //points scheduled for the next processing pass are listed in
+   //mActiveQueues, in order of first change
+   std::unique_ptr<InputParameterValueQueue[]> mParameterQueues;
+   std::unordered_map<Steinberg::Vst::ParamID, Steinberg::int32> mQueueIndices;
+   std::vector<Steinberg::int32> mActiveQueues;
 
    Steinberg::Vst::ProcessContext mProcessContext { };
 };
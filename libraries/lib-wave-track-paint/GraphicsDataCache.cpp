@@ -14,6 +14,7 @@
 #include <cassert>
 #include <type_traits>
 
+#include "FrameStatistics.h"
 #include "ZoomInfo.h"
 
 #include "float_cast.h"
@@ -71,6 +72,135 @@ auto GetPPSMatchRange(
 }
 } // namespace
 
+double GraphicsDataCacheBudget::Statistics::GetHitRate() const noexcept
+{
+   const auto lookups = Hits + Misses;
+   return lookups > 0 ? double(Hits) / lookups : 0.0;
+}
+
+GraphicsDataCacheBudget& GraphicsDataCacheBudget::Get()
+{
+   static GraphicsDataCacheBudget budget;
+   return budget;
+}
+
+void GraphicsDataCacheBudget::SetBudget(size_t bytes) noexcept
+{
+   mBudget = bytes;
+}
+
+size_t GraphicsDataCacheBudget::GetBudget() const noexcept
+{
+   return mBudget;
+}
+
+GraphicsDataCacheBudget::Statistics
+GraphicsDataCacheBudget::GetStatistics() const noexcept
+{
+   auto statistics        = mStatistics;
+   statistics.CachesCount = mCaches.size();
+   return statistics;
+}
+
+void GraphicsDataCacheBudget::ResetCounters() noexcept
+{
+   mStatistics.Hits            = 0;
+   mStatistics.Misses          = 0;
+   mStatistics.Evictions       = 0;
+   mStatistics.BudgetEvictions = 0;
+}
+
+void GraphicsDataCacheBudget::Register(GraphicsDataCacheBase& cache)
+{
+   mCaches.push_back(&cache);
+}
+
+void GraphicsDataCacheBudget::Unregister(GraphicsDataCacheBase& cache) noexcept
+{
+   UpdateBytes(cache.mMemoryUsage, 0);
+
+   mCaches.erase(
+      std::remove(mCaches.begin(), mCaches.end(), &cache), mCaches.end());
+}
+
+uint64_t GraphicsDataCacheBudget::BeginLookup() noexcept
+{
+   ++mClock;
+
+   if (mLookupDepth++ == 0)
+      mLookupStart = mClock;
+
+   return mClock;
+}
+
+void GraphicsDataCacheBudget::EndLookup() noexcept
+{
+   assert(mLookupDepth > 0);
+   --mLookupDepth;
+}
+
+void GraphicsDataCacheBudget::UpdateBytes(
+   size_t oldUsage, size_t newUsage) noexcept
+{
+   mStatistics.Bytes =
+      mStatistics.Bytes - std::min(mStatistics.Bytes, oldUsage) + newUsage;
+}
+
+void GraphicsDataCacheBudget::Enforce()
+{
+   if (mLookupDepth != 1 || mBudget == 0 || mStatistics.Bytes <= mBudget)
+      return;
+
+   const size_t target = mBudget / 4 * 3;
+
+   // Evicted elements, kept only for reuse, go first
+   for (auto cache : mCaches)
+   {
+      cache->ReleaseDisposedElements();
+      cache->UpdateMemoryUsage();
+   }
+
+   if (mStatistics.Bytes <= target)
+      return;
+
+   for (auto cache : mCaches)
+   {
+      for (const auto& item : cache->mLookup)
+      {
+         if (item.Data->LastBudgetAccess < mLookupStart)
+            mCandidates.emplace_back(
+               item.Data->LastBudgetAccess, item.Data->GetMemoryUsage());
+      }
+   }
+
+   std::sort(mCandidates.begin(), mCandidates.end());
+
+   size_t bytes       = mStatistics.Bytes;
+   uint64_t threshold = 0;
+
+   for (const auto& [lastAccess, usage] : mCandidates)
+   {
+      if (bytes <= target)
+         break;
+
+      bytes -= std::min(bytes, usage);
+      threshold = lastAccess + 1;
+   }
+
+   mCandidates.clear();
+
+   if (threshold == 0)
+      return;
+
+   for (auto cache : mCaches)
+      mStatistics.BudgetEvictions += cache->EvictAccessedBefore(threshold);
+}
+
+GraphicsDataCacheBase::~GraphicsDataCacheBase()
+{
+   GraphicsDataCacheBudget::Get().Unregister(*this);
+}
+
 void GraphicsDataCacheBase::Invalidate()
 {
    for (auto& item : mLookup)
@@ -97,6 +227,7 @@ int64_t GraphicsDataCacheBase::GetMaxViewportWidth() const noexcept
 GraphicsDataCacheBase::GraphicsDataCacheBase(double sampleRate)
     : mScaledSampleRate { sampleRate }
 {
+   GraphicsDataCacheBudget::Get().Register(*this);
 }
 
 void GraphicsDataCacheBase::SetScaledSampleRate(double scaledSampleRate)
@@ -119,6 +250,11 @@ void GraphicsDataCacheElementBase::Smooth(
 {
 }
 
+size_t GraphicsDataCacheElementBase::GetMemoryUsage() const noexcept
+{
+   return sizeof(GraphicsDataCacheElementBase);
+}
+
 GraphicsDataCacheBase::BaseLookupResult
 GraphicsDataCacheBase::PerformBaseLookup(
    const ZoomInfo& zoomInfo, double t0, double t1)
@@ -126,6 +262,9 @@ GraphicsDataCacheBase::PerformBaseLookup(
    if (bool(t0 > t1) || IsSameSample(mScaledSampleRate, t0, t1))
       return {};
 
+   auto sw = FrameStatistics::CreateStopwatch(
+      FrameStatistics::SectionID::GraphicsDataCacheLookup);
+
    const double pixelsPerSecond = zoomInfo.GetZoom();
 
    const int64_t left  = zoomInfo.TimeToPosition(t0);
@@ -144,6 +283,10 @@ GraphicsDataCacheBase::PerformBaseLookup(
 
    UpdateViewportWidth(width);
 
+   auto& budget  = GraphicsDataCacheBudget::Get();
+   mBudgetAccess = budget.BeginLookup();
+   auto endLookup = finally([&budget] { budget.EndLookup(); });
+
    mNewLookupItems.clear();
    mNewLookupItems.reserve(cacheItemsCount);
 
@@ -168,6 +311,15 @@ GraphicsDataCacheBase::PerformBaseLookup(
 
    bool needsSmoothing = !mNewLookupItems.empty();
 
+   budget.mStatistics.Hits += cacheItemsCount - mNewLookupItems.size();
+   budget.mStatistics.Misses += mNewLookupItems.size();
+
+   FrameStatistics::AddCount(
+      FrameStatistics::CounterID::CacheHits,
+      cacheItemsCount - mNewLookupItems.size());
+   FrameStatistics::AddCount(
+      FrameStatistics::CounterID::CacheMisses, mNewLookupItems.size());
+
    ++mCacheAccessIndex;
 
    if (!CreateNewItems())
@@ -205,8 +357,9 @@ GraphicsDataCacheBase::PerformBaseLookup(
    {
       auto data = it->Data;
 
-      data->LastCacheAccess = mCacheAccessIndex;
-      data->AwaitsEviction  = false;
+      data->LastCacheAccess  = mCacheAccessIndex;
+      data->LastBudgetAccess = mBudgetAccess;
+      data->AwaitsEviction   = false;
 
       if (!data->IsComplete && data->LastUpdate != mCacheAccessIndex)
       {
@@ -225,6 +378,8 @@ GraphicsDataCacheBase::PerformBaseLookup(
    }
 
    PerformCleanup();
+   UpdateMemoryUsage();
+   budget.Enforce();
 
    it        = FindKey(firstItemKey);
    auto last = it;
@@ -240,14 +395,25 @@ GraphicsDataCacheBase::PerformBaseLookup(
 const GraphicsDataCacheElementBase*
 GraphicsDataCacheBase::PerformBaseLookup(GraphicsDataCacheKey key)
 {
+   auto sw = FrameStatistics::CreateStopwatch(
+      FrameStatistics::SectionID::GraphicsDataCacheLookup);
+
    auto it = FindKey(key);
 
    ++mCacheAccessIndex;
 
+   auto& budget  = GraphicsDataCacheBudget::Get();
+   mBudgetAccess = budget.BeginLookup();
+   auto endLookup = finally([&budget] { budget.EndLookup(); });
+
    if (it != mLookup.end())
    {
       GraphicsDataCacheElementBase* data = it->Data;
 
+      ++budget.mStatistics.Hits;
+      FrameStatistics::AddCount(FrameStatistics::CounterID::CacheHits);
+      data->LastBudgetAccess = mBudgetAccess;
+
       if (!data->IsComplete && data->LastUpdate != mCacheAccessIndex)
       {
          if (!UpdateElement(it->Key, *data))
@@ -264,14 +430,18 @@ GraphicsDataCacheBase::PerformBaseLookup(GraphicsDataCacheKey key)
 
    mNewLookupItems.push_back({ key, nullptr });
 
+   ++budget.mStatistics.Misses;
+   FrameStatistics::AddCount(FrameStatistics::CounterID::CacheMisses);
+
    LookupElement newElement { key, CreateElement(key) };
 
    if (newElement.Data == nullptr)
       return nullptr;
 
-   newElement.Data->LastUpdate      = mCacheAccessIndex;
-   newElement.Data->LastCacheAccess = mCacheAccessIndex;
-   newElement.Data->AwaitsEviction  = false;
+   newElement.Data->LastUpdate       = mCacheAccessIndex;
+   newElement.Data->LastCacheAccess  = mCacheAccessIndex;
+   newElement.Data->LastBudgetAccess = mBudgetAccess;
+   newElement.Data->AwaitsEviction   = false;
 
    auto insertedPosition = mLookup.insert(
       std::upper_bound(
@@ -291,6 +461,8 @@ GraphicsDataCacheBase::PerformBaseLookup(GraphicsDataCacheKey key)
                                             (insertedPosition - 1)->Data);
 
    PerformCleanup();
+   UpdateMemoryUsage();
+   budget.Enforce();
 
    return newElement.Data;
 }
@@ -353,6 +525,8 @@ void GraphicsDataCacheBase::PerformCleanup()
       {
          DisposeElement(it->Data);
          mLookup.erase(it);
+
+         ++GraphicsDataCacheBudget::Get().mStatistics.Evictions;
       }
    }
    else
@@ -391,6 +565,8 @@ void GraphicsDataCacheBase::PerformFullCleanup(
 
       DisposeElement(data);
       data->AwaitsEviction = true;
+
+      ++GraphicsDataCacheBudget::Get().mStatistics.Evictions;
    }
 
    mLookup.erase(
@@ -401,3 +577,42 @@ void GraphicsDataCacheBase::PerformFullCleanup(
 
    mLRUHelper.clear();
 }
+
+void GraphicsDataCacheBase::UpdateMemoryUsage()
+{
+   const auto usage = ComputeMemoryUsage();
+
+   GraphicsDataCacheBudget::Get().UpdateBytes(mMemoryUsage, usage);
+   mMemoryUsage = usage;
+   mCharge.Set(usage);
+}
+
+size_t GraphicsDataCacheBase::EvictAccessedBefore(uint64_t budgetAccess)
+{
+   size_t evicted = 0;
+
+   for (auto& item : mLookup)
+   {
+      if (item.Data->LastBudgetAccess >= budgetAccess)
+         continue;
+
+      DisposeElement(item.Data);
+      item.Data->AwaitsEviction = true;
+
+      ++evicted;
+   }
+
+   if (evicted > 0)
+   {
+      mLookup.erase(
+         std::remove_if(
+            mLookup.begin(), mLookup.end(),
+            [](auto item) { return item.Data->AwaitsEviction; }),
+         mLookup.end());
+
+      ReleaseDisposedElements();
+      UpdateMemoryUsage();
+   }
+
+   return evicted;
+}
@@ -10,6 +10,7 @@
 **********************************************************************/
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 #include <functional>
@@ -17,6 +18,7 @@
 #include <type_traits>
 #include <vector>
 
+#include "MemoryAccounting.h"
 #include "MemoryX.h"
 #include "IteratorX.h"
 
@@ -39,9 +41,13 @@ struct WAVE_TRACK_PAINT_API GraphicsDataCacheElementBase /* not final */
    virtual void Dispose();
    //! This method is called during the lookup when new items are inserted. prevElement can be nullptr. Default implementation is empty
    virtual void Smooth(GraphicsDataCacheElementBase* prevElement);
+   //! Approximate number of bytes held by the element, counted against the GraphicsDataCacheBudget. Default implementation returns the size of the base
+   virtual size_t GetMemoryUsage() const noexcept;
 
    //! Index filled by GraphicsDataCacheBase to implement LRU eviction policy
    uint64_t LastCacheAccess { 0 };
+   //! Clock of the GraphicsDataCacheBudget at the last access, to implement LRU eviction across caches
+   uint64_t LastBudgetAccess { 0 };
    //! The last time the item was updated. If (!IsComplete && LastUpdate < LastCacheAccess) the item will be updated.
    uint64_t LastUpdate { 0 };
    //! Cache implementation is responsible to set this flag when all the data of the item is filled
@@ -50,6 +56,84 @@ struct WAVE_TRACK_PAINT_API GraphicsDataCacheElementBase /* not final */
    bool AwaitsEviction { false };
 };
 
+class GraphicsDataCacheBase;
+
+//! Bounds the memory held by all the graphics data caches together
+/*!
+ Each cache still bounds the number of its elements by its viewport width.
+ When the elements of all caches hold more than the budget, the least
+ recently used elements of any cache are evicted, down to three quarters of
+ the budget.  Elements used by the lookup in progress are never evicted,
+ but the result of a lookup may not survive a lookup in another cache.
+
+ All the caches are accessed only in the main thread, and so is the budget.
+ */
+class WAVE_TRACK_PAINT_API GraphicsDataCacheBudget final
+{
+public:
+   //! Counters of all the caches
+   struct Statistics final
+   {
+      //! Bytes held by the elements of all caches, evicted or not
+      size_t Bytes { 0 };
+      size_t CachesCount { 0 };
+      //! Elements that lookups found in the cache
+      uint64_t Hits { 0 };
+      //! Elements that lookups had to create
+      uint64_t Misses { 0 };
+      //! Elements evicted by a cache to stay within its own bound
+      uint64_t Evictions { 0 };
+      //! Elements evicted to stay within the budget
+      uint64_t BudgetEvictions { 0 };
+
+      double GetHitRate() const noexcept;
+   };
+
+   static constexpr size_t DefaultBudget = 512 * 1024 * 1024;
+
+   static GraphicsDataCacheBudget& Get();
+
+   GraphicsDataCacheBudget(const GraphicsDataCacheBudget&) = delete;
+   GraphicsDataCacheBudget& operator=(const GraphicsDataCacheBudget&) = delete;
+
+   //! Sets the budget in bytes, 0 for none; takes effect at the next lookup
+   void SetBudget(size_t bytes) noexcept;
+   size_t GetBudget() const noexcept;
+
+   Statistics GetStatistics() const noexcept;
+   //! Resets hits, misses and evictions
+   void ResetCounters() noexcept;
+
+private:
+   GraphicsDataCacheBudget() = default;
+
+   void Register(GraphicsDataCacheBase& cache);
+   void Unregister(GraphicsDataCacheBase& cache) noexcept;
+
+   //! @return the clock value of the new lookup
+   uint64_t BeginLookup() noexcept;
+   void EndLookup() noexcept;
+
+   void UpdateBytes(size_t oldUsage, size_t newUsage) noexcept;
+   //! Evicts elements if over budget; only the outermost of nested lookups
+   //! may, as inner ones run while the outer cache iterates its elements
+   void Enforce();
+
+   std::vector<GraphicsDataCacheBase*> mCaches;
+   //! Helper vector of (last access, bytes) of the elements that may be evicted
+   std::vector<std::pair<uint64_t, size_t>> mCandidates;
+
+   Statistics mStatistics;
+   size_t mBudget { DefaultBudget };
+
+   uint64_t mClock { 0 };
+   //! Clock at the start of the outermost lookup in progress
+   uint64_t mLookupStart { 0 };
+   int mLookupDepth { 0 };
+
+   friend class GraphicsDataCacheBase;
+};
+
 //! A base class for the GraphicsDataCache. Implements LRU policy
 class WAVE_TRACK_PAINT_API GraphicsDataCacheBase /* not final */
 {
@@ -57,7 +141,7 @@ public:
    // Number of pixels in a single cache element
    constexpr static uint32_t CacheElementWidth = 256;
 
-   virtual ~GraphicsDataCacheBase() = default;
+   virtual ~GraphicsDataCacheBase();
 
    //! Invalidate the cache content
    void Invalidate();
@@ -103,6 +187,11 @@ protected:
    virtual bool UpdateElement(
       const GraphicsDataCacheKey& key, GraphicsDataCacheElementBase& element) = 0;
 
+   //! Bytes held by all the elements, including the evicted ones kept for reuse
+   virtual size_t ComputeMemoryUsage() const = 0;
+   //! Deallocate the evicted elements kept for reuse
+   virtual void ReleaseDisposedElements() = 0;
+
    //! Perform a lookup inside the cache. This method modifies mLookup and invalidates any previous result.
    BaseLookupResult PerformBaseLookup(const ZoomInfo& zoomInfo, double t0, double t1);
 
@@ -120,6 +209,10 @@ private:
    void PerformCleanup();
    // A heap based approach if cache needs to evict more than one item
    void PerformFullCleanup(int64_t currentSize, int64_t itemsToEvict);
+   // Recomputes the memory usage and reports it to the budget
+   void UpdateMemoryUsage();
+   // Called by the budget to evict the elements last accessed before the given clock value
+   size_t EvictAccessedBefore(uint64_t budgetAccess);
    // This vector is sorted according to the key
    Lookup mLookup;
    // This vector is used to avoid memory allocations when growing the cache
@@ -138,6 +231,14 @@ private:
    uint64_t mCacheAccessIndex {};
    // A multiplier used to control the cache size
    int32_t mCacheSizeMultiplier { 4 };
+   // Bytes last reported to the budget
+   size_t mMemoryUsage { 0 };
+   // The same bytes, for the memory accounting
+   MemoryAccounting::Charge mCharge { MemoryAccounting::Tag::GraphicsDataCaches };
+   // Clock of the budget for the current lookup
+   uint64_t mBudgetAccess { 0 };
+
+   friend class GraphicsDataCacheBudget;
 
    template <typename CacheElementType>
    friend class GraphicsDataCacheIterator;
@@ -349,6 +450,35 @@ private:
       return InitializeElement(key, static_cast<CacheElementType&>(element));
    }
 
+   size_t ComputeMemoryUsage() const override
+   {
+      size_t usage = 0;
+
+      for (const auto& element : mCache)
+         usage += element->GetMemoryUsage();
+
+      return usage;
+   }
+
+   void ReleaseDisposedElements() override
+   {
+      if (mFreeList.empty())
+         return;
+
+      std::sort(mFreeList.begin(), mFreeList.end());
+
+      mCache.erase(
+         std::remove_if(
+            mCache.begin(), mCache.end(),
+            [this](const auto& element) {
+               return std::binary_search(
+                  mFreeList.begin(), mFreeList.end(), element.get());
+            }),
+         mCache.end());
+
+      mFreeList.clear();
+   }
+
    Initializer mInitializer;
 
    ElementFactory mElementFactory;
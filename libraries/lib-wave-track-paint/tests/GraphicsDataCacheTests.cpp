@@ -117,3 +117,74 @@ TEST_CASE("graphics-data-cache", "")
       CheckCacheElementLookup(cache, info, t0, t1, itemsCount);
    }
 }
+
+namespace
+{
+struct SizedCacheElement : CacheElement
+{
+   SizedCacheElement& operator=(GraphicsDataCacheKey key)
+   {
+      Key = key;
+      return *this;
+   }
+
+   size_t GetMemoryUsage() const noexcept override
+   {
+      return 1000;
+   }
+};
+
+using SizedCache = GraphicsDataCache<SizedCacheElement>;
+
+GraphicsDataCacheKey MakeKey(int index)
+{
+   return { 1.0, index * 1000 };
+}
+} // namespace
+
+TEST_CASE("graphics-data-cache-budget", "")
+{
+   auto& budget = GraphicsDataCacheBudget::Get();
+   const auto oldBudget = budget.GetBudget();
+
+   budget.SetBudget(30 * 1000);
+   budget.ResetCounters();
+
+   const auto initialBytes = budget.GetStatistics().Bytes;
+
+   {
+      SizedCache first(44100, [] { return std::make_unique<SizedCacheElement>(); });
+      SizedCache second(44100, [] { return std::make_unique<SizedCacheElement>(); });
+
+      for (int i = 0; i < 20; ++i)
+         REQUIRE(first.PerformLookup(MakeKey(i)) != nullptr);
+
+      REQUIRE(budget.GetStatistics().Bytes == initialBytes + 20 * 1000);
+      REQUIRE(budget.GetStatistics().Misses == 20);
+
+      // Going over the budget evicts the oldest elements of the first cache
+      for (int i = 0; i < 15; ++i)
+         REQUIRE(second.PerformLookup(MakeKey(i)) != nullptr);
+
+      auto statistics = budget.GetStatistics();
+
+      REQUIRE(statistics.Bytes <= initialBytes + 30 * 1000);
+      REQUIRE(statistics.BudgetEvictions > 0);
+      REQUIRE(statistics.Evictions == 0);
+      REQUIRE(statistics.Hits == 0);
+
+      // The most recent elements remain
+      REQUIRE(first.PerformLookup(MakeKey(19)) != nullptr);
+      REQUIRE(second.PerformLookup(MakeKey(0)) != nullptr);
+      REQUIRE(budget.GetStatistics().Hits == 2);
+
+      // The oldest were evicted, and are created again
+      REQUIRE(first.PerformLookup(MakeKey(0)) != nullptr);
+      REQUIRE(budget.GetStatistics().Misses == 36);
+      REQUIRE(budget.GetStatistics().GetHitRate() == Approx(2.0 / 38));
+   }
+
+   REQUIRE(budget.GetStatistics().Bytes == initialBytes);
+
+   budget.SetBudget(oldBudget);
+}
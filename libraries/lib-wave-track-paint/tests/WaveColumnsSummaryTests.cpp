@@ -0,0 +1,124 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ WaveColumnsSummaryTests.cpp
+
+ **********************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "waveform/WaveColumnsSummary.h"
+
+namespace
+{
+std::vector<float> RandomSamples(size_t count)
+{
+   std::mt19937 engine { 42 };
+   std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+   std::vector<float> samples(count);
+   for (auto& sample : samples)
+      sample = distribution(engine);
+   return samples;
+}
+} // namespace
+
+TEST_CASE("SummarizeLinearColumns", "")
+{
+   SECTION("agrees with the scalar loop")
+   {
+      // Narrow, fractional and wide columns, from several first columns
+      for (const double samplesPerColumn : { 1.0, 1.5, 2.7, 4.0, 7.9, 8.0, 300.3 })
+      {
+         for (const size_t firstColumn : { 0, 1, 3, 13 })
+         {
+            const size_t columnsCount = 61;
+            const auto samples = RandomSamples(
+               GetLinearColumnsSamples(
+                  samplesPerColumn, firstColumn + columnsCount) -
+               GetLinearColumnsSamples(samplesPerColumn, firstColumn));
+
+            std::vector<float> expected(3 * columnsCount);
+            std::vector<float> actual(3 * columnsCount);
+
+            SummarizeLinearColumnsScalar(
+               samples.data(), samplesPerColumn, firstColumn, columnsCount,
+               expected.data());
+            SummarizeLinearColumns(
+               samples.data(), samplesPerColumn, firstColumn, columnsCount,
+               actual.data());
+
+            for (size_t i = 0; i < columnsCount; ++i)
+            {
+               REQUIRE(actual[3 * i] == expected[3 * i]);
+               REQUIRE(actual[3 * i + 1] == expected[3 * i + 1]);
+               REQUIRE(actual[3 * i + 2] == Approx(expected[3 * i + 2]));
+            }
+         }
+      }
+   }
+
+   SECTION("covers the samples rounded per column")
+   {
+      const std::vector<float> samples { 0.5f, -1.0f, 0.25f, 1.0f, 0.0f };
+      std::vector<float> summary(6);
+
+      // Columns 1 and 2 of 2.5 samples: samples [3, 5) and [5, 8) of the
+      // mapping
+      SummarizeLinearColumns(samples.data(), 2.5, 1, 2, summary.data());
+
+      REQUIRE(summary[0] == -1.0f);
+      REQUIRE(summary[1] == 0.5f);
+      REQUIRE(summary[2] == Approx(std::sqrt(1.25 / 2)));
+      REQUIRE(summary[3] == 0.0f);
+      REQUIRE(summary[4] == 1.0f);
+      REQUIRE(summary[5] == Approx(std::sqrt(1.0625 / 3)));
+   }
+}
+
+// Not run by default; select it with the tag
+TEST_CASE("SummarizeLinearColumns benchmark", "[.benchmark]")
+{
+   // Columns of one element of the wave data cache
+   constexpr size_t columnsCount = 256;
+   constexpr int repetitions = 20000;
+
+   using namespace std::chrono;
+
+   for (const double samplesPerColumn : { 1.7, 3.3, 6.1, 40.0, 200.0 })
+   {
+      const auto samples = RandomSamples(
+         GetLinearColumnsSamples(samplesPerColumn, columnsCount));
+      std::vector<float> summary(3 * columnsCount);
+
+      const auto time = [&](auto summarize)
+      {
+         double total = 0;
+         const auto start = steady_clock::now();
+         for (int i = 0; i < repetitions; ++i)
+         {
+            summarize(
+               samples.data(), samplesPerColumn, 0, columnsCount,
+               summary.data());
+            total += summary[2];
+         }
+         const auto elapsed = steady_clock::now() - start;
+         REQUIRE(total > 0);
+         return duration_cast<duration<double, std::micro>>(elapsed).count() /
+                repetitions;
+      };
+
+      const auto scalar = time(SummarizeLinearColumnsScalar);
+      const auto simd = time(SummarizeLinearColumns);
+      WARN(
+         samplesPerColumn << " samples per column, microseconds per element: "
+                          << "scalar " << scalar << ", vector " << simd
+                          << ", speedup " << scalar / simd);
+   }
+}
@@ -0,0 +1,79 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ WaveSummaryPyramidTests.cpp
+
+ **********************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+#include "waveform/WaveSummaryPyramid.h"
+
+namespace
+{
+std::vector<float> MakeBaseLevel(size_t entriesCount)
+{
+   std::vector<float> baseLevel;
+
+   for (size_t entry = 0; entry < entriesCount; ++entry)
+   {
+      const float value = float(entry + 1) / entriesCount;
+      baseLevel.insert(baseLevel.end(), { -value, value, value / 2 });
+   }
+
+   return baseLevel;
+}
+} // namespace
+
+TEST_CASE("WaveSummaryPyramid", "")
+{
+   constexpr auto baseSamples = WaveSummaryPyramid::BaseLevelSamples;
+
+   SECTION("Levels shrink by the level factor down to one entry")
+   {
+      // 17 full entries and a short one
+      const int64_t length = 17 * baseSamples + 100;
+      const WaveSummaryPyramid pyramid { MakeBaseLevel(18), length };
+
+      REQUIRE(pyramid.GetLevelsCount() == 4);
+      REQUIRE(pyramid.GetLevel(0).size() == 18 * 3);
+      REQUIRE(pyramid.GetLevel(1).size() == 5 * 3);
+      REQUIRE(pyramid.GetLevel(2).size() == 2 * 3);
+      REQUIRE(pyramid.GetLevel(3).size() == 1 * 3);
+
+      const auto& top = pyramid.GetLevel(3);
+      REQUIRE(top[0] == Approx(-1.0f));
+      REQUIRE(top[1] == Approx(1.0f));
+
+      // The short last entry weighs little in the RMS of its parent
+      const auto& level1 = pyramid.GetLevel(1);
+      REQUIRE(level1[3 * 4 + 1] == Approx(1.0f));
+      REQUIRE(level1[3 * 4 + 2] == Approx(17.0f / 18 / 2).epsilon(0.01));
+   }
+
+   SECTION("FindLevel picks the coarsest level no wider than a column")
+   {
+      const int64_t length = 64 * baseSamples;
+      const WaveSummaryPyramid pyramid { MakeBaseLevel(64), length };
+
+      REQUIRE(pyramid.GetLevelsCount() == 4);
+      REQUIRE(pyramid.FindLevel(1.0) == 0);
+      REQUIRE(pyramid.FindLevel(baseSamples * 3.9) == 0);
+      REQUIRE(pyramid.FindLevel(baseSamples * 4.0) == 1);
+      REQUIRE(pyramid.FindLevel(baseSamples * 20.0) == 2);
+      REQUIRE(pyramid.FindLevel(baseSamples * 1e6) == 3);
+   }
+
+   SECTION("An empty sequence has one empty level")
+   {
+      const WaveSummaryPyramid pyramid { {}, 0 };
+
+      REQUIRE(pyramid.GetLevelsCount() == 1);
+      REQUIRE(pyramid.GetLevel(0).empty());
+      REQUIRE(pyramid.FindLevel(baseSamples * 1e6) == 0);
+   }
+}
@@ -317,6 +317,11 @@ WaveBitmapCache::~WaveBitmapCache() = default;
 
 WaveBitmapCacheElement::~WaveBitmapCacheElement() = default;
 
+size_t WaveBitmapCacheElement::GetMemoryUsage() const noexcept
+{
+   return sizeof(WaveBitmapCacheElement) + Width() * Height() * 3;
+}
+
 
 WaveBitmapCache&
 WaveBitmapCache::SetPaintParameters(const WavePaintParameters& params)
@@ -34,6 +34,9 @@ public:
    virtual size_t Width() const = 0;
    virtual size_t Height() const = 0;
 
+   //! Counts the bitmap as RGB
+   size_t GetMemoryUsage() const noexcept override;
+
    size_t AvailableColumns { 0 };
 };
 
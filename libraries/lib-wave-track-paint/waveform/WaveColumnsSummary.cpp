@@ -0,0 +1,254 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveColumnsSummary.cpp
+
+**********************************************************************/
+#include "WaveColumnsSummary.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "SampleSummary.h"
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAVE_COLUMNS_SSE2
+#include <emmintrin.h>
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#define WAVE_COLUMNS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+void SummarizeColumnScalar(const float* samples, size_t length, float* dest)
+{
+   float min = samples[0];
+   float max = samples[0];
+   double squaresSum = 0.0;
+
+   for (size_t i = 0; i < length; ++i)
+   {
+      const float sample = samples[i];
+
+      min = std::min(min, sample);
+      max = std::max(max, sample);
+      squaresSum += double(sample) * double(sample);
+   }
+
+   dest[0] = min;
+   dest[1] = max;
+   dest[2] = static_cast<float>(std::sqrt(squaresSum / length));
+}
+
+#if defined(WAVE_COLUMNS_SSE2) || defined(WAVE_COLUMNS_NEON)
+constexpr size_t LanesCount = 4;
+
+//! Summarize four columns of one to a few samples, one in each lane
+/*!
+ Columns of a linear mapping differ in length by at most one sample.  In the
+ last step, lanes of shorter columns repeat their last sample, which does not
+ change the min and max, and is not counted in the sum of squares.
+ */
+void SummarizeNarrowColumns(
+   const float* samples, const size_t* begins, const size_t* lengths,
+   float* dest)
+{
+   const auto minLength = std::min(
+      std::min(lengths[0], lengths[1]), std::min(lengths[2], lengths[3]));
+   const auto maxLength = std::max(
+      std::max(lengths[0], lengths[1]), std::max(lengths[2], lengths[3]));
+
+   const float* lane0 = samples + begins[0];
+   const float* lane1 = samples + begins[1];
+   const float* lane2 = samples + begins[2];
+   const float* lane3 = samples + begins[3];
+
+   alignas(16) float results[3 * LanesCount];
+
+#if defined(WAVE_COLUMNS_SSE2)
+   auto value = _mm_set_ps(lane3[0], lane2[0], lane1[0], lane0[0]);
+   auto min = value, max = value;
+   auto sumsq = _mm_mul_ps(value, value);
+
+   for (size_t i = 1; i < minLength; ++i)
+   {
+      value = _mm_set_ps(lane3[i], lane2[i], lane1[i], lane0[i]);
+      min = _mm_min_ps(min, value);
+      max = _mm_max_ps(max, value);
+      sumsq = _mm_add_ps(sumsq, _mm_mul_ps(value, value));
+   }
+
+   if (maxLength > minLength)
+   {
+      const auto at = [&](const float* lane, size_t length)
+      { return lane[std::min(minLength, length - 1)]; };
+      const auto weight = [&](size_t length)
+      { return length > minLength ? 1.0f : 0.0f; };
+
+      value = _mm_set_ps(
+         at(lane3, lengths[3]), at(lane2, lengths[2]), at(lane1, lengths[1]),
+         at(lane0, lengths[0]));
+      const auto weights = _mm_set_ps(
+         weight(lengths[3]), weight(lengths[2]), weight(lengths[1]),
+         weight(lengths[0]));
+      min = _mm_min_ps(min, value);
+      max = _mm_max_ps(max, value);
+      sumsq = _mm_add_ps(sumsq, _mm_mul_ps(weights, _mm_mul_ps(value, value)));
+   }
+
+   const auto counts = _mm_set_ps(
+      float(lengths[3]), float(lengths[2]), float(lengths[1]),
+      float(lengths[0]));
+
+   _mm_store_ps(results, min);
+   _mm_store_ps(results + LanesCount, max);
+   _mm_store_ps(
+      results + 2 * LanesCount, _mm_sqrt_ps(_mm_div_ps(sumsq, counts)));
+#else
+   alignas(16) float values[LanesCount];
+
+   const auto load = [&](size_t i)
+   {
+      values[0] = lane0[i];
+      values[1] = lane1[i];
+      values[2] = lane2[i];
+      values[3] = lane3[i];
+      return vld1q_f32(values);
+   };
+
+   auto value = load(0);
+   auto min = value, max = value;
+   auto sumsq = vmulq_f32(value, value);
+
+   for (size_t i = 1; i < minLength; ++i)
+   {
+      value = load(i);
+      min = vminq_f32(min, value);
+      max = vmaxq_f32(max, value);
+      sumsq = vmlaq_f32(sumsq, value, value);
+   }
+
+   alignas(16) float weights[LanesCount];
+
+   if (maxLength > minLength)
+   {
+      const float* lanes[] = { lane0, lane1, lane2, lane3 };
+      for (size_t lane = 0; lane < LanesCount; ++lane)
+      {
+         values[lane] =
+            lanes[lane][std::min(minLength, lengths[lane] - 1)];
+         weights[lane] = lengths[lane] > minLength ? 1.0f : 0.0f;
+      }
+      value = vld1q_f32(values);
+      min = vminq_f32(min, value);
+      max = vmaxq_f32(max, value);
+      sumsq = vmlaq_f32(sumsq, vmulq_f32(vld1q_f32(weights), value), value);
+   }
+
+   for (size_t lane = 0; lane < LanesCount; ++lane)
+      weights[lane] = float(lengths[lane]);
+
+   vst1q_f32(results, min);
+   vst1q_f32(results + LanesCount, max);
+   vst1q_f32(
+      results + 2 * LanesCount,
+      vsqrtq_f32(vdivq_f32(sumsq, vld1q_f32(weights))));
+#endif
+
+   for (size_t lane = 0; lane < LanesCount; ++lane, dest += 3)
+   {
+      dest[0] = results[lane];
+      dest[1] = results[LanesCount + lane];
+      dest[2] = results[2 * LanesCount + lane];
+   }
+}
+#endif
+} // namespace
+
+size_t
+GetLinearColumnsSamples(double samplesPerColumn, size_t column) noexcept
+{
+   return static_cast<size_t>(std::round(samplesPerColumn * column));
+}
+
+void SummarizeLinearColumns(
+   const float* samples, double samplesPerColumn, size_t firstColumn,
+   size_t columnsCount, float* dest)
+{
+   assert(samplesPerColumn >= 1);
+
+#if defined(WAVE_COLUMNS_SSE2) || defined(WAVE_COLUMNS_NEON)
+   const auto origin = GetLinearColumnsSamples(samplesPerColumn, firstColumn);
+
+   // Wide columns fill the vectors by themselves
+   if (samplesPerColumn >= 2 * LanesCount)
+   {
+      for (size_t column = 0; column < columnsCount; ++column, dest += 3)
+      {
+         const auto begin =
+            GetLinearColumnsSamples(samplesPerColumn, firstColumn + column);
+         const auto end =
+            GetLinearColumnsSamples(samplesPerColumn, firstColumn + column + 1);
+
+         SummarizeSamples(
+            samples + begin - origin, end - begin, end - begin, dest);
+      }
+
+      return;
+   }
+
+   size_t column = 0;
+   size_t begin  = 0;
+
+   for (; column + LanesCount <= columnsCount; column += LanesCount)
+   {
+      size_t begins[LanesCount];
+      size_t lengths[LanesCount];
+
+      for (size_t lane = 0; lane < LanesCount; ++lane)
+      {
+         const auto end = GetLinearColumnsSamples(
+                             samplesPerColumn, firstColumn + column + lane + 1) -
+                          origin;
+         begins[lane]  = begin;
+         lengths[lane] = end - begin;
+         begin         = end;
+      }
+
+      SummarizeNarrowColumns(samples, begins, lengths, dest + 3 * column);
+   }
+
+   if (column < columnsCount)
+      SummarizeLinearColumnsScalar(
+         samples + begin, samplesPerColumn, firstColumn + column,
+         columnsCount - column, dest + 3 * column);
+#else
+   SummarizeLinearColumnsScalar(
+      samples, samplesPerColumn, firstColumn, columnsCount, dest);
+#endif
+}
+
+void SummarizeLinearColumnsScalar(
+   const float* samples, double samplesPerColumn, size_t firstColumn,
+   size_t columnsCount, float* dest)
+{
+   assert(samplesPerColumn >= 1);
+
+   auto begin = GetLinearColumnsSamples(samplesPerColumn, firstColumn);
+   const auto origin = begin;
+
+   for (size_t column = 0; column < columnsCount; ++column, dest += 3)
+   {
+      const auto end =
+         GetLinearColumnsSamples(samplesPerColumn, firstColumn + column + 1);
+
+      SummarizeColumnScalar(samples + begin - origin, end - begin, dest);
+
+      begin = end;
+   }
+}
@@ -0,0 +1,41 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveColumnsSummary.h
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+
+//! Samples in columns [0, column) of a linear mapping, counted like
+//! WaveDataCache does, from the first column of the mapping
+WAVE_TRACK_PAINT_API size_t
+GetLinearColumnsSamples(double samplesPerColumn, size_t column) noexcept;
+
+//! Write min, max and rms for each of `columnsCount` consecutive columns of
+//! a linear mapping of samples to pixels
+/*!
+ Column `firstColumn + i` covers the samples the linear case of
+ PixelSampleMapper maps to it, rounded like WaveDataCache does, that is
+ `GetLinearColumnsSamples(samplesPerColumn, firstColumn + i)` up to the same
+ for the next column.
+
+ Narrow columns are summarized four at a time, one in each lane of a vector,
+ and wide ones with the vector instructions of SummarizeSamples().
+
+ @pre `samplesPerColumn >= 1`
+ @param samples the first sample of column `firstColumn`
+ @param dest receives three floats for each column
+ */
+WAVE_TRACK_PAINT_API void SummarizeLinearColumns(
+   const float* samples, double samplesPerColumn, size_t firstColumn,
+   size_t columnsCount, float* dest);
+
+//! Same results as SummarizeLinearColumns() (except for rounding of rms)
+//! with no vector instructions
+WAVE_TRACK_PAINT_API void SummarizeLinearColumnsScalar(
+   const float* samples, double samplesPerColumn, size_t firstColumn,
+   size_t columnsCount, float* dest);
@@ -9,19 +9,27 @@
 
 **********************************************************************/
 #include "WaveDataCache.h"
+#include "WaveColumnsSummary.h"
+#include "WaveSummaryPyramid.h"
 #include "FrameStatistics.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstring>
+#include <list>
+#include <unordered_map>
+#include <utility>
 
+#include "BasicUI.h"
 #include "SampleBlock.h"
 #include "SampleFormat.h"
 #include "Sequence.h"
 #include "WaveClip.h"
 
 #include "RoundUpUnsafe.h"
+#include "concurrency/TaskScheduler.h"
 
 namespace
 {
@@ -177,6 +185,56 @@ private:
    size_t mLastProcessedSample { 0 };
 };
 
+bool ReadBlock(
+   const SeqBlock& inputBlock, WaveCacheSampleBlock::Type dataType,
+   WaveCacheSampleBlock& outBlock)
+{
+   outBlock.FirstSample = inputBlock.start.as_long_long();
+   outBlock.NumSamples  = inputBlock.sb->GetSampleCount();
+
+   switch (dataType)
+   {
+   case WaveCacheSampleBlock::Type::Samples:
+   {
+      samplePtr ptr = static_cast<samplePtr>(
+         static_cast<void*>(outBlock.GetWritePointer(outBlock.NumSamples)));
+
+      inputBlock.sb->GetSamples(
+         ptr, floatSample, 0, outBlock.NumSamples, false);
+
+      FrameStatistics::AddCount(
+         FrameStatistics::CounterID::SamplesRead, outBlock.NumSamples);
+   }
+   break;
+   case WaveCacheSampleBlock::Type::MinMaxRMS256:
+   {
+      size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 256);
+
+      float* ptr =
+         static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+
+      inputBlock.sb->GetSummary256(ptr, 0, framesCount);
+   }
+   break;
+   case WaveCacheSampleBlock::Type::MinMaxRMS64k:
+   {
+      size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 64 * 1024);
+
+      float* ptr =
+         static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+
+      inputBlock.sb->GetSummary64k(ptr, 0, framesCount);
+   }
+   break;
+   default:
+      return false;
+   }
+
+   outBlock.DataType = dataType;
+
+   return true;
+}
+
 WaveDataCache::DataProvider
 MakeDefaultDataProvider(const WaveClip& clip, int channelIndex)
 {
@@ -202,61 +260,342 @@ MakeDefaultDataProvider(const WaveClip& clip, int channelIndex)
          return appendBufferHelper.FillBuffer(*clip, outBlock, channelIndex);
       }
 
-      const auto blockIndex  = sequence->FindBlock(requiredSample);
-      const auto& inputBlock = sequence->GetBlockArray()[blockIndex];
+      const auto blockIndex = sequence->FindBlock(requiredSample);
 
-      outBlock.FirstSample = inputBlock.start.as_long_long();
-      outBlock.NumSamples  = inputBlock.sb->GetSampleCount();
+      return ReadBlock(
+         sequence->GetBlockArray()[blockIndex], dataType, outBlock);
+   };
+}
 
-      switch (dataType)
-      {
-      case WaveCacheSampleBlock::Type::Samples:
+//! Provides samples only from the given blocks, which are sorted by start
+WaveDataCache::DataProvider
+MakeBlocksDataProvider(const std::vector<SeqBlock>& blocks)
+{
+   return [&blocks](
+             int64_t requiredSample, WaveCacheSampleBlock::Type dataType,
+             WaveCacheSampleBlock& outBlock)
+   {
+      const auto it = std::upper_bound(
+         blocks.begin(), blocks.end(), requiredSample,
+         [](int64_t sample, const SeqBlock& block)
+         { return sample < block.start.as_long_long(); });
+
+      if (it == blocks.begin())
+         return false;
+
+      const auto& block = *(it - 1);
+
+      if (
+         requiredSample >=
+         block.start.as_long_long() + int64_t(block.sb->GetSampleCount()))
+         return false;
+
+      return ReadBlock(block, dataType, outBlock);
+   };
+}
+
+double GetSamplesPerColumn(
+   const GraphicsDataCacheKey& key, double scaledSampleRate) noexcept
+{
+   return std::max(0.0, scaledSampleRate / key.PixelsPerSecond);
+}
+
+size_t GetElementSamplesCount(
+   const GraphicsDataCacheKey& key, double scaledSampleRate) noexcept
+{
+   return GetSamplesPerColumn(key, scaledSampleRate) *
+          WaveDataCache::CacheElementWidth;
+}
+
+//! Copies the tuples of a level of the pyramid, for samples from `from`
+//! to `to`
+bool FillFromPyramid(
+   const WaveSummaryPyramid& pyramid, size_t level, int64_t from, int64_t to,
+   WaveCacheSampleBlock& outBlock)
+{
+   const auto levelSamples = WaveSummaryPyramid::GetLevelSamples(level);
+   const auto& tuples      = pyramid.GetLevel(level);
+
+   const auto first = size_t(from / levelSamples);
+   const auto last  = std::min(
+      tuples.size() / 3, size_t((to + levelSamples - 1) / levelSamples));
+
+   if (from < 0 || first >= last)
+      return false;
+
+   std::copy(
+      tuples.begin() + 3 * first, tuples.begin() + 3 * last,
+      outBlock.GetWritePointer(3 * (last - first)));
+
+   outBlock.DataType       = WaveCacheSampleBlock::Type::MinMaxRMSPyramid;
+   outBlock.SummarySamples = levelSamples;
+   outBlock.FirstSample    = first * levelSamples;
+   outBlock.NumSamples =
+      std::min<int64_t>(pyramid.GetLength(), last * levelSamples) -
+      outBlock.FirstSample;
+
+   return true;
+}
+
+//! Fills the columns from the minimum, maximum and RMS of the whole blocks
+//! that they overlap, which need no reading of samples or summaries
+void FillPlaceholder(
+   const GraphicsDataCacheKey& key, double scaledSampleRate,
+   const std::vector<SeqBlock>& blocks, int64_t sequenceLength,
+   WaveCacheElement& element)
+{
+   const auto samplesPerColumn = GetSamplesPerColumn(key, scaledSampleRate);
+
+   auto block = blocks.begin();
+   size_t columnIndex = 0;
+
+   for (; columnIndex < WaveDataCache::CacheElementWidth; ++columnIndex)
+   {
+      const int64_t from =
+         key.FirstSample + int64_t(std::round(samplesPerColumn * columnIndex));
+
+      if (from >= sequenceLength)
+         break;
+
+      const int64_t to = std::max(
+         from + 1,
+         std::min(
+            sequenceLength,
+            key.FirstSample +
+               int64_t(std::round(samplesPerColumn * (columnIndex + 1)))));
+
+      while (block + 1 != blocks.end() &&
+             (block + 1)->start.as_long_long() <= from)
+         ++block;
+
+      float min = std::numeric_limits<float>::infinity();
+      float max = -std::numeric_limits<float>::infinity();
+      double squaresSum = 0.0;
+      size_t samplesCount = 0;
+
+      for (auto it = block;
+           it != blocks.end() && it->start.as_long_long() < to; ++it)
       {
-         samplePtr ptr = static_cast<samplePtr>(
-            static_cast<void*>(outBlock.GetWritePointer(outBlock.NumSamples)));
+         const auto summary = it->sb->GetMinMaxRMS(false);
+         const auto blockSamples = it->sb->GetSampleCount();
 
-         inputBlock.sb->GetSamples(
-            ptr, floatSample, 0, outBlock.NumSamples, false);
+         min = std::min(min, summary.min);
+         max = std::max(max, summary.max);
+         squaresSum += double(summary.RMS) * summary.RMS * blockSamples;
+         samplesCount += blockSamples;
       }
-      break;
-      case WaveCacheSampleBlock::Type::MinMaxRMS256:
+
+      if (samplesCount == 0)
+         break;
+
+      element.Data[columnIndex] = {
+         min, max, static_cast<float>(std::sqrt(squaresSum / samplesCount))
+      };
+   }
+
+   element.AvailableColumns = columnIndex;
+   element.IsComplete       = false;
+   element.ReadSamples      = 0;
+}
+
+} // namespace
+
+namespace
+{
+//! Identifies the columns of an element by the sample blocks under it, which
+//! are immutable, so that elements of clips sharing the blocks share columns
+struct WaveColumnsContent final
+{
+   double SamplesPerColumn {};
+   //! Ids of the blocks, with their starts relative to the first sample of
+   //! the element
+   std::vector<std::pair<int64_t, int64_t>> Blocks;
+
+   bool operator==(const WaveColumnsContent& other) const noexcept
+   {
+      return SamplesPerColumn == other.SamplesPerColumn &&
+             Blocks == other.Blocks;
+   }
+
+   uint64_t GetHash() const noexcept
+   {
+      // FNV-1a
+      uint64_t hash = 14695981039346656037ull;
+
+      const auto mix = [&hash](uint64_t value)
       {
-         size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 256);
+         for (int byte = 0; byte < 8; ++byte)
+         {
+            hash ^= (value >> (8 * byte)) & 0xFF;
+            hash *= 1099511628211ull;
+         }
+      };
+
+      uint64_t samplesPerColumn;
+      static_assert(sizeof(samplesPerColumn) == sizeof(SamplesPerColumn));
+      std::memcpy(&samplesPerColumn, &SamplesPerColumn, sizeof(samplesPerColumn));
 
-         float* ptr =
-            static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+      mix(samplesPerColumn);
 
-         inputBlock.sb->GetSummary256(ptr, 0, framesCount);
+      for (const auto& [id, start] : Blocks)
+      {
+         mix(id);
+         mix(start);
       }
-      break;
-      case WaveCacheSampleBlock::Type::MinMaxRMS64k:
+
+      return hash;
+   }
+};
+} // namespace
+
+//! One read of the columns of an element, shared by the elements of all
+//! clips over the same blocks
+/*!
+ A read in worker threads owns copies of the entries of the block array,
+ which share the sample blocks, so the worker never touches the clip.  The
+ last reference to it is always released in the main thread, which may
+ release the last reference to a block.
+ */
+struct WaveCacheBackgroundRead final
+{
+   GraphicsDataCacheKey Key;
+   double ScaledSampleRate {};
+   WaveColumnsContent Content;
+   //! Released in the main thread when the read finishes
+   std::vector<SeqBlock> Blocks;
+   //! Accessed only in the main thread
+   std::function<void()> OnColumnsReady;
+   //! Elements awaiting the read; accessed only in the main thread
+   size_t Awaiters { 0 };
+
+   //! Written only by the worker, and read only after Finished is set
+   WaveCacheElement::Columns Data;
+   size_t AvailableColumns { 0 };
+   size_t ProcessedSamples { 0 };
+   bool Failed { false };
+
+   std::atomic<bool> Finished { false };
+   std::atomic<bool> Cancelled { false };
+};
+
+namespace
+{
+//! Reads of columns from sample blocks, finished or not, for all clips
+/*!
+ Duplicated and pasted clips share sample blocks, so their caches find the
+ columns here instead of reading the blocks again.  Only the least recently
+ used reads are kept; accessed only in the main thread.
+ */
+class WaveColumnsStore final
+{
+public:
+   static WaveColumnsStore& Get()
+   {
+      static WaveColumnsStore store;
+      return store;
+   }
+
+   std::shared_ptr<WaveCacheBackgroundRead>
+   Find(const WaveColumnsContent& content)
+   {
+      const auto [first, last] = mIndex.equal_range(content.GetHash());
+
+      for (auto it = first; it != last; ++it)
       {
-         size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 64 * 1024);
+         auto pRead = *it->second;
+
+         // Let failed and cancelled reads be tried again
+         if (
+            pRead->Cancelled ||
+            (pRead->Finished &&
+             (pRead->Failed || pRead->ProcessedSamples == 0)) ||
+            !(pRead->Content == content))
+            continue;
 
-         float* ptr =
-            static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+         mReads.splice(mReads.begin(), mReads, it->second);
 
-         inputBlock.sb->GetSummary64k(ptr, 0, framesCount);
+         return pRead;
       }
-      break;
-      default:
-         return false;
+
+      return {};
+   }
+
+   void Add(std::shared_ptr<WaveCacheBackgroundRead> pRead)
+   {
+      mReads.push_front(std::move(pRead));
+      mIndex.emplace(mReads.front()->Content.GetHash(), mReads.begin());
+
+      while (mReads.size() > Capacity)
+      {
+         const auto last = std::prev(mReads.end());
+         const auto [first, end] =
+            mIndex.equal_range((*last)->Content.GetHash());
+
+         for (auto it = first; it != end; ++it)
+         {
+            if (it->second == last)
+            {
+               mIndex.erase(it);
+               break;
+            }
+         }
+
+         mReads.erase(last);
       }
+   }
 
-      outBlock.DataType = dataType;
+private:
+   //! About 3 MB of columns
+   static constexpr size_t Capacity = 1024;
 
-      return true;
-   };
-}
+   //! Most recently used first
+   using Reads = std::list<std::shared_ptr<WaveCacheBackgroundRead>>;
+
+   Reads mReads;
+   std::unordered_multimap<uint64_t, Reads::iterator> mIndex;
+};
 
+//! Copies the columns of a finished read into the element
+void AdoptColumns(
+   const WaveCacheBackgroundRead& read, const GraphicsDataCacheKey& key,
+   double scaledSampleRate, WaveCacheElement& element)
+{
+   element.Data             = read.Data;
+   element.AvailableColumns = read.AvailableColumns;
+   element.ReadSamples      = 0;
+   element.IsComplete       = read.ProcessedSamples ==
+                        GetElementSamplesCount(key, scaledSampleRate);
+}
 } // namespace
 
+//! State of a build of the pyramid in a worker thread
+/*!
+ Like WaveCacheBackgroundRead, it owns copies of the block array entries and
+ is released only in the main thread
+ */
+struct WaveCachePyramidBuild final
+{
+   std::vector<SeqBlock> Blocks;
+   uint64_t Fingerprint {};
+   //! Whose block summaries may be reused
+   std::shared_ptr<const WaveSummaryPyramid> Previous;
+   //! Accessed only in the main thread
+   std::function<void()> OnColumnsReady;
+
+   //! Written only by the worker, and read only after Finished is set
+   std::shared_ptr<const WaveSummaryPyramid> Result;
+
+   std::atomic<bool> Finished { false };
+   std::atomic<bool> Cancelled { false };
+};
+
 WaveDataCache::WaveDataCache(const WaveClip& waveClip, int channelIndex)
     : GraphicsDataCache<WaveCacheElement>(
          waveClip.GetRate() / waveClip.GetStretchRatio(),
          [] { return std::make_unique<WaveCacheElement>(); })
     , mProvider { MakeDefaultDataProvider(waveClip, channelIndex) }
     , mWaveClip { waveClip }
+    , mChannelIndex { channelIndex }
     , mStretchChangedSubscription {
        const_cast<WaveClip&>(waveClip)
           .Observer::Publisher<StretchRatioChange>::Subscribe(
@@ -268,36 +607,416 @@ WaveDataCache::WaveDataCache(const WaveClip& waveClip, int channelIndex)
 {
 }
 
+WaveDataCache::~WaveDataCache()
+{
+   if (mpPyramidBuild)
+   {
+      mpPyramidBuild->Cancelled      = true;
+      mpPyramidBuild->OnColumnsReady = nullptr;
+   }
+}
+
+void WaveDataCache::SetReadInBackground(std::function<void()> onColumnsReady)
+{
+   const bool changed = bool(onColumnsReady) != bool(mOnColumnsReady);
+
+   mOnColumnsReady = std::move(onColumnsReady);
+
+   if (changed)
+      Invalidate();
+}
+
 bool WaveDataCache::InitializeElement(
    const GraphicsDataCacheKey& key, WaveCacheElement& element)
 {
+   if (const auto pRead = element.PendingRead)
+   {
+      // Keep the placeholder until the read finishes
+      if (!pRead->Finished)
+         return true;
+
+      element.PendingRead.reset();
+
+      // On failure, keep the placeholder rather than read at every lookup
+      if (pRead->Failed || pRead->ProcessedSamples == 0)
+         return true;
+
+      AdoptColumns(*pRead, key, GetScaledSampleRate(), element);
+
+      return true;
+   }
+
+   // Columns that the pyramid can supply need no reading of blocks
+   const auto pyramid =
+      GetSamplesPerColumn(key, GetScaledSampleRate()) >=
+            WaveSummaryPyramid::BaseLevelSamples ?
+         GetPyramid() :
+         nullptr;
+
+   const auto& sequence = *mWaveClip.GetSequence(mChannelIndex);
+   const auto sequenceLength = sequence.GetNumSamples().as_long_long();
+
+   // Columns read from the blocks may be shared with other clips
+   std::shared_ptr<WaveCacheBackgroundRead> pShared;
+
+   if (pyramid == nullptr)
+   {
+      const int64_t first = key.FirstSample;
+      const int64_t last =
+         first + GetElementSamplesCount(key, GetScaledSampleRate());
+
+      // The append buffer changes while recording and belongs to this clip
+      if (
+         first >= 0 && first < sequenceLength &&
+         !(last > sequenceLength &&
+           mWaveClip.GetAppendBufferLen(mChannelIndex) > 0))
+      {
+         pShared = std::make_shared<WaveCacheBackgroundRead>();
+
+         pShared->Key              = key;
+         pShared->ScaledSampleRate = GetScaledSampleRate();
+         pShared->Content.SamplesPerColumn =
+            GetSamplesPerColumn(key, GetScaledSampleRate());
+
+         const auto& blocks = sequence.GetBlockArray();
+
+         for (size_t blockIndex = sequence.FindBlock(first);
+              blockIndex < blocks.size() &&
+              blocks[blockIndex].start.as_long_long() < last;
+              ++blockIndex)
+         {
+            const auto& block = blocks[blockIndex];
+
+            pShared->Blocks.push_back(block);
+            pShared->Content.Blocks.emplace_back(
+               block.sb->GetBlockID(), block.start.as_long_long() - first);
+         }
+
+         if (auto pRead = WaveColumnsStore::Get().Find(pShared->Content))
+         {
+            if (pRead->Finished)
+            {
+               AdoptColumns(*pRead, key, GetScaledSampleRate(), element);
+
+               return true;
+            }
+
+            if (mOnColumnsReady)
+            {
+               FillPlaceholder(
+                  key, GetScaledSampleRate(), pShared->Blocks, sequenceLength,
+                  element);
+
+               if (!pRead->OnColumnsReady)
+                  pRead->OnColumnsReady = mOnColumnsReady;
+
+               ++pRead->Awaiters;
+               element.PendingRead        = pRead;
+               element.ReadSequenceLength = sequenceLength;
+
+               return true;
+            }
+         }
+      }
+   }
+
+   if (mOnColumnsReady && pyramid == nullptr)
+   {
+      // An element that ends with its clip stays incomplete; don't read it
+      // again unless the sequence grew
+      if (element.ReadSequenceLength == sequenceLength)
+         return true;
+
+      if (pShared)
+      {
+         FillPlaceholder(
+            key, GetScaledSampleRate(), pShared->Blocks, sequenceLength,
+            element);
+
+         ReadInBackground(pShared);
+
+         element.PendingRead        = pShared;
+         element.ReadSequenceLength = sequenceLength;
+
+         return true;
+      }
+   }
+
    auto sw = FrameStatistics::CreateStopwatch(
       FrameStatistics::SectionID::WaveDataCache);
 
-   element.AvailableColumns = 0;
+   // While the clip grows only the last column, which may have been short,
+   // and the new ones need reading
+   const size_t firstColumn =
+      pyramid == nullptr && element.ReadSamples > 0 &&
+            element.AvailableColumns > 0 ?
+         element.AvailableColumns - 1 :
+         0;
+
+   const auto processedSamples = ReadColumns(
+      key, GetScaledSampleRate(), mProvider, pyramid, mCachedBlock,
+      element.Data, element.AvailableColumns, firstColumn);
+
+   element.IsComplete =
+      processedSamples == GetElementSamplesCount(key, GetScaledSampleRate());
+   element.ReadSamples = processedSamples;
+
+   if (pShared && processedSamples != 0)
+   {
+      pShared->Blocks.clear();
+      pShared->Data             = element.Data;
+      pShared->AvailableColumns = element.AvailableColumns;
+      pShared->ProcessedSamples = processedSamples;
+      pShared->Finished         = true;
+
+      WaveColumnsStore::Get().Add(std::move(pShared));
+   }
+
+   return processedSamples != 0;
+}
+
+void WaveDataCache::ReadInBackground(
+   std::shared_ptr<WaveCacheBackgroundRead> pRead)
+{
+   pRead->OnColumnsReady = mOnColumnsReady;
+   pRead->Awaiters       = 1;
+
+   WaveColumnsStore::Get().Add(pRead);
+
+   audacity::concurrency::TaskScheduler::Get().Submit(
+      [pRead = std::move(pRead)]() mutable
+      {
+         if (!pRead->Cancelled)
+         {
+            try
+            {
+               WaveCacheSampleBlock cachedBlock;
+
+               pRead->ProcessedSamples = ReadColumns(
+                  pRead->Key, pRead->ScaledSampleRate,
+                  MakeBlocksDataProvider(pRead->Blocks), nullptr,
+                  cachedBlock, pRead->Data, pRead->AvailableColumns);
+            }
+            catch (...)
+            {
+               pRead->Failed = true;
+            }
+         }
+
+         pRead->Finished = true;
+
+         // Release the read, and its blocks, in the main thread
+         BasicUI::CallAfter(
+            [pRead = std::move(pRead)]
+            {
+               pRead->Blocks.clear();
+
+               if (!pRead->Cancelled && pRead->OnColumnsReady)
+                  pRead->OnColumnsReady();
+            });
+      });
+}
+
+const WaveSummaryPyramid* WaveDataCache::GetPyramid()
+{
+   const auto& blocks =
+      mWaveClip.GetSequence(mChannelIndex)->GetBlockArray();
+   const auto fingerprint = WaveSummaryPyramid::GetFingerprint(blocks);
+
+   if (mpPyramidBuild && mpPyramidBuild->Finished)
+   {
+      if (mpPyramidBuild->Result)
+         mpPyramid = mpPyramidBuild->Result;
+
+      mpPyramidBuild.reset();
+   }
+
+   if (mpPyramid && mpPyramid->GetFingerprint() == fingerprint)
+      return mpPyramid.get();
+
+   if (!mOnColumnsReady)
+   {
+      mpPyramid = WaveSummaryPyramid::Build(blocks, mpPyramid.get());
+      return mpPyramid.get();
+   }
+
+   if (mpPyramidBuild && mpPyramidBuild->Fingerprint == fingerprint)
+      return nullptr;
+
+   if (mpPyramidBuild)
+      mpPyramidBuild->Cancelled = true;
+
+   auto pBuild = std::make_shared<WaveCachePyramidBuild>();
+
+   pBuild->Blocks         = blocks;
+   pBuild->Fingerprint    = fingerprint;
+   pBuild->Previous       = mpPyramid;
+   pBuild->OnColumnsReady = mOnColumnsReady;
+
+   mpPyramidBuild = pBuild;
+
+   audacity::concurrency::TaskScheduler::Get().Submit(
+      [pBuild]() mutable
+      {
+         try
+         {
+            pBuild->Result = WaveSummaryPyramid::Build(
+               pBuild->Blocks, pBuild->Previous.get(), &pBuild->Cancelled);
+         }
+         catch (...)
+         {
+            // Columns are read from the blocks instead
+         }
+
+         pBuild->Finished = true;
+
+         // Release the build in the main thread
+         BasicUI::CallAfter(
+            [pBuild = std::move(pBuild)]
+            {
+               if (!pBuild->Cancelled && pBuild->OnColumnsReady)
+                  pBuild->OnColumnsReady();
+            });
+      });
+
+   return nullptr;
+}
+
+namespace
+{
+//! Close the gap between a column and the one before, so that the waveform
+//! is drawn connected
+void ConnectToPreviousColumn(
+   WaveCacheElement::Columns& columns, size_t columnIndex) noexcept
+{
+   if (columnIndex == 0)
+      return;
+
+   const auto prevColumn = columns[columnIndex - 1];
+   auto& column = columns[columnIndex];
+
+   bool updated = false;
+
+   if (prevColumn.min > column.max)
+   {
+      column.max = prevColumn.min;
+      updated    = true;
+   }
+
+   if (prevColumn.max < column.min)
+   {
+      column.min = prevColumn.max;
+      updated    = true;
+   }
+
+   if (updated)
+      column.rms = std::clamp(column.rms, column.min, column.max);
+}
+} // namespace
+
+size_t WaveDataCache::ReadColumns(
+   const GraphicsDataCacheKey& key, double scaledSampleRate,
+   const DataProvider& provider, const WaveSummaryPyramid* pyramid,
+   WaveCacheSampleBlock& cachedBlock, WaveCacheElement::Columns& columns,
+   size_t& availableColumns, size_t firstColumn)
+{
+   availableColumns = 0;
+
+   const auto samplesPerColumn = GetSamplesPerColumn(key, scaledSampleRate);
 
-   int64_t firstSample = key.FirstSample;
+   const auto skippedSamples =
+      static_cast<size_t>(std::round(samplesPerColumn * firstColumn));
 
-   const auto samplesPerColumn =
-      std::max(0.0, GetScaledSampleRate() / key.PixelsPerSecond);
+   int64_t firstSample = key.FirstSample + skippedSamples;
 
-   const size_t elementSamplesCount =
-      samplesPerColumn * WaveDataCache::CacheElementWidth;
-   size_t processedSamples = 0;
+   size_t processedSamples = skippedSamples;
 
-   const WaveCacheSampleBlock::Type blockType =
+   const WaveCacheSampleBlock::Type providerType =
       samplesPerColumn >= 64 * 1024 ?
          WaveCacheSampleBlock::Type::MinMaxRMS64k :
          (samplesPerColumn >= 256 ? WaveCacheSampleBlock::Type::MinMaxRMS256 :
                                     WaveCacheSampleBlock::Type::Samples);
 
-   if (blockType != mCachedBlock.DataType)
-      mCachedBlock.Reset();
+   if (samplesPerColumn < WaveSummaryPyramid::BaseLevelSamples)
+      pyramid = nullptr;
 
-   size_t columnIndex = 0;
+   // Samples past the end of the pyramid, in the append buffer, still come
+   // from the provider
+   const auto pyramidLevel =
+      pyramid != nullptr ? pyramid->FindLevel(samplesPerColumn) : 0;
+   const auto pyramidLength = pyramid != nullptr ? pyramid->GetLength() : 0;
+   const int64_t lastSample =
+      firstSample + GetElementSamplesCount(key, scaledSampleRate);
+
+   const auto blockType = pyramid != nullptr ?
+                             WaveCacheSampleBlock::Type::MinMaxRMSPyramid :
+                             providerType;
+
+   if (
+      blockType != cachedBlock.DataType ||
+      (pyramid != nullptr &&
+       cachedBlock.SummarySamples !=
+          WaveSummaryPyramid::GetLevelSamples(pyramidLevel)))
+      cachedBlock.Reset();
+
+   // Whole columns of loaded samples are summarized together
+   const bool summarizeLinearColumns =
+      blockType == WaveCacheSampleBlock::Type::Samples &&
+      samplesPerColumn >= 1;
+
+   size_t columnIndex = firstColumn;
 
    for (; columnIndex < WaveDataCache::CacheElementWidth; ++columnIndex)
    {
+      if (
+         summarizeLinearColumns &&
+         cachedBlock.DataType == WaveCacheSampleBlock::Type::Samples &&
+         cachedBlock.ContainsSample(firstSample))
+      {
+         const auto origin =
+            GetLinearColumnsSamples(samplesPerColumn, columnIndex);
+         const auto loadedSamples = static_cast<size_t>(
+            cachedBlock.FirstSample + cachedBlock.NumSamples - firstSample);
+
+         size_t columnsCount = 0;
+
+         while (columnIndex + columnsCount < WaveDataCache::CacheElementWidth &&
+                GetLinearColumnsSamples(
+                   samplesPerColumn, columnIndex + columnsCount + 1) -
+                      origin <=
+                   loadedSamples)
+            ++columnsCount;
+
+         if (columnsCount > 0)
+         {
+            float summaries[3 * WaveDataCache::CacheElementWidth];
+
+            SummarizeLinearColumns(
+               cachedBlock.mData.data() + (firstSample - cachedBlock.FirstSample),
+               samplesPerColumn, columnIndex, columnsCount, summaries);
+
+            for (size_t i = 0; i < columnsCount; ++i, ++columnIndex)
+            {
+               auto& column = columns[columnIndex];
+
+               column.min = summaries[3 * i];
+               column.max = summaries[3 * i + 1];
+               column.rms = summaries[3 * i + 2];
+
+               ConnectToPreviousColumn(columns, columnIndex);
+            }
+
+            const auto samplesCount =
+               GetLinearColumnsSamples(samplesPerColumn, columnIndex) - origin;
+
+            firstSample += samplesCount;
+            processedSamples += samplesCount;
+
+            if (columnIndex == WaveDataCache::CacheElementWidth)
+               break;
+         }
+      }
+
       WaveCacheSampleBlock::Summary summary;
 
       auto samplesLeft =
@@ -305,11 +1024,20 @@ bool WaveDataCache::InitializeElement(
 
       while (samplesLeft != 0)
       {
-         if (!mCachedBlock.ContainsSample(firstSample))
-            if (!mProvider(firstSample, blockType, mCachedBlock))
+         if (!cachedBlock.ContainsSample(firstSample))
+         {
+            const bool filled =
+               firstSample < pyramidLength ?
+                  FillFromPyramid(
+                     *pyramid, pyramidLevel, firstSample, lastSample,
+                     cachedBlock) :
+                  provider(firstSample, providerType, cachedBlock);
+
+            if (!filled)
                break;
+         }
 
-         summary = mCachedBlock.GetSummary(firstSample, samplesLeft, summary);
+         summary = cachedBlock.GetSummary(firstSample, samplesLeft, summary);
          if(summary.SamplesCount == 0)
             break;
 
@@ -320,7 +1048,7 @@ bool WaveDataCache::InitializeElement(
 
       if (summary.SamplesCount > 0)
       {
-         auto& column = element.Data[columnIndex];
+         auto& column = columns[columnIndex];
 
          column.min = summary.Min;
          column.max = summary.Max;
@@ -328,28 +1056,7 @@ bool WaveDataCache::InitializeElement(
          column.rms = std::sqrt(summary.SquaresSum / summary.SumItemsCount);
       }
 
-      if (columnIndex > 0)
-      {
-         const auto prevColumn = element.Data[columnIndex - 1];
-         auto& column = element.Data[columnIndex];
-
-         bool updated = false;
-
-         if (prevColumn.min > column.max)
-         {
-            column.max = prevColumn.min;
-            updated    = true;
-         }
-
-         if (prevColumn.max < column.min)
-         {
-            column.min = prevColumn.max;
-            updated    = true;
-         }
-
-         if (updated)
-            column.rms = std::clamp(column.rms, column.min, column.max);
-      }
+      ConnectToPreviousColumn(columns, columnIndex);
 
       if (samplesLeft != 0)
       {
@@ -358,10 +1065,9 @@ bool WaveDataCache::InitializeElement(
       }
    }
 
-   element.AvailableColumns = columnIndex;
-   element.IsComplete       = processedSamples == elementSamplesCount;
+   availableColumns = columnIndex;
 
-   return processedSamples != 0;
+   return processedSamples;
 }
 
 bool WaveCacheSampleBlock::ContainsSample(int64_t sampleIndex) const noexcept
@@ -384,9 +1090,8 @@ void WaveCacheSampleBlock::Reset() noexcept
 
 namespace
 {
-template<size_t blockSize>
 void processBlock(
-   const float* input, int64_t from, size_t count,
+   const float* input, int64_t from, size_t count, size_t blockSize,
    WaveCacheSampleBlock::Summary& summary)
 {
    input = input + 3 * (from / blockSize);
@@ -451,10 +1156,13 @@ WaveCacheSampleBlock::Summary WaveCacheSampleBlock::GetSummary(
 
       break;
    case WaveCacheSampleBlock::Type::MinMaxRMS256:
-      processBlock<256>(data, from, samplesCount, summary);
+      processBlock(data, from, samplesCount, 256, summary);
       break;
    case WaveCacheSampleBlock::Type::MinMaxRMS64k:
-      processBlock<64 * 1024>(data, from, samplesCount, summary);
+      processBlock(data, from, samplesCount, 64 * 1024, summary);
+      break;
+   case WaveCacheSampleBlock::Type::MinMaxRMSPyramid:
+      processBlock(data, from, samplesCount, SummarySamples, summary);
       break;
    default:
       break;
@@ -463,6 +1171,29 @@ WaveCacheSampleBlock::Summary WaveCacheSampleBlock::GetSummary(
    return summary;
 }
 
+void WaveCacheElement::Dispose()
+{
+   if (PendingRead)
+   {
+      // Other clips may still await the shared read
+      if (--PendingRead->Awaiters == 0)
+      {
+         PendingRead->Cancelled      = true;
+         PendingRead->OnColumnsReady = nullptr;
+      }
+
+      PendingRead.reset();
+   }
+
+   ReadSequenceLength = -1;
+   ReadSamples        = 0;
+}
+
+size_t WaveCacheElement::GetMemoryUsage() const noexcept
+{
+   return sizeof(WaveCacheElement);
+}
+
 void WaveCacheElement::Smooth(GraphicsDataCacheElementBase* prevElement)
 {
    if (prevElement == nullptr||prevElement->AwaitsEviction || AvailableColumns == 0)
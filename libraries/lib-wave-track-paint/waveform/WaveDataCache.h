@@ -15,12 +15,16 @@
 #include <numeric>
 #include <vector>
 #include <functional>
+#include <memory>
 
 #include "GraphicsDataCache.h"
 #include "WaveData.h"
 #include "Observer.h"
 
 class WaveClip;
+class WaveSummaryPyramid;
+struct WaveCacheBackgroundRead;
+struct WaveCachePyramidBuild;
 
 //! Helper structure used to transfer the data between the data and graphics layers
 struct WAVE_TRACK_PAINT_API WaveCacheSampleBlock final
@@ -40,6 +44,12 @@ struct WAVE_TRACK_PAINT_API WaveCacheSampleBlock final
        * calculated over 256 samples.
        */
       MinMaxRMS64k,
+      /*!
+       * Each element of the resulting array is a tuple (min, max, rms)
+       * calculated over SummarySamples samples, from a level of
+       * WaveSummaryPyramid.
+       */
+      MinMaxRMSPyramid,
    };
 
    //! Summary calculated over the requested range
@@ -58,6 +68,8 @@ struct WAVE_TRACK_PAINT_API WaveCacheSampleBlock final
    Type DataType { Type::Samples };
    int64_t FirstSample { 0 };
    size_t NumSamples { 0 };
+   //! Samples in each tuple, when DataType is MinMaxRMSPyramid
+   size_t SummarySamples { 0 };
 
    //! Checks if sample is in the range represented by this block
    bool ContainsSample(int64_t sampleIndex) const noexcept;
@@ -85,10 +97,26 @@ struct WAVE_TRACK_PAINT_API WaveCacheElement final : GraphicsDataCacheElementBas
    Columns Data;
    size_t AvailableColumns { 0 };
 
+   //! Read in worker threads that the element awaits, if any
+   std::shared_ptr<WaveCacheBackgroundRead> PendingRead;
+   //! Length of the sequence when the columns were last read in the
+   //! background, or -1
+   int64_t ReadSequenceLength { -1 };
+   //! Samples summarized by the columns when they were last read at once,
+   //! from which the read resumes while the clip grows, or 0
+   size_t ReadSamples { 0 };
+
+   //! Cancels the pending read
+   void Dispose() override;
    void Smooth(GraphicsDataCacheElementBase* prevElement) override;
+   size_t GetMemoryUsage() const noexcept override;
 };
 
 //! Cache that contains the waveform data
+/*!
+ Columns read from sample blocks are shared with the caches of other clips
+ over the same blocks, at the same zoom
+ */
 class WAVE_TRACK_PAINT_API WaveDataCache final :
     public GraphicsDataCache<WaveCacheElement>
 {
@@ -96,15 +124,59 @@ public:
    using DataProvider = std::function<bool (int64_t requiredSample, WaveCacheSampleBlock::Type dataType, WaveCacheSampleBlock& block)>;
 
    WaveDataCache(const WaveClip& waveClip, int channelIndex);
+   //! Cancels reads in worker threads
+   ~WaveDataCache() override;
+
+   //! Read the samples of elements not yet cached in worker threads, instead
+   //! of while looking them up
+   /*!
+    Until its read finishes, an element holds a coarser placeholder, made
+    from the minimum, maximum and RMS of whole sample blocks, and is not
+    complete.  Elements that reach into the append buffer are still read
+    at once.
+
+    @param onColumnsReady called in the main thread when the next lookup can
+    find more columns; if empty, all reads happen during lookups
+    */
+   void SetReadInBackground(std::function<void()> onColumnsReady);
 
 private:
    bool InitializeElement(
       const GraphicsDataCacheKey& key, WaveCacheElement& element) override;
 
+   //! Queue the read in worker threads, and share it with other clips
+   void ReadInBackground(std::shared_ptr<WaveCacheBackgroundRead> pRead);
+
+   //! The pyramid of the sequence, if it is up to date
+   /*!
+    Otherwise builds it, at once, or in worker threads if reading in the
+    background, and then returns null until it is ready
+    */
+   const WaveSummaryPyramid* GetPyramid();
+
+   //! Compute the columns for key, from samples the provider fetches
+   /*!
+    @param pyramid if not null, supplies the summaries of the sequence when
+    columns are at least WaveSummaryPyramid::BaseLevelSamples wide
+    @param firstColumn columns before it are kept as they are
+    @return how many samples were summarized, including those of the kept
+    columns
+    */
+   static size_t ReadColumns(
+      const GraphicsDataCacheKey& key, double scaledSampleRate,
+      const DataProvider& provider, const WaveSummaryPyramid* pyramid,
+      WaveCacheSampleBlock& cachedBlock, WaveCacheElement::Columns& columns,
+      size_t& availableColumns, size_t firstColumn = 0);
+
    DataProvider mProvider;
+   std::function<void()> mOnColumnsReady;
+
+   std::shared_ptr<const WaveSummaryPyramid> mpPyramid;
+   std::shared_ptr<WaveCachePyramidBuild> mpPyramidBuild;
 
    WaveCacheSampleBlock mCachedBlock;
 
    const WaveClip& mWaveClip;
+   const int mChannelIndex;
    Observer::Subscription mStretchChangedSubscription;
 };
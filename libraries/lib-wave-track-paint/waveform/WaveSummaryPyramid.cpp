@@ -0,0 +1,244 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveSummaryPyramid.cpp
+
+**********************************************************************/
+#include "WaveSummaryPyramid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "SampleBlock.h"
+#include "Sequence.h"
+
+namespace
+{
+size_t GetEntriesCount(int64_t length, size_t entrySamples) noexcept
+{
+   return length <= 0 ? 0 : (length + entrySamples - 1) / entrySamples;
+}
+
+//! Samples summarized by the entry, which is shorter at the end
+double GetEntryWeight(
+   int64_t length, size_t entrySamples, size_t entryIndex) noexcept
+{
+   return std::min<int64_t>(entrySamples, length - entryIndex * entrySamples);
+}
+} // namespace
+
+std::shared_ptr<const WaveSummaryPyramid> WaveSummaryPyramid::Build(
+   const std::vector<SeqBlock>& blocks, const WaveSummaryPyramid* previous,
+   const std::atomic<bool>* cancelled)
+{
+   int64_t length = 0;
+
+   if (!blocks.empty())
+      length = blocks.back().start.as_long_long() +
+               blocks.back().sb->GetSampleCount();
+
+   const auto entriesCount = GetEntriesCount(length, BaseLevelSamples);
+
+   std::vector<float> minimums(
+      entriesCount, std::numeric_limits<float>::infinity());
+   std::vector<float> maximums(
+      entriesCount, -std::numeric_limits<float>::infinity());
+   std::vector<double> squaresSums(entriesCount);
+   std::vector<double> counts(entriesCount);
+
+   std::unordered_map<int64_t, std::vector<float>> blockSummaries;
+   blockSummaries.reserve(blocks.size());
+
+   for (const auto& block : blocks)
+   {
+      if (cancelled != nullptr && *cancelled)
+         return {};
+
+      const auto blockID      = block.sb->GetBlockID();
+      const auto blockSamples = block.sb->GetSampleCount();
+      const auto framesCount  = GetEntriesCount(blockSamples, BaseLevelSamples);
+
+      auto& summary = blockSummaries[blockID];
+
+      if (summary.empty() && previous != nullptr)
+      {
+         const auto it = previous->mBlockSummaries.find(blockID);
+
+         if (it != previous->mBlockSummaries.end())
+            summary = it->second;
+      }
+
+      if (summary.size() != framesCount * 3)
+      {
+         summary.resize(framesCount * 3);
+         block.sb->GetSummary64k(summary.data(), 0, framesCount);
+      }
+
+      // Block summaries are aligned to the start of the block; spread each
+      // over the entries of the base level it overlaps
+      const auto blockStart = block.start.as_long_long();
+
+      for (size_t frame = 0; frame < framesCount; ++frame)
+      {
+         const int64_t from = blockStart + frame * BaseLevelSamples;
+         const int64_t to   = std::min<int64_t>(
+            from + BaseLevelSamples, blockStart + blockSamples);
+
+         const float min = summary[3 * frame];
+         const float max = summary[3 * frame + 1];
+         const double rms = summary[3 * frame + 2];
+
+         for (auto entry = size_t(from / BaseLevelSamples);
+              entry < entriesCount && int64_t(entry * BaseLevelSamples) < to;
+              ++entry)
+         {
+            const int64_t overlap =
+               std::min<int64_t>(to, (entry + 1) * BaseLevelSamples) -
+               std::max<int64_t>(from, entry * BaseLevelSamples);
+
+            minimums[entry] = std::min(minimums[entry], min);
+            maximums[entry] = std::max(maximums[entry], max);
+            squaresSums[entry] += rms * rms * overlap;
+            counts[entry] += overlap;
+         }
+      }
+   }
+
+   std::vector<float> baseLevel(entriesCount * 3);
+
+   for (size_t entry = 0; entry < entriesCount; ++entry)
+   {
+      if (counts[entry] == 0)
+         continue;
+
+      baseLevel[3 * entry]     = minimums[entry];
+      baseLevel[3 * entry + 1] = maximums[entry];
+      baseLevel[3 * entry + 2] =
+         static_cast<float>(std::sqrt(squaresSums[entry] / counts[entry]));
+   }
+
+   auto pyramid = std::make_shared<WaveSummaryPyramid>(
+      std::move(baseLevel), length, GetFingerprint(blocks));
+
+   pyramid->mBlockSummaries = std::move(blockSummaries);
+
+   return pyramid;
+}
+
+uint64_t WaveSummaryPyramid::GetFingerprint(const std::vector<SeqBlock>& blocks)
+{
+   // FNV-1a over ids and starts
+   uint64_t hash = 14695981039346656037ull;
+
+   const auto mix = [&hash](uint64_t value)
+   {
+      for (int byte = 0; byte < 8; ++byte)
+      {
+         hash ^= (value >> (8 * byte)) & 0xFF;
+         hash *= 1099511628211ull;
+      }
+   };
+
+   for (const auto& block : blocks)
+   {
+      mix(block.sb->GetBlockID());
+      mix(block.start.as_long_long());
+   }
+
+   return hash;
+}
+
+WaveSummaryPyramid::WaveSummaryPyramid(
+   std::vector<float> baseLevel, int64_t length, uint64_t fingerprint)
+    : mLength { length }
+    , mFingerprint { fingerprint }
+{
+   assert(baseLevel.size() == 3 * GetEntriesCount(length, BaseLevelSamples));
+
+   mLevels.push_back(std::move(baseLevel));
+
+   for (size_t level = 1; mLevels.back().size() > 3; ++level)
+   {
+      const auto& children     = mLevels.back();
+      const auto childSamples  = GetLevelSamples(level - 1);
+      const auto childrenCount = children.size() / 3;
+      const auto entriesCount  = GetEntriesCount(length, GetLevelSamples(level));
+
+      std::vector<float> entries(entriesCount * 3);
+
+      for (size_t entry = 0; entry < entriesCount; ++entry)
+      {
+         float min = std::numeric_limits<float>::infinity();
+         float max = -std::numeric_limits<float>::infinity();
+         double squaresSum = 0.0;
+         double count      = 0.0;
+
+         const auto firstChild = entry * LevelFactor;
+         const auto lastChild =
+            std::min(firstChild + LevelFactor, childrenCount);
+
+         for (auto child = firstChild; child < lastChild; ++child)
+         {
+            const double weight = GetEntryWeight(length, childSamples, child);
+            const double rms    = children[3 * child + 2];
+
+            min = std::min(min, children[3 * child]);
+            max = std::max(max, children[3 * child + 1]);
+            squaresSum += rms * rms * weight;
+            count += weight;
+         }
+
+         entries[3 * entry]     = min;
+         entries[3 * entry + 1] = max;
+         entries[3 * entry + 2] =
+            count > 0 ? static_cast<float>(std::sqrt(squaresSum / count)) : 0;
+      }
+
+      mLevels.push_back(std::move(entries));
+   }
+}
+
+size_t WaveSummaryPyramid::GetLevelSamples(size_t level) noexcept
+{
+   size_t samples = BaseLevelSamples;
+
+   while (level-- > 0)
+      samples *= LevelFactor;
+
+   return samples;
+}
+
+size_t WaveSummaryPyramid::GetLevelsCount() const noexcept
+{
+   return mLevels.size();
+}
+
+size_t WaveSummaryPyramid::FindLevel(double samplesPerColumn) const noexcept
+{
+   size_t level = 0;
+
+   while (level + 1 < mLevels.size() &&
+          GetLevelSamples(level + 1) <= samplesPerColumn)
+      ++level;
+
+   return level;
+}
+
+const std::vector<float>& WaveSummaryPyramid::GetLevel(size_t level) const
+{
+   return mLevels[std::min(level, mLevels.size() - 1)];
+}
+
+int64_t WaveSummaryPyramid::GetLength() const noexcept
+{
+   return mLength;
+}
+
+uint64_t WaveSummaryPyramid::GetFingerprint() const noexcept
+{
+   return mFingerprint;
+}
@@ -0,0 +1,79 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveSummaryPyramid.h
+
+**********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class SeqBlock;
+
+//! Minimum, maximum and RMS of the samples of a sequence, at coarser and
+//! coarser resolutions
+/*!
+ Each entry of the base level summarizes 64k samples, counted from the start
+ of the sequence, and each entry of the next level four entries of the one
+ before, up to a level of one entry.  Entries are (min, max, rms) triples,
+ like the summaries of sample blocks.
+
+ The 64k summaries of the sample blocks are kept, by block id, so that the
+ pyramid of an edited sequence reads summaries only of the new blocks.
+ */
+class WAVE_TRACK_PAINT_API WaveSummaryPyramid final
+{
+public:
+   static constexpr size_t BaseLevelSamples = 64 * 1024;
+   static constexpr size_t LevelFactor      = 4;
+
+   //! Summarize a sequence from its blocks
+   /*!
+    May be called in any thread where the sample blocks may be read
+
+    @param blocks sorted, contiguous, and starting at sample 0
+    @param previous if not null, a pyramid whose block summaries are reused
+    @param cancelled if not null, checked before reading each block
+    @return null if cancelled
+    */
+   static std::shared_ptr<const WaveSummaryPyramid> Build(
+      const std::vector<SeqBlock>& blocks,
+      const WaveSummaryPyramid* previous = nullptr,
+      const std::atomic<bool>* cancelled = nullptr);
+
+   //! Identifies the blocks and their positions, so that a pyramid can be
+   //! known to be stale
+   static uint64_t GetFingerprint(const std::vector<SeqBlock>& blocks);
+
+   //! Make the levels over a base level of (min, max, rms) triples
+   WaveSummaryPyramid(
+      std::vector<float> baseLevel, int64_t length, uint64_t fingerprint = 0);
+
+   //! Samples summarized by each entry of the level
+   static size_t GetLevelSamples(size_t level) noexcept;
+
+   size_t GetLevelsCount() const noexcept;
+   //! The coarsest level with entries of no more than samplesPerColumn
+   //! samples, or the base level
+   size_t FindLevel(double samplesPerColumn) const noexcept;
+   //! The (min, max, rms) triples of a level
+   const std::vector<float>& GetLevel(size_t level) const;
+
+   //! Number of samples summarized
+   int64_t GetLength() const noexcept;
+   uint64_t GetFingerprint() const noexcept;
+
+private:
+   std::vector<std::vector<float>> mLevels;
+   //! 64k summaries of sample blocks, by block id
+   std::unordered_map<int64_t, std::vector<float>> mBlockSummaries;
+
+   int64_t mLength { 0 };
+   uint64_t mFingerprint { 0 };
+};
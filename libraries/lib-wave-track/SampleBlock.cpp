@@ -11,6 +11,8 @@ SampleBlock.cpp
 #include "SampleBlock.h"
 #include "SampleFormat.h"
 
+#include <numeric>
+
 #include <wx/defs.h>
 
 SampleBlockFactoryPtr SampleBlockFactory::New( AudacityProject &project )
@@ -34,6 +36,32 @@ SampleBlockPtr SampleBlockFactory::Create(constSamplePtr src,
    return result;
 }
 
+std::vector<SampleBlockPtr> SampleBlockFactory::CreateMany(
+   const std::vector<BlockSource> &sources,
+   sampleFormat srcformat)
+{
+   auto result = DoCreateMany(sources, srcformat);
+   if (result.size() != sources.size())
+      THROW_INCONSISTENCY_EXCEPTION;
+   for (auto &pBlock : result) {
+      if (!pBlock)
+         THROW_INCONSISTENCY_EXCEPTION;
+      Publisher<SampleBlockCreateMessage>::Publish({});
+   }
+   return result;
+}
+
+std::vector<SampleBlockPtr> SampleBlockFactory::DoCreateMany(
+   const std::vector<BlockSource> &sources,
+   sampleFormat srcformat)
+{
+   std::vector<SampleBlockPtr> result;
+   result.reserve(sources.size());
+   for (auto &source : sources)
+      result.push_back(DoCreate(source.src, source.numsamples, srcformat));
+   return result;
+}
+
 SampleBlockPtr SampleBlockFactory::CreateSilent(
    size_t numsamples,
    sampleFormat srcformat)
@@ -66,6 +94,71 @@ SampleBlockPtr SampleBlockFactory::CreateFromId(
    return result;
 }
 
+void SampleBlockFactory::BeginWriteBatch()
+{
+}
+
+void SampleBlockFactory::EndWriteBatch()
+{
+}
+
+void SampleBlockFactory::FlushWriteBatch()
+{
+}
+
+void SampleBlockFactory::BeginLoading()
+{
+}
+
+void SampleBlockFactory::EndLoading()
+{
+}
+
+SampleBlockLoading::SampleBlockLoading(SampleBlockFactory &factory)
+   : mFactory{ factory }
+{
+   mFactory.BeginLoading();
+}
+
+SampleBlockLoading::~SampleBlockLoading()
+{
+   mFactory.EndLoading();
+}
+
+SampleBlockCache *SampleBlockFactory::GetCache()
+{
+   return nullptr;
+}
+
+auto SampleBlockFactory::GetActiveBlockIDs(
+   SampleBlockID after, SampleBlockID upTo) -> SampleBlockIDs
+{
+   auto result = GetActiveBlockIDs();
+   for (auto iter = result.begin(); iter != result.end();) {
+      if (*iter > after && *iter <= upTo)
+         ++iter;
+      else
+         iter = result.erase(iter);
+   }
+   return result;
+}
+
+SampleBlockWriteBatch::SampleBlockWriteBatch(SampleBlockFactory &factory)
+   : mFactory{ factory }
+{
+   mFactory.BeginWriteBatch();
+}
+
+SampleBlockWriteBatch::~SampleBlockWriteBatch()
+{
+   mFactory.EndWriteBatch();
+}
+
+void SampleBlockWriteBatch::Flush()
+{
+   mFactory.FlushWriteBatch();
+}
+
 SampleBlock::~SampleBlock() = default;
 
 size_t SampleBlock::GetSamples(samplePtr dest,
@@ -82,6 +175,11 @@ size_t SampleBlock::GetSamples(samplePtr dest,
    }
 }
  
+bool SampleBlock::SuggestSampleCount(size_t)
+{
+   return false;
+}
+
  MinMaxRMS SampleBlock::GetMinMaxRMS(
                         size_t start, size_t len, bool mayThrow)
 {
@@ -103,3 +201,22 @@ size_t SampleBlock::GetSamples(samplePtr dest,
    }
 }
 
+double SampleBlock::GetSum(bool mayThrow)
+{
+   try{ return DoGetSum(); }
+   catch( ... ) {
+      if( mayThrow )
+         throw;
+      return 0.0;
+   }
+}
+
+double SampleBlock::DoGetSum()
+{
+   const auto count = GetSampleCount();
+   SampleBuffer buffer(count, floatSample);
+   const auto samples = reinterpret_cast<const float*>(buffer.ptr());
+   DoGetSamples(buffer.ptr(), floatSample, 0, count);
+   return std::accumulate(samples, samples + count, 0.0);
+}
+
@@ -16,12 +16,14 @@ SampleBlock.h
 #include <functional>
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "Observer.h"
 #include "XMLTagHandler.h"
 
 class AudacityProject;
 class ProjectFileIO;
+class SampleBlockCache;
 class XMLWriter;
 
 class SampleBlock;
@@ -67,6 +69,12 @@ public:
 
    virtual size_t GetSampleCount() const = 0;
 
+   //! Tell a block made from a document the sample count that the document
+   //! implies, so that GetSampleCount() need not fetch stored details
+   /*! @return whether the block will report that count; the default does
+    nothing and returns false */
+   virtual bool SuggestSampleCount(size_t count);
+
    //! Non-throwing, should fill with zeroes on failure
    virtual bool
       GetSummary256(float *dest, size_t frameoffset, size_t numframes) = 0;
@@ -85,6 +93,10 @@ public:
    // That may be appropriate when only attempting to display samples, not edit.
    MinMaxRMS GetMinMaxRMS(bool mayThrow = true) const;
 
+   /// Gets the sum of the samples of the entire block, as for a mean
+   // If !mayThrow and there is an error, ignores it and returns zero.
+   double GetSum(bool mayThrow = true);
+
    virtual size_t GetSpaceUsage() const = 0;
 
    virtual void SaveXML(XMLWriter &xmlFile) = 0;
@@ -98,6 +110,36 @@ protected:
    virtual MinMaxRMS DoGetMinMaxRMS(size_t start, size_t len) = 0;
 
    virtual MinMaxRMS DoGetMinMaxRMS() const = 0;
+
+   //! Default implementation reads all the samples
+   virtual double DoGetSum();
+};
+
+//! Opens loading by a SampleBlockFactory for the lifetime of the object
+class WAVE_TRACK_API SampleBlockLoading final {
+public:
+   explicit SampleBlockLoading(SampleBlockFactory &factory);
+   ~SampleBlockLoading();
+   SampleBlockLoading(const SampleBlockLoading&) = delete;
+   SampleBlockLoading &operator=(const SampleBlockLoading&) = delete;
+
+private:
+   SampleBlockFactory &mFactory;
+};
+
+//! Opens a write batch of a SampleBlockFactory for the lifetime of the object
+class WAVE_TRACK_API SampleBlockWriteBatch final {
+public:
+   explicit SampleBlockWriteBatch(SampleBlockFactory &factory);
+   ~SampleBlockWriteBatch();
+   SampleBlockWriteBatch(const SampleBlockWriteBatch&) = delete;
+   SampleBlockWriteBatch &operator=(const SampleBlockWriteBatch&) = delete;
+
+   //! An explicit flush point
+   void Flush();
+
+private:
+   SampleBlockFactory &mFactory;
 };
 
 // Makes a useful function object
@@ -131,6 +173,18 @@ public:
       size_t numsamples,
       sampleFormat srcformat);
 
+   //! Samples for one of the blocks made by CreateMany()
+   struct BlockSource {
+      constSamplePtr src;
+      size_t numsamples;
+   };
+
+   // Returns non-null pointers, one for each source in order, or else throws
+   // an exception.  May be faster than repeated calls to Create().
+   std::vector<SampleBlockPtr> CreateMany(
+      const std::vector<BlockSource> &sources,
+      sampleFormat srcformat);
+
    // Returns a non-null pointer or else throws an exception
    SampleBlockPtr CreateSilent(
       size_t numsamples,
@@ -144,9 +198,42 @@ public:
    // Potentially returns a null pointer
    SampleBlockPtr CreateFromId(sampleFormat srcformat, SampleBlockID id);
 
+   //! While a write batch is open, the factory may group the storage of new
+   //! blocks into fewer, larger transactions
+   /*!
+    Batches nest; only the outermost has effect.  Don't begin other
+    transactions on the same storage while a batch is open, though a batch
+    may be opened inside them.  Default implementation does nothing.
+    @see SampleBlockWriteBatch
+    */
+   virtual void BeginWriteBatch();
+   //! Make durable the blocks created in the batch; must not throw
+   virtual void EndWriteBatch();
+   //! Make durable the blocks created so far in an open batch
+   virtual void FlushWriteBatch();
+
+   //! While loading is open, as when reading a project, the factory may
+   //! fetch the stored details of all blocks at once, when it first makes a
+   //! block from an id
+   /*!
+    Default implementation does nothing.
+    @see SampleBlockLoading
+    */
+   virtual void BeginLoading();
+   //! Discard the details fetched and not yet used; must not throw
+   virtual void EndLoading();
+
+   //! Cache of float samples of the blocks of this factory
+   /*! @return null (the default) if there is none */
+   virtual SampleBlockCache *GetCache();
+
    using SampleBlockIDs = std::unordered_set<SampleBlockID>;
    /*! @return ids of all sample blocks created by this factory and still extant */
    virtual SampleBlockIDs GetActiveBlockIDs() = 0;
+   /*! @return ids in (`after`, `upTo`] of sample blocks created by this
+    factory and still extant; the default filters GetActiveBlockIDs() */
+   virtual SampleBlockIDs GetActiveBlockIDs(
+      SampleBlockID after, SampleBlockID upTo);
 
 protected:
    // The override should throw more informative exceptions on error than the
@@ -155,6 +242,11 @@ protected:
       size_t numsamples,
       sampleFormat srcformat) = 0;
 
+   //! Default implementation calls DoCreate() for each source
+   virtual std::vector<SampleBlockPtr> DoCreateMany(
+      const std::vector<BlockSource> &sources,
+      sampleFormat srcformat);
+
    // The override should throw more informative exceptions on error than the
    // default InconsistencyException thrown by CreateSilent
    virtual SampleBlockPtr DoCreateSilent(
@@ -0,0 +1,130 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+SampleBlockCache.cpp
+
+**********************************************************************/
+
+#include "SampleBlockCache.h"
+
+#include <functional>
+
+namespace {
+size_t ViewBytes(const BlockSampleView &view)
+{
+   return view ? view->size() * sizeof(float) : 0;
+}
+}
+
+SampleBlockCache::SampleBlockCache(size_t budgetBytes)
+{
+   SetBudget(budgetBytes);
+}
+
+SampleBlockCache::~SampleBlockCache() = default;
+
+auto SampleBlockCache::GetShard(SampleBlockID id) -> Shard &
+{
+   return mShards[std::hash<SampleBlockID>{}(id) % ShardCount];
+}
+
+BlockSampleView SampleBlockCache::Find(SampleBlockID id)
+{
+   auto &shard = GetShard(id);
+   std::lock_guard<std::mutex> lock{ shard.mutex };
+   const auto iter = shard.index.find(id);
+   if (iter == shard.index.end()) {
+      ++shard.statistics.misses;
+      return {};
+   }
+   ++shard.statistics.hits;
+   // Move to the front
+   shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+   return iter->second->view;
+}
+
+void SampleBlockCache::Insert(SampleBlockID id, BlockSampleView view)
+{
+   auto &shard = GetShard(id);
+   std::lock_guard<std::mutex> lock{ shard.mutex };
+   const auto bytes = ViewBytes(view);
+   if (const auto iter = shard.index.find(id); iter != shard.index.end()) {
+      shard.statistics.bytes -= iter->second->bytes;
+      shard.entries.erase(iter->second);
+      shard.index.erase(iter);
+   }
+   shard.entries.push_front({ id, std::move(view), bytes });
+   shard.index.emplace(id, shard.entries.begin());
+   shard.statistics.bytes += bytes;
+   shard.Evict();
+}
+
+void SampleBlockCache::Erase(SampleBlockID id)
+{
+   auto &shard = GetShard(id);
+   std::lock_guard<std::mutex> lock{ shard.mutex };
+   if (const auto iter = shard.index.find(id); iter != shard.index.end()) {
+      shard.statistics.bytes -= iter->second->bytes;
+      shard.entries.erase(iter->second);
+      shard.index.erase(iter);
+   }
+}
+
+void SampleBlockCache::Pin(SampleBlockID id)
+{
+   auto &shard = GetShard(id);
+   std::lock_guard<std::mutex> lock{ shard.mutex };
+   ++shard.pins[id];
+}
+
+void SampleBlockCache::Unpin(SampleBlockID id)
+{
+   auto &shard = GetShard(id);
+   std::lock_guard<std::mutex> lock{ shard.mutex };
+   const auto iter = shard.pins.find(id);
+   if (iter == shard.pins.end())
+      return;
+   if (--iter->second == 0) {
+      shard.pins.erase(iter);
+      shard.Evict();
+   }
+}
+
+void SampleBlockCache::SetBudget(size_t budgetBytes)
+{
+   for (auto &shard : mShards) {
+      std::lock_guard<std::mutex> lock{ shard.mutex };
+      shard.budget = budgetBytes / ShardCount;
+      shard.Evict();
+   }
+}
+
+auto SampleBlockCache::GetStatistics() const -> Statistics
+{
+   Statistics result;
+   for (auto &shard : mShards) {
+      std::lock_guard<std::mutex> lock{ shard.mutex };
+      result.hits += shard.statistics.hits;
+      result.misses += shard.statistics.misses;
+      result.evictions += shard.statistics.evictions;
+      result.bytes += shard.statistics.bytes;
+      result.entries += shard.entries.size();
+   }
+   return result;
+}
+
+void SampleBlockCache::Shard::Evict()
+{
+   // Visit from least recently used, skipping pinned entries
+   auto iter = entries.end();
+   while (statistics.bytes > budget && iter != entries.begin()) {
+      --iter;
+      if (pins.count(iter->id))
+         continue;
+      statistics.bytes -= iter->bytes;
+      ++statistics.evictions;
+      index.erase(iter->id);
+      iter = entries.erase(iter);
+   }
+}
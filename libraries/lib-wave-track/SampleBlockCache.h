@@ -0,0 +1,89 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+SampleBlockCache.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_BLOCK_CACHE__
+#define __AUDACITY_SAMPLE_BLOCK_CACHE__
+
+#include "AudioSegmentSampleView.h" // BlockSampleView
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+using SampleBlockID = long long;
+
+//! Float samples of recently used sample blocks, within a memory budget
+/*!
+ Entries are evicted least recently used first, except that pinned blocks are
+ never evicted.  Pinning counts, so that several clients may pin the same
+ block; a block may be pinned before it is inserted.
+
+ The cache is divided into shards, each with its own lock and an equal part
+ of the budget, so that threads reading different blocks rarely contend.
+ */
+class WAVE_TRACK_API SampleBlockCache final
+{
+public:
+   struct Statistics {
+      uint64_t hits{};
+      uint64_t misses{};
+      uint64_t evictions{};
+      size_t bytes{};
+      size_t entries{};
+   };
+
+   explicit SampleBlockCache(size_t budgetBytes);
+   ~SampleBlockCache();
+
+   SampleBlockCache(const SampleBlockCache&) = delete;
+   SampleBlockCache &operator =(const SampleBlockCache&) = delete;
+
+   //! @return null, counting a miss, if the block is not cached
+   BlockSampleView Find(SampleBlockID id);
+   //! Add or replace the samples of a block, then evict as needed
+   void Insert(SampleBlockID id, BlockSampleView view);
+   //! Forget a block, as when it is deleted
+   void Erase(SampleBlockID id);
+
+   void Pin(SampleBlockID id);
+   //! Undo one Pin(); the block becomes evictable when no pins remain
+   void Unpin(SampleBlockID id);
+
+   //! Change the budget, evicting as needed
+   void SetBudget(size_t budgetBytes);
+   //! Totals of all shards
+   Statistics GetStatistics() const;
+
+private:
+   struct Entry {
+      SampleBlockID id;
+      BlockSampleView view;
+      size_t bytes;
+   };
+   struct Shard {
+      mutable std::mutex mutex;
+      //! Most recently used first
+      std::list<Entry> entries;
+      std::unordered_map<SampleBlockID, std::list<Entry>::iterator> index;
+      std::unordered_map<SampleBlockID, size_t> pins;
+      size_t budget{};
+      Statistics statistics;
+
+      //! @pre mutex is locked
+      void Evict();
+   };
+   static constexpr size_t ShardCount = 16;
+
+   Shard &GetShard(SampleBlockID id);
+
+   std::array<Shard, ShardCount> mShards;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+SampleBlockPrefetcher.cpp
+
+**********************************************************************/
+
+#include "SampleBlockPrefetcher.h"
+
+#include "BasicUI.h"
+#include "SampleBlockCache.h"
+
+#include <algorithm>
+
+namespace {
+//! A window not renewed for this long is unpinned
+constexpr auto StaleTime = std::chrono::seconds{ 5 };
+//! Oldest requests are dropped beyond this many
+constexpr size_t MaxQueued = 256;
+}
+
+SampleBlockPrefetcher &SampleBlockPrefetcher::Get()
+{
+   static SampleBlockPrefetcher instance;
+   return instance;
+}
+
+SampleBlockPrefetcher::SampleBlockPrefetcher() = default;
+
+SampleBlockPrefetcher::~SampleBlockPrefetcher()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStopping = true;
+   }
+   mCondition.notify_one();
+   if (mThread.joinable())
+      mThread.join();
+}
+
+void SampleBlockPrefetcher::Request(const void *client,
+   const SampleBlockFactoryPtr &pFactory,
+   const std::vector<SampleBlockPtr> &blocks)
+{
+   const auto pCache = pFactory ? pFactory->GetCache() : nullptr;
+   if (!pCache)
+      return;
+   // Usually the window is unchanged; then reuse the storage, allocating
+   // nothing
+   static thread_local std::vector<SampleBlockID> ids;
+   ids.clear();
+   for (auto &pBlock : blocks)
+      ids.push_back(pBlock->GetBlockID());
+
+   std::lock_guard<std::mutex> lock{ mMutex };
+   const auto now = Clock::now();
+   ReleaseStale(now);
+   auto &window = mWindows[client];
+   window.renewed = now;
+   const bool sameFactory = window.wFactory.lock() == pFactory;
+   if (sameFactory && window.ids == ids)
+      return;
+
+   // Pin the new window before unpinning the old, so that blocks in both
+   // stay
+   for (auto id : ids)
+      pCache->Pin(id);
+   Unpin(window);
+   for (size_t ii = 0; ii < blocks.size(); ++ii)
+      if (!sameFactory ||
+          std::find(window.ids.begin(), window.ids.end(), ids[ii]) ==
+             window.ids.end())
+         mQueue.push_back(blocks[ii]);
+   while (mQueue.size() > MaxQueued)
+      mQueue.pop_front();
+   window.wFactory = pFactory;
+   window.ids = ids;
+
+   if (!mThread.joinable())
+      mThread = std::thread{ [this]{ Loop(); } };
+   mCondition.notify_one();
+}
+
+void SampleBlockPrefetcher::Release(const void *client)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (const auto iter = mWindows.find(client); iter != mWindows.end()) {
+      Unpin(iter->second);
+      mWindows.erase(iter);
+   }
+}
+
+void SampleBlockPrefetcher::Unpin(const Window &window)
+{
+   if (const auto pFactory = window.wFactory.lock())
+      if (const auto pCache = pFactory->GetCache())
+         for (auto id : window.ids)
+            pCache->Unpin(id);
+}
+
+void SampleBlockPrefetcher::ReleaseStale(Clock::time_point now)
+{
+   for (auto iter = mWindows.begin(); iter != mWindows.end();) {
+      if (now - iter->second.renewed > StaleTime) {
+         Unpin(iter->second);
+         iter = mWindows.erase(iter);
+      }
+      else
+         ++iter;
+   }
+}
+
+void SampleBlockPrefetcher::Loop()
+{
+   while (true) {
+      std::weak_ptr<SampleBlock> wBlock;
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mCondition.wait(lock, [this]{ return mStopping || !mQueue.empty(); });
+         if (mStopping)
+            return;
+         wBlock = std::move(mQueue.front());
+         mQueue.pop_front();
+      }
+      if (auto pBlock = wBlock.lock()) {
+         // Errors are ignored here, and not cached; the reader will meet
+         // them again
+         if (pBlock->GetSampleCount() > 0)
+            pBlock->GetFloatSampleView(false);
+         // The block may have left its sequence meanwhile; don't let its
+         // destruction, and the deletion of its storage, happen here
+         BasicUI::CallAfter([pBlock = std::move(pBlock)]{});
+      }
+   }
+}
@@ -0,0 +1,66 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+SampleBlockPrefetcher.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_BLOCK_PREFETCHER__
+#define __AUDACITY_SAMPLE_BLOCK_PREFETCHER__
+
+#include "SampleBlock.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+//! Loads sample blocks into the caches of their factories, in a thread of
+//! its own, ahead of reading
+/*!
+ Each client, such as a reader of a track in the course of playback, has one
+ window of blocks, which stay pinned in the cache until the client replaces
+ the window, or stops renewing it for a while.
+ */
+class WAVE_TRACK_API SampleBlockPrefetcher final
+{
+public:
+   static SampleBlockPrefetcher &Get();
+
+   ~SampleBlockPrefetcher();
+
+   //! Replace the window of `client` with `blocks`, loading those not loaded
+   /*! Does nothing if the factory has no cache */
+   void Request(const void *client, const SampleBlockFactoryPtr &pFactory,
+      const std::vector<SampleBlockPtr> &blocks);
+   //! Unpin the window of `client`
+   void Release(const void *client);
+
+private:
+   using Clock = std::chrono::steady_clock;
+   struct Window {
+      std::weak_ptr<SampleBlockFactory> wFactory;
+      std::vector<SampleBlockID> ids;
+      Clock::time_point renewed;
+   };
+
+   SampleBlockPrefetcher();
+   //! @pre mMutex is locked
+   static void Unpin(const Window &window);
+   //! @pre mMutex is locked
+   void ReleaseStale(Clock::time_point now);
+   void Loop();
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::unordered_map<const void*, Window> mWindows;
+   std::deque<std::weak_ptr<SampleBlock>> mQueue;
+   bool mStopping{ false };
+   //! Started at the first request
+   std::thread mThread;
+};
+
+#endif
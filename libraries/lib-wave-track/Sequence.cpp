@@ -32,6 +32,7 @@
 #include "Sequence.h"
 
 #include <algorithm>
+#include <numeric>
 #include <optional>
 #include <float.h>
 #include <math.h>
@@ -42,6 +43,7 @@
 
 #include "BasicUI.h"
 #include "Dither.h"
+#include "concurrency/TaskScheduler.h"
 #include "SampleBlock.h"
 #include "InconsistencyException.h"
 
@@ -70,13 +72,27 @@ Sequence::Sequence(
    mMinSamples(orig.mMinSamples),
    mMaxSamples(orig.mMaxSamples)
 {
-   Paste(0, &orig);
+   if (pFactory == orig.mpFactory) {
+      // Share the array of blocks, until either sequence changes it, so that
+      // copies for undo history cost little more than for the clip
+      mpBlock = orig.mpBlock;
+      mNumSamples = orig.mNumSamples;
+   }
+   else
+      Paste(0, &orig);
 }
 
 Sequence::~Sequence()
 {
 }
 
+BlockArray &Sequence::MutableBlocks()
+{
+   if (mpBlock.use_count() > 1)
+      mpBlock = std::make_shared<BlockArray>(*mpBlock);
+   return *mpBlock;
+}
+
 size_t Sequence::GetMaxBlockSize() const
 {
    return mMaxSamples;
@@ -89,8 +105,8 @@ size_t Sequence::GetIdealBlockSize() const
 
 bool Sequence::CloseLock() noexcept
 {
-   for (unsigned int i = 0; i < mBlock.size(); i++)
-      mBlock[i].sb->CloseLock();
+   for (unsigned int i = 0; i < Blocks().size(); i++)
+      Blocks()[i].sb->CloseLock();
 
    return true;
 }
@@ -103,7 +119,7 @@ SampleFormats Sequence::GetSampleFormats() const
 /*
 bool Sequence::SetSampleFormat(sampleFormat format)
 {
-   if (mBlock.size() > 0 || mNumSamples > 0)
+   if (Blocks().size() > 0 || mNumSamples > 0)
       return false;
 
    mSampleFormat = format;
@@ -144,7 +160,7 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
       // no change
       return false;
 
-   if (mBlock.size() == 0)
+   if (Blocks().size() == 0)
    {
       // Effective format can be made narrowest when there is no content
       mSampleFormats = { narrowestSampleFormat, format };
@@ -177,37 +193,66 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
    // Use the ratio of old to NEW mMaxSamples to make a reasonable guess
    // at allocation.
    newBlockArray.reserve
-      (1 + mBlock.size() * ((float)oldMaxSamples / (float)mMaxSamples));
+      (1 + Blocks().size() * ((float)oldMaxSamples / (float)mMaxSamples));
 
    {
-      size_t oldSize = oldMaxSamples;
-      SampleBuffer bufferOld(oldSize, oldFormats.Stored());
-      size_t newSize = oldMaxSamples;
-      SampleBuffer bufferNew(newSize, format);
-
-      for (size_t i = 0, nn = mBlock.size(); i < nn; i++)
+      const auto oldFormat = oldFormats.Stored();
+      // Do not dither to reformat samples if format is at least as wide
+      // as the old effective (though format might be narrower than the
+      // old stored).
+      const auto ditherType = format < oldFormats.Effective()
+         ? gHighQualityDither
+         : DitherType::none;
+
+      // Blocks converted before their new blocks are made, which bounds the
+      // memory held at once
+      constexpr size_t blocksPerBatch = 64;
+      // Blocks converted in order by one task.  Each task has its own dither,
+      // as CopySamples shares one that is not thread-safe; the state it
+      // carries then depends only on the blocks, not on the threads, so that
+      // conversions are repeatable
+      constexpr size_t blocksPerTask = 8;
+
+      std::vector<SampleBuffer> converted(blocksPerBatch);
+      std::vector<size_t> convertedSizes(blocksPerBatch, 0);
+      std::vector<SampleBlockFactory::BlockSource> sources;
+      std::vector<sampleCount> starts;
+
+      for (size_t first = 0, nn = Blocks().size(); first < nn;
+         first += blocksPerBatch)
       {
-         SeqBlock &oldSeqBlock = mBlock[i];
-         const auto &oldBlockFile = oldSeqBlock.sb;
-         const auto len = oldBlockFile->GetSampleCount();
-         ensureSampleBufferSize(bufferOld, oldFormats.Stored(), oldSize, len);
-
-         // Dither won't happen here, reading back the same as-saved format
-         Read(bufferOld.ptr(), oldFormats.Stored(), oldSeqBlock, 0, len, true);
-
-         ensureSampleBufferSize(bufferNew, format, newSize, len);
-
-         CopySamples(
-            bufferOld.ptr(), oldFormats.Stored(), bufferNew.ptr(), format, len,
-            // Do not dither to reformat samples if format is at least as wide
-            // as the old effective (though format might be narrower than the
-            // old stored).
-            format < oldFormats.Effective()
-               ? gHighQualityDither
-               : DitherType::none );
+         const auto last = std::min(nn, first + blocksPerBatch);
+         {
+            audacity::concurrency::TaskGroup group;
+            for (auto begin = first; begin < last; begin += blocksPerTask)
+               group.Run([&, begin]{
+                  Dither dither;
+                  SampleBuffer bufferOld;
+                  size_t oldSize = 0;
+                  for (auto i = begin, end = std::min(last, begin + blocksPerTask);
+                     i < end; ++i)
+                  {
+                     const SeqBlock &oldSeqBlock = Blocks()[i];
+                     const auto len = oldSeqBlock.sb->GetSampleCount();
+                     ensureSampleBufferSize(bufferOld, oldFormat, oldSize, len);
+
+                     // Dither won't happen here, reading back the same
+                     // as-saved format
+                     Read(bufferOld.ptr(), oldFormat, oldSeqBlock, 0, len, true);
+
+                     auto &bufferNew = converted[i - first];
+                     ensureSampleBufferSize(
+                        bufferNew, format, convertedSizes[i - first], len);
+                     dither.Apply(ditherType,
+                        bufferOld.ptr(), oldFormat, bufferNew.ptr(), format,
+                        len);
+                  }
+               });
+            group.Wait();
+         }
 
          // Note this fix for http://bugzilla.audacityteam.org/show_bug.cgi?id=451,
-         // using Blockify, allows (len < mMinSamples).
+         // splitting as Blockify does, allows (len < mMinSamples).
          // This will happen consistently when going from more bytes per sample to fewer...
          // This will create a block that's smaller than mMinSamples, which
          // shouldn't be allowed, but we agreed it's okay for now.
@@ -215,13 +260,32 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
          //    If so, need to special-case (len < mMinSamples) and start combining data
          //    from the old blocks... Oh no!
 
-         // Using Blockify will handle the cases where len > the NEW mMaxSamples. Previous code did not.
-         const auto blockstart = oldSeqBlock.start;
-         Blockify(*mpFactory, mMaxSamples, format,
-                  newBlockArray, blockstart, bufferNew.ptr(), len);
+         // Splitting handles the cases where len > the NEW mMaxSamples.
+         // All the new blocks of the batch are made at once, which prepares
+         // them concurrently and commits them together
+         sources.clear();
+         starts.clear();
+         size_t batchLen = 0;
+         for (auto i = first; i < last; ++i) {
+            const SeqBlock &oldSeqBlock = Blocks()[i];
+            const auto len = oldSeqBlock.sb->GetSampleCount();
+            batchLen += len;
+            const auto buffer = converted[i - first].ptr();
+            const auto num = (len + (mMaxSamples - 1)) / mMaxSamples;
+            for (decltype(num) j = 0; j < num; ++j) {
+               const auto offset = j * len / num;
+               starts.push_back(oldSeqBlock.start + offset);
+               sources.push_back({
+                  buffer + offset * SAMPLE_SIZE(format),
+                  ((j + 1) * len / num) - offset });
+            }
+         }
+         auto blocks = mpFactory->CreateMany(sources, format);
+         for (size_t j = 0; j < blocks.size(); ++j)
+            newBlockArray.push_back({ std::move(blocks[j]), starts[j] });
 
          if (progressReport)
-            progressReport(len);
+            progressReport(batchLen);
       }
    }
 
@@ -241,7 +305,7 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
 std::pair<float, float> Sequence::GetMinMax(
    sampleCount start, sampleCount len, bool mayThrow) const
 {
-   if (len == 0 || mBlock.size() == 0) {
+   if (len == 0 || Blocks().size() == 0) {
       return {
          0.f,
          // FLT_MAX?  So it doesn't look like a spurious '0' to a caller?
@@ -262,7 +326,7 @@ std::pair<float, float> Sequence::GetMinMax(
    // already in memory.
 
    for (unsigned b = block0 + 1; b < block1; ++b) {
-      auto results = mBlock[b].sb->GetMinMaxRMS(mayThrow);
+      auto results = Blocks()[b].sb->GetMinMaxRMS(mayThrow);
 
       if (results.min < min)
          min = results.min;
@@ -275,7 +339,7 @@ std::pair<float, float> Sequence::GetMinMax(
    // of either of these blocks is within min...max, then we can ignore them.
    // If not, we need read some samples and summaries from disk.
    {
-      const SeqBlock &theBlock = mBlock[block0];
+      const SeqBlock &theBlock = Blocks()[block0];
       const auto &theFile = theBlock.sb;
       auto results = theFile->GetMinMaxRMS(mayThrow);
 
@@ -299,7 +363,7 @@ std::pair<float, float> Sequence::GetMinMax(
 
    if (block1 > block0)
    {
-      const SeqBlock &theBlock = mBlock[block1];
+      const SeqBlock &theBlock = Blocks()[block1];
       const auto &theFile = theBlock.sb;
       auto results = theFile->GetMinMaxRMS(mayThrow);
 
@@ -324,7 +388,7 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
 {
    // len is the number of samples that we want the rms of.
    // it may be longer than a block, and the code is carefully set up to handle that.
-   if (len == 0 || mBlock.size() == 0)
+   if (len == 0 || Blocks().size() == 0)
       return 0.f;
 
    double sumsq = 0.0;
@@ -337,7 +401,7 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    // this is very fast because we have the rms of every entire block
    // already in memory.
    for (unsigned b = block0 + 1; b < block1; b++) {
-      const SeqBlock &theBlock = mBlock[b];
+      const SeqBlock &theBlock = Blocks()[b];
       const auto &sb = theBlock.sb;
       auto results = sb->GetMinMaxRMS(mayThrow);
 
@@ -351,7 +415,7 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    // selection may only partly overlap these blocks.
    // If not, we need read some samples and summaries from disk.
    {
-      const SeqBlock &theBlock = mBlock[block0];
+      const SeqBlock &theBlock = Blocks()[block0];
       const auto &sb = theBlock.sb;
       // start lies within theBlock
       auto s0 = ( start - theBlock.start ).as_size_t();
@@ -368,7 +432,7 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    }
 
    if (block1 > block0) {
-      const SeqBlock &theBlock = mBlock[block1];
+      const SeqBlock &theBlock = Blocks()[block1];
       const auto &sb = theBlock.sb;
 
       // start + len - 1 lies within theBlock
@@ -387,6 +451,111 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    return sqrt(sumsq / length.as_double() );
 }
 
+double Sequence::GetSum(sampleCount start, sampleCount len, bool mayThrow) const
+{
+   if (len == 0 || Blocks().size() == 0)
+      return 0.0;
+
+   double sum = 0.0;
+
+   unsigned int block0 = FindBlock(start);
+   unsigned int block1 = FindBlock(start + len - 1);
+
+   // Whole blocks know their sums; read samples only of partial blocks
+   const auto partialSum = [&](const SeqBlock &theBlock, size_t s0, size_t l0){
+      const auto &sb = theBlock.sb;
+      if (s0 == 0 && l0 == sb->GetSampleCount())
+         return sb->GetSum(mayThrow);
+      SampleBuffer buffer(l0, floatSample);
+      const auto samples = reinterpret_cast<const float*>(buffer.ptr());
+      sb->GetSamples(buffer.ptr(), floatSample, s0, l0, mayThrow);
+      return std::accumulate(samples, samples + l0, 0.0);
+   };
+
+   for (unsigned b = block0 + 1; b < block1; b++)
+      sum += Blocks()[b].sb->GetSum(mayThrow);
+
+   {
+      const SeqBlock &theBlock = Blocks()[block0];
+      // start lies within theBlock
+      auto s0 = ( start - theBlock.start ).as_size_t();
+      const auto maxl0 =
+         (theBlock.start + theBlock.sb->GetSampleCount() - start).as_size_t();
+      const auto l0 = limitSampleBufferSize( maxl0, len );
+      sum += partialSum(theBlock, s0, l0);
+   }
+
+   if (block1 > block0) {
+      const SeqBlock &theBlock = Blocks()[block1];
+      // start + len - 1 lies within theBlock
+      const auto l0 = ( start + len - theBlock.start ).as_size_t();
+      sum += partialSum(theBlock, 0, l0);
+   }
+
+   return sum;
+}
+
+sampleCount Sequence::GetQuietLength(sampleCount start, sampleCount len,
+   float threshold, bool mayThrow) const
+{
+   if (len <= 0 || Blocks().size() == 0)
+      return 0;
+
+   // Summary frames are of min, max, and rms
+   constexpr size_t fields = 3;
+   const auto quiet = [&](float min, float max){
+      return min > -threshold && max < threshold;
+   };
+
+   const auto end = start + len;
+   auto pos = start;
+   for (auto b = FindBlock(start); pos < end && b < Blocks().size(); ++b) {
+      const SeqBlock &theBlock = Blocks()[b];
+      const auto &sb = theBlock.sb;
+      const auto count = sb->GetSampleCount();
+
+      // The whole block, then frames of 65536, then frames of 256 samples
+      const auto results = sb->GetMinMaxRMS(mayThrow);
+      if (quiet(results.min, results.max)) {
+         pos = theBlock.start + count;
+         continue;
+      }
+
+      // pos lies within theBlock
+      auto offset = (pos - theBlock.start).as_size_t();
+      // Advance offset over quiet frames, before last; return whether all
+      // were quiet
+      const auto skip = [&](size_t frameSize, size_t last, auto getSummary){
+         const auto first = offset / frameSize;
+         const auto nFrames = (last + frameSize - 1) / frameSize - first;
+         std::vector<float> summary(nFrames * fields);
+         if (!getSummary(summary.data(), first, nFrames))
+            return false;
+         size_t ii = 0;
+         for (; ii < nFrames; ++ii) {
+            const auto frame = &summary[ii * fields];
+            if (!quiet(frame[0], frame[1]))
+               break;
+         }
+         offset = std::max(offset, std::min(last, (first + ii) * frameSize));
+         return ii == nFrames;
+      };
+
+      constexpr size_t bigFrame = 65536, smallFrame = 256;
+      if (!skip(bigFrame, count,
+         [&](float *dest, size_t first, size_t nFrames){
+            return sb->GetSummary64k(dest, first, nFrames); }))
+         skip(smallFrame, std::min(count, (offset / bigFrame + 1) * bigFrame),
+            [&](float *dest, size_t first, size_t nFrames){
+               return sb->GetSummary256(dest, first, nFrames); });
+      pos = theBlock.start + offset;
+      if (offset < count)
+         break;
+   }
+
+   return std::min(pos, end) - start;
+}
+
 // Must pass in the correct factory for the result.  If it's not the same
 // as in this, then block contents must be copied.
 std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
@@ -402,7 +571,11 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    // contents are used -- must copy if factories are different:
    auto pUseFactory = (pFactory == mpFactory) ? nullptr : pFactory.get();
 
-   int numBlocks = mBlock.size();
+   if (!pUseFactory && s0 <= 0 && s1 >= mNumSamples)
+      // All of it:  share the array of blocks too, like the copy constructor
+      return std::make_unique<Sequence>(*this, pFactory);
+
+   int numBlocks = Blocks().size();
 
    int b0 = FindBlock(s0);
    const int b1 = FindBlock(s1 - 1);
@@ -412,7 +585,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    wxUnusedVar(numBlocks);
    wxASSERT(b0 <= b1);
 
-   dest->mBlock.reserve(b1 - b0 + 1);
+   dest->MutableBlocks().reserve(b1 - b0 + 1);
 
    auto bufferSize = mMaxSamples;
    const auto format = mSampleFormats.Stored();
@@ -422,7 +595,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
 
    // Do any initial partial block
 
-   const SeqBlock &block0 = mBlock[b0];
+   const SeqBlock &block0 = Blocks()[b0];
    if (s0 != block0.start) {
       const auto &sb = block0.sb;
       // Nonnegative result is length of block0 or less:
@@ -442,13 +615,13 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    // If there are blocks in the middle, use the blocks whole
    for (int bb = b0 + 1; bb < b1; ++bb)
       AppendBlock(pUseFactory, format,
-         dest->mBlock, dest->mNumSamples, mBlock[bb]);
+         dest->MutableBlocks(), dest->mNumSamples, Blocks()[bb]);
       // Increase ref count or duplicate file
 
    // Do the last block
    if (b1 > b0) {
       // Probable case of a partial block
-      const SeqBlock &block = mBlock[b1];
+      const SeqBlock &block = Blocks()[b1];
       const auto &sb = block.sb;
       // s1 is within block:
       blocklen = (s1 - block.start).as_size_t();
@@ -463,7 +636,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
       else
          // Special case of a whole block
          AppendBlock(pUseFactory, format,
-            dest->mBlock, dest->mNumSamples, block);
+            dest->MutableBlocks(), dest->mNumSamples, block);
          // Increase ref count or duplicate file
    }
 
@@ -529,7 +702,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       THROW_INCONSISTENCY_EXCEPTION;
    }
 
-   const BlockArray &srcBlock = src->mBlock;
+   const BlockArray &srcBlock = src->Blocks();
    auto addedLen = src->mNumSamples;
    const unsigned int srcNumBlocks = srcBlock.size();
    auto sampleSize = SAMPLE_SIZE(format);
@@ -537,7 +710,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    if (addedLen == 0 || srcNumBlocks == 0)
       return;
 
-   const size_t numBlocks = mBlock.size();
+   const size_t numBlocks = Blocks().size();
 
    // Decide whether to share sample blocks or make new copies, when whole block
    // contents are used -- must copy if factories are different:
@@ -545,13 +718,13 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       (src->mpFactory == mpFactory) ? nullptr : mpFactory.get();
 
    if (numBlocks == 0 ||
-       (s == mNumSamples && mBlock.back().sb->GetSampleCount() >= mMinSamples)) {
+       (s == mNumSamples && Blocks().back().sb->GetSampleCount() >= mMinSamples)) {
       // Special case: this track is currently empty, or it's safe to append
       // onto the end because the current last block is longer than the
       // minimum size
 
       // Build and swap a copy so there is a strong exception safety guarantee
-      BlockArray newBlock{ mBlock };
+      BlockArray newBlock{ Blocks() };
       sampleCount samples = mNumSamples;
       for (unsigned int i = 0; i < srcNumBlocks; i++)
          // AppendBlock may throw for limited disk space, if pasting from
@@ -560,24 +733,31 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
             newBlock, samples, srcBlock[i]);
 
       CommitChangesIfConsistent
-         (newBlock, samples, wxT("Paste branch one"));
+         (newBlock, samples, wxT("Paste branch one"), numBlocks);
       mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
       return;
    }
 
-   const int b = (s == mNumSamples) ? mBlock.size() - 1 : FindBlock(s);
+   const int b = (s == mNumSamples) ? Blocks().size() - 1 : FindBlock(s);
    wxASSERT((b >= 0) && (b < (int)numBlocks));
-   SeqBlock *const pBlock = &mBlock[b];
+   const SeqBlock *const pBlock = &Blocks()[b];
    const auto length = pBlock->sb->GetSampleCount();
    const auto largerBlockLen = addedLen + length;
+   // When the paste point is at a block boundary, and no pasted block is
+   // below the minimum size, sharing the pasted blocks in case three makes no
+   // small block, so there is nothing to gain from rewriting them
+   const bool shareAligned = !pUseFactory &&
+      (s == pBlock->start || s == pBlock->start + length) &&
+      std::all_of(srcBlock.begin(), srcBlock.end(), [&](const SeqBlock &block){
+         return block.sb->GetSampleCount() >= mMinSamples; });
    // PRL: when insertion point is the first sample of a block,
    // and the following test fails, perhaps we could test
    // whether coalescence with the previous block is possible.
-   if (largerBlockLen <= mMaxSamples) {
+   if (largerBlockLen <= mMaxSamples && !shareAligned) {
       // Special case: we can fit all of the NEW samples inside of
       // one block!
 
-      SeqBlock &block = *pBlock;
+      SeqBlock &block = MutableBlocks()[b];
       // largerBlockLen is not more than mMaxSamples...
       SampleBuffer buffer(largerBlockLen.as_size_t(), format);
 
@@ -602,31 +782,66 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // if we modify only one block in place.
 
       // use No-fail-guarantee in remaining steps
+      auto &blocks = MutableBlocks();
       for (unsigned int i = b + 1; i < numBlocks; i++)
-         mBlock[i].start += addedLen;
+         blocks[i].start += addedLen;
 
       mNumSamples += addedLen;
 
       // This consistency check won't throw, it asserts.
       // Proof that we kept consistency is not hard.
-      ConsistencyCheck(wxT("Paste branch two"), false);
+      ConsistencyCheck(wxT("Paste branch two"), false, b);
       mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
       return;
    }
 
-   // Case three: if we are inserting four or fewer blocks,
-   // it's simplest to just lump all the data together
-   // into one big block along with the split block,
-   // then resplit it all
    BlockArray newBlock;
    newBlock.reserve(numBlocks + srcNumBlocks + 2);
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b);
+   newBlock.insert(newBlock.end(), Blocks().begin(), Blocks().begin() + b);
 
-   SeqBlock &splitBlock = mBlock[b];
+   const SeqBlock &splitBlock = Blocks()[b];
    auto splitLen = splitBlock.sb->GetSampleCount();
    // s lies within splitBlock
    auto splitPoint = ( s - splitBlock.start ).as_size_t();
 
+   if (!pUseFactory) {
+      // Case three: the pasted blocks can be shared.  Split the block at the
+      // paste point, tolerating pieces smaller than the minimum, rather than
+      // reading and writing again the pasted samples.  Then an edit costs
+      // the input and output of one block at most, however often it is
+      // repeated near the same place.
+      const auto piece = [&](size_t from, size_t len)
+         -> SeqBlock::SampleBlockPtr {
+         if (len == splitLen)
+            return splitBlock.sb;
+         SampleBuffer buffer(len, format);
+         Read(buffer.ptr(), format, splitBlock, from, len, true);
+         return mpFactory->Create(buffer.ptr(), len, format);
+      };
+      if (splitPoint > 0)
+         newBlock.push_back(
+            SeqBlock(piece(0, splitPoint), splitBlock.start));
+      for (const auto &block : srcBlock)
+         newBlock.push_back(block.Plus(s));
+      if (splitPoint < splitLen)
+         newBlock.push_back(SeqBlock(
+            piece(splitPoint, splitLen - splitPoint), s + addedLen));
+
+      for (size_t i = b + 1; i < numBlocks; i++)
+         newBlock.push_back(Blocks()[i].Plus(addedLen));
+
+      CommitChangesIfConsistent
+         (newBlock, mNumSamples + addedLen, wxT("Paste branch three"), b);
+
+      mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
+      return;
+   }
+
+   // Case four: when copying blocks from another project, if we are
+   // inserting four or fewer blocks, it's simplest to just lump all the data
+   // together into one big block along with the split block, then resplit it
+   // all
+
    unsigned int i;
    if (srcNumBlocks <= 4) {
 
@@ -693,10 +908,10 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    // Copy remaining blocks to NEW block array and
    // swap the NEW block array in for the old
    for (i = b + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(addedLen));
+      newBlock.push_back(Blocks()[i].Plus(addedLen));
 
    CommitChangesIfConsistent
-      (newBlock, mNumSamples + addedLen, wxT("Paste branch three"));
+      (newBlock, mNumSamples + addedLen, wxT("Paste branch four"), b);
 
    mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
 }
@@ -732,7 +947,7 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
    // Could nBlocks overflow a size_t?  Not very likely.  You need perhaps
    // 2 ^ 52 samples which is over 3000 years at 44.1 kHz.
    auto nBlocks = (len + idealSamples - 1) / idealSamples;
-   sTrack.mBlock.reserve(nBlocks.as_size_t());
+   sTrack.MutableBlocks().reserve(nBlocks.as_size_t());
 
    const auto format = mSampleFormats.Stored();
    if (len >= idealSamples) {
@@ -740,7 +955,7 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
          idealSamples,
          format);
       while (len >= idealSamples) {
-         sTrack.mBlock.push_back(SeqBlock(silentFile, pos));
+         sTrack.MutableBlocks().push_back(SeqBlock(silentFile, pos));
 
          pos += idealSamples;
          len -= idealSamples;
@@ -748,7 +963,7 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
    }
    if (len != 0) {
       // len is not more than idealSamples:
-      sTrack.mBlock.push_back(SeqBlock(
+      sTrack.MutableBlocks().push_back(SeqBlock(
          factory.CreateSilent(len.as_size_t(), format), pos));
       pos += len;
    }
@@ -781,7 +996,7 @@ void Sequence::AppendBlock( SampleBlockFactory *pFactory, sampleFormat format,
 sampleCount Sequence::GetBlockStart(sampleCount position) const
 {
    int b = FindBlock(position);
-   return mBlock[b].start;
+   return Blocks()[b].start;
 }
 
 size_t Sequence::GetBestBlockSize(sampleCount start) const
@@ -795,15 +1010,15 @@ size_t Sequence::GetBestBlockSize(sampleCount start) const
       return mMaxSamples;
 
    int b = FindBlock(start);
-   int numBlocks = mBlock.size();
+   int numBlocks = Blocks().size();
 
-   const SeqBlock &block = mBlock[b];
+   const SeqBlock &block = Blocks()[b];
    // start is in block:
    auto result = (block.start + block.sb->GetSampleCount() - start).as_size_t();
 
    decltype(result) length;
    while(result < mMinSamples && b+1<numBlocks &&
-         ((length = mBlock[b+1].sb->GetSampleCount()) + result) <= mMaxSamples) {
+         ((length = Blocks()[b+1].sb->GetSampleCount()) + result) <= mMaxSamples) {
       b++;
       result += length;
    }
@@ -857,7 +1072,7 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
          }
       }
 
-      mBlock.push_back(wb);
+      MutableBlocks().push_back(wb);
 
       return true;
    }
@@ -957,11 +1172,27 @@ void Sequence::HandleXMLEndTag(const std::string_view& tag)
 
    // Make sure that the sequence is valid.
 
+   // If the starts in the document are consistent, let the blocks take their
+   // lengths from them, so that lazily loaded blocks need not be fetched now
+   const auto nBlocks = Blocks().size();
+   const auto length = [&](size_t b) {
+      return (b + 1 < nBlocks ? Blocks()[b + 1].start : mNumSamples) -
+         Blocks()[b].start;
+   };
+   bool consistent = nBlocks == 0 || Blocks()[0].start == 0;
+   for (size_t b = 0; consistent && b < nBlocks; ++b) {
+      const auto len = length(b);
+      consistent = len > 0 && len <= sampleCount{ mMaxSamples };
+   }
+   if (consistent)
+      for (size_t b = 0; b < nBlocks; ++b)
+         Blocks()[b].sb->SuggestSampleCount(length(b).as_size_t());
+
    // Make sure that start times and lengths are consistent
    sampleCount numSamples = 0;
-   for (unsigned b = 0, nn = mBlock.size(); b < nn;  b++)
+   for (unsigned b = 0, nn = Blocks().size(); b < nn;  b++)
    {
-      SeqBlock &block = mBlock[b];
+      SeqBlock &block = MutableBlocks()[b];
       if (block.start != numSamples)
       {
          wxLogWarning(
@@ -1016,8 +1247,8 @@ void Sequence::WriteXML(XMLWriter &xmlFile) const
       static_cast<size_t>( mSampleFormats.Effective() ));
    xmlFile.WriteAttr(NumSamples_attr, mNumSamples.as_long_long() );
 
-   for (b = 0; b < mBlock.size(); b++) {
-      const SeqBlock &bb = mBlock[b];
+   for (b = 0; b < Blocks().size(); b++) {
+      const SeqBlock &bb = Blocks()[b];
 
       // See http://bugzilla.audacityteam.org/show_bug.cgi?id=451.
       if (bb.sb->GetSampleCount() > mMaxSamples)
@@ -1059,7 +1290,7 @@ int Sequence::FindBlock(sampleCount pos) const
    if (pos == 0)
       return 0;
 
-   int numBlocks = mBlock.size();
+   int numBlocks = Blocks().size();
 
    size_t lo = 0, hi = numBlocks, guess;
    sampleCount loSamples = 0, hiSamples = mNumSamples;
@@ -1071,7 +1302,7 @@ int Sequence::FindBlock(sampleCount pos) const
       const double frac = (pos - loSamples).as_double() /
          (hiSamples - loSamples).as_double();
       guess = std::min(hi - 1, lo + size_t(frac * (hi - lo)));
-      const SeqBlock &block = mBlock[guess];
+      const SeqBlock &block = Blocks()[guess];
 
       wxASSERT(block.sb->GetSampleCount() > 0);
       wxASSERT(lo <= guess && guess < hi && lo < hi);
@@ -1095,8 +1326,8 @@ int Sequence::FindBlock(sampleCount pos) const
 
    const int rval = guess;
    wxASSERT(rval >= 0 && rval < numBlocks &&
-            pos >= mBlock[rval].start &&
-            pos < mBlock[rval].start + mBlock[rval].sb->GetSampleCount());
+            pos >= Blocks()[rval].start &&
+            pos < Blocks()[rval].start + Blocks()[rval].sb->GetSampleCount());
 
    return rval;
 }
@@ -1136,13 +1367,25 @@ AudioSegmentSampleView Sequence::GetFloatSampleView(
    while (cursor < start + length)
    {
       const auto b = FindBlock(cursor);
-      const SeqBlock& block = mBlock[b];
+      const SeqBlock& block = Blocks()[b];
       blockViews.push_back(block.sb->GetFloatSampleView(mayThrow));
       cursor = block.start + block.sb->GetSampleCount();
    }
    return { std::move(blockViews), sequenceOffset, length };
 }
 
+void Sequence::GetBlocks(sampleCount start, sampleCount len,
+   std::vector<std::shared_ptr<SampleBlock>> &blocks) const
+{
+   const auto end = std::min(start + len, mNumSamples);
+   start = std::max<sampleCount>(start, 0);
+   if (start >= end)
+      return;
+   for (auto b = FindBlock(start);
+        b < static_cast<int>(Blocks().size()) && Blocks()[b].start < end; ++b)
+      blocks.push_back(Blocks()[b].sb);
+}
+
 bool Sequence::Get(samplePtr buffer, sampleFormat format,
    sampleCount start, size_t len, bool mayThrow) const
 {
@@ -1187,7 +1430,7 @@ bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
 {
    bool result = true;
    while (len) {
-      const SeqBlock &block = mBlock[b];
+      const SeqBlock &block = Blocks()[b];
       // start is in block
       const auto bstart = (start - block.start).as_size_t();
       // bstart is not more than block length
@@ -1212,7 +1455,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
    effectiveFormat = std::min(effectiveFormat, format);
    auto &factory = *mpFactory;
 
-   const auto size = mBlock.size();
+   const auto size = Blocks().size();
 
    if (start < 0 || start + len > mNumSamples)
       THROW_INCONSISTENCY_EXCEPTION;
@@ -1228,8 +1471,9 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
    }
 
    int b = FindBlock(start);
+   const size_t firstChanged = b;
    BlockArray newBlock;
-   std::copy( mBlock.begin(), mBlock.begin() + b, std::back_inserter(newBlock) );
+   std::copy( Blocks().begin(), Blocks().begin() + b, std::back_inserter(newBlock) );
 
    while (len > 0
       // Redundant termination condition,
@@ -1238,7 +1482,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       // that cause the loop to make no progress because blen == 0
       && b < (int)size
    ) {
-      newBlock.push_back( mBlock[b] );
+      newBlock.push_back( Blocks()[b] );
       SeqBlock &block = newBlock.back();
       // start is within block
       const auto bstart = ( start - block.start ).as_size_t();
@@ -1315,22 +1559,23 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       b++;
    }
 
-   std::copy( mBlock.begin() + b, mBlock.end(), std::back_inserter(newBlock) );
+   std::copy( Blocks().begin() + b, Blocks().end(), std::back_inserter(newBlock) );
 
-   CommitChangesIfConsistent( newBlock, mNumSamples, wxT("SetSamples") );
+   CommitChangesIfConsistent(
+      newBlock, mNumSamples, wxT("SetSamples"), firstChanged );
 
    mSampleFormats.UpdateEffective(effectiveFormat);
 }
 
 size_t Sequence::GetIdealAppendLen() const
 {
-   int numBlocks = mBlock.size();
+   int numBlocks = Blocks().size();
    const auto max = GetMaxBlockSize();
 
    if (numBlocks == 0)
       return max;
 
-   const auto lastBlockLen = mBlock.back().sb->GetSampleCount();
+   const auto lastBlockLen = Blocks().back().sb->GetSampleCount();
    if (lastBlockLen >= max)
       return max;
    else
@@ -1405,6 +1650,22 @@ bool Sequence::Append(
       if (len == 0)
          break;
 
+      if (mAppendBufferLen == 0 && stride == 1 &&
+          !(seqFormat < effectiveFormat) && len >= 2 * blockSize) {
+         // Nothing to dither, so bypass mAppendBuffer and make several
+         // whole blocks at once, which the factory may do in parallel
+         // use Strong-guarantee
+         const auto batchLen = len - len % blockSize;
+         DoAppend(buffer, format, batchLen, true);
+         mSampleFormats.UpdateEffective(effectiveFormat);
+         result = true;
+
+         buffer += batchLen * SAMPLE_SIZE(format);
+         len -= batchLen;
+         blockSize = GetIdealAppendLen();
+         continue;
+      }
+
       // use No-fail-guarantee for rest of this "for"
       wxASSERT(mAppendBufferLen <= mMaxSamples);
       auto toCopy = std::min(len, mMaxSamples - mAppendBufferLen);
@@ -1446,8 +1707,8 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
    sampleCount newNumSamples = mNumSamples;
 
    // If the last block is not full, we need to add samples to it
-   int numBlocks = mBlock.size();
-   SeqBlock *pLastBlock;
+   int numBlocks = Blocks().size();
+   const SeqBlock *pLastBlock;
    decltype(pLastBlock->sb->GetSampleCount()) length;
    size_t bufferSize = mMaxSamples;
    const auto dstFormat = mSampleFormats.Stored();
@@ -1456,7 +1717,7 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
    if (coalesce &&
        numBlocks > 0 &&
        (length =
-        (pLastBlock = &mBlock.back())->sb->GetSampleCount()) < mMinSamples) {
+        (pLastBlock = &Blocks().back())->sb->GetSampleCount()) < mMinSamples) {
       // Enlarge a sub-minimum block at the end
       const SeqBlock &lastBlock = *pLastBlock;
       const auto addLen = std::min(mMaxSamples - length, len);
@@ -1486,6 +1747,32 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
       replaceLast = true;
    }
    // Append the rest as NEW blocks
+   if (len > GetIdealBlockSize()) {
+      // Let the factory make all the blocks at once, perhaps in parallel
+      SampleBuffer converted;
+      if (format != dstFormat) {
+         converted.Allocate(len, dstFormat);
+         CopySamples(buffer, format, converted.ptr(), dstFormat,
+            len, DitherType::none);
+         buffer = converted.ptr();
+      }
+      std::vector<SampleBlockFactory::BlockSource> sources;
+      for (size_t offset = 0; offset < len;) {
+         const auto addedLen = std::min(GetIdealBlockSize(), len - offset);
+         sources.push_back({
+            buffer + offset * SAMPLE_SIZE(dstFormat), addedLen });
+         offset += addedLen;
+      }
+      for (auto &pBlock : factory.CreateMany(sources, dstFormat)) {
+         const auto addedLen = pBlock->GetSampleCount();
+         newBlock.push_back(SeqBlock(pBlock, newNumSamples));
+         newNumSamples += addedLen;
+         len -= addedLen;
+      }
+      // It's expected that when not requesting coalescence, the
+      // data should fit in one block
+      wxASSERT( coalesce );
+   }
    while (len) {
       const auto idealSamples = GetIdealBlockSize();
       const auto addedLen = std::min(idealSamples, len);
@@ -1586,7 +1873,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
    auto &factory = *mpFactory;
 
-   const unsigned int numBlocks = mBlock.size();
+   const unsigned int numBlocks = Blocks().size();
 
    const unsigned int b0 = FindBlock(start);
    unsigned int b1 = FindBlock(start + len - 1);
@@ -1594,7 +1881,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    const auto format = mSampleFormats.Stored();
    auto sampleSize = SAMPLE_SIZE(format);
 
-   SeqBlock *pBlock;
+   const SeqBlock *pBlock;
    decltype(pBlock->sb->GetSampleCount()) length;
 
    // One buffer for reuse in various branches here
@@ -1606,8 +1893,8 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // block and the resulting length is not too small, perform the
    // deletion within this block:
    if (b0 == b1 &&
-       (length = (pBlock = &mBlock[b0])->sb->GetSampleCount()) - len >= mMinSamples) {
-      SeqBlock &b = *pBlock;
+       (length = (pBlock = &Blocks()[b0])->sb->GetSampleCount()) - len >= mMinSamples) {
+      SeqBlock &b = MutableBlocks()[b0];
       // start is within block
       auto pos = ( start - b.start ).as_size_t();
 
@@ -1635,14 +1922,15 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
       // use No-fail-guarantee in remaining steps
 
+      auto &blocks = MutableBlocks();
       for (unsigned int j = b0 + 1; j < numBlocks; j++)
-         mBlock[j].start -= len;
+         blocks[j].start -= len;
 
       mNumSamples -= len;
 
       // This consistency check won't throw, it asserts.
       // Proof that we kept consistency is not hard.
-      ConsistencyCheck(wxT("Delete - branch one"), false);
+      ConsistencyCheck(wxT("Delete - branch one"), false, b0);
       return;
    }
 
@@ -1652,19 +1940,23 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
    // Copy the blocks before the deletion point over to
    // the NEW array
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b0);
+   newBlock.insert(newBlock.end(), Blocks().begin(), Blocks().begin() + b0);
+   size_t firstChanged = b0;
    unsigned int i;
 
    // First grab the samples in block b0 before the deletion point
    // into preBuffer.  If this is enough samples for its own block,
-   // or if this would be the first block in the array, write it out.
+   // or if this would be the first block in the array, or if the previous
+   // block is not small either, write it out, tolerating a small block rather
+   // than rewriting a big one.
    // Otherwise combine it with the previous block (splitting them
    // 50/50 if necessary).
-   const SeqBlock &preBlock = mBlock[b0];
+   const SeqBlock &preBlock = Blocks()[b0];
    // start is within preBlock
    auto preBufferLen = ( start - preBlock.start ).as_size_t();
    if (preBufferLen) {
-      if (preBufferLen >= mMinSamples || b0 == 0) {
+      if (preBufferLen >= mMinSamples || b0 == 0 ||
+          Blocks()[b0 - 1].sb->GetSampleCount() >= mMinSamples) {
          if (!scratch.ptr())
             scratch.Allocate(scratchSize, format);
          ensureSampleBufferSize(scratch, format, scratchSize, preBufferLen);
@@ -1674,7 +1966,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.push_back(SeqBlock(pFile, preBlock.start));
       } else {
-         const SeqBlock &prepreBlock = mBlock[b0 - 1];
+         const SeqBlock &prepreBlock = Blocks()[b0 - 1];
          const auto prepreLen = prepreBlock.sb->GetSampleCount();
          const auto sum = prepreLen + preBufferLen;
 
@@ -1688,6 +1980,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
               preBlock, 0, preBufferLen, true);
 
          newBlock.pop_back();
+         --firstChanged;
          Blockify(*mpFactory, mMaxSamples, format,
                   newBlock, prepreBlock.start, scratch.ptr(), sum);
       }
@@ -1700,15 +1993,17 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // Now, symmetrically, grab the samples in block b1 after the
    // deletion point into postBuffer.  If this is enough samples
    // for its own block, or if this would be the last block in
-   // the array, write it out.  Otherwise combine it with the
-   // subsequent block (splitting them 50/50 if necessary).
-   const SeqBlock &postBlock = mBlock[b1];
+   // the array, or if the subsequent block is not small, write it out.
+   // Otherwise combine it with the subsequent block (splitting them 50/50 if
+   // necessary).
+   const SeqBlock &postBlock = Blocks()[b1];
    // start + len - 1 lies within postBlock
    const auto postBufferLen = (
        (postBlock.start + postBlock.sb->GetSampleCount()) - (start + len)
    ).as_size_t();
    if (postBufferLen) {
-      if (postBufferLen >= mMinSamples || b1 == numBlocks - 1) {
+      if (postBufferLen >= mMinSamples || b1 == numBlocks - 1 ||
+          Blocks()[b1 + 1].sb->GetSampleCount() >= mMinSamples) {
          if (!scratch.ptr())
             // Last use of scratch, can ask for smaller
             scratch.Allocate(postBufferLen, format);
@@ -1720,7 +2015,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.push_back(SeqBlock(file, start));
       } else {
-         SeqBlock &postpostBlock = mBlock[b1 + 1];
+         const SeqBlock &postpostBlock = Blocks()[b1 + 1];
          const auto postpostLen = postpostBlock.sb->GetSampleCount();
          const auto sum = postpostLen + postBufferLen;
 
@@ -1745,15 +2040,18 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
    // Copy the remaining blocks over from the old array
    for (i = b1 + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(-len));
+      newBlock.push_back(Blocks()[i].Plus(-len));
 
    CommitChangesIfConsistent
-      (newBlock, mNumSamples - len, wxT("Delete - branch two"));
+      (newBlock, mNumSamples - len, wxT("Delete - branch two"), firstChanged);
 }
 
-void Sequence::ConsistencyCheck(const wxChar *whereStr, bool mayThrow) const
+void Sequence::ConsistencyCheck(
+   const wxChar *whereStr, bool mayThrow, size_t from) const
 {
-   ConsistencyCheck(mBlock, mMaxSamples, 0, mNumSamples, whereStr, mayThrow);
+   // Check the block before too, so that its end meets the first changed one
+   ConsistencyCheck(Blocks(), mMaxSamples, from > 0 ? from - 1 : 0,
+      mNumSamples, whereStr, mayThrow);
 }
 
 void Sequence::ConsistencyCheck
@@ -1808,14 +2106,21 @@ void Sequence::ConsistencyCheck
 }
 
 void Sequence::CommitChangesIfConsistent
-   (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr)
+   (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr,
+    size_t from)
 {
-   ConsistencyCheck( newBlock, mMaxSamples, 0, numSamples, whereStr ); // may throw
+   // may throw
+   ConsistencyCheck( newBlock, mMaxSamples, from > 0 ? from - 1 : 0,
+      numSamples, whereStr );
+
+   if (mpBlock.use_count() > 1)
+      // Leave the old blocks to the copies that share them
+      mpBlock = std::make_shared<BlockArray>();
 
    // now commit
    // use No-fail-guarantee
 
-   mBlock.swap(newBlock);
+   mpBlock->swap(newBlock);
    mNumSamples = numSamples;
 }
 
@@ -1829,31 +2134,33 @@ void Sequence::AppendBlocksIfConsistent
    if (additionalBlocks.empty())
       return;
 
+   auto &blocks = MutableBlocks();
+
    bool tmpValid = false;
    SeqBlock tmp;
 
-   if ( replaceLast && ! mBlock.empty() ) {
-      tmp = mBlock.back(), tmpValid = true;
-      mBlock.pop_back();
+   if ( replaceLast && ! blocks.empty() ) {
+      tmp = blocks.back(), tmpValid = true;
+      blocks.pop_back();
    }
 
-   auto prevSize = mBlock.size();
+   auto prevSize = blocks.size();
 
    bool consistent = false;
    auto cleanup = finally( [&] {
       if ( !consistent ) {
-         mBlock.resize( prevSize );
+         blocks.resize( prevSize );
          if ( tmpValid )
-            mBlock.push_back( tmp );
+            blocks.push_back( tmp );
       }
    } );
 
    std::copy( additionalBlocks.begin(), additionalBlocks.end(),
-              std::back_inserter( mBlock ) );
+              std::back_inserter( blocks ) );
 
    // Check consistency only of the blocks that were added,
    // avoiding quadratic time for repeated checking of repeating appends
-   ConsistencyCheck( mBlock, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
+   ConsistencyCheck( blocks, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
 
    // now commit
    // use No-fail-guarantee
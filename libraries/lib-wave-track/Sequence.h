@@ -12,6 +12,7 @@
 #define __AUDACITY_SEQUENCE__
 
 
+#include <memory>
 #include <vector>
 #include <functional>
 
@@ -107,6 +108,10 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    AudioSegmentSampleView
    GetFloatSampleView(sampleCount start, size_t len, bool mayThrow) const;
 
+   //! Append to `blocks` those holding any of the `len` samples from `start`
+   void GetBlocks(sampleCount start, sampleCount len,
+      std::vector<std::shared_ptr<SampleBlock>> &blocks) const;
+
    //! Pass nullptr to set silence
    /*! Note that len is not size_t, because nullptr may be passed for buffer, in
       which case, silence is inserted, possibly a large amount. */
@@ -214,6 +219,16 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    std::pair<float, float> GetMinMax(
       sampleCount start, sampleCount len, bool mayThrow) const;
    float GetRMS(sampleCount start, sampleCount len, bool mayThrow) const;
+   //! Sum of the samples, from block summaries where blocks are whole
+   double GetSum(sampleCount start, sampleCount len, bool mayThrow) const;
+   //! How many samples from start, at most len, are less than threshold in
+   //! magnitude, as far as the block summaries show without reading samples
+   /*!
+    The result is a whole number of summary frames of 256 samples, less any
+    before start, or until the end of the region
+    */
+   sampleCount GetQuietLength(sampleCount start, sampleCount len,
+      float threshold, bool mayThrow) const;
 
    //
    // Getting block size and alignment information
@@ -229,8 +244,9 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    // you're doing!
    //
 
-   BlockArray &GetBlockArray() { return mBlock; }
-   const BlockArray &GetBlockArray() const { return mBlock; }
+   //! Unshares the blocks from copies of this sequence
+   BlockArray &GetBlockArray() { return MutableBlocks(); }
+   const BlockArray &GetBlockArray() const { return Blocks(); }
 
    size_t GetAppendBufferLen() const { return mAppendBufferLen; }
    constSamplePtr GetAppendBuffer() const { return mAppendBuffer.ptr(); }
@@ -249,7 +265,9 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
 
    SampleBlockFactoryPtr mpFactory;
 
-   BlockArray    mBlock;
+   //! Shared with copies of this sequence in the same project, until one
+   //! of them changes
+   std::shared_ptr<BlockArray> mpBlock{ std::make_shared<BlockArray>() };
    SampleFormats  mSampleFormats;
 
    // Not size_t!  May need to be large:
@@ -268,6 +286,10 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    // Private methods
    //
 
+   const BlockArray &Blocks() const { return *mpBlock; }
+   //! The blocks to be changed, copied first if shared
+   BlockArray &MutableBlocks();
+
    //! @return possibly a large or negative value
    sampleCount GetBlockStart(sampleCount position) const;
 
@@ -313,7 +335,12 @@ public:
 
    // This function throws if the track is messed up
    // because of inconsistent block starts & lengths
-   void ConsistencyCheck (const wxChar *whereStr, bool mayThrow = true) const;
+   /*!
+    @param from index of the first block that may have changed; those before
+    it are not checked again, except for the one just before
+    */
+   void ConsistencyCheck (const wxChar *whereStr, bool mayThrow = true,
+      size_t from = 0) const;
 
    // This function prints information to stdout about the blocks in the
    // tracks and indicates if there are inconsistencies.
@@ -330,8 +357,13 @@ private:
    // They either throw because final consistency check fails, or swap the
    // changed contents into place.
 
+   /*!
+    @param from how many of the first blocks of `newBlock` are copied
+    unchanged from this sequence, and need not be checked again
+    */
    void CommitChangesIfConsistent
-      (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr);
+      (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr,
+       size_t from = 0);
 
    void AppendBlocksIfConsistent
       (BlockArray &additionalBlocks, bool replaceLast,
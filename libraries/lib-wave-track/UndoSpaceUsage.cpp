@@ -0,0 +1,268 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoSpaceUsage.cpp
+
+**********************************************************************/
+#include "UndoSpaceUsage.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "Project.h"
+#include "SampleBlock.h"
+#include "Sequence.h"
+#include "UndoManager.h"
+#include "UndoTracks.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+#include "WaveTrackUtilities.h"
+
+namespace {
+using Bytes = unsigned long long;
+
+struct BlockChange {
+   SampleBlockID id;
+   Bytes bytes;
+};
+
+//! The blocks of a state, as changes to the blocks of its base
+struct Node {
+   //! Null for a state made from no other
+   std::shared_ptr<Node> base;
+   //! Greater than that of the base
+   size_t depth{ 0 };
+   std::vector<BlockChange> added, removed;
+   //! Of all blocks of the state
+   Bytes bytes{ 0 };
+};
+
+//! Net changes of membership of blocks, and their sizes
+using Changes = std::unordered_map<SampleBlockID, std::pair<int, Bytes>>;
+
+void Apply(Changes &changes, const std::vector<BlockChange> &blocks, int sign)
+{
+   for (auto &block : blocks) {
+      auto &change = changes[block.id];
+      change.first += sign;
+      change.second = block.bytes;
+   }
+}
+
+//! Changes that make the blocks of `from` into those of `to`
+/*! A null node has no blocks */
+Changes Difference(const Node *from, const Node *to)
+{
+   Changes result;
+   // Meet at the common base
+   while (from != to) {
+      if (!to || (from && from->depth >= to->depth)) {
+         Apply(result, from->added, -1);
+         Apply(result, from->removed, +1);
+         from = from->base.get();
+      }
+      else {
+         Apply(result, to->added, +1);
+         Apply(result, to->removed, -1);
+         to = to->base.get();
+      }
+   }
+   return result;
+}
+
+//! Fold into the node the bases of states that were removed
+void Compact(Node &node)
+{
+   // Live states hold their nodes too
+   while (node.base && node.base.use_count() == 1) {
+      const auto pBase = std::move(node.base);
+      Changes changes;
+      Apply(changes, pBase->added, +1);
+      Apply(changes, pBase->removed, -1);
+      Apply(changes, node.added, +1);
+      Apply(changes, node.removed, -1);
+      node.added.clear();
+      node.removed.clear();
+      for (auto &[id, change] : changes)
+         if (change.first > 0)
+            node.added.push_back({ id, change.second });
+         else if (change.first < 0)
+            node.removed.push_back({ id, change.second });
+      node.base = pBase->base;
+   }
+}
+
+struct BlocksRestorer final : UndoStateExtension {
+   explicit BlocksRestorer(std::shared_ptr<Node> pNode)
+      : mpNode{ std::move(pNode) }
+   {}
+   void RestoreUndoRedoState(AudacityProject &) override {}
+   const std::shared_ptr<Node> mpNode;
+};
+
+std::shared_ptr<Node> FindNode(const UndoStackElem &state)
+{
+   for (auto &pExtension : state.state.extensions)
+      if (auto pRestorer = dynamic_cast<BlocksRestorer*>(pExtension.get()))
+         return pRestorer->mpNode;
+   return nullptr;
+}
+
+//! Counts blocks of the state last pushed, to find the changes of the next
+struct BlockCounts final : ClientData::Base {
+   static BlockCounts &Get(AudacityProject &project);
+
+   //! How many sequences of the state use each block
+   std::unordered_map<SampleBlockID, size_t> counts;
+   //! The state counted
+   std::weak_ptr<Node> wNode;
+};
+
+static const AudacityProject::AttachedObjects::RegisteredFactory sKey{
+   [](AudacityProject &) { return std::make_unique<BlockCounts>(); }
+};
+
+BlockCounts &BlockCounts::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<BlockCounts>(sKey);
+}
+
+using Arrays = std::vector<const BlockArray *>;
+
+//! Arrays of blocks of sequences of tracks, as UndoTracks copies them
+Arrays GetArrays(const TrackList &tracks)
+{
+   Arrays result;
+   for (auto pTrack : tracks.Any<const WaveTrack>()) {
+      if (pTrack->GetId() == TrackId{})
+         // A pending added track
+         continue;
+      for (const auto &pClip : WaveTrackUtilities::GetAllClips(*pTrack))
+         for (const auto &pChannel : pClip->Channels())
+            result.push_back(pChannel->GetSequenceBlockArray());
+   }
+   std::sort(result.begin(), result.end(), std::less<>{});
+   return result;
+}
+
+std::shared_ptr<Node> Save(AudacityProject &project)
+{
+   auto &manager = UndoManager::Get(project);
+   auto &blockCounts = BlockCounts::Get(project);
+   auto &counts = blockCounts.counts;
+
+   // The state that the new one is made from, while it is still in the stack
+   std::shared_ptr<Node> pBase;
+   const TrackList *pBaseTracks = nullptr;
+   if (const auto current = manager.GetCurrentState();
+       current < manager.GetNumStates())
+      manager.VisitStates([&](const UndoStackElem &elem) {
+         pBase = FindNode(elem);
+         pBaseTracks = UndoTracks::Find(elem);
+      }, current, current + 1);
+   if (!pBaseTracks)
+      pBase.reset();
+   const auto baseArrays = pBaseTracks ? GetArrays(*pBaseTracks) : Arrays{};
+
+   // Count anew only after undo or redo
+   if (!pBase || blockCounts.wNode.lock() != pBase) {
+      counts.clear();
+      for (auto pArray : baseArrays)
+         for (auto &block : *pArray)
+            if (block.sb)
+               ++counts[block.sb->GetBlockID()];
+   }
+
+   const auto arrays = GetArrays(TrackList::Get(project));
+   Arrays entering, leaving;
+   std::set_difference(arrays.begin(), arrays.end(),
+      baseArrays.begin(), baseArrays.end(), back_inserter(entering),
+      std::less<>{});
+   std::set_difference(baseArrays.begin(), baseArrays.end(),
+      arrays.begin(), arrays.end(), back_inserter(leaving), std::less<>{});
+
+   auto pNode = std::make_shared<Node>();
+   Bytes bytes = pBase ? pBase->bytes : 0;
+   // Count entering blocks first, so that those only moving from one
+   // sequence to another don't leave
+   for (auto pArray : entering)
+      for (auto &block : *pArray)
+         if (auto &pBlock = block.sb;
+             pBlock && counts[pBlock->GetBlockID()]++ == 0) {
+            const Bytes size = pBlock->GetSpaceUsage();
+            pNode->added.push_back({ pBlock->GetBlockID(), size });
+            bytes += size;
+         }
+   for (auto pArray : leaving)
+      for (auto &block : *pArray)
+         if (auto &pBlock = block.sb) {
+            const auto iter = counts.find(pBlock->GetBlockID());
+            if (iter != counts.end() && --iter->second == 0) {
+               counts.erase(iter);
+               const Bytes size = pBlock->GetSpaceUsage();
+               pNode->removed.push_back({ pBlock->GetBlockID(), size });
+               bytes -= size;
+            }
+         }
+
+   pNode->depth = pBase ? pBase->depth + 1 : 1;
+   pNode->base = std::move(pBase);
+   pNode->bytes = bytes;
+   Compact(*pNode);
+   blockCounts.wNode = pNode;
+   return pNode;
+}
+
+UndoRedoExtensionRegistry::Entry sEntry {
+   [](AudacityProject &project) -> std::shared_ptr<UndoStateExtension> {
+      return std::make_shared<BlocksRestorer>(Save(project));
+   }
+};
+}
+
+std::vector<unsigned long long>
+UndoSpaceUsage::Calculate(AudacityProject &project)
+{
+   std::vector<std::shared_ptr<Node>> nodes;
+   UndoManager::Get(project).VisitStates([&](const UndoStackElem &elem) {
+      nodes.push_back(FindNode(elem));
+   }, false);
+
+   std::vector<Bytes> result(nodes.size());
+   if (nodes.empty())
+      return result;
+
+   for (auto &pNode : nodes)
+      if (pNode)
+         Compact(*pNode);
+
+   // Blocks of the newest state are the counted ones, with few changes
+   auto &blockCounts = BlockCounts::Get(project);
+   const auto pCounted = blockCounts.wNode.lock();
+   const auto &pNewest = nodes.back();
+   const auto toNewest = Difference(pCounted.get(), pNewest.get());
+   const auto inNewest = [&](SampleBlockID id) {
+      if (const auto iter = toNewest.find(id);
+          iter != toNewest.end() && iter->second.first != 0)
+         return iter->second.first > 0;
+      return pCounted && blockCounts.counts.count(id) > 0;
+   };
+
+   result.back() = pNewest ? pNewest->bytes : 0;
+
+   // Older states count only blocks that no newer one uses
+   std::unordered_set<SampleBlockID> seen;
+   for (auto ii = nodes.size() - 1; ii-- > 0;)
+      for (auto &[id, change] :
+           Difference(nodes[ii + 1].get(), nodes[ii].get()))
+         if (change.first > 0 && !inNewest(id) && seen.insert(id).second)
+            result[ii] += change.second;
+
+   return result;
+}
@@ -0,0 +1,28 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoSpaceUsage.h
+
+**********************************************************************/
+#pragma once
+
+#include <vector>
+
+class AudacityProject;
+
+//! Keeps account of the sample blocks of states of undo history
+/*!
+ Each pushed state records only the blocks that entered or left the tracks
+ since the state it was made from.  Sequences share their arrays of blocks
+ with their copies until changed, so only the arrays that differ are
+ examined.
+ */
+namespace UndoSpaceUsage {
+//! Bytes of sample blocks of each state of undo history, oldest first,
+//! counting each block in the newest state that uses it
+/*! Takes time for the changes between states, not for all of their blocks */
+WAVE_TRACK_API std::vector<unsigned long long>
+Calculate(AudacityProject &project);
+}
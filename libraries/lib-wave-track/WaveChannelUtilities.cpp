@@ -92,6 +92,68 @@ float WaveChannelUtilities::GetRMS(const WaveChannel &channel,
    return duration > 0 ? sqrt(sumsq / duration) : 0.0;
 }
 
+std::optional<std::pair<double, sampleCount>>
+WaveChannelUtilities::GetSum(const WaveChannel &channel,
+   double t0, double t1, bool mayThrow)
+{
+   if (t0 > t1) {
+      if (mayThrow)
+         THROW_INCONSISTENCY_EXCEPTION;
+      return std::pair{ 0.0, sampleCount{ 0 } };
+   }
+
+   std::pair<double, sampleCount> result{ 0.0, 0 };
+   for (const auto &clip: channel.Intervals())
+   {
+      if (t1 > clip->GetPlayStartTime() && t0 < clip->GetPlayEndTime())
+      {
+         if (clip->HasPitchOrSpeed())
+            return std::nullopt;
+         const auto [sum, count] = clip->GetSum(t0, t1, mayThrow);
+         result.first += sum;
+         result.second += count;
+      }
+   }
+   return result;
+}
+
+sampleCount WaveChannelUtilities::GetQuietLength(const WaveChannel &channel,
+   sampleCount start, sampleCount len, float threshold, bool mayThrow)
+{
+   const auto end = start + len;
+   auto pos = start;
+   while (pos < end) {
+      // Find the clip at pos, else where the next begins
+      std::shared_ptr<const WaveClipChannel> pClip;
+      auto next = end;
+      for (const auto &clip : channel.Intervals()) {
+         const auto clipStart = clip->GetPlayStartSample();
+         if (clipStart <= pos && pos < clip->GetPlayEndSample()) {
+            pClip = clip;
+            break;
+         }
+         if (clipStart > pos)
+            next = std::min(next, clipStart);
+      }
+      if (!pClip) {
+         // A gap reads as zeroes
+         if (!(threshold > 0))
+            break;
+         pos = next;
+         continue;
+      }
+      if (pClip->HasPitchOrSpeed())
+         break;
+      const auto clipStart = pClip->GetPlayStartSample();
+      const auto clipEnd = std::min(end, pClip->GetPlayEndSample());
+      pos += pClip->GetQuietLength(
+         pos - clipStart, clipEnd - pos, threshold, mayThrow);
+      if (pos < clipEnd)
+         break;
+   }
+   return pos - start;
+}
+
 namespace {
 using namespace WaveChannelUtilities;
 
@@ -19,9 +19,12 @@ enum class sampleFormat : unsigned;
 class WaveChannel;
 class WaveClipChannel;
 
+#include "SampleCount.h"
+
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -87,6 +90,24 @@ WAVE_TRACK_API std::pair<float, float> GetMinMax(const WaveChannel &channel,
 WAVE_TRACK_API float GetRMS(const WaveChannel &channel,
    double t0, double t1, bool mayThrow = true);
 
+/*!
+ Sum and number of the samples of clips between the times, not counting gaps,
+ mostly from block summaries; or nullopt if any of those clips
+ HasPitchOrSpeed(), so that its samples must be rendered
+ */
+WAVE_TRACK_API std::optional<std::pair<double, sampleCount>>
+GetSum(const WaveChannel &channel, double t0, double t1, bool mayThrow = true);
+
+/*!
+ How many samples from start, at most len, are less than threshold in
+ magnitude, as `GetFloats()` would give them, judging from block summaries
+ and gaps between clips, without reading samples; stops at any clip that
+ HasPitchOrSpeed()
+ @param start, len in samples of the channel
+ */
+WAVE_TRACK_API sampleCount GetQuietLength(const WaveChannel &channel,
+   sampleCount start, sampleCount len, float threshold, bool mayThrow = true);
+
 /*!
  @brief Gets as many samples as it can, but no more than `2 *
  numSideSamples + 1`, centered around `t`. Reads nothing if
@@ -18,6 +18,7 @@
 #include <math.h>
 #include <numeric>
 #include <optional>
+#include <utility>
 #include <vector>
 #include <wx/log.h>
 
@@ -51,6 +52,11 @@ void WaveClipListener::MakeStereo(WaveClipListener &&, bool)
 {
 }
 
+void WaveClipListener::MarkAppended() noexcept
+{
+   MarkChanged();
+}
+
 void WaveClipListener::SwapChannels()
 {
 }
@@ -158,6 +164,18 @@ float WaveClipChannel::GetRMS(double t0, double t1, bool mayThrow) const
    return GetClip().GetRMS(miChannel, t0, t1, mayThrow);
 }
 
+std::pair<double, sampleCount>
+WaveClipChannel::GetSum(double t0, double t1, bool mayThrow) const
+{
+   return GetClip().GetSum(miChannel, t0, t1, mayThrow);
+}
+
+sampleCount WaveClipChannel::GetQuietLength(sampleCount start,
+   sampleCount len, float threshold, bool mayThrow) const
+{
+   return GetClip().GetQuietLength(miChannel, start, len, threshold, mayThrow);
+}
+
 sampleCount WaveClipChannel::GetPlayStartSample() const
 {
    return GetClip().GetPlayStartSample();
@@ -370,6 +388,28 @@ AudioSegmentSampleView WaveClip::GetSampleView(
    return GetSampleView(iChannel, start, length, mayThrow);
 }
 
+ClipContentKey WaveClip::GetContentKey() const
+{
+   for (auto &pSequence : mSequences)
+      if (pSequence->GetAppendBufferLen() > 0)
+         return {};
+   // Blocks are never changed once written, so that their ids identify
+   // their samples
+   ClipContentKey key;
+   key.owner = GetFactory();
+   key.ids.push_back(TimeToSamples(mTrimLeft).as_long_long());
+   key.ids.push_back(GetVisibleSampleCount().as_long_long());
+   for (auto &pSequence : mSequences) {
+      const auto &blocks = pSequence->GetBlockArray();
+      key.ids.push_back(blocks.size());
+      for (const auto &block : blocks) {
+         key.ids.push_back(block.sb->GetBlockID());
+         key.ids.push_back(block.start.as_long_long());
+      }
+   }
+   return key;
+}
+
 size_t WaveClip::NChannels() const
 {
    return mSequences.size();
@@ -393,6 +433,18 @@ bool WaveClip::GetSamples(samplePtr buffers[], sampleFormat format,
    return result;
 }
 
+void WaveClip::GetBlocks(sampleCount start, sampleCount len,
+   std::vector<std::shared_ptr<SampleBlock>> &blocks) const
+{
+   // Positions in the sequences scale inversely with the stretch
+   const auto ratio = GetStretchRatio();
+   const auto first = sampleCount{ start.as_double() / ratio } +
+      TimeToSamples(mTrimLeft);
+   const auto count = sampleCount{ len.as_double() / ratio + 1 };
+   for (auto &pSequence : mSequences)
+      pSequence->GetBlocks(first, count, blocks);
+}
+
 /*! @excsafety{Strong} */
 void WaveClip::SetSamples(size_t ii,
    constSamplePtr buffer, sampleFormat format,
@@ -417,7 +469,8 @@ void WaveClip::SetEnvelope(std::unique_ptr<Envelope> p)
 const BlockArray* WaveClip::GetSequenceBlockArray(size_t ii) const
 {
    assert(ii < NChannels());
-   return &mSequences[ii]->GetBlockArray();
+   // Not the mutating overload, which would stop sharing with copies
+   return &std::as_const(*mSequences[ii]).GetBlockArray();
 }
 
 size_t WaveClip::GetAppendBufferLen(size_t iChannel) const
@@ -694,7 +747,7 @@ size_t WaveClip::CountBlocks() const
 {
    return std::accumulate(mSequences.begin(), mSequences.end(), size_t{},
    [](size_t acc, auto &pSequence){
-      return acc + pSequence->GetBlockArray().size(); });
+      return acc + std::as_const(*pSequence).GetBlockArray().size(); });
 }
 
 //! A hint for sizing of well aligned fetches
@@ -737,6 +790,11 @@ void WaveClip::MarkChanged() noexcept // NOFAIL-GUARANTEE
    Attachments::ForEach(std::mem_fn(&WaveClipListener::MarkChanged));
 }
 
+void WaveClip::MarkAppended() noexcept // NOFAIL-GUARANTEE
+{
+   Attachments::ForEach(std::mem_fn(&WaveClipListener::MarkAppended));
+}
+
 std::pair<float, float> WaveClip::GetMinMax(size_t ii,
    double t0, double t1, bool mayThrow) const
 {
@@ -779,6 +837,33 @@ float WaveClip::GetRMS(size_t ii, double t0, double t1, bool mayThrow) const
    return mSequences[ii]->GetRMS(s0, s1-s0, mayThrow);
 }
 
+std::pair<double, sampleCount>
+WaveClip::GetSum(size_t ii, double t0, double t1, bool mayThrow) const
+{
+   assert(ii < NChannels());
+   t0 = std::max(t0, GetPlayStartTime());
+   t1 = std::min(t1, GetPlayEndTime());
+   if (t0 >= t1)
+      return { 0.0, 0 };
+
+   auto s0 = TimeToSequenceSamples(t0);
+   auto s1 = TimeToSequenceSamples(t1);
+
+   return { mSequences[ii]->GetSum(s0, s1 - s0, mayThrow), s1 - s0 };
+}
+
+sampleCount WaveClip::GetQuietLength(size_t ii, sampleCount start,
+   sampleCount len, float threshold, bool mayThrow) const
+{
+   assert(ii < NChannels());
+   start = std::max<sampleCount>(start, 0);
+   len = std::min(len, GetVisibleSampleCount() - start);
+   if (len <= 0)
+      return 0;
+   return mSequences[ii]->GetQuietLength(
+      start + TimeToSamples(mTrimLeft), len, threshold, mayThrow);
+}
+
 void WaveClip::ConvertToSampleFormat(sampleFormat format,
    const std::function<void(size_t)> & progressReport)
 {
@@ -861,7 +946,7 @@ bool WaveClip::Append(size_t iChannel, const size_t nChannels,
 
    // use No-fail-guarantee
    UpdateEnvelopeTrackLen();
-   MarkChanged();
+   MarkAppended();
 
    return appended;
 }
@@ -885,7 +970,7 @@ bool WaveClip::Append(constSamplePtr buffers[], sampleFormat format,
    transaction.Commit();
    // use No-fail-guarantee
    UpdateEnvelopeTrackLen();
-   MarkChanged();
+   MarkAppended();
 
    return appended;
 }
@@ -909,7 +994,7 @@ void WaveClip::Flush()
 
       // No-fail operations
       UpdateEnvelopeTrackLen();
-      MarkChanged();
+      MarkAppended();
    }
 
    //wxLogDebug(wxT("now sample count %lli"), (long long) mSequence->GetNumSamples());
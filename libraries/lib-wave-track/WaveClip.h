@@ -52,6 +52,13 @@ CRTP_BASE(WaveClipListenerBase, struct,
 struct WaveClipListener : WaveClipListenerBase {
    virtual ~WaveClipListener() = 0;
    virtual void MarkChanged() noexcept = 0;
+   //! Called instead of MarkChanged() when samples were only appended at
+   //! the end of the clip, leaving the others as they were
+   /*!
+    May be called in a worker thread while recording.
+    Default implementation calls MarkChanged()
+    */
+   virtual void MarkAppended() noexcept;
    virtual void Invalidate() = 0;
 
    // Default implementation does nothing
@@ -152,6 +159,22 @@ public:
     */
    float GetRMS(double t0, double t1, bool mayThrow) const;
 
+   //! Sum and number of the stored samples between the times
+   /*!
+    Not of the samples as rendered, if HasPitchOrSpeed()
+    */
+   std::pair<double, sampleCount>
+   GetSum(double t0, double t1, bool mayThrow) const;
+
+   //! How many samples from start, at most len, the summaries show to be less
+   //! than threshold in magnitude
+   /*!
+    Of the stored samples, if HasPitchOrSpeed()
+    @param start relative to the play start
+    */
+   sampleCount GetQuietLength(sampleCount start, sampleCount len,
+      float threshold, bool mayThrow) const;
+
    //! Real start time of the clip, quantized to raw sample rate (track's rate)
    sampleCount GetPlayStartSample() const;
 
@@ -514,6 +537,12 @@ public:
    AudioSegmentSampleView GetSampleView(
       size_t iChannel, double t0, double t1, bool mayThrow = true) const;
 
+   //! Identifies the samples by the blocks of the sequences and the trimming
+   /*!
+    Empty while samples are appended and not yet flushed to blocks
+    */
+   ClipContentKey GetContentKey() const override;
+
    //! Get samples from one channel
    /*!
     @param ii identifies the channel
@@ -531,6 +560,14 @@ public:
    bool GetSamples(samplePtr buffers[], sampleFormat format,
                    sampleCount start, size_t len, bool mayThrow = true) const;
 
+   //! Append to `blocks` those of all channels holding samples that play
+   //! within `len` samples from `start`
+   /*!
+    @param start relative to clip play start sample
+    */
+   void GetBlocks(sampleCount start, sampleCount len,
+      std::vector<std::shared_ptr<SampleBlock>> &blocks) const;
+
    //! @param ii identifies the channel
    /*!
     @pre `ii < NChannels()`
@@ -589,6 +626,16 @@ public:
     @copydoc GetMinMax
     */
    float GetRMS(size_t ii, double t0, double t1, bool mayThrow) const;
+   /*!
+    @copydoc WaveClipChannel::GetSum
+    */
+   std::pair<double, sampleCount>
+   GetSum(size_t ii, double t0, double t1, bool mayThrow) const;
+   /*!
+    @copydoc WaveClipChannel::GetQuietLength
+    */
+   sampleCount GetQuietLength(size_t ii, sampleCount start, sampleCount len,
+      float threshold, bool mayThrow) const;
 
    /** Whenever you do an operation to the sequence that will change the number
     * of samples (that is, the length of the clip), you will want to call this
@@ -873,6 +920,10 @@ private:
    /*! @excsafety{No-fail} */
    void MarkChanged() noexcept;
 
+   //! Called by appending operations; notifies listeners
+   /*! @excsafety{No-fail} */
+   void MarkAppended() noexcept;
+
    // Always gives non-negative answer, not more than sample sequence length
    // even if t0 really falls outside that range
    sampleCount TimeToSequenceSamples(double t) const;
@@ -55,6 +55,7 @@ from the project that will own the track.
 #include "Project.h"
 #include "ProjectRate.h"
 #include "SampleBlock.h"
+#include "SampleBlockPrefetcher.h"
 
 #include "BasicUI.h"
 #include "Prefs.h"
@@ -64,39 +65,38 @@ from the project that will own the track.
 
 
 #include "InconsistencyException.h"
+#include "concurrency/TaskScheduler.h"
 
 #include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using std::max;
 
+namespace {
+//! Receives the stretched samples of an interval as they come, and the
+//! fraction of them given so far
+//! @return whether to go on
+using StretchedSamplesConsumer = std::function<bool(
+   const float* const* buffers, size_t numSamples, double progress)>;
+
+//! Stretch `interval`, with one second of unstretched audio kept before and
+//! after the visible region when there is some
 /*!
- * @post result: `result->GetStretchRatio() == 1`
+ The trims of `interval` change meanwhile, but are restored.
+ @return the play start time of the first sample given to `consume`
  */
-namespace {
-WaveTrack::IntervalHolder GetRenderedCopy(
-   const WaveTrack::IntervalHolder &pInterval,
-   const std::function<void(double)>& reportProgress,
-   const SampleBlockFactoryPtr& factory, sampleFormat format)
+double StretchInterval(
+   WaveTrack::Interval& interval, const StretchedSamplesConsumer& consume)
 {
-   auto &interval = *pInterval;
-   using Interval = WaveTrack::Interval;
-   if (!interval.HasPitchOrSpeed())
-      return pInterval;
-
-   const auto dst = std::make_shared<Interval>(
-      interval.NChannels(), factory, format, interval.GetRate());
-
    const auto originalPlayStartTime = interval.GetPlayStartTime();
    const auto originalPlayEndTime = interval.GetPlayEndTime();
    const auto stretchRatio = interval.GetStretchRatio();
 
-   auto success = false;
    Finally Do { [&] {
-      if (!success)
-      {
-         interval.TrimLeftTo(originalPlayStartTime);
-         interval.TrimRightTo(originalPlayEndTime);
-      }
+      interval.TrimLeftTo(originalPlayStartTime);
+      interval.TrimRightTo(originalPlayEndTime);
    } };
 
    // Leave 1 second of raw, unstretched audio before and after visible region
@@ -135,23 +135,40 @@ WaveTrack::IntervalHolder GetRenderedCopy(
       const auto numSamplesToGet =
          limitSampleBufferSize(blockSize, totalNumOutSamples - numOutSamples);
       stretcher.GetSamples(container.Get(), numSamplesToGet);
-      constSamplePtr data[2];
-      data[0] = reinterpret_cast<constSamplePtr>(container.Get()[0]);
-      if (interval.NChannels() == 2)
-         data[1] = reinterpret_cast<constSamplePtr>(container.Get()[1]);
-      dst->Append(data, floatSample, numSamplesToGet, 1, widestSampleFormat);
       numOutSamples += numSamplesToGet;
-      if (reportProgress)
-         reportProgress(
-            numOutSamples.as_double() / totalNumOutSamples.as_double());
+      if (!consume(
+             container.Get(), numSamplesToGet,
+             numOutSamples.as_double() / totalNumOutSamples.as_double()))
+         break;
    }
-   dst->Flush();
+   return tmpPlayStartTime;
+}
+
+void AppendStretchedSamples(
+   WaveTrack::Interval& dst, const float* const* buffers, size_t numSamples)
+{
+   constSamplePtr data[2];
+   data[0] = reinterpret_cast<constSamplePtr>(buffers[0]);
+   if (dst.NChannels() == 2)
+      data[1] = reinterpret_cast<constSamplePtr>(buffers[1]);
+   dst.Append(data, floatSample, numSamples, 1, widestSampleFormat);
+}
+
+//! Make `dst`, holding all that StretchInterval() gave, like `interval` with
+//! no stretching
+void FinishRenderedCopy(
+   const WaveTrack::Interval& interval, WaveTrack::Interval& dst,
+   double tmpPlayStartTime)
+{
+   const auto originalPlayStartTime = interval.GetPlayStartTime();
+   const auto originalPlayEndTime = interval.GetPlayEndTime();
+   dst.Flush();
 
    // Now we're all like `this` except unstretched. We can clear leading and
    // trailing, stretching transient parts.
-   dst->SetPlayStartTime(tmpPlayStartTime);
-   dst->ClearLeft(originalPlayStartTime);
-   dst->ClearRight(originalPlayEndTime);
+   dst.SetPlayStartTime(tmpPlayStartTime);
+   dst.ClearLeft(originalPlayStartTime);
+   dst.ClearRight(originalPlayEndTime);
 
    // We don't preserve cutlines but the relevant part of the envelope.
    auto dstEnvelope = std::make_unique<Envelope>(interval.GetEnvelope());
@@ -160,13 +177,60 @@ WaveTrack::IntervalHolder GetRenderedCopy(
       originalPlayEndTime, interval.GetSequenceEndTime() + samplePeriod, samplePeriod);
    dstEnvelope->CollapseRegion(0, originalPlayStartTime, samplePeriod);
    dstEnvelope->SetOffset(originalPlayStartTime);
-   dst->SetEnvelope(move(dstEnvelope));
+   dst.SetEnvelope(move(dstEnvelope));
 
-   success = true;
+   assert(!dst.HasPitchOrSpeed());
+}
+
+/*!
+ * @post result: `result->GetStretchRatio() == 1`
+ */
+WaveTrack::IntervalHolder GetRenderedCopy(
+   const WaveTrack::IntervalHolder &pInterval,
+   const std::function<void(double)>& reportProgress,
+   const SampleBlockFactoryPtr& factory, sampleFormat format)
+{
+   auto &interval = *pInterval;
+   using Interval = WaveTrack::Interval;
+   if (!interval.HasPitchOrSpeed())
+      return pInterval;
 
-   assert(!dst->HasPitchOrSpeed());
+   const auto dst = std::make_shared<Interval>(
+      interval.NChannels(), factory, format, interval.GetRate());
+
+   const auto tmpPlayStartTime = StretchInterval(
+      interval,
+      [&](const float* const* buffers, size_t numSamples, double progress) {
+         AppendStretchedSamples(*dst, buffers, numSamples);
+         if (reportProgress)
+            reportProgress(progress);
+         return true;
+      });
+   FinishRenderedCopy(interval, *dst, tmpPlayStartTime);
    return dst;
 }
+
+//! Copy clips in increasing order of play start times
+/*!
+ The times are computed once for each clip, not in each comparison of the
+ sort, which is what costs most in tracks of very many clips
+ */
+template<typename Holders, typename Intervals>
+Holders SortedByPlayStart(const Intervals &intervals)
+{
+   using Holder = typename Holders::value_type;
+   std::vector<std::pair<double, Holder>> keyed;
+   keyed.reserve(intervals.size());
+   for (const auto &pInterval : intervals)
+      keyed.emplace_back(pInterval->GetPlayStartTime(), pInterval);
+   std::sort(keyed.begin(), keyed.end(), [](const auto &a, const auto &b){
+      return a.first < b.first; });
+   Holders result;
+   result.reserve(keyed.size());
+   for (auto &pair : keyed)
+      result.push_back(std::move(pair.second));
+   return result;
+}
 }
 
 std::shared_ptr<const WaveTrack::Interval>
@@ -2720,6 +2784,28 @@ bool WaveTrack::GetOne(const WaveClipHolders &clips, size_t iChannel,
    return result;
 }
 
+void WaveTrack::Prefetch(const void *client,
+   sampleCount start, size_t len, bool backward) const
+{
+   if (backward)
+      start -= len;
+   // Called for each buffer of playback; reuse the storage, and don't let it
+   // keep the blocks alive
+   static thread_local std::vector<SampleBlockPtr> blocks;
+   blocks.clear();
+   for (const auto &clip: mClips) {
+      const auto clipStart = clip->GetPlayStartSample();
+      const auto clipEnd = clip->GetPlayEndSample();
+      if (clipEnd > start && clipStart < start + len) {
+         const auto first = std::max(start, clipStart);
+         clip->GetBlocks(first - clipStart,
+            std::min(start + len, clipEnd) - first, blocks);
+      }
+   }
+   Finally Do { []{ blocks.clear(); } };
+   SampleBlockPrefetcher::Get().Request(client, mpFactory, blocks);
+}
+
 ChannelGroupSampleView
 WaveTrack::GetSampleView(double t0, double t1, bool mayThrow) const
 {
@@ -2932,12 +3018,19 @@ void WaveTrack::GetEnvelopeValues(
 // latter clip is returned.
 auto WaveTrack::GetClipAtTime(double time) const -> IntervalConstHolder
 {
-   const auto clips = SortedClipArray();
-   auto p = std::find_if(
-      clips.rbegin(), clips.rend(), [&](const auto &pClip) {
-         return pClip->WithinPlayRegion(time);
-      });
-   return p != clips.rend() ? *p : nullptr;
+   // Of the clips containing the time, the one that starts last, found in one
+   // pass without sorting
+   IntervalConstHolder result;
+   double resultStart = 0;
+   for (const auto &pClip : Intervals()) {
+      const auto start = pClip->GetPlayStartTime();
+      if (start <= time && time < pClip->GetPlayEndTime() &&
+         (!result || start >= resultStart)) {
+         result = pClip;
+         resultStart = start;
+      }
+   }
+   return result;
 }
 
 auto WaveTrack::CreateClip(double offset, const wxString& name,
@@ -3186,18 +3279,160 @@ bool WaveTrack::MergeClips(int clipidx1, int clipidx2)
    return true;
 }
 
+namespace {
+//! Stretched samples of one interval, made in a worker thread and appended to
+//! the rendered copy in the main thread, which alone creates sample blocks
+struct ParallelRender
+{
+   //! What the worker reads and trims, sharing the blocks of the original
+   WaveTrack::IntervalHolder source;
+   WaveTrack::IntervalHolder dst;
+   //! Weight of the interval in the total progress
+   double duration {};
+   double tmpPlayStartTime {};
+
+   // Guarded by the mutex of all renders
+   std::vector<std::vector<float>> pending;
+   double progress {};
+};
+
+//! Samples of each channel that a worker may make ahead of the main thread
+constexpr size_t maxPendingSamples = 1 << 20;
+
+//! Like GetRenderedCopy() for each interval, but stretching in worker threads
+WaveTrack::IntervalHolders GetRenderedCopiesInParallel(
+   const WaveTrack::IntervalHolders& intervals,
+   const std::function<void(double)>& reportProgress,
+   const SampleBlockFactoryPtr& factory, sampleFormat format)
+{
+   std::vector<std::unique_ptr<ParallelRender>> renders;
+   double totalDuration = 0;
+   for (const auto& pInterval : intervals)
+   {
+      if (!pInterval->HasPitchOrSpeed())
+         continue;
+      auto& render = *renders.emplace_back(std::make_unique<ParallelRender>());
+      constexpr auto copyCutlines = false;
+      render.source =
+         std::make_shared<WaveTrack::Interval>(*pInterval, factory, copyCutlines);
+      render.dst = std::make_shared<WaveTrack::Interval>(
+         pInterval->NChannels(), factory, format, pInterval->GetRate());
+      render.duration = pInterval->GetPlayDuration();
+      render.pending.resize(pInterval->NChannels());
+      totalDuration += render.duration;
+   }
+
+   std::mutex mutex;
+   std::condition_variable condition;
+   bool stop = false;
+   // Should another wait in the main thread run a render there, it must not
+   // wait for the main thread
+   const auto mainThread = std::this_thread::get_id();
+
+   // Append what the workers made so far
+   const auto consume = [&] {
+      auto progress = 0.;
+      for (auto& pRender : renders)
+      {
+         std::vector<std::vector<float>> samples(pRender->pending.size());
+         {
+            std::lock_guard<std::mutex> lock { mutex };
+            std::swap(samples, pRender->pending);
+            if (totalDuration > 0)
+               progress +=
+                  pRender->progress * pRender->duration / totalDuration;
+         }
+         if (!samples[0].empty())
+         {
+            condition.notify_all();
+            const float* buffers[2] {};
+            for (size_t iChannel = 0; iChannel < samples.size(); ++iChannel)
+               buffers[iChannel] = samples[iChannel].data();
+            AppendStretchedSamples(
+               *pRender->dst, buffers, samples[0].size());
+         }
+      }
+      if (reportProgress)
+         reportProgress(progress);
+   };
+
+   audacity::concurrency::TaskGroup group;
+   // Declared after the group, so that on exception, workers stop before the
+   // group waits for them
+   Finally Do { [&] {
+      {
+         std::lock_guard<std::mutex> lock { mutex };
+         stop = true;
+      }
+      condition.notify_all();
+   } };
+
+   for (auto& pRender : renders)
+      group.Run([&, &render = *pRender] {
+         render.tmpPlayStartTime = StretchInterval(
+            *render.source,
+            [&](const float* const* buffers, size_t numSamples,
+                double progress) {
+               std::unique_lock<std::mutex> lock { mutex };
+               condition.wait(lock, [&] {
+                  return stop ||
+                         render.pending[0].size() < maxPendingSamples ||
+                         std::this_thread::get_id() == mainThread;
+               });
+               if (stop)
+                  return false;
+               for (size_t iChannel = 0; iChannel < render.pending.size();
+                    ++iChannel)
+                  render.pending[iChannel].insert(
+                     render.pending[iChannel].end(), buffers[iChannel],
+                     buffers[iChannel] + numSamples);
+               render.progress = progress;
+               return true;
+            });
+      });
+   group.WaitPolling(consume, std::chrono::milliseconds { 20 });
+   consume();
+
+   WaveTrack::IntervalHolders result;
+   auto iRender = renders.begin();
+   for (const auto& pInterval : intervals)
+   {
+      if (!pInterval->HasPitchOrSpeed())
+      {
+         result.push_back(pInterval);
+         continue;
+      }
+      auto& render = **iRender++;
+      FinishRenderedCopy(*pInterval, *render.dst, render.tmpPlayStartTime);
+      result.push_back(render.dst);
+   }
+   return result;
+}
+} // namespace
+
 void WaveTrack::ApplyPitchAndSpeedOnIntervals(
    const IntervalHolders& srcIntervals,
    const ProgressReporter& reportProgress)
 {
    IntervalHolders dstIntervals;
-   dstIntervals.reserve(srcIntervals.size());
-   std::transform(
+   const auto numToRender = std::count_if(
       srcIntervals.begin(), srcIntervals.end(),
-      std::back_inserter(dstIntervals), [&](const IntervalHolder& interval) {
-         return GetRenderedCopy(interval,
-            reportProgress, mpFactory, GetSampleFormat());
-      });
+      [](const IntervalHolder& interval) { return interval->HasPitchOrSpeed(); });
+   if (numToRender > 1 &&
+       audacity::concurrency::TaskScheduler::Get().ThreadCount() > 1)
+      // Each interval is stretched in its own thread
+      dstIntervals = GetRenderedCopiesInParallel(
+         srcIntervals, reportProgress, mpFactory, GetSampleFormat());
+   else
+   {
+      dstIntervals.reserve(srcIntervals.size());
+      std::transform(
+         srcIntervals.begin(), srcIntervals.end(),
+         std::back_inserter(dstIntervals), [&](const IntervalHolder& interval) {
+            return GetRenderedCopy(interval,
+               reportProgress, mpFactory, GetSampleFormat());
+         });
+   }
 
    // If we reach this point it means that no error was thrown - we can replace
    // the source with the destination intervals.
@@ -3268,32 +3503,17 @@ bool WaveTrack::SetFloats(const float *const *buffers,
 
 auto WaveTrack::SortedClipArray() const -> IntervalConstHolders
 {
-   const auto &intervals = Intervals();
-   IntervalConstHolders clips{ intervals.begin(), intervals.end() };
-   const auto comp = [](const auto &a, const auto &b) {
-      return a->GetPlayStartTime() < b->GetPlayStartTime(); };
-   std::sort(clips.begin(), clips.end(), comp);
-   return clips;
+   return SortedByPlayStart<IntervalConstHolders>(Intervals());
 }
 
 auto WaveTrack::SortedIntervalArray() -> IntervalHolders
 {
-   const auto &intervals = Intervals();
-   IntervalHolders result;
-   copy(intervals.begin(), intervals.end(), back_inserter(result));
-   sort(result.begin(), result.end(), [](const auto &pA, const auto &pB){
-      return pA->GetPlayStartTime() < pB->GetPlayStartTime(); });
-   return result;
+   return SortedByPlayStart<IntervalHolders>(Intervals());
 }
 
 auto WaveTrack::SortedIntervalArray() const -> IntervalConstHolders
 {
-   const auto &intervals = Intervals();
-   IntervalConstHolders result;
-   copy(intervals.begin(), intervals.end(), back_inserter(result));
-   sort(result.begin(), result.end(), [](const auto &pA, const auto &pB){
-      return pA->GetPlayStartTime() < pB->GetPlayStartTime(); });
-   return result;
+   return SortedByPlayStart<IntervalConstHolders>(Intervals());
 }
 
 void WaveTrack::ZipClips(bool mustAlign)
@@ -485,6 +485,10 @@ public:
       // contiguous range.
       sampleCount* pNumWithinClips = nullptr) const override;
 
+   //! Load blocks of all channels in the background
+   void Prefetch(const void *client,
+      sampleCount start, size_t len, bool backward) const override;
+
    /*!
     * @brief Request samples within [t0, t1), not knowing in advance how
     * many this will be.
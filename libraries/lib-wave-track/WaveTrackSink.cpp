@@ -14,13 +14,157 @@
 #include "WaveTrackSink.h"
 
 #include "AudioGraphBuffers.h"
+#include "SampleBlock.h"
 #include "WaveTrack.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//! Thread writing filled buffers to the track, while the sink's caller fills
+//! the other of two buffers
+class WaveTrackSink::Writer final {
+public:
+   Writer(WaveTrackSink &sink, unsigned nChannels)
+      : mSink{ sink }, mNChannels{ nChannels }
+   {
+      for (auto &staged : mStaged)
+         mFree.push_back(&staged);
+      mThread = std::thread{ [this]{ Loop(); } };
+   }
+
+   ~Writer()
+   {
+      {
+         std::lock_guard lock{ mMutex };
+         mStopping = true;
+      }
+      mFilledCondition.notify_one();
+      mThread.join();
+   }
+
+   //! Copy the samples, waiting for a free buffer; called by the sink
+   //! @throws the exception from a previous write, if any
+   void Post(const Buffers &data, size_t len)
+   {
+      Staged *pStaged{};
+      {
+         std::unique_lock lock{ mMutex };
+         mFreeCondition.wait(lock, [this]{ return !mFree.empty(); });
+         RethrowLocked();
+         pStaged = mFree.front();
+         mFree.pop_front();
+      }
+      pStaged->channels.resize(mNChannels);
+      for (unsigned iChannel = 0; iChannel < mNChannels; ++iChannel) {
+         const auto pSamples =
+            reinterpret_cast<const float*>(data.GetReadPosition(iChannel));
+         pStaged->channels[iChannel].assign(pSamples, pSamples + len);
+      }
+      pStaged->len = len;
+      {
+         std::lock_guard lock{ mMutex };
+         mFilled.push_back(pStaged);
+      }
+      mFilledCondition.notify_one();
+   }
+
+   //! Wait for all posted buffers to be written
+   //! @throws the exception from writing, if any
+   void Drain()
+   {
+      std::unique_lock lock{ mMutex };
+      mFreeCondition.wait(lock, [this]{ return mFree.size() == nStaged; });
+      RethrowLocked();
+   }
+
+private:
+   static constexpr size_t nStaged = 2;
+
+   struct Staged {
+      std::vector<std::vector<float>> channels;
+      size_t len{};
+   };
+
+   void RethrowLocked()
+   {
+      if (mpException)
+         std::rethrow_exception(std::exchange(mpException, nullptr));
+   }
+
+   void Loop()
+   {
+      const auto &pFactory = (mSink.mpGenerated
+         ? *mSink.mpGenerated : mSink.mLeft.GetTrack()).GetSampleBlockFactory();
+      while (true) {
+         Staged *pStaged{};
+         bool failed{};
+         {
+            std::unique_lock lock{ mMutex };
+            mFilledCondition.wait(lock,
+               [this]{ return mStopping || !mFilled.empty(); });
+            if (mFilled.empty())
+               return;
+            pStaged = mFilled.front();
+            mFilled.pop_front();
+            failed = mFailed;
+         }
+         // After a failure, only recycle the buffers
+         if (!failed) {
+            try {
+               // Group the storage of the new blocks of the buffer into
+               // fewer transactions
+               std::optional<SampleBlockWriteBatch> batch;
+               if (pFactory)
+                  batch.emplace(*pFactory);
+               const auto &channels = pStaged->channels;
+               const auto samples = [&](size_t iChannel) {
+                  return iChannel < channels.size()
+                     ? reinterpret_cast<constSamplePtr>(
+                        channels[iChannel].data())
+                     : nullptr;
+               };
+               mSink.Write(samples(0), samples(1), pStaged->len);
+            }
+            catch (...) {
+               mSink.mOk.store(false, std::memory_order_relaxed);
+               std::lock_guard lock{ mMutex };
+               mpException = std::current_exception();
+               mFailed = true;
+            }
+         }
+         {
+            std::lock_guard lock{ mMutex };
+            mFree.push_back(pStaged);
+         }
+         mFreeCondition.notify_one();
+      }
+   }
+
+   WaveTrackSink &mSink;
+   const unsigned mNChannels;
+
+   std::mutex mMutex;
+   std::condition_variable mFilledCondition, mFreeCondition;
+   std::array<Staged, nStaged> mStaged;
+   std::deque<Staged*> mFilled, mFree;
+   std::exception_ptr mpException;
+   bool mFailed{ false };
+   bool mStopping{ false };
+   std::thread mThread;
+};
 
 WaveTrackSink::WaveTrackSink(WaveChannel &left, WaveChannel *pRight,
    WaveTrack *pGenerated,
    sampleCount start, bool isProcessor,
-   sampleFormat effectiveFormat
+   sampleFormat effectiveFormat, bool async
 )  : mLeft{ left }, mpRight{ pRight }
    , mpGenerated{ pGenerated }
    , mGenLeft{ pGenerated ? (*pGenerated->Channels().begin()).get() : nullptr }
@@ -30,6 +174,8 @@ WaveTrackSink::WaveTrackSink(WaveChannel &left, WaveChannel *pRight,
    , mEffectiveFormat{ effectiveFormat }
    , mOutPos{ start }
 {
+   if (async)
+      mpWriter = std::make_unique<Writer>(*this, pRight ? 2 : 1);
 }
 
 WaveTrackSink::~WaveTrackSink() = default;
@@ -65,26 +211,13 @@ void WaveTrackSink::DoConsume(Buffers &data)
    const auto inputBufferCnt = data.Position();
    if (inputBufferCnt > 0) {
       // Some data still unwritten
-      if (mIsProcessor) {
-         mOk = mOk &&
-            mLeft.Set(data.GetReadPosition(0),
-               floatSample, mOutPos, inputBufferCnt, mEffectiveFormat);
-         if (mpRight)
-            mOk = mOk &&
-               mpRight->Set(data.GetReadPosition(1),
-                  floatSample, mOutPos, inputBufferCnt, mEffectiveFormat);
-      }
-      else if (mGenLeft) {
-         mGenLeft->Append(data.GetReadPosition(0),
-            floatSample, inputBufferCnt );
-         if (mGenRight)
-            mGenRight->Append(data.GetReadPosition(1),
-               floatSample, inputBufferCnt);
-      }
+      if (mpWriter)
+         mpWriter->Post(data, inputBufferCnt);
+      else
+         Write(data.GetReadPosition(0),
+            mpRight ? data.GetReadPosition(1) : nullptr, inputBufferCnt);
       // Satisfy post
       data.Rewind();
-      // Bump to the next track position
-      mOutPos += inputBufferCnt;
    }
    else {
       // Position is zero, therefore Remaining() is a positive multiple of
@@ -94,9 +227,31 @@ void WaveTrackSink::DoConsume(Buffers &data)
    assert(data.BlockSize() <= data.Remaining());
 }
 
+void WaveTrackSink::Write(constSamplePtr pLeft, constSamplePtr pRight,
+   size_t len)
+{
+   if (mIsProcessor) {
+      bool ok = IsOk() &&
+         mLeft.Set(pLeft, floatSample, mOutPos, len, mEffectiveFormat);
+      if (mpRight)
+         ok = ok &&
+            mpRight->Set(pRight, floatSample, mOutPos, len, mEffectiveFormat);
+      mOk.store(ok, std::memory_order_relaxed);
+   }
+   else if (mGenLeft) {
+      mGenLeft->Append(pLeft, floatSample, len);
+      if (mGenRight)
+         mGenRight->Append(pRight, floatSample, len);
+   }
+   // Bump to the next track position
+   mOutPos += len;
+}
+
 void WaveTrackSink::Flush(Buffers &data)
 {
    DoConsume(data);
+   if (mpWriter)
+      mpWriter->Drain();
    if (mpGenerated)
       mpGenerated->Flush();
 }
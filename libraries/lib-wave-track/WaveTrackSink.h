@@ -18,6 +18,7 @@
 #include "AudioGraphSink.h" // to inherit
 #include "SampleCount.h"
 #include "SampleFormat.h"
+#include <atomic>
 #include <memory>
 
 class WaveChannel;
@@ -26,10 +27,16 @@ class TrackList;
 
 class WAVE_TRACK_API WaveTrackSink final : public AudioGraph::Sink {
 public:
+   /*!
+    @param async if true, a thread of this object writes to the track, from
+       one buffer, while the caller fills a second; nothing else may read or
+       write the channels that are written, until Flush()
+    */
    WaveTrackSink(WaveChannel &left, WaveChannel *pRight,
       WaveTrack *pGenerated, sampleCount start, bool isProcessor,
       //! This argument affects processors only, not generators
-      sampleFormat effectiveFormat);
+      sampleFormat effectiveFormat,
+      bool async = false);
    ~WaveTrackSink() override;
 
    //! Accepts buffers only if there is at least one channel
@@ -40,18 +47,24 @@ public:
 
    /*!
     @copydoc DoConsume
+    Then waits for writing to finish, if async
+    @throws the first exception from writing in the other thread
     */
    void Flush(Buffers &data);
 
    //! Whether any errors have occurred in writing data
-   bool IsOk() const { return mOk; }
+   bool IsOk() const { return mOk.load(std::memory_order_relaxed); }
 
 private:
+   class Writer;
+
    /*!
     @pre `data.Channels() > 0`
     @post `data.BlockSize() <= data.Remaining()`
     */
    void DoConsume(Buffers &data);
+   //! Write the samples to the track at mOutPos, and advance it
+   void Write(constSamplePtr left, constSamplePtr right, size_t len);
 
    WaveChannel &mLeft;
    WaveChannel *const mpRight;
@@ -62,6 +75,9 @@ private:
    const sampleFormat mEffectiveFormat;
 
    sampleCount mOutPos;
-   bool mOk{ true };
+   std::atomic<bool> mOk{ true };
+
+   //! Null unless async
+   std::unique_ptr<Writer> mpWriter;
 };
 #endif
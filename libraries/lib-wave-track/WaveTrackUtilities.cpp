@@ -377,21 +377,27 @@ void WaveTrackUtilities::VisitBlocks(TrackList &tracks, BlockVisitor visitor,
    SampleBlockIDSet *pIDs)
 {
    for (auto wt : tracks.Any<WaveTrack>())
-      // Scan all clips within current track
-      for (const auto &pClip : GetAllClips(*wt))
-         // Scan all sample blocks within current clip
-         for (const auto &pChannel : pClip->Channels()) {
-            auto blocks = pChannel->GetSequenceBlockArray();
-            for (const auto &block : *blocks) {
-               auto &pBlock = block.sb;
-               if (pBlock) {
-                  if (pIDs && !pIDs->insert(pBlock->GetBlockID()).second)
-                     continue;
-                  if (visitor)
-                     visitor(pBlock);
-               }
+      VisitBlocks(*wt, visitor, pIDs);
+}
+
+void WaveTrackUtilities::VisitBlocks(WaveTrack &track, BlockVisitor visitor,
+   SampleBlockIDSet *pIDs)
+{
+   // Scan all clips within the track
+   for (const auto &pClip : GetAllClips(track))
+      // Scan all sample blocks within current clip
+      for (const auto &pChannel : pClip->Channels()) {
+         auto blocks = pChannel->GetSequenceBlockArray();
+         for (const auto &block : *blocks) {
+            auto &pBlock = block.sb;
+            if (pBlock) {
+               if (pIDs && !pIDs->insert(pBlock->GetBlockID()).second)
+                  continue;
+               if (visitor)
+                  visitor(pBlock);
             }
          }
+      }
 }
 
 void WaveTrackUtilities::InspectBlocks(const TrackList &tracks,
@@ -400,6 +406,12 @@ void WaveTrackUtilities::InspectBlocks(const TrackList &tracks,
    VisitBlocks(const_cast<TrackList &>(tracks), move(inspector), pIDs);
 }
 
+void WaveTrackUtilities::InspectBlocks(const WaveTrack &track,
+   BlockInspector inspector, SampleBlockIDSet *pIDs)
+{
+   VisitBlocks(const_cast<WaveTrack &>(track), move(inspector), pIDs);
+}
+
 WaveTrack::IntervalConstHolders
 WaveTrackUtilities::GetClipsIntersecting(const WaveTrack &track,
    double t0, double t1)
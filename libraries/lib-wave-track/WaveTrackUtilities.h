@@ -177,10 +177,18 @@ WAVE_TRACK_API void DiscardTrimmed(WaveTrack &track);
 WAVE_TRACK_API void VisitBlocks(TrackList &tracks, BlockVisitor visitor,
    SampleBlockIDSet *pIDs = nullptr);
 
+//! As above, for the blocks of one track
+WAVE_TRACK_API void VisitBlocks(WaveTrack &track, BlockVisitor visitor,
+   SampleBlockIDSet *pIDs = nullptr);
+
 // Non-mutating version of the above
 WAVE_TRACK_API void InspectBlocks(const TrackList &tracks,
    BlockInspector inspector, SampleBlockIDSet *pIDs = nullptr);
 
+//! Non-mutating version of the above, for one track
+WAVE_TRACK_API void InspectBlocks(const WaveTrack &track,
+   BlockInspector inspector, SampleBlockIDSet *pIDs = nullptr);
+
 /*!
  @pre t0 <= t1
  */
@@ -49,7 +49,12 @@
 
 #include "NumericConverterFormats.h"
 
+#include "TransactionScope.h"
+#include "concurrency/TaskScheduler.h"
+
 #include <map>
+#include <optional>
+#include <unordered_set>
 
 #define DESC XO("AUP project files (*.aup)")
 
@@ -144,14 +149,30 @@ private:
                 sampleCount origin = 0,
                 int channel = 0);
 
+   //! Samples of one block file, read and converted in any thread
+   struct BlockSamples
+   {
+      SampleBuffer buffer;
+      size_t count{ 0 };
+      //! Empty if the samples were read
+      TranslatableString warning;
+   };
+   static BlockSamples ReadBlockFile(const FilePath &audioFilename,
+                                     sampleCount len,
+                                     sampleFormat format,
+                                     sampleCount origin,
+                                     int channel);
+
    // These two use the collected file information in a second pass
    bool AddSilence(sampleCount len);
+   //! @param pSamples if not null, what ReadBlockFile() gave for the block
    bool AddSamples(const FilePath &blockFilename,
                    const FilePath &audioFilename,
                    sampleCount len,
                    sampleFormat format,
                    sampleCount origin = 0,
-                   int channel = 0);
+                   int channel = 0,
+                   BlockSamples *pSamples = nullptr);
 
    bool SetError(const TranslatableString &msg);
    bool SetWarning(const TranslatableString &msg);
@@ -353,9 +374,57 @@ void AUPImportFileHandle::Import(
 
    // (If we keep this entire source file at all)
 
+   // Block files are read and converted in worker threads, one batch ahead
+   // of the appending of the previous batch to the clips in this thread.
+   // Only the first use of each block file needs reading; later uses share
+   // its sample block
+   constexpr size_t BatchSize = 32;
+   const auto nFiles = mFiles.size();
+   std::vector<bool> needsReading(nFiles);
+   {
+      std::unordered_set<wxString> names;
+      for (size_t ii = 0; ii < nFiles; ++ii) {
+         const auto &fi = mFiles[ii];
+         needsReading[ii] = !fi.blockFile.empty() &&
+            names.insert(wxFileNameFromPath(fi.blockFile)).second;
+      }
+   }
+   std::vector<std::optional<BlockSamples>> blockSamples(nFiles);
+   const auto readBatch = [&](size_t first) {
+      using namespace audacity::concurrency;
+      auto pGroup = std::make_unique<TaskGroup>();
+      for (auto ii = first, end = std::min(nFiles, first + BatchSize);
+         ii < end; ++ii)
+         if (needsReading[ii])
+            pGroup->Run([&, ii]{
+               const auto &fi = mFiles[ii];
+               blockSamples[ii] = ReadBlockFile(
+                  fi.audioFile, fi.len, fi.format, fi.origin, fi.channel);
+            });
+      return pGroup;
+   };
+   auto pBatch = readBatch(0);
+
+   // The new sample blocks of each batch go to the database in one
+   // transaction
+   std::optional<TransactionScope> transaction;
+   const auto commit = [&]{ return !transaction || transaction->Commit(); };
+
    sampleCount processed = 0;
-   for (auto fi : mFiles)
+   for (size_t ii = 0; ii < nFiles; ++ii)
    {
+      const auto &fi = mFiles[ii];
+      if (ii % BatchSize == 0)
+      {
+         pBatch->Wait();
+         pBatch = readBatch(ii + BatchSize);
+         if (!commit())
+         {
+            progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
+            return;
+         }
+         transaction.emplace(mProject, "ImportAUP");
+      }
       if(mTotalSamples.as_double() > 0)
          progressListener.OnImportProgress(processed.as_double() / mTotalSamples.as_double());
       if(IsCancelled())
@@ -377,8 +446,13 @@ void AUPImportFileHandle::Import(
       }
       else
       {
-         if (!AddSamples(fi.blockFile, fi.audioFile,
-                    fi.len, fi.format, fi.origin, fi.channel))
+         auto &samples = blockSamples[ii];
+         const auto added = AddSamples(fi.blockFile, fi.audioFile,
+            fi.len, fi.format, fi.origin, fi.channel,
+            samples ? &*samples : nullptr);
+         // Free the memory of the batch as it goes
+         samples.reset();
+         if (!added)
          {
             progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
             return;
@@ -387,6 +461,12 @@ void AUPImportFileHandle::Import(
 
       processed += fi.len;
    }
+   if (!commit())
+   {
+      progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
+      return;
+   }
+   transaction.reset();
 
    for (auto pClip : mClips)
       pClip->UpdateEnvelopeTrackLen();
@@ -1438,70 +1518,37 @@ bool AUPImportFileHandle::AddSilence(sampleCount len)
    return true;
 }
 
-// All errors that occur here will simply insert silence and allow the
-// import to continue.
-bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
-                                     const FilePath &audioFilename,
-                                     sampleCount len,
-                                     sampleFormat format,
-                                     sampleCount origin /* = 0 */,
-                                     int channel /* = 0 */)
+AUPImportFileHandle::BlockSamples
+AUPImportFileHandle::ReadBlockFile(const FilePath &audioFilename,
+                                   sampleCount len,
+                                   sampleFormat format,
+                                   sampleCount origin,
+                                   int channel)
 {
-   auto pClip = mClip ? mClip : mWaveTrack->RightmostOrNewClip().get();
-   auto &pBlock = mFileMap[wxFileNameFromPath(blockFilename)].second;
-   if (pBlock) {
-      // Replicate the sharing of blocks
-      if (pClip->NChannels() != 1)
-         return false;
-      pClip->AppendLegacySharedBlock( pBlock );
-      return true;
-   }
-
    // Third party library has its own type alias, check it before
    // adding origin + size_t
    static_assert(sizeof(sampleCount::type) <= sizeof(sf_count_t),
                  "Type sf_count_t is too narrow to hold a sampleCount");
 
+   BlockSamples result;
    SF_INFO info;
    memset(&info, 0, sizeof(info));
 
    wxFile f; // will be closed when it goes out of scope
    SNDFILE *sf = nullptr;
-   bool success = false;
-
-#ifndef UNCAUGHT_EXCEPTIONS_UNAVAILABLE
-   const auto uncaughtExceptionsCount = std::uncaught_exceptions();
-#endif
-
    auto cleanup = finally([&]
    {
-      // Do this before any throwing might happen
       if (sf)
       {
          SFCall<int>(sf_close, sf);
       }
-
-      if (!success)
-      {
-         SetWarning(XO("Error while processing %s\n\nInserting silence.").Format(audioFilename));
-
-         // If we are unwinding for an exception, don't do another
-         // potentially throwing operation
-#ifdef UNCAUGHT_EXCEPTIONS_UNAVAILABLE
-         if (!std::uncaught_exception())
-#else
-         if (uncaughtExceptionsCount == std::uncaught_exceptions())
-#endif
-            // If this does throw, let that propagate, don't guard the call
-            AddSilence(len);
-      }
    });
 
    if (!f.Open(audioFilename))
    {
-      SetWarning(XO("Failed to open %s").Format(audioFilename));
+      result.warning = XO("Failed to open %s").Format(audioFilename);
 
-      return true;
+      return result;
    }
 
    // Even though there is an sf_open() that takes a filename, use the one that
@@ -1510,19 +1557,19 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
    sf = SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_READ, &info, FALSE);
    if (!sf)
    {
-      SetWarning(XO("Failed to open %s").Format(audioFilename));
+      result.warning = XO("Failed to open %s").Format(audioFilename);
 
-      return true;
+      return result;
    }
 
    if (origin > 0)
    {
       if (SFCall<sf_count_t>(sf_seek, sf, origin.as_long_long(), SEEK_SET) < 0)
       {
-         SetWarning(XO("Failed to seek to position %lld in %s")
-            .Format(origin.as_long_long(), audioFilename));
+         result.warning = XO("Failed to seek to position %lld in %s")
+            .Format(origin.as_long_long(), audioFilename);
 
-         return true;
+         return result;
       }
    }
 
@@ -1532,8 +1579,8 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
    wxASSERT(channels >= 1);
    wxASSERT(channel < channels);
 
-   SampleBuffer buffer(cnt, format);
-   samplePtr bufptr = buffer.ptr();
+   result.buffer.Allocate(cnt, format);
+   samplePtr bufptr = result.buffer.ptr();
 
    size_t framesRead = 0;
 
@@ -1550,10 +1597,10 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
       framesRead = SFCall<sf_count_t>(sf_readf_int, sf, (int *) bufptr, cnt);
       if (framesRead != cnt)
       {
-         SetWarning(XO("Unable to read %lld samples from %s")
-            .Format(cnt, audioFilename));
+         result.warning = XO("Unable to read %lld samples from %s")
+            .Format(cnt, audioFilename);
 
-         return true;
+         return result;
       }
 
       // libsndfile gave us the 3 byte sample in the 3 most
@@ -1577,10 +1624,10 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
       framesRead = SFCall<sf_count_t>(sf_readf_short, sf, tmpptr, cnt);
       if (framesRead != cnt)
       {
-         SetWarning(XO("Unable to read %lld samples from %s")
-            .Format(cnt, audioFilename));
+         result.warning = XO("Unable to read %lld samples from %s")
+            .Format(cnt, audioFilename);
 
-         return true;
+         return result;
       }
 
       for (size_t i = 0; i < framesRead; i++)
@@ -1611,10 +1658,10 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
       framesRead = SFCall<sf_count_t>(sf_readf_float, sf, tmpptr, cnt);
       if (framesRead != cnt)
       {
-         SetWarning(XO("Unable to read %lld samples from %s")
-            .Format(cnt, audioFilename));
+         result.warning = XO("Unable to read %lld samples from %s")
+            .Format(cnt, audioFilename);
 
-         return true;
+         return result;
       }
 
       /*
@@ -1639,6 +1686,41 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
                   channels /* source stride */);
    }
 
+   result.count = cnt;
+   return result;
+}
+
+// All errors that occur here will simply insert silence and allow the
+// import to continue.
+bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
+                                     const FilePath &audioFilename,
+                                     sampleCount len,
+                                     sampleFormat format,
+                                     sampleCount origin /* = 0 */,
+                                     int channel /* = 0 */,
+                                     BlockSamples *pSamples /* = nullptr */)
+{
+   auto pClip = mClip ? mClip : mWaveTrack->RightmostOrNewClip().get();
+   auto &pBlock = mFileMap[wxFileNameFromPath(blockFilename)].second;
+   if (pBlock) {
+      // Replicate the sharing of blocks
+      if (pClip->NChannels() != 1)
+         return false;
+      pClip->AppendLegacySharedBlock( pBlock );
+      return true;
+   }
+
+   // Read now, unless a worker thread did
+   auto samples = pSamples
+      ? std::move(*pSamples)
+      : ReadBlockFile(audioFilename, len, format, origin, channel);
+   if (!samples.warning.empty())
+   {
+      SetWarning(samples.warning);
+      SetWarning(XO("Error while processing %s\n\nInserting silence.").Format(audioFilename));
+      return AddSilence(len);
+   }
+
    wxASSERT(mClip || mWaveTrack);
 
    // Add the samples to the clip/track
@@ -1646,12 +1728,10 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
    {
       if (pClip->NChannels() != 1)
          return false;
-      pBlock = pClip->AppendLegacyNewBlock(bufptr, format, cnt);
+      pBlock = pClip->AppendLegacyNewBlock(
+         samples.buffer.ptr(), format, samples.count);
    }
 
-   // Let the finally block know everything is good
-   success = true;
-
    return true;
 }
 
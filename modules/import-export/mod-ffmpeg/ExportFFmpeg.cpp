@@ -41,6 +41,7 @@ function.
 #include "ShuttleGui.h"
 
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "PlainExportOptionsEditor.h"
 #include "FFmpegDefines.h"
 #include "ExportOptionsUIServices.h"
@@ -608,7 +609,7 @@ public:
    /// Flushes audio encoder
    bool Finalize();
 
-   std::unique_ptr<Mixer> CreateMixer(
+   std::unique_ptr<PipelinedMixer> CreateMixer(
       const AudacityProject& project, bool selectionOnly, double startTime,
       double stopTime, MixerOptions::Downmix* mixerSpec);
 
@@ -668,7 +669,7 @@ class FFmpegExportProcessor final : public ExportProcessor
       TranslatableString status;
       double t0;
       double t1;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       std::unique_ptr<FFmpegExporter> exporter;
    } context;
 
@@ -725,11 +726,11 @@ FFmpegExporter::FFmpegExporter(std::shared_ptr<FFmpegFunctions> ffmpeg,
    }
 }
 
-std::unique_ptr<Mixer> FFmpegExporter::CreateMixer(
+std::unique_ptr<PipelinedMixer> FFmpegExporter::CreateMixer(
    const AudacityProject& project, bool selectionOnly, double startTime,
    double stopTime, MixerOptions::Downmix* mixerSpec)
 {
-   return ExportPluginHelpers::CreateMixer(
+   return ExportPluginHelpers::CreatePipelinedMixer(
       project, selectionOnly, startTime, stopTime, mChannels, mDefaultFrameSize,
       true, mSampleRate, int16Sample, mixerSpec);
 }
@@ -1251,6 +1252,11 @@ bool FFmpegExporter::InitCodecs(int sampleRate,
       mEncFormatCtx->SetFlags(mEncFormatCtx->GetFlags() | AUDACITY_AV_CODEC_FLAG_GLOBAL_HEADER);
    }
 
+   // Let the codec use threads, if it can, unless the options say otherwise
+   mEncAudioCodecCtx->SetThreadCount(0);
+   mEncAudioCodecCtx->SetThreadType(
+      AUDACITY_FF_THREAD_FRAME | AUDACITY_FF_THREAD_SLICE);
+
    // Open the codec.
    int rc = mEncAudioCodecCtx->Open(codec.get(), &options);
    if (rc < 0)
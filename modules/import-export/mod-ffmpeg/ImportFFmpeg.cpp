@@ -26,6 +26,11 @@ Licensed under the GNU General Public License v2 or later
 #include <wx/log.h>
 #include <wx/window.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #define DESC XO("FFmpeg-compatible files")
 
 //TODO: remove non-audio extensions
@@ -185,6 +190,46 @@ struct StreamContext final
    sampleFormat SampleFormat { floatSample };
 
    bool Use { true };
+
+   //! Of the stream, copied so that WriteData() need not use the format
+   //! context while it demuxes
+   AudacityAVRational TimeBase { 0, 1 };
+   int64_t FramesCount { 0 };
+};
+
+//! Reads the packets of some streams in a thread of its own, ahead of their
+//! decoding, at most a bounded number ahead
+class PacketsAhead final
+{
+public:
+   //! Starts reading
+   /*!
+    @param context is not otherwise used until this is destroyed
+    */
+   PacketsAhead(AVFormatContextWrapper& context, std::vector<int> streams);
+   //! Stops reading
+   ~PacketsAhead();
+
+   PacketsAhead(const PacketsAhead&) = delete;
+   PacketsAhead& operator=(const PacketsAhead&) = delete;
+
+   //! @return null at the end of the file
+   std::unique_ptr<AVPacketWrapper> Next();
+
+private:
+   static constexpr size_t MaxQueued = 64;
+
+   void Loop();
+
+   AVFormatContextWrapper& mContext;
+   const std::vector<int> mStreams;
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::deque<std::unique_ptr<AVPacketWrapper>> mPackets;
+   bool mEnd { false };
+   bool mStopping { false };
+   std::thread mThread;
 };
 
 ///! Does actual import, returned by FFmpegImportPlugin::Open
@@ -267,6 +312,10 @@ private:
 
    TranslatableStrings   mStreamInfo;    //!< Array of stream descriptions. After Init() and before Import(), same size as mStreamContexts
 
+   //! Copied before demuxing starts
+   int64_t               mFileSize = 0;
+   int64_t               mDuration = AUDACITY_AV_NOPTS_VALUE;
+
    wxInt64               mProgressPos = 0;   //!< Current timestamp, file position or whatever is used as first argument for Update()
    wxInt64               mProgressLen = 1;   //!< Duration, total length or whatever is used as second argument for Update()
 
@@ -277,6 +326,75 @@ private:
 };
 
 
+PacketsAhead::PacketsAhead(
+   AVFormatContextWrapper& context, std::vector<int> streams)
+    : mContext { context }
+    , mStreams { std::move(streams) }
+    , mThread { [this] { Loop(); } }
+{
+}
+
+PacketsAhead::~PacketsAhead()
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mStopping = true;
+   }
+   mCondition.notify_all();
+   mThread.join();
+}
+
+std::unique_ptr<AVPacketWrapper> PacketsAhead::Next()
+{
+   std::unique_lock<std::mutex> lock { mMutex };
+   mCondition.wait(lock, [this] { return mEnd || !mPackets.empty(); });
+   if (mPackets.empty())
+      return {};
+   auto packet = std::move(mPackets.front());
+   mPackets.pop_front();
+   mCondition.notify_all();
+   return packet;
+}
+
+void PacketsAhead::Loop()
+{
+   while (true)
+   {
+      {
+         std::unique_lock<std::mutex> lock { mMutex };
+         mCondition.wait(lock,
+            [this] { return mStopping || mPackets.size() < MaxQueued; });
+         if (mStopping)
+            return;
+      }
+
+      std::unique_ptr<AVPacketWrapper> packet;
+      try
+      {
+         packet = mContext.ReadNextPacket();
+      }
+      catch (...)
+      {
+         // End the import with what was read
+      }
+
+      // Packets of other streams are not queued
+      if (packet && std::find(mStreams.begin(), mStreams.end(),
+                       packet->GetStreamIndex()) == mStreams.end())
+         continue;
+
+      std::lock_guard<std::mutex> lock { mMutex };
+      if (!packet)
+      {
+         mEnd = true;
+         mCondition.notify_all();
+         return;
+      }
+      mPackets.push_back(std::move(packet));
+      mCondition.notify_all();
+   }
+}
+
 TranslatableString FFmpegImportPlugin::GetPluginFormatDescription()
 {
    return DESC;
@@ -383,6 +501,11 @@ bool FFmpegImportFileHandle::InitCodecs()
 
          auto codecContextPtr = stream->GetAVCodecContext();
 
+         // Let the decoder use threads, if it can
+         codecContextPtr->SetThreadCount(0);
+         codecContextPtr->SetThreadType(
+            AUDACITY_FF_THREAD_FRAME | AUDACITY_FF_THREAD_SLICE);
+
          if ( codecContextPtr->Open( codecContextPtr->GetCodec() ) < 0 )
          {
             wxLogError(wxT("FFmpeg : Open() failed. Index[%02d], Codec[%02x - %s]"),i,id,name);
@@ -398,7 +521,8 @@ bool FFmpegImportFileHandle::InitCodecs()
 
          mStreamContexts.emplace_back(
             StreamContext { stream->GetIndex(), std::move(codecContextPtr),
-                            channels, preferredFormat, true });
+                            channels, preferredFormat, true,
+                            stream->GetTimeBase(), stream->GetFramesCount() });
 
          // Stream is decodeable and it is audio. Add it and its description to the arrays
          int duration = 0;
@@ -500,25 +624,39 @@ void FFmpegImportFileHandle::Import(
 
    // This is the heart of the importing process
 
-   // Read frames.
-   for (std::unique_ptr<AVPacketWrapper> packet;
-        (packet = mAVFormatContext->ReadNextPacket()) != nullptr &&
-        !mCancelled && !mStopped;)
-   {
-      // Find a matching StreamContext
-      auto streamContextIt = std::find_if(
-         mStreamContexts.begin(), mStreamContexts.end(),
-         [index = packet->GetStreamIndex()](const StreamContext& ctx)
-         { return ctx.StreamIndex == index;
-      });
+   // The demuxer skips the packets of other streams, such as video
+   std::vector<int> streamIndices;
+   for (const auto& sc : mStreamContexts)
+      streamIndices.push_back(sc.StreamIndex);
+   for (const auto& stream : mAVFormatContext->GetStreams())
+      if (std::find(streamIndices.begin(), streamIndices.end(),
+             stream->GetIndex()) == streamIndices.end())
+         stream->SetDiscard(AUDACITY_AVDISCARD_ALL);
 
-      if (streamContextIt == mStreamContexts.end())
-         continue;
+   mFileSize = mFFmpeg->avio_size(mAVFormatContext->GetAVIOContext()->GetWrappedValue());
+   mDuration = mAVFormatContext->GetDuration();
 
-      WriteData(&(*streamContextIt), packet.get());
-      if(mProgressLen > 0)
-         progressListener.OnImportProgress(static_cast<double>(mProgressPos) /
-                                           static_cast<double>(mProgressLen));
+   // Read frames, in another thread, while this one decodes them.
+   {
+      PacketsAhead packets{ *mAVFormatContext, streamIndices };
+      for (std::unique_ptr<AVPacketWrapper> packet;
+           !mCancelled && !mStopped && (packet = packets.Next()) != nullptr;)
+      {
+         // Find a matching StreamContext
+         auto streamContextIt = std::find_if(
+            mStreamContexts.begin(), mStreamContexts.end(),
+            [index = packet->GetStreamIndex()](const StreamContext& ctx)
+            { return ctx.StreamIndex == index;
+         });
+
+         if (streamContextIt == mStreamContexts.end())
+            continue;
+
+         WriteData(&(*streamContextIt), packet.get());
+         if(mProgressLen > 0)
+            progressListener.OnImportProgress(static_cast<double>(mProgressPos) /
+                                              static_cast<double>(mProgressLen));
+      }
    }
 
    // Flush the decoders.
@@ -631,31 +769,29 @@ void FFmpegImportFileHandle::WriteData(StreamContext *sc, const AVPacketWrapper*
          ++channelIndex;
       });
    }
-   const AVStreamWrapper* avStream = mAVFormatContext->GetStream(sc->StreamIndex);
-
-   int64_t filesize = mFFmpeg->avio_size(mAVFormatContext->GetAVIOContext()->GetWrappedValue());
+   const auto filesize = mFileSize;
    // PTS (presentation time) is the proper way of getting current position
    if (
       packet->GetPresentationTimestamp() != AUDACITY_AV_NOPTS_VALUE &&
-      mAVFormatContext->GetDuration() != AUDACITY_AV_NOPTS_VALUE)
+      mDuration != AUDACITY_AV_NOPTS_VALUE)
    {
-      auto timeBase = avStream->GetTimeBase();
+      auto timeBase = sc->TimeBase;
 
       mProgressPos =
          packet->GetPresentationTimestamp() * timeBase.num / timeBase.den;
 
       mProgressLen =
-         (mAVFormatContext->GetDuration() > 0 ?
-             mAVFormatContext->GetDuration() / AUDACITY_AV_TIME_BASE :
+         (mDuration > 0 ?
+             mDuration / AUDACITY_AV_TIME_BASE :
              1);
    }
    // When PTS is not set, use number of frames and number of current frame
    else if (
-      avStream->GetFramesCount() > 0 && sc->CodecContext->GetFrameNumber() > 0 &&
-      sc->CodecContext->GetFrameNumber() <= avStream->GetFramesCount())
+      sc->FramesCount > 0 && sc->CodecContext->GetFrameNumber() > 0 &&
+      sc->CodecContext->GetFrameNumber() <= sc->FramesCount)
    {
       mProgressPos = sc->CodecContext->GetFrameNumber();
-      mProgressLen = avStream->GetFramesCount();
+      mProgressLen = sc->FramesCount;
    }
    // When number of frames is unknown, use position in file
    else if (
@@ -40,6 +40,9 @@ static_assert(
    AV_CODEC_FLAG_GLOBAL_HEADER == AUDACITY_AV_CODEC_FLAG_GLOBAL_HEADER
    && AV_CODEC_CAP_SMALL_LAST_FRAME == AUDACITY_AV_CODEC_CAP_SMALL_LAST_FRAME
    && AV_CODEC_FLAG_QSCALE == AUDACITY_AV_CODEC_FLAG_QSCALE
+   && FF_THREAD_FRAME == AUDACITY_FF_THREAD_FRAME
+   && FF_THREAD_SLICE == AUDACITY_FF_THREAD_SLICE
+   && AVDISCARD_ALL == AUDACITY_AVDISCARD_ALL
 ,
    "FFmpeg constants don't match"
 );
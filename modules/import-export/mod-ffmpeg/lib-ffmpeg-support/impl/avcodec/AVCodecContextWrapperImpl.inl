@@ -371,6 +371,34 @@ public:
          mAVCodecContext->strict_std_compliance = value;
    }
 
+   int GetThreadCount() const noexcept override
+   {
+      if (mAVCodecContext != nullptr)
+         return mAVCodecContext->thread_count;
+
+      return {};
+   }
+
+   void SetThreadCount(int value) noexcept override
+   {
+      if (mAVCodecContext != nullptr)
+         mAVCodecContext->thread_count = value;
+   }
+
+   int GetThreadType() const noexcept override
+   {
+      if (mAVCodecContext != nullptr)
+         return mAVCodecContext->thread_type;
+
+      return {};
+   }
+
+   void SetThreadType(int value) noexcept override
+   {
+      if (mAVCodecContext != nullptr)
+         mAVCodecContext->thread_type = value;
+   }
+
    struct AudacityAVRational GetTimeBase() const noexcept override
    {
       if (mAVCodecContext != nullptr)
@@ -105,6 +105,14 @@ public:
    virtual struct AudacityAVRational GetTimeBase() const noexcept = 0;
    virtual void SetTimeBase(struct AudacityAVRational value) noexcept = 0;
 
+   //! Zero lets the codec choose, before Open()
+   virtual int GetThreadCount() const noexcept = 0;
+   virtual void SetThreadCount(int value) noexcept = 0;
+
+   //! AUDACITY_FF_THREAD_FRAME and AUDACITY_FF_THREAD_SLICE flags
+   virtual int GetThreadType() const noexcept = 0;
+   virtual void SetThreadType(int value) noexcept = 0;
+
    /*!
     @param options   A dictionary filled with AVCodecContext and
     codec-private options. On return this object will be filled with
@@ -23,6 +23,9 @@ Joshua Haberman
 
 #include "FLAC++/encoder.h"
 
+#include <algorithm>
+#include <thread>
+
 #include "float_cast.h"
 #include "Mix.h"
 #include "Prefs.h"
@@ -33,6 +36,7 @@ Joshua Haberman
 #include "wxFileNameWrapper.h"
 
 #include "ExportPluginHelpers.h"
+#include "ExportSource.h"
 #include "ExportPluginRegistry.h"
 #include "PlainExportOptionsEditor.h"
 
@@ -184,7 +188,7 @@ class FLACExportProcessor final : public ExportProcessor
       sampleFormat format;
       FLAC::Encoder::File encoder;
       wxFFile f;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<ExportSource> source;
    } context;
 
 public:
@@ -377,6 +381,12 @@ bool FLACExportProcessor::Initialize(AudacityProject& project,
       throw ExportErrorException("FLAC:336");
    }
 
+#if defined(FLAC_API_VERSION_CURRENT) && FLAC_API_VERSION_CURRENT >= 14
+   // libflac 1.5 can encode frames in parallel; it falls back to one thread
+   // if it was built without threads
+   encoder.set_num_threads(std::max(1u, std::thread::hardware_concurrency()));
+#endif
+
 #ifdef LEGACY_FLAC
    encoder.init();
 #else
@@ -400,7 +410,7 @@ bool FLACExportProcessor::Initialize(AudacityProject& project,
 
    metadata.reset();
 
-   context.mixer = ExportPluginHelpers::CreateMixer(
+   context.source = ExportPluginHelpers::CreateSource(
       project, selectionOnly, t0, t1, numChannels, SAMPLES_PER_RUN, false,
       sampleRate, context.format, mixerSpec);
 
@@ -429,12 +439,12 @@ ExportResult FLACExportProcessor::Process(ExportProcessorDelegate& delegate)
    ArraysOf<FLAC__int32> tmpsmplbuf{ context.numChannels, SAMPLES_PER_RUN, true };
 
    while (exportResult == ExportResult::Success) {
-      auto samplesThisRun = context.mixer->Process();
+      auto samplesThisRun = context.source->Process();
       if (samplesThisRun == 0) //stop encoding
          break;
 
       for (size_t i = 0; i < context.numChannels; i++) {
-         auto mixed = context.mixer->GetBuffer(i);
+         auto mixed = context.source->GetBuffer(i);
          if (context.format == int24Sample) {
             for (decltype(samplesThisRun) j = 0; j < samplesThisRun; j++) {
                tmpsmplbuf[i][j] = ((const int *)mixed)[j];
@@ -453,7 +463,7 @@ ExportResult FLACExportProcessor::Process(ExportProcessorDelegate& delegate)
          throw ExportDiskFullError(context.fName);
       }
       exportResult = ExportPluginHelpers::UpdateProgress(
-         delegate, *context.mixer, context.t0, context.t1);
+         delegate, *context.source, context.t0, context.t1);
    }
 
    if (exportResult != ExportResult::Cancelled && exportResult != ExportResult::Error) {
@@ -26,6 +26,7 @@
 #include <wx/defs.h>
 
 #include "Import.h"
+#include "ImportByteStream.h"
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 
@@ -47,6 +48,10 @@ static const auto exts = {
 
 #include "WaveTrack.h"
 #include "ImportUtils.h"
+#include "concurrency/TaskScheduler.h"
+
+#include <algorithm>
+#include <vector>
 
 #ifdef USE_LIBID3TAG
 extern "C" {
@@ -87,7 +92,20 @@ class MyFLACFile final : public FLAC::Decoder::File
    FLACImportFileHandle *mFile;
    bool                  mWasError;
    wxArrayString         mComments;
+#ifndef LEGACY_FLAC
+   //! Read by the callbacks when initialized with Stream::init()
+   ImportByteStream     *mStream{ nullptr };
+   bool                  mStreamEnded{ false };
+#endif
  protected:
+#ifndef LEGACY_FLAC
+   FLAC__StreamDecoderReadStatus read_callback(
+      FLAC__byte buffer[], size_t *bytes) override;
+   bool eof_callback() override
+   {
+      return mStreamEnded;
+   }
+#endif
    FLAC__StreamDecoderWriteStatus write_callback(const FLAC__Frame *frame,
                                                          const FLAC__int32 * const buffer[]) override;
    void metadata_callback(const FLAC__StreamMetadata *metadata) override;
@@ -95,6 +113,46 @@ class MyFLACFile final : public FLAC::Decoder::File
 };
 
 
+#ifndef LEGACY_FLAC
+//! Decodes ranges of samples of a FLAC file, independently of other decoders
+//! of the same file, so that several may run in parallel
+class FLACSegmentDecoder final : public FLAC::Decoder::File
+{
+ public:
+   FLACSegmentDecoder()
+   {
+      set_metadata_ignore_all();
+   }
+
+   //! @return whether the file is open and its metadata read
+   bool Open(const FilePath &filename);
+
+   //! Decode samples [start, start + length) into GetChannels()
+   //! @return whether all of them were decoded with no error
+   bool Decode(FLAC__uint64 start, size_t length);
+
+   const std::vector<std::vector<FLAC__int32>> &GetChannels() const
+   {
+      return mChannels;
+   }
+
+ protected:
+   FLAC__StreamDecoderWriteStatus write_callback(const FLAC__Frame *frame,
+      const FLAC__int32 * const buffer[]) override;
+   void metadata_callback(const FLAC__StreamMetadata *) override {}
+   void error_callback(FLAC__StreamDecoderErrorStatus) override
+   {
+      mWasError = true;
+   }
+
+ private:
+   std::vector<std::vector<FLAC__int32>> mChannels;
+   size_t mLength{ 0 };
+   bool mWasError{ false };
+};
+#endif
+
+
 class FLACImportPlugin final : public ImportPlugin
 {
  public:
@@ -109,6 +167,10 @@ class FLACImportPlugin final : public ImportPlugin
    TranslatableString GetPluginFormatDescription() override;
    std::unique_ptr<ImportFileHandle> Open(
       const FilePath &Filename, AudacityProject*)  override;
+
+   bool SupportsStreams() const override;
+   std::unique_ptr<ImportFileHandle> OpenStream(
+      std::shared_ptr<ImportByteStream> stream, AudacityProject*) override;
 };
 
 
@@ -120,6 +182,10 @@ public:
    ~FLACImportFileHandle();
 
    bool Init();
+#ifndef LEGACY_FLAC
+   //! Like Init(), for a stream that is decoded as it arrives
+   bool InitStream(std::shared_ptr<ImportByteStream> stream);
+#endif
 
    TranslatableString GetFileDescription() override;
    ByteCount GetFileUncompressedBytes() override;
@@ -140,9 +206,23 @@ public:
    {}
 
 private:
+   //! Append the samples of each channel, as decoded by libflac
+   void AppendSamples(const FLAC__int32 * const buffer[], size_t length,
+      unsigned bitsPerSample);
+
+   //! Decode consecutive ranges of the file in parallel, and append them in
+   //! order
+   /*!
+    @return whether all of the file was imported, or the import cancelled or
+    stopped; else the samples from mSamplesDone remain to be decoded by mFile
+    */
+   bool ImportSegments(ImportProgressListener &progressListener);
+
    sampleFormat          mFormat;
    std::unique_ptr<MyFLACFile> mFile;
    wxFFile               mHandle;
+   //! When not null, is read by mFile instead of a file
+   std::shared_ptr<ImportByteStream> mStream;
    unsigned long         mSampleRate;
    unsigned long         mNumChannels;
    unsigned long         mBitsPerSample;
@@ -216,40 +296,29 @@ void MyFLACFile::error_callback(FLAC__StreamDecoderErrorStatus WXUNUSED(status))
    }*/
 }
 
+#ifndef LEGACY_FLAC
+FLAC__StreamDecoderReadStatus MyFLACFile::read_callback(
+   FLAC__byte buffer[], size_t *bytes)
+{
+   // Called only for a stream; libflac reads files by itself
+   return GuardedCall< FLAC__StreamDecoderReadStatus > ( [&] {
+      *bytes = mStream ? mStream->Read(buffer, *bytes) : 0;
+      if (*bytes == 0) {
+         mStreamEnded = true;
+         return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+      }
+      return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+   }, MakeSimpleGuard(FLAC__STREAM_DECODER_READ_STATUS_ABORT) );
+}
+#endif
+
 FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *frame,
                                                           const FLAC__int32 * const buffer[])
 {
    // Don't let C++ exceptions propagate through libflac
    return GuardedCall< FLAC__StreamDecoderWriteStatus > ( [&] {
-      auto tmp = ArrayOf< short >{ frame->header.blocksize };
-
-      unsigned chn = 0;
-      ImportUtils::ForEachChannel(*mFile->mTrack, [&](auto& channel)
-      {
-         if (frame->header.bits_per_sample <= 16) {
-            if (frame->header.bits_per_sample == 8) {
-               for (unsigned int s = 0; s < frame->header.blocksize; s++) {
-                  tmp[s] = buffer[chn][s] << 8;
-               }
-            } else /* if (frame->header.bits_per_sample == 16) */ {
-               for (unsigned int s = 0; s < frame->header.blocksize; s++) {
-                  tmp[s] = buffer[chn][s];
-               }
-            }
-
-            channel.AppendBuffer((samplePtr)tmp.get(),
-                     int16Sample,
-                     frame->header.blocksize, 1,
-                     int16Sample);
-         }
-         else {
-            channel.AppendBuffer((samplePtr)buffer[chn],
-                     int24Sample,
-                     frame->header.blocksize, 1,
-                     int24Sample);
-         }
-         ++chn;
-      });
+      mFile->AppendSamples(
+         buffer, frame->header.blocksize, frame->header.bits_per_sample);
 
       mFile->mSamplesDone += frame->header.blocksize;
 
@@ -266,6 +335,176 @@ FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *fra
    }, MakeSimpleGuard(FLAC__STREAM_DECODER_WRITE_STATUS_ABORT) );
 }
 
+void FLACImportFileHandle::AppendSamples(
+   const FLAC__int32 * const buffer[], size_t length, unsigned bitsPerSample)
+{
+   auto tmp = ArrayOf< short >{ length };
+
+   unsigned chn = 0;
+   ImportUtils::ForEachChannel(*mTrack, [&](auto& channel)
+   {
+      if (bitsPerSample <= 16) {
+         if (bitsPerSample == 8) {
+            for (size_t s = 0; s < length; s++) {
+               tmp[s] = buffer[chn][s] << 8;
+            }
+         } else /* if (bitsPerSample == 16) */ {
+            for (size_t s = 0; s < length; s++) {
+               tmp[s] = buffer[chn][s];
+            }
+         }
+
+         channel.AppendBuffer((samplePtr)tmp.get(),
+                  int16Sample,
+                  length, 1,
+                  int16Sample);
+      }
+      else {
+         channel.AppendBuffer((samplePtr)buffer[chn],
+                  int24Sample,
+                  length, 1,
+                  int24Sample);
+      }
+      ++chn;
+   });
+}
+
+#ifndef LEGACY_FLAC
+bool FLACSegmentDecoder::Open(const FilePath &filename)
+{
+   wxFFile handle;
+   if (!handle.Open(filename, wxT("rb")))
+      return false;
+
+   // As in FLACImportFileHandle::Init(), libflac takes the file handle
+   const auto status = init(handle.fp());
+   handle.Detach();
+   if (status != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+      return false;
+
+   if (!process_until_end_of_metadata() || mWasError)
+      return false;
+   mChannels.resize(get_channels());
+   return !mChannels.empty();
+}
+
+bool FLACSegmentDecoder::Decode(FLAC__uint64 start, size_t length)
+{
+   for (auto &channel : mChannels)
+      channel.clear();
+   mLength = length;
+   mWasError = false;
+
+   // Seeking decodes the frame containing `start`, from `start` on
+   if (!seek_absolute(start))
+      return false;
+   while (!mWasError && mChannels[0].size() < length) {
+      if (!process_single() ||
+          get_state() == FLAC__STREAM_DECODER_END_OF_STREAM)
+         break;
+   }
+   return !mWasError && mChannels[0].size() == length;
+}
+
+FLAC__StreamDecoderWriteStatus FLACSegmentDecoder::write_callback(
+   const FLAC__Frame *frame, const FLAC__int32 * const buffer[])
+{
+   // Don't let C++ exceptions propagate through libflac
+   return GuardedCall< FLAC__StreamDecoderWriteStatus > ( [&] {
+      if (frame->header.channels != mChannels.size())
+         return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+      const auto count = std::min<size_t>(
+         frame->header.blocksize, mLength - mChannels[0].size());
+      for (size_t chn = 0; chn < mChannels.size(); ++chn)
+         mChannels[chn].insert(
+            mChannels[chn].end(), buffer[chn], buffer[chn] + count);
+
+      // The rest of a frame past the range belongs to the next range
+      return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+   }, MakeSimpleGuard(FLAC__STREAM_DECODER_WRITE_STATUS_ABORT) );
+}
+#endif
+
+bool FLACImportFileHandle::ImportSegments(
+   ImportProgressListener &progressListener)
+{
+#ifdef LEGACY_FLAC
+   return false;
+#else
+   using namespace audacity::concurrency;
+
+   // Long enough that the seek to each range costs little
+   constexpr size_t SegmentLength = 1 << 18;
+
+   // A stream can only be decoded in order
+   if (mStream)
+      return false;
+
+   // The total may be unknown, and then is zero
+   auto &scheduler = TaskScheduler::Get();
+   const auto nSegments = std::min<FLAC__uint64>(scheduler.ThreadCount(),
+      (mNumSamples + SegmentLength - 1) / SegmentLength);
+   if (nSegments < 2)
+      return false;
+
+   std::vector<std::unique_ptr<FLACSegmentDecoder>> decoders;
+   for (size_t ii = 0; ii < nSegments; ++ii) {
+      auto decoder = std::make_unique<FLACSegmentDecoder>();
+      if (!decoder->Open(GetFilename()))
+         return false;
+      decoders.push_back(std::move(decoder));
+   }
+
+   // Decode as many ranges as there are decoders at once, so that memory for
+   // the decoded samples does not grow with the file
+   std::vector<char> decoded(nSegments);
+   while (mSamplesDone < mNumSamples) {
+      const auto start = mSamplesDone;
+      const auto length = [&](size_t ii) -> size_t {
+         const auto first = start + ii * SegmentLength;
+         return first < mNumSamples
+            ? std::min<FLAC__uint64>(SegmentLength, mNumSamples - first)
+            : 0;
+      };
+      {
+         TaskGroup group{ scheduler };
+         for (size_t ii = 0; ii < nSegments; ++ii) {
+            decoded[ii] = false;
+            if (length(ii) > 0)
+               group.Run([&, ii]{
+                  try {
+                     decoded[ii] = decoders[ii]->Decode(
+                        start + ii * SegmentLength, length(ii));
+                  }
+                  catch (...) {
+                  }
+               });
+         }
+         group.Wait();
+      }
+
+      for (size_t ii = 0; ii < nSegments && length(ii) > 0; ++ii) {
+         if (!decoded[ii])
+            return false;
+
+         const auto &channels = decoders[ii]->GetChannels();
+         std::vector<const FLAC__int32 *> buffers;
+         for (const auto &channel : channels)
+            buffers.push_back(channel.data());
+         AppendSamples(buffers.data(), length(ii), mBitsPerSample);
+         mSamplesDone += length(ii);
+      }
+
+      progressListener.OnImportProgress(static_cast<double>(mSamplesDone) /
+                                        static_cast<double>(mNumSamples));
+      if (IsCancelled() || IsStopped())
+         return true;
+   }
+   return true;
+#endif
+}
+
 TranslatableString FLACImportPlugin::GetPluginFormatDescription()
 {
     return DESC;
@@ -314,6 +553,33 @@ std::unique_ptr<ImportFileHandle> FLACImportPlugin::Open(
    return std::move(handle);
 }
 
+bool FLACImportPlugin::SupportsStreams() const
+{
+#ifdef LEGACY_FLAC
+   return false;
+#else
+   return true;
+#endif
+}
+
+std::unique_ptr<ImportFileHandle> FLACImportPlugin::OpenStream(
+   std::shared_ptr<ImportByteStream> stream, AudacityProject*)
+{
+#ifdef LEGACY_FLAC
+   return nullptr;
+#else
+   const auto name = stream->GetName();
+   auto handle = std::make_unique<FLACImportFileHandle>(name);
+
+   if (!handle->InitStream(std::move(stream))) {
+      return nullptr;
+   }
+
+   // This std::move is needed to "upcast" the pointer type
+   return std::move(handle);
+#endif
+}
+
 static Importer::RegisteredImportPlugin registered{ "FLAC",
    std::make_unique< FLACImportPlugin >()
 };
@@ -380,6 +646,27 @@ bool FLACImportFileHandle::Init()
    return true;
 }
 
+#ifndef LEGACY_FLAC
+bool FLACImportFileHandle::InitStream(std::shared_ptr<ImportByteStream> stream)
+{
+   mStream = std::move(stream);
+   mFile->mStream = mStream.get();
+
+   // The stream decoder under the file decoder, calling back read_callback()
+   if (mFile->FLAC::Decoder::Stream::init() !=
+       FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+      return false;
+   }
+   mFile->process_until_end_of_metadata();
+
+   if (mFile->get_state() > FLAC__STREAM_DECODER_READ_FRAME) {
+      return false;
+   }
+
+   return mFile->is_valid() && !mFile->get_was_error() && mStreamInfoDone;
+}
+#endif
+
 TranslatableString FLACImportFileHandle::GetFileDescription()
 {
    return DESC;
@@ -409,13 +696,18 @@ void FLACImportFileHandle::Import(
 
    mFile->mImportProgressListener = &progressListener;
 
-   // TODO: Vigilant Sentry: Variable res unused after assignment (error code DA1)
-   //    Should check the result.
-   #ifdef LEGACY_FLAC
-      bool res = (mFile->process_until_end_of_file() != 0);
-   #else
-      bool res = (mFile->process_until_end_of_stream() != 0);
-   #endif
+   // Decode in parallel when possible; else, or after a failure there,
+   // decode the rest in this thread
+   if (!ImportSegments(progressListener) &&
+       (mSamplesDone == 0 || mFile->seek_absolute(mSamplesDone))) {
+      // TODO: Vigilant Sentry: Variable res unused after assignment (error code DA1)
+      //    Should check the result.
+      #ifdef LEGACY_FLAC
+         bool res = (mFile->process_until_end_of_file() != 0);
+      #else
+         bool res = (mFile->process_until_end_of_stream() != 0);
+      #endif
+   }
 
    if(IsCancelled())
    {
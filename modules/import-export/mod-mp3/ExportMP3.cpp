@@ -97,6 +97,7 @@
 
 #include "ExportOptionsEditor.h"
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportPluginRegistry.h"
 #include "SelectFile.h"
 #include "ShuttleGui.h"
@@ -1603,7 +1604,7 @@ class MP3ExportProcessor final : public ExportProcessor
       wxFileOffset infoTagPos;
       size_t bufferSize;
       int inSamples;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
    } context;
 
 public:
@@ -1944,7 +1945,7 @@ bool MP3ExportProcessor::Initialize(AudacityProject& project,
             .Format( bitrate );
    }
 
-   context.mixer = ExportPluginHelpers::CreateMixer(
+   context.mixer = ExportPluginHelpers::CreatePipelinedMixer(
       project, selectionOnly, t0, t1, channels, context.inSamples, true, rate,
       floatSample, mixerSpec);
 
@@ -15,6 +15,7 @@
 
 #include "Import.h"
 #include "BasicUI.h"
+#include "ImportByteStream.h"
 #include "ImportPlugin.h"
 #include "ImportUtils.h"
 #include "ImportProgressListener.h"
@@ -118,6 +119,14 @@ public:
    }
 
    std::unique_ptr<ImportFileHandle> Open(const FilePath &Filename, AudacityProject*) override;
+
+   bool SupportsStreams() const override
+   {
+      return true;
+   }
+
+   std::unique_ptr<ImportFileHandle> OpenStream(
+      std::shared_ptr<ImportByteStream> stream, AudacityProject*) override;
 }; // class MP3ImportPlugin
 
 class MP3ImportFileHandle final : public ImportFileHandleEx
@@ -150,6 +159,8 @@ private:
 
    wxFile mFile;
    wxFileOffset mFileLen { 0 };
+   //! When not null, is read instead of mFile, which is not opened
+   std::shared_ptr<ImportByteStream> mStream;
 
    WaveTrackFactory* mTrackFactory { nullptr };
    WaveTrack::Holder mTrack;
@@ -173,6 +184,18 @@ std::unique_ptr<ImportFileHandle> MP3ImportPlugin::Open(
    return handle;
 }
 
+std::unique_ptr<ImportFileHandle> MP3ImportPlugin::OpenStream(
+   std::shared_ptr<ImportByteStream> stream, AudacityProject *)
+{
+   auto handle = std::make_unique<MP3ImportFileHandle>(stream->GetName());
+   handle->mStream = std::move(stream);
+
+   if (!handle->Open())
+      return nullptr;
+
+   return handle;
+}
+
 static Importer::RegisteredImportPlugin registered
 {
    "MP3",
@@ -455,6 +478,17 @@ bool MP3ImportFileHandle::Open()
    if (mHandle == nullptr)
       return false;
 
+   // A stream is decoded as it arrives, with no scan, and so with no length
+   // for the progress
+   if (mStream)
+   {
+      if (mpg123_open_handle(mHandle, this) != MPG123_OK)
+         return false;
+
+      return mpg123_decode_frame(mHandle, nullptr, nullptr, nullptr) ==
+             MPG123_NEW_FORMAT;
+   }
+
    // Open the file
    if (!mFile.Open(GetFilename()))
    {
@@ -501,7 +535,10 @@ bool MP3ImportFileHandle::Open()
 ptrdiff_t MP3ImportFileHandle::ReadCallback(
    void* handle, void* buffer, size_t size)
 {
-   return static_cast<MP3ImportFileHandle*>(handle)->mFile.Read(buffer, size);
+   const auto self = static_cast<MP3ImportFileHandle*>(handle);
+   if (self->mStream)
+      return self->mStream->Read(buffer, size);
+   return self->mFile.Read(buffer, size);
 }
 
 wxSeekMode GetWXSeekMode(int whence)
@@ -525,8 +562,11 @@ wxSeekMode GetWXSeekMode(int whence)
 off_t MP3ImportFileHandle::SeekCallback(
    void* handle, off_t offset, int whence)
 {
-   return static_cast<MP3ImportFileHandle*>(handle)->mFile.Seek(
-      offset, GetWXSeekMode(whence));
+   const auto self = static_cast<MP3ImportFileHandle*>(handle);
+   // libmpg123 then knows that the stream is not seekable
+   if (self->mStream)
+      return -1;
+   return self->mFile.Seek(offset, GetWXSeekMode(whence));
 }
 
 } // namespace
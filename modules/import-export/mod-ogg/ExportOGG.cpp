@@ -20,6 +20,7 @@
 
 #include "wxFileNameWrapper.h"
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportPluginRegistry.h"
 #include "FileIO.h"
 #include "Mix.h"
@@ -107,7 +108,7 @@ class OGGExportProcessor final : public ExportProcessor
       double t0;
       double t1;
       unsigned numChannels;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       std::unique_ptr<FileIO> outFile;
       wxFileNameWrapper fName;
 
@@ -268,7 +269,7 @@ bool OGGExportProcessor::Initialize(AudacityProject& project,
       }
    }
 
-   context.mixer = ExportPluginHelpers::CreateMixer(
+   context.mixer = ExportPluginHelpers::CreatePipelinedMixer(
       project, selectionOnly, t0, t1, numChannels, SAMPLES_PER_RUN, false,
       sampleRate, floatSample, mixerSpec);
 
@@ -49,6 +49,7 @@ static const auto exts = {
 #include <vorbis/vorbisfile.h>
 
 #include "WaveTrack.h"
+#include "ImportByteStream.h"
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "ImportUtils.h"
@@ -67,17 +68,24 @@ public:
    TranslatableString GetPluginFormatDescription() override;
    std::unique_ptr<ImportFileHandle> Open(
       const FilePath &Filename, AudacityProject*) override;
+
+   bool SupportsStreams() const override { return true; }
+   std::unique_ptr<ImportFileHandle> OpenStream(
+      std::shared_ptr<ImportByteStream> stream, AudacityProject*) override;
 };
 
 
 class OggImportFileHandle final : public ImportFileHandleEx
 {
 public:
+   //! @param file may be null when vorbisFile reads a stream
    OggImportFileHandle(const FilePath & filename,
                        std::unique_ptr<wxFFile> &&file,
-                       std::unique_ptr<OggVorbis_File> &&vorbisFile)
+                       std::unique_ptr<OggVorbis_File> &&vorbisFile,
+                       std::shared_ptr<ImportByteStream> stream = {})
    :  ImportFileHandleEx(filename),
       mFile(std::move(file)),
+      mStream(std::move(stream)),
       mVorbisFile(std::move(vorbisFile))
       , mStreamUsage{ static_cast<size_t>(mVorbisFile->links) }
    {
@@ -127,6 +135,9 @@ public:
 
 private:
    std::unique_ptr<wxFFile> mFile;
+   //! Read by mVorbisFile, which then can only decode forward, when mFile
+   //! is null
+   std::shared_ptr<ImportByteStream> mStream;
    std::unique_ptr<OggVorbis_File> mVorbisFile;
 
    ArrayOf<int> mStreamUsage;
@@ -187,6 +198,31 @@ std::unique_ptr<ImportFileHandle> OggImportPlugin::Open(
    return std::make_unique<OggImportFileHandle>(filename, std::move(file), std::move(vorbisFile));
 }
 
+std::unique_ptr<ImportFileHandle> OggImportPlugin::OpenStream(
+   std::shared_ptr<ImportByteStream> stream, AudacityProject*)
+{
+   // With no seek callback, libvorbisfile reads the stream only forward, and
+   // knows only its first logical bitstream
+   ov_callbacks callbacks {
+      [](void *buffer, size_t size, size_t count, void *source) -> size_t {
+         if (size == 0)
+            return 0;
+         return static_cast<ImportByteStream *>(source)->Read(
+            buffer, size * count) / size;
+      },
+      nullptr, nullptr, nullptr
+   };
+
+   auto vorbisFile = std::make_unique<OggVorbis_File>();
+   if (ov_open_callbacks(
+         stream.get(), vorbisFile.get(), NULL, 0, callbacks) < 0)
+      return nullptr;
+
+   const auto name = stream->GetName();
+   return std::make_unique<OggImportFileHandle>(
+      name, nullptr, std::move(vorbisFile), std::move(stream));
+}
+
 static Importer::RegisteredImportPlugin registered{ "OGG",
    std::make_unique< OggImportPlugin >()
 };
@@ -211,7 +247,7 @@ void OggImportFileHandle::Import(
 
    outTracks.clear();
 
-   wxASSERT(mFile->IsOpened());
+   wxASSERT(mStream || mFile->IsOpened());
 
    //Number of streams used may be less than mVorbisFile->links,
    //but this way bitstream matches array index.
@@ -364,6 +400,7 @@ void OggImportFileHandle::Import(
 OggImportFileHandle::~OggImportFileHandle()
 {
    ov_clear(mVorbisFile.get());
-   mFile->Detach();    // so that it doesn't try to close the file (ov_clear()
+   if (mFile)
+      mFile->Detach(); // so that it doesn't try to close the file (ov_clear()
                        // did that already)
 }
@@ -28,6 +28,7 @@
 #include "Tags.h"
 
 #include "ExportPluginHelpers.h"
+#include "PipelinedMixer.h"
 #include "ExportOptionsEditor.h"
 #include "ExportPluginRegistry.h"
 
@@ -346,7 +347,7 @@ class OpusExportProcessor final : public ExportProcessor
       unsigned numChannels {};
       wxFileNameWrapper fName;
       wxFile outFile;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<PipelinedMixer> mixer;
       std::unique_ptr<Tags> metadata;
 
       // Encoder properties
@@ -755,7 +756,7 @@ bool OpusExportProcessor::Initialize(
 
    WriteTags();
 
-   context.mixer = ExportPluginHelpers::CreateMixer(
+   context.mixer = ExportPluginHelpers::CreatePipelinedMixer(
       project, selectionOnly, t0, t1, numChannels, context.opus.frameSize, true,
       sampleRate, floatSample, mixerSpec);
 
@@ -28,6 +28,7 @@
 #include "ExportOptionsEditor.h"
 
 #include "ExportPluginHelpers.h"
+#include "ExportSource.h"
 #include "ExportPluginRegistry.h"
 
 #ifdef USE_LIBID3TAG
@@ -384,7 +385,7 @@ class PCMExportProcessor final : public ExportProcessor
       int subformat;
       double t0;
       double t1;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<ExportSource> source;
       TranslatableString status;
       SF_INFO info;
       sampleFormat format;
@@ -678,7 +679,7 @@ bool PCMExportProcessor::Initialize(AudacityProject& project,
 
 
       wxASSERT(info.channels >= 0);
-      context.mixer = ExportPluginHelpers::CreateMixer(
+      context.source = ExportPluginHelpers::CreateSource(
          project, selectionOnly, t0, t1, info.channels, maxBlockLen, true,
          sampleRate, context.format, mixerSpec);
    }
@@ -700,11 +701,11 @@ ExportResult PCMExportProcessor::Process(ExportProcessorDelegate& delegate)
 
       while (exportResult == ExportResult::Success) {
          sf_count_t samplesWritten;
-         size_t numSamples = context.mixer->Process();
+         size_t numSamples = context.source->Process();
          if (numSamples == 0)
             break;
 
-         auto mixed = context.mixer->GetBuffer();
+         auto mixed = context.source->GetBuffer();
 
          // Bug 1572: Not ideal, but it does add the desired dither
          if ((context.info.format & SF_FORMAT_SUBMASK) == SF_FORMAT_PCM_24) {
@@ -754,7 +755,7 @@ ExportResult PCMExportProcessor::Process(ExportProcessorDelegate& delegate)
          }
          if(exportResult == ExportResult::Success)
             exportResult = ExportPluginHelpers::UpdateProgress(
-               delegate, *context.mixer, context.t0, context.t1);
+               delegate, *context.source, context.t0, context.t1);
       }
    }
 
@@ -26,6 +26,7 @@
 
 #include <wx/wx.h>
 #include <wx/ffile.h>
+#include <wx/filefn.h>
 
 #include "sndfile.h"
 
@@ -35,12 +36,22 @@
 
 #include "FileFormats.h"
 #include "GetAcidizerTags.h"
+#include "ImportByteStream.h"
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "ImportUtils.h"
 #include "WaveTrack.h"
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
+
+#ifdef __WXMSW__
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 #ifdef USE_LIBID3TAG
    #include <id3tag.h>
@@ -56,6 +67,87 @@
 
 #define DESC XO("WAV, AIFF, and other uncompressed types")
 
+namespace {
+//! Copies a stream into an operating system pipe, in a thread of its own
+/*!
+ libsndfile reads a pipe forward only, as it reads stdin, skipping what in a
+ file it would seek past
+ */
+class StreamPipe final
+{
+public:
+   explicit StreamPipe(std::shared_ptr<ImportByteStream> stream);
+   //! Waits for the copying to stop, which it does after the next read from
+   //! the stream
+   ~StreamPipe();
+
+   StreamPipe(const StreamPipe&) = delete;
+   StreamPipe& operator=(const StreamPipe&) = delete;
+
+   //! @return the end of the pipe to read, owned by this, or -1 on failure
+   int GetDescriptor() const noexcept { return mDescriptors[0]; }
+
+private:
+   void Copy();
+
+   const std::shared_ptr<ImportByteStream> mStream;
+   int mDescriptors[2] { -1, -1 };
+   std::atomic<bool> mStopping { false };
+   std::thread mThread;
+};
+
+StreamPipe::StreamPipe(std::shared_ptr<ImportByteStream> stream)
+   : mStream{ std::move(stream) }
+{
+#ifdef __WXMSW__
+   const auto result = _pipe(mDescriptors, 1 << 16, _O_BINARY);
+#else
+   const auto result = pipe(mDescriptors);
+#endif
+   if (result != 0) {
+      mDescriptors[0] = mDescriptors[1] = -1;
+      return;
+   }
+   mThread = std::thread{ [this]{ Copy(); } };
+}
+
+StreamPipe::~StreamPipe()
+{
+   if (!mThread.joinable())
+      return;
+
+   // Keep the reading end open, so that writing fails with no signal, and
+   // empty the pipe until the other end is closed
+   mStopping = true;
+   char buffer[1 << 12];
+   while (wxRead(mDescriptors[0], buffer, sizeof(buffer)) > 0)
+      ;
+   mThread.join();
+   wxClose(mDescriptors[0]);
+}
+
+void StreamPipe::Copy()
+{
+   char buffer[1 << 16];
+   while (!mStopping) {
+      const auto count = mStream->Read(buffer, sizeof(buffer));
+      if (count == 0)
+         break;
+      for (size_t written = 0; written < count && !mStopping;) {
+         const auto result = wxWrite(
+            mDescriptors[1], buffer + written, count - written);
+         if (result <= 0) {
+            mStopping = true;
+            break;
+         }
+         written += result;
+      }
+   }
+   // The reader then sees the end of the file
+   wxClose(mDescriptors[1]);
+}
+}
+
 class PCMImportPlugin final : public ImportPlugin
 {
 public:
@@ -70,13 +162,19 @@ public:
    TranslatableString GetPluginFormatDescription() override;
    std::unique_ptr<ImportFileHandle> Open(
       const FilePath &Filename, AudacityProject*) override;
+
+   bool SupportsStreams() const override { return true; }
+   std::unique_ptr<ImportFileHandle> OpenStream(
+      std::shared_ptr<ImportByteStream> stream, AudacityProject*) override;
 };
 
 
 class PCMImportFileHandle final : public ImportFileHandleEx
 {
 public:
-   PCMImportFileHandle(const FilePath &name, SFFile &&file, SF_INFO info);
+   //! @param pipe when not null, is what file reads
+   PCMImportFileHandle(const FilePath &name, SFFile &&file, SF_INFO info,
+      std::unique_ptr<StreamPipe> pipe = {});
    ~PCMImportFileHandle();
 
    TranslatableString GetFileDescription() override;
@@ -98,6 +196,8 @@ public:
    {}
 
 private:
+   //! Destroyed after mFile, which reads it
+   std::unique_ptr<StreamPipe> mPipe;
    SFFile                mFile;
    const SF_INFO         mInfo;
    sampleFormat          mEffectiveFormat;
@@ -174,13 +274,38 @@ std::unique_ptr<ImportFileHandle> PCMImportPlugin::Open(
    return std::make_unique<PCMImportFileHandle>(filename, std::move(file), info);
 }
 
+std::unique_ptr<ImportFileHandle> PCMImportPlugin::OpenStream(
+   std::shared_ptr<ImportByteStream> stream, AudacityProject*)
+{
+   const auto name = stream->GetName();
+   auto pipe = std::make_unique<StreamPipe>(std::move(stream));
+   if (pipe->GetDescriptor() < 0)
+      return nullptr;
+
+   SF_INFO info;
+   memset(&info, 0, sizeof(info));
+   SFFile file;
+   // The pipe closes its descriptor
+   file.reset(SFCall<SNDFILE*>(
+      sf_open_fd, pipe->GetDescriptor(), SFM_READ, &info, FALSE));
+
+   // As in Open(), do not let libsndfile read Ogg
+   if (!file || (info.format & SF_FORMAT_TYPEMASK) == SF_FORMAT_OGG)
+      return nullptr;
+
+   return std::make_unique<PCMImportFileHandle>(
+      name, std::move(file), info, std::move(pipe));
+}
+
 static Importer::RegisteredImportPlugin registered{ "PCM",
    std::make_unique< PCMImportPlugin >()
 };
 
 PCMImportFileHandle::PCMImportFileHandle(const FilePath &name,
-                                         SFFile &&file, SF_INFO info)
+                                         SFFile &&file, SF_INFO info,
+                                         std::unique_ptr<StreamPipe> pipe)
 :  ImportFileHandleEx(name),
+   mPipe(std::move(pipe)),
    mFile(std::move(file)),
    mInfo(info)
 {
@@ -308,20 +433,27 @@ void PCMImportFileHandle::Import(
          progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
          return;
       }
+      // Reading several blocks at once lets a mono track make whole blocks
+      // straight from the read buffer.  Other channels are appended from the
+      // interleaved frames with a stride, so there is no other copy
+      const size_t blocksPerRead = mInfo.channels == 1 ? 4 : 1;
       auto maxBlock = std::min(maxBlockSize,
          std::numeric_limits<type>::max() /
-            (mInfo.channels * SAMPLE_SIZE(mFormat))
-      );
+            (blocksPerRead * mInfo.channels * SAMPLE_SIZE(mFormat))
+      ) * blocksPerRead;
       if (maxBlock < 1)
       {
          progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
          return;
       }
 
-      SampleBuffer srcbuffer, buffer;
+      //import 24 bit int as float and have the append function convert it.  This is how PCMAliasBlockFile worked too.
+      const auto readFormat =
+         (mFormat == int16Sample) ? int16Sample : floatSample;
+
+      SampleBuffer srcbuffer;
       wxASSERT(mInfo.channels >= 0);
-      while (NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, mFormat).ptr() ||
-             NULL == buffer.Allocate(maxBlock, mFormat).ptr())
+      while (NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, readFormat).ptr())
       {
          maxBlock /= 2;
          if (maxBlock < 1)
@@ -337,9 +469,8 @@ void PCMImportFileHandle::Import(
       do {
          block = maxBlock;
 
-         if (mFormat == int16Sample)
+         if (readFormat == int16Sample)
             block = SFCall<sf_count_t>(sf_readf_short, mFile.get(), (short *)srcbuffer.ptr(), block);
-         //import 24 bit int as float and have the append function convert it.  This is how PCMAliasBlockFile worked too.
          else
             block = SFCall<sf_count_t>(sf_readf_float, mFile.get(), (float *)srcbuffer.ptr(), block);
 
@@ -352,21 +483,9 @@ void PCMImportFileHandle::Import(
             unsigned c = 0;
             ImportUtils::ForEachChannel(*trackList, [&](auto& channel)
             {
-               if (mFormat==int16Sample) {
-                  for(int j=0; j<block; j++)
-                     ((short *)buffer.ptr())[j] =
-                        ((short *)srcbuffer.ptr())[mInfo.channels*j+c];
-               }
-               else {
-                  for(int j=0; j<block; j++)
-                     ((float *)buffer.ptr())[j] =
-                        ((float *)srcbuffer.ptr())[mInfo.channels*j+c];
-               }
-
                channel.AppendBuffer(
-                  buffer.ptr(),
-                  (mFormat == int16Sample) ? int16Sample : floatSample,
-                  block, 1, mEffectiveFormat
+                  srcbuffer.ptr() + c * SAMPLE_SIZE(readFormat), readFormat,
+                  block, mInfo.channels, mEffectiveFormat
                );
                ++c;
             });
@@ -439,8 +558,10 @@ void PCMImportFileHandle::Import(
       outAcidTags.emplace(*acidTags);
 
 #if defined(USE_LIBID3TAG)
-   if (((mInfo.format & SF_FORMAT_TYPEMASK) == SF_FORMAT_AIFF) ||
-       ((mInfo.format & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAV)) {
+   // A stream is not a file to read again
+   if (!mPipe &&
+       (((mInfo.format & SF_FORMAT_TYPEMASK) == SF_FORMAT_AIFF) ||
+        ((mInfo.format & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAV))) {
       wxFFile f(GetFilename(), wxT("rb"));
       if (f.IsOpened()) {
          char id[5];
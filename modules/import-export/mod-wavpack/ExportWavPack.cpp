@@ -26,6 +26,7 @@
 #include "Tags.h"
 
 #include "ExportPluginHelpers.h"
+#include "ExportSource.h"
 #include "ExportOptionsEditor.h"
 #include "ExportPluginRegistry.h"
 
@@ -256,7 +257,7 @@ class WavPackExportProcessor final : public ExportProcessor
       sampleFormat format;
       WriteId outWvFile, outWvcFile;
       WavpackContext *wpc{};
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<ExportSource> source;
       std::unique_ptr<Tags> metadata;
    } context;
 public:
@@ -483,7 +484,7 @@ bool WavPackExportProcessor::Initialize(AudacityProject& project,
          : *metadata
       );
 
-   context.mixer = ExportPluginHelpers::CreateMixer(
+   context.source = ExportPluginHelpers::CreateSource(
       project, selectionOnly, t0, t1, numChannels, SAMPLES_PER_RUN, true,
       sampleRate, context.format, mixerSpec);
 
@@ -502,20 +503,20 @@ ExportResult WavPackExportProcessor::Process(ExportProcessorDelegate& delegate)
    {
 
       while (exportResult == ExportResult::Success) {
-         auto samplesThisRun = context.mixer->Process();
+         auto samplesThisRun = context.source->Process();
 
          if (samplesThisRun == 0)
             break;
 
          if (context.format == int16Sample) {
-            const int16_t *mixed = reinterpret_cast<const int16_t*>(context.mixer->GetBuffer());
+            const int16_t *mixed = reinterpret_cast<const int16_t*>(context.source->GetBuffer());
             for (decltype(samplesThisRun) j = 0; j < samplesThisRun; j++) {
                for (size_t i = 0; i < context.numChannels; i++) {
                   wavpackBuffer[j*context.numChannels + i] = (static_cast<int32_t>(*mixed++) * 65536) >> 16;
                }
             }
          } else {
-            const int *mixed = reinterpret_cast<const int*>(context.mixer->GetBuffer());
+            const int *mixed = reinterpret_cast<const int*>(context.source->GetBuffer());
             for (decltype(samplesThisRun) j = 0; j < samplesThisRun; j++) {
                for (size_t i = 0; i < context.numChannels; i++) {
                   wavpackBuffer[j*context.numChannels + i] = *mixed++;
@@ -527,7 +528,7 @@ ExportResult WavPackExportProcessor::Process(ExportProcessorDelegate& delegate)
             throw ExportErrorException(WavpackGetErrorMessage(context.wpc));
          }
          exportResult = ExportPluginHelpers::UpdateProgress(
-            delegate, *context.mixer, context.t0, context.t1);
+            delegate, *context.source, context.t0, context.t1);
       }
    }
 
@@ -70,7 +70,8 @@ void PipeServer()
          for(;;)
          {
             printf( "About to read\n" );
-            bSuccess = ReadFile( hPipeToSrv, chRequest, nBuff, &cbBytesRead, NULL);
+            // Leave room for the terminating null
+            bSuccess = ReadFile( hPipeToSrv, chRequest, nBuff - 1, &cbBytesRead, NULL);
 
             chRequest[ cbBytesRead] = '\0'; 
 
@@ -111,12 +112,15 @@ void PipeServer()
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 
 const char fifotmpl[] = "/tmp/audacity_script_pipe.%s.%d";
 
 const int nBuff = 1024;
+// Responses are written in pieces that large
+const int nResponseBuff = 64 * 1024;
 
 extern "C" int DoSrv( char * pIn );
 extern "C" int DoSrvMore( char * pOut, size_t nMax );
@@ -126,7 +130,10 @@ void PipeServer()
    FILE *fromFifo = NULL;
    FILE *toFifo = NULL;
    int rc;
-   char buf[nBuff];
+   // Commands can be of any length, getline grows the buffer as needed
+   char *buf = NULL;
+   size_t bufSize = 0;
+   static char response[nResponseBuff];
    char toFifoName[nBuff];
    char fromFifoName[nBuff];
 
@@ -164,9 +171,9 @@ void PipeServer()
       return;
    }
 
-   while (fgets(buf, sizeof(buf), toFifo) != NULL)
+   ssize_t len;
+   while ((len = getline(&buf, &bufSize, toFifo)) != -1)
    {
-      int len = strlen(buf);
       if (len <= 1)
       {
          continue;
@@ -179,21 +186,23 @@ void PipeServer()
 
       while (true)
       {
-         len = DoSrvMore(buf, nBuff);
+         len = DoSrvMore(response, nResponseBuff);
          if (len <= 1)
          {
             break;
          }
-         printf("Server sending %s",buf);
+         printf("Server sending %s",response);
 
          // len - 1 because we do not send the null character
-         fwrite(buf, 1, len - 1, fromFifo);
+         fwrite(response, 1, len - 1, fromFifo);
       }
       fflush(fromFifo);
    }
 
    printf("Read failed on fifo, quitting\n");
 
+   free(buf);
+
    if (toFifo != NULL)
       fclose(toFifo);
 
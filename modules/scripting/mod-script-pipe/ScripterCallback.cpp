@@ -57,12 +57,11 @@ extern "C" DLL_API int ModuleDispatch(ModuleDispatchTypes type)
 }
 
 wxString Str2;
-wxArrayString aStr;
-unsigned int currentLine;
+wxCharBuffer response;
 size_t currentPosition;
 
-// Send the received command to Audacity and build an array of response lines.
-// The response lines can be retrieved by calling DoSrvMore repeatedly.
+// Send the received command to Audacity and prepare the response.
+// The response can be retrieved by calling DoSrvMore repeatedly.
 int DoSrv(char *pIn)
 {
    // Interpret string as unicode.
@@ -76,20 +75,10 @@ int DoSrv(char *pIn)
    (*pScriptServerFn)( &Str1 , &Str2);
 
    Str2 += wxT('\n');
-   size_t outputLength = Str2.Length();
-   aStr.Clear();
-   size_t iStart = 0;
-   size_t i;
-   for(i = 0; i < outputLength; ++i)
-   {
-      if( Str2[i] == wxT('\n') )
-      {
-         aStr.Add( Str2.Mid( iStart, i-iStart) + wxT("\n") );
-         iStart = i+1;
-      }
-   }
+   // Converted once, so that long responses are not converted again for
+   // each piece that is sent
+   response = Str2.ToUTF8();
 
-   currentLine     = 0;
    currentPosition = 0;
 
    return 1;
@@ -97,46 +86,25 @@ int DoSrv(char *pIn)
 
 size_t smin(size_t a, size_t b) { return a < b ? a : b; }
 
-// Write up to nMax characters of the prepared (by DoSrv) response lines.
+// Write up to nMax characters of the response prepared by DoSrv.
 // Returns the number of characters sent, including null.
 // Zero returned if and only if there's nothing else to send.
 int DoSrvMore(char *pOut, size_t nMax)
 {
-   wxASSERT(currentLine >= 0);
-   wxASSERT(currentPosition >= 0);
-
-   size_t totalLines = aStr.GetCount();
-   while (currentLine < totalLines)
-   {
-      wxCharBuffer lineString    = aStr[currentLine].ToUTF8();
-      size_t lineLength      = lineString.length();
-      size_t charsLeftInLine = lineLength - currentPosition;
-
-      wxASSERT(charsLeftInLine >= 0);
-
-      if (charsLeftInLine == 0)
-      {
-         // Move to next line
-         ++currentLine;
-         currentPosition = 0;
-      }
-      else
-      {
-         // Write as much of the rest of the line as will fit in the buffer
-         size_t charsToWrite = smin(charsLeftInLine, nMax - 1);
-         memcpy(pOut, 
-                &(lineString.data()[currentPosition]),
-                charsToWrite);
-         pOut[charsToWrite] = '\0';
-         currentPosition    += charsToWrite;
-         // Need to cast to prevent compiler warnings
-         int charsWritten = static_cast<int>(charsToWrite + 1);
-         // (Check cast was safe)
-         wxASSERT(static_cast<size_t>(charsWritten) == charsToWrite + 1);
-         return charsWritten;
-      }
-   }
-   return 0;
+   const size_t responseLength = response.length();
+   if (currentPosition >= responseLength)
+      return 0;
+
+   // Write as much of the rest of the response as will fit in the buffer
+   size_t charsToWrite = smin(responseLength - currentPosition, nMax - 1);
+   memcpy(pOut, &(response.data()[currentPosition]), charsToWrite);
+   pOut[charsToWrite] = '\0';
+   currentPosition    += charsToWrite;
+   // Need to cast to prevent compiler warnings
+   int charsWritten = static_cast<int>(charsToWrite + 1);
+   // (Check cast was safe)
+   wxASSERT(static_cast<size_t>(charsWritten) == charsToWrite + 1);
+   return charsWritten;
 }
 
 } // End extern "C"
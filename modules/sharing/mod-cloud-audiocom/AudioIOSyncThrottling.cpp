@@ -0,0 +1,60 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AudioIOSyncThrottling.cpp
+
+**********************************************************************/
+
+#include "AppEvents.h"
+#include "AudioIO.h"
+#include "Observer.h"
+
+#include "sync/SyncThrottling.h"
+
+namespace audacity::cloud::audiocom::sync
+{
+namespace
+{
+//! Slows down the sync while audio is played or recorded
+class AudioIOSyncThrottling final
+{
+public:
+   AudioIOSyncThrottling()
+   {
+      AppEvents::OnAppInitialized([this] { OnAppInitialized(); });
+      AppEvents::OnAppClosing([this] { mAudioIOSubscription.Reset(); });
+   }
+
+private:
+   void OnAppInitialized()
+   {
+      auto audioIO = AudioIO::Get();
+
+      if (!audioIO)
+         return;
+
+      mAudioIOSubscription = audioIO->Subscribe(
+         [this](const AudioIOEvent& event)
+         {
+            if (event.type == AudioIOEvent::PLAYBACK)
+               mPlaying = event.on;
+            else if (event.type == AudioIOEvent::CAPTURE)
+               mCapturing = event.on;
+            else
+               return;
+
+            SetAudioIOActive(mPlaying || mCapturing);
+         });
+   }
+
+   Observer::Subscription mAudioIOSubscription;
+
+   bool mPlaying { false };
+   bool mCapturing { false };
+}; // class AudioIOSyncThrottling
+
+AudioIOSyncThrottling audioIOSyncThrottling;
+} // namespace
+} // namespace audacity::cloud::audiocom::sync
@@ -54,6 +54,7 @@ public:
 
       CloudProjectsSavePath.Invalidate();
       DaysToKeepFiles.Invalidate();
+      UploadSpeedLimitWhileAudioIOActive.Invalidate();
 
       // Enum settings are not cacheable, so we need to invalidate them
       // sync::SaveLocationMode.Invalidate();
@@ -171,6 +172,21 @@ public:
             S.EndMultiColumn();
          }
          S.EndStatic();
+
+         S.StartStatic(XO("Sync during playback and recording"));
+         {
+            S.SetBorder(8);
+            S.StartMultiColumn(3);
+            {
+               S.NameSuffix(XO("kilobytes per second"))
+                  .TieIntegerTextBox(
+                     XXO("&Limit uploads to:"),
+                     UploadSpeedLimitWhileAudioIOActive, 10);
+               S.AddFixedText(XO("KB/s (0 for no limit)"), true);
+            }
+            S.EndMultiColumn();
+         }
+         S.EndStatic();
       }
       S.EndScroller();
    }
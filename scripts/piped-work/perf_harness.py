@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""Replay a recorded workload in Audacity and report its performance as JSON.
+
+Make sure Audacity is running first and that mod-script-pipe is enabled
+before running this script.  Use the same build options and preferences
+for each of the versions to be compared.
+
+    usage: perf_harness.py [-h] [-p PROJECT] [-o OUTPUT] [-l LABEL] commands
+
+The commands file has one scripting command per line, as for pipeclient.py.
+Blank lines and lines beginning with '#' are ignored.  In each command,
+{project} is replaced with the path of the reference project and {output}
+with the output directory.  The step
+
+    Sleep: Seconds=5
+
+is not sent to Audacity but waits, for instance to play for five seconds:
+
+    OpenProject2: Filename="{project}"
+    Play:
+    Sleep: Seconds=5
+    Stop:
+    SelectAll:
+    Normalize:
+    Export2: Filename="{output}/out.wav" NumChannels=2
+    Undo:
+    Redo:
+    SaveProject2: Filename="{output}/copy.aup3"
+
+After the last command, the counters of GetInfo: Type=Performance are
+added.  The report keeps the same keys from version to version; a new key
+increments "format".  Times are in seconds, of the wall clock, from
+sending a command until the end of its reply.
+
+Requires Python 3.
+
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+
+# The version of the layout of the report
+FORMAT = 1
+
+if sys.platform == 'win32':
+    TONAME = '\\\\.\\pipe\\ToSrvPipe'
+    FROMNAME = '\\\\.\\pipe\\FromSrvPipe'
+    EOL = '\r\n\0'
+else:
+    TONAME = '/tmp/audacity_script_pipe.to.' + str(os.getuid())
+    FROMNAME = '/tmp/audacity_script_pipe.from.' + str(os.getuid())
+    EOL = '\n'
+
+
+class Pipe():
+    """Synchronous connection to mod-script-pipe."""
+
+    def __init__(self):
+        for name in (TONAME, FROMNAME):
+            if not os.path.exists(name):
+                sys.exit('perf_harness: "' + name + '" does not exist.  '
+                         'Ensure Audacity is running with mod-script-pipe.')
+        self.tofile = open(TONAME, 'w')
+        self.fromfile = open(FROMNAME, 'rt')
+
+    def do_command(self, command):
+        """Send one command, and return its reply, without the last line,
+        and whether it succeeded."""
+        self.tofile.write(command + EOL)
+        self.tofile.flush()
+        lines = []
+        while True:
+            line = self.fromfile.readline()
+            if line == '':
+                sys.exit('perf_harness: Read-pipe error.')
+            if line == '\n' and lines:
+                break
+            lines.append(line)
+        status = lines.pop().strip() if lines else ''
+        return ''.join(lines), status.endswith('OK')
+
+
+def read_steps(path, project, output):
+    """Return the commands of the file, with the paths substituted."""
+    steps = []
+    with open(path, 'rt') as commands:
+        for line in commands:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            steps.append(line.replace('{project}', project)
+                         .replace('{output}', output))
+    return steps
+
+
+def sleep_seconds(step):
+    """Return the duration of a Sleep step, or None for other steps."""
+    name, _, params = step.partition(':')
+    if name.strip() != 'Sleep':
+        return None
+    for param in params.split():
+        key, _, value = param.partition('=')
+        if key == 'Seconds':
+            return float(value)
+    return 0.0
+
+
+def run(pipe, steps):
+    """Do the steps, and return the report of each."""
+    results = []
+    for step in steps:
+        start = time.perf_counter()
+        seconds = sleep_seconds(step)
+        if seconds is None:
+            _, ok = pipe.do_command(step)
+        else:
+            time.sleep(seconds)
+            ok = True
+        elapsed = time.perf_counter() - start
+        results.append({'command': step, 'seconds': round(elapsed, 6),
+                        'ok': ok})
+        print('{0:10.3f}s {1} {2}'.format(
+            elapsed, 'ok    ' if ok else 'FAILED', step), file=sys.stderr)
+    return results
+
+
+def main():
+    """Replay the workload and write the report."""
+    parser = argparse.ArgumentParser()
+    parser.add_argument('commands',
+                        help='file of commands, one on each line')
+    parser.add_argument('-p', '--project', default='',
+                        help='reference .aup3 project, for {project}')
+    parser.add_argument('-o', '--output', default='.',
+                        help='directory for exports and saves, for {output} '
+                        '(default: .)')
+    parser.add_argument('-l', '--label', default='',
+                        help='name of the version under test, as reported')
+    parser.add_argument('-r', '--report', default='',
+                        help='file for the JSON report (default: stdout)')
+    args = parser.parse_args()
+
+    steps = read_steps(args.commands, os.path.abspath(args.project),
+                       os.path.abspath(args.output))
+    pipe = Pipe()
+    start = time.perf_counter()
+    results = run(pipe, steps)
+    total = time.perf_counter() - start
+
+    reply, ok = pipe.do_command('GetInfo: Type=Performance Format=JSON')
+    counters = json.loads(reply) if ok else {}
+
+    report = {
+        'format': FORMAT,
+        'label': args.label,
+        'commands': os.path.basename(args.commands),
+        'project': os.path.basename(args.project),
+        'steps': results,
+        'totalSeconds': round(total, 6),
+        'failures': sum(1 for result in results if not result['ok']),
+        'counters': counters,
+    }
+    text = json.dumps(report, indent=2, sort_keys=True)
+    if args.report:
+        with open(args.report, 'w') as out:
+            out.write(text + '\n')
+    else:
+        print(text)
+
+
+if __name__ == '__main__':
+    main()
@@ -43,6 +43,11 @@ It handles initialization and termination by subclassing wxApp.
 #include <wx/file.h>
 #include <wx/filename.h>
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
 #ifdef __WXGTK__
 #include <unistd.h>
 #ifdef HAVE_GTK
@@ -68,10 +73,12 @@ It handles initialization and termination by subclassing wxApp.
 #include "AColor.h"
 #include "AudacityFileConfig.h"
 #include "AudioIO.h"
+#include "BatchCommands.h"
 #include "Benchmark.h"
 #include "Clipboard.h"
 #include "CommandLineArgs.h"
 #include "CrashReport.h" // for HAS_CRASH_REPORT
+#include "DeviceManager.h"
 #include "commands/CommandHandler.h"
 #include "commands/AppCommandEvent.h"
 #include "widgets/ASlider.h"
@@ -93,6 +100,7 @@ It handles initialization and termination by subclassing wxApp.
 #include "ProjectWindows.h"
 #include "Sequence.h"
 #include "SelectFile.h"
+#include "SelectUtilities.h"
 #include "TempDirectory.h"
 #include "LoadThemeResources.h"
 #include "Track.h"
@@ -201,6 +209,78 @@ static void wxOnAssert(const wxChar *fileName, int lineNumber, const wxChar *msg
 
 namespace {
 
+//! Records how long each phase of the startup takes, when the
+//! AUDACITY_STARTUP_TRACE environment variable names a file to write that to.
+//! The file is in the Trace Event format, that chrome://tracing and
+//! https://ui.perfetto.dev display.
+class StartupTrace final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+
+   static StartupTrace &Get()
+   {
+      static StartupTrace trace;
+      return trace;
+   }
+
+   //! Ends the phase that began where the previous one ended
+   void EndPhase(const char *name)
+   {
+      if (!mPath)
+         return;
+      const auto now = Clock::now();
+      mPhases.push_back({ name, mPhaseStart, now });
+      mPhaseStart = now;
+   }
+
+   void Write() const
+   {
+      if (!mPath || mPhases.empty())
+         return;
+      const auto file = fopen(mPath, "w");
+      if (!file)
+         return;
+      const auto us = [this](Clock::time_point time) {
+         return static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+               time - mStart).count());
+      };
+      fprintf(file, "{\"traceEvents\":[\n");
+      for (size_t ii = 0; ii < mPhases.size(); ++ii) {
+         const auto &phase = mPhases[ii];
+         fprintf(file,
+            "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,"
+            "\"pid\":1,\"tid\":1}%s\n",
+            phase.name, us(phase.start), us(phase.end) - us(phase.start),
+            ii + 1 < mPhases.size() ? "," : "");
+      }
+      fprintf(file, "]}\n");
+      fclose(file);
+   }
+
+private:
+   StartupTrace()
+      : mPath{ getenv("AUDACITY_STARTUP_TRACE") }
+   {
+   }
+
+   struct Phase {
+      const char *name;
+      Clock::time_point start;
+      Clock::time_point end;
+   };
+
+   const char *const mPath;
+   // As early as static initialization allows
+   const Clock::time_point mStart{ Clock::now() };
+   Clock::time_point mPhaseStart{ mStart };
+   std::vector<Phase> mPhases;
+};
+
+// Starts the clock
+const auto &sStartupTrace = StartupTrace::Get();
+
 void PopulatePreferences()
 {
    bool resetPrefs = false;
@@ -507,6 +587,8 @@ void InitCrashreports()
 
 static bool gInited = false;
 static bool gIsQuitting = false;
+// Set when a macro given on the command line failed on some file
+static bool gMacroFailed = false;
 
 //Config instance that is set as current instance of `wxConfigBase`
 //and used to initialize `SettingsWX` objects created by
@@ -1367,6 +1449,7 @@ bool AudacityApp::OnInit()
    OnInit0();
 
    FileNames::InitializePathList();
+   StartupTrace::Get().EndPhase("Toolkit");
 
    // Define languages for which we have translations, but that are not yet
    // supported by wxWidgets.
@@ -1385,6 +1468,7 @@ bool AudacityApp::OnInit()
       InitPreferences(audacity::ApplicationSettings::Call());
       PopulatePreferences();
    }
+   StartupTrace::Get().EndPhase("Preferences");
 
    mThemeChangeSubscription = theTheme.Subscribe(OnThemeChange);
 
@@ -1395,6 +1479,7 @@ bool AudacityApp::OnInit()
 
    // AColor depends on theTheme.
    AColor::Init();
+   StartupTrace::Get().EndPhase("Theme");
 
    // If this fails, we must exit the program.
    if (!InitTempDir()) {
@@ -1403,6 +1488,7 @@ bool AudacityApp::OnInit()
    }
 
    ThemeResources::Load();
+   StartupTrace::Get().EndPhase("Temporary directory and theme resources");
 
 #ifdef __WXMAC__
    // Bug2437:  When files are opened from Finder and another instance of
@@ -1429,6 +1515,56 @@ bool AudacityApp::OnInit()
 #endif
 }
 
+namespace
+{
+//! Applies a macro to each file in turn, in the empty project, as
+//! Apply Macro to Files does, reporting the failures on the console
+//! @return whether the macro succeeded on all the files
+bool ApplyMacroToFiles(
+   AudacityProject& project, const wxString& macroName,
+   const wxArrayString& files)
+{
+   if (MacroCommands::GetNames().Index(macroName) == wxNOT_FOUND)
+   {
+      wxPrintf(_("No macro named \"%s\"\n"), macroName);
+      return false;
+   }
+
+   MacroCommands macroCommands { project };
+   macroCommands.ReadMacro(macroName);
+   const MacroCommandsCatalog catalog { &project };
+
+   auto& globalClipboard = Clipboard::Get();
+   // Move global clipboard contents aside temporarily
+   Clipboard::Scope scope;
+
+   bool success = true;
+   for (const auto& file : files)
+   {
+      const auto fileSuccess = GuardedCall<bool>([&] {
+         ProjectFileManager::Get(project).Import(file);
+         Viewport::Get(project).ZoomFitHorizontallyAndShowTrack(nullptr);
+         SelectUtilities::DoSelectAll(project);
+         return macroCommands.ApplyMacro(catalog);
+      });
+
+      // Ensure project is completely reset, and the clipboard too, so that
+      // sample block ids can be reused safely in the next pass (Bug2567)
+      ProjectManager::Get(project).ResetProjectToEmpty();
+      globalClipboard.Clear();
+
+      // Unlike in the dialog, one failure doesn't stop the others
+      if (!fileSuccess)
+      {
+         wxPrintf(_("Failed to apply macro \"%s\" to %s\n"), macroName, file);
+         success = false;
+      }
+   }
+
+   return success;
+}
+} // namespace
+
 bool AudacityApp::InitPart2()
 {
 #if defined(__WXMAC__)
@@ -1454,8 +1590,11 @@ bool AudacityApp::InitPart2()
    // Initialize the CommandHandler
    InitCommandHandler();
 
+   StartupTrace::Get().EndPhase("Single instance check and command handler");
+
    // Initialize the ModuleManager, including loading found modules
    ModuleManager::Get().Initialize();
+   StartupTrace::Get().EndPhase("Modules");
 
    // Initialize the PluginManager
    PluginManager::Get().Initialize( [](const FilePath &localFileName){
@@ -1463,6 +1602,7 @@ bool AudacityApp::InitPart2()
          AudacityFileConfig::Create({}, {}, localFileName)
       );
    });
+   StartupTrace::Get().EndPhase("Plug-in registry");
 
    // Parse command line and handle options that might require
    // immediate exit...no need to initialize all of the audio
@@ -1477,8 +1617,12 @@ bool AudacityApp::InitPart2()
    wxString journalFileName;
    const bool playingJournal = parser->Found("j", &journalFileName);
 
+   // No dialog is to interrupt a macro run from the command line
+   wxString macroName;
+   const bool applyingMacro = parser->Found("m", &macroName);
+
 #if defined(__WXMSW__) && !defined(__WXUNIVERSAL__) && !defined(__CYGWIN__)
-   if (!playingJournal)
+   if (!playingJournal && !applyingMacro)
       this->AssociateFileTypes();
 #endif
 
@@ -1548,12 +1692,17 @@ bool AudacityApp::InitPart2()
       //wxEventLoopBase::GetActive()->YieldFor(wxEVT_CATEGORY_UI|wxEVT_CATEGORY_USER_INPUT|wxEVT_CATEGORY_UNKNOWN);
       wxEventLoopBase::GetActive()->YieldFor(wxEVT_CATEGORY_UI);
 
+      StartupTrace::Get().EndPhase("Splash screen");
+
       //JKC: Would like to put module loading here.
 
       // More initialization
 
       InitDitherers();
       AudioIO::Init();
+      // Probe the devices while the rest of the startup goes on
+      DeviceManager::Instance()->StartScan();
+      StartupTrace::Get().EndPhase("Audio devices");
 
 #ifdef __WXMAC__
 
@@ -1587,6 +1736,7 @@ bool AudacityApp::InitPart2()
 
    //Search for the new plugins
    std::vector<wxString> failedPlugins;
+   StartupTrace::Get().EndPhase("Common menu bar");
    if(!playingJournal && !SkipEffectsScanAtStartup.Read())
    {
       auto newPlugins = PluginManager::Get().CheckPluginUpdates();
@@ -1611,11 +1761,14 @@ bool AudacityApp::InitPart2()
    // creating the project.
    // Root cause is problem with wxSplashScreen and other dialogs co-existing, that
    // seemed to arrive with wx3.
+   StartupTrace::Get().EndPhase("Plug-in updates check");
    {
       project = ProjectManager::New();
    }
+   StartupTrace::Get().EndPhase("First project window");
 
-   if (!playingJournal && ProjectSettings::Get(*project).GetShowSplashScreen())
+   if (!playingJournal && !applyingMacro &&
+       ProjectSettings::Get(*project).GetShowSplashScreen())
    {
       // This may do a check-for-updates at every start up.
       // Mainly this is to tell users of ALPHAS who don't know that they have an ALPHA.
@@ -1627,11 +1780,12 @@ bool AudacityApp::InitPart2()
    }
 
 #if defined(HAVE_UPDATES_CHECK)
-   UpdateManager::Start(playingJournal);
+   UpdateManager::Start(playingJournal || applyingMacro);
 #endif
 
    Importer::Get().Initialize();
    ExportPluginRegistry::Get().Initialize();
+   StartupTrace::Get().EndPhase("Importers and exporters");
 
    // Bug1561: delay the recovery dialog, to avoid crashes.
    CallAfter( [=] () mutable {
@@ -1647,7 +1801,7 @@ bool AudacityApp::InitPart2()
       //
       bool didRecoverAnything = false;
       // This call may reassign project (passed by reference)
-      if (!playingJournal)
+      if (!playingJournal && !applyingMacro)
       {
          if (!ShowAutoRecoveryDialogIfNeeded(project, &didRecoverAnything))
          {
@@ -1666,6 +1820,18 @@ bool AudacityApp::InitPart2()
             QuitAudacity(true);
          }
 
+         if (applyingMacro)
+         {
+            wxArrayString files;
+            for (size_t i = 0, cnt = parser->GetParamCount(); i < cnt; i++)
+               files.push_back(parser->GetParam(i));
+            files.Sort();
+
+            gMacroFailed = !ApplyMacroToFiles(*project, macroName, files);
+            QuitAudacity(true);
+            return;
+         }
+
          for (size_t i = 0, cnt = parser->GetParamCount(); i < cnt; i++)
          {
             // PRL: Catch any exceptions, don't try this file again, continue to
@@ -1753,6 +1919,8 @@ bool AudacityApp::InitPart2()
 #endif
 
    HandleAppInitialized();
+   StartupTrace::Get().EndPhase("Application initialized handlers");
+   StartupTrace::Get().Write();
 
    return TRUE;
 }
@@ -1764,6 +1932,8 @@ int AudacityApp::OnRun()
    if (result == 0)
       // If not otherwise abnormal, report any journal sync failure
       result = Journal::GetExitCode();
+   if (result == 0 && gMacroFailed)
+      result = 1;
    return result;
 }
 
@@ -2393,6 +2563,11 @@ std::unique_ptr<wxCmdLineParser> AudacityApp::ParseCommandLine()
    /*i18n-hint: This displays the Audacity version */
    parser->AddSwitch(wxT("v"), wxT("version"), _("display Audacity version"));
 
+   /*i18n-hint: This applies a macro, given by its name, to each of the
+    *           files given on the command line, then quits */
+   parser->AddOption(wxT("m"), wxT("macro"),
+                     _("apply a macro to each file given, then quit"));
+
    /*i18n-hint: This is a list of one or more files that Audacity
     *           should open upon startup */
    parser->AddParam(_("audio or project file name"),
@@ -2756,10 +2931,12 @@ static audacity::ApplicationSettings::Scope applicationSettingsScope {
       static std::once_flag configSetupFlag;
       std::call_once(configSetupFlag, [&]{
          const auto configFileName = wxFileName { FileNames::Configuration() };
-         gConfig = AudacityFileConfig::Create(
+         auto config = AudacityFileConfig::Create(
             wxTheApp->GetAppName(), wxEmptyString,
             configFileName.GetFullPath(),
             wxEmptyString, wxCONFIG_USE_LOCAL_FILE);
+         config->EnableDeferredFlush();
+         gConfig = std::move(config);
          wxConfigBase::Set(gConfig.get());
       });
       return std::make_unique<SettingsWX>(gConfig);
@@ -11,6 +11,7 @@ Paul Licameli split from Prefs.cpp
 
 #include "AudacityFileConfig.h"
 
+#include "BasicUI.h"
 #include "HelpSystem.h"
 #include "wxPanelWrapper.h"
 #include "ShuttleGui.h"
@@ -82,6 +83,8 @@ void AudacityFileConfig::Init()
 
 AudacityFileConfig::~AudacityFileConfig()
 {
+   if (mDeferFlush)
+      DoFlush();
    wxASSERT(mDirty == false);
 }
 
@@ -102,8 +105,33 @@ std::unique_ptr<AudacityFileConfig> AudacityFileConfig::Create(
    return result;
 }
 
+void AudacityFileConfig::EnableDeferredFlush()
+{
+   mDeferFlush = true;
+}
+
 bool AudacityFileConfig::Flush(bool bCurrentOnly)
 {
+   if (!mDeferFlush)
+   {
+      return DoFlush();
+   }
+
+   if (mDirty && !mFlushPending)
+   {
+      mFlushPending = true;
+      BasicUI::CallAfter([this, alive = std::weak_ptr<bool>{ mAlive }]
+      {
+         if (alive.lock())
+            DoFlush();
+      });
+   }
+   return true;
+}
+
+bool AudacityFileConfig::DoFlush()
+{
+   mFlushPending = false;
    if (!mDirty)
    {
       return true;
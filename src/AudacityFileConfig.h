@@ -29,6 +29,11 @@ public:
       const wxMBConv& conv = wxConvAuto()
    );
 
+   //! Makes Flush() write the file only at the next idle time, so that the
+   //! many flushes of one event handler, such as the OK of a dialog, write it
+   //! only once; the destructor writes what is still pending
+   void EnableDeferredFlush();
+
    bool Flush(bool bCurrentOnly) override;
 
    ~AudacityFileConfig() override;
@@ -59,9 +64,14 @@ private:
 
    void Init();
    void Warn() const;
+   bool DoFlush();
 
    //wxFileConfig already has m_isDirty flag, but it's inaccessible
    bool mDirty{false};
+   bool mDeferFlush{false};
+   bool mFlushPending{false};
+   //! Tells a pending flush whether this still exists
+   std::shared_ptr<bool> mAlive{ std::make_shared<bool>(true) };
    const wxString mLocalFilename;
 };
 #endif
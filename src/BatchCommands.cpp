@@ -18,6 +18,8 @@ processing.  See also MacrosWindow and ApplyMacroDialog.
 
 #include "BatchCommands.h"
 
+#include <optional>
+
 #include <wx/defs.h>
 #include <wx/datetime.h>
 #include <wx/dir.h>
@@ -623,6 +625,8 @@ bool MacroCommands::ApplyMacro(
 
    AudacityProject *proj = &mProject;
    bool res = false;
+   // Coalesces the states the commands push, also without autosaving each
+   std::optional<ProjectHistory::BatchScope> batch;
 
    // Only perform this group on initial entry.  They should not be done
    // while recursing.
@@ -649,6 +653,7 @@ bool MacroCommands::ApplyMacro(
       // previous state in history.  See Bug 2076
       if (proj) {
          ProjectHistory::Get(*proj).PushState(longDesc, shortDesc);
+         batch.emplace(*proj);
       }
    }
 
@@ -726,6 +731,8 @@ bool MacroCommands::ApplyMacro(
    if (MacroReentryCount == 1) {
       mFileName.Empty();
 
+      // Autosave once, for all of the commands
+      batch.reset();
       if (proj)
          ProjectHistory::Get(*proj).ModifyState(true);
    }
@@ -30,8 +30,11 @@
 
 #include "CellularPanel.h"
 
+#include <string>
+#include <typeinfo>
 #include <wx/eventfilter.h>
 #include <wx/setup.h> // for wxUSE_* macros
+#include "FrameStatistics.h"
 #include "KeyboardCapture.h"
 #include "UIHandle.h"
 #include "TrackPanelMouseEvent.h"
@@ -1234,18 +1237,32 @@ std::shared_ptr<TrackPanelCell> CellularPanel::LastCell() const
 }
 
 void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
+{
+   Draw( context, nPasses, GetClientRect() );
+}
+
+void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses,
+   const wxRect &area )
 {
    const auto panelRect = GetClientRect();
+   const auto drawnRect = area.Intersect( panelRect );
    auto lastCell = LastCell();
    for ( unsigned iPass = 0; iPass < nPasses; ++iPass ) {
+      auto passStopwatch = FrameStatistics::CreateStopwatch(
+         FrameStatistics::SectionID::CellularPanelPass,
+         [iPass]{ return "Pass " + std::to_string(iPass); } );
 
       VisitPostorder( [&]( const wxRect &rect, TrackPanelNode &node ) {
 
          // Draw the node
          const auto newRect = node.DrawingArea(
             context, rect, panelRect, iPass );
-         if ( newRect.Intersects( panelRect ) )
+         if ( newRect.Intersects( drawnRect ) ) {
+            auto nodeStopwatch = FrameStatistics::CreateStopwatch(
+               FrameStatistics::SectionID::CellularPanelNode,
+               [&node]{ return std::string{ typeid(node).name() }; } );
             node.Draw( context, newRect, iPass );
+         }
 
          // Draw the current handle if it is associated with the node
          if ( &node == lastCell.get() ) {
@@ -1253,7 +1270,7 @@ void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
             if ( target ) {
                const auto targetRect =
                   target->DrawingArea( context, rect, panelRect, iPass );
-               if ( targetRect.Intersects( panelRect ) )
+               if ( targetRect.Intersects( drawnRect ) )
                   target->Draw( context, targetRect, iPass );
             }
          }
@@ -115,6 +115,10 @@ public:
    // and of all groups of cells,
    // repeatedly with a pass count from 0 to nPasses - 1
    void Draw( TrackPanelDrawingContext &context, unsigned nPasses );
+   // Like the above, but only for what intersects the given part of the
+   // panel, so that a redraw of it, clipped by the caller, costs less
+   void Draw( TrackPanelDrawingContext &context, unsigned nPasses,
+      const wxRect &area );
    
 protected:
    bool HasEscape();
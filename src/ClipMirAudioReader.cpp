@@ -9,9 +9,15 @@
 
 **********************************************************************/
 #include "ClipMirAudioReader.h"
+#include "BasicUI.h"
 #include "ClipInterface.h"
+#include "MemoryX.h"
+#include "MusicInformationRetrieval.h"
+#include "UserException.h"
 #include "WaveClip.h"
+#include "concurrency/TaskScheduler.h"
 
+#include <atomic>
 #include <cassert>
 
 ClipMirAudioReader::ClipMirAudioReader(
@@ -24,6 +30,16 @@ ClipMirAudioReader::ClipMirAudioReader(
 {
 }
 
+ClipMirAudioReader::ClipMirAudioReader(
+   std::optional<LibFileFormats::AcidizerTags> tags, std::string filename,
+   WaveTrack::IntervalHolder clip)
+    : tags { std::move(tags) }
+    , filename { std::move(filename) }
+    , clip { clip }
+    , mClip { std::move(clip) }
+{
+}
+
 double ClipMirAudioReader::GetSampleRate() const
 {
    return mClip->GetRate();
@@ -57,3 +73,66 @@ void ClipMirAudioReader::AddChannel(
    cache->AddTo(buffer, len);
    mUseFirst[iChannel] = !mUseFirst[iChannel];
 }
+
+std::vector<std::optional<MIR::ProjectSyncInfo>> GetSyncInfosInParallel(
+   const std::vector<std::shared_ptr<ClipMirAudioReader>>& readers,
+   const TranslatableString& message, double projectTempo,
+   bool projectWasEmpty, bool viewIsBeatsAndMeasures)
+{
+   using namespace BasicUI;
+   using namespace audacity::concurrency;
+   auto progress = MakeProgress(
+      XO("Music Information Retrieval"), message, ProgressShowCancel);
+
+   // The clips are independent, so analyze them in parallel, keeping results
+   // in the order of the readers; the workers only record their progress,
+   // which this thread reports
+   const auto nReaders = readers.size();
+   std::vector<std::optional<MIR::ProjectSyncInfo>> syncInfos(nReaders);
+   std::vector<std::atomic<double>> fractions(nReaders);
+   for (auto& fraction : fractions)
+      fraction = 0.0;
+   std::atomic<bool> cancelled { false };
+   {
+      TaskGroup group;
+      bool finished = false;
+      // If this thread throws, stop the workers, before the group waits
+      auto cleanup = finally([&] {
+         if (!finished)
+            cancelled = true;
+      });
+      for (size_t ii = 0; ii < nReaders; ++ii)
+         group.Run([&, ii] {
+            const auto& reader = readers[ii];
+            const auto recordProgress = [&](double progressFraction) {
+               if (cancelled)
+                  throw UserException {};
+               fractions[ii] = progressFraction;
+            };
+            const MIR::ProjectSyncInfoInput input {
+               *reader,      reader->filename, reader->tags,
+               recordProgress, projectTempo, projectWasEmpty,
+               viewIsBeatsAndMeasures,
+            };
+            // Not assigned, as ProjectSyncInfo has const members
+            if (const auto syncInfo = MIR::GetProjectSyncInfo(input))
+               syncInfos[ii].emplace(*syncInfo);
+            fractions[ii] = 1.0;
+         });
+      group.WaitPolling([&] {
+         if (cancelled)
+            return;
+         double done = 0;
+         for (const auto& fraction : fractions)
+            done += fraction;
+         if (
+            progress->Poll(done / nReaders * 1000, 1000) !=
+            ProgressResult::Success)
+            cancelled = true;
+      });
+      finished = true;
+   }
+   if (cancelled)
+      throw UserException {};
+   return syncInfos;
+}
@@ -16,9 +16,12 @@
 #include "WaveTrack.h"
 
 #include <array>
+#include <memory>
 #include <optional>
+#include <vector>
 
 class ClipInterface;
+class TranslatableString;
 
 class ClipMirAudioReader : public MIR::MirAudioReader
 {
@@ -27,6 +30,11 @@ public:
       std::optional<LibFileFormats::AcidizerTags> tags, std::string filename,
       WaveTrack& singleClipWaveTrack);
 
+   //! Reads any one clip of a track
+   ClipMirAudioReader(
+      std::optional<LibFileFormats::AcidizerTags> tags, std::string filename,
+      WaveTrack::IntervalHolder clip);
+
    const std::optional<LibFileFormats::AcidizerTags> tags;
    const std::string filename;
    const WaveTrack::IntervalHolder clip;
@@ -54,3 +62,15 @@ private:
    mutable std::array<ChannelCache, 2> mCache;
    mutable std::array<bool, 2> mUseFirst { true, true };
 };
+
+/*!
+ * @brief Gets the sync info of each reader, analyzing them in parallel while a
+ * progress dialog with `message` is shown
+ *
+ * @return the sync infos in the order of `readers`
+ * @throws UserException if the user cancels
+ */
+std::vector<std::optional<MIR::ProjectSyncInfo>> GetSyncInfosInParallel(
+   const std::vector<std::shared_ptr<ClipMirAudioReader>>& readers,
+   const TranslatableString& message, double projectTempo,
+   bool projectWasEmpty, bool viewIsBeatsAndMeasures);
@@ -23,6 +23,12 @@ class TrackList;
 //! Message is sent during idle time by the global clipboard
 struct ClipboardChangeMessage {};
 
+//! Holds tracks cut or copied from a project
+/*!
+ The tracks share the sample blocks, and the arrays of them, with the project
+ they come from, so a copy costs little memory or time however long it is.
+ Samples are copied only when pasted into another project.
+ */
 class AUDACITY_DLL_API Clipboard final
    : public Observer::Publisher<ClipboardChangeMessage>
 {
@@ -31,8 +31,8 @@ void DefaultPlaybackPolicy::Initialize(
 {
    PlaybackPolicy::Initialize(schedule, rate);
    mLastPlaySpeed = GetPlaySpeed();
-   mMessageChannel.Write( { mLastPlaySpeed,
-      schedule.mT0, mLoopEndTime, mLoopEnabled } );
+   // The audio thread is not yet running, so assign its copy directly
+   mData = { mLastPlaySpeed, schedule.mT0, mLoopEndTime, mLoopEnabled };
 
    auto callback = [this](auto&){ WriteMessage(); };
    mRegionSubscription =
@@ -177,7 +177,16 @@ bool DefaultPlaybackPolicy::RepositionPlayback(
    size_t frames, size_t available )
 {
    // This executes in the SequenceBufferExchange thread
-   auto data = mMessageChannel.Read();
+   if (auto batch = mCommands.Consume(); !batch.empty()) {
+      if (batch.speed)
+         mData.mPlaySpeed = *batch.speed;
+      if (const auto &region = batch.loopRegion) {
+         mData.mT0 = region->t0;
+         mData.mT1 = region->t1;
+         mData.mLoopEnabled = region->enabled;
+      }
+   }
+   const auto &data = mData;
 
    bool speedChange = false;
    if (mVariableSpeed) {
@@ -278,9 +287,9 @@ bool DefaultPlaybackPolicy::Looping( const PlaybackSchedule & ) const
 void DefaultPlaybackPolicy::WriteMessage()
 {
    const auto &region = ViewInfo::Get( mProject ).playRegion;
-   mMessageChannel.Write( { GetPlaySpeed(),
-      region.GetStart(), region.GetEnd(), region.Active()
-   } );
+   mCommands.Post(PlaybackCommandQueue::Speed{ GetPlaySpeed() });
+   mCommands.Post(PlaybackCommandQueue::LoopRegion{
+      region.GetStart(), region.GetEnd(), region.Active() });
 }
 
 double DefaultPlaybackPolicy::GetPlaySpeed()
@@ -10,6 +10,7 @@
 #ifndef __AUDACITY_DEFAULT_PLAYBACK_POLICY__
 #define __AUDACITY_DEFAULT_PLAYBACK_POLICY__
 
+#include "PlaybackCommandQueue.h"
 #include "PlaybackSchedule.h"
 
 //! The PlaybackPolicy used by Audacity for most playback.
@@ -57,15 +58,16 @@ private:
 
    AudacityProject &mProject;
 
-   // The main thread writes changes in response to user events, and
-   // the audio thread later reads, and changes the playback.
+   // The main thread posts changes in response to user events, and
+   // the audio thread later consumes them in a batch, and changes the playback.
+   PlaybackCommandQueue mCommands;
+   //! Latest state received by the audio thread
    struct SlotData {
       double mPlaySpeed;
       double mT0;
       double mT1;
       bool mLoopEnabled;
-   };
-   MessageBuffer<SlotData> mMessageChannel;
+   } mData{};
 
    Observer::Subscription mRegionSubscription,
       mSpeedSubscription;
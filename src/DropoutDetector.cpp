@@ -9,6 +9,8 @@ Paul Licameli split from ProjectAudioManager.cpp
 
 **********************************************************************/
 
+#include "DropoutDetector.h"
+
 #include "ClientData.h"
 #include "LabelTrack.h"
 #include "Observer.h"
@@ -25,7 +27,12 @@ struct DropoutSubscription : ClientData::Base {
    DropoutSubscription(AudacityProject &project)
    {
       mSubscription = ProjectAudioManager::Get(project).Subscribe(
-      [&project](const RecordingDropoutEvent &evt){
+      [this, &project](const RecordingDropoutEvent &evt){
+         for (auto &interval : evt.intervals) {
+            ++mStatistics.dropouts;
+            mStatistics.lostSeconds += interval.second;
+         }
+
          // Make a track with labels for recording errors
          auto &tracks = TrackList::Get( project );
 
@@ -64,6 +71,7 @@ You are saving directly to a slow external storage device\n\
       });
    }
    Observer::Subscription mSubscription;
+   DropoutDetector::Statistics mStatistics;
 };
 }
 
@@ -72,3 +80,9 @@ static AudacityProject::AttachedObjects::RegisteredFactory sKey {
       return std::make_shared<DropoutSubscription>(project);
    }
 };
+
+DropoutDetector::Statistics
+DropoutDetector::GetStatistics(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<DropoutSubscription>(sKey).mStatistics;
+}
@@ -0,0 +1,29 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file DropoutDetector.h
+@brief Counts of the recording dropouts of a project
+
+**********************************************************************/
+#ifndef __AUDACITY_DROPOUT_DETECTOR__
+#define __AUDACITY_DROPOUT_DETECTOR__
+
+#include <cstddef>
+
+class AudacityProject;
+
+namespace DropoutDetector {
+
+//! Of all recordings of the project since it opened
+struct Statistics {
+   //! Intervals of lost audio
+   size_t dropouts{ 0 };
+   double lostSeconds{ 0 };
+};
+
+Statistics GetStatistics(AudacityProject &project);
+
+}
+
+#endif
@@ -13,11 +13,18 @@
 #include "MemoryX.h"
 #include "FrameStatistics.h"
 
+#include "AudacityMessageBox.h"
+#include "FileNames.h"
+#include "SelectFile.h"
 #include "ShuttleGui.h"
 #include "wxPanelWrapper.h"
 
+#include <sstream>
 #include <string>
 
+#include <wx/button.h>
+#include <wx/checkbox.h>
+#include <wx/file.h>
 #include <wx/stattext.h>
 
 namespace
@@ -45,6 +52,44 @@ public:
             AddSection(S, FrameStatistics::SectionID::WaveBitmapCachePreprocess);
             S.AddFixedText(Verbatim("WaveBitmapCache Lookups"));
             AddSection(S, FrameStatistics::SectionID::WaveBitmapCache);
+            S.AddFixedText(Verbatim("Cellular Panel Passes"));
+            AddSection(S, FrameStatistics::SectionID::CellularPanelPass);
+            S.AddFixedText(Verbatim("Cellular Panel Nodes"));
+            AddSection(S, FrameStatistics::SectionID::CellularPanelNode);
+            S.AddFixedText(Verbatim("Spectrogram Rendering (per clip)"));
+            AddSection(S, FrameStatistics::SectionID::SpectrumView);
+            S.AddFixedText(Verbatim("GraphicsDataCache Lookups"));
+            AddSection(S, FrameStatistics::SectionID::GraphicsDataCacheLookup);
+
+            S.AddFixedText(Verbatim("Last Frame Counters"));
+            S.StartMultiColumn(2, wxEXPAND);
+            {
+               S.AddFixedText(Verbatim("Cache hits:"));
+               mCounters[size_t(FrameStatistics::CounterID::CacheHits)] =
+                  S.AddVariableText({});
+               S.AddFixedText(Verbatim("Cache misses:"));
+               mCounters[size_t(FrameStatistics::CounterID::CacheMisses)] =
+                  S.AddVariableText({});
+               S.AddFixedText(Verbatim("Samples read:"));
+               mCounters[size_t(FrameStatistics::CounterID::SamplesRead)] =
+                  S.AddVariableText({});
+            }
+            S.EndMultiColumn();
+            CountersUpdated();
+
+            S.StartHorizontalLay();
+            {
+               auto tracing = S.AddCheckBox(
+                  Verbatim("Record trace"), FrameStatistics::IsTracing());
+               tracing->Bind(
+                  wxEVT_CHECKBOX,
+                  [](wxCommandEvent& evt)
+                  { FrameStatistics::SetTracing(evt.IsChecked()); });
+
+               S.AddButton(Verbatim("Export Trace..."))
+                  ->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnExport(); });
+            }
+            S.EndHorizontalLay();
          }
          S.EndVerticalLay();
       }
@@ -56,6 +101,10 @@ public:
       mStatisticsUpdated = FrameStatistics::Subscribe(
          [this](FrameStatistics::SectionID sectionID) {
             mSections[size_t(sectionID)].Dirty = true;
+
+            // Counters are complete when the frame is
+            if (sectionID == FrameStatistics::SectionID::TrackPanel)
+               mCountersDirty = true;
          });
 
       Bind(
@@ -68,6 +117,9 @@ public:
                if (mSections[i].Dirty)
                   SectionUpdated(FrameStatistics::SectionID(i));
             }
+
+            if (mCountersDirty)
+               CountersUpdated();
          });
    }
 
@@ -130,6 +182,37 @@ private:
       section.Dirty = false;
    }
 
+   void CountersUpdated()
+   {
+      for (size_t i = 0; i < size_t(FrameStatistics::CounterID::Count); ++i)
+         mCounters[i]->SetLabel(std::to_string(
+            FrameStatistics::GetCount(FrameStatistics::CounterID(i))));
+
+      mCountersDirty = false;
+   }
+
+   void OnExport()
+   {
+      const auto fileName = SelectFile(
+         FileNames::Operation::Export, Verbatim("Export Trace as:"),
+         wxEmptyString, wxT("trace.json"), wxT("json"),
+         { { Verbatim("Chrome trace files"), { wxT("json") }, true } },
+         wxFD_SAVE | wxFD_OVERWRITE_PROMPT | wxRESIZE_BORDER, this);
+
+      if (fileName.empty())
+         return;
+
+      std::ostringstream trace;
+      FrameStatistics::WriteTrace(trace);
+      const auto json = trace.str();
+
+      wxFile file;
+      if (
+         !file.Create(fileName, true) ||
+         file.Write(json.data(), json.size()) != json.size())
+         AudacityMessageBox(Verbatim("Could not write the trace"));
+   }
+
    struct Section final
    {
       wxStaticText* Last;
@@ -143,6 +226,9 @@ private:
 
    Section mSections[size_t(FrameStatistics::SectionID::Count)];
 
+   wxStaticText* mCounters[size_t(FrameStatistics::CounterID::Count)];
+   bool mCountersDirty { true };
+
    Observer::Subscription mStatisticsUpdated;
 };
 
@@ -37,6 +37,7 @@ the mouse around.
 
 #include <wx/setup.h> // for wxUSE_* macros
 
+#include <wx/app.h>
 #include <wx/brush.h>
 #include <wx/button.h>
 #include <wx/checkbox.h>
@@ -114,6 +115,17 @@ enum {
 #define FREQ_WINDOW_WIDTH 480
 #define FREQ_WINDOW_HEIGHT 330
 
+namespace {
+// Samples of the selection read at once
+constexpr size_t PieceSize = 1 << 16;
+// How long to analyze in each idle event
+constexpr auto AnalysisSlice = std::chrono::milliseconds{ 50 };
+// How often to replot the results of an unfinished analysis
+constexpr auto ShowResultsInterval = std::chrono::milliseconds{ 250 };
+// Range of the progress gauge
+constexpr int ProgressRange = 10000;
+}
+
 static const char * ZoomIn[] = {
 "16 16 6 1",
 " 	c None",
@@ -181,6 +193,7 @@ BEGIN_EVENT_TABLE(FrequencyPlotDialog, wxDialogWrapper)
    EVT_BUTTON(wxID_HELP, FrequencyPlotDialog::OnGetURL)
    EVT_CHECKBOX(GridOnOffID, FrequencyPlotDialog::OnGridOnOff)
    EVT_COMMAND(wxID_ANY, EVT_FREQWINDOW_RECALC, FrequencyPlotDialog::OnRecalc)
+   EVT_IDLE(FrequencyPlotDialog::OnIdle)
 END_EVENT_TABLE()
 
 FrequencyPlotDialog::FrequencyPlotDialog(wxWindow * parent, wxWindowID id,
@@ -559,6 +572,7 @@ bool FrequencyPlotDialog::Show(bool show)
    if (!show)
    {
       mFreqPlot->SetCursor(*mArrowCursor);
+      StopAnalysis();
    }
 
    bool shown = IsShown();
@@ -583,83 +597,37 @@ bool FrequencyPlotDialog::Show(bool show)
 
 bool FrequencyPlotDialog::GetAudio()
 {
-   mData.reset();
+   StopAnalysis();
+   mSources.clear();
    mDataLen = 0;
 
-   int selcount = 0;
-   bool warning = false;
    for (auto track :
       TrackList::Get(*mProject).Selected<const WaveTrack>()
    ) {
       auto &selectedRegion = ViewInfo::Get(*mProject).selectedRegion;
       auto start = track->TimeToLongSamples(selectedRegion.t0());
-      if (selcount == 0) {
+      if (mSources.empty()) {
          mRate = track->GetRate();
          auto end = track->TimeToLongSamples(selectedRegion.t1());
-         auto dataLen = end - start;
-         // Permit approximately 46.60 minutes of selected samples at
-         // a sampling frequency of 48 kHz (11.65 minutes at 192 kHz).
-         auto maxDataLen = size_t(2) << 26;
-         if (dataLen > maxDataLen) {
-            warning = true;
-            mDataLen = maxDataLen;
-         }
-         else
-            mDataLen = dataLen.as_size_t();
-         mData = Floats{ mDataLen };
+         mDataLen = end - start;
       }
-      const auto nChannels = track->NChannels();
       if (track->GetRate() != mRate) {
          using namespace BasicUI;
          ShowMessageBox(
             XO("To plot the spectrum, all selected tracks must have the same sample rate."),
             MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
-         mData.reset();
-         mDataLen = 0;
-         return false;
-      }
-      Floats buffer1{ mDataLen };
-      Floats buffer2{ mDataLen };
-      float *const buffers[]{ buffer1.get(), buffer2.get() };
-      // Don't allow throw for bad reads
-      if (!track->GetFloats(
-             0, nChannels, buffers, start, mDataLen, false,
-             FillFormat::fillZero, false))
-      {
-         using namespace BasicUI;
-         ShowMessageBox(
-            XO("Audio could not be analyzed. This may be due to a stretched or pitch-shifted clip.\nTry resetting any stretched clips, or mixing and rendering the tracks before analyzing"),
-            MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
-         mData.reset();
+         mSources.clear();
          mDataLen = 0;
          return false;
       }
-      size_t iChannel = 0;
-      if (selcount == 0) {
-         // First channel -- assign into mData
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] = buffers[0][i];
-         ++iChannel;
-      }
-      // Later channels -- accumulate
-      for (; iChannel < nChannels; ++iChannel) {
-         const auto buffer = buffers[iChannel];
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] += buffer[i];
-      }
-      ++selcount;
+      // The selection is read later, in pieces, from a copy that doesn't
+      // duplicate the samples
+      mSources.push_back({ std::static_pointer_cast<const WaveTrack>(
+         track->Duplicate(Track::DuplicateOptions{}.ShallowCopyAttachments())),
+         start });
    }
 
-   if (selcount == 0)
-      return false;
-
-   if (warning) {
-      auto msg = XO(
-"Too much audio was selected. Only the first %.1f seconds of audio will be analyzed.")
-         .Format(mDataLen / mRate);
-      AudacityMessageBox( msg );
-   }
-   return true;
+   return !mSources.empty();
 }
 
 void FrequencyPlotDialog::OnSize(wxSizeEvent & WXUNUSED(event))
@@ -695,7 +663,8 @@ void FrequencyPlotDialog::DrawBackground(wxMemoryDC & dc)
 
 void FrequencyPlotDialog::DrawPlot()
 {
-   if (!mData || mDataLen < mWindowSize || mAnalyst->GetProcessedSize() == 0) {
+   if (mSources.empty() || mDataLen < mWindowSize ||
+       mAnalyst->GetProcessedSize() == 0) {
       wxMemoryDC memDC;
 
       vRuler->ruler.SetUpdater(&LinearUpdater::Instance());
@@ -913,7 +882,7 @@ void FrequencyPlotDialog::PlotPaint(wxPaintEvent & event)
 
    dc.DrawBitmap( *mBitmap, 0, 0, true );
    // Fix for Bug 1226 "Plot Spectrum freezes... if insufficient samples selected"
-   if (!mData || mDataLen < mWindowSize)
+   if (mSources.empty() || mDataLen < mWindowSize)
       return;
 
    dc.SetFont(mFreqFont);
@@ -1023,7 +992,7 @@ void FrequencyPlotDialog::OnCloseButton(wxCommandEvent & WXUNUSED(event))
    gPrefs->Write(wxT("/FrequencyPlotDialog/FuncChoice"), mFuncChoice->GetSelection());
    gPrefs->Write(wxT("/FrequencyPlotDialog/AxisChoice"), mAxisChoice->GetSelection());
    gPrefs->Flush();
-   mData.reset();
+   mSources.clear();
    Show(false);
 }
 
@@ -1035,7 +1004,8 @@ void FrequencyPlotDialog::SendRecalcEvent()
 
 void FrequencyPlotDialog::Recalc()
 {
-   if (!mData || mDataLen < mWindowSize) {
+   StopAnalysis();
+   if (mSources.empty() || mDataLen < mWindowSize) {
       DrawPlot();
       return;
    }
@@ -1044,26 +1014,106 @@ void FrequencyPlotDialog::Recalc()
       SpectrumAnalyst::Algorithm(mAlgChoice->GetSelection());
    int windowFunc = mFuncChoice->GetSelection();
 
-   wxWindow *hadFocus = FindFocus();
-   // In wxMac, the skipped window MUST be a top level window.  I'd originally made it
-   // just the mProgress window with the idea of preventing user interaction with the
-   // controls while the plot was being recalculated.  This doesn't appear to be necessary
-   // so just use the top level window instead.
-   {
-      std::optional<wxWindowDisabler> blocker;
-      if (IsShown())
-         blocker.emplace(this);
-      wxYieldIfNeeded();
-
-      mAnalyst->Calculate(alg, windowFunc, mWindowSize, mRate,
-         mData.get(), mDataLen,
-         &mYMin, &mYMax, mProgress);
+   if (!mAnalyst->Start(alg, windowFunc, mWindowSize, mRate)) {
+      DrawPlot();
+      return;
+   }
+   mAnalyzing = true;
+   mAnalyzed = 0;
+   mPiece.reinit(PieceSize);
+   mBuffer1.reinit(PieceSize);
+   mBuffer2.reinit(PieceSize);
+   mLastShown = {};
+   mProgress->SetRange(ProgressRange);
+
+   // Analyze some now, so that mAnalyst is valid when we paint; OnIdle()
+   // does the rest
+   if (ContinueAnalysis())
+      wxWakeUpIdle();
+}
+
+bool FrequencyPlotDialog::ContinueAnalysis()
+{
+   if (!mAnalyzing)
+      return false;
+
+   using namespace std::chrono;
+   const auto deadline = steady_clock::now() + AnalysisSlice;
+   while (mAnalyzed < mDataLen) {
+      const auto len = limitSampleBufferSize(PieceSize, mDataLen - mAnalyzed);
+      bool first = true;
+      for (const auto &[pTrack, start] : mSources) {
+         const auto nChannels = pTrack->NChannels();
+         float *const buffers[]{ mBuffer1.get(), mBuffer2.get() };
+         // Don't allow throw for bad reads
+         if (!pTrack->GetFloats(
+                0, nChannels, buffers, start + mAnalyzed, len, false,
+                FillFormat::fillZero, false))
+         {
+            StopAnalysis();
+            mSources.clear();
+            mDataLen = 0;
+            DrawPlot();
+            using namespace BasicUI;
+            ShowMessageBox(
+               XO("Audio could not be analyzed. This may be due to a stretched or pitch-shifted clip.\nTry resetting any stretched clips, or mixing and rendering the tracks before analyzing"),
+               MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
+            return false;
+         }
+         size_t iChannel = 0;
+         if (first) {
+            // First channel -- assign into mPiece
+            std::copy(buffers[0], buffers[0] + len, mPiece.get());
+            ++iChannel;
+            first = false;
+         }
+         // Later channels -- accumulate
+         for (; iChannel < nChannels; ++iChannel) {
+            const auto buffer = buffers[iChannel];
+            for (size_t i = 0; i < len; i++)
+               mPiece[i] += buffer[i];
+         }
+      }
+      mAnalyst->Accumulate(mPiece.get(), len);
+      mAnalyzed += len;
+      if (steady_clock::now() >= deadline)
+         break;
    }
-   if (hadFocus) {
-      hadFocus->SetFocus();
+
+   if (mAnalyzed < mDataLen) {
+      mProgress->SetValue(
+         ProgressRange * (mAnalyzed.as_double() / mDataLen.as_double()));
+      if (steady_clock::now() - mLastShown >= ShowResultsInterval)
+         ShowResults();
+      return true;
    }
 
-   if (alg == SpectrumAnalyst::Spectrum) {
+   StopAnalysis();
+   ShowResults();
+   return false;
+}
+
+void FrequencyPlotDialog::StopAnalysis()
+{
+   if (!mAnalyzing)
+      return;
+   mAnalyzing = false;
+   mPiece.reset();
+   mBuffer1.reset();
+   mBuffer2.reset();
+   // Reset for next time
+   mProgress->Reset();
+}
+
+void FrequencyPlotDialog::ShowResults()
+{
+   mLastShown = std::chrono::steady_clock::now();
+   if (!mAnalyst->Summarize(&mYMin, &mYMax)) {
+      DrawPlot();
+      return;
+   }
+
+   if (mAlgChoice->GetSelection() == SpectrumAnalyst::Spectrum) {
       if(mYMin < -dBRange)
          mYMin = -dBRange;
       if(mYMax <= -dBRange)
@@ -1078,6 +1128,13 @@ void FrequencyPlotDialog::Recalc()
    DrawPlot();
 }
 
+void FrequencyPlotDialog::OnIdle(wxIdleEvent & event)
+{
+   event.Skip();
+   if (ContinueAnalysis())
+      event.RequestMore();
+}
+
 void FrequencyPlotDialog::OnExport(wxCommandEvent & WXUNUSED(event))
 {
    wxString fName = _("spectrum.txt");
@@ -11,14 +11,18 @@
 #ifndef __AUDACITY_FREQ_WINDOW__
 #define __AUDACITY_FREQ_WINDOW__
 
+#include <chrono>
+#include <memory>
 #include <vector>
 #include <wx/font.h> // member variable
 #include <wx/statusbr.h> // to inherit
 #include "Prefs.h"
+#include "SampleCount.h"
 #include "SampleFormat.h"
 #include "SpectrumAnalyst.h"
 #include "wxPanelWrapper.h" // to inherit
 
+class wxIdleEvent;
 class wxMemoryDC;
 class wxScrollBar;
 class wxSlider;
@@ -31,6 +35,7 @@ class AudacityProject;
 class FrequencyPlotDialog;
 class FreqGauge;
 class RulerPanel;
+class WaveTrack;
 
 DECLARE_EXPORTED_EVENT_TYPE(AUDACITY_DLL_API, EVT_FREQWINDOW_RECALC, -1);
 
@@ -86,9 +91,16 @@ private:
    void OnReplot(wxCommandEvent & event);
    void OnGridOnOff(wxCommandEvent & event);
    void OnRecalc(wxCommandEvent & event);
+   void OnIdle(wxIdleEvent & event);
 
    void SendRecalcEvent();
    void Recalc();
+   //! Give mAnalyst more of the selection, for a limited time
+   //! @return whether to continue later
+   bool ContinueAnalysis();
+   void StopAnalysis();
+   //! Get results of the analysis so far and plot them
+   void ShowResults();
    void DrawPlot();
    void DrawBackground(wxMemoryDC & dc);
 
@@ -136,11 +148,29 @@ private:
    wxTextCtrl *mPeakText;
 
 
+   //! One of the selected tracks
+   struct Source {
+      //! A copy sharing sample blocks, which edits of the project don't change
+      std::shared_ptr<const WaveTrack> pTrack;
+      //! Where the selection starts
+      sampleCount start;
+   };
+
    double mRate;
-   size_t mDataLen;
-   Floats mData;
+   std::vector<Source> mSources;
+   sampleCount mDataLen;
    size_t mWindowSize;
 
+   // State of the analysis, which reads the selection in pieces when idle,
+   // so that memory does not grow with its length, and the dialog responds
+   bool mAnalyzing{ false };
+   //! How much of the selection mAnalyst was given
+   sampleCount mAnalyzed;
+   //! Sum of the channels of the tracks, for one piece
+   Floats mPiece;
+   Floats mBuffer1, mBuffer2;
+   std::chrono::steady_clock::time_point mLastShown;
+
    bool mLogAxis;
    float mYMin;
    float mYMax;
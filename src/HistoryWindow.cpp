@@ -36,7 +36,7 @@ undo memory so as to free up space.
 #include "../images/Arrow.xpm"
 #include "../images/Empty9x16.xpm"
 #include "UndoManager.h"
-#include "UndoTracks.h"
+#include "UndoSpaceUsage.h"
 #include "Project.h"
 #include "ProjectFileIO.h"
 #include "ProjectHistory.h"
@@ -71,7 +71,7 @@ struct SpaceUsageCalculator {
    SpaceArray space;
    Type clipboardSpaceUsage;
 
-   void Calculate( UndoManager &manager )
+   void Calculate( AudacityProject &project )
    {
       SampleBlockIDSet seen;
 
@@ -90,18 +90,14 @@ struct SpaceUsageCalculator {
       // contribution to space usage should be counted only in that latest
       // state.
 
-      manager.VisitStates(
-         [this, &seen](const UndoStackElem &elem) {
-            // Scan all tracks at current level
-            if (auto pTracks = UndoTracks::Find(elem))
-               space.push_back(CalculateUsage(*pTracks, seen));
-         },
-         true // newest state first
-      );
+      // The states keep account of the blocks that change between them, also
+      // when spilled into the project file
+      const auto usage = UndoSpaceUsage::Calculate(project);
+      // Newest state first
+      space.assign(usage.rbegin(), usage.rend());
 
       // Count the usage of the clipboard separately, using another set.  Do not
       // multiple-count any block occurring multiple times within the clipboard.
-      seen.clear();
       clipboardSpaceUsage = CalculateUsage(
          Clipboard::Get().GetTracks(), seen);
 
@@ -286,7 +282,7 @@ void HistoryDialog::DoUpdate()
    int i = 0;
 
    SpaceUsageCalculator calculator;
-   calculator.Calculate( *mManager );
+   calculator.Calculate( *mProject );
 
    // point to size for oldest state
    auto iter = calculator.space.rbegin();
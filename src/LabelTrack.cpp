@@ -36,7 +36,6 @@ for drawing different aspects of the label and its text box.
 #include <float.h>
 
 #include <wx/log.h>
-#include <wx/tokenzr.h>
 #include <wx/datetime.h>
 
 #include "Prefs.h"
@@ -424,16 +423,52 @@ ImportExportPrefs::RegisteredControls reg{ wxT("LabelStyle"), AddControls };
 
 }
 
-static double SubRipTimestampToDouble(const wxString &ts)
+namespace {
+//! Value of the two or three decimal digits of ts at pos, at most limit
+int SubRipField(const wxString &ts, size_t pos, size_t nDigits, int limit)
 {
-   wxString::const_iterator end;
-   wxDateTime dt;
+   int result = 0;
+   for (size_t ii = pos; ii < pos + nDigits; ++ii) {
+      const auto c = ts[ii].GetValue();
+      if (c < '0' || c > '9')
+         throw LabelStruct::BadFormatException{};
+      result = 10 * result + (c - '0');
+   }
+   if (result > limit)
+      throw LabelStruct::BadFormatException{};
+   return result;
+}
+
+//! Tokens between tabs, skipping empty ones, as wxStringTokenizer does for
+//! white space delimiters, but without its copies of the rest of the line
+class TabTokens {
+public:
+   explicit TabTokens(const wxString &line) : mLine{ line } {}
+   wxString Next()
+   {
+      const auto length = mLine.length();
+      while (mPos < length && mLine[mPos] == '\t')
+         ++mPos;
+      const auto start = mPos;
+      while (mPos < length && mLine[mPos] != '\t')
+         ++mPos;
+      return mLine.substr(start, mPos - start);
+   }
+private:
+   const wxString &mLine;
+   size_t mPos{ 0 };
+};
+}
 
-   if (!dt.ParseFormat(ts, wxT("%H:%M:%S,%l"), &end) || end != ts.end())
+// Parsing data of the form 'HH:MM:SS,sss', less than 24 hours
+static double SubRipTimestampToDouble(const wxString &ts)
+{
+   if (ts.length() != 12 ||
+       ts[2] != ':' || ts[5] != ':' || ts[8] != ',')
       throw LabelStruct::BadFormatException{};
 
-   return dt.GetHour() * 3600 + dt.GetMinute() * 60 + dt.GetSecond()
-      + dt.GetMillisecond() / 1000.0;
+   return SubRipField(ts, 0, 2, 23) * 3600 + SubRipField(ts, 3, 2, 59) * 60
+      + SubRipField(ts, 6, 2, 59) + SubRipField(ts, 9, 3, 999) / 1000.0;
 }
 
 LabelStruct LabelStruct::Import(wxTextFile &file, int &index, LabelFormat format)
@@ -452,23 +487,23 @@ LabelStruct LabelStruct::Import(wxTextFile &file, int &index, LabelFormat format
          // Assume tab is an impossible character within the exported text
          // of the label, so can be only a delimiter.  But other white space may
          // be part of the label text.
-         wxStringTokenizer toker { firstLine, wxT("\t") };
+         TabTokens toker{ firstLine };
 
          //get the timepoint of the left edge of the label.
-         auto token = toker.GetNextToken();
+         auto token = toker.Next();
 
          double t0;
          if (!Internat::CompatibleToDouble(token, &t0))
             throw BadFormatException{};
 
-         token = toker.GetNextToken();
+         token = toker.Next();
 
          double t1;
          if (!Internat::CompatibleToDouble(token, &t1))
             //s1 is not a number.
             t1 = t0;  //This is a one-sided label; t1 == t0.
          else
-            token = toker.GetNextToken();
+            token = toker.Next();
 
          sr.setTimes( t0, t1 );
 
@@ -491,17 +526,18 @@ LabelStruct LabelStruct::Import(wxTextFile &file, int &index, LabelFormat format
          ++index;
 
       if (index2 < index) {
-         wxStringTokenizer toker { file.GetLine(index2++), wxT("\t") };
-         auto token = toker.GetNextToken();
+         const auto &line = file.GetLine(index2++);
+         TabTokens toker{ line };
+         auto token = toker.Next();
          if (token != continuation)
             throw BadFormatException{};
 
-         token = toker.GetNextToken();
+         token = toker.Next();
          double f0;
          if (!Internat::CompatibleToDouble(token, &f0))
             throw BadFormatException{};
 
-         token = toker.GetNextToken();
+         token = toker.Next();
          double f1;
          if (!Internat::CompatibleToDouble(token, &f1))
             throw BadFormatException{};
@@ -542,7 +578,7 @@ LabelStruct LabelStruct::Import(wxTextFile &file, int &index, LabelFormat format
       // with spaces.  This is not reversed on export.
       while (index < (int)file.GetLineCount() &&
              !file.GetLine(index).IsEmpty())
-         title += " " + file.GetLine(index);
+         title += " " + file.GetLine(index++);
 
       index++; // Skip over empty line
 
@@ -563,9 +599,19 @@ static wxString SubRipTimestampFromDouble(double timestamp, bool webvtt)
    // WebVTT also allows skipping the hour part, but doesn't require doing so.
    static constexpr auto webvttFormat = wxT("%H:%M:%S.%l");
 
+   const auto seconds = (time_t) timestamp;
+   const auto milliseconds = wxRound(timestamp * 1000) % 1000;
+   if (seconds >= 0 && milliseconds >= 0) {
+      // As the time of day below, without the cost of wxDateTime
+      return wxString::Format(webvtt
+            ? wxT("%02d:%02d:%02d.%03d") : wxT("%02d:%02d:%02d,%03d"),
+         int(seconds / 3600 % 24), int(seconds / 60 % 60), int(seconds % 60),
+         milliseconds);
+   }
+
    // dt is the datetime that is timestamp seconds after Jan 1, 1970 UTC.
-   wxDateTime dt { (time_t) timestamp };
-   dt.SetMillisecond(wxRound(timestamp * 1000) % 1000);
+   wxDateTime dt { seconds };
+   dt.SetMillisecond(milliseconds);
 
    // As such, we need to use UTC when formatting it, or else the time will
    // be shifted (assuming the user is not in the UTC timezone).
@@ -573,6 +619,12 @@ static wxString SubRipTimestampFromDouble(double timestamp, bool webvtt)
 }
 
 void LabelStruct::Export(wxTextFile &file, LabelFormat format, int index) const
+{
+   Export(file, format, index, LabelStyleSetting.ReadEnum());
+}
+
+void LabelStruct::Export(wxTextFile &file, LabelFormat format, int index,
+   bool timesOnly) const
 {
    switch (format) {
    case LabelFormat::TEXT:
@@ -589,7 +641,7 @@ void LabelStruct::Export(wxTextFile &file, LabelFormat format, int index) const
    auto f1 = selectedRegion.f1();
    if ((f0 == SelectedRegion::UndefinedFrequency &&
       f1 == SelectedRegion::UndefinedFrequency) ||
-      LabelStyleSetting.ReadEnum())
+      timesOnly)
       return;
 
       // Write a \ character at the start of a second line,
@@ -696,9 +748,10 @@ void LabelTrack::Export(wxTextFile & f, LabelFormat format) const
    }
 
    // PRL: to do: export other selection fields
+   const bool timesOnly = LabelStyleSetting.ReadEnum();
    int index = 0;
    for (auto &labelStruct: mLabels)
-      labelStruct.Export(f, format, index++);
+      labelStruct.Export(f, format, index++, timesOnly);
 }
 
 LabelFormat LabelTrack::FormatForFileName(const wxString & fileName)
@@ -739,7 +792,11 @@ void LabelTrack::Import(wxTextFile & in, LabelFormat format)
    }
    if (error)
       ::AudacityMessageBox( XO("One or more saved labels could not be read.") );
-   SortLabels();
+   // One sort for all; there are no stored indices into new labels to update
+   // by permutation events, as SortLabels() would
+   std::stable_sort(mLabels.begin(), mLabels.end(),
+      [](const LabelStruct &a, const LabelStruct &b){
+         return a.getT0() < b.getT0(); });
 }
 
 bool LabelTrack::HandleXMLTag(const std::string_view& tag, const AttributesList &attrs)
@@ -908,11 +965,7 @@ Track::Holder LabelTrack::Copy(double t0, double t1, bool) const
 bool LabelTrack::PasteOver(double t, const Track &src)
 {
    auto result = src.TypeSwitch<bool>([&](const LabelTrack &sl) {
-      int len = mLabels.size();
-      int pos = 0;
-
-      while (pos < len && mLabels[pos].getT0() < t)
-         pos++;
+      int pos = LowerBound(t);
 
       for (auto &labelStruct: sl.mLabels) {
          LabelStruct l {
@@ -1095,11 +1148,7 @@ int LabelTrack::AddLabel(const SelectedRegion &selectedRegion,
 {
    LabelStruct l { selectedRegion, title };
 
-   int len = mLabels.size();
-   int pos = 0;
-
-   while (pos < len && mLabels[pos].getT0() < selectedRegion.t0())
-      pos++;
+   int pos = LowerBound(selectedRegion.t0());
 
    mLabels.insert(mLabels.begin() + pos, l);
 
@@ -1156,6 +1205,20 @@ void LabelTrack::SortLabels()
    }
 }
 
+int LabelTrack::LowerBound(double t) const
+{
+   return std::partition_point(mLabels.begin(), mLabels.end(),
+      [t](const LabelStruct &label){ return label.getT0() < t; })
+         - mLabels.begin();
+}
+
+int LabelTrack::UpperBound(double t) const
+{
+   return std::partition_point(mLabels.begin(), mLabels.end(),
+      [t](const LabelStruct &label){ return label.getT0() <= t; })
+         - mLabels.begin();
+}
+
 wxString LabelTrack::GetTextOfLabels(double t0, double t1) const
 {
    bool firstLabel = true;
@@ -1188,12 +1251,8 @@ int LabelTrack::FindNextLabel(const SelectedRegion& currentRegion)
       }
       else {
          i = 0;
-         if (currentRegion.t0() < mLabels[len - 1].getT0()) {
-            while (i < len &&
-                  mLabels[i].getT0() <= currentRegion.t0()) {
-               i++;
-            }
-         }
+         if (currentRegion.t0() < mLabels[len - 1].getT0())
+            i = UpperBound(currentRegion.t0());
       }
    }
 
@@ -1214,12 +1273,8 @@ int LabelTrack::FindNextLabel(const SelectedRegion& currentRegion)
       }
       else {
          i = len - 1;
-         if (currentRegion.t0() > mLabels[0].getT0()) {
-            while (i >=0  &&
-                  mLabels[i].getT0() >= currentRegion.t0()) {
-               i--;
-            }
-         }
+         if (currentRegion.t0() > mLabels[0].getT0())
+            i = LowerBound(currentRegion.t0()) - 1;
       }
    }
 
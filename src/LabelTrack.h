@@ -54,6 +54,10 @@ public:
    static LabelStruct Import(wxTextFile &file, int &index, LabelFormat format);
 
    void Export(wxTextFile &file, LabelFormat format, int index) const;
+   //! @param timesOnly whether to omit the line of frequencies, as
+   //! LabelStyleSetting may require; saves reading it for each label
+   void Export(wxTextFile &file, LabelFormat format, int index,
+      bool timesOnly) const;
 
    /// Relationships between selection region and labels
    enum TimeRelations
@@ -87,6 +91,7 @@ public:
    bool updated{};                  /// flag to tell if the label times were updated
 };
 
+//! Contiguous, and kept in order of start times, for binary searches
 using LabelArray = std::vector<LabelStruct>;
 
 class AUDACITY_DLL_API LabelTrack final
@@ -215,6 +220,11 @@ private:
    std::shared_ptr<WideChannelGroupInterval> DoGetInterval(size_t iInterval)
       override;
 
+   //! Index of the first label starting at or after t
+   int LowerBound(double t) const;
+   //! Index of the first label starting after t
+   int UpperBound(double t) const;
+
    LabelArray mLabels;
 
    // Set in copied label tracks
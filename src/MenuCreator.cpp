@@ -154,6 +154,8 @@ struct MenuItemVisitor final : CommandManager::Populator {
       void EnableMultiItem(bool enabled) final;
 
       wxMenu *menu{};
+      //! The item in menu, so that updates need not search for it
+      wxMenuItem *item{};
    };
 
 private:
@@ -189,7 +191,10 @@ void
 MenuItemVisitor::CommandListEntryEx::UpdateCheckmark(AudacityProject &project)
 {
    if (menu && checkmarkFn && !isOccult) {
-      menu->Check(id, checkmarkFn(project));
+      if (item)
+         item->Check(checkmarkFn(project));
+      else
+         menu->Check(id, checkmarkFn(project));
    }
 }
 
@@ -213,7 +218,10 @@ void MenuItemVisitor::CommandListEntryEx::Check(bool checked)
 {
    if (!menu || isOccult)
       return;
-   menu->Check(id, checked);
+   if (item)
+      item->Check(checked);
+   else
+      menu->Check(id, checked);
 }
 
 void MenuItemVisitor::CommandListEntryEx::Enable(bool b)
@@ -223,24 +231,32 @@ void MenuItemVisitor::CommandListEntryEx::Enable(bool b)
       return;
    }
 
+   // Finding the item by id searches the whole menu, which matters when
+   // every command is enabled or disabled, in menus of many plug-ins
+   const auto pItem = item ? item : menu->FindItem(id);
+   if (!pItem) {
+      enabled = b;
+      return;
+   }
+
    // LL:  Refresh from real state as we can get out of sync on the
    //      Mac due to its reluctance to enable menus when in a modal
    //      state.
-   enabled = menu->IsEnabled(id);
+   enabled = pItem->IsEnabled();
 
    // Only enabled if needed
    if (enabled != b) {
-      menu->Enable(id, b);
-      enabled = menu->IsEnabled(id);
+      pItem->Enable(b);
+      enabled = pItem->IsEnabled();
    }
 }
 
 void MenuItemVisitor::CommandListEntryEx::EnableMultiItem(bool b)
 {
    if (menu) {
-      const auto item = menu->FindItem(id);
-      if (item) {
-         item->Enable(b);
+      const auto pItem = item ? item : menu->FindItem(id);
+      if (pItem) {
+         pItem->Enable(b);
          return;
       }
    }
@@ -332,9 +348,10 @@ FormatLabelWithDisabledAccel(const CommandManager::CommandListEntry &entry)
 void MenuItemVisitor::VisitEntry(CommandManager::CommandListEntry &entry,
    const MenuRegistry::Options *pOptions)
 {
+   wxMenuItem *item{};
    if (!pOptions)
       // command list item
-      CurrentMenu()->Append(entry.id, entry.FormatLabelForMenu());
+      item = CurrentMenu()->Append(entry.id, entry.FormatLabelForMenu());
    else if (pOptions->global)
       ;
    else {
@@ -342,12 +359,18 @@ void MenuItemVisitor::VisitEntry(CommandManager::CommandListEntry &entry,
       auto label = FormatLabelWithDisabledAccel(entry);
       auto &checker = pOptions->checker;
       if (checker) {
-         CurrentMenu()->AppendCheckItem(ID, label);
-         CurrentMenu()->Check(ID, checker(mProject));
+         item = CurrentMenu()->AppendCheckItem(ID, label);
+         item->Check(checker(mProject));
       }
       else
-         CurrentMenu()->Append(ID, label);
+         item = CurrentMenu()->Append(ID, label);
    }
+
+   // An entry reused for another menu keeps the first item, as the search
+   // by id in its menu found
+   auto &entryEx = static_cast<CommandListEntryEx&>(entry);
+   if (!entryEx.item)
+      entryEx.item = item;
 }
 
 MenuItemVisitor::~MenuItemVisitor() = default;
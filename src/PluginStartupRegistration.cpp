@@ -10,6 +10,7 @@
 
 #include "PluginStartupRegistration.h"
 
+#include <algorithm>
 #include <thread>
 
 #include <wx/log.h>
@@ -127,18 +128,80 @@ namespace
    };
 }
 
-PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
+PluginStartupRegistration::Worker::Worker(PluginStartupRegistration& owner)
+   : mOwner(owner)
 {
-   for(auto& p : pluginsToProcess)
-      mPluginsToProcess.push_back(p);
 }
 
-void PluginStartupRegistration::OnInternalError(const wxString& error)
+void PluginStartupRegistration::Worker::Start(size_t pluginIndex)
+{
+   mPluginIndex = pluginIndex;
+   mProviderIndex = 0;
+   mValidProviderFound = false;
+   mFailedPluginsCache.clear();
+   ValidateCurrent();
+}
+
+void PluginStartupRegistration::Worker::ValidateCurrent()
+{
+   const auto& plugin = mOwner.mPluginsToProcess[*mPluginIndex];
+   if(!mValidator)
+      mValidator = std::make_unique<AsyncPluginValidator>(*this);
+
+   mValidator->Validate(plugin.second[mProviderIndex], plugin.first);
+   mRequestStartTime = std::chrono::system_clock::now();
+}
+
+bool PluginStartupRegistration::Worker::IsStalled() const noexcept
+{
+   return mValidator && mValidator->InactiveSince() < mRequestStartTime;
+}
+
+void PluginStartupRegistration::Worker::Release()
+{
+   if(!mValidator)
+      return;
+   //Drop current validator, no more callbacks will be received from now
+   mValidator->SetDelegate(nullptr);
+   //While on Linux and MacOS socket `shutdown()` wakes up `select()` almost
+   //immediately, on Windows it sometimes get delayed on unspecified amount
+   //of time. As we do not expect any data we can safely move remaining
+   //operations to another thread.
+   std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(mValidator))]{ }).detach();
+}
+
+void PluginStartupRegistration::Worker::Skip()
+{
+   if(!mPluginIndex)
+      return;
+
+   Release();
+
+   const auto& plugin = mOwner.mPluginsToProcess[*mPluginIndex];
+   if(!mValidProviderFound)
+   {
+      // Validator didn't report anything yet or it tried
+      // one or more providers that didn't recognize the plugin.
+      // In that case we assume that none of the remaining providers
+      // can recognize that plugin.
+      // Note: create stub `PluginDescriptors` for each associated provider
+      for(;mProviderIndex < plugin.second.size(); ++mProviderIndex)
+         OnPluginValidationFailed(plugin.second[mProviderIndex], plugin.first);
+      mProviderIndex = plugin.second.size() - 1;
+   }
+   //else
+   //    Don't assume that `OnValidationFinished()` and `OnPluginFound()`
+   //    aren't deferred within run loop
+
+   OnValidationFinished();
+}
+
+void PluginStartupRegistration::Worker::OnInternalError(const wxString& error)
 {
-   StopWithError(error);
+   mOwner.StopWithError(error);
 }
 
-void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
+void PluginStartupRegistration::Worker::OnPluginFound(const PluginDescriptor& desc)
 {
    if(!mValidProviderFound)
       mFailedPluginsCache.clear();
@@ -149,7 +212,7 @@ void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
    PluginManager::Get().RegisterPlugin(PluginDescriptor { desc });
 }
 
-void PluginStartupRegistration::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
+void PluginStartupRegistration::Worker::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
 {
    PluginID ID = providerId + wxT("_") + path;
    PluginDescriptor pluginDescriptor;
@@ -165,41 +228,70 @@ void PluginStartupRegistration::OnPluginValidationFailed(const wxString& provide
    mFailedPluginsCache.push_back(std::move(pluginDescriptor));
 }
 
-
-void PluginStartupRegistration::OnValidationFinished()
+void PluginStartupRegistration::Worker::OnValidationFinished()
 {
-   ++mCurrentPluginProviderIndex;
+   ++mProviderIndex;
    if(mValidProviderFound ||
-      mPluginsToProcess[mCurrentPluginIndex].second.size() == mCurrentPluginProviderIndex)
+      mOwner.mPluginsToProcess[*mPluginIndex].second.size() == mProviderIndex)
+   {
+      const auto pluginIndex = *mPluginIndex;
+      mPluginIndex.reset();
+      mOwner.OnModuleFinished(pluginIndex, mValidProviderFound, mFailedPluginsCache);
+      mValidProviderFound = false;
+      mFailedPluginsCache.clear();
+      mOwner.ProcessNext(*this);
+      return;
+   }
+   try
+   {
+      ValidateCurrent();
+   }
+   catch(std::exception& e)
+   {
+      mOwner.StopWithError(e.what());
+   }
+   catch(...)
    {
-      if(!mFailedPluginsCache.empty())
+      mOwner.StopWithError("unknown error");
+   }
+}
+
+PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
+{
+   for(auto& p : pluginsToProcess)
+      mPluginsToProcess.push_back(p);
+}
+
+PluginStartupRegistration::~PluginStartupRegistration() = default;
+
+void PluginStartupRegistration::OnModuleFinished(size_t pluginIndex,
+   bool validProviderFound, std::vector<PluginDescriptor>& failedPluginsCache)
+{
+   if(!failedPluginsCache.empty())
+   {
+      //we've tried all providers associated with same module path...
+      if(!validProviderFound)
       {
-         //we've tried all providers associated with same module path...
-         if(!mValidProviderFound)
-         {
-            //...but none of them succeeded
-            mFailedPluginsPaths.push_back(mFailedPluginsCache[0].GetPath());
+         //...but none of them succeeded
+         mFailedPluginsPaths.push_back(failedPluginsCache[0].GetPath());
 
-            //Same plugin path, but different providers, we need to register all of them
-            for(auto& desc : mFailedPluginsCache)
-               PluginManager::Get().RegisterPlugin(std::move(desc));
-         }
-         //plugin type was detected, but plugin instance validation has failed
-         else
+         //Same plugin path, but different providers, we need to register all of them
+         for(auto& desc : failedPluginsCache)
+            PluginManager::Get().RegisterPlugin(std::move(desc));
+      }
+      //plugin type was detected, but plugin instance validation has failed
+      else
+      {
+         for(auto& desc : failedPluginsCache)
          {
-            for(auto& desc : mFailedPluginsCache)
-            {
-               if(desc.GetPluginType() != PluginTypeStub)
-                  mFailedPluginsPaths.push_back(desc.GetPath());
-            }
+            if(desc.GetPluginType() != PluginTypeStub)
+               mFailedPluginsPaths.push_back(desc.GetPath());
          }
       }
-      ++mCurrentPluginIndex;
-      mCurrentPluginProviderIndex = 0;
-      mValidProviderFound = false;
-      mFailedPluginsCache.clear();
    }
-   ProcessNext();
+   //Whatever the outcome, don't probe the module again until it changes
+   PluginManager::Get().SetModuleScanned(mPluginsToProcess[pluginIndex].first);
+   ++mFinishedCount;
 }
 
 const std::vector<wxString>& PluginStartupRegistration::GetFailedPluginsPaths() const noexcept
@@ -207,12 +299,11 @@ const std::vector<wxString>& PluginStartupRegistration::GetFailedPluginsPaths()
    return mFailedPluginsPaths;
 }
 
-void PluginStartupRegistration::Run(std::chrono::seconds timeout)
+void PluginStartupRegistration::Run(std::chrono::seconds timeout, unsigned concurrency)
 {
    PluginScanDialog dialog(nullptr, wxID_ANY, XO("Searching for plugins"));
    wxTimer timeoutTimer(&dialog, OnPluginScanTimeout);
    mScanDialog = &dialog;
-   mTimeoutTimer = &timeoutTimer;
    mTimeout = timeout;
 
    dialog.Bind(wxEVT_BUTTON, [this](wxCommandEvent& evt) {
@@ -222,61 +313,67 @@ void PluginStartupRegistration::Run(std::chrono::seconds timeout)
    });
    dialog.Bind(wxEVT_TIMER, [this](wxTimerEvent& evt) {
       if(evt.GetId() == OnPluginScanTimeout)
-      {
-         if(mValidator && mValidator->InactiveSince() < mRequestStartTime)
-            Skip();
-         //else
-         //   wxMessageBox("Please check for plugin popups!");
-      }
+         CheckTimeouts();
       else
          evt.Skip();
    });
    dialog.Bind(wxEVT_CLOSE_WINDOW, [this](wxCloseEvent& evt) {
       evt.Skip();
-      mValidator.reset();
+      //Workers are destroyed with this, as one of them may be the caller
+      for(auto& worker : mWorkers)
+         worker->Release();
       PluginManager::Get().Save();
       PluginManager::Get().NotifyPluginsChanged();
    });
 
+   if(concurrency == 0)
+      concurrency = std::max(1u, std::thread::hardware_concurrency());
+   const auto workerCount = std::min<size_t>(concurrency, mPluginsToProcess.size());
+   for(size_t i = 0; i < workerCount; ++i)
+      mWorkers.push_back(std::make_unique<Worker>(*this));
+
+   if(mTimeout.count() > 0)
+      //The timeout applies to each request, so check periodically
+      timeoutTimer.Start(std::min<long>(1000,
+         std::chrono::duration_cast<std::chrono::milliseconds>(mTimeout).count()));
+
    dialog.CenterOnScreen();
-   ProcessNext();
+   for(auto& worker : mWorkers)
+      ProcessNext(*worker);
+   if(mPluginsToProcess.empty())
+      Stop();
    dialog.ShowModal();
 }
 
 void PluginStartupRegistration::Stop()
 {
+   mStopped = true;
    if(auto dialog = mScanDialog.get())
       dialog->Close();
 }
 
 void PluginStartupRegistration::Skip()
 {
-   //Drop current validator, no more callbacks will be received from now
-   mValidator->SetDelegate(nullptr);
-   //While on Linux and MacOS socket `shutdown()` wakes up `select()` almost
-   //immediately, on Windows it sometimes get delayed on unspecified amount
-   //of time. As we do not expect any data we can safely move remaining
-   //operations to another thread.
-   std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(mValidator))]{ }).detach();
+   Worker* oldest{};
+   for(auto& worker : mWorkers)
+      if(worker->IsActive() &&
+         (oldest == nullptr || worker->GetRequestStartTime() < oldest->GetRequestStartTime()))
+         oldest = worker.get();
+   if(oldest != nullptr)
+      oldest->Skip();
+}
 
-   if(!mValidProviderFound)
+void PluginStartupRegistration::CheckTimeouts()
+{
+   const auto now = std::chrono::system_clock::now();
+   for(auto& worker : mWorkers)
    {
-      // Validator didn't report anything yet or it tried
-      // one or more providers that didn't recognize the plugin.
-      // In that case we assume that none of the remaining providers
-      // can recognize that plugin.
-      // Note: create stub `PluginDescriptors` for each associated provider
-      for(;mCurrentPluginProviderIndex < mPluginsToProcess[mCurrentPluginIndex].second.size(); ++mCurrentPluginProviderIndex)
-         OnPluginValidationFailed(
-            mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-            mPluginsToProcess[mCurrentPluginIndex].first);
-      mCurrentPluginProviderIndex = mPluginsToProcess[mCurrentPluginIndex].second.size() - 1;
+      if(worker->IsActive() && worker->IsStalled() &&
+         now - worker->GetRequestStartTime() >= mTimeout)
+         worker->Skip();
+      //else
+      //   wxMessageBox("Please check for plugin popups!");
    }
-   //else
-   //    Don't assume that `OnValidationFinished()` and `OnPluginFound()`
-   //    aren't deferred within run loop
-
-   OnValidationFinished();
 }
 
 void PluginStartupRegistration::StopWithError(const wxString& msg)
@@ -286,33 +383,24 @@ void PluginStartupRegistration::StopWithError(const wxString& msg)
    Stop();
 }
 
-void PluginStartupRegistration::ProcessNext()
+void PluginStartupRegistration::ProcessNext(Worker& worker)
 {
-   if(mCurrentPluginIndex == mPluginsToProcess.size())
+   if(mStopped)
+      return;
+   if(mNextPluginIndex == mPluginsToProcess.size())
    {
-      Stop();
+      if(std::none_of(mWorkers.begin(), mWorkers.end(),
+         [](const auto& w) { return w->IsActive(); }))
+         Stop();
+      else
+         UpdateProgress();
       return;
    }
 
    try
    {
-      if(auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get()))
-      {
-         const auto progress = static_cast<float>(mCurrentPluginIndex) / static_cast<float>(mPluginsToProcess.size());
-         dialog->UpdateProgress(
-            mPluginsToProcess[mCurrentPluginIndex].first,
-            progress);
-      }
-      if(!mValidator)
-         mValidator = std::make_unique<AsyncPluginValidator>(*this);
-
-      mValidator->Validate(
-         mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-         mPluginsToProcess[mCurrentPluginIndex].first
-      );
-      mRequestStartTime = std::chrono::system_clock::now();
-      if(auto timer = mTimeoutTimer.get())
-         timer->StartOnce(std::chrono::duration_cast<std::chrono::milliseconds>(mTimeout).count());
+      worker.Start(mNextPluginIndex++);
+      UpdateProgress();
    }
    catch(std::exception& e)
    {
@@ -324,3 +412,23 @@ void PluginStartupRegistration::ProcessNext()
    }
 }
 
+void PluginStartupRegistration::UpdateProgress()
+{
+   auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get());
+   if(dialog == nullptr)
+      return;
+
+   //Show the module that waits the longest, which is what "Skip" skips
+   const Worker* oldest{};
+   for(auto& worker : mWorkers)
+      if(worker->IsActive() &&
+         (oldest == nullptr || worker->GetRequestStartTime() < oldest->GetRequestStartTime()))
+         oldest = worker.get();
+   if(oldest == nullptr)
+      return;
+
+   const auto progress = static_cast<float>(mFinishedCount) / static_cast<float>(mPluginsToProcess.size());
+   dialog->UpdateProgress(
+      mPluginsToProcess[*oldest->GetPluginIndex()].first,
+      progress);
+}
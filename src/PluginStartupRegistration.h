@@ -14,50 +14,85 @@
 #include <map>
 #include <memory>
 #include <chrono>
+#include <optional>
 #include <wx/string.h>
 #include <wx/timer.h>
 #include "AsyncPluginValidator.h"
+#include "PluginDescriptor.h"
 #include "wxPanelWrapper.h"
 
 ///Helper class that passes plugins provided in constructor
-///to plugin validator, then "good" plugins are registered in
-///PluginManager. 
-class PluginStartupRegistration final :
-   public AsyncPluginValidator::Delegate
+///to plugin validators, then "good" plugins are registered in
+///PluginManager. Several modules are validated at once, each
+///in a host process of its own.
+class PluginStartupRegistration final
 {
-   std::unique_ptr<AsyncPluginValidator> mValidator;
+   ///Validates one module at a time, trying each of its providers in turn
+   class Worker final : public AsyncPluginValidator::Delegate
+   {
+      PluginStartupRegistration& mOwner;
+      std::unique_ptr<AsyncPluginValidator> mValidator;
+      std::optional<size_t> mPluginIndex;
+      size_t mProviderIndex{0};
+      bool mValidProviderFound{false};
+      std::vector<PluginDescriptor> mFailedPluginsCache;
+      std::chrono::system_clock::time_point mRequestStartTime{};
+   public:
+      explicit Worker(PluginStartupRegistration& owner);
+
+      void Start(size_t pluginIndex);
+      void Skip();
+      //! Stop receiving callbacks, letting the host process go
+      void Release();
+
+      bool IsActive() const noexcept { return mPluginIndex.has_value(); }
+      std::optional<size_t> GetPluginIndex() const noexcept { return mPluginIndex; }
+      std::chrono::system_clock::time_point GetRequestStartTime() const noexcept { return mRequestStartTime; }
+      //! Whether no response was received since the current request was made
+      bool IsStalled() const noexcept;
+
+      void OnInternalError(const wxString& error) override;
+      void OnPluginFound(const PluginDescriptor& desc) override;
+      void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
+      void OnValidationFinished() override;
+
+   private:
+      void ValidateCurrent();
+   };
+
    std::vector<std::pair<wxString, std::vector<wxString>>> mPluginsToProcess;
-   size_t mCurrentPluginIndex{0};
-   size_t mCurrentPluginProviderIndex{0};
-   bool mValidProviderFound{false};
+   std::vector<std::unique_ptr<Worker>> mWorkers;
+   size_t mNextPluginIndex{0};
+   size_t mFinishedCount{0};
+   bool mStopped{false};
    std::vector<wxString> mFailedPluginsPaths;
-   std::vector<PluginDescriptor> mFailedPluginsCache;
    wxWeakRef<wxDialogWrapper> mScanDialog;
-   wxWeakRef<wxTimer> mTimeoutTimer;
    std::chrono::system_clock::duration mTimeout{};
-   std::chrono::system_clock::time_point mRequestStartTime{};
 public:
 
    PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess);
+   ~PluginStartupRegistration();
 
    ///Starts validation, showing dialog that blocks execution until
    ///process is complete or canceled
    ///@param timeout Time allowed to spend on a single plugin validation.
    ///Pass 0 to disable timeout.
-   void Run(std::chrono::seconds timeout = std::chrono::seconds(30));
+   ///@param concurrency How many modules to validate at once.
+   ///Pass 0 to use the number of processor cores.
+   void Run(std::chrono::seconds timeout = std::chrono::seconds(30), unsigned concurrency = 0);
 
    ///Returns list of paths of plugins that didn't pass validation for some reason
    const std::vector<wxString>& GetFailedPluginsPaths() const noexcept;
 
-   void OnInternalError(const wxString& error) override;
-   void OnPluginFound(const PluginDescriptor& desc) override;
-   void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
-   void OnValidationFinished() override;
-
 private:
    
    void Stop();
+   ///Skips the module that waits for validation the longest
    void Skip();
+   void CheckTimeouts();
    void StopWithError(const wxString& msg);
-   void ProcessNext();
+   void ProcessNext(Worker& worker);
+   void OnModuleFinished(size_t pluginIndex,
+      bool validProviderFound, std::vector<PluginDescriptor>& failedPluginsCache);
+   void UpdateProgress();
 };
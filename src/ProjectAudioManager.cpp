@@ -21,6 +21,7 @@ Paul Licameli split from ProjectManager.cpp
 #include "BasicUI.h"
 #include "CommandManager.h"
 #include "CommonCommandFlags.h"
+#include "DBConnection.h"
 #include "DefaultPlaybackPolicy.h"
 #include "Meter.h"
 #include "Mix.h"
@@ -1083,6 +1084,9 @@ void ProjectAudioManager::OnAudioIOStartRecording()
 {
    // Auto-save was done here before, but it is unnecessary, provided there
    // are sufficient autosaves when pushing or modifying undo states.
+
+   // Leave the disk to the capture; the log of the database may grow
+   DBConnection::DeferCheckpoints(true);
 }
 
 // This is called after recording has stopped and all tracks have flushed.
@@ -1121,6 +1125,9 @@ void ProjectAudioManager::OnAudioIOStopRecording()
             Publish( RecordingDropoutEvent{ intervals } );
       }
    }
+
+   // Checkpoint what accumulated, including the state just pushed
+   DBConnection::DeferCheckpoints(false);
 }
 
 void ProjectAudioManager::OnAudioIONewBlocks()
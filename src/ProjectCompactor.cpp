@@ -0,0 +1,109 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+ProjectCompactor.cpp
+
+**********************************************************************/
+
+#include "ClientData.h"
+#include "Observer.h"
+#include "Project.h"
+#include "ProjectAudioIO.h"
+#include "ProjectFileIO.h"
+#include "ProjectStatus.h"
+#include "UndoManager.h"
+
+#include <wx/app.h>
+
+namespace {
+
+//! Longest time taken from each idle event
+constexpr auto Slice = std::chrono::milliseconds{ 20 };
+
+//! Compacts the project file in slices of idle time, after undo history
+//! changes may have left unused space
+class ProjectCompactor final
+   : public ClientData::Base
+   , public wxEvtHandler
+{
+public:
+   explicit ProjectCompactor(AudacityProject &project);
+   ~ProjectCompactor() override;
+
+private:
+   void OnIdle(wxIdleEvent &event);
+
+   AudacityProject &mProject;
+   Observer::Subscription mUndoSubscription;
+   //! The status message last shown
+   TranslatableString mMessage;
+   //! Begin with one pass after opening, for space left by earlier sessions
+   bool mPending{ true };
+};
+
+static const AttachedProjectObjects::RegisteredFactory key {
+   [](AudacityProject &project) {
+      return std::make_shared<ProjectCompactor>(project);
+   }
+};
+
+ProjectCompactor::ProjectCompactor(AudacityProject &project)
+   : mProject{ project }
+{
+   mUndoSubscription = UndoManager::Get(project)
+      .Subscribe([this](const UndoRedoMessage &message) {
+         switch (message.type) {
+         // Redo states may have been discarded
+         case UndoRedoMessage::Pushed:
+         case UndoRedoMessage::EndPurge:
+            mPending = true;
+            break;
+         default:
+            break;
+         }
+      });
+   wxTheApp->Bind(wxEVT_IDLE, &ProjectCompactor::OnIdle, this);
+}
+
+ProjectCompactor::~ProjectCompactor()
+{
+   wxTheApp->Unbind(wxEVT_IDLE, &ProjectCompactor::OnIdle, this);
+}
+
+void ProjectCompactor::OnIdle(wxIdleEvent &event)
+{
+   event.Skip();
+   // Don't compete with playback or recording for the file
+   if (!mPending || ProjectAudioIO::Get(mProject).IsAudioActive())
+      return;
+
+   ProjectFileIO::CompactionProgress progress;
+   try {
+      progress = ProjectFileIO::Get(mProject).CompactIncrementally(Slice);
+   }
+   catch (...) {
+      // Try again at the next change of undo history
+      progress.done = true;
+   }
+
+   auto &status = ProjectStatus::Get(mProject);
+   // Don't replace a message of anything else
+   const bool showing = !mMessage.empty() && status.Get() == mMessage;
+   if (progress.done) {
+      mPending = false;
+      if (showing)
+         status.Set({});
+      mMessage = {};
+   }
+   else {
+      const auto message = XO("Compacting project file... %d%%")
+         .Format(static_cast<int>(progress.fraction * 100));
+      if (mMessage.empty() || showing)
+         status.Set(message);
+      mMessage = message;
+      event.RequestMore();
+   }
+}
+
+}
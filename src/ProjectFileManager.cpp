@@ -58,6 +58,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
 #include "XMLFileReader.h"
+#include "concurrency/TaskScheduler.h"
 #include "import/ImportStreamDialog.h"
 #include "prefs/ImportExportPrefs.h"
 #include "widgets/FileHistory.h"
@@ -68,6 +69,7 @@ Paul Licameli split from AudacityProject.cpp
 
 #include "ProjectFileIOExtension.h"
 
+#include <atomic>
 #include <optional>
 #include <wx/frame.h>
 #include <wx/log.h>
@@ -1388,31 +1390,16 @@ std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> RunTempoDetection(
    const auto isBeatsAndMeasures = project.ViewIsBeatsAndMeasures();
    const auto projectTempo = project.GetTempo();
 
-   using namespace BasicUI;
-   auto progress = MakeProgress(
-      XO("Music Information Retrieval"), XO("Analyzing imported audio"),
-      ProgressShowCancel);
-   auto count = 0;
-   const auto reportProgress = [&](double progressFraction) {
-      const auto result = progress->Poll(
-         (count + progressFraction) / readers.size() * 1000, 1000);
-      if (result != ProgressResult::Success)
-         throw UserException {};
-   };
+   const auto syncInfos = GetSyncInfosInParallel(
+      readers, XO("Analyzing imported audio"), projectTempo, projectWasEmpty,
+      isBeatsAndMeasures);
+   const auto nReaders = readers.size();
 
    std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> analyzedClips;
-   analyzedClips.reserve(readers.size());
-   std::transform(
-      readers.begin(), readers.end(), std::back_inserter(analyzedClips),
-      [&](const std::shared_ptr<ClipMirAudioReader>& reader) {
-         const MIR::ProjectSyncInfoInput input {
-            *reader,      reader->filename, reader->tags,       reportProgress,
-            projectTempo, projectWasEmpty,  isBeatsAndMeasures,
-         };
-         auto syncInfo = MIR::GetProjectSyncInfo(input);
-         ++count;
-         return std::make_shared<AnalyzedWaveClip>(reader, syncInfo);
-      });
+   analyzedClips.reserve(nReaders);
+   for (size_t ii = 0; ii < nReaders; ++ii)
+      analyzedClips.push_back(
+         std::make_shared<AnalyzedWaveClip>(readers[ii], syncInfos[ii]));
    return analyzedClips;
 }
 } // namespace
@@ -0,0 +1,274 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PunchAndRollCache.cpp
+
+**********************************************************************/
+#include "PunchAndRollCache.h"
+
+#include "AudioIOBase.h"
+#include "BasicUI.h"
+#include "Prefs.h"
+#include "Project.h"
+#include "SampleBlockPrefetcher.h"
+#include "UndoManager.h"
+#include "ViewInfo.h"
+#include "WaveTrack.h"
+#include "prefs/RecordingPrefs.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::optional<PunchAndRollStart> ComputePunchAndRollStart(
+   const WritableSampleTrackArray &tracks, double t1, double crossFadeDuration)
+{
+   // Remember a part of what is right of the selection for crossfading with
+   // the new recording.
+   // We may also adjust the starting point leftward if it is too close to the
+   // end of the track, so that at least some nonzero crossfade data can be
+   // taken.
+   PunchAndRollStart result;
+
+   // The test for t1 == 0.0 stops punch and roll deleting everything where the
+   // selection is at zero.  There wouldn't be any cued audio to play in
+   // that case, so a normal record, not a punch and roll, is called for.
+   bool error = (t1 == 0.0);
+
+   double newt1 = t1;
+   for (const auto &wt : tracks) {
+      auto rate = wt->GetRate();
+      sampleCount testSample(floor(t1 * rate));
+      const auto &intervals = as_const(*wt).Intervals();
+      auto pred = [rate](sampleCount testSample){ return
+         [rate, testSample](const auto &pInterval){
+            auto start = floor(pInterval->Start() * rate + 0.5);
+            auto end = floor(pInterval->End() * rate + 0.5);
+            auto ts = testSample.as_double();
+            return ts >= start && ts < end;
+         };
+      };
+      auto begin = intervals.begin(), end = intervals.end(),
+         iter = std::find_if(begin, end, pred(testSample));
+      if (iter == end)
+         // Bug 1890 (an enhancement request)
+         // Try again, a little to the left.
+         // Subtract 10 to allow a selection exactly at or slightly after the
+         // end time
+         iter = std::find_if(begin, end, pred(testSample - 10));
+      if (iter == end)
+         error = true;
+      else {
+         // May adjust t1 left
+         // Let's ignore the possibility of a clip even shorter than the
+         // crossfade duration!
+         newt1 = std::min(newt1, (*iter).get()->End() - crossFadeDuration);
+      }
+   }
+
+   if (error)
+      return result;
+   result.withinClips = true;
+
+   t1 = newt1;
+   result.t1 = t1;
+   auto &crossfadeData = result.crossfadeData;
+   for (const auto &wt : tracks) {
+      const auto endTime = wt->GetEndTime();
+      const auto duration =
+         std::max(0.0, std::min(crossFadeDuration, endTime - t1));
+      const size_t getLen = floor(duration * wt->GetRate());
+      if (getLen > 0) {
+         // TODO more-than-two-channels
+         const auto nChannels = std::min<size_t>(2, wt->NChannels());
+         crossfadeData.resize(nChannels);
+         float *buffers[2]{};
+         for (size_t ii = 0; ii < nChannels; ++ii) {
+            auto &data = crossfadeData[ii];
+            data.resize(getLen);
+            buffers[ii] = data.data();
+         }
+         const sampleCount pos = wt->TimeToLongSamples(t1);
+         if (!wt->GetFloats(0, nChannels, buffers, pos, getLen))
+            return {};
+      }
+   }
+   return result;
+}
+
+BoolSetting PunchAndRollPrefetchPreRoll{
+   L"/AudioIO/PunchAndRollPrefetchPreRoll", false };
+
+namespace {
+//! Less than the time after which SampleBlockPrefetcher unpins a window
+constexpr int RenewIntervalMS = 2000;
+
+const AttachedProjectObjects::RegisteredFactory key{
+   [](AudacityProject &project) {
+      return std::make_shared<PunchAndRollCache>(project);
+   }
+};
+
+double CrossFadeDuration()
+{
+   return std::max(0.0,
+      gPrefs->Read(AUDIO_ROLL_CROSSFADE_KEY, DEFAULT_ROLL_CROSSFADE_MS)
+         / 1000.0);
+}
+
+bool TransportIsBusy()
+{
+   auto gAudioIO = AudioIOBase::Get();
+   return gAudioIO && gAudioIO->IsBusy();
+}
+}
+
+PunchAndRollCache &PunchAndRollCache::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<PunchAndRollCache>(key);
+}
+
+PunchAndRollCache::PunchAndRollCache(AudacityProject &project)
+   : mProject{ project }
+   , mUndoSubscription{ UndoManager::Get(project)
+      .Subscribe([this](UndoRedoMessage message){
+         switch (message.type) {
+         case UndoRedoMessage::Pushed:
+         case UndoRedoMessage::Modified:
+         case UndoRedoMessage::UndoOrRedo:
+         case UndoRedoMessage::Reset:
+            Invalidate();
+            Schedule();
+            break;
+         default:
+            break;
+         }
+      }) }
+   // Refresh() compares the key, so changes of selection that leave its left
+   // edge in place cost little
+   , mSelectionSubscription{ ViewInfo::Get(project).selectedRegion
+      .Subscribe([this](const NotifyingSelectedRegionMessage&){
+         Schedule();
+      }) }
+{
+   mTimer.Bind(wxEVT_TIMER, [this](wxTimerEvent&){
+      if (TransportIsBusy())
+         Invalidate();
+      else
+         Prefetch();
+   });
+}
+
+PunchAndRollCache::~PunchAndRollCache()
+{
+   Release();
+}
+
+auto PunchAndRollCache::MakeKey(const WritableSampleTrackArray &tracks,
+   double t1, double crossFadeDuration) -> Key
+{
+   Key key{ t1, crossFadeDuration };
+   for (const auto &pTrack : tracks)
+      key.tracks.push_back(pTrack->GetId());
+   return key;
+}
+
+std::optional<PunchAndRollStart> PunchAndRollCache::Take(
+   const WritableSampleTrackArray &tracks, double t1, double crossFadeDuration)
+{
+   auto result = (mStart && MakeKey(tracks, t1, crossFadeDuration) == mKey)
+      ? std::move(mStart)
+      : ComputePunchAndRollStart(tracks, t1, crossFadeDuration);
+   Invalidate();
+   return result;
+}
+
+void PunchAndRollCache::Invalidate()
+{
+   mStart.reset();
+   mTimer.Stop();
+   Release();
+}
+
+void PunchAndRollCache::Schedule()
+{
+   if (mScheduled)
+      return;
+   mScheduled = true;
+   BasicUI::CallAfter([wProject = mProject.weak_from_this()]{
+      if (auto pProject = wProject.lock())
+         Get(*pProject).Refresh();
+   });
+}
+
+void PunchAndRollCache::Refresh()
+{
+   mScheduled = false;
+   // Don't compete with playback or recording; the next change of the project
+   // refreshes again
+   if (TransportIsBusy())
+      return;
+
+   // Choose tracks as OnPunchAndRoll does
+   const auto properties = GetPropertiesOfSelected(mProject);
+   if (!properties.allSameRate) {
+      Invalidate();
+      return;
+   }
+   const auto tracks = ProjectAudioManager::ChooseExistingRecordingTracks(
+      mProject, true, properties.rateOfSelected);
+   const double t1 =
+      std::max(0.0, ViewInfo::Get(mProject).selectedRegion.t0());
+   auto key = MakeKey(tracks, t1, CrossFadeDuration());
+   if (mStart && key == mKey)
+      return;
+
+   Invalidate();
+   if (tracks.empty())
+      return;
+   mKey = std::move(key);
+   mStart = ComputePunchAndRollStart(tracks, t1, mKey.crossFadeDuration);
+
+   if (mStart && mStart->withinClips && PunchAndRollPrefetchPreRoll.Read()) {
+      const auto preRoll = std::max(0.0,
+         gPrefs->Read(AUDIO_PRE_ROLL_KEY, DEFAULT_PRE_ROLL_SECONDS));
+      mPreRollStart = std::max(0.0, mStart->t1 - preRoll);
+      Prefetch();
+      mTimer.Start(RenewIntervalMS);
+   }
+}
+
+void PunchAndRollCache::Prefetch()
+{
+   if (!mStart)
+      return;
+   // Which tracks play during the pre-roll, as in OnPunchAndRoll
+   std::vector<std::shared_ptr<const WaveTrack>> tracks;
+   if (ProjectAudioManager::UseDuplex())
+      for (auto pTrack : TrackList::Get(mProject).Any<const WaveTrack>())
+         tracks.push_back(pTrack->SharedPointer<const WaveTrack>());
+   else
+      for (const auto &id : mKey.tracks)
+         if (auto pTrack =
+            TrackList::Get(mProject).FindById(id); pTrack != nullptr)
+            if (auto pWaveTrack = dynamic_cast<const WaveTrack*>(pTrack))
+               tracks.push_back(pWaveTrack->SharedPointer<const WaveTrack>());
+
+   Release();
+   for (const auto &pTrack : tracks) {
+      const auto start = pTrack->TimeToLongSamples(mPreRollStart);
+      const auto end = pTrack->TimeToLongSamples(mStart->t1);
+      if (end <= start)
+         continue;
+      // Each track is the client of its own window of blocks
+      pTrack->Prefetch(pTrack.get(), start, (end - start).as_size_t(), false);
+      mPrefetched.push_back(pTrack.get());
+   }
+}
+
+void PunchAndRollCache::Release()
+{
+   for (const auto client : mPrefetched)
+      SampleBlockPrefetcher::Get().Release(client);
+   mPrefetched.clear();
+}
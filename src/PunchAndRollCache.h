@@ -0,0 +1,98 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PunchAndRollCache.h
+
+**********************************************************************/
+#ifndef __AUDACITY_PUNCH_AND_ROLL_CACHE__
+#define __AUDACITY_PUNCH_AND_ROLL_CACHE__
+
+#include "ClientData.h"
+#include "Observer.h"
+#include "ProjectAudioManager.h" // for WritableSampleTrackArray
+#include "Track.h"
+
+#include <optional>
+#include <vector>
+#include <wx/timer.h>
+
+class AudacityProject;
+class BoolSetting;
+
+using PRCrossfadeData = std::vector< std::vector < float > >;
+
+//! Where punch-and-roll recording begins, and what it crossfades with there
+struct PunchAndRollStart {
+   //! False if the time was not within a clip of each track
+   bool withinClips{ false };
+   //! Adjusted leftward to leave room for the crossfade
+   double t1{};
+   PRCrossfadeData crossfadeData;
+};
+
+//! Find the start of punch-and-roll recording into tracks at about t1
+/*!
+ @return nullopt if the crossfade data could not be read
+ */
+AUDACITY_DLL_API std::optional<PunchAndRollStart> ComputePunchAndRollStart(
+   const WritableSampleTrackArray &tracks, double t1, double crossFadeDuration);
+
+//! When on, the sample blocks of the pre-roll stay loaded while the transport
+//! is idle, at the cost of the memory they take
+extern AUDACITY_DLL_API BoolSetting PunchAndRollPrefetchPreRoll;
+
+//! Keeps the start of a punch-and-roll at the selection computed, while the
+//! transport is idle, so that recording need not wait for it
+class AUDACITY_DLL_API PunchAndRollCache final : public ClientData::Base
+{
+public:
+   static PunchAndRollCache &Get(AudacityProject &project);
+
+   explicit PunchAndRollCache(AudacityProject &project);
+   PunchAndRollCache(const PunchAndRollCache&) = delete;
+   PunchAndRollCache &operator=(const PunchAndRollCache&) = delete;
+   ~PunchAndRollCache() override;
+
+   //! The start for these arguments, cached if it is up to date, else computed
+   /*! The cache is emptied either way, because recording changes the tracks */
+   std::optional<PunchAndRollStart> Take(
+      const WritableSampleTrackArray &tracks, double t1,
+      double crossFadeDuration);
+
+private:
+   struct Key {
+      double t1, crossFadeDuration;
+      std::vector<TrackId> tracks;
+      bool operator ==(const Key &other) const
+      {
+         return t1 == other.t1 &&
+            crossFadeDuration == other.crossFadeDuration &&
+            tracks == other.tracks;
+      }
+   };
+   static Key MakeKey(const WritableSampleTrackArray &tracks,
+      double t1, double crossFadeDuration);
+
+   void Invalidate();
+   //! Compute in the next idle time, once for all the changes before
+   void Schedule();
+   void Refresh();
+   //! Renew the windows in SampleBlockPrefetcher before they go stale
+   void Prefetch();
+   void Release();
+
+   AudacityProject &mProject;
+   Observer::Subscription mUndoSubscription, mSelectionSubscription;
+   wxTimer mTimer;
+
+   Key mKey;
+   std::optional<PunchAndRollStart> mStart;
+   //! The pre-roll to prefetch, ending at the start
+   double mPreRollStart{};
+   //! Clients of SampleBlockPrefetcher
+   std::vector<const void*> mPrefetched;
+   bool mScheduled{ false };
+};
+
+#endif
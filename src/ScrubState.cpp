@@ -11,6 +11,11 @@
 #include "ScrubState.h"
 #include "AudioIO.h"
 #include "Mix.h"
+#include "SPSCQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
 
 namespace {
 struct ScrubQueue : NonInterferingBase
@@ -31,12 +36,23 @@ struct ScrubQueue : NonInterferingBase
       mStarted = false;
       mStopped = false;
       mAccumulatedSeekDuration = 0;
+      mPointerVelocity = 0;
+      mLastPointer.reset();
    }
 
    void Update(double end, const ScrubbingOptions &options)
    {
       // Called by another thread
-      mMessage.Write({ end, options });
+      Message message;
+      message.end = end;
+      message.options = options;
+      message.when = Clock::now();
+      // If the queue is full, keep only the latest message for a later try
+      if (!(mPending && !mMessages.TryPush(*mPending)) &&
+          mMessages.TryPush(message))
+         mPending.reset();
+      else
+         mPending = message;
    }
 
    void Get(sampleCount &startSample, sampleCount &endSample,
@@ -46,7 +62,14 @@ struct ScrubQueue : NonInterferingBase
       startSample = endSample = duration = -1LL;
       sampleCount s0Init;
 
-      Message message( mMessage.Read() );
+      // Consume all messages without waiting; only the latest matters
+      bool received = false;
+      mMessages.ConsumeAll([&](Message &&message){
+         mMessage = std::move(message);
+         received = true; });
+      const auto &message = mMessage;
+      if (received)
+         UpdateVelocity(message);
       if ( !mStarted ) {
          s0Init = llrint( mRate *
             std::max( message.options.minTime,
@@ -86,6 +109,7 @@ struct ScrubQueue : NonInterferingBase
       };
 
       mStarted = true;
+      UpdatePrediction(message);
 
       Data &entry = mData;
       if (  mStopped.load( std::memory_order_relaxed ) ) {
@@ -124,7 +148,59 @@ struct ScrubQueue : NonInterferingBase
 
    bool Started() const { return mStarted; }
 
+   //! Times of the tracks that scrubbing may soon reach, for prefetching
+   std::pair<double, double> PredictedRange() const { return mPredicted; }
+
 private:
+   using Clock = std::chrono::steady_clock;
+
+   //! How far ahead to extrapolate the motion of the pointer
+   static constexpr std::chrono::duration<double> PredictionHorizon{ 0.5 };
+   //! Track time to load on both sides of the extremes of the prediction
+   static constexpr double PredictionMargin = 1.0;
+
+   struct Message;
+
+   void UpdateVelocity(const Message &message)
+   {
+      if (message.options.bySpeed) {
+         // The message gives the speed directly
+         mLastPointer.reset();
+         return;
+      }
+      if (mLastPointer) {
+         const auto elapsed =
+            std::chrono::duration<double>{ message.when - mLastWhen }.count();
+         if (elapsed > 0) {
+            // Smooth the velocity of the pointer over a few polls of the mouse
+            const auto velocity = (message.end - *mLastPointer) / elapsed;
+            mPointerVelocity += 0.5 * (velocity - mPointerVelocity);
+         }
+      }
+      mLastPointer = message.end;
+      mLastWhen = message.when;
+   }
+
+   void UpdatePrediction(const Message &message)
+   {
+      // Cover where playback is, where the pointer is, and where the pointer
+      // is heading
+      const auto &options = message.options;
+      const auto position = mData.mS1.as_double() / mRate;
+      const auto pointer = options.bySpeed ? position : message.end;
+      const auto velocity =
+         options.bySpeed ? message.end : mPointerVelocity;
+      const auto maxLead = ScrubbingOptions::MaxAllowedScrubSpeed() *
+         PredictionHorizon.count();
+      const auto predicted = pointer + std::clamp(
+         velocity * PredictionHorizon.count(), -maxLead, maxLead);
+      const auto [low, high] = std::minmax({ position, pointer, predicted });
+      mPredicted = {
+         std::max(options.minTime, low - PredictionMargin),
+         std::min(options.maxTime, high + PredictionMargin)
+      };
+   }
+
    struct Data
    {
       Data()
@@ -282,9 +358,21 @@ private:
       Message(const Message&) = default;
       double end;
       ScrubbingOptions options;
+      Clock::time_point when;
    };
-   MessageBuffer<Message> mMessage;
+   SPSCQueue<Message> mMessages{ 16 };
+   //! Producer side only; latest message not yet sent because queue was full
+   std::optional<Message> mPending;
+   //! Consumer side only; latest message received
+   Message mMessage;
    sampleCount mAccumulatedSeekDuration{};
+
+   //! Consumer side only; estimate of the motion of the pointer, in track
+   //! seconds per second
+   double mPointerVelocity{ 0 };
+   std::optional<double> mLastPointer;
+   Clock::time_point mLastWhen;
+   std::pair<double, double> mPredicted{ 0, 0 };
 };
 
 ScrubQueue ScrubQueue::Instance;
@@ -343,6 +431,12 @@ ScrubbingPlaybackPolicy::SuggestedBufferTimes(PlaybackSchedule &)
    };
 }
 
+bool ScrubbingPlaybackPolicy::AllowLookAhead( PlaybackSchedule & )
+{
+   // Scrubbing must follow the mouse closely
+   return false;
+}
+
 bool ScrubbingPlaybackPolicy::AllowSeek( PlaybackSchedule & )
 {
    // While scrubbing, ignore seek requests
@@ -433,6 +527,12 @@ bool ScrubbingPlaybackPolicy::RepositionPlayback(
       }
       else
       {
+         // Load the blocks that the next intervals may need, while this one
+         // plays, so that fast or jumping scrubs don't wait on storage
+         const auto [t0, t1] = ScrubQueue::Instance.PredictedRange();
+         for (auto &pMixer : playbackMixers)
+            pMixer->Prefetch(t0, t1);
+
          mSilentScrub = (mEndSample == mStartSample);
          double startTime, endTime;
          startTime = mStartSample.as_double() / mRate;
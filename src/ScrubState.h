@@ -57,6 +57,8 @@ public:
 
    BufferTimes SuggestedBufferTimes(PlaybackSchedule &schedule) override;
 
+   bool AllowLookAhead( PlaybackSchedule & ) override;
+
    bool AllowSeek( PlaybackSchedule & ) override;
 
    std::chrono::milliseconds
@@ -13,11 +13,14 @@
 
 *//*******************************************************************/
 
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include "FFT.h"
 #include "ProjectHistory.h"
 #include "SpectralDataManager.h"
 #include "WaveTrack.h"
+#include "concurrency/TaskScheduler.h"
 
 SpectralDataManager::SpectralDataManager()= default;
 
@@ -51,68 +54,122 @@ const std::shared_ptr<SpectralData> FindSpectralData(Channel *pChannel)
    }
    return {};
 }
+
+//! First and last hops of the runs of hops with brush data in any of the
+//! channels; hops no farther apart than `gap` share a run, so that windows
+//! are not processed twice
+std::vector<std::pair<long long, long long>> FindTouchedHops(
+   const std::vector<std::shared_ptr<SpectralData>> &channelsData,
+   long long gap)
+{
+   std::set<long long> hops;
+   for (const auto &pData : channelsData)
+      if (pData)
+         for (const auto &hopsAndBins : pData->dataHistory)
+            for (const auto &[hop, bins] : hopsAndBins)
+               if (!bins.empty())
+                  hops.insert(hop);
+   std::vector<std::pair<long long, long long>> result;
+   for (const auto hop : hops)
+      if (!result.empty() && hop - result.back().second <= gap)
+         result.back().second = hop;
+      else
+         result.emplace_back(hop, hop);
+   return result;
+}
 }
 
 bool SpectralDataManager::ProcessTracks(AudacityProject &project){
    auto &tracks = TrackList::Get(project);
    int applyCount = 0;
    Setting setting;
+
+   // Only the windows near the brush data are processed, elsewhere the
+   // transformation would give back the samples.  Each run of them in each
+   // channel is a job, and all jobs of all tracks run in parallel; the FFT
+   // tables of the window size are shared
+   struct Job {
+      const WaveChannel *pChannel;
+      std::shared_ptr<SpectralData> pData;
+      long long firstHop, lastHop;
+      WaveChannel *pOutput;
+      SpectrumTransformer::FloatVector output;
+   };
+   struct Run {
+      WaveTrack *pTrack;
+      std::shared_ptr<WaveTrack> pTempTrack;
+      long long start, len;
+   };
+   std::vector<Job> jobs;
+   std::vector<Run> runs;
+   std::vector<std::shared_ptr<SpectralData>> allData;
    for (auto wt : tracks.Any<WaveTrack>()) {
-      using Type = long long;
-      Type startSample{ std::numeric_limits<Type>::max() };
-      Type endSample{ std::numeric_limits<Type>::min() };
-      for (auto pChannel : wt->Channels()) {
-         if (const auto pData = FindSpectralData(pChannel.get())) {
-            const auto &hopSize = pData->GetHopSize();
-            auto start = pData->GetStartSample();
-            endSample = std::max(endSample, pData->GetEndSample());
-
-            // Correct the start of range so that the first full window is
-            // centered at that position
-            start = std::max(static_cast<long long>(0), start - 2 * hopSize);
-            startSample = std::min(startSample, start);
-         }
-      }
-      if (startSample >= endSample)
+      std::vector<std::shared_ptr<SpectralData>> channelsData;
+      for (auto pChannel : wt->Channels())
+         channelsData.push_back(FindSpectralData(pChannel.get()));
+      const auto iData = std::find_if(channelsData.begin(),
+         channelsData.end(), [](const auto &pData){ return pData != nullptr; });
+      if (iData == channelsData.end())
          continue;
-      const auto t0 = wt->LongSamplesToTime(startSample);
-      const auto len = endSample - startSample;
-      const auto tLen = wt->LongSamplesToTime(len);
-      auto tempTrack = wt->EmptyCopy();
-      auto iter = tempTrack->Channels().begin();
-      long long processed{};
-      for (auto pChannel : wt->Channels()) {
-         Worker worker{ (*iter++).get(), setting };
-         auto &view = ChannelView::Get(*pChannel);
-
-         if (auto waveChannelViewPtr = dynamic_cast<WaveChannelView*>(&view)){
-            for (const auto &subViewPtr : waveChannelViewPtr->GetAllSubViews()){
-               if (!subViewPtr->IsSpectral())
-                  continue;
-               auto sView = std::static_pointer_cast<SpectrumView>(subViewPtr).get();
-               auto pSpectralData = sView->GetSpectralData();
-
-               if (!pSpectralData->dataHistory.empty()) {
-                  // TODO make this correct in case start or end of spectral data in
-                  // the channels differs
-                  processed = std::max(processed, pSpectralData->GetLength());
-                  worker.Process(*pChannel, pSpectralData);
-                  applyCount += static_cast<int>(pSpectralData->dataHistory.size());
-                  pSpectralData->clearAllData();
-               }
-            }
+      const long long hopSize = (*iData)->GetHopSize();
+
+      for (const auto &[firstHop, lastHop] :
+         FindTouchedHops(channelsData, 2 * setting.mStepsPerWindow)) {
+         // Correct the start of range so that the first full window is
+         // centered at that position
+         const auto start = std::max(0LL, (firstHop - 2) * hopSize);
+         const auto end = lastHop * hopSize;
+         if (start >= end)
+            continue;
+         auto tempTrack = wt->EmptyCopy();
+         auto iter = tempTrack->Channels().begin();
+         auto iChannelData = channelsData.begin();
+         for (auto pChannel : wt->Channels()) {
+            auto pData = *iChannelData++;
+            if (!pData)
+               // Without brush data, the channel is copied
+               pData = std::make_shared<SpectralData>(wt->GetRate());
+            jobs.push_back(
+               { pChannel.get(), pData, firstHop, lastHop, (*iter++).get() });
          }
+         runs.push_back({ wt, tempTrack, start, end - start });
       }
-      if (tempTrack) {
-         TrackSpectrumTransformer::PostProcess(*tempTrack, processed);
-         // Take the output track and insert it in place of the original
-         // sample data
-         // TODO make this correct in case start or end of spectral data in
-         // the channels differs
-         wt->ClearAndPaste(t0, t0 + tLen, *tempTrack, true, false);
-      }
+
+      for (const auto &pData : channelsData)
+         if (pData) {
+            applyCount += static_cast<int>(pData->dataHistory.size());
+            allData.push_back(pData);
+         }
    }
 
+   {
+      audacity::concurrency::TaskGroup group;
+      for (auto &job : jobs)
+         group.Run([&setting, &job]{
+            Worker worker{ job.pOutput, setting };
+            worker.Process(
+               *job.pChannel, job.pData, job.firstHop, job.lastHop);
+            job.output = std::move(worker.Output());
+         });
+      group.Wait();
+   }
+
+   // Sample blocks are made here, in the main thread
+   for (const auto &job : jobs)
+      job.pOutput->Append(reinterpret_cast<constSamplePtr>(job.output.data()),
+         floatSample, job.output.size());
+   for (const auto &run : runs) {
+      auto &tempTrack = *run.pTempTrack;
+      TrackSpectrumTransformer::PostProcess(tempTrack, run.len);
+      // Take the output track and insert it in place of the original
+      // sample data
+      const auto t0 = run.pTrack->LongSamplesToTime(run.start);
+      const auto tLen = run.pTrack->LongSamplesToTime(run.len);
+      run.pTrack->ClearAndPaste(t0, t0 + tLen, tempTrack, true, false);
+   }
+   for (const auto &pData : allData)
+      pData->clearAllData();
+
    if (applyCount) {
       ProjectHistory::Get(project).PushState(
             XO("Applied effect to selection"),
@@ -168,17 +225,27 @@ bool SpectralDataManager::Worker::DoFinish() {
 }
 
 bool SpectralDataManager::Worker::Process(const WaveChannel &channel,
-   const std::shared_ptr<SpectralData> &pSpectralData)
+   const std::shared_ptr<SpectralData> &pSpectralData,
+   long long firstHop, long long lastHop)
 {
    mpSpectralData = pSpectralData;
-   const auto hopSize = mpSpectralData->GetHopSize();
-   const auto startSample = mpSpectralData->GetStartSample();
+   const long long hopSize = mpSpectralData->GetHopSize();
+   // Correct the start of range so that the first full window is
+   // centered at that position
+   const auto start = std::max(0LL, (firstHop - 2) * hopSize);
    // Correct the first hop num, because SpectrumTransformer will send
    // a few initial windows that overlay the range only partially
-   mStartHopNum = startSample / hopSize - (mStepsPerWindow - 1);
+   mStartHopNum = firstHop - (mStepsPerWindow - 1);
    mWindowCount = 0;
+   mOutput.clear();
    return TrackSpectrumTransformer::Process(Processor, channel, 1,
-      mpSpectralData->GetCorrectedStartSample(), mpSpectralData->GetLength());
+      start, lastHop * hopSize - start);
+}
+
+void SpectralDataManager::Worker::DoOutput(
+   const float *outBuffer, size_t mStepSize)
+{
+   mOutput.insert(mOutput.end(), outBuffer, outBuffer + mStepSize);
 }
 
 int SpectralDataManager::Worker::ProcessSnapping(const WaveChannel &channel,
@@ -323,9 +390,13 @@ bool SpectralDataManager::Worker::Processor(SpectrumTransformer &transformer)
 bool SpectralDataManager::Worker::ApplyEffectToSelection() {
    auto &record = NthWindow(0);
 
-   for(auto &spectralDataMap: mpSpectralData->dataHistory){
+   for(const auto &spectralDataMap: mpSpectralData->dataHistory){
+      // Find, not insert, as other workers may read the same data
+      const auto iter = spectralDataMap.find(mStartHopNum);
+      if (iter == spectralDataMap.end())
+         continue;
       // For all added frequency
-      for(const int &freqBin: spectralDataMap[mStartHopNum]){
+      for(const int &freqBin: iter->second){
          record.mRealFFTs[freqBin] = 0;
          record.mImagFFTs[freqBin] = 0;
       }
@@ -58,8 +58,12 @@ public:
       FloatVector mGains;
    };
 
+   //! Process the windows of hops from firstHop to lastHop, collecting the
+   //! output instead of appending it, so that this may run in any thread
    bool Process(const WaveChannel &channel,
-      const std::shared_ptr<SpectralData> &sDataPtr);
+      const std::shared_ptr<SpectralData> &sDataPtr,
+      long long firstHop, long long lastHop);
+   FloatVector &Output() { return mOutput; }
    int ProcessSnapping(const WaveChannel &channel,
       long long int startSC, int hopSize, size_t winSize,
       double threshold, int targetFreqBin);
@@ -73,6 +77,7 @@ protected:
    }
    std::unique_ptr<Window> NewWindow(size_t windowSize) override;
    bool DoStart() override;
+   void DoOutput(const float *outBuffer, size_t mStepSize) override;
    static bool Processor(SpectrumTransformer &transformer);
    static bool OvertonesProcessor(SpectrumTransformer &transformer);
    static bool SnappingProcessor(SpectrumTransformer &transformer);
@@ -89,4 +94,5 @@ private:
    int mSnapTargetFreqBin;
    int mSnapReturnFreqBin { -1 };
    long long mStartHopNum { 0 };
+   FloatVector mOutput;
 };
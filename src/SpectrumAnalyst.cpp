@@ -26,6 +26,8 @@ and in the spectrogram spectral selection.
 #include "FFT.h"
 
 #include "SampleFormat.h"
+#include "WindowTable.h"
+#include <algorithm>
 #include <wx/dcclient.h>
 
 FreqGauge::FreqGauge(wxWindow * parent, wxWindowID winid)
@@ -93,9 +95,48 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
                                 const float *data, size_t dataLen,
                                 float *pYMin, float *pYMax,
                                 FreqGauge *progress)
+{
+   if (!Start(alg, windowFunc, windowSize, rate))
+      return false;
+
+   if (dataLen < windowSize) {
+      mRate = 0.0;
+      mWindowSize = 0;
+      return false;
+   }
+
+   if (progress) {
+      progress->SetRange(dataLen);
+   }
+
+   // Give the data in pieces of one hop, to update the progress bar once for
+   // each window
+   const auto half = mWindowSize / 2;
+   for (size_t start = 0; start < dataLen; start += half) {
+      Accumulate(data + start, std::min(half, dataLen - start));
+
+      // Update the progress bar
+      if (progress) {
+         progress->SetValue(start);
+      }
+   }
+
+   if (progress) {
+      // Reset for next time
+      progress->Reset();
+   }
+
+   return Summarize(pYMin, pYMax);
+}
+
+bool SpectrumAnalyst::Start(Algorithm alg, int windowFunc,
+                            size_t windowSize, double rate)
 {
    // Wipe old data
    mProcessed.resize(0);
+   mSums.resize(0);
+   mPending.resize(0);
+   mWindows = 0;
    mRate = 0.0;
    mWindowSize = 0;
 
@@ -109,141 +150,157 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       return false;
    }
 
-   if (dataLen < windowSize) {
-      return false;
-   }
-
    // Now repopulate
    mRate = rate;
    mWindowSize = windowSize;
    mAlg = alg;
 
-   auto half = mWindowSize / 2;
-   mProcessed.resize(mWindowSize);
-
-   Floats in{ mWindowSize };
-   Floats out{ mWindowSize };
-   Floats out2{ mWindowSize };
-   Floats win{ mWindowSize };
-
-   for (size_t i = 0; i < mWindowSize; i++) {
-      mProcessed[i] = 0.0f;
-      win[i] = 1.0f;
-   }
+   mSums.resize(mWindowSize / 2, 0.0f);
+   mPending.reserve(mWindowSize);
+   mIn.reinit(mWindowSize);
+   mOut.reinit(mWindowSize);
+   mOut2.reinit(mWindowSize);
+   mWin.reinit(mWindowSize);
 
-   WindowFunc(windowFunc, mWindowSize, win.get());
+   const auto pTable = GetWindowFuncTable(windowFunc, mWindowSize);
+   std::copy(pTable->begin(), pTable->end(), mWin.get());
 
    // Scale window such that an amplitude of 1.0 in the time domain
    // shows an amplitude of 0dB in the frequency domain
    double wss = 0;
    for (size_t i = 0; i<mWindowSize; i++)
-      wss += win[i];
+      wss += mWin[i];
    if(wss > 0)
       wss = 4.0 / (wss*wss);
    else
       wss = 1.0;
+   mWss = wss;
 
-   if (progress) {
-      progress->SetRange(dataLen);
+   return true;
+}
+
+void SpectrumAnalyst::Accumulate(const float *data, size_t dataLen)
+{
+   if (mWindowSize == 0)
+      return;
+
+   const auto half = mWindowSize / 2;
+   while (dataLen > 0) {
+      const auto count = std::min(dataLen, mWindowSize - mPending.size());
+      mPending.insert(mPending.end(), data, data + count);
+      data += count;
+      dataLen -= count;
+      if (mPending.size() < mWindowSize)
+         break;
+
+      AccumulateWindow();
+
+      // Windows overlap by half
+      std::copy(mPending.begin() + half, mPending.end(), mPending.begin());
+      mPending.resize(mWindowSize - half);
    }
+}
 
-   size_t start = 0;
-   int windows = 0;
-   while (start + mWindowSize <= dataLen) {
-      for (size_t i = 0; i < mWindowSize; i++)
-         in[i] = win[i] * data[start + i];
+void SpectrumAnalyst::AccumulateWindow()
+{
+   const auto half = mWindowSize / 2;
+   const auto in = mIn.get();
+   const auto out = mOut.get();
+   const auto out2 = mOut2.get();
 
-      switch (alg) {
-         case Spectrum:
-            PowerSpectrum(mWindowSize, in.get(), out.get());
+   for (size_t i = 0; i < mWindowSize; i++)
+      in[i] = mWin[i] * mPending[i];
 
-            for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
-            break;
+   switch (mAlg) {
+      case Spectrum:
+         PowerSpectrum(mWindowSize, in, out);
 
-         case Autocorrelation:
-         case CubeRootAutocorrelation:
-         case EnhancedAutocorrelation:
+         for (size_t i = 0; i < half; i++)
+            mSums[i] += out[i];
+         break;
 
-            // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-            // Compute power
-            for (size_t i = 0; i < mWindowSize; i++)
-               in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
+      case Autocorrelation:
+      case CubeRootAutocorrelation:
+      case EnhancedAutocorrelation:
 
-            if (alg == Autocorrelation) {
-               for (size_t i = 0; i < mWindowSize; i++)
-                  in[i] = sqrt(in[i]);
-            }
-            if (alg == CubeRootAutocorrelation ||
-                alg == EnhancedAutocorrelation) {
-               // Tolonen and Karjalainen recommend taking the cube root
-               // of the power, instead of the square root
+         // Take FFT
+         RealFFT(mWindowSize, in, out, out2);
+         // Compute power
+         for (size_t i = 0; i < mWindowSize; i++)
+            in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
 
-               for (size_t i = 0; i < mWindowSize; i++)
-                  in[i] = pow(in[i], 1.0f / 3.0f);
+         if (mAlg == Autocorrelation) {
+            for (size_t i = 0; i < mWindowSize; i++)
+               in[i] = sqrt(in[i]);
+         }
+         if (mAlg == CubeRootAutocorrelation ||
+             mAlg == EnhancedAutocorrelation) {
+            // Tolonen and Karjalainen recommend taking the cube root
+            // of the power, instead of the square root
+
+            for (size_t i = 0; i < mWindowSize; i++)
+               in[i] = pow(in[i], 1.0f / 3.0f);
+         }
+         // Take FFT
+         RealFFT(mWindowSize, in, out, out2);
+
+         // Take real part of result
+         for (size_t i = 0; i < half; i++)
+            mSums[i] += out[i];
+         break;
+
+      case Cepstrum:
+         RealFFT(mWindowSize, in, out, out2);
+
+         // Compute log power
+         // Set a sane lower limit assuming maximum time amplitude of 1.0
+         {
+            float power;
+            float minpower = 1e-20*mWindowSize*mWindowSize;
+            for (size_t i = 0; i < mWindowSize; i++)
+            {
+               power = (out[i] * out[i]) + (out2[i] * out2[i]);
+               if(power < minpower)
+                  in[i] = log(minpower);
+               else
+                  in[i] = log(power);
             }
-            // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
+            // Take IFFT
+            InverseRealFFT(mWindowSize, in, NULL, out);
 
             // Take real part of result
             for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
-            break;
-
-         case Cepstrum:
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-
-            // Compute log power
-            // Set a sane lower limit assuming maximum time amplitude of 1.0
-            {
-               float power;
-               float minpower = 1e-20*mWindowSize*mWindowSize;
-               for (size_t i = 0; i < mWindowSize; i++)
-               {
-                  power = (out[i] * out[i]) + (out2[i] * out2[i]);
-                  if(power < minpower)
-                     in[i] = log(minpower);
-                  else
-                     in[i] = log(power);
-               }
-               // Take IFFT
-               InverseRealFFT(mWindowSize, in.get(), NULL, out.get());
-
-               // Take real part of result
-               for (size_t i = 0; i < half; i++)
-                  mProcessed[i] += out[i];
-            }
+               mSums[i] += out[i];
+         }
 
-            break;
+         break;
 
-         default:
-            wxASSERT(false);
-            break;
-      }                         //switch
+      default:
+         wxASSERT(false);
+         break;
+   }                         //switch
 
-      // Update the progress bar
-      if (progress) {
-         progress->SetValue(start);
-      }
+   mWindows++;
+}
 
-      start += half;
-      windows++;
-   }
+bool SpectrumAnalyst::Summarize(float *pYMin, float *pYMax)
+{
+   if (mWindows == 0)
+      return false;
 
-   if (progress) {
-      // Reset for next time
-      progress->Reset();
-   }
+   const auto half = mWindowSize / 2;
+   const auto windows = mWindows;
+   mProcessed.assign(mWindowSize, 0.0f);
+   std::copy(mSums.begin(), mSums.end(), mProcessed.begin());
 
    float mYMin = 1000000, mYMax = -1000000;
    double scale;
-   switch (alg) {
+   switch (mAlg) {
    case Spectrum:
       // Convert to decibels
       mYMin = 1000000.;
       mYMax = -1000000.;
-      scale = wss / (double)windows;
+      scale = mWss / (double)windows;
       for (size_t i = 0; i < half; i++)
       {
          mProcessed[i] = 10 * log10(mProcessed[i] * scale);
@@ -270,12 +327,14 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       break;
 
    case EnhancedAutocorrelation:
+   {
       for (size_t i = 0; i < half; i++)
          mProcessed[i] = mProcessed[i] / windows;
 
       // Peak Pruning as described by Tolonen and Karjalainen, 2000
 
       // Clip at zero, copy to temp array
+      const auto out = mOut.get();
       for (size_t i = 0; i < half; i++) {
          if (mProcessed[i] < 0.0)
             mProcessed[i] = float(0.0);
@@ -304,6 +363,7 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
          else if (mProcessed[i] < mYMin)
             mYMin = mProcessed[i];
       break;
+   }
 
    case Cepstrum:
       for (size_t i = 0; i < half; i++)
@@ -14,6 +14,7 @@
 
 #include <vector>
 #include <wx/statusbr.h>
+#include "SampleFormat.h"
 
 class FreqGauge;
 
@@ -42,6 +43,22 @@ public:
       float *pYMin = NULL, float *pYMax = NULL, // outputs
       FreqGauge *progress = NULL);
 
+   //! Begin averaging windows of data given in pieces to Accumulate()
+   //! Return true iff the parameters are valid
+   bool Start(Algorithm alg,
+      int windowFunc, // see FFT.h for values
+      size_t windowSize, double rate);
+
+   //! Analyze more data; successive windows overlap by half, also across
+   //! pieces.  Memory used does not depend on the total length
+   void Accumulate(const float *data, size_t dataLen);
+
+   //! Compute GetProcessed() from the windows accumulated so far, which may
+   //! be continued afterward
+   //! Return true iff at least one window was complete
+   bool Summarize(
+      float *pYMin = NULL, float *pYMax = NULL); // outputs
+
    const float *GetProcessed() const;
    int GetProcessedSize() const;
 
@@ -52,11 +69,21 @@ private:
    float CubicInterpolate(float y0, float y1, float y2, float y3, float x) const;
    float CubicMaximize(float y0, float y1, float y2, float y3, float * max) const;
 
+   void AccumulateWindow();
+
 private:
    Algorithm mAlg;
    double mRate;
    size_t mWindowSize;
    std::vector<float> mProcessed;
+
+   // State of accumulation
+   std::vector<float> mSums;
+   //! Samples not yet analyzed in all windows that contain them
+   std::vector<float> mPending;
+   size_t mWindows{ 0 };
+   double mWss{ 1.0 };
+   Floats mIn, mOut, mOut2, mWin;
 };
 
 class AUDACITY_DLL_API FreqGauge final : public wxStatusBar
@@ -13,6 +13,7 @@ Edward Hui
 #include <algorithm>
 #include "FFT.h"
 #include "WaveTrack.h"
+#include "WindowTable.h"
 
 SpectrumTransformer::SpectrumTransformer( bool needsOutput,
    eWindowFunctions inWindowType,
@@ -46,14 +47,12 @@ SpectrumTransformer::SpectrumTransformer( bool needsOutput,
 
    // Create windows as needed
    if (inWindowType != eWinFuncRectangular) {
-      mInWindow.resize(mWindowSize);
-      std::fill(mInWindow.begin(), mInWindow.end(), 1.0f);
-      NewWindowFunc(inWindowType, mWindowSize, false, mInWindow.data());
+      const auto pTable = GetWindowTable(inWindowType, mWindowSize, false);
+      mInWindow.assign(pTable->begin(), pTable->end());
    }
    if (outWindowType != eWinFuncRectangular) {
-      mOutWindow.resize(mWindowSize);
-      std::fill(mOutWindow.begin(), mOutWindow.end(), 1.0f);
-      NewWindowFunc(outWindowType, mWindowSize, false, mOutWindow.data());
+      const auto pTable = GetWindowTable(outWindowType, mWindowSize, false);
+      mOutWindow.assign(pTable->begin(), pTable->end());
    }
 
    // Must scale one or the other window so overlap-add
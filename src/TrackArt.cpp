@@ -220,6 +220,15 @@ wxRect GetClipAffordanceRect(
 }
 }
 
+bool TrackArt::MeetsClippingBox(wxDC& dc, const wxRect& rect)
+{
+   wxRect box;
+   if (!dc.GetClippingBox(box))
+      return true;
+   // Allow for the frame, which is drawn on the edges of the rectangle
+   return box.Intersects(wxRect{ rect }.Inflate(1, 0));
+}
+
 wxRect TrackArt::DrawClipAffordance(
    wxDC& dc, const wxRect& clipRect, bool highlight, bool selected)
 {
@@ -69,6 +69,12 @@ namespace TrackArt {
 
    AUDACITY_DLL_API
    void DrawSnapLines(wxDC *dc, wxInt64 snap0, wxInt64 snap1);
+
+   //! Whether drawing in rect could change what dc shows, because it meets
+   //! the clipping box, or there is none
+   /*! Lets the drawing of a cell skip the clips outside a partial redraw */
+   AUDACITY_DLL_API
+   bool MeetsClippingBox(wxDC& dc, const wxRect& rect);
 }
 
 extern AUDACITY_DLL_API int GetWaveYPos(float value, float min, float max,
@@ -107,6 +107,8 @@ public:
 #endif //EXPERIMENTAL_FFT_Y_GRID
 
 #ifdef EXPERIMENTAL_FIND_NOTES
+   int gainOld;
+   int rangeOld;
    bool fftFindNotesOld;
    int findNotesMinAOld;
    int findNotesNOld;
@@ -80,6 +80,7 @@ is time to refresh some aspect of the screen.
 #include "TrackArtist.h"
 #include "TrackPanelAx.h"
 #include "TrackPanelResizerCell.h"
+#include "Tracing.h"
 #include "Viewport.h"
 #include "WaveTrack.h"
 
@@ -93,6 +94,7 @@ is time to refresh some aspect of the screen.
 #include "../images/Cursors.h"
 
 #include <algorithm>
+#include <limits>
 
 #include <wx/dc.h>
 #include <wx/dcclient.h>
@@ -454,17 +456,97 @@ void TrackPanel::OnTimer(wxTimerEvent& )
 
       // Periodically update the display while recording
 
-      if ((mTimeCount % 5) == 0) {
-         // Must tell OnPaint() to recreate the backing bitmap
-         // since we've not done a full refresh.
-         mRefreshBacking = true;
-         Refresh( false );
-      }
+      if ((mTimeCount % 5) == 0)
+         RefreshRecording();
    }
+   else
+      mRecordingDrawnEnd.reset();
    if(mTimeCount > 1000)
       mTimeCount = 0;
 }
 
+namespace {
+//! Pixels redrawn left of what was recorded since the last refresh, for the
+//! rounded end of the clip that was drawn there, and right of it
+constexpr int kRecordingStripMargin = TrackArt::ClipFrameRadius + 2;
+}
+
+void TrackPanel::RefreshRecording()
+{
+   // Recording goes into pending replacements of tracks, or into pending new
+   // tracks, which have no id
+   const auto &pendingTracks = PendingTracks::Get(*GetProject());
+   std::vector<WaveTrack*> recording;
+   double end0 = std::numeric_limits<double>::max();
+   double end1 = std::numeric_limits<double>::lowest();
+   for (auto pTrack : GetTracks()->Any<WaveTrack>()) {
+      const auto &track = pendingTracks.SubstitutePendingChangedTrack(*pTrack);
+      if (&track == pTrack && pTrack->GetId() != TrackId{})
+         continue;
+      recording.push_back(pTrack);
+      end0 = std::min(end0, track.GetEndTime());
+      end1 = std::max(end1, track.GetEndTime());
+   }
+
+   const auto drawnEnd = mRecordingDrawnEnd;
+   mRecordingDrawnEnd = recording.empty()
+      ? std::optional<double>{} : std::optional{ end0 };
+   if (!drawnEnd || recording.empty() || end1 < *drawnEnd) {
+      // First refresh, or the recording restarted; draw everything.
+      // Must tell OnPaint() to recreate the backing bitmap
+      // since we've not done a full refresh.
+      mRefreshBacking = true;
+      Refresh( false );
+      return;
+   }
+
+   // Draw again only the strip of the recording tracks that the new samples
+   // cover, and the clip titles and edges above them, which are cheap; the
+   // other tracks and the rest of the recording did not change
+   const auto leftOffset = mViewInfo->GetLeftOffset();
+   const auto x0 =
+      mViewInfo->TimeToPosition(*drawnEnd, leftOffset) - kRecordingStripMargin;
+   const auto x1 =
+      mViewInfo->TimeToPosition(end1, leftOffset) + kRecordingStripMargin;
+   std::vector<wxRect> strips, affordances;
+   for (auto pTrack : recording) {
+      auto rect = FindTrackRect(pTrack);
+      if (rect.IsEmpty())
+         continue;
+      const auto &pAffordance =
+         ChannelView::Get(**pTrack->Channels().begin()).GetAffordanceControls();
+      const auto affordanceRect = pAffordance
+         ? FindRect([&](TrackPanelNode &node){
+               return &node == pAffordance.get(); })
+         : wxRect{};
+      if (!affordanceRect.IsEmpty()) {
+         affordances.push_back(affordanceRect);
+         // The title of a clip would be put within a narrower clip box
+         const auto bottom = rect.GetBottom();
+         rect.SetTop(std::max(rect.GetTop(), affordanceRect.GetBottom() + 1));
+         rect.SetBottom(bottom);
+      }
+      const auto left = static_cast<int>(std::clamp<decltype(x0)>(
+         x0, rect.GetLeft(), rect.GetRight() + 1));
+      const auto right = static_cast<int>(std::clamp<decltype(x1)>(
+         x1, left, rect.GetRight() + 1));
+      rect.SetLeft(left);
+      rect.SetRight(right - 1);
+      if (!rect.IsEmpty())
+         strips.push_back(rect);
+   }
+
+   // Titles last, over the strips
+   wxRect damage;
+   for (auto &rects : { strips, affordances })
+      for (const auto &rect : rects) {
+         mDirtyRects.push_back(rect);
+         damage.Union(rect);
+      }
+   if (!damage.IsEmpty())
+      Refresh(false, &damage);
+}
+
 void TrackPanel::OnSyncLockChange(SyncLockChangeMessage)
 {
    Refresh(false);
@@ -505,6 +587,7 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       {
          // Reset (should a mutex be used???)
          mRefreshBacking = false;
+         mDirtyRects.clear();
 
          // Redraw the backing bitmap
          DrawTracks(&GetBackingDCForRepaint());
@@ -514,6 +597,13 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       }
       else
       {
+         // Redraw only the parts of the backing bitmap that are stale
+         // (See TrackPanel::RefreshRecording())
+         if (!mDirtyRects.empty()) {
+            DrawTracks(&GetBackingDCForRepaint(), mDirtyRects);
+            mDirtyRects.clear();
+         }
+
          // Copy full, possibly clipped, damage rectangle
          RepairBitmap(dc, box.x, box.y, box.width, box.height);
       }
@@ -835,8 +925,9 @@ void TrackPanel::OnAudioIO(AudioIOEvent evt)
 /// Draw the actual track areas.  We only draw the borders
 /// and the little buttons and menues and whatnot here, the
 /// actual contents of each track are drawn by the TrackArtist.
-void TrackPanel::DrawTracks(wxDC * dc)
+void TrackPanel::DrawTracks(wxDC * dc, const std::vector<wxRect> &areas)
 {
+   AUDACITY_TRACE_SCOPE("TrackPanel::DrawTracks");
    wxRegion region = GetUpdateRegion();
 
    const wxRect clip = GetRect();
@@ -878,7 +969,15 @@ void TrackPanel::DrawTracks(wxDC * dc)
    mTrackArtist->onBrushTool = brushFlag;
    mTrackArtist->hasSolo = hasSolo;
 
-   this->CellularPanel::Draw( context, TrackArtist::NPasses );
+   if (areas.empty()) {
+      this->CellularPanel::Draw( context, TrackArtist::NPasses );
+      return;
+   }
+   // Later areas are drawn over earlier ones
+   for (const auto &area : areas) {
+      wxDCClipper clipper{ *dc, area };
+      this->CellularPanel::Draw( context, TrackArtist::NPasses, area );
+   }
 }
 
 void TrackPanel::SetBackgroundCell
@@ -12,6 +12,7 @@
 #define __AUDACITY_TRACK_PANEL__
 
 #include <chrono>
+#include <optional>
 #include <vector>
 
 #include <wx/setup.h> // for wxUSE_* macros
@@ -166,7 +167,10 @@ public:
    AdornedRulerPanel * GetRuler(){ return mRuler;}
 
 protected:
-   void DrawTracks(wxDC * dc);
+   //! Draw all, or else only the given areas of the panel, in order
+   void DrawTracks(wxDC * dc, const std::vector<wxRect> &areas = {});
+   //! Invalidate what recording changed since the last call
+   void RefreshRecording();
 
 public:
    // Set the object that performs catch-all event handling when the pointer
@@ -213,6 +217,10 @@ protected:
    int mTimeCount;
 
    bool mRefreshBacking;
+   //! Parts of the backing bitmap to draw again at the next paint, if not all
+   std::vector<wxRect> mDirtyRects;
+   //! How much of the recording the backing bitmap shows, while recording
+   std::optional<double> mRecordingDrawnEnd;
 
 
 protected:
@@ -15,6 +15,7 @@
 #include "AudioIO.h"
 #include "AudioIOSequences.h"
 #include "CommandContext.h"
+#include "FrozenTracks.h"
 #include "Project.h"
 #include "ProjectAudioIO.h"
 #include "ProjectAudioManager.h"
@@ -212,9 +213,18 @@ TransportSequences MakeTransportTracks(
    {
       const auto range = trackList.Any<WaveTrack>()
          + (selectedOnly ? &Track::IsSelected : &Track::Any);
-      for (auto pTrack : range)
+      const auto pProject = trackList.GetOwner();
+      for (auto pTrack : range) {
+         // Play the rendering of a frozen track while it is up to date
+         if (auto pFrozen = pProject
+            ? FrozenTracks::Get(*pProject).Find(*pTrack) : nullptr
+         ) {
+            result.playbackSequences.push_back(move(pFrozen));
+            continue;
+         }
          result.playbackSequences.push_back(
             StretchingSequence::Create(*pTrack, pTrack->GetClipInterfaces()));
+      }
    }
    if (nonWaveToo) {
       const auto range = trackList.Any<const PlayableTrack>() +
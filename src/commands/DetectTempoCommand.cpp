@@ -0,0 +1,190 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DetectTempoCommand.cpp
+
+**********************************************************************/
+#include "DetectTempoCommand.h"
+
+#include "../ClipMirAudioReader.h"
+#include "../CommonCommandFlags.h"
+#include "CodeConversions.h"
+#include "CommandContext.h"
+#include "CommandDispatch.h"
+#include "LoadCommands.h"
+#include "MenuRegistry.h"
+#include "MusicInformationRetrieval.h"
+#include "ProjectHistory.h"
+#include "SettingsVisitor.h"
+#include "ShuttleGui.h"
+#include "UserException.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+
+const ComponentInterfaceSymbol DetectTempoCommand::Symbol { XO(
+   "Detect Tempo") };
+
+namespace
+{
+BuiltinCommandsModule::Registration<DetectTempoCommand> reg;
+
+enum kTolerances
+{
+   kStrict,
+   kLenient,
+   nTolerances
+};
+
+// Lenient is what imports use in the beats-and-measures view
+const EnumValueSymbol kToleranceStrings[nTolerances] = {
+   { wxT("Strict"), XO("Strict") },
+   { wxT("Lenient"), XO("Lenient") },
+};
+
+wxString GetMethodName(MIR::TempoObtainedFrom method)
+{
+   switch (method)
+   {
+   case MIR::TempoObtainedFrom::Header:
+      return wxT("header");
+   case MIR::TempoObtainedFrom::Title:
+      return wxT("title");
+   case MIR::TempoObtainedFrom::Signal:
+   default:
+      return wxT("signal");
+   }
+}
+} // namespace
+
+template <bool Const>
+bool DetectTempoCommand::VisitSettings(SettingsVisitorBase<Const>& S)
+{
+   S.OptionalN(bHasContainsTime)
+      .Define(mContainsTime, wxT("At"), 0.0, 0.0, 100000.0);
+   S.DefineEnum(
+      mTolerance, wxT("Tolerance"), kStrict, kToleranceStrings, nTolerances);
+   return true;
+}
+
+bool DetectTempoCommand::VisitSettings(SettingsVisitor& S)
+{
+   return VisitSettings<false>(S);
+}
+
+bool DetectTempoCommand::VisitSettings(ConstSettingsVisitor& S)
+{
+   return VisitSettings<true>(S);
+}
+
+void DetectTempoCommand::PopulateOrExchange(ShuttleGui& S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(3, wxALIGN_CENTER);
+   {
+      S.Optional(bHasContainsTime)
+         .TieNumericTextBox(XXO("At:"), mContainsTime);
+      S.AddSpace(0, 0);
+      S.TieChoice(
+         XXO("Tolerance:"), mTolerance,
+         Msgids(kToleranceStrings, nTolerances));
+   }
+   S.EndMultiColumn();
+}
+
+bool DetectTempoCommand::Apply(const CommandContext& context)
+{
+   // If no 'At' is specified, all clips of the selected tracks are analyzed.
+   std::vector<std::shared_ptr<ClipMirAudioReader>> readers;
+   std::vector<int> trackIndices;
+   auto iTrack = 0;
+   for (const auto track : TrackList::Get(context.project))
+   {
+      if (track->GetSelected())
+         track->TypeSwitch([&](WaveTrack& waveTrack) {
+            for (const auto& interval : waveTrack.Intervals())
+               if (
+                  !bHasContainsTime || (interval->Start() <= mContainsTime &&
+                                        interval->End() >= mContainsTime))
+               {
+                  // The clip name is the file name, for imported files, and
+                  // may tell the tempo
+                  readers.push_back(std::make_shared<ClipMirAudioReader>(
+                     std::nullopt, audacity::ToUTF8(interval->GetName()),
+                     interval));
+                  trackIndices.push_back(iTrack);
+               }
+         });
+      // Numbering counts all tracks, as GetInfo does
+      ++iTrack;
+   }
+   if (readers.empty())
+   {
+      context.Status(wxT("No clip to analyze"));
+      return true;
+   }
+
+   // Analyzed as for an import into an empty project; the project tempo only
+   // matters to the stretching that an import recommends, unused here.
+   std::vector<std::optional<MIR::ProjectSyncInfo>> syncInfos;
+   try
+   {
+      syncInfos = GetSyncInfosInParallel(
+         readers, XO("Detecting the tempo of clips"), 120., true,
+         mTolerance == kLenient);
+   }
+   catch (const UserException&)
+   {
+      return false;
+   }
+
+   bool changed = false;
+   context.StartArray();
+   for (size_t ii = 0; ii < readers.size(); ++ii)
+   {
+      const auto& clip = *readers[ii]->clip;
+      context.StartStruct();
+      context.AddItem(static_cast<double>(trackIndices[ii]), "track");
+      context.AddItem(clip.GetPlayStartTime(), "start");
+      context.AddItem(clip.GetName(), "name");
+      if (const auto& syncInfo = syncInfos[ii])
+      {
+         readers[ii]->clip->SetRawAudioTempo(syncInfo->rawAudioTempo);
+         changed = true;
+         context.AddItem(syncInfo->rawAudioTempo, "tempo");
+         if (syncInfo->timeSignature)
+            context.AddItem(
+               wxString::Format(
+                  wxT("%d/%d"), MIR::GetNumerator(*syncInfo->timeSignature),
+                  MIR::GetDenominator(*syncInfo->timeSignature)),
+               "meter");
+         context.AddItem(GetMethodName(syncInfo->usedMethod), "method");
+      }
+      context.EndStruct();
+   }
+   context.EndArray();
+
+   if (changed)
+      ProjectHistory::Get(context.project)
+         .PushState(XO("Detected Tempo"), XO("Detect Tempo"));
+
+   return true;
+}
+
+namespace
+{
+using namespace MenuRegistry;
+
+// Register menu items
+
+AttachedItem sAttachment1 {
+   // Note that the PLUGIN_SYMBOL must have a space between words,
+   // whereas the short-form used here must not.
+   Command(
+      wxT("DetectTempo"), XXO("Detect Tempo..."),
+      CommandDispatch::OnAudacityCommand, AudioIONotBusyFlag()),
+   wxT("Optional/Extra/Part2/Scriptables1")
+};
+} // namespace
@@ -0,0 +1,43 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DetectTempoCommand.h
+
+**********************************************************************/
+#pragma once
+
+#include "Command.h"
+#include "CommandType.h"
+
+//! Detects the tempo and meter of the clips of the selected wave tracks, in
+//! parallel, and sets the tempo of each clip that has one
+class DetectTempoCommand final : public AudacityCommand
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() const override { return Symbol; }
+   TranslatableString GetDescription() const override
+   {
+      return XO("Detects the tempo and meter of clips, such as loops.");
+   }
+   template <bool Const> bool VisitSettings(SettingsVisitorBase<Const>& S);
+   bool VisitSettings(SettingsVisitor& S) override;
+   bool VisitSettings(ConstSettingsVisitor& S) override;
+   void PopulateOrExchange(ShuttleGui& S) override;
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override
+   {
+      return L"Extra_Menu:_Scriptables_I#detect_tempo";
+   }
+   bool Apply(const CommandContext& context) override;
+
+private:
+   double mContainsTime { 0. };
+   bool bHasContainsTime { false };
+   int mTolerance { 0 };
+};
@@ -43,7 +43,11 @@ This class now lists
 #include "../LabelTrack.h"
 #include "NoteTrack.h"
 #include "TimeTrack.h"
+#include "EffectProfiler.h"
 #include "Envelope.h"
+#include "MemoryAccounting.h"
+#include "DBConnection.h"
+#include "../DropoutDetector.h"
 #include "ProjectAudioIO.h"
 #include "AudioIO.h"
 
@@ -76,6 +80,9 @@ enum {
    kLabels,
    kBoxes,
    kSelection,
+   kEffectsProfile,
+   kMemory,
+   kPerformance,
    nTypes
 };
 
@@ -91,6 +98,9 @@ static const EnumValueSymbol kTypes[nTypes] =
    { XO("Labels") },
    { XO("Boxes") },
    { XO("Selection") },
+   { wxT("EffectsProfile"), XO("Effects Profile") },
+   { XO("Memory") },
+   { XO("Performance") },
 };
 
 enum {
@@ -177,6 +187,9 @@ bool GetInfoCommand::ApplyInner(const CommandContext &context)
       case kLabels       : return SendLabels( context );
       case kBoxes        : return SendBoxes( context );
       case kSelection    : return SendSelection( context );
+      case kEffectsProfile : return SendEffectsProfile( context );
+      case kMemory       : return SendMemory( context );
+      case kPerformance  : return SendPerformance( context );
       default:
          context.Status( "Command options not recognised" );
    }
@@ -645,6 +658,86 @@ bool GetInfoCommand::SendSelection(const CommandContext &context)
    return true;
 }
 
+/**
+ Send the time spent in each effect instance, realtime or not, since the
+ last report.
+ */
+bool GetInfoCommand::SendEffectsProfile(const CommandContext &context)
+{
+   auto &profiler = EffectProfiler::Get();
+   context.StartArray();
+   for (const auto &statistics : profiler.GetStatistics()) {
+      context.StartStruct();
+      context.AddItem(statistics.name, "name");
+      context.AddBool(statistics.realtime, "realtime");
+      context.AddItem((double)statistics.blocks, "blocks");
+      context.AddItem((double)statistics.samples, "samples");
+      context.AddItem(statistics.totalSeconds, "total");
+      context.AddItem(statistics.blocks > 0
+         ? statistics.totalSeconds / statistics.blocks : 0.0, "mean");
+      context.AddItem(statistics.peakSeconds, "peak");
+      context.AddItem((double)statistics.deadlineMisses, "misses");
+      context.EndStruct();
+   }
+   context.EndArray();
+   // Finished instances are reported once only
+   profiler.Reset();
+   return true;
+}
+
+bool GetInfoCommand::SendMemory(const CommandContext &context)
+{
+   using namespace MemoryAccounting;
+   if (!IsEnabled()) {
+      context.Status(wxT("Memory accounting is not enabled"));
+      return true;
+   }
+   context.StartArray();
+   for (unsigned ii = 0; ii < static_cast<unsigned>(Tag::nTags); ++ii) {
+      const auto tag = static_cast<Tag>(ii);
+      const auto totals = GetTotals(tag);
+      context.StartStruct();
+      context.AddItem(wxString{ GetName(tag) }, "name");
+      context.AddItem((double)totals.bytes, "bytes");
+      context.AddItem((double)totals.peakBytes, "peak");
+      context.AddItem((double)totals.objects, "objects");
+      context.EndStruct();
+   }
+   context.EndArray();
+   return true;
+}
+
+/**
+ Send counters of the process and of the project, for comparison of the
+ same scripted work in different versions: peak resident memory, recording
+ dropouts, and the page cache and checkpoints of the project database.
+ */
+bool GetInfoCommand::SendPerformance(const CommandContext &context)
+{
+   auto &project = context.project;
+   context.StartStruct();
+   context.AddItem(
+      (double)MemoryAccounting::GetPeakProcessBytes(), "peakBytes");
+
+   const auto dropouts = DropoutDetector::GetStatistics(project);
+   context.AddItem((double)dropouts.dropouts, "dropouts");
+   context.AddItem(dropouts.lostSeconds, "lostSeconds");
+
+   if (const auto &pConnection = ConnectionPtr::Get(project).mpConnection) {
+      const auto io = pConnection->GetIOStatistics();
+      context.AddItem((double)io.cacheHits, "cacheHits");
+      context.AddItem((double)io.cacheMisses, "cacheMisses");
+      context.AddItem((double)io.pagesWritten, "pagesWritten");
+      const auto checkpoints = pConnection->GetCheckpointStatistics();
+      context.AddItem((double)checkpoints.count, "checkpoints");
+      context.AddItem(checkpoints.totalSeconds, "checkpointSeconds");
+      context.AddItem(checkpoints.maxSeconds, "longestCheckpoint");
+      context.AddItem((double)checkpoints.walBytes, "walBytes");
+   }
+   context.EndStruct();
+   return true;
+}
+
 /*******************************************************************
 The various Explore functions are called from the Send functions,
 and may be recursive.  'Send' is the top level.
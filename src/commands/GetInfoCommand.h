@@ -58,6 +58,9 @@ private:
    bool SendEnvelopes(const CommandContext & context);
    bool SendBoxes(const CommandContext & context);
    bool SendSelection(const CommandContext & context);
+   bool SendEffectsProfile(const CommandContext & context);
+   bool SendMemory(const CommandContext & context);
+   bool SendPerformance(const CommandContext & context);
 
    void ExploreMenu( const CommandContext &context, wxMenu * pMenu, int Id, int depth );
    void ExploreTrackPanel( const CommandContext & context,
@@ -21,7 +21,9 @@
 #include "EffectOutputTracks.h"
 #include "LoadEffects.h"
 #include "UserException.h"
+#include "concurrency/TaskScheduler.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include <wx/dcclient.h>
@@ -34,6 +36,7 @@
 #include "Theme.h"
 #include "../widgets/valnum.h"
 
+#include "WaveChannelUtilities.h"
 #include "WaveClip.h"
 #include "WaveTrack.h"
 #include "TimeStretching.h"
@@ -241,64 +244,104 @@ bool EffectAutoDuck::Process(EffectInstance &, EffectSettings &)
       double duckRegionStart = 0;
       sampleCount curSamplesPause = 0;
 
-      auto pos = start;
-
       const auto pControlChannel = *pControlTrack->Channels().begin();
-      while (pos < end)
-      {
-         const auto len = limitSampleBufferSize( kBufSize, end - pos );
 
-         pControlChannel->GetFloats(buf.get(), pos, len);
+      const auto step = [&](sampleCount i, float value) {
+         rmsSum -= rmsWindow[rmsPos];
+         rmsWindow[rmsPos] = value * value;
+         rmsSum += rmsWindow[rmsPos];
+         rmsPos = (rmsPos + 1) % kRMSWindowSize;
 
-         for (auto i = pos; i < pos + len; i++)
-         {
-            rmsSum -= rmsWindow[rmsPos];
-            // i - pos is bounded by len:
-            auto index = ( i - pos ).as_size_t();
-            rmsWindow[rmsPos] = buf[ index ] * buf[ index ];
-            rmsSum += rmsWindow[rmsPos];
-            rmsPos = (rmsPos + 1) % kRMSWindowSize;
+         bool thresholdExceeded = rmsSum > threshold;
 
-            bool thresholdExceeded = rmsSum > threshold;
+         if (thresholdExceeded)
+         {
+            // everytime the threshold is exceeded, reset our count for
+            // the number of pause samples
+            curSamplesPause = 0;
 
-            if (thresholdExceeded)
+            if (!inDuckRegion)
             {
-               // everytime the threshold is exceeded, reset our count for
-               // the number of pause samples
-               curSamplesPause = 0;
-
-               if (!inDuckRegion)
-               {
-                  // the threshold has been exceeded for the first time, so
-                  // let the duck region begin here
-                  inDuckRegion = true;
-                  duckRegionStart = pControlTrack->LongSamplesToTime(i);
-               }
+               // the threshold has been exceeded for the first time, so
+               // let the duck region begin here
+               inDuckRegion = true;
+               duckRegionStart = pControlTrack->LongSamplesToTime(i);
             }
+         }
+
+         if (!thresholdExceeded && inDuckRegion)
+         {
+            // the threshold has not been exceeded and we are in a duck
+            // region, but only fade in if the maximum pause has been
+            // exceeded
+            curSamplesPause += 1;
 
-            if (!thresholdExceeded && inDuckRegion)
+            if (curSamplesPause >= minSamplesPause)
             {
-               // the threshold has not been exceeded and we are in a duck
-               // region, but only fade in if the maximum pause has been
-               // exceeded
-               curSamplesPause += 1;
-
-               if (curSamplesPause >= minSamplesPause)
-               {
-                  // do the actual duck fade and reset all values
-                  double duckRegionEnd =
-                     pControlTrack->LongSamplesToTime(i - curSamplesPause);
-
-                  regions.push_back(AutoDuckRegion(
-                     duckRegionStart - mOuterFadeDownLen,
-                     duckRegionEnd + mOuterFadeUpLen));
-
-                  inDuckRegion = false;
-               }
+               // do the actual duck fade and reset all values
+               double duckRegionEnd =
+                  pControlTrack->LongSamplesToTime(i - curSamplesPause);
+
+               regions.push_back(AutoDuckRegion(
+                  duckRegionStart - mOuterFadeDownLen,
+                  duckRegionEnd + mOuterFadeUpLen));
+
+               inDuckRegion = false;
             }
          }
+      };
 
-         pos += len;
+      const auto read = [&](sampleCount pos, size_t len) {
+         pControlChannel->GetFloats(buf.get(), pos, len);
+         for (size_t ii = 0; ii < len; ++ii)
+            step(pos + ii, buf[ii]);
+      };
+
+      // Same as step() for count samples from i, none exceeding the
+      // threshold, leaving rmsWindow stale
+      const auto skip = [&](sampleCount i, sampleCount count) {
+         if (!inDuckRegion)
+            return;
+         const auto needed =
+            std::max<sampleCount>(1, minSamplesPause - curSamplesPause);
+         if (count < needed) {
+            curSamplesPause += count;
+            return;
+         }
+         curSamplesPause += needed;
+         double duckRegionEnd = pControlTrack->LongSamplesToTime(
+            i + needed - 1 - curSamplesPause);
+         regions.push_back(AutoDuckRegion(
+            duckRegionStart - mOuterFadeDownLen,
+            duckRegionEnd + mOuterFadeUpLen));
+         inDuckRegion = false;
+      };
+
+      // Where all of a window is quieter than this, so is its RMS
+      const auto quietLevel = static_cast<float>(DB_TO_LINEAR(mThresholdDb));
+
+      auto pos = start;
+      while (pos < end)
+      {
+         // The block summaries find long quiet stretches without reading
+         // them.  Step through a window's worth at each end of the stretch,
+         // so that the windows that overlap louder samples are exact, and
+         // so that rmsWindow is again up to date.
+         const auto quiet = WaveChannelUtilities::GetQuietLength(
+            *pControlChannel, pos, end - pos, quietLevel);
+         if (quiet > 2 * kRMSWindowSize) {
+            read(pos, kRMSWindowSize);
+            skip(pos + kRMSWindowSize, quiet - 2 * kRMSWindowSize);
+            std::fill(rmsWindow.get(), rmsWindow.get() + kRMSWindowSize, 0);
+            rmsSum = 0;
+            read(pos + quiet - kRMSWindowSize, kRMSWindowSize);
+            pos += quiet;
+         }
+         else {
+            const auto len = limitSampleBufferSize( kBufSize, end - pos );
+            read(pos, len);
+            pos += len;
+         }
 
          if (TotalProgress(
             (pos - start).as_double() /
@@ -325,23 +368,7 @@ bool EffectAutoDuck::Process(EffectInstance &, EffectSettings &)
    if (!cancel) {
       EffectOutputTracks outputs { *mTracks, GetType(), { { mT0, mT1 } } };
 
-      int trackNum = 0;
-
-      for (auto iterTrack : outputs.Get().Selected<WaveTrack>()) {
-         for (const auto pChannel : iterTrack->Channels())
-            for (size_t i = 0; i < regions.size(); ++i) {
-               const AutoDuckRegion& region = regions[i];
-               if (ApplyDuckFade(trackNum++, *pChannel, region.t0, region.t1)) {
-                  cancel = true;
-                  goto done;
-               }
-            }
-
-         done:
-         if (cancel)
-            break;
-      }
-
+      cancel = !ApplyDuckFades(outputs.Get(), regions);
       if (!cancel)
          outputs.Commit();
    }
@@ -455,18 +482,74 @@ bool EffectAutoDuck::TransferDataFromWindow(EffectSettings &)
 
 // EffectAutoDuck implementation
 
-// this currently does an exponential fade
-bool EffectAutoDuck::ApplyDuckFade(int trackNum, WaveChannel &track,
-   double t0, double t1)
+bool EffectAutoDuck::ApplyDuckFades(
+   TrackList &tracks, const std::vector<AutoDuckRegion> &regions)
 {
-   bool cancel = false;
+   using namespace audacity::concurrency;
+
+   // Divide the regions of all channels into chunks, each read and faded in
+   // a worker thread, then written in order in this thread
+   struct Chunk {
+      WaveChannel &channel;
+      sampleCount start, end; // of the region
+      sampleCount pos;
+      size_t len;
+   };
+   std::vector<Chunk> chunks;
+   double totalLen = 0;
+   for (auto pTrack : tracks.Selected<WaveTrack>())
+      for (const auto pChannel : pTrack->Channels())
+         // The regions don't overlap, each beginning at least the maximum
+         // pause after the end of the previous
+         for (const auto &region : regions) {
+            const auto start = pChannel->TimeToLongSamples(region.t0);
+            const auto end = pChannel->TimeToLongSamples(region.t1);
+            for (auto pos = start; pos < end;) {
+               const auto len = limitSampleBufferSize(kBufSize, end - pos);
+               chunks.push_back({ *pChannel, start, end, pos, len });
+               pos += len;
+               totalLen += len;
+            }
+         }
 
-   auto start = track.TimeToLongSamples(t0);
-   auto end = track.TimeToLongSamples(t1);
+   const auto batchSize = 2 * TaskScheduler::Get().ThreadCount();
+   std::vector<Floats> buffers(batchSize);
+   for (auto &buffer : buffers)
+      buffer.reinit(kBufSize);
+   double doneLen = 0;
+   for (size_t first = 0; first < chunks.size(); first += batchSize) {
+      const auto count = std::min(batchSize, chunks.size() - first);
+      TaskGroup group;
+      for (size_t ii = 0; ii < count; ++ii)
+         group.Run([&, ii]{
+            const auto &chunk = chunks[first + ii];
+            const auto buf = buffers[ii].get();
+            chunk.channel.GetFloats(buf, chunk.pos, chunk.len);
+            ApplyDuckFade(
+               chunk.channel, chunk.start, chunk.end, chunk.pos, buf, chunk.len);
+         });
+      group.Wait();
+
+      for (size_t ii = 0; ii < count; ++ii) {
+         const auto &chunk = chunks[first + ii];
+         if (!chunk.channel.SetFloats(buffers[ii].get(), chunk.pos, chunk.len))
+            return false;
+         doneLen += chunk.len;
+         if (TotalProgress((1 + GetNumWaveTracks() * doneLen / totalLen) /
+            (GetNumWaveTracks() + 1))
+         )
+            return false;
+      }
+   }
 
-   Floats buf{ kBufSize };
-   auto pos = start;
+   return true;
+}
 
+// this currently does an exponential fade
+void EffectAutoDuck::ApplyDuckFade(const WaveChannel &track,
+   sampleCount start, sampleCount end, sampleCount pos, float *buf, size_t len)
+   const
+{
    auto fadeDownSamples = track.TimeToLongSamples(
       mOuterFadeDownLen + mInnerFadeDownLen);
    if (fadeDownSamples < 1)
@@ -480,43 +563,21 @@ bool EffectAutoDuck::ApplyDuckFade(int trackNum, WaveChannel &track,
    float fadeDownStep = mDuckAmountDb / fadeDownSamples.as_double();
    float fadeUpStep = mDuckAmountDb / fadeUpSamples.as_double();
 
-   while (pos < end) {
-      const auto len = limitSampleBufferSize(kBufSize, end - pos);
-      track.GetFloats(buf.get(), pos, len);
-      for (auto i = pos; i < pos + len; ++i) {
-         float gainDown = fadeDownStep * (i - start).as_float();
-         float gainUp = fadeUpStep * (end - i).as_float();
-
-         float gain;
-         if (gainDown > gainUp)
-            gain = gainDown;
-         else
-            gain = gainUp;
-         if (gain < mDuckAmountDb)
-            gain = mDuckAmountDb;
-
-         // i - pos is bounded by len:
-         buf[ ( i - pos ).as_size_t() ] *= DB_TO_LINEAR(gain);
-      }
-
-      if (!track.SetFloats(buf.get(), pos, len)) {
-         cancel = true;
-         break;
-      }
+   for (auto i = pos; i < pos + len; ++i) {
+      float gainDown = fadeDownStep * (i - start).as_float();
+      float gainUp = fadeUpStep * (end - i).as_float();
 
-      pos += len;
+      float gain;
+      if (gainDown > gainUp)
+         gain = gainDown;
+      else
+         gain = gainUp;
+      if (gain < mDuckAmountDb)
+         gain = mDuckAmountDb;
 
-      float curTime = track.LongSamplesToTime(pos);
-      float fractionFinished = (curTime - mT0) / (mT1 - mT0);
-      if (TotalProgress((trackNum + 1 + fractionFinished) /
-         (GetNumWaveTracks() + 1))
-      ) {
-         cancel = true;
-         break;
-      }
+      // i - pos is bounded by len:
+      buf[ ( i - pos ).as_size_t() ] *= DB_TO_LINEAR(gain);
    }
-
-   return cancel;
 }
 
 void EffectAutoDuck::OnValueChanged(wxCommandEvent & WXUNUSED(evt))
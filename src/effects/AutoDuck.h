@@ -14,12 +14,16 @@
 #include "StatefulEffect.h"
 #include "ShuttleAutomation.h"
 #include <float.h> // for DBL_MAX
+#include <vector>
+#include "SampleCount.h"
 #include "wxPanelWrapper.h"
 
 class wxBitmap;
 class wxTextCtrl;
 class ShuttleGui;
+class TrackList;
 class WaveChannel;
+struct AutoDuckRegion;
 
 #define AUTO_DUCK_PANEL_NUM_CONTROL_POINTS 5
 
@@ -57,7 +61,14 @@ public:
 private:
    // EffectAutoDuck implementation
 
-   bool ApplyDuckFade(int trackNum, WaveChannel &track, double t0, double t1);
+   //! Fade all selected channels of tracks in all regions
+   //! @return false if cancelled
+   bool ApplyDuckFades(
+      TrackList &tracks, const std::vector<AutoDuckRegion> &regions);
+   //! Fade len samples from pos, read into buf, of the region from start to
+   //! end; may be called in any thread
+   void ApplyDuckFade(const WaveChannel &track, sampleCount start,
+      sampleCount end, sampleCount pos, float *buf, size_t len) const;
 
    void OnValueChanged(wxCommandEvent & evt);
 
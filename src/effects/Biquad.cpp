@@ -12,6 +12,7 @@ Max Maisel
 #include "Biquad.h"
 
 #include <cmath>
+#include <utility>
 #include <wx/utils.h>
 
 #define square(a) ((a)*(a))
@@ -41,6 +42,15 @@ void Biquad::Process(const float* pfIn, float* pfOut, int iNumSamples)
       *pfOut++ = ProcessOne(*pfIn++);
 }
 
+BiquadCascade Biquad::MakeCascade(
+   const Biquad *pBiquads, size_t nBiquads, size_t nChannels)
+{
+   std::vector<BiquadCascade::Section> sections;
+   for (size_t i = 0; i < nBiquads; ++i)
+      sections.push_back(pBiquads[i].GetSection());
+   return { std::move(sections), nChannels };
+}
+
 const double Biquad::s_fChebyCoeffs[MAX_Order][MAX_Order + 1] =
 {
    // For Chebyshev polynomials of the first kind (see http://en.wikipedia.org/wiki/Chebyshev_polynomial)
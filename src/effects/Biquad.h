@@ -12,6 +12,7 @@ Max Maisel
 #ifndef __BIQUAD_H__
 #define __BIQUAD_H__
 
+#include "BiquadCascade.h"
 #include "MemoryX.h"
 
 /// \brief Represents a biquad digital filter.
@@ -49,6 +50,17 @@ struct Biquad
       return fOut;
    }
 
+   //! The coefficients, as a section of a BiquadCascade
+   BiquadCascade::Section GetSection() const
+   {
+      return { fNumerCoeffs[B0], fNumerCoeffs[B1], fNumerCoeffs[B2],
+         fDenomCoeffs[A1], fDenomCoeffs[A2] };
+   }
+   //! Filter that applies the biquads in order to each of nChannels, faster
+   //! than a series of Process() calls for each channel
+   static BiquadCascade MakeCascade(
+      const Biquad *pBiquads, size_t nBiquads, size_t nChannels);
+
    double fNumerCoeffs[3]; // B0 B1 B2
    double fDenomCoeffs[2]; // A1 A2, A0 == 1.0
    double fPrevIn;
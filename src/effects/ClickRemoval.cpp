@@ -39,6 +39,9 @@
 #include "../widgets/valnum.h"
 
 #include "WaveTrack.h"
+#include "concurrency/TaskScheduler.h"
+
+#include <vector>
 
 enum
 {
@@ -158,47 +161,88 @@ bool EffectClickRemoval::ProcessOne(
       return false;
    }
 
+   using namespace audacity::concurrency;
+
    auto idealBlockLen = track.GetMaxBlockSize() * 4;
    if (idealBlockLen % windowSize != 0)
       idealBlockLen += (windowSize - (idealBlockLen % windowSize));
 
+   // Blocks are independent, so a batch of them is done in parallel, then
+   // stored in order in this thread
+   struct Block {
+      explicit Block(size_t size) : buffer{ size } {}
+      Floats buffer;
+      sampleCount s;
+      size_t len;
+      bool changed;
+   };
+   std::vector<Block> blocks;
+   const auto batchSize = 2 * TaskScheduler::Get().ThreadCount();
+   for (size_t ii = 0; ii < batchSize; ++ii)
+      blocks.emplace_back(idealBlockLen);
+
    bool bResult = true;
    decltype(len) s = 0;
-   Floats buffer{ idealBlockLen };
-   Floats datawindow{ windowSize };
-   while ((len - s) > windowSize / 2) {
-      auto block = limitSampleBufferSize(idealBlockLen, len - s);
-      track.GetFloats(buffer.get(), start + s, block);
-      for (decltype(block) i = 0;
-           i + windowSize / 2 < block; i += windowSize / 2
-      ) {
-         auto wcopy = std::min(windowSize, block - i);
-         for (decltype(wcopy) j = 0; j < wcopy; ++j)
-            datawindow[j] = buffer[i + j];
-         for (auto j = wcopy; j < windowSize; ++j)
-            datawindow[j] = 0;
-         mbDidSomething |= RemoveClicks(windowSize, datawindow.get());
-         for (decltype(wcopy) j = 0; j < wcopy; ++j)
-           buffer[i+j] = datawindow[j];
+   while (bResult && (len - s) > windowSize / 2) {
+      size_t nBlocks = 0;
+      for (; nBlocks < batchSize && (len - s) > windowSize / 2; ++nBlocks) {
+         auto &block = blocks[nBlocks];
+         block.s = s;
+         block.len = limitSampleBufferSize(idealBlockLen, len - s);
+         s += block.len;
       }
 
-      if (mbDidSomething) {
-         // RemoveClicks() actually did something.
-         if(!track.SetFloats(buffer.get(), start + s, block)) {
+      {
+         TaskGroup group;
+         for (size_t ii = 0; ii < nBlocks; ++ii)
+            group.Run([&, &block = blocks[ii]]{
+               track.GetFloats(block.buffer.get(), start + block.s, block.len);
+               block.changed = ProcessBlock(block.buffer.get(), block.len);
+            });
+         group.Wait();
+      }
+
+      for (size_t ii = 0; ii < nBlocks; ++ii) {
+         const auto &block = blocks[ii];
+         if (block.changed) {
+            // RemoveClicks() actually did something.
+            mbDidSomething = true;
+            if(!track.SetFloats(
+               block.buffer.get(), start + block.s, block.len)) {
+               bResult = false;
+               break;
+            }
+         }
+         if (TrackProgress(count,
+            (block.s + block.len).as_double() / len.as_double())) {
             bResult = false;
             break;
          }
       }
-      s += block;
-      if (TrackProgress(count, s.as_double() / len.as_double())) {
-         bResult = false;
-         break;
-      }
    }
    return bResult;
 }
 
-bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
+bool EffectClickRemoval::ProcessBlock(float *buffer, size_t block) const
+{
+   bool bResult = false;
+   Floats datawindow{ windowSize };
+   for (decltype(block) i = 0;
+        i + windowSize / 2 < block; i += windowSize / 2
+   ) {
+      auto wcopy = std::min(windowSize, block - i);
+      for (decltype(wcopy) j = 0; j < wcopy; ++j)
+         datawindow[j] = buffer[i + j];
+      for (auto j = wcopy; j < windowSize; ++j)
+         datawindow[j] = 0;
+      bResult |= RemoveClicks(windowSize, datawindow.get());
+      for (decltype(wcopy) j = 0; j < wcopy; ++j)
+        buffer[i+j] = datawindow[j];
+   }
+   return bResult;
+}
+
+bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer) const
 {
    bool bResult = false; // This effect usually does nothing.
    size_t i;
@@ -207,6 +251,12 @@ bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
 
    float msw;
    int ww;
+   /* Cheat by rounding sep up to a power of two, as the running sums below
+    * do...
+    */
+   int sep = 1;
+   while (sep < this->sep)
+      sep *= 2;
    int s2 = sep/2;
    Floats ms_seq{ len };
    Floats b2{ len };
@@ -225,9 +275,6 @@ bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
          ms_seq[j] += ms_seq[j+i];
    }
 
-   /* Cheat by truncating sep to next-lower power of two... */
-   sep = i;
-
    for( i=0; i<len-sep; i++ ) {
       ms_seq[i] /= sep;
    }
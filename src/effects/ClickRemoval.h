@@ -60,7 +60,10 @@ private:
    bool ProcessOne(int count, WaveChannel &track,
       sampleCount start, sampleCount len);
 
-   bool RemoveClicks(size_t len, float *buffer);
+   //! Remove clicks in overlapping windows of a block of samples; may be
+   //! called in several threads at once
+   bool ProcessBlock(float *buffer, size_t block) const;
+   bool RemoveClicks(size_t len, float *buffer) const;
 
    void OnWidthText(wxCommandEvent & evt);
    void OnThreshText(wxCommandEvent & evt);
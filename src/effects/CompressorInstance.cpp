@@ -27,6 +27,8 @@ CompressorInstance::CompressorInstance(CompressorInstance&& other)
     , mSampleRate { std::move(other.mSampleRate) }
     , mOutputQueue { std::move(other.mOutputQueue) }
     , mCompressionValueQueue { std::move(other.mCompressionValueQueue) }
+    , mOutputWriter { std::move(other.mOutputWriter) }
+    , mCompressionValueWriter { std::move(other.mCompressionValueWriter) }
 {
 }
 
@@ -74,6 +76,12 @@ bool CompressorInstance::ProcessFinalize() noexcept
 
 namespace
 {
+// Least durations of the items sent to the panels: well below the periods at
+// which these read them, so that no read finds nothing, but long enough to
+// spare them an item per block when blocks are small.
+constexpr auto minOutputPacketMs = 5;
+constexpr auto minMeterValuesMs = compressorMeterUpdatePeriodMs / 4;
+
 DynamicRangeProcessorSettings
 GetDynamicRangeProcessorSettings(const EffectSettings& settings)
 {
@@ -118,9 +126,13 @@ bool CompressorInstance::RealtimeInitialize(EffectSettings&, double sampleRate)
 bool CompressorInstance::RealtimeResume()
 {
    for (auto& slave : mSlaves)
+   {
       // Neither block size nore sample rate or any other parameter has changed,
       // so `Reinit()` should not reallocate memory.
       slave.mCompressor->Reinit();
+      slave.mOutputWriter.Reset();
+      slave.mCompressionValueWriter.Reset();
+   }
    RealtimeResumePublisher::Publish({});
    return true;
 }
@@ -179,14 +191,17 @@ size_t CompressorInstance::RealtimeProcess(
       newPacket.actualCompressionDb = frameStats.dbGainOfMaxInputSample;
       newPacket.inputDb = frameStats.maxInputSampleDb;
       newPacket.outputDb = GetOutputDb(frameStats, compressorSettings);
-      queue->Put(newPacket);
+      slave.mOutputWriter.Write(*queue, newPacket, numProcessedSamples);
    }
 
    if (const auto queue = slave.mCompressionValueQueue.lock())
-      queue->Put(MeterValues {
-         compressor.GetLastFrameStats().dbGainOfMaxInputSample,
-         GetOutputDb(
-            compressor.GetLastFrameStats(), compressor.GetSettings()) });
+      slave.mCompressionValueWriter.Write(
+         *queue,
+         MeterValues { compressor.GetLastFrameStats().dbGainOfMaxInputSample,
+                       GetOutputDb(
+                          compressor.GetLastFrameStats(),
+                          compressor.GetSettings()) },
+         numProcessedSamples);
 
    slave.mSampleCounter += numProcessedSamples;
    return numProcessedSamples;
@@ -209,6 +224,12 @@ void CompressorInstance::InstanceInit(
 {
    instance.mOutputQueue = mOutputQueue;
    instance.mCompressionValueQueue = mCompressionValueQueue;
+   instance.mOutputWriter = DownsamplingQueueWriter<
+      DynamicRangeProcessorOutputPacket> { static_cast<long long>(
+      sampleRate * minOutputPacketMs / 1000) };
+   instance.mCompressionValueWriter = DownsamplingQueueWriter<MeterValues> {
+      static_cast<long long>(sampleRate * minMeterValuesMs / 1000)
+   };
    instance.mCompressor->ApplySettingsIfNeeded(
       GetDynamicRangeProcessorSettings(settings));
    instance.mCompressor->Init(sampleRate, numChannels, GetBlockSize());
@@ -10,6 +10,7 @@
 **********************************************************************/
 #pragma once
 
+#include "DownsamplingQueueWriter.h"
 #include "DynamicRangeProcessorTypes.h"
 #include "EffectInterface.h"
 #include "Observer.h"
@@ -90,4 +91,6 @@ private:
    std::optional<double> mSampleRate;
    std::weak_ptr<DynamicRangeProcessorOutputPacketQueue> mOutputQueue;
    std::weak_ptr<DynamicRangeProcessorMeterValuesQueue> mCompressionValueQueue;
+   DownsamplingQueueWriter<DynamicRangeProcessorOutputPacket> mOutputWriter;
+   DownsamplingQueueWriter<MeterValues> mCompressionValueWriter;
 };
@@ -23,7 +23,7 @@
 #include "ShuttleGui.h"
 #include "FileNames.h"
 #include "ViewInfo.h"
-#include "WaveChannelUtilities.h"
+#include "RegionAnalysis.h"
 #include "HelpSystem.h"
 #include "../widgets/NumericTextCtrl.h"
 #include "AudacityMessageBox.h"
@@ -53,11 +53,6 @@
 
 bool ContrastDialog::GetDB(float &dB)
 {
-   float rms = float(0.0);
-
-   // For stereo tracks: sqrt((mean(L)+mean(R))/2)
-   double meanSq = 0.0;
-
    auto p = FindProjectFromWindow( this );
    auto range =
       TrackList::Get(*p).Selected<const WaveTrack>();
@@ -113,16 +108,14 @@ bool ContrastDialog::GetDB(float &dB)
          m.ShowModal();
          return false;
       }
-
-      // Don't throw in this analysis dialog
-      rms = WaveChannelUtilities::GetRMS(*t, mT0, mT1, false);
-      meanSq += rms * rms;
    }
+
+   // Don't throw in this analysis dialog
    // TODO: This works for stereo, provided the audio clips are in both channels.
    // We should really count gaps between clips as silence.
-   rms = (meanSq > 0.0)
-      ? sqrt( meanSq/static_cast<double>( channels.size() ) )
-      : 0.0;
+   const auto results = RegionAnalysis::Measure({ { *first, -1, mT0, mT1 } },
+      RegionAnalysis::RMS, {}, false);
+   const float rms = results ? results->front().rms.value_or(0.0f) : 0.0f;
 
    // Gives warning C4056, Overflow in floating-point constant arithmetic
    // -INFINITY is intentional here.
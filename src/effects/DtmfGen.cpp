@@ -17,6 +17,8 @@
 #include "DtmfGen.h"
 #include "EffectEditor.h"
 #include "LoadEffects.h"
+#include "VectorOps.h"
+#include <algorithm>
 
 #include <wx/slider.h>
 #include <wx/valgen.h>
@@ -613,10 +615,22 @@ bool EffectDtmf::MakeDtmfTone(float *buffer, size_t len, float fs, wxChar tone,
 
    // now generate the wave: 'last' is used to avoid phase errors
    // when inside the inner for loop of the Process() function.
-   for(decltype(len) i = 0; i < len; i++) {
-      buffer[i] = amplitude * 0.5 *
-         (sin( A * (i + last).as_double() ) +
-          sin( B * (i + last).as_double() ));
+   // The phases of a chunk are found in double, then their sines at once
+   constexpr size_t chunkSize = 512;
+   double cycles[chunkSize];
+   float low[chunkSize], high[chunkSize];
+   const double cyclesA = A / (2 * M_PI), cyclesB = B / (2 * M_PI);
+   for (size_t start = 0; start < len; start += chunkSize) {
+      const auto count = std::min(chunkSize, len - start);
+      const auto first = (last + start).as_double();
+      for (size_t i = 0; i < count; i++)
+         cycles[i] = cyclesA * (first + i);
+      VectorOps::SinCycles(cycles, low, count);
+      for (size_t i = 0; i < count; i++)
+         cycles[i] = cyclesB * (first + i);
+      VectorOps::SinCycles(cycles, high, count);
+      for (size_t i = 0; i < count; i++)
+         buffer[start + i] = amplitude * 0.5 * (low[i] + high[i]);
    }
 
    // generate a fade-in of duration 1/250th of second
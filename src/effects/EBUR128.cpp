@@ -19,16 +19,11 @@ EBUR128::EBUR128(double rate, size_t channels)
 {
    mLoudnessHist.reinit(HIST_BIN_COUNT, false);
    mBlockRingBuffer.reinit(mBlockSize);
-   mWeightingFilter.reinit(mChannelCount, false);
-   for(size_t channel = 0; channel < mChannelCount; ++channel)
-      mWeightingFilter[channel] = CalcWeightingFilter(mRate);
+   mWeightingFilter =
+      Biquad::MakeCascade(CalcWeightingFilter(mRate).get(), 2, mChannelCount);
+   mWeighted.resize(mChannelCount);
 
    memset(mLoudnessHist.get(), 0, HIST_BIN_COUNT*sizeof(long int));
-   for(size_t channel = 0; channel < mChannelCount; ++channel)
-   {
-      mWeightingFilter[channel][0].Reset();
-      mWeightingFilter[channel][1].Reset();
-   }
 }
 
 // fs: sample rate
@@ -80,18 +75,26 @@ ArrayOf<Biquad> EBUR128::CalcWeightingFilter(double fs)
    return pBiquad;
 }
 
-void EBUR128::ProcessSampleFromChannel(float x_in, size_t channel) const
+void EBUR128::ProcessSamples(const float *const *channels, size_t len)
 {
-   double value;
-   value = mWeightingFilter[channel][0].ProcessOne(x_in);
-   value = mWeightingFilter[channel][1].ProcessOne(value);
-   if(channel == 0)
-      mBlockRingBuffer[mBlockRingPos] = value * value;
-   else
-   {
+   std::vector<float*> weighted;
+   for (auto &buffer : mWeighted) {
+      if (buffer.size() < len)
+         buffer.resize(len);
+      weighted.push_back(buffer.data());
+   }
+   mWeightingFilter.Process(channels, weighted.data(), len);
+
+   for (size_t i = 0; i < len; ++i) {
       // Add the power of additional channels to the power of first channel.
       // As a result, stereo tracks appear about 3 LUFS louder, as specified.
-      mBlockRingBuffer[mBlockRingPos] += value * value;
+      double power = 0;
+      for (const auto pWeighted : weighted) {
+         const double value = pWeighted[i];
+         power += value * value;
+      }
+      mBlockRingBuffer[mBlockRingPos] = power;
+      NextSample();
    }
 }
 
@@ -112,21 +115,61 @@ void EBUR128::NextSample()
    ++mSampleCount;
 }
 
+EBUR128::Histogram EBUR128::SparseHistogram() const
+{
+   Histogram result;
+   for(size_t i = 0; i < HIST_BIN_COUNT; ++i)
+      if(mLoudnessHist[i])
+         result.emplace_back(i, mLoudnessHist[i]);
+   return result;
+}
+
+EBUR128::Histogram EBUR128::GetHistogram()
+{
+   auto result = SparseHistogram();
+   // Handle incomplete block if no non-zero block was found.
+   if(result.empty() && mBlockRingSize > 0)
+   {
+      AddBlockToHistogram(mBlockRingSize);
+      result = SparseHistogram();
+   }
+   return result;
+}
+
+void EBUR128::AddHistogram(Histogram &sum, const Histogram &addend)
+{
+   Histogram result;
+   result.reserve(sum.size() + addend.size());
+   auto iter = sum.begin(), end = sum.end();
+   for(const auto &[idx, count] : addend)
+   {
+      for(; iter != end && iter->first < idx; ++iter)
+         result.push_back(*iter);
+      if(iter != end && iter->first == idx)
+         result.emplace_back(idx, (iter++)->second + count);
+      else
+         result.emplace_back(idx, count);
+   }
+   result.insert(result.end(), iter, end);
+   sum.swap(result);
+}
+
 double EBUR128::IntegrativeLoudness()
+{
+   return IntegrativeLoudness(GetHistogram());
+}
+
+double EBUR128::IntegrativeLoudness(const Histogram &histogram)
 {
    // EBU R128: z_i = mean square without root
 
    // Calculate Gamma_R from histogram.
    double sum_v;
    long int sum_c;
-   HistogramSums(0, sum_v, sum_c);
-
-   // Handle incomplete block if no non-zero block was found.
+   HistogramSums(histogram, 0, sum_v, sum_c);
    if(sum_c == 0)
-   {
-      AddBlockToHistogram(mBlockRingSize);
-      HistogramSums(0, sum_v, sum_c);
-   }
+      // Silence was processed.
+      return 0;
 
    // Histogram values are simplified log(x^2) immediate values
    // without -0.691 + 10*(...) to safe computing power. This is
@@ -137,7 +180,7 @@ double EBUR128::IntegrativeLoudness()
    size_t idx_R = round((Gamma_R - GAMMA_A) * double(HIST_BIN_COUNT) / -GAMMA_A - 1);
 
    // Apply Gamma_R threshold and calculate gated loudness (extent).
-   HistogramSums(idx_R+1, sum_v, sum_c);
+   HistogramSums(histogram, idx_R+1, sum_v, sum_c);
    if(sum_c == 0)
       // Silence was processed.
       return 0;
@@ -145,17 +188,19 @@ double EBUR128::IntegrativeLoudness()
    return 0.8529037031 * sum_v / sum_c;
 }
 
-void
-EBUR128::HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const
+void EBUR128::HistogramSums(const Histogram &histogram,
+   size_t start_idx, double& sum_v, long int& sum_c)
 {
     double val;
     sum_v = 0;
     sum_c = 0;
-    for(size_t i = start_idx; i < HIST_BIN_COUNT; ++i)
+    for(const auto &[i, count] : histogram)
     {
+       if(i < start_idx)
+          continue;
        val = -GAMMA_A / double(HIST_BIN_COUNT) * (i+1) + GAMMA_A;
-       sum_v += pow(10, val) * mLoudnessHist[i];
-       sum_c += mLoudnessHist[i];
+       sum_v += pow(10, val) * count;
+       sum_c += count;
     }
 }
 
@@ -16,6 +16,8 @@ Max Maisel
 #include "SampleFormat.h"
 
 #include <cmath>
+#include <utility>
+#include <vector>
 
 /// \brief Implements EBU-R128 loudness measurement.
 class EBUR128
@@ -26,15 +28,30 @@ public:
    EBUR128(EBUR128&&) = delete;
    ~EBUR128() = default;
 
+   //! Sparse gating histogram, of (bin, count) in increasing order of bin
+   /*!
+    Histograms of consecutive parts of the audio may be summed, then
+    measured, without keeping any of the samples
+    */
+   using Histogram = std::vector<std::pair<size_t, long int>>;
+
    static ArrayOf<Biquad> CalcWeightingFilter(double fs);
-   void ProcessSampleFromChannel(float x_in, size_t channel) const;
-   void NextSample();
+   //! Weight and measure the next len samples of each channel
+   void ProcessSamples(const float *const *channels, size_t len);
+   //! Histogram of the full blocks so far, or if none is above the absolute
+   //! threshold, with the incomplete block too
+   Histogram GetHistogram();
+   static void AddHistogram(Histogram &sum, const Histogram &addend);
    double IntegrativeLoudness();
+   static double IntegrativeLoudness(const Histogram &histogram);
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
 
 private:
-   void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const;
+   static void HistogramSums(const Histogram &histogram,
+      size_t start_idx, double& sum_v, long int& sum_c);
+   Histogram SparseHistogram() const;
+   void NextSample();
    void AddBlockToHistogram(size_t validLen);
 
    static constexpr size_t HIST_BIN_COUNT = 65536;
@@ -50,11 +67,10 @@ private:
    const size_t mBlockSize;
    const size_t mBlockOverlap;
 
-   /// This is be an array of arrays of the type
-   /// mWeightingFilter[CHANNEL][FILTER] with
-   /// CHANNEL = LEFT/RIGHT (0/1) and
-   /// FILTER  = HSF/HPF    (0/1)
-   ArrayOf<ArrayOf<Biquad>> mWeightingFilter;
+   /// The HSF and HPF filters, in that order, for all channels
+   BiquadCascade mWeightingFilter;
+   /// Output of mWeightingFilter, for each channel
+   std::vector<std::vector<float>> mWeighted;
 };
 
 #endif
@@ -17,10 +17,85 @@
 #include "AudioIO.h"
 #include "BasicUI.h"
 #include "MixAndRender.h"
+#include "Project.h"
 #include "ProjectAudioIO.h"
 #include "TransportUtilities.h"
+#include "UndoManager.h"
 #include "WaveTrack.h"
 
+namespace {
+//! The copies of the tracks that the last preview of a project began with,
+//! to serve again until the project changes
+class PreviewSources final : public ClientData::Base
+{
+public:
+   static PreviewSources &Get(AudacityProject &project);
+
+   explicit PreviewSources(AudacityProject &project)
+      : mSubscription{ UndoManager::Get(project)
+         .Subscribe([this](UndoRedoMessage message){
+            switch (message.type) {
+            case UndoRedoMessage::Pushed:
+            case UndoRedoMessage::Modified:
+            case UndoRedoMessage::UndoOrRedo:
+            case UndoRedoMessage::Reset:
+               mpTracks.reset();
+               break;
+            default:
+               break;
+            }
+         }) }
+   {}
+
+   //! What determines the copies
+   struct Key {
+      bool mixed;
+      double t0, t1, rate;
+      std::vector<TrackId> tracks;
+      bool operator ==(const Key &other) const
+      {
+         return mixed == other.mixed && t0 == other.t0 && t1 == other.t1 &&
+            rate == other.rate && tracks == other.tracks;
+      }
+   };
+
+   //! Add duplicates of the cached copies to `tracks`, if they match the key
+   bool Find(const Key &key, TrackList &tracks) const
+   {
+      if (!mpTracks || !(key == mKey))
+         return false;
+      for (const auto pTrack : *mpTracks)
+         tracks.Add(pTrack->Duplicate())->SetSelected(true);
+      return true;
+   }
+
+   //! Remember duplicates of the tracks
+   void Store(Key key, const TrackList &tracks)
+   {
+      mKey = std::move(key);
+      mpTracks = TrackList::Create(nullptr);
+      for (const auto pTrack : tracks)
+         mpTracks->Add(pTrack->Duplicate());
+   }
+
+private:
+   Observer::Subscription mSubscription;
+   Key mKey;
+   std::shared_ptr<TrackList> mpTracks;
+};
+
+const AttachedProjectObjects::RegisteredFactory key{
+   [](AudacityProject &project){
+      return std::make_shared<PreviewSources>(project);
+   }
+};
+
+PreviewSources &PreviewSources::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<PreviewSources>(key);
+}
+}
+
 void EffectPreview(EffectBase &effect,
    EffectSettingsAccess &access, std::function<void()> updateUI, bool dryOnly)
 {
@@ -119,7 +194,16 @@ void EffectPreview(EffectBase &effect,
 
    // Linear Effect preview optimised by pre-mixing to one track.
    // Generators need to generate per track.
-   if (isLinearEffect && !isGenerator) {
+   const bool mixed = isLinearEffect && !isGenerator;
+   PreviewSources::Key sourcesKey{ mixed, mT0, t1, rate };
+   for (auto src : saveTracks->Selected<const WaveTrack>())
+      sourcesKey.tracks.push_back(src->GetId());
+   // Repeated previews with other settings need not copy or mix again
+   auto &sources = PreviewSources::Get(*pProject);
+   const bool cached = sources.Find(sourcesKey, *mTracks);
+   if (cached)
+      ;
+   else if (mixed) {
       auto newTrack = MixAndRender(
          saveTracks->Selected<const WaveTrack>(),
          Mixer::WarpOptions{ saveTracks->GetOwner() },
@@ -139,6 +223,8 @@ void EffectPreview(EffectBase &effect,
          mTracks->Add(dest);
       }
    }
+   if (!cached && !mTracks->empty())
+      sources.Store(std::move(sourcesKey), *mTracks);
 
    // NEW tracks start at time zero.
    // Adjust mT0 and mT1 to be the times to process, and to
@@ -20,7 +20,12 @@ class EffectSettingsAccess;
 
 //! Calculate temporary tracks of limited length with effect applied and play
 /*!
+ The copied or mixed source tracks are kept for the next preview, until the
+ project changes.
+
  @param updateUI called after adjusting temporary settings and before play
+ @param dryOnly play the source without applying the effect, as when a
+ realtime instance of it processes the playback
  */
 void EffectPreview(EffectBase &effect,
    EffectSettingsAccess &access, std::function<void()> updateUI,
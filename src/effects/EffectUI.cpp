@@ -761,7 +761,11 @@ void EffectUIHost::OnPlay(wxCommandEvent & WXUNUSED(evt))
       return;
    
    auto updater = [this]{ TransferDataToWindow(); };
-   EffectPreview(mEffectUIHost, *mpAccess, updater, false);
+   // A realtime capable effect is among the master effects while this dialog
+   // is open, with the same settings; then play the source unprocessed, and
+   // the effect applies live as it plays, with no rendering first
+   const bool live = (mpTempProjectState != nullptr);
+   EffectPreview(mEffectUIHost, *mpAccess, updater, live);
    // After restoration of settings and effect state:
    // In case any dialog control depends on mT1 or mDuration:
    updater();
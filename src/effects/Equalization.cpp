@@ -37,6 +37,7 @@
 #include "EffectEditor.h"
 #include "EffectOutputTracks.h"
 #include "LoadEffects.h"
+#include "PartitionedConvolver.h"
 #include "ShuttleGui.h"
 
 #include "WaveClip.h"
@@ -363,14 +364,21 @@ bool EffectEqualization::Init()
    return(true);
 }
 
+namespace {
+//! Least block size of the convolver, so that short filters are not applied
+//! in tiny pieces
+constexpr size_t MinBlockSize = 1024;
+}
+
 struct EffectEqualization::Task {
-   Task(size_t M, size_t idealBlockLen, WaveChannel &channel)
-      : buffer{ idealBlockLen }
+   Task(const std::vector<float> &impulse, size_t blockSize,
+      size_t idealBlockLen, WaveChannel &channel)
+      : convolver{ impulse.data(), impulse.size(), blockSize }
+      , buffer{ idealBlockLen }
       , idealBlockLen{ idealBlockLen }
       , output{ channel }
-      , leftTailRemaining{ (M - 1) / 2 }
+      , leftTailRemaining{ (impulse.size() - 1) / 2 }
    {
-      memset(lastWindow, 0, windowSize * sizeof(float));
    }
 
    void AccumulateSamples(constSamplePtr buffer, size_t len)
@@ -382,17 +390,11 @@ struct EffectEqualization::Task {
       output.Append(buffer, floatSample, len);
    }
 
-   static constexpr auto windowSize = EqualizationFilter::windowSize;
-   Floats window1{ windowSize };
-   Floats window2{ windowSize };
+   PartitionedConvolver convolver;
 
    Floats buffer;
    const size_t idealBlockLen;
 
-   // These pointers are swapped after each FFT window
-   float *thisWindow{ window1.get() };
-   float *lastWindow{ window2.get() };
-
    // a new WaveChannel to hold all of the output,
    // including 'tails' each end
    WaveChannel &output;
@@ -423,17 +425,17 @@ bool EffectEqualization::Process(EffectInstance &, EffectSettings &)
          auto iter0 = pTempTrack->Channels().begin();
 
          for (const auto pChannel : track->Channels()) {
-            constexpr auto windowSize = EqualizationFilter::windowSize;
-            const auto &M = mParameters.mM;
-
-            wxASSERT(M - 1 < windowSize);
-            size_t L = windowSize - (M - 1);   //Process L samples at a go
-            auto s = start;
+            const auto &impulse = mParameters.mImpulse;
+            // One partition of the impulse response, which is fastest
+            // without the need for low latency
+            size_t blockSize = MinBlockSize;
+            while (blockSize < impulse.size())
+               blockSize *= 2;
             auto idealBlockLen = pChannel->GetMaxBlockSize() * 4;
-            if (idealBlockLen % L != 0)
-               idealBlockLen += (L - (idealBlockLen % L));
+            if (idealBlockLen % blockSize != 0)
+               idealBlockLen += (blockSize - (idealBlockLen % blockSize));
             auto pNewChannel = *iter0++;
-            Task task{ M, idealBlockLen, *pNewChannel };
+            Task task{ impulse, blockSize, idealBlockLen, *pNewChannel };
             bGoodResult = ProcessOne(task, count, *pChannel, start, len);
             if (!bGoodResult)
                goto done;
@@ -475,27 +477,18 @@ bool EffectEqualization::TransferDataToWindow(const EffectSettings &settings)
 bool EffectEqualization::ProcessOne(Task &task,
    int count, const WaveChannel &t, sampleCount start, sampleCount len)
 {
-   constexpr auto windowSize = EqualizationFilter::windowSize;
-
-   const auto &M = mParameters.mM;
-
-   wxASSERT(M - 1 < windowSize);
-   size_t L = windowSize - (M - 1);   //Process L samples at a go
+   auto &convolver = task.convolver;
+   const auto blockSize = convolver.BlockSize();
    auto s = start;
 
    auto &buffer = task.buffer;
-   auto &window1 = task.window1;
-   auto &window2 = task.window2;
-   auto &thisWindow = task.thisWindow;
-   auto &lastWindow = task.lastWindow;
 
    auto originalLen = len;
-
-   auto &output = task.output;
+   // Samples of output still to come, including the tail
+   auto remaining = len + (convolver.ImpulseLength() - 1);
 
    TrackProgress(count, 0.);
    bool bLoopSuccess = true;
-   size_t wcopy = 0;
 
    while (len != 0)
    {
@@ -503,26 +496,15 @@ bool EffectEqualization::ProcessOne(Task &task,
 
       t.GetFloats(buffer.get(), s, block);
 
-      for(size_t i = 0; i < block; i += L)   //go through block in lumps of length L
-      {
-         wcopy = std::min <size_t> (L, block - i);
-         for(size_t j = 0; j < wcopy; j++)
-            thisWindow[j] = buffer[i+j];   //copy the L (or remaining) samples
-         for(auto j = wcopy; j < windowSize; j++)
-            thisWindow[j] = 0;   //this includes the padding
-
-         mParameters.Filter(windowSize, thisWindow);
-
-         // Overlap - Add
-         for(size_t j = 0; (j < M - 1) && (j < wcopy); j++)
-            buffer[i+j] = thisWindow[j] + lastWindow[L + j];
-         for(size_t j = M - 1; j < wcopy; j++)
-            buffer[i+j] = thisWindow[j];
-
-         std::swap( thisWindow, lastWindow );
-      }  //next i, lump of this block
+      // Zero fill a part of a last block of the convolver
+      const auto padded = (block + blockSize - 1) / blockSize * blockSize;
+      std::fill(buffer.get() + block, buffer.get() + padded, 0.0f);
+      for (size_t i = 0; i < padded; i += blockSize)
+         convolver.Process(buffer.get() + i, buffer.get() + i);
 
-      task.AccumulateSamples((samplePtr)buffer.get(), block);
+      const auto produced = limitSampleBufferSize(padded, remaining);
+      task.AccumulateSamples((samplePtr)buffer.get(), produced);
+      remaining -= produced;
       len -= block;
       s += block;
 
@@ -535,22 +517,14 @@ bool EffectEqualization::ProcessOne(Task &task,
    }
 
    if (bLoopSuccess) {
-      // M-1 samples of 'tail' left in lastWindow, get them now
-      if(wcopy < (M - 1)) {
-         // Still have some overlap left to process
-         // (note that lastWindow and thisWindow have been exchanged at this point
-         //  so that 'thisWindow' is really the window prior to 'lastWindow')
-         size_t j = 0;
-         for(; j < M - 1 - wcopy; j++)
-            buffer[j] = lastWindow[wcopy + j] + thisWindow[L + wcopy + j];
-         // And fill in the remainder after the overlap
-         for( ; j < M - 1; j++)
-            buffer[j] = lastWindow[wcopy + j];
-      } else {
-         for(size_t j = 0; j < M - 1; j++)
-            buffer[j] = lastWindow[wcopy + j];
+      // Get the rest of the 'tail' from the convolver
+      while (remaining > 0) {
+         std::fill(buffer.get(), buffer.get() + blockSize, 0.0f);
+         convolver.Process(buffer.get(), buffer.get());
+         const auto produced = limitSampleBufferSize(blockSize, remaining);
+         task.AccumulateSamples((samplePtr)buffer.get(), produced);
+         remaining -= produced;
       }
-      task.AccumulateSamples((samplePtr)buffer.get(), M - 1);
    }
    return bLoopSuccess;
 }
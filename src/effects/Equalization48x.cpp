@@ -22,6 +22,8 @@
 #include "WaveClip.h"
 #include "WaveTrack.h"
 #include "../float_cast.h"
+#include "concurrency/TaskScheduler.h"
+#include <chrono>
 #include <vector>
 
 #include <wx/setup.h> // for wxUSE_* macros
@@ -38,6 +40,12 @@
 #define	USE_SSE2
 #endif
 
+using namespace audacity::concurrency;
+
+//! Longest that threaded processing waits for a buffer between updates of
+//! progress
+static constexpr auto ProgressInterval = std::chrono::milliseconds{ 100 };
+
 #include <stdlib.h>
 
 #ifdef __WXMSW__
@@ -180,7 +188,7 @@ bool EffectEqualization48x::AllocateBuffersWorkers(int nThreads)
    mWindowSize=mEffectEqualization->windowSize;
    wxASSERT(mFilterSize < mWindowSize);
    mBlockSize=mWindowSize-mFilterSize; // 12,384
-   auto threadCount = wxThread::GetCPUCount();
+   const auto threadCount = TaskScheduler::Get().ThreadCount();
    mThreaded = (nThreads > 0 && threadCount > 0);
    if(mThreaded)
    {
@@ -217,29 +225,13 @@ bool EffectEqualization48x::AllocateBuffersWorkers(int nThreads)
       for(int j=0;j<mBufferCount;j++)
          mBufferInfo[i].mBufferDest[j]=mBufferInfo[i].mBufferSouce[j]=&mBigBuffer[j*(mBufferInfo[i].mBufferLength-mBlockSize)+(mSubBufferSize+mScratchBufferSize)*i];
    }
-   if(mThreadCount) {
-      // start the workers
-      mDataMutex.IsOk();
-      mEQWorkers.reinit(mThreadCount);
-      for(int i=0;i<mThreadCount;i++) {
-         mEQWorkers[i].SetData( mBufferInfo.get(), mWorkerDataCount, &mDataMutex, this);
-         mEQWorkers[i].Create();
-         mEQWorkers[i].Run();
-      }
-   } 
    return true;
 }
 
 bool EffectEqualization48x::FreeBuffersWorkers()
 {
    if(mThreaded) {
-      for(int i=0;i<mThreadCount;i++) { // tell all the workers to exit
-         mEQWorkers[i].ExitLoop();
-      }
-      for(int i=0;i<mThreadCount;i++) {
-         mEQWorkers[i].Wait();
-      }
-      mEQWorkers.reset(); // kill the workers ( go directly to jail)
+      // Tasks of the workers finished before the threaded runs returned
       mThreadCount=0;
       mWorkerDataCount=0; 
    }
@@ -854,35 +846,20 @@ bool EffectEqualization48x::ProcessOne4x(int count, WaveTrack * t,
    return bBreakLoop;
 }
 
-#include <wx/thread.h>
-
-void *EQWorker::Entry()
+void EffectEqualization48x::ScheduleBuffer(TaskGroup &group,
+   BufferInfo &bufferInfo, int processingType)
 {
-   while(!mExitLoop) {
-      int i = 0;
-      {
-         wxMutexLocker locker( *mMutex );
-         for(; i < mBufferInfoCount; i++) {
-            if(mBufferInfoList[i].mBufferStatus==BufferReady) { // we found an unlocked ready buffer
-               mBufferInfoList[i].mBufferStatus=BufferBusy; // we own it now
-               break;
-            }
-         }
-      }
-      if ( i < mBufferInfoCount ) {
-         switch (mProcessingType)
-         {
-            case 1:
-               mEffectEqualization48x->ProcessBuffer1x(&mBufferInfoList[i]);
-               break;
-            case 4:
-               mEffectEqualization48x->ProcessBuffer4x(&mBufferInfoList[i]);
-               break;
-         }
-         mBufferInfoList[i].mBufferStatus=BufferDone; // we're done
-      }
-   }
-   return NULL;
+   bufferInfo.mBufferStatus=BufferReady;
+   group.Run([this, &bufferInfo, processingType]{
+      // As by the old worker threads, which did 4x for all but 1x
+      if (processingType == 1)
+         ProcessBuffer1x(&bufferInfo);
+      else
+         ProcessBuffer4x(&bufferInfo);
+      std::lock_guard<std::mutex> locker{ mDataMutex };
+      bufferInfo.mBufferStatus=BufferDone; // we're done
+      mBufferDone.notify_all();
+   });
 }
 
 bool EffectEqualization48x::ProcessOne1x4xThreaded(int count, WaveTrack * t,
@@ -897,9 +874,6 @@ bool EffectEqualization48x::ProcessOne1x4xThreaded(int count, WaveTrack * t,
    if(mThreadCount<=0 || blockCount<256) // don't do it without cores or big data
       return ProcessOne4x(count, t, start, len);
 
-   for(int i=0;i<mThreadCount;i++)
-      mEQWorkers[i].mProcessingType=processingType;
-
    auto output = t->EmptyCopy();
    t->ConvertToSampleFormat( floatSample );
 
@@ -914,6 +888,8 @@ bool EffectEqualization48x::ProcessOne1x4xThreaded(int count, WaveTrack * t,
    auto currentSample=start;
 
    int bigBlocksRead=mWorkerDataCount, bigBlocksWritten=0;
+   // Waits for the buffers still processing in case of cancellation
+   TaskGroup group;
 
    // fill the first workerDataCount buffers we checked above and there is at least this data
    auto maxPreFill = bigRuns < mWorkerDataCount ? bigRuns : mWorkerDataCount;
@@ -929,7 +905,7 @@ bool EffectEqualization48x::ProcessOne1x4xThreaded(int count, WaveTrack * t,
          currentSample+=trackLeftovers;
       }
       currentSample-=mBlockSize+(mFilterSize>>1);
-      mBufferInfo[i].mBufferStatus=BufferReady; // free for grabbin
+      ScheduleBuffer(group, mBufferInfo[i], processingType); // free for grabbin
    }
    int currentIndex=0;
    bool bBreakLoop = false;
@@ -937,7 +913,10 @@ bool EffectEqualization48x::ProcessOne1x4xThreaded(int count, WaveTrack * t,
       bBreakLoop=mEffectEqualization->TrackProgress(count, (double)(bigBlocksWritten)/bigRuns.as_double());
       if( bBreakLoop )
          break;
-      wxMutexLocker locker( mDataMutex ); // Get in line for data
+      std::unique_lock<std::mutex> locker{ mDataMutex }; // Get in line for data
+      // Sleep until the next is processed, but wake for progress
+      mBufferDone.wait_for(locker, ProgressInterval, [&]{
+         return mBufferInfo[currentIndex].mBufferStatus==BufferDone; });
       // process as many blocks as we can
       while((mBufferInfo[currentIndex].mBufferStatus==BufferDone) && (bigBlocksWritten<bigRuns)) { // data is ours
          output->Append((samplePtr)&mBufferInfo[currentIndex].mBufferDest[0][(bigBlocksWritten?mBlockSize:0)+(mFilterSize>>1)], floatSample, subBufferSize-((bigBlocksWritten?mBlockSize:0)+(mFilterSize>>1)));
@@ -953,7 +932,7 @@ bool EffectEqualization48x::ProcessOne1x4xThreaded(int count, WaveTrack * t,
                currentSample+=trackLeftovers;
             }
             currentSample-=mBlockSize+(mFilterSize>>1);
-            mBufferInfo[currentIndex].mBufferStatus=BufferReady; // free for grabbin
+            ScheduleBuffer(group, mBufferInfo[currentIndex], processingType); // free for grabbin
             bigBlocksRead++;
          } else mBufferInfo[currentIndex].mBufferStatus=BufferEmpty; // this is completely unnecessary
          currentIndex=(currentIndex+1)%mWorkerDataCount;
@@ -1210,6 +1189,8 @@ bool EffectEqualization48x::ProcessOne8xThreaded(int count, WaveTrack * t,
    auto currentSample=start;
 
    int bigBlocksRead=mWorkerDataCount, bigBlocksWritten=0;
+   // Waits for the buffers still processing in case of cancellation
+   TaskGroup group;
 
    // fill the first workerDataCount buffers we checked above and there is at least this data
    for(int i=0;i<mWorkerDataCount;i++)
@@ -1224,7 +1205,7 @@ bool EffectEqualization48x::ProcessOne8xThreaded(int count, WaveTrack * t,
          currentSample+=trackLeftovers;
       }
       currentSample-=mBlockSize+(mFilterSize>>1);
-      mBufferInfo[i].mBufferStatus=BufferReady; // free for grabbin
+      ScheduleBuffer(group, mBufferInfo[i], 4); // free for grabbin
    }
    int currentIndex=0;
    bool bBreakLoop = false;
@@ -1233,7 +1214,10 @@ bool EffectEqualization48x::ProcessOne8xThreaded(int count, WaveTrack * t,
       {
          break;
       }
-      wxMutexLocker locker( mDataMutex ); // Get in line for data
+      std::unique_lock<std::mutex> locker{ mDataMutex }; // Get in line for data
+      // Sleep until the next is processed, but wake for progress
+      mBufferDone.wait_for(locker, ProgressInterval, [&]{
+         return mBufferInfo[currentIndex].mBufferStatus==BufferDone; });
       // process as many blocks as we can
       while((mBufferInfo[currentIndex].mBufferStatus==BufferDone) && (bigBlocksWritten<bigRuns)) { // data is ours
          output->Append((samplePtr)&mBufferInfo[currentIndex].mBufferDest[0][(bigBlocksWritten?mBlockSize:0)+(mFilterSize>>1)], floatSample, mSubBufferSize-((bigBlocksWritten?mBlockSize:0)+(mFilterSize>>1)));
@@ -1249,7 +1233,7 @@ bool EffectEqualization48x::ProcessOne8xThreaded(int count, WaveTrack * t,
                currentSample+=trackLeftovers;
             }
             currentSample-=mBlockSize+(mFilterSize>>1);
-            mBufferInfo[currentIndex].mBufferStatus=BufferReady; // free for grabbin
+            ScheduleBuffer(group, mBufferInfo[currentIndex], 4); // free for grabbin
             bigBlocksRead++;
          } else mBufferInfo[currentIndex].mBufferStatus=BufferEmpty; // this is completely unnecessary
          currentIndex=(currentIndex+1)%mWorkerDataCount;
@@ -13,11 +13,16 @@ Intrinsics (SSE/AVX) and Threaded Equalization
 
 #ifdef EXPERIMENTAL_EQ_SSE_THREADED
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
-#include <wx/thread.h> // to inherit
 #include <audacity/Types.h>
 class WaveTrack;
+
+namespace audacity::concurrency {
+class TaskGroup;
+}
 using fft_type = float;
 
 #ifdef __AVX_ENABLED
@@ -83,37 +88,6 @@ class EffectEqualization;
 
 class EffectEqualization48x;
 
-static int EQWorkerCounter=0;
-
-class EQWorker : public wxThread {
-public:
-   EQWorker():wxThread(wxTHREAD_JOINABLE) {   
-      mBufferInfoList=NULL;
-      mBufferInfoCount=0;
-      mMutex=NULL;
-      mEffectEqualization48x=NULL;
-      mExitLoop=false;
-      mThreadID=EQWorkerCounter++;
-      mProcessingType=4;
-   }
-   void SetData( BufferInfo* bufferInfoList, int bufferInfoCount, wxMutex *mutex, EffectEqualization48x *effectEqualization48x) {
-      mBufferInfoList=bufferInfoList;
-      mBufferInfoCount=bufferInfoCount;
-      mMutex=mutex;
-      mEffectEqualization48x=effectEqualization48x;
-   }
-   void ExitLoop() { // this will cause the thread to drop from the loops
-      mExitLoop=true;
-   }
-   void* Entry() override;
-   BufferInfo* mBufferInfoList;
-   int mBufferInfoCount, mThreadID;
-   wxMutex *mMutex;
-   EffectEqualization48x *mEffectEqualization48x;
-   bool mExitLoop;
-   int mProcessingType;
-};
-
 class EffectEqualization48x {
 
 public:
@@ -139,6 +113,10 @@ private:
    bool ProcessTail(WaveTrack * t, WaveTrack * output, sampleCount start, sampleCount len);
 
    bool ProcessBuffer(fft_type *sourceBuffer, fft_type *destBuffer, size_t bufferLength);
+   //! Process a filled buffer in the shared TaskScheduler; then its status
+   //! becomes BufferDone
+   void ScheduleBuffer(audacity::concurrency::TaskGroup &group,
+      BufferInfo &bufferInfo, int processingType);
    bool ProcessBuffer1x(BufferInfo *bufferInfo);
    bool ProcessOne1x(int count, WaveTrack * t, sampleCount start, sampleCount len);
    void Filter1x(size_t len, float *buffer, float *scratchBuffer);
@@ -167,11 +145,12 @@ private:
    size_t mSubBufferSize;
    simd_floats mBigBuffer;
    ArrayOf<BufferInfo> mBufferInfo;
-   wxMutex mDataMutex;
-   ArrayOf<EQWorker> mEQWorkers;
+   //! Guards the statuses of mBufferInfo
+   std::mutex mDataMutex;
+   //! Notified when a buffer becomes BufferDone
+   std::condition_variable mBufferDone;
    bool mThreaded;
    bool mBenching;
-   friend EQWorker;
    friend EffectEqualization;
 };
 
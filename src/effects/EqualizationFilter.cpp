@@ -135,6 +135,7 @@ bool EqualizationFilter::CalcFilter()
    {   //and copy useful values back
       outr[i] = tempr[i];
    }
+   mImpulse.assign(outr.get(), outr.get() + mM);
    for (size_t i = mM; i < mWindowSize; i++)
    {   //rest is padding
       outr[i]=0.;
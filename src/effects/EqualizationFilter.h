@@ -17,6 +17,7 @@
 #include "EqualizationParameters.h" // base class
 #include "Envelope.h" // member
 #include "RealFFTf.h" // member
+#include <vector>
 using Floats = ArrayOf<float>;
 
 //! Extend EqualizationParameters with frequency domain coefficients computed
@@ -54,6 +55,8 @@ struct EqualizationFilter : EqualizationParameters {
    HFFT hFFT{ GetFFT(windowSize) };
    Floats mFFTBuffer{ windowSize };
    Floats mFilterFuncR{ windowSize }, mFilterFuncI{ windowSize };
+   //! The mM values of the finite impulse response computed by CalcFilter()
+   std::vector<float> mImpulse;
    double mLoFreq{ loFreqI };
    double mHiFreq{ mLoFreq };
    size_t mWindowSize{ windowSize };
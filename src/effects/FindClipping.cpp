@@ -23,7 +23,10 @@
 #include "EffectOutputTracks.h"
 #include "LoadEffects.h"
 
+#include <atomic>
 #include <math.h>
+#include <utility>
+#include <vector>
 
 
 #include "ShuttleGui.h"
@@ -31,7 +34,9 @@
 #include "AudacityMessageBox.h"
 
 #include "../LabelTrack.h"
+#include "WaveChannelUtilities.h"
 #include "WaveTrack.h"
+#include "concurrency/TaskScheduler.h"
 
 const EffectParameterMethods& EffectFindClipping::Parameters() const
 {
@@ -126,88 +131,139 @@ bool EffectFindClipping::Process(EffectInstance &, EffectSettings &)
    return true;
 }
 
+namespace {
+//! Start and length of each run of clipped samples, relative to the start
+//! of the selection
+using Runs = std::vector<std::pair<sampleCount, sampleCount>>;
+
+//! Find the runs of clipped samples between positions relative to start
+/*!
+ Only reads samples, and so may be called in a worker thread
+ */
+void FindRuns(const WaveChannel &wt, sampleCount start,
+   sampleCount s, sampleCount end, Runs &runs,
+   std::atomic<long long> &done, const std::atomic<bool> &cancelled)
+{
+   const auto bufferSize = wt.GetMaxBlockSize();
+   Floats buffer{ bufferSize };
+   while (s < end) {
+      if (cancelled)
+         return;
+
+      // Skip samples that the block summaries show to be unclipped
+      const auto quiet = WaveChannelUtilities::GetQuietLength(
+         wt, start + s, end - s, MAX_AUDIO);
+      s += quiet;
+      done += quiet.as_long_long();
+      if (s >= end)
+         break;
+
+      const auto block = limitSampleBufferSize(bufferSize, end - s);
+      wt.GetFloats(buffer.get(), start + s, block);
+      for (size_t i = 0; i < block; ++i) {
+         if (fabs(buffer[i]) >= MAX_AUDIO) {
+            const auto pos = s + i;
+            if (!runs.empty() && runs.back().first + runs.back().second == pos)
+               ++runs.back().second;
+            else
+               runs.emplace_back(pos, 1);
+         }
+      }
+      s += block;
+      done += block;
+   }
+}
+}
+
 bool EffectFindClipping::ProcessOne(LabelTrack &lt,
    int count, const WaveChannel &wt, sampleCount start, sampleCount len)
 {
-   bool bGoodResult = true;
-   size_t blockSize = (mStart * 1000);
+   using namespace audacity::concurrency;
 
    if (len < mStart)
       return true;
 
-   Floats buffer;
-   try {
-      // mStart should be positive.
-      // if we are throwing bad_alloc and mStart is negative, find out why.
-      if (mStart < 0 || (int)blockSize < mStart)
-         // overflow
-         throw std::bad_alloc{};
-      buffer.reinit(blockSize);
+   // Find the runs in chunks, in parallel, then make labels of them in order
+   constexpr long long chunkSize = 1 << 20;
+   const auto nChunks =
+      static_cast<size_t>((len.as_long_long() + chunkSize - 1) / chunkSize);
+   std::vector<Runs> chunkRuns(nChunks);
+   std::atomic<bool> cancelled{ false };
+   std::atomic<long long> done{ 0 };
+   {
+      TaskGroup group;
+      bool finished = false;
+      // If this thread throws, stop the workers, before the group waits
+      auto cleanup = finally([&]{
+         if (!finished)
+            cancelled = true;
+      });
+      for (size_t ii = 0; ii < nChunks; ++ii)
+         group.Run([&, ii]{
+            const sampleCount s = ii * chunkSize;
+            FindRuns(wt, start, s, std::min(len, s + chunkSize),
+               chunkRuns[ii], done, cancelled);
+         });
+      group.WaitPolling([&]{
+         if (!cancelled &&
+             TrackProgress(count, done.load() / len.as_double()))
+            cancelled = true;
+      });
+      finished = true;
    }
-   catch( const std::bad_alloc & ) {
-      EffectUIServices::DoMessageBox(*this,
-         XO("Requested value exceeds memory capacity."));
+   if (cancelled)
       return false;
-   }
 
-   float *ptr = buffer.get();
-
-   decltype(len) s = 0, startrun = 0, stoprun = 0, samps = 0;
-   decltype(blockSize) block = 0;
-   double startTime = -1.0;
-
-   while (s < len) {
-      if (block == 0) {
-         if (TrackProgress(count, s.as_double() / len.as_double() )) {
-            bGoodResult = false;
-            break;
-         }
-         block = limitSampleBufferSize( blockSize, len - s );
-         wt.GetFloats(buffer.get(), start + s, block);
-         ptr = buffer.get();
+   // Join runs that meet at the ends of chunks
+   Runs runs;
+   for (const auto &someRuns : chunkRuns)
+      for (const auto &run : someRuns) {
+         if (!runs.empty() && runs.back().first + runs.back().second == run.first)
+            runs.back().second += run.second;
+         else
+            runs.push_back(run);
       }
 
-      float v = fabs(*ptr++);
-      if (v >= MAX_AUDIO) {
-         if (startrun == 0) {
-            startTime = wt.LongSamplesToTime(start + s);
-            samps = 0;
-         }
-         else
-            stoprun = 0;
-         startrun++;
-         samps++;
+   // A label is for consecutive runs, of at least mStart samples in all,
+   // separated by fewer than mStop unclipped samples, and then followed by
+   // at least mStop
+   decltype(len) startrun = 0, samps = 0, startPos = 0;
+   for (size_t ii = 0; ii < runs.size(); ++ii) {
+      const auto [pos, length] = runs[ii];
+      if (startrun == 0) {
+         startPos = pos;
+         samps = 0;
       }
-      else {
-         if (startrun >= mStart) {
-            stoprun++;
-            samps++;
-            if (stoprun >= mStop) {
-               lt.AddLabel(
-                  SelectedRegion(startTime,
-                     wt.LongSamplesToTime(start + s - mStop)),
-                  /*!
-                   i18n-hint: Two numbers are substituted; the second is the
-                   size of a set, the first is the size of a subset, and not
-                   understood as an ordinal (i.e., not meaning "first", or
-                   "second", etc.)
-                   */
-                  XC("%lld of %lld", "find clipping")
-                     .Format(startrun.as_long_long(),
-                        (samps - mStop).as_long_long())
-                     .Translation());
-               startrun = 0;
-               stoprun = 0;
-               samps = 0;
-            }
+      startrun += length;
+      samps += length;
+
+      // Unclipped samples before the next run, or the end
+      const auto stopPos = pos + length;
+      const auto gap = (ii + 1 < runs.size() ? runs[ii + 1].first : len)
+         - stopPos;
+      if (startrun >= mStart) {
+         if (gap >= mStop) {
+            lt.AddLabel(
+               SelectedRegion(wt.LongSamplesToTime(start + startPos),
+                  wt.LongSamplesToTime(start + stopPos - 1)),
+               /*!
+                i18n-hint: Two numbers are substituted; the second is the
+                size of a set, the first is the size of a subset, and not
+                understood as an ordinal (i.e., not meaning "first", or
+                "second", etc.)
+                */
+               XC("%lld of %lld", "find clipping")
+                  .Format(startrun.as_long_long(), samps.as_long_long())
+                  .Translation());
+            startrun = 0;
          }
          else
-            startrun = 0;
+            samps += gap;
       }
-      s++;
-      block--;
+      else
+         startrun = 0;
    }
-   return bGoodResult;
+   return true;
 }
 
 std::unique_ptr<EffectEditor> EffectFindClipping::PopulateOrExchange(
@@ -18,6 +18,9 @@
 #include "EffectOutputTracks.h"
 
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <optional>
 
 #include <wx/simplebook.h>
 #include <wx/valgen.h>
@@ -26,12 +29,14 @@
 #include "Prefs.h"
 #include "../ProjectFileManager.h"
 #include "ShuttleGui.h"
-#include "WaveChannelUtilities.h"
+#include "WaveClip.h"
 #include "WaveTrack.h"
 #include "../widgets/valnum.h"
 #include "ProgressDialog.h"
+#include "RegionAnalysis.h"
 
 #include "LoadEffects.h"
+#include "concurrency/TaskScheduler.h"
 
 static const EnumValueSymbol kNormalizeTargetStrings[EffectLoudness::nAlgos] =
 {
@@ -94,6 +99,146 @@ EffectType EffectLoudness::GetType() const
 
 // Effect implementation
 
+namespace {
+//! Gating histograms of whole clips, from earlier normalizations, kept until
+//! the clip changes, so that normalizing again does not measure it again
+struct ClipLoudnessCache final : WaveClipListener
+{
+   struct Entry {
+      bool Matches(const WaveClip &clip, int iChannel) const;
+
+      //! A channel, or -1 for all channels
+      int iChannel;
+      // The clip properties that change the samples read, without
+      // MarkChanged()
+      int rate;
+      double trimLeft;
+      double trimRight;
+      double stretchRatio;
+      int centShift;
+      EBUR128::Histogram histogram;
+   };
+
+   static ClipLoudnessCache &Get(WaveClip &clip);
+
+   const EBUR128::Histogram *Find(const WaveClip &clip, int iChannel) const;
+   void Store(const WaveClip &clip, int iChannel,
+      EBUR128::Histogram histogram);
+
+   std::unique_ptr<WaveClipListener> Clone() const override;
+   void MarkChanged() noexcept override;
+   void Invalidate() override;
+   void MakeStereo(WaveClipListener &&other, bool aligned) override;
+   void SwapChannels() override;
+   void Erase(size_t index) override;
+
+   std::vector<Entry> mEntries;
+};
+
+static WaveClip::Attachments::RegisteredFactory sKeyL{ [](WaveClip &){
+   return std::make_unique<ClipLoudnessCache>();
+} };
+
+bool ClipLoudnessCache::Entry::Matches(
+   const WaveClip &clip, int iChannel) const
+{
+   return this->iChannel == iChannel &&
+      rate == clip.GetRate() &&
+      trimLeft == clip.GetTrimLeft() &&
+      trimRight == clip.GetTrimRight() &&
+      stretchRatio == clip.GetStretchRatio() &&
+      centShift == clip.GetCentShift();
+}
+
+ClipLoudnessCache &ClipLoudnessCache::Get(WaveClip &clip)
+{
+   return clip.Attachments::Get<ClipLoudnessCache>(sKeyL);
+}
+
+const EBUR128::Histogram *
+ClipLoudnessCache::Find(const WaveClip &clip, int iChannel) const
+{
+   for (auto &entry : mEntries)
+      if (entry.Matches(clip, iChannel))
+         return &entry.histogram;
+   return nullptr;
+}
+
+void ClipLoudnessCache::Store(const WaveClip &clip, int iChannel,
+   EBUR128::Histogram histogram)
+{
+   mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(),
+      [&](const Entry &entry){ return entry.iChannel == iChannel; }),
+      mEntries.end());
+   mEntries.push_back({ iChannel, clip.GetRate(),
+      clip.GetTrimLeft(), clip.GetTrimRight(),
+      clip.GetStretchRatio(), clip.GetCentShift(), std::move(histogram) });
+}
+
+std::unique_ptr<WaveClipListener> ClipLoudnessCache::Clone() const
+{
+   return std::make_unique<ClipLoudnessCache>(*this);
+}
+
+void ClipLoudnessCache::MarkChanged() noexcept
+{
+   mEntries.clear();
+}
+
+void ClipLoudnessCache::Invalidate()
+{
+   mEntries.clear();
+}
+
+void ClipLoudnessCache::MakeStereo(WaveClipListener &&, bool)
+{
+   mEntries.clear();
+}
+
+void ClipLoudnessCache::SwapChannels()
+{
+   mEntries.clear();
+}
+
+void ClipLoudnessCache::Erase(size_t)
+{
+   mEntries.clear();
+}
+
+//! The part of one clip within the selection
+struct Piece {
+   WaveClip &clip;
+   //! In samples of the track
+   sampleCount start;
+   sampleCount end;
+   //! Whether all the clip is selected, so that its loudness can be cached
+   bool whole;
+   //! Measured in MeasureLoudness(), if not found in the cache
+   std::optional<EBUR128::Histogram> histogram;
+};
+}
+
+struct EffectLoudness::Unit {
+   WaveChannel &Channel() const
+      { return *track.GetChannel(std::max(iChannel, 0)); }
+   size_t NChannels() const { return iChannel < 0 ? track.NChannels() : 1; }
+
+   WaveTrack &track;
+   //! A channel, or -1 for all channels of the track
+   int iChannel;
+   double t0;
+   double t1;
+   std::vector<Piece> pieces;
+   //! Sum for all pieces, in loudness mode
+   EBUR128::Histogram histogram;
+};
+
+struct EffectLoudness::Measurement {
+   WaveClip &clip;
+   int iChannel;
+   EBUR128::Histogram histogram;
+};
+
 bool EffectLoudness::Process(EffectInstance &, EffectSettings &)
 {
    const float ratio = DB_TO_LINEAR(
@@ -105,124 +250,118 @@ bool EffectLoudness::Process(EffectInstance &, EffectSettings &)
             std::clamp<double>(mRMSLevel, RMSLevel.min, RMSLevel.max)
    );
 
-   // Iterate over each track
    EffectOutputTracks outputs { *mTracks, GetType(), { { mT0, mT1 } } };
    bool bGoodResult = true;
    auto topMsg = XO("Normalizing Loudness...\n");
 
-   AllocBuffers(outputs.Get());
-   mProgressVal = 0;
-
+   // Find the channels to normalize together, and the parts of clips in them
+   std::vector<Unit> units;
+   mTotalLen = 0;
    for (auto pTrack : outputs.Get().Selected<WaveTrack>()) {
-      // Get start and end times from track
-      double trackStart = pTrack->GetStartTime();
-      double trackEnd = pTrack->GetEndTime();
-
       // Set the current bounds to whichever left marker is
       // greater and whichever right marker is less:
-      const double curT0 = std::max(trackStart, mT0);
-      const double curT1 = std::min(trackEnd, mT1);
-
-      // Get the track rate
-      mCurRate = pTrack->GetRate();
-
-      wxString msg;
-      auto trackName = pTrack->GetName();
-      // This affects only the progress indicator update during ProcessOne
-      mSteps = (mNormalizeTo == kLoudness) ? 2 : 1;
-
-      mProgressMsg =
-         topMsg + XO("Analyzing: %s").Format(trackName);
-
-      const auto channels = pTrack->Channels();
-      auto nChannels = mStereoInd ? 1 : channels.size();
-      mProcStereo = nChannels > 1;
+      const double curT0 = std::max(pTrack->GetStartTime(), mT0);
+      const double curT1 = std::min(pTrack->GetEndTime(), mT1);
+      // Abort if the right marker is not to the right of the left marker
+      if (curT1 <= curT0)
+         return false;
+
+      const auto start = pTrack->TimeToLongSamples(curT0);
+      const auto end = pTrack->TimeToLongSamples(curT1);
+      std::vector<Piece> pieces;
+      for (const auto &pClip : pTrack->Intervals()) {
+         const auto clipStart = pClip->GetPlayStartSample();
+         const auto clipEnd = pClip->GetPlayEndSample();
+         if (clipEnd <= start || clipStart >= end)
+            continue;
+         pieces.push_back({ *pClip,
+            std::max(start, clipStart), std::min(end, clipEnd),
+            start <= clipStart && clipEnd <= end });
+         mTotalLen += (pieces.back().end - pieces.back().start).as_double()
+            * pTrack->NChannels();
+      }
 
-      const auto processOne = [&](WaveChannel &track){
-         std::optional<EBUR128> loudnessProcessor;
-         float RMS[2];
+      if (mStereoInd)
+         for (size_t iChannel = 0; iChannel < pTrack->NChannels(); ++iChannel)
+            units.push_back({ *pTrack, int(iChannel), curT0, curT1, pieces });
+      else
+         units.push_back({ *pTrack, -1, curT0, curT1, std::move(pieces) });
+   }
 
-         if (mNormalizeTo == kLoudness) {
-            loudnessProcessor.emplace(mCurRate, nChannels);
-            if (!ProcessOne(track, nChannels,
-               curT0, curT1, 0, &*loudnessProcessor))
-               // Processing failed -> abort
-               return false;
-         }
-         else {
-            // RMS
-            if (mProcStereo) {
-               size_t idx = 0;
-               for (const auto pChannel : channels) {
-                  if (!GetTrackRMS(*pChannel, curT0, curT1, RMS[idx]))
-                     return false;
-                  ++idx;
-               }
-            }
-            else {
-               if (!GetTrackRMS(track, curT0, curT1, RMS[0]))
-                  return false;
-            }
-         }
+   AllocBuffers(outputs.Get());
+   auto cleanup = finally([&]{ FreeBuffers(); });
+   // This affects only the progress indicator update during ProcessOne
+   mSteps = (mNormalizeTo == kLoudness) ? 2 : 1;
+   mProgressVal = 0;
 
-         // Calculate normalization values the analysis results
-         float extent;
-         if (mNormalizeTo == kLoudness)
-            extent = loudnessProcessor->IntegrativeLoudness();
-         else {
-            // RMS
-            extent = RMS[0];
-            if (mProcStereo)
-               // RMS: use average RMS, average must be calculated in quadratic
-               // domain.
-               extent = sqrt((RMS[0] * RMS[0] + RMS[1] * RMS[1]) / 2.0);
-         }
+   if (mNormalizeTo == kLoudness) {
+      mProgressMsg = topMsg + XO("Analyzing...");
+      if (!MeasureLoudness(units))
+         return false;
+      mProgressVal = 1.0 / mSteps;
+   }
 
-         if (extent == 0.0) {
-            FreeBuffers();
-            return false;
-         }
-         float mult = ratio / extent;
-
-         if (mNormalizeTo == kLoudness) {
-            // Target half the LUFS value if mono (or independent processed
-            // stereo) shall be treated as dual mono.
-            if (nChannels == 1 &&
-               (mDualMono || !IsMono(track)))
-               mult /= 2.0;
-
-            // LUFS are related to square values so the multiplier must be the
-            // xroot.
-            mult = sqrt(mult);
-         }
+   // Measure RMS of all units at once.  No progress bar here as it's fast.
+   std::vector<RegionAnalysis::Result> rmsResults;
+   if (mNormalizeTo == kRMS) {
+      std::vector<RegionAnalysis::Region> regions;
+      for (const auto &unit : units)
+         regions.push_back({ unit.track, unit.iChannel, unit.t0, unit.t1 });
+      auto results = RegionAnalysis::Measure(regions, RegionAnalysis::RMS);
+      if (!results)
+         return false;
+      rmsResults = std::move(*results);
+   }
 
-         mProgressMsg = topMsg + XO("Processing: %s").Format( trackName );
-         if (!ProcessOne(track, nChannels, curT0, curT1, mult, nullptr)) {
-            // Processing failed -> abort
-            return false;
-         }
-         return true;
-      };
+   std::vector<Measurement> measurements;
+   for (size_t iUnit = 0; iUnit < units.size(); ++iUnit) {
+      auto &unit = units[iUnit];
+      const auto nChannels = unit.NChannels();
+      mProcStereo = nChannels > 1;
 
-      if (mStereoInd) {
-         for (const auto pChannel : channels)
-            if (!(bGoodResult = processOne(*pChannel)))
-               goto done;
+      // Calculate normalization values the analysis results
+      float extent;
+      if (mNormalizeTo == kLoudness)
+         extent = EBUR128::IntegrativeLoudness(unit.histogram);
+      else
+         // RMS: for stereo, the average RMS, calculated in the quadratic
+         // domain
+         extent = rmsResults[iUnit].rms.value_or(0.0f);
+
+      if (extent == 0.0)
+         return false;
+      float mult = ratio / extent;
+
+      if (mNormalizeTo == kLoudness) {
+         // Target half the LUFS value if mono (or independent processed
+         // stereo) shall be treated as dual mono.
+         if (nChannels == 1 &&
+            (mDualMono || !IsMono(unit.Channel())))
+            mult /= 2.0;
+
+         // LUFS are related to square values so the multiplier must be the
+         // xroot.
+         mult = sqrt(mult);
       }
-      else {
-         // processOne captured nChannels which is 2 and is passed to
-         // LoadBufferBlock, StoreBufferBlock which find the track from the
-         // channel and iterate channels
-         if (!(bGoodResult = processOne(**pTrack->Channels().begin())))
-            break;
+
+      mProgressMsg =
+         topMsg + XO("Processing: %s").Format( unit.track.GetName() );
+      if (!ProcessOne(unit, mult,
+         mNormalizeTo == kLoudness ? &measurements : nullptr)) {
+         // Processing failed -> abort
+         bGoodResult = false;
+         break;
       }
    }
-done:
 
-   if (bGoodResult)
+   if (bGoodResult) {
+      // Only now that no more samples change, which would empty the caches
+      for (auto &measurement : measurements)
+         ClipLoudnessCache::Get(measurement.clip).Store(measurement.clip,
+            measurement.iChannel, std::move(measurement.histogram));
       outputs.Commit();
+   }
 
-   FreeBuffers();
    return bGoodResult;
 }
 
@@ -382,66 +521,98 @@ void EffectLoudness::FreeBuffers()
    mTrackBuffer[1].reset();
 }
 
-bool EffectLoudness::GetTrackRMS(WaveChannel &track,
-   const double curT0, const double curT1, float &rms)
-{
-   // set mRMS.  No progress bar here as it's fast.
-   float _rms = WaveChannelUtilities::GetRMS(track, curT0, curT1); // may throw
-   rms = _rms;
-   return true;
-}
-
-/// ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
-/// and executes ProcessData, on it...
-///  uses mMult to normalize a track.
-///  mMult must be set before this is called
-/// In analyse mode, it executes the selected analyse operation on it...
-///  mMult does not have to be set before this is called
-bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
-   const double curT0, const double curT1, const float mult,
-   EBUR128 *pLoudnessProcessor)
+bool EffectLoudness::MeasureLoudness(std::vector<Unit> &units)
 {
-   // Transform the marker timepoints to samples
-   auto start = track.TimeToLongSamples(curT0);
-   auto end   = track.TimeToLongSamples(curT1);
+   using namespace audacity::concurrency;
 
-   // Get the length of the buffer (as double). len is
-   // used simply to calculate a progress meter, so it is easier
-   // to make it a double now than it is to do it later
-   mTrackLen = (end - start).as_double();
+   std::atomic<bool> cancelled{ false };
+   std::atomic<long long> done{ 0 };
+   double totalLen = 0;
+   {
+      TaskGroup group;
+      bool finished = false;
+      // If this thread throws, stop the workers, before the group waits
+      auto cleanup = finally([&]{
+         if (!finished)
+            cancelled = true;
+      });
+
+      for (auto &unit : units)
+         for (auto &piece : unit.pieces) {
+            if (piece.whole)
+               if (auto pHistogram = ClipLoudnessCache::Get(piece.clip)
+                  .Find(piece.clip, unit.iChannel)) {
+                  piece.histogram = *pHistogram;
+                  continue;
+               }
+            totalLen +=
+               (piece.end - piece.start).as_double() * unit.NChannels();
+            group.Run([&, &unit = unit, &piece = piece]{
+               piece.histogram = RegionAnalysis::MeasureSamples(unit.track,
+                  unit.iChannel, piece.start, piece.end, done, cancelled);
+            });
+         }
 
-   // Abort if the right marker is not to the right of the left marker
-   if (curT1 <= curT0)
+      // Report progress until all workers finish, and rethrow any
+      // exception from them
+      group.WaitPolling([&]{
+         if (!cancelled &&
+             TotalProgress(done.load() / totalLen / mSteps, mProgressMsg))
+            cancelled = true;
+      });
+      finished = true;
+   }
+   if (cancelled)
       return false;
 
-   // Go through the track one buffer at a time. s counts which
-   // sample the current buffer starts at.
-   auto s = start;
-   while (s < end) {
-      // Get a block of samples (smaller than the size of the buffer)
-      // Adjust the block size if it is the final block in the track
-      auto blockLen = limitSampleBufferSize(
-         track.GetBestBlockSize(s),
-         mTrackBufferCapacity);
-
-      const size_t remainingLen = (end - s).as_size_t();
-      blockLen = blockLen > remainingLen ? remainingLen : blockLen;
-      LoadBufferBlock(track, nChannels, s, blockLen);
-
-      // Process the buffer.
-      if (pLoudnessProcessor) {
-         if (!AnalyseBufferBlock(*pLoudnessProcessor))
-            return false;
-      }
-      else {
+   for (auto &unit : units)
+      for (auto &piece : unit.pieces)
+         EBUR128::AddHistogram(unit.histogram, *piece.histogram);
+   return true;
+}
+
+/// ProcessOne() takes the parts of clips of a unit, transforms them to bunch
+/// of buffer-blocks, and multiplies them by mult.
+/// In loudness mode, it measures again each whole clip, for the cache
+bool EffectLoudness::ProcessOne(const Unit &unit, const float mult,
+   std::vector<Measurement> *pMeasurements)
+{
+   auto &track = unit.Channel();
+   const auto nChannels = unit.NChannels();
+   for (auto &piece : unit.pieces) {
+      std::optional<EBUR128> loudnessProcessor;
+      if (pMeasurements && piece.whole)
+         loudnessProcessor.emplace(unit.track.GetRate(), nChannels);
+
+      // Go through the piece one buffer at a time. s counts which
+      // sample the current buffer starts at.
+      auto s = piece.start;
+      while (s < piece.end) {
+         // Get a block of samples (smaller than the size of the buffer)
+         // Adjust the block size if it is the final block in the piece
+         auto blockLen = limitSampleBufferSize(
+            track.GetBestBlockSize(s),
+            mTrackBufferCapacity);
+
+         const size_t remainingLen = (piece.end - s).as_size_t();
+         blockLen = blockLen > remainingLen ? remainingLen : blockLen;
+         LoadBufferBlock(track, nChannels, s, blockLen);
+
+         // Process the buffer.
          if (!ProcessBufferBlock(mult))
             return false;
+         if (loudnessProcessor)
+            AnalyseBufferBlock(*loudnessProcessor);
          if (!StoreBufferBlock(track, nChannels, s, blockLen))
             return false;
+
+         // Increment s one blockfull of samples
+         s += blockLen;
       }
 
-      // Increment s one blockfull of samples
-      s += blockLen;
+      if (loudnessProcessor)
+         pMeasurements->push_back({ piece.clip, unit.iChannel,
+            loudnessProcessor->GetHistogram() });
    }
 
    // Return true because the effect processing succeeded ... unless cancelled
@@ -467,21 +638,12 @@ void EffectLoudness::LoadBufferBlock(WaveChannel &track, size_t nChannels,
    mTrackBufferLen = len;
 }
 
-/// Calculates sample sum (for DC) and EBU R128 weighted square sum
-/// (for loudness).
-bool EffectLoudness::AnalyseBufferBlock(EBUR128 &loudnessProcessor)
+/// Calculates EBU R128 weighted square sum (for loudness).
+void EffectLoudness::AnalyseBufferBlock(EBUR128 &loudnessProcessor)
 {
-   for(size_t i = 0; i < mTrackBufferLen; i++)
-   {
-      loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[0][i], 0);
-      if (mProcStereo)
-         loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[1][i], 1);
-      loudnessProcessor.NextSample();
-   }
-
-   if (!UpdateProgress())
-      return false;
-   return true;
+   // The processor reads only as many channels as it was made for
+   const float *const channels[]{ mTrackBuffer[0].get(), mTrackBuffer[1].get() };
+   loudnessProcessor.ProcessSamples(channels, mTrackBufferLen);
 }
 
 bool EffectLoudness::ProcessBufferBlock(const float mult)
@@ -522,7 +684,7 @@ bool EffectLoudness::StoreBufferBlock(WaveChannel &track, size_t nChannels,
 bool EffectLoudness::UpdateProgress()
 {
    mProgressVal += (double(1 + mProcStereo) * double(mTrackBufferLen)
-                 / (double(GetNumWaveTracks()) * double(mSteps) * mTrackLen));
+                 / (double(mSteps) * mTotalLen));
    return !TotalProgress(mProgressVal, mProgressMsg);
 }
 
@@ -22,6 +22,8 @@
 #include "ShuttleAutomation.h"
 #include "Track.h"
 
+#include <vector>
+
 class wxChoice;
 class wxSimplebook;
 class EBUR128;
@@ -68,15 +70,20 @@ public:
 private:
    // EffectLoudness implementation
 
+   //! Channels given the same gain: a track, or one channel of it
+   struct Unit;
+   //! Measurements of whole clips, to be cached when all are done
+   struct Measurement;
+
    void AllocBuffers(TrackList &outputs);
    void FreeBuffers();
-   static bool GetTrackRMS(WaveChannel &track,
-      double curT0, double curT1, float &rms);
-   [[nodiscard]] bool ProcessOne(WaveChannel &track, size_t nChannels,
-      double curT0, double curT1, float mult, EBUR128 *pLoudnessProcessor);
+   //! Sum the gating histograms of all units, measuring clips in parallel
+   [[nodiscard]] bool MeasureLoudness(std::vector<Unit> &units);
+   [[nodiscard]] bool ProcessOne(const Unit &unit, float mult,
+      std::vector<Measurement> *pMeasurements);
    void LoadBufferBlock(WaveChannel &track, size_t nChannels,
       sampleCount pos, size_t len);
-   bool AnalyseBufferBlock(EBUR128 &loudnessProcessor);
+   void AnalyseBufferBlock(EBUR128 &loudnessProcessor);
    bool ProcessBufferBlock(float mult);
    [[nodiscard]] bool StoreBufferBlock(WaveChannel &track, size_t nChannels,
       sampleCount pos, size_t len);
@@ -98,8 +105,8 @@ private:
    double mProgressVal;
    int    mSteps;
    TranslatableString mProgressMsg;
-   double mTrackLen;
-   double mCurRate;
+   //! Samples of all channels given gain
+   double mTotalLen;
 
    wxSimplebook *mBook;
    wxChoice *mChoice;
@@ -17,6 +17,7 @@
 #include "LoadEffects.h"
 
 #include <math.h>
+#include <random>
 
 #include <wx/choice.h>
 #include <wx/textctrl.h>
@@ -103,6 +104,8 @@ bool EffectNoise::ProcessInitialize(EffectSettings &,
    double sampleRate, ChannelNames)
 {
    mSampleRate = sampleRate;
+   // A new stream for each generation, as rand() gave
+   mWhite = WhiteNoise{ std::random_device{}() };
    return true;
 }
 
@@ -113,16 +116,15 @@ size_t EffectNoise::ProcessBlock(EffectSettings &,
 
    float white;
    float amplitude;
-   float div = ((float) RAND_MAX) / 2.0f;
+
+   // White noise, of unit amplitude where the filters below shape it
+   const bool filtered = mType == kPink || mType == kBrownian;
+   mWhite.Fill(buffer, size, filtered ? 1.0f : mAmp);
 
    switch (mType)
    {
    default:
    case kWhite: // white
-       for (decltype(size) i = 0; i < size; i++)
-       {
-          buffer[i] = mAmp * ((rand() / div) - 1.0f);
-       }
        break;
 
    case kPink: // pink
@@ -132,7 +134,7 @@ size_t EffectNoise::ProcessBlock(EffectSettings &,
       amplitude = mAmp * 0.129f;
       for (decltype(size) i = 0; i < size; i++)
       {
-         white = (rand() / div) - 1.0f;
+         white = buffer[i];
          buf0 = 0.99886f * buf0 + 0.0555179f * white;
          buf1 = 0.99332f * buf1 + 0.0750759f * white;
          buf2 = 0.96900f * buf2 + 0.1538520f * white;
@@ -159,7 +161,7 @@ size_t EffectNoise::ProcessBlock(EffectSettings &,
 
       for (decltype(size) i = 0; i < size; i++)
       {
-         white = (rand() / div) - 1.0f;
+         white = buffer[i];
          z = leakage * y + white * scaling;
          y = fabs(z) > 1.0
             ? leakage * y - white * scaling
@@ -15,6 +15,7 @@
 
 #include "StatefulPerTrackEffect.h"
 #include "ShuttleAutomation.h"
+#include "WhiteNoise.h"
 #include <wx/weakref.h>
 
 class NumericTextCtrl;
@@ -64,6 +65,7 @@ private:
    int mType;
    double mAmp;
 
+   WhiteNoise mWhite;
    float y, z, buf0, buf1, buf2, buf3, buf4, buf5, buf6;
 
    NumericTextCtrl *mNoiseDurationT;
@@ -50,13 +50,20 @@
 #include "FFT.h"
 #include "Prefs.h"
 #include "RealFFTf.h"
+#include "VectorOps.h"
 #include "../SpectrumTransformer.h"
 
 #include "WaveTrack.h"
 #include "AudacityMessageBox.h"
 #include "../widgets/valnum.h"
+#include "concurrency/TaskScheduler.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <vector>
 #include <math.h>
 
@@ -251,6 +258,93 @@ EffectNoiseReduction::Settings::Settings()
    PrefsIO(true);
 }
 
+//! Synchronizes the main thread with channels reduced in other threads
+struct ChannelExchange {
+   std::mutex mutex;
+   //! Signals output, the finish of a channel, or cancellation
+   std::condition_variable condition;
+   std::atomic<bool> cancelled{ false };
+};
+
+//! Output of a channel reduced in a worker thread, which the main thread
+//! appends to the output track, because only it makes sample blocks
+class ChannelOutput final {
+public:
+   ChannelOutput(ChannelExchange &exchange, WaveChannel &channel)
+      : mExchange{ exchange }, mChannel{ channel }
+   {}
+
+   //! Called in the worker thread
+   void Put(const float *buffer, size_t len)
+   {
+      mPending.insert(mPending.end(), buffer, buffer + len);
+      if (mPending.size() >= ChunkSize)
+         Pass();
+   }
+
+   //! Called in the worker thread, last, even after failure
+   void Finish()
+   {
+      if (!mExchange.cancelled && !mPending.empty())
+         Pass();
+      std::lock_guard<std::mutex> lock{ mExchange.mutex };
+      mFinished = true;
+      mExchange.condition.notify_all();
+   }
+
+   //! Called in the main thread, to append what the worker passed
+   //! @return whether the worker finished
+   bool Drain()
+   {
+      std::deque<FloatVector> chunks;
+      {
+         std::lock_guard<std::mutex> lock{ mExchange.mutex };
+         chunks.swap(mChunks);
+         mDone = mFinished;
+         // Make room for a waiting worker
+         mExchange.condition.notify_all();
+      }
+      for (const auto &chunk : chunks)
+         mChannel.Append(reinterpret_cast<constSamplePtr>(chunk.data()),
+            floatSample, chunk.size());
+      return mDone;
+   }
+
+   //! Called in the main thread, with the mutex of the exchange locked
+   bool Ready() const { return !mDone && (mFinished || !mChunks.empty()); }
+
+   bool Cancelled() const { return mExchange.cancelled; }
+   WaveChannel &Channel() const { return mChannel; }
+
+   //! Windows processed, for the progress indicator
+   std::atomic<size_t> mWindows{ 0 };
+
+private:
+   //! Samples passed to the main thread at once
+   static constexpr size_t ChunkSize = 1 << 16;
+   //! Chunks waiting for the main thread, before the worker waits too
+   static constexpr size_t MaxChunks = 8;
+
+   void Pass()
+   {
+      std::unique_lock<std::mutex> lock{ mExchange.mutex };
+      mExchange.condition.wait(lock, [this]{
+         return mChunks.size() < MaxChunks || mExchange.cancelled; });
+      mChunks.push_back(std::move(mPending));
+      mPending = {};
+      mExchange.condition.notify_all();
+   }
+
+   ChannelExchange &mExchange;
+   WaveChannel &mChannel;
+   //! Only the worker thread touches this
+   FloatVector mPending;
+   std::deque<FloatVector> mChunks;
+   bool mFinished{ false };
+   //! Only the main thread touches this
+   bool mDone{ false };
+};
+
 struct MyTransformer : TrackSpectrumTransformer {
    MyTransformer(EffectNoiseReduction::Worker &worker,
       WaveChannel *pOutputTrack,
@@ -280,6 +374,7 @@ struct MyTransformer : TrackSpectrumTransformer {
    MyWindow &NthWindow(int nn) { return static_cast<MyWindow&>(Nth(nn)); }
    std::unique_ptr<Window> NewWindow(size_t windowSize) override;
    bool DoStart() override;
+   void DoOutput(const float *outBuffer, size_t mStepSize) override;
    bool DoFinish() override;
 
    EffectNoiseReduction::Worker &mWorker;
@@ -302,6 +397,8 @@ public:
       , double f0, double f1
 #endif
       );
+   //! For a channel reduced in another thread
+   Worker(const Worker &) = default;
    ~Worker();
 
    bool Process(eWindowFunctions inWindowType, eWindowFunctions outWindowType,
@@ -309,6 +406,18 @@ public:
 
    static bool Processor(SpectrumTransformer &transformer);
 
+private:
+   //! Reduce all channels at once in the threads of the TaskScheduler,
+   //! sharing the read-only statistics
+   bool ProcessParallel(
+      eWindowFunctions inWindowType, eWindowFunctions outWindowType,
+      TrackList &tracks, double mT0, double mT1);
+   bool CheckRate(const WaveTrack &track) const;
+   //! Denominator for progress, given the length of the selection
+   sampleCount ProgressLength(sampleCount len) const;
+
+public:
+
    void ApplyFreqSmoothing(FloatVector &gains);
    void GatherStatistics(MyTransformer &transformer);
    inline bool Classify(
@@ -345,6 +454,10 @@ public:
    unsigned  mProgressTrackCount = 0;
    sampleCount mLen = 0;
    sampleCount mProgressWindowCount = 0;
+
+   //! Not null when reducing in a worker thread, which does not report
+   //! progress or append to the output track
+   ChannelOutput *mpOutput{};
 };
 
 /****************************************************************//**
@@ -718,23 +831,54 @@ EffectNoiseReduction::Worker::~Worker()
 {
 }
 
+bool EffectNoiseReduction::Worker::CheckRate(const WaveTrack &track) const
+{
+   if (track.GetRate() != mStatistics.mRate) {
+      if (mDoProfile)
+         EffectUIServices::DoMessageBox(mEffect,
+            XO("All noise profile data must have the same sample rate.") );
+      else
+         EffectUIServices::DoMessageBox(mEffect,
+            XO(
+"The sample rate of the noise profile must match that of the sound to be processed.") );
+      return false;
+   }
+   return true;
+}
+
+sampleCount EffectNoiseReduction::Worker::ProgressLength(sampleCount len) const
+{
+   const auto extra =
+      (mSettings.StepsPerWindow() - 1) * mSettings.SpectrumSize();
+   // Adjust denominator for presence or absence of padding,
+   // which makes the number of windows visited either more or less
+   // than the number of window steps in the data.
+   if (mDoProfile)
+      return len - extra;
+   else
+      return len + extra;
+}
+
 bool EffectNoiseReduction::Worker::Process(
    eWindowFunctions inWindowType, eWindowFunctions outWindowType,
    TrackList &tracks, double inT0, double inT1)
 {
+   // Profiling accumulates into the statistics, so only reduction of
+   // several channels may go in parallel
+   if (!mDoProfile) {
+      size_t nChannels = 0;
+      for (auto track : tracks.Selected<const WaveTrack>())
+         nChannels += track->NChannels();
+      if (nChannels > 1)
+         return ProcessParallel(
+            inWindowType, outWindowType, tracks, inT0, inT1);
+   }
+
    mProgressTrackCount = 0;
    for (auto track : tracks.Selected<WaveTrack>()) {
       mProgressWindowCount = 0;
-      if (track->GetRate() != mStatistics.mRate) {
-         if (mDoProfile)
-            EffectUIServices::DoMessageBox(mEffect,
-               XO("All noise profile data must have the same sample rate.") );
-         else
-            EffectUIServices::DoMessageBox(mEffect,
-               XO(
-"The sample rate of the noise profile must match that of the sound to be processed.") );
+      if (!CheckRate(*track))
          return false;
-      }
 
       double trackStart = track->GetStartTime();
       double trackEnd = track->GetEndTime();
@@ -745,16 +889,7 @@ bool EffectNoiseReduction::Worker::Process(
          auto start = track->TimeToLongSamples(t0);
          auto end = track->TimeToLongSamples(t1);
          const auto len = end - start;
-         mLen = len;
-         const auto extra =
-            (mSettings.StepsPerWindow() - 1) * mSettings.SpectrumSize();
-         // Adjust denominator for presence or absence of padding,
-         // which makes the number of windows visited either more or less
-         // than the number of window steps in the data.
-         if (mDoProfile)
-            mLen -= extra;
-         else
-            mLen += extra;
+         mLen = ProgressLength(len);
 
          auto t0 = track->LongSamplesToTime(start);
          auto tLen = track->LongSamplesToTime(len);
@@ -799,6 +934,132 @@ bool EffectNoiseReduction::Worker::Process(
    return true;
 }
 
+bool EffectNoiseReduction::Worker::ProcessParallel(
+   eWindowFunctions inWindowType, eWindowFunctions outWindowType,
+   TrackList &tracks, double inT0, double inT1)
+{
+   using namespace audacity::concurrency;
+
+   struct TrackRange {
+      WaveTrack &track;
+      sampleCount start;
+      sampleCount len;
+      WaveTrack::Holder pTempTrack;
+   };
+   struct ChannelJob {
+      ChannelJob(const Worker &worker,
+         std::shared_ptr<const WaveChannel> pInput,
+         sampleCount start, sampleCount len,
+         ChannelExchange &exchange, WaveChannel &outputChannel
+      )  : worker{ worker }, pInput{ std::move(pInput) }
+         , start{ start }, len{ len }
+         , output{ exchange, outputChannel }
+      {}
+      Worker worker;
+      std::shared_ptr<const WaveChannel> pInput;
+      sampleCount start;
+      sampleCount len;
+      ChannelOutput output;
+   };
+
+   ChannelExchange exchange;
+   std::vector<TrackRange> ranges;
+   std::vector<std::unique_ptr<ChannelJob>> jobs;
+   double totalLen = 0;
+   for (auto track : tracks.Selected<WaveTrack>()) {
+      if (!CheckRate(*track))
+         return false;
+      const double t0 = std::max(track->GetStartTime(), inT0);
+      const double t1 = std::min(track->GetEndTime(), inT1);
+      if (!(t1 > t0))
+         continue;
+      const auto start = track->TimeToLongSamples(t0);
+      const auto len = track->TimeToLongSamples(t1) - start;
+      auto &range = ranges.emplace_back(
+         TrackRange{ *track, start, len, track->EmptyCopy() });
+      auto iter = range.pTempTrack->Channels().begin();
+      for (const auto pChannel : track->Channels()) {
+         auto &job = *jobs.emplace_back(std::make_unique<ChannelJob>(
+            *this, pChannel, start, len, exchange, **iter++));
+         job.worker.mLen = ProgressLength(len);
+         job.worker.mpOutput = &job.output;
+         totalLen += job.worker.mLen.as_double();
+      }
+   }
+
+   {
+      TaskGroup group;
+      bool finished = false;
+      // If this thread throws, stop the workers, before the group waits
+      auto cleanup = finally([&]{
+         if (!finished) {
+            std::lock_guard<std::mutex> lock{ exchange.mutex };
+            exchange.cancelled = true;
+            exchange.condition.notify_all();
+         }
+      });
+
+      for (auto &pJob : jobs)
+         group.Run([this, &job = *pJob, &exchange,
+            inWindowType, outWindowType
+         ]{
+            bool success = false;
+            auto finish = finally([&]{
+               if (!success)
+                  exchange.cancelled = true;
+               job.output.Finish();
+            });
+            MyTransformer transformer{ job.worker, &job.output.Channel(),
+               true, inWindowType, outWindowType,
+               mSettings.WindowSize(), mSettings.StepsPerWindow(), true, true
+            };
+            success = transformer.Process(Processor,
+               *job.pInput, mHistoryLen, job.start, job.len);
+         });
+
+      // Append the output, and report progress, until all workers finish;
+      // don't Wait() on the group first, which could run a task here
+      const auto stepSize = mSettings.StepSize();
+      while (true) {
+         bool allFinished = true;
+         double done = 0;
+         for (auto &pJob : jobs) {
+            allFinished = pJob->output.Drain() && allFinished;
+            done += pJob->output.mWindows * stepSize;
+         }
+         if (allFinished) {
+            finished = true;
+            break;
+         }
+         if (!exchange.cancelled &&
+             mEffect.TotalProgress(std::min(1.0, done / totalLen))) {
+            std::lock_guard<std::mutex> lock{ exchange.mutex };
+            exchange.cancelled = true;
+            exchange.condition.notify_all();
+         }
+         std::unique_lock<std::mutex> lock{ exchange.mutex };
+         exchange.condition.wait_for(lock, std::chrono::milliseconds{ 100 },
+            [&]{ return std::any_of(jobs.begin(), jobs.end(),
+               [](auto &pJob){ return pJob->output.Ready(); }); });
+      }
+      // Rethrow any exception from the workers
+      group.Wait();
+   }
+   if (exchange.cancelled)
+      return false;
+
+   for (auto &range : ranges) {
+      TrackSpectrumTransformer::PostProcess(*range.pTempTrack, range.len);
+      constexpr auto preserveSplits = true;
+      constexpr auto merge = true;
+      const auto t0 = range.track.LongSamplesToTime(range.start);
+      const auto tLen = range.track.LongSamplesToTime(range.len);
+      range.track.ClearAndPaste(
+         t0, t0 + tLen, *range.pTempTrack, preserveSplits, merge);
+   }
+   return true;
+}
+
 void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
 {
    // Given an array of gain mutipliers, average them
@@ -810,22 +1071,19 @@ void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
 
    const auto spectrumSize = mSettings.SpectrumSize();
 
-   {
-      auto pScratch = mFreqSmoothingScratch.data();
-      std::fill(pScratch, pScratch + spectrumSize, 0.0f);
-   }
-
    for (size_t ii = 0; ii < spectrumSize; ++ii)
       gains[ii] = log(gains[ii]);
 
-   // ii must be signed
-   for (int ii = 0; ii < (int)spectrumSize; ++ii) {
-      const int j0 = std::max(0, ii - (int)mFreqSmoothingBins);
-      const int j1 = std::min(spectrumSize - 1, ii + mFreqSmoothingBins);
-      for(int jj = j0; jj <= j1; ++jj) {
-         mFreqSmoothingScratch[ii] += gains[jj];
-      }
-      mFreqSmoothingScratch[ii] /= (j1 - j0 + 1);
+   // A running sum over the window of bins [j0, j1), as it slides
+   double sum = 0;
+   size_t j0 = 0, j1 = 0;
+   for (size_t ii = 0; ii < spectrumSize; ++ii) {
+      const auto end = std::min(spectrumSize, ii + mFreqSmoothingBins + 1);
+      for (; j1 < end; ++j1)
+         sum += gains[j1];
+      for (; j0 + mFreqSmoothingBins < ii; ++j0)
+         sum -= gains[j0];
+      mFreqSmoothingScratch[ii] = sum / (j1 - j0);
    }
 
    for (size_t ii = 0; ii < spectrumSize; ++ii)
@@ -925,11 +1183,10 @@ bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
       float *pSpectrum = &record.mSpectrums[0];
       const double dc = record.mRealFFTs[0];
       *pSpectrum++ = dc * dc;
-      float *pReal = &record.mRealFFTs[1], *pImag = &record.mImagFFTs[1];
-      for (size_t nn = worker.mSettings.SpectrumSize() - 2; nn--;) {
-         const double re = *pReal++, im = *pImag++;
-         *pSpectrum++ = re * re + im * im;
-      }
+      const auto nn = worker.mSettings.SpectrumSize() - 2;
+      VectorOps::PowerSpectrum(
+         &record.mRealFFTs[1], &record.mImagFFTs[1], pSpectrum, nn);
+      pSpectrum += nn;
       const double nyquist = record.mImagFFTs[0];
       *pSpectrum = nyquist * nyquist;
    }
@@ -939,6 +1196,12 @@ bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
    else
       worker.ReduceNoise(transformer);
 
+   if (const auto pOutput = worker.mpOutput) {
+      // In a worker thread; the main thread reports progress
+      ++pOutput->mWindows;
+      return !pOutput->Cancelled();
+   }
+
    // Update the Progress meter, let user cancel
    return !worker.mEffect.TrackProgress(worker.mProgressTrackCount,
       std::min(1.0,
@@ -975,9 +1238,7 @@ void EffectNoiseReduction::Worker::GatherStatistics(MyTransformer &transformer)
       // NEW statistics
       auto pPower = transformer.NthWindow(0).mSpectrums.data();
       auto pSum = mStatistics.mSums.data();
-      for (size_t jj = 0; jj < mSettings.SpectrumSize(); ++jj) {
-         *pSum++ += *pPower++;
-      }
+      VectorOps::Add(pPower, pSum, mSettings.SpectrumSize());
    }
 
 #ifdef OLD_METHOD_AVAILABLE
@@ -1151,13 +1412,8 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
       {
          auto pNextGain = transformer.NthWindow(mCenter - 1).mGains.data();
          auto pThisGain = transformer.NthWindow(mCenter).mGains.data();
-         for (auto nn = mSettings.SpectrumSize(); nn--;) {
-            *pNextGain =
-               std::max(*pNextGain,
-                        std::max(mNoiseAttenFactor,
-                                 *pThisGain++ * mOneBlockRelease));
-            ++pNextGain;
-         }
+         VectorOps::MaxOfScaled(pThisGain, mOneBlockRelease,
+            mNoiseAttenFactor, pNextGain, mSettings.SpectrumSize());
       }
    }
 
@@ -1178,23 +1434,17 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
          float *pImag = &record.mImagFFTs[1];
          auto nn = mSettings.SpectrumSize() - 2;
          if (mNoiseReductionChoice == NRC_LEAVE_RESIDUE) {
-            for (; nn--;) {
-               // Subtract the gain we would otherwise apply from 1, and
-               // negate that to flip the phase.
-               const double gain = *pGain++ - 1.0;
-               *pReal++ *= gain;
-               *pImag++ *= gain;
-            }
+            // Subtract the gain we would otherwise apply from 1, and
+            // negate that to flip the phase.
+            VectorOps::MultiplyShifted(pGain, -1.0f, pReal, nn);
+            VectorOps::MultiplyShifted(pGain, -1.0f, pImag, nn);
             record.mRealFFTs[0] *= (record.mGains[0] - 1.0);
             // The Fs/2 component is stored as the imaginary part of the DC component
             record.mImagFFTs[0] *= (record.mGains[last] - 1.0);
          }
          else {
-            for (; nn--;) {
-               const double gain = *pGain++;
-               *pReal++ *= gain;
-               *pImag++ *= gain;
-            }
+            VectorOps::Multiply(pGain, pReal, nn);
+            VectorOps::Multiply(pGain, pImag, nn);
             record.mRealFFTs[0] *= record.mGains[0];
             // The Fs/2 component is stored as the imaginary part of the DC component
             record.mImagFFTs[0] *= record.mGains[last];
@@ -1203,6 +1453,14 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
    }
 }
 
+void MyTransformer::DoOutput(const float *outBuffer, size_t mStepSize)
+{
+   if (const auto pOutput = mWorker.mpOutput)
+      pOutput->Put(outBuffer, mStepSize);
+   else
+      TrackSpectrumTransformer::DoOutput(outBuffer, mStepSize);
+}
+
 bool MyTransformer::DoFinish()
 {
    if (mWorker.mDoProfile)
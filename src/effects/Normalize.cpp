@@ -339,6 +339,15 @@ bool EffectNormalize::AnalyseTrackData(const WaveChannel &track,
 {
    bool rc = true;
 
+   // Whole sample blocks know their sums, so that only the samples of
+   // partial blocks at the ends of clips need be read
+   if (const auto result = WaveChannelUtilities::GetSum(track, curT0, curT1))
+   {
+      const auto [sum, totalSamples] = *result;
+      offset = totalSamples > 0 ? -sum / totalSamples.as_double() : 0.0;
+      return report(1.0);
+   }
+
    //Transform the marker timepoints to samples
    auto start = track.TimeToLongSamples(curT0);
    auto end = track.TimeToLongSamples(curT1);
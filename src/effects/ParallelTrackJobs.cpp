@@ -0,0 +1,78 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ParallelTrackJobs.cpp
+
+**********************************************************************/
+#include "ParallelTrackJobs.h"
+
+#include "Effect.h"
+#include "WaveTrack.h"
+#include "concurrency/TaskScheduler.h"
+
+#include <deque>
+#include <mutex>
+
+struct TrackJobContext::Shared {
+   std::mutex appendMutex;
+   std::atomic<bool> cancelled{ false };
+};
+
+void TrackJobContext::SetProgress(double fraction)
+{
+   mFraction.store(fraction, std::memory_order_relaxed);
+}
+
+double TrackJobContext::GetProgress() const
+{
+   return mFraction.load(std::memory_order_relaxed);
+}
+
+bool TrackJobContext::IsCancelled() const
+{
+   return mShared.cancelled.load(std::memory_order_relaxed);
+}
+
+void TrackJobContext::Append(
+   WaveChannel &channel, const float *buffer, size_t len)
+{
+   std::lock_guard<std::mutex> lock{ mShared.appendMutex };
+   channel.Append(reinterpret_cast<constSamplePtr>(buffer), floatSample, len);
+}
+
+void TrackJobContext::Flush(WaveTrack &track)
+{
+   std::lock_guard<std::mutex> lock{ mShared.appendMutex };
+   track.Flush();
+}
+
+bool RunTrackJobs(const Effect &effect, size_t nJobs,
+   const std::function<void(size_t iJob, TrackJobContext &context)> &job)
+{
+   if (nJobs == 0)
+      return true;
+
+   TrackJobContext::Shared shared;
+   // Contexts can't move, so don't keep them in a vector
+   std::deque<TrackJobContext> contexts;
+   for (size_t iJob = 0; iJob < nJobs; ++iJob)
+      contexts.emplace_back(shared);
+
+   audacity::concurrency::TaskGroup group;
+   for (size_t iJob = 0; iJob < nJobs; ++iJob)
+      group.Run([&, iJob]{
+         if (!shared.cancelled.load(std::memory_order_relaxed))
+            job(iJob, contexts[iJob]);
+      });
+   group.WaitPolling([&]{
+      if (shared.cancelled.load(std::memory_order_relaxed))
+         return;
+      double total = 0;
+      for (const auto &context : contexts)
+         total += context.GetProgress();
+      if (effect.TotalProgress(total / nJobs))
+         shared.cancelled.store(true, std::memory_order_relaxed);
+   });
+   return !shared.cancelled.load(std::memory_order_relaxed);
+}
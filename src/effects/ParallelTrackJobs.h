@@ -0,0 +1,53 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ParallelTrackJobs.h
+
+**********************************************************************/
+#ifndef __AUDACITY_PARALLEL_TRACK_JOBS__
+#define __AUDACITY_PARALLEL_TRACK_JOBS__
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+class Effect;
+class WaveChannel;
+class WaveTrack;
+
+//! What one of the jobs of RunTrackJobs() may use
+class TrackJobContext final {
+public:
+   struct Shared;
+   explicit TrackJobContext(Shared &shared) : mShared{ shared } {}
+
+   //! Fraction between 0.0 and 1.0 of the job done
+   void SetProgress(double fraction);
+   double GetProgress() const;
+   //! The job should return soon if true
+   bool IsCancelled() const;
+
+   //! Append to a track that only this job writes
+   /*!
+    Jobs take turns, because making sample blocks is not thread-safe, but
+    they may read their sources at once
+    */
+   void Append(WaveChannel &channel, const float *buffer, size_t len);
+   void Flush(WaveTrack &track);
+
+private:
+   Shared &mShared;
+   std::atomic<double> mFraction{ 0 };
+};
+
+//! Run jobs in worker threads, as for the tracks of an effect, while the
+//! calling thread reports the average of their progress to the effect
+/*!
+ @return false if the user cancelled
+ @throws the first exception from a job
+ */
+bool RunTrackJobs(const Effect &effect, size_t nJobs,
+   const std::function<void(size_t iJob, TrackJobContext &context)> &job);
+
+#endif
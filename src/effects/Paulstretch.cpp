@@ -19,6 +19,9 @@
 #include "LoadEffects.h"
 
 #include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
 
 #include <math.h>
 
@@ -33,6 +36,8 @@
 #include "TimeWarper.h"
 
 #include "WaveTrack.h"
+#include "WindowTable.h"
+#include "concurrency/TaskScheduler.h"
 
 const EffectParameterMethods& EffectPaulstretch::Parameters() const
 {
@@ -44,6 +49,11 @@ const EffectParameterMethods& EffectPaulstretch::Parameters() const
 
 /// \brief Class that helps EffectPaulStretch.  It does the FFTs and inner loop
 /// of the effect.
+/*!
+ Each frame of output depends only on a window of the input and on random
+ phases, so that frames may be computed in parallel by process_frame(), then
+ overlapped in order by add_frame()
+ */
 class PaulStretch
 {
 public:
@@ -51,13 +61,26 @@ public:
    //in_bufsize is also a half of a FFT buffer (in samples)
    virtual ~PaulStretch();
 
-   void process(float *smps, size_t nsmps);
+   //! Work space of process_frame(), one for each frame done at once
+   struct Spectra {
+      explicit Spectra(size_t poolsize);
+      Floats fft_c, fft_s, fft_freq, fft_tmp;
+   };
+
+   //! Replace poolsize samples of input with the frame of output
+   /*!
+    Does not change this object, and so may be called in several threads
+    @param seed for the random phases
+    */
+   void process_frame(float *smps, Spectra &spectra, unsigned seed) const;
+   //! Overlap the next frame with the previous, to make out_buf
+   void add_frame(const float *frame);
 
    size_t get_nsamples();//how many samples are required to be added in the pool next time
    size_t get_nsamples_for_fill();//how many samples are required to be added for a complete buffer refill (at start of the song or after seek)
 
 private:
-   void process_spectrum(float *WXUNUSED(freq)) {};
+   void process_spectrum(float *WXUNUSED(freq)) const {};
 
    const float samplerate;
    const float rap;
@@ -74,11 +97,9 @@ public:
    const size_t poolsize;//how many samples are inside the input_pool size (need to know how many samples to fill when seeking)
 
 private:
-   const Floats in_pool;//de marimea in_bufsize
-
    double remained_samples;//how many fraction of samples has remained (0..1)
 
-   const Floats fft_smps, fft_c, fft_s, fft_freq, fft_tmp;
+   const WindowTable window;
 };
 
 //
@@ -347,61 +368,106 @@ bool EffectPaulstretch::ProcessOne(const WaveChannel &track,
       // This encloses all the allocations of buffers, including those in
       // the constructor of the PaulStretch object
 
+      using namespace audacity::concurrency;
+
       PaulStretch stretch(amount, stretch_buf_size, rate);
 
       auto nget = stretch.get_nsamples_for_fill();
 
       auto bufsize = stretch.poolsize;
-      Floats buffer0{ bufsize };
-      float *bufferptr0 = buffer0.get();
-      bool first_time = true;
-
       const auto fade_len = std::min<size_t>(100, bufsize / 2 - 1);
       bool cancelled = false;
 
+      // Frames are computed in batches, in parallel; the batch is limited
+      // in memory too, because frames may be long
+      constexpr size_t maxBatchBytes = 64 * 1024 * 1024;
+      const auto batchSize = std::clamp<size_t>(
+         maxBatchBytes / (5 * bufsize * sizeof(float)),
+         1, 2 * TaskScheduler::Get().ThreadCount());
+      std::vector<Floats> frames;
+      std::vector<PaulStretch::Spectra> spectra;
+      for (size_t ii = 0; ii < batchSize; ++ii) {
+         frames.emplace_back(bufsize);
+         spectra.emplace_back(bufsize);
+      }
+      // Where the input of each frame ends, relative to start, and the seed
+      // of its phases
+      std::vector<std::pair<sampleCount, unsigned>> batch;
+
       {
          Floats fade_track_smps{ fade_len };
-         decltype(len) s=0;
-
-         while (s < len) {
-            track.GetFloats(bufferptr0, start + s, nget);
-            stretch.process(buffer0.get(), nget);
-
-            if (first_time) {
-               stretch.process(buffer0.get(), 0);
-            };
+         decltype(len) s = nget;
+         bool more = true;
+
+         // The first frame is done twice, the first time only for the
+         // overlap with the second
+         bool warm_up = true;
+         bool first_time = true;
+         batch.emplace_back(s, rand());
+
+         while (more) {
+            // The inputs of frames are found in series, because the length
+            // of each depends on the previous
+            while (more && batch.size() < batchSize) {
+               batch.emplace_back(s, rand());
+               if (s >= len)
+                  more = false;
+               else
+                  s += stretch.get_nsamples();
+            }
 
-            s += nget;
+            {
+               TaskGroup group;
+               for (size_t ii = 0; ii < batch.size(); ++ii)
+                  group.Run([&, ii]{
+                     const auto frame = frames[ii].get();
+                     track.GetFloats(
+                        frame, start + batch[ii].first - bufsize, bufsize);
+                     stretch.process_frame(
+                        frame, spectra[ii], batch[ii].second);
+                  });
+               group.Wait();
+            }
 
-            if (first_time){//blend the start of the selection
-               track.GetFloats(fade_track_smps.get(), start, fade_len);
-               first_time = false;
-               for (size_t i = 0; i < fade_len; i++){
-                  float fi = (float)i / (float)fade_len;
-                  stretch.out_buf[i] =
-                     stretch.out_buf[i] * fi + (1.0 - fi) * fade_track_smps[i];
+            for (size_t ii = 0; ii < batch.size(); ++ii) {
+               stretch.add_frame(frames[ii].get());
+               if (warm_up) {
+                  warm_up = false;
+                  continue;
                }
-            }
-            if (s >= len){//blend the end of the selection
-               track.GetFloats(fade_track_smps.get(), end - fade_len, fade_len);
-               for (size_t i = 0; i < fade_len; i++){
-                  float fi = (float)i / (float)fade_len;
-                  auto i2 = bufsize / 2 - 1 - i;
-                  stretch.out_buf[i2] =
-                     stretch.out_buf[i2] * fi + (1.0 - fi) *
-                     fade_track_smps[fade_len - 1 - i];
+               const auto end_s = batch[ii].first;
+
+               if (first_time){//blend the start of the selection
+                  track.GetFloats(fade_track_smps.get(), start, fade_len);
+                  first_time = false;
+                  for (size_t i = 0; i < fade_len; i++){
+                     float fi = (float)i / (float)fade_len;
+                     stretch.out_buf[i] =
+                        stretch.out_buf[i] * fi + (1.0 - fi) * fade_track_smps[i];
+                  }
+               }
+               if (end_s >= len){//blend the end of the selection
+                  track.GetFloats(fade_track_smps.get(), end - fade_len, fade_len);
+                  for (size_t i = 0; i < fade_len; i++){
+                     float fi = (float)i / (float)fade_len;
+                     auto i2 = bufsize / 2 - 1 - i;
+                     stretch.out_buf[i2] =
+                        stretch.out_buf[i2] * fi + (1.0 - fi) *
+                        fade_track_smps[fade_len - 1 - i];
+                  }
                }
-            }
 
-            outputTrack.Append((samplePtr)stretch.out_buf.get(), floatSample, stretch.out_bufsize);
+               outputTrack.Append((samplePtr)stretch.out_buf.get(), floatSample, stretch.out_bufsize);
 
-            nget = stretch.get_nsamples();
-            if (TrackProgress(count,
-               s.as_double() / len.as_double()
-            )) {
-               cancelled = true;
-               break;
+               if (TrackProgress(count,
+                  end_s.as_double() / len.as_double()
+               )) {
+                  cancelled = true;
+                  more = false;
+                  break;
+               }
             }
+            batch.clear();
          }
       }
 
@@ -425,13 +491,8 @@ PaulStretch::PaulStretch(float rap_, size_t in_bufsize_, float samplerate_ )
    , out_buf { out_bufsize }
    , old_out_smp_buf { out_bufsize * 2, true }
    , poolsize { in_bufsize_ * 2 }
-   , in_pool { poolsize, true }
    , remained_samples { 0.0 }
-   , fft_smps { poolsize, true }
-   , fft_c { poolsize, true }
-   , fft_s { poolsize, true }
-   , fft_freq { poolsize, true }
-   , fft_tmp { poolsize }
+   , window { GetWindowFuncTable(eWinFuncHann, poolsize) }
 {
 }
 
@@ -439,40 +500,38 @@ PaulStretch::~PaulStretch()
 {
 }
 
-void PaulStretch::process(float *smps, size_t nsmps)
+PaulStretch::Spectra::Spectra(size_t poolsize)
+   : fft_c { poolsize }
+   , fft_s { poolsize }
+   , fft_freq { poolsize }
+   , fft_tmp { poolsize }
 {
-   //add NEW samples to the pool
-   if ((smps != NULL) && (nsmps != 0)) {
-      if (nsmps > poolsize) {
-         nsmps = poolsize;
-      }
-      int nleft = poolsize - nsmps;
-
-      //move left the samples from the pool to make room for NEW samples
-      for (int i = 0; i < nleft; i++)
-         in_pool[i] = in_pool[i + nsmps];
+}
 
-      //add NEW samples to the pool
-      for (size_t i = 0; i < nsmps; i++)
-         in_pool[i + nleft] = smps[i];
-   }
+void PaulStretch::process_frame(
+   float *smps, Spectra &spectra, unsigned seed) const
+{
+   const auto fft_c = spectra.fft_c.get();
+   const auto fft_s = spectra.fft_s.get();
+   const auto fft_freq = spectra.fft_freq.get();
 
-   //get the samples from the pool
+   //get the windowed samples
+   const float *const pWindow = window->data();
    for (size_t i = 0; i < poolsize; i++)
-      fft_smps[i] = in_pool[i];
-   WindowFunc(eWinFuncHann, poolsize, fft_smps.get());
+      smps[i] *= pWindow[i];
 
-   RealFFT(poolsize, fft_smps.get(), fft_c.get(), fft_s.get());
+   RealFFT(poolsize, smps, fft_c, fft_s);
 
    for (size_t i = 0; i < poolsize / 2; i++)
       fft_freq[i] = sqrt(fft_c[i] * fft_c[i] + fft_s[i] * fft_s[i]);
-   process_spectrum(fft_freq.get());
+   process_spectrum(fft_freq);
 
 
    //put randomize phases to frequencies and do a IFFT
+   std::minstd_rand engine{ seed };
    float inv_2p15_2pi = 1.0 / 16384.0 * (float)M_PI;
    for (size_t i = 1; i < poolsize / 2; i++) {
-      unsigned int random = (rand()) & 0x7fff;
+      unsigned int random = engine() & 0x7fff;
       float phase = random * inv_2p15_2pi;
       float s = fft_freq[i] * sin(phase);
       float c = fft_freq[i] * cos(phase);
@@ -484,15 +543,11 @@ void PaulStretch::process(float *smps, size_t nsmps)
    fft_c[0] = fft_s[0] = 0.0;
    fft_c[poolsize / 2] = fft_s[poolsize / 2] = 0.0;
 
-   FFT(poolsize, true, fft_c.get(), fft_s.get(), fft_smps.get(), fft_tmp.get());
-
-   float max = 0.0, max2 = 0.0;
-   for (size_t i = 0; i < poolsize; i++) {
-      max = std::max(max, fabsf(fft_tmp[i]));
-      max2 = std::max(max2, fabsf(fft_smps[i]));
-   }
-
+   FFT(poolsize, true, fft_c, fft_s, smps, spectra.fft_tmp.get());
+}
 
+void PaulStretch::add_frame(const float *frame)
+{
    //make the output buffer
    float tmp = 1.0 / (float) out_bufsize * M_PI;
    float hinv_sqrt2 = 0.853553390593f;//(1.0+1.0/sqrt(2))*0.5;
@@ -505,7 +560,7 @@ void PaulStretch::process(float *smps, size_t nsmps)
 
    for (size_t i = 0; i < out_bufsize; i++) {
       float a = (0.5 + 0.5 * cos(i * tmp));
-      float out = fft_smps[i + out_bufsize] * (1.0 - a) + old_out_smp_buf[i] * a;
+      float out = frame[i + out_bufsize] * (1.0 - a) + old_out_smp_buf[i] * a;
       out_buf[i] =
          out * (hinv_sqrt2 - (1.0 - hinv_sqrt2) * cos(i * 2.0 * tmp)) *
          ampfactor;
@@ -513,7 +568,7 @@ void PaulStretch::process(float *smps, size_t nsmps)
 
    //copy the current output buffer to old buffer
    for (size_t i = 0; i < out_bufsize * 2; i++)
-      old_out_smp_buf[i] = fft_smps[i];
+      old_out_smp_buf[i] = frame[i];
 }
 
 size_t PaulStretch::get_nsamples()
@@ -0,0 +1,176 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RegionAnalysis.cpp
+
+**********************************************************************/
+#include "RegionAnalysis.h"
+
+#include "MemoryX.h"
+#include "WaveChannelUtilities.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+#include "concurrency/TaskScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+size_t NChannels(const RegionAnalysis::Region &region)
+{
+   return region.iChannel < 0 ? region.track.NChannels() : 1;
+}
+
+float MeasureRMS(const RegionAnalysis::Region &region, double t0, double t1,
+   bool mayThrow)
+{
+   // For stereo tracks: sqrt((mean(L)+mean(R))/2)
+   double meanSq = 0.0;
+   const auto measure = [&](const WaveChannel &channel) {
+      const auto rms = WaveChannelUtilities::GetRMS(channel, t0, t1, mayThrow);
+      meanSq += rms * rms;
+   };
+   if (region.iChannel < 0)
+      for (const auto pChannel : region.track.Channels())
+         measure(*pChannel);
+   else
+      measure(*region.track.GetChannel(region.iChannel));
+   return meanSq > 0.0 ? sqrt(meanSq / NChannels(region)) : 0.0;
+}
+}
+
+auto RegionAnalysis::Measure(const std::vector<Region> &regions,
+   unsigned measurements, const ProgressReport &report, bool mayThrow)
+   -> std::optional<std::vector<Result>>
+{
+   using namespace audacity::concurrency;
+
+   //! The part of one clip within a region
+   struct Piece {
+      size_t iRegion;
+      sampleCount start;
+      sampleCount end;
+      std::optional<EBUR128::Histogram> histogram;
+   };
+
+   // Ignore whitespace beyond ends of tracks
+   struct Bounds { double t0, t1; };
+   std::vector<std::optional<Bounds>> bounds(regions.size());
+   std::vector<Piece> pieces;
+   double totalLen = 0;
+   for (size_t iRegion = 0; iRegion < regions.size(); ++iRegion) {
+      const auto &region = regions[iRegion];
+      const auto &track = region.track;
+      const auto t0 = std::max(region.t0, track.GetStartTime());
+      const auto t1 = std::min(region.t1, track.GetEndTime());
+      const auto start = track.TimeToLongSamples(t0);
+      const auto end = track.TimeToLongSamples(t1);
+      if (start >= end)
+         continue;
+      bounds[iRegion] = { t0, t1 };
+
+      if (!(measurements & Loudness))
+         continue;
+      for (const auto &pClip : track.Intervals()) {
+         const auto clipStart = pClip->GetPlayStartSample();
+         const auto clipEnd = pClip->GetPlayEndSample();
+         if (clipEnd <= start || clipStart >= end)
+            continue;
+         pieces.push_back({ iRegion,
+            std::max(start, clipStart), std::min(end, clipEnd) });
+         totalLen += (pieces.back().end - pieces.back().start).as_double()
+            * NChannels(region);
+      }
+   }
+
+   std::vector<Result> results(regions.size());
+   std::atomic<bool> cancelled{ false };
+   std::atomic<long long> done{ 0 };
+   {
+      TaskGroup group;
+      bool finished = false;
+      // If this thread throws, stop the workers, before the group waits
+      auto cleanup = finally([&]{
+         if (!finished)
+            cancelled = true;
+      });
+
+      if (measurements & RMS)
+         for (size_t iRegion = 0; iRegion < regions.size(); ++iRegion)
+            if (const auto &pBounds = bounds[iRegion])
+               group.Run([&, iRegion, b = *pBounds]{
+                  results[iRegion].rms =
+                     MeasureRMS(regions[iRegion], b.t0, b.t1, mayThrow);
+               });
+
+      for (auto &piece : pieces)
+         group.Run([&, &piece = piece]{
+            const auto &region = regions[piece.iRegion];
+            piece.histogram = MeasureSamples(region.track, region.iChannel,
+               piece.start, piece.end, done, cancelled);
+         });
+
+      // Report progress until all workers finish, and rethrow any
+      // exception from them
+      group.WaitPolling([&]{
+         if (!cancelled && report &&
+             report(totalLen > 0 ? done.load() / totalLen : 1.0))
+            cancelled = true;
+      });
+      finished = true;
+   }
+   if (cancelled)
+      return {};
+
+   if (measurements & Loudness) {
+      std::vector<EBUR128::Histogram> histograms(regions.size());
+      for (const auto &piece : pieces)
+         EBUR128::AddHistogram(histograms[piece.iRegion], *piece.histogram);
+      for (size_t iRegion = 0; iRegion < regions.size(); ++iRegion)
+         if (bounds[iRegion]) {
+            const auto loudness =
+               EBUR128::IntegrativeLoudness(histograms[iRegion]);
+            results[iRegion].lufs = loudness > 0
+               ? 10 * log10(loudness)
+               : -std::numeric_limits<double>::infinity();
+         }
+   }
+   return results;
+}
+
+std::optional<EBUR128::Histogram> RegionAnalysis::MeasureSamples(
+   const WaveTrack &track, int iChannel, sampleCount start, sampleCount end,
+   std::atomic<long long> &done, const std::atomic<bool> &cancelled)
+{
+   std::vector<std::shared_ptr<const WaveChannel>> channels;
+   if (iChannel < 0)
+      for (const auto pChannel : track.Channels())
+         channels.push_back(pChannel);
+   else
+      channels.push_back(track.GetChannel(iChannel));
+   const auto nChannels = channels.size();
+
+   EBUR128 loudnessProcessor{ track.GetRate(), nChannels };
+   const auto capacity = track.GetMaxBlockSize();
+   std::vector<Floats> buffers(nChannels);
+   std::vector<const float *> pointers;
+   for (auto &buffer : buffers) {
+      buffer.reinit(capacity);
+      pointers.push_back(buffer.get());
+   }
+
+   for (auto s = start; s < end;) {
+      if (cancelled)
+         return {};
+      const auto len = limitSampleBufferSize(
+         std::min(channels[0]->GetBestBlockSize(s), capacity), end - s);
+      for (size_t iBuffer = 0; iBuffer < nChannels; ++iBuffer)
+         channels[iBuffer]->GetFloats(buffers[iBuffer].get(), s, len);
+      loudnessProcessor.ProcessSamples(pointers.data(), len);
+      done += len * nChannels;
+      s += len;
+   }
+   return loudnessProcessor.GetHistogram();
+}
@@ -0,0 +1,78 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RegionAnalysis.h
+
+**********************************************************************/
+#ifndef __AUDACITY_REGION_ANALYSIS__
+#define __AUDACITY_REGION_ANALYSIS__
+
+#include "EBUR128.h"
+#include "SampleCount.h"
+
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <vector>
+
+class WaveTrack;
+
+//! RMS and loudness of several parts of tracks, measured in worker threads
+//! and reported together
+namespace RegionAnalysis {
+
+//! A time range of one or all channels of a track
+struct Region {
+   const WaveTrack &track;
+   //! A channel, or -1 for all channels of the track
+   int iChannel;
+   double t0;
+   double t1;
+};
+
+//! Flags, for the measurements to make
+enum Measurements : unsigned {
+   RMS = 1 << 0,
+   Loudness = 1 << 1,
+};
+
+struct Result {
+   //! Of the channels together, by the mean of their squares; computed from
+   //! the block summaries except at the ends; nullopt if not measured, or if
+   //! the region is empty after excluding space beyond the ends of the track
+   std::optional<float> rms;
+   //! Integrated loudness in LUFS, negative infinity for silence; nullopt if
+   //! not measured, or if the region is empty
+   /*! Gaps between clips are skipped, and each clip is measured separately
+    before the histograms are added, as by the Loudness effect */
+   std::optional<double> lufs;
+};
+
+//! Called in the calling thread of Measure() with the fraction done of the
+//! loudness measurement
+/*! @return true to cancel */
+using ProgressReport = std::function<bool(double fraction)>;
+
+//! Measure all regions, each in its own tasks
+/*!
+ @param mayThrow passed to the RMS computations
+ @return a result for each region in order, or nullopt if cancelled
+ @throws the first exception from a worker
+ */
+std::optional<std::vector<Result>> Measure(const std::vector<Region> &regions,
+   unsigned measurements, const ProgressReport &report = {},
+   bool mayThrow = true);
+
+//! Measure the samples of one channel, or of all channels, of a track
+/*!
+ Only reads samples, and so may be called in a worker thread
+ @param done incremented by the count of samples read, of all channels
+ @return nullopt if cancelled
+ */
+std::optional<EBUR128::Histogram> MeasureSamples(const WaveTrack &track,
+   int iChannel, sampleCount start, sampleCount end,
+   std::atomic<long long> &done, const std::atomic<bool> &cancelled);
+}
+
+#endif
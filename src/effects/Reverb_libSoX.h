@@ -117,14 +117,47 @@ typedef struct {
    float   store;
 } filter_t;
 
-static float comb_process(filter_t * p,  /* gcc -O2 will inline this */
-      float const * input, float const * feedback, float const * hf_damping)
+/* Four combs at once, over n samples of input, adding their outputs to sum.
+   Each comb outputs its delayed input, and feeds back that output, damped by
+   a one pole lowpass.  The combs are independent, so their computations
+   overlap, where those of one comb must follow each other.  n must not
+   exceed the size of any of the combs, so that all outputs were written
+   before. */
+static void comb_quad_process(filter_t * const * f, size_t n,
+      float const * input, float * sum, float feedback, float hf_damping)
 {
-   float output = *p->ptr;
-   p->store = output + (p->store - output) * *hf_damping;
-   *p->ptr = *input + p->store * *feedback;
-   filter_advance(p);
-   return output;
+   while (n) {
+      /* Samples before the first of the pointers wraps */
+      size_t m = n, i;
+      for (i = 0; i < 4; ++i)
+         m = min(m, (size_t)(f[i]->ptr - f[i]->buffer) + 1);
+
+      float * p0 = f[0]->ptr, * p1 = f[1]->ptr,
+         * p2 = f[2]->ptr, * p3 = f[3]->ptr;
+      float s0 = f[0]->store, s1 = f[1]->store,
+         s2 = f[2]->store, s3 = f[3]->store;
+      for (size_t t = 0; t < m; ++t, --p0, --p1, --p2, --p3) {
+         const float in = input[t];
+         const float o0 = *p0, o1 = *p1, o2 = *p2, o3 = *p3;
+         s0 = o0 + (s0 - o0) * hf_damping;
+         s1 = o1 + (s1 - o1) * hf_damping;
+         s2 = o2 + (s2 - o2) * hf_damping;
+         s3 = o3 + (s3 - o3) * hf_damping;
+         *p0 = in + s0 * feedback;
+         *p1 = in + s1 * feedback;
+         *p2 = in + s2 * feedback;
+         *p3 = in + s3 * feedback;
+         sum[t] = (((sum[t] + o0) + o1) + o2) + o3;
+      }
+      f[0]->store = s0, f[1]->store = s1, f[2]->store = s2, f[3]->store = s3;
+
+      for (i = 0; i < 4; ++i) {
+         f[i]->ptr -= m;
+         if (f[i]->ptr < f[i]->buffer)
+            f[i]->ptr += f[i]->size;
+      }
+      input += m, sum += m, n -= m;
+   }
 }
 
 static float allpass_process(filter_t * p,  /* gcc -O2 will inline this */
@@ -149,6 +182,9 @@ static const size_t /* Filter delay lengths in samples (44100Hz sample-rate) */
    comb_lengths[] = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617},
    allpass_lengths[] = {225, 341, 441, 556}, stereo_adjust = 12;
 
+/* Combs are processed in fours */
+static_assert(array_length(comb_lengths) % 4 == 0, "");
+
 typedef struct {
    filter_t comb   [array_length(comb_lengths)];
    filter_t allpass[array_length(allpass_lengths)];
@@ -235,16 +271,32 @@ static void filter_array_create(filter_array_t * p, double rate,
    }
 }
 
+/* Results are the same as sample by sample, but the combs run a block at a
+   time, no longer than any of them, then the allpasses and EQ */
 static void filter_array_process(filter_array_t * p,
       size_t length, float const * input, float * output,
       float const * feedback, float const * hf_damping, float const * gain)
 {
-   while (length--) {
-      float out = 0, in = *input++;
+   size_t i, block = length;
+   for (i = 0; i < array_length(comb_lengths); ++i)
+      block = min(block, p->comb[i].size);
+
+   for (size_t done = 0; done < length;) {
+      const size_t n = min(block, length - done);
+      float * const sum = output + done;
+      std::fill(sum, sum + n, 0.0f);
+      /* In the order of the sample-by-sample sums, last comb first */
+      for (i = array_length(comb_lengths); i > 0; i -= 4) {
+         filter_t * const quad[] = {
+            p->comb + i - 1, p->comb + i - 2, p->comb + i - 3, p->comb + i - 4
+         };
+         comb_quad_process(quad, n, input + done, sum, *feedback, *hf_damping);
+      }
+      done += n;
+   }
 
-      size_t i = array_length(comb_lengths) - 1;
-      do out += comb_process(p->comb + i, &in, feedback, hf_damping);
-      while (i--);
+   while (length--) {
+      float out = *output;
 
       i = array_length(allpass_lengths) - 1;
       do out = allpass_process(p->allpass + i, &out);
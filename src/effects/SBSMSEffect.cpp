@@ -13,6 +13,7 @@ effect that uses SBSMS to do its processing (TimeScale)
 #if USE_SBSMS
 #include "SBSMSEffect.h"
 #include "EffectOutputTracks.h"
+#include "ParallelTrackJobs.h"
 
 #include <math.h>
 
@@ -230,13 +231,15 @@ bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
    //Iterate over each track
    //all needed because this effect needs to introduce silence in the group tracks to keep sync
    EffectOutputTracks outputs { *mTracks, GetType(), { { mT0, mT1 } }, true };
-   mCurTrackNum = 0;
 
-   double maxDuration = 0.0;
+   mTotalStretch = Slide(rateSlideType,rateStart,rateEnd).getTotalStretch();
 
-   Slide rateSlide(rateSlideType,rateStart,rateEnd);
-   Slide pitchSlide(pitchSlideType,pitchStart,pitchEnd);
-   mTotalStretch = rateSlide.getTotalStretch();
+   // Wave tracks to render in parallel, each with its own SBSMS
+   struct Job {
+      WaveTrack *pTrack;
+      WaveTrack::Holder pOut;
+   };
+   std::vector<Job> jobs;
 
    outputs.Get().Any().VisitWhile(bGoodResult,
       [&](auto &&fallthrough){ return [&](LabelTrack &lt) {
@@ -250,176 +253,164 @@ bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
             return fallthrough();
 
          // Process only if the right marker is to the right of the left marker
-         if (mT1 > mT0) {
-            const auto start = track.TimeToLongSamples(mT0);
-            const auto end = track.TimeToLongSamples(mT1);
-
-            // TODO: more-than-two-channels
-            auto channels = track.Channels();
-            const auto leftTrack = (*channels.begin()).get();
-            const auto rightTrack = (channels.size() > 1)
-               ? (* ++ channels.first).get()
-               : nullptr;
-            if (rightTrack)
-               mCurTrackNum++; // Increment for rightTrack, too.
-
-            // SBSMS has a fixed sample rate - we just convert to its sample
-            // rate and then convert back
-            const float srTrack = track.GetRate();
-            const float srProcess = bLinkRatePitch ? srTrack : 44100.0;
-
-            // the resampler needs a callback to supply its samples
-            ResampleBuf rb;
-            const auto maxBlockSize = track.GetMaxBlockSize();
-            rb.blockSize = maxBlockSize;
-            rb.buf.reinit(rb.blockSize, true);
-            rb.leftTrack = leftTrack;
-            rb.rightTrack = rightTrack ? rightTrack : leftTrack;
-            rb.leftBuffer.reinit(maxBlockSize, true);
-            rb.rightBuffer.reinit(maxBlockSize, true);
-
-            // Samples in selection
-            const auto samplesIn = end - start;
-
-            // Samples for SBSMS to process after resampling
-            const auto samplesToProcess = static_cast<sampleCount>(
-               samplesIn.as_float() * (srProcess/srTrack));
-
-            SlideType outSlideType;
-            SBSMSResampleCB outResampleCB;
-
-            if (bLinkRatePitch) {
-              rb.bPitch = true;
-              outSlideType = rateSlideType;
-              outResampleCB = resampleCB;
-              rb.offset = start;
-              rb.end = end;
-               // Third party library has its own type alias, check it
-               static_assert(sizeof(sampleCount::type) <=
-                 sizeof(_sbsms_::SampleCountType),
+         if (mT1 > mT0)
+            jobs.push_back({ &track, track.EmptyCopy() });
+      }; },
+      [&](Track &t) {
+         if (SyncLock::IsSyncLockSelected(t))
+            t.SyncLockAdjust(mT1, mT0 + (mT1 - mT0) * mTotalStretch);
+      }
+   );
+
+   if (bGoodResult)
+      bGoodResult = RunTrackJobs(*this, jobs.size(),
+      [&](size_t iJob, TrackJobContext &context){
+         auto &track = *jobs[iJob].pTrack;
+         auto &outputTrack = *jobs[iJob].pOut;
+         // The slides have state, so each job needs its own
+         Slide rateSlide(rateSlideType,rateStart,rateEnd);
+         Slide pitchSlide(pitchSlideType,pitchStart,pitchEnd);
+
+         const auto start = track.TimeToLongSamples(mT0);
+         const auto end = track.TimeToLongSamples(mT1);
+
+         // TODO: more-than-two-channels
+         auto channels = track.Channels();
+         const auto leftTrack = (*channels.begin()).get();
+         const auto rightTrack = (channels.size() > 1)
+            ? (* ++ channels.first).get()
+            : nullptr;
+
+         // SBSMS has a fixed sample rate - we just convert to its sample
+         // rate and then convert back
+         const float srTrack = track.GetRate();
+         const float srProcess = bLinkRatePitch ? srTrack : 44100.0;
+
+         // the resampler needs a callback to supply its samples
+         ResampleBuf rb;
+         const auto maxBlockSize = track.GetMaxBlockSize();
+         rb.blockSize = maxBlockSize;
+         rb.buf.reinit(rb.blockSize, true);
+         rb.leftTrack = leftTrack;
+         rb.rightTrack = rightTrack ? rightTrack : leftTrack;
+         rb.leftBuffer.reinit(maxBlockSize, true);
+         rb.rightBuffer.reinit(maxBlockSize, true);
+
+         // Samples in selection
+         const auto samplesIn = end - start;
+
+         // Samples for SBSMS to process after resampling
+         const auto samplesToProcess = static_cast<sampleCount>(
+            samplesIn.as_float() * (srProcess/srTrack));
+
+         SlideType outSlideType;
+         SBSMSResampleCB outResampleCB;
+
+         if (bLinkRatePitch) {
+           rb.bPitch = true;
+           outSlideType = rateSlideType;
+           outResampleCB = resampleCB;
+           rb.offset = start;
+           rb.end = end;
+            // Third party library has its own type alias, check it
+            static_assert(sizeof(sampleCount::type) <=
+              sizeof(_sbsms_::SampleCountType),
 "Type _sbsms_::SampleCountType is too narrow to hold a sampleCount");
-              rb.iface = std::make_unique<SBSMSInterfaceSliding>(
-                  &rateSlide, &pitchSlide, bPitchReferenceInput,
-                  static_cast<_sbsms_::SampleCountType>(
-                     samplesToProcess.as_long_long()),
-                  0, nullptr);
-            }
-            else {
-               rb.bPitch = false;
-               outSlideType =
-                  (srProcess == srTrack ? SlideIdentity : SlideConstant);
-               outResampleCB = postResampleCB;
-               rb.ratio = srProcess/srTrack;
-               rb.quality = std::make_unique<SBSMSQuality>(&SBSMSQualityStandard);
-               rb.resampler = std::make_unique<Resampler>(resampleCB, &rb,
-                  srProcess == srTrack ? SlideIdentity : SlideConstant);
-               rb.sbsms = std::make_unique<SBSMS>(
-                  rightTrack ? 2 : 1, rb.quality.get(), true);
-               rb.SBSMSBlockSize = rb.sbsms->getInputFrameSize();
-               rb.SBSMSBuf.reinit(static_cast<size_t>(rb.SBSMSBlockSize), true);
-               rb.offset = start;
-               rb.end = end;
-               rb.iface = std::make_unique<SBSMSEffectInterface>(
-                  rb.resampler.get(), &rateSlide, &pitchSlide,
-                  bPitchReferenceInput,
-                  static_cast<_sbsms_::SampleCountType>(
-                     samplesToProcess.as_long_long()),
-                  0,
-                  rb.quality.get());
-            }
+           rb.iface = std::make_unique<SBSMSInterfaceSliding>(
+               &rateSlide, &pitchSlide, bPitchReferenceInput,
+               static_cast<_sbsms_::SampleCountType>(
+                  samplesToProcess.as_long_long()),
+               0, nullptr);
+         }
+         else {
+            rb.bPitch = false;
+            outSlideType =
+               (srProcess == srTrack ? SlideIdentity : SlideConstant);
+            outResampleCB = postResampleCB;
+            rb.ratio = srProcess/srTrack;
+            rb.quality = std::make_unique<SBSMSQuality>(&SBSMSQualityStandard);
+            rb.resampler = std::make_unique<Resampler>(resampleCB, &rb,
+               srProcess == srTrack ? SlideIdentity : SlideConstant);
+            rb.sbsms = std::make_unique<SBSMS>(
+               rightTrack ? 2 : 1, rb.quality.get(), true);
+            rb.SBSMSBlockSize = rb.sbsms->getInputFrameSize();
+            rb.SBSMSBuf.reinit(static_cast<size_t>(rb.SBSMSBlockSize), true);
+            rb.offset = start;
+            rb.end = end;
+            rb.iface = std::make_unique<SBSMSEffectInterface>(
+               rb.resampler.get(), &rateSlide, &pitchSlide,
+               bPitchReferenceInput,
+               static_cast<_sbsms_::SampleCountType>(
+                  samplesToProcess.as_long_long()),
+               0,
+               rb.quality.get());
+         }
 
-            Resampler resampler(outResampleCB, &rb, outSlideType);
+         Resampler resampler(outResampleCB, &rb, outSlideType);
 
-            audio outBuf[SBSMSOutBlockSize];
-            float outBufLeft[2 * SBSMSOutBlockSize];
-            float outBufRight[2 * SBSMSOutBlockSize];
+         audio outBuf[SBSMSOutBlockSize];
+         float outBufLeft[2 * SBSMSOutBlockSize];
+         float outBufRight[2 * SBSMSOutBlockSize];
 
-            // Samples in output after SBSMS
-            const sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
+         // Samples in output after SBSMS
+         const sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
 
-            // Samples in output after resampling back
-            const auto samplesOut = static_cast<sampleCount>(
-               samplesToOutput.as_float() * (srTrack / srProcess));
+         // Samples in output after resampling back
+         const auto samplesOut = static_cast<sampleCount>(
+            samplesToOutput.as_float() * (srTrack / srProcess));
 
-            // Duration in track time
-            const double duration = (mT1 - mT0) * mTotalStretch;
+         auto iter = outputTrack.Channels().begin();
+         rb.outputTrack = &outputTrack;
+         rb.outputLeftChannel = (*iter++).get();
+         if (rightTrack)
+            rb.outputRightChannel = (*iter).get();
 
-            if (duration > maxDuration)
-               maxDuration = duration;
+         long pos = 0;
+         long outputCount = -1;
 
-            const auto warper = createTimeWarper(
-               mT0, mT1, maxDuration, rateStart, rateEnd, rateSlideType);
+         // process
+         while (pos < samplesOut && outputCount) {
+            const auto frames =
+               limitSampleBufferSize(SBSMSOutBlockSize, samplesOut - pos);
 
-            WaveTrack::Holder outputTrack = track.EmptyCopy();
-            auto iter = outputTrack->Channels().begin();
-            rb.outputTrack = outputTrack.get();
-            rb.outputLeftChannel = (*iter++).get();
-            if (rightTrack)
-               rb.outputRightChannel = (*iter).get();
-
-            long pos = 0;
-            long outputCount = -1;
-
-            // process
-            while (pos < samplesOut && outputCount) {
-               const auto frames =
-                  limitSampleBufferSize(SBSMSOutBlockSize, samplesOut - pos);
-
-               outputCount = resampler.read(outBuf, frames);
-               for (int i = 0; i < outputCount; ++i) {
-                  outBufLeft[i] = outBuf[i][0];
-                  if (rightTrack)
-                     outBufRight[i] = outBuf[i][1];
-               }
-               pos += outputCount;
-               rb.outputLeftChannel->Append(
-                  (samplePtr)outBufLeft, floatSample, outputCount);
+            outputCount = resampler.read(outBuf, frames);
+            for (int i = 0; i < outputCount; ++i) {
+               outBufLeft[i] = outBuf[i][0];
                if (rightTrack)
-                  rb.outputRightChannel->Append(
-                     (samplePtr)outBufRight, floatSample, outputCount);
-
-               double frac = static_cast<double>(pos) / samplesOut.as_double();
-               int nWhichTrack = mCurTrackNum;
-               if (rightTrack) {
-                  nWhichTrack = 2 * (mCurTrackNum / 2);
-                  if (frac < 0.5)
-                     // Show twice as far for each track,
-                     // because we're doing 2 at once.
-                     frac *= 2.0;
-                  else {
-                     nWhichTrack++;
-                     frac -= 0.5;
-                     // Show twice as far for each track,
-                     // because we're doing 2 at once.
-                     frac *= 2.0;
-                  }
-               }
-               if (TrackProgress(nWhichTrack, frac)) {
-                  bGoodResult = false;
-                  return;
-               }
+                  outBufRight[i] = outBuf[i][1];
             }
+            pos += outputCount;
+            context.Append(*rb.outputLeftChannel, outBufLeft, outputCount);
+            if (rightTrack)
+               context.Append(
+                  *rb.outputRightChannel, outBufRight, outputCount);
 
-            {
-               auto pException = rb.mpException;
-               rb.mpException = {};
-               if (pException)
-                  std::rethrow_exception(pException);
-            }
+            context.SetProgress(
+               static_cast<double>(pos) / samplesOut.as_double());
+            if (context.IsCancelled())
+               return;
+         }
 
-            rb.outputTrack->Flush();
-            Finalize(track, *outputTrack, *warper);
+         {
+            auto pException = rb.mpException;
+            rb.mpException = {};
+            if (pException)
+               std::rethrow_exception(pException);
          }
-         mCurTrackNum++;
-      }; },
-      [&](Track &t) {
-         if (SyncLock::IsSyncLockSelected(t))
-            t.SyncLockAdjust(mT1, mT0 + (mT1 - mT0) * mTotalStretch);
-      }
-   );
 
-   if (bGoodResult)
+         context.Flush(outputTrack);
+      });
+
+   if (bGoodResult) {
+      // Duration in track time
+      const double duration = (mT1 - mT0) * mTotalStretch;
+      const auto warper = createTimeWarper(
+         mT0, mT1, duration, rateStart, rateEnd, rateSlideType);
+      // Transfer output samples to the originals, in this thread
+      for (auto &job : jobs)
+         Finalize(*job.pTrack, *job.pOut, *warper);
       outputs.Commit();
+   }
 
    return bGoodResult;
 }
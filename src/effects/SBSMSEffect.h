@@ -58,7 +58,6 @@ private:
    bool bLinkRatePitch, bRateReferenceInput, bPitchReferenceInput;
    SlideType rateSlideType;
    SlideType pitchSlideType;
-   int mCurTrackNum;
    float mTotalStretch;
 
    friend class EffectChangeTempo;
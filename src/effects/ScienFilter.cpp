@@ -198,21 +198,14 @@ unsigned EffectScienFilter::GetAudioOutCount() const
 bool EffectScienFilter::ProcessInitialize(
    EffectSettings &, double, ChannelNames chanMap)
 {
-   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-      mpBiquad[iPair].Reset();
+   mCascade = Biquad::MakeCascade(mpBiquad.get(), (mOrder + 1) / 2, 1);
    return true;
 }
 
 size_t EffectScienFilter::ProcessBlock(EffectSettings &,
    const float *const *inBlock, float *const *outBlock, size_t blockLen)
 {
-   const float *ibuf = inBlock[0];
-   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-   {
-      mpBiquad[iPair].Process(ibuf, outBlock[0], blockLen);
-      ibuf = outBlock[0];
-   }
-
+   mCascade.Process(inBlock, outBlock, blockLen);
    return blockLen;
 }
 
@@ -100,6 +100,8 @@ private:
    int mOrder;
    int mOrderIndex;
    ArrayOf<Biquad> mpBiquad;
+   //! The biquads, as they filter the samples
+   BiquadCascade mCascade;
 
    double mdBMax;
    double mdBMin;
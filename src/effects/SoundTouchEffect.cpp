@@ -17,7 +17,9 @@ effect that uses SoundTouch to do its processing (ChangeTempo
 #if USE_SOUNDTOUCH
 #include "SoundTouchEffect.h"
 #include "EffectOutputTracks.h"
+#include "ParallelTrackJobs.h"
 
+#include <cassert>
 #include <math.h>
 
 #include "../LabelTrack.h"
@@ -70,112 +72,18 @@ bool EffectSoundTouch::ProcessNoteTrack(NoteTrack *nt, const TimeWarper &warper)
 }
 #endif
 
-bool EffectSoundTouch::ProcessWithTimeWarper(InitFunction initer,
-                                             const TimeWarper &warper,
-                                             bool preserveLength)
+namespace {
+//! Render mono orig through SoundTouch into out
+void RenderMono(soundtouch::SoundTouch &soundTouch,
+   WaveChannel &orig, WaveTrack &out, sampleCount start, sampleCount end,
+   TrackJobContext &context)
 {
-   // Assumes that mSoundTouch has already been initialized
-   // by the subclass for subclass-specific parameters. The
-   // time warper should also be set.
-
-   // Check if this effect will alter the selection length; if so, we need
-   // to operate on sync-lock selected tracks.
-   bool mustSync = true;
-   if (mT1 == warper.Warp(mT1)) {
-      mustSync = false;
-   }
-
-   //Iterate over each track
-   // Needs all for sync-lock grouping.
-   EffectOutputTracks outputs { *mTracks, GetType(), { { mT0, mT1 } }, true };
-   bool bGoodResult = true;
-
-   mPreserveLength = preserveLength;
-   mCurTrackNum = 0;
-   m_maxNewLength = 0.0;
-
-   outputs.Get().Any().VisitWhile(bGoodResult,
-      [&](auto &&fallthrough){ return [&](LabelTrack &lt) {
-         if ( !(lt.GetSelected() ||
-                (mustSync && SyncLock::IsSyncLockSelected(lt))) )
-            return fallthrough();
-         if (!ProcessLabelTrack(&lt, warper))
-            bGoodResult = false;
-      }; },
-#ifdef USE_MIDI
-      [&](auto &&fallthrough){ return [&](NoteTrack &nt) {
-         if (!(nt.GetSelected() ||
-               (mustSync && SyncLock::IsSyncLockSelected(nt))))
-            return fallthrough();
-         if (!ProcessNoteTrack(&nt, warper))
-            bGoodResult = false;
-      }; },
-#endif
-      [&](auto &&fallthrough){ return [&](WaveTrack &orig) {
-         if (!orig.GetSelected())
-            return fallthrough();
-
-         // Process only if the right marker is to the right of the left marker
-         if (mT1 > mT0) {
-            //Transform the marker timepoints to samples
-            const auto start = orig.TimeToLongSamples(mT0);
-            const auto end = orig.TimeToLongSamples(mT1);
-
-            const auto tempTrack = orig.EmptyCopy();
-            auto &out = *tempTrack;
-
-            const auto pSoundTouch = std::make_unique<soundtouch::SoundTouch>();
-            initer(pSoundTouch.get());
-
-            // TODO: more-than-two-channels
-            auto channels = orig.Channels();
-            if (channels.size() > 1) {
-
-               //Inform soundtouch there's 2 channels
-               pSoundTouch->setChannels(2);
-
-               //ProcessStereo() (implemented below) processes a stereo track
-               if (!ProcessStereo(pSoundTouch.get(),
-                  orig, out, start, end, warper))
-                  bGoodResult = false;
-               mCurTrackNum++; // Increment for rightTrack, too.
-            } else {
-               //Inform soundtouch there's a single channel
-               pSoundTouch->setChannels(1);
-
-               //ProcessOne() (implemented below) processes a single track
-               if (!ProcessOne(pSoundTouch.get(), **channels.begin(),
-                     out, start, end, warper))
-                  bGoodResult = false;
-            }
-            // pSoundTouch is destroyed here
-         }
-         mCurTrackNum++;
-      }; },
-      [&](Track &t) {
-         if (mustSync && SyncLock::IsSyncLockSelected(t))
-            t.SyncLockAdjust(mT1, warper.Warp(mT1));
-      }
-   );
-
-   if (bGoodResult)
-      outputs.Commit();
-
-   return bGoodResult;
-}
-
-//ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
-//and executes ProcessSoundTouch on these blocks
-bool EffectSoundTouch::ProcessOne(soundtouch::SoundTouch *pSoundTouch,
-   WaveChannel &orig, WaveTrack &out,
-   sampleCount start, sampleCount end,
-   const TimeWarper &warper)
-{
-   // ProcessStereo handles the stereo case instead.  This is a precondition
+   // RenderStereo handles the stereo case instead.  This is a precondition
    // for Append:
    assert(out.NChannels() == 1);
+   auto &outChannel = **out.Channels().begin();
 
-   pSoundTouch->setSampleRate(
+   soundTouch.setSampleRate(
       static_cast<unsigned int>((orig.GetRate() + 0.5)));
 
    //Get the length of the buffer (as double). len is
@@ -183,69 +91,76 @@ bool EffectSoundTouch::ProcessOne(soundtouch::SoundTouch *pSoundTouch,
    //to make it a double now than it is to do it later
    auto len = (end - start).as_double();
 
-   {
-      //Initiate a processing buffer.  This buffer will (most likely)
-      //be shorter than the length of the track being processed.
-      Floats buffer{ orig.GetMaxBlockSize() };
-
-      //Go through the track one buffer at a time. s counts which
-      //sample the current buffer starts at.
-      auto s = start;
-      while (s < end) {
-         //Get a block of samples (smaller than the size of the buffer)
-         const auto block = std::min<size_t>(8192,
-            limitSampleBufferSize(orig.GetBestBlockSize(s), end - s));
-
-         //Get the samples from the track and put them in the buffer
-         orig.GetFloats(buffer.get(), s, block);
-
-         //Add samples to SoundTouch
-         pSoundTouch->putSamples(buffer.get(), block);
-
-         //Get back samples from SoundTouch
-         unsigned int outputCount = pSoundTouch->numSamples();
-         if (outputCount > 0) {
-            Floats buffer2{ outputCount };
-            pSoundTouch->receiveSamples(buffer2.get(), outputCount);
-            out.Append(0, (samplePtr)buffer2.get(), floatSample, outputCount);
-         }
-
-         //Increment s one blockfull of samples
-         s += block;
-
-         //Update the Progress meter
-         if (TrackProgress(mCurTrackNum, (s - start).as_double() / len))
-            return false;
-      }
-
-      // Tell SoundTouch to finish processing any remaining samples
-      pSoundTouch->flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
+   //Initiate a processing buffer.  This buffer will (most likely)
+   //be shorter than the length of the track being processed.
+   Floats buffer{ orig.GetMaxBlockSize() };
 
-      unsigned int outputCount = pSoundTouch->numSamples();
+   const auto receive = [&]{
+      //Get back samples from SoundTouch
+      unsigned int outputCount = soundTouch.numSamples();
       if (outputCount > 0) {
          Floats buffer2{ outputCount };
-         pSoundTouch->receiveSamples(buffer2.get(), outputCount);
-         out.Append(0, (samplePtr)buffer2.get(), floatSample, outputCount);
+         soundTouch.receiveSamples(buffer2.get(), outputCount);
+         context.Append(outChannel, buffer2.get(), outputCount);
       }
+   };
+
+   //Go through the track one buffer at a time. s counts which
+   //sample the current buffer starts at.
+   auto s = start;
+   while (s < end) {
+      //Get a block of samples (smaller than the size of the buffer)
+      const auto block = std::min<size_t>(8192,
+         limitSampleBufferSize(orig.GetBestBlockSize(s), end - s));
+
+      //Get the samples from the track and put them in the buffer
+      orig.GetFloats(buffer.get(), s, block);
+
+      //Add samples to SoundTouch
+      soundTouch.putSamples(buffer.get(), block);
+      receive();
 
-      out.Flush();
+      //Increment s one blockfull of samples
+      s += block;
+
+      context.SetProgress((s - start).as_double() / len);
+      if (context.IsCancelled())
+         return;
    }
 
-   // Transfer output samples to the original
-   Finalize(orig.GetTrack(), out, warper);
+   // Tell SoundTouch to finish processing any remaining samples
+   soundTouch.flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
+   receive();
 
-   double newLength = out.GetEndTime();
-   m_maxNewLength = std::max(m_maxNewLength, newLength);
+   context.Flush(out);
+}
 
-   //Return true because the effect processing succeeded.
-   return true;
+void AppendStereoResults(soundtouch::SoundTouch &soundTouch,
+   const size_t outputCount,
+   WaveChannel &outputLeftTrack, WaveChannel &outputRightTrack,
+   TrackJobContext &context)
+{
+   Floats outputSoundTouchBuffer{ outputCount * 2 };
+   soundTouch.receiveSamples(outputSoundTouchBuffer.get(), outputCount);
+
+   // Dis-interleave outputSoundTouchBuffer into separate track buffers.
+   Floats outputLeftBuffer{ outputCount };
+   Floats outputRightBuffer{ outputCount };
+   for (unsigned int index = 0; index < outputCount; ++index) {
+      outputLeftBuffer[index] = outputSoundTouchBuffer[index * 2];
+      outputRightBuffer[index] = outputSoundTouchBuffer[(index * 2) + 1];
+   }
+
+   context.Append(outputLeftTrack, outputLeftBuffer.get(), outputCount);
+   context.Append(outputRightTrack, outputRightBuffer.get(), outputCount);
 }
 
-bool EffectSoundTouch::ProcessStereo(soundtouch::SoundTouch *pSoundTouch,
+//! Render stereo orig through SoundTouch into outputTrack
+void RenderStereo(soundtouch::SoundTouch &soundTouch,
    WaveTrack &orig, WaveTrack &outputTrack,
-   sampleCount start, sampleCount end, const TimeWarper &warper)
+   sampleCount start, sampleCount end, TrackJobContext &context)
 {
-   pSoundTouch->setSampleRate(
+   soundTouch.setSampleRate(
       static_cast<unsigned int>(orig.GetRate() + 0.5));
 
    auto channels = orig.Channels();
@@ -267,105 +182,159 @@ bool EffectSoundTouch::ProcessStereo(soundtouch::SoundTouch *pSoundTouch,
    // because Soundtouch wants them interleaved, i.e., each
    // Soundtouch sample is left-right pair.
    auto maxBlockSize = orig.GetMaxBlockSize();
-   {
-      Floats leftBuffer{ maxBlockSize };
-      Floats rightBuffer{ maxBlockSize };
-      Floats soundTouchBuffer{ maxBlockSize * 2 };
-
-      // Go through the track one stereo buffer at a time.
-      // sourceSampleCount counts the sample at which the current buffer starts,
-      // per channel.
-      auto sourceSampleCount = start;
-      while (sourceSampleCount < end) {
-         auto blockSize = limitSampleBufferSize(
-            orig.GetBestBlockSize(sourceSampleCount),
-            end - sourceSampleCount
-         );
-
-         // Get the samples from the tracks and put them in the buffers.
-         leftTrack.GetFloats((leftBuffer.get()), sourceSampleCount, blockSize);
-         rightTrack
-            .GetFloats((rightBuffer.get()), sourceSampleCount, blockSize);
-
-         // Interleave into soundTouchBuffer.
-         for (decltype(blockSize) index = 0; index < blockSize; index++) {
-            soundTouchBuffer[index * 2] = leftBuffer[index];
-            soundTouchBuffer[(index * 2) + 1] = rightBuffer[index];
-         }
-
-         //Add samples to SoundTouch
-         pSoundTouch->putSamples(soundTouchBuffer.get(), blockSize);
-
-         //Get back samples from SoundTouch
-         unsigned int outputCount = pSoundTouch->numSamples();
-         if (outputCount > 0)
-            this->ProcessStereoResults(pSoundTouch,
-               outputCount, outputLeftTrack, outputRightTrack);
-
-         //Increment sourceSampleCount one blockfull of samples
-         sourceSampleCount += blockSize;
-
-         //Update the Progress meter
-         // mCurTrackNum is left track. Include right track.
-         int nWhichTrack = mCurTrackNum;
-         double frac = (sourceSampleCount - start).as_double() / len;
-         if (frac < 0.5)
-            frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-         else
-         {
-            nWhichTrack++;
-            frac -= 0.5;
-            frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-         }
-         if (TrackProgress(nWhichTrack, frac))
-            return false;
+   Floats leftBuffer{ maxBlockSize };
+   Floats rightBuffer{ maxBlockSize };
+   Floats soundTouchBuffer{ maxBlockSize * 2 };
+
+   // Go through the track one stereo buffer at a time.
+   // sourceSampleCount counts the sample at which the current buffer starts,
+   // per channel.
+   auto sourceSampleCount = start;
+   while (sourceSampleCount < end) {
+      auto blockSize = limitSampleBufferSize(
+         orig.GetBestBlockSize(sourceSampleCount),
+         end - sourceSampleCount
+      );
+
+      // Get the samples from the tracks and put them in the buffers.
+      leftTrack.GetFloats((leftBuffer.get()), sourceSampleCount, blockSize);
+      rightTrack
+         .GetFloats((rightBuffer.get()), sourceSampleCount, blockSize);
+
+      // Interleave into soundTouchBuffer.
+      for (decltype(blockSize) index = 0; index < blockSize; index++) {
+         soundTouchBuffer[index * 2] = leftBuffer[index];
+         soundTouchBuffer[(index * 2) + 1] = rightBuffer[index];
       }
 
-      // Tell SoundTouch to finish processing any remaining samples
-      pSoundTouch->flush();
+      //Add samples to SoundTouch
+      soundTouch.putSamples(soundTouchBuffer.get(), blockSize);
 
-      unsigned int outputCount = pSoundTouch->numSamples();
+      //Get back samples from SoundTouch
+      unsigned int outputCount = soundTouch.numSamples();
       if (outputCount > 0)
-         this->ProcessStereoResults(pSoundTouch,
-            outputCount, outputLeftTrack, outputRightTrack);
+         AppendStereoResults(soundTouch,
+            outputCount, outputLeftTrack, outputRightTrack, context);
 
-      outputTrack.Flush();
-   }
+      //Increment sourceSampleCount one blockfull of samples
+      sourceSampleCount += blockSize;
 
-   // Transfer output samples to the original
-   Finalize(orig, outputTrack, warper);
+      context.SetProgress((sourceSampleCount - start).as_double() / len);
+      if (context.IsCancelled())
+         return;
+   }
 
+   // Tell SoundTouch to finish processing any remaining samples
+   soundTouch.flush();
 
-   // Track the longest result length
-   double newLength = outputTrack.GetEndTime();
-   m_maxNewLength = std::max(m_maxNewLength, newLength);
+   unsigned int outputCount = soundTouch.numSamples();
+   if (outputCount > 0)
+      AppendStereoResults(soundTouch,
+         outputCount, outputLeftTrack, outputRightTrack, context);
 
-   //Return true because the effect processing succeeded.
-   return true;
+   context.Flush(outputTrack);
+}
 }
 
-bool EffectSoundTouch::ProcessStereoResults(soundtouch::SoundTouch *pSoundTouch,
-   const size_t outputCount,
-   WaveChannel &outputLeftTrack,
-   WaveChannel &outputRightTrack)
+bool EffectSoundTouch::ProcessWithTimeWarper(InitFunction initer,
+                                             const TimeWarper &warper,
+                                             bool preserveLength)
 {
-   Floats outputSoundTouchBuffer{ outputCount * 2 };
-   pSoundTouch->receiveSamples(outputSoundTouchBuffer.get(), outputCount);
+   // Assumes that mSoundTouch has already been initialized
+   // by the subclass for subclass-specific parameters. The
+   // time warper should also be set.
 
-   // Dis-interleave outputSoundTouchBuffer into separate track buffers.
-   Floats outputLeftBuffer{ outputCount };
-   Floats outputRightBuffer{ outputCount };
-   for (unsigned int index = 0; index < outputCount; ++index) {
-      outputLeftBuffer[index] = outputSoundTouchBuffer[index * 2];
-      outputRightBuffer[index] = outputSoundTouchBuffer[(index * 2) + 1];
+   // Check if this effect will alter the selection length; if so, we need
+   // to operate on sync-lock selected tracks.
+   bool mustSync = true;
+   if (mT1 == warper.Warp(mT1)) {
+      mustSync = false;
    }
 
-   outputLeftTrack.Append(
-      (samplePtr)outputLeftBuffer.get(), floatSample, outputCount);
-   outputRightTrack.Append(
-      (samplePtr)outputRightBuffer.get(), floatSample, outputCount);
+   //Iterate over each track
+   // Needs all for sync-lock grouping.
+   EffectOutputTracks outputs { *mTracks, GetType(), { { mT0, mT1 } }, true };
+   bool bGoodResult = true;
+
+   mPreserveLength = preserveLength;
+   m_maxNewLength = 0.0;
 
-   return true;
+   // Wave tracks to render in parallel, each with its own SoundTouch
+   struct Job {
+      WaveTrack *pOrig;
+      WaveTrack::Holder pOut;
+      sampleCount start, end;
+   };
+   std::vector<Job> jobs;
+
+   outputs.Get().Any().VisitWhile(bGoodResult,
+      [&](auto &&fallthrough){ return [&](LabelTrack &lt) {
+         if ( !(lt.GetSelected() ||
+                (mustSync && SyncLock::IsSyncLockSelected(lt))) )
+            return fallthrough();
+         if (!ProcessLabelTrack(&lt, warper))
+            bGoodResult = false;
+      }; },
+#ifdef USE_MIDI
+      [&](auto &&fallthrough){ return [&](NoteTrack &nt) {
+         if (!(nt.GetSelected() ||
+               (mustSync && SyncLock::IsSyncLockSelected(nt))))
+            return fallthrough();
+         if (!ProcessNoteTrack(&nt, warper))
+            bGoodResult = false;
+      }; },
+#endif
+      [&](auto &&fallthrough){ return [&](WaveTrack &orig) {
+         if (!orig.GetSelected())
+            return fallthrough();
+
+         // Process only if the right marker is to the right of the left marker
+         if (mT1 > mT0)
+            //Transform the marker timepoints to samples
+            jobs.push_back({ &orig, orig.EmptyCopy(),
+               orig.TimeToLongSamples(mT0), orig.TimeToLongSamples(mT1) });
+      }; },
+      [&](Track &t) {
+         if (mustSync && SyncLock::IsSyncLockSelected(t))
+            t.SyncLockAdjust(mT1, warper.Warp(mT1));
+      }
+   );
+
+   if (bGoodResult)
+      bGoodResult = RunTrackJobs(*this, jobs.size(),
+      [&](size_t iJob, TrackJobContext &context){
+         auto &job = jobs[iJob];
+         const auto pSoundTouch = std::make_unique<soundtouch::SoundTouch>();
+         initer(pSoundTouch.get());
+
+         // TODO: more-than-two-channels
+         auto channels = job.pOrig->Channels();
+         if (channels.size() > 1) {
+            //Inform soundtouch there's 2 channels
+            pSoundTouch->setChannels(2);
+            RenderStereo(*pSoundTouch,
+               *job.pOrig, *job.pOut, job.start, job.end, context);
+         }
+         else {
+            //Inform soundtouch there's a single channel
+            pSoundTouch->setChannels(1);
+            RenderMono(*pSoundTouch, **channels.begin(),
+               *job.pOut, job.start, job.end, context);
+         }
+         // pSoundTouch is destroyed here
+      });
+
+   if (bGoodResult) {
+      // Transfer output samples to the originals, in this thread
+      for (auto &job : jobs) {
+         Finalize(*job.pOrig, *job.pOut, warper);
+         // Track the longest result length
+         m_maxNewLength = std::max(m_maxNewLength, job.pOut->GetEndTime());
+      }
+      outputs.Commit();
+   }
+
+   return bGoodResult;
 }
 
 void EffectSoundTouch::Finalize(
@@ -28,3 +28,8 @@ std::unique_ptr<EffectEditor> StatelessEffectUIServices::PopulateUI(
 }
 
 StatelessPerTrackEffect::~StatelessPerTrackEffect() = default;
+
+bool StatelessPerTrackEffect::InstancesAreIndependent() const
+{
+   return true;
+}
@@ -38,6 +38,10 @@ class StatelessPerTrackEffect
 {
 public:
    ~StatelessPerTrackEffect() override;
+
+protected:
+   //! @return true
+   bool InstancesAreIndependent() const override;
 };
 
 #endif
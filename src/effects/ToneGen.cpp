@@ -20,6 +20,8 @@ frequency changes smoothly during the tone.
 #include "ToneGen.h"
 #include "EffectEditor.h"
 #include "LoadEffects.h"
+#include "VectorOps.h"
+#include <algorithm>
 
 #include <math.h>
 
@@ -162,7 +164,7 @@ size_t EffectToneGen::ProcessBlock(EffectSettings &,
    double frequencyQuantum;
    double BlendedFrequency;
    double BlendedAmplitude;
-   double BlendedLogFrequency = 0.0;
+   double frequencyRatio = 1.0;
 
    // calculate delta, and reposition from where we left
    auto doubleSampleCount = mSampleCnt.as_double();
@@ -184,8 +186,11 @@ size_t EffectToneGen::ProcessBlock(EffectSettings &,
       mLogFrequency[1] = log10(mFrequency1);
       // calculate delta, and reposition from where we left
       frequencyQuantum = (mLogFrequency[1] - mLogFrequency[0]) / doubleSampleCount;
-      BlendedLogFrequency = mLogFrequency[0] + frequencyQuantum * doubleSample;
-      BlendedFrequency = pow(10.0, BlendedLogFrequency);
+      BlendedFrequency =
+         pow(10.0, mLogFrequency[0] + frequencyQuantum * doubleSample);
+      // Steps of the logarithm are a constant ratio, so that each sample
+      // needs no pow() of its own
+      frequencyRatio = pow(10.0, frequencyQuantum);
    }
    else
    {
@@ -194,14 +199,43 @@ size_t EffectToneGen::ProcessBlock(EffectSettings &,
       BlendedFrequency = mFrequency0 + frequencyQuantum * doubleSample;
    }
 
+   // update freq,amplitude
+   const auto step = [&]{
+      mPositionInCycles += BlendedFrequency;
+      BlendedAmplitude += amplitudeQuantum;
+      if (mInterpolation == kLogarithmic)
+         BlendedFrequency *= frequencyRatio;
+      else
+         BlendedFrequency += frequencyQuantum;
+   };
+
+   if (mWaveform == kSine)
+   {
+      // The phases and amplitudes of a chunk, then all of its sines at once
+      constexpr size_t chunkSize = 512;
+      double cycles[chunkSize];
+      float amplitudes[chunkSize];
+      for (size_t start = 0; start < blockLen; start += chunkSize)
+      {
+         const auto len = std::min(chunkSize, blockLen - start);
+         for (size_t i = 0; i < len; i++)
+         {
+            cycles[i] = mPositionInCycles / mSampleRate;
+            amplitudes[i] = BlendedAmplitude;
+            step();
+         }
+         VectorOps::SinCycles(cycles, buffer + start, len);
+         VectorOps::Multiply(amplitudes, buffer + start, len);
+      }
+      mSample += blockLen;
+      return blockLen;
+   }
+
    // synth loop
    for (decltype(blockLen) i = 0; i < blockLen; i++)
    {
       switch (mWaveform)
       {
-      case kSine:
-         f = sin(pre2PI * mPositionInCycles / mSampleRate);
-         break;
       case kSquare:
          f = (modf(mPositionInCycles / mSampleRate, &throwaway) < 0.5) ? 1.0 : -1.0;
          break;
@@ -232,18 +266,7 @@ size_t EffectToneGen::ProcessBlock(EffectSettings &,
       }
       // insert value in buffer
       buffer[i] = (float) (BlendedAmplitude * f);
-      // update freq,amplitude
-      mPositionInCycles += BlendedFrequency;
-      BlendedAmplitude += amplitudeQuantum;
-      if (mInterpolation == kLogarithmic)
-      {
-         BlendedLogFrequency += frequencyQuantum;
-         BlendedFrequency = pow(10.0, BlendedLogFrequency);
-      }
-      else
-      {
-         BlendedFrequency += frequencyQuantum;
-      }
+      step();
    }
 
    // update external placeholder
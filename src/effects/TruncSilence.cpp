@@ -21,6 +21,7 @@
 #include "LoadEffects.h"
 
 #include <algorithm>
+#include <cmath>
 #include <list>
 #include <limits>
 #include <math.h>
@@ -33,6 +34,7 @@
 #include "Project.h"
 #include "ShuttleGui.h"
 #include "SyncLock.h"
+#include "WaveChannelUtilities.h"
 #include "WaveTrack.h"
 #include "../widgets/valnum.h"
 #include "AudacityMessageBox.h"
@@ -523,6 +525,11 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
       sampleCount(std::max(mInitialAllowedSilence, DEF_MinTruncMs) * rate);
 
    double truncDbSilenceThreshold = DB_TO_LINEAR(mThresholdDB);
+   // For comparison with summaries: not more than the threshold, so that
+   // samples less than it are less than this
+   auto summaryThreshold = static_cast<float>(truncDbSilenceThreshold);
+   if (summaryThreshold > truncDbSilenceThreshold)
+      summaryThreshold = std::nextafter(summaryThreshold, 0.0f);
    auto blockLen = wt.GetMaxBlockSize();
    auto start = wt.TimeToLongSamples(mT0);
    auto end = wt.TimeToLongSamples(mT1);
@@ -611,6 +618,21 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
       }
       // End of optimization
 
+      // Optimization: skip samples that the block summaries show to be
+      // silent in all channels, within the current region, without reading
+      // them; not when measuring for preview, which counts samples
+      if (!inputLength) {
+         auto quiet = std::min(end, wt.TimeToLongSamples(rit->end)) - *index;
+         for (const auto pChannel : wt.Channels())
+            quiet = WaveChannelUtilities::GetQuietLength(
+               *pChannel, *index, quiet, summaryThreshold);
+         if (quiet > 0) {
+            *silentFrame += quiet;
+            *index += quiet;
+            continue;
+         }
+      }
+
       // Limit size of current block if we've reached the end
       auto count = limitSampleBufferSize( blockLen, end - *index );
 
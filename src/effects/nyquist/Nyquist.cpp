@@ -27,6 +27,7 @@ effects from this one class.
 
 #include "Nyquist.h"
 #include "EffectOutputTracks.h"
+#include "NyquistWorker.h"
 
 #include <algorithm>
 #include <cmath>
@@ -674,6 +675,10 @@ struct NyquistEffect::NyxContext {
       , mProgressTot{ progressTot }
    {}
 
+   //! Set the channel group, and the samples of the selection from t0 to t1,
+   //! up to maxLen
+   void SetTrack(WaveTrack &track, double t0, double t1, sampleCount maxLen);
+
    int GetCallback(float *buffer, int channel,
       int64_t start, int64_t len, int64_t totlen);
    int PutCallback(float *buffer, int channel,
@@ -919,6 +924,18 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
    Track *gtLast = NULL;
    double progressTot{};
 
+   if (pRange && UseWorkerProcesses(pRange->size())) {
+      if (const auto result = ProcessInWorkers(*oOutputs)) {
+         success = *result;
+         if (success && mOutputTime > 0.0)
+            mT1 = mT0 + mOutputTime;
+         goto finish;
+      }
+      // Else some worker failed; evaluate here instead
+      mTrackIndex = 0;
+      mOutputTime = 0;
+   }
+
    for (;
         bOnePassTool || pRange->first != pRange->second;
         (void) (!pRange || (++pRange->first, true))
@@ -933,8 +950,6 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
       auto &mCurNumChannels = nyxContext.mCurNumChannels;
       auto &mCurChannelGroup = nyxContext.mCurChannelGroup;
       auto &mCurTrack = nyxContext.mCurTrack;
-      auto &mCurStart = nyxContext.mCurStart;
-      auto &mCurLen = nyxContext.mCurLen;
 
       mCurChannelGroup = pRange ? *pRange->first : nullptr;
       mCurTrack[0] = mCurChannelGroup
@@ -946,29 +961,12 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
          if (bOnePassTool) {
          }
          else {
-            if (auto channels = mCurChannelGroup->Channels()
-               ; channels.size() > 1
-            ) {
-               // TODO: more-than-two-channels
-               // Pay attention to consistency of mNumSelectedChannels
-               // with the running tally made by this loop!
-               mCurNumChannels = 2;
-
-               mCurTrack[1] = (* ++ channels.first).get();
-            }
+            nyxContext.SetTrack(*mCurChannelGroup, mT0, mT1, mMaxLen);
 
             // Check whether we're in the same group as the last selected track
             Track *gt = *SyncLock::Group(*mCurChannelGroup).first;
             mFirstInGroup = !gtLast || (gtLast != gt);
             gtLast = gt;
-
-            mCurStart = mCurChannelGroup->TimeToLongSamples(mT0);
-            auto end = mCurChannelGroup->TimeToLongSamples(mT1);
-            mCurLen = end - mCurStart;
-
-            wxASSERT(mCurLen <= NYQ_MAX_LEN);
-
-            mCurLen = std::min(mCurLen, mMaxLen);
          }
 
          // libnyquist breaks except in LC_NUMERIC=="C".
@@ -994,51 +992,7 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
          } );
 
 
-         if (mVersion >= 4)
-         {
-            mPerTrackProps = wxEmptyString;
-            wxString lowHz = wxT("nil");
-            wxString highHz = wxT("nil");
-            wxString centerHz = wxT("nil");
-            wxString bandwidth = wxT("nil");
-
-            if (mF0 >= 0.0) {
-               lowHz.Printf(wxT("(float %s)"), Internat::ToString(mF0));
-            }
-
-            if (mF1 >= 0.0) {
-               highHz.Printf(wxT("(float %s)"), Internat::ToString(mF1));
-            }
-
-            if ((mF0 >= 0.0) && (mF1 >= 0.0)) {
-               centerHz.Printf(wxT("(float %s)"), Internat::ToString(sqrt(mF0 * mF1)));
-            }
-
-            if ((mF0 > 0.0) && (mF1 >= mF0)) {
-               // with very small values, bandwidth calculation may be inf.
-               // (Observed on Linux)
-               double bw = log(mF1 / mF0) / log(2.0);
-               if (!std::isinf(bw)) {
-                  bandwidth.Printf(wxT("(float %s)"), Internat::ToString(bw));
-               }
-            }
-
-            mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'LOW-HZ)\n"), lowHz);
-            mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'CENTER-HZ)\n"), centerHz);
-            mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'HIGH-HZ)\n"), highHz);
-            mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'BANDWIDTH)\n"), bandwidth);
-
-            const auto t0 =
-               mCurChannelGroup ? mCurChannelGroup->SnapToSample(mT0) : mT0;
-            const auto t1 =
-               mCurChannelGroup ? mCurChannelGroup->SnapToSample(mT1) : mT1;
-            mPerTrackProps += wxString::Format(
-               wxT("(putprop '*SELECTION* (float %s) 'START)\n"),
-               Internat::ToString(t0));
-            mPerTrackProps += wxString::Format(
-               wxT("(putprop '*SELECTION* (float %s) 'END)\n"),
-               Internat::ToString(t1));
-         }
+         SetPerTrackProps(mCurChannelGroup);
 
          success = ProcessOne(nyxContext, oOutputs ? &*oOutputs : nullptr);
 
@@ -1270,11 +1224,10 @@ wxString GetClipBoundaries(const Track* t)
 
 // NyquistEffect implementation
 
-bool NyquistEffect::ProcessOne(
+wxString NyquistEffect::BuildCommand(
    NyxContext &nyxContext, EffectOutputTracks *pOutputs)
 {
    const auto mCurNumChannels = nyxContext.mCurNumChannels;
-   nyx_rval rval;
 
    wxString cmd;
    cmd += wxT("(snd-set-latency  0.1)");
@@ -1283,14 +1236,10 @@ bool NyquistEffect::ProcessOne(
    // so tools do not get *TRACK*.
    if (GetType() == EffectTypeTool)
       cmd += wxT("(setf S 0.25)\n");  // No Track.
-   else if (mVersion >= 4) {
-      nyx_set_audio_name("*TRACK*");
+   else if (mVersion >= 4)
       cmd += wxT("(setf S 0.25)\n");
-   }
-   else {
-      nyx_set_audio_name("S");
+   else
       cmd += wxT("(setf *TRACK* '*unbound*)\n");
-   }
 
    if(mVersion >= 4) {
       cmd += mProps;
@@ -1452,18 +1401,6 @@ bool NyquistEffect::ProcessOne(
          cmd += wxString::Format(wxT("(putprop '*SELECTION* %s 'RMS)\n"), rmsString);
    }
 
-   // If in tool mode, then we don't do anything with the track and selection.
-   if (GetType() == EffectTypeTool)
-      nyx_set_audio_params(44100, 0);
-   else if (GetType() == EffectTypeGenerate)
-      nyx_set_audio_params(mCurChannelGroup->GetRate(), 0);
-   else {
-      auto curLen = nyxContext.mCurLen.as_long_long();
-      nyx_set_audio_params(mCurChannelGroup->GetRate(), curLen);
-      nyx_set_input_audio(NyxContext::StaticGetCallback, &nyxContext,
-         (int)mCurNumChannels, curLen, mCurChannelGroup->GetRate());
-   }
-
    // Restore the Nyquist sixteenth note symbol for Generate plug-ins.
    // See http://bugzilla.audacityteam.org/show_bug.cgi?id=490.
    if (GetType() == EffectTypeGenerate) {
@@ -1548,6 +1485,37 @@ bool NyquistEffect::ProcessOne(
       cmd += mCmd;
    }
 
+   return cmd;
+}
+
+bool NyquistEffect::ProcessOne(
+   NyxContext &nyxContext, EffectOutputTracks *pOutputs)
+{
+   const auto mCurNumChannels = nyxContext.mCurNumChannels;
+   const auto& mCurChannelGroup = nyxContext.mCurChannelGroup;
+   nyx_rval rval;
+
+   const auto cmd = BuildCommand(nyxContext, pOutputs);
+
+   if (GetType() == EffectTypeTool)
+      ;
+   else if (mVersion >= 4)
+      nyx_set_audio_name("*TRACK*");
+   else
+      nyx_set_audio_name("S");
+
+   // If in tool mode, then we don't do anything with the track and selection.
+   if (GetType() == EffectTypeTool)
+      nyx_set_audio_params(44100, 0);
+   else if (GetType() == EffectTypeGenerate)
+      nyx_set_audio_params(mCurChannelGroup->GetRate(), 0);
+   else {
+      auto curLen = nyxContext.mCurLen.as_long_long();
+      nyx_set_audio_params(mCurChannelGroup->GetRate(), curLen);
+      nyx_set_input_audio(NyxContext::StaticGetCallback, &nyxContext,
+         (int)mCurNumChannels, curLen, mCurChannelGroup->GetRate());
+   }
+
    // Evaluate the expression, which may invoke the get callback, but often does
    // not, leaving that to delayed evaluation of the output sound
    rval = nyx_eval_expression(cmd.mb_str(wxConvUTF8));
@@ -1693,7 +1661,27 @@ bool NyquistEffect::ProcessOne(
    wxASSERT(rval == nyx_audio);
 
    int outChannels = nyx_get_audio_num_channels();
-   if (outChannels > (int)mCurNumChannels) {
+   if (!CheckOutputChannels(outChannels, mCurNumChannels))
+      return false;
+
+   nyxContext.mOutputTrack = mCurChannelGroup->EmptyCopy();
+
+   // Now fully evaluate the sound
+   int success = nyx_get_audio(NyxContext::StaticPutCallback, &nyxContext);
+
+   // See if GetCallback found read errors
+   if (auto pException = nyxContext.mpException)
+      std::rethrow_exception(pException);
+
+   if (!success)
+      return false;
+
+   return PasteOutput(nyxContext, outChannels);
+}
+
+bool NyquistEffect::CheckOutputChannels(int outChannels, unsigned nChannels)
+{
+   if (outChannels > (int)nChannels) {
       EffectUIServices::DoMessageBox(*this,
          XO("Nyquist returned too many audio channels.\n"));
       return false;
@@ -1711,18 +1699,14 @@ bool NyquistEffect::ProcessOne(
       return false;
    }
 
-   nyxContext.mOutputTrack = mCurChannelGroup->EmptyCopy();
-   auto out = nyxContext.mOutputTrack;
-
-   // Now fully evaluate the sound
-   int success = nyx_get_audio(NyxContext::StaticPutCallback, &nyxContext);
-
-   // See if GetCallback found read errors
-   if (auto pException = nyxContext.mpException)
-      std::rethrow_exception(pException);
+   return true;
+}
 
-   if (!success)
-      return false;
+bool NyquistEffect::PasteOutput(NyxContext &nyxContext, int outChannels)
+{
+   const auto mCurNumChannels = nyxContext.mCurNumChannels;
+   const auto& mCurChannelGroup = nyxContext.mCurChannelGroup;
+   auto out = nyxContext.mOutputTrack;
 
    mOutputTime = out->GetEndTime();
    if (mOutputTime <= 0) {
@@ -1771,6 +1755,239 @@ bool NyquistEffect::ProcessOne(
    return true;
 }
 
+void NyquistEffect::SetPerTrackProps(const WaveTrack *pTrack)
+{
+   if (mVersion < 4)
+      return;
+
+   mPerTrackProps = wxEmptyString;
+   wxString lowHz = wxT("nil");
+   wxString highHz = wxT("nil");
+   wxString centerHz = wxT("nil");
+   wxString bandwidth = wxT("nil");
+
+   if (mF0 >= 0.0) {
+      lowHz.Printf(wxT("(float %s)"), Internat::ToString(mF0));
+   }
+
+   if (mF1 >= 0.0) {
+      highHz.Printf(wxT("(float %s)"), Internat::ToString(mF1));
+   }
+
+   if ((mF0 >= 0.0) && (mF1 >= 0.0)) {
+      centerHz.Printf(wxT("(float %s)"), Internat::ToString(sqrt(mF0 * mF1)));
+   }
+
+   if ((mF0 > 0.0) && (mF1 >= mF0)) {
+      // with very small values, bandwidth calculation may be inf.
+      // (Observed on Linux)
+      double bw = log(mF1 / mF0) / log(2.0);
+      if (!std::isinf(bw)) {
+         bandwidth.Printf(wxT("(float %s)"), Internat::ToString(bw));
+      }
+   }
+
+   mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'LOW-HZ)\n"), lowHz);
+   mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'CENTER-HZ)\n"), centerHz);
+   mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'HIGH-HZ)\n"), highHz);
+   mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'BANDWIDTH)\n"), bandwidth);
+
+   const auto t0 =
+      pTrack ? pTrack->SnapToSample(mT0) : mT0;
+   const auto t1 =
+      pTrack ? pTrack->SnapToSample(mT1) : mT1;
+   mPerTrackProps += wxString::Format(
+      wxT("(putprop '*SELECTION* (float %s) 'START)\n"),
+      Internat::ToString(t0));
+   mPerTrackProps += wxString::Format(
+      wxT("(putprop '*SELECTION* (float %s) 'END)\n"),
+      Internat::ToString(t1));
+}
+
+bool NyquistEffect::UseWorkerProcesses(size_t nTracks) const
+{
+   // Interaction, and AUD-DO commands, need this process; so does debug
+   // output, which is shown as it comes
+   return NyquistWorker::UseWorkerProcesses.Read() && nTracks > 1 &&
+      mT1 >= mT0 && GetType() == EffectTypeProcess && !IsPreviewing() &&
+      !mDebug && !mTrace && !mExternal && !mRedirectOutput &&
+      !mCmd.Lower().Contains(wxT("aud-do"));
+}
+
+std::optional<bool> NyquistEffect::ProcessInWorkers(EffectOutputTracks &outputs)
+{
+   // Build the commands, and read the inputs, here
+   std::vector<NyquistWorker::Request> requests;
+   std::vector<NyxContext> contexts;
+   contexts.reserve(outputs.Get().Selected<WaveTrack>().size());
+   for (auto pTrack : outputs.Get().Selected<WaveTrack>()) {
+      auto &nyxContext = contexts.emplace_back(nullptr, 0, 0);
+      nyxContext.SetTrack(*pTrack, mT0, mT1, mMaxLen);
+      SetPerTrackProps(pTrack);
+
+      auto &request = requests.emplace_back();
+      request.command = BuildCommand(nyxContext, &outputs).ToUTF8().data();
+      request.audioName = (mVersion >= 4) ? "*TRACK*" : "S";
+      request.rate = pTrack->GetRate();
+      const auto len = nyxContext.mCurLen.as_size_t();
+      for (size_t ii = 0; ii < nyxContext.mCurNumChannels; ++ii) {
+         auto &samples = request.channels.emplace_back(len);
+         nyxContext.mCurTrack[ii]->GetFloats(
+            samples.data(), nyxContext.mCurStart, len);
+      }
+   }
+
+   const auto nRequests = requests.size();
+   std::vector<NyquistWorker::Reply> replies;
+   switch (NyquistWorker::Evaluate(move(requests), [&](size_t nDone){
+      return TotalProgress(0.5 * nDone / nRequests);
+   }, replies)) {
+   case NyquistWorker::Outcome::Done:
+      break;
+   case NyquistWorker::Outcome::Cancelled:
+      return false;
+   default:
+      return {};
+   }
+
+   // Prepare to accumulate debug output, as in Process()
+   mDebugOutputStr = mDebugOutput.Translation();
+   mDebugOutput = Verbatim( "%s" ).Format( std::cref( mDebugOutputStr ) );
+   wxString output;
+   for (auto &reply : replies) {
+      for (auto c : reply.output)
+         output += (wxChar)c;
+      if (reply.rval == nyx_error) {
+         mDebugOutputStr += output;
+         wxLogMessage(
+            "Nyquist returned nyx_error:\n%s", mDebugOutputStr);
+         return false;
+      }
+      // Other results are shown as they come; evaluate again here
+      if (reply.rval != nyx_audio)
+         return {};
+   }
+   mDebugOutputStr += output;
+   if (!output.empty())
+      /* i18n-hint: An effect "returned" a message.*/
+      wxLogMessage(wxT("\'%s\' returned:\n%s"),
+         mName.Translation(), output);
+
+   // Paste the outputs in order
+   Track *gtLast = nullptr;
+   for (size_t ii = 0; ii < replies.size(); ++ii) {
+      auto &reply = replies[ii];
+      auto &nyxContext = contexts[ii];
+      const auto pTrack = nyxContext.mCurChannelGroup;
+
+      Track *gt = *SyncLock::Group(*pTrack).first;
+      mFirstInGroup = !gtLast || (gtLast != gt);
+      gtLast = gt;
+
+      if (!CheckOutputChannels(reply.outChannels, nyxContext.mCurNumChannels))
+         return false;
+      nyxContext.mOutputTrack = pTrack->EmptyCopy();
+      auto iChannel = nyxContext.mOutputTrack->Channels().begin();
+      for (auto &samples : reply.channels) {
+         (*iChannel++)->Append(reinterpret_cast<samplePtr>(samples.data()),
+            floatSample, samples.size());
+         samples = {};
+      }
+      if (!PasteOutput(nyxContext, reply.outChannels))
+         return false;
+
+      if (TotalProgress(0.5 + 0.5 * (ii + 1) / replies.size()))
+         return false;
+   }
+   return true;
+}
+
+NyquistWorker::Reply NyquistEffect::EvaluateRequest(
+   const NyquistWorker::Request &request, const std::function<bool()> &stopped)
+{
+   NyquistWorker::Reply reply;
+   RegisterFunctions();
+
+   // As in Process()
+   wxString prevlocale = wxSetlocale(LC_NUMERIC, NULL);
+   wxSetlocale(LC_NUMERIC, wxString(wxT("C")));
+   auto restoreLocale = finally([&]{ wxSetlocale(LC_NUMERIC, prevlocale); });
+
+   struct Context {
+      const NyquistWorker::Request &request;
+      NyquistWorker::Reply &reply;
+      const std::function<bool()> &stopped;
+   } context{ request, reply, stopped };
+
+   nyx_init();
+   nyx_set_os_callback([](void *userdata){
+      if (static_cast<Context*>(userdata)->stopped())
+         nyx_stop();
+   }, &context);
+   nyx_capture_output([](int c, void *userdata){
+      static_cast<Context*>(userdata)->reply.output += (char)c;
+   }, &context);
+   auto cleanup = finally( [&] {
+      nyx_capture_output(NULL, (void *)NULL);
+      nyx_set_os_callback(NULL, (void *)NULL);
+      nyx_cleanup();
+   } );
+
+   const auto nChannels = request.channels.size();
+   const int64_t len = nChannels ? request.channels[0].size() : 0;
+   nyx_set_audio_name(request.audioName.c_str());
+   nyx_set_audio_params(request.rate, len);
+   nyx_set_input_audio([](float *buffer, int channel,
+      int64_t start, int64_t count, int64_t, void *userdata){
+      const auto &samples =
+         static_cast<Context*>(userdata)->request.channels[channel];
+      std::memcpy(buffer, samples.data() + start, count * sizeof(float));
+      return 0;
+   }, &context, (int)nChannels, len, request.rate);
+
+   reply.rval = nyx_eval_expression(request.command.c_str());
+   if (reply.rval != nyx_audio)
+      return reply;
+
+   reply.outChannels = nyx_get_audio_num_channels();
+   if (reply.outChannels < 1 || reply.outChannels > (int)nChannels)
+      return reply;
+   reply.channels.resize(reply.outChannels);
+   if (!nyx_get_audio([](float *buffer, int channel,
+      int64_t, int64_t count, int64_t, void *userdata){
+      auto &samples = static_cast<Context*>(userdata)->reply.channels[channel];
+      samples.insert(samples.end(), buffer, buffer + count);
+      return 0;
+   }, &context))
+      reply.rval = nyx_error;
+   return reply;
+}
+
+void NyquistEffect::NyxContext::SetTrack(
+   WaveTrack &track, double t0, double t1, sampleCount maxLen)
+{
+   mCurChannelGroup = &track;
+   auto channels = track.Channels();
+   mCurTrack[0] = (*channels.begin()).get();
+   mCurNumChannels = 1;
+   if (channels.size() > 1) {
+      // TODO: more-than-two-channels
+      // Pay attention to consistency of mNumSelectedChannels
+      // with the running tally made by the loop in Process()!
+      mCurNumChannels = 2;
+
+      mCurTrack[1] = (* ++ channels.first).get();
+   }
+
+   mCurStart = track.TimeToLongSamples(t0);
+   auto end = track.TimeToLongSamples(t1);
+   mCurLen = end - mCurStart;
+
+   wxASSERT(mCurLen <= NYQ_MAX_LEN);
+
+   mCurLen = std::min(mCurLen, maxLen);
+}
+
 // ============================================================================
 // NyquistEffect Implementation
 // ============================================================================
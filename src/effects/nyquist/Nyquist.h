@@ -18,12 +18,21 @@
 
 #include "nyx.h"
 
+#include <functional>
+#include <optional>
+
 class wxArrayString;
 class wxFileName;
 class wxCheckBox;
 class wxTextCtrl;
 
 class EffectOutputTracks;
+class WaveTrack;
+
+namespace NyquistWorker {
+struct Request;
+struct Reply;
+}
 
 #define NYQUISTEFFECTS_VERSION wxT("1.0.0.0")
 
@@ -140,6 +149,15 @@ public:
    void Break();
    void Stop();
 
+   //! Evaluate in a worker process, as ProcessOne() does with the input
+   //! audio given
+   /*!
+    @param stopped is polled during evaluation, and returns true to stop
+    */
+   static NyquistWorker::Reply EvaluateRequest(
+      const NyquistWorker::Request &request,
+      const std::function<bool()> &stopped);
+
 private:
    wxWeakRef<wxWindow> mUIParent{};
 
@@ -148,6 +166,21 @@ private:
 
    struct NyxContext;
    bool ProcessOne(NyxContext &nyxContext, EffectOutputTracks *pOutputs);
+   //! The Lisp to evaluate for the channel group of the context
+   wxString BuildCommand(NyxContext &nyxContext, EffectOutputTracks *pOutputs);
+   void SetPerTrackProps(const WaveTrack *pTrack);
+   //! Show a message and return false if the number is not acceptable
+   bool CheckOutputChannels(int outChannels, unsigned nChannels);
+   //! Replace the selection with the output track of the context
+   bool PasteOutput(NyxContext &nyxContext, int outChannels);
+
+   bool UseWorkerProcesses(size_t nTracks) const;
+   //! Evaluate for all tracks in worker processes
+   /*!
+    @return success, or nothing if the workers failed, or returned other
+    than audio, before any output was pasted
+    */
+   std::optional<bool> ProcessInWorkers(EffectOutputTracks &outputs);
 
    void BuildPromptWindow(ShuttleGui & S);
    void BuildEffectWindow(ShuttleGui & S);
@@ -0,0 +1,520 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file NyquistWorker.cpp
+
+**********************************************************************/
+#include "NyquistWorker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#include <wx/log.h>
+#include <wx/module.h>
+#include <wx/process.h>
+
+#include "CommandLineArgs.h"
+#include "FileNames.h"
+#include "IPCChannel.h"
+#include "IPCClient.h"
+#include "IPCServer.h"
+#include "LoadNyquist.h"
+#include "Nyquist.h"
+#include "PlatformCompatibility.h"
+#include "Prefs.h"
+
+BoolSetting NyquistWorker::UseWorkerProcesses{
+   L"/Nyquist/UseWorkerProcesses", false };
+
+namespace {
+constexpr auto WorkerArgument = "--nyquist-worker";
+
+using Length = uint64_t;
+
+//! Builds a message of lengths and bytes
+class Writer {
+public:
+   void Put(Length value) { Put(&value, sizeof(value)); }
+   void Put(double value) { Put(&value, sizeof(value)); }
+   void Put(const std::string &value)
+   {
+      Put(static_cast<Length>(value.size()));
+      Put(value.data(), value.size());
+   }
+   void Put(const std::vector<float> &value)
+   {
+      Put(static_cast<Length>(value.size()));
+      Put(value.data(), value.size() * sizeof(float));
+   }
+   void Put(const std::vector<std::vector<float>> &value)
+   {
+      Put(static_cast<Length>(value.size()));
+      for (auto &channel : value)
+         Put(channel);
+   }
+
+   std::string mBytes;
+
+private:
+   void Put(const void *data, size_t size)
+   {
+      mBytes.append(static_cast<const char *>(data), size);
+   }
+};
+
+//! Reads what Writer wrote, throwing if the message is short
+class Reader {
+public:
+   explicit Reader(const std::string &bytes) : mBytes{ bytes } {}
+
+   Length GetLength() { Length value; Get(&value, sizeof(value)); return value; }
+   double GetDouble() { double value; Get(&value, sizeof(value)); return value; }
+   std::string GetString()
+   {
+      std::string value(GetLength(), '\0');
+      Get(value.data(), value.size());
+      return value;
+   }
+   std::vector<float> GetFloats()
+   {
+      std::vector<float> value(GetLength());
+      Get(value.data(), value.size() * sizeof(float));
+      return value;
+   }
+   std::vector<std::vector<float>> GetChannels()
+   {
+      std::vector<std::vector<float>> value(GetLength());
+      for (auto &channel : value)
+         channel = GetFloats();
+      return value;
+   }
+
+private:
+   void Get(void *data, size_t size)
+   {
+      if (mBytes.size() - mPosition < size)
+         throw std::runtime_error("short Nyquist worker message");
+      std::memcpy(data, mBytes.data() + mPosition, size);
+      mPosition += size;
+   }
+
+   const std::string &mBytes;
+   size_t mPosition{ 0 };
+};
+
+std::string Serialize(const NyquistWorker::Request &request)
+{
+   Writer writer;
+   writer.Put(request.command);
+   writer.Put(request.audioName);
+   writer.Put(request.rate);
+   writer.Put(request.channels);
+   return move(writer.mBytes);
+}
+
+NyquistWorker::Request DeserializeRequest(const std::string &bytes)
+{
+   Reader reader{ bytes };
+   NyquistWorker::Request request;
+   request.command = reader.GetString();
+   request.audioName = reader.GetString();
+   request.rate = reader.GetDouble();
+   request.channels = reader.GetChannels();
+   return request;
+}
+
+std::string Serialize(const NyquistWorker::Reply &reply)
+{
+   Writer writer;
+   // Signed values travel in two's complement
+   writer.Put(static_cast<Length>(reply.rval));
+   writer.Put(reply.output);
+   writer.Put(static_cast<Length>(reply.outChannels));
+   writer.Put(reply.channels);
+   return move(writer.mBytes);
+}
+
+NyquistWorker::Reply DeserializeReply(const std::string &bytes)
+{
+   Reader reader{ bytes };
+   NyquistWorker::Reply reply;
+   reply.rval = static_cast<int>(reader.GetLength());
+   reply.output = reader.GetString();
+   reply.outChannels = static_cast<int>(reader.GetLength());
+   reply.channels = reader.GetChannels();
+   return reply;
+}
+
+//! Writes the length of the message, then its bytes
+void PutMessage(IPCChannel &channel, const std::string &message)
+{
+   const Length length = message.size();
+   channel.Send(&length, sizeof(length));
+   if (length > 0)
+      channel.Send(message.data(), length);
+}
+
+//! Stores consumed bytes, so that whole messages can be extracted
+class MessageReader {
+public:
+   void ConsumeBytes(const void *bytes, size_t length)
+   {
+      const auto chars = static_cast<const char *>(bytes);
+      mBuffer.insert(mBuffer.end(), chars, chars + length);
+   }
+
+   //! @return a whole message, if there is one
+   std::optional<std::string> Pop()
+   {
+      Length length;
+      if (mBuffer.size() < sizeof(length))
+         return {};
+      std::memcpy(&length, mBuffer.data(), sizeof(length));
+      if (mBuffer.size() - sizeof(length) < length)
+         return {};
+      const auto begin = mBuffer.begin() + sizeof(length);
+      std::string message(begin, begin + length);
+      mBuffer.erase(mBuffer.begin(), begin + length);
+      return message;
+   }
+
+private:
+   std::vector<char> mBuffer;
+};
+
+//! Requests shared by the connections with all workers
+class Jobs final {
+public:
+   explicit Jobs(std::vector<NyquistWorker::Request> requests)
+      : mRequests{ move(requests) }
+      , mReplies(mRequests.size())
+   {}
+
+   size_t Size() const { return mRequests.size(); }
+
+   //! @return index of the next request to send, if any
+   std::optional<size_t> Take()
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (mFailed || mNext == mRequests.size())
+         return {};
+      return mNext++;
+   }
+
+   //! Serialize a request, and free its samples
+   std::string Release(size_t index)
+   {
+      auto message = Serialize(mRequests[index]);
+      mRequests[index] = {};
+      return message;
+   }
+
+   void Finish(size_t index, NyquistWorker::Reply reply)
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mReplies[index] = move(reply);
+         ++mDone;
+      }
+      mCondition.notify_one();
+   }
+
+   void Fail()
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mFailed = true;
+      }
+      mCondition.notify_one();
+   }
+
+   //! Wait for all replies, or failure, calling progress at intervals
+   NyquistWorker::Outcome Wait(const std::function<bool(size_t)> &progress)
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      while (true) {
+         mCondition.wait_for(lock, std::chrono::milliseconds{ 100 },
+            [this]{ return mFailed || mDone == mRequests.size(); });
+         if (mFailed)
+            return NyquistWorker::Outcome::Failed;
+         if (mDone == mRequests.size())
+            return NyquistWorker::Outcome::Done;
+         const auto done = mDone;
+         lock.unlock();
+         if (progress(done))
+            return NyquistWorker::Outcome::Cancelled;
+         lock.lock();
+      }
+   }
+
+   std::vector<NyquistWorker::Reply> TakeReplies()
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      return move(mReplies);
+   }
+
+private:
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::vector<NyquistWorker::Request> mRequests;
+   std::vector<NyquistWorker::Reply> mReplies;
+   size_t mNext{ 0 };
+   size_t mDone{ 0 };
+   bool mFailed{ false };
+};
+
+//! The main process's end of the connection with one worker, which sends
+//! requests one at a time while there are any
+class Connection final : public IPCChannelStatusCallback {
+public:
+   explicit Connection(Jobs &jobs) : mJobs{ jobs } {}
+
+   ~Connection() override
+   {
+      // Disconnection now is not a failure
+      mStopping = true;
+      mServer.reset();
+   }
+
+   //! Call in the main thread
+   /*! @return whether the worker process started */
+   bool Start()
+   {
+      // Requests and replies carry whole channels of samples
+      mServer =
+         std::make_unique<IPCServer>(*this, IPCTransport::SharedMemory);
+      const auto cmd = wxString::Format("\"%s\" %s %d",
+         PlatformCompatibility::GetExecutablePath(),
+         WorkerArgument,
+         mServer->GetConnectPort());
+      auto process = std::make_unique<wxProcess>();
+      process->Detach();
+      if (wxExecute(cmd, wxEXEC_ASYNC, process.get()) == 0)
+         return false;
+      // process will delete itself upon termination
+      process.release();
+      return true;
+   }
+
+   void OnConnect(IPCChannel &channel) noexcept override
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mChannel = &channel;
+      SendNext();
+   }
+
+   void OnDisconnect() noexcept override
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mChannel = nullptr;
+      }
+      if (!mStopping)
+         mJobs.Fail();
+   }
+
+   void OnConnectionError() noexcept override
+   {
+      if (!mStopping)
+         mJobs.Fail();
+   }
+
+   void OnDataAvailable(const void *data, size_t size) noexcept override
+   {
+      try {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mReader.ConsumeBytes(data, size);
+         while (auto message = mReader.Pop()) {
+            if (!mIndex)
+               throw std::runtime_error("unrequested Nyquist worker reply");
+            mJobs.Finish(*mIndex, DeserializeReply(*message));
+            mIndex.reset();
+            SendNext();
+         }
+      }
+      catch (...) {
+         mJobs.Fail();
+      }
+   }
+
+private:
+   //! Call with mMutex locked
+   void SendNext()
+   {
+      if (!mChannel || mIndex)
+         return;
+      try {
+         if ((mIndex = mJobs.Take()))
+            PutMessage(*mChannel, mJobs.Release(*mIndex));
+      }
+      catch (...) {
+         mJobs.Fail();
+      }
+   }
+
+   Jobs &mJobs;
+   std::unique_ptr<IPCServer> mServer;
+   std::mutex mMutex;
+   IPCChannel *mChannel{};
+   MessageReader mReader;
+   //! Of the request being evaluated
+   std::optional<size_t> mIndex;
+   std::atomic<bool> mStopping{ false };
+};
+
+//! The worker process's end of the connection, which evaluates each request
+//! in the main thread and then replies
+class Worker final : public IPCChannelStatusCallback {
+public:
+   explicit Worker(int connectPort)
+   {
+      mClient = std::make_unique<IPCClient>(connectPort, *this);
+   }
+
+   void OnConnect(IPCChannel &channel) noexcept override
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mChannel = &channel;
+   }
+
+   void OnDisconnect() noexcept override { Stop(); }
+   void OnConnectionError() noexcept override { Stop(); }
+
+   void OnDataAvailable(const void *data, size_t size) noexcept override
+   {
+      try {
+         std::optional<std::string> message;
+         {
+            std::lock_guard<std::mutex> lock{ mMutex };
+            mReader.ConsumeBytes(data, size);
+            message = mReader.Pop();
+            if (message)
+               mRequest = move(message);
+         }
+         mCondition.notify_one();
+      }
+      catch (...) {
+         Stop();
+      }
+   }
+
+   //! @return false when there will be no more requests
+   bool Serve()
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      mCondition.wait(lock, [this]{ return !mRunning || mRequest; });
+      if (!mRunning)
+         return false;
+      auto message = move(*mRequest);
+      mRequest.reset();
+      lock.unlock();
+
+      const auto reply = NyquistEffect::EvaluateRequest(
+         DeserializeRequest(message), [this]{ return !mRunning; });
+      const auto bytes = Serialize(reply);
+
+      lock.lock();
+      if (mChannel)
+         PutMessage(*mChannel, bytes);
+      return true;
+   }
+
+private:
+   void Stop() noexcept
+   {
+      try {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mChannel = nullptr;
+      }
+      catch (...) {
+      }
+      mRunning = false;
+      mCondition.notify_one();
+   }
+
+   std::unique_ptr<IPCClient> mClient;
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   IPCChannel *mChannel{};
+   MessageReader mReader;
+   std::optional<std::string> mRequest;
+   std::atomic<bool> mRunning{ true };
+};
+}
+
+bool NyquistWorker::IsWorkerProcess()
+{
+   return CommandLineArgs::argc >= 3 &&
+      wxStrcmp(CommandLineArgs::argv[1], WorkerArgument) == 0;
+}
+
+NyquistWorker::Outcome NyquistWorker::Evaluate(std::vector<Request> requests,
+   const std::function<bool(size_t)> &progress, std::vector<Reply> &replies)
+{
+   Jobs jobs{ move(requests) };
+   const auto nWorkers = std::min<size_t>(jobs.Size(),
+      std::max(1u, std::thread::hardware_concurrency()));
+   std::vector<std::unique_ptr<Connection>> connections;
+   try {
+      for (size_t ii = 0; ii < nWorkers; ++ii) {
+         connections.push_back(std::make_unique<Connection>(jobs));
+         if (!connections.back()->Start())
+            return Outcome::Failed;
+      }
+   }
+   catch (...) {
+      return Outcome::Failed;
+   }
+
+   const auto outcome = jobs.Wait(progress);
+   // Workers exit when disconnected, stopping any evaluation
+   connections.clear();
+   if (outcome == Outcome::Done)
+      replies = jobs.TakeReplies();
+   return outcome;
+}
+
+//! Serves requests, instead of starting the application, in a worker process
+class NyquistWorkerModule final : public wxModule
+{
+public:
+   DECLARE_DYNAMIC_CLASS(NyquistWorkerModule)
+
+   bool OnInit() override
+   {
+      if (!NyquistWorker::IsWorkerProcess())
+         return true;
+
+      long connectPort;
+      if (!wxString{ CommandLineArgs::argv[2] }.ToLong(&connectPort))
+         return false;
+
+      wxLog::EnableLogging(false);
+      FileNames::InitializePathList();
+      InitPreferences(audacity::ApplicationSettings::Call());
+      // Finds the Lisp runtime
+      NyquistEffectsModule module;
+      if (!module.Initialize())
+         return false;
+
+      Worker worker(connectPort);
+      while (worker.Serve()) { }
+      // Terminate the process
+      return false;
+   }
+
+   void OnExit() override
+   {
+   }
+};
+IMPLEMENT_DYNAMIC_CLASS(NyquistWorkerModule, wxModule);
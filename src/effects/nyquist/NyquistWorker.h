@@ -0,0 +1,70 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file NyquistWorker.h
+  @brief Evaluation of Nyquist commands in other processes
+
+**********************************************************************/
+#ifndef __AUDACITY_NYQUIST_WORKER__
+#define __AUDACITY_NYQUIST_WORKER__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class BoolSetting;
+
+//! libnyquist has one global interpreter, so that one process evaluates one
+//! command at a time; this starts more processes, each serving requests to
+//! evaluate a command for one channel group in turn
+namespace NyquistWorker {
+
+//! Whether Nyquist effects may evaluate in worker processes
+extern AUDACITY_DLL_API BoolSetting UseWorkerProcesses;
+
+//! What a worker needs to evaluate the command for one channel group
+struct Request {
+   //! Lisp, UTF-8 encoded
+   std::string command;
+   //! Name of the variable bound to the input sound
+   std::string audioName;
+   double rate{};
+   //! Input samples, of equal lengths
+   std::vector<std::vector<float>> channels;
+};
+
+struct Reply {
+   //! An nyx_rval
+   int rval{};
+   //! Captured output of the interpreter, one char per byte
+   std::string output;
+   //! From nyx_get_audio_num_channels(), if rval is nyx_audio
+   int outChannels{};
+   //! Output samples, if rval is nyx_audio and outChannels is valid
+   std::vector<std::vector<float>> channels;
+};
+
+//! Whether this process was started to serve requests
+bool IsWorkerProcess();
+
+enum class Outcome {
+   Done,
+   Cancelled,
+   //! Some worker could not start or lost its connection
+   Failed,
+};
+
+//! Evaluate all requests, in up to as many new processes as there are cores
+/*!
+ Call in the main thread.  Workers stop when this returns.
+
+ @param progress is called periodically with the number of requests done,
+ and returns true to cancel
+ @param replies receives one reply for each request, in order, if Done
+ */
+Outcome Evaluate(std::vector<Request> requests,
+   const std::function<bool(size_t)> &progress, std::vector<Reply> &replies);
+}
+
+#endif
@@ -37,6 +37,11 @@
 
 #include "../../LabelTrack.h"
 #include "WaveTrack.h"
+#include "concurrency/TaskScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
 
 enum
 {
@@ -316,17 +321,109 @@ bool VampEffect::Init()
    return true;
 }
 
+namespace {
+//! One track to analyze, and the features of the chosen output found in it
+struct VampJob {
+   std::shared_ptr<const WaveChannel> left, right;
+   unsigned channels;
+   sampleCount start, len;
+   LabelTrack *ltrack;
+   Vamp::Plugin::FeatureSet features;
+};
+
+//! Plugin instances of one worker, one for each count of channels, because a
+//! Vamp plugin can't be re-initialised with another count
+struct VampWorker {
+   struct Instance {
+      std::unique_ptr<Vamp::Plugin> pPlugin;
+      bool used{ false };
+   };
+   std::map<unsigned, Instance> instances;
+};
+
+void CopyParameters(const Vamp::Plugin &from, Vamp::Plugin &to)
+{
+   if (!from.getPrograms().empty())
+      to.selectProgram(from.getCurrentProgram());
+   for (const auto &descriptor : from.getParameterDescriptors())
+      to.setParameter(descriptor.identifier,
+         from.getParameter(descriptor.identifier));
+}
+
+//! Feed the plugin overlapping blocks, advancing by step, reading each sample
+//! of the track only once
+bool Analyze(Vamp::Plugin &plugin, VampJob &job, int output,
+   size_t step, size_t block, int rate,
+   std::atomic<long long> &done, const std::atomic<bool> &cancelled)
+{
+   const WaveChannel *const channels[]{ job.left.get(), job.right.get() };
+   const auto end = job.start + job.len;
+   FloatBuffers data{ job.channels, block };
+
+   // Fill [offset, offset + count) of the buffers from the track at from,
+   // with zeroes past the end
+   const auto read = [&](size_t offset, sampleCount from, size_t count){
+      const size_t avail =
+         from < end ? limitSampleBufferSize(count, end - from) : 0;
+      for (unsigned c = 0; c < job.channels; ++c) {
+         const auto buffer = data[c].get() + offset;
+         if (avail)
+            channels[c]->GetFloats(buffer, from, avail);
+         std::fill(buffer + avail, buffer + count, 0.f);
+      }
+   };
+
+   auto &features = job.features[output];
+   const auto append = [&](Vamp::Plugin::FeatureSet &&set){
+      auto &list = set[output];
+      features.insert(features.end(),
+         std::make_move_iterator(list.begin()),
+         std::make_move_iterator(list.end()));
+   };
+
+   read(0, job.start, block);
+   for (auto pos = job.start; pos < end;) {
+      if (cancelled)
+         return false;
+
+      // UNSAFE_SAMPLE_COUNT_TRUNCATION
+      // Truncation in case of very long tracks!
+      const auto timestamp =
+         Vamp::RealTime::frame2RealTime(long(pos.as_long_long()), rate);
+      append(plugin.process(reinterpret_cast<float**>(data.get()), timestamp));
+
+      const auto next = pos + step;
+      done += limitSampleBufferSize(step, end - pos);
+      if (next < end) {
+         if (step < block) {
+            // Keep the overlap, and read only what follows it
+            const auto kept = block - step;
+            for (unsigned c = 0; c < job.channels; ++c)
+               std::copy(data[c].get() + step, data[c].get() + block,
+                  data[c].get());
+            read(kept, next + kept, step);
+         }
+         else
+            read(0, next, block);
+      }
+      pos = next;
+   }
+
+   append(plugin.getRemainingFeatures());
+   return true;
+}
+}
+
 bool VampEffect::Process(EffectInstance &, EffectSettings &)
 {
+   using namespace audacity::concurrency;
+
    if (!mPlugin)
    {
       return false;
    }
 
-   int count = 0;
-
    bool multiple = false;
-   unsigned prevTrackChannels = 0;
 
    if (GetNumWaveGroups() > 1)
    {
@@ -337,7 +434,29 @@ bool VampEffect::Process(EffectInstance &, EffectSettings &)
       multiple = true;
    }
 
+   size_t step = mPlugin->getPreferredStepSize();
+   size_t block = mPlugin->getPreferredBlockSize();
+
+   if (block == 0)
+   {
+      if (step != 0)
+      {
+         block = step;
+      }
+      else
+      {
+         block = 1024;
+      }
+   }
+
+   if (step == 0)
+   {
+      step = block;
+   }
+
    std::vector<std::shared_ptr<AddedAnalysisTrack>> addedTracks;
+   std::vector<VampJob> jobs;
+   double totalLen = 0;
 
    for (auto pTrack : inputTracks()->Any<const WaveTrack>())
    {
@@ -358,138 +477,87 @@ bool VampEffect::Process(EffectInstance &, EffectSettings &)
 
       // TODO: more-than-two-channels
 
-      size_t step = mPlugin->getPreferredStepSize();
-      size_t block = mPlugin->getPreferredBlockSize();
-
-      bool initialiseRequired = true;
-
-      if (block == 0)
-      {
-         if (step != 0)
-         {
-            block = step;
-         }
-         else
-         {
-            block = 1024;
-         }
-      }
-
-      if (step == 0)
-      {
-         step = block;
-      }
-
-      if (prevTrackChannels > 0)
-      {
-         // Plugin has already been initialised, so if the number of
-         // channels remains the same, we only need to do a reset.
-         // Otherwise we need to re-construct the whole plugin,
-         // because a Vamp plugin can't be re-initialised.
-         if (prevTrackChannels == channels)
-         {
-            mPlugin->reset();
-            initialiseRequired = false;
-         }
-         else
-         {
-            //!!! todo: retain parameters previously set
-            Init();
-         }
-      }
-
-      if (initialiseRequired)
-      {
-         if (!mPlugin->initialise(channels, step, block))
-         {
-            EffectUIServices::DoMessageBox(*this,
-               XO("Sorry, Vamp Plug-in failed to initialize."));
-            return false;
-         }
-      }
-
+      // Label tracks are made here, in the order of the wave tracks
       const auto effectName = GetSymbol().Translation();
       addedTracks.push_back(AddAnalysisTrack(*this,
          multiple
          ? wxString::Format( _("%s: %s"), pTrack->GetName(), effectName )
          : effectName
       ));
-      LabelTrack *ltrack = addedTracks.back()->get();
-
-      FloatBuffers data{ channels, block };
-
-      auto originalLen = len;
-
-      auto pos = start;
+      jobs.push_back({ left, right, channels, start, len,
+         addedTracks.back()->get() });
+      totalLen += len.as_double();
+   }
 
-      while (len != 0)
+   // Each worker takes whole tracks, with plugin instances of its own, loaded
+   // and initialised here, with the parameters of mPlugin
+   const auto nWorkers = std::max<size_t>(1,
+      std::min(jobs.size(), TaskScheduler::Get().ThreadCount()));
+   std::vector<VampWorker> workers(nWorkers);
+   Vamp::HostExt::PluginLoader *loader = Vamp::HostExt::PluginLoader::getInstance();
+   for (auto &worker : workers)
+      for (const auto &job : jobs)
       {
-         const auto request = limitSampleBufferSize( block, len );
-
-         if (left)
-            left->GetFloats(data[0].get(), pos, request);
-
-         if (right)
-            right->GetFloats(data[1].get(), pos, request);
-
-         if (request < block)
+         auto &instance = worker.instances[job.channels];
+         if (instance.pPlugin)
+            continue;
+         instance.pPlugin.reset(loader->loadPlugin(
+            mKey, mRate, Vamp::HostExt::PluginLoader::ADAPT_ALL));
+         if (!instance.pPlugin)
          {
-            for (unsigned int c = 0; c < channels; ++c)
-            {
-               for (decltype(block) i = request; i < block; ++i)
-               {
-                  data[c][i] = 0.f;
-               }
-            }
-         }
-
-         // UNSAFE_SAMPLE_COUNT_TRUNCATION
-         // Truncation in case of very long tracks!
-         Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime(
-            long( pos.as_long_long() ),
-            (int)(mRate + 0.5)
-         );
-
-         Vamp::Plugin::FeatureSet features = mPlugin->process(
-            reinterpret_cast< float** >( data.get() ), timestamp);
-         AddFeatures(ltrack, features);
-
-         if (len > (int)step)
-         {
-            len -= step;
-         }
-         else
-         {
-            len = 0;
-         }
-
-         pos += step;
-
-         if (channels > 1)
-         {
-            if (TrackGroupProgress(count,
-                  (pos - start).as_double() /
-                  originalLen.as_double() ))
-            {
-               return false;
-            }
+            EffectUIServices::DoMessageBox(*this,
+               XO("Sorry, failed to load Vamp Plug-in."));
+            return false;
          }
-         else
+         CopyParameters(*mPlugin, *instance.pPlugin);
+         if (!instance.pPlugin->initialise(job.channels, step, block))
          {
-            if (TrackProgress(count,
-                  (pos - start).as_double() /
-                  originalLen.as_double() ))
-            {
-               return false;
-            }
+            EffectUIServices::DoMessageBox(*this,
+               XO("Sorry, Vamp Plug-in failed to initialize."));
+            return false;
          }
       }
 
-      Vamp::Plugin::FeatureSet features = mPlugin->getRemainingFeatures();
-      AddFeatures(ltrack, features);
-
-      prevTrackChannels = channels;
+   const int rate = int(mRate + 0.5);
+   std::atomic<size_t> nextJob{ 0 };
+   std::atomic<bool> cancelled{ false };
+   std::atomic<long long> done{ 0 };
+   {
+      TaskGroup group;
+      bool finished = false;
+      // If this thread throws, stop the workers, before the group waits
+      auto cleanup = finally([&]{
+         if (!finished)
+            cancelled = true;
+      });
+      for (auto &worker : workers)
+         group.Run([&, pWorker = &worker]{
+            while (!cancelled) {
+               const auto ii = nextJob++;
+               if (ii >= jobs.size())
+                  break;
+               auto &job = jobs[ii];
+               auto &instance = pWorker->instances[job.channels];
+               if (instance.used)
+                  instance.pPlugin->reset();
+               instance.used = true;
+               if (!Analyze(*instance.pPlugin, job, mOutput, step, block, rate,
+                  done, cancelled))
+                  cancelled = true;
+            }
+         });
+      group.WaitPolling([&]{
+         if (!cancelled && totalLen > 0 &&
+             TotalProgress(done.load() / totalLen))
+            cancelled = true;
+      });
+      finished = true;
    }
+   if (cancelled)
+      return false;
+
+   for (auto &job : jobs)
+      AddFeatures(job.ltrack, job.features);
 
    // All completed without cancellation, so commit the addition of tracks now
    for (auto &addedTrack : addedTracks)
@@ -13,6 +13,7 @@
 #include "ExportAudioDialog.h"
 
 #include <numeric>
+#include <thread>
 
 #include <wx/frame.h>
 
@@ -101,6 +102,22 @@ BoolSetting ExportAudioOverwriteExisting { L"/ExportAudioDialog/OverwriteExistin
 
 BoolSetting ExportAudioSkipSilenceAtBeginning { L"/ExportAudioDialog/SkipSilenceAtBeginning", false };
 
+//! How many files of a split export are written at once, or 0 for a number
+//! suited to the machine
+IntSetting ExportAudioConcurrentExports { L"/ExportAudioDialog/ConcurrentExports", 0 };
+
+namespace
+{
+size_t GetConcurrentExports()
+{
+   const auto setting = ExportAudioConcurrentExports.Read();
+   if (setting > 0)
+      return setting;
+   // Each export also mixes and encodes in threads of its own
+   return std::max(1u, std::thread::hardware_concurrency() / 2);
+}
+}
+
 StringSetting ExportAudioDefaultFormat{ L"/ExportAudioDialog/Format", L"WAV" };
 
 StringSetting ExportAudioDefaultPath{ L"ExportAudioDialog/DefaultPath", L"" };
@@ -869,6 +886,10 @@ ExportResult ExportAudioDialog::DoExportSplitByLabels(const ExportPlugin& plugin
                                                       const ExportProcessor::Parameters& parameters,
                                                       FilePaths& exporterFiles)
 {
+   if (const auto maxConcurrent = GetConcurrentExports(); maxConcurrent > 1)
+      return DoExportConcurrently(plugin, formatIndex, parameters,
+         [](size_t) { return nullptr; }, false, maxConcurrent, exporterFiles);
+
    auto ok = ExportResult::Success;   // did it work?
    /* Go round again and do the exporting (so this run is slow but
     * non-interactive) */
@@ -922,6 +943,19 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
    for (auto tr : tracks.Selected<WaveTrack>())
       tr->SetSelected(false);
 
+   if (const auto maxConcurrent = GetConcurrentExports(); maxConcurrent > 1)
+   {
+      // Each task mixes the tracks selected when it is made
+      const std::vector<WaveTrack*> exported(waveTracks.begin(), waveTracks.end());
+      return DoExportConcurrently(plugin, formatIndex, parameters,
+         [&](size_t index) -> std::shared_ptr<void> {
+            auto pChanger =
+               std::make_shared<SelectionStateChanger>(selectionState, tracks);
+            exported[index]->SetSelected(true);
+            return pChanger;
+         }, true, maxConcurrent, exporterFiles);
+   }
+
    auto ok = ExportResult::Success;
 
    int count = 0;
@@ -975,8 +1009,6 @@ ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
                                          const Tags& tags,
                                          FilePaths& exportedFiles)
 {
-   wxFileName name;
-
    wxLogDebug(wxT("Doing multiple Export: File name \"%s\""), (filename.GetFullName()));
    wxLogDebug(wxT("Channels: %i, Start: %lf, End: %lf "), channels, t0, t1);
    if (selectedOnly)
@@ -985,6 +1017,84 @@ ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
       wxLogDebug(wxT("Whole Project"));
 
    wxFileName backup;
+   const wxString fullPath = PrepareExportFile(filename, backup);
+
+   bool success{false};
+   auto cleanup = finally( [&] {
+      FinishExportFile(fullPath, backup, success);
+   } );
+
+   auto result = ExportResult::Error;
+   ExportProgressUI::ExceptionWrappedCall([&]
+   {
+      result = ExportProgressUI::Show(MakeExportTask(plugin, formatIndex,
+         parameters, fullPath, channels, t0, t1, selectedOnly, tags));
+   });
+
+   success = result == ExportResult::Success || result == ExportResult::Stopped;
+
+   if(success)
+      exportedFiles.push_back(fullPath);
+
+   return result;
+}
+
+ExportResult ExportAudioDialog::DoExportConcurrently(const ExportPlugin& plugin,
+                                                     int formatIndex,
+                                                     const ExportProcessor::Parameters& parameters,
+                                                     const std::function<std::shared_ptr<void>(size_t)>& select,
+                                                     bool selectedOnly,
+                                                     size_t maxConcurrent,
+                                                     FilePaths& exportedFiles)
+{
+   struct File
+   {
+      //! Of mExportSettings
+      size_t setting;
+      wxString fullPath;
+      wxFileName backup;
+   };
+   std::vector<File> files;
+   for (size_t ii = 0; ii < mExportSettings.size(); ++ii)
+      // Bug 1440 fix.
+      if (!mExportSettings[ii].filename.GetName().empty())
+         files.push_back({ ii });
+
+   // Files not yet finished are finished as failures
+   std::vector<bool> finished(files.size());
+   auto cleanup = finally([&] {
+      for (size_t ii = 0; ii < files.size(); ++ii)
+         if (!finished[ii] && !files[ii].fullPath.empty())
+            FinishExportFile(files[ii].fullPath, files[ii].backup, false);
+   });
+
+   return ExportProgressUI::Show(files.size(), maxConcurrent,
+      [&](size_t ii) {
+         auto& file = files[ii];
+         const auto& setting = mExportSettings[file.setting];
+         wxLogDebug(wxT("Doing multiple Export: File name \"%s\""),
+            (setting.filename.GetFullName()));
+         file.fullPath = PrepareExportFile(setting.filename, file.backup);
+         // Make the task while the selection holds
+         const auto selection = select(file.setting);
+         return MakeExportTask(plugin, formatIndex, parameters, file.fullPath,
+            setting.channels, setting.t0, setting.t1, selectedOnly,
+            setting.tags);
+      },
+      [&](size_t ii, ExportResult result) {
+         const auto success =
+            result == ExportResult::Success || result == ExportResult::Stopped;
+         finished[ii] = true;
+         FinishExportFile(files[ii].fullPath, files[ii].backup, success);
+         if (success)
+            exportedFiles.push_back(files[ii].fullPath);
+      });
+}
+
+wxString ExportAudioDialog::PrepareExportFile(const wxFileName& filename,
+                                              wxFileName& backup)
+{
+   wxFileName name;
    if (mOverwriteExisting->GetValue()) {
       name = filename;
       backup.Assign(name);
@@ -1006,47 +1116,45 @@ ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
          name.SetName(wxString::Format(wxT("%s-%d"), base, i++));
       }
    }
+   return name.GetFullPath();
+}
 
-   bool success{false};
-   const wxString fullPath{name.GetFullPath()};
-
-   auto cleanup = finally( [&] {
-      if (backup.IsOk()) {
-         if ( success )
-            // Remove backup
-            ::wxRemoveFile(backup.GetFullPath());
-         else {
-            // Restore original
-            ::wxRemoveFile(fullPath);
-            ::wxRenameFile(backup.GetFullPath(), fullPath);
-         }
-      }
+void ExportAudioDialog::FinishExportFile(const wxString& fullPath,
+                                         const wxFileName& backup, bool success)
+{
+   if (backup.IsOk()) {
+      if ( success )
+         // Remove backup
+         ::wxRemoveFile(backup.GetFullPath());
       else {
-         if ( ! success )
-            // Remove any new, and only partially written, file.
-            ::wxRemoveFile(fullPath);
+         // Restore original
+         ::wxRemoveFile(fullPath);
+         ::wxRenameFile(backup.GetFullPath(), fullPath);
       }
-   } );
-
-   auto result = ExportResult::Error;
-   ExportProgressUI::ExceptionWrappedCall([&]
-   {
-      result = ExportProgressUI::Show(ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
-                                    .SetParameters(parameters)
-                                    .SetRange(t0, t1, selectedOnly)
-                                    .SetTags(&tags)
-                                    .SetNumChannels(channels)
-                                    .SetFileName(fullPath)
-                                    .SetSampleRate(mExportOptionsPanel->GetSampleRate())
-                                    .Build(mProject));
-   });
-
-   success = result == ExportResult::Success || result == ExportResult::Stopped;
-
-   if(success)
-      exportedFiles.push_back(fullPath);
+   }
+   else {
+      if ( ! success )
+         // Remove any new, and only partially written, file.
+         ::wxRemoveFile(fullPath);
+   }
+}
 
-   return result;
+ExportTask ExportAudioDialog::MakeExportTask(const ExportPlugin& plugin,
+                                             int formatIndex,
+                                             const ExportProcessor::Parameters& parameters,
+                                             const wxString& fullPath,
+                                             int channels,
+                                             double t0, double t1, bool selectedOnly,
+                                             const Tags& tags)
+{
+   return ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
+      .SetParameters(parameters)
+      .SetRange(t0, t1, selectedOnly)
+      .SetTags(&tags)
+      .SetNumChannels(channels)
+      .SetFileName(fullPath)
+      .SetSampleRate(mExportOptionsPanel->GetSampleRate())
+      .Build(mProject);
 }
 
 
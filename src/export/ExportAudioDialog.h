@@ -14,6 +14,9 @@
 #include "ExportTypes.h"
 #include <wx/filename.h>
 
+#include <functional>
+#include <memory>
+
 #include "ExportPlugin.h"
 #include "Tags.h"
 
@@ -102,6 +105,19 @@ private:
                                       const ExportProcessor::Parameters& parameters,
                                       FilePaths& exporterFiles);
    
+   //! Export the files of mExportSettings several at once
+   /*!
+    @param select called before the task for each setting is made, to select
+    what it exports, until the returned object is destroyed
+    */
+   ExportResult DoExportConcurrently(const ExportPlugin& plugin,
+                                     int formatIndex,
+                                     const ExportProcessor::Parameters& parameters,
+                                     const std::function<std::shared_ptr<void>(size_t)>& select,
+                                     bool selectedOnly,
+                                     size_t maxConcurrent,
+                                     FilePaths& exportedFiles);
+
    ExportResult DoExport(const ExportPlugin& plugin,
                          int formatIndex,
                          const ExportProcessor::Parameters& parameters,
@@ -110,6 +126,22 @@ private:
                          double t0, double t1, bool selectedOnly,
                          const Tags& tags,
                          FilePaths& exportedFiles);
+
+   //! The path to export to instead of `filename`, which may be moved to
+   //! `backup` first
+   wxString PrepareExportFile(const wxFileName& filename, wxFileName& backup);
+   //! Restore the file moved by PrepareExportFile() if export failed, else
+   //! remove it
+   static void FinishExportFile(const wxString& fullPath,
+                                const wxFileName& backup, bool success);
+
+   ExportTask MakeExportTask(const ExportPlugin& plugin,
+                             int formatIndex,
+                             const ExportProcessor::Parameters& parameters,
+                             const wxString& fullPath,
+                             int channels,
+                             double t0, double t1, bool selectedOnly,
+                             const Tags& tags);
    
    AudacityProject& mProject;
 
@@ -1,6 +1,7 @@
 
 #include <wx/app.h>
 #include <wx/bmpbuttn.h>
+#include <wx/ffile.h>
 #include <wx/textctrl.h>
 #include <wx/frame.h>
 
@@ -13,6 +14,7 @@
 #include "HelpText.h"
 #include "../HelpUtilities.h"
 #include "LogWindow.h"
+#include "MemoryAccounting.h"
 #include "Prefs.h"
 #include "Project.h"
 #include "ProjectSnap.h"
@@ -21,6 +23,7 @@
 #include "ShuttleGui.h"
 #include "SyncLock.h"
 #include "Theme.h"
+#include "Tracing.h"
 #include "CommandContext.h"
 #include "MenuRegistry.h"
 #include "../prefs/PrefsDialog.h"
@@ -275,6 +278,58 @@ void OnAudioDeviceInfo(const CommandContext &context)
       XO("Audio Device Info"), wxT("deviceinfo.txt") );
 }
 
+void OnMemoryUsage(const CommandContext &context)
+{
+   using namespace MemoryAccounting;
+   auto &project = context.project;
+   wxString info;
+   if (!IsEnabled())
+      info = XO(
+"Memory accounting is off.  Start Audacity with the environment variable\n\
+AUDACITY_MEMORY_ACCOUNTING set to turn it on.").Translation();
+   else {
+      info += wxString::Format(wxT("%-20s %16s %16s %10s\n"),
+         wxT("Subsystem"), wxT("Bytes"), wxT("Peak bytes"), wxT("Objects"));
+      for (unsigned ii = 0; ii < static_cast<unsigned>(Tag::nTags); ++ii) {
+         const auto tag = static_cast<Tag>(ii);
+         const auto totals = GetTotals(tag);
+         info += wxString::Format(wxT("%-20s %16llu %16llu %10llu\n"),
+            GetName(tag),
+            static_cast<unsigned long long>(totals.bytes),
+            static_cast<unsigned long long>(totals.peakBytes),
+            static_cast<unsigned long long>(totals.objects));
+      }
+   }
+   ShowDiagnostics( project, info,
+      XO("Memory Usage"), wxT("memoryusage.txt") );
+}
+
+#ifdef HAS_TRACING
+void OnTracing(const CommandContext &context)
+{
+   if (!Tracing::IsEnabled()) {
+      Tracing::Start();
+      return;
+   }
+   Tracing::Stop();
+
+   auto &window = GetProjectFrame(context.project);
+   /* i18n-hint: leave untranslated the file extension .json */
+   const auto fName = SelectFile(FileNames::Operation::Export,
+      XO("Save Trace As:"), wxEmptyString, XO("trace.json").Translation(),
+      wxT("json"), { { XO("Trace files"), { wxT("json") }, true } },
+      wxFD_SAVE | wxFD_OVERWRITE_PROMPT | wxRESIZE_BORDER, &window);
+   if (fName.empty())
+      return;
+
+   const auto json = Tracing::GetTraceJSON();
+   wxFFile file{ fName, wxT("wb") };
+   if (!file.IsOpened() || !file.Write(json.data(), json.size()))
+      AudacityMessageBox(XO("Could not write the trace to %s").Format(fName),
+         XO("Tracing"), wxOK | wxICON_ERROR, &window);
+}
+#endif
+
 void OnShowLog( const CommandContext &context )
 {
    LogWindow::Show();
@@ -430,6 +485,15 @@ auto HelpMenu()
             Command( wxT("DeviceInfo"), XXO("Au&dio Device Info..."),
                OnAudioDeviceInfo,
                AudioIONotBusyFlag() ),
+            Command( wxT("MemoryUsage"), XXO("&Memory Usage..."),
+               OnMemoryUsage, AlwaysEnabledFlag ),
+      #ifdef HAS_TRACING
+            // Checked while recording; unchecking saves the trace
+            Command( wxT("Tracing"), XXO("Record &Trace"),
+               OnTracing, AlwaysEnabledFlag,
+               Options{}.CheckTest( [](const AudacityProject &) {
+                  return Tracing::IsEnabled(); } ) ),
+      #endif
             Command( wxT("Log"), XXO("Show &Log..."), OnShowLog,
                AlwaysEnabledFlag ),
       #if defined(HAS_CRASH_REPORT)
@@ -1,5 +1,6 @@
 #include "../CommonCommandFlags.h"
 #include "../LabelTrack.h"
+#include "FrozenTracks.h"
 #include "MixAndRender.h"
 
 #include "Prefs.h"
@@ -568,6 +569,24 @@ void OnMixAndRenderToNewTrack(const CommandContext &context)
    DoMixAndRender(project, true);
 }
 
+void OnFreezeEffects(const CommandContext &context)
+{
+   auto &project = context.project;
+   auto &frozenTracks = FrozenTracks::Get(project);
+   for (auto pTrack : TrackList::Get(project).Selected<const WaveTrack>())
+      if (!frozenTracks.Freeze(*pTrack))
+         // Cancelled, or nothing to freeze
+         frozenTracks.Thaw(*pTrack);
+}
+
+void OnUnfreezeEffects(const CommandContext &context)
+{
+   auto &project = context.project;
+   auto &frozenTracks = FrozenTracks::Get(project);
+   for (auto pTrack : TrackList::Get(project).Selected<const WaveTrack>())
+      frozenTracks.Thaw(*pTrack);
+}
+
 void OnResample(const CommandContext &context)
 {
    auto &project = context.project;
@@ -1157,6 +1176,13 @@ auto TracksMenu()
                AudioIONotBusyFlag() | WaveTracksSelectedFlag(), wxT("Ctrl+Shift+M") )
          ),
 
+         Command( wxT("FreezeEffects"), XXO("&Freeze Realtime Effects"),
+            OnFreezeEffects,
+            AudioIONotBusyFlag() | WaveTracksSelectedFlag() ),
+         Command( wxT("UnfreezeEffects"), XXO("U&nfreeze Realtime Effects"),
+            OnUnfreezeEffects,
+            AudioIONotBusyFlag() | WaveTracksSelectedFlag() ),
+
          Command( wxT("Resample"), XXO("&Resample..."), OnResample,
             AudioIONotBusyFlag() | WaveTracksSelectedFlag() )
       ),
@@ -8,6 +8,7 @@
 #include "../ProjectAudioManager.h"
 #include "ProjectHistory.h"
 #include "../ProjectWindows.h"
+#include "../PunchAndRollCache.h"
 #include "../SelectUtilities.h"
 #include "../SoundActivatedRecord.h"
 #include "TrackFocus.h"
@@ -245,80 +246,26 @@ void OnPunchAndRoll(const CommandContext &context)
 
    // Delete the portion of the target tracks right of the selection, but first,
    // remember a part of the deletion for crossfading with the new recording.
-   // We may also adjust the starting point leftward if it is too close to the
-   // end of the track, so that at least some nonzero crossfade data can be
-   // taken.
-   PRCrossfadeData crossfadeData;
+   // The start is usually computed already, while the transport was idle.
    const double crossFadeDuration = std::max(0.0,
       gPrefs->Read(AUDIO_ROLL_CROSSFADE_KEY, DEFAULT_ROLL_CROSSFADE_MS)
          / 1000.0
    );
+   auto start = PunchAndRollCache::Get(project)
+      .Take(tracks, t1, crossFadeDuration);
+   if (!start)
+      // TODO error message
+      return;
 
-   // The test for t1 == 0.0 stops punch and roll deleting everything where the
-   // selection is at zero.  There wouldn't be any cued audio to play in
-   // that case, so a normal record, not a punch and roll, is called for.
-   bool error = (t1 == 0.0);
-
-   double newt1 = t1;
-   for (const auto &wt : tracks) {
-      auto rate = wt->GetRate();
-      sampleCount testSample(floor(t1 * rate));
-      const auto &intervals = as_const(*wt).Intervals();
-      auto pred = [rate](sampleCount testSample){ return
-         [rate, testSample](const auto &pInterval){
-            auto start = floor(pInterval->Start() * rate + 0.5);
-            auto end = floor(pInterval->End() * rate + 0.5);
-            auto ts = testSample.as_double();
-            return ts >= start && ts < end;
-         };
-      };
-      auto begin = intervals.begin(), end = intervals.end(),
-         iter = std::find_if(begin, end, pred(testSample));
-      if (iter == end)
-         // Bug 1890 (an enhancement request)
-         // Try again, a little to the left.
-         // Subtract 10 to allow a selection exactly at or slightly after the
-         // end time
-         iter = std::find_if(begin, end, pred(testSample - 10));
-      if (iter == end)
-         error = true;
-      else {
-         // May adjust t1 left
-         // Let's ignore the possibility of a clip even shorter than the
-         // crossfade duration!
-         newt1 = std::min(newt1, (*iter).get()->End() - crossFadeDuration);
-      }
-   }
-
-   if (error) {
+   if (!start->withinClips) {
       auto message = XO("Please select a time within a clip.");
       BasicUI::ShowErrorDialog(
          *ProjectFramePlacement(&project), XO("Error"), message, url);
       return;
    }
 
-   t1 = newt1;
-   for (const auto &wt : tracks) {
-      const auto endTime = wt->GetEndTime();
-      const auto duration =
-         std::max(0.0, std::min(crossFadeDuration, endTime - t1));
-      const size_t getLen = floor(duration * wt->GetRate());
-      if (getLen > 0) {
-         // TODO more-than-two-channels
-         const auto nChannels = std::min<size_t>(2, wt->NChannels());
-         crossfadeData.resize(nChannels);
-         float *buffers[2]{};
-         for (size_t ii = 0; ii < nChannels; ++ii) {
-            auto &data = crossfadeData[ii];
-            data.resize(getLen);
-            buffers[ii] = data.data();
-         }
-         const sampleCount pos = wt->TimeToLongSamples(t1);
-         if (!wt->GetFloats(0, nChannels, buffers, pos, getLen))
-            // TODO error message
-            return;
-      }
-   }
+   t1 = start->t1;
+   PRCrossfadeData crossfadeData = std::move(start->crossfadeData);
 
    // Change tracks only after passing the error checks above
    for (const auto &wt : tracks)
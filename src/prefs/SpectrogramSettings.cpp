@@ -24,6 +24,7 @@ Paul Licameli
 #include "FFT.h"
 #include "Prefs.h"
 #include "WaveTrack.h"
+#include "WindowTable.h"
 
 #include <cmath>
 
@@ -286,6 +287,8 @@ const TranslatableStrings &SpectrogramSettings::GetAlgorithmNames()
       XO("Reassignment") ,
       /* i18n-hint: EAC abbreviates "Enhanced Autocorrelation" */
       XO("Pitch (EAC)") ,
+      /* i18n-hint: a spectrogram with bins at equal ratios of frequency */
+      XO("Constant Q") ,
    };
    return results;
 }
@@ -556,24 +559,20 @@ namespace
          window[ii] = 0.0;
          window[fftLen - ii - 1] = 0.0;
       }
-      // Default rectangular window in the middle
-      for (; ii < endOfWindow; ++ii)
-         window[ii] = 1.0;
-      // Overwrite middle as needed
+      // Copy the middle from the shared table
+      const auto pTable =
+         GetWindowTable(windowType, windowSize, extra, which == DWINDOW);
+      std::copy(pTable->begin(), pTable->end(), window.get() + padding);
       switch (which) {
       case WINDOW:
-         NewWindowFunc(windowType, windowSize, extra, window.get() + padding);
+      case DWINDOW:
          break;
       case TWINDOW:
-         NewWindowFunc(windowType, windowSize, extra, window.get() + padding);
          {
             for (int jj = padding, multiplier = -(int)windowSize / 2; jj < (int)endOfWindow; ++jj, ++multiplier)
                window[jj] *= multiplier;
          }
          break;
-      case DWINDOW:
-         DerivativeOfWindowFunc(windowType, windowSize, extra, window.get() + padding);
-         break;
       default:
          wxASSERT(false);
       }
@@ -177,6 +177,7 @@ public:
       algSTFT = 0,
       algReassignment,
       algPitchEAC,
+      algConstantQ,
 
       algNumAlgorithms,
    };
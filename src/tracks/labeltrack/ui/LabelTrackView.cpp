@@ -424,7 +424,11 @@ void LabelTrackView::ComputeTextPosition(const wxRect & r, int index) const
 /// ComputeLayout determines which row each label
 /// should be placed on, and reserves space for it.
 /// Function assumes that the labels are sorted.
-void LabelTrackView::ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) const
+/// Only labels near the screen are laid out, and the text of a label
+/// is measured only when a row is free for it, so that dense tracks
+/// cost little more than the labels that can be shown.
+void LabelTrackView::ComputeLayout(
+   wxDC &dc, const wxRect & r, const ZoomInfo &zoomInfo) const
 {
    int xUsed[MAX_NUM_ROWS];
 
@@ -454,7 +458,24 @@ void LabelTrackView::ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) c
    const auto pTrack = FindLabelTrack();
    const auto &mLabels = pTrack->GetLabels();
 
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   // Hit tests look at the positions of all labels
+   for (const auto &labelStruct : mLabels)
+      labelStruct.y = -1;
+
+   mLabelIndex.Reset(mLabels.begin(), mLabels.end(),
+      [](const LabelStruct &ls){ return ls.getT0(); },
+      [](const LabelStruct &ls){ return ls.getT1(); });
+
+   // Labels starting up to a screen to the left may have text reaching
+   // into it, and right glyphs stick out by half an icon
+   mVisibleLabels.clear();
+   mLabelIndex.Visit(
+      zoomInfo.PositionToTime(r.x - r.width, r.x),
+      zoomInfo.PositionToTime(r.x + r.width + mIconWidth, r.x),
+      [this](size_t i){ mVisibleLabels.push_back(i); });
+
+   for (const int i : mVisibleLabels) {
+      const auto &labelStruct = mLabels[i];
       const int x = zoomInfo.TimeToPosition(labelStruct.getT0(), r.x);
       const int x1 = zoomInfo.TimeToPosition(labelStruct.getT1(), r.x);
       int y = r.y;
@@ -479,6 +500,10 @@ void LabelTrackView::ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) c
       // IF we found such a row THEN record a valid position.
       if( iRow<nRows )
       {
+         wxCoord textWidth, textHeight;
+         dc.GetTextExtent(labelStruct.title, &textWidth, &textHeight);
+         labelStruct.width = textWidth;
+
          // Possibly update the number of rows actually used.
          if( iRow >= nRowsUsed )
             nRowsUsed=iRow+1;
@@ -492,7 +517,7 @@ void LabelTrackView::ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) c
          if( xUsed[iRow] < x1 ) xUsed[iRow]=x1;
          ComputeTextPosition( r, i );
       }
-   }}
+   }
 }
 
 /// Draw vertical lines that go exactly through the position
@@ -627,6 +652,9 @@ void LabelTrackView::DrawTextBox(
    // Draw bar for label extent...
    // We don't quite draw from x to x1 because we allow
    // half an icon width at each end.
+    if (ls.y == -1)
+       return;
+
     const auto textFrameHeight = GetTextFrameHeight();
     auto& xText = ls.xText;
     const int xStart = wxMax(r.x, xText - mIconWidth / 2);
@@ -788,16 +816,6 @@ const
       AColor::labelSelectedBrush, AColor::labelUnselectedBrush,
       SyncLock::IsSelectedOrSyncLockSelected(track));
 
-   wxCoord textWidth, textHeight;
-
-   // Get the text widths.
-   // TODO: Make more efficient by only re-computing when a
-   // text label title changes.
-   for (const auto &labelStruct : mLabels) {
-      dc.GetTextExtent(labelStruct.title, &textWidth, &textHeight);
-      labelStruct.width = textWidth;
-   }
-
    // TODO: And this only needs to be done once, but we
    // do need the dc to do it.
    // We need to set mTextHeight to something sensible,
@@ -807,7 +825,15 @@ const
    mTextHeight = dc.GetFontMetrics().ascent + dc.GetFontMetrics().descent;
    const int yFrameHeight = mTextHeight + TextFramePadding * 2;
 
-   ComputeLayout( r, zoomInfo );
+   ComputeLayout( dc, r, zoomInfo );
+
+   // The track drawn may be a pending substitute of the one laid out
+   const auto forVisibleLabels = [&](auto f) {
+      for (const int i : mVisibleLabels)
+         if (i < static_cast<int>(mLabels.size()))
+            f(i, mLabels[i]);
+   };
+
    dc.SetTextForeground(theTheme.Colour( clrLabelTrackText));
    dc.SetBackgroundMode(wxTRANSPARENT);
    dc.SetBrush(AColor::labelTextNormalBrush);
@@ -818,11 +844,31 @@ const
    // so that the correct things overpaint each other.
 
    // Draw vertical lines that show where the end positions are.
-   for (const auto &labelStruct : mLabels)
-      DrawLines( dc, labelStruct, r );
+   // Labels with no room in the rows are only lines, which coincide
+   // when zoomed out on a dense track, so draw each column once.
+   {
+      std::vector<bool> linedColumns(r.width + 1);
+      const auto isLined = [&](int x) {
+         if (x < r.x || x > r.x + r.width)
+            return true;
+         const bool lined = linedColumns[x - r.x];
+         linedColumns[x - r.x] = true;
+         return lined;
+      };
+      forVisibleLabels([&](int, const LabelStruct &labelStruct) {
+         if (labelStruct.y >= 0) {
+            DrawLines( dc, labelStruct, r );
+            return;
+         }
+         const bool newLeft = !isLined(labelStruct.x);
+         const bool newRight = !isLined(labelStruct.x1);
+         if (newLeft || newRight)
+            DrawLines( dc, labelStruct, r );
+      });
+   }
 
    // Draw the end glyphs.
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   forVisibleLabels([&](int i, const LabelStruct &labelStruct) {
       GlyphLeft=0;
       GlyphRight=1;
       if( pHit && i == pHit->mMouseOverLabelLeft )
@@ -830,7 +876,7 @@ const
       if( pHit && i == pHit->mMouseOverLabelRight )
          GlyphRight = (pHit->mEdge & 4) ? 7:4;
       DrawGlyphs( dc, labelStruct, r, GlyphLeft, GlyphRight );
-   }}
+   });
 
    auto &project = *artist->parent->GetProject();
 
@@ -842,7 +888,7 @@ const
       highlightTrack = target &&
          target->FindTrack().get() == FindTrack().get();
 #endif
-      int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+      forVisibleLabels([&](int i, const LabelStruct &labelStruct) {
          bool highlight = false;
 #ifdef EXPERIMENTAL_TRACK_PANEL_HIGHLIGHTING
          highlight = highlightTrack && target->GetLabelNum() == i;
@@ -863,7 +909,7 @@ const
          DrawTextBox(dc, labelStruct, r);
 
          dc.SetBrush(AColor::labelTextNormalBrush);
-      }
+      });
    }
 
    // Draw highlights
@@ -876,13 +922,13 @@ const
    }
 
    // Draw the text and the label boxes.
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   forVisibleLabels([&](int i, const LabelStruct &labelStruct) {
       if(mTextEditIndex == i )
          dc.SetBrush(AColor::labelTextEditBrush);
       DrawText( dc, labelStruct, r );
       if(mTextEditIndex == i )
          dc.SetBrush(AColor::labelTextNormalBrush);
-   }}
+   });
 
    // Draw the cursor, if there is one.
    if(mInitialCursorPos == mCurrentCursorPos && IsValidIndex(mTextEditIndex, project))
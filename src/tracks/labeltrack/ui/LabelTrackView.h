@@ -12,8 +12,11 @@ Paul Licameli split from class LabelTrack
 #define __AUDACITY_LABEL_TRACK_VIEW__
 
 #include "../../ui/CommonChannelView.h"
+#include "IntervalIndex.h"
 #include "Observer.h"
 
+#include <vector>
+
 class LabelGlyphHandle;
 class LabelTextHandle;
 class LabelDefaultClickHandle;
@@ -208,7 +211,8 @@ private:
                                                    /// when done editing
 
    void ComputeTextPosition(const wxRect & r, int index) const;
-   void ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) const;
+   void ComputeLayout(
+      wxDC &dc, const wxRect & r, const ZoomInfo &zoomInfo) const;
    static void DrawLines( wxDC & dc, const LabelStruct &ls, const wxRect & r);
    static void DrawGlyphs( wxDC & dc, const LabelStruct &ls, const wxRect & r,
       int GlyphLeft, int GlyphRight);
@@ -266,6 +270,13 @@ private:
 
    // Bug #2571: See explanation in ShowContextMenu()
    int mEditIndex;
+
+   //! Times of the labels, indexed again at each layout, because labels
+   //! change in place without notification
+   mutable IntervalIndex mLabelIndex;
+   //! Indices of the labels that ComputeLayout() found near the screen,
+   //! in order; only these are drawn
+   mutable std::vector<int> mVisibleLabels;
 };
 
 #endif
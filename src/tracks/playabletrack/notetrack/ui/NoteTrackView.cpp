@@ -32,6 +32,10 @@ Paul Licameli split from TrackPanel.cpp
 
 #include <wx/dc.h>
 
+#include <algorithm>
+#include <climits>
+#include <vector>
+
 NoteTrackView::NoteTrackView(const std::shared_ptr<Channel> &pChannel)
    : CommonChannelView{ pChannel }
 {
@@ -462,11 +466,19 @@ void DrawNoteTrack(TrackPanelDrawingContext &context,
    // We want to draw in seconds, so we need to convert to seconds
    seq->convert_to_seconds();
 
+   // Notes a pixel wide or less, in the same column and row as the last
+   // one drawn there, would only paint it again; dense tracks zoomed out
+   // have many of them
+   std::vector<int> lastThinColumns(128, INT_MIN);
+
    Alg_iterator iterator(seq, false);
    iterator.begin();
    //for every event
    Alg_event_ptr evt;
    while (0 != (evt = iterator.next())) {
+      // Events come in order of time, so the rest all start after the box
+      if (evt->time + track.GetStartTime() >= h1)
+         break;
       if (evt->get_type() == 'n') { // 'n' means a note
          Alg_note_ptr note = (Alg_note_ptr) evt;
          // if the note's channel is visible
@@ -514,6 +526,13 @@ void DrawNoteTrack(TrackPanelDrawingContext &context,
                            nr.y += offset;
                         }
                         // nr.y += rect.y;
+                        if (nr.width <= 1) {
+                           auto &lastColumn = lastThinColumns[
+                              std::clamp(static_cast<int>(note->pitch), 0, 127)];
+                           if (lastColumn == nr.x)
+                              continue;
+                           lastColumn = nr.x;
+                        }
                         if (muted)
                            AColor::LightMIDIChannel(&dc, note->chan + 1);
                         else
@@ -11,13 +11,27 @@
 #include "SpectrumCache.h"
 
 #include "../../../../prefs/SpectrogramSettings.h"
+#include "BasicUI.h"
+#include "ConstantQ.h"
+#include "Prefs.h"
 #include "RealFFTf.h"
 #include "Sequence.h"
 #include "Spectrum.h"
+#include "SpectrumColumnCache.h"
 #include "WaveClipUIUtilities.h"
 #include "WaveTrack.h"
 #include "WideSampleSequence.h"
+#include "concurrency/CancellationContext.h"
+#include "concurrency/ICancellable.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+BoolSetting SpectrogramInBackground{ L"/Spectrum/ComputeInBackground", true };
 
 namespace {
 
@@ -70,6 +84,185 @@ void ComputeSpectrogramGainFactors
    }
 }
 
+//! Value of columns not yet computed; painted like silence
+constexpr float PlaceholderValue = -160.0f;
+
+//! How many columns each task of PopulateInBackground() computes
+constexpr int ColumnsPerTask = 16;
+
+//! Threads, shared by all clips, that compute spectrogram columns in order of
+//! submission, taking tasks of low priority only when there are no others
+class SpectrumWorkers final {
+public:
+   static SpectrumWorkers &Get()
+   {
+      static SpectrumWorkers instance;
+      return instance;
+   }
+
+   ~SpectrumWorkers()
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mStopping = true;
+      }
+      mCondition.notify_all();
+      for (auto &thread : mThreads)
+         thread.join();
+   }
+
+   void Submit(std::function<void()> task, bool lowPriority = false)
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         (lowPriority ? mLowPriorityTasks : mTasks).push_back(move(task));
+      }
+      mCondition.notify_one();
+   }
+
+private:
+   SpectrumWorkers()
+   {
+      // Leave one core for the main thread
+      const auto nThreads =
+         std::max(2u, std::thread::hardware_concurrency()) - 1;
+      for (size_t ii = 0; ii < nThreads; ++ii)
+         mThreads.emplace_back([this]{ Loop(); });
+   }
+
+   void Loop()
+   {
+      while (true) {
+         std::function<void()> task;
+         {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            mCondition.wait(lock, [this]{
+               return mStopping || !mTasks.empty() || !mLowPriorityTasks.empty();
+            });
+            if (mStopping)
+               return;
+            auto &tasks = mTasks.empty() ? mLowPriorityTasks : mTasks;
+            task = move(tasks.front());
+            tasks.pop_front();
+         }
+         task();
+      }
+   }
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::deque<std::function<void()>> mTasks;
+   std::deque<std::function<void()>> mLowPriorityTasks;
+   std::vector<std::thread> mThreads;
+   bool mStopping{ false };
+};
+
+}
+
+SpecCache::Parameters::Parameters(const SpectrogramSettings &settings)
+   : algorithm{ settings.algorithm }
+   , windowType{ settings.windowType }
+   , frequencyGain{ settings.frequencyGain }
+   , windowSize{ settings.WindowSize() }
+   , zeroPaddingFactor{ settings.ZeroPaddingFactor() }
+   , nBins{ settings.NBins() }
+   , hFFT{ settings.hFFT.get() }
+   , window{ settings.window.get() }
+   , tWindow{ settings.tWindow.get() }
+   , dWindow{ settings.dWindow.get() }
+   , useColumnCache{
+      settings.algorithm != SpectrogramSettings::algReassignment &&
+      SpectrumColumnCache::Get().GetCapacity() > 0 }
+{
+}
+
+SpecCache::ClipSamples::ClipSamples(
+   const WaveChannelInterval &clip, const Sequence &sequence_)
+   : sequence{ sequence_ }
+   , trimLeft{ clip.TimeToSamples(clip.GetTrimLeft()) }
+   , rate{ static_cast<double>(clip.GetRate()) }
+   , stretchRatio{ clip.GetStretchRatio() }
+{
+}
+
+//! Everything the worker threads use: copies of the window and the samples,
+//! and results for the columns
+/*!
+ It is destroyed only in the main thread, which may release the last
+ reference to sample blocks.  It copies no SpectrogramSettings, which change
+ when preferences do.
+ */
+struct SpecCache::Job final : audacity::concurrency::ICancellable {
+   //! @pre `settings.window` is not null
+   Job(const SpectrogramSettings &settings, const WaveChannelInterval &clip,
+      const SpecCache &cache, double pixelsPerSecond_,
+      std::function<void()> onProgress_)
+      : fftLen{ settings.GetFFTLength() }
+      , hFFT{ GetFFT(fftLen) }
+      , window{ fftLen }
+      , params{ settings }
+      , pSequence{ std::make_unique<Sequence>(
+           clip.GetSequence(), clip.GetSequence().GetFactory()) }
+      , samples{ clip, *pSequence }
+      , pixelsPerSecond{ pixelsPerSecond_ }
+      , onProgress{ move(onProgress_) }
+   {
+      std::copy_n(settings.window.get(), fftLen, window.get());
+      params.hFFT = hFFT.get();
+      params.window = window.get();
+      params.tWindow = params.dWindow = nullptr;
+      if (settings.algorithm == SpectrogramSettings::algConstantQ) {
+         pConstantQ = ConstantQKernels::Get(fftLen, settings.WindowSize(),
+            settings.windowType, samples.rate);
+         params.constantQ = pConstantQ.get();
+      }
+      columns.where = cache.where;
+      columns.len = cache.len;
+      columns.freq.resize(cache.freq.size());
+      if (settings.algorithm != SpectrogramSettings::algPitchEAC)
+         ComputeSpectrogramGainFactors(
+            fftLen, samples.rate, settings.frequencyGain, gainFactors);
+   }
+
+   void Cancel() override { cancelled = true; }
+
+   //! Compute columns from begin to end, in a worker thread
+   void Compute(int begin, int end)
+   {
+      std::vector<float> scratch(fftLen);
+      for (auto xx = begin; xx < end; ++xx) {
+         if (cancelled)
+            return;
+         columns.CalculateColumn(params, samples, xx, pixelsPerSecond,
+            gainFactors, scratch.data(), columns.freq.data());
+      }
+      std::lock_guard<std::mutex> lock{ mutex };
+      finished.emplace_back(begin, end);
+   }
+
+   const size_t fftLen;
+   const HFFT hFFT;
+   const Floats window;
+   std::shared_ptr<const ConstantQKernels> pConstantQ;
+   Parameters params;
+   const std::unique_ptr<Sequence> pSequence;
+   const ClipSamples samples;
+   const double pixelsPerSecond;
+   //! Accessed only in the main thread
+   std::function<void()> onProgress;
+   std::vector<float> gainFactors;
+   //! Columns are written only by the task that computes them
+   SpecCache columns;
+   std::atomic<bool> cancelled{ false };
+
+   std::mutex mutex;
+   //! Ranges of columns finished but not yet collected
+   std::vector<std::pair<int, int>> finished;
+};
+
+SpecCache::~SpecCache()
+{
+   Cancel();
 }
 
 bool SpecCache::Matches(
@@ -92,27 +285,29 @@ bool SpecCache::Matches(
 }
 
 bool SpecCache::CalculateOneSpectrum(
-   const SpectrogramSettings& settings, const WaveChannelInterval& clip,
+   const Parameters& params, const ClipSamples& clip,
    const int xx, double pixelsPerSecond, int lowerBoundX, int upperBoundX,
    const std::vector<float>& gainFactors, float* __restrict scratch,
-   float* __restrict out) const
+   float* __restrict out, std::optional<sampleCount> center) const
 {
    bool result = false;
    const bool reassignment =
-      (settings.algorithm == SpectrogramSettings::algReassignment);
-   const size_t windowSizeSetting = settings.WindowSize();
+      (params.algorithm == SpectrogramSettings::algReassignment);
+   const size_t windowSizeSetting = params.windowSize;
 
    sampleCount from;
 
-   const auto numSamples = clip.GetSequence().GetNumSamples();
-   const auto sampleRate = clip.GetRate();
-   const auto stretchRatio = clip.GetStretchRatio();
+   const auto numSamples = clip.sequence.GetNumSamples();
+   const auto sampleRate = clip.rate;
+   const auto stretchRatio = clip.stretchRatio;
    const auto samplesPerPixel = sampleRate / pixelsPerSecond / stretchRatio;
    // xx may be for a column that is out of the visible bounds, but only
    // when we are calculating reassignment contributions that may cross into
    // the visible area.
 
-   if (xx < 0)
+   if (center)
+      from = *center;
+   else if (xx < 0)
       from = sampleCount(where[0].as_double() + xx * samplesPerPixel);
    else if (xx > (int)len)
       from = sampleCount(where[len].as_double() + (xx - len) * samplesPerPixel);
@@ -120,11 +315,11 @@ bool SpecCache::CalculateOneSpectrum(
       from = where[xx];
 
    const bool autocorrelation =
-      settings.algorithm == SpectrogramSettings::algPitchEAC;
-   const size_t zeroPaddingFactorSetting = settings.ZeroPaddingFactor();
+      params.algorithm == SpectrogramSettings::algPitchEAC;
+   const size_t zeroPaddingFactorSetting = params.zeroPaddingFactor;
    const size_t padding = (windowSizeSetting * (zeroPaddingFactorSetting - 1)) / 2;
    const size_t fftLen = windowSizeSetting * zeroPaddingFactorSetting;
-   auto nBins = settings.NBins();
+   auto nBins = params.nBins;
 
    if (from < 0 || from >= numSamples) {
       if (xx >= 0 && xx < (int)len) {
@@ -167,12 +362,11 @@ bool SpecCache::CalculateOneSpectrum(
          }
 
          if (myLen > 0) {
-            constexpr auto iChannel = 0u;
             constexpr auto mayThrow = false; // Don't throw just for display
-            mSampleCacheHolder.emplace(
-               clip.GetSampleView(from, myLen, mayThrow));
+            const auto view = clip.sequence.GetFloatSampleView(
+               from + clip.trimLeft, myLen, mayThrow);
             floats.resize(myLen);
-            mSampleCacheHolder->Copy(floats.data(), myLen);
+            view.Copy(floats.data(), myLen);
             useBuffer = floats.data();
             if (copy) {
                if (useBuffer)
@@ -193,38 +387,30 @@ bool SpecCache::CalculateOneSpectrum(
          // This function does not mutate useBuffer
          ComputeSpectrum(
             useBuffer, windowSizeSetting, windowSizeSetting, results,
-            autocorrelation, settings.windowType);
+            autocorrelation, params.windowType);
       }
       else if (reassignment) {
          static const double epsilon = 1e-16;
-         const auto hFFT = settings.hFFT.get();
+         const auto hFFT = params.hFFT;
 
          float *const scratch2 = scratch + fftLen;
-         std::copy(scratch, scratch2, scratch2);
-
          float *const scratch3 = scratch + 2 * fftLen;
-         std::copy(scratch, scratch2, scratch3);
-
-         {
-            const float *const window = settings.window.get();
-            for (size_t ii = 0; ii < fftLen; ++ii)
-               scratch[ii] *= window[ii];
-            RealFFTf(scratch, hFFT);
-         }
 
+         // Apply the three windows in one pass over the samples, then do
+         // the three transforms with the one plan
          {
-            const float *const dWindow = settings.dWindow.get();
-            for (size_t ii = 0; ii < fftLen; ++ii)
-               scratch2[ii] *= dWindow[ii];
-            RealFFTf(scratch2, hFFT);
-         }
-
-         {
-            const float *const tWindow = settings.tWindow.get();
-            for (size_t ii = 0; ii < fftLen; ++ii)
-               scratch3[ii] *= tWindow[ii];
-            RealFFTf(scratch3, hFFT);
+            const float *const __restrict window = params.window;
+            const float *const __restrict dWindow = params.dWindow;
+            const float *const __restrict tWindow = params.tWindow;
+            for (size_t ii = 0; ii < fftLen; ++ii) {
+               const auto sample = scratch[ii];
+               scratch[ii] = sample * window[ii];
+               scratch2[ii] = sample * dWindow[ii];
+               scratch3[ii] = sample * tWindow[ii];
+            }
          }
+         for (const auto buffer : { scratch, scratch2, scratch3 })
+            RealFFTf(buffer, hFFT);
 
          for (size_t ii = 0; ii < hFFT->Points; ++ii) {
             const int index = hFFT->BitReversed[ii];
@@ -291,6 +477,30 @@ bool SpecCache::CalculateOneSpectrum(
             }
          }
       }
+      else if (params.constantQ) {
+         // not reassignment, xx is surely within bounds.
+         wxASSERT(xx >= 0);
+         float *const results = &out[nBins * xx];
+
+         // The kernels include their windows, so instead of windowing,
+         // just clear the padding zones
+         std::fill(scratch, scratch + padding, 0.0f);
+         std::fill(scratch + padding + windowSizeSetting, scratch + fftLen, 0.0f);
+         RealFFTf(scratch, params.hFFT);
+         params.constantQ->GetPowers(*params.hFFT, scratch, results);
+         for (size_t ii = 0; ii < nBins; ++ii) {
+            float &power = results[ii];
+            if (power <= 0)
+               power = -160.0;
+            else
+               power = 10.0*log10f(power);
+         }
+         if (!gainFactors.empty()) {
+            // Apply a frequency-dependent gain factor
+            for (size_t ii = 0; ii < nBins; ++ii)
+               results[ii] += gainFactors[ii];
+         }
+      }
       else {
          // not reassignment, xx is surely within bounds.
          wxASSERT(xx >= 0);
@@ -303,7 +513,7 @@ bool SpecCache::CalculateOneSpectrum(
 
          // This function mutates useBuffer
          ComputeSpectrumUsingRealFFTf
-            (useBuffer, settings.hFFT.get(), settings.window.get(), fftLen, results);
+            (useBuffer, params.hFFT, params.window, fftLen, results);
          if (!gainFactors.empty()) {
             // Apply a frequency-dependent gain factor
             for (size_t ii = 0; ii < nBins; ++ii)
@@ -315,6 +525,82 @@ bool SpecCache::CalculateOneSpectrum(
    return result;
 }
 
+namespace {
+//! Hash of the blocks of a sequence overlapping samples from start to end
+uint64_t HashBlocks(const Sequence &sequence, sampleCount start, sampleCount end)
+{
+   start = std::max<sampleCount>(start, 0);
+   end = std::min(end, sequence.GetNumSamples());
+   uint64_t result = 0;
+   if (start >= end)
+      return result;
+   const auto &blocks = sequence.GetBlockArray();
+   for (auto b = sequence.FindBlock(start);
+      b < static_cast<int>(blocks.size()) && blocks[b].start < end; ++b
+   ) {
+      // Mix id and start, as in boost::hash_combine
+      for (const auto value : {
+         static_cast<uint64_t>(blocks[b].sb->GetBlockID()),
+         static_cast<uint64_t>(blocks[b].start.as_long_long())
+      })
+         result ^= value + 0x9e3779b97f4a7c15ull + (result << 6) + (result >> 2);
+   }
+   return result;
+}
+}
+
+void SpecCache::CalculateColumn(
+   const Parameters& params, const ClipSamples &clip,
+   const int xx, double pixelsPerSecond,
+   const std::vector<float>& gainFactors, float* __restrict scratch,
+   float* __restrict out) const
+{
+   assert(params.algorithm != SpectrogramSettings::algReassignment);
+   if (!params.useColumnCache) {
+      CalculateOneSpectrum(params, clip, xx, pixelsPerSecond, xx, xx + 1,
+         gainFactors, scratch, out);
+      return;
+   }
+
+   // Center on a grid with spacing a power of two, not more than the samples
+   // per pixel, so the columns of coarser zooming are among these
+   const auto samplesPerPixel =
+      clip.rate / pixelsPerSecond / clip.stretchRatio;
+   long long spacing = 1;
+   while (2 * spacing <= samplesPerPixel)
+      spacing *= 2;
+   const auto position =
+      (where[xx].as_long_long() + spacing / 2) / spacing * spacing;
+   const auto numSamples = clip.sequence.GetNumSamples();
+   if (position < 0 || position >= numSamples) {
+      // Out of bounds; not worth caching
+      CalculateOneSpectrum(params, clip, xx, pixelsPerSecond, xx, xx + 1,
+         gainFactors, scratch, out, sampleCount{ position });
+      return;
+   }
+
+   // A superset of the samples of the window, in the sequence
+   const auto reach = static_cast<long long>(params.windowSize);
+   const sampleCount first = clip.trimLeft + position - reach;
+   const sampleCount last = clip.trimLeft + position + reach;
+   const auto &pFactory = clip.sequence.GetFactory();
+   const SpectrumColumnCache::Key key{
+      pFactory.get(), params.algorithm, params.windowType,
+      params.frequencyGain, params.windowSize, params.zeroPaddingFactor,
+      clip.rate, position, clip.trimLeft.as_long_long(),
+      position + reach >= numSamples ? numSamples.as_long_long() : -1,
+      HashBlocks(clip.sequence, first, last)
+   };
+
+   auto &cache = SpectrumColumnCache::Get();
+   float *const results = &out[params.nBins * xx];
+   if (cache.Find(key, params.nBins, results))
+      return;
+   CalculateOneSpectrum(params, clip, xx, pixelsPerSecond, xx, xx + 1,
+      gainFactors, scratch, out, sampleCount{ position });
+   cache.Insert(key, pFactory, params.nBins, results);
+}
+
 void SpecCache::Grow(
    size_t len_, SpectrogramSettings& settings, double samplesPerPixel,
    double start_)
@@ -329,6 +615,9 @@ void SpecCache::Grow(
    // Sample counts corresponding to the columns, and to one past the end.
    where.resize(len_ + 1);
 
+   // Callers must find afresh which columns need computation
+   pending.assign(len_, false);
+
    len = len_;
    algorithm = settings.algorithm;
    spp = samplesPerPixel;
@@ -366,6 +655,15 @@ void SpecCache::Populate(
       ComputeSpectrogramGainFactors(
          fftLen, sampleRate, frequencyGainSetting, gainFactors);
 
+   Parameters params{ settings };
+   std::shared_ptr<const ConstantQKernels> pConstantQ;
+   if (settings.algorithm == SpectrogramSettings::algConstantQ) {
+      pConstantQ = ConstantQKernels::Get(
+         fftLen, windowSizeSetting, settings.windowType, sampleRate);
+      params.constantQ = pConstantQ.get();
+   }
+   const ClipSamples samples{ clip, clip.GetSequence() };
+
    // Loop over the ranges before and after the copied portion and compute anew.
    // One of the ranges may be empty.
    for (int jj = 0; jj < 2; ++jj) {
@@ -402,9 +700,13 @@ void SpecCache::Populate(
 #else
          float* buffer = &scratch[0];
 #endif
-         CalculateOneSpectrum(
-            settings, clip, xx, pixelsPerSecond, lowerBoundX, upperBoundX,
-            gainFactors, buffer, &freq[0]);
+         if (reassignment)
+            CalculateOneSpectrum(
+               params, samples, xx, pixelsPerSecond, lowerBoundX, upperBoundX,
+               gainFactors, buffer, &freq[0]);
+         else
+            CalculateColumn(params, samples, xx, pixelsPerSecond,
+               gainFactors, buffer, &freq[0]);
       }
 
       if (reassignment) {
@@ -418,7 +720,7 @@ void SpecCache::Populate(
          for (int ii = 0; ii < limit; ++ii)
          {
             const bool result = CalculateOneSpectrum(
-               settings, clip, --xx, pixelsPerSecond, lowerBoundX, upperBoundX,
+               params, samples, --xx, pixelsPerSecond, lowerBoundX, upperBoundX,
                gainFactors, &scratch[0], &freq[0]);
             if (!result)
                break;
@@ -428,7 +730,7 @@ void SpecCache::Populate(
          for (int ii = 0; ii < limit; ++ii)
          {
             const bool result = CalculateOneSpectrum(
-               settings, clip, xx++, pixelsPerSecond, lowerBoundX, upperBoundX,
+               params, samples, xx++, pixelsPerSecond, lowerBoundX, upperBoundX,
                gainFactors, &scratch[0], &freq[0]);
             if (!result)
                break;
@@ -458,15 +760,103 @@ void SpecCache::Populate(
    }
 }
 
+void SpecCache::PopulateInBackground(
+   const SpectrogramSettings& settings, const WaveChannelInterval& clip,
+   int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond,
+   std::function<void()> onProgress, bool lowPriority)
+{
+   assert(settings.algorithm != SpectrogramSettings::algReassignment);
+   Cancel();
+
+   const auto nBins = settings.NBins();
+   for (const auto [lowerBoundX, upperBoundX] : {
+      std::pair{ 0, copyBegin }, std::pair{ copyEnd, int(numPixels) }
+   })
+      std::fill(pending.begin() + lowerBoundX, pending.begin() + upperBoundX,
+         true);
+   for (size_t xx = 0; xx < len; ++xx)
+      if (pending[xx])
+         std::fill_n(freq.begin() + nBins * xx, nBins, PlaceholderValue);
+   if (std::find(pending.begin(), pending.end(), true) == pending.end())
+      return;
+
+   auto pJob = std::make_shared<Job>(
+      settings, clip, *this, pixelsPerSecond, move(onProgress));
+   mpCancellation = audacity::concurrency::CancellationContext::Create();
+   mpCancellation->OnCancelled(pJob);
+   mpJob = pJob;
+
+   // Submit runs of pending columns, a few at a time, from left to right
+   for (int xx = 0, end = 0; xx < int(len); xx = end) {
+      end = xx + 1;
+      if (!pending[xx])
+         continue;
+      while (end < int(len) && pending[end] && end - xx < ColumnsPerTask)
+         ++end;
+      SpectrumWorkers::Get().Submit([pJob, xx, end]() mutable {
+         try {
+            pJob->Compute(xx, end);
+         }
+         catch (...) {
+            // Leave the columns pending; they may be computed again later
+         }
+         // Release the job in the main thread
+         BasicUI::CallAfter([pJob = move(pJob)]{
+            if (!pJob->cancelled && pJob->onProgress)
+               pJob->onProgress();
+         });
+      }, lowPriority);
+   }
+}
+
+bool SpecCache::Collect()
+{
+   if (!mpJob)
+      return false;
+   std::vector<std::pair<int, int>> finished;
+   {
+      std::lock_guard<std::mutex> lock{ mpJob->mutex };
+      swap(finished, mpJob->finished);
+   }
+   const auto nBins = mpJob->params.nBins;
+   const auto &results = mpJob->columns.freq;
+   for (const auto [begin, end] : finished) {
+      std::copy(results.begin() + nBins * begin, results.begin() + nBins * end,
+         freq.begin() + nBins * begin);
+      std::fill(pending.begin() + begin, pending.begin() + end, false);
+   }
+   if (std::find(pending.begin(), pending.end(), true) == pending.end())
+      Cancel();
+   return !finished.empty();
+}
+
+void SpecCache::Cancel()
+{
+   if (mpCancellation)
+      mpCancellation->Cancel();
+   if (mpJob)
+      // Don't notify any more
+      mpJob->onProgress = nullptr;
+   mpCancellation.reset();
+   mpJob.reset();
+}
+
 bool WaveClipSpectrumCache::GetSpectrogram(
    const WaveChannelInterval &clip,
    const float*& spectrogram, SpectrogramSettings& settings,
    const sampleCount*& where, size_t numPixels, double t0,
-   double pixelsPerSecond)
+   double pixelsPerSecond, std::function<void()> onProgress)
 
 {
    auto &mSpecCache = mSpecCaches[clip.GetChannelIndex()];
 
+   // Take any columns finished in the background, before they might be
+   // moved below
+   const bool collected = mSpecCache->Collect();
+
+   SpectrumColumnCache::Get().SetCapacity(
+      static_cast<size_t>(std::max(0, SpectrumColumnCacheSize.Read())) << 20);
+
    const auto sampleRate = clip.GetRate();
    const auto stretchRatio = clip.GetStretchRatio();
    const auto samplesPerPixel = sampleRate / pixelsPerSecond / stretchRatio;
@@ -483,9 +873,12 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       spectrogram = &mSpecCache->freq[0];
       where = &mSpecCache->where[0];
 
-      return false;  //hit cache completely
+      return collected;  //hit cache completely
    }
 
+   // Columns computed in the background from now would be misplaced
+   mSpecCache->Cancel();
+
    // Caching is not implemented for reassignment, unless for
    // a complete hit, because of the complications of time reassignment
    if (settings.algorithm == SpectrogramSettings::algReassignment)
@@ -507,6 +900,7 @@ bool WaveClipSpectrumCache::GetSpectrogram(
    double correction = 0.0;
 
    int copyBegin = 0, copyEnd = 0;
+   std::vector<bool> wasPending;
    if (match) {
       WaveClipUIUtilities::findCorrection(
          mSpecCache->where, mSpecCache->len, numPixels, t0, sampleRate,
@@ -518,6 +912,7 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       copyEnd = std::min((int)numPixels, std::max(0,
          (int)mSpecCache->len - oldX0
       ));
+      wasPending = move(mSpecCache->pending);
    }
 
    // Resize the cache, keep the contents unchanged.
@@ -535,6 +930,9 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       memmove(&mSpecCache->freq[nBins * copyBegin],
                &mSpecCache->freq[nBins * (copyBegin + oldX0)],
                nBins * (copyEnd - copyBegin) * sizeof(float));
+      // Placeholders that are copied still need computation
+      for (auto xx = copyBegin; xx < copyEnd; ++xx)
+         mSpecCache->pending[xx] = wasPending[xx + oldX0];
    }
 
    // Reassignment accumulates, so it needs a zeroed buffer
@@ -562,8 +960,29 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       mSpecCache->where, numPixels, addBias, correction, t0, sampleRate,
       stretchRatio, samplesPerPixel);
 
-   mSpecCache->Populate(
-      settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond);
+   const bool inBackground = onProgress &&
+      settings.algorithm != SpectrogramSettings::algReassignment &&
+      SpectrogramInBackground.Read();
+   bool populated = false;
+   if (inBackground) {
+      try {
+         mSpecCache->PopulateInBackground(settings, clip, copyBegin, copyEnd,
+            numPixels, pixelsPerSecond, move(onProgress));
+         populated = true;
+      }
+      catch (...) {
+         // Such as failure to copy the sequence; compute here instead
+      }
+   }
+   if (!populated) {
+      auto &pending = mSpecCache->pending;
+      if (std::find(pending.begin(), pending.end(), true) != pending.end())
+         // Recompute everything, rather than find the pending runs
+         copyBegin = copyEnd = 0;
+      mSpecCache->Populate(
+         settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond);
+      pending.assign(numPixels, false);
+   }
 
    mSpecCache->dirty = mDirty;
    spectrogram = &mSpecCache->freq[0];
@@ -572,9 +991,56 @@ bool WaveClipSpectrumCache::GetSpectrogram(
    return true;
 }
 
+void WaveClipSpectrumCache::Prerender(const WaveChannelInterval &clip,
+   SpectrogramSettings &settings, size_t numPixels, double t0,
+   double pixelsPerSecond)
+{
+   if (!SpectrogramInBackground.Read() ||
+       settings.algorithm == SpectrogramSettings::algReassignment ||
+       SpectrumColumnCache::Get().GetCapacity() == 0)
+      return;
+
+   auto &pCache = mPrerenderCaches[clip.GetChannelIndex()];
+
+   const auto sampleRate = clip.GetRate();
+   const auto stretchRatio = clip.GetStretchRatio();
+   const auto samplesPerPixel = sampleRate / pixelsPerSecond / stretchRatio;
+
+   // Columns may still be computing for the same range
+   if (pCache && pCache->start == t0 && pCache->len >= numPixels &&
+       pCache->leftTrim == clip.GetTrimLeft() &&
+       pCache->rightTrim == clip.GetTrimRight() &&
+       pCache->Matches(mDirty, samplesPerPixel, settings))
+      return;
+
+   // Destroying the previous cache cancels the rest of its columns
+   pCache = std::make_unique<SpecCache>();
+   pCache->Grow(numPixels, settings, samplesPerPixel, t0);
+   pCache->leftTrim = clip.GetTrimLeft();
+   pCache->rightTrim = clip.GetTrimRight();
+   pCache->dirty = mDirty;
+
+   // Same columns as GetSpectrogram() centers on the grid of
+   // SpectrumColumnCache
+   constexpr auto addBias = true;
+   WaveClipUIUtilities::fillWhere(pCache->where, numPixels, addBias, 0.0, t0,
+      sampleRate, stretchRatio, samplesPerPixel);
+
+   try {
+      // The results stay in SpectrumColumnCache; nothing collects them here
+      pCache->PopulateInBackground(
+         settings, clip, 0, 0, numPixels, pixelsPerSecond, {}, true);
+   }
+   catch (...) {
+      // Such as failure to copy the sequence; it is only a speculation
+      pCache.reset();
+   }
+}
+
 WaveClipSpectrumCache::WaveClipSpectrumCache(size_t nChannels)
    : mSpecCaches(nChannels)
    , mSpecPxCaches(nChannels)
+   , mPrerenderCaches(nChannels)
 {
    for (auto &pCache : mSpecCaches)
       pCache = std::make_unique<SpecCache>();
@@ -611,6 +1077,8 @@ void WaveClipSpectrumCache::Invalidate()
    // Invalidate the spectrum display cache
    for (auto &pCache : mSpecCaches)
       pCache = std::make_unique<SpecCache>();
+   for (auto &pCache : mPrerenderCaches)
+      pCache.reset();
 }
 
 void WaveClipSpectrumCache::MakeStereo(WaveClipListener &&other, bool)
@@ -619,6 +1087,7 @@ void WaveClipSpectrumCache::MakeStereo(WaveClipListener &&other, bool)
    assert(pOther); // precondition
    mSpecCaches.push_back(move(pOther->mSpecCaches[0]));
    mSpecPxCaches.push_back(move(pOther->mSpecPxCaches[0]));
+   mPrerenderCaches.push_back(move(pOther->mPrerenderCaches[0]));
 }
 
 void WaveClipSpectrumCache::SwapChannels()
@@ -627,6 +1096,8 @@ void WaveClipSpectrumCache::SwapChannels()
    std::swap(mSpecCaches[0], mSpecCaches[1]);
    mSpecPxCaches.resize(2);
    std::swap(mSpecPxCaches[0], mSpecPxCaches[1]);
+   mPrerenderCaches.resize(2);
+   std::swap(mPrerenderCaches[0], mPrerenderCaches[1]);
 }
 
 void WaveClipSpectrumCache::Erase(size_t index)
@@ -635,4 +1106,6 @@ void WaveClipSpectrumCache::Erase(size_t index)
       mSpecCaches.erase(mSpecCaches.begin() + index);
    if (index < mSpecPxCaches.size())
       mSpecPxCaches.erase(mSpecPxCaches.begin() + index);
+   if (index < mPrerenderCaches.size())
+      mPrerenderCaches.erase(mPrerenderCaches.begin() + index);
 }
@@ -11,18 +11,32 @@
 #ifndef __AUDACITY_WAVECLIP_SPECTRUM_CACHE__
 #define __AUDACITY_WAVECLIP_SPECTRUM_CACHE__
 
+class BoolSetting;
+class ConstantQKernels;
+struct FFTParam;
 class sampleCount;
+class Sequence;
 class SpectrogramSettings;
 class WaveClipChannel;
 using WaveChannelInterval = WaveClipChannel;
 class WideSampleSequence;
 
+#include <functional>
+#include <memory>
 #include <vector>
 #include "MemoryX.h"
 #include "WaveClip.h" // to inherit WaveClipListener
 
+namespace audacity::concurrency {
+class CancellationContext;
+}
+
 using Floats = ArrayOf<float>;
 
+//! Whether spectrogram columns are computed in worker threads, and painted as
+//! they finish, instead of all of them while painting
+AUDACITY_DLL_API extern BoolSetting SpectrogramInBackground;
+
 class AUDACITY_DLL_API SpecCache {
 public:
 
@@ -37,9 +51,8 @@ public:
    {
    }
 
-   ~SpecCache()
-   {
-   }
+   //! Cancels computation in the background
+   ~SpecCache();
 
    bool Matches(
       int dirty_, double samplesPerPixel,
@@ -55,6 +68,28 @@ public:
       const SpectrogramSettings& settings, const WaveChannelInterval& clip,
       int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond);
 
+   //! Like Populate(), but in worker threads, also recalculating columns
+   //! still pending; until Collect() finds them, columns hold placeholders
+   /*!
+    @param onProgress called in the main thread when more columns are ready
+    for Collect()
+    @param lowPriority if true, the workers compute these columns only when
+    no others are waiting
+    @pre `settings.algorithm != SpectrogramSettings::algReassignment`
+    */
+   void PopulateInBackground(
+      const SpectrogramSettings& settings, const WaveChannelInterval& clip,
+      int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond,
+      std::function<void()> onProgress, bool lowPriority = false);
+
+   //! Copy into freq the columns finished in the background since the last
+   //! call
+   //! @return whether any were copied
+   bool Collect();
+
+   //! Stop computation in the background; unfinished columns stay pending
+   void Cancel();
+
    size_t       len { 0 }; // counts pixels, not samples
    int          algorithm;
    double       spp; // samples per pixel
@@ -67,18 +102,66 @@ public:
    int          frequencyGain;
    std::vector<float> freq;
    std::vector<sampleCount> where;
+   //! Whether each column of freq holds only a placeholder
+   std::vector<bool> pending;
 
    int          dirty;
 
 private:
+   //! What CalculateOneSpectrum() uses of SpectrogramSettings, after
+   //! SpectrogramSettings::CacheWindows()
+   struct Parameters {
+      explicit Parameters(const SpectrogramSettings &settings);
+      int algorithm;
+      int windowType;
+      int frequencyGain;
+      size_t windowSize;
+      size_t zeroPaddingFactor;
+      size_t nBins;
+      const FFTParam *hFFT;
+      const float *window;
+      const float *tWindow;
+      const float *dWindow;
+      //! Not null if `algorithm == SpectrogramSettings::algConstantQ`
+      const ConstantQKernels *constantQ{};
+      //! Whether to center columns on the grid of SpectrumColumnCache, and
+      //! reuse its columns
+      bool useColumnCache;
+   };
+
+   //! The samples of one channel of a clip, as CalculateOneSpectrum() uses
+   //! them
+   struct ClipSamples {
+      ClipSamples(const WaveChannelInterval &clip, const Sequence &sequence);
+      //! All of the channel, or a copy of it that other threads may read
+      const Sequence &sequence;
+      //! Samples trimmed from the start of the sequence
+      const sampleCount trimLeft;
+      const double rate;
+      const double stretchRatio;
+   };
+
    // Calculate one column of the spectrum
+   // If center is given, the column is centered there, instead of where[xx]
    bool CalculateOneSpectrum(
-      const SpectrogramSettings& settings, const WaveChannelInterval &clip,
+      const Parameters& params, const ClipSamples &clip,
       const int xx, double pixelsPerSecond, int lowerBoundX, int upperBoundX,
       const std::vector<float>& gainFactors, float* __restrict scratch,
+      float* __restrict out,
+      std::optional<sampleCount> center = std::nullopt) const;
+
+   //! Calculate column xx, or find it in SpectrumColumnCache
+   //! @pre `params.algorithm != SpectrogramSettings::algReassignment`
+   void CalculateColumn(
+      const Parameters& params, const ClipSamples &clip,
+      const int xx, double pixelsPerSecond,
+      const std::vector<float>& gainFactors, float* __restrict scratch,
       float* __restrict out) const;
 
-   mutable std::optional<AudioSegmentSampleView> mSampleCacheHolder;
+   //! State of PopulateInBackground(), shared with the worker threads
+   struct Job;
+   std::shared_ptr<Job> mpJob;
+   std::shared_ptr<audacity::concurrency::CancellationContext> mpCancellation;
 };
 
 class SpecPxCache {
@@ -88,16 +171,15 @@ public:
       , values{ len }
    {
       scaleType = 0;
-      range = gain = -1;
       minFreq = maxFreq = -1;
    }
 
    size_t  len;
+   //! Peak values of the spectrum for pixels, before gain and range are
+   //! applied
    Floats values;
 
    int scaleType;
-   int range;
-   int gain;
    int minFreq;
    int maxFreq;
 };
@@ -112,6 +194,8 @@ struct WaveClipSpectrumCache final : WaveClipListener
    // Cache of values to colour pixels of Spectrogram - used by TrackArtist
    std::vector<std::unique_ptr<SpecPxCache>> mSpecPxCaches;
    std::vector<std::unique_ptr<SpecCache>> mSpecCaches;
+   //! Columns computed ahead of scrolling, for SpectrumColumnCache only
+   std::vector<std::unique_ptr<SpecCache>> mPrerenderCaches;
    int mDirty { 0 };
 
    static WaveClipSpectrumCache &Get(const WaveChannelInterval &clip);
@@ -124,10 +208,26 @@ struct WaveClipSpectrumCache final : WaveClipListener
    // > only the 0th channel of sequence is really used
    // > In the interim, this still works correctly for WideSampleSequence backed
    // > by a right channel track, which always ignores its partner.
+   // If onProgress is not empty, and SpectrogramInBackground is set, new
+   // columns may be computed later in other threads; then onProgress is
+   // called in the main thread, and the next call returns them.
+   // Returns true if the spectrogram changed since the last call.
    bool GetSpectrogram(const WaveChannelInterval &clip,
       const float *&spectrogram,
       SpectrogramSettings &spectrogramSettings,
       const sampleCount *&where, size_t numPixels,
+      double t0 /*absolute time*/, double pixelsPerSecond,
+      std::function<void()> onProgress = {});
+
+   //! Compute in the background, at low priority, the columns of a range
+   //! about to come into view, so that SpectrumColumnCache has them when
+   //! GetSpectrogram() needs them
+   /*!
+    Does nothing unless SpectrogramInBackground is set and SpectrumColumnCache
+    has capacity, or for reassignment.  Arguments are as for GetSpectrogram().
+    */
+   void Prerender(const WaveChannelInterval &clip,
+      SpectrogramSettings &spectrogramSettings, size_t numPixels,
       double t0 /*absolute time*/, double pixelsPerSecond);
 
    void MakeStereo(WaveClipListener &&other, bool aligned) override;
@@ -0,0 +1,126 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SpectrumColumnCache.cpp
+
+**********************************************************************/
+
+#include "SpectrumColumnCache.h"
+
+#include "Prefs.h"
+#include <algorithm>
+#include <functional>
+
+IntSetting SpectrumColumnCacheSize{ L"/Spectrum/ColumnCacheMegabytes", 64 };
+
+namespace {
+void Combine(size_t &seed, size_t value)
+{
+   // As in boost::hash_combine
+   seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+}
+
+bool SpectrumColumnCache::Key::operator ==(const Key &other) const
+{
+   return pFactory == other.pFactory
+      && algorithm == other.algorithm
+      && windowType == other.windowType
+      && frequencyGain == other.frequencyGain
+      && windowSize == other.windowSize
+      && zeroPaddingFactor == other.zeroPaddingFactor
+      && rate == other.rate
+      && position == other.position
+      && trimLeft == other.trimLeft
+      && end == other.end
+      && content == other.content;
+}
+
+size_t SpectrumColumnCache::Key::Hash::operator ()(const Key &key) const
+{
+   size_t result = std::hash<const void*>{}(key.pFactory);
+   Combine(result, key.algorithm);
+   Combine(result, key.windowType);
+   Combine(result, key.frequencyGain);
+   Combine(result, key.windowSize);
+   Combine(result, key.zeroPaddingFactor);
+   Combine(result, std::hash<double>{}(key.rate));
+   Combine(result, std::hash<long long>{}(key.position));
+   Combine(result, std::hash<long long>{}(key.trimLeft));
+   Combine(result, std::hash<long long>{}(key.end));
+   Combine(result, std::hash<uint64_t>{}(key.content));
+   return result;
+}
+
+SpectrumColumnCache &SpectrumColumnCache::Get()
+{
+   static SpectrumColumnCache instance;
+   return instance;
+}
+
+void SpectrumColumnCache::SetCapacity(size_t bytes)
+{
+   if (mCapacity.exchange(bytes) > bytes) {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      Trim();
+   }
+}
+
+size_t SpectrumColumnCache::GetCapacity() const
+{
+   return mCapacity;
+}
+
+bool SpectrumColumnCache::Find(const Key &key, size_t nBins, float *values)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   const auto found = mIndex.find(key);
+   if (found == mIndex.end())
+      return false;
+   const auto iter = found->second;
+   if (iter->wFactory.expired() || iter->values.size() != nBins) {
+      // The ids of blocks may be reused by another project
+      mBytes -= Bytes(*iter);
+      mIndex.erase(found);
+      mEntries.erase(iter);
+      return false;
+   }
+   mEntries.splice(mEntries.begin(), mEntries, iter);
+   std::copy(iter->values.begin(), iter->values.end(), values);
+   return true;
+}
+
+void SpectrumColumnCache::Insert(const Key &key,
+   const std::shared_ptr<SampleBlockFactory> &pFactory,
+   size_t nBins, const float *values)
+{
+   if (mCapacity == 0)
+      return;
+   Entry entry{ key, pFactory, std::vector<float>(values, values + nBins) };
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (mIndex.count(key))
+      // Another thread computed the same column
+      return;
+   mBytes += Bytes(entry);
+   mEntries.push_front(std::move(entry));
+   mIndex.emplace(key, mEntries.begin());
+   Trim();
+}
+
+size_t SpectrumColumnCache::Bytes(const Entry &entry)
+{
+   // Count some overhead of the containers too
+   return sizeof(Entry) + 4 * sizeof(void*) +
+      entry.values.size() * sizeof(float);
+}
+
+void SpectrumColumnCache::Trim()
+{
+   while (mBytes > mCapacity && !mEntries.empty()) {
+      auto &last = mEntries.back();
+      mBytes -= Bytes(last);
+      mIndex.erase(last.key);
+      mEntries.pop_back();
+   }
+}
@@ -0,0 +1,106 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SpectrumColumnCache.h
+  @brief Spectrogram columns kept across zooming, scrolling and edits
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SPECTRUM_COLUMN_CACHE__
+#define __AUDACITY_SPECTRUM_COLUMN_CACHE__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class IntSetting;
+class SampleBlockFactory;
+
+//! Megabytes of spectrogram columns kept by SpectrumColumnCache; 0 disables
+//! it
+extern AUDACITY_DLL_API IntSetting SpectrumColumnCacheSize;
+
+//! Least recently used spectrogram columns, shared by all clips, and found
+//! by everything that their values depend on
+/*!
+ The columns of a SpecCache are discarded when zooming, or when any part of
+ the clip changes; these are not, so the same column need not be computed
+ again.  Columns are centered on a grid of spacing a power of two, so that
+ a coarser zoom level uses a subset of the columns of a finer one.
+
+ Methods may be called in any thread, except SetCapacity()
+ */
+class SpectrumColumnCache final {
+public:
+   //! Everything that the values of a column depend on
+   struct Key {
+      //! Qualifies the ids of sample blocks
+      const SampleBlockFactory *pFactory{};
+      int algorithm{};
+      int windowType{};
+      int frequencyGain{};
+      size_t windowSize{};
+      size_t zeroPaddingFactor{};
+      double rate{};
+      //! Center of the column, relative to the start of the clip
+      long long position{};
+      //! Samples trimmed from the start of the sequence
+      long long trimLeft{};
+      //! Length of the sequence if the window might reach its end, else -1
+      long long end{};
+      //! Hash of the ids and starts of the sample blocks in the window
+      uint64_t content{};
+
+      bool operator ==(const Key &other) const;
+      struct Hash { size_t operator ()(const Key &key) const; };
+   };
+
+   static SpectrumColumnCache &Get();
+
+   //! Change the limit of memory, evicting columns if it is exceeded
+   void SetCapacity(size_t bytes);
+   size_t GetCapacity() const;
+
+   //! Copy the column, if found, into `values`
+   /*!
+    @param values has room for nBins values
+    @return whether found
+    */
+   bool Find(const Key &key, size_t nBins, float *values);
+
+   //! Remember a copy of the column
+   /*!
+    @param pFactory the same as `key.pFactory`; the column can't be found
+    after it is destroyed
+    */
+   void Insert(const Key &key,
+      const std::shared_ptr<SampleBlockFactory> &pFactory,
+      size_t nBins, const float *values);
+
+private:
+   struct Entry {
+      Key key;
+      std::weak_ptr<SampleBlockFactory> wFactory;
+      std::vector<float> values;
+   };
+   using Entries = std::list<Entry>;
+
+   static size_t Bytes(const Entry &entry);
+   //! Evict from the back of mEntries until within capacity
+   void Trim();
+
+   mutable std::mutex mMutex;
+   //! Most recently used first
+   Entries mEntries;
+   std::unordered_map<Key, Entries::iterator, Key::Hash> mIndex;
+   size_t mBytes{ 0 };
+   std::atomic<size_t> mCapacity{ 0 };
+};
+
+#endif
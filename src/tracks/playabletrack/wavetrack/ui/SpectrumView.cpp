@@ -24,11 +24,13 @@ Paul Licameli split from WaveChannelView.cpp
 #include "../../../ui/BrushHandle.h"
 
 #include "AColor.h"
+#include "FrameStatistics.h"
 #include "PendingTracks.h"
 #include "Prefs.h"
 #include "NumberScale.h"
 #include "../../../../TrackArt.h"
 #include "../../../../TrackArtist.h"
+#include "../../../../TrackPanel.h"
 #include "../../../../TrackPanelDrawingContext.h"
 #include "ViewInfo.h"
 #include "WaveClip.h"
@@ -39,6 +41,9 @@ Paul Licameli split from WaveChannelView.cpp
 
 #include <wx/dcmemory.h>
 #include <wx/graphics.h>
+#include <wx/weakref.h>
+
+#include <limits>
 
 #include "float_cast.h"
 
@@ -242,9 +247,10 @@ void SpectrumView::CopyToSubView(WaveChannelSubView *destSubView) const
 namespace
 {
 
-static inline float findValue
+// Find the value for one pixel row, before gain and range are applied
+static inline float findPeak
 (const float *spectrum, float bin0, float bin1, unsigned nBins,
- bool autocorrelation, int gain, int range)
+ bool autocorrelation)
 {
    float value;
 
@@ -292,6 +298,13 @@ static inline float findValue
    while (++index < limitIndex)
       value = std::max(value, spectrum[index]);
 #endif
+   return value;
+}
+
+// Map the result of findPeak into the 0.0-1.0 range of the color gradient
+static inline float normalizeValue
+(float value, bool autocorrelation, int gain, int range)
+{
    if (!autocorrelation) {
       // Last step converts dB to a 0.0-1.0 range
       value = (value + range + gain) / (double)range;
@@ -300,6 +313,15 @@ static inline float findValue
    return value;
 }
 
+static inline float findValue
+(const float *spectrum, float bin0, float bin1, unsigned nBins,
+ bool autocorrelation, int gain, int range)
+{
+   return normalizeValue(
+      findPeak(spectrum, bin0, bin1, nBins, autocorrelation),
+      autocorrelation, gain, range);
+}
+
 // dashCount counts both dashes and the spaces between them.
 inline AColor::ColorGradientChoice
 ChooseColorSet( float bin0, float bin1, float selBinLo,
@@ -348,6 +370,12 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
   const auto &selectedRegion = *artist->pSelectedRegion;
   const auto &zoomInfo = *artist->pZoomInfo;
 
+   auto sw = FrameStatistics::CreateStopwatch(
+      FrameStatistics::SectionID::SpectrumView, [&] {
+         return std::string { (channel.GetTrack().GetName() + wxT(": ") +
+                               clip.GetClip().GetName()).ToUTF8().data() };
+      });
+
 #ifdef PROFILE_WAVEFORM
    Profiler profiler;
 #endif
@@ -424,9 +452,14 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
    const double binUnit = sampleRate / (2 * half);
    const float *freq = 0;
    const sampleCount *where = 0;
+   // Paint again as columns computed in the background become ready
+   auto onProgress = [wPanel = wxWeakRef<wxWindow>{ artist->parent }]{
+      if (wPanel)
+         wPanel->Refresh(false);
+   };
    bool updated = WaveClipSpectrumCache::Get(clip).GetSpectrogram(
       clip, freq, settings, where, (size_t)hiddenMid.width, t0,
-      averagePixelsPerSecond);
+      averagePixelsPerSecond, onProgress);
    auto nBins = settings.NBins();
 
    float minFreq, maxFreq;
@@ -479,14 +512,15 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
    if (!updated && specPxCache &&
       ((int)specPxCache->len == hiddenMid.height * hiddenMid.width)
       && scaleType == specPxCache->scaleType
-      && gain == specPxCache->gain
-      && range == specPxCache->range
       && minFreq == specPxCache->minFreq
       && maxFreq == specPxCache->maxFreq
 #ifdef EXPERIMENTAL_FFT_Y_GRID
    && fftYGrid==fftYGridOld
 #endif //EXPERIMENTAL_FFT_Y_GRID
 #ifdef EXPERIMENTAL_FIND_NOTES
+   // Finding notes depends on gain and range, not only the peaks
+   && gain == artist->gainOld
+   && range == artist->rangeOld
    && fftFindNotes == artist->fftFindNotesOld
    && findNotesMinA == artist->findNotesMinAOld
    && numberOfMaxima == artist->findNotesNOld
@@ -500,11 +534,11 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
       // Update the spectrum pixel cache
       specPxCache = std::make_unique<SpecPxCache>(hiddenMid.width * hiddenMid.height);
       specPxCache->scaleType = scaleType;
-      specPxCache->gain = gain;
-      specPxCache->range = range;
       specPxCache->minFreq = minFreq;
       specPxCache->maxFreq = maxFreq;
 #ifdef EXPERIMENTAL_FIND_NOTES
+      artist->gainOld = gain;
+      artist->rangeOld = range;
       artist->fftFindNotesOld = fftFindNotes;
       artist->findNotesMinAOld = findNotesMinA;
       artist->findNotesNOld = numberOfMaxima;
@@ -528,7 +562,8 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
          minDistance = powf(2.0f, 2.0f / 12.0f),
          i0 = expf(lmin) / binUnit,
          i1 = expf(scale + lmin) / binUnit,
-         minColor = 0.0f;
+         // normalizeValue maps this to the least color
+         minPeak = -std::numeric_limits<float>::infinity();
       const size_t maxTableSize = 1024;
       ArrayOf<int> indexes{ maxTableSize };
 #endif //EXPERIMENTAL_FIND_NOTES
@@ -607,8 +642,8 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
             const float nextBin = bins[yy+1];
 
             if (settings.scaleType != SpectrogramSettings::stLogarithmic) {
-               const float value = findValue
-                  (freq + nBins * xx, bin, nextBin, nBins, autocorrelation, gain, range);
+               const float value = findPeak
+                  (freq + nBins * xx, bin, nextBin, nBins, autocorrelation);
                specPxCache->values[xx * hiddenMid.height + yy] = value;
             }
             else {
@@ -624,28 +659,28 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
                      if (inMaximum) {
                         float i1 = maxima1[it];
                         if (yy + 1 <= i1) {
-                           value = findValue(freq + x0, bin, nextBin, nBins, autocorrelation, gain, range);
-                           if (value < findNotesMinA)
-                              value = minColor;
+                           value = findPeak(freq + x0, bin, nextBin, nBins, autocorrelation);
+                           if (normalizeValue(value, autocorrelation, gain, range) < findNotesMinA)
+                              value = minPeak;
                         }
                         else {
                            it++;
                            inMaximum = false;
-                           value = minColor;
+                           value = minPeak;
                         }
                      }
                      else {
-                        value = minColor;
+                        value = minPeak;
                      }
                   }
                   else
-                     value = minColor;
+                     value = minPeak;
                }
                else
 #endif //EXPERIMENTAL_FIND_NOTES
                {
-                  value = findValue
-                     (freq + nBins * xx, bin, nextBin, nBins, autocorrelation, gain, range);
+                  value = findPeak
+                     (freq + nBins * xx, bin, nextBin, nBins, autocorrelation);
                }
                specPxCache->values[xx * hiddenMid.height + yy] = value;
             } // logF
@@ -811,9 +846,13 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
                selected = AColor::ColorGradientTimeAndFrequencySelected;
          }
 
+         // Gain and range apply only now, so that changing them does not
+         // invalidate the pixel cache
          const float value = uncached
             ? findValue(uncached, bin, nextBin, nBins, autocorrelation, gain, range)
-            : specPxCache->values[correctedX * hiddenMid.height + yy];
+            : normalizeValue(
+               specPxCache->values[correctedX * hiddenMid.height + yy],
+               autocorrelation, gain, range);
 
          unsigned char rv, gv, bv;
          GetColorGradient(value, selected, colorScheme, &rv, &gv, &bv);
@@ -855,6 +894,24 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
 }
 }
 
+//! Start computing in the background the spectrogram of a clip where the
+//! view is about to scroll
+void PrerenderClipSpectrum(const WaveChannel &channel,
+   const WaveChannelInterval &clip, const wxRect &rect, const ZoomInfo &ahead)
+{
+   if (!WaveChannelView::ClipDetailsVisible(clip, ahead, rect))
+      return;
+
+   const ClipParameters params { clip, rect, ahead };
+   if (params.hiddenMid.width <= 0)
+      return;
+
+   auto &settings = SpectrogramSettings::Get(channel);
+   WaveClipSpectrumCache::Get(clip).Prerender(clip, settings,
+      (size_t)params.hiddenMid.width, params.t0,
+      params.averagePixelsPerSecond);
+}
+
 void SpectrumView::DoDraw(TrackPanelDrawingContext& context,
    const WaveChannel &channel, const WaveTrack::Interval* selectedClip,
    const wxRect & rect)
@@ -865,7 +922,11 @@ void SpectrumView::DoDraw(TrackPanelDrawingContext& context,
    TrackArt::DrawBackgroundWithSelection(
       context, rect, channel, blankSelectedBrush, blankBrush );
 
+   const auto &zoomInfo = *artist->pZoomInfo;
    for (const auto &pInterval : channel.Intervals()) {
+      if (!TrackArt::MeetsClippingBox(context.dc,
+         ClipParameters::GetClipRect(*pInterval, zoomInfo, rect)))
+         continue;
       bool selected = selectedClip &&
          selectedClip == &pInterval->GetClip();
       DrawClipSpectrum(context, channel, *pInterval, rect, mpSpectralData,
@@ -873,6 +934,12 @@ void SpectrumView::DoDraw(TrackPanelDrawingContext& context,
    }
 
    DrawBoldBoundaries(context, channel, rect);
+
+   if (const auto start = GetPrerenderStart(context, rect)) {
+      const ZoomInfo ahead{ *start, artist->pZoomInfo->GetZoom() };
+      for (const auto &pInterval : channel.Intervals())
+         PrerenderClipSpectrum(channel, *pInterval, rect, ahead);
+   }
 }
 
 void SpectrumView::Draw(
@@ -14,6 +14,7 @@ Paul Licameli split from TrackPanel.cpp
 
 #include "CutlineHandle.h"
 
+#include <cmath>
 #include <numeric>
 #include <wx/dc.h>
 #include <wx/graphics.h>
@@ -34,10 +35,12 @@ Paul Licameli split from TrackPanel.cpp
 #include "../../../../prefs/TracksPrefs.h"
 #include "CommandContext.h"
 #include "PitchAndSpeedDialog.h"
+#include "Prefs.h"
 #include "ProjectHistory.h"
 #include "SyncLock.h"
 #include "TrackFocus.h"
 #include "ViewInfo.h"
+#include "Viewport.h"
 
 #include "../../../ui/TimeShiftHandle.h"
 #include "../../../ui/ButtonHandle.h"
@@ -53,6 +56,8 @@ Paul Licameli split from TrackPanel.cpp
 
 constexpr int kClipDetailedViewMinimumWidth{ 3 };
 
+BoolSetting PrerenderWhileScrolling{ L"/GUI/PrerenderWhileScrolling", true };
+
 using WaveChannelSubViewPtrs = std::vector<std::shared_ptr<WaveChannelSubView>>;
 
 namespace {
@@ -844,6 +849,27 @@ std::pair<
    return results;
 }
 
+std::optional<double> WaveChannelSubView::GetPrerenderStart(
+   TrackPanelDrawingContext &context, const wxRect &rect)
+{
+   if (!PrerenderWhileScrolling.Read())
+      return {};
+
+   const auto artist = TrackArtist::Get(context);
+   const auto pProject = artist->parent ? artist->parent->GetProject() : nullptr;
+   if (!pProject)
+      return {};
+
+   const auto &zoomInfo = *artist->pZoomInfo;
+   const auto velocity = Viewport::Get(*pProject).GetScrollVelocity();
+   const double screen = rect.width / zoomInfo.GetZoom();
+
+   // Slow drifting exposes few columns at a time, which painting keeps up with
+   if (std::abs(velocity) < screen / 10)
+      return {};
+
+   return zoomInfo.hpos + (velocity > 0 ? screen : -screen);
+}
 
 void WaveChannelSubView::DrawBoldBoundaries(
    TrackPanelDrawingContext &context, const WaveChannel &channel,
@@ -15,9 +15,13 @@ Paul Licameli split from class WaveTrack
 #include "ClientData.h"
 #include "SampleCount.h"
 #include "WaveTrack.h"
+
+#include <optional>
+
 namespace WaveChannelViewConstants{ enum Display : int; }
 struct WaveChannelSubViewType;
 
+class BoolSetting;
 class ClipTimes;
 class CutlineHandle;
 class TranslatableString;
@@ -36,6 +40,10 @@ class SubViewRearrangeHandle;
 
 class wxDC;
 
+//! Whether sub-views fill their caches for the next screen width in the
+//! direction of horizontal scrolling, before it comes into view
+AUDACITY_DLL_API extern BoolSetting PrerenderWhileScrolling;
+
 class AUDACITY_DLL_API WaveChannelSubView : public CommonChannelView
 {
 public:
@@ -67,6 +75,15 @@ protected:
       TrackPanelDrawingContext &context, const WaveChannel &channel,
       const wxRect &rect);
 
+   //! Left edge time of the view one screen width on, in the direction that
+   //! Viewport scrolled lately, for filling caches ahead
+   /*!
+    @return nullopt if the view is not scrolling fast enough to matter, or
+    PrerenderWhileScrolling is off
+    */
+   static std::optional<double> GetPrerenderStart(
+      TrackPanelDrawingContext &context, const wxRect &rect);
+
    std::weak_ptr<WaveChannelView> GetWaveChannelView() const;
 
    std::vector<MenuItem> GetMenuItems(
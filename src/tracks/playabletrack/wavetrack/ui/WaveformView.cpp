@@ -29,6 +29,7 @@ Paul Licameli split from WaveChannelView.cpp
 #include "SyncLock.h"
 #include "../../../../TrackArt.h"
 #include "../../../../TrackArtist.h"
+#include "../../../../TrackPanel.h"
 #include "../../../../TrackPanelDrawingContext.h"
 #include "../../../../TrackPanelMouseEvent.h"
 #include "ViewInfo.h"
@@ -45,6 +46,7 @@ Paul Licameli split from WaveChannelView.cpp
 #include <wx/dc.h>
 
 #include <wx/dcmemory.h>
+#include <wx/weakref.h>
 #include "waveform/WaveBitmapCache.h"
 #include "waveform/WaveDataCache.h"
 #include "waveform/WavePaintParameters.h"
@@ -61,6 +63,15 @@ static WaveChannelSubView::Type sType{
 
 static WaveChannelSubViewType::RegisteredType reg{ sType };
 
+//! Whether samples of clips not yet cached are read in worker threads, and
+//! painted when ready, instead of while painting
+static BoolSetting WaveformInBackground{ L"/GUI/WaveformInBackground", true };
+
+//! Megabytes that the waveform caches of all clips may hold together, or 0
+//! for no bound
+static IntSetting GraphicsCacheSize{ L"/GUI/GraphicsCacheSize",
+   int(GraphicsDataCacheBudget::DefaultBudget / (1024 * 1024)) };
+
 WaveformView::~WaveformView() = default;
 
 std::vector<UIHandlePtr> WaveformView::DetailedHitTest(
@@ -201,6 +212,15 @@ struct WaveBitmapCacheElementWX final : public WaveBitmapCacheElement
       return mImage.GetHeight();
    }
 
+   size_t GetMemoryUsage() const noexcept override
+   {
+      if (!mImage.IsOk())
+         return sizeof(*this);
+
+      // The image, and the bitmap made from it, about as large
+      return sizeof(*this) + 2 * Width() * Height() * 3;
+   }
+
 private:
    wxBitmap mBitmap;
    wxImage  mImage;
@@ -248,6 +268,20 @@ public:
       return *this;
    }
 
+   //! @copydoc WaveDataCache::SetReadInBackground
+   void SetReadInBackground(const std::function<void()>& onColumnsReady)
+   {
+      for (auto& channelCache : mChannelCaches)
+         channelCache.DataCache->SetReadInBackground(onColumnsReady);
+   }
+
+   //! Look up the columns of a range not yet drawn, so that those read in
+   //! the background are ready when it is
+   void Prerender(int channelIndex, const ZoomInfo& zoomInfo, double from, double to)
+   {
+      mChannelCaches[channelIndex].DataCache->PerformLookup(zoomInfo, from, to);
+   }
+
    void SetSelection(const ZoomInfo& zoomInfo, float t0, float t1, bool selected)
    {
       for (auto& channelCache : mChannelCaches)
@@ -303,6 +337,13 @@ public:
       mChanged.store(true);
    }
 
+   void MarkAppended() noexcept override
+   {
+      // Columns of the samples that were there stay valid; the elements
+      // that end with the clip are incomplete, and read again only from
+      // their last column at the next lookup
+   }
+
    void Invalidate() override
    {
       for (auto& channelCache : mChannelCaches)
@@ -330,6 +371,15 @@ private:
    std::atomic<bool> mChanged = false;
 };
 
+//! Paint again as columns read in the background become ready
+std::function<void()> RefreshWhenColumnsReady(const TrackArtist& artist)
+{
+   return [wPanel = wxWeakRef<wxWindow> { artist.parent }] {
+      if (wPanel)
+         wPanel->Refresh(false);
+   };
+}
+
 void DrawWaveform(
    TrackPanelDrawingContext& context, const WaveTrack& track, const WaveChannelInterval& channelInterval,
    int leftOffset, double t0, double t1,
@@ -369,6 +419,14 @@ void DrawWaveform(
          ColorFromWXPen(muted ? artist->muteClippedPen : artist->clippedPen))
       .SetEnvelope(clip.GetEnvelope());
 
+   GraphicsDataCacheBudget::Get().SetBudget(
+      size_t(std::max(0, GraphicsCacheSize.Read())) * 1024 * 1024);
+
+   if (WaveformInBackground.Read())
+      clipPainter.SetReadInBackground(RefreshWhenColumnsReady(*artist));
+   else
+      clipPainter.SetReadInBackground({});
+
    clipPainter.SetSelection(
       zoomInfo, artist->pSelectedRegion->t0() - sequenceStartTime,
       artist->pSelectedRegion->t1() - sequenceStartTime,
@@ -769,7 +827,11 @@ void DrawClipWaveform(TrackPanelDrawingContext &context,
    const auto &selectedRegion = *artist->pSelectedRegion;
    const auto &zoomInfo = *artist->pZoomInfo;
 
-   auto sw = FrameStatistics::CreateStopwatch(FrameStatistics::SectionID::WaveformView);
+   auto sw = FrameStatistics::CreateStopwatch(
+      FrameStatistics::SectionID::WaveformView, [&] {
+         return std::string { (channel.GetTrack().GetName() + wxT(": ") +
+                               clip.GetClip().GetName()).ToUTF8().data() };
+      });
 
    bool highlightEnvelope = false;
 #ifdef EXPERIMENTAL_TRACK_PANEL_HIGHLIGHTING
@@ -909,6 +971,36 @@ void DrawClipWaveform(TrackPanelDrawingContext &context,
    }
 }
 
+//! Start reading in the background the columns of a clip where the view is
+//! about to scroll
+void PrerenderClipWaveform(TrackPanelDrawingContext &context,
+   const WaveChannelInterval &clip, const wxRect &rect, const ZoomInfo &ahead)
+{
+   // Reading in this thread would only delay the painting of what is in view
+   if (!WaveformInBackground.Read())
+      return;
+
+   if (!WaveChannelView::ClipDetailsVisible(clip, ahead, rect))
+      return;
+
+   const ClipParameters params { clip, rect, ahead };
+   if (params.hiddenMid.width <= 0)
+      return;
+
+   // Individual samples are drawn without the caches
+   if (ahead.GetZoom() > 0.5 * clip.GetRate() / clip.GetStretchRatio())
+      return;
+
+   auto& clipPainter = WaveformPainter::Get(clip.GetClip());
+   clipPainter.SetReadInBackground(
+      RefreshWhenColumnsReady(*TrackArtist::Get(context)));
+
+   const auto trimLeft = clip.GetTrimLeft();
+   clipPainter.Prerender(
+      clip.GetChannelIndex(), ZoomInfo(0.0, ahead.GetZoom()),
+      params.t0 + trimLeft, params.t1 + trimLeft);
+}
+
 void DrawTimeSlider( TrackPanelDrawingContext &context,
                                   const wxRect & rect,
                                   bool rightwards, bool highlight )
@@ -996,13 +1088,23 @@ void WaveformView::DoDraw(TrackPanelDrawingContext &context,
    TrackArt::DrawBackgroundWithSelection(
       context, rect, channel, blankSelectedBrush, blankBrush );
 
+   const auto &zoomInfo = *artist->pZoomInfo;
    for (const auto &pInterval : channel.Intervals()) {
+      if (!TrackArt::MeetsClippingBox(dc,
+         ClipParameters::GetClipRect(*pInterval, zoomInfo, rect)))
+         continue;
       bool selected = selectedClip &&
          selectedClip == &pInterval->GetClip();
       DrawClipWaveform(context, channel, *pInterval, rect, dB, muted, selected);
    }
    DrawBoldBoundaries(context, channel, rect);
 
+   if (const auto start = GetPrerenderStart(context, rect)) {
+      const ZoomInfo ahead{ *start, artist->pZoomInfo->GetZoom() };
+      for (const auto &pInterval : channel.Intervals())
+         PrerenderClipWaveform(context, *pInterval, rect, ahead);
+   }
+
    const auto drawSliders = artist->drawSliders;
    if (drawSliders) {
       DrawTimeSlider( context, rect, true, highlight && gripHit );  // directed right
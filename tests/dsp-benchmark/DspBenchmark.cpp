@@ -0,0 +1,251 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DspBenchmark.cpp
+
+  A command-line application to measure the speed of the signal processing
+  that playback, rendering and spectrogram drawing rely on, for the purpose of
+  catching regressions.  The results are JSON, one object per measurement,
+  so that runs of two releases can be compared with any JSON tool.
+
+**********************************************************************/
+
+#include "MockedPrefs.h"
+#include "PowerSpectrumGetter.h"
+#include "RealFFTf.h"
+#include "Resample.h"
+#include "StaffPadTimeAndPitch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+constexpr auto pi = 3.14159265358979323846;
+
+//! Ten seconds of a chirp with some noise
+std::vector<float> MakeSignal()
+{
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise(-.1f, .1f);
+   std::vector<float> signal(10 * sampleRate);
+   double phase = 0;
+   for (size_t i = 0; i < signal.size(); ++i)
+   {
+      const auto frequency = 100. + 10000. * i / signal.size();
+      phase += 2 * pi * frequency / sampleRate;
+      signal[i] = .5f * static_cast<float>(std::sin(phase)) + noise(gen);
+   }
+   return signal;
+}
+
+//! Loops over the signal for as long as it is pulled
+class LoopingSource final : public TimeAndPitchSource
+{
+public:
+   explicit LoopingSource(const std::vector<float>& signal)
+       : mSignal { signal }
+   {
+   }
+
+   void Pull(float* const* buffer, size_t samplesPerChannel) override
+   {
+      for (size_t i = 0; i < samplesPerChannel; ++i)
+      {
+         buffer[0][i] = mSignal[mPosition];
+         mPosition = (mPosition + 1) % mSignal.size();
+      }
+   }
+
+private:
+   const std::vector<float>& mSignal;
+   size_t mPosition = 0;
+};
+
+struct Benchmark
+{
+   std::string name;
+   std::string parameters;
+   //! Runs once, returns how many items (samples or frames) it processed
+   std::function<size_t()> run;
+};
+
+std::vector<Benchmark> GetBenchmarks(const std::vector<float>& signal)
+{
+   std::vector<Benchmark> benchmarks;
+
+   for (const size_t fftSize : { 256u, 1024u, 4096u })
+      benchmarks.push_back({ "RealFFTf", "size=" + std::to_string(fftSize),
+         [&signal, fftSize] {
+            const auto hFFT = GetFFT(fftSize);
+            std::vector<fft_type> buffer(fftSize);
+            size_t items = 0;
+            for (size_t start = 0; start + fftSize <= signal.size();
+                 start += fftSize)
+            {
+               std::copy_n(signal.begin() + start, fftSize, buffer.begin());
+               RealFFTf(buffer.data(), hFFT.get());
+               InverseRealFFTf(buffer.data(), hFFT.get());
+               items += fftSize;
+            }
+            return items;
+         } });
+
+   for (const unsigned nThreads : { 1u, 4u })
+      benchmarks.push_back({ "PowerSpectrumGetter",
+         "size=2048,hop=512,threads=" + std::to_string(nThreads),
+         [&signal, nThreads] {
+            constexpr auto fftSize = 2048;
+            constexpr auto hop = 512;
+            PowerSpectrumGetter getter { fftSize };
+            const auto nFrames = (signal.size() - fftSize) / hop + 1;
+            const auto frameStride = getter.GetFrameStride();
+            PffftFloatVector frames(frameStride * nFrames);
+            PffftFloatVector spectra(getter.GetSpectrumStride() * nFrames);
+            for (size_t i = 0; i < nFrames; ++i)
+               std::copy_n(signal.begin() + i * hop, fftSize,
+                  frames.begin() + frameStride * i);
+            getter(frames.aligned(), nFrames, spectra.aligned(), nThreads);
+            return nFrames;
+         } });
+
+   for (const auto useBest : { false, true })
+      benchmarks.push_back({ "Resample",
+         std::string { "method=" } + (useBest ? "best" : "fast") +
+            ",factor=48000/44100",
+         [&signal, useBest] {
+            constexpr auto factor = 48000. / sampleRate;
+            Resample resample { useBest, factor, factor };
+            std::vector<float> output(signal.size() * factor + 1024);
+            size_t consumed = 0;
+            size_t produced = 0;
+            while (consumed < signal.size())
+            {
+               const auto [used, created] = resample.Process(factor,
+                  signal.data() + consumed, signal.size() - consumed, true,
+                  output.data() + produced, output.size() - produced);
+               consumed += used;
+               produced += created;
+               if (used == 0 && created == 0)
+                  break;
+            }
+            return consumed;
+         } });
+
+   for (const auto [timeRatio, pitchRatio, formants] :
+        { std::tuple { 1.5, 1., false }, std::tuple { 1., 1.25, false },
+          std::tuple { 1., 1.25, true } })
+      benchmarks.push_back({ "StaffPadTimeAndPitch",
+         "time_ratio=" + std::to_string(timeRatio) +
+            ",pitch_ratio=" + std::to_string(pitchRatio) +
+            ",formants=" + (formants ? "true" : "false"),
+         [&signal, timeRatio = timeRatio, pitchRatio = pitchRatio,
+          formants = formants] {
+            LoopingSource source { signal };
+            TimeAndPitchInterface::Parameters params;
+            params.timeRatio = timeRatio;
+            params.pitchRatio = pitchRatio;
+            params.preserveFormants = formants;
+            StaffPadTimeAndPitch stretcher { sampleRate, 1, source,
+                                             std::move(params) };
+            constexpr size_t blockSize = 512;
+            std::vector<float> output(blockSize);
+            const auto channels = output.data();
+            size_t items = 0;
+            while (items < signal.size())
+            {
+               stretcher.GetSamples(&channels, blockSize);
+               items += blockSize;
+            }
+            return items;
+         } });
+
+   return benchmarks;
+}
+
+std::string Escape(const std::string& str)
+{
+   std::string result;
+   for (const auto c : str)
+   {
+      if (c == '"' || c == '\\')
+         result += '\\';
+      result += c;
+   }
+   return result;
+}
+
+void PrintHelp(char* const* argv)
+{
+   std::cout
+      << "Usage: " << argv[0] << " [--filter NAME] [--repeat N]\n"
+      << "Runs each benchmark N times (default 5) and writes the fastest\n"
+      << "run of each as JSON to the standard output.\n"
+      << "--filter runs only the benchmarks whose name contains NAME.\n";
+}
+} // namespace
+
+int main(int argc, char* const* argv)
+{
+   std::string filter;
+   int repeat = 5;
+   for (int i = 1; i < argc; ++i)
+   {
+      const std::string arg = argv[i];
+      if (arg == "--help" || arg == "-h")
+      {
+         PrintHelp(argv);
+         return 0;
+      }
+      else if (arg == "--filter" && i + 1 < argc)
+         filter = argv[++i];
+      else if (arg == "--repeat" && i + 1 < argc)
+         repeat = std::max(1, std::atoi(argv[++i]));
+      else
+      {
+         PrintHelp(argv);
+         return 1;
+      }
+   }
+
+   // Resample and the stretcher read settings
+   MockedPrefs mockedPrefs;
+
+   const auto signal = MakeSignal();
+   auto first = true;
+   std::cout << "{\n  \"repeat\": " << repeat << ",\n  \"benchmarks\": [";
+   for (const auto& benchmark : GetBenchmarks(signal))
+   {
+      if (benchmark.name.find(filter) == std::string::npos)
+         continue;
+      auto best = std::numeric_limits<double>::max();
+      size_t items = 0;
+      for (int i = 0; i < repeat; ++i)
+      {
+         const auto start = std::chrono::steady_clock::now();
+         items = benchmark.run();
+         const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+         best = std::min(best, elapsed.count());
+      }
+      std::cout << (first ? "\n" : ",\n") << "    { \"name\": \""
+                << Escape(benchmark.name) << "\", \"parameters\": \""
+                << Escape(benchmark.parameters) << "\", \"items\": " << items
+                << ", \"seconds\": " << best
+                << ", \"items_per_second\": " << items / best << " }";
+      first = false;
+   }
+   std::cout << "\n  ]\n}" << std::endl;
+   return 0;
+}